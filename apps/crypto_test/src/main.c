@@ -473,6 +473,10 @@ run_ctr_bench(struct crypto_dev *crypto, uint8_t iter)
 }
 #endif /* MYNEWT_VAL(CRYPTOTEST_BENCHMARK) */
 
+#if MYNEWT_VAL(CRYPTOTEST_TC_BENCHMARK)
+void run_tc_benchmark(void);
+#endif
+
 #if MYNEWT_VAL(CRYPTOTEST_CONCURRENCY)
 static void
 lock(void)
@@ -996,6 +1000,10 @@ mynewt_main(int argc, char **argv)
     os_time_delay(OS_TICKS_PER_SEC);
 #endif
 
+#if MYNEWT_VAL(CRYPTOTEST_TC_BENCHMARK)
+    run_tc_benchmark();
+#endif
+
 #if MYNEWT_VAL(CRYPTOTEST_CONCURRENCY)
     run_concurrency_test(crypto);
 #endif
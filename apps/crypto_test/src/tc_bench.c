@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Cost per operation of the tinycrypt primitives that dominate image
+ * signature checks and pairing: an AES-128 block, a SHA-256 block, ECDSA
+ * P-256 sign / verify and ECDH.  Run it with and without the
+ * TINYCRYPT_AES_TTABLE, TINYCRYPT_SHA256_UNROLL and TINYCRYPT_ECC_UMAAL
+ * settings to compare.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CRYPTOTEST_TC_BENCHMARK)
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "tinycrypt/aes.h"
+#include "tinycrypt/sha256.h"
+/* For uECC_make_key_with_d() and uECC_sign_with_k(). */
+#define ENABLE_TESTS
+#include "tinycrypt/ecc.h"
+#include "tinycrypt/ecc_dh.h"
+#include "tinycrypt/ecc_dsa.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define TC_BENCH_CYCCNT     1
+#else
+#define TC_BENCH_CYCCNT     0
+#endif
+
+#define TC_BENCH_AES_ITER   1000
+#define TC_BENCH_SHA_ITER   1000
+#define TC_BENCH_ECC_ITER   3
+
+extern uint8_t aes_128_key[];
+extern uint8_t aes_128_input[];
+
+/* Fixed test keys and nonce; never use fixed values outside a benchmark. */
+static const unsigned int tc_bench_d[NUM_ECC_WORDS] = {
+    0x8bd9be13, 0x9f1a0e5f, 0x47b3c4b2, 0x012ddb5a,
+    0x1e6a4d27, 0xc1b8a0f3, 0x7e5c6f21, 0x3a9d82c4,
+};
+static uECC_word_t tc_bench_k[NUM_ECC_WORDS] = {
+    0x5e3f1c2a, 0x0b7d9e84, 0x66a1f3c9, 0x2d48b07e,
+    0xc3915fa2, 0x18e76d3b, 0x9af0245c, 0x4c2b8e17,
+};
+
+static uint32_t
+tc_bench_now(void)
+{
+#if TC_BENCH_CYCCNT
+    return DWT->CYCCNT;
+#else
+    return os_cputime_get32();
+#endif
+}
+
+static void
+tc_bench_report(const char *name, uint32_t elapsed, uint32_t iter)
+{
+    printf("%-16s %10"PRIu32" %s/op\n", name, elapsed / iter,
+           TC_BENCH_CYCCNT ? "cycles" : "cputime ticks");
+}
+
+void
+run_tc_benchmark(void)
+{
+    struct tc_aes_key_sched_struct aes;
+    struct tc_sha256_state_struct sha;
+    uint8_t private_key[NUM_ECC_BYTES];
+    uint8_t public_key[2 * NUM_ECC_BYTES];
+    uint8_t secret[NUM_ECC_BYTES];
+    uint8_t sig[2 * NUM_ECC_BYTES];
+    uint8_t digest[TC_SHA256_DIGEST_SIZE];
+    uint8_t block[TC_AES_BLOCK_SIZE];
+    unsigned int d[NUM_ECC_WORDS];
+    uECC_Curve curve = uECC_secp256r1();
+    uint32_t start;
+    int rc;
+    int i;
+
+#if TC_BENCH_CYCCNT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    printf("\n=== TINYCRYPT cost per operation ===\n");
+
+    tc_aes128_set_encrypt_key(&aes, aes_128_key);
+    start = tc_bench_now();
+    for (i = 0; i < TC_BENCH_AES_ITER; i++) {
+        tc_aes_encrypt(block, &aes_128_input[(i * TC_AES_BLOCK_SIZE) % 4096],
+                       &aes);
+    }
+    tc_bench_report("AES-128 block", tc_bench_now() - start,
+                    TC_BENCH_AES_ITER);
+
+    tc_sha256_init(&sha);
+    start = tc_bench_now();
+    for (i = 0; i < TC_BENCH_SHA_ITER; i++) {
+        tc_sha256_update(&sha, &aes_128_input[(i * 64) % 4096], 64);
+    }
+    tc_bench_report("SHA-256 block", tc_bench_now() - start,
+                    TC_BENCH_SHA_ITER);
+    tc_sha256_final(digest, &sha);
+
+    memcpy(d, tc_bench_d, sizeof(d));
+    rc = uECC_make_key_with_d(public_key, private_key, d, curve);
+    if (!rc) {
+        printf("P-256 key setup failed\n");
+        return;
+    }
+
+    start = tc_bench_now();
+    for (i = 0; i < TC_BENCH_ECC_ITER; i++) {
+        rc = uECC_sign_with_k(private_key, digest, sizeof(digest),
+                              tc_bench_k, sig, curve);
+    }
+    tc_bench_report("ECDSA sign", tc_bench_now() - start, TC_BENCH_ECC_ITER);
+    if (!rc) {
+        printf("ECDSA sign failed\n");
+        return;
+    }
+
+    start = tc_bench_now();
+    for (i = 0; i < TC_BENCH_ECC_ITER; i++) {
+        rc = uECC_verify(public_key, digest, sizeof(digest), sig, curve);
+    }
+    tc_bench_report("ECDSA verify", tc_bench_now() - start,
+                    TC_BENCH_ECC_ITER);
+    if (!rc) {
+        printf("ECDSA verify failed\n");
+    }
+
+    start = tc_bench_now();
+    for (i = 0; i < TC_BENCH_ECC_ITER; i++) {
+        rc = uECC_shared_secret(public_key, private_key, secret, curve);
+    }
+    tc_bench_report("ECDH", tc_bench_now() - start, TC_BENCH_ECC_ITER);
+    if (!rc) {
+        printf("ECDH failed\n");
+    }
+}
+
+#endif /* MYNEWT_VAL(CRYPTOTEST_TC_BENCHMARK) */
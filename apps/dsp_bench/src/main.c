@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "dsp/dsp.h"
+
+#define BENCH_ROUNDS        100
+#define BENCH_LEN           256
+#define BENCH_FIR_TAPS      32
+#define BENCH_FFT_LEN       256
+
+static q15_t bench_in[2 * BENCH_FFT_LEN];
+static q15_t bench_out[2 * BENCH_FFT_LEN];
+static q15_t bench_coeffs[BENCH_FIR_TAPS];
+static q15_t bench_fir_state[DSP_FIR_STATE_LEN(BENCH_FIR_TAPS, BENCH_LEN)];
+static q15_t bench_twiddle[DSP_CFFT_TWIDDLE_LEN(BENCH_FFT_LEN)];
+
+static struct dsp_fir_q15 bench_fir;
+static struct dsp_cfft_q15 bench_fft;
+
+typedef void bench_fn(void);
+
+static void
+bench_fir_scalar(void)
+{
+    dsp_fir_q15_scalar(&bench_fir, bench_in, bench_out, BENCH_LEN);
+}
+
+static void
+bench_fir_simd(void)
+{
+    dsp_fir_q15(&bench_fir, bench_in, bench_out, BENCH_LEN);
+}
+
+static void
+bench_rms_scalar(void)
+{
+    bench_out[0] = dsp_rms_q15_scalar(bench_in, BENCH_LEN);
+}
+
+static void
+bench_rms_simd(void)
+{
+    bench_out[0] = dsp_rms_q15(bench_in, BENCH_LEN);
+}
+
+static void
+bench_fft_scalar(void)
+{
+    memcpy(bench_out, bench_in, sizeof(bench_out));
+    dsp_cfft_q15_scalar(&bench_fft, bench_out);
+}
+
+static void
+bench_fft_simd(void)
+{
+    memcpy(bench_out, bench_in, sizeof(bench_out));
+    dsp_cfft_q15(&bench_fft, bench_out);
+}
+
+static uint32_t
+bench_run(bench_fn *fn)
+{
+    uint32_t start;
+    int i;
+
+    start = os_cputime_get32();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        fn();
+    }
+
+    return os_cputime_ticks_to_usecs(os_cputime_get32() - start) /
+           BENCH_ROUNDS;
+}
+
+static void
+bench_report(const char *name, bench_fn *scalar, bench_fn *simd)
+{
+    uint32_t t_scalar;
+    uint32_t t_simd;
+
+    t_scalar = bench_run(scalar);
+    t_simd = bench_run(simd);
+    console_printf("%-12s scalar %6lu us  default %6lu us\n", name,
+                   (unsigned long)t_scalar, (unsigned long)t_simd);
+}
+
+int
+mynewt_main(int argc, char **argv)
+{
+    uint32_t seed = 1;
+    int i;
+
+    sysinit();
+
+    for (i = 0; i < BENCH_FIR_TAPS; i++) {
+        bench_coeffs[i] = DSP_Q15(1.0 / BENCH_FIR_TAPS);
+    }
+    for (i = 0; i < 2 * BENCH_FFT_LEN; i++) {
+        seed = seed * 1103515245 + 12345;
+        bench_in[i] = (q15_t)(seed >> 16);
+    }
+    dsp_fir_q15_init(&bench_fir, bench_coeffs, BENCH_FIR_TAPS,
+                     bench_fir_state, BENCH_LEN);
+    dsp_cfft_q15_init(&bench_fft, BENCH_FFT_LEN, bench_twiddle);
+
+    console_printf("DSP kernels, SIMD %s, %d samples\n",
+                   DSP_HAS_SIMD ? "enabled" : "not available", BENCH_LEN);
+    bench_report("fir32", bench_fir_scalar, bench_fir_simd);
+    bench_report("rms", bench_rms_scalar, bench_rms_simd);
+    bench_report("cfft256", bench_fft_scalar, bench_fft_simd);
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+}
@@ -20,6 +20,8 @@
 #ifndef _FLASH_LOADER_H
 #define _FLASH_LOADER_H
 
+#include <stdint.h>
+
 /*
  * Flash loader state.
  */
@@ -35,6 +37,13 @@
 #define FL_CMD_VERIFY           4
 #define FL_CMD_LOAD_VERIFY      5
 #define FL_CMD_DUMP             6
+#define FL_CMD_LOAD_CRC         7   /* load, then compare CRC-32 of flash */
+#define FL_CMD_CRC              8   /* CRC-32 of a flash area */
+
+/*
+ * Command flags
+ */
+#define FL_F_LZ4                0x01    /* data is an LZ4 block */
 
 /*
  * Return codes
@@ -44,4 +53,27 @@
 #define FL_RC_VERIFY_ERR        3
 #define FL_RC_UNKNOWN_CMD_ERR   4
 #define FL_RC_ARG_ERR           5
+#define FL_RC_DATA_ERR          6
+
+/*
+ * With FLASH_LOADER_RTT, commands can also be sent as frames on the "fl"
+ * RTT down-buffer.  Load commands are followed by fl_rtt_req.amount bytes
+ * of data.  Every command is answered on the "fl" up-buffer with a
+ * fl_rtt_rsp; a successful dump is followed by the data.  Little endian.
+ */
+struct fl_rtt_req {
+    uint8_t cmd;
+    uint8_t flags;
+    uint16_t flash_id;
+    uint32_t addr;
+    uint32_t amount;
+    uint32_t crc;       /* expected CRC-32 of the data, for FL_CMD_LOAD_CRC */
+};
+
+struct fl_rtt_rsp {
+    uint8_t cmd;
+    uint8_t rc;
+    uint16_t reserved;
+    uint32_t crc;       /* result of FL_CMD_CRC */
+};
 #endif
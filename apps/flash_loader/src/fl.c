@@ -27,6 +27,13 @@
 #include <hal/hal_flash.h>
 #include <hal/hal_gpio.h>
 #include <hal/hal_watchdog.h>
+#include <crc/crc32.h>
+#if MYNEWT_VAL(FLASH_LOADER_LZ4)
+#include <lz4/lz4.h>
+#endif
+#if MYNEWT_VAL(FLASH_LOADER_RTT)
+#include <rtt/SEGGER_RTT.h>
+#endif
 
 #include "flash_loader/flash_loader.h"
 
@@ -43,28 +50,55 @@ volatile uint8_t *fl_cmd_data;
 volatile uint32_t fl_cmd_amount;
 volatile uint32_t fl_cmd_flash_id;
 volatile uint32_t fl_cmd_flash_addr;
+volatile uint32_t fl_cmd_flags;
+volatile uint32_t fl_cmd_crc;
 int fl_cmd_data_sz = MYNEWT_VAL(FLASH_LOADER_DL_SZ) / 2;
 
 /*
- * Load/verify use doble buffering scheme. Programmer can write the
- * data for next flash operation while app is executing previous command.
+ * One command, as given by the programmer.
  */
-struct {
-    uint8_t *buf;
-    uint32_t amount;
+struct fl_req {
+    int cmd;
+    uint32_t flags;
     uint32_t flash_id;
     uint32_t addr;
-} fl_write;
+    uint32_t amount;
+    uint32_t crc;
+    uint8_t *buf;
+};
+
+/*
+ * Load/verify use doble buffering scheme. Programmer can write the
+ * data for next flash operation while app is executing previous command.
+ */
+struct fl_req fl_write;
 
 uint8_t fl_verify_buf[MYNEWT_VAL(FLASH_LOADER_VERIFY_BUF_SZ)];
 
+#if MYNEWT_VAL(FLASH_LOADER_LZ4)
+/* Compressed data is expanded here before it is programmed. */
+static uint8_t fl_unpack_buf[MYNEWT_VAL(FLASH_LOADER_DL_SZ) / 2];
+#endif
+
+#if MYNEWT_VAL(FLASH_LOADER_RTT)
+static uint8_t fl_rtt_down_buf[MYNEWT_VAL(FLASH_LOADER_RTT_BUF_SZ)];
+static uint8_t fl_rtt_up_buf[MYNEWT_VAL(FLASH_LOADER_RTT_UP_BUF_SZ)];
+static int fl_rtt_down;
+static int fl_rtt_up;
+#endif
+
+static void blink_led(void);
+
 static void
 fl_rotate_databuf(void)
 {
+    fl_write.cmd = fl_cmd;
+    fl_write.flags = fl_cmd_flags;
     fl_write.buf = (uint8_t *)fl_cmd_data;
     fl_write.amount = fl_cmd_amount;
     fl_write.flash_id = fl_cmd_flash_id;
     fl_write.addr = fl_cmd_flash_addr;
+    fl_write.crc = fl_cmd_crc;
 
     if (fl_cmd_data == fl_data) {
         fl_cmd_data = &fl_data[fl_cmd_data_sz];
@@ -74,16 +108,52 @@ fl_rotate_databuf(void)
     fl_cmd_amount = 0;
 }
 
+/*
+ * Commands which carry data to program or compare with.
+ */
 static int
-fl_load_cmd(void)
+fl_cmd_has_data(int cmd)
 {
-    int rc;
+    return cmd == FL_CMD_LOAD || cmd == FL_CMD_VERIFY ||
+           cmd == FL_CMD_LOAD_VERIFY || cmd == FL_CMD_LOAD_CRC;
+}
 
-    if (fl_write.amount > fl_cmd_data_sz) {
+/*
+ * Checks the size of the data, and expands it if it is compressed.
+ */
+static int
+fl_unpack(struct fl_req *req)
+{
+#if MYNEWT_VAL(FLASH_LOADER_LZ4)
+    int len;
+#endif
+
+    if (req->amount > fl_cmd_data_sz) {
         return FL_RC_ARG_ERR;
     }
-    rc = hal_flash_write(fl_write.flash_id, fl_write.addr,
-                         fl_write.buf, fl_write.amount);
+    if (!(req->flags & FL_F_LZ4)) {
+        return FL_RC_OK;
+    }
+#if MYNEWT_VAL(FLASH_LOADER_LZ4)
+    len = lz4_decompress(req->buf, req->amount, fl_unpack_buf,
+                         sizeof(fl_unpack_buf));
+    if (len < 0) {
+        return FL_RC_DATA_ERR;
+    }
+    req->buf = fl_unpack_buf;
+    req->amount = len;
+    return FL_RC_OK;
+#else
+    return FL_RC_ARG_ERR;
+#endif
+}
+
+static int
+fl_load_cmd(const struct fl_req *req)
+{
+    int rc;
+
+    rc = hal_flash_write(req->flash_id, req->addr, req->buf, req->amount);
     if (rc) {
         return FL_RC_FLASH_ERR;
     }
@@ -91,11 +161,11 @@ fl_load_cmd(void)
 }
 
 static int
-fl_erase_cmd(void)
+fl_erase_cmd(const struct fl_req *req)
 {
     int rc;
 
-    rc = hal_flash_erase(fl_cmd_flash_id, fl_cmd_flash_addr, fl_cmd_amount);
+    rc = hal_flash_erase(req->flash_id, req->addr, req->amount);
     if (rc) {
         return FL_RC_FLASH_ERR;
     }
@@ -103,45 +173,204 @@ fl_erase_cmd(void)
 }
 
 static int
-fl_verify_cmd(void)
+fl_verify_cmd(const struct fl_req *req)
 {
     int rc;
     uint32_t off;
     int blen;
 
-    if (fl_write.amount > fl_cmd_data_sz) {
-        return FL_RC_ARG_ERR;
-    }
-    for (off = 0; off < fl_write.amount; off += blen) {
-        blen = fl_write.amount - off;
+    for (off = 0; off < req->amount; off += blen) {
+        blen = req->amount - off;
         if (blen > sizeof(fl_verify_buf)) {
             blen = sizeof(fl_verify_buf);
         }
-        rc = hal_flash_read(fl_write.flash_id, fl_write.addr + off,
+        rc = hal_flash_read(req->flash_id, req->addr + off,
                             fl_verify_buf, blen);
         if (rc) {
             return FL_RC_FLASH_ERR;
         }
-        if (memcmp(fl_verify_buf, fl_write.buf + off, blen)) {
+        if (memcmp(fl_verify_buf, req->buf + off, blen)) {
             return FL_RC_VERIFY_ERR;
         }
     }
     return FL_RC_OK;
 }
 
+/*
+ * CRC-32 of a flash area, placed in req->crc.  Only the result needs to
+ * travel back to the programmer, not the data.
+ */
+static int
+fl_crc_cmd(struct fl_req *req)
+{
+    int rc;
+    uint32_t off;
+    uint32_t crc;
+    int blen;
+
+    crc = crc32_init();
+    for (off = 0; off < req->amount; off += blen) {
+        blen = req->amount - off;
+        if (blen > sizeof(fl_verify_buf)) {
+            blen = sizeof(fl_verify_buf);
+        }
+        rc = hal_flash_read(req->flash_id, req->addr + off,
+                            fl_verify_buf, blen);
+        if (rc) {
+            return FL_RC_FLASH_ERR;
+        }
+        crc = crc32_calc(crc, fl_verify_buf, blen);
+    }
+    req->crc = crc;
+    return FL_RC_OK;
+}
+
 static int
-fl_dump_cmd(void)
+fl_dump_cmd(const struct fl_req *req)
 {
     int rc;
 
-    rc = hal_flash_read(fl_cmd_flash_id, fl_cmd_flash_addr, (void *)fl_cmd_data,
-                        fl_cmd_amount);
+    rc = hal_flash_read(req->flash_id, req->addr, req->buf, req->amount);
     if (rc) {
         return FL_RC_FLASH_ERR;
     }
     return FL_RC_OK;
 }
 
+static int
+fl_exec(struct fl_req *req)
+{
+    uint32_t crc;
+    int rc;
+
+    if (fl_cmd_has_data(req->cmd)) {
+        rc = fl_unpack(req);
+        if (rc == FL_RC_OK && req->cmd != FL_CMD_VERIFY) {
+            rc = fl_load_cmd(req);
+        }
+        if (rc == FL_RC_OK &&
+            (req->cmd == FL_CMD_VERIFY || req->cmd == FL_CMD_LOAD_VERIFY)) {
+            rc = fl_verify_cmd(req);
+        }
+        if (rc == FL_RC_OK && req->cmd == FL_CMD_LOAD_CRC) {
+            crc = req->crc;
+            rc = fl_crc_cmd(req);
+            if (rc == FL_RC_OK && req->crc != crc) {
+                rc = FL_RC_VERIFY_ERR;
+            }
+        }
+        return rc;
+    }
+
+    switch (req->cmd) {
+    case FL_CMD_PING:
+        return FL_RC_OK;
+    case FL_CMD_ERASE:
+        return fl_erase_cmd(req);
+    case FL_CMD_DUMP:
+        return fl_dump_cmd(req);
+    case FL_CMD_CRC:
+        return fl_crc_cmd(req);
+    default:
+        return FL_RC_UNKNOWN_CMD_ERR;
+    }
+}
+
+#if MYNEWT_VAL(FLASH_LOADER_RTT)
+static void
+fl_rtt_init(void)
+{
+    fl_rtt_down = SEGGER_RTT_AllocDownBuffer("fl", fl_rtt_down_buf,
+                                             sizeof(fl_rtt_down_buf),
+                                             SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    assert(fl_rtt_down >= 0);
+    fl_rtt_up = SEGGER_RTT_AllocUpBuffer("fl", fl_rtt_up_buf,
+                                         sizeof(fl_rtt_up_buf),
+                                         SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
+    assert(fl_rtt_up >= 0);
+}
+
+static void
+fl_rtt_read(void *buf, uint32_t len)
+{
+    uint8_t *p;
+    unsigned cnt;
+
+    p = buf;
+    while (len > 0) {
+        cnt = SEGGER_RTT_Read(fl_rtt_down, p, len);
+        if (cnt == 0) {
+            blink_led();
+        }
+        p += cnt;
+        len -= cnt;
+    }
+}
+
+/*
+ * Executes a command framed on the RTT down-buffer.  The down-buffer is the
+ * second half of the double buffer here: the programmer keeps filling it
+ * while the previous command is being executed.
+ *
+ * Returns 1 if a command was executed.
+ */
+static int
+fl_rtt_poll(void)
+{
+    struct fl_rtt_req hdr;
+    struct fl_rtt_rsp rsp;
+    struct fl_req req;
+    uint32_t off;
+    uint32_t len;
+    int rc;
+
+    if (!SEGGER_RTT_HasData(fl_rtt_down)) {
+        return 0;
+    }
+    fl_state = FL_EXECUTING;
+
+    fl_rtt_read(&hdr, sizeof(hdr));
+    req.cmd = hdr.cmd;
+    req.flags = hdr.flags;
+    req.flash_id = hdr.flash_id;
+    req.addr = hdr.addr;
+    req.amount = hdr.amount;
+    req.crc = hdr.crc;
+    req.buf = fl_data;
+
+    if (fl_cmd_has_data(req.cmd) && req.amount > fl_cmd_data_sz) {
+        /* Drain the data to stay in step with the programmer. */
+        for (off = 0; off < req.amount; off += len) {
+            len = min(req.amount - off, MYNEWT_VAL(FLASH_LOADER_DL_SZ));
+            fl_rtt_read(fl_data, len);
+        }
+        rc = FL_RC_ARG_ERR;
+    } else if (req.cmd == FL_CMD_DUMP && req.amount > fl_cmd_data_sz) {
+        rc = FL_RC_ARG_ERR;
+    } else {
+        if (fl_cmd_has_data(req.cmd)) {
+            fl_rtt_read(fl_data, req.amount);
+        }
+        rc = fl_exec(&req);
+    }
+
+#if MYNEWT_VAL(WATCHDOG_INTERVAL) > 0
+    hal_watchdog_tickle();
+#endif
+
+    memset(&rsp, 0, sizeof(rsp));
+    rsp.cmd = hdr.cmd;
+    rsp.rc = rc;
+    rsp.crc = req.crc;
+    SEGGER_RTT_Write(fl_rtt_up, &rsp, sizeof(rsp));
+    if (req.cmd == FL_CMD_DUMP && rc == FL_RC_OK) {
+        SEGGER_RTT_Write(fl_rtt_up, fl_data, req.amount);
+    }
+
+    return 1;
+}
+#endif
+
 /*
  * Blinks led if running (and LED is defined).
  */
@@ -168,6 +397,7 @@ blink_led(void)
 int
 mynewt_main(int argc, char **argv)
 {
+    struct fl_req req;
     int rc;
 
     hal_bsp_init();
@@ -180,48 +410,38 @@ mynewt_main(int argc, char **argv)
     fl_data = malloc(MYNEWT_VAL(FLASH_LOADER_DL_SZ));
     assert(fl_data);
     fl_cmd_data  = fl_data;
+#if MYNEWT_VAL(FLASH_LOADER_RTT)
+    fl_rtt_init();
+#endif
     while (1) {
         if (!fl_cmd) {
+#if MYNEWT_VAL(FLASH_LOADER_RTT)
+            if (fl_rtt_poll()) {
+                continue;
+            }
+#endif
             fl_state = FL_WAITING;
             blink_led();
             continue;
         }
         fl_state = FL_EXECUTING;
-        switch (fl_cmd) {
-        case FL_CMD_PING:
-            fl_cmd = 0;
-            rc = FL_RC_OK;
-            break;
-        case FL_CMD_LOAD:
+        if (fl_cmd_has_data(fl_cmd)) {
             fl_rotate_databuf();
             fl_cmd = 0;
-            rc = fl_load_cmd();
-            break;
-        case FL_CMD_ERASE:
-            fl_cmd = 0;
-            rc = fl_erase_cmd();
-            break;
-        case FL_CMD_VERIFY:
-            fl_rotate_databuf();
+            rc = fl_exec(&fl_write);
+        } else {
+            req.cmd = fl_cmd;
+            req.flags = fl_cmd_flags;
+            req.flash_id = fl_cmd_flash_id;
+            req.addr = fl_cmd_flash_addr;
+            req.amount = fl_cmd_amount;
+            req.crc = fl_cmd_crc;
+            req.buf = (uint8_t *)fl_cmd_data;
             fl_cmd = 0;
-            rc = fl_verify_cmd();
-            break;
-        case FL_CMD_LOAD_VERIFY:
-            fl_rotate_databuf();
-            fl_cmd = 0;
-            rc = fl_load_cmd();
-            if (rc == FL_RC_OK) {
-                rc = fl_verify_cmd();
+            rc = fl_exec(&req);
+            if (req.cmd == FL_CMD_CRC) {
+                fl_cmd_crc = req.crc;
             }
-            break;
-        case FL_CMD_DUMP:
-            fl_cmd = 0;
-            rc = fl_dump_cmd();
-            break;
-        default:
-            fl_cmd = 0;
-            rc = FL_RC_UNKNOWN_CMD_ERR;
-            break;
         }
 #if MYNEWT_VAL(WATCHDOG_INTERVAL) > 0
         hal_watchdog_tickle();
@@ -0,0 +1,641 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Runs a fixed set of workloads on the native BSP and prints one line per
+ * workload: operations done, payload bytes, a hash of the payload and the
+ * number of simulated flash reads, writes and erases (count/bytes).  All
+ * inputs are deterministic, so two builds can be compared by diffing the
+ * output; a change in flash traffic or in the produced data shows up as a
+ * changed line.
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "os/endian.h"
+#include "mcu/mcu_sim.h"
+#include "sysflash/sysflash.h"
+#include "flash_map/flash_map.h"
+#include "fcb/fcb.h"
+#include "fs/fs.h"
+#include "log/log.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_buf_reader.h"
+#include "oic/port/oc_connectivity.h"
+#include "oic/port/mynewt/config.h"
+#include "oic/port/mynewt/transport.h"
+#include "oic/oc_buffer.h"
+#include "oic/messaging/coap/coap.h"
+
+#define PERF_FCB_RECORDS        600
+#define PERF_FCB_RECORD_LEN     32
+#define PERF_FCB_MAX_SECTORS    16
+
+#define PERF_FS_FILE            "/perf.bin"
+#define PERF_FS_CHUNKS          64
+#define PERF_FS_WRITE_LEN       128
+#define PERF_FS_READ_LEN        100
+
+#define PERF_LOG_ENTRIES        400
+#define PERF_LOG_BODY_LEN       48
+
+#define PERF_CBOR_RECORDS       1000
+#define PERF_CBOR_BUF_LEN       128
+
+#define PERF_COAP_REQUESTS      200
+#define PERF_COAP_PAYLOAD_LEN   32
+#define PERF_COAP_PATH          "perf/res"
+#define PERF_COAP_QUERY         "if=oic.if.baseline"
+
+#define PERF_HASH_INIT          2166136261UL
+#define PERF_HASH_PRIME         16777619UL
+
+struct perf_result {
+    uint32_t ops;
+    uint32_t bytes;
+    uint32_t hash;
+};
+
+static int perf_failures;
+#if MYNEWT_VAL(NATIVE_PERF_TIME)
+static int64_t perf_start;
+#endif
+
+static uint8_t perf_buf[PERF_FS_WRITE_LEN];
+
+static struct flash_area perf_sectors[PERF_FCB_MAX_SECTORS];
+static struct fcb perf_fcb;
+static struct fcb_log perf_log_fcb;
+static struct log perf_log;
+
+/* FNV-1a; only used to notice that the produced data changed. */
+static void
+perf_hash(struct perf_result *res, const void *data, uint32_t len)
+{
+    const uint8_t *u8;
+    uint32_t i;
+
+    u8 = data;
+    for (i = 0; i < len; i++) {
+        res->hash = (res->hash ^ u8[i]) * PERF_HASH_PRIME;
+    }
+}
+
+static void
+perf_hash_mbuf(struct perf_result *res, const struct os_mbuf *om)
+{
+    while (om != NULL) {
+        perf_hash(res, om->om_data, om->om_len);
+        om = SLIST_NEXT(om, om_next);
+    }
+}
+
+static void
+perf_fill(uint8_t *buf, int len, uint32_t seed)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed * 31 + i);
+    }
+}
+
+static void
+perf_begin(struct perf_result *res)
+{
+    memset(res, 0, sizeof(*res));
+    res->hash = PERF_HASH_INIT;
+    memset(&native_flash_stats, 0, sizeof(native_flash_stats));
+#if MYNEWT_VAL(NATIVE_PERF_TIME)
+    perf_start = os_get_uptime_usec();
+#endif
+}
+
+static void
+perf_report(const char *name, int rc, const struct perf_result *res)
+{
+    const struct native_flash_stats *nfs;
+
+    if (rc != 0) {
+        printf("%-12s FAILED rc=%d\n", name, rc);
+        perf_failures++;
+        return;
+    }
+
+    nfs = &native_flash_stats;
+    printf("%-12s ops=%" PRIu32 " bytes=%" PRIu32 " hash=%08" PRIx32
+           " flash_rd=%" PRIu32 "/%" PRIu32
+           " flash_wr=%" PRIu32 "/%" PRIu32
+           " flash_er=%" PRIu32 "/%" PRIu32,
+           name, res->ops, res->bytes, res->hash,
+           nfs->nfs_reads, nfs->nfs_read_bytes,
+           nfs->nfs_writes, nfs->nfs_write_bytes,
+           nfs->nfs_erases, nfs->nfs_erase_bytes);
+#if MYNEWT_VAL(NATIVE_PERF_TIME)
+    printf(" usec=%" PRId64, os_get_uptime_usec() - perf_start);
+#endif
+    printf("\n");
+}
+
+/*
+ * Sets up an empty fcb over the reboot log area; the fcb and log workloads
+ * take turns using it.
+ */
+static int
+perf_fcb_setup(struct fcb *fcb)
+{
+    const struct flash_area *fa;
+    int cnt;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_REBOOT_LOG, &fa);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    flash_area_close(fa);
+    if (rc != 0) {
+        return rc;
+    }
+
+    cnt = PERF_FCB_MAX_SECTORS;
+    rc = flash_area_to_sectors(FLASH_AREA_REBOOT_LOG, &cnt, perf_sectors);
+    if (rc != 0) {
+        return rc;
+    }
+
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = 0x50455246;
+    fcb->f_version = 1;
+    fcb->f_sector_cnt = cnt;
+    fcb->f_sectors = perf_sectors;
+
+    return fcb_init(fcb);
+}
+
+static int
+perf_fcb_append(struct perf_result *res)
+{
+    struct fcb_entry loc;
+    uint32_t i;
+    int rc;
+
+    for (i = 0; i < PERF_FCB_RECORDS; i++) {
+        perf_fill(perf_buf, PERF_FCB_RECORD_LEN, i);
+
+        rc = fcb_append(&perf_fcb, PERF_FCB_RECORD_LEN, &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            rc = fcb_rotate(&perf_fcb);
+            if (rc == 0) {
+                rc = fcb_append(&perf_fcb, PERF_FCB_RECORD_LEN, &loc);
+            }
+        }
+        if (rc != 0) {
+            return rc;
+        }
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, perf_buf,
+                              PERF_FCB_RECORD_LEN);
+        if (rc != 0) {
+            return rc;
+        }
+        rc = fcb_append_finish(&perf_fcb, &loc);
+        if (rc != 0) {
+            return rc;
+        }
+
+        perf_hash(res, perf_buf, PERF_FCB_RECORD_LEN);
+        res->ops++;
+        res->bytes += PERF_FCB_RECORD_LEN;
+    }
+
+    return 0;
+}
+
+static int
+perf_fcb_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    struct perf_result *res;
+    int rc;
+
+    res = arg;
+    if (loc->fe_data_len > sizeof(perf_buf)) {
+        return FCB_ERR_ARGS;
+    }
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, perf_buf,
+                         loc->fe_data_len);
+    if (rc != 0) {
+        return FCB_ERR_FLASH;
+    }
+
+    perf_hash(res, perf_buf, loc->fe_data_len);
+    res->ops++;
+    res->bytes += loc->fe_data_len;
+
+    return 0;
+}
+
+static void
+perf_run_fcb(void)
+{
+    struct perf_result res;
+    int rc;
+
+    rc = perf_fcb_setup(&perf_fcb);
+    if (rc != 0) {
+        perf_report("fcb_append", rc, NULL);
+        return;
+    }
+
+    perf_begin(&res);
+    rc = perf_fcb_append(&res);
+    perf_report("fcb_append", rc, &res);
+    if (rc != 0) {
+        return;
+    }
+
+    perf_begin(&res);
+    rc = fcb_walk(&perf_fcb, NULL, perf_fcb_walk_cb, &res);
+    perf_report("fcb_walk", rc, &res);
+}
+
+static int
+perf_fs_write(struct perf_result *res)
+{
+    struct fs_file *file;
+    uint32_t i;
+    int rc;
+
+    rc = fs_open(PERF_FS_FILE, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+    if (rc != 0) {
+        return rc;
+    }
+
+    for (i = 0; i < PERF_FS_CHUNKS; i++) {
+        perf_fill(perf_buf, PERF_FS_WRITE_LEN, i);
+        rc = fs_write(file, perf_buf, PERF_FS_WRITE_LEN);
+        if (rc != 0) {
+            break;
+        }
+        perf_hash(res, perf_buf, PERF_FS_WRITE_LEN);
+        res->ops++;
+        res->bytes += PERF_FS_WRITE_LEN;
+    }
+
+    if (rc == 0) {
+        rc = fs_close(file);
+    } else {
+        fs_close(file);
+    }
+    return rc;
+}
+
+/* Reads in a size which does not divide the write size. */
+static int
+perf_fs_read(struct perf_result *res)
+{
+    struct fs_file *file;
+    uint32_t len;
+    int rc;
+
+    rc = fs_open(PERF_FS_FILE, FS_ACCESS_READ, &file);
+    if (rc != 0) {
+        return rc;
+    }
+
+    while (1) {
+        rc = fs_read(file, PERF_FS_READ_LEN, perf_buf, &len);
+        if (rc != 0 || len == 0) {
+            break;
+        }
+        perf_hash(res, perf_buf, len);
+        res->ops++;
+        res->bytes += len;
+    }
+
+    fs_close(file);
+    return rc;
+}
+
+static void
+perf_run_fs(void)
+{
+    struct perf_result res;
+    int rc;
+
+    perf_begin(&res);
+    rc = perf_fs_write(&res);
+    perf_report("fs_write", rc, &res);
+    if (rc != 0) {
+        return;
+    }
+
+    perf_begin(&res);
+    rc = perf_fs_read(&res);
+    perf_report("fs_read", rc, &res);
+
+    perf_begin(&res);
+    rc = fs_unlink(PERF_FS_FILE);
+    perf_report("fs_unlink", rc, &res);
+}
+
+static void
+perf_run_log(void)
+{
+    struct perf_result res;
+    char body[PERF_LOG_BODY_LEN];
+    uint32_t i;
+    int rc;
+
+    rc = perf_fcb_setup(&perf_log_fcb.fl_fcb);
+    if (rc == 0) {
+        rc = log_register("perf", &perf_log, &log_fcb_handler, &perf_log_fcb,
+                          LOG_LEVEL_DEBUG);
+    }
+    if (rc != 0) {
+        perf_report("log_append", rc, NULL);
+        return;
+    }
+
+    perf_begin(&res);
+    for (i = 0; i < PERF_LOG_ENTRIES; i++) {
+        memset(body, '.', sizeof(body));
+        snprintf(body, sizeof(body), "perf log entry %05" PRIu32, i);
+
+        rc = log_append_body(&perf_log, LOG_MODULE_DEFAULT, LOG_LEVEL_INFO,
+                             LOG_ETYPE_STRING, body, sizeof(body));
+        if (rc != 0) {
+            break;
+        }
+        perf_hash(&res, body, sizeof(body));
+        res.ops++;
+        res.bytes += sizeof(body);
+    }
+    perf_report("log_append", rc, &res);
+}
+
+static int
+perf_cbor_encode(uint8_t *buf, uint32_t seq, size_t *out_len)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder enc;
+    CborEncoder map;
+    CborEncoder arr;
+    int rc;
+
+    cbor_buf_writer_init(&writer, buf, PERF_CBOR_BUF_LEN);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+
+    rc = cbor_encoder_create_map(&enc, &map, 3);
+    rc |= cbor_encode_text_stringz(&map, "seq");
+    rc |= cbor_encode_uint(&map, seq);
+    rc |= cbor_encode_text_stringz(&map, "name");
+    rc |= cbor_encode_text_stringz(&map, "native_perf");
+    rc |= cbor_encode_text_stringz(&map, "vals");
+    rc |= cbor_encoder_create_array(&map, &arr, 4);
+    rc |= cbor_encode_int(&arr, seq);
+    rc |= cbor_encode_int(&arr, (int64_t)seq * 1000);
+    rc |= cbor_encode_int(&arr, -(int64_t)seq);
+    rc |= cbor_encode_int(&arr, (int64_t)seq << 20);
+    rc |= cbor_encoder_close_container(&map, &arr);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    if (rc != 0) {
+        return rc;
+    }
+
+    *out_len = cbor_buf_writer_buffer_size(&writer, buf);
+    return 0;
+}
+
+static int
+perf_cbor_decode(const uint8_t *buf, size_t len, uint32_t seq)
+{
+    struct cbor_buf_reader reader;
+    CborParser parser;
+    CborValue value;
+    CborValue elem;
+    CborValue item;
+    int64_t val;
+    int cnt;
+    int rc;
+
+    cbor_buf_reader_init(&reader, buf, len);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &value);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = cbor_value_map_find_value(&value, "seq", &elem);
+    if (rc == 0) {
+        rc = cbor_value_get_int64(&elem, &val);
+    }
+    if (rc != 0 || val != seq) {
+        return SYS_EINVAL;
+    }
+
+    rc = cbor_value_map_find_value(&value, "vals", &elem);
+    if (rc == 0) {
+        rc = cbor_value_enter_container(&elem, &item);
+    }
+    for (cnt = 0; rc == 0 && !cbor_value_at_end(&item); cnt++) {
+        rc = cbor_value_get_int64(&item, &val);
+        if (rc == 0) {
+            rc = cbor_value_advance(&item);
+        }
+    }
+    if (rc != 0 || cnt != 4) {
+        return SYS_EINVAL;
+    }
+
+    return 0;
+}
+
+static void
+perf_run_cbor(void)
+{
+    static uint8_t bufs[2][PERF_CBOR_BUF_LEN];
+    struct perf_result enc_res;
+    struct perf_result dec_res;
+    size_t len;
+    uint32_t i;
+    int rc;
+
+    /*
+     * Encode and decode are interleaved; flash counts are zero for both so
+     * the two results are only kept apart.
+     */
+    perf_begin(&enc_res);
+    perf_begin(&dec_res);
+    rc = 0;
+    for (i = 0; i < PERF_CBOR_RECORDS; i++) {
+        rc = perf_cbor_encode(bufs[i & 1], i, &len);
+        if (rc != 0) {
+            perf_report("cbor_encode", rc, NULL);
+            return;
+        }
+        perf_hash(&enc_res, bufs[i & 1], len);
+        enc_res.ops++;
+        enc_res.bytes += len;
+
+        rc = perf_cbor_decode(bufs[i & 1], len, i);
+        if (rc != 0) {
+            break;
+        }
+        dec_res.ops++;
+        dec_res.bytes += len;
+    }
+    perf_report("cbor_encode", 0, &enc_res);
+    perf_report("cbor_decode", rc, &dec_res);
+}
+
+/*
+ * CoAP messages are built on a loopback transport which is never used to
+ * send anything; it only tells the CoAP layer to use UDP style headers.
+ */
+static uint8_t
+perf_coap_ep_size(const struct oc_endpoint *oe)
+{
+    return sizeof(struct oc_endpoint_plain);
+}
+
+static const struct oc_transport perf_coap_transport = {
+    .ot_flags = 0,
+    .ot_ep_size = perf_coap_ep_size,
+};
+
+static int
+perf_coap_request(struct perf_result *res, struct oc_endpoint *oe,
+                  struct os_mbuf *payload, uint16_t mid)
+{
+    static coap_packet_t pkt;
+    static struct coap_packet_rx rx;
+    char path[sizeof(PERF_COAP_PATH)];
+    struct os_mbuf *m;
+    uint8_t token[2];
+    int rc;
+
+    /* Client side: serialize the request. */
+    m = oc_allocate_mbuf(oe);
+    if (m == NULL) {
+        return SYS_ENOMEM;
+    }
+    put_le16(token, mid);
+    coap_init_message(&pkt, COAP_TYPE_CON, COAP_GET, mid);
+    coap_set_token(&pkt, token, sizeof(token));
+    coap_set_header_uri_path(&pkt, PERF_COAP_PATH);
+    coap_set_header_uri_query(&pkt, PERF_COAP_QUERY);
+    coap_set_header_accept(&pkt, APPLICATION_CBOR);
+    if (coap_serialize_message(&pkt, m)) {
+        os_mbuf_free_chain(m);
+        return SYS_ENOMEM;
+    }
+    perf_hash_mbuf(res, m);
+    res->bytes += OS_MBUF_PKTLEN(m);
+
+    /* Server side: parse it and check the request line. */
+    rc = coap_parse_message(&rx, &m);
+    if (rc == NO_ERROR) {
+        if (rx.code != COAP_GET || rx.mid != mid ||
+            coap_get_header_uri_path(&rx, path, sizeof(path) - 1) !=
+              sizeof(path) - 1 ||
+            memcmp(path, PERF_COAP_PATH, sizeof(path) - 1)) {
+            rc = SYS_EINVAL;
+        }
+    }
+    os_mbuf_free_chain(m);
+    if (rc != NO_ERROR) {
+        return rc;
+    }
+
+    /* And serialize the response, sharing the payload. */
+    m = oc_allocate_mbuf(oe);
+    if (m == NULL) {
+        return SYS_ENOMEM;
+    }
+    coap_init_message(&pkt, COAP_TYPE_ACK, CONTENT_2_05, mid);
+    coap_set_token(&pkt, token, sizeof(token));
+    coap_set_header_content_format(&pkt, APPLICATION_CBOR);
+    if (coap_set_payload(&pkt, payload, PERF_COAP_PAYLOAD_LEN) < 0 ||
+        coap_serialize_message(&pkt, m)) {
+        os_mbuf_free_chain(m);
+        return SYS_ENOMEM;
+    }
+    perf_hash_mbuf(res, m);
+    res->bytes += OS_MBUF_PKTLEN(m);
+    os_mbuf_free_chain(m);
+
+    res->ops++;
+    return 0;
+}
+
+static void
+perf_run_coap(void)
+{
+    struct oc_endpoint_plain ep;
+    struct perf_result res;
+    struct os_mbuf *payload;
+    uint16_t i;
+    int8_t id;
+    int rc;
+
+    id = oc_transport_lookup(&perf_coap_transport);
+    if (id < 0) {
+        id = oc_transport_register(&perf_coap_transport);
+    }
+    payload = os_msys_get_pkthdr(PERF_COAP_PAYLOAD_LEN, 0);
+    if (id < 0 || payload == NULL) {
+        if (payload != NULL) {
+            os_mbuf_free_chain(payload);
+        }
+        perf_report("coap_req", SYS_ENOMEM, NULL);
+        return;
+    }
+    perf_fill(perf_buf, PERF_COAP_PAYLOAD_LEN, 0);
+    rc = os_mbuf_append(payload, perf_buf, PERF_COAP_PAYLOAD_LEN);
+
+    memset(&ep, 0, sizeof(ep));
+    ep.ep.oe_type = id;
+
+    perf_begin(&res);
+    for (i = 0; rc == 0 && i < PERF_COAP_REQUESTS; i++) {
+        rc = perf_coap_request(&res, (struct oc_endpoint *)&ep, payload, i);
+    }
+    perf_report("coap_req", rc, &res);
+
+    os_mbuf_free_chain(payload);
+}
+
+int
+mynewt_main(int argc, char **argv)
+{
+    sysinit();
+
+    perf_run_fcb();
+    perf_run_fs();
+    perf_run_log();
+    perf_run_cbor();
+    perf_run_coap();
+
+    exit(perf_failures ? 1 : 0);
+}
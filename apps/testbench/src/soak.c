@@ -0,0 +1,621 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * soak - load generator for soak testing a configuration.
+ *
+ * Each load task wakes up every TESTBENCH_SOAK_PERIOD_MS and catches up
+ * with its configured rates: it posts timestamped events to the sink task,
+ * allocates and frees msys mbufs, appends to a RAM log and writes and reads
+ * back a flash area.  A callout samples CPU load, event queue depth and free
+ * msys blocks, and every TESTBENCH_SOAK_REPORT_SECS writes a summary to the
+ * "soak" log, where it can be read with log mgmt.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(TESTBENCH_SOAK)
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include "os/os_cputime.h"
+#include "flash_map/flash_map.h"
+#include "log/log.h"
+
+#include "soak.h"
+
+#define SOAK_NTASKS         MYNEWT_VAL(TESTBENCH_SOAK_TASKS)
+#define SOAK_NEVS           MYNEWT_VAL(TESTBENCH_SOAK_EVENTS)
+#define SOAK_STACK_SIZE     OS_STACK_ALIGN(MYNEWT_VAL(TESTBENCH_SOAK_STACK_SIZE))
+#define SOAK_FLASH_AREA     MYNEWT_VAL(TESTBENCH_SOAK_FLASH_AREA)
+
+/* Work done in one period is capped so a stalled task does not burst. */
+#define SOAK_BURST_MAX      32
+
+#define SOAK_FLASH_CHUNK    64
+#define SOAK_LOG_BODY_LEN   32
+
+struct soak_ev {
+    struct os_event se_ev;
+    uint32_t se_ts;
+    uint8_t se_busy;
+};
+
+struct soak_gen {
+    struct os_task sg_task;
+    struct os_sem sg_start;
+    uint8_t sg_idx;
+    struct soak_ev sg_evs[SOAK_NEVS];
+
+    /* Written only by this task. */
+    uint32_t sg_ev_sent;
+    uint32_t sg_ev_drop;
+    uint32_t sg_mbuf_ops;
+    uint32_t sg_mbuf_fail;
+    uint32_t sg_log_ops;
+    uint32_t sg_log_fail;
+    uint32_t sg_flash_ops;
+    uint32_t sg_flash_fail;
+};
+
+static struct soak_gen soak_gens[SOAK_NTASKS];
+static os_stack_t soak_gen_stacks[SOAK_NTASKS][SOAK_STACK_SIZE]
+    __attribute__((aligned(OS_STACK_ALIGNMENT)));
+
+static struct os_task soak_sink_task;
+OS_TASK_STACK_DEFINE(soak_sink_stack, SOAK_STACK_SIZE);
+static struct os_eventq soak_evq;
+
+static struct soak_cfg soak_cfg;
+static volatile uint32_t soak_gen_id;
+static volatile bool soak_on;
+static os_time_t soak_start_time;
+
+/* Written by the sink task. */
+static uint32_t soak_ev_done;
+static uint32_t soak_lat_max;
+static uint32_t soak_lat_hist[SOAK_LAT_BUCKETS];
+static volatile uint16_t soak_evq_depth;
+static uint16_t soak_evq_max;
+
+/* Written by the sampler. */
+static struct os_callout soak_sample_co;
+static struct os_task *soak_idle_task;
+static os_time_t soak_sample_time;
+static os_time_t soak_sample_idle;
+static uint16_t soak_msys_free;
+static uint16_t soak_msys_min;
+static uint8_t soak_cpu_load;
+static uint8_t soak_cpu_max;
+static uint32_t soak_samples;
+
+static struct log soak_log;
+static struct cbmem soak_log_cbmem;
+static uint8_t soak_log_buf[MYNEWT_VAL(TESTBENCH_SOAK_LOG_SIZE)];
+static struct log soak_load_log;
+static struct cbmem soak_load_cbmem;
+static uint8_t soak_load_buf[MYNEWT_VAL(TESTBENCH_SOAK_LOG_SIZE)];
+
+#if SOAK_FLASH_AREA >= 0
+static struct os_mutex soak_flash_mtx;
+static struct flash_area soak_flash_sector;
+static int soak_flash_sector_id = -1;
+static uint32_t soak_flash_off;
+static uint8_t soak_flash_buf[SOAK_FLASH_CHUNK];
+#endif
+
+static uint8_t soak_pattern[64];
+
+static const struct soak_cfg soak_dflt_cfg = {
+    .sc_tasks = SOAK_NTASKS,
+    .sc_ev_rate = MYNEWT_VAL(TESTBENCH_SOAK_EVENT_RATE),
+    .sc_mbuf_rate = MYNEWT_VAL(TESTBENCH_SOAK_MBUF_RATE),
+    .sc_log_rate = MYNEWT_VAL(TESTBENCH_SOAK_LOG_RATE),
+    .sc_flash_rate = MYNEWT_VAL(TESTBENCH_SOAK_FLASH_RATE),
+};
+
+static int
+soak_lat_bucket(uint32_t usecs)
+{
+    int bucket;
+
+    if (usecs < 16) {
+        return 0;
+    }
+    bucket = (32 - __builtin_clz(usecs)) - 4;
+    if (bucket >= SOAK_LAT_BUCKETS) {
+        bucket = SOAK_LAT_BUCKETS - 1;
+    }
+    return bucket;
+}
+
+static void
+soak_ev_cb(struct os_event *ev)
+{
+    struct soak_ev *se;
+    uint32_t usecs;
+    os_sr_t sr;
+
+    se = ev->ev_arg;
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - se->se_ts);
+    se->se_busy = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    soak_evq_depth--;
+    OS_EXIT_CRITICAL(sr);
+
+    soak_lat_hist[soak_lat_bucket(usecs)]++;
+    if (usecs > soak_lat_max) {
+        soak_lat_max = usecs;
+    }
+    soak_ev_done++;
+}
+
+static void
+soak_sink_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&soak_evq);
+    }
+}
+
+static void
+soak_ev_post(struct soak_gen *sg)
+{
+    struct soak_ev *se;
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < SOAK_NEVS; i++) {
+        se = &sg->sg_evs[i];
+        if (!se->se_busy) {
+            break;
+        }
+    }
+    if (i == SOAK_NEVS) {
+        sg->sg_ev_drop++;
+        return;
+    }
+
+    se->se_busy = 1;
+    OS_ENTER_CRITICAL(sr);
+    if (++soak_evq_depth > soak_evq_max) {
+        soak_evq_max = soak_evq_depth;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    se->se_ts = os_cputime_get32();
+    os_eventq_put(&soak_evq, &se->se_ev);
+    sg->sg_ev_sent++;
+}
+
+static void
+soak_mbuf_churn(struct soak_gen *sg, uint32_t seq)
+{
+    struct os_mbuf *om;
+    uint16_t len;
+    uint16_t chunk;
+
+    /* Vary the length so that both single and chained mbufs are used. */
+    len = 32 + (seq * 37) % 256;
+
+    om = os_msys_get_pkthdr(len, 0);
+    if (om == NULL) {
+        sg->sg_mbuf_fail++;
+        return;
+    }
+    while (len > 0) {
+        chunk = min(len, sizeof(soak_pattern));
+        if (os_mbuf_append(om, soak_pattern, chunk)) {
+            sg->sg_mbuf_fail++;
+            break;
+        }
+        len -= chunk;
+    }
+    os_mbuf_free_chain(om);
+    if (len == 0) {
+        sg->sg_mbuf_ops++;
+    }
+}
+
+static void
+soak_log_append(struct soak_gen *sg, uint32_t seq)
+{
+    char body[SOAK_LOG_BODY_LEN];
+    int len;
+
+    len = snprintf(body, sizeof(body), "gen %u seq %lu",
+                   sg->sg_idx, (unsigned long)seq);
+    if (log_append_body(&soak_load_log, LOG_MODULE_TEST, LOG_LEVEL_INFO,
+                        LOG_ETYPE_STRING, body, len)) {
+        sg->sg_log_fail++;
+    } else {
+        sg->sg_log_ops++;
+    }
+}
+
+/*
+ * Writes the next chunk of the flash area and reads it back.  Sectors are
+ * erased as the write offset enters them, wrapping around at the end of
+ * the area.
+ */
+static void
+soak_flash_io(struct soak_gen *sg)
+{
+#if SOAK_FLASH_AREA >= 0
+    int rc;
+
+    os_mutex_pend(&soak_flash_mtx, OS_TIMEOUT_NEVER);
+
+    rc = 0;
+    if (soak_flash_sector_id < 0 ||
+        soak_flash_off + SOAK_FLASH_CHUNK > soak_flash_sector.fa_size) {
+        rc = flash_area_getnext_sector(SOAK_FLASH_AREA, &soak_flash_sector_id,
+                                       &soak_flash_sector);
+        if (rc) {
+            soak_flash_sector_id = -1;
+            rc = flash_area_getnext_sector(SOAK_FLASH_AREA,
+                                           &soak_flash_sector_id,
+                                           &soak_flash_sector);
+        }
+        if (rc == 0) {
+            rc = flash_area_erase(&soak_flash_sector, 0,
+                                  soak_flash_sector.fa_size);
+        }
+        soak_flash_off = 0;
+    }
+    if (rc == 0) {
+        rc = flash_area_write(&soak_flash_sector, soak_flash_off,
+                              soak_pattern, SOAK_FLASH_CHUNK);
+    }
+    if (rc == 0) {
+        rc = flash_area_read(&soak_flash_sector, soak_flash_off,
+                             soak_flash_buf, SOAK_FLASH_CHUNK);
+    }
+    if (rc == 0 && memcmp(soak_flash_buf, soak_pattern, SOAK_FLASH_CHUNK)) {
+        rc = SYS_EIO;
+    }
+    if (rc) {
+        /* Start over with a freshly erased sector. */
+        soak_flash_sector_id = -1;
+        sg->sg_flash_fail++;
+    } else {
+        soak_flash_off += SOAK_FLASH_CHUNK;
+        sg->sg_flash_ops++;
+    }
+
+    os_mutex_release(&soak_flash_mtx);
+#else
+    sg->sg_flash_fail++;
+#endif
+}
+
+/* Number of operations still owed at 'rate' after 'elapsed' ticks. */
+static uint32_t
+soak_due(uint16_t rate, os_time_t elapsed, uint32_t done)
+{
+    uint32_t due;
+
+    due = (uint64_t)rate * elapsed / OS_TICKS_PER_SEC;
+    if (due <= done) {
+        return 0;
+    }
+    return min(due - done, SOAK_BURST_MAX);
+}
+
+static void
+soak_gen_handler(void *arg)
+{
+    struct soak_gen *sg;
+    os_time_t elapsed;
+    os_time_t start;
+    uint32_t n_ev;
+    uint32_t n_mbuf;
+    uint32_t n_log;
+    uint32_t n_flash;
+    uint32_t cnt;
+    uint32_t id;
+
+    sg = arg;
+    while (1) {
+        os_sem_pend(&sg->sg_start, OS_TIMEOUT_NEVER);
+
+        id = soak_gen_id;
+        start = os_time_get();
+        n_ev = 0;
+        n_mbuf = 0;
+        n_log = 0;
+        n_flash = 0;
+
+        while (soak_on && id == soak_gen_id) {
+            os_time_delay(os_time_ms_to_ticks32(
+                MYNEWT_VAL(TESTBENCH_SOAK_PERIOD_MS)));
+            elapsed = os_time_get() - start;
+
+            for (cnt = soak_due(soak_cfg.sc_ev_rate, elapsed, n_ev); cnt;
+                 cnt--, n_ev++) {
+                soak_ev_post(sg);
+            }
+            for (cnt = soak_due(soak_cfg.sc_mbuf_rate, elapsed, n_mbuf); cnt;
+                 cnt--, n_mbuf++) {
+                soak_mbuf_churn(sg, n_mbuf);
+            }
+            for (cnt = soak_due(soak_cfg.sc_log_rate, elapsed, n_log); cnt;
+                 cnt--, n_log++) {
+                soak_log_append(sg, n_log);
+            }
+            for (cnt = soak_due(soak_cfg.sc_flash_rate, elapsed, n_flash); cnt;
+                 cnt--, n_flash++) {
+                soak_flash_io(sg);
+            }
+        }
+    }
+}
+
+static void
+soak_report(void)
+{
+    struct soak_stats ss;
+
+    soak_stats_get(&ss);
+    log_printf(&soak_log, LOG_MODULE_TEST, LOG_LEVEL_INFO,
+               "soak %lus ev %lu/%lu drop %lu lat max %luus evq max %u "
+               "msys min %u cpu %u%% max %u%% fail m%lu l%lu f%lu",
+               (unsigned long)ss.ss_secs,
+               (unsigned long)ss.ss_ev_done, (unsigned long)ss.ss_ev_sent,
+               (unsigned long)ss.ss_ev_drop, (unsigned long)ss.ss_lat_max,
+               ss.ss_evq_max, ss.ss_msys_min, ss.ss_cpu_load, ss.ss_cpu_max,
+               (unsigned long)ss.ss_mbuf_fail, (unsigned long)ss.ss_log_fail,
+               (unsigned long)ss.ss_flash_fail);
+}
+
+static void
+soak_sample_cb(struct os_event *ev)
+{
+    os_time_t now;
+    os_time_t idle;
+    uint32_t busy;
+    uint16_t free;
+
+    now = os_time_get();
+    free = os_msys_num_free();
+    soak_msys_free = free;
+    if (free < soak_msys_min) {
+        soak_msys_min = free;
+    }
+
+    if (soak_idle_task != NULL && now != soak_sample_time) {
+        idle = soak_idle_task->t_run_time - soak_sample_idle;
+        if (idle > now - soak_sample_time) {
+            idle = now - soak_sample_time;
+        }
+        busy = now - soak_sample_time - idle;
+        soak_cpu_load = busy * 100 / (now - soak_sample_time);
+        if (soak_cpu_load > soak_cpu_max) {
+            soak_cpu_max = soak_cpu_load;
+        }
+        soak_sample_idle = soak_idle_task->t_run_time;
+    }
+    soak_sample_time = now;
+
+    if (soak_on) {
+        soak_samples++;
+        if (soak_samples % (MYNEWT_VAL(TESTBENCH_SOAK_REPORT_SECS) * 1000 /
+                            MYNEWT_VAL(TESTBENCH_SOAK_SAMPLE_MS)) == 0) {
+            soak_report();
+        }
+    }
+
+    os_callout_reset(&soak_sample_co,
+                     os_time_ms_to_ticks32(MYNEWT_VAL(TESTBENCH_SOAK_SAMPLE_MS)));
+}
+
+int
+soak_start(const struct soak_cfg *cfg)
+{
+    int i;
+
+    if (cfg == NULL) {
+        cfg = &soak_dflt_cfg;
+    }
+    if (cfg->sc_tasks < 1 || cfg->sc_tasks > SOAK_NTASKS) {
+        return SYS_EINVAL;
+    }
+#if SOAK_FLASH_AREA < 0
+    if (cfg->sc_flash_rate != 0) {
+        return SYS_EINVAL;
+    }
+#endif
+    if (soak_on) {
+        return SYS_EBUSY;
+    }
+
+    soak_cfg = *cfg;
+    soak_start_time = os_time_get();
+    soak_samples = 0;
+    soak_gen_id++;
+    soak_on = true;
+    for (i = 0; i < soak_cfg.sc_tasks; i++) {
+        os_sem_release(&soak_gens[i].sg_start);
+    }
+
+    log_printf(&soak_log, LOG_MODULE_TEST, LOG_LEVEL_INFO,
+               "soak start tasks %u ev %u mbuf %u log %u flash %u",
+               soak_cfg.sc_tasks, soak_cfg.sc_ev_rate, soak_cfg.sc_mbuf_rate,
+               soak_cfg.sc_log_rate, soak_cfg.sc_flash_rate);
+    return 0;
+}
+
+void
+soak_stop(void)
+{
+    if (soak_on) {
+        soak_on = false;
+        soak_report();
+    }
+}
+
+int
+soak_running(struct soak_cfg *cfg)
+{
+    if (cfg != NULL) {
+        *cfg = soak_on ? soak_cfg : soak_dflt_cfg;
+    }
+    return soak_on;
+}
+
+void
+soak_stats_get(struct soak_stats *ss)
+{
+    const struct soak_gen *sg;
+    int i;
+
+    memset(ss, 0, sizeof(*ss));
+    if (soak_on) {
+        ss->ss_secs = (os_time_get() - soak_start_time) / OS_TICKS_PER_SEC;
+    }
+
+    for (i = 0; i < SOAK_NTASKS; i++) {
+        sg = &soak_gens[i];
+        ss->ss_ev_sent += sg->sg_ev_sent;
+        ss->ss_ev_drop += sg->sg_ev_drop;
+        ss->ss_mbuf_ops += sg->sg_mbuf_ops;
+        ss->ss_mbuf_fail += sg->sg_mbuf_fail;
+        ss->ss_log_ops += sg->sg_log_ops;
+        ss->ss_log_fail += sg->sg_log_fail;
+        ss->ss_flash_ops += sg->sg_flash_ops;
+        ss->ss_flash_fail += sg->sg_flash_fail;
+    }
+    ss->ss_ev_done = soak_ev_done;
+    ss->ss_evq_depth = soak_evq_depth;
+    ss->ss_evq_max = soak_evq_max;
+    ss->ss_msys_free = soak_msys_free;
+    ss->ss_msys_min = soak_msys_min;
+    ss->ss_cpu_load = soak_cpu_load;
+    ss->ss_cpu_max = soak_cpu_max;
+    ss->ss_lat_max = soak_lat_max;
+    memcpy(ss->ss_lat_hist, soak_lat_hist, sizeof(ss->ss_lat_hist));
+}
+
+/*
+ * Counters are owned by the tasks which increment them; a reset racing
+ * with an update can lose that one update, which is fine for statistics.
+ */
+void
+soak_stats_reset(void)
+{
+    struct soak_gen *sg;
+    int i;
+
+    for (i = 0; i < SOAK_NTASKS; i++) {
+        sg = &soak_gens[i];
+        sg->sg_ev_sent = 0;
+        sg->sg_ev_drop = 0;
+        sg->sg_mbuf_ops = 0;
+        sg->sg_mbuf_fail = 0;
+        sg->sg_log_ops = 0;
+        sg->sg_log_fail = 0;
+        sg->sg_flash_ops = 0;
+        sg->sg_flash_fail = 0;
+    }
+    soak_ev_done = 0;
+    soak_evq_max = soak_evq_depth;
+    soak_lat_max = 0;
+    memset(soak_lat_hist, 0, sizeof(soak_lat_hist));
+    soak_msys_min = os_msys_num_free();
+    soak_cpu_max = 0;
+}
+
+void
+soak_init(void)
+{
+    struct os_task_info oti;
+    struct os_task *t;
+    struct soak_gen *sg;
+    int rc;
+    int i;
+    int j;
+
+    for (i = 0; i < sizeof(soak_pattern); i++) {
+        soak_pattern[i] = i;
+    }
+
+    cbmem_init(&soak_log_cbmem, soak_log_buf, sizeof(soak_log_buf));
+    rc = log_register("soak", &soak_log, &log_cbmem_handler, &soak_log_cbmem,
+                      LOG_SYSLEVEL);
+    assert(rc == 0);
+    cbmem_init(&soak_load_cbmem, soak_load_buf, sizeof(soak_load_buf));
+    rc = log_register("soakload", &soak_load_log, &log_cbmem_handler,
+                      &soak_load_cbmem, LOG_SYSLEVEL);
+    assert(rc == 0);
+
+#if SOAK_FLASH_AREA >= 0
+    os_mutex_init(&soak_flash_mtx);
+#endif
+
+    /* The idle task's run time gives the CPU load. */
+    t = NULL;
+    while ((t = os_task_info_get_next(t, &oti)) != NULL) {
+        if (!strcmp(oti.oti_name, "idle")) {
+            soak_idle_task = t;
+            soak_sample_idle = t->t_run_time;
+            break;
+        }
+    }
+    soak_sample_time = os_time_get();
+    soak_msys_min = os_msys_num_free();
+
+    os_eventq_init(&soak_evq);
+    rc = os_task_init(&soak_sink_task, "soak_sink", soak_sink_handler, NULL,
+                      MYNEWT_VAL(TESTBENCH_SOAK_TASK_PRIO), OS_WAIT_FOREVER,
+                      soak_sink_stack, SOAK_STACK_SIZE);
+    assert(rc == 0);
+
+    for (i = 0; i < SOAK_NTASKS; i++) {
+        sg = &soak_gens[i];
+        sg->sg_idx = i;
+        for (j = 0; j < SOAK_NEVS; j++) {
+            sg->sg_evs[j].se_ev.ev_cb = soak_ev_cb;
+            sg->sg_evs[j].se_ev.ev_arg = &sg->sg_evs[j];
+        }
+        os_sem_init(&sg->sg_start, 0);
+        rc = os_task_init(&sg->sg_task, "soak_gen", soak_gen_handler, sg,
+                          MYNEWT_VAL(TESTBENCH_SOAK_TASK_PRIO) + 1 + i,
+                          OS_WAIT_FOREVER, soak_gen_stacks[i],
+                          SOAK_STACK_SIZE);
+        assert(rc == 0);
+    }
+
+    os_callout_init(&soak_sample_co, os_eventq_dflt_get(), soak_sample_cb,
+                    NULL);
+    os_callout_reset(&soak_sample_co,
+                     os_time_ms_to_ticks32(MYNEWT_VAL(TESTBENCH_SOAK_SAMPLE_MS)));
+
+    rc = soak_mgmt_register_group();
+    assert(rc == 0);
+
+#if MYNEWT_VAL(TESTBENCH_SOAK_AUTOSTART)
+    rc = soak_start(NULL);
+    assert(rc == 0);
+#endif
+}
+
+#endif /* MYNEWT_VAL(TESTBENCH_SOAK) */
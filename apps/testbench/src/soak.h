@@ -0,0 +1,116 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SOAK_
+#define H_SOAK_
+
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(TESTBENCH_SOAK)
+
+/**
+ * Number of latency histogram buckets.  Bucket n counts latencies below
+ * (16 << n) us that did not fit an earlier bucket; the last bucket takes
+ * everything longer.
+ */
+#define SOAK_LAT_BUCKETS    12
+
+/** Load to generate.  Rates are operations per second per load task. */
+struct soak_cfg {
+    uint8_t sc_tasks;
+    uint16_t sc_ev_rate;
+    uint16_t sc_mbuf_rate;
+    uint16_t sc_log_rate;
+    uint16_t sc_flash_rate;
+};
+
+/** Snapshot of what the load generator has done and seen. */
+struct soak_stats {
+    /** Seconds since the load was started */
+    uint32_t ss_secs;
+
+    uint32_t ss_ev_sent;
+    uint32_t ss_ev_done;
+    /** Events not sent because all of a task's events were queued */
+    uint32_t ss_ev_drop;
+    uint32_t ss_mbuf_ops;
+    uint32_t ss_mbuf_fail;
+    uint32_t ss_log_ops;
+    uint32_t ss_log_fail;
+    uint32_t ss_flash_ops;
+    uint32_t ss_flash_fail;
+
+    /** Event queue depth now and at most */
+    uint16_t ss_evq_depth;
+    uint16_t ss_evq_max;
+    /** Free msys blocks at the last sample and at least */
+    uint16_t ss_msys_free;
+    uint16_t ss_msys_min;
+    /** CPU load in percent over the last sample period and at most */
+    uint8_t ss_cpu_load;
+    uint8_t ss_cpu_max;
+
+    /** Event post-to-handler latency, in microseconds */
+    uint32_t ss_lat_max;
+    uint32_t ss_lat_hist[SOAK_LAT_BUCKETS];
+};
+
+/**
+ * Creates the load tasks and starts sampling.  Starts the load with the
+ * syscfg defaults if TESTBENCH_SOAK_AUTOSTART is set.
+ */
+void soak_init(void);
+
+/**
+ * Starts generating load.
+ *
+ * @param cfg                   The load to generate; NULL for the syscfg
+ *                                  defaults.
+ *
+ * @return                      0 on success;
+ *                              SYS_EBUSY if the load is already running;
+ *                              SYS_EINVAL if the configuration is invalid.
+ */
+int soak_start(const struct soak_cfg *cfg);
+
+/** Stops generating load.  The statistics are kept. */
+void soak_stop(void);
+
+/** Returns whether load is being generated, and with what configuration. */
+int soak_running(struct soak_cfg *cfg);
+
+void soak_stats_get(struct soak_stats *stats);
+void soak_stats_reset(void);
+
+/* soak_mgmt.c */
+int soak_mgmt_register_group(void);
+
+#else
+#define soak_init()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
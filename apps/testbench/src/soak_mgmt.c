@@ -0,0 +1,268 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(TESTBENCH_SOAK)
+
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+
+#include "soak.h"
+
+#define SOAK_MGMT_OP_CTL    0
+#define SOAK_MGMT_OP_STATS  1
+
+static int soak_mgmt_ctl_read(struct mgmt_ctxt *);
+static int soak_mgmt_ctl_write(struct mgmt_ctxt *);
+static int soak_mgmt_stats_read(struct mgmt_ctxt *);
+static int soak_mgmt_stats_write(struct mgmt_ctxt *);
+
+static const struct mgmt_handler soak_mgmt_handlers[] = {
+    [SOAK_MGMT_OP_CTL] = { soak_mgmt_ctl_read, soak_mgmt_ctl_write },
+    [SOAK_MGMT_OP_STATS] = { soak_mgmt_stats_read, soak_mgmt_stats_write }
+};
+
+static struct mgmt_group soak_mgmt_group = {
+    .mg_handlers = (struct mgmt_handler *)soak_mgmt_handlers,
+    .mg_handlers_count = sizeof(soak_mgmt_handlers) / sizeof(soak_mgmt_handlers[0]),
+    .mg_group_id = MYNEWT_VAL(TESTBENCH_SOAK_MGMT_GROUP_ID),
+};
+
+static int
+soak_mgmt_ctl_read(struct mgmt_ctxt *mc)
+{
+    struct soak_cfg cfg;
+    CborError err = CborNoError;
+    int running;
+
+    running = soak_running(&cfg);
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "run");
+    err |= cbor_encode_int(&mc->encoder, running);
+    err |= cbor_encode_text_stringz(&mc->encoder, "max_tasks");
+    err |= cbor_encode_uint(&mc->encoder, MYNEWT_VAL(TESTBENCH_SOAK_TASKS));
+    err |= cbor_encode_text_stringz(&mc->encoder, "tasks");
+    err |= cbor_encode_uint(&mc->encoder, cfg.sc_tasks);
+    err |= cbor_encode_text_stringz(&mc->encoder, "ev");
+    err |= cbor_encode_uint(&mc->encoder, cfg.sc_ev_rate);
+    err |= cbor_encode_text_stringz(&mc->encoder, "mbuf");
+    err |= cbor_encode_uint(&mc->encoder, cfg.sc_mbuf_rate);
+    err |= cbor_encode_text_stringz(&mc->encoder, "log");
+    err |= cbor_encode_uint(&mc->encoder, cfg.sc_log_rate);
+    err |= cbor_encode_text_stringz(&mc->encoder, "flash");
+    err |= cbor_encode_uint(&mc->encoder, cfg.sc_flash_rate);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+/*
+ * Starts ("run": 1) or stops ("run": 0) the load.  A running load is
+ * restarted with the new configuration.  Values not given are kept, or
+ * taken from syscfg if no load is running.
+ */
+static int
+soak_mgmt_ctl_write(struct mgmt_ctxt *mc)
+{
+    long long run = -1;
+    long long tasks;
+    long long ev;
+    long long mbuf;
+    long long log;
+    long long flash;
+    struct soak_cfg cfg;
+    CborError err = CborNoError;
+    int rc;
+
+    soak_running(&cfg);
+
+    const struct cbor_attr_t attr[] = {
+        [0] = {
+            .attribute = "run",
+            .type = CborAttrIntegerType,
+            .addr.integer = &run,
+            .dflt.integer = -1
+        },
+        [1] = {
+            .attribute = "tasks",
+            .type = CborAttrIntegerType,
+            .addr.integer = &tasks,
+            .dflt.integer = cfg.sc_tasks
+        },
+        [2] = {
+            .attribute = "ev",
+            .type = CborAttrIntegerType,
+            .addr.integer = &ev,
+            .dflt.integer = cfg.sc_ev_rate
+        },
+        [3] = {
+            .attribute = "mbuf",
+            .type = CborAttrIntegerType,
+            .addr.integer = &mbuf,
+            .dflt.integer = cfg.sc_mbuf_rate
+        },
+        [4] = {
+            .attribute = "log",
+            .type = CborAttrIntegerType,
+            .addr.integer = &log,
+            .dflt.integer = cfg.sc_log_rate
+        },
+        [5] = {
+            .attribute = "flash",
+            .type = CborAttrIntegerType,
+            .addr.integer = &flash,
+            .dflt.integer = cfg.sc_flash_rate
+        },
+        [6] = {
+            .attribute = NULL
+        }
+    };
+
+    rc = cbor_read_object(&mc->it, attr);
+    if (rc != 0 || run < 0 || run > 1) {
+        return MGMT_ERR_EINVAL;
+    }
+    if (tasks < 0 || tasks > UINT8_MAX ||
+        ev < 0 || ev > UINT16_MAX || mbuf < 0 || mbuf > UINT16_MAX ||
+        log < 0 || log > UINT16_MAX || flash < 0 || flash > UINT16_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    soak_stop();
+    rc = 0;
+    if (run) {
+        cfg.sc_tasks = tasks;
+        cfg.sc_ev_rate = ev;
+        cfg.sc_mbuf_rate = mbuf;
+        cfg.sc_log_rate = log;
+        cfg.sc_flash_rate = flash;
+        rc = soak_start(&cfg);
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    switch (rc) {
+    case 0:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+        break;
+    case SYS_EINVAL:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EINVAL);
+        break;
+    default:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EUNKNOWN);
+        break;
+    }
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+soak_mgmt_stats_read(struct mgmt_ctxt *mc)
+{
+    struct soak_stats ss;
+    CborError err = CborNoError;
+    CborEncoder hist;
+    int i;
+
+    soak_stats_get(&ss);
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "secs");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_secs);
+    err |= cbor_encode_text_stringz(&mc->encoder, "ev_sent");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_ev_sent);
+    err |= cbor_encode_text_stringz(&mc->encoder, "ev_done");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_ev_done);
+    err |= cbor_encode_text_stringz(&mc->encoder, "ev_drop");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_ev_drop);
+    err |= cbor_encode_text_stringz(&mc->encoder, "mbuf_ops");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_mbuf_ops);
+    err |= cbor_encode_text_stringz(&mc->encoder, "mbuf_fail");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_mbuf_fail);
+    err |= cbor_encode_text_stringz(&mc->encoder, "log_ops");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_log_ops);
+    err |= cbor_encode_text_stringz(&mc->encoder, "log_fail");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_log_fail);
+    err |= cbor_encode_text_stringz(&mc->encoder, "flash_ops");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_flash_ops);
+    err |= cbor_encode_text_stringz(&mc->encoder, "flash_fail");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_flash_fail);
+    err |= cbor_encode_text_stringz(&mc->encoder, "evq_depth");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_evq_depth);
+    err |= cbor_encode_text_stringz(&mc->encoder, "evq_max");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_evq_max);
+    err |= cbor_encode_text_stringz(&mc->encoder, "msys_free");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_msys_free);
+    err |= cbor_encode_text_stringz(&mc->encoder, "msys_min");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_msys_min);
+    err |= cbor_encode_text_stringz(&mc->encoder, "cpu");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_cpu_load);
+    err |= cbor_encode_text_stringz(&mc->encoder, "cpu_max");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_cpu_max);
+    err |= cbor_encode_text_stringz(&mc->encoder, "lat_max");
+    err |= cbor_encode_uint(&mc->encoder, ss.ss_lat_max);
+
+    /* Bucket n holds latencies below (16 << n) us; the last is open. */
+    err |= cbor_encode_text_stringz(&mc->encoder, "lat_hist");
+    err |= cbor_encoder_create_array(&mc->encoder, &hist, SOAK_LAT_BUCKETS);
+    for (i = 0; i < SOAK_LAT_BUCKETS; i++) {
+        err |= cbor_encode_uint(&hist, ss.ss_lat_hist[i]);
+    }
+    err |= cbor_encoder_close_container(&mc->encoder, &hist);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+/* Any write clears the statistics. */
+static int
+soak_mgmt_stats_write(struct mgmt_ctxt *mc)
+{
+    CborError err = CborNoError;
+
+    soak_stats_reset();
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+int
+soak_mgmt_register_group(void)
+{
+    mgmt_register_group(&soak_mgmt_group);
+
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(TESTBENCH_SOAK) */
@@ -53,6 +53,7 @@
 #include "runtest/runtest.h"
 #endif
 #include "tbb.h"
+#include "soak.h"
 
 struct os_timeval tv;
 struct os_timezone tz;
@@ -146,6 +147,8 @@ mynewt_main(int argc, char **argv)
 
     testbench_test_init(); /* initialize globals include blink duty cycle */
 
+    soak_init();
+
     os_task_init(&testtask, "testtask", testtask_handler, NULL,
                  TESTTASK_PRIO, OS_WAIT_FOREVER, teststack,
                  TESTTASK_STACK_SIZE);
@@ -20,6 +20,7 @@
 #ifndef _SPLIT_H__
 #define _SPLIT_H__
 
+#include "syscfg/syscfg.h"
 #include "bootutil/bootutil.h"
 
 #ifdef __cplusplus
@@ -78,6 +79,15 @@ void split_app_active_set(int active);
 
 int split_write_split(split_mode_t mode);
 
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+/**
+ * Forgets the cached validation result, so the next split_app_go() or
+ * split_check_status() validates the images in full.  A rewritten slot is
+ * detected without this; it is for code that modifies a slot in place.
+ */
+void split_verify_cache_clear(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,12 +18,18 @@
  */
 
 #include <assert.h>
+#include <stddef.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "bootutil/bootutil.h"
 #include "bootutil/image.h"
 #include "config/config.h"
 #include "scfg/scfg.h"
 #include "split/split.h"
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+#include "flash_map/flash_map.h"
+#include "crc/crc32.h"
+#endif
 
 #define LOADER_IMAGE_SLOT   0
 #define SPLIT_IMAGE_SLOT    1
@@ -32,6 +38,11 @@
 static int8_t split_mode_cur;
 static int8_t split_app_active;
 
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+/* Fingerprint of the image pair split_go() last accepted; 0 if none. */
+static uint32_t split_vcache_key;
+#endif
+
 static struct scfg_group split_scfg = {
     .settings = (const struct scfg_setting[]) {
         {
@@ -39,6 +50,13 @@ static struct scfg_group split_scfg = {
             .val = &split_mode_cur,
             .type = CONF_INT8,
         },
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+        {
+            .name = "vkey",
+            .val = &split_vcache_key,
+            .type = CONF_UINT32,
+        },
+#endif
 
         /* No more settings. */
         { 0 },
@@ -59,13 +77,158 @@ split_app_init(void)
     assert(rc == 0);
 }
 
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+/**
+ * Folds the header and the SHA256 TLV of the image in the given slot into
+ * a CRC.  The TLV area is the last thing written when a slot is uploaded,
+ * so rewriting a slot in any way changes (or erases) what is read here.
+ *
+ * @param slot                  The image slot to read.
+ * @param crc                   The CRC to update.
+ * @param entry                 If not NULL, filled with the image entry
+ *                                  point, the way split_go() reports it.
+ *
+ * @return                      0 on success; nonzero if the slot doesn't
+ *                                  hold a complete image.
+ */
+static int
+split_vcache_fold(int slot, uint32_t *crc, void **entry)
+{
+    const struct flash_area *fap;
+    struct image_header hdr;
+    struct image_tlv_info info;
+    struct image_tlv tlv;
+    uint8_t hash[32];
+    uint8_t prot[2];
+    uint32_t off;
+    uint32_t end;
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(slot), &fap);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = flash_area_read(fap, 0, &hdr, sizeof(hdr));
+    if (rc != 0 || hdr.ih_magic != IMAGE_MAGIC) {
+        rc = -1;
+        goto out;
+    }
+
+    /* The protected TLV size follows ih_hdr_size; not every bootutil
+     * version names that field.
+     */
+    off = offsetof(struct image_header, ih_hdr_size) + sizeof(hdr.ih_hdr_size);
+    memcpy(prot, (uint8_t *)&hdr + off, sizeof(prot));
+    off = (uint32_t)hdr.ih_hdr_size + hdr.ih_img_size + get_le16(prot);
+
+    rc = flash_area_read(fap, off, &info, sizeof(info));
+    if (rc != 0 || info.it_magic != IMAGE_TLV_INFO_MAGIC ||
+        off + info.it_tlv_tot > fap->fa_size) {
+        rc = -1;
+        goto out;
+    }
+    end = off + info.it_tlv_tot;
+
+    rc = -1;
+    for (off += sizeof(info); off + sizeof(tlv) <= end;
+         off += sizeof(tlv) + tlv.it_len) {
+        if (flash_area_read(fap, off, &tlv, sizeof(tlv))) {
+            break;
+        }
+        if (tlv.it_type == IMAGE_TLV_SHA256 && tlv.it_len == sizeof(hash)) {
+            rc = flash_area_read(fap, off + sizeof(tlv), hash, sizeof(hash));
+            break;
+        }
+    }
+    if (rc != 0) {
+        rc = -1;
+        goto out;
+    }
+
+    *crc = crc32_calc(*crc, &hdr, sizeof(hdr));
+    *crc = crc32_calc(*crc, hash, sizeof(hash));
+    if (entry != NULL) {
+        *entry = (void *)(uintptr_t)(fap->fa_off + hdr.ih_hdr_size);
+    }
+
+out:
+    flash_area_close(fap);
+    return rc;
+}
+
+/**
+ * Computes the fingerprint of the current loader / split image pair.
+ *
+ * @return                      The fingerprint; 0 if either slot doesn't
+ *                                  hold a complete image.
+ */
+static uint32_t
+split_vcache_key_calc(void **entry)
+{
+    uint32_t crc;
+
+    crc = crc32_init();
+    if (split_vcache_fold(LOADER_IMAGE_SLOT, &crc, NULL) ||
+        split_vcache_fold(SPLIT_IMAGE_SLOT, &crc, entry)) {
+        return 0;
+    }
+
+    /* 0 means "nothing cached". */
+    return crc != 0 ? crc : 1;
+}
+
+static void
+split_vcache_set(uint32_t key)
+{
+    if (split_vcache_key != key) {
+        split_vcache_key = key;
+        scfg_save_val(&split_scfg, &split_vcache_key);
+    }
+}
+
+void
+split_verify_cache_clear(void)
+{
+    split_vcache_set(0);
+}
+#endif
+
+/**
+ * Runs split_go(), skipping the image validation if the image pair is the
+ * one that was last validated.
+ */
+static int
+split_go_cached(void **entry)
+{
+#if MYNEWT_VAL(SPLIT_VERIFY_CACHE)
+    void *cached_entry;
+    uint32_t key;
+    int rc;
+
+    conf_ensure_loaded();
+
+    key = split_vcache_key_calc(&cached_entry);
+    if (key != 0 && key == split_vcache_key) {
+        *entry = cached_entry;
+        return SPLIT_GO_OK;
+    }
+
+    rc = split_go(LOADER_IMAGE_SLOT, SPLIT_IMAGE_SLOT, entry);
+    split_vcache_set(rc == SPLIT_GO_OK ? key : 0);
+    return rc;
+#else
+    return split_go(LOADER_IMAGE_SLOT, SPLIT_IMAGE_SLOT, entry);
+#endif
+}
+
 split_status_t
 split_check_status(void)
 {
     void *entry;
     int rc;
 
-    rc = split_go(LOADER_IMAGE_SLOT, SPLIT_IMAGE_SLOT, &entry);
+    rc = split_go_cached(&entry);
     switch (rc) {
     case SPLIT_GO_ERR:
         return SPLIT_STATUS_INVALID;
@@ -191,7 +354,7 @@ split_app_go(void **entry, int toboot)
         }
     }
 
-    rc = split_go(LOADER_IMAGE_SLOT, SPLIT_IMAGE_SLOT, entry);
+    rc = split_go_cached(entry);
     if (rc != 0) {
         /* Images don't match; clear split status. */
         split_write_split(SPLIT_MODE_LOADER);
@@ -242,6 +242,43 @@ static void uECC_vli_rshift1(uECC_word_t *vli, wordcount_t num_words)
 	}
 }
 
+#if defined(TC_ECC_UMAAL)
+#if !defined(__ARM_FEATURE_DSP)
+#error "TC_ECC_UMAAL needs an ARMv7E-M (Cortex-M4/M7) or later core"
+#endif
+
+/*
+ * Computes result = left * right. Result must be 2 * num_words long and
+ * must not overlap the operands.
+ *
+ * Operand scanning, one row of partial products at a time.  UMAAL computes
+ * lo + hi + a * b, which is exactly one multiply-accumulate step with
+ * carry and can never overflow 64 bits.
+ */
+static void uECC_vli_mult(uECC_word_t *result, const uECC_word_t *left,
+			  const uECC_word_t *right, wordcount_t num_words)
+{
+	uECC_word_t carry;
+	uECC_word_t lo;
+	wordcount_t i, j;
+
+	for (i = 0; i < num_words; ++i) {
+		result[i] = 0;
+	}
+
+	for (i = 0; i < num_words; ++i) {
+		carry = 0;
+		for (j = 0; j < num_words; ++j) {
+			lo = result[i + j];
+			__asm__ ("umaal %0, %1, %2, %3"
+				 : "+r" (lo), "+r" (carry)
+				 : "r" (left[i]), "r" (right[j]));
+			result[i + j] = lo;
+		}
+		result[i + num_words] = carry;
+	}
+}
+#else
 static void muladd(uECC_word_t a, uECC_word_t b, uECC_word_t *r0,
 		   uECC_word_t *r1, uECC_word_t *r2)
 {
@@ -290,6 +327,7 @@ static void uECC_vli_mult(uECC_word_t *result, const uECC_word_t *left,
 	}
 	result[num_words * 2 - 1] = r0;
 }
+#endif
 
 void uECC_vli_modAdd(uECC_word_t *result, const uECC_word_t *left,
 		     const uECC_word_t *right, const uECC_word_t *mod,
@@ -178,6 +178,62 @@ static inline unsigned int BigEndian(const uint8_t **c)
 	return n;
 }
 
+#if defined(TC_SHA256_UNROLL)
+/*
+ * Eight rounds per loop iteration, with the working variables renamed from
+ * round to round instead of shifted through: each round only updates d and
+ * h.  The message schedule is expanded in place in a 16-word window.
+ */
+#define W(i) (work_space[(i) & 0x0f])
+#define EXPAND(i) \
+	(W(i) += sigma0(W((i) + 1)) + sigma1(W((i) + 14)) + W((i) + 9))
+#define ROUND(a, b, c, d, e, f, g, h, w, k) \
+	do { \
+		t1 = (h) + Sigma1(e) + Ch((e), (f), (g)) + (k) + (w); \
+		(d) += t1; \
+		(h) = t1 + Sigma0(a) + Maj((a), (b), (c)); \
+	} while (0)
+
+static void compress(unsigned int *iv, const uint8_t *data)
+{
+	unsigned int a, b, c, d, e, f, g, h;
+	unsigned int t1;
+	unsigned int work_space[16];
+	unsigned int i;
+
+	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+
+	for (i = 0; i < 16; ++i) {
+		work_space[i] = BigEndian(&data);
+	}
+
+	for (i = 0; i < 16; i += 8) {
+		ROUND(a, b, c, d, e, f, g, h, W(i + 0), k256[i + 0]);
+		ROUND(h, a, b, c, d, e, f, g, W(i + 1), k256[i + 1]);
+		ROUND(g, h, a, b, c, d, e, f, W(i + 2), k256[i + 2]);
+		ROUND(f, g, h, a, b, c, d, e, W(i + 3), k256[i + 3]);
+		ROUND(e, f, g, h, a, b, c, d, W(i + 4), k256[i + 4]);
+		ROUND(d, e, f, g, h, a, b, c, W(i + 5), k256[i + 5]);
+		ROUND(c, d, e, f, g, h, a, b, W(i + 6), k256[i + 6]);
+		ROUND(b, c, d, e, f, g, h, a, W(i + 7), k256[i + 7]);
+	}
+
+	for ( ; i < 64; i += 8) {
+		ROUND(a, b, c, d, e, f, g, h, EXPAND(i + 0), k256[i + 0]);
+		ROUND(h, a, b, c, d, e, f, g, EXPAND(i + 1), k256[i + 1]);
+		ROUND(g, h, a, b, c, d, e, f, EXPAND(i + 2), k256[i + 2]);
+		ROUND(f, g, h, a, b, c, d, e, EXPAND(i + 3), k256[i + 3]);
+		ROUND(e, f, g, h, a, b, c, d, EXPAND(i + 4), k256[i + 4]);
+		ROUND(d, e, f, g, h, a, b, c, EXPAND(i + 5), k256[i + 5]);
+		ROUND(c, d, e, f, g, h, a, b, EXPAND(i + 6), k256[i + 6]);
+		ROUND(b, c, d, e, f, g, h, a, EXPAND(i + 7), k256[i + 7]);
+	}
+
+	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+}
+#else
 static void compress(unsigned int *iv, const uint8_t *data)
 {
 	unsigned int a, b, c, d, e, f, g, h;
@@ -215,3 +271,4 @@ static void compress(unsigned int *iv, const uint8_t *data)
 	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
 	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 }
+#endif
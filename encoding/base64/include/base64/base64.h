@@ -42,7 +42,20 @@ struct base64_decoder {
     int buf_len;
 };
 
+/**
+ * base64_encoder: used for encoding data that arrives in pieces.  Must be
+ * zeroed before use.
+ */
+struct base64_encoder {
+    /*** private */
+    uint8_t buf[3];
+    uint8_t buf_len;
+};
+
+struct os_mbuf;
+
 int base64_encode(const void *, int, char *, uint8_t);
+/* Decodes a NUL terminated string.  buf may be the string itself. */
 int base64_decode(const char *, void *buf);
 int base64_pad(char *, int);
 int base64_decode_len(const char *str);
@@ -53,6 +66,34 @@ int base64_decode_maxlen(const char *str, void *data, int len);
  */
 int base64_decoder_go(struct base64_decoder *dec);
 
+/**
+ * Encodes the next len bytes of a stream.  Up to 2 bytes are held back
+ * until more data or base64_encoder_finish() completes their group.
+ *
+ * @return The number of characters written to dst; no NUL is added.
+ */
+int base64_encoder_feed(struct base64_encoder *enc, const void *data, int len,
+                        char *dst);
+
+/**
+ * Encodes the bytes held back by the encoder and NUL terminates dst.
+ *
+ * @return The number of characters written, excluding the NUL.
+ */
+int base64_encoder_finish(struct base64_encoder *enc, char *dst,
+                          uint8_t should_pad);
+
+/**
+ * Encodes len bytes of an mbuf chain starting at off, without copying the
+ * data out of the chain first.  dst must hold BASE64_ENCODE_SIZE(len) + 1
+ * characters.
+ *
+ * @return The number of characters written, excluding the NUL; -1 if the
+ *         chain holds fewer than off + len bytes.
+ */
+int base64_encode_mbuf(const struct os_mbuf *om, int off, int len, char *dst,
+                       uint8_t should_pad);
+
 #define BASE64_ENCODE_SIZE(__size) (((((__size) - 1) / 3) * 4) + 4)
 
 #ifdef __cplusplus
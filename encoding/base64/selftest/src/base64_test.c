@@ -27,6 +27,7 @@ TEST_SUITE(base64_test_suite)
     decode_basic();
     decode_maxlen();
     decode_chunks();
+    encode_stream();
 }
 
 int
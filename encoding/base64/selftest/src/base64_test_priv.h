@@ -34,6 +34,7 @@ TEST_CASE_DECL(str2hex);
 TEST_CASE_DECL(decode_basic);
 TEST_CASE_DECL(decode_maxlen);
 TEST_CASE_DECL(decode_chunks);
+TEST_CASE_DECL(encode_stream);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os/mynewt.h"
+#include "base64_test_priv.h"
+
+static void
+pass(const char *src, uint8_t pad)
+{
+    struct base64_encoder enc;
+    char expected[128];
+    char dst[128];
+    struct os_mbuf *om;
+    int elen;
+    int len;
+    int off;
+    int i;
+    int rc;
+
+    elen = base64_encode(src, strlen(src), expected, pad);
+
+    /* Feed the input in pieces of every length up to 4 bytes. */
+    memset(&enc, 0, sizeof(enc));
+    len = 0;
+    off = 0;
+    for (i = 1; off < strlen(src); i = i % 4 + 1) {
+        i = min(i, strlen(src) - off);
+        len += base64_encoder_feed(&enc, src + off, i, dst + len);
+        off += i;
+    }
+    len += base64_encoder_finish(&enc, dst + len, pad);
+    TEST_ASSERT_FATAL(len == elen);
+    TEST_ASSERT(strcmp(dst, expected) == 0);
+
+    /* Same input in an mbuf chain. */
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    for (off = 0; off < strlen(src); off++) {
+        rc = os_mbuf_append(om, src + off, 1);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    len = base64_encode_mbuf(om, 0, strlen(src), dst, pad);
+    TEST_ASSERT(len == elen);
+    TEST_ASSERT(strcmp(dst, expected) == 0);
+
+    len = base64_encode_mbuf(om, 1, strlen(src), dst, pad);
+    TEST_ASSERT(len == -1);
+
+    os_mbuf_free_chain(om);
+}
+
+TEST_CASE_SELF(encode_stream)
+{
+    pass("the die is cast", 1);
+    pass("some text with padding", 1);
+    pass("some text with padding", 0);
+    pass("a", 1);
+}
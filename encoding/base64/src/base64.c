@@ -50,63 +50,168 @@
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+#define BASE64_DEC_PAD      0xfe
+#define BASE64_DEC_INVALID  0xff
+
+/* Maps a character to its 6-bit value, BASE64_DEC_PAD or BASE64_DEC_INVALID. */
+static const uint8_t base64_dec[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xfe, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/* Writes the four characters encoding the 24 low bits of c. */
+static inline void
+base64_encode_group(char *p, uint32_t c)
+{
+    p[0] = base64_chars[(c >> 18) & 0x3f];
+    p[1] = base64_chars[(c >> 12) & 0x3f];
+    p[2] = base64_chars[(c >> 6) & 0x3f];
+    p[3] = base64_chars[c & 0x3f];
+}
+
+/* Writes the 1 or 2 trailing bytes of an encoding; returns the length. */
 static int
-pos(char c)
+base64_encode_tail(const uint8_t *q, int len, char *p, uint8_t should_pad)
 {
-    const char *p;
-    for (p = base64_chars; *p; p++)
-        if (*p == c)
-            return p - base64_chars;
-    return -1;
+    uint32_t c;
+
+    c = q[0] << 16;
+    if (len > 1) {
+        c |= q[1] << 8;
+    }
+    base64_encode_group(p, c);
+
+    if (!should_pad) {
+        return len + 1;
+    }
+    if (len == 1) {
+        p[2] = '=';
+    }
+    p[3] = '=';
+    return 4;
 }
 
 int
 base64_encode(const void *data, int size, char *s, uint8_t should_pad)
 {
+    const uint8_t *q;
     char *p;
     int i;
-    int c;
-    const unsigned char *q;
-    char *last;
-    int diff;
 
     p = s;
+    q = data;
+
+    /*
+     * Each group of 3 bytes is read before its 4 characters are written;
+     * callers rely on this to encode towards the start of a buffer.
+     */
+    for (i = 0; i + 3 <= size; i += 3) {
+        base64_encode_group(p, (q[i] << 16) | (q[i + 1] << 8) | q[i + 2]);
+        p += 4;
+    }
+    if (i < size) {
+        p += base64_encode_tail(q + i, size - i, p, should_pad);
+    }
 
-    q = (const unsigned char *) data;
-    last = NULL;
+    *p = 0;
+
+    return (p - s);
+}
+
+int
+base64_encoder_feed(struct base64_encoder *enc, const void *data, int len,
+                    char *dst)
+{
+    const uint8_t *q;
+    char *p;
+    int i;
+
+    q = data;
+    p = dst;
     i = 0;
-    while (i < size) {
-        c = q[i++];
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        p[0] = base64_chars[(c & 0x00fc0000) >> 18];
-        p[1] = base64_chars[(c & 0x0003f000) >> 12];
-        p[2] = base64_chars[(c & 0x00000fc0) >> 6];
-        p[3] = base64_chars[(c & 0x0000003f) >> 0];
-        last = p;
+
+    /* Complete a group left over from the previous call. */
+    while (enc->buf_len > 0 && i < len) {
+        enc->buf[enc->buf_len++] = q[i++];
+        if (enc->buf_len == 3) {
+            base64_encode_group(p, (enc->buf[0] << 16) | (enc->buf[1] << 8) |
+                                   enc->buf[2]);
+            p += 4;
+            enc->buf_len = 0;
+        }
+    }
+
+    for (; i + 3 <= len; i += 3) {
+        base64_encode_group(p, (q[i] << 16) | (q[i + 1] << 8) | q[i + 2]);
         p += 4;
     }
 
-    if (last) {
-        diff = i - size;
-        if (diff > 0) {
-            if (should_pad) {
-                memset(last + (4 - diff), '=', diff);
-            } else {
-                p = last + (4 - diff);
-            }
-        }
+    while (i < len) {
+        enc->buf[enc->buf_len++] = q[i++];
     }
 
-    *p = 0;
+    return p - dst;
+}
 
-    return (p - s);
+int
+base64_encoder_finish(struct base64_encoder *enc, char *dst,
+                      uint8_t should_pad)
+{
+    int len;
+
+    len = 0;
+    if (enc->buf_len > 0) {
+        len = base64_encode_tail(enc->buf, enc->buf_len, dst, should_pad);
+        enc->buf_len = 0;
+    }
+    dst[len] = '\0';
+
+    return len;
+}
+
+int
+base64_encode_mbuf(const struct os_mbuf *om, int off, int len, char *dst,
+                   uint8_t should_pad)
+{
+    struct base64_encoder enc = { 0 };
+    char *p;
+    int chunk;
+
+    p = dst;
+    while (om != NULL && off >= om->om_len) {
+        off -= om->om_len;
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    while (om != NULL && len > 0) {
+        chunk = min(om->om_len - off, len);
+        p += base64_encoder_feed(&enc, om->om_data + off, chunk, p);
+        len -= chunk;
+        off = 0;
+        om = SLIST_NEXT(om, om_next);
+    }
+    if (len > 0) {
+        /* Chain is shorter than requested. */
+        return -1;
+    }
+
+    p += base64_encoder_finish(&enc, p, should_pad);
+
+    return p - dst;
 }
 
 int
@@ -144,7 +249,7 @@ token_decode(const char *token, int len)
         } else if (marker > 0) {
             return DECODE_ERROR;
         } else {
-            val += pos(token[i]);
+            val += base64_dec[(uint8_t)token[i]];
         }
     }
 
@@ -193,8 +298,13 @@ base64_decode_len(const char *str)
 int
 base64_decoder_go(struct base64_decoder *dec)
 {
+    const uint8_t *s;
     unsigned int marker;
     unsigned int val;
+    unsigned int a;
+    unsigned int b;
+    unsigned int c;
+    unsigned int d;
     uint8_t *dst;
     char sval;
     int read_len;
@@ -233,6 +343,34 @@ base64_decoder_go(struct base64_decoder *dec)
             break;
         }
 
+        /*
+         * Fast path: decode whole groups straight from the source while
+         * they hold no padding or other special characters.  Characters
+         * are checked one at a time so a terminating NUL is never read
+         * past.
+         */
+        if (dec->buf_len == 0) {
+            while (src_len - src_off >= 4 && dst_len - dst_off >= 3) {
+                s = (const uint8_t *)dec->src + src_off;
+                if ((a = base64_dec[s[0]]) >= 64 ||
+                    (b = base64_dec[s[1]]) >= 64 ||
+                    (c = base64_dec[s[2]]) >= 64 ||
+                    (d = base64_dec[s[3]]) >= 64) {
+                    break;
+                }
+                val = (a << 18) | (b << 12) | (c << 6) | d;
+                dst[dst_off] = val >> 16;
+                dst[dst_off + 1] = val >> 8;
+                dst[dst_off + 2] = val;
+                dst_off += 3;
+                src_off += 4;
+            }
+            src_rem = src_len - src_off;
+            if (src_rem == 0 || dec->src[src_off] == '\0') {
+                break;
+            }
+        }
+
         /* Account for possibility of partial token from previous call. */
         assert(dec->buf_len < 4);
         read_len = 4 - dec->buf_len;
@@ -244,7 +382,7 @@ base64_decoder_go(struct base64_decoder *dec)
                 /* Incomplete input. */
                 return -1;
             }
-            if (sval != '=' && strchr(base64_chars, sval) == NULL) {
+            if (base64_dec[(uint8_t)sval] == BASE64_DEC_INVALID) {
                 /* Invalid base64 character. */
                 return -1;
             }
@@ -18,13 +18,30 @@
  */
 
 #include <inttypes.h>
-#include <ctype.h>
 #include <stddef.h>
 
 #include "base64/hex.h"
 
 static const char hex_bytes[] = "0123456789abcdef";
 
+/* Returns the value of a hex digit; a value above 0xf if c is not one. */
+static inline unsigned int
+hex_nibble(char c)
+{
+    unsigned int v;
+
+    v = (unsigned char)c - '0';
+    if (v < 10) {
+        return v;
+    }
+    /* Fold case; 'a'..'f' and 'A'..'F' become 10..15. */
+    v = ((unsigned char)c | 0x20) - 'a';
+    if (v < 6) {
+        return v + 10;
+    }
+    return 0x100;
+}
+
 /*
  * Turn byte array into a printable array. I.e. "\x01" -> "01"
  *
@@ -69,7 +86,7 @@ hex_parse(const char *src, int src_len, void *dst_v, int dst_len)
 {
     int i;
     uint8_t *dst = (uint8_t *)dst_v;
-    char c;
+    unsigned int v;
 
     if (src_len & 0x1) {
         return -1;
@@ -77,24 +94,12 @@ hex_parse(const char *src, int src_len, void *dst_v, int dst_len)
     if (dst_len * 2 < src_len) {
         return -1;
     }
-    for (i = 0; i < src_len; i++, src++) {
-        c = *src;
-        if (isdigit((unsigned char)c)) {
-            c -= '0';
-        } else if (c >= 'a' && c <= 'f') {
-            c -= ('a' - 10);
-        } else if (c >= 'A' && c <= 'F') {
-            c -= ('A' - 10);
-        } else {
+    for (i = 0; i < src_len; i += 2) {
+        v = (hex_nibble(src[i]) << 4) | hex_nibble(src[i + 1]);
+        if (v > 0xff) {
             return -1;
         }
-        if (i & 1) {
-            *dst |= c;
-            dst++;
-            dst_len--;
-        } else {
-            *dst = c << 4;
-        }
+        *dst++ = v;
     }
     return src_len >> 1;
 }
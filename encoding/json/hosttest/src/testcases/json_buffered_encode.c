@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_json_priv.h"
+
+static const char *test_json_buffered_output =
+    "{\"min\": -9223372036854775808,\"max\": 18446744073709551615,"
+    "\"zero\": 0,\"esc\": \"a\\\"b\\\\c\\/d\\ne\"}";
+
+TEST_CASE(test_json_buffered_encode)
+{
+    struct json_encoder encoder;
+    struct json_value value;
+    char buf[8];
+    char hex[16];
+    int rc;
+
+    buf_index = 0;
+    memset(&encoder, 0, sizeof(encoder));
+
+    encoder.je_write = test_write;
+    encoder.je_arg = NULL;
+
+    /* Smaller than some tokens, so both paths get exercised. */
+    json_encoder_set_buf(&encoder, buf, sizeof(buf));
+
+    rc = json_encode_object_start(&encoder);
+    TEST_ASSERT(rc == 0);
+
+    JSON_VALUE_INT(&value, INT64_MIN);
+    rc = json_encode_object_entry(&encoder, "min", &value);
+    TEST_ASSERT(rc == 0);
+
+    JSON_VALUE_UINT(&value, UINT64_MAX);
+    rc = json_encode_object_entry(&encoder, "max", &value);
+    TEST_ASSERT(rc == 0);
+
+    JSON_VALUE_UINT(&value, 0);
+    rc = json_encode_object_entry(&encoder, "zero", &value);
+    TEST_ASSERT(rc == 0);
+
+    JSON_VALUE_STRING(&value, "a\"b\\c/d\ne");
+    rc = json_encode_object_entry(&encoder, "esc", &value);
+    TEST_ASSERT(rc == 0);
+
+    rc = json_encode_object_finish(&encoder);
+    TEST_ASSERT(rc == 0);
+
+    /* The tail is held back until the flush. */
+    TEST_ASSERT(buf_index < strlen(test_json_buffered_output));
+
+    rc = json_encode_flush(&encoder);
+    TEST_ASSERT(rc >= 0);
+
+    bigbuf[buf_index] = '\0';
+    rc = strcmp(bigbuf, test_json_buffered_output);
+    TEST_ASSERT(rc == 0);
+
+    rc = json_fmt_hex(hex, 0xbeef, 8);
+    TEST_ASSERT(rc == 8 && memcmp(hex, "0000beef", 8) == 0);
+    rc = json_fmt_hex(hex, 0, 1);
+    TEST_ASSERT(rc == 1 && hex[0] == '0');
+}
@@ -25,6 +25,7 @@
 #include <ctype.h>
 #include <stdio.h>
 #include <sys/types.h>
+#include "syscfg/syscfg.h"
 
 
 #ifdef __cplusplus
@@ -37,6 +38,9 @@ extern "C" {
 #define JSON_VALUE_TYPE_STRING (3)
 #define JSON_VALUE_TYPE_ARRAY  (4)
 #define JSON_VALUE_TYPE_OBJECT (5)
+#ifdef FLOAT_SUPPORT
+#define JSON_VALUE_TYPE_FLOAT  (6)
+#endif
 
 struct json_value {
     uint8_t jv_pad1;
@@ -76,6 +80,12 @@ struct json_value {
     (__jv)->jv_type = JSON_VALUE_TYPE_UINT64; \
     (__jv)->jv_val.u = (uint64_t) __v;
 
+#ifdef FLOAT_SUPPORT
+#define JSON_VALUE_FLOAT(__jv, __v)           \
+    (__jv)->jv_type = JSON_VALUE_TYPE_FLOAT;  \
+    (__jv)->jv_val.fl = (float) __v;
+#endif
+
 /* Encoding functions */
 typedef int (*json_write_func_t)(void *buf, char *data,
         int len);
@@ -85,6 +95,10 @@ struct json_encoder {
     void *je_arg;
     int je_wr_commas:1;
     char je_encode_buf[64];
+    /* Optional output buffer, see json_encoder_set_buf() */
+    char *je_buf;
+    uint16_t je_buf_size;
+    uint16_t je_buf_len;
 };
 
 
@@ -101,6 +115,34 @@ int json_encode_array_start(struct json_encoder *encoder);
 int json_encode_array_value(struct json_encoder *encoder, struct json_value *val);
 int json_encode_array_finish(struct json_encoder *encoder);
 
+/*
+ * Collects encoder output in buf and passes it to je_write in chunks of up
+ * to buf_size bytes, instead of once per token.  json_encode_flush() must
+ * be called once encoding is done.
+ */
+void json_encoder_set_buf(struct json_encoder *encoder, char *buf,
+        int buf_size);
+/* Writes out anything held in the encoder buffer; returns je_write's rc. */
+int json_encode_flush(struct json_encoder *encoder);
+
+/*
+ * Number formatting without printf.  Each writes into buf, without a
+ * terminating NUL, and returns the number of characters written: at most
+ * 20 for json_fmt_uint(), 20 for json_fmt_int() and 16 for json_fmt_hex().
+ * json_fmt_hex() pads with zeros to at least min_digits digits.
+ */
+int json_fmt_uint(char *buf, uint64_t val);
+int json_fmt_int(char *buf, int64_t val);
+int json_fmt_hex(char *buf, uint64_t val, int min_digits);
+
+#if MYNEWT_VAL(JSON_ENCODE_MBUF)
+/*
+ * json_write_func_t appending to the mbuf chain in arg.  Combined with
+ * json_encoder_set_buf(), output is copied straight into the chain's tail.
+ */
+int json_mbuf_write(void *arg, char *data, int len);
+#endif
+
 /* Json parser definitions */
 typedef enum {
     t_integer,
@@ -17,29 +17,259 @@
  * under the License.
  */
 
-#include <stdio.h>
 #include <string.h>
 
 #include <json/json.h>
 
+#if MYNEWT_VAL(JSON_ENCODE_MBUF)
+#include "os/os_mbuf.h"
+#endif
+
 #define JSON_ENCODE_OBJECT_START(__e) \
-    (__e)->je_write((__e)->je_arg, "{", sizeof("{")-1);
+    json_write((__e), "{", sizeof("{")-1);
 
 #define JSON_ENCODE_OBJECT_END(__e) \
-    (__e)->je_write((__e)->je_arg, "}", sizeof("}")-1);
+    json_write((__e), "}", sizeof("}")-1);
 
 #define JSON_ENCODE_ARRAY_START(__e) \
-    (__e)->je_write((__e)->je_arg, "[", sizeof("[")-1);
+    json_write((__e), "[", sizeof("[")-1);
 
 #define JSON_ENCODE_ARRAY_END(__e) \
-    (__e)->je_write((__e)->je_arg, "]", sizeof("]")-1);
+    json_write((__e), "]", sizeof("]")-1);
+
+/*
+ * All output goes through here.  Without a buffer every token is handed to
+ * je_write right away; with one, tokens are collected and written in
+ * je_buf_size chunks.
+ */
+static void
+json_write(struct json_encoder *encoder, const char *data, int len)
+{
+    if (encoder->je_buf == NULL) {
+        encoder->je_write(encoder->je_arg, (char *)data, len);
+        return;
+    }
+
+    if (encoder->je_buf_len + len > encoder->je_buf_size) {
+        json_encode_flush(encoder);
+        if (len > encoder->je_buf_size) {
+            encoder->je_write(encoder->je_arg, (char *)data, len);
+            return;
+        }
+    }
+
+    memcpy(encoder->je_buf + encoder->je_buf_len, data, len);
+    encoder->je_buf_len += len;
+}
+
+void
+json_encoder_set_buf(struct json_encoder *encoder, char *buf, int buf_size)
+{
+    encoder->je_buf = buf;
+    encoder->je_buf_size = buf_size;
+    encoder->je_buf_len = 0;
+}
+
+int
+json_encode_flush(struct json_encoder *encoder)
+{
+    int rc;
+
+    if (encoder->je_buf == NULL || encoder->je_buf_len == 0) {
+        return 0;
+    }
+
+    rc = encoder->je_write(encoder->je_arg, encoder->je_buf,
+                           encoder->je_buf_len);
+    encoder->je_buf_len = 0;
+
+    return rc;
+}
+
+int
+json_fmt_uint(char *buf, uint64_t val)
+{
+    char tmp[20];
+    int len;
+    int i;
+
+    len = 0;
+    do {
+        tmp[len++] = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+
+    for (i = 0; i < len; i++) {
+        buf[i] = tmp[len - 1 - i];
+    }
+
+    return len;
+}
+
+int
+json_fmt_int(char *buf, int64_t val)
+{
+    if (val < 0) {
+        buf[0] = '-';
+        /* Negate as unsigned so INT64_MIN does not overflow. */
+        return 1 + json_fmt_uint(buf + 1, -(uint64_t)val);
+    }
+
+    return json_fmt_uint(buf, val);
+}
+
+int
+json_fmt_hex(char *buf, uint64_t val, int min_digits)
+{
+    static const char hex[] = "0123456789abcdef";
+    int digits;
+    int i;
+
+    digits = 1;
+    while (digits < 16 && (val >> (digits * 4)) != 0) {
+        digits++;
+    }
+    if (digits < min_digits) {
+        digits = min_digits;
+    }
+
+    for (i = digits - 1; i >= 0; i--) {
+        buf[i] = hex[val & 0xf];
+        val >>= 4;
+    }
+
+    return digits;
+}
+
+#ifdef FLOAT_SUPPORT
+/*
+ * Writes val with up to 6 fractional digits, switching to an exponent when
+ * the integer part does not fit in 64 bits.  Non-finite values have no JSON
+ * form and are written as null.
+ */
+static int
+json_fmt_float(char *buf, float val)
+{
+    uint64_t ipart;
+    uint32_t frac;
+    double v;
+    int exp;
+    int len;
+    int i;
+
+    v = val;
+    if (v != v || v - v != 0) {
+        memcpy(buf, "null", 4);
+        return 4;
+    }
 
+    len = 0;
+    if (v < 0) {
+        buf[len++] = '-';
+        v = -v;
+    }
+
+    exp = 0;
+    if (v >= 1e18) {
+        while (v >= 10) {
+            v /= 10;
+            exp++;
+        }
+    }
+
+    ipart = v;
+    frac = (v - ipart) * 1000000 + 0.5;
+    if (frac >= 1000000) {
+        ipart++;
+        frac -= 1000000;
+    }
+
+    len += json_fmt_uint(buf + len, ipart);
+    buf[len++] = '.';
+    for (i = 100000; i > 1 && frac % 10 == 0; i /= 10) {
+        frac /= 10;
+    }
+    for (; i > 0; i /= 10) {
+        buf[len++] = '0' + (frac / i) % 10;
+    }
+
+    if (exp != 0) {
+        buf[len++] = 'e';
+        len += json_fmt_uint(buf + len, exp);
+    }
+
+    return len;
+}
+#endif
+
+#if MYNEWT_VAL(JSON_ENCODE_MBUF)
+int
+json_mbuf_write(void *arg, char *data, int len)
+{
+    return os_mbuf_append(arg, data, len);
+}
+#endif
+
+/*
+ * Writes a quoted string, escaping as needed.  Runs of characters that need
+ * no escaping are written with a single call.
+ */
+static void
+json_encode_string(struct json_encoder *encoder, const char *str, int len)
+{
+    const char *esc;
+    int start;
+    int i;
+
+    json_write(encoder, "\"", sizeof("\"")-1);
+    start = 0;
+    for (i = 0; i < len; i++) {
+        switch (str[i]) {
+        case '"':
+            esc = "\\\"";
+            break;
+        case '/':
+            esc = "\\/";
+            break;
+        case '\\':
+            esc = "\\\\";
+            break;
+        case '\t':
+            esc = "\\t";
+            break;
+        case '\r':
+            esc = "\\r";
+            break;
+        case '\n':
+            esc = "\\n";
+            break;
+        case '\f':
+            esc = "\\f";
+            break;
+        case '\b':
+            esc = "\\b";
+            break;
+        default:
+            continue;
+        }
+
+        if (i > start) {
+            json_write(encoder, str + start, i - start);
+        }
+        json_write(encoder, esc, 2);
+        start = i + 1;
+    }
+    if (len > start) {
+        json_write(encoder, str + start, len - start);
+    }
+    json_write(encoder, "\"", sizeof("\"")-1);
+}
 
 int
 json_encode_object_start(struct json_encoder *encoder)
 {
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
     JSON_ENCODE_OBJECT_START(encoder);
@@ -57,61 +287,28 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
 
     switch (jv->jv_type) {
     case JSON_VALUE_TYPE_BOOL:
-        len = sprintf(encoder->je_encode_buf, "%s",
-                      jv->jv_val.u > 0 ? "true" : "false");
-        encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+        if (jv->jv_val.u > 0) {
+            json_write(encoder, "true", sizeof("true")-1);
+        } else {
+            json_write(encoder, "false", sizeof("false")-1);
+        }
         break;
     case JSON_VALUE_TYPE_UINT64:
-        len = sprintf(encoder->je_encode_buf, "%llu",
-                      (long long unsigned)jv->jv_val.u);
-        encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+        len = json_fmt_uint(encoder->je_encode_buf, jv->jv_val.u);
+        json_write(encoder, encoder->je_encode_buf, len);
         break;
     case JSON_VALUE_TYPE_INT64:
-        len = sprintf(encoder->je_encode_buf, "%lld",
-                      (long long)jv->jv_val.u);
-        encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+        len = json_fmt_int(encoder->je_encode_buf, (int64_t)jv->jv_val.u);
+        json_write(encoder, encoder->je_encode_buf, len);
         break;
+#ifdef FLOAT_SUPPORT
+    case JSON_VALUE_TYPE_FLOAT:
+        len = json_fmt_float(encoder->je_encode_buf, jv->jv_val.fl);
+        json_write(encoder, encoder->je_encode_buf, len);
+        break;
+#endif
     case JSON_VALUE_TYPE_STRING:
-        encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-        for (i = 0; i < jv->jv_len; i++) {
-            switch (jv->jv_val.str[i]) {
-            case '"':
-            case '/':
-            case '\\':
-                encoder->je_write(encoder->je_arg, "\\",
-                                  sizeof("\\")-1);
-                encoder->je_write(encoder->je_arg,
-                                  (char *) &jv->jv_val.str[i], 1);
-
-                break;
-            case '\t':
-                encoder->je_write(encoder->je_arg, "\\t",
-                                  sizeof("\\t")-1);
-                break;
-            case '\r':
-                encoder->je_write(encoder->je_arg, "\\r",
-                                  sizeof("\\r")-1);
-                break;
-            case '\n':
-                encoder->je_write(encoder->je_arg, "\\n",
-                                  sizeof("\\n")-1);
-                break;
-            case '\f':
-                encoder->je_write(encoder->je_arg, "\\f",
-                                  sizeof("\\f")-1);
-                break;
-            case '\b':
-                encoder->je_write(encoder->je_arg, "\\b",
-                                  sizeof("\\b")-1);
-                break;
-            default:
-                encoder->je_write(encoder->je_arg,
-                                  (char *) &jv->jv_val.str[i], 1);
-                break;
-            }
-
-        }
-        encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
+        json_encode_string(encoder, jv->jv_val.str, jv->jv_len);
         break;
     case JSON_VALUE_TYPE_ARRAY:
         JSON_ENCODE_ARRAY_START(encoder);
@@ -121,7 +318,7 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
                 goto err;
             }
             if (i != jv->jv_len - 1) {
-                encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+                json_write(encoder, ",", sizeof(",")-1);
             }
         }
         JSON_ENCODE_ARRAY_END(encoder);
@@ -153,14 +350,14 @@ int
 json_encode_object_key(struct json_encoder *encoder, char *key)
 {
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
 
     /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_write(encoder, "\"", sizeof("\"")-1);
+    json_write(encoder, key, strlen(key));
+    json_write(encoder, "\": ", sizeof("\": ")-1);
 
     return (0);
 }
@@ -172,13 +369,13 @@ json_encode_object_entry(struct json_encoder *encoder, char *key,
     int rc;
 
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
     /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_write(encoder, "\"", sizeof("\"")-1);
+    json_write(encoder, key, strlen(key));
+    json_write(encoder, "\": ", sizeof("\": ")-1);
 
     rc = json_encode_value(encoder, val);
     if (rc != 0) {
@@ -222,7 +419,7 @@ json_encode_array_value(struct json_encoder *encoder, struct json_value *jv)
     int rc;
 
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
 
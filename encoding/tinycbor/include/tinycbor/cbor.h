@@ -193,6 +193,7 @@ CBOR_API CborError cbor_encode_text_string(CborEncoder *encoder, const char *str
 CBOR_INLINE_API CborError cbor_encode_text_stringz(CborEncoder *encoder, const char *string)
 { return cbor_encode_text_string(encoder, string, strlen(string)); }
 CBOR_API CborError cbor_encode_byte_string(CborEncoder *encoder, const uint8_t *string, size_t length);
+CBOR_API CborError cbor_encode_raw(CborEncoder *encoder, const void *data, size_t len, size_t items);
 CBOR_API CborError cbor_encode_byte_iovec(CborEncoder *encoder,
                                           const struct cbor_iovec iov[],
                                           int iov_len);
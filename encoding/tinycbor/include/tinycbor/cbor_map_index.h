@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CBOR_MAP_INDEX_H
+#define CBOR_MAP_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tinycbor/cbor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest text string key that gets indexed. */
+#define CBOR_MAP_INDEX_KEY_MAX  32
+
+struct cbor_map_index_entry {
+    CborValue key;                    /* the key; CborInvalidType if free */
+    CborValue value;
+    uint32_t hash;
+};
+
+/**
+ * Index of the text string keys of one map, so that looking up many keys
+ * doesn't walk the map once per key.  The table is provided by the caller;
+ * keys that don't fit in it, or are longer than CBOR_MAP_INDEX_KEY_MAX, are
+ * still found by falling back to cbor_value_map_find_value().
+ */
+struct cbor_map_index {
+    struct cbor_map_index_entry *table;
+    CborValue map;
+    uint16_t size;
+    uint16_t count;
+    uint8_t complete;                 /* every text key is in the table */
+};
+
+/**
+ * Walks the map once and records where each key and value is.  The data
+ * the map is read from must not change while the index is in use.
+ *
+ * @param index         The index to initialize.
+ * @param map           The map to index.
+ * @param table         Storage for the index.  Somewhat more entries than
+ *                      the expected number of keys keeps lookups short.
+ * @param size          Number of entries in table.
+ *
+ * @return              CborNoError, or the error the map failed to parse
+ *                      with.
+ */
+CborError cbor_map_index_init(struct cbor_map_index *index,
+                              const CborValue *map,
+                              struct cbor_map_index_entry *table,
+                              size_t size);
+
+/**
+ * Like cbor_value_map_find_value(), on an indexed map.
+ */
+CborError cbor_map_index_find(const struct cbor_map_index *index,
+                              const char *string, CborValue *element);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBOR_MAP_INDEX_H */
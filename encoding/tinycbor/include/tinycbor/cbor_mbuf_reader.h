@@ -31,6 +31,14 @@ struct cbor_mbuf_reader {
     struct cbor_decoder_reader r;
     int init_off;                     /* initial offset into the data */
     struct os_mbuf *m;
+
+    /*
+     * The mbuf the last read was in and its offset in the chain.  Parsing
+     * mostly moves forward, so reads start looking from here rather than
+     * from the head of the chain.
+     */
+    struct os_mbuf *cur;
+    int cur_off;
 };
 
 void cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
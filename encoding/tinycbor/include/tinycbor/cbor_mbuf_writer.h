@@ -30,10 +30,23 @@ extern "C" {
 struct cbor_mbuf_writer {
     struct cbor_encoder_writer enc;
     struct os_mbuf *m;
+    struct os_mbuf *tail;             /* last mbuf, as of the last write */
+    uint32_t tail_pktlen;             /* chain length as of the last write */
+    uint16_t seg_len;
 };
 
 void cbor_mbuf_writer_init(struct cbor_mbuf_writer *cb, struct os_mbuf *m);
 
+/**
+ * Initializes a writer that lays the encoded data out in segments of
+ * seg_len bytes.  Every segment after the first starts with its own packet
+ * header mbuf holding a copy of m's user header, so the chain can later be
+ * cut at segment boundaries into separate packets without copying.  The
+ * chain is still a single packet; only m's packet header describes it.
+ */
+void cbor_mbuf_writer_init_aligned(struct cbor_mbuf_writer *cb,
+                                   struct os_mbuf *m, uint16_t seg_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,425 @@
+#!/usr/bin/env python3
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+Generates C encoders and decoders for flat CBOR maps from a JSON schema.
+
+The map keys are encoded at generation time and written with
+cbor_encode_raw(); decoding is a single pass over the map that matches keys
+by length and memcmp().  With "json" set, each type also gets a JSON
+encoder, for encoding/json, with the keys and punctuation precomputed.
+
+Schema:
+
+    {
+        "name": "echo",
+        "json": true,
+        "types": [
+            {
+                "name": "echo_rsp",
+                "fields": [
+                    { "name": "r", "type": "text", "size": 128 },
+                    { "name": "rc", "type": "int" },
+                    { "name": "ok", "key": "success", "type": "bool" }
+                ]
+            }
+        ]
+    }
+
+Field types are int (int64_t), uint (uint64_t), bool and text (a
+NUL-terminated char array of the given size).  "key" defaults to the field
+name.  The output is <name>_cbor.h and <name>_cbor.c; the generated files
+are meant to be checked in next to the code using them.
+
+Usage: cbor_codegen.py <schema.json> <output directory>
+"""
+
+import json
+import os
+import sys
+
+LICENSE = """/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+"""
+
+C_TYPES = {
+    'int': 'int64_t',
+    'uint': 'uint64_t',
+    'bool': 'bool',
+}
+
+MAX_FIELDS = 32
+
+
+def cbor_head(major, val):
+    """Encodes a CBOR initial byte plus argument."""
+    if val < 24:
+        return bytes([(major << 5) | val])
+    for more, size in ((24, 1), (25, 2), (26, 4), (27, 8)):
+        if val < (1 << (8 * size)):
+            return bytes([(major << 5) | more]) + val.to_bytes(size, 'big')
+    raise ValueError(val)
+
+
+def cbor_text(s):
+    b = s.encode('utf-8')
+    return cbor_head(3, len(b)) + b
+
+
+def c_bytes(b):
+    return ', '.join('0x%02x' % x for x in b)
+
+
+def c_string(s):
+    out = ''
+    for ch in s:
+        if ch in '\\"':
+            out += '\\' + ch
+        elif ' ' <= ch <= '~':
+            out += ch
+        else:
+            out += '\\x%02x' % ord(ch)
+    return '"' + out + '"'
+
+
+def check_type(t):
+    fields = t['fields']
+    if len(fields) > MAX_FIELDS:
+        raise ValueError('%s: more than %d fields' % (t['name'], MAX_FIELDS))
+    for f in fields:
+        f.setdefault('key', f['name'])
+        if f['type'] == 'text':
+            if int(f.get('size', 0)) < 1:
+                raise ValueError('%s.%s: text needs a size' %
+                                 (t['name'], f['name']))
+        elif f['type'] not in C_TYPES:
+            raise ValueError('%s.%s: unknown type %s' %
+                             (t['name'], f['name'], f['type']))
+
+
+def write_header(out, schema):
+    guard = 'H_%s_CBOR_' % schema['name'].upper()
+    out.write(LICENSE)
+    out.write('\n/* Generated by cbor_codegen.py; do not edit. */\n\n')
+    out.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+    out.write('#include <stdbool.h>\n#include <stdint.h>\n')
+    out.write('#include "tinycbor/cbor.h"\n')
+    if schema.get('json'):
+        out.write('#include "json/json.h"\n')
+    out.write('\n')
+    out.write('#ifdef __cplusplus\nextern "C" {\n#endif\n\n')
+
+    for t in schema['types']:
+        n = t['name']
+        out.write('struct %s {\n' % n)
+        for f in t['fields']:
+            if f['type'] == 'text':
+                out.write('    char %s[%d];\n' % (f['name'], int(f['size'])))
+            else:
+                out.write('    %s %s;\n' % (C_TYPES[f['type']], f['name']))
+        out.write('};\n\n')
+
+        for i, f in enumerate(t['fields']):
+            out.write('#define %s_%s (1UL << %d)\n' %
+                      (n.upper(), f['name'].upper(), i))
+        out.write('\n')
+
+        out.write('CborError %s_encode(CborEncoder *enc,\n' % n)
+        out.write('%sconst struct %s *v);\n' % (' ' * (len(n) + 17), n))
+        out.write('\n/**\n')
+        out.write(' * Decodes the fields found in the map; the others are '
+                  'left untouched.\n')
+        out.write(' * Unknown keys are skipped.  If found is not NULL, it '
+                  'receives the\n')
+        out.write(' * %s_[...] bits of the fields that were present.\n' %
+                  n.upper())
+        out.write(' */\n')
+        out.write('CborError %s_decode(const CborValue *map, '
+                  'struct %s *v,\n' % (n, n))
+        out.write('%suint32_t *found);\n' % (' ' * (len(n) + 17)))
+        if schema.get('json'):
+            out.write('int %s_encode_json(struct json_encoder *enc,\n' % n)
+            out.write('%sconst struct %s *v);\n' % (' ' * (len(n) + 17), n))
+        out.write('\n')
+
+    out.write('#ifdef __cplusplus\n}\n#endif\n\n#endif\n')
+
+
+HELPERS = '''
+static CborError
+cbor_gen_text(CborValue *it, char *dst, size_t size)
+{
+    size_t len;
+    CborError err;
+
+    if (!cbor_value_is_text_string(it)) {
+        return CborErrorIllegalType;
+    }
+    len = size;
+    err = cbor_value_copy_text_string(it, dst, &len, it);
+    if (err == CborNoError && len >= size) {
+        /* No room left for the terminating NUL. */
+        err = CborErrorOutOfMemory;
+    }
+    return err;
+}
+
+static CborError
+cbor_gen_int(CborValue *it, int64_t *dst)
+{
+    CborError err;
+
+    if (!cbor_value_is_integer(it)) {
+        return CborErrorIllegalType;
+    }
+    err = cbor_value_get_int64(it, dst);
+    if (err == CborNoError) {
+        err = cbor_value_advance_fixed(it);
+    }
+    return err;
+}
+
+static CborError
+cbor_gen_uint(CborValue *it, uint64_t *dst)
+{
+    CborError err;
+
+    if (!cbor_value_is_unsigned_integer(it)) {
+        return CborErrorIllegalType;
+    }
+    err = cbor_value_get_uint64(it, dst);
+    if (err == CborNoError) {
+        err = cbor_value_advance_fixed(it);
+    }
+    return err;
+}
+
+static CborError
+cbor_gen_bool(CborValue *it, bool *dst)
+{
+    CborError err;
+
+    if (!cbor_value_is_boolean(it)) {
+        return CborErrorIllegalType;
+    }
+    err = cbor_value_get_boolean(it, dst);
+    if (err == CborNoError) {
+        err = cbor_value_advance_fixed(it);
+    }
+    return err;
+}
+'''
+
+JSON_HELPERS = '''
+static int
+json_gen_write(struct json_encoder *enc, const char *s, int len)
+{
+    return enc->je_write(enc->je_arg, (char *)s, len);
+}
+
+static int
+json_gen_text(struct json_encoder *enc, const char *s)
+{
+    struct json_value jv;
+    int rc;
+
+    /* Reuse json_encode's escaping through a one entry array encoder. */
+    JSON_VALUE_STRINGN(&jv, (char *)s, strlen(s));
+    enc->je_wr_commas = 0;
+    rc = json_encode_array_value(enc, &jv);
+    return rc;
+}
+
+static int
+json_gen_num(struct json_encoder *enc, const char *fmt, ...)
+{
+    char buf[24];
+    va_list ap;
+    int len;
+
+    va_start(ap, fmt);
+    len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return json_gen_write(enc, buf, len);
+}
+'''
+
+
+def write_source(out, schema):
+    out.write(LICENSE)
+    out.write('\n/* Generated by cbor_codegen.py; do not edit. */\n\n')
+    if schema.get('json'):
+        out.write('#include <stdarg.h>\n#include <stdio.h>\n')
+    out.write('#include <string.h>\n')
+    out.write('#include "%s_cbor.h"\n' % schema['name'])
+    out.write(HELPERS)
+    if schema.get('json'):
+        out.write(JSON_HELPERS)
+
+    for t in schema['types']:
+        n = t['name']
+        fields = t['fields']
+        maxkey = max(len(f['key'].encode('utf-8')) for f in fields)
+
+        out.write('\n')
+        for i, f in enumerate(fields):
+            kb = cbor_text(f['key'])
+            out.write('static const uint8_t %s_k%d[] = {\n' % (n, i))
+            for j in range(0, len(kb), 8):
+                out.write('    %s,\n' % c_bytes(kb[j:j + 8]))
+            out.write('};\n')
+
+        # CBOR encoder
+        out.write('\nCborError\n%s_encode(CborEncoder *enc, '
+                  'const struct %s *v)\n{\n' % (n, n))
+        out.write('    CborEncoder map;\n    CborError err;\n\n')
+        out.write('    err = cbor_encoder_create_map(enc, &map, %d);\n' %
+                  len(fields))
+        for i, f in enumerate(fields):
+            out.write('    err |= cbor_encode_raw(&map, %s_k%d, '
+                      'sizeof(%s_k%d), 1);\n' % (n, i, n, i))
+            if f['type'] == 'text':
+                out.write('    err |= cbor_encode_text_stringz(&map, '
+                          'v->%s);\n' % f['name'])
+            elif f['type'] == 'int':
+                out.write('    err |= cbor_encode_int(&map, v->%s);\n' %
+                          f['name'])
+            elif f['type'] == 'uint':
+                out.write('    err |= cbor_encode_uint(&map, v->%s);\n' %
+                          f['name'])
+            else:
+                out.write('    err |= cbor_encode_boolean(&map, v->%s);\n' %
+                          f['name'])
+        out.write('    err |= cbor_encoder_close_container(enc, &map);\n\n')
+        out.write('    return err;\n}\n')
+
+        # CBOR decoder
+        out.write('\nCborError\n%s_decode(const CborValue *map, '
+                  'struct %s *v, uint32_t *found)\n{\n' % (n, n))
+        out.write('    char key[%d];\n' % (maxkey + 1))
+        out.write('    uint32_t seen;\n    CborValue it;\n    CborValue k;\n')
+        out.write('    CborError err;\n    size_t len;\n\n')
+        out.write('    if (!cbor_value_is_map(map)) {\n'
+                  '        return CborErrorIllegalType;\n    }\n\n')
+        out.write('    seen = 0;\n')
+        out.write('    err = cbor_value_enter_container(map, &it);\n')
+        out.write('    while (err == CborNoError && '
+                  '!cbor_value_at_end(&it)) {\n')
+        out.write('        k = it;\n')
+        out.write('        len = sizeof(key);\n')
+        out.write('        if (!cbor_value_is_text_string(&k) ||\n'
+                  '            cbor_value_copy_text_string(&k, key, &len, '
+                  '&it) != CborNoError) {\n'
+                  '            /* Not one of ours; skip the key and the '
+                  'value. */\n'
+                  '            it = k;\n'
+                  '            err = cbor_value_advance(&it);\n'
+                  '            if (err == CborNoError) {\n'
+                  '                err = cbor_value_advance(&it);\n'
+                  '            }\n'
+                  '            continue;\n'
+                  '        }\n\n')
+        for i, f in enumerate(fields):
+            kb = f['key'].encode('utf-8')
+            kw = 'if' if i == 0 else '} else if'
+            out.write('        %s (len == %d && memcmp(key, %s, %d) == 0) {\n'
+                      % (kw, len(kb), c_string(f['key']), len(kb)))
+            if f['type'] == 'text':
+                out.write('            err = cbor_gen_text(&it, v->%s, '
+                          'sizeof(v->%s));\n' % (f['name'], f['name']))
+            else:
+                out.write('            err = cbor_gen_%s(&it, &v->%s);\n' %
+                          (f['type'], f['name']))
+            out.write('            seen |= %s_%s;\n' %
+                      (n.upper(), f['name'].upper()))
+        out.write('        } else {\n'
+                  '            err = cbor_value_advance(&it);\n'
+                  '        }\n'
+                  '    }\n\n')
+        out.write('    if (found != NULL) {\n'
+                  '        *found = seen;\n    }\n')
+        out.write('    return err;\n}\n')
+
+        if schema.get('json'):
+            write_json_encoder(out, t)
+
+
+def write_json_encoder(out, t):
+    n = t['name']
+    fields = t['fields']
+    out.write('\nint\n%s_encode_json(struct json_encoder *enc, '
+              'const struct %s *v)\n{\n' % (n, n))
+    out.write('    int rc;\n\n    rc = 0;\n')
+    for i, f in enumerate(fields):
+        prefix = ('{' if i == 0 else ',') + json.dumps(f['key']) + ':'
+        out.write('    rc |= json_gen_write(enc, %s, %d);\n' %
+                  (c_string(prefix), len(prefix.encode('utf-8'))))
+        if f['type'] == 'text':
+            out.write('    rc |= json_gen_text(enc, v->%s);\n' %
+                      f['name'])
+        elif f['type'] == 'int':
+            out.write('    rc |= json_gen_num(enc, "%%lld", '
+                      '(long long)v->%s);\n' % f['name'])
+        elif f['type'] == 'uint':
+            out.write('    rc |= json_gen_num(enc, "%%llu", '
+                      '(unsigned long long)v->%s);\n' % f['name'])
+        else:
+            out.write('    rc |= v->%s ? json_gen_write(enc, "true", 4) '
+                      ':\n'
+                      '                 json_gen_write(enc, "false", 5);\n'
+                      % f['name'])
+    out.write('    rc |= json_gen_write(enc, "}", 1);\n\n')
+    out.write('    return rc;\n}\n')
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[1]) as f:
+        schema = json.load(f)
+    for t in schema['types']:
+        check_type(t)
+
+    base = os.path.join(sys.argv[2], schema['name'] + '_cbor')
+    with open(base + '.h', 'w') as out:
+        write_header(out, schema)
+    with open(base + '.c', 'w') as out:
+        write_source(out, schema)
+
+
+if __name__ == '__main__':
+    main()
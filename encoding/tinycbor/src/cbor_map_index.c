@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <tinycbor/cbor_map_index.h>
+
+/* FNV-1a */
+static uint32_t
+cbor_map_index_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (len--) {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static void
+cbor_map_index_add(struct cbor_map_index *index, const CborValue *key,
+                   const CborValue *value, uint32_t hash)
+{
+    struct cbor_map_index_entry *e;
+    size_t slot;
+
+    if (index->count == index->size) {
+        index->complete = 0;
+        return;
+    }
+
+    /* Probed in insertion order, so the first of duplicate keys wins, as
+     * with cbor_value_map_find_value().
+     */
+    slot = hash % index->size;
+    while (index->table[slot].key.type != CborInvalidType) {
+        slot = (slot + 1) % index->size;
+    }
+    e = &index->table[slot];
+    e->key = *key;
+    e->value = *value;
+    e->hash = hash;
+    index->count++;
+}
+
+CborError
+cbor_map_index_init(struct cbor_map_index *index, const CborValue *map,
+                    struct cbor_map_index_entry *table, size_t size)
+{
+    char buf[CBOR_MAP_INDEX_KEY_MAX + 1];
+    CborValue key;
+    CborValue it;
+    CborError err;
+    size_t len;
+    size_t i;
+
+    assert(cbor_value_is_map(map));
+    assert(size > 0 && size <= UINT16_MAX);
+
+    index->table = table;
+    index->map = *map;
+    index->size = size;
+    index->count = 0;
+    index->complete = 1;
+    for (i = 0; i < size; i++) {
+        table[i].key.type = CborInvalidType;
+    }
+
+    err = cbor_value_enter_container(map, &it);
+    while (err == CborNoError && !cbor_value_at_end(&it)) {
+        err = cbor_value_skip_tag(&it);
+        if (err != CborNoError) {
+            break;
+        }
+        key = it;
+
+        len = sizeof(buf);
+        if (cbor_value_is_text_string(&key) &&
+            cbor_value_copy_text_string(&key, buf, &len, &it) ==
+            CborNoError && len <= CBOR_MAP_INDEX_KEY_MAX) {
+            cbor_map_index_add(index, &key, &it,
+                               cbor_map_index_hash(buf, len));
+        } else {
+            if (cbor_value_is_text_string(&key)) {
+                /* Too long to index. */
+                index->complete = 0;
+            }
+            it = key;
+            err = cbor_value_advance(&it);
+            if (err != CborNoError) {
+                break;
+            }
+        }
+
+        /* skip the value */
+        err = cbor_value_skip_tag(&it);
+        if (err == CborNoError) {
+            err = cbor_value_advance(&it);
+        }
+    }
+
+    return err;
+}
+
+CborError
+cbor_map_index_find(const struct cbor_map_index *index, const char *string,
+                    CborValue *element)
+{
+    const struct cbor_map_index_entry *e;
+    CborError err;
+    uint32_t hash;
+    size_t slot;
+    size_t len;
+    size_t n;
+    bool eq;
+
+    len = strlen(string);
+    if (len <= CBOR_MAP_INDEX_KEY_MAX) {
+        hash = cbor_map_index_hash(string, len);
+        slot = hash % index->size;
+        for (n = 0; n < index->size; n++) {
+            e = &index->table[slot];
+            if (e->key.type == CborInvalidType) {
+                break;
+            }
+            if (e->hash == hash) {
+                err = cbor_value_text_string_equals(&e->key, string, &eq);
+                if (err != CborNoError) {
+                    element->type = CborInvalidType;
+                    return err;
+                }
+                if (eq) {
+                    *element = e->value;
+                    return CborNoError;
+                }
+            }
+            slot = (slot + 1) % index->size;
+        }
+    }
+
+    if (!index->complete) {
+        return cbor_value_map_find_value(&index->map, string, element);
+    }
+
+    /* not found */
+    element->type = CborInvalidType;
+    return CborNoError;
+}
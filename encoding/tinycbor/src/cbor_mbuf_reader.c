@@ -17,17 +17,59 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor_mbuf_reader.h>
 #include <tinycbor/compilersupport_p.h>
 
+/*
+ * Returns the mbuf holding the given reader offset, and the offset within
+ * it.  A NULL return is fine to pass on to the os_mbuf functions, which
+ * then fail the read.
+ */
+static struct os_mbuf *
+cbor_mbuf_reader_seek(struct cbor_mbuf_reader *cb, int offset, int *moff)
+{
+    offset += cb->init_off;
+    if (offset < cb->cur_off) {
+        cb->cur = cb->m;
+        cb->cur_off = 0;
+    }
+    while (cb->cur != NULL && offset >= cb->cur_off + cb->cur->om_len) {
+        cb->cur_off += cb->cur->om_len;
+        cb->cur = SLIST_NEXT(cb->cur, om_next);
+    }
+
+    *moff = offset - cb->cur_off;
+    return cb->cur;
+}
+
+static int
+cbor_mbuf_reader_copy(struct cbor_mbuf_reader *cb, int offset, int len,
+                      void *dst)
+{
+    struct os_mbuf *om;
+    int moff;
+
+    om = cbor_mbuf_reader_seek(cb, offset, &moff);
+    if (om == NULL) {
+        return -1;
+    }
+    if (moff + len <= om->om_len) {
+        /* Within one segment; the common case. */
+        memcpy(dst, om->om_data + moff, len);
+        return 0;
+    }
+    return os_mbuf_copydata(om, moff, len, dst);
+}
+
 static uint8_t
 cbor_mbuf_reader_get8(struct cbor_decoder_reader *d, int offset)
 {
     uint8_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, sizeof(val), &val);
     return val;
 }
 
@@ -37,7 +79,7 @@ cbor_mbuf_reader_get16(struct cbor_decoder_reader *d, int offset)
     uint16_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, sizeof(val), &val);
     return cbor_ntohs(val);
 }
 
@@ -47,7 +89,7 @@ cbor_mbuf_reader_get32(struct cbor_decoder_reader *d, int offset)
     uint32_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, sizeof(val), &val);
     return cbor_ntohl(val);
 }
 
@@ -57,7 +99,7 @@ cbor_mbuf_reader_get64(struct cbor_decoder_reader *d, int offset)
     uint64_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, sizeof(val), &val);
     return cbor_ntohll(val);
 }
 
@@ -66,7 +108,17 @@ cbor_mbuf_reader_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
                      size_t len)
 {
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
-    return os_mbuf_cmpf(cb->m, offset + cb->init_off, buf, len) == 0;
+    struct os_mbuf *om;
+    int moff;
+
+    om = cbor_mbuf_reader_seek(cb, offset, &moff);
+    if (om == NULL) {
+        return false;
+    }
+    if (moff + len <= om->om_len) {
+        return memcmp(om->om_data + moff, buf, len) == 0;
+    }
+    return os_mbuf_cmpf(om, moff, buf, len) == 0;
 }
 
 static uintptr_t
@@ -76,7 +128,7 @@ cbor_mbuf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
     int rc;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    rc = os_mbuf_copydata(cb->m, offset + cb->init_off, len, dst);
+    rc = cbor_mbuf_reader_copy(cb, offset, len, dst);
     if (rc == 0) {
         return true;
     }
@@ -100,5 +152,7 @@ cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
     hdr = OS_MBUF_PKTHDR(m);
     cb->m = m;
     cb->init_off = initial_offset;
+    cb->cur = m;
+    cb->cur_off = 0;
     cb->r.message_size = hdr->omp_len - initial_offset;
 }
@@ -17,22 +17,125 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor.h>
 #include <tinycbor/cbor.h>
 #include <tinycbor/cbor_mbuf_writer.h>
 
+/*
+ * Returns the last mbuf of the chain.  The one found by the previous write
+ * is reused unless the chain's length changed since, meaning someone else
+ * modified the chain (e.g. trimmed it to rewrite a response).
+ */
+static struct os_mbuf *
+cbor_mbuf_writer_tail(struct cbor_mbuf_writer *cb)
+{
+    struct os_mbuf *last;
+
+    if (cb->tail == NULL || cb->tail_pktlen != OS_MBUF_PKTLEN(cb->m)) {
+        cb->tail = cb->m;
+    }
+    last = cb->tail;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+    cb->tail = last;
+    return last;
+}
+
+/*
+ * Appends to the chain.  When the tail mbuf has room the data is copied
+ * straight into it; only at mbuf boundaries does os_mbuf_append() walk the
+ * chain and allocate.
+ */
+static int
+cbor_mbuf_writer_append(struct cbor_mbuf_writer *cb, const char *data,
+                        int len)
+{
+    struct os_mbuf *last;
+    int rc;
+
+    if (!OS_MBUF_IS_PKTHDR(cb->m)) {
+        return os_mbuf_append(cb->m, data, len);
+    }
+
+    last = cbor_mbuf_writer_tail(cb);
+    if (OS_MBUF_TRAILINGSPACE(last) >= len) {
+        memcpy(last->om_data + last->om_len, data, len);
+        last->om_len += len;
+        OS_MBUF_PKTHDR(cb->m)->omp_len += len;
+        rc = 0;
+    } else {
+        rc = os_mbuf_append(cb->m, data, len);
+    }
+    cb->tail_pktlen = OS_MBUF_PKTLEN(cb->m);
+    return rc;
+}
+
+/*
+ * Starts a new segment: a packet header mbuf, carrying a copy of the chain's
+ * user header, linked to the end of the chain.
+ */
+static int
+cbor_mbuf_writer_new_seg(struct cbor_mbuf_writer *cb)
+{
+    struct os_mbuf *last;
+    struct os_mbuf *seg;
+
+    last = cbor_mbuf_writer_tail(cb);
+    if (last != cb->m && last->om_len == 0 && OS_MBUF_IS_PKTHDR(last)) {
+        return 0; /* previous attempt left an empty segment behind */
+    }
+
+    seg = os_mbuf_get_pkthdr(cb->m->om_omp, OS_MBUF_USRHDR_LEN(cb->m));
+    if (seg == NULL) {
+        return -1;
+    }
+    memcpy(OS_MBUF_USRHDR(seg), OS_MBUF_USRHDR(cb->m),
+           OS_MBUF_USRHDR_LEN(cb->m));
+    SLIST_NEXT(last, om_next) = seg;
+    cb->tail = seg;
+
+    return 0;
+}
+
 int
 cbor_mbuf_writer(struct cbor_encoder_writer *arg, const char *data, int len)
 {
     int rc;
+    int off;
+    int chunk;
     struct cbor_mbuf_writer *cb = (struct cbor_mbuf_writer *) arg;
 
-    rc = os_mbuf_append(cb->m, data, len);
-    if (rc) {
-        return CborErrorOutOfMemory;
+    if (cb->seg_len == 0) {
+        rc = cbor_mbuf_writer_append(cb, data, len);
+        if (rc) {
+            return CborErrorOutOfMemory;
+        }
+        cb->enc.bytes_written += len;
+        return CborNoError;
+    }
+
+    while (len > 0) {
+        off = OS_MBUF_PKTLEN(cb->m) % cb->seg_len;
+        if (off == 0 && OS_MBUF_PKTLEN(cb->m) != 0) {
+            if (cbor_mbuf_writer_new_seg(cb)) {
+                return CborErrorOutOfMemory;
+            }
+        }
+        chunk = cb->seg_len - off;
+        if (chunk > len) {
+            chunk = len;
+        }
+        rc = cbor_mbuf_writer_append(cb, data, chunk);
+        if (rc) {
+            return CborErrorOutOfMemory;
+        }
+        cb->enc.bytes_written += chunk;
+        data += chunk;
+        len -= chunk;
     }
-    cb->enc.bytes_written += len;
     return CborNoError;
 }
 
@@ -41,7 +144,17 @@ void
 cbor_mbuf_writer_init(struct cbor_mbuf_writer *cb, struct os_mbuf *m)
 {
     cb->m = m;
+    cb->tail = NULL;
+    cb->seg_len = 0;
     cb->enc.bytes_written = 0;
     cb->enc.write = &cbor_mbuf_writer;
 }
 
+void
+cbor_mbuf_writer_init_aligned(struct cbor_mbuf_writer *cb, struct os_mbuf *m,
+                              uint16_t seg_len)
+{
+    cbor_mbuf_writer_init(cb, m);
+    cb->seg_len = seg_len;
+}
+
@@ -451,6 +451,19 @@ CborError cbor_encode_text_string(CborEncoder *encoder, const char *string, size
     return encode_string(encoder, length, TextStringType << MajorTypeShift, string);
 }
 
+/**
+ * Appends \a len bytes of already encoded CBOR from \a data to the stream
+ * provided by \a encoder, counting them as \a items items of the enclosing
+ * container (a map key and its value are two). This is meant for constant
+ * data such as map keys that are encoded once, at build time; TinyCBOR does
+ * not check that \a data is valid CBOR.
+ */
+CborError cbor_encode_raw(CborEncoder *encoder, const void *data, size_t len, size_t items)
+{
+    encoder->added += items;
+    return append_to_buffer(encoder, data, len);
+}
+
 #ifdef __GNUC__
 __attribute__((noinline))
 #endif
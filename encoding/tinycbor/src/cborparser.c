@@ -982,6 +982,11 @@ static CborError iterate_string_chunks(const CborValue *value, char *buffer, siz
         }
     }
 
+    /* comparing: the string is longer than the value */
+    if (*result && *buflen > total && func == value->parser->d->cmp) {
+        *result = false;
+    }
+
     /* is there enough room for the ending NUL byte? */
     if (*result && *buflen > total) {
         /* we are just trying to write a NULL byte here,, but this is hard
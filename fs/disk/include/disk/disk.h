@@ -49,6 +49,98 @@ char *disk_fs_for(const char *disk_name);
 char *disk_name_from_path(const char *path);
 char *disk_filepath_from_path(const char *path);
 
+#if MYNEWT_VAL(DISK_BDEV)
+
+#define DISK_REQ_READ       0
+#define DISK_REQ_WRITE      1
+
+/** Metadata request; dispatched ahead of queued data requests. */
+#define DISK_REQ_F_META     0x01
+
+/**
+ * A block device request.  The submitter owns the request and its buffer
+ * until it completes.
+ */
+struct disk_req {
+    /** Completion event; the submitter sets ev_cb and ev_arg. */
+    struct os_event dr_ev;
+
+    /**
+     * Queue the completion event is posted to.  If NULL, ev_cb (if any)
+     * is called directly from the dispatching task.
+     */
+    struct os_eventq *dr_evq;
+
+    /** DISK_REQ_READ or DISK_REQ_WRITE. */
+    uint8_t dr_op;
+
+    /** DISK_REQ_F_[...] flags. */
+    uint8_t dr_flags;
+
+    uint32_t dr_sector;
+    uint32_t dr_count;
+    void *dr_buf;
+
+    /** Driver result; set on completion. */
+    int dr_rc;
+
+    TAILQ_ENTRY(disk_req) dr_next;
+};
+
+TAILQ_HEAD(disk_req_list, disk_req);
+
+/**
+ * A block device: a disk driver plus its request queues.
+ */
+struct disk_bdev {
+    const char *db_name;
+    struct disk_ops *db_dops;
+    uint8_t db_id;
+    uint16_t db_sector_size;
+
+    /** Sector following the last dispatched request (elevator head). */
+    uint32_t db_head;
+
+    struct os_mutex db_mtx;
+
+    /** Pending requests, metadata and data, each sorted by sector. */
+    struct disk_req_list db_meta_q;
+    struct disk_req_list db_data_q;
+
+    SLIST_ENTRY(disk_bdev) db_next;
+};
+
+/**
+ * Registers a block device.  Requests are passed to dops->read/write with
+ * id as the device number and byte addresses.
+ */
+int disk_bdev_register(struct disk_bdev *bdev, const char *name,
+                       struct disk_ops *dops, uint8_t id,
+                       uint16_t sector_size);
+
+struct disk_bdev *disk_bdev_find(const char *name);
+
+/**
+ * Queues a request without dispatching it.  A batch of requests queued
+ * this way is sorted and merged when the queue is next run.
+ */
+int disk_bdev_submit(struct disk_bdev *bdev, struct disk_req *req);
+
+/**
+ * Dispatches all queued requests in elevator order, completing each.
+ *
+ * @return                      Number of driver calls made.
+ */
+int disk_bdev_run(struct disk_bdev *bdev);
+
+/** Synchronous read and write helpers; flags are DISK_REQ_F_[...]. */
+int disk_bdev_read(struct disk_bdev *bdev, uint32_t sector, uint32_t count,
+                   void *buf, uint8_t flags);
+int disk_bdev_write(struct disk_bdev *bdev, uint32_t sector, uint32_t count,
+                    const void *buf, uint8_t flags);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,360 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(DISK_BDEV)
+
+#include <string.h>
+#include <disk/disk.h>
+
+/*
+ * Block device layer.
+ *
+ * Requests are queued per device, metadata and data separately, each
+ * kept sorted by sector.  The queue is run as a one-way elevator: the next
+ * request is the first one at or past the head position, wrapping to the
+ * lowest sector at the end of the sweep; metadata requests always go
+ * first.  Runs of adjacent requests of the same kind are merged into one
+ * driver call through a bounce buffer.
+ *
+ * A request that overlaps one already queued forces the queue to be run
+ * first, so reordering never changes what a read returns.
+ */
+
+#define DISK_BDEV_MERGE_BUF_SIZE    MYNEWT_VAL(DISK_BDEV_MERGE_BUF_SIZE)
+
+static SLIST_HEAD(, disk_bdev) disk_bdevs = SLIST_HEAD_INITIALIZER();
+
+#if DISK_BDEV_MERGE_BUF_SIZE > 0
+static uint8_t disk_bdev_merge_buf[DISK_BDEV_MERGE_BUF_SIZE]
+    __attribute__((aligned(4)));
+static struct os_mutex disk_bdev_merge_mtx;
+#endif
+
+int
+disk_bdev_register(struct disk_bdev *bdev, const char *name,
+                   struct disk_ops *dops, uint8_t id, uint16_t sector_size)
+{
+    if (bdev == NULL || name == NULL || dops == NULL || sector_size == 0) {
+        return DISK_ENOENT;
+    }
+
+    if (disk_bdev_find(name) != NULL) {
+        return DISK_ENOENT;
+    }
+
+#if DISK_BDEV_MERGE_BUF_SIZE > 0
+    if (SLIST_EMPTY(&disk_bdevs)) {
+        os_mutex_init(&disk_bdev_merge_mtx);
+    }
+#endif
+
+    memset(bdev, 0, sizeof(*bdev));
+    bdev->db_name = name;
+    bdev->db_dops = dops;
+    bdev->db_id = id;
+    bdev->db_sector_size = sector_size;
+    os_mutex_init(&bdev->db_mtx);
+    TAILQ_INIT(&bdev->db_meta_q);
+    TAILQ_INIT(&bdev->db_data_q);
+
+    SLIST_INSERT_HEAD(&disk_bdevs, bdev, db_next);
+
+    return DISK_EOK;
+}
+
+struct disk_bdev *
+disk_bdev_find(const char *name)
+{
+    struct disk_bdev *bdev;
+
+    SLIST_FOREACH(bdev, &disk_bdevs, db_next) {
+        if (strcmp(bdev->db_name, name) == 0) {
+            return bdev;
+        }
+    }
+
+    return NULL;
+}
+
+static int
+disk_bdev_overlaps(const struct disk_req_list *q, const struct disk_req *req)
+{
+    const struct disk_req *cur;
+
+    TAILQ_FOREACH(cur, q, dr_next) {
+        if (cur->dr_sector < req->dr_sector + req->dr_count &&
+            req->dr_sector < cur->dr_sector + cur->dr_count) {
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void
+disk_bdev_insert(struct disk_req_list *q, struct disk_req *req)
+{
+    struct disk_req *cur;
+
+    TAILQ_FOREACH(cur, q, dr_next) {
+        if (cur->dr_sector > req->dr_sector) {
+            TAILQ_INSERT_BEFORE(cur, req, dr_next);
+            return;
+        }
+    }
+
+    TAILQ_INSERT_TAIL(q, req, dr_next);
+}
+
+static void
+disk_bdev_complete(struct disk_req *req, int rc)
+{
+    req->dr_rc = rc;
+
+    if (req->dr_evq != NULL) {
+        os_eventq_put(req->dr_evq, &req->dr_ev);
+    } else if (req->dr_ev.ev_cb != NULL) {
+        req->dr_ev.ev_cb(&req->dr_ev);
+    }
+}
+
+static int
+disk_bdev_xfer(struct disk_bdev *bdev, uint8_t op, uint32_t sector,
+               uint32_t count, void *buf)
+{
+    uint32_t addr;
+    uint32_t len;
+
+    addr = sector * bdev->db_sector_size;
+    len = count * bdev->db_sector_size;
+
+    if (op == DISK_REQ_READ) {
+        return bdev->db_dops->read(bdev->db_id, addr, buf, len);
+    } else {
+        return bdev->db_dops->write(bdev->db_id, addr, buf, len);
+    }
+}
+
+/*
+ * Picks the next request of a queue in elevator order.
+ */
+static struct disk_req *
+disk_bdev_pick(struct disk_bdev *bdev, struct disk_req_list *q)
+{
+    struct disk_req *req;
+
+    TAILQ_FOREACH(req, q, dr_next) {
+        if (req->dr_sector >= bdev->db_head) {
+            return req;
+        }
+    }
+
+    return TAILQ_FIRST(q);
+}
+
+/*
+ * Dispatches the request at the head of the elevator together with any
+ * directly following requests it can be merged with.  Called with the
+ * device lock held.
+ */
+static void
+disk_bdev_dispatch(struct disk_bdev *bdev, struct disk_req_list *q)
+{
+    struct disk_req_list batch;
+    struct disk_req *first;
+#if DISK_BDEV_MERGE_BUF_SIZE > 0
+    struct disk_req *req;
+    struct disk_req *next;
+    uint32_t off;
+#endif
+    uint32_t count;
+    int rc;
+
+    first = disk_bdev_pick(bdev, q);
+    TAILQ_REMOVE(q, first, dr_next);
+
+    TAILQ_INIT(&batch);
+    TAILQ_INSERT_TAIL(&batch, first, dr_next);
+    count = first->dr_count;
+
+#if DISK_BDEV_MERGE_BUF_SIZE > 0
+    req = TAILQ_FIRST(q);
+    while (req != NULL && req->dr_sector < first->dr_sector + count) {
+        req = TAILQ_NEXT(req, dr_next);
+    }
+    while (req != NULL &&
+           req->dr_op == first->dr_op &&
+           req->dr_sector == first->dr_sector + count &&
+           (count + req->dr_count) * bdev->db_sector_size <=
+           DISK_BDEV_MERGE_BUF_SIZE) {
+
+        next = TAILQ_NEXT(req, dr_next);
+        TAILQ_REMOVE(q, req, dr_next);
+        TAILQ_INSERT_TAIL(&batch, req, dr_next);
+        count += req->dr_count;
+        req = next;
+    }
+#endif
+
+    bdev->db_head = first->dr_sector + count;
+
+    if (TAILQ_NEXT(first, dr_next) == NULL) {
+        rc = disk_bdev_xfer(bdev, first->dr_op, first->dr_sector,
+                            first->dr_count, first->dr_buf);
+        TAILQ_REMOVE(&batch, first, dr_next);
+        disk_bdev_complete(first, rc);
+        return;
+    }
+
+#if DISK_BDEV_MERGE_BUF_SIZE > 0
+    os_mutex_pend(&disk_bdev_merge_mtx, OS_TIMEOUT_NEVER);
+
+    if (first->dr_op == DISK_REQ_WRITE) {
+        off = 0;
+        TAILQ_FOREACH(req, &batch, dr_next) {
+            memcpy(disk_bdev_merge_buf + off, req->dr_buf,
+                   req->dr_count * bdev->db_sector_size);
+            off += req->dr_count * bdev->db_sector_size;
+        }
+    }
+
+    rc = disk_bdev_xfer(bdev, first->dr_op, first->dr_sector, count,
+                        disk_bdev_merge_buf);
+
+    off = 0;
+    while ((req = TAILQ_FIRST(&batch)) != NULL) {
+        TAILQ_REMOVE(&batch, req, dr_next);
+        if (first->dr_op == DISK_REQ_READ && rc == 0) {
+            memcpy(req->dr_buf, disk_bdev_merge_buf + off,
+                   req->dr_count * bdev->db_sector_size);
+        }
+        off += req->dr_count * bdev->db_sector_size;
+        disk_bdev_complete(req, rc);
+    }
+
+    os_mutex_release(&disk_bdev_merge_mtx);
+#endif
+}
+
+static int
+disk_bdev_run_locked(struct disk_bdev *bdev)
+{
+    int cnt;
+
+    cnt = 0;
+    while (1) {
+        if (!TAILQ_EMPTY(&bdev->db_meta_q)) {
+            disk_bdev_dispatch(bdev, &bdev->db_meta_q);
+        } else if (!TAILQ_EMPTY(&bdev->db_data_q)) {
+            disk_bdev_dispatch(bdev, &bdev->db_data_q);
+        } else {
+            break;
+        }
+        cnt++;
+    }
+
+    return cnt;
+}
+
+int
+disk_bdev_submit(struct disk_bdev *bdev, struct disk_req *req)
+{
+    if (bdev == NULL || req == NULL || req->dr_count == 0 ||
+        req->dr_buf == NULL || req->dr_op > DISK_REQ_WRITE) {
+
+        return DISK_ENOENT;
+    }
+
+    req->dr_rc = 0;
+
+    os_mutex_pend(&bdev->db_mtx, OS_TIMEOUT_NEVER);
+
+    if (disk_bdev_overlaps(&bdev->db_meta_q, req) ||
+        disk_bdev_overlaps(&bdev->db_data_q, req)) {
+
+        disk_bdev_run_locked(bdev);
+    }
+
+    if (req->dr_flags & DISK_REQ_F_META) {
+        disk_bdev_insert(&bdev->db_meta_q, req);
+    } else {
+        disk_bdev_insert(&bdev->db_data_q, req);
+    }
+
+    os_mutex_release(&bdev->db_mtx);
+
+    return DISK_EOK;
+}
+
+int
+disk_bdev_run(struct disk_bdev *bdev)
+{
+    int cnt;
+
+    os_mutex_pend(&bdev->db_mtx, OS_TIMEOUT_NEVER);
+    cnt = disk_bdev_run_locked(bdev);
+    os_mutex_release(&bdev->db_mtx);
+
+    return cnt;
+}
+
+static int
+disk_bdev_rw(struct disk_bdev *bdev, uint8_t op, uint32_t sector,
+             uint32_t count, void *buf, uint8_t flags)
+{
+    struct disk_req req;
+    int rc;
+
+    memset(&req, 0, sizeof(req));
+    req.dr_op = op;
+    req.dr_flags = flags;
+    req.dr_sector = sector;
+    req.dr_count = count;
+    req.dr_buf = buf;
+
+    rc = disk_bdev_submit(bdev, &req);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Runs everything queued so far, this request included. */
+    disk_bdev_run(bdev);
+
+    return req.dr_rc;
+}
+
+int
+disk_bdev_read(struct disk_bdev *bdev, uint32_t sector, uint32_t count,
+               void *buf, uint8_t flags)
+{
+    return disk_bdev_rw(bdev, DISK_REQ_READ, sector, count, buf, flags);
+}
+
+int
+disk_bdev_write(struct disk_bdev *bdev, uint32_t sector, uint32_t count,
+                const void *buf, uint8_t flags)
+{
+    return disk_bdev_rw(bdev, DISK_REQ_WRITE, sector, count, (void *)buf,
+                        flags);
+}
+
+#endif
@@ -251,6 +251,26 @@ err:
     return fatfs_path;
 }
 
+#if MYNEWT_VAL(FATFS_FAST_SEEK)
+static void
+fatfs_fast_seek_enable(FIL *file)
+{
+    DWORD *tbl;
+
+    tbl = malloc(MYNEWT_VAL(FATFS_FAST_SEEK_TBL_LEN) * sizeof(DWORD));
+    if (tbl == NULL) {
+        return;
+    }
+
+    tbl[0] = MYNEWT_VAL(FATFS_FAST_SEEK_TBL_LEN);
+    file->cltbl = tbl;
+    if (f_lseek(file, CREATE_LINKMAP) != FR_OK) {
+        file->cltbl = NULL;
+        free(tbl);
+    }
+}
+#endif
+
 static int
 fatfs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
 {
@@ -299,6 +319,16 @@ fatfs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
         goto out;
     }
 
+#if MYNEWT_VAL(FATFS_FAST_SEEK)
+    /*
+     * FatFs cannot grow a file in fast seek mode, so only read-only files
+     * get a link map.  Failing to build one just leaves normal seeking.
+     */
+    if (!(access_flags & FS_ACCESS_WRITE)) {
+        fatfs_fast_seek_enable(out_file);
+    }
+#endif
+
     file->file = out_file;
     file->fops = &fatfs_ops;
     *out_fs_file = (struct fs_file *) file;
@@ -321,6 +351,9 @@ fatfs_close(struct fs_file *fs_file)
 
     if (file != NULL) {
         res = f_close(file);
+#if MYNEWT_VAL(FATFS_FAST_SEEK)
+        free(file->cltbl);
+#endif
         free(file);
     }
 
@@ -578,49 +611,279 @@ static struct disk_ops *dops_from_handle(BYTE pdrv)
     return NULL;
 }
 
-DRESULT
-disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+static int
+fatfs_disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 {
-    int rc;
-    uint32_t address;
-    uint32_t num_bytes;
     struct disk_ops *dops;
 
     /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
-    address = (uint32_t) sector * 512;
-    num_bytes = (uint32_t) count * 512;
+    dops = dops_from_handle(pdrv);
+    if (dops == NULL) {
+        return -1;
+    }
+
+    return dops->read(pdrv, (uint32_t)sector * 512, (void *)buff,
+                      (uint32_t)count * 512);
+}
+
+static int
+fatfs_disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    struct disk_ops *dops;
 
     dops = dops_from_handle(pdrv);
     if (dops == NULL) {
-        return STA_NOINIT;
+        return -1;
+    }
+
+    return dops->write(pdrv, (uint32_t)sector * 512, (const void *)buff,
+                       (uint32_t)count * 512);
+}
+
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+
+/*
+ * Sector cache.
+ *
+ * FatFs keeps a single sector window per volume, so walking the FAT for a
+ * seek or looking up a path keeps re-reading the same few sectors.  The
+ * cache keeps the most recently used single sectors of all volumes;
+ * multi-sector transfers, which FatFs only issues for bulk file data, go
+ * straight to the disk and only update sectors that are already cached.
+ */
+
+#define FATFS_CACHE_SECTORS     MYNEWT_VAL(FATFS_CACHE_SECTORS)
+
+struct fatfs_cache_entry {
+    DWORD fce_sector;
+    uint32_t fce_used;      /* LRU stamp; 0 means the entry is free. */
+    BYTE fce_pdrv;
+    uint8_t fce_dirty;
+};
+
+static struct fatfs_cache_entry fatfs_cache[FATFS_CACHE_SECTORS];
+static BYTE fatfs_cache_buf[FATFS_CACHE_SECTORS][512]
+    __attribute__((aligned(4)));
+static uint32_t fatfs_cache_clock;
+
+static struct fatfs_cache_entry *
+fatfs_cache_find(BYTE pdrv, DWORD sector)
+{
+    struct fatfs_cache_entry *fce;
+    int i;
+
+    for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+        fce = &fatfs_cache[i];
+        if (fce->fce_used != 0 && fce->fce_pdrv == pdrv &&
+            fce->fce_sector == sector) {
+
+            return fce;
+        }
+    }
+
+    return NULL;
+}
+
+static BYTE *
+fatfs_cache_data(const struct fatfs_cache_entry *fce)
+{
+    return fatfs_cache_buf[fce - fatfs_cache];
+}
+
+static void
+fatfs_cache_touch(struct fatfs_cache_entry *fce)
+{
+    fce->fce_used = ++fatfs_cache_clock;
+    if (fce->fce_used == 0) {
+        /* Stamp wrapped; keep 0 reserved for free entries. */
+        fce->fce_used = ++fatfs_cache_clock;
+    }
+}
+
+static int
+fatfs_cache_clean(struct fatfs_cache_entry *fce)
+{
+    int rc;
+
+    if (!fce->fce_dirty) {
+        return 0;
     }
 
-    rc = dops->read(pdrv, address, (void *) buff, num_bytes);
+    rc = fatfs_disk_write(fce->fce_pdrv, fatfs_cache_data(fce),
+                          fce->fce_sector, 1);
     if (rc < 0) {
-        return STA_NOINIT;
+        return rc;
     }
 
-    return RES_OK;
+    fce->fce_dirty = 0;
+    return 0;
 }
 
-DRESULT
-disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+/*
+ * Picks a free entry, or evicts the least recently used one, writing it
+ * back first if dirty.
+ */
+static struct fatfs_cache_entry *
+fatfs_cache_alloc(void)
 {
+    struct fatfs_cache_entry *victim;
+    struct fatfs_cache_entry *fce;
+    int i;
+
+    victim = &fatfs_cache[0];
+    for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+        fce = &fatfs_cache[i];
+        if (fce->fce_used == 0) {
+            return fce;
+        }
+        if ((int32_t)(fce->fce_used - victim->fce_used) < 0) {
+            victim = fce;
+        }
+    }
+
+    if (fatfs_cache_clean(victim) < 0) {
+        return NULL;
+    }
+    victim->fce_used = 0;
+
+    return victim;
+}
+
+static int
+fatfs_cache_flush(BYTE pdrv)
+{
+    struct fatfs_cache_entry *fce;
     int rc;
-    uint32_t address;
-    uint32_t num_bytes;
-    struct disk_ops *dops;
+    int i;
+
+    for (i = 0; i < FATFS_CACHE_SECTORS; i++) {
+        fce = &fatfs_cache[i];
+        if (fce->fce_used != 0 && fce->fce_pdrv == pdrv) {
+            rc = fatfs_cache_clean(fce);
+            if (rc < 0) {
+                return rc;
+            }
+        }
+    }
 
-    /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
-    address = (uint32_t) sector * 512;
-    num_bytes = (uint32_t) count * 512;
+    return 0;
+}
 
-    dops = dops_from_handle(pdrv);
-    if (dops == NULL) {
+static int
+fatfs_cache_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_entry *fce;
+    UINT i;
+    int rc;
+
+    if (count > 1) {
+        rc = fatfs_disk_read(pdrv, buff, sector, count);
+        if (rc < 0) {
+            return rc;
+        }
+
+        /* Cached copies of these sectors may be newer than the disk. */
+        for (i = 0; i < count; i++) {
+            fce = fatfs_cache_find(pdrv, sector + i);
+            if (fce != NULL && fce->fce_dirty) {
+                memcpy(buff + i * 512, fatfs_cache_data(fce), 512);
+            }
+        }
+        return 0;
+    }
+
+    fce = fatfs_cache_find(pdrv, sector);
+    if (fce == NULL) {
+        fce = fatfs_cache_alloc();
+        if (fce == NULL) {
+            return -1;
+        }
+
+        rc = fatfs_disk_read(pdrv, fatfs_cache_data(fce), sector, 1);
+        if (rc < 0) {
+            return rc;
+        }
+        fce->fce_pdrv = pdrv;
+        fce->fce_sector = sector;
+        fce->fce_dirty = 0;
+    }
+
+    fatfs_cache_touch(fce);
+    memcpy(buff, fatfs_cache_data(fce), 512);
+
+    return 0;
+}
+
+static int
+fatfs_cache_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_entry *fce;
+    UINT i;
+    int rc;
+
+    if (count > 1 || !MYNEWT_VAL(FATFS_CACHE_WRITE_BACK)) {
+        rc = fatfs_disk_write(pdrv, buff, sector, count);
+        if (rc < 0) {
+            return rc;
+        }
+
+        /* Keep cached copies in step with what was written. */
+        for (i = 0; i < count; i++) {
+            fce = fatfs_cache_find(pdrv, sector + i);
+            if (fce != NULL) {
+                memcpy(fatfs_cache_data(fce), buff + i * 512, 512);
+                fce->fce_dirty = 0;
+            }
+        }
+        return 0;
+    }
+
+    fce = fatfs_cache_find(pdrv, sector);
+    if (fce == NULL) {
+        fce = fatfs_cache_alloc();
+        if (fce == NULL) {
+            return -1;
+        }
+        fce->fce_pdrv = pdrv;
+        fce->fce_sector = sector;
+    }
+
+    memcpy(fatfs_cache_data(fce), buff, 512);
+    fce->fce_dirty = 1;
+    fatfs_cache_touch(fce);
+
+    return 0;
+}
+
+#endif
+
+DRESULT
+disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+    int rc;
+
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    rc = fatfs_cache_read(pdrv, buff, sector, count);
+#else
+    rc = fatfs_disk_read(pdrv, buff, sector, count);
+#endif
+    if (rc < 0) {
         return STA_NOINIT;
     }
 
-    rc = dops->write(pdrv, address, (const void *) buff, num_bytes);
+    return RES_OK;
+}
+
+DRESULT
+disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+    int rc;
+
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    rc = fatfs_cache_write(pdrv, buff, sector, count);
+#else
+    rc = fatfs_disk_write(pdrv, buff, sector, count);
+#endif
     if (rc < 0) {
         return STA_NOINIT;
     }
@@ -631,6 +894,13 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
 DRESULT
 disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
 {
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    /* FatFs syncs the volume from f_sync() and f_close(). */
+    if (cmd == CTRL_SYNC && fatfs_cache_flush(pdrv) < 0) {
+        return RES_ERROR;
+    }
+#endif
+
     return RES_OK;
 }
 
@@ -90,6 +90,39 @@ int fcb_init(struct fcb *fcb);
 int fcb_append(struct fcb *, uint16_t len, struct fcb_entry *loc);
 int fcb_append_finish(struct fcb *, struct fcb_entry *append_loc);
 
+/**
+ * RAM staging area for appending several entries with one flash write.
+ * The entries are laid out in the buffer exactly as they will be in flash.
+ */
+struct fcb_batch {
+    uint8_t *fb_buf;		/* Caller supplied staging buffer */
+    uint16_t fb_size;		/* Size of fb_buf */
+    uint16_t fb_len;		/* Number of bytes of fb_buf in use */
+    uint16_t fb_cnt;		/* Number of entries reserved */
+};
+
+/**
+ * fcb_batch_init() prepares a batch using buf as the staging area.
+ */
+void fcb_batch_init(struct fcb_batch *batch, void *buf, uint16_t size);
+
+/**
+ * fcb_batch_reserve() adds an entry of len bytes to the batch. The entry
+ * contents should be written to *data before fcb_batch_commit() is called.
+ * Returns FCB_ERR_NOMEM if the entry does not fit in the staging buffer.
+ */
+int fcb_batch_reserve(struct fcb *, struct fcb_batch *batch, uint16_t len,
+                      void **data);
+
+/**
+ * fcb_batch_commit() writes all entries in the batch to flash with a single
+ * write; the whole batch is placed in one sector. If first_loc is not NULL,
+ * it is filled in with the location of the first entry, the rest can be
+ * reached with fcb_getnext(). The batch is emptied on success.
+ */
+int fcb_batch_commit(struct fcb *, struct fcb_batch *batch,
+                     struct fcb_entry *first_loc);
+
 /**
  * Walk over all entries in FCB.
  * cb gets called for every entry. If cb wants to stop the walk, it should
@@ -102,6 +135,24 @@ typedef int (*fcb_walk_cb)(struct fcb_entry *loc, void *arg);
 int fcb_walk(struct fcb *, struct flash_area *, fcb_walk_cb cb, void *cb_arg);
 int fcb_getnext(struct fcb *, struct fcb_entry *loc);
 
+/**
+ * Walk over entries in FCB from newest to oldest. Arguments and return
+ * values are the same as with fcb_walk().
+ */
+int fcb_walk_back(struct fcb *, struct flash_area *, fcb_walk_cb cb,
+                  void *cb_arg);
+
+/**
+ * fcb_getprev() finds the previous valid entry backwards from loc, and
+ * fills in the location of that entry. To get the newest entry set
+ * loc->fe_area to NULL. Returns FCB_ERR_NOVAR once the oldest entry has
+ * been passed.
+ *
+ * Entries are variable length and have no back links, so each step reads
+ * the element headers of the sector up to loc.
+ */
+int fcb_getprev(struct fcb *, struct fcb_entry *loc);
+
 /**
  * Erases the data from oldest sector.
  */
@@ -142,11 +142,13 @@ TEST_CASE_DECL(fcb_test_empty_walk)
 TEST_CASE_DECL(fcb_test_append)
 TEST_CASE_DECL(fcb_test_append_too_big)
 TEST_CASE_DECL(fcb_test_append_fill)
+TEST_CASE_DECL(fcb_test_batch)
 TEST_CASE_DECL(fcb_test_reset)
 TEST_CASE_DECL(fcb_test_rotate)
 TEST_CASE_DECL(fcb_test_multiple_scratch)
 TEST_CASE_DECL(fcb_test_last_of_n)
 TEST_CASE_DECL(fcb_test_area_info)
+TEST_CASE_DECL(fcb_test_getprev)
 
 TEST_SUITE(fcb_test_all)
 {
@@ -156,11 +158,13 @@ TEST_SUITE(fcb_test_all)
     fcb_test_append();
     fcb_test_append_too_big();
     fcb_test_append_fill();
+    fcb_test_batch();
     fcb_test_reset();
     fcb_test_rotate();
     fcb_test_multiple_scratch();
     fcb_test_last_of_n();
     fcb_test_area_info();
+    fcb_test_getprev();
 }
 
 int
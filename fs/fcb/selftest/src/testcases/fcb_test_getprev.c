@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+static int
+fcb_test_append_len(struct fcb *fcb, int len, struct fcb_entry *loc)
+{
+    uint8_t test_data[128];
+    int rc;
+    int i;
+
+    rc = fcb_append(fcb, len, loc);
+    if (rc) {
+        return rc;
+    }
+    for (i = 0; i < len; i++) {
+        test_data[i] = fcb_test_append_data(len, i);
+    }
+    rc = flash_area_write(loc->fe_area, loc->fe_data_off, test_data, len);
+    TEST_ASSERT(rc == 0);
+
+    return fcb_append_finish(fcb, loc);
+}
+
+#define FCB_TEST_GETPREV_MAX 64
+
+static struct fcb_entry fwd[FCB_TEST_GETPREV_MAX];
+
+struct walk_back_arg {
+    int next_len;
+    int cnt;
+};
+
+static int
+fcb_test_walk_back_cb(struct fcb_entry *loc, void *arg)
+{
+    struct walk_back_arg *wa = (struct walk_back_arg *)arg;
+
+    TEST_ASSERT(loc->fe_data_len == wa->next_len);
+    wa->next_len = wa->next_len == 1 ? 128 : wa->next_len - 1;
+    wa->cnt++;
+    return 0;
+}
+
+TEST_CASE_SELF(fcb_test_getprev)
+{
+    struct fcb *fcb = &test_fcb;
+    struct fcb_entry loc;
+    struct fcb_entry prev;
+    struct walk_back_arg wa;
+    int area_cnt[2];
+    int rc;
+    int i, j;
+
+    fcb_tc_pretest(3);
+
+    /*
+     * Empty FCB returns error.
+     */
+    prev.fe_area = NULL;
+    rc = fcb_getprev(fcb, &prev);
+    TEST_ASSERT_FATAL(rc == FCB_ERR_NOVAR);
+
+    /*
+     * Add one entry. getprev should find that guy, and then error.
+     */
+    rc = fcb_test_append_len(fcb, 8, &loc);
+    TEST_ASSERT(rc == 0);
+
+    prev.fe_area = NULL;
+    rc = fcb_getprev(fcb, &prev);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(prev.fe_area == loc.fe_area);
+    TEST_ASSERT(prev.fe_elem_off == loc.fe_elem_off);
+    TEST_ASSERT(prev.fe_data_len == 8);
+
+    rc = fcb_getprev(fcb, &prev);
+    TEST_ASSERT(rc == FCB_ERR_NOVAR);
+
+    /*
+     * Add enough entries to go to 3 sectors, should find them all.
+     */
+    fcb_tc_pretest(3);
+    memset(area_cnt, 0, sizeof(area_cnt));
+    for (i = 0; ; i++) {
+        rc = fcb_test_append_len(fcb, i % 128 + 1, &loc);
+        TEST_ASSERT(rc == 0);
+        if (loc.fe_area == &test_fcb_area[2]) {
+            break;
+        }
+        area_cnt[loc.fe_area - &test_fcb_area[0]]++;
+    }
+
+    prev.fe_area = NULL;
+    for (j = i; j >= 0; j--) {
+        rc = fcb_getprev(fcb, &prev);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(prev.fe_data_len == j % 128 + 1);
+    }
+    rc = fcb_getprev(fcb, &prev);
+    TEST_ASSERT(rc == FCB_ERR_NOVAR);
+
+    /*
+     * Walk back within one sector only.
+     */
+    wa.next_len = (i - 1) % 128 + 1;
+    wa.cnt = 0;
+    rc = fcb_walk_back(fcb, &test_fcb_area[1], fcb_test_walk_back_cb, &wa);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(wa.cnt == area_cnt[1]);
+
+    /*
+     * Unfinished appends are corrupt entries; they should be skipped, the
+     * same way fcb_getnext() skips them.
+     */
+    fcb_tc_pretest(3);
+    rc = fcb_test_append_len(fcb, 10, &loc);
+    TEST_ASSERT(rc == 0);
+    do {
+        rc = fcb_append(fcb, 128, &loc);
+        TEST_ASSERT(rc == 0);
+    } while (loc.fe_area != &test_fcb_area[2]);
+    rc = fcb_test_append_len(fcb, 20, &loc);
+    TEST_ASSERT(rc == 0);
+
+    memset(&loc, 0, sizeof(loc));
+    for (i = 0; fcb_getnext(fcb, &loc) == 0; i++) {
+        TEST_ASSERT_FATAL(i < FCB_TEST_GETPREV_MAX);
+        fwd[i] = loc;
+    }
+    TEST_ASSERT(fwd[0].fe_data_len == 10);
+    TEST_ASSERT(fwd[i - 1].fe_data_len == 20);
+
+    prev.fe_area = NULL;
+    for (j = i - 1; j >= 0; j--) {
+        rc = fcb_getprev(fcb, &prev);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(prev.fe_area == fwd[j].fe_area);
+        TEST_ASSERT(prev.fe_elem_off == fwd[j].fe_elem_off);
+    }
+    rc = fcb_getprev(fcb, &prev);
+    TEST_ASSERT(rc == FCB_ERR_NOVAR);
+
+    /*
+     * Fill, rotate, add one more, and then walk backwards past the
+     * wrap point.
+     */
+    fcb_tc_pretest(3);
+    for (i = 0; ; i++) {
+        rc = fcb_test_append_len(fcb, i % 128 + 1, &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        TEST_ASSERT(rc == 0);
+    }
+    rc = fcb_rotate(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_test_append_len(fcb, i % 128 + 1, &loc);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(loc.fe_area == &test_fcb_area[0]);
+
+    wa.next_len = i % 128 + 1;
+    wa.cnt = 0;
+    rc = fcb_walk_back(fcb, NULL, fcb_test_walk_back_cb, &wa);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(wa.cnt > 1);
+
+    rc = fcb_offset_last_n(fcb, 2, &prev);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(prev.fe_data_len == (i - 1) % 128 + 1);
+}
@@ -88,8 +88,12 @@ fcb_init(struct fcb *fcb)
      */
     assert((fcb->f_align & (fcb->f_align - 1)) == 0);
 
+    /*
+     * Find the end of the active area. Only element lengths are needed for
+     * this, element data is verified when it gets read.
+     */
     while (1) {
-        rc = fcb_getnext_in_area(fcb, &fcb->f_active);
+        rc = fcb_skip_in_area(fcb, &fcb->f_active);
         if (rc == FCB_ERR_NOVAR) {
             rc = FCB_OK;
             break;
@@ -173,6 +177,13 @@ fcb_sector_hdr_init(struct fcb *fcb, struct flash_area *fap, uint16_t id)
     fda._pad = 0xff;
     fda.fd_id = id;
 
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    /* Sector might still be queued for erase by fcb_rotate(). */
+    rc = flash_area_preerase_wait(fap, 0, fap->fa_size);
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+#endif
     rc = flash_area_write(fap, 0, &fda, sizeof(fda));
     if (rc) {
         return FCB_ERR_FLASH;
@@ -230,16 +241,11 @@ fcb_offset_last_n(struct fcb *fcb, uint8_t entries,
         entries = 1;
     }
 
+    /* Step back from the newest entry, stopping early at the oldest one */
     i = 0;
     memset(&loc, 0, sizeof(loc));
-    while (!fcb_getnext(fcb, &loc)) {
-        if (i == 0) {
-            /* Start from the beginning of fcb entries */
-            *last_n_entry = loc;
-        } else if (i > (entries - 1)) {
-            /* Update last_n_entry after n entries and keep updating */
-            fcb_getnext(fcb, last_n_entry);
-        }
+    while (i < entries && !fcb_getprev(fcb, &loc)) {
+        *last_n_entry = loc;
         i++;
     }
 
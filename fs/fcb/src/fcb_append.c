@@ -17,9 +17,11 @@
  * under the License.
  */
 #include <stddef.h>
+#include <string.h>
 
 #include "fcb/fcb.h"
 #include "fcb_priv.h"
+#include "crc/crc8.h"
 
 static struct flash_area *
 fcb_new_area(struct fcb *fcb, int cnt)
@@ -66,11 +68,39 @@ fcb_append_to_scratch(struct fcb *fcb)
     return FCB_OK;
 }
 
+/*
+ * Make sure the active area has room for len more bytes, moving on to a new
+ * area if necessary. Must be called with f_mtx held.
+ */
+static int
+fcb_reserve_space(struct fcb *fcb, int len)
+{
+    struct fcb_entry *active;
+    struct flash_area *fa;
+    int rc;
+
+    active = &fcb->f_active;
+    if (active->fe_elem_off + len > active->fe_area->fa_size) {
+        fa = fcb_new_area(fcb, fcb->f_scratch_cnt);
+        if (!fa || (fa->fa_size <
+            sizeof(struct fcb_disk_area) + len)) {
+            return FCB_ERR_NOSPACE;
+        }
+        rc = fcb_sector_hdr_init(fcb, fa, fcb->f_active_id + 1);
+        if (rc) {
+            return rc;
+        }
+        fcb->f_active.fe_area = fa;
+        fcb->f_active.fe_elem_off = fcb_len_in_flash(fcb, sizeof(struct fcb_disk_area));
+        fcb->f_active_id++;
+    }
+    return FCB_OK;
+}
+
 int
 fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
 {
     struct fcb_entry *active;
-    struct flash_area *fa;
     uint8_t tmp_str[2];
     int cnt;
     int rc;
@@ -87,20 +117,9 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
         return FCB_ERR_ARGS;
     }
     active = &fcb->f_active;
-    if (active->fe_elem_off + len + cnt > active->fe_area->fa_size) {
-        fa = fcb_new_area(fcb, fcb->f_scratch_cnt);
-        if (!fa || (fa->fa_size <
-            sizeof(struct fcb_disk_area) + len + cnt)) {
-            rc = FCB_ERR_NOSPACE;
-            goto err;
-        }
-        rc = fcb_sector_hdr_init(fcb, fa, fcb->f_active_id + 1);
-        if (rc) {
-            goto err;
-        }
-        fcb->f_active.fe_area = fa;
-        fcb->f_active.fe_elem_off = fcb_len_in_flash(fcb, sizeof(struct fcb_disk_area));
-        fcb->f_active_id++;
+    rc = fcb_reserve_space(fcb, len + cnt);
+    if (rc) {
+        goto err;
     }
 
     rc = flash_area_write(active->fe_area, active->fe_elem_off, tmp_str, cnt);
@@ -143,3 +162,127 @@ fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
     }
     return 0;
 }
+
+void
+fcb_batch_init(struct fcb_batch *batch, void *buf, uint16_t size)
+{
+    batch->fb_buf = buf;
+    batch->fb_size = size;
+    batch->fb_len = 0;
+    batch->fb_cnt = 0;
+}
+
+int
+fcb_batch_reserve(struct fcb *fcb, struct fcb_batch *batch, uint16_t len,
+                  void **data)
+{
+    uint8_t *elem;
+    int cnt;
+    int elem_len;
+
+    elem = batch->fb_buf + batch->fb_len;
+    if (batch->fb_len + 2 > batch->fb_size) {
+        return FCB_ERR_NOMEM;
+    }
+    cnt = fcb_put_len(elem, len);
+    if (cnt < 0) {
+        return cnt;
+    }
+    elem_len = fcb_len_in_flash(fcb, cnt) + fcb_len_in_flash(fcb, len) +
+      fcb_len_in_flash(fcb, FCB_CRC_SZ);
+    if (batch->fb_len + elem_len > batch->fb_size) {
+        return FCB_ERR_NOMEM;
+    }
+
+    /*
+     * Alignment padding goes out to flash with the entries, keep it at the
+     * erased value.
+     */
+    memset(elem + cnt, 0xff, elem_len - cnt);
+    *data = elem + fcb_len_in_flash(fcb, cnt);
+
+    batch->fb_len += elem_len;
+    batch->fb_cnt++;
+    return FCB_OK;
+}
+
+int
+fcb_batch_commit(struct fcb *fcb, struct fcb_batch *batch,
+                 struct fcb_entry *first_loc)
+{
+    struct fcb_entry *active;
+    uint8_t *elem;
+    uint8_t *last;
+    uint8_t *end;
+    uint16_t len;
+    uint8_t crc8;
+    int cnt;
+    int rc;
+
+    if (batch->fb_cnt == 0) {
+        return FCB_ERR_ARGS;
+    }
+
+    /*
+     * The data is already in RAM, so the CRCs can be filled in before
+     * anything is written.
+     */
+    last = batch->fb_buf;
+    elem = batch->fb_buf;
+    end = batch->fb_buf + batch->fb_len;
+    while (elem < end) {
+        cnt = fcb_get_len(elem, &len);
+        crc8 = crc8_init();
+        crc8 = crc8_calc(crc8, elem, cnt);
+        cnt = fcb_len_in_flash(fcb, cnt);
+        crc8 = crc8_calc(crc8, elem + cnt, len);
+        len = fcb_len_in_flash(fcb, len);
+        elem[cnt + len] = crc8;
+
+        last = elem;
+        elem += cnt + len + fcb_len_in_flash(fcb, FCB_CRC_SZ);
+    }
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+    active = &fcb->f_active;
+    rc = fcb_reserve_space(fcb, batch->fb_len);
+    if (rc) {
+        goto err;
+    }
+
+    rc = flash_area_write(active->fe_area, active->fe_elem_off,
+                          batch->fb_buf, batch->fb_len);
+    if (rc) {
+        rc = FCB_ERR_FLASH;
+        goto err;
+    }
+
+    if (first_loc) {
+        first_loc->fe_area = active->fe_area;
+        first_loc->fe_elem_off = active->fe_elem_off;
+        cnt = fcb_get_len(batch->fb_buf, &len);
+        first_loc->fe_data_off = active->fe_elem_off +
+          fcb_len_in_flash(fcb, cnt);
+        first_loc->fe_data_len = len;
+    }
+
+    /* Leave the active entry pointing at the last entry of the batch. */
+    cnt = fcb_get_len(last, &len);
+    active->fe_data_off = active->fe_elem_off + (last - batch->fb_buf) +
+      fcb_len_in_flash(fcb, cnt);
+    active->fe_data_len = fcb_len_in_flash(fcb, len) +
+      fcb_len_in_flash(fcb, FCB_CRC_SZ);
+    active->fe_elem_off += batch->fb_len;
+
+    os_mutex_release(&fcb->f_mtx);
+
+    batch->fb_len = 0;
+    batch->fb_cnt = 0;
+    return FCB_OK;
+err:
+    os_mutex_release(&fcb->f_mtx);
+    return rc;
+}
@@ -23,40 +23,71 @@
 #include "fcb_priv.h"
 
 /*
- * Given offset in flash area, fill in rest of the fcb_entry, and crc8 over
- * the data.
+ * Read length of element at given offset in flash area. Fills in rest of the
+ * fcb_entry and the encoded length, returns number of bytes in encoded
+ * length or one of FCB_ERR_XXX.
  */
-int
-fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
+static int
+fcb_elem_len(struct fcb *fcb, struct fcb_entry *loc, uint8_t *len_buf)
 {
-    uint8_t tmp_str[FCB_TMP_BUF_SZ];
-    int cnt;
-    int blk_sz;
-    uint8_t crc8;
     uint16_t len;
-    uint32_t off;
-    uint32_t end;
+    int cnt;
     int rc;
 
     if (loc->fe_elem_off + 2 > loc->fe_area->fa_size) {
         return FCB_ERR_NOVAR;
     }
-    rc = flash_area_read_is_empty(loc->fe_area, loc->fe_elem_off, tmp_str, 2);
+    rc = flash_area_read_is_empty(loc->fe_area, loc->fe_elem_off, len_buf, 2);
     if (rc < 0) {
         return FCB_ERR_FLASH;
     } else if (rc == 1) {
         return FCB_ERR_NOVAR;
     }
 
-    cnt = fcb_get_len(tmp_str, &len);
+    cnt = fcb_get_len(len_buf, &len);
     loc->fe_data_off = loc->fe_elem_off + fcb_len_in_flash(fcb, cnt);
     loc->fe_data_len = len;
 
+    return cnt;
+}
+
+/*
+ * Given offset in flash area, fill in rest of the fcb_entry, and crc8 over
+ * the data.
+ */
+int
+fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
+{
+    uint8_t tmp_str[FCB_TMP_BUF_SZ];
+    int cnt;
+    int blk_sz;
+    uint8_t crc8;
+    uint16_t len;
+    uint32_t off;
+    uint32_t end;
+    int rc;
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    const void *data;
+#endif
+
+    cnt = fcb_elem_len(fcb, loc, tmp_str);
+    if (cnt < 0) {
+        return cnt;
+    }
+    len = loc->fe_data_len;
+
     crc8 = crc8_init();
     crc8 = crc8_calc(crc8, tmp_str, cnt);
 
     off = loc->fe_data_off;
     end = loc->fe_data_off + len;
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    data = flash_area_mmap(loc->fe_area, off, len);
+    if (data) {
+        *c8p = crc8_calc(crc8, (void *)data, len);
+        return 0;
+    }
+#endif
     for (; off < end; off += blk_sz) {
         blk_sz = end - off;
         if (blk_sz > sizeof(tmp_str)) {
@@ -74,6 +105,20 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
     return 0;
 }
 
+/*
+ * Given offset in flash area, fill in rest of the fcb_entry without reading
+ * or verifying the data.
+ */
+int
+fcb_elem_hdr(struct fcb *fcb, struct fcb_entry *loc)
+{
+    uint8_t len_buf[2];
+    int rc;
+
+    rc = fcb_elem_len(fcb, loc, len_buf);
+    return rc < 0 ? rc : 0;
+}
+
 int
 fcb_elem_info(struct fcb *fcb, struct fcb_entry *loc)
 {
@@ -21,18 +21,19 @@
 #include "fcb/fcb.h"
 #include "fcb_priv.h"
 
-int
-fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc)
+static int
+fcb_getnext_in_area_with(struct fcb *fcb, struct fcb_entry *loc,
+                         int (*elem_info)(struct fcb *, struct fcb_entry *))
 {
     int rc;
 
-    rc = fcb_elem_info(fcb, loc);
+    rc = elem_info(fcb, loc);
     if (rc == 0 || rc == FCB_ERR_CRC) {
         do {
             loc->fe_elem_off = loc->fe_data_off +
               fcb_len_in_flash(fcb, loc->fe_data_len) +
               fcb_len_in_flash(fcb, FCB_CRC_SZ);
-            rc = fcb_elem_info(fcb, loc);
+            rc = elem_info(fcb, loc);
             if (rc != FCB_ERR_CRC) {
                 break;
             }
@@ -41,6 +42,18 @@ fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc)
     return rc;
 }
 
+int
+fcb_getnext_in_area(struct fcb *fcb, struct fcb_entry *loc)
+{
+    return fcb_getnext_in_area_with(fcb, loc, fcb_elem_info);
+}
+
+int
+fcb_skip_in_area(struct fcb *fcb, struct fcb_entry *loc)
+{
+    return fcb_getnext_in_area_with(fcb, loc, fcb_elem_hdr);
+}
+
 struct flash_area *
 fcb_getnext_area(struct fcb *fcb, struct flash_area *fap)
 {
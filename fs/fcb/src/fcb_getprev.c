@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stddef.h>
+
+#include "fcb/fcb.h"
+#include "fcb_priv.h"
+
+static struct flash_area *
+fcb_getprev_area(struct fcb *fcb, struct flash_area *fap)
+{
+    if (fap == &fcb->f_sectors[0]) {
+        fap = &fcb->f_sectors[fcb->f_sector_cnt];
+    }
+    return fap - 1;
+}
+
+/*
+ * Find the last valid element in loc->fe_area which starts before offset
+ * 'end'. Elements are variable length, so the area is scanned from the
+ * start reading only element headers; crc is checked just for the element
+ * that is returned.
+ */
+static int
+fcb_area_find_prev(struct fcb *fcb, struct fcb_entry *loc, uint32_t end)
+{
+    struct fcb_entry cur;
+    uint32_t prev;
+    int rc;
+
+    while (1) {
+        cur.fe_area = loc->fe_area;
+        cur.fe_elem_off = fcb_len_in_flash(fcb, sizeof(struct fcb_disk_area));
+        prev = 0;
+        while (cur.fe_elem_off < end) {
+            rc = fcb_elem_hdr(fcb, &cur);
+            if (rc == FCB_ERR_NOVAR) {
+                break;
+            } else if (rc) {
+                return rc;
+            }
+            prev = cur.fe_elem_off;
+            cur.fe_elem_off = cur.fe_data_off +
+              fcb_len_in_flash(fcb, cur.fe_data_len) +
+              fcb_len_in_flash(fcb, FCB_CRC_SZ);
+        }
+        if (prev == 0) {
+            return FCB_ERR_NOVAR;
+        }
+        loc->fe_elem_off = prev;
+        rc = fcb_elem_info(fcb, loc);
+        if (rc != FCB_ERR_CRC) {
+            return rc;
+        }
+        /*
+         * Corrupt element, look for the one before it.
+         */
+        end = prev;
+    }
+}
+
+int
+fcb_getprev_nolock(struct fcb *fcb, struct fcb_entry *loc)
+{
+    uint32_t end;
+    int rc;
+
+    if (loc->fe_area == NULL) {
+        /*
+         * Find the last element.
+         */
+        loc->fe_area = fcb->f_active.fe_area;
+        end = loc->fe_area->fa_size;
+    } else {
+        end = loc->fe_elem_off;
+    }
+    while (1) {
+        rc = fcb_area_find_prev(fcb, loc, end);
+        if (rc != FCB_ERR_NOVAR) {
+            return rc;
+        }
+        if (loc->fe_area == fcb->f_oldest) {
+            return FCB_ERR_NOVAR;
+        }
+        loc->fe_area = fcb_getprev_area(fcb, loc->fe_area);
+        end = loc->fe_area->fa_size;
+    }
+}
+
+int
+fcb_getprev(struct fcb *fcb, struct fcb_entry *loc)
+{
+    int rc;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+    rc = fcb_getprev_nolock(fcb, loc);
+    os_mutex_release(&fcb->f_mtx);
+
+    return rc;
+}
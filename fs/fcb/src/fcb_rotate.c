@@ -31,7 +31,18 @@ fcb_rotate(struct fcb *fcb)
         return FCB_ERR_ARGS;
     }
 
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    /*
+     * Let the sector be erased in the background; it gets waited on when
+     * the sector is taken into use again.
+     */
+    rc = flash_area_preerase(fcb->f_oldest, 0, fcb->f_oldest->fa_size);
+    if (rc) {
+        rc = flash_area_erase(fcb->f_oldest, 0, fcb->f_oldest->fa_size);
+    }
+#else
     rc = flash_area_erase(fcb->f_oldest, 0, fcb->f_oldest->fa_size);
+#endif
     if (rc) {
         rc = FCB_ERR_FLASH;
         goto out;
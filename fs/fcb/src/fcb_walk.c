@@ -51,3 +51,41 @@ fcb_walk(struct fcb *fcb, struct flash_area *fap, fcb_walk_cb cb, void *cb_arg)
     os_mutex_release(&fcb->f_mtx);
     return 0;
 }
+
+/*
+ * Like fcb_walk(), but elements are reported from newest to oldest. If fap
+ * is specified, only elements within that flash_area are reported.
+ */
+int
+fcb_walk_back(struct fcb *fcb, struct flash_area *fap, fcb_walk_cb cb,
+              void *cb_arg)
+{
+    struct fcb_entry loc;
+    int rc;
+
+    loc.fe_area = fap;
+    if (fap) {
+        loc.fe_elem_off = fap->fa_size;
+    }
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+    while ((rc = fcb_getprev_nolock(fcb, &loc)) != FCB_ERR_NOVAR) {
+        os_mutex_release(&fcb->f_mtx);
+        if (rc) {
+            return rc;
+        }
+        if (fap && loc.fe_area != fap) {
+            return 0;
+        }
+        rc = cb(&loc, cb_arg);
+        if (rc) {
+            return rc;
+        }
+        os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    }
+    os_mutex_release(&fcb->f_mtx);
+    return 0;
+}
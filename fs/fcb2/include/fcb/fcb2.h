@@ -35,6 +35,10 @@ extern "C" {
 #include <syscfg/syscfg.h>
 #include <os/os_mutex.h>
 #include <flash_map/flash_map.h>
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+#include <os/queue.h>
+#include <os/os_callout.h>
+#endif
 
 #define FCB2_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
 
@@ -74,8 +78,42 @@ struct fcb2 {
     struct os_mutex f_mtx;	/* Locking for accessing the FCB data */
     struct fcb2_entry f_active;
     uint16_t f_active_id;
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+    struct fcb2_cache *f_cache; /* Write-back cache, if configured */
+#endif
+};
+
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+/* Number of flash pages cached; one for entry data, one for entries. */
+#define FCB2_CACHE_PAGES         2
+
+/**
+ * One cached flash page. Only bytes between cp_lo and cp_hi are dirty.
+ */
+struct fcb2_cache_page {
+    uint8_t *cp_buf;        /* Page sized buffer */
+    struct flash_sector_range *cp_range; /* Range page belongs to */
+    uint32_t cp_off;        /* Offset of page within range flash area */
+    uint16_t cp_lo;         /* Start of dirty data within page */
+    uint16_t cp_hi;         /* End of dirty data within page, 0 if clean */
+    uint8_t cp_age;         /* For picking which page to evict */
 };
 
+/**
+ * Write-back cache for an FCB.
+ */
+struct fcb2_cache {
+    SLIST_ENTRY(fcb2_cache) fc_next;
+    struct fcb2 *fc_fcb;
+    uint16_t fc_page_size;
+    uint8_t fc_age;
+#if MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)
+    struct os_callout fc_timer;
+#endif
+    struct fcb2_cache_page fc_pages[FCB2_CACHE_PAGES];
+};
+#endif
+
 /**
  * Error codes.
  */
@@ -158,6 +196,60 @@ int fcb2_write(struct fcb2_entry *loc, uint16_t off, const void *buf,
  */
 int fcb2_append_finish(struct fcb2_entry *append_loc);
 
+/**
+ * RAM staging area for appending several entries at once. Entry data is
+ * laid out from the start of the buffer and entry descriptors from its end,
+ * the same way they are placed within a sector.
+ */
+struct fcb2_batch {
+    uint8_t *fb_buf;        /* Caller supplied staging buffer */
+    uint16_t fb_size;       /* Size of fb_buf */
+    uint16_t fb_data_len;   /* Bytes of entry data and CRCs in fb_buf */
+    uint16_t fb_cnt;        /* Number of entries reserved */
+    uint8_t fb_align;       /* Flash alignment the batch is laid out for */
+};
+
+/**
+ * Prepare a batch for use.
+ *
+ * @param batch          Batch to initialize
+ * @param buf            Staging buffer for the entries
+ * @param size           Size of the staging buffer
+ */
+void fcb2_batch_init(struct fcb2_batch *batch, void *buf, uint16_t size);
+
+/**
+ * Reserve space for an entry within a batch. Caller fills in the entry
+ * contents through data before calling fcb2_batch_commit().
+ *
+ * @param fcb            FCB the batch will be appended to.
+ * @param batch          Batch to add the entry to
+ * @param len            Size of the entry being added
+ * @param data           Will be filled with the location of the entry data
+ *                       within the staging buffer
+ *
+ * @return 0 on success. FCB2_ERR_NOMEM if the entry does not fit in the
+ *         staging buffer, otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_batch_reserve(struct fcb2 *fcb, struct fcb2_batch *batch,
+                       uint16_t len, void **data);
+
+/**
+ * Write all entries of a batch to FCB. The whole batch is placed within one
+ * sector; entry descriptors and entry data are each written with a single
+ * flash write. The batch is emptied on success; after FCB2_ERR_FLASH it has
+ * to be initialized again.
+ *
+ * @param fcb            FCB this batch is being appended to.
+ * @param batch          Batch to write
+ * @param first_loc      If not NULL, filled with the location of the first
+ *                       entry of the batch
+ *
+ * @return 0 on success. Otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_batch_commit(struct fcb2 *fcb, struct fcb2_batch *batch,
+                      struct fcb2_entry *first_loc);
+
 /**
  * Callback routine getting called when walking through FCB entries.
  * Entry data can be read by using fcb2_read().
@@ -293,6 +385,35 @@ int fcb2_get_total_size(const struct fcb2 *fcb);
  */
 int fcb2_clear(struct fcb2 *fcb);
 
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+/**
+ * Start caching writes to FCB in RAM. Writes are gathered into page sized
+ * chunks and programmed when a page fills up, after
+ * FCB2_WRITE_CACHE_TIMEOUT milliseconds, or when fcb2_flush() is called.
+ * Reads done through FCB see the cached data.
+ *
+ * @param fcb            FCB to cache; must have been initialized with
+ *                       fcb2_init().
+ * @param cache          Cache state
+ * @param buf            Buffer for the cache, FCB2_CACHE_PAGES * page_size
+ *                       bytes long
+ * @param page_size      Flash page size, power of two
+ *
+ * @return 0 on success. Otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_cache_init(struct fcb2 *fcb, struct fcb2_cache *cache, void *buf,
+                    uint16_t page_size);
+
+/**
+ * Write all cached data to flash.
+ *
+ * @param fcb            FCB to flush
+ *
+ * @return 0 on success. Otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_flush(struct fcb2 *fcb);
+#endif
+
 /**
  * Usage report for a given FCB sector. Returns number of elements and the
  * number of bytes stored in them.
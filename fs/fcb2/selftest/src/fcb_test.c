@@ -143,6 +143,8 @@ TEST_CASE_DECL(fcb_test_empty_walk)
 TEST_CASE_DECL(fcb_test_append)
 TEST_CASE_DECL(fcb_test_append_too_big)
 TEST_CASE_DECL(fcb_test_append_fill)
+TEST_CASE_DECL(fcb_test_batch)
+TEST_CASE_DECL(fcb_test_cache)
 TEST_CASE_DECL(fcb_test_append_fill_small)
 TEST_CASE_DECL(fcb_test_reset)
 TEST_CASE_DECL(fcb_test_rotate)
@@ -158,6 +160,10 @@ TEST_SUITE(fcb_test_all)
     fcb_test_append();
     fcb_test_append_too_big();
     fcb_test_append_fill();
+    fcb_test_batch();
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+    fcb_test_cache();
+#endif
     fcb_test_append_fill_small();
     fcb_test_reset();
     fcb_test_rotate();
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+TEST_CASE_SELF(fcb_test_batch)
+{
+    int rc;
+    struct fcb2 *fcb;
+    struct fcb2_batch batch;
+    struct fcb2_entry loc;
+    uint8_t batch_buf[1024];
+    uint8_t *data;
+    int first_len;
+    int i;
+    int j;
+    int var_cnt;
+
+    fcb_tc_pretest(2);
+
+    fcb = &test_fcb;
+
+    /* Entry that does not fit the staging buffer */
+    fcb2_batch_init(&batch, batch_buf, 16);
+    rc = fcb2_batch_reserve(fcb, &batch, 16, (void **)&data);
+    TEST_ASSERT(rc == FCB2_ERR_NOMEM);
+    rc = fcb2_batch_commit(fcb, &batch, NULL);
+    TEST_ASSERT(rc == FCB2_ERR_ARGS);
+
+    fcb2_batch_init(&batch, batch_buf, sizeof(batch_buf));
+    first_len = 1;
+    for (i = 1; i < 128; i++) {
+        /* Mix single appends with batches */
+        if (i % 10 == 0) {
+            rc = fcb2_append(fcb, i, &loc);
+            TEST_ASSERT_FATAL(rc == 0);
+            for (j = 0; j < i; j++) {
+                batch_buf[j] = fcb_test_append_data(i, j);
+            }
+            rc = fcb2_write(&loc, 0, batch_buf, i);
+            TEST_ASSERT(rc == 0);
+            rc = fcb2_append_finish(&loc);
+            TEST_ASSERT(rc == 0);
+            first_len = i + 1;
+            continue;
+        }
+        rc = fcb2_batch_reserve(fcb, &batch, i, (void **)&data);
+        if (rc == FCB2_ERR_NOMEM) {
+            rc = fcb2_batch_commit(fcb, &batch, &loc);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(loc.fe_data_len == first_len);
+            first_len = i;
+            rc = fcb2_batch_reserve(fcb, &batch, i, (void **)&data);
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        for (j = 0; j < i; j++) {
+            data[j] = fcb_test_append_data(i, j);
+        }
+        if (i % 10 == 9) {
+            rc = fcb2_batch_commit(fcb, &batch, &loc);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(loc.fe_data_len == first_len);
+        }
+    }
+    if (batch.fb_cnt) {
+        rc = fcb2_batch_commit(fcb, &batch, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    var_cnt = 1;
+    rc = fcb2_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 128);
+
+    /* Entries are found again after a restart */
+    rc = fcb_tc_init_fcb(2);
+    TEST_ASSERT_FATAL(rc == 0);
+    var_cnt = 1;
+    rc = fcb2_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 128);
+}
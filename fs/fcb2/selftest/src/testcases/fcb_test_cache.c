@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+
+#define FCB_TEST_CACHE_PAGE 256
+
+TEST_CASE_SELF(fcb_test_cache)
+{
+    int rc;
+    struct fcb2 *fcb;
+    struct fcb2_entry loc;
+    struct fcb2_cache cache;
+    uint8_t cache_buf[FCB2_CACHE_PAGES * FCB_TEST_CACHE_PAGE];
+    uint8_t test_data[128];
+    uint8_t flash_data[8];
+    int i;
+    int j;
+    int var_cnt;
+
+    fcb_tc_pretest(2);
+
+    fcb = &test_fcb;
+
+    rc = fcb2_cache_init(fcb, &cache, cache_buf, 100);
+    TEST_ASSERT(rc == FCB2_ERR_ARGS);
+    rc = fcb2_cache_init(fcb, &cache, cache_buf, FCB_TEST_CACHE_PAGE);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb2_cache_init(fcb, &cache, cache_buf, FCB_TEST_CACHE_PAGE);
+    TEST_ASSERT(rc == FCB2_ERR_ARGS);
+
+    for (i = 1; i < 8; i++) {
+        for (j = 0; j < i; j++) {
+            test_data[j] = fcb_test_append_data(i, j);
+        }
+        rc = fcb2_append(fcb, i, &loc);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fcb2_write(&loc, 0, test_data, i);
+        TEST_ASSERT(rc == 0);
+        rc = fcb2_append_finish(&loc);
+        TEST_ASSERT(rc == 0);
+    }
+
+    /*** Small appends stay in RAM, but are visible through FCB. */
+    rc = flash_area_read(&loc.fe_range->fsr_flash_area,
+                         loc.fe_data_off, flash_data, sizeof(flash_data));
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < sizeof(flash_data); i++) {
+        TEST_ASSERT(flash_data[i] == 0xff);
+    }
+
+    var_cnt = 1;
+    rc = fcb2_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 8);
+
+    rc = fcb2_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = flash_area_read(&loc.fe_range->fsr_flash_area,
+                         loc.fe_data_off, flash_data, 7);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(flash_data, test_data, 7) == 0);
+
+    /*** Enough appends to go through several pages. */
+    for (i = 8; i < sizeof(test_data); i++) {
+        for (j = 0; j < i; j++) {
+            test_data[j] = fcb_test_append_data(i, j);
+        }
+        rc = fcb2_append(fcb, i, &loc);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fcb2_write(&loc, 0, test_data, i);
+        TEST_ASSERT(rc == 0);
+        rc = fcb2_append_finish(&loc);
+        TEST_ASSERT(rc == 0);
+    }
+
+    var_cnt = 1;
+    rc = fcb2_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == sizeof(test_data));
+
+    /*** After a flush everything is found from flash alone. */
+    rc = fcb2_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_tc_init_fcb(2);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(fcb->f_cache == NULL);
+
+    var_cnt = 1;
+    rc = fcb2_walk(fcb, 0, fcb_test_data_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == sizeof(test_data));
+}
+
+#endif
@@ -38,6 +38,10 @@ fcb2_init(struct fcb2 *fcb)
         return FCB2_ERR_ARGS;
     }
 
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+    fcb2_cache_detach(fcb);
+#endif
+
     /* Fill last used, first used */
     for (i = 0; i < fcb->f_sector_cnt; i++) {
         range = fcb2_get_sector_range(fcb, i);
@@ -87,8 +91,13 @@ fcb2_init(struct fcb2 *fcb)
     fcb->f_active.fe_entry_num = 0;
     fcb->f_active_id = newest;
 
+    /*
+     * Find the end of the active sector. Only entries in the sector
+     * descriptor table are needed for this, entry data is verified when it
+     * gets read.
+     */
     while (1) {
-        rc = fcb2_getnext_in_area(fcb, &fcb->f_active);
+        rc = fcb2_skip_in_area(fcb, &fcb->f_active);
         if (rc == FCB2_ERR_NOVAR) {
             rc = FCB2_OK;
             break;
@@ -360,6 +369,11 @@ fcb2_sector_erase(const struct fcb2 *fcb, int sector)
         goto end;
     }
 
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+    fcb2_cache_discard(info.si_range,
+        info.si_sector_in_range * info.si_range->fsr_sector_size,
+        info.si_range->fsr_sector_size);
+#endif
     rc = flash_area_erase(&info.si_range->fsr_flash_area,
         info.si_sector_in_range * info.si_range->fsr_sector_size,
         info.si_range->fsr_sector_size);
@@ -17,10 +17,12 @@
  * under the License.
  */
 #include <stddef.h>
+#include <string.h>
 
 #include "fcb/fcb2.h"
 #include "fcb_priv.h"
 #include "crc/crc8.h"
+#include "crc/crc16.h"
 
 int
 fcb2_new_sector(struct fcb2 *fcb, int cnt)
@@ -89,7 +91,7 @@ fcb2_write_to_sector(struct fcb2_entry *loc, int off, const void *buf, int len)
     if (off + len > loc->fe_range->fsr_sector_size) {
         len = loc->fe_range->fsr_sector_size - off;
     }
-    return flash_area_write(&loc->fe_range->fsr_flash_area,
+    return fcb2_cache_write(loc->fe_range,
         fcb2_sector_flash_offset(loc) + off, buf, len);
 }
 
@@ -104,7 +106,7 @@ fcb2_read_from_sector(struct fcb2_entry *loc, int off, void *buf, int len)
     if (off + len > loc->fe_range->fsr_sector_size) {
         len = loc->fe_range->fsr_sector_size - off;
     }
-    return flash_area_read(&loc->fe_range->fsr_flash_area,
+    return fcb2_cache_read(loc->fe_range,
         fcb2_sector_flash_offset(loc) + off, buf, len);
 }
 
@@ -159,6 +161,31 @@ fcb2_element_length_in_flash(const struct fcb2_entry *loc, int len)
         fcb2_len_in_flash(loc->fe_range, FCB2_CRC_LEN);
 }
 
+/*
+ * Initialize a new sector and start appending to it.
+ */
+static int
+fcb2_set_active_sector(struct fcb2 *fcb, int sector,
+                       struct flash_sector_range *range)
+{
+    int rc;
+
+    rc = fcb2_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
+    if (rc) {
+        return rc;
+    }
+    fcb->f_active.fe_range = range;
+    fcb->f_active.fe_sector = sector;
+    /* Start with offset just after sector header */
+    fcb->f_active.fe_data_off =
+        fcb2_len_in_flash(range, sizeof(struct fcb2_disk_area));
+    /* No entries as yet */
+    fcb->f_active.fe_entry_num = 1;
+    fcb->f_active.fe_data_len = 0;
+    fcb->f_active_id++;
+    return 0;
+}
+
 int
 fcb2_append(struct fcb2 *fcb, uint16_t len, struct fcb2_entry *append_loc)
 {
@@ -190,19 +217,10 @@ fcb2_append(struct fcb2 *fcb, uint16_t len, struct fcb2_entry *append_loc)
             rc = FCB2_ERR_NOSPACE;
             goto err;
         }
-        rc = fcb2_sector_hdr_init(fcb, sector, fcb->f_active_id + 1);
+        rc = fcb2_set_active_sector(fcb, sector, range);
         if (rc) {
             goto err;
         }
-        fcb->f_active.fe_range = range;
-        fcb->f_active.fe_sector = sector;
-        /* Start with offset just after sector header */
-        fcb->f_active.fe_data_off =
-            fcb2_len_in_flash(range, sizeof(struct fcb2_disk_area));
-        /* No entries as yet */
-        fcb->f_active.fe_entry_num = 1;
-        fcb->f_active.fe_data_len = 0;
-        fcb->f_active_id++;
     } else {
         range = active->fe_range;
     }
@@ -259,3 +277,182 @@ fcb2_append_finish(struct fcb2_entry *loc)
     }
     return 0;
 }
+
+static inline int
+fcb2_batch_len(const struct fcb2_batch *batch, uint16_t len)
+{
+    return (len + (batch->fb_align - 1)) & ~(batch->fb_align - 1);
+}
+
+/* Descriptor of the idx'th entry of the batch within the staging buffer. */
+static inline uint8_t *
+fcb2_batch_entry(const struct fcb2_batch *batch, int idx)
+{
+    return batch->fb_buf + batch->fb_size -
+        (idx + 1) * fcb2_batch_len(batch, FCB2_ENTRY_SIZE);
+}
+
+void
+fcb2_batch_init(struct fcb2_batch *batch, void *buf, uint16_t size)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->fb_buf = buf;
+    batch->fb_size = size;
+}
+
+int
+fcb2_batch_reserve(struct fcb2 *fcb, struct fcb2_batch *batch, uint16_t len,
+                   void **data)
+{
+    uint8_t *flash_entry;
+    uint8_t align;
+    int elem_len;
+    int entry_len;
+
+    if (len == 0 || len >= FCB2_MAX_LEN) {
+        return FCB2_ERR_ARGS;
+    }
+
+    if (batch->fb_cnt == 0) {
+        align = fcb->f_active.fe_range->fsr_align;
+        batch->fb_align = align > 1 ? align : 1;
+    }
+
+    elem_len = fcb2_batch_len(batch, len) +
+        fcb2_batch_len(batch, FCB2_CRC_LEN);
+    entry_len = fcb2_batch_len(batch, FCB2_ENTRY_SIZE);
+    if (batch->fb_data_len + elem_len + (batch->fb_cnt + 1) * entry_len >
+        batch->fb_size) {
+        return FCB2_ERR_NOMEM;
+    }
+
+    /*
+     * Offset is relative to the start of the batch until the batch gets
+     * committed.
+     */
+    flash_entry = fcb2_batch_entry(batch, batch->fb_cnt);
+    memset(flash_entry, 0xff, entry_len);
+    flash_entry[0] = (uint8_t)(batch->fb_data_len >> 16);
+    flash_entry[1] = (uint8_t)(batch->fb_data_len >> 8);
+    flash_entry[2] = (uint8_t)(batch->fb_data_len >> 0);
+    flash_entry[3] = (uint8_t)(len >> 8);
+    flash_entry[4] = (uint8_t)(len >> 0);
+
+    /* Padding is written out with the data, keep it at the erased value */
+    memset(batch->fb_buf + batch->fb_data_len, 0xff, elem_len);
+    *data = batch->fb_buf + batch->fb_data_len;
+
+    batch->fb_data_len += elem_len;
+    batch->fb_cnt++;
+    return FCB2_OK;
+}
+
+int
+fcb2_batch_commit(struct fcb2 *fcb, struct fcb2_batch *batch,
+                  struct fcb2_entry *first_loc)
+{
+    struct fcb2_entry *active;
+    struct flash_sector_range *range;
+    uint8_t *flash_entry;
+    uint32_t off;
+    uint16_t len;
+    int entry_len;
+    int need;
+    int sector;
+    int rc;
+    int i;
+
+    if (batch->fb_cnt == 0) {
+        return FCB2_ERR_ARGS;
+    }
+
+    /* Data is already in RAM, CRCs can be filled in right away */
+    for (i = 0; i < batch->fb_cnt; i++) {
+        flash_entry = fcb2_batch_entry(batch, i);
+        off = (flash_entry[0] << 16) | (flash_entry[1] << 8) | flash_entry[2];
+        len = (flash_entry[3] << 8) | flash_entry[4];
+        put_be16(batch->fb_buf + off + fcb2_batch_len(batch, len),
+                 crc16_ccitt(0xFFFF, batch->fb_buf + off, len));
+    }
+
+    entry_len = fcb2_batch_len(batch, FCB2_ENTRY_SIZE);
+    need = batch->fb_data_len + batch->fb_cnt * entry_len;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB2_ERR_ARGS;
+    }
+    active = &fcb->f_active;
+    if (fcb2_len_in_flash(active->fe_range, 1) != batch->fb_align ||
+        fcb2_active_sector_free_space(fcb) < need) {
+        sector = fcb2_new_sector(fcb, fcb->f_scratch_cnt);
+        if (sector < 0) {
+            rc = FCB2_ERR_NOSPACE;
+            goto err;
+        }
+        range = fcb2_get_sector_range(fcb, sector);
+        if (fcb2_len_in_flash(range, 1) != batch->fb_align) {
+            /* Batch was laid out for a different flash alignment */
+            rc = FCB2_ERR_ARGS;
+            goto err;
+        }
+        if (range->fsr_sector_size <
+            fcb2_len_in_flash(range, sizeof(struct fcb2_disk_area)) + need) {
+            rc = FCB2_ERR_NOSPACE;
+            goto err;
+        }
+        rc = fcb2_set_active_sector(fcb, sector, range);
+        if (rc) {
+            goto err;
+        }
+    }
+
+    /* Turn the entry offsets into sector offsets */
+    for (i = 0; i < batch->fb_cnt; i++) {
+        flash_entry = fcb2_batch_entry(batch, i);
+        off = (flash_entry[0] << 16) | (flash_entry[1] << 8) | flash_entry[2];
+        off += active->fe_data_off;
+        flash_entry[0] = (uint8_t)(off >> 16);
+        flash_entry[1] = (uint8_t)(off >> 8);
+        flash_entry[2] = (uint8_t)(off >> 0);
+        flash_entry[5] = crc8_calc(crc8_init(), flash_entry,
+                                   FCB2_ENTRY_SIZE - 1);
+    }
+
+    /*
+     * As with fcb2_append(), entries are written before data. Descriptors
+     * of later entries are at lower addresses.
+     */
+    rc = fcb2_write_to_sector(active,
+        -(active->fe_entry_num + batch->fb_cnt - 1) * entry_len,
+        fcb2_batch_entry(batch, batch->fb_cnt - 1),
+        batch->fb_cnt * entry_len);
+    if (rc) {
+        rc = FCB2_ERR_FLASH;
+        goto err;
+    }
+    rc = fcb2_write_to_sector(active, active->fe_data_off, batch->fb_buf,
+                              batch->fb_data_len);
+    if (rc) {
+        rc = FCB2_ERR_FLASH;
+        goto err;
+    }
+
+    if (first_loc) {
+        flash_entry = fcb2_batch_entry(batch, 0);
+        *first_loc = *active;
+        first_loc->fe_data_len = (flash_entry[3] << 8) | flash_entry[4];
+    }
+
+    active->fe_data_off += batch->fb_data_len;
+    active->fe_entry_num += batch->fb_cnt;
+
+    os_mutex_release(&fcb->f_mtx);
+
+    batch->fb_data_len = 0;
+    batch->fb_cnt = 0;
+    return FCB2_OK;
+err:
+    os_mutex_release(&fcb->f_mtx);
+    return rc;
+}
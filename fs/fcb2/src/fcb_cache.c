@@ -0,0 +1,411 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "fcb/fcb2.h"
+#include "fcb_priv.h"
+
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+
+/*
+ * Writes are kept in RAM one flash page at a time. A page holds a single
+ * dirty extent; FCB2 appends grow entry data upwards from the start of the
+ * sector and entries downwards from its end, so one cached page for each is
+ * enough to gather consecutive appends.
+ */
+
+static SLIST_HEAD(, fcb2_cache) fcb2_caches =
+    SLIST_HEAD_INITIALIZER(fcb2_caches);
+
+static struct fcb2_cache *
+fcb2_cache_find(const struct flash_sector_range *range)
+{
+    struct fcb2_cache *cache;
+    struct fcb2 *fcb;
+
+    SLIST_FOREACH(cache, &fcb2_caches, fc_next) {
+        fcb = cache->fc_fcb;
+        if (range >= fcb->f_ranges && range < fcb->f_ranges + fcb->f_range_cnt) {
+            return cache;
+        }
+    }
+    return NULL;
+}
+
+static void
+fcb2_cache_lock(struct fcb2_cache *cache)
+{
+    os_mutex_pend(&cache->fc_fcb->f_mtx, OS_WAIT_FOREVER);
+}
+
+static void
+fcb2_cache_unlock(struct fcb2_cache *cache)
+{
+    os_mutex_release(&cache->fc_fcb->f_mtx);
+}
+
+static int
+fcb2_cache_page_flush(struct fcb2_cache_page *page)
+{
+    int rc;
+
+    if (page->cp_hi == 0) {
+        return 0;
+    }
+    rc = flash_area_write(&page->cp_range->fsr_flash_area,
+                          page->cp_off + page->cp_lo,
+                          page->cp_buf + page->cp_lo,
+                          page->cp_hi - page->cp_lo);
+    page->cp_lo = 0;
+    page->cp_hi = 0;
+
+    return rc ? FCB2_ERR_FLASH : 0;
+}
+
+static int
+fcb2_cache_flush_all(struct fcb2_cache *cache)
+{
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < FCB2_CACHE_PAGES; i++) {
+        if (fcb2_cache_page_flush(&cache->fc_pages[i])) {
+            rc = FCB2_ERR_FLASH;
+        }
+    }
+#if MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)
+    os_callout_stop(&cache->fc_timer);
+#endif
+    return rc;
+}
+
+#if MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)
+static void
+fcb2_cache_timer_exp(struct os_event *ev)
+{
+    struct fcb2_cache *cache = ev->ev_arg;
+
+    fcb2_flush(cache->fc_fcb);
+}
+#endif
+
+/*
+ * Whether [off, off + len) can be added to the dirty extent of a page. Only
+ * alignment padding is allowed between the two, as it never gets written
+ * on its own.
+ */
+static int
+fcb2_cache_page_mergeable(const struct fcb2_cache_page *page, uint16_t off,
+                          uint16_t len)
+{
+    uint8_t align;
+
+    align = page->cp_range->fsr_align > 1 ? page->cp_range->fsr_align : 1;
+    return off < page->cp_hi + align && off + len + align > page->cp_lo;
+}
+
+static struct fcb2_cache_page *
+fcb2_cache_page_get(struct fcb2_cache *cache,
+                    struct flash_sector_range *range, uint32_t page_off,
+                    uint16_t off, uint16_t len)
+{
+    struct fcb2_cache_page *victim;
+    struct fcb2_cache_page *page;
+    int i;
+
+    victim = NULL;
+    for (i = 0; i < FCB2_CACHE_PAGES; i++) {
+        page = &cache->fc_pages[i];
+        if (page->cp_hi != 0 && page->cp_range == range &&
+            page->cp_off == page_off) {
+            if (fcb2_cache_page_mergeable(page, off, len)) {
+                return page;
+            }
+            victim = page;
+            break;
+        }
+        if (victim == NULL || (victim->cp_hi != 0 &&
+            (page->cp_hi == 0 ||
+             (int8_t)(page->cp_age - victim->cp_age) < 0))) {
+            victim = page;
+        }
+    }
+
+    if (fcb2_cache_page_flush(victim)) {
+        return NULL;
+    }
+    victim->cp_range = range;
+    victim->cp_off = page_off;
+    memset(victim->cp_buf, 0xff, cache->fc_page_size);
+    return victim;
+}
+
+static int
+fcb2_cache_do_write(struct fcb2_cache *cache, struct flash_sector_range *range,
+                    uint32_t off, const uint8_t *buf, int len)
+{
+    struct fcb2_cache_page *page;
+    uint32_t page_off;
+    uint16_t in_page;
+    uint16_t chunk;
+    int grew_down;
+    int rc;
+
+    while (len > 0) {
+        page_off = off & ~(uint32_t)(cache->fc_page_size - 1);
+        in_page = off - page_off;
+        chunk = cache->fc_page_size - in_page;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        page = fcb2_cache_page_get(cache, range, page_off, in_page, chunk);
+        if (page == NULL) {
+            return FCB2_ERR_FLASH;
+        }
+        memcpy(page->cp_buf + in_page, buf, chunk);
+        if (page->cp_hi == 0) {
+            page->cp_lo = in_page;
+            page->cp_hi = in_page + chunk;
+            grew_down = 0;
+        } else {
+            grew_down = in_page < page->cp_lo;
+            if (grew_down) {
+                page->cp_lo = in_page;
+            }
+            if (in_page + chunk > page->cp_hi) {
+                page->cp_hi = in_page + chunk;
+            }
+        }
+        page->cp_age = ++cache->fc_age;
+
+        /* Program the page once appends reach its end. */
+        if (in_page + chunk == cache->fc_page_size ||
+            (grew_down && in_page == 0)) {
+            rc = fcb2_cache_page_flush(page);
+            if (rc) {
+                return rc;
+            }
+        } else {
+#if MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)
+            if (!os_callout_queued(&cache->fc_timer)) {
+                os_callout_reset(&cache->fc_timer, os_time_ms_to_ticks32(
+                                 MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)));
+            }
+#endif
+        }
+
+        off += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+/* Copy dirty cached data over what was read from flash. */
+static int
+fcb2_cache_overlay(struct fcb2_cache *cache,
+                   const struct flash_sector_range *range, uint32_t off,
+                   uint8_t *buf, int len)
+{
+    struct fcb2_cache_page *page;
+    uint32_t start;
+    uint32_t end;
+    int found = 0;
+    int i;
+
+    for (i = 0; i < FCB2_CACHE_PAGES; i++) {
+        page = &cache->fc_pages[i];
+        if (page->cp_hi == 0 || page->cp_range != range) {
+            continue;
+        }
+        start = page->cp_off + page->cp_lo;
+        end = page->cp_off + page->cp_hi;
+        if (start < off) {
+            start = off;
+        }
+        if (end > off + len) {
+            end = off + len;
+        }
+        if (start < end) {
+            memcpy(buf + (start - off), page->cp_buf + (start - page->cp_off),
+                   end - start);
+            found = 1;
+        }
+    }
+    return found;
+}
+
+int
+fcb2_cache_write(struct flash_sector_range *range, uint32_t off,
+                 const void *buf, int len)
+{
+    struct fcb2_cache *cache;
+    int rc;
+
+    cache = fcb2_cache_find(range);
+    if (cache == NULL) {
+        return flash_area_write(&range->fsr_flash_area, off, buf, len);
+    }
+
+    fcb2_cache_lock(cache);
+    rc = fcb2_cache_do_write(cache, range, off, buf, len);
+    fcb2_cache_unlock(cache);
+
+    return rc;
+}
+
+int
+fcb2_cache_read(struct flash_sector_range *range, uint32_t off, void *buf,
+                int len)
+{
+    struct fcb2_cache *cache;
+    int rc;
+
+    cache = fcb2_cache_find(range);
+    if (cache == NULL) {
+        return flash_area_read(&range->fsr_flash_area, off, buf, len);
+    }
+
+    fcb2_cache_lock(cache);
+    rc = flash_area_read(&range->fsr_flash_area, off, buf, len);
+    if (rc == 0) {
+        fcb2_cache_overlay(cache, range, off, buf, len);
+    }
+    fcb2_cache_unlock(cache);
+
+    return rc;
+}
+
+int
+fcb2_cache_read_is_empty(struct flash_sector_range *range, uint32_t off,
+                         void *buf, int len)
+{
+    struct fcb2_cache *cache;
+    int rc;
+
+    cache = fcb2_cache_find(range);
+    if (cache == NULL) {
+        return flash_area_read_is_empty(&range->fsr_flash_area, off, buf, len);
+    }
+
+    fcb2_cache_lock(cache);
+    rc = flash_area_read_is_empty(&range->fsr_flash_area, off, buf, len);
+    if (rc >= 0 && fcb2_cache_overlay(cache, range, off, buf, len)) {
+        rc = 0;
+    }
+    fcb2_cache_unlock(cache);
+
+    return rc;
+}
+
+void
+fcb2_cache_discard(struct flash_sector_range *range, uint32_t off,
+                   uint32_t len)
+{
+    struct fcb2_cache_page *page;
+    struct fcb2_cache *cache;
+    int i;
+
+    cache = fcb2_cache_find(range);
+    if (cache == NULL) {
+        return;
+    }
+
+    fcb2_cache_lock(cache);
+    for (i = 0; i < FCB2_CACHE_PAGES; i++) {
+        page = &cache->fc_pages[i];
+        if (page->cp_range == range && page->cp_off >= off &&
+            page->cp_off < off + len) {
+            page->cp_lo = 0;
+            page->cp_hi = 0;
+        }
+    }
+    fcb2_cache_unlock(cache);
+}
+
+void
+fcb2_cache_detach(struct fcb2 *fcb)
+{
+    struct fcb2_cache *cache;
+
+    SLIST_FOREACH(cache, &fcb2_caches, fc_next) {
+        if (cache->fc_fcb == fcb) {
+            break;
+        }
+    }
+    if (cache != NULL) {
+        /* FCB is being reinitialized; its mutex can not be used. */
+        fcb2_cache_flush_all(cache);
+        SLIST_REMOVE(&fcb2_caches, cache, fcb2_cache, fc_next);
+    }
+    fcb->f_cache = NULL;
+}
+
+int
+fcb2_cache_init(struct fcb2 *fcb, struct fcb2_cache *cache, void *buf,
+                uint16_t page_size)
+{
+    int i;
+
+    if (fcb->f_cache != NULL || page_size == 0 ||
+        (page_size & (page_size - 1)) != 0) {
+        return FCB2_ERR_ARGS;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+    cache->fc_fcb = fcb;
+    cache->fc_page_size = page_size;
+    for (i = 0; i < FCB2_CACHE_PAGES; i++) {
+        cache->fc_pages[i].cp_buf = (uint8_t *)buf + i * page_size;
+    }
+#if MYNEWT_VAL(FCB2_WRITE_CACHE_TIMEOUT)
+    os_callout_init(&cache->fc_timer, os_eventq_dflt_get(),
+                    fcb2_cache_timer_exp, cache);
+#endif
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    SLIST_INSERT_HEAD(&fcb2_caches, cache, fc_next);
+    fcb->f_cache = cache;
+    os_mutex_release(&fcb->f_mtx);
+
+    return 0;
+}
+
+int
+fcb2_flush(struct fcb2 *fcb)
+{
+    struct fcb2_cache *cache;
+    int rc;
+
+    cache = fcb->f_cache;
+    if (cache == NULL) {
+        return 0;
+    }
+
+    fcb2_cache_lock(cache);
+    rc = fcb2_cache_flush_all(cache);
+    fcb2_cache_unlock(cache);
+
+    return rc;
+}
+
+#endif
@@ -57,7 +57,11 @@ fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p)
     return 0;
 }
 
-static int
+/*
+ * Read entry from the end of the sector, filling in location of its data.
+ * The data itself is not verified.
+ */
+int
 fcb2_read_entry(struct fcb2_entry *loc)
 {
     uint8_t buf[FCB2_ENTRY_SIZE];
@@ -69,8 +73,8 @@ fcb2_read_entry(struct fcb2_entry *loc)
 
     assert(loc != NULL);
     entry_offset = fcb2_entry_location_in_range(loc);
-    rc = flash_area_read_is_empty(&loc->fe_range->fsr_flash_area,
-        entry_offset, buf, sizeof(buf));
+    rc = fcb2_cache_read_is_empty(loc->fe_range, entry_offset, buf,
+                                  sizeof(buf));
     if (rc < 0) {
         /* Error reading from flash */
         return FCB2_ERR_FLASH;
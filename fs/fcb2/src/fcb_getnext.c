@@ -21,8 +21,9 @@
 #include "fcb/fcb2.h"
 #include "fcb_priv.h"
 
-int
-fcb2_getnext_in_area(struct fcb2 *fcb, struct fcb2_entry *loc)
+static int
+fcb2_getnext_in_area_with(struct fcb2 *fcb, struct fcb2_entry *loc,
+                          int (*elem_info)(struct fcb2_entry *))
 {
     int rc = FCB2_ERR_CRC;
     int len;
@@ -44,7 +45,7 @@ fcb2_getnext_in_area(struct fcb2 *fcb, struct fcb2_entry *loc)
         if (next_data_offset >= next_entry_offset) {
             return FCB2_ERR_NOVAR;
         }
-        rc = fcb2_elem_info(loc);
+        rc = elem_info(loc);
         if (len) {
             loc->fe_data_off = next_data_offset;
         }
@@ -52,6 +53,18 @@ fcb2_getnext_in_area(struct fcb2 *fcb, struct fcb2_entry *loc)
     return rc;
 }
 
+int
+fcb2_getnext_in_area(struct fcb2 *fcb, struct fcb2_entry *loc)
+{
+    return fcb2_getnext_in_area_with(fcb, loc, fcb2_elem_info);
+}
+
+int
+fcb2_skip_in_area(struct fcb2 *fcb, struct fcb2_entry *loc)
+{
+    return fcb2_getnext_in_area_with(fcb, loc, fcb2_read_entry);
+}
+
 int
 fcb2_getnext_nolock(struct fcb2 *fcb, struct fcb2_entry *loc)
 {
@@ -50,6 +50,8 @@ fcb2_len_in_flash(const struct flash_sector_range *range, uint16_t len)
 }
 
 int fcb2_getnext_in_area(struct fcb2 *fcb, struct fcb2_entry *loc);
+/* Like fcb2_getnext_in_area(), but without reading the entry data. */
+int fcb2_skip_in_area(struct fcb2 *fcb, struct fcb2_entry *loc);
 
 static inline int
 fcb2_getnext_sector(struct fcb2 *fcb, int sector)
@@ -63,6 +65,7 @@ fcb2_getnext_sector(struct fcb2 *fcb, int sector)
 int fcb2_getnext_nolock(struct fcb2 *fcb, struct fcb2_entry *loc);
 
 int fcb2_elem_info(struct fcb2_entry *loc);
+int fcb2_read_entry(struct fcb2_entry *loc);
 int fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p);
 int fcb2_sector_hdr_init(struct fcb2 *fcb, int sector, uint16_t id);
 int fcb2_entry_location_in_range(const struct fcb2_entry *loc);
@@ -118,6 +121,45 @@ int fcb2_write_to_sector(struct fcb2_entry *loc, int off,
  */
 int fcb2_read_from_sector(struct fcb2_entry *loc, int off, void *buf, int len);
 
+#if MYNEWT_VAL(FCB2_WRITE_CACHE)
+/*
+ * Flash access for FCB entries and their data goes through these, so that
+ * cached writes are seen by readers. Offsets are within range flash area.
+ */
+int fcb2_cache_write(struct flash_sector_range *range, uint32_t off,
+                     const void *buf, int len);
+int fcb2_cache_read(struct flash_sector_range *range, uint32_t off, void *buf,
+                    int len);
+int fcb2_cache_read_is_empty(struct flash_sector_range *range, uint32_t off,
+                             void *buf, int len);
+/* Drop cached data for an area that is getting erased. */
+void fcb2_cache_discard(struct flash_sector_range *range, uint32_t off,
+                        uint32_t len);
+/* Write out and stop using the cache of an FCB being reinitialized. */
+void fcb2_cache_detach(struct fcb2 *fcb);
+#else
+static inline int
+fcb2_cache_write(struct flash_sector_range *range, uint32_t off,
+                 const void *buf, int len)
+{
+    return flash_area_write(&range->fsr_flash_area, off, buf, len);
+}
+
+static inline int
+fcb2_cache_read(struct flash_sector_range *range, uint32_t off, void *buf,
+                int len)
+{
+    return flash_area_read(&range->fsr_flash_area, off, buf, len);
+}
+
+static inline int
+fcb2_cache_read_is_empty(struct flash_sector_range *range, uint32_t off,
+                         void *buf, int len)
+{
+    return flash_area_read_is_empty(&range->fsr_flash_area, off, buf, len);
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,11 +33,60 @@ extern "C" {
 struct fs_file;
 struct fs_dir;
 struct fs_dirent;
+struct os_mbuf;
+
+/**
+ * Receives one chunk of file data from fs_sendfile().  The callee takes
+ * ownership of the mbuf chain.  A nonzero return aborts the transfer and
+ * is passed back to the caller of fs_sendfile().
+ */
+typedef int fs_sendfile_fn(struct os_mbuf *om, void *arg);
 
 int fs_open(const char *filename, uint8_t access_flags, struct fs_file **);
 int fs_close(struct fs_file *);
 int fs_read(struct fs_file *, uint32_t len, void *out_data, uint32_t *out_len);
 int fs_write(struct fs_file *, const void *data, int len);
+
+/**
+ * One segment of a vectored read or write.
+ */
+struct fs_iovec {
+    void *fiov_base;
+    uint32_t fiov_len;
+};
+
+/**
+ * Reads into each segment in turn, stopping early at end of file.
+ * *out_len is set to the total number of bytes read.
+ */
+int fs_readv(struct fs_file *, const struct fs_iovec *iov, int iovcnt,
+             uint32_t *out_len);
+
+/**
+ * Writes each segment in turn.  Runs of short segments are gathered into
+ * a small buffer and handed to the file system as one write, which saves
+ * per-call overhead and, on nffs, a data block per segment.
+ */
+int fs_writev(struct fs_file *, const struct fs_iovec *iov, int iovcnt);
+
+/**
+ * Reads up to len bytes from the current file position and appends them to
+ * an mbuf chain.  Data is read directly into the chain; extra mbufs are
+ * allocated from the pool of the first mbuf as needed.  Fewer than len
+ * bytes are appended at end of file or when the pool runs dry
+ * (FS_ENOMEM); *out_len reports what was appended in every case.
+ */
+int fs_read_mbuf(struct fs_file *, uint32_t len, struct os_mbuf *om,
+                 uint32_t *out_len);
+
+/**
+ * Streams up to len bytes from the current file position as a series of
+ * msys packet chains of at most chunk_len bytes each, handing every chain
+ * to cb.  Stops at end of file, on a read or allocation error, or when cb
+ * returns nonzero.  *out_len is set to the number of bytes read.
+ */
+int fs_sendfile(struct fs_file *, uint32_t len, uint16_t chunk_len,
+                fs_sendfile_fn *cb, void *arg, uint32_t *out_len);
 int fs_seek(struct fs_file *, uint32_t offset);
 uint32_t fs_getpos(const struct fs_file *);
 int fs_filelen(const struct fs_file *, uint32_t *out_len);
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __FS_ASYNC_H__
+#define __FS_ASYNC_H__
+
+#include "os/mynewt.h"
+#include "fs/fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FS_ASYNC_OP_READ        0
+#define FS_ASYNC_OP_WRITE       1
+#define FS_ASYNC_OP_FLUSH       2
+
+/**
+ * An asynchronous file I/O request.  The submitter owns the request and
+ * its data buffer until the completion event fires.
+ *
+ * Requests are carried out in submission order by the fs task.  A file
+ * with outstanding requests must not be accessed synchronously.
+ */
+struct fs_async_req {
+    /** Completion event; the submitter sets ev_cb and ev_arg. */
+    struct os_event far_ev;
+
+    /**
+     * Queue the completion event is posted to.  If NULL, ev_cb (if any)
+     * is called directly from the fs task.
+     */
+    struct os_eventq *far_evq;
+
+    /** One of FS_ASYNC_OP_[...]. */
+    uint8_t far_op;
+
+    struct fs_file *far_file;
+
+    /** Source (write) or destination (read) buffer; unused for flush. */
+    void *far_data;
+    uint32_t far_len;
+
+    /** Number of bytes transferred; set on completion. */
+    uint32_t far_done;
+
+    /** 0 or FS_E[...] error code; set on completion. */
+    int far_rc;
+
+    STAILQ_ENTRY(fs_async_req) far_next;
+};
+
+/**
+ * Queues a request for the fs task.
+ *
+ * @param req                   The request to queue.
+ *
+ * @return                      0 on success; FS_EINVAL if the request is
+ *                                  malformed.
+ */
+int fs_async_submit(struct fs_async_req *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
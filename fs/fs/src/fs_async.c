@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FS_ASYNC)
+
+#include <string.h>
+
+#include "fs/fs.h"
+#include "fs/fs_async.h"
+
+/*
+ * Asynchronous file I/O.
+ *
+ * Submitters append requests to a queue and wake the fs task, which works
+ * through them in order.  Consecutive short writes to the same file are
+ * copied into one merge buffer and passed to the file system as a single
+ * fs_write(); every request of the batch then completes with its result.
+ */
+
+#define FS_ASYNC_MERGE_BUF_SIZE MYNEWT_VAL(FS_ASYNC_MERGE_BUF_SIZE)
+
+static STAILQ_HEAD(, fs_async_req) fs_async_q =
+    STAILQ_HEAD_INITIALIZER(fs_async_q);
+
+static uint8_t fs_async_merge_buf[FS_ASYNC_MERGE_BUF_SIZE];
+
+static struct os_eventq fs_async_evq;
+static struct os_task fs_async_task;
+OS_TASK_STACK_DEFINE(fs_async_stack, MYNEWT_VAL(FS_ASYNC_STACK_SIZE));
+
+static void fs_async_event_cb(struct os_event *ev);
+
+static struct os_event fs_async_ev = {
+    .ev_cb = fs_async_event_cb,
+};
+
+int
+fs_async_submit(struct fs_async_req *req)
+{
+    os_sr_t sr;
+
+    if (req == NULL || req->far_file == NULL ||
+        req->far_op > FS_ASYNC_OP_FLUSH ||
+        (req->far_op != FS_ASYNC_OP_FLUSH && req->far_data == NULL)) {
+
+        return FS_EINVAL;
+    }
+
+    req->far_done = 0;
+    req->far_rc = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&fs_async_q, req, far_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&fs_async_evq, &fs_async_ev);
+
+    return 0;
+}
+
+static struct fs_async_req *
+fs_async_dequeue(void)
+{
+    struct fs_async_req *req;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req = STAILQ_FIRST(&fs_async_q);
+    if (req != NULL) {
+        STAILQ_REMOVE_HEAD(&fs_async_q, far_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return req;
+}
+
+/*
+ * Removes and returns the head of the queue if it is a write to the given
+ * file that still fits in the merge buffer.
+ */
+static struct fs_async_req *
+fs_async_dequeue_mergeable(const struct fs_file *file, uint32_t used)
+{
+    struct fs_async_req *req;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req = STAILQ_FIRST(&fs_async_q);
+    if (req != NULL &&
+        req->far_op == FS_ASYNC_OP_WRITE && req->far_file == file &&
+        used + req->far_len <= FS_ASYNC_MERGE_BUF_SIZE) {
+
+        STAILQ_REMOVE_HEAD(&fs_async_q, far_next);
+    } else {
+        req = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return req;
+}
+
+static void
+fs_async_complete(struct fs_async_req *req, int rc, uint32_t done)
+{
+    req->far_rc = rc;
+    req->far_done = done;
+
+    if (req->far_evq != NULL) {
+        os_eventq_put(req->far_evq, &req->far_ev);
+    } else if (req->far_ev.ev_cb != NULL) {
+        req->far_ev.ev_cb(&req->far_ev);
+    }
+}
+
+static void
+fs_async_write_merged(struct fs_async_req *first)
+{
+    STAILQ_HEAD(, fs_async_req) batch;
+    struct fs_async_req *req;
+    uint32_t used;
+    int rc;
+
+    req = fs_async_dequeue_mergeable(first->far_file, first->far_len);
+    if (req == NULL) {
+        /* Nothing to merge with; skip the copy. */
+        rc = fs_write(first->far_file, first->far_data, first->far_len);
+        fs_async_complete(first, rc, rc == 0 ? first->far_len : 0);
+        return;
+    }
+
+    STAILQ_INIT(&batch);
+    memcpy(fs_async_merge_buf, first->far_data, first->far_len);
+    used = first->far_len;
+    STAILQ_INSERT_TAIL(&batch, first, far_next);
+
+    do {
+        memcpy(fs_async_merge_buf + used, req->far_data, req->far_len);
+        used += req->far_len;
+        STAILQ_INSERT_TAIL(&batch, req, far_next);
+    } while ((req = fs_async_dequeue_mergeable(first->far_file, used)));
+
+    rc = fs_write(first->far_file, fs_async_merge_buf, used);
+
+    /* Completion may reuse the request, so unlink before completing. */
+    while ((req = STAILQ_FIRST(&batch)) != NULL) {
+        STAILQ_REMOVE_HEAD(&batch, far_next);
+        fs_async_complete(req, rc, rc == 0 ? req->far_len : 0);
+    }
+}
+
+static void
+fs_async_process(struct fs_async_req *req)
+{
+    uint32_t done;
+    int rc;
+
+    done = 0;
+
+    switch (req->far_op) {
+    case FS_ASYNC_OP_READ:
+        rc = fs_read(req->far_file, req->far_len, req->far_data, &done);
+        break;
+
+    case FS_ASYNC_OP_WRITE:
+        if (req->far_len <= FS_ASYNC_MERGE_BUF_SIZE) {
+            fs_async_write_merged(req);
+            return;
+        }
+        rc = fs_write(req->far_file, req->far_data, req->far_len);
+        if (rc == 0) {
+            done = req->far_len;
+        }
+        break;
+
+    default:
+        rc = fs_flush(req->far_file);
+        break;
+    }
+
+    fs_async_complete(req, rc, done);
+}
+
+static void
+fs_async_event_cb(struct os_event *ev)
+{
+    struct fs_async_req *req;
+
+    while ((req = fs_async_dequeue()) != NULL) {
+        fs_async_process(req);
+    }
+}
+
+static void
+fs_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&fs_async_evq);
+    }
+}
+
+void
+fs_async_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    os_eventq_init(&fs_async_evq);
+
+    rc = os_task_init(&fs_async_task, "fs", fs_async_task_handler, NULL,
+                      MYNEWT_VAL(FS_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      fs_async_stack, MYNEWT_VAL(FS_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif
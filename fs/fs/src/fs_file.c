@@ -207,6 +207,118 @@ fs_read(struct fs_file *file, uint32_t len, void *out_data, uint32_t *out_len)
     return fops->f_read(file, len, out_data, out_len);
 }
 
+int
+fs_read_mbuf(struct fs_file *file, uint32_t len, struct os_mbuf *om,
+             uint32_t *out_len)
+{
+    struct fs_ops *fops;
+    struct os_mbuf *last;
+    struct os_mbuf *m;
+    uint32_t total;
+    uint32_t chunk;
+    uint32_t bytes;
+    int rc;
+
+    if (om == NULL) {
+        return FS_EINVAL;
+    }
+
+    fops = fops_from_file(file);
+
+    last = om;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+
+    /*
+     * Read straight into the tail of the chain, growing it one mbuf at a
+     * time from the chain's own pool; no intermediate buffer is needed.
+     */
+    total = 0;
+    rc = 0;
+    while (total < len) {
+        m = last;
+        if (OS_MBUF_TRAILINGSPACE(m) == 0) {
+            m = os_mbuf_get(om->om_omp, 0);
+            if (m == NULL) {
+                rc = FS_ENOMEM;
+                break;
+            }
+        }
+
+        chunk = min(OS_MBUF_TRAILINGSPACE(m), len - total);
+        rc = fops->f_read(file, chunk, m->om_data + m->om_len, &bytes);
+        if (rc == 0 && bytes > 0) {
+            m->om_len += bytes;
+            total += bytes;
+            if (m != last) {
+                SLIST_NEXT(last, om_next) = m;
+                last = m;
+            }
+        } else if (m != last) {
+            os_mbuf_free(m);
+        }
+
+        if (rc != 0 || bytes < chunk) {
+            /* Error or end of file. */
+            break;
+        }
+    }
+
+    if (OS_MBUF_IS_PKTHDR(om)) {
+        OS_MBUF_PKTHDR(om)->omp_len += total;
+    }
+
+    if (out_len != NULL) {
+        *out_len = total;
+    }
+    return rc;
+}
+
+int
+fs_sendfile(struct fs_file *file, uint32_t len, uint16_t chunk_len,
+            fs_sendfile_fn *cb, void *arg, uint32_t *out_len)
+{
+    struct os_mbuf *om;
+    uint32_t total;
+    uint32_t want;
+    uint32_t bytes;
+    int rc;
+
+    if (cb == NULL || chunk_len == 0) {
+        return FS_EINVAL;
+    }
+
+    total = 0;
+    rc = 0;
+    while (total < len) {
+        om = os_msys_get_pkthdr(chunk_len, 0);
+        if (om == NULL) {
+            rc = FS_ENOMEM;
+            break;
+        }
+
+        want = min(chunk_len, len - total);
+        rc = fs_read_mbuf(file, want, om, &bytes);
+        if (rc != 0 || bytes == 0) {
+            os_mbuf_free_chain(om);
+            break;
+        }
+        total += bytes;
+
+        /* The callback takes ownership of the chain. */
+        rc = cb(om, arg);
+        if (rc != 0 || bytes < want) {
+            break;
+        }
+    }
+
+    if (out_len != NULL) {
+        *out_len = total;
+    }
+    return rc;
+}
+
 int
 fs_write(struct fs_file *file, const void *data, int len)
 {
@@ -214,6 +326,78 @@ fs_write(struct fs_file *file, const void *data, int len)
     return fops->f_write(file, data, len);
 }
 
+int
+fs_readv(struct fs_file *file, const struct fs_iovec *iov, int iovcnt,
+         uint32_t *out_len)
+{
+    struct fs_ops *fops = fops_from_file(file);
+    uint32_t total;
+    uint32_t bytes;
+    int rc;
+    int i;
+
+    total = 0;
+    rc = 0;
+    for (i = 0; i < iovcnt; i++) {
+        rc = fops->f_read(file, iov[i].fiov_len, iov[i].fiov_base, &bytes);
+        if (rc != 0) {
+            break;
+        }
+        total += bytes;
+        if (bytes < iov[i].fiov_len) {
+            break;
+        }
+    }
+
+    if (out_len != NULL) {
+        *out_len = total;
+    }
+    return rc;
+}
+
+int
+fs_writev(struct fs_file *file, const struct fs_iovec *iov, int iovcnt)
+{
+    struct fs_ops *fops = fops_from_file(file);
+    uint8_t buf[MYNEWT_VAL(FS_WRITEV_MERGE_SIZE)];
+    uint32_t used;
+    int rc;
+    int i;
+
+    used = 0;
+    for (i = 0; i < iovcnt; i++) {
+        if (used + iov[i].fiov_len <= sizeof(buf)) {
+            memcpy(buf + used, iov[i].fiov_base, iov[i].fiov_len);
+            used += iov[i].fiov_len;
+            continue;
+        }
+
+        if (used != 0) {
+            rc = fops->f_write(file, buf, used);
+            if (rc != 0) {
+                return rc;
+            }
+            used = 0;
+        }
+
+        if (iov[i].fiov_len <= sizeof(buf)) {
+            memcpy(buf, iov[i].fiov_base, iov[i].fiov_len);
+            used = iov[i].fiov_len;
+        } else {
+            rc = fops->f_write(file, iov[i].fiov_base, iov[i].fiov_len);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    if (used != 0) {
+        return fops->f_write(file, buf, used);
+    }
+
+    return 0;
+}
+
 int
 fs_seek(struct fs_file *file, uint32_t offset)
 {
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_LITTLEFS_
+#define H_LITTLEFS_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Configuration of an additional littlefs mount.
+ *
+ * Files on an additional mount are accessed with a "<disk_name>:" prefix,
+ * e.g. "ext:/log/0".  Unprefixed paths refer to the default mount
+ * configured through LITTLEFS_FLASH_AREA.
+ */
+struct littlefs_mount_cfg {
+    /** Disk name used as path prefix; must remain valid while mounted. */
+    const char *disk_name;
+
+    /** Flash area holding the file system. */
+    uint8_t flash_area_id;
+
+    /** Sector size; all sectors of the area must have this size. */
+    uint32_t block_size;
+
+    /** Number of sectors used by the file system. */
+    uint32_t block_count;
+
+    /** Size of the littlefs read and program caches; 0 = default. */
+    uint32_t cache_size;
+
+    /** Size of the block allocator lookahead buffer; 0 = default. */
+    uint32_t lookahead_size;
+
+    /**
+     * Size of the sequential read-ahead window; 0 disables read-ahead.
+     * Useful on SPI NOR where a few large transfers are much cheaper than
+     * many small ones.
+     */
+    uint32_t read_ahead_size;
+};
+
+/**
+ * Mounts the default littlefs instance and registers the file system.
+ * Formats the area first if mounting fails and
+ * LITTLEFS_DETECT_FAIL_FORMAT is enabled.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int littlefs_init(void);
+
+/**
+ * Formats the default littlefs instance.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int littlefs_reformat(void);
+
+/**
+ * Mounts an additional littlefs instance and registers its disk name.
+ * The configuration is copied; only cfg->disk_name must outlive the call.
+ *
+ * @param cfg                   Configuration of the new mount.
+ *
+ * @return                      0 on success; FS_E[...] error code on
+ *                                  failure.
+ */
+int littlefs_mount_area(const struct littlefs_mount_cfg *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,6 +31,7 @@
 
 #include <fs/fs.h>
 #include <fs/fs_if.h>
+#include "littlefs/littlefs.h"
 
 static int littlefs_open(const char *path, uint8_t access_flags,
                          struct fs_file **out_file);
@@ -138,6 +139,44 @@ littlefs_to_vfs_error(int err)
     return rc;
 }
 
+/*
+ * Per-mount state.  The lfs_config context points back at this structure
+ * so the block device callbacks can find the flash area and read-ahead
+ * window of the mount they operate on.
+ */
+struct littlefs_mount {
+    lfs_t lfs;
+    struct lfs_config cfg;
+    const struct flash_area *fa;
+
+    /* Path prefix of this mount; NULL for the default mount. */
+    const char *disk_name;
+
+    /*
+     * Sequential read-ahead window.  A read that continues where the
+     * previous one ended refills the window with one ra_size transfer;
+     * other reads go straight to flash.
+     */
+    uint8_t *ra_buf;
+    uint32_t ra_size;
+    uint32_t ra_off;
+    uint32_t ra_len;
+    uint32_t ra_next;
+
+    SLIST_ENTRY(littlefs_mount) next;
+};
+
+static void
+littlefs_ra_invalidate(struct littlefs_mount *lm, uint32_t offset,
+                       uint32_t len)
+{
+    if (lm->ra_len != 0 &&
+        offset < lm->ra_off + lm->ra_len && lm->ra_off < offset + len) {
+
+        lm->ra_len = 0;
+    }
+}
+
 /*
  * Read a region in a block. Negative error codes are propagated
  * to the user.
@@ -146,17 +185,64 @@ static int
 flash_read(const struct lfs_config *c, lfs_block_t block,
            lfs_off_t off, void *buffer, lfs_size_t size)
 {
-    int rc;
-    const struct flash_area *fa;
+    struct littlefs_mount *lm;
     uint32_t offset;
+    uint32_t len;
+    int rc;
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    const void *src;
+#endif
 
-    fa = (const struct flash_area *)(c->context);
+    lm = c->context;
     offset = c->block_size * block + off;
-    rc = flash_area_read(fa, offset, buffer, size);
-    if (rc != 0) {
-        return LFS_ERR_IO;
+
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    /* Memory mapped flash needs no transfer nor read-ahead window */
+    src = flash_area_mmap(lm->fa, offset, size);
+    if (src) {
+        memcpy(buffer, src, size);
+        return 0;
+    }
+#endif
+
+    if (lm->ra_size == 0 || size >= lm->ra_size) {
+        rc = flash_area_read(lm->fa, offset, buffer, size);
+        if (rc != 0) {
+            return LFS_ERR_IO;
+        }
+        return 0;
+    }
+
+    if (lm->ra_len == 0 || offset < lm->ra_off ||
+        offset + size > lm->ra_off + lm->ra_len) {
+
+        if (offset != lm->ra_next) {
+            /* Not a sequential read; don't pay for a window refill. */
+            lm->ra_next = offset + size;
+            rc = flash_area_read(lm->fa, offset, buffer, size);
+            if (rc != 0) {
+                return LFS_ERR_IO;
+            }
+            return 0;
+        }
+
+        len = min(lm->ra_size, lm->fa->fa_size - offset);
+        if (len < size) {
+            return LFS_ERR_IO;
+        }
+
+        rc = flash_area_read(lm->fa, offset, lm->ra_buf, len);
+        if (rc != 0) {
+            lm->ra_len = 0;
+            return LFS_ERR_IO;
+        }
+        lm->ra_off = offset;
+        lm->ra_len = len;
     }
 
+    memcpy(buffer, lm->ra_buf + (offset - lm->ra_off), size);
+    lm->ra_next = offset + size;
+
     return 0;
 }
 
@@ -170,12 +256,13 @@ flash_prog(const struct lfs_config *c, lfs_block_t block,
            lfs_off_t off, const void *buffer, lfs_size_t size)
 {
     int rc;
-    const struct flash_area *fa;
+    struct littlefs_mount *lm;
     uint32_t offset;
 
-    fa = (const struct flash_area *)(c->context);
+    lm = c->context;
     offset = c->block_size * block + off;
-    rc = flash_area_write(fa, offset, buffer, (uint32_t)size);
+    littlefs_ra_invalidate(lm, offset, size);
+    rc = flash_area_write(lm->fa, offset, buffer, (uint32_t)size);
     if (rc != 0) {
         return LFS_ERR_IO;
     }
@@ -193,10 +280,11 @@ static int
 flash_erase(const struct lfs_config *c, lfs_block_t block)
 {
     int rc;
-    const struct flash_area *fa;
+    struct littlefs_mount *lm;
 
-    fa = (const struct flash_area *)(c->context);
-    rc = flash_area_erase(fa, c->block_size * block, c->block_size);
+    lm = c->context;
+    littlefs_ra_invalidate(lm, c->block_size * block, c->block_size);
+    rc = flash_area_erase(lm->fa, c->block_size * block, c->block_size);
     if (rc != 0) {
         return LFS_ERR_IO;
     }
@@ -215,42 +303,87 @@ flash_sync(const struct lfs_config *c)
     return 0;
 }
 
-static lfs_t *g_lfs = NULL;
-static bool g_lfs_alloc_done = false;
-
 #define READ_SIZE       MYNEWT_VAL(MCU_FLASH_MIN_WRITE_SIZE)
 #define PROG_SIZE       MYNEWT_VAL(MCU_FLASH_MIN_WRITE_SIZE)
-#define CACHE_SIZE      16
-#define LOOKAHEAD_SIZE  16
+#define CACHE_SIZE      MYNEWT_VAL(LITTLEFS_CACHE_SIZE)
+#define LOOKAHEAD_SIZE  MYNEWT_VAL(LITTLEFS_LOOKAHEAD_SIZE)
+#define READ_AHEAD_SIZE MYNEWT_VAL(LITTLEFS_READ_AHEAD_SIZE)
 
 static uint8_t read_buffer[CACHE_SIZE];
 static uint8_t prog_buffer[CACHE_SIZE];
 static uint8_t __attribute__((aligned(4))) lookahead_buffer[LOOKAHEAD_SIZE];
-static struct lfs_config g_lfs_cfg = {
-    .context = NULL,
-
-    .read = flash_read,
-    .prog = flash_prog,
-    .erase = flash_erase,
-    .sync = flash_sync,
-
-    /* block device configuration */
-    .read_size = READ_SIZE,
-    .prog_size = PROG_SIZE,
-    .block_size = MYNEWT_VAL(LITTLEFS_BLOCK_SIZE),
-    .block_count = MYNEWT_VAL(LITTLEFS_BLOCK_COUNT),
-    .block_cycles = 500,
-    .cache_size = CACHE_SIZE,
-    .lookahead_size = LOOKAHEAD_SIZE,
-    .read_buffer = read_buffer,
-    .prog_buffer = prog_buffer,
-    .lookahead_buffer = lookahead_buffer,
-    .name_max = 0,
-    .file_max = 0,
-    .attr_max = 0,
-    .metadata_max = 0,
+#if READ_AHEAD_SIZE > 0
+static uint8_t read_ahead_buffer[READ_AHEAD_SIZE];
+#endif
+
+static struct littlefs_mount g_lfs_mount = {
+    .cfg = {
+        .context = &g_lfs_mount,
+
+        .read = flash_read,
+        .prog = flash_prog,
+        .erase = flash_erase,
+        .sync = flash_sync,
+
+        /* block device configuration */
+        .read_size = READ_SIZE,
+        .prog_size = PROG_SIZE,
+        .block_size = MYNEWT_VAL(LITTLEFS_BLOCK_SIZE),
+        .block_count = MYNEWT_VAL(LITTLEFS_BLOCK_COUNT),
+        .block_cycles = 500,
+        .cache_size = CACHE_SIZE,
+        .lookahead_size = LOOKAHEAD_SIZE,
+        .read_buffer = read_buffer,
+        .prog_buffer = prog_buffer,
+        .lookahead_buffer = lookahead_buffer,
+        .name_max = 0,
+        .file_max = 0,
+        .attr_max = 0,
+        .metadata_max = 0,
+    },
+#if READ_AHEAD_SIZE > 0
+    .ra_buf = read_ahead_buffer,
+    .ra_size = READ_AHEAD_SIZE,
+#endif
 };
 
+static bool g_lfs_alloc_done = false;
+static bool g_lfs_mounted = false;
+
+/* Additional mounts created with littlefs_mount_area(). */
+static SLIST_HEAD(, littlefs_mount) littlefs_mounts =
+    SLIST_HEAD_INITIALIZER(littlefs_mounts);
+
+/*
+ * Finds the mount a path refers to and returns the path with the disk
+ * prefix stripped.  Unprefixed paths belong to the default mount.
+ */
+static lfs_t *
+littlefs_lfs_for_path(const char *path, const char **out_path)
+{
+    struct littlefs_mount *lm;
+    const char *colon;
+    size_t len;
+
+    colon = strchr(path, ':');
+    if (colon == NULL) {
+        *out_path = path;
+        return g_lfs_mounted ? &g_lfs_mount.lfs : NULL;
+    }
+
+    len = colon - path;
+    SLIST_FOREACH(lm, &littlefs_mounts, next) {
+        if (strlen(lm->disk_name) == len &&
+            strncmp(lm->disk_name, path, len) == 0) {
+
+            *out_path = colon + 1;
+            return &lm->lfs;
+        }
+    }
+
+    return NULL;
+}
+
 static struct os_mutex littlefs_mutex;
 
 static void
@@ -276,6 +409,7 @@ littlefs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_fi
 {
     lfs_file_t *out_file = NULL;
     struct littlefs_file *file = NULL;
+    lfs_t *lfs;
     int flags;
     int rc;
 
@@ -283,6 +417,11 @@ littlefs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_fi
         return FS_EINVAL;
     }
 
+    lfs = littlefs_lfs_for_path(path, &path);
+    if (!lfs) {
+        return FS_EUNINIT;
+    }
+
     out_file = NULL;
 
     file = malloc(sizeof(struct littlefs_file));
@@ -321,7 +460,7 @@ littlefs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_fi
     }
 
     littlefs_lock();
-    rc = lfs_file_open(g_lfs, out_file, path, flags);
+    rc = lfs_file_open(lfs, out_file, path, flags);
     littlefs_unlock();
     if (rc != LFS_ERR_OK) {
         rc = littlefs_to_vfs_error(rc);
@@ -330,7 +469,7 @@ littlefs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_fi
 
     file->file = out_file;
     file->fops = &littlefs_ops;
-    file->lfs = g_lfs;
+    file->lfs = lfs;
     *out_fs_file = (struct fs_file *) file;
     rc = FS_EOK;
 
@@ -520,14 +659,20 @@ littlefs_flush(struct fs_file *fs_file)
 static int
 littlefs_unlink(const char *path)
 {
+    lfs_t *lfs;
     int rc;
 
     if (!path) {
         return FS_EINVAL;
     }
 
+    lfs = littlefs_lfs_for_path(path, &path);
+    if (!lfs) {
+        return FS_EUNINIT;
+    }
+
     littlefs_lock();
-    rc = lfs_remove(g_lfs, path);
+    rc = lfs_remove(lfs, path);
     littlefs_unlock();
 
     return littlefs_to_vfs_error(rc);
@@ -536,14 +681,25 @@ littlefs_unlink(const char *path)
 static int
 littlefs_rename(const char *from, const char *to)
 {
+    lfs_t *lfs;
     int rc;
 
     if (!from || !to) {
         return FS_EINVAL;
     }
 
+    lfs = littlefs_lfs_for_path(from, &from);
+    if (!lfs) {
+        return FS_EUNINIT;
+    }
+
+    /* Renaming across mounts is not supported. */
+    if (littlefs_lfs_for_path(to, &to) != lfs) {
+        return FS_EINVAL;
+    }
+
     littlefs_lock();
-    rc = lfs_rename(g_lfs, from, to);
+    rc = lfs_rename(lfs, from, to);
     littlefs_unlock();
 
     return littlefs_to_vfs_error(rc);
@@ -552,14 +708,20 @@ littlefs_rename(const char *from, const char *to)
 static int
 littlefs_mkdir(const char *path)
 {
+    lfs_t *lfs;
     int rc;
 
     if (!path) {
         return FS_EINVAL;
     }
 
+    lfs = littlefs_lfs_for_path(path, &path);
+    if (!lfs) {
+        return FS_EUNINIT;
+    }
+
     littlefs_lock();
-    rc = lfs_mkdir(g_lfs, path);
+    rc = lfs_mkdir(lfs, path);
     littlefs_unlock();
 
     return littlefs_to_vfs_error(rc);
@@ -570,12 +732,18 @@ littlefs_opendir(const char *path, struct fs_dir **out_fs_dir)
 {
     lfs_dir_t *out_dir = NULL;
     struct littlefs_dir *dir = NULL;
+    lfs_t *lfs;
     int rc;
 
     if (!path || !out_fs_dir) {
         return FS_EINVAL;
     }
 
+    lfs = littlefs_lfs_for_path(path, &path);
+    if (!lfs) {
+        return FS_EUNINIT;
+    }
+
     out_dir = NULL;
 
     dir = malloc(sizeof(struct littlefs_dir));
@@ -591,7 +759,7 @@ littlefs_opendir(const char *path, struct fs_dir **out_fs_dir)
     }
 
     littlefs_lock();
-    rc = lfs_dir_open(g_lfs, out_dir, path);
+    rc = lfs_dir_open(lfs, out_dir, path);
     littlefs_unlock();
     if (rc < 0) {
         rc = littlefs_to_vfs_error(rc);
@@ -601,7 +769,7 @@ littlefs_opendir(const char *path, struct fs_dir **out_fs_dir)
     dir->dir = out_dir;
     dir->cur_dirent = NULL;
     dir->fops = &littlefs_ops;
-    dir->lfs = g_lfs;
+    dir->lfs = lfs;
     *out_fs_dir = (struct fs_dir *)dir;
     rc = FS_EOK;
 
@@ -720,6 +888,25 @@ littlefs_dirent_is_dir(const struct fs_dirent *fs_dirent)
     return info->type == LFS_TYPE_DIR;
 }
 
+static int
+littlefs_mutex_init(void)
+{
+    static bool initialized;
+    int rc;
+
+    if (initialized) {
+        return FS_EOK;
+    }
+
+    rc = os_mutex_init(&littlefs_mutex);
+    if (rc != 0) {
+        return FS_EOS;
+    }
+
+    initialized = true;
+    return FS_EOK;
+}
+
 /*
  * Initializes only Mynewt glue, to fully initialize call
  * LitteFS must call littlefs_format or littlefs_mount.
@@ -733,42 +920,66 @@ littlefs_alloc(void)
     /*
      * Already initialized.
      */
-    if (g_lfs && g_lfs_alloc_done) {
+    if (g_lfs_alloc_done) {
         return FS_EOK;
     }
 
-    rc = os_mutex_init(&littlefs_mutex);
-    if (rc != 0) {
-        return FS_EOS;
-    }
-
-    g_lfs = malloc(sizeof(lfs_t));
-    if (!g_lfs) {
-        return FS_ENOMEM;
+    rc = littlefs_mutex_init();
+    if (rc != FS_EOK) {
+        return rc;
     }
 
     /*
      * This doesn't seem to be needed because lfs_mount initializes
      * all fields, but just to stay on the safe side...
      */
-    memset(g_lfs, 0, sizeof(lfs_t));
+    memset(&g_lfs_mount.lfs, 0, sizeof(lfs_t));
 
     rc = flash_area_open(MYNEWT_VAL(LITTLEFS_FLASH_AREA), &fa);
     if (rc) {
-        free(g_lfs);
-        g_lfs = NULL;
         return FS_EHW;
     }
 
     /*
      * TODO: could check that fa_size matches the configured block size * count
      */
-    g_lfs_cfg.context = (struct flash_area *)fa;
+    g_lfs_mount.fa = fa;
     g_lfs_alloc_done = true;
 
     return FS_EOK;
 }
 
+/*
+ * Mounts a littlefs instance, formatting it first if no valid file system
+ * is found and the configured detection failure policy says so.
+ */
+static int
+littlefs_mount_lfs(struct littlefs_mount *lm)
+{
+    int rc;
+
+    lm->ra_len = 0;
+    rc = lfs_mount(&lm->lfs, &lm->cfg);
+    switch (rc) {
+    case LFS_ERR_OK:
+        break;
+    case LFS_ERR_INVAL:
+    case LFS_ERR_CORRUPT:
+        /* No valid LittleFS instance detected; act based on configued
+         * detection failure policy.
+         */
+#if MYNEWT_VAL(LITTLEFS_DETECT_FAIL_FORMAT)
+        rc = lfs_format(&lm->lfs, &lm->cfg);
+        if (!rc) {
+            rc = lfs_mount(&lm->lfs, &lm->cfg);
+        }
+#endif
+        break;
+    }
+
+    return rc;
+}
+
 int
 littlefs_reformat(void)
 {
@@ -781,7 +992,8 @@ littlefs_reformat(void)
         }
     }
 
-    return lfs_format(g_lfs, &g_lfs_cfg);
+    g_lfs_mount.ra_len = 0;
+    return lfs_format(&g_lfs_mount.lfs, &g_lfs_mount.cfg);
 }
 
 int
@@ -796,31 +1008,106 @@ littlefs_init(void)
         }
     }
 
-    rc = lfs_mount(g_lfs, &g_lfs_cfg);
-    switch (rc) {
-    case LFS_ERR_OK:
-        break;
-    case LFS_ERR_INVAL:
-    case LFS_ERR_CORRUPT:
-        /* No valid LittleFS instance detected; act based on configued
-         * detection failure policy.
-         */
-#if MYNEWT_VAL(LITTLEFS_DETECT_FAIL_FORMAT)
-        rc = lfs_format(g_lfs, &g_lfs_cfg);
-        if (!rc) {
-            rc = lfs_mount(g_lfs, &g_lfs_cfg);
-        }
-#endif
-        break;
-    }
-
+    rc = littlefs_mount_lfs(&g_lfs_mount);
     if (!rc) {
+        g_lfs_mounted = true;
         fs_register(&littlefs_ops);
     }
 
     return rc;
 }
 
+int
+littlefs_mount_area(const struct littlefs_mount_cfg *cfg)
+{
+    struct littlefs_mount *lm;
+    const struct flash_area *fa;
+    uint32_t cache_size;
+    uint32_t lookahead_size;
+    uint8_t *buf;
+    int rc;
+
+    if (!cfg || !cfg->disk_name || !cfg->block_size || !cfg->block_count) {
+        return FS_EINVAL;
+    }
+
+    rc = littlefs_mutex_init();
+    if (rc != FS_EOK) {
+        return rc;
+    }
+
+    cache_size = cfg->cache_size ? cfg->cache_size : CACHE_SIZE;
+    lookahead_size = cfg->lookahead_size ? cfg->lookahead_size :
+                                           LOOKAHEAD_SIZE;
+    /* littlefs wants the lookahead size to be a multiple of 8. */
+    lookahead_size = (lookahead_size + 7) & ~7;
+
+    rc = flash_area_open(cfg->flash_area_id, &fa);
+    if (rc) {
+        return FS_EHW;
+    }
+
+    /*
+     * One allocation holds the mount, the lookahead buffer, both caches and
+     * the read-ahead window, in that order.
+     */
+    lm = malloc(((sizeof(*lm) + 3) & ~3) + lookahead_size + 2 * cache_size +
+                cfg->read_ahead_size);
+    if (!lm) {
+        return FS_ENOMEM;
+    }
+    memset(lm, 0, sizeof(*lm));
+    buf = (uint8_t *)lm + ((sizeof(*lm) + 3) & ~3);
+
+    lm->fa = fa;
+    lm->disk_name = cfg->disk_name;
+
+    lm->cfg.context = lm;
+    lm->cfg.read = flash_read;
+    lm->cfg.prog = flash_prog;
+    lm->cfg.erase = flash_erase;
+    lm->cfg.sync = flash_sync;
+    lm->cfg.read_size = READ_SIZE;
+    lm->cfg.prog_size = PROG_SIZE;
+    lm->cfg.block_size = cfg->block_size;
+    lm->cfg.block_count = cfg->block_count;
+    lm->cfg.block_cycles = 500;
+    lm->cfg.cache_size = cache_size;
+    lm->cfg.lookahead_size = lookahead_size;
+    lm->cfg.lookahead_buffer = buf;
+    buf += lookahead_size;
+    lm->cfg.read_buffer = buf;
+    buf += cache_size;
+    lm->cfg.prog_buffer = buf;
+    buf += cache_size;
+
+    if (cfg->read_ahead_size) {
+        lm->ra_buf = buf;
+        lm->ra_size = cfg->read_ahead_size;
+    }
+
+    rc = littlefs_mount_lfs(lm);
+    if (rc) {
+        free(lm);
+        return littlefs_to_vfs_error(rc);
+    }
+
+    rc = disk_register(lm->disk_name, littlefs_ops.f_name, NULL);
+    if (rc) {
+        lfs_unmount(&lm->lfs);
+        free(lm);
+        return FS_EEXIST;
+    }
+
+    littlefs_lock();
+    SLIST_INSERT_HEAD(&littlefs_mounts, lm, next);
+    littlefs_unlock();
+
+    fs_register(&littlefs_ops);
+
+    return FS_EOK;
+}
+
 void
 littlefs_pkg_init(void)
 {
@@ -22,6 +22,7 @@
 
 #include <stddef.h>
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
 #include "fs/fs.h"
 
 #ifdef __cplusplus
@@ -65,6 +66,18 @@ int nffs_format(const struct nffs_area_desc *area_descs);
 
 int nffs_misc_desc_from_flash_area(int idx, int *cnt, struct nffs_area_desc *nad);
 
+#if MYNEWT_VAL(NFFS_GC_BACKGROUND)
+struct os_eventq;
+
+/**
+ * Sets the event queue used for background garbage collection.  By default,
+ * the default event queue is used.
+ *
+ * @param evq                   The event queue to use.
+ */
+void nffs_gc_evq_set(struct os_eventq *evq);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
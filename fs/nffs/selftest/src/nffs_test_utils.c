@@ -109,8 +109,8 @@ nffs_test_util_assert_cache_is_sane(const char *filename)
             if (cache_block == TAILQ_FIRST(&cache_inode->nci_block_list)) {
                 TEST_ASSERT(cache_block->ncb_file_offset == cache_start);
             } else {
-                /* Ensure no gap between this block and its predecessor. */
-                TEST_ASSERT(cache_block->ncb_file_offset == block_end);
+                /* Ensure blocks are sorted and don't overlap. */
+                TEST_ASSERT(cache_block->ncb_file_offset >= block_end);
             }
 
             block_end = cache_block->ncb_file_offset +
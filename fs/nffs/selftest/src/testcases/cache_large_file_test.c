@@ -57,33 +57,36 @@ TEST_CASE_SELF(nffs_test_cache_large_file)
                                      nffs_block_max_data_sz * 2);
 
 
-    /* Cache fourth block; prior cache should get erased. */
+    /* Cache fourth block; prior cache is retained, leaving a gap. */
     rc = fs_seek(file, nffs_block_max_data_sz * 3);
     TEST_ASSERT(rc == 0);
     rc = fs_read(file, 1, &b, NULL);
     TEST_ASSERT(rc == 0);
     nffs_test_util_assert_cache_range("/myfile.txt",
-                                     nffs_block_max_data_sz * 3,
+                                     nffs_block_max_data_sz * 0,
                                      nffs_block_max_data_sz * 4);
 
-    /* Cache second and third blocks. */
-    rc = fs_seek(file, nffs_block_max_data_sz * 1);
+    /* Cache fifth block. */
+    rc = fs_seek(file, nffs_block_max_data_sz * 4);
     TEST_ASSERT(rc == 0);
     rc = fs_read(file, 1, &b, NULL);
     TEST_ASSERT(rc == 0);
     nffs_test_util_assert_cache_range("/myfile.txt",
-                                     nffs_block_max_data_sz * 1,
-                                     nffs_block_max_data_sz * 4);
+                                     nffs_block_max_data_sz * 0,
+                                     nffs_block_max_data_sz * 5);
 
-    /* Cache fifth block. */
-    rc = fs_seek(file, nffs_block_max_data_sz * 4);
+    /* Read across the gap; third block gets cached. */
+    rc = fs_seek(file, nffs_block_max_data_sz * 2);
     TEST_ASSERT(rc == 0);
     rc = fs_read(file, 1, &b, NULL);
     TEST_ASSERT(rc == 0);
     nffs_test_util_assert_cache_range("/myfile.txt",
-                                     nffs_block_max_data_sz * 1,
+                                     nffs_block_max_data_sz * 0,
                                      nffs_block_max_data_sz * 5);
 
+    /* Contents read correctly through the segmented cache. */
+    nffs_test_util_assert_contents("/myfile.txt", data, sizeof data);
+
     rc = fs_close(file);
     TEST_ASSERT(rc == 0);
 }
@@ -143,6 +143,45 @@ nffs_unlock(void)
     assert(rc == 0 || rc == OS_NOT_STARTED);
 }
 
+#if MYNEWT_VAL(NFFS_GC_BACKGROUND)
+static struct os_eventq *nffs_gc_evq;
+
+static void
+nffs_gc_event_cb(struct os_event *ev)
+{
+    int again;
+
+    nffs_lock();
+    again = nffs_misc_ready() && nffs_gc_bg_step();
+    nffs_unlock();
+
+    /* Let other file system users in between cycles. */
+    if (again) {
+        nffs_gc_bg_schedule();
+    }
+}
+
+static struct os_event nffs_gc_event = {
+    .ev_cb = nffs_gc_event_cb,
+};
+
+void
+nffs_gc_evq_set(struct os_eventq *evq)
+{
+    nffs_gc_evq = evq;
+}
+
+void
+nffs_gc_bg_schedule(void)
+{
+    if (nffs_gc_evq == NULL) {
+        nffs_gc_evq = os_eventq_dflt_get();
+    }
+
+    os_eventq_put(nffs_gc_evq, &nffs_gc_event);
+}
+#endif
+
 static int
 nffs_stats_init(void)
 {
@@ -26,6 +26,10 @@ TAILQ_HEAD(nffs_cache_inode_list, nffs_cache_inode);
 static struct nffs_cache_inode_list nffs_cache_inode_list =
     TAILQ_HEAD_INITIALIZER(nffs_cache_inode_list);
 
+/** All cached blocks of all inodes; least recently used at the tail. */
+static struct nffs_cache_block_list nffs_cache_block_lru =
+    TAILQ_HEAD_INITIALIZER(nffs_cache_block_lru);
+
 static void nffs_cache_reclaim_blocks(void);
 
 static struct nffs_cache_block *
@@ -49,6 +53,24 @@ nffs_cache_block_free(struct nffs_cache_block *entry)
     }
 }
 
+static void
+nffs_cache_block_touch(struct nffs_cache_block *cache_block)
+{
+    if (cache_block != TAILQ_FIRST(&nffs_cache_block_lru)) {
+        TAILQ_REMOVE(&nffs_cache_block_lru, cache_block, ncb_lru);
+        TAILQ_INSERT_HEAD(&nffs_cache_block_lru, cache_block, ncb_lru);
+    }
+}
+
+static void
+nffs_cache_block_remove(struct nffs_cache_block *cache_block)
+{
+    TAILQ_REMOVE(&cache_block->ncb_cache_inode->nci_block_list, cache_block,
+                 ncb_link);
+    TAILQ_REMOVE(&nffs_cache_block_lru, cache_block, ncb_lru);
+    nffs_cache_block_free(cache_block);
+}
+
 static struct nffs_cache_block *
 nffs_cache_block_acquire(void)
 {
@@ -65,24 +87,6 @@ nffs_cache_block_acquire(void)
     return cache_block;
 }
 
-static int
-nffs_cache_block_populate(struct nffs_cache_block *cache_block,
-                          struct nffs_hash_entry *block_entry,
-                          uint32_t end_offset)
-{
-    int rc;
-
-    rc = nffs_block_from_hash_entry(&cache_block->ncb_block, block_entry);
-    if (rc != 0) {
-        return rc;
-    }
-
-    cache_block->ncb_file_offset = end_offset -
-                                   cache_block->ncb_block.nb_data_len;
-
-    return 0;
-}
-
 static struct nffs_cache_inode *
 nffs_cache_inode_alloc(void)
 {
@@ -103,9 +107,12 @@ nffs_cache_inode_free_blocks(struct nffs_cache_inode *cache_inode)
     struct nffs_cache_block *cache_block;
 
     while ((cache_block = TAILQ_FIRST(&cache_inode->nci_block_list)) != NULL) {
-        TAILQ_REMOVE(&cache_inode->nci_block_list, cache_block, ncb_link);
-        nffs_cache_block_free(cache_block);
+        nffs_cache_block_remove(cache_block);
     }
+
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+    cache_inode->nci_skip_cnt = 0;
+#endif
 }
 
 static void
@@ -145,6 +152,7 @@ nffs_cache_inode_populate(struct nffs_cache_inode *cache_inode,
     int rc;
 
     memset(cache_inode, 0, sizeof *cache_inode);
+    TAILQ_INIT(&cache_inode->nci_block_list);
 
     rc = nffs_inode_from_entry(&cache_inode->nci_inode, inode_entry);
     if (rc != 0) {
@@ -160,25 +168,6 @@ nffs_cache_inode_populate(struct nffs_cache_inode *cache_inode,
     return 0;
 }
 
-/**
- * Retrieves the block entry corresponding to the last cached block in the
- * specified inode's list.  If the inode has no cached blocks, this function
- * returns null.
- */
-static struct nffs_hash_entry *
-nffs_cache_inode_last_entry(struct nffs_cache_inode *cache_inode)
-{
-    struct nffs_cache_block *cache_block;
-
-    if (TAILQ_EMPTY(&cache_inode->nci_block_list)) {
-        return NULL;
-    }
-
-    cache_block = TAILQ_LAST(&cache_inode->nci_block_list,
-                             nffs_cache_block_list);
-    return cache_block->ncb_block.nb_hash_entry;
-}
-
 static struct nffs_cache_inode *
 nffs_cache_inode_find(const struct nffs_inode_entry *inode_entry)
 {
@@ -193,6 +182,11 @@ nffs_cache_inode_find(const struct nffs_inode_entry *inode_entry)
     return NULL;
 }
 
+/**
+ * Retrieves the span of file offsets covered by an inode's cached blocks,
+ * from the start of the first cached block to the end of the last one.  The
+ * span may contain uncached gaps.
+ */
 void
 nffs_cache_inode_range(const struct nffs_cache_inode *cache_inode,
                       uint32_t *out_start, uint32_t *out_end)
@@ -214,20 +208,19 @@ nffs_cache_inode_range(const struct nffs_cache_inode *cache_inode,
                cache_block->ncb_block.nb_data_len;
 }
 
+/**
+ * Frees the least recently used cached block, regardless of which inode it
+ * belongs to.
+ */
 static void
 nffs_cache_reclaim_blocks(void)
 {
-    struct nffs_cache_inode *cache_inode;
+    struct nffs_cache_block *cache_block;
 
-    TAILQ_FOREACH_REVERSE(cache_inode, &nffs_cache_inode_list,
-                          nffs_cache_inode_list, nci_link) {
-        if (!TAILQ_EMPTY(&cache_inode->nci_block_list)) {
-            nffs_cache_inode_free_blocks(cache_inode);
-            return;
-        }
-    }
+    cache_block = TAILQ_LAST(&nffs_cache_block_lru, nffs_cache_block_list);
+    assert(cache_block != NULL);
 
-    assert(0);
+    nffs_cache_block_remove(cache_block);
 }
 
 void
@@ -253,6 +246,11 @@ nffs_cache_inode_ensure(struct nffs_cache_inode **out_cache_inode,
 
     cache_inode = nffs_cache_inode_find(inode_entry);
     if (cache_inode != NULL) {
+        /* Keep the inode list in LRU order. */
+        if (cache_inode != TAILQ_FIRST(&nffs_cache_inode_list)) {
+            TAILQ_REMOVE(&nffs_cache_inode_list, cache_inode, nci_link);
+            TAILQ_INSERT_HEAD(&nffs_cache_inode_list, cache_inode, nci_link);
+        }
         rc = 0;
         goto done;
     }
@@ -278,9 +276,9 @@ done:
 }
 
 /**
- * Recaches all cached inodes.  All cached blocks are deleted from the cache
- * during this operation.  This function should be called after garbage
- * collection occurs to ensure the cache is consistent.
+ * Recaches all cached inodes.  All cached blocks and skip index entries are
+ * deleted from the cache during this operation.  This function should be
+ * called after garbage collection occurs to ensure the cache is consistent.
  *
  * @return                      0 on success; nonzero on failure.
  */
@@ -330,38 +328,156 @@ nffs_cache_log_insert_block(struct nffs_cache_inode *cache_inode,
     nffs_cache_log_block(cache_inode, cache_block);
 }
 
-void
+/**
+ * Inserts a block into its inode's cached block list, keeping the list sorted
+ * by file offset.
+ */
+static void
 nffs_cache_insert_block(struct nffs_cache_inode *cache_inode,
-                        struct nffs_cache_block *cache_block,
-                        int tail)
+                        struct nffs_cache_block *cache_block)
 {
-    if (tail) {
+    struct nffs_cache_block *cur;
+
+    TAILQ_FOREACH(cur, &cache_inode->nci_block_list, ncb_link) {
+        if (cur->ncb_file_offset > cache_block->ncb_file_offset) {
+            break;
+        }
+    }
+
+    if (cur == NULL) {
         TAILQ_INSERT_TAIL(&cache_inode->nci_block_list, cache_block, ncb_link);
     } else {
-        TAILQ_INSERT_HEAD(&cache_inode->nci_block_list, cache_block, ncb_link);
+        TAILQ_INSERT_BEFORE(cur, cache_block, ncb_link);
+    }
+    TAILQ_INSERT_HEAD(&nffs_cache_block_lru, cache_block, ncb_lru);
+    cache_block->ncb_cache_inode = cache_inode;
+
+    nffs_cache_log_insert_block(cache_inode, cache_block,
+                                cur == NULL);
+}
+
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+
+#define NFFS_CACHE_SKIP_ENTRIES     MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES)
+
+/**
+ * Finds the skip index entry that ends closest after the specified file
+ * offset.
+ */
+static const struct nffs_cache_skip *
+nffs_cache_skip_find(const struct nffs_cache_inode *cache_inode,
+                     uint32_t seek_offset)
+{
+    int i;
+
+    /* Entries are sorted by end offset. */
+    for (i = 0; i < cache_inode->nci_skip_cnt; i++) {
+        if (cache_inode->nci_skip[i].ncs_end > seek_offset) {
+            return &cache_inode->nci_skip[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Records a block position in the inode's skip index.  When the index is
+ * full, the entry whose removal leaves the smallest gap between its
+ * neighbours is discarded so that the remaining entries stay spread over the
+ * file.
+ */
+static void
+nffs_cache_skip_insert(struct nffs_cache_inode *cache_inode,
+                       struct nffs_hash_entry *block_entry, uint32_t end)
+{
+    struct nffs_cache_skip skip[NFFS_CACHE_SKIP_ENTRIES + 1];
+    uint32_t best_gap;
+    uint32_t prev_end;
+    uint32_t next_end;
+    int victim;
+    int cnt;
+    int idx;
+    int i;
+
+    if (block_entry == NULL || end == 0) {
+        return;
+    }
+
+    cnt = cache_inode->nci_skip_cnt;
+    for (idx = 0; idx < cnt; idx++) {
+        if (cache_inode->nci_skip[idx].ncs_end >= end) {
+            break;
+        }
+    }
+    if (idx < cnt && cache_inode->nci_skip[idx].ncs_end == end) {
+        return;
+    }
+
+    memcpy(skip, cache_inode->nci_skip, idx * sizeof *skip);
+    skip[idx].ncs_block_entry = block_entry;
+    skip[idx].ncs_end = end;
+    memcpy(skip + idx + 1, cache_inode->nci_skip + idx,
+           (cnt - idx) * sizeof *skip);
+    cnt++;
+
+    if (cnt > NFFS_CACHE_SKIP_ENTRIES) {
+        victim = 0;
+        best_gap = UINT32_MAX;
+        for (i = 0; i < cnt; i++) {
+            prev_end = i > 0 ? skip[i - 1].ncs_end : 0;
+            next_end = i + 1 < cnt ? skip[i + 1].ncs_end :
+                                     cache_inode->nci_file_size;
+            if (next_end - prev_end < best_gap) {
+                best_gap = next_end - prev_end;
+                victim = i;
+            }
+        }
+
+        memmove(skip + victim, skip + victim + 1,
+                (cnt - victim - 1) * sizeof *skip);
+        cnt--;
+    }
+
+    memcpy(cache_inode->nci_skip, skip, cnt * sizeof *skip);
+    cache_inode->nci_skip_cnt = cnt;
+}
+
+#endif
+
+/**
+ * Returns the cached block that immediately precedes the specified one in its
+ * file.  If the preceding block is not cached, this function returns null;
+ * call nffs_cache_seek() to load it.
+ */
+struct nffs_cache_block *
+nffs_cache_block_prev(struct nffs_cache_block *cache_block)
+{
+    struct nffs_cache_block *prev;
+
+    prev = TAILQ_PREV(cache_block, nffs_cache_block_list, ncb_link);
+    if (prev == NULL ||
+        prev->ncb_block.nb_hash_entry != cache_block->ncb_block.nb_prev) {
+
+        return NULL;
     }
 
-    nffs_cache_log_insert_block(cache_inode, cache_block, tail);
+    nffs_cache_block_touch(prev);
+
+    return prev;
 }
 
 /**
  * Finds the data block containing the specified offset within a file inode.
  * If the block is not yet cached, it gets cached as a result of this
- * operation.  This function modifies the inode's cached block list according
- * to the following procedure:
+ * operation.  An inode's cached blocks need not be contiguous; the least
+ * recently used block of any inode is evicted when the block cache is full.
  *
- *  1. If none of the owning inode's blocks are currently cached, allocate a
- *     cached block entry and insert it into the inode's list.
- *  2. Else if the requested file offset is less than that of the first cached
- *     block, bridge the gap between the inode's sequence of cached blocks and
- *     the block that now needs to be cached.  This is accomplished by caching
- *     each block in the gap, finishing with the requested block.
- *  3. Else (the requested offset is beyond the end of the cache),
- *      a. If the requested offset belongs to the block that immediately
- *         follows the end of the cache, cache the block and append it to the
- *         list.
- *      b. Else, clear the cache, and populate it with the single entry
- *         corresponding to the requested block.
+ * A block that is not cached is located by scanning backwards through the
+ * file's block chain.  The scan starts from the nearest known block that
+ * ends after the requested offset: either a cached block, an entry in the
+ * inode's skip index, or the last block in the file.  The scan records new
+ * skip index entries as it goes so that later seeks into the same region
+ * are short.
  *
  * @param cache_inode           The cached file inode to seek within.
  * @param seek_offset           The file offset to seek to.
@@ -376,12 +492,12 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
                 struct nffs_cache_block **out_cache_block)
 {
     struct nffs_cache_block *cache_block;
-    struct nffs_hash_entry *last_cached_entry;
     struct nffs_hash_entry *block_entry;
-    struct nffs_hash_entry *pred_entry;
     struct nffs_block block;
-    uint32_t cache_start;
-    uint32_t cache_end;
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+    const struct nffs_cache_skip *skip;
+    int steps;
+#endif
     uint32_t block_start;
     uint32_t block_end;
     int rc;
@@ -391,106 +507,79 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
         return FS_ENOENT;
     }
 
-    nffs_cache_inode_range(cache_inode, &cache_start, &cache_end);
-    if (cache_end != 0 && seek_offset < cache_start) {
-        /* Seeking prior to cache.  Iterate backwards from cache start. */
-        cache_block = TAILQ_FIRST(&cache_inode->nci_block_list);
-        block_entry = cache_block->ncb_block.nb_prev;
-        block_end = cache_block->ncb_file_offset;
-        cache_block = NULL;
-    } else if (seek_offset < cache_end) {
-        /* Seeking within cache.  Iterate backwards from cache end. */
-        cache_block = TAILQ_LAST(&cache_inode->nci_block_list,
-                                 nffs_cache_block_list);
-        block_entry = cache_block->ncb_block.nb_hash_entry;
-        block_end = cache_end;
-    } else {
-        /* Seeking beyond end of cache.  Iterate backwards from file end.  If
-         * sought-after block is adjacent to cache end, its cache entry will
-         * get appended to the current cache.  Otherwise, the current cache
-         * will be freed and replaced with the single requested block.
-         */
-        cache_block = NULL;
-        block_entry =
-            cache_inode->nci_inode.ni_inode_entry->nie_last_block_entry;
-        block_end = cache_inode->nci_file_size;
+    /* Look for a cached block containing the offset.  Remember the first
+     * cached block that starts after it; the scan can begin there.
+     */
+    block_entry = cache_inode->nci_inode.ni_inode_entry->nie_last_block_entry;
+    block_end = cache_inode->nci_file_size;
+    TAILQ_FOREACH(cache_block, &cache_inode->nci_block_list, ncb_link) {
+        if (cache_block->ncb_file_offset > seek_offset) {
+            block_entry = cache_block->ncb_block.nb_prev;
+            block_end = cache_block->ncb_file_offset;
+            break;
+        }
+
+        if (seek_offset < cache_block->ncb_file_offset +
+                          cache_block->ncb_block.nb_data_len) {
+            nffs_cache_block_touch(cache_block);
+            goto done;
+        }
+    }
+
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+    skip = nffs_cache_skip_find(cache_inode, seek_offset);
+    if (skip != NULL && skip->ncs_end < block_end) {
+        block_entry = skip->ncs_block_entry;
+        block_end = skip->ncs_end;
     }
+    steps = 0;
+#endif
 
     /* Scan backwards until we find the block containing the seek offest. */
     while (1) {
-        if (block_end <= cache_start) {
-            /* We are looking before the start of the cache.  Allocate a new
-             * cache block and prepend it to the cache.
-             */
-            assert(cache_block == NULL);
-            cache_block = nffs_cache_block_acquire();
-            rc = nffs_cache_block_populate(cache_block, block_entry,
-                                           block_end);
-            if (rc != 0) {
-                return rc;
-            }
+        assert(block_entry != NULL);
 
-            nffs_cache_insert_block(cache_inode, cache_block, 0);
+        rc = nffs_block_from_hash_entry(&block, block_entry);
+        if (rc != 0) {
+            return rc;
         }
 
-        /* Calculate the file offset of the start of this block.  This is used
-         * to determine if this block contains the sought-after offset.
-         */
-        if (cache_block != NULL) {
-            /* Current block is cached. */
-            block_start = cache_block->ncb_file_offset;
-            pred_entry = cache_block->ncb_block.nb_prev;
-        } else {
-            /* We are looking beyond the end of the cache.  Read the data block
-             * from flash.
-             */
-            rc = nffs_block_from_hash_entry(&block, block_entry);
-            if (rc != 0) {
-                return rc;
-            }
+        block_start = block_end - block.nb_data_len;
+        if (block_start <= seek_offset) {
+            break;
+        }
 
-            block_start = block_end - block.nb_data_len;
-            pred_entry = block.nb_prev;
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+        if (++steps % MYNEWT_VAL(NFFS_CACHE_SKIP_STRIDE) == 0) {
+            nffs_cache_skip_insert(cache_inode, block.nb_prev, block_start);
         }
+#endif
 
-        if (block_start <= seek_offset) {
-            /* This block contains the requested address; iteration is
-             * complete.
-             */
-           if (cache_block == NULL) {
-                /* The block isn't cached, so it must come after the cache end.
-                 * Append it to the cache if it directly follows.  Otherwise,
-                 * erase the current cache and populate it with this single
-                 * block.
-                 */
-                cache_block = nffs_cache_block_acquire();
-                cache_block->ncb_block = block;
-                cache_block->ncb_file_offset = block_start;
-
-                last_cached_entry = nffs_cache_inode_last_entry(cache_inode);
-                if (last_cached_entry != NULL &&
-                    last_cached_entry == pred_entry) {
-
-                    nffs_cache_insert_block(cache_inode, cache_block, 1);
-                } else {
-                    nffs_cache_inode_free_blocks(cache_inode);
-                    nffs_cache_insert_block(cache_inode, cache_block, 0);
-                }
-            }
+        block_entry = block.nb_prev;
+        block_end = block_start;
+    }
 
-            if (out_cache_block != NULL) {
-                *out_cache_block = cache_block;
-            }
+    /* A cached copy of this block may be stale (e.g., the last block grew
+     * since it was cached).  Refresh it rather than caching it twice.
+     */
+    TAILQ_FOREACH(cache_block, &cache_inode->nci_block_list, ncb_link) {
+        if (cache_block->ncb_block.nb_hash_entry == block_entry) {
+            TAILQ_REMOVE(&cache_inode->nci_block_list, cache_block, ncb_link);
+            TAILQ_REMOVE(&nffs_cache_block_lru, cache_block, ncb_lru);
             break;
         }
+    }
 
-        /* Prepare for next iteration. */
-        if (cache_block != NULL) {
-            cache_block = TAILQ_PREV(cache_block, nffs_cache_block_list,
-                                     ncb_link);
-        }
-        block_entry = pred_entry;
-        block_end = block_start;
+    if (cache_block == NULL) {
+        cache_block = nffs_cache_block_acquire();
+    }
+    cache_block->ncb_block = block;
+    cache_block->ncb_file_offset = block_start;
+    nffs_cache_insert_block(cache_inode, cache_block);
+
+done:
+    if (out_cache_block != NULL) {
+        *out_cache_block = cache_block;
     }
 
     return 0;
@@ -18,6 +18,8 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include "hal/hal_flash.h"
 #include "nffs/nffs.h"
 #include "nffs_priv.h"
@@ -25,6 +27,97 @@
 /** A buffer used for flash reads; shared across all of nffs. */
 uint8_t nffs_flash_buf[NFFS_FLASH_BUF_SZ];
 
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+#define NFFS_FLASH_RA_SZ    MYNEWT_VAL(NFFS_RESTORE_BUF_SZ)
+
+/** Read-ahead window; only allocated while areas are being restored. */
+static uint8_t *nffs_flash_ra_buf;
+static uint32_t nffs_flash_ra_off;
+static uint32_t nffs_flash_ra_len;
+static uint8_t nffs_flash_ra_area_idx;
+
+/**
+ * Enables read-ahead for a forward scan of the specified area.  Small reads
+ * are served from a RAM copy of the area contents that follow the requested
+ * offset, so that the scan costs one flash read per window rather than
+ * several per object.  Reads from other areas, or from behind the window, go
+ * straight to flash.  If the window cannot be allocated, all reads are
+ * unbuffered.
+ *
+ * @param area_idx              The index of the area about to be scanned.
+ */
+void
+nffs_flash_ra_start(uint8_t area_idx)
+{
+    if (nffs_flash_ra_buf == NULL) {
+        nffs_flash_ra_buf = malloc(NFFS_FLASH_RA_SZ);
+    }
+    nffs_flash_ra_area_idx = area_idx;
+    nffs_flash_ra_off = 0;
+    nffs_flash_ra_len = 0;
+}
+
+/**
+ * Disables read-ahead and frees the read-ahead window.
+ */
+void
+nffs_flash_ra_stop(void)
+{
+    free(nffs_flash_ra_buf);
+    nffs_flash_ra_buf = NULL;
+    nffs_flash_ra_len = 0;
+}
+
+/**
+ * Attempts to satisfy a read from the read-ahead window, refilling the window
+ * if the read lies ahead of it.
+ *
+ * @return                      0 on success;
+ *                              FS_EHW on flash error;
+ *                              FS_ENOENT if the read should go to flash
+ *                                  directly.
+ */
+static int
+nffs_flash_ra_read(uint8_t area_idx, uint32_t area_offset, void *data,
+                   uint32_t len)
+{
+    const struct nffs_area *area;
+    uint32_t chunk_len;
+    int rc;
+
+    if (area_idx != nffs_flash_ra_area_idx ||
+        area_offset < nffs_flash_ra_off) {
+
+        return FS_ENOENT;
+    }
+
+    if (area_offset + len > nffs_flash_ra_off + nffs_flash_ra_len) {
+        /* Refill the window starting at the requested offset. */
+        area = nffs_areas + area_idx;
+        chunk_len = area->na_length - area_offset;
+        if (chunk_len > NFFS_FLASH_RA_SZ) {
+            chunk_len = NFFS_FLASH_RA_SZ;
+        }
+
+        STATS_INC(nffs_stats, nffs_iocnt_read);
+        rc = hal_flash_read(area->na_flash_id, area->na_offset + area_offset,
+                            nffs_flash_ra_buf, chunk_len);
+        if (rc != 0) {
+            nffs_flash_ra_len = 0;
+            return FS_EHW;
+        }
+
+        nffs_flash_ra_area_idx = area_idx;
+        nffs_flash_ra_off = area_offset;
+        nffs_flash_ra_len = chunk_len;
+    }
+
+    memcpy(data, nffs_flash_ra_buf + (area_offset - nffs_flash_ra_off), len);
+
+    return 0;
+}
+#endif
+
 /**
  * Reads a chunk of data from flash.
  *
@@ -54,6 +147,15 @@ nffs_flash_read(uint8_t area_idx, uint32_t area_offset, void *data,
         return FS_EOFFSET;
     }
 
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+    if (nffs_flash_ra_buf != NULL && len <= NFFS_FLASH_RA_SZ) {
+        rc = nffs_flash_ra_read(area_idx, area_offset, data, len);
+        if (rc != FS_ENOENT) {
+            return rc;
+        }
+    }
+#endif
+
     STATS_INC(nffs_stats, nffs_iocnt_read);
     rc = hal_flash_read(area->na_flash_id, area->na_offset + area_offset, data,
                         len);
@@ -96,6 +198,13 @@ nffs_flash_write(uint8_t area_idx, uint32_t area_offset, const void *data,
         return FS_EOFFSET;
     }
 
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+    /* Don't let the read-ahead window go stale. */
+    if (area_idx == nffs_flash_ra_area_idx) {
+        nffs_flash_ra_len = 0;
+    }
+#endif
+
     STATS_INC(nffs_stats, nffs_iocnt_write);
     rc = hal_flash_write(area->na_flash_id, area->na_offset + area_offset,
                          data, len);
@@ -467,7 +467,7 @@ nffs_gc(uint8_t *out_area_idx)
         return rc;
     }
 
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         entry = SLIST_FIRST(nffs_hash + i);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
@@ -572,3 +572,113 @@ nffs_gc_until(uint32_t space, uint8_t *out_area_idx)
 
     return FS_EFULL;
 }
+
+#if MYNEWT_VAL(NFFS_GC_BACKGROUND)
+
+/** Whether a background collection may run. */
+static uint8_t nffs_gc_bg_armed = 1;
+
+/** Number of background collections since the last re-arm. */
+static uint8_t nffs_gc_bg_steps;
+
+/** Bytes reserved since background collection was disarmed. */
+static uint32_t nffs_gc_bg_written;
+
+/**
+ * Calculates the total free space in all non-scratch areas.
+ */
+static uint32_t
+nffs_gc_free_space(uint32_t *out_capacity)
+{
+    uint32_t capacity;
+    uint32_t space;
+    int i;
+
+    capacity = 0;
+    space = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx) {
+            capacity += nffs_areas[i].na_length -
+                        sizeof (struct nffs_disk_area);
+            space += nffs_area_free_space(nffs_areas + i);
+        }
+    }
+
+    if (out_capacity != NULL) {
+        *out_capacity = capacity;
+    }
+
+    return space;
+}
+
+static int
+nffs_gc_bg_needed(void)
+{
+    uint32_t capacity;
+    uint32_t space;
+
+    space = nffs_gc_free_space(&capacity);
+
+    return (uint64_t)space * 100 <
+           (uint64_t)capacity * MYNEWT_VAL(NFFS_GC_BACKGROUND_FREE_PCT);
+}
+
+/**
+ * Called whenever space is reserved for a new object.  Schedules a background
+ * garbage collection cycle if free space has dropped below the watermark.
+ *
+ * Background collection disarms itself when a cycle fails to free any space,
+ * or after every area has been collected once; it is re-armed after
+ * NFFS_GC_BACKGROUND_REARM more bytes have been written.  This keeps an
+ * area without garbage from being erased over and over.
+ *
+ * @param space                 The number of bytes just reserved.
+ */
+void
+nffs_gc_bg_check(uint16_t space)
+{
+    if (!nffs_gc_bg_armed) {
+        nffs_gc_bg_written += space;
+        if (nffs_gc_bg_written < MYNEWT_VAL(NFFS_GC_BACKGROUND_REARM)) {
+            return;
+        }
+        nffs_gc_bg_armed = 1;
+        nffs_gc_bg_steps = 0;
+    }
+
+    if (nffs_gc_bg_needed()) {
+        nffs_gc_bg_schedule();
+    }
+}
+
+/**
+ * Performs one background garbage collection cycle, i.e., collects a single
+ * area.  The caller must hold the nffs lock.
+ *
+ * @return                      1 if another cycle should be scheduled;
+ *                              0 otherwise.
+ */
+int
+nffs_gc_bg_step(void)
+{
+    uint32_t before;
+    int rc;
+
+    if (!nffs_gc_bg_armed || !nffs_gc_bg_needed()) {
+        return 0;
+    }
+
+    before = nffs_gc_free_space(NULL);
+    rc = nffs_gc(NULL);
+    if (rc != 0 || nffs_gc_free_space(NULL) <= before ||
+        ++nffs_gc_bg_steps >= nffs_num_areas - 1) {
+
+        nffs_gc_bg_armed = 0;
+        nffs_gc_bg_written = 0;
+        return 0;
+    }
+
+    return nffs_gc_bg_needed();
+}
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include "nffs/nffs.h"
@@ -25,6 +26,9 @@
 
 struct nffs_hash_list *nffs_hash;
 
+/** Number of buckets in nffs_hash; always a power of two. */
+uint32_t nffs_hash_size;
+
 uint32_t nffs_hash_next_dir_id;
 uint32_t nffs_hash_next_file_id;
 uint32_t nffs_hash_next_block_id;
@@ -53,10 +57,11 @@ nffs_hash_id_is_block(uint32_t id)
     return id >= NFFS_ID_BLOCK_MIN && id < NFFS_ID_BLOCK_MAX;
 }
 
-static int
+int
 nffs_hash_fn(uint32_t id)
 {
-    return id % NFFS_HASH_SIZE;
+    /* IDs are allocated sequentially, so the low bits spread well. */
+    return id & (nffs_hash_size - 1);
 }
 
 static struct nffs_hash_entry *
@@ -194,6 +199,29 @@ nffs_hash_remove(struct nffs_hash_entry *entry)
     assert(nffs_hash_find(entry->nhe_id) == NULL);
 }
 
+/**
+ * Calculates the number of hash buckets to use.  The table is sized so that,
+ * with every inode and block entry in use, the average chain length does not
+ * exceed NFFS_HASH_LOAD_FACTOR.
+ */
+static uint32_t
+nffs_hash_calc_size(void)
+{
+    uint32_t entries;
+    uint32_t size;
+
+    entries = nffs_config.nc_num_inodes + nffs_config.nc_num_blocks;
+
+    size = NFFS_HASH_SIZE_MIN;
+    while (size < MYNEWT_VAL(NFFS_HASH_SIZE_MAX) &&
+           size * MYNEWT_VAL(NFFS_HASH_LOAD_FACTOR) < entries) {
+
+        size <<= 1;
+    }
+
+    return size;
+}
+
 int
 nffs_hash_init(void)
 {
@@ -201,12 +229,19 @@ nffs_hash_init(void)
 
     free(nffs_hash);
 
-    nffs_hash = malloc(NFFS_HASH_SIZE * sizeof *nffs_hash);
+    nffs_hash_size = nffs_hash_calc_size();
+    nffs_hash = malloc(nffs_hash_size * sizeof *nffs_hash);
     if (nffs_hash == NULL) {
-        return FS_ENOMEM;
+        /* Fall back to the minimum table size. */
+        nffs_hash_size = NFFS_HASH_SIZE_MIN;
+        nffs_hash = malloc(nffs_hash_size * sizeof *nffs_hash);
+        if (nffs_hash == NULL) {
+            nffs_hash_size = 0;
+            return FS_ENOMEM;
+        }
     }
 
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         SLIST_INIT(nffs_hash + i);
     }
 
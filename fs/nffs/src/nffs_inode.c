@@ -1108,7 +1108,7 @@ nffs_inode_read(struct nffs_inode_entry *inode_entry, uint32_t offset,
             return rc;
         }
 
-        cache_block = TAILQ_PREV(cache_block, nffs_cache_block_list, ncb_link);
+        cache_block = nffs_cache_block_prev(cache_block);
     }
 
     if (out_len != NULL) {
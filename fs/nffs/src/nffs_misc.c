@@ -220,6 +220,9 @@ nffs_misc_reserve_space(uint16_t space,
             rc = nffs_misc_reserve_space_area(i, space, out_area_offset);
             if (rc == 0) {
                 *out_area_idx = i;
+#if MYNEWT_VAL(NFFS_GC_BACKGROUND)
+                nffs_gc_bg_check(space);
+#endif
                 return 0;
             }
         }
@@ -32,7 +32,7 @@
 extern "C" {
 #endif
 
-#define NFFS_HASH_SIZE               256
+#define NFFS_HASH_SIZE_MIN           256
 
 #define NFFS_ID_DIR_MIN              0
 #define NFFS_ID_DIR_MAX              0x10000000
@@ -108,7 +108,9 @@ struct nffs_disk_block {
 
 /**
  * What gets stored in the hash table.  Each entry represents a data block or
- * an inode.
+ * an inode.  Data block entries are allocated from a pool of
+ * nffs_config.nc_num_blocks entries; on a 32-bit target each costs 12 bytes
+ * (plus pool overhead).
  */
 struct nffs_hash_entry {
     SLIST_ENTRY(nffs_hash_entry) nhe_next;
@@ -120,7 +122,12 @@ struct nffs_hash_entry {
 SLIST_HEAD(nffs_hash_list, nffs_hash_entry);
 SLIST_HEAD(nffs_inode_list, nffs_inode_entry);
 
-/** Each inode hash entry is actually one of these. */
+/**
+ * Each inode hash entry is actually one of these.  Inode entries are
+ * allocated from a pool of nffs_config.nc_num_inodes entries; on a 32-bit
+ * target each costs 24 bytes: the 12-byte hash entry, the sibling link, the
+ * child list / last block union, and four bytes of counters and flags.
+ */
 struct nffs_inode_entry {
     struct nffs_hash_entry nie_hash_entry;
     SLIST_ENTRY(nffs_inode_entry) nie_sibling_next;
@@ -219,21 +226,40 @@ struct nffs_path_parser {
     int npp_off;
 };
 
+struct nffs_cache_inode;
+
 /** Represents a single cached data block. */
 struct nffs_cache_block {
     TAILQ_ENTRY(nffs_cache_block) ncb_link; /* Next / prev cached block. */
+    TAILQ_ENTRY(nffs_cache_block) ncb_lru;  /* Global; LRU at tail. */
+    struct nffs_cache_inode *ncb_cache_inode; /* Owning cached inode. */
     struct nffs_block ncb_block;            /* Full data block. */
     uint32_t ncb_file_offset;               /* File offset of this block. */
 };
 
 TAILQ_HEAD(nffs_cache_block_list, nffs_cache_block);
 
+/**
+ * Skip index entry: a known block and the file offset at which it ends.  Used
+ * as a starting point when scanning backwards for an uncached block.
+ */
+struct nffs_cache_skip {
+    struct nffs_hash_entry *ncs_block_entry;
+    uint32_t ncs_end;
+};
+
 /** Represents a single cached file inode. */
 struct nffs_cache_inode {
     TAILQ_ENTRY(nffs_cache_inode) nci_link;        /* Sorted; LRU at tail. */
     struct nffs_inode nci_inode;                   /* Full inode. */
-    struct nffs_cache_block_list nci_block_list;   /* List of cached blocks. */
+    struct nffs_cache_block_list nci_block_list;   /* Cached blocks sorted by
+                                                      file offset; may contain
+                                                      gaps. */
     uint32_t nci_file_size;                        /* Total file size. */
+#if MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES) > 0
+    struct nffs_cache_skip nci_skip[MYNEWT_VAL(NFFS_CACHE_SKIP_ENTRIES)];
+    uint8_t nci_skip_cnt;                          /* # of valid entries. */
+#endif
 };
 
 struct nffs_dirent {
@@ -296,6 +322,7 @@ extern struct nffs_area_desc *nffs_current_area_descs;
 extern uint8_t nffs_flash_buf[NFFS_FLASH_BUF_SZ];
 
 extern struct nffs_hash_list *nffs_hash;
+extern uint32_t nffs_hash_size;
 extern struct nffs_inode_entry *nffs_root_dir;
 extern struct nffs_inode_entry *nffs_lost_found_dir;
 
@@ -344,6 +371,8 @@ void nffs_cache_inode_range(const struct nffs_cache_inode *cache_inode,
                             uint32_t *out_start, uint32_t *out_end);
 int nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t to,
                     struct nffs_cache_block **out_cache_block);
+struct nffs_cache_block *
+nffs_cache_block_prev(struct nffs_cache_block *cache_block);
 void nffs_cache_clear(void);
 
 /* @crc */
@@ -386,6 +415,11 @@ int nffs_format_full(const struct nffs_area_desc *area_descs);
 /* @gc */
 int nffs_gc(uint8_t *out_area_idx);
 int nffs_gc_until(uint32_t space, uint8_t *out_area_idx);
+#if MYNEWT_VAL(NFFS_GC_BACKGROUND)
+void nffs_gc_bg_check(uint16_t space);
+int nffs_gc_bg_step(void);
+void nffs_gc_bg_schedule(void);
+#endif
 
 /* @flash */
 struct nffs_area *nffs_flash_find_area(uint16_t logical_id);
@@ -399,6 +433,10 @@ int nffs_flash_copy(uint8_t area_id_from, uint32_t offset_from,
 uint32_t nffs_flash_loc(uint8_t area_idx, uint32_t offset);
 void nffs_flash_loc_expand(uint32_t flash_loc, uint8_t *out_area_idx,
                            uint32_t *out_area_offset);
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+void nffs_flash_ra_start(uint8_t area_idx);
+void nffs_flash_ra_stop(void);
+#endif
 
 /* @hash */
 int nffs_hash_id_is_dir(uint32_t id);
@@ -411,6 +449,7 @@ struct nffs_hash_entry *nffs_hash_find_block(uint32_t id);
 void nffs_hash_insert(struct nffs_hash_entry *entry);
 void nffs_hash_remove(struct nffs_hash_entry *entry);
 int nffs_hash_init(void);
+int nffs_hash_fn(uint32_t id);
 int nffs_hash_entry_is_dummy(struct nffs_hash_entry *he);
 int nffs_hash_id_is_dummy(uint32_t id);
 
@@ -503,7 +542,7 @@ int nffs_write_to_file(struct nffs_file *file, const void *data, int len);
 
 
 #define NFFS_HASH_FOREACH(entry, i, next)                               \
-    for ((i) = 0; (i) < NFFS_HASH_SIZE; (i)++)                          \
+    for ((i) = 0; (i) < nffs_hash_size; (i)++)                          \
         for ((entry) = SLIST_FIRST(nffs_hash + (i));                    \
              (entry) && (((next)) = SLIST_NEXT((entry), nhe_next), 1);  \
              (entry) = ((next)))
@@ -287,7 +287,7 @@ nffs_restore_sweep(void)
     /* Iterate through every object in the hash table, deleting all inodes that
      * should be removed.
      */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         list = nffs_hash + i;
 
         entry = SLIST_FIRST(list);
@@ -1159,7 +1159,7 @@ nffs_restore_corrupt_scratch(void)
     }
 
     /* Invalidate all objects resident in the bad area. */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_size; i++) {
         entry = SLIST_FIRST(&nffs_hash[i]);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
@@ -1357,12 +1357,21 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
             } else {
                 nffs_areas[cur_area_idx].na_cur =
                     sizeof (struct nffs_disk_area);
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+                /* The area is scanned front to back; read it in large
+                 * chunks.
+                 */
+                nffs_flash_ra_start(cur_area_idx);
+#endif
                 nffs_restore_area_contents(cur_area_idx);
             }
         }
     }
 
     /* All areas have been restored from flash. */
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+    nffs_flash_ra_stop();
+#endif
 
     if (nffs_scratch_area_idx == NFFS_AREA_ID_NONE) {
         /* No scratch area.  The system may have been rebooted in the middle of
@@ -1414,6 +1423,9 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
     return 0;
 
 err:
+#if MYNEWT_VAL(NFFS_RESTORE_BUF_SZ) > 0
+    nffs_flash_ra_stop();
+#endif
     nffs_misc_reset();
     return rc;
 }
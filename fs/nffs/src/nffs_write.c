@@ -364,8 +364,7 @@ nffs_write_chunk(struct nffs_inode_entry *inode_entry, uint32_t file_offset,
              */
             cache_block = NULL;
         } else {
-            cache_block = TAILQ_PREV(cache_block, nffs_cache_block_list,
-                                     ncb_link);
+            cache_block = nffs_cache_block_prev(cache_block);
         }
     } while (data_offset > 0);
 
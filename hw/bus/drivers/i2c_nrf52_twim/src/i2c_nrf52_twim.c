@@ -88,6 +88,18 @@ struct twim_dev_data {
     struct os_sem sem;
     uint32_t errorsrc;
     bool suspended;
+    /* Multi-segment transfer in progress */
+    const struct bus_xfer_seg *segs;
+    uint8_t seg_cnt;
+    uint8_t seg_idx;
+    /* Segments handled by current transfer (write + read done at once) */
+    uint8_t seg_step;
+    /* Suspend instead of STOP after last segment */
+    bool seg_nostop;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Queued transaction in progress */
+    struct bus_xfer *xfer;
+#endif
 
 #if MYNEWT_VAL(I2C_NRF52_TWIM_STAT)
     STATS_SECT_DECL(twim_stats_section) stats;
@@ -97,6 +109,100 @@ struct twim_dev_data {
 static struct bus_i2c_dev *twim_devs[TWIM_COUNT];
 static struct twim_dev_data twim_devs_data[TWIM_COUNT];
 
+static int nrf_twim_translate_twim(int twim_err);
+static void nrf_twim_start_task(NRF_TWIM_Type *nrf_twim,
+                                struct twim_dev_data *dd,
+                                __O uint32_t *task_start,
+                                __IO uint32_t *event_last);
+
+/*
+ * Starts segment seg_idx of multi-segment transfer. Write segment directly
+ * followed by read segment is done in one go, using repeated start shortcut.
+ * Transfer suspends after write segment unless it is the last one.
+ */
+static void
+twim_seg_start(NRF_TWIM_Type *nrf_twim, struct twim_dev_data *dd)
+{
+    const struct bus_xfer_seg *seg = &dd->segs[dd->seg_idx];
+    const struct bus_xfer_seg *next = NULL;
+
+    if (dd->seg_idx + 1 < dd->seg_cnt) {
+        next = seg + 1;
+    }
+
+    nrf_twim->INTEN = 0;
+    nrf_twim->EVENTS_ERROR = 0;
+    nrf_twim->EVENTS_STOPPED = 0;
+    nrf_twim->EVENTS_SUSPENDED = 0;
+    nrf_twim->EVENTS_TXSTARTED = 0;
+    nrf_twim->EVENTS_RXSTARTED = 0;
+
+    if (seg->rbuf) {
+        /* Read is always the last segment */
+        dd->seg_step = 1;
+        nrf_twim->RXD.PTR = (uint32_t)seg->rbuf;
+        nrf_twim->RXD.MAXCNT = seg->length;
+        nrf_twim->RXD.LIST = 0;
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTRX_STOP_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim_start_task(nrf_twim, dd, &nrf_twim->TASKS_STARTRX,
+                            &nrf_twim->EVENTS_LASTRX);
+        return;
+    }
+
+    nrf_twim->TXD.PTR = (uint32_t)seg->wbuf;
+    nrf_twim->TXD.MAXCNT = seg->length;
+    nrf_twim->TXD.LIST = 0;
+
+    if (next && next->rbuf) {
+        dd->seg_step = 2;
+        nrf_twim->RXD.PTR = (uint32_t)next->rbuf;
+        nrf_twim->RXD.MAXCNT = next->length;
+        nrf_twim->RXD.LIST = 0;
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_STARTRX_Msk |
+                           TWIM_SHORTS_LASTRX_STOP_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+    } else if (next || dd->seg_nostop) {
+        dd->seg_step = 1;
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_SUSPEND_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_SUSPENDED_Msk;
+    } else {
+        dd->seg_step = 1;
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+    }
+
+    nrf_twim->TASKS_RESUME = 1;
+    nrf_twim_start_task(nrf_twim, dd, &nrf_twim->TASKS_STARTTX,
+                        &nrf_twim->EVENTS_LASTTX);
+}
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+/* Completion of queued transaction, next one is started from here */
+static void
+twim_xfer_irq_handler(struct bus_i2c_dev *dev, struct twim_dev_data *dd,
+                      NRF_TWIM_Type *nrf_twim)
+{
+    struct bus_xfer *xfer;
+    int rc = 0;
+
+    xfer = dd->xfer;
+    dd->xfer = NULL;
+
+    if (dd->errorsrc) {
+        rc = nrf_twim_translate_twim(dd->errorsrc);
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim->TASKS_STOP = 1;
+    }
+
+    dd->suspended = !rc && xfer->type == BUS_XFER_WRITE &&
+                    (xfer->flags & BUS_F_NOSTOP);
+
+    bus_dev_xfer_done(&dev->bdev, rc);
+}
+#endif
+
 static void
 twim_irq_handler(struct bus_i2c_dev *dev)
 {
@@ -120,6 +226,22 @@ twim_irq_handler(struct bus_i2c_dev *dev)
     dd->errorsrc = nrf_twim->ERRORSRC;
     nrf_twim->ERRORSRC = dd->errorsrc;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    if (dd->xfer) {
+        twim_xfer_irq_handler(dev, dd, nrf_twim);
+        return;
+    }
+#endif
+
+    /* Continue multi-segment transfer, task is woken up when done */
+    if (dd->segs && !dd->errorsrc) {
+        dd->seg_idx += dd->seg_step;
+        if (dd->seg_idx < dd->seg_cnt) {
+            twim_seg_start(nrf_twim, dd);
+            return;
+        }
+    }
+
     os_sem_release(&dd->sem);
 }
 
@@ -580,6 +702,184 @@ bus_i2c_nrf52_twim_write(struct bus_dev *bdev, struct bus_node *bnode,
     return rc;
 }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+bus_i2c_nrf52_twim_xfer_start(struct bus_dev *bdev, struct bus_node *bnode,
+                              struct bus_xfer *xfer)
+{
+    struct bus_i2c_dev *dev = (struct bus_i2c_dev *)bdev;
+    struct bus_i2c_node *node = (struct bus_i2c_node *)bnode;
+    struct twim_dev_data *dd;
+    NRF_TWIM_Type *nrf_twim;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    /* Same as for blocking read, no stop after read is not possible */
+    if (xfer->type != BUS_XFER_WRITE && (xfer->flags & BUS_F_NOSTOP)) {
+        return SYS_ENOTSUP;
+    }
+
+    nrf_twim = twims[dev->cfg.i2c_num].nrf_twim;
+    dd = &twim_devs_data[dev->cfg.i2c_num];
+
+    if (!dd->suspended) {
+        nrf_twim_fix_sda(nrf_twim, dd);
+    }
+
+    dd->xfer = xfer;
+
+    nrf_twim->INTEN = 0;
+    nrf_twim->EVENTS_ERROR = 0;
+    nrf_twim->EVENTS_STOPPED = 0;
+    nrf_twim->EVENTS_SUSPENDED = 0;
+    nrf_twim->EVENTS_TXSTARTED = 0;
+    nrf_twim->EVENTS_RXSTARTED = 0;
+
+    if (xfer->type != BUS_XFER_WRITE) {
+        nrf_twim->RXD.PTR = (uint32_t)xfer->rbuf;
+        nrf_twim->RXD.MAXCNT = xfer->rlength;
+        nrf_twim->RXD.LIST = 0;
+    }
+    if (xfer->type != BUS_XFER_READ) {
+        nrf_twim->TXD.PTR = (uint32_t)xfer->wbuf;
+        nrf_twim->TXD.MAXCNT = xfer->wlength;
+        nrf_twim->TXD.LIST = 0;
+    }
+
+    switch (xfer->type) {
+    case BUS_XFER_READ:
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTRX_STOP_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim_start_task(nrf_twim, dd, &nrf_twim->TASKS_STARTRX,
+                            &nrf_twim->EVENTS_LASTRX);
+        break;
+    case BUS_XFER_WRITE:
+        if (xfer->flags & BUS_F_NOSTOP) {
+            nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_SUSPEND_Msk;
+            nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_SUSPENDED_Msk;
+        } else {
+            nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
+            nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+        }
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim_start_task(nrf_twim, dd, &nrf_twim->TASKS_STARTTX,
+                            &nrf_twim->EVENTS_LASTTX);
+        break;
+    default:
+        /*
+         * Register read in a single hardware transaction: repeated start
+         * after write and stop after read are done by shortcuts.
+         */
+        nrf_twim->SHORTS = TWIM_SHORTS_LASTTX_STARTRX_Msk |
+                           TWIM_SHORTS_LASTRX_STOP_Msk;
+        nrf_twim->INTEN = TWIM_INTEN_ERROR_Msk | TWIM_INTEN_STOPPED_Msk;
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim_start_task(nrf_twim, dd, &nrf_twim->TASKS_STARTTX,
+                            &nrf_twim->EVENTS_LASTTX);
+        break;
+    }
+
+    return 0;
+}
+
+static void
+bus_i2c_nrf52_twim_xfer_abort(struct bus_dev *bdev)
+{
+    struct bus_i2c_dev *dev = (struct bus_i2c_dev *)bdev;
+    struct twim_dev_data *dd;
+    NRF_TWIM_Type *nrf_twim;
+    os_sr_t sr;
+
+    nrf_twim = twims[dev->cfg.i2c_num].nrf_twim;
+    dd = &twim_devs_data[dev->cfg.i2c_num];
+
+    OS_ENTER_CRITICAL(sr);
+    if (dd->xfer) {
+        dd->xfer = NULL;
+        nrf_twim->INTEN = 0;
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim->TASKS_STOP = 1;
+        NVIC_ClearPendingIRQ(twims[dev->cfg.i2c_num].irqn);
+        dd->suspended = false;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+static int
+bus_i2c_nrf52_twim_xfer(struct bus_dev *bdev, struct bus_node *bnode,
+                        const struct bus_xfer_seg *segs, int cnt,
+                        os_time_t timeout, uint16_t flags)
+{
+    struct bus_i2c_dev *dev = (struct bus_i2c_dev *)bdev;
+    struct bus_i2c_node *node = (struct bus_i2c_node *)bnode;
+    struct twim_dev_data *dd;
+    NRF_TWIM_Type *nrf_twim;
+    bool nostop;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    nostop = flags & BUS_F_NOSTOP;
+
+    /*
+     * Only writes followed by single read can be done: there is no way to
+     * continue after read without STOP (see bus_i2c_nrf52_twim_read()).
+     */
+    if (cnt > UINT8_MAX) {
+        return SYS_EINVAL;
+    }
+    for (i = 0; i < cnt; i++) {
+        if (segs[i].wbuf && segs[i].rbuf) {
+            return SYS_ENOTSUP;
+        }
+        if (segs[i].rbuf && (i != cnt - 1 || nostop)) {
+            return SYS_ENOTSUP;
+        }
+    }
+
+    nrf_twim = twims[dev->cfg.i2c_num].nrf_twim;
+    dd = &twim_devs_data[dev->cfg.i2c_num];
+
+    if (!dd->suspended) {
+        nrf_twim_fix_sda(nrf_twim, dd);
+    }
+
+    dd->segs = segs;
+    dd->seg_cnt = cnt;
+    dd->seg_idx = 0;
+    dd->seg_nostop = nostop;
+
+    twim_seg_start(nrf_twim, dd);
+
+    rc = os_sem_pend(&dd->sem, timeout);
+    OS_ENTER_CRITICAL(sr);
+    dd->segs = NULL;
+    nrf_twim->INTEN = 0;
+    OS_EXIT_CRITICAL(sr);
+    if (rc == OS_TIMEOUT) {
+        rc = SYS_ETIMEOUT;
+    } else if (rc) {
+        rc = SYS_EUNKNOWN;
+    } else if (dd->errorsrc) {
+        rc = nrf_twim_translate_twim(dd->errorsrc);
+    }
+
+    if (rc) {
+        nrf_twim->TASKS_RESUME = 1;
+        nrf_twim->TASKS_STOP = 1;
+    }
+
+    dd->suspended = !rc && nostop;
+
+    return rc;
+}
+
 int
 bus_i2c_nrf52_twim_probe(struct bus_i2c_dev *dev, uint16_t address, os_time_t timeout)
 {
@@ -654,6 +954,11 @@ static const struct i2c_dev_ops bus_i2c_nrf52_twim_ops = {
         .read = bus_i2c_nrf52_twim_read,
         .write = bus_i2c_nrf52_twim_write,
         .disable = bus_i2c_nrf52_twim_disable,
+        .xfer = bus_i2c_nrf52_twim_xfer,
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+        .xfer_start = bus_i2c_nrf52_twim_xfer_start,
+        .xfer_abort = bus_i2c_nrf52_twim_xfer_abort,
+#endif
     },
     .probe = bus_i2c_nrf52_twim_probe,
 };
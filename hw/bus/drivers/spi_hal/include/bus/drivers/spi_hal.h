@@ -33,6 +33,16 @@ struct bus_spi_hal_dev {
     struct bus_spi_dev spi_dev;
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
     struct os_sem sem;
+    /* Multi-segment transfer in progress */
+    const struct bus_xfer_seg *segs;
+    uint8_t seg_cnt;
+    uint8_t seg_idx;
+    int seg_rc;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Queued transaction in progress */
+    struct bus_xfer *xfer;
+    uint8_t xfer_phase;
+#endif
 #endif
 };
 
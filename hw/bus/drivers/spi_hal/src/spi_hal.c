@@ -46,11 +46,85 @@ bus_spi_init_node(struct bus_dev *bdev, struct bus_node *bnode, void *arg)
 
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static void
+bus_spi_xfer_end(struct bus_spi_hal_dev *dev, int rc)
+{
+    struct bus_spi_node *node;
+    struct bus_xfer *xfer;
+
+    xfer = dev->xfer;
+    node = (struct bus_spi_node *)xfer->node;
+    dev->xfer = NULL;
+
+    if (rc || !(xfer->flags & BUS_F_NOSTOP)) {
+        hal_gpio_write(node->pin_cs, 1);
+    }
+
+    bus_dev_xfer_done((struct bus_dev *)dev, rc);
+}
+
+/* Called from txrx callback when transfer of queued transaction is done */
+static void
+bus_spi_xfer_step(struct bus_spi_hal_dev *dev)
+{
+    struct bus_xfer *xfer = dev->xfer;
+    int rc;
+
+    if (xfer->type != BUS_XFER_WRITE_READ || dev->xfer_phase != 0) {
+        bus_spi_xfer_end(dev, 0);
+        return;
+    }
+
+    /* Write part done, now read */
+    dev->xfer_phase = 1;
+    memset(xfer->rbuf, 0xFF, xfer->rlength);
+    rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, xfer->rbuf,
+                              xfer->rbuf, xfer->rlength);
+    if (rc) {
+        bus_spi_xfer_end(dev, SYS_EIO);
+    }
+}
+#endif
+
+static int
+bus_spi_seg_start(struct bus_spi_hal_dev *dev, const struct bus_xfer_seg *seg)
+{
+    uint8_t *tx;
+
+    if (seg->wbuf) {
+        /* XXX update HAL to accept const instead */
+        tx = (uint8_t *)seg->wbuf;
+    } else {
+        /* Same as for read, do not output random data */
+        memset(seg->rbuf, 0xFF, seg->length);
+        tx = seg->rbuf;
+    }
+
+    return hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, tx, seg->rbuf,
+                                seg->length);
+}
+
 static void
 bus_spi_txrx_cb(void *arg, int len)
 {
     struct bus_spi_hal_dev *dev = arg;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    if (dev->xfer) {
+        bus_spi_xfer_step(dev);
+        return;
+    }
+#endif
+
+    /* Start next segment right away, task is woken up when all are done */
+    if (dev->segs && ++dev->seg_idx < dev->seg_cnt) {
+        if (bus_spi_seg_start(dev, &dev->segs[dev->seg_idx]) == 0) {
+            return;
+        }
+        dev->seg_rc = SYS_EIO;
+    }
+
     os_sem_release(&dev->sem);
 }
 #endif
@@ -282,6 +356,109 @@ bus_spi_duplex_write_read(struct bus_dev *bdev, struct bus_node *bnode,
     return rc;
 }
 
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+bus_spi_xfer_start(struct bus_dev *bdev, struct bus_node *bnode,
+                   struct bus_xfer *xfer)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    int rc;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    dev->xfer = xfer;
+    dev->xfer_phase = 0;
+
+    hal_gpio_write(node->pin_cs, 0);
+
+    if (xfer->type == BUS_XFER_READ) {
+        memset(xfer->rbuf, 0xFF, xfer->rlength);
+        rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, xfer->rbuf,
+                                  xfer->rbuf, xfer->rlength);
+    } else {
+        /* XXX update HAL to accept const instead */
+        rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num,
+                                  (uint8_t *)xfer->wbuf, NULL, xfer->wlength);
+    }
+
+    if (rc) {
+        dev->xfer = NULL;
+        hal_gpio_write(node->pin_cs, 1);
+        rc = SYS_EIO;
+    }
+
+    return rc;
+}
+
+static void
+bus_spi_xfer_abort(struct bus_dev *bdev)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (dev->xfer) {
+        node = (struct bus_spi_node *)dev->xfer->node;
+        dev->xfer = NULL;
+        hal_spi_abort(dev->spi_dev.cfg.spi_num);
+        hal_gpio_write(node->pin_cs, 1);
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
+static int
+bus_spi_xfer(struct bus_dev *bdev, struct bus_node *bnode,
+             const struct bus_xfer_seg *segs, int cnt, os_time_t timeout,
+             uint16_t flags)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    os_sr_t sr;
+    int rc;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    if (cnt > UINT8_MAX) {
+        return SYS_EINVAL;
+    }
+
+    hal_gpio_write(node->pin_cs, 0);
+
+    dev->segs = segs;
+    dev->seg_cnt = cnt;
+    dev->seg_idx = 0;
+    dev->seg_rc = 0;
+
+    rc = bus_spi_seg_start(dev, &segs[0]);
+    if (rc == 0) {
+        rc = os_sem_pend(&dev->sem, timeout);
+        if (rc) {
+            OS_ENTER_CRITICAL(sr);
+            dev->segs = NULL;
+            hal_spi_abort(dev->spi_dev.cfg.spi_num);
+            OS_EXIT_CRITICAL(sr);
+            rc = os_error_to_sys(rc);
+        } else {
+            rc = dev->seg_rc;
+        }
+    }
+
+    dev->segs = NULL;
+
+    if (rc || !(flags & BUS_F_NOSTOP)) {
+        hal_gpio_write(node->pin_cs, 1);
+    }
+
+    return rc;
+}
+#endif
+
 static int bus_spi_disable(struct bus_dev *bdev)
 {
     struct bus_spi_dev *spi_dev = (struct bus_spi_dev *)bdev;
@@ -306,6 +483,13 @@ static const struct bus_dev_ops bus_spi_ops = {
     .disable = bus_spi_disable,
     .write_read = bus_spi_write_read,
     .duplex_write_read = bus_spi_duplex_write_read,
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
+    .xfer = bus_spi_xfer,
+#endif
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_XFER_QUEUE)
+    .xfer_start = bus_spi_xfer_start,
+    .xfer_abort = bus_spi_xfer_abort,
+#endif
 };
 
 int
@@ -107,6 +107,15 @@ struct spi_stm32_driver_data {
     const struct stm32_spi_hw *hw;
     /* Semaphore used for end of transfer completion notification */
     struct os_sem sem;
+    /* Multi-segment transfer in progress */
+    const struct bus_xfer_seg *segs;
+    uint8_t seg_cnt;
+    uint8_t seg_idx;
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Queued transaction in progress */
+    struct bus_xfer *xfer;
+    uint8_t xfer_phase;
+#endif
 
 #if MYNEWT_VAL(SPI_STM32_STAT)
     STATS_SECT_DECL(spi_stm32_stats_section) stats;
@@ -664,11 +673,111 @@ end:
     return rc;
 }
 
+static void
+spi_stm32_rx_start(struct spi_stm32_driver_data *dd, uint8_t *buf,
+                   uint16_t length)
+{
+    if (MIN_DMA_RX_SIZE >= 0 && length >= MIN_DMA_RX_SIZE) {
+        HAL_SPI_Receive_DMA(&dd->hspi, buf, length);
+    } else {
+        HAL_SPI_Receive_IT(&dd->hspi, buf, length);
+    }
+}
+
+static void
+spi_stm32_tx_start(struct spi_stm32_driver_data *dd, const uint8_t *buf,
+                   uint16_t length)
+{
+    if (MIN_DMA_TX_SIZE >= 0 && length >= MIN_DMA_TX_SIZE) {
+        HAL_SPI_Transmit_DMA(&dd->hspi, (uint8_t *)buf, length);
+    } else {
+        HAL_SPI_Transmit_IT(&dd->hspi, (uint8_t *)buf, length);
+    }
+}
+
+static void
+spi_stm32_seg_start(struct spi_stm32_driver_data *dd,
+                    const struct bus_xfer_seg *seg)
+{
+    if (seg->wbuf && seg->rbuf) {
+        if (MIN_DMA_TX_SIZE >= 0 && seg->length >= MIN_DMA_TX_SIZE) {
+            HAL_SPI_TransmitReceive_DMA(&dd->hspi, (uint8_t *)seg->wbuf,
+                                        seg->rbuf, seg->length);
+        } else {
+            HAL_SPI_TransmitReceive_IT(&dd->hspi, (uint8_t *)seg->wbuf,
+                                       seg->rbuf, seg->length);
+        }
+    } else if (seg->wbuf) {
+        spi_stm32_tx_start(dd, seg->wbuf, seg->length);
+    } else {
+        spi_stm32_rx_start(dd, seg->rbuf, seg->length);
+    }
+}
+
+/*
+ * Starts next segment of multi-segment transfer from completion callback.
+ * Returns true if there was one.
+ */
+static bool
+spi_stm32_seg_next(struct spi_stm32_driver_data *dd)
+{
+    if (!dd->segs || ++dd->seg_idx >= dd->seg_cnt) {
+        return false;
+    }
+
+    spi_stm32_seg_start(dd, &dd->segs[dd->seg_idx]);
+
+    return true;
+}
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+
+/* Called from completion callback when part of queued transaction is done */
+static void
+spi_stm32_xfer_step(struct spi_stm32_driver_data *dd)
+{
+    struct bus_xfer *xfer = dd->xfer;
+    struct bus_spi_node *node = (struct bus_spi_node *)xfer->node;
+
+    if (xfer->type == BUS_XFER_WRITE_READ && dd->xfer_phase == 0) {
+        /* Write part done, now read */
+        SPI_STATS_INCN(dd->stats, written_bytes, xfer->wlength);
+        dd->xfer_phase = 1;
+        spi_stm32_rx_start(dd, xfer->rbuf, xfer->rlength);
+        return;
+    }
+
+    if (xfer->type == BUS_XFER_WRITE) {
+        SPI_STATS_INCN(dd->stats, written_bytes, xfer->wlength);
+    } else {
+        SPI_STATS_INCN(dd->stats, read_bytes, xfer->rlength);
+    }
+
+    if (!(xfer->flags & BUS_F_NOSTOP) && node->pin_cs >= 0) {
+        hal_gpio_write(node->pin_cs, 1);
+    }
+
+    dd->xfer = NULL;
+    bus_dev_xfer_done(&dd->dev->bdev, 0);
+}
+#endif
+
 void
 HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
 {
     struct spi_stm32_driver_data *dd = (struct spi_stm32_driver_data *)hspi;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    if (dd->xfer) {
+        spi_stm32_xfer_step(dd);
+        return;
+    }
+#endif
+
+    if (spi_stm32_seg_next(dd)) {
+        return;
+    }
+
     os_sem_release(&dd->sem);
 }
 
@@ -677,6 +786,17 @@ HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
 {
     struct spi_stm32_driver_data *dd = (struct spi_stm32_driver_data *)hspi;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    if (dd->xfer) {
+        spi_stm32_xfer_step(dd);
+        return;
+    }
+#endif
+
+    if (spi_stm32_seg_next(dd)) {
+        return;
+    }
+
     os_sem_release(&dd->sem);
 }
 
@@ -685,6 +805,10 @@ HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
 {
     struct spi_stm32_driver_data *dd = (struct spi_stm32_driver_data *)hspi;
 
+    if (spi_stm32_seg_next(dd)) {
+        return;
+    }
+
     os_sem_release(&dd->sem);
 }
 
@@ -857,6 +981,122 @@ spi_stm32_duplex_write_read(struct bus_dev *bdev, struct bus_node *bnode,
     return rc;
 }
 
+#if MYNEWT_VAL(OS_SCHEDULING)
+static int
+spi_stm32_xfer(struct bus_dev *bdev, struct bus_node *bnode,
+               const struct bus_xfer_seg *segs, int cnt, os_time_t timeout,
+               uint16_t flags)
+{
+    struct bus_spi_dev *dev = (struct bus_spi_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    struct spi_stm32_driver_data *dd;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    if (cnt > UINT8_MAX) {
+        return SYS_EINVAL;
+    }
+
+    dd = driver_data(dev);
+
+    if (node->pin_cs >= 0) {
+        hal_gpio_write(node->pin_cs, 0);
+    }
+
+    assert(os_sem_get_count(&dd->sem) == 0);
+
+    /* Segments are chained from completion callbacks */
+    dd->segs = segs;
+    dd->seg_cnt = cnt;
+    dd->seg_idx = 0;
+    spi_stm32_seg_start(dd, &segs[0]);
+
+    rc = os_sem_pend(&dd->sem, timeout);
+    if (rc) {
+        OS_ENTER_CRITICAL(sr);
+        dd->segs = NULL;
+        OS_EXIT_CRITICAL(sr);
+        HAL_SPI_Abort(&dd->hspi);
+        SPI_STATS_INC(dd->stats, transaction_error_count);
+    } else {
+        for (i = 0; i < cnt; i++) {
+            if (segs[i].wbuf) {
+                SPI_STATS_INCN(dd->stats, written_bytes, segs[i].length);
+            }
+            if (segs[i].rbuf) {
+                SPI_STATS_INCN(dd->stats, read_bytes, segs[i].length);
+            }
+        }
+    }
+    dd->segs = NULL;
+
+    rc = os_error_to_sys(rc);
+
+    if ((rc != 0 || !(flags & BUS_F_NOSTOP)) && node->pin_cs >= 0) {
+        hal_gpio_write(node->pin_cs, 1);
+    }
+
+    return rc;
+}
+#endif
+
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static int
+spi_stm32_xfer_start(struct bus_dev *bdev, struct bus_node *bnode,
+                     struct bus_xfer *xfer)
+{
+    struct bus_spi_dev *dev = (struct bus_spi_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    struct spi_stm32_driver_data *dd;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    dd = driver_data(dev);
+
+    dd->xfer = xfer;
+    dd->xfer_phase = 0;
+
+    if (node->pin_cs >= 0) {
+        hal_gpio_write(node->pin_cs, 0);
+    }
+
+    if (xfer->type == BUS_XFER_READ) {
+        SPI_STATS_INC(dd->stats, read_count);
+        spi_stm32_rx_start(dd, xfer->rbuf, xfer->rlength);
+    } else {
+        SPI_STATS_INC(dd->stats, write_count);
+        spi_stm32_tx_start(dd, xfer->wbuf, xfer->wlength);
+    }
+
+    return 0;
+}
+
+static void
+spi_stm32_xfer_abort(struct bus_dev *bdev)
+{
+    struct bus_spi_dev *dev = (struct bus_spi_dev *)bdev;
+    struct spi_stm32_driver_data *dd;
+    struct bus_spi_node *node;
+
+    dd = driver_data(dev);
+
+    if (dd->xfer) {
+        node = (struct bus_spi_node *)dd->xfer->node;
+        dd->xfer = NULL;
+        HAL_SPI_Abort(&dd->hspi);
+        SPI_STATS_INC(dd->stats, transaction_error_count);
+        if (node->pin_cs >= 0) {
+            hal_gpio_write(node->pin_cs, 1);
+        }
+    }
+}
+#endif
+
 static int
 spi_stm32_enable(struct bus_dev *bdev)
 {
@@ -894,6 +1134,13 @@ static const struct bus_dev_ops bus_spi_stm32_ops = {
     .write = spi_stm32_write,
     .disable = spi_stm32_disable,
     .duplex_write_read = spi_stm32_duplex_write_read,
+#if MYNEWT_VAL(OS_SCHEDULING)
+    .xfer = spi_stm32_xfer,
+#endif
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    .xfer_start = spi_stm32_xfer_start,
+    .xfer_abort = spi_stm32_xfer_abort,
+#endif
 };
 
 /* Helper function to setup interrupt handler for SPI and DMA */
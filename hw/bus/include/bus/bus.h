@@ -22,8 +22,10 @@
 
 #include <stdint.h>
 #include "os/os_dev.h"
+#include "os/os_mbuf.h"
 #include "os/os_mutex.h"
 #include "os/os_time.h"
+#include "os/queue.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +40,68 @@ extern "C" {
 /* Use as default timeout to lock node */
 #define BUS_NODE_LOCK_DEFAULT_TIMEOUT        ((os_time_t) -1)
 
+/**
+ * Transaction types for bus_node_submit()
+ */
+#define BUS_XFER_READ           0
+#define BUS_XFER_WRITE          1
+#define BUS_XFER_WRITE_READ     2
+
+/**
+ * Segment of multi-segment transaction
+ *
+ * Segment with only wbuf set is written, with only rbuf set is read. On SPI,
+ * segment with both set is written and read at the same time.
+ */
+struct bus_xfer_seg {
+    /** Data to be written, NULL for read segment */
+    const void *wbuf;
+    /** Buffer to read data into, NULL for write segment */
+    void *rbuf;
+    /** Length of segment */
+    uint16_t length;
+};
+
+struct bus_xfer;
+
+/**
+ * Transaction completion callback
+ *
+ * Called once the transaction is done, with xfer->rc set to 0 on success or
+ * SYS_xxx on error. This may be called from interrupt context, so anything
+ * lengthy should be deferred, e.g. by posting an event. The callback may
+ * submit new transactions, including the one just completed.
+ */
+typedef void (* bus_xfer_cb)(struct bus_xfer *xfer);
+
+/**
+ * Queued bus transaction
+ *
+ * Filled in by caller and passed to bus_node_submit(). The object and
+ * buffers shall stay valid until completion callback is called.
+ */
+struct bus_xfer {
+    STAILQ_ENTRY(bus_xfer) next;
+    /** Node device object */
+    struct os_dev *node;
+    /** Data to be written, for BUS_XFER_WRITE and BUS_XFER_WRITE_READ */
+    const uint8_t *wbuf;
+    /** Buffer to read data into, for BUS_XFER_READ and BUS_XFER_WRITE_READ */
+    uint8_t *rbuf;
+    uint16_t wlength;
+    uint16_t rlength;
+    /** Flags, as for bus_node_read() and bus_node_write() */
+    uint16_t flags;
+    /** Transaction type, BUS_XFER_xxx */
+    uint8_t type;
+    /** Time allowed for transfer itself, queueing time excluded */
+    os_time_t timeout;
+    bus_xfer_cb cb;
+    void *arg;
+    /** Transaction result, valid in completion callback */
+    int rc;
+};
+
 /** Bus PM mode */
 typedef enum {
     /* Bus device enable/disable is controlled by application */
@@ -103,6 +167,31 @@ int
 bus_node_write(struct os_dev *node, const void *buf, uint16_t length,
                os_time_t timeout, uint16_t flags);
 
+/**
+ * Write a byte range of an mbuf chain to node
+ *
+ * Writes each data segment of the range straight from the chain, without
+ * copying it into a flat buffer. Bus is locked for the whole range and all
+ * segments but the last are written with BUS_F_NOSTOP, so on SPI the range
+ * is sent within a single chip select assertion. On I2C a repeated start
+ * separates the segments.
+ *
+ * The timeout parameter applies to each segment.
+ *
+ * @param node     Node device object
+ * @param om       Mbuf chain with data to be written
+ * @param off      Offset of the data within the chain
+ * @param length   Length of data to be written
+ * @param timeout  Operation timeout
+ * @param flags    Flags
+ *
+ * @return 0 on success, SYS_xxx on error
+ */
+int
+bus_node_write_mbuf(struct os_dev *node, const struct os_mbuf *om,
+                    uint16_t off, uint16_t length, os_time_t timeout,
+                    uint16_t flags);
+
 /**
  * Perform write and read transaction on node
  *
@@ -149,6 +238,52 @@ bus_node_duplex_write_read(struct os_dev *node, const void *wbuf,
                            void *rbuf, uint16_t length,
                            os_time_t timeout, uint16_t flags);
 
+/**
+ * Perform multi-segment transaction on node
+ *
+ * Transfers list of segments within single transaction, i.e. chip select is
+ * kept asserted on SPI between segments and no STOP is sent on I2C (segments
+ * are separated by a repeated start). This allows to e.g. send command and
+ * payload from separate buffers without copying them.
+ * Bus is locked automatically for the duration of operation.
+ *
+ * Drivers may not support every combination of segments; in particular on
+ * I2C only write segments followed by at most one read segment may be
+ * supported.
+ *
+ * The timeout parameter applies to complete transaction time.
+ *
+ * @param node     Node device object
+ * @param segs     Array of segments
+ * @param cnt      Number of segments
+ * @param timeout  Operation timeout
+ * @param flags    Flags, BUS_F_NOSTOP applies to last segment
+ *
+ * @return 0 on success, SYS_xxx on error
+ */
+int
+bus_node_xfer(struct os_dev *node, const struct bus_xfer_seg *segs, int cnt,
+              os_time_t timeout, uint16_t flags);
+
+/**
+ * Submit transaction without waiting for its completion
+ *
+ * Queues transaction on parent bus of node. Queued transactions are executed
+ * in order, back-to-back, as soon as bus is not locked by any task. Drivers
+ * which support it start each transaction directly from completion interrupt
+ * of the previous one; otherwise transactions are executed from default event
+ * queue. Bus is configured for node automatically.
+ *
+ * This can be called from interrupt context.
+ *
+ * @param node  Node device object
+ * @param xfer  Transaction to submit
+ *
+ * @return 0 on success, SYS_xxx on error
+ */
+int
+bus_node_submit(struct os_dev *node, struct bus_xfer *xfer);
+
 /**
  * Read data from node
  *
@@ -273,6 +408,19 @@ bus_node_unlock(struct os_dev *node);
 os_time_t
 bus_node_get_lock_timeout(struct os_dev *node);
 
+/**
+ * Get bus device node is attached to
+ *
+ * Nodes returning the same bus share the interface and can't be accessed
+ * concurrently.
+ *
+ * @param node  Node to get bus for
+ *
+ * @return bus device object
+ */
+struct os_dev *
+bus_node_get_bus(struct os_dev *node);
+
 /**
  * Set power management settings for bus device
  *
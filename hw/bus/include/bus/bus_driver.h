@@ -32,6 +32,8 @@ extern "C" {
 
 struct bus_dev;
 struct bus_node;
+struct bus_xfer;
+struct bus_xfer_seg;
 
 #if MYNEWT_VAL(BUS_STATS)
 STATS_SECT_START(bus_stats_section)
@@ -40,6 +42,7 @@ STATS_SECT_START(bus_stats_section)
     STATS_SECT_ENTRY(read_errors)
     STATS_SECT_ENTRY(write_ops)
     STATS_SECT_ENTRY(write_errors)
+    STATS_SECT_ENTRY(reconfigs)
 STATS_SECT_END
 #endif
 
@@ -72,6 +75,24 @@ struct bus_dev_ops {
     int (* duplex_write_read)(struct bus_dev *bdev, struct bus_node *bnode,
                               const uint8_t *wbuf, uint8_t *rbuf, uint16_t length,
                               os_time_t timeout, uint16_t flags);
+    /*
+     * Transfer list of segments as single transaction (optional). If not
+     * set, segments are transferred using other operations.
+     */
+    int (* xfer)(struct bus_dev *bdev, struct bus_node *bnode,
+                 const struct bus_xfer_seg *segs, int cnt,
+                 os_time_t timeout, uint16_t flags);
+    /*
+     * Start queued transaction without blocking (optional). Driver calls
+     * bus_dev_xfer_done() once it completes.
+     */
+    int (* xfer_start)(struct bus_dev *bdev, struct bus_node *bnode,
+                       struct bus_xfer *xfer);
+    /*
+     * Abort transaction started by xfer_start on timeout. Driver shall not
+     * call bus_dev_xfer_done() for it afterwards.
+     */
+    void (* xfer_abort)(struct bus_dev *bdev);
 };
 
 /**
@@ -124,6 +145,24 @@ struct bus_dev {
     STATS_SECT_DECL(bus_stats_section) stats;
 #endif
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    STAILQ_HEAD(, bus_xfer) xfer_q;
+    struct bus_xfer *xfer_cur;
+    struct os_event xfer_ev;
+    /* Starts next transaction outside of interrupt when node changes */
+    struct os_event xfer_next_ev;
+    struct os_callout xfer_tmo;
+    struct os_sem xfer_idle;
+    /* Transactions are being executed from queue */
+    uint8_t xfer_busy;
+    /* Bus is locked by task, queue is on hold */
+    uint8_t xfer_sync;
+    /* Task waits for queue to become idle */
+    uint8_t xfer_sync_wait;
+    /* Transactions executed ahead of older ones for other nodes */
+    uint8_t xfer_batch;
+#endif
+
     bool enabled;
 
 #if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
@@ -201,6 +240,19 @@ bus_node_init_func(struct os_dev *node, void *arg);
 void
 bus_node_set_callbacks(struct os_dev *node, struct bus_node_callbacks *cbs);
 
+/**
+ * Notify completion of transaction started by xfer_start
+ *
+ * Shall be called by driver, usually from interrupt context, once transaction
+ * started by xfer_start operation is completed. Next queued transaction, if
+ * any, is started before this returns.
+ *
+ * @param bdev  Bus device object
+ * @param rc    0 on success, SYS_xxx on error
+ */
+void
+bus_dev_xfer_done(struct bus_dev *bdev, int rc);
+
 #ifdef __cplusplus
 }
 #endif
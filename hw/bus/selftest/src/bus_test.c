@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "bus_test.h"
+
+struct bus_dev bus_test_dev;
+struct bus_node bus_test_node_a;
+struct bus_node bus_test_node_b;
+
+struct bus_test_op bus_test_log[BUS_TEST_LOG_MAX];
+int bus_test_log_cnt;
+int bus_test_configs;
+
+static void
+bus_test_log_op(struct bus_node *node, uint8_t type, uint16_t length)
+{
+    TEST_ASSERT_FATAL(bus_test_log_cnt < BUS_TEST_LOG_MAX);
+
+    bus_test_log[bus_test_log_cnt].node = node;
+    bus_test_log[bus_test_log_cnt].type = type;
+    bus_test_log[bus_test_log_cnt].length = length;
+    bus_test_log_cnt++;
+}
+
+static int
+bus_test_init_node(struct bus_dev *bdev, struct bus_node *bnode, void *arg)
+{
+    return 0;
+}
+
+static int
+bus_test_configure(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    bus_test_configs++;
+
+    return 0;
+}
+
+/* Reads return node address in each byte so caller can tell nodes apart */
+static int
+bus_test_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+              uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    memset(buf, bnode == &bus_test_node_a ? 0xa : 0xb, length);
+    bus_test_log_op(bnode, BUS_XFER_READ, length);
+
+    return 0;
+}
+
+static int
+bus_test_write(struct bus_dev *bdev, struct bus_node *bnode,
+               const uint8_t *buf, uint16_t length, os_time_t timeout,
+               uint16_t flags)
+{
+    bus_test_log_op(bnode, BUS_XFER_WRITE, length);
+
+    return 0;
+}
+
+/* No xfer_start, so queued transactions run from default event queue */
+static const struct bus_dev_ops bus_test_ops = {
+    .init_node = bus_test_init_node,
+    .configure = bus_test_configure,
+    .read = bus_test_read,
+    .write = bus_test_write,
+};
+
+void
+bus_test_init(void)
+{
+    struct bus_node_cfg cfg = {
+        .bus_name = "bustest",
+    };
+    int rc;
+
+    memset(&bus_test_dev, 0, sizeof(bus_test_dev));
+    memset(&bus_test_node_a, 0, sizeof(bus_test_node_a));
+    memset(&bus_test_node_b, 0, sizeof(bus_test_node_b));
+    memset(bus_test_log, 0, sizeof(bus_test_log));
+    bus_test_log_cnt = 0;
+    bus_test_configs = 0;
+
+    rc = os_dev_create(&bus_test_dev.odev, "bustest",
+                       OS_DEV_INIT_PRIMARY, 0, bus_dev_init_func,
+                       (void *)&bus_test_ops);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_dev_create(&bus_test_node_a.odev, "bustest_a",
+                       OS_DEV_INIT_PRIMARY, 1, bus_node_init_func, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_dev_create(&bus_test_node_b.odev, "bustest_b",
+                       OS_DEV_INIT_PRIMARY, 1, bus_node_init_func, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_SUITE(bus_test_suite_xfer)
+{
+    bus_test_case_queue();
+    bus_test_case_sync();
+}
+
+int
+main(int argc, char **argv)
+{
+    bus_test_suite_xfer();
+
+    return tu_any_failed;
+}
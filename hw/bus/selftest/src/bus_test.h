@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_BUS_TEST_H
+#define H_BUS_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "bus/bus.h"
+#include "bus/bus_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUS_TEST_LOG_MAX    16
+
+/* Operations executed by mock bus driver, in order */
+struct bus_test_op {
+    struct bus_node *node;
+    uint8_t type;
+    uint16_t length;
+};
+
+extern struct bus_dev bus_test_dev;
+extern struct bus_node bus_test_node_a;
+extern struct bus_node bus_test_node_b;
+
+extern struct bus_test_op bus_test_log[BUS_TEST_LOG_MAX];
+extern int bus_test_log_cnt;
+extern int bus_test_configs;
+
+void bus_test_init(void);
+
+TEST_SUITE_DECL(bus_test_suite_xfer);
+TEST_CASE_DECL(bus_test_case_queue);
+TEST_CASE_DECL(bus_test_case_sync);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+static int bus_test_queue_done;
+static int bus_test_queue_rc;
+
+static void
+bus_test_queue_cb(struct bus_xfer *xfer)
+{
+    bus_test_queue_done++;
+    if (xfer->rc) {
+        bus_test_queue_rc = xfer->rc;
+    }
+}
+
+TEST_CASE_TASK(bus_test_case_queue)
+{
+    static const uint8_t wbuf[4] = { 1, 2, 3, 4 };
+    uint8_t rbuf_a[2];
+    uint8_t rbuf_b[3];
+    struct bus_xfer xfers[3] = {
+        {
+            .type = BUS_XFER_WRITE,
+            .wbuf = wbuf,
+            .wlength = sizeof(wbuf),
+        }, {
+            .type = BUS_XFER_READ,
+            .rbuf = rbuf_b,
+            .rlength = sizeof(rbuf_b),
+        }, {
+            .type = BUS_XFER_READ,
+            .rbuf = rbuf_a,
+            .rlength = sizeof(rbuf_a),
+        },
+    };
+    int rc;
+    int i;
+
+    bus_test_init();
+
+    for (i = 0; i < 3; i++) {
+        xfers[i].timeout = OS_TIMEOUT_NEVER;
+        xfers[i].cb = bus_test_queue_cb;
+    }
+
+    /* Hold bus so all transactions are queued before any is executed */
+    rc = bus_node_lock(&bus_test_node_a.odev, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = bus_node_submit(&bus_test_node_a.odev, &xfers[0]);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_submit(&bus_test_node_b.odev, &xfers[1]);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_submit(&bus_test_node_a.odev, &xfers[2]);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_queue_done == 0);
+
+    rc = bus_node_unlock(&bus_test_node_a.odev);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_time_delay(1);
+
+    TEST_ASSERT_FATAL(bus_test_queue_done == 3);
+    TEST_ASSERT(bus_test_queue_rc == 0);
+    TEST_ASSERT(rbuf_a[0] == 0xa && rbuf_a[1] == 0xa);
+    TEST_ASSERT(rbuf_b[0] == 0xb && rbuf_b[2] == 0xb);
+
+    /* Read for node A overtakes older read for node B */
+    TEST_ASSERT_FATAL(bus_test_log_cnt == 3);
+    TEST_ASSERT(bus_test_log[0].node == &bus_test_node_a &&
+                bus_test_log[0].type == BUS_XFER_WRITE &&
+                bus_test_log[0].length == sizeof(wbuf));
+    TEST_ASSERT(bus_test_log[1].node == &bus_test_node_a &&
+                bus_test_log[1].type == BUS_XFER_READ);
+    TEST_ASSERT(bus_test_log[2].node == &bus_test_node_b &&
+                bus_test_log[2].type == BUS_XFER_READ);
+    TEST_ASSERT(bus_test_configs == 2);
+}
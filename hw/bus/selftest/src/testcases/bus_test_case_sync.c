@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "bus_test.h"
+
+static struct bus_xfer bus_test_sync_xfers[2];
+static uint8_t bus_test_sync_wbuf[2];
+static int bus_test_sync_done;
+static int bus_test_sync_rc;
+static uint8_t bus_test_sync_rbuf[4];
+
+static void
+bus_test_sync_cb(struct bus_xfer *xfer)
+{
+    bus_test_sync_done++;
+}
+
+/*
+ * Runs on default event queue task: queues transactions, which are executed
+ * from the same event queue, then reads synchronously.
+ */
+static void
+bus_test_sync_ev_func(struct os_event *ev)
+{
+    int rc;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        bus_test_sync_xfers[i].type = BUS_XFER_WRITE;
+        bus_test_sync_xfers[i].wbuf = bus_test_sync_wbuf;
+        bus_test_sync_xfers[i].wlength = sizeof(bus_test_sync_wbuf);
+        bus_test_sync_xfers[i].timeout = OS_TIMEOUT_NEVER;
+        bus_test_sync_xfers[i].cb = bus_test_sync_cb;
+    }
+
+    rc = bus_node_submit(&bus_test_node_a.odev, &bus_test_sync_xfers[0]);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = bus_node_submit(&bus_test_node_b.odev, &bus_test_sync_xfers[1]);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    bus_test_sync_rc = bus_node_simple_read(&bus_test_node_b.odev,
+                                            bus_test_sync_rbuf,
+                                            sizeof(bus_test_sync_rbuf));
+}
+
+static struct os_event bus_test_sync_ev = {
+    .ev_cb = bus_test_sync_ev_func,
+};
+
+TEST_CASE_TASK(bus_test_case_sync)
+{
+    bus_test_init();
+
+    bus_test_sync_rc = -1;
+    os_eventq_put(os_eventq_dflt_get(), &bus_test_sync_ev);
+
+    os_time_delay(1);
+
+    TEST_ASSERT_FATAL(bus_test_sync_rc == 0);
+    TEST_ASSERT(bus_test_sync_rbuf[0] == 0xb && bus_test_sync_rbuf[3] == 0xb);
+    TEST_ASSERT_FATAL(bus_test_sync_done == 2);
+
+    /* Sync read waits for transaction in progress, then overtakes queue */
+    TEST_ASSERT_FATAL(bus_test_log_cnt == 3);
+    TEST_ASSERT(bus_test_log[0].node == &bus_test_node_a &&
+                bus_test_log[0].type == BUS_XFER_WRITE);
+    TEST_ASSERT(bus_test_log[1].node == &bus_test_node_b &&
+                bus_test_log[1].type == BUS_XFER_READ &&
+                bus_test_log[1].length == sizeof(bus_test_sync_rbuf));
+    TEST_ASSERT(bus_test_log[2].node == &bus_test_node_b &&
+                bus_test_log[2].type == BUS_XFER_WRITE);
+}
@@ -29,6 +29,12 @@
 
 static os_time_t g_bus_node_lock_timeout;
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+#define BUS_XFER_BUSY(_bdev)    ((_bdev)->xfer_busy)
+#else
+#define BUS_XFER_BUSY(_bdev)    0
+#endif
+
 #if MYNEWT_VAL(BUS_STATS)
 STATS_NAME_START(bus_stats_section)
     STATS_NAME(bus_stats_section, lock_timeouts)
@@ -36,6 +42,7 @@ STATS_NAME_START(bus_stats_section)
     STATS_NAME(bus_stats_section, read_errors)
     STATS_NAME(bus_stats_section, write_ops)
     STATS_NAME(bus_stats_section, write_errors)
+    STATS_NAME(bus_stats_section, reconfigs)
 STATS_NAME_END(bus_stats_section)
 
 #if MYNEWT_VAL(BUS_STATS_PER_NODE)
@@ -84,6 +91,431 @@ bus_dev_disable(struct bus_dev *bdev)
     bdev->enabled = false;
 }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+static int bus_xfer_start(struct bus_dev *bdev);
+
+/* Called when queue runs dry or is handed over to task */
+static void
+bus_xfer_idle(struct bus_dev *bdev)
+{
+#if MYNEWT_VAL(BUS_PM)
+    if (bdev->pm_mode == BUS_PM_MODE_AUTO && !bdev->xfer_sync) {
+        os_callout_reset(&bdev->inactivity_tmo,
+                         bdev->pm_opts.pm_mode_auto.disable_tmo);
+    }
+#endif
+}
+
+/* Completes transaction at head of queue and starts next one */
+static void
+bus_xfer_complete(struct bus_dev *bdev, int rc)
+{
+    struct bus_xfer *xfer;
+    os_sr_t sr;
+
+    do {
+        OS_ENTER_CRITICAL(sr);
+        xfer = STAILQ_FIRST(&bdev->xfer_q);
+        assert(xfer);
+        STAILQ_REMOVE_HEAD(&bdev->xfer_q, next);
+        OS_EXIT_CRITICAL(sr);
+
+        if (rc && xfer->type != BUS_XFER_WRITE) {
+            BUS_STATS_INC(bdev, (struct bus_node *)xfer->node, read_errors);
+        }
+        if (rc && xfer->type != BUS_XFER_READ) {
+            BUS_STATS_INC(bdev, (struct bus_node *)xfer->node, write_errors);
+        }
+
+        xfer->rc = rc;
+        xfer->cb(xfer);
+
+        OS_ENTER_CRITICAL(sr);
+        if (bdev->xfer_sync_wait) {
+            /* Task is waiting to lock bus, let it go first */
+            bdev->xfer_sync_wait = 0;
+            bdev->xfer_sync = 1;
+            bdev->xfer_busy = 0;
+            OS_EXIT_CRITICAL(sr);
+            os_sem_release(&bdev->xfer_idle);
+            return;
+        }
+        if (STAILQ_EMPTY(&bdev->xfer_q)) {
+            bdev->xfer_busy = 0;
+            OS_EXIT_CRITICAL(sr);
+            bus_xfer_idle(bdev);
+            return;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        rc = bus_xfer_start(bdev);
+    } while (rc);
+}
+
+/* Executes transaction at head of queue using blocking operations */
+static void
+bus_xfer_ev_func(struct os_event *ev)
+{
+    struct bus_dev *bdev = ev->ev_arg;
+    struct bus_xfer *xfer;
+    struct bus_node *bnode;
+    int rc;
+
+    xfer = STAILQ_FIRST(&bdev->xfer_q);
+    bnode = (struct bus_node *)xfer->node;
+
+    switch (xfer->type) {
+    case BUS_XFER_READ:
+        rc = bdev->dops->read(bdev, bnode, xfer->rbuf, xfer->rlength,
+                              xfer->timeout, xfer->flags);
+        break;
+    case BUS_XFER_WRITE:
+        rc = bdev->dops->write(bdev, bnode, xfer->wbuf, xfer->wlength,
+                               xfer->timeout, xfer->flags);
+        break;
+    default:
+        if (bdev->dops->write_read) {
+            rc = bdev->dops->write_read(bdev, bnode, xfer->wbuf,
+                                        xfer->wlength, xfer->rbuf,
+                                        xfer->rlength, xfer->timeout,
+                                        xfer->flags);
+            break;
+        }
+        rc = bdev->dops->write(bdev, bnode, xfer->wbuf, xfer->wlength,
+                               xfer->timeout, BUS_F_NOSTOP);
+        if (rc == 0) {
+            rc = bdev->dops->read(bdev, bnode, xfer->rbuf, xfer->rlength,
+                                  xfer->timeout, xfer->flags);
+        }
+        break;
+    }
+
+    bus_xfer_complete(bdev, rc);
+}
+
+static void
+bus_xfer_tmo_func(struct os_event *ev)
+{
+    struct bus_dev *bdev = ev->ev_arg;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!bdev->xfer_cur) {
+        /* Completed in the meantime */
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_cur = NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    bdev->dops->xfer_abort(bdev);
+
+    bus_xfer_complete(bdev, SYS_ETIMEOUT);
+}
+
+/*
+ * Moves oldest transaction for node bus is configured for to head of queue,
+ * so transactions for each node are grouped and reconfiguration is avoided.
+ * Only up to BUS_XFER_QUEUE_GROUP_MAX transactions in a row can overtake
+ * older ones, then head of queue is served anyway.
+ */
+static void
+bus_xfer_pick(struct bus_dev *bdev)
+{
+#if MYNEWT_VAL(BUS_XFER_QUEUE_GROUP_MAX) > 0
+    struct bus_xfer *head;
+    struct bus_xfer *xfer;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    head = STAILQ_FIRST(&bdev->xfer_q);
+    if ((struct bus_node *)head->node == bdev->configured_for) {
+        bdev->xfer_batch = 0;
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+
+    if (bdev->configured_for &&
+        bdev->xfer_batch < MYNEWT_VAL(BUS_XFER_QUEUE_GROUP_MAX)) {
+        STAILQ_FOREACH(xfer, &bdev->xfer_q, next) {
+            if ((struct bus_node *)xfer->node == bdev->configured_for) {
+                STAILQ_REMOVE(&bdev->xfer_q, xfer, bus_xfer, next);
+                STAILQ_INSERT_HEAD(&bdev->xfer_q, xfer, next);
+                bdev->xfer_batch++;
+                OS_EXIT_CRITICAL(sr);
+                return;
+            }
+        }
+    }
+
+    bdev->xfer_batch = 0;
+
+    OS_EXIT_CRITICAL(sr);
+#endif
+}
+
+/*
+ * Starts transaction at head of queue. Returns 0 if started, otherwise
+ * transaction shall be completed with returned error.
+ */
+static int
+bus_xfer_start(struct bus_dev *bdev)
+{
+    struct bus_xfer *xfer;
+    struct bus_node *bnode;
+    int rc;
+
+    bus_xfer_pick(bdev);
+
+    xfer = STAILQ_FIRST(&bdev->xfer_q);
+    bnode = (struct bus_node *)xfer->node;
+
+    if (!bdev->enabled) {
+        return SYS_EIO;
+    }
+
+    if (bdev->configured_for != bnode) {
+        if (os_arch_in_isr()) {
+            /* Drivers may block in configure, so do it from task context */
+            os_eventq_put(os_eventq_dflt_get(), &bdev->xfer_next_ev);
+            return 0;
+        }
+        BUS_STATS_INC(bdev, bnode, reconfigs);
+        rc = bdev->dops->configure(bdev, bnode);
+        if (rc) {
+            bdev->configured_for = NULL;
+            return rc;
+        }
+        bdev->configured_for = bnode;
+    }
+
+    if (xfer->type != BUS_XFER_WRITE) {
+        BUS_STATS_INC(bdev, bnode, read_ops);
+    }
+    if (xfer->type != BUS_XFER_READ) {
+        BUS_STATS_INC(bdev, bnode, write_ops);
+    }
+
+    if (!bdev->dops->xfer_start) {
+        os_eventq_put(os_eventq_dflt_get(), &bdev->xfer_ev);
+        return 0;
+    }
+
+    bdev->xfer_cur = xfer;
+    if (xfer->timeout != OS_TIMEOUT_NEVER && bdev->dops->xfer_abort) {
+        os_callout_reset(&bdev->xfer_tmo, xfer->timeout);
+    }
+
+    rc = bdev->dops->xfer_start(bdev, bnode, xfer);
+    if (rc) {
+        bdev->xfer_cur = NULL;
+        os_callout_stop(&bdev->xfer_tmo);
+    }
+
+    return rc;
+}
+
+/* Starts transaction deferred by completion interrupt */
+static void
+bus_xfer_next_ev_func(struct os_event *ev)
+{
+    struct bus_dev *bdev = ev->ev_arg;
+    int rc;
+
+    rc = bus_xfer_start(bdev);
+    if (rc) {
+        bus_xfer_complete(bdev, rc);
+    }
+}
+
+/* Starts queue processing, bus shall be marked as busy already */
+static void
+bus_xfer_kick(struct bus_dev *bdev)
+{
+    int rc;
+
+#if MYNEWT_VAL(BUS_PM)
+    if (bdev->pm_mode == BUS_PM_MODE_AUTO) {
+        os_callout_stop(&bdev->inactivity_tmo);
+        bus_dev_enable(bdev);
+    }
+#endif
+
+    rc = bus_xfer_start(bdev);
+    if (rc) {
+        bus_xfer_complete(bdev, rc);
+    }
+}
+
+void
+bus_dev_xfer_done(struct bus_dev *bdev, int rc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!bdev->xfer_cur) {
+        /* Already timed out */
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_cur = NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    os_callout_stop(&bdev->xfer_tmo);
+
+    bus_xfer_complete(bdev, rc);
+}
+
+/*
+ * Runs one queue event pending on default event queue, if any.  Returns
+ * true if an event was run.
+ */
+static bool
+bus_xfer_run_pending(struct bus_dev *bdev)
+{
+    struct os_event *ev;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (OS_EVENT_QUEUED(&bdev->xfer_ev)) {
+        ev = &bdev->xfer_ev;
+    } else if (OS_EVENT_QUEUED(&bdev->xfer_next_ev)) {
+        ev = &bdev->xfer_next_ev;
+    } else if (OS_EVENT_QUEUED(&bdev->xfer_tmo.c_ev)) {
+        ev = &bdev->xfer_tmo.c_ev;
+    } else {
+        ev = NULL;
+    }
+    if (ev) {
+        os_eventq_remove(os_eventq_dflt_get(), ev);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!ev) {
+        return false;
+    }
+
+    ev->ev_cb(ev);
+
+    return true;
+}
+
+/* Takes bus over from queue; called by task which locked bus mutex */
+static void
+bus_xfer_sync_enter(struct bus_dev *bdev)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!bdev->xfer_busy) {
+        bdev->xfer_sync = 1;
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_sync_wait = 1;
+    OS_EXIT_CRITICAL(sr);
+
+    /*
+     * Queue sets xfer_sync for us before releasing semaphore.  Transactions
+     * of drivers without xfer_start, reconfiguration after completion
+     * interrupt and transaction timeouts are all run from default event
+     * queue.  If we are the task servicing that queue, nobody else will run
+     * them, so do it here while waiting.
+     */
+    if (os_eventq_dflt_get()->evq_owner != os_sched_get_current_task()) {
+        os_sem_pend(&bdev->xfer_idle, OS_TIMEOUT_NEVER);
+        return;
+    }
+
+    while (1) {
+        while (bus_xfer_run_pending(bdev)) {
+        }
+        if (os_sem_pend(&bdev->xfer_idle, 1) == 0) {
+            return;
+        }
+    }
+}
+
+/* Hands bus back to queue; called by task before unlocking bus mutex */
+static void
+bus_xfer_sync_exit(struct bus_dev *bdev)
+{
+    bool start = false;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    bdev->xfer_sync = 0;
+    if (!STAILQ_EMPTY(&bdev->xfer_q)) {
+        bdev->xfer_busy = 1;
+        start = true;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (start) {
+        bus_xfer_kick(bdev);
+    }
+}
+
+int
+bus_node_submit(struct os_dev *node, struct bus_xfer *xfer)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    bool start = false;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    switch (xfer->type) {
+    case BUS_XFER_READ:
+        if (!bdev->dops->read) {
+            return SYS_ENOTSUP;
+        }
+        break;
+    case BUS_XFER_WRITE:
+        if (!bdev->dops->write) {
+            return SYS_ENOTSUP;
+        }
+        break;
+    case BUS_XFER_WRITE_READ:
+        if (!bdev->dops->write || !bdev->dops->read) {
+            return SYS_ENOTSUP;
+        }
+        break;
+    default:
+        return SYS_EINVAL;
+    }
+
+    if (!xfer->cb) {
+        return SYS_EINVAL;
+    }
+
+    xfer->node = node;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&bdev->xfer_q, xfer, next);
+    if (!bdev->xfer_busy && !bdev->xfer_sync) {
+        bdev->xfer_busy = 1;
+        start = true;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (start) {
+        bus_xfer_kick(bdev);
+    }
+
+    return 0;
+}
+#else
+int
+bus_node_submit(struct os_dev *node, struct bus_xfer *xfer)
+{
+    return SYS_ENOTSUP;
+}
+#endif
+
 static int
 bus_dev_suspend_func(struct os_dev *odev, os_time_t suspend_at, int force)
 {
@@ -105,9 +537,15 @@ bus_dev_suspend_func(struct os_dev *odev, os_time_t suspend_at, int force)
     if (rc) {
         return rc;
     }
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_enter(bdev);
+#endif
 
     bus_dev_disable(bdev);
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_exit(bdev);
+#endif
     os_mutex_release(&bdev->lock);
 
     return OS_OK;
@@ -129,9 +567,15 @@ bus_dev_resume_func(struct os_dev *odev)
     if (rc) {
         return rc;
     }
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_enter(bdev);
+#endif
 
     bus_dev_enable(bdev);
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_exit(bdev);
+#endif
     os_mutex_release(&bdev->lock);
 
     return OS_OK;
@@ -148,12 +592,18 @@ bus_dev_inactivity_tmo_func(struct os_event *ev)
     if (rc) {
         return;
     }
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_enter(bdev);
+#endif
 
     /* Just in case PM was changed while timer was running */
     if (bdev->pm_mode == BUS_PM_MODE_AUTO) {
         bus_dev_disable(bdev);
     }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    bus_xfer_sync_exit(bdev);
+#endif
     os_mutex_release(&bdev->lock);
 }
 #endif
@@ -235,6 +685,17 @@ bus_dev_init_func(struct os_dev *odev, void *arg)
     bdev->configured_for = NULL;
 
     os_mutex_init(&bdev->lock);
+    os_mutex_stats_register(&bdev->lock, odev->od_name);
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    STAILQ_INIT(&bdev->xfer_q);
+    bdev->xfer_ev.ev_cb = bus_xfer_ev_func;
+    bdev->xfer_ev.ev_arg = bdev;
+    bdev->xfer_next_ev.ev_cb = bus_xfer_next_ev_func;
+    bdev->xfer_next_ev.ev_arg = bdev;
+    os_callout_init(&bdev->xfer_tmo, os_eventq_dflt_get(),
+                    bus_xfer_tmo_func, bdev);
+    os_sem_init(&bdev->xfer_idle, 0);
+#endif
 #if MYNEWT_VAL(BUS_PM)
     /* XXX allow custom eventq */
     os_callout_init(&bdev->inactivity_tmo, os_eventq_dflt_get(),
@@ -394,6 +855,56 @@ done:
     return rc;
 }
 
+int
+bus_node_write_mbuf(struct os_dev *node, const struct os_mbuf *om,
+                    uint16_t off, uint16_t length, os_time_t timeout,
+                    uint16_t flags)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    struct os_mbuf_iter it;
+    uint16_t seg_len;
+    void *data;
+    int rc;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (!bdev->dops->write) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = os_mbuf_iter_init(&it, om, off, length);
+    if (rc) {
+        return SYS_EINVAL;
+    }
+
+    rc = bus_node_lock(node, bus_node_get_lock_timeout(node));
+    if (rc) {
+        return rc;
+    }
+
+    if (!bdev->enabled) {
+        rc = SYS_EIO;
+        goto done;
+    }
+
+    BUS_STATS_INC(bdev, bnode, write_ops);
+    while ((seg_len = os_mbuf_iter_next(&it, &data)) != 0) {
+        rc = bdev->dops->write(bdev, bnode, data, seg_len, timeout,
+                               it.omi_rem ? flags | BUS_F_NOSTOP : flags);
+        if (rc) {
+            BUS_STATS_INC(bdev, bnode, write_errors);
+            break;
+        }
+    }
+
+done:
+    (void)bus_node_unlock(node);
+
+    return rc;
+}
+
 int
 bus_node_write_read_transact(struct os_dev *node, const void *wbuf,
                              uint16_t wlength, void *rbuf, uint16_t rlength,
@@ -496,6 +1007,97 @@ done:
     return rc;
 }
 
+int
+bus_node_xfer(struct os_dev *node, const struct bus_xfer_seg *segs, int cnt,
+              os_time_t timeout, uint16_t flags)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    bool reads = false;
+    bool writes = false;
+    uint16_t seg_flags;
+    int rc;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (cnt <= 0) {
+        return SYS_EINVAL;
+    }
+
+    for (i = 0; i < cnt; i++) {
+        if (!segs[i].wbuf && !segs[i].rbuf) {
+            return SYS_EINVAL;
+        }
+        /* With native support driver checks what it can do */
+        if (!bdev->dops->xfer) {
+            if (segs[i].wbuf && segs[i].rbuf) {
+                if (!bdev->dops->duplex_write_read) {
+                    return SYS_ENOTSUP;
+                }
+            } else if (segs[i].wbuf ? !bdev->dops->write :
+                                      !bdev->dops->read) {
+                return SYS_ENOTSUP;
+            }
+        }
+        reads |= segs[i].rbuf != NULL;
+        writes |= segs[i].wbuf != NULL;
+    }
+
+    rc = bus_node_lock(node, bus_node_get_lock_timeout(node));
+    if (rc) {
+        return rc;
+    }
+
+    if (!bdev->enabled) {
+        rc = SYS_EIO;
+        goto done;
+    }
+
+    if (reads) {
+        BUS_STATS_INC(bdev, bnode, read_ops);
+    }
+    if (writes) {
+        BUS_STATS_INC(bdev, bnode, write_ops);
+    }
+
+    if (bdev->dops->xfer) {
+        rc = bdev->dops->xfer(bdev, bnode, segs, cnt, timeout, flags);
+    } else {
+        for (i = 0; i < cnt; i++) {
+            seg_flags = (i == cnt - 1) ? flags : flags | BUS_F_NOSTOP;
+            if (segs[i].wbuf && segs[i].rbuf) {
+                rc = bdev->dops->duplex_write_read(bdev, bnode, segs[i].wbuf,
+                                                   segs[i].rbuf,
+                                                   segs[i].length, timeout,
+                                                   seg_flags);
+            } else if (segs[i].wbuf) {
+                rc = bdev->dops->write(bdev, bnode, segs[i].wbuf,
+                                       segs[i].length, timeout, seg_flags);
+            } else {
+                rc = bdev->dops->read(bdev, bnode, segs[i].rbuf,
+                                      segs[i].length, timeout, seg_flags);
+            }
+            if (rc) {
+                break;
+            }
+        }
+    }
+
+    if (rc && reads) {
+        BUS_STATS_INC(bdev, bnode, read_errors);
+    }
+    if (rc && writes) {
+        BUS_STATS_INC(bdev, bnode, write_errors);
+    }
+
+done:
+    (void)bus_node_unlock(node);
+
+    return rc;
+}
+
 int
 bus_node_lock(struct os_dev *node, os_time_t timeout)
 {
@@ -521,6 +1123,13 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
         assert(err == OS_OK || err == OS_NOT_STARTED);
     }
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Wait for queued transactions on first lock */
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_xfer_sync_enter(bdev);
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we need to enable bus device on first lock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
@@ -545,6 +1154,7 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
         return SYS_EACCES;
     }
 
+    BUS_STATS_INC(bdev, bnode, reconfigs);
     rc = bdev->dops->configure(bdev, bnode);
     if (rc) {
         bdev->configured_for = NULL;
@@ -566,10 +1176,18 @@ bus_node_unlock(struct os_dev *node)
     BUS_DEBUG_VERIFY_DEV(bdev);
     BUS_DEBUG_VERIFY_NODE(bnode);
 
+#if MYNEWT_VAL(BUS_XFER_QUEUE)
+    /* Let queue run on last unlock, it takes care of PM when done */
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_xfer_sync_exit(bdev);
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we should disable bus device on last unlock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
-        (os_mutex_get_level(&bdev->lock) == 1)) {
+        (os_mutex_get_level(&bdev->lock) == 1) &&
+        !BUS_XFER_BUSY(bdev)) {
         if (bdev->pm_opts.pm_mode_auto.disable_tmo == 0) {
             bus_dev_disable(bdev);
         } else {
@@ -606,6 +1224,16 @@ bus_node_get_lock_timeout(struct os_dev *node)
     return bnode->lock_timeout ? bnode->lock_timeout : g_bus_node_lock_timeout;
 }
 
+struct os_dev *
+bus_node_get_bus(struct os_dev *node)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    return (struct os_dev *)bnode->parent_bus;
+}
+
 int
 bus_dev_set_pm(struct os_dev *bus, bus_pm_mode_t pm_mode,
                union bus_pm_options *pm_opts)
@@ -54,10 +54,30 @@ struct nrf52_saadc_dev_global {
     struct nrf52_adc_chan channels[SAADC_CH_NUM];
     bool calibrate;
     bool calibrated;
+#if MYNEWT_VAL(ADC_STREAM)
+    bool streaming;
+#endif
 };
 
 static struct nrf52_saadc_dev_global g_drv_instance;
 
+#if MYNEWT_VAL(ADC_STREAM)
+static NRF_TIMER_Type *const nrf52_adc_stream_timers[] = {
+    NRF_TIMER0,
+    NRF_TIMER1,
+    NRF_TIMER2,
+#if defined(NRF_TIMER3)
+    NRF_TIMER3,
+    NRF_TIMER4,
+#endif
+};
+
+#define NRF52_ADC_STREAM_TIMER \
+    (nrf52_adc_stream_timers[MYNEWT_VAL(ADC_NRF52_STREAM_TIMER)])
+#define NRF52_ADC_STREAM_PPI_SAMPLE MYNEWT_VAL(ADC_NRF52_STREAM_PPI_CH0)
+#define NRF52_ADC_STREAM_PPI_START  MYNEWT_VAL(ADC_NRF52_STREAM_PPI_CH1)
+#endif
+
 /**
  * Initialize a channel with default/unconfigured values.
  */
@@ -97,6 +117,9 @@ init_instance_unconf(void)
     g_drv_instance.resolution = NRF_SAADC_RESOLUTION_14BIT;
     g_drv_instance.oversample = NRF_SAADC_OVERSAMPLE_DISABLED;
     g_drv_instance.calibrate = false;
+#if MYNEWT_VAL(ADC_STREAM)
+    g_drv_instance.streaming = false;
+#endif
 
     for (cnum = 0; cnum < SAADC_CH_NUM; cnum++) {
         channel_unconf(cnum);
@@ -253,6 +276,9 @@ nrf52_adc_close(struct os_dev *odev)
         unlock = 1;
     }
     if (--(dev->ad_ref_cnt) == 0) {
+#if MYNEWT_VAL(ADC_STREAM)
+        adc_stream_stop(dev);
+#endif
         NVIC_DisableIRQ(SAADC_IRQn);
         if (nrf_saadc_busy_check(NRF_SAADC)) {
             nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STOPPED);
@@ -581,6 +607,125 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(ADC_STREAM)
+/**
+ * Start continuous sampling. TIMER compare event triggers SAMPLE task
+ * through PPI, second PPI channel restarts conversion into next buffer
+ * on END so no samples are lost while interrupt is serviced.
+ */
+static int
+nrf52_adc_stream_start(struct adc_dev *dev, uint32_t freq)
+{
+    NRF_TIMER_Type *tmr = NRF52_ADC_STREAM_TIMER;
+    int cnum;
+    int used_chans = 0;
+    int size;
+
+    if (nrf_saadc_busy_check(NRF_SAADC)) {
+        return OS_EBUSY;
+    }
+    if (freq > 200000 || freq < 1) {
+        return OS_EINVAL;
+    }
+
+    for (cnum = 0; cnum < SAADC_CH_NUM; cnum++) {
+        if (dev->ad_chans[cnum].c_configured) {
+            used_chans++;
+            nrf_saadc_channel_input_set(NRF_SAADC, cnum,
+                                        g_drv_instance.channels[cnum].pin_p,
+                                        g_drv_instance.channels[cnum].pin_n);
+        }
+    }
+    if (used_chans == 0) {
+        return OS_EINVAL;
+    }
+
+    size = dev->ad_stream.as_buf_len / sizeof(nrf_saadc_value_t);
+    if (size % used_chans || size > SAADC_RESULT_MAXCNT_MAXCNT_Msk) {
+        return OS_EINVAL;
+    }
+
+    g_drv_instance.streaming = true;
+    nrf_saadc_oversample_set(NRF_SAADC, NRF_SAADC_OVERSAMPLE_DISABLED);
+    nrf_saadc_resolution_set(NRF_SAADC, g_drv_instance.resolution);
+    nrf_saadc_buffer_init(NRF_SAADC, adc_stream_dma_buf(dev, 0), size);
+
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_END);
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STARTED);
+    nrf_saadc_int_enable(NRF_SAADC,
+                         NRF_SAADC_INT_END | NRF_SAADC_INT_STARTED);
+
+    tmr->TASKS_STOP = 1;
+    tmr->TASKS_CLEAR = 1;
+    tmr->MODE = TIMER_MODE_MODE_Timer;
+    tmr->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    tmr->PRESCALER = 0;
+    tmr->CC[0] = 16000000 / freq;
+    tmr->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+    tmr->EVENTS_COMPARE[0] = 0;
+
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_SAMPLE].EEP =
+        (uint32_t)&tmr->EVENTS_COMPARE[0];
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_SAMPLE].TEP =
+        (uint32_t)&NRF_SAADC->TASKS_SAMPLE;
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_START].EEP =
+        (uint32_t)&NRF_SAADC->EVENTS_END;
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_START].TEP =
+        (uint32_t)&NRF_SAADC->TASKS_START;
+    NRF_PPI->CHENSET = (1UL << NRF52_ADC_STREAM_PPI_SAMPLE) |
+                       (1UL << NRF52_ADC_STREAM_PPI_START);
+
+    nrf_saadc_enable(NRF_SAADC);
+    nrf_saadc_task_trigger(NRF_SAADC, NRF_SAADC_TASK_START);
+    tmr->TASKS_START = 1;
+
+    return 0;
+}
+
+static int
+nrf52_adc_stream_stop(struct adc_dev *dev)
+{
+    NRF_TIMER_Type *tmr = NRF52_ADC_STREAM_TIMER;
+
+    tmr->TASKS_STOP = 1;
+    NRF_PPI->CHENCLR = (1UL << NRF52_ADC_STREAM_PPI_SAMPLE) |
+                       (1UL << NRF52_ADC_STREAM_PPI_START);
+
+    nrf_saadc_int_disable(NRF_SAADC, NRF_SAADC_INT_ALL);
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STOPPED);
+    nrf_saadc_task_trigger(NRF_SAADC, NRF_SAADC_TASK_STOP);
+    while (!nrf_saadc_event_check(NRF_SAADC, NRF_SAADC_EVENT_STOPPED));
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STOPPED);
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_END);
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STARTED);
+    nrf_saadc_disable(NRF_SAADC);
+    g_drv_instance.streaming = false;
+
+    return 0;
+}
+
+static void
+nrf52_saadc_stream_irq(struct adc_dev *dev)
+{
+    int size;
+
+    size = dev->ad_stream.as_buf_len / sizeof(nrf_saadc_value_t);
+
+    /*
+     * END must be handled before STARTED; RESULT.PTR written at STARTED
+     * is latched by START triggered by the next END.
+     */
+    if (nrf_saadc_event_check(NRF_SAADC, NRF_SAADC_EVENT_END)) {
+        nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_END);
+        adc_stream_buf_done(dev);
+    }
+    if (nrf_saadc_event_check(NRF_SAADC, NRF_SAADC_EVENT_STARTED)) {
+        nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STARTED);
+        nrf_saadc_buffer_init(NRF_SAADC, adc_stream_dma_buf(dev, 1), size);
+    }
+}
+#endif
+
 static int
 nrf52_adc_read_buffer(struct adc_dev *dev, void *buf, int buf_len, int off,
                       int *result)
@@ -610,6 +755,14 @@ nrf52_saadc_irq_handler(void)
     int bufsize = 0;
     int size;
 
+#if MYNEWT_VAL(ADC_STREAM)
+    if (g_drv_instance.streaming) {
+        ++nrf52_saadc_stats.saadc_events;
+        nrf52_saadc_stream_irq(global_adc_dev);
+        return;
+    }
+#endif
+
     if (global_adc_dev == NULL || !global_adc_dev->ad_event_handler_func) {
         ++nrf52_saadc_stats.saadc_events_failed;
         return;
@@ -677,6 +830,10 @@ static const struct adc_driver_funcs nrf52_adc_funcs = {
         .af_release_buffer = nrf52_adc_release_buffer,
         .af_read_buffer = nrf52_adc_read_buffer,
         .af_size_buffer = nrf52_adc_size_buffer,
+#if MYNEWT_VAL(ADC_STREAM)
+        .af_stream_start = nrf52_adc_stream_start,
+        .af_stream_stop = nrf52_adc_stream_stop,
+#endif
 };
 
 /**
@@ -59,6 +59,10 @@ struct stm32f4_adc_dev_cfg {
     void *secondarybuf;
     int buflen;
     ADC_HandleTypeDef *sac_adc_handle;
+#if MYNEWT_VAL(ADC_STREAM)
+    /* Timer triggering conversions in stream mode (TIM2, TIM3 or TIM8) */
+    TIM_TypeDef *sac_stream_tim;
+#endif
 };
 
 int stm32f4_adc_dev_init(struct os_dev *, void *);
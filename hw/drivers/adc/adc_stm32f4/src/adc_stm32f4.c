@@ -30,6 +30,9 @@
 #include "adc_stm32f4/adc_stm32f4.h"
 #include "stm32f4xx_hal_dma.h"
 #include "mcu/stm32f4xx_mynewt_hal.h"
+#if MYNEWT_VAL(ADC_STREAM)
+#include "stm32_common/stm32_hal.h"
+#endif
 
 #if MYNEWT_VAL(ADC_1)||MYNEWT_VAL(ADC_2)||MYNEWT_VAL(ADC_3)
 #include <adc/adc.h>
@@ -511,6 +514,9 @@ stm32f4_adc_close(struct os_dev *odev)
 
     dev = (struct adc_dev *) odev;
 
+#if MYNEWT_VAL(ADC_STREAM)
+    adc_stream_stop(dev);
+#endif
     stm32f4_adc_uninit(dev);
 
     if (os_started()) {
@@ -645,6 +651,150 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(ADC_STREAM)
+static void
+stm32f4_adc_stream_tim_clk_enable(TIM_TypeDef *tim)
+{
+    switch ((uintptr_t)tim) {
+#if defined(TIM2)
+        case (uintptr_t)TIM2:
+            __HAL_RCC_TIM2_CLK_ENABLE();
+            break;
+#endif
+#if defined(TIM3)
+        case (uintptr_t)TIM3:
+            __HAL_RCC_TIM3_CLK_ENABLE();
+            break;
+#endif
+#if defined(TIM8)
+        case (uintptr_t)TIM8:
+            __HAL_RCC_TIM8_CLK_ENABLE();
+            break;
+#endif
+        default:
+            assert(0);
+    }
+}
+
+static void
+stm32f4_adc_stream_dma_complete(DMA_HandleTypeDef *hdma,
+        HAL_DMA_MemoryTypeDef memory)
+{
+    struct adc_dev *adc;
+    void *next;
+
+    ++stm32f4_adc_stats.adc_dma_xfer_complete;
+
+    adc = adc_dma[stm32f4_resolve_dma_handle_idx(hdma)];
+    next = adc_stream_buf_done(adc);
+    HAL_DMAEx_ChangeMemory(hdma, (uint32_t)next, memory);
+}
+
+static void
+stm32f4_adc_stream_m0_complete(DMA_HandleTypeDef *hdma)
+{
+    stm32f4_adc_stream_dma_complete(hdma, MEMORY0);
+}
+
+static void
+stm32f4_adc_stream_m1_complete(DMA_HandleTypeDef *hdma)
+{
+    stm32f4_adc_stream_dma_complete(hdma, MEMORY1);
+}
+
+static void
+stm32f4_adc_stream_dma_error(DMA_HandleTypeDef *hdma)
+{
+    ++stm32f4_adc_stats.adc_dma_xfer_failed;
+}
+
+/**
+ * Start continuous sampling. Conversions are triggered by update event of
+ * sac_stream_tim; ADC external trigger in sac_adc_handle must be set to
+ * TRGO of that timer. DMA runs in double buffer mode, memory address of
+ * completed half is replaced with next free buffer.
+ *
+ * @param ADC device structure
+ * @param Sampling frequency in Hz
+ * @return OS_OK on success, non OS_OK on failure
+ */
+static int
+stm32f4_adc_stream_start(struct adc_dev *dev, uint32_t freq)
+{
+    ADC_HandleTypeDef *hadc;
+    DMA_HandleTypeDef *hdma;
+    struct stm32f4_adc_dev_cfg *cfg;
+    TIM_TypeDef *tim;
+    uint32_t clk;
+    uint32_t psc;
+
+    assert(dev);
+    cfg  = (struct stm32f4_adc_dev_cfg *)dev->ad_dev.od_init_arg;
+    hadc = cfg->sac_adc_handle;
+    hdma = hadc->DMA_Handle;
+    tim = cfg->sac_stream_tim;
+
+    if (!tim ||
+        hadc->Init.ExternalTrigConvEdge == ADC_EXTERNALTRIGCONVEDGE_NONE) {
+        return OS_EINVAL;
+    }
+    clk = stm32_hal_timer_get_freq(tim);
+    if (clk == 0 || freq > clk) {
+        return OS_EINVAL;
+    }
+
+    hdma->XferCpltCallback = stm32f4_adc_stream_m0_complete;
+    hdma->XferM1CpltCallback = stm32f4_adc_stream_m1_complete;
+    hdma->XferHalfCpltCallback = NULL;
+    hdma->XferM1HalfCpltCallback = NULL;
+    hdma->XferErrorCallback = stm32f4_adc_stream_dma_error;
+    hdma->Instance->CR &= ~DMA_SxCR_CT_Msk;
+
+    hadc->Instance->CR2 |= ADC_CR2_DMA | ADC_CR2_DDS;
+    if (HAL_DMAEx_MultiBufferStart_IT(hdma, (uint32_t)&hadc->Instance->DR,
+                                      (uint32_t)adc_stream_dma_buf(dev, 0),
+                                      (uint32_t)adc_stream_dma_buf(dev, 1),
+                                      dev->ad_stream.as_buf_len /
+                                      sizeof(uint32_t)) != HAL_OK) {
+        hadc->Instance->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS);
+        ++stm32f4_adc_stats.adc_dma_start_error;
+        return OS_EINVAL;
+    }
+    __HAL_ADC_ENABLE(hadc);
+
+    /* Update event every 1 / freq s, output as TRGO */
+    stm32f4_adc_stream_tim_clk_enable(tim);
+    clk /= freq;
+    psc = (clk - 1) >> 16;
+    tim->CR1 = 0;
+    tim->PSC = psc;
+    tim->ARR = clk / (psc + 1) - 1;
+    tim->EGR = TIM_EGR_UG;
+    tim->CR2 = (tim->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_1;
+    tim->CR1 = TIM_CR1_CEN;
+
+    return OS_OK;
+}
+
+static int
+stm32f4_adc_stream_stop(struct adc_dev *dev)
+{
+    ADC_HandleTypeDef *hadc;
+    struct stm32f4_adc_dev_cfg *cfg;
+
+    assert(dev);
+    cfg  = (struct stm32f4_adc_dev_cfg *)dev->ad_dev.od_init_arg;
+    hadc = cfg->sac_adc_handle;
+
+    cfg->sac_stream_tim->CR1 = 0;
+    HAL_DMA_Abort(hadc->DMA_Handle);
+    hadc->Instance->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS);
+    __HAL_ADC_DISABLE(hadc);
+
+    return OS_OK;
+}
+#endif
+
 /**
  * Blocking read of an ADC channel, returns result as an integer.
  *
@@ -710,6 +860,10 @@ static const struct adc_driver_funcs stm32f4_adc_funcs = {
         .af_release_buffer = stm32f4_adc_release_buffer,
         .af_read_buffer = stm32f4_adc_read_buffer,
         .af_size_buffer = stm32f4_adc_size_buffer,
+#if MYNEWT_VAL(ADC_STREAM)
+        .af_stream_start = stm32f4_adc_stream_start,
+        .af_stream_stop = stm32f4_adc_stream_stop,
+#endif
 };
 
 /**
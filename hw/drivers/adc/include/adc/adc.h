@@ -137,6 +137,30 @@ typedef int (*adc_buf_read_func_t)(struct adc_dev *, void *, int, int, int *);
  */
 typedef int (*adc_buf_size_func_t)(struct adc_dev *, int, int);
 
+#if MYNEWT_VAL(ADC_STREAM)
+/**
+ * Start continuous, timer triggered sampling of all configured channels
+ * into the stream buffers.  This is implemented by the HW specific drivers.
+ * The two buffers to start with are already taken from the ring, see
+ * adc_stream_dma_buf().
+ *
+ * @param The ADC device to start
+ * @param Sampling frequency in Hz (one scan of all channels per period)
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*adc_stream_start_func_t)(struct adc_dev *, uint32_t);
+
+/**
+ * Stop continuous sampling.  This is implemented by the HW specific drivers.
+ *
+ * @param The ADC device to stop
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*adc_stream_stop_func_t)(struct adc_dev *);
+#endif
+
 struct adc_driver_funcs {
     adc_configure_channel_func_t af_configure_channel;
     adc_sample_func_t af_sample;
@@ -145,8 +169,60 @@ struct adc_driver_funcs {
     adc_buf_release_func_t af_release_buffer;
     adc_buf_read_func_t af_read_buffer;
     adc_buf_size_func_t af_size_buffer;
+#if MYNEWT_VAL(ADC_STREAM)
+    /* Optional, NULL if driver does not support streaming */
+    adc_stream_start_func_t af_stream_start;
+    adc_stream_stop_func_t af_stream_stop;
+#endif
 };
 
+#if MYNEWT_VAL(ADC_STREAM)
+/**
+ * Configuration of continuous sampling.
+ */
+struct adc_stream_cfg {
+    /* Sampling frequency in Hz */
+    uint32_t asc_freq;
+    /* Buffers forming the ring, filled in order they become free */
+    void **asc_bufs;
+    /* Number of buffers, at least 3, at most ADC_STREAM_MAX_BUFS */
+    uint8_t asc_buf_cnt;
+    /* Length of each buffer in bytes, see adc_buf_size() */
+    uint16_t asc_buf_len;
+    /* Event queue where ready buffers are signalled */
+    struct os_eventq *asc_evq;
+    /* Called from asc_evq when there are buffers to be read */
+    os_event_fn *asc_ev_cb;
+    void *asc_ev_arg;
+};
+
+/**
+ * State of continuous sampling.  Two buffers are owned by the driver at
+ * any time; the one being filled and the one queued after it.  Filled
+ * buffers are queued for the consumer until it releases them.  If the
+ * consumer holds all other buffers when one gets filled, the data in that
+ * buffer is dropped and the buffer is reused; this is counted as overrun.
+ */
+struct adc_stream {
+    void **as_bufs;
+    uint16_t as_buf_len;
+    uint8_t as_buf_cnt;
+    uint8_t as_running;
+    /* Buffers owned by driver, index of active one first */
+    uint8_t as_dma[2];
+    /* Ready buffers not yet taken by consumer */
+    uint8_t as_rdy[MYNEWT_VAL(ADC_STREAM_MAX_BUFS)];
+    uint8_t as_rdy_head;
+    uint8_t as_rdy_cnt;
+    /* Bitmap of buffers free for driver */
+    uint32_t as_free;
+    /* Number of filled buffers dropped */
+    uint32_t as_overruns;
+    struct os_eventq *as_evq;
+    struct os_event as_ev;
+};
+#endif
+
 struct adc_chan_config {
     uint16_t c_refmv;
     uint8_t c_res;
@@ -164,6 +240,9 @@ struct adc_dev {
     uint8_t ad_ref_cnt;
     adc_event_handler_func_t ad_event_handler_func;
     void *ad_event_handler_arg;
+#if MYNEWT_VAL(ADC_STREAM)
+    struct adc_stream ad_stream;
+#endif
 };
 
 int adc_chan_config(struct adc_dev *, uint8_t, void *);
@@ -171,6 +250,82 @@ int adc_chan_read(struct adc_dev *, uint8_t, int *);
 int adc_event_handler_set(struct adc_dev *, adc_event_handler_func_t,
         void *);
 
+#if MYNEWT_VAL(ADC_STREAM)
+/**
+ * Start continuous sampling.  Buffers are filled by DMA and handed over to
+ * the consumer without copying; the consumer takes them with
+ * adc_stream_get() and gives them back with adc_stream_release().
+ *
+ * @param dev The ADC device to start
+ * @param cfg Stream configuration, buffer array must stay valid until
+ *            stream is stopped.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int adc_stream_start(struct adc_dev *dev, const struct adc_stream_cfg *cfg);
+
+/**
+ * Stop continuous sampling.  Buffers not returned by adc_stream_get() yet
+ * are discarded.
+ *
+ * @param dev The ADC device to stop
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int adc_stream_stop(struct adc_dev *dev);
+
+/**
+ * Take oldest filled buffer.
+ *
+ * @param dev The ADC device
+ *
+ * @return Buffer of asc_buf_len bytes, NULL if no buffer is ready.
+ */
+void *adc_stream_get(struct adc_dev *dev);
+
+/**
+ * Return buffer taken by adc_stream_get() so it can be filled again.
+ *
+ * @param dev The ADC device
+ * @param buf The buffer to release
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int adc_stream_release(struct adc_dev *dev, void *buf);
+
+/**
+ * Number of filled buffers dropped because consumer did not release
+ * buffers in time.
+ */
+static inline uint32_t
+adc_stream_overruns(struct adc_dev *dev)
+{
+    return dev->ad_stream.as_overruns;
+}
+
+/**
+ * For drivers: buffer owned by driver.
+ *
+ * @param dev The ADC device
+ * @param slot 0 for buffer being filled, 1 for buffer queued after it
+ */
+static inline void *
+adc_stream_dma_buf(struct adc_dev *dev, int slot)
+{
+    return dev->ad_stream.as_bufs[dev->ad_stream.as_dma[slot]];
+}
+
+/**
+ * For drivers: called from interrupt context when active buffer is full
+ * and hardware moved on to the queued one.
+ *
+ * @param dev The ADC device
+ *
+ * @return Buffer to queue after the one that is now active.
+ */
+void *adc_stream_buf_done(struct adc_dev *dev);
+#endif
+
 /**
  * Sample the device specified by dev.  This is used in non-blocking mode
  * to generate samples into the event buffer.
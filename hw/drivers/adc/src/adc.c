@@ -87,3 +87,147 @@ adc_event_handler_set(struct adc_dev *dev, adc_event_handler_func_t func,
     return (0);
 }
 
+
+#if MYNEWT_VAL(ADC_STREAM)
+/*
+ * Take free buffer for driver, returns buffer index or -1.
+ */
+static int
+adc_stream_take_free(struct adc_stream *as)
+{
+    int idx;
+
+    if (!as->as_free) {
+        return -1;
+    }
+    idx = __builtin_ctz(as->as_free);
+    as->as_free &= ~(1UL << idx);
+
+    return idx;
+}
+
+int
+adc_stream_start(struct adc_dev *dev, const struct adc_stream_cfg *cfg)
+{
+    struct adc_stream *as = &dev->ad_stream;
+    int rc;
+
+    if (!dev->ad_funcs->af_stream_start) {
+        return (ENOTSUP);
+    }
+    if (cfg->asc_buf_cnt < 3 ||
+        cfg->asc_buf_cnt > MYNEWT_VAL(ADC_STREAM_MAX_BUFS) ||
+        cfg->asc_buf_cnt > 32 || cfg->asc_buf_len == 0 ||
+        cfg->asc_freq == 0 || !cfg->asc_evq || !cfg->asc_ev_cb) {
+        return (EINVAL);
+    }
+    if (as->as_running) {
+        return (EBUSY);
+    }
+
+    as->as_bufs = cfg->asc_bufs;
+    as->as_buf_len = cfg->asc_buf_len;
+    as->as_buf_cnt = cfg->asc_buf_cnt;
+    as->as_free = (cfg->asc_buf_cnt == 32) ? UINT32_MAX :
+                  (1UL << cfg->asc_buf_cnt) - 1;
+    as->as_rdy_head = 0;
+    as->as_rdy_cnt = 0;
+    as->as_overruns = 0;
+    as->as_evq = cfg->asc_evq;
+    as->as_ev.ev_cb = cfg->asc_ev_cb;
+    as->as_ev.ev_arg = cfg->asc_ev_arg;
+    as->as_dma[0] = adc_stream_take_free(as);
+    as->as_dma[1] = adc_stream_take_free(as);
+
+    as->as_running = 1;
+    rc = dev->ad_funcs->af_stream_start(dev, cfg->asc_freq);
+    if (rc) {
+        as->as_running = 0;
+    }
+
+    return (rc);
+}
+
+int
+adc_stream_stop(struct adc_dev *dev)
+{
+    struct adc_stream *as = &dev->ad_stream;
+    int rc;
+
+    if (!as->as_running) {
+        return (0);
+    }
+    rc = dev->ad_funcs->af_stream_stop(dev);
+    as->as_running = 0;
+    os_eventq_remove(as->as_evq, &as->as_ev);
+
+    return (rc);
+}
+
+void *
+adc_stream_get(struct adc_dev *dev)
+{
+    struct adc_stream *as = &dev->ad_stream;
+    void *buf;
+    int sr;
+
+    buf = NULL;
+    OS_ENTER_CRITICAL(sr);
+    if (as->as_rdy_cnt) {
+        buf = as->as_bufs[as->as_rdy[as->as_rdy_head]];
+        as->as_rdy_head = (as->as_rdy_head + 1) % as->as_buf_cnt;
+        as->as_rdy_cnt--;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return (buf);
+}
+
+int
+adc_stream_release(struct adc_dev *dev, void *buf)
+{
+    struct adc_stream *as = &dev->ad_stream;
+    int idx;
+    int sr;
+
+    for (idx = 0; idx < as->as_buf_cnt; idx++) {
+        if (as->as_bufs[idx] == buf) {
+            break;
+        }
+    }
+    if (idx == as->as_buf_cnt) {
+        return (EINVAL);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    as->as_free |= 1UL << idx;
+    OS_EXIT_CRITICAL(sr);
+
+    return (0);
+}
+
+void *
+adc_stream_buf_done(struct adc_dev *dev)
+{
+    struct adc_stream *as = &dev->ad_stream;
+    int done;
+    int next;
+
+    done = as->as_dma[0];
+    next = adc_stream_take_free(as);
+    if (next < 0) {
+        /* Consumer is behind, drop data and fill this buffer again */
+        as->as_overruns++;
+        next = done;
+    } else {
+        as->as_rdy[(as->as_rdy_head + as->as_rdy_cnt) % as->as_buf_cnt] =
+            done;
+        as->as_rdy_cnt++;
+        os_eventq_put(as->as_evq, &as->as_ev);
+    }
+    as->as_dma[0] = as->as_dma[1];
+    as->as_dma[1] = next;
+
+    return (as->as_bufs[next]);
+}
+#endif
@@ -28,6 +28,14 @@ extern "C" {
 
 int da1469x_crypto_dev_init(struct os_dev *dev, void *arg);
 
+#if MYNEWT_VAL(CRYPTO_DA1469X_KEY_CACHE)
+/**
+ * Forgets the cached key, so the next operation loads and expands its key
+ * again.  Needed after the engine's key memory lost its contents.
+ */
+void da1469x_crypto_key_cache_flush(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
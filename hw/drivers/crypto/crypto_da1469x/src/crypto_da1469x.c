@@ -28,6 +28,29 @@
 
 static struct os_mutex gmtx;
 
+#if MYNEWT_VAL(CRYPTO_DA1469X_KEY_CACHE)
+/* Key whose expanded schedule is in the engine's key memory; 0 keylen if
+ * none is known to be.  Protected by gmtx.
+ */
+static uint8_t cached_key[AES_MAX_KEY_LEN];
+static uint16_t cached_keylen;
+
+void
+da1469x_crypto_key_cache_flush(void)
+{
+    os_mutex_pend(&gmtx, OS_TIMEOUT_NEVER);
+    cached_keylen = 0;
+    os_mutex_release(&gmtx);
+}
+
+static bool
+da1469x_key_cached(const uint8_t *key, uint16_t keylen)
+{
+    return cached_keylen == keylen &&
+           memcmp(cached_key, key, keylen / 8) == 0;
+}
+#endif
+
 #define VALID_AES_KEYLEN(x) (((x) == 128) || ((x) == 192) || ((x) == 256))
 
 /* Definitions for REMAP_ADR0 (bits 2:0) of SYS_CTRL_REG. See Datasheet for details */
@@ -110,6 +133,7 @@ da1469x_crypto_op(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
     uint32_t *keyp32;
     uint32_t ctrl_reg;
     Sys_Remap_ADR0 remap_adr0;
+    bool load_key = true;
 
     if (!da1469x_has_support(crypto, op, algo, mode, keylen)) {
         return 0;
@@ -162,7 +186,15 @@ da1469x_crypto_op(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
     }
 
     /* activate key expansion */
-    ctrl_reg |= AES_HASH_CRYPTO_CTRL_REG_CRYPTO_AES_KEXP_Msk;
+#if MYNEWT_VAL(CRYPTO_DA1469X_KEY_CACHE)
+    load_key = OTP_ADDRESS_RANGE_USER_DATA_KEYS(key) ||
+               !da1469x_key_cached(key, keylen);
+#endif
+    if (load_key) {
+        ctrl_reg |= AES_HASH_CRYPTO_CTRL_REG_CRYPTO_AES_KEXP_Msk;
+    } else {
+        ctrl_reg &= ~AES_HASH_CRYPTO_CTRL_REG_CRYPTO_AES_KEXP_Msk;
+    }
 
     if (op == CRYPTO_OP_ENCRYPT) {
         ctrl_reg |= AES_HASH_CRYPTO_CTRL_REG_CRYPTO_ENCDEC_Msk;
@@ -190,9 +222,18 @@ da1469x_crypto_op(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
         AES_HASH->CRYPTO_MREG3_REG = os_bswap_32(((uint32_t *)iv)[0]);
     }
 
-    if (OTP_ADDRESS_RANGE_USER_DATA_KEYS(key)) {
+    if (!load_key) {
+        /* Expanded schedule of this key is still in the key memory. */
+    } else if (OTP_ADDRESS_RANGE_USER_DATA_KEYS(key)) {
         do_dma_key_tx(key, keylen);
+#if MYNEWT_VAL(CRYPTO_DA1469X_KEY_CACHE)
+        cached_keylen = 0;
+#endif
     } else {
+#if MYNEWT_VAL(CRYPTO_DA1469X_KEY_CACHE)
+        memcpy(cached_key, key, keylen / 8);
+        cached_keylen = keylen;
+#endif
         keyreg = (uint32_t *)&AES_HASH->CRYPTO_KEYS_START;
         keyp32 = (uint32_t *)key;
         switch (keylen) {
@@ -47,6 +47,26 @@ int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode,
 int mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode,
                           size_t length, unsigned char iv[16], const unsigned char *input,
                           unsigned char *output);
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CFB)
+int mbedtls_aes_crypt_cfb128(mbedtls_aes_context *ctx, int mode,
+                             size_t length, size_t *iv_off,
+                             unsigned char iv[16], const unsigned char *input,
+                             unsigned char *output);
+int mbedtls_aes_crypt_cfb8(mbedtls_aes_context *ctx, int mode,
+                           size_t length, unsigned char iv[16],
+                           const unsigned char *input, unsigned char *output);
+#endif
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_OFB)
+int mbedtls_aes_crypt_ofb(mbedtls_aes_context *ctx, size_t length,
+                          size_t *iv_off, unsigned char iv[16],
+                          const unsigned char *input, unsigned char *output);
+#endif
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CTR)
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length,
+                          size_t *nc_off, unsigned char nonce_counter[16],
+                          unsigned char stream_block[16],
+                          const unsigned char *input, unsigned char *output);
+#endif
 
 #ifdef __cplusplus
 }
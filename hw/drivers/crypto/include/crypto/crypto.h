@@ -142,6 +142,32 @@ uint32_t crypto_encryptv_custom(struct crypto_dev *crypto, uint16_t algo,
         uint16_t mode, const void *key, uint16_t keylen, void *iv,
         struct crypto_iovec *iov, uint32_t iovlen);
 
+/**
+ * Encrypt a byte range of an mbuf chain in-place using custom parameters
+ *
+ * Each data segment of the range is handed to the driver directly, as with
+ * crypto_encryptv_custom(), so the chain does not need to be pulled up.
+ * The data must not be shared with other chains (see OS_MBUF_IS_SHARED()).
+ *
+ * @note iv receives the initial vector and returns the final vector
+ *       after running on the block, so subsequent calls can use this value
+ *
+ * @param crypto   OS device
+ * @param algo     Algorithm to use (see CRYPTO_ALGO_*)
+ * @param mode     Mode to use (see CRYPTO_MODE_*)
+ * @param key      The key
+ * @param keylen   Length of the key in bits
+ * @param iv       NULL or initial value or nonce
+ * @param om       The mbuf chain
+ * @param off      Offset of the range within the chain
+ * @param len      Length of the range
+ *
+ * @return Number of bytes encrypted
+ */
+uint32_t crypto_encrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, uint16_t off, uint16_t len);
+
 /**
  * Decrypt a buffer using custom parameters
  *
@@ -185,6 +211,32 @@ uint32_t crypto_decryptv_custom(struct crypto_dev *crypto, uint16_t algo,
         uint16_t mode, const void *key, uint16_t keylen, void *iv,
         struct crypto_iovec *iov, uint32_t iovlen);
 
+/**
+ * Decrypt a byte range of an mbuf chain in-place using custom parameters
+ *
+ * Each data segment of the range is handed to the driver directly, as with
+ * crypto_decryptv_custom(), so the chain does not need to be pulled up.
+ * The data must not be shared with other chains (see OS_MBUF_IS_SHARED()).
+ *
+ * @note iv receives the initial vector and returns the final vector
+ *       after running on the block, so subsequent calls can use this value
+ *
+ * @param crypto   OS device
+ * @param algo     Algorithm to use (see CRYPTO_ALGO_*)
+ * @param mode     Mode to use (see CRYPTO_MODE_*)
+ * @param key      The key
+ * @param keylen   Length of the key in bits
+ * @param iv       NULL or initial value or nonce
+ * @param om       The mbuf chain
+ * @param off      Offset of the range within the chain
+ * @param len      Length of the range
+ *
+ * @return Number of bytes decrypted
+ */
+uint32_t crypto_decrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, uint16_t off, uint16_t len);
+
 /*
  * Query Crypto HW capabilities
  *
@@ -209,6 +261,56 @@ bool crypto_has_support(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
  */
 bool crypto_in_use(struct crypto_dev *crypto);
 
+#if MYNEWT_VAL(CRYPTO_JOB_QUEUE)
+/**
+ * @struct crypto_job
+ * @brief An operation queued with crypto_job_submit()
+ *
+ * The caller fills in everything up to and including the completion event;
+ * the job must stay valid, and its buffers untouched, until the event is
+ * posted.  cj_ev.ev_arg is set to the job itself before posting.
+ */
+struct crypto_job {
+    /** CRYPTO_OP_ENCRYPT or CRYPTO_OP_DECRYPT */
+    uint8_t cj_op;
+    /** Algorithm to use (see CRYPTO_ALGO_*) */
+    uint16_t cj_algo;
+    /** Mode to use (see CRYPTO_MODE_*) */
+    uint16_t cj_mode;
+    /** Length of the key in bits */
+    uint16_t cj_keylen;
+    const uint8_t *cj_key;
+    /** NULL or initial value or nonce; updated like for the sync API */
+    uint8_t *cj_iv;
+    const uint8_t *cj_inbuf;
+    uint8_t *cj_outbuf;
+    uint32_t cj_len;
+    /** Set to the number of bytes processed once the job completed */
+    uint32_t cj_result;
+    /** Posted on completion */
+    struct os_event cj_ev;
+    /** Queue cj_ev is posted to; NULL for the default event queue */
+    struct os_eventq *cj_evq;
+
+    /* Private */
+    struct crypto_dev *cj_crypto;
+    STAILQ_ENTRY(crypto_job) cj_next;
+};
+
+/**
+ * Queues a job for the crypto worker task.  Jobs are run in submission
+ * order; whatever is queued when the worker wakes up is run back to back
+ * without giving the device up in between.  May be called from interrupt
+ * context.
+ *
+ * @param crypto   OS device
+ * @param job      The job to run
+ *
+ * @return 0 on success, SYS_EINVAL if the job is malformed
+ */
+int crypto_job_submit(struct crypto_dev *crypto, struct crypto_job *job);
+#endif
+
 /*
  * AES helpers
  */
@@ -284,6 +284,38 @@ crypto_encryptv_custom(struct crypto_dev *crypto, uint16_t algo, uint16_t mode,
     return total;
 }
 
+uint32_t
+crypto_encrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, uint16_t off, uint16_t len)
+{
+    struct os_mbuf_iter it;
+    uint32_t total;
+    uint32_t rc;
+    uint16_t seg_len;
+    void *data;
+
+    if (crypto->interface.encrypt == NULL) {
+        return 0;
+    }
+
+    if (os_mbuf_iter_init(&it, om, off, len) != 0) {
+        return 0;
+    }
+
+    total = 0;
+    while ((seg_len = os_mbuf_iter_next(&it, &data)) != 0) {
+        rc = crypto_encrypt_custom(crypto, algo, mode, key, keylen, iv,
+                data, data, seg_len);
+        total += rc;
+        if (rc != seg_len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
 uint32_t
 crypto_decrypt_custom(struct crypto_dev *crypto, uint16_t algo, uint16_t mode,
         const void *key, uint16_t keylen, void *iv, const void *inbuf,
@@ -346,6 +378,38 @@ crypto_decryptv_custom(struct crypto_dev *crypto, uint16_t algo, uint16_t mode,
     return total;
 }
 
+uint32_t
+crypto_decrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, uint16_t off, uint16_t len)
+{
+    struct os_mbuf_iter it;
+    uint32_t total;
+    uint32_t rc;
+    uint16_t seg_len;
+    void *data;
+
+    if (crypto->interface.decrypt == NULL) {
+        return 0;
+    }
+
+    if (os_mbuf_iter_init(&it, om, off, len) != 0) {
+        return 0;
+    }
+
+    total = 0;
+    while ((seg_len = os_mbuf_iter_next(&it, &data)) != 0) {
+        rc = crypto_decrypt_custom(crypto, algo, mode, key, keylen, iv,
+                data, data, seg_len);
+        total += rc;
+        if (rc != seg_len) {
+            break;
+        }
+    }
+
+    return total;
+}
+
 /*
  * AES-ECB helpers
  */
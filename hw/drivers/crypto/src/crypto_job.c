@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CRYPTO_JOB_QUEUE)
+
+#include "crypto/crypto.h"
+
+static STAILQ_HEAD(, crypto_job) crypto_job_list =
+    STAILQ_HEAD_INITIALIZER(crypto_job_list);
+
+/* Counts queued jobs. */
+static struct os_sem crypto_job_sem;
+
+static struct os_task crypto_job_task_s;
+static os_stack_t crypto_job_stack[
+    OS_STACK_ALIGN(MYNEWT_VAL(CRYPTO_JOB_STACK_SIZE))]
+    __attribute__((aligned(OS_STACK_ALIGNMENT)));
+
+int
+crypto_job_submit(struct crypto_dev *crypto, struct crypto_job *job)
+{
+    os_sr_t sr;
+
+    if (!CRYPTO_VALID_OP(job->cj_op) || job->cj_ev.ev_cb == NULL) {
+        return SYS_EINVAL;
+    }
+
+    job->cj_crypto = crypto;
+    job->cj_result = 0;
+    job->cj_ev.ev_arg = job;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&crypto_job_list, job, cj_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_sem_release(&crypto_job_sem);
+
+    return 0;
+}
+
+static struct crypto_job *
+crypto_job_take(void)
+{
+    struct crypto_job *job;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    job = STAILQ_FIRST(&crypto_job_list);
+    if (job != NULL) {
+        STAILQ_REMOVE_HEAD(&crypto_job_list, cj_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return job;
+}
+
+static void
+crypto_job_run(struct crypto_job *job)
+{
+    if (job->cj_op == CRYPTO_OP_ENCRYPT) {
+        job->cj_result = crypto_encrypt_custom(job->cj_crypto, job->cj_algo,
+                job->cj_mode, job->cj_key, job->cj_keylen, job->cj_iv,
+                job->cj_inbuf, job->cj_outbuf, job->cj_len);
+    } else {
+        job->cj_result = crypto_decrypt_custom(job->cj_crypto, job->cj_algo,
+                job->cj_mode, job->cj_key, job->cj_keylen, job->cj_iv,
+                job->cj_inbuf, job->cj_outbuf, job->cj_len);
+    }
+
+    os_eventq_put(job->cj_evq ? job->cj_evq : os_eventq_dflt_get(),
+                  &job->cj_ev);
+}
+
+static void
+crypto_job_task(void *arg)
+{
+    struct crypto_job *job;
+    struct crypto_dev *crypto;
+    (void)arg;
+
+    while (1) {
+        os_sem_pend(&crypto_job_sem, OS_TIMEOUT_NEVER);
+
+        /* Drain everything queued, keeping the device marked busy while
+         * consecutive jobs target it.
+         */
+        crypto = NULL;
+        while ((job = crypto_job_take()) != NULL) {
+            if (job->cj_crypto != crypto) {
+                if (crypto != NULL) {
+                    crypto->in_use = false;
+                }
+                crypto = job->cj_crypto;
+                crypto->in_use = true;
+            }
+            crypto_job_run(job);
+            if (STAILQ_FIRST(&crypto_job_list) != NULL) {
+                /* Consume the count for the job taken next. */
+                os_sem_pend(&crypto_job_sem, 0);
+            }
+        }
+        if (crypto != NULL) {
+            crypto->in_use = false;
+        }
+    }
+}
+
+void
+crypto_job_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = os_sem_init(&crypto_job_sem, 0);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    rc = os_task_init(&crypto_job_task_s, "crypto_job", crypto_job_task,
+                      NULL, MYNEWT_VAL(CRYPTO_JOB_TASK_PRIO), OS_WAIT_FOREVER,
+                      crypto_job_stack, MYNEWT_VAL(CRYPTO_JOB_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif
@@ -118,6 +118,10 @@ mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length, unsigne
 {
     int ret;
 
+    if (length % AES_BLOCK_LEN) {
+        return MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH;
+    }
+
     switch (mode) {
     case MBEDTLS_AES_ENCRYPT:
         ret = crypto_encrypt_aes_cbc(ctx->crypto, ctx->key, ctx->keylen, (uint8_t *)iv,
@@ -134,4 +138,168 @@ mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length, unsigne
     return (ret == length) ? 0 : -1;
 }
 
+/*
+ * The remaining modes run on the HW block cipher.  CTR hands whole blocks
+ * to the driver in one go; the rest are feedback modes which need one ECB
+ * operation per block anyway.
+ */
+
+static int
+mbedtls_aes_alt_block(mbedtls_aes_context *ctx, const unsigned char in[16],
+                      unsigned char out[16])
+{
+    uint32_t ret;
+
+    ret = crypto_encrypt_aes_ecb(ctx->crypto, ctx->key, ctx->keylen, in, out,
+                                 AES_BLOCK_LEN);
+    return (ret == AES_BLOCK_LEN) ? 0 : -1;
+}
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CFB)
+int
+mbedtls_aes_crypt_cfb128(mbedtls_aes_context *ctx, int mode, size_t length,
+                         size_t *iv_off, unsigned char iv[16],
+                         const unsigned char *input, unsigned char *output)
+{
+    size_t n = *iv_off;
+    unsigned char c;
+
+    if (n > 15) {
+        return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+    }
+
+    while (length--) {
+        if (n == 0 && mbedtls_aes_alt_block(ctx, iv, iv)) {
+            return -1;
+        }
+        c = *input++;
+        *output = c ^ iv[n];
+        iv[n] = (mode == MBEDTLS_AES_DECRYPT) ? c : *output;
+        output++;
+        n = (n + 1) & 0x0f;
+    }
+
+    *iv_off = n;
+    return 0;
+}
+
+int
+mbedtls_aes_crypt_cfb8(mbedtls_aes_context *ctx, int mode, size_t length,
+                       unsigned char iv[16], const unsigned char *input,
+                       unsigned char *output)
+{
+    unsigned char ov[AES_BLOCK_LEN + 1];
+    unsigned char c;
+
+    while (length--) {
+        memcpy(ov, iv, AES_BLOCK_LEN);
+        if (mbedtls_aes_alt_block(ctx, iv, iv)) {
+            return -1;
+        }
+        if (mode == MBEDTLS_AES_DECRYPT) {
+            ov[AES_BLOCK_LEN] = *input;
+        }
+        c = *output++ = iv[0] ^ *input++;
+        if (mode == MBEDTLS_AES_ENCRYPT) {
+            ov[AES_BLOCK_LEN] = c;
+        }
+        memcpy(iv, ov + 1, AES_BLOCK_LEN);
+    }
+
+    return 0;
+}
+#endif /* MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CFB) */
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_OFB)
+int
+mbedtls_aes_crypt_ofb(mbedtls_aes_context *ctx, size_t length, size_t *iv_off,
+                      unsigned char iv[16], const unsigned char *input,
+                      unsigned char *output)
+{
+    size_t n = *iv_off;
+
+    if (n > 15) {
+        return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+    }
+
+    while (length--) {
+        if (n == 0 && mbedtls_aes_alt_block(ctx, iv, iv)) {
+            return -1;
+        }
+        *output++ = *input++ ^ iv[n];
+        n = (n + 1) & 0x0f;
+    }
+
+    *iv_off = n;
+    return 0;
+}
+#endif /* MYNEWT_VAL(MBEDTLS_CIPHER_MODE_OFB) */
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CTR)
+static void
+mbedtls_aes_alt_ctr_inc(unsigned char nonce_counter[16])
+{
+    int i;
+
+    for (i = AES_BLOCK_LEN; i > 0; i--) {
+        if (++nonce_counter[i - 1] != 0) {
+            break;
+        }
+    }
+}
+
+int
+mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off,
+                      unsigned char nonce_counter[16],
+                      unsigned char stream_block[16],
+                      const unsigned char *input, unsigned char *output)
+{
+    size_t n = *nc_off;
+    size_t bulk;
+
+    if (n > 15) {
+        return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+    }
+
+    /* Use up what is left of the current key stream block. */
+    while (n != 0 && length != 0) {
+        *output++ = *input++ ^ stream_block[n];
+        n = (n + 1) & 0x0f;
+        length--;
+    }
+
+#if MYNEWT_VAL(CRYPTO_NEED_CTR) || MYNEWT_VAL(CRYPTO_HW_AES_CTR)
+    /* Whole blocks in one driver call; it advances the counter. */
+    bulk = length & ~(size_t)(AES_BLOCK_LEN - 1);
+    if (bulk != 0) {
+        if (crypto_encrypt_aes_ctr(ctx->crypto, ctx->key, ctx->keylen,
+                                   nonce_counter, input, output,
+                                   bulk) != bulk) {
+            return -1;
+        }
+        input += bulk;
+        output += bulk;
+        length -= bulk;
+    }
+#else
+    (void)bulk;
+#endif
+
+    while (length != 0) {
+        if (n == 0) {
+            if (mbedtls_aes_alt_block(ctx, nonce_counter, stream_block)) {
+                return -1;
+            }
+            mbedtls_aes_alt_ctr_inc(nonce_counter);
+        }
+        *output++ = *input++ ^ stream_block[n];
+        n = (n + 1) & 0x0f;
+        length--;
+    }
+
+    *nc_off = n;
+    return 0;
+}
+#endif /* MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CTR) */
+
 #endif /* MYNEWT_VAL(MBEDTLS_AES_ALT) */
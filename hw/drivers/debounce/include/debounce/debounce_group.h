@@ -0,0 +1,154 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _DEBOUNCE_DEBOUNCE_GROUP_H_
+#define _DEBOUNCE_DEBOUNCE_GROUP_H_
+
+/*
+ * debounce_group
+ *
+ * Debounces up to 32 pins with a single periodic timer.
+ *
+ * Every scan samples all pins of the group into a bit mask and runs a
+ * vertical counter over it: each pin has a 2-bit counter held in two
+ * 32-bit words, so all pins are debounced with a handful of bitwise
+ * operations.  A pin changes state once it has read the opposite value
+ * on 4 consecutive scans.
+ *
+ * Changes found by a scan are accumulated and reported through a single
+ * event on an event queue, however many pins changed.  Neither the
+ * number of wakeups nor the work per scan depends on edges on individual
+ * pins, which suits keypads and input banks better than per-pin
+ * debouncing with \c debounce_pin_t.
+ *
+ * // ---------------------- Example begin --------------------------
+ *
+ * static const int key_pins[] = { KEY0_PIN, KEY1_PIN, KEY2_PIN };
+ * static struct debounce_group keys;
+ *
+ * void keys_changed(struct debounce_group *g, uint32_t changed) {
+ *     uint32_t pressed = changed & ~debounce_group_state(g);
+ *     ...
+ * }
+ *
+ * int main(int argc, char *argv[]) {
+ *     ...
+ *     debounce_group_init(&keys, key_pins, 3, HAL_GPIO_PULL_UP, 0,
+ *                         MYNEWT_VAL(DEBOUNCE_GROUP_TICKS));
+ *     debounce_group_start(&keys, NULL, keys_changed, NULL);
+ *     ...
+ * }
+ *
+ * // ---------------------- Example end ----------------------------
+ */
+
+#include "os/mynewt.h"
+#include "hal/hal_gpio.h"
+#include "hal/hal_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEBOUNCE_GROUP_MAX_PINS     32
+
+struct debounce_group;
+
+/*
+ * Called from the group's event queue with the bits of the pins which
+ * changed state since the previous call.
+ */
+typedef void (*debounce_group_cb_t)(struct debounce_group *, uint32_t changed);
+
+struct debounce_group {
+    const int *pins;
+    uint8_t num_pins;
+    uint32_t ticks;
+    /* Debounced state, bit n for pins[n] */
+    uint32_t state;
+    /* Vertical counter bits */
+    uint32_t cnt0;
+    uint32_t cnt1;
+    /* Changes not yet reported */
+    uint32_t pending;
+    debounce_group_cb_t on_change;
+    void *arg;
+    struct os_eventq *evq;
+    struct os_event ev;
+    struct hal_timer timer;
+};
+
+/**
+ * Initialize a group of pins as inputs and read their initial state.
+ *
+ * @param g        The group; must stay valid while debouncing.
+ * @param pins     The pins of the group; must stay valid as well.
+ * @param num_pins Number of pins, up to DEBOUNCE_GROUP_MAX_PINS.
+ * @param pull     Pull configuration applied to all pins.
+ * @param timer    The hal_timer number used for scanning.
+ * @param ticks    Scan period, in ticks of that timer.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int debounce_group_init(struct debounce_group *g, const int *pins,
+                        int num_pins, hal_gpio_pull_t pull, int timer,
+                        uint32_t ticks);
+
+/**
+ * Start scanning.
+ *
+ * @param g   The group.
+ * @param evq Queue the change callback runs on; NULL for the default
+ *            event queue.
+ * @param cb  Change callback.
+ * @param arg Argument returned by debounce_group_arg().
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int debounce_group_start(struct debounce_group *g, struct os_eventq *evq,
+                         debounce_group_cb_t cb, void *arg);
+
+/**
+ * Stop scanning.  Changes not yet reported are dropped.
+ *
+ * @param g The group.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int debounce_group_stop(struct debounce_group *g);
+
+/**
+ * Debounced state of all pins, bit n for pins[n].
+ */
+static inline uint32_t
+debounce_group_state(const struct debounce_group *g)
+{
+    return g->state;
+}
+
+static inline void *
+debounce_group_arg(const struct debounce_group *g)
+{
+    return g->arg;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DEBOUNCE_DEBOUNCE_GROUP_H_ */
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "debounce_test.h"
+
+void
+debounce_test_set_pin(int pin, int val)
+{
+    int rc;
+
+    rc = hal_gpio_init_in(pin, val ? HAL_GPIO_PULL_UP : HAL_GPIO_PULL_DOWN);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+void
+debounce_test_scan(struct debounce_group *g, int times)
+{
+    while (times-- > 0) {
+        /* Dequeued on expiry; the scan starts it again. */
+        hal_timer_stop(&g->timer);
+        g->timer.cb_func(g->timer.cb_arg);
+    }
+}
+
+TEST_SUITE(debounce_test_suite_group)
+{
+    debounce_test_case_group_init();
+    debounce_test_case_group_basic();
+}
+
+int
+main(int argc, char **argv)
+{
+    debounce_test_suite_group();
+    return tu_any_failed;
+}
@@ -0,0 +1,40 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_DEBOUNCE_DRV_TEST_
+#define H_DEBOUNCE_DRV_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "debounce/debounce_group.h"
+
+/*
+ * Native GPIO inputs read back their pull setting, so changing the pull
+ * is how tests drive a pin.
+ */
+void debounce_test_set_pin(int pin, int val);
+
+/* Runs "times" scans of the group, as its timer would. */
+void debounce_test_scan(struct debounce_group *g, int times);
+
+TEST_SUITE_DECL(debounce_test_suite_group);
+TEST_CASE_DECL(debounce_test_case_group_init);
+TEST_CASE_DECL(debounce_test_case_group_basic);
+
+#endif
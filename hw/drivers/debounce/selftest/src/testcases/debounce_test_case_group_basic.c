@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "debounce_test.h"
+
+/* Long enough for the timer never to fire; the test runs the scans. */
+#define DTCGB_TICKS     (10 * MYNEWT_VAL(OS_CPUTIME_FREQ))
+
+static struct os_eventq dtcgb_evq;
+static int dtcgb_calls;
+static uint32_t dtcgb_changed;
+static uint32_t dtcgb_state;
+
+static void
+dtcgb_on_change(struct debounce_group *g, uint32_t changed)
+{
+    TEST_ASSERT(debounce_group_arg(g) == &dtcgb_evq);
+    dtcgb_calls++;
+    dtcgb_changed = changed;
+    dtcgb_state = debounce_group_state(g);
+}
+
+/* Runs the queued change event, if any; returns number of callbacks. */
+static int
+dtcgb_run(void)
+{
+    struct os_event *ev;
+
+    dtcgb_calls = 0;
+    dtcgb_changed = 0;
+    while ((ev = os_eventq_get_no_wait(&dtcgb_evq)) != NULL) {
+        ev->ev_cb(ev);
+    }
+
+    return dtcgb_calls;
+}
+
+TEST_CASE_SELF(debounce_test_case_group_basic)
+{
+    static const int pins[] = { 0, 1, 2, 3 };
+    struct debounce_group g;
+    int rc;
+
+    os_eventq_init(&dtcgb_evq);
+
+    rc = debounce_group_init(&g, pins, 4, HAL_GPIO_PULL_DOWN, 0,
+                             DTCGB_TICKS);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = debounce_group_start(&g, &dtcgb_evq, dtcgb_on_change, &dtcgb_evq);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    // Stable pins; nothing reported.
+    debounce_test_scan(&g, 8);
+    TEST_ASSERT(dtcgb_run() == 0);
+
+    // A pin changes state on the 4th scan at the new level.
+    debounce_test_set_pin(1, 1);
+    debounce_test_scan(&g, 3);
+    TEST_ASSERT(debounce_group_state(&g) == 0);
+    TEST_ASSERT(dtcgb_run() == 0);
+    debounce_test_scan(&g, 1);
+    TEST_ASSERT(debounce_group_state(&g) == 0x2);
+    TEST_ASSERT(dtcgb_run() == 1);
+    TEST_ASSERT(dtcgb_changed == 0x2);
+    TEST_ASSERT(dtcgb_state == 0x2);
+
+    // A bounce restarts the count.
+    debounce_test_set_pin(2, 1);
+    debounce_test_scan(&g, 3);
+    debounce_test_set_pin(2, 0);
+    debounce_test_scan(&g, 1);
+    debounce_test_set_pin(2, 1);
+    debounce_test_scan(&g, 3);
+    TEST_ASSERT(debounce_group_state(&g) == 0x2);
+    debounce_test_scan(&g, 1);
+    TEST_ASSERT(debounce_group_state(&g) == 0x6);
+    TEST_ASSERT(dtcgb_run() == 1);
+    TEST_ASSERT(dtcgb_changed == 0x4);
+
+    // Pins changing together are reported with one event.
+    debounce_test_set_pin(0, 1);
+    debounce_test_set_pin(1, 0);
+    debounce_test_set_pin(3, 1);
+    debounce_test_scan(&g, 4);
+    TEST_ASSERT(debounce_group_state(&g) == 0xd);
+    TEST_ASSERT(dtcgb_run() == 1);
+    TEST_ASSERT(dtcgb_changed == 0xb);
+    TEST_ASSERT(dtcgb_state == 0xd);
+
+    // Changes accumulate until the event runs; a change undone before
+    // then is not reported.
+    debounce_test_set_pin(0, 0);
+    debounce_test_scan(&g, 4);
+    debounce_test_set_pin(3, 0);
+    debounce_test_scan(&g, 4);
+    debounce_test_set_pin(0, 1);
+    debounce_test_scan(&g, 4);
+    TEST_ASSERT(debounce_group_state(&g) == 0x5);
+    TEST_ASSERT(dtcgb_run() == 1);
+    TEST_ASSERT(dtcgb_changed == 0x8);
+
+    // Stopping drops unreported changes.
+    debounce_test_set_pin(2, 0);
+    debounce_test_scan(&g, 4);
+    TEST_ASSERT(debounce_group_state(&g) == 0x1);
+    rc = debounce_group_stop(&g);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(dtcgb_run() == 0);
+
+    // Restarting keeps the debounced state.
+    rc = debounce_group_start(&g, &dtcgb_evq, dtcgb_on_change, &dtcgb_evq);
+    TEST_ASSERT_FATAL(rc == 0);
+    debounce_test_scan(&g, 4);
+    TEST_ASSERT(dtcgb_run() == 0);
+    debounce_test_set_pin(2, 1);
+    debounce_test_scan(&g, 4);
+    TEST_ASSERT(dtcgb_run() == 1);
+    TEST_ASSERT(dtcgb_changed == 0x4);
+
+    debounce_group_stop(&g);
+}
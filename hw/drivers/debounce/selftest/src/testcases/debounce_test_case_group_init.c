@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "debounce_test.h"
+
+TEST_CASE_SELF(debounce_test_case_group_init)
+{
+    static const int pins[] = { 0, 1, 2, 3 };
+    static const int bad_pins[] = { 0, 1000 };
+    struct debounce_group g;
+    int rc;
+
+    // Invalid configuration - no pins, too many pins, nonexistent pin.
+    rc = debounce_group_init(&g, pins, 0, HAL_GPIO_PULL_UP, 0, 1);
+    TEST_ASSERT(rc != 0);
+    rc = debounce_group_init(&g, pins, DEBOUNCE_GROUP_MAX_PINS + 1,
+                             HAL_GPIO_PULL_UP, 0, 1);
+    TEST_ASSERT(rc != 0);
+    rc = debounce_group_init(&g, bad_pins, 2, HAL_GPIO_PULL_UP, 0, 1);
+    TEST_ASSERT(rc != 0);
+
+    // Initial state is read from the pins.
+    rc = debounce_group_init(&g, pins, 4, HAL_GPIO_PULL_UP, 0, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(debounce_group_state(&g) == 0xf);
+
+    rc = debounce_group_init(&g, pins, 4, HAL_GPIO_PULL_NONE, 0, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(debounce_group_state(&g) == 0);
+
+    rc = debounce_group_init(&g, pins, 3, HAL_GPIO_PULL_UP, 0, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(debounce_group_state(&g) == 0x7);
+}
@@ -0,0 +1,143 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "debounce/debounce_group.h"
+
+static uint32_t
+debounce_group_sample(const struct debounce_group *g)
+{
+    uint32_t sample;
+    int i;
+
+    sample = 0;
+    for (i = 0; i < g->num_pins; i++) {
+        if (hal_gpio_read(g->pins[i])) {
+            sample |= 1UL << i;
+        }
+    }
+
+    return sample;
+}
+
+static void
+debounce_group_event(struct os_event *ev)
+{
+    struct debounce_group *g = ev->ev_arg;
+    uint32_t changed;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    changed = g->pending;
+    g->pending = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    if (changed && g->on_change) {
+        g->on_change(g, changed);
+    }
+}
+
+static void
+debounce_group_scan(void *arg)
+{
+    struct debounce_group *g = arg;
+    uint32_t delta;
+    uint32_t toggle;
+
+    hal_timer_start(&g->timer, g->ticks);
+
+    /*
+     * Vertical counter: a bit's counter advances while the sample differs
+     * from the debounced state and is cleared as soon as it matches.  The
+     * state flips when the counter wraps after 4 samples.
+     */
+    delta = debounce_group_sample(g) ^ g->state;
+    g->cnt1 = (g->cnt1 ^ g->cnt0) & delta;
+    g->cnt0 = ~g->cnt0 & delta;
+    toggle = delta & ~(g->cnt0 | g->cnt1);
+    if (!toggle) {
+        return;
+    }
+
+    g->state ^= toggle;
+    g->pending ^= toggle;
+    if (g->pending) {
+        os_eventq_put(g->evq, &g->ev);
+    }
+}
+
+int
+debounce_group_init(struct debounce_group *g, const int *pins,
+                    int num_pins, hal_gpio_pull_t pull, int timer,
+                    uint32_t ticks)
+{
+    int i;
+
+    if (num_pins <= 0 || num_pins > DEBOUNCE_GROUP_MAX_PINS) {
+        return -1;
+    }
+
+    memset(g, 0, sizeof(*g));
+    g->pins = pins;
+    g->num_pins = num_pins;
+    g->ticks = ticks;
+    g->ev.ev_cb = debounce_group_event;
+    g->ev.ev_arg = g;
+
+    for (i = 0; i < num_pins; i++) {
+        if (hal_gpio_init_in(pins[i], pull)) {
+            return -1;
+        }
+    }
+
+    if (hal_timer_set_cb(timer, &g->timer, debounce_group_scan, g)) {
+        return -1;
+    }
+
+    g->state = debounce_group_sample(g);
+
+    return 0;
+}
+
+int
+debounce_group_start(struct debounce_group *g, struct os_eventq *evq,
+                     debounce_group_cb_t cb, void *arg)
+{
+    g->evq = evq ? evq : os_eventq_dflt_get();
+    g->on_change = cb;
+    g->arg = arg;
+    g->cnt0 = 0;
+    g->cnt1 = 0;
+    g->pending = 0;
+
+    return hal_timer_start(&g->timer, g->ticks);
+}
+
+int
+debounce_group_stop(struct debounce_group *g)
+{
+    hal_timer_stop(&g->timer);
+    if (g->evq) {
+        os_eventq_remove(g->evq, &g->ev);
+    }
+    g->pending = 0;
+
+    return 0;
+}
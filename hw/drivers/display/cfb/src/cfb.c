@@ -57,10 +57,48 @@ struct char_framebuffer {
 
 	/** Inverted */
 	bool inverted;
+
+	/** Nothing drawn since the last clear */
+	bool blank;
+
+	/** Some tiles changed since the last finalize */
+	bool dirty;
+
+	/** Changed tiles: columns dx0..dx1, tile rows dy0..dy1 */
+	uint8_t dx0;
+	uint8_t dx1;
+	uint8_t dy0;
+	uint8_t dy1;
+
+	/** Window staging buffer, for displays with SCREEN_INFO_WINDOW */
+	uint8_t *win_buf;
 };
 
 static struct char_framebuffer char_fb;
 
+static void cfb_mark_dirty(struct char_framebuffer *fb, uint8_t x0,
+			   uint8_t x1, uint8_t y0, uint8_t y1)
+{
+	if (!fb->dirty) {
+		fb->dirty = true;
+		fb->dx0 = x0;
+		fb->dx1 = x1;
+		fb->dy0 = y0;
+		fb->dy1 = y1;
+		return;
+	}
+
+	fb->dx0 = min(fb->dx0, x0);
+	fb->dx1 = max(fb->dx1, x1);
+	fb->dy0 = min(fb->dy0, y0);
+	fb->dy1 = max(fb->dy1, y1);
+}
+
+static void cfb_mark_all_dirty(struct char_framebuffer *fb)
+{
+	cfb_mark_dirty(fb, 0, fb->x_res - 1, 0, fb->y_res / fb->ppt - 1);
+}
+
 static inline uint8_t *get_glyph_ptr(const struct cfb_font *fptr, char c)
 {
 	if (fptr->caps & CFB_FONT_MONO_VPACKED) {
@@ -76,11 +114,12 @@ static inline uint8_t *get_glyph_ptr(const struct cfb_font *fptr, char c)
  * Draw the monochrome character in the monochrome tiled framebuffer,
  * a byte is interpreted as 8 pixels ordered vertically among each other.
  */
-static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
+static uint8_t draw_char_vtmono(struct char_framebuffer *fb,
 			     char c, uint16_t x, uint16_t y)
 {
 	const struct cfb_font *fptr = &(fb->fonts[fb->font_idx]);
 	uint8_t *glyph_ptr;
+	uint8_t *dst;
 
 	if (c < fptr->first_char || c > fptr->last_char) {
 		c = ' ';
@@ -100,8 +139,13 @@ static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
 			if ((fb_y + x + g_x) >= fb->size) {
 				return 0;
 			}
-			fb->buf[fb_y + x + g_x] =
-				glyph_ptr[g_x * (fptr->height / 8) + g_y];
+			dst = &fb->buf[fb_y + x + g_x];
+			if (*dst != glyph_ptr[g_x * (fptr->height / 8) + g_y]) {
+				*dst = glyph_ptr[g_x * (fptr->height / 8) + g_y];
+				cfb_mark_dirty(fb, x + g_x, x + g_x,
+					       y_segment + g_y, y_segment + g_y);
+				fb->blank = false;
+			}
 		}
 
 	}
@@ -111,7 +155,7 @@ static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
 
 int cfb_print(struct os_dev *dev, char *str, uint16_t x, uint16_t y)
 {
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	const struct cfb_font *fptr = &(fb->fonts[fb->font_idx]);
 
 	if (!fb->fonts || !fb->buf) {
@@ -138,38 +182,83 @@ int cfb_print(struct os_dev *dev, char *str, uint16_t x, uint16_t y)
 	return -1;
 }
 
-static int cfb_reverse_bytes(const struct char_framebuffer *fb)
+static int cfb_reverse_bytes(const struct char_framebuffer *fb,
+			     uint8_t *buf, size_t len)
 {
 	if (!(fb->screen_info & SCREEN_INFO_MONO_VTILED)) {
 		DFLT_LOG_ERROR("Unsupported framebuffer configuration");
 		return -1;
 	}
 
-	for (size_t i = 0; i < fb->x_res * fb->y_res / 8; i++) {
-		fb->buf[i] = (fb->buf[i] & 0xf0) >> 4 |
-			      (fb->buf[i] & 0x0f) << 4;
-		fb->buf[i] = (fb->buf[i] & 0xcc) >> 2 |
-			      (fb->buf[i] & 0x33) << 2;
-		fb->buf[i] = (fb->buf[i] & 0xaa) >> 1 |
-			      (fb->buf[i] & 0x55) << 1;
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = (buf[i] & 0xf0) >> 4 |
+			 (buf[i] & 0x0f) << 4;
+		buf[i] = (buf[i] & 0xcc) >> 2 |
+			 (buf[i] & 0x33) << 2;
+		buf[i] = (buf[i] & 0xaa) >> 1 |
+			 (buf[i] & 0x55) << 1;
 	}
 
 	return 0;
 }
 
-static int cfb_invert(const struct char_framebuffer *fb)
+static int cfb_invert(uint8_t *buf, size_t len)
 {
-	for (size_t i = 0; i < fb->x_res * fb->y_res / 8; i++) {
-		fb->buf[i] = ~fb->buf[i];
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = ~buf[i];
 	}
 
 	return 0;
 }
 
+static void cfb_prepare(const struct char_framebuffer *fb, uint8_t *buf,
+			size_t len)
+{
+	if (!(fb->pixel_format & PIXEL_FORMAT_MONO10) != !(fb->inverted)) {
+		cfb_invert(buf, len);
+	}
+
+	if (fb->screen_info & SCREEN_INFO_MONO_MSB_FIRST) {
+		cfb_reverse_bytes(fb, buf, len);
+	}
+}
+
+/*
+ * Send only the changed window on displays that accept windows.  The
+ * staging copy is converted, so the framebuffer keeps its drawing layout.
+ */
+static int cfb_write_window(struct os_dev *dev,
+			    struct char_framebuffer *fb)
+{
+	const struct display_driver_api *api = dev->od_init_arg;
+	struct display_buffer_descriptor desc;
+	uint8_t width;
+	uint8_t rows;
+	uint8_t *dst;
+
+	width = fb->dx1 - fb->dx0 + 1;
+	rows = fb->dy1 - fb->dy0 + 1;
+
+	dst = fb->win_buf;
+	for (uint8_t row = fb->dy0; row <= fb->dy1; row++) {
+		memcpy(dst, &fb->buf[row * fb->x_res + fb->dx0], width);
+		dst += width;
+	}
+
+	desc.buf_size = width * rows;
+	desc.width = width;
+	desc.height = rows * fb->ppt;
+	desc.pitch = width;
+
+	cfb_prepare(fb, fb->win_buf, desc.buf_size);
+
+	return api->write(dev, fb->dx0, fb->dy0 * fb->ppt, &desc, fb->win_buf);
+}
+
 int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 {
 	const struct display_driver_api *api = dev->od_init_arg;
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	struct display_buffer_descriptor desc;
 	int rc;
 
@@ -181,7 +270,11 @@ int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 	desc.width = 0;
 	desc.height = 0;
 	desc.pitch = 0;
-	memset(fb->buf, 0, fb->size);
+	if (!fb->blank) {
+		memset(fb->buf, 0, fb->size);
+		fb->blank = true;
+		cfb_mark_all_dirty(fb);
+	}
 
 	if (clear_display && (fb->screen_info & SCREEN_INFO_EPD)) {
 		rc = api->set_contrast(dev, 1);
@@ -206,7 +299,7 @@ int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 int cfb_framebuffer_finalize(struct os_dev *dev)
 {
 	const struct display_driver_api *api = dev->od_init_arg;
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	struct display_buffer_descriptor desc;
 	int rc;
 
@@ -214,20 +307,32 @@ int cfb_framebuffer_finalize(struct os_dev *dev)
 		return -1;
 	}
 
+	/* Display already shows the framebuffer. */
+	if (!fb->dirty) {
+		return 0;
+	}
+
+	if (fb->win_buf) {
+		rc = cfb_write_window(dev, fb);
+		if (rc == 0) {
+			fb->dirty = false;
+		}
+		return rc;
+	}
+
 	desc.buf_size = fb->size;
 	desc.width = 0;
 	desc.height = 0;
 	desc.pitch = 0;
 
-	if (!(fb->pixel_format & PIXEL_FORMAT_MONO10) != !(fb->inverted)) {
-		cfb_invert(fb);
-	}
-
-	if (fb->screen_info & SCREEN_INFO_MONO_MSB_FIRST) {
-		cfb_reverse_bytes(fb);
-	}
+	cfb_prepare(fb, fb->buf, fb->size);
+	/* Converted in place; any later drawing changes the whole frame. */
+	fb->blank = false;
 
 	rc = api->write(dev, 0, 0, &desc, fb->buf);
+	if (rc == 0) {
+		fb->dirty = false;
+	}
 	return rc;
 }
 
@@ -314,6 +419,13 @@ int cfb_framebuffer_init(struct os_dev *dev)
 	fb->font_idx = 0;
 	fb->kerning = 0;
 	fb->inverted = false;
+	fb->blank = true;
+	fb->dirty = true;
+	fb->dx0 = 0;
+	fb->dx1 = fb->x_res - 1;
+	fb->dy0 = 0;
+	fb->dy1 = fb->y_res / fb->ppt - 1;
+	fb->win_buf = NULL;
 
 	fb->fonts = font_array;
 	fb->font_idx = 0;
@@ -326,5 +438,10 @@ int cfb_framebuffer_init(struct os_dev *dev)
 
 	memset(fb->buf, 0, fb->size);
 
+	if (fb->screen_info & SCREEN_INFO_WINDOW) {
+		/* Without it full frames are sent. */
+		fb->win_buf = malloc(fb->size);
+	}
+
 	return 0;
 }
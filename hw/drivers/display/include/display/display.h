@@ -57,6 +57,12 @@ enum display_screen_info {
 	 * Electrophoretic Display.
 	 */
 	SCREEN_INFO_EPD			= (1UL << 2),
+	/**
+	 * The write API accepts windows smaller than the screen: x and y
+	 * give the window origin in pixels and the buffer holds only the
+	 * window, in the same tiled layout as a full frame.
+	 */
+	SCREEN_INFO_WINDOW		= (1UL << 3),
 };
 
 /**
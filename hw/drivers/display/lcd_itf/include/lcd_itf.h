@@ -98,4 +98,15 @@ void lcd_itf_init(void);
 void lcd_ift_write_cmd(const uint8_t *cmd, int cmd_length);
 void lcd_itf_write_color_data(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, void *pixels);
 
+typedef void (*lcd_itf_write_done_cb)(void *arg);
+
+/*
+ * Starts writing color data and returns, calling cb (possibly from
+ * interrupt context) once pixels buffer is no longer used. Interfaces that
+ * can not transfer in background write synchronously and call cb before
+ * returning. No other interface function may be called until cb runs.
+ */
+void lcd_itf_write_color_data_async(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2,
+                                    void *pixels, lcd_itf_write_done_cb cb, void *arg);
+
 #endif /* LCD_ITF_H */
@@ -25,12 +25,38 @@
 
 #define PIN(b, pin) ((b >> pin) & 1)
 
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+/* Set when all data pins are on one port and can be written at once */
+static int lcd_itf_8080_use_bus;
+static struct hal_gpio_bus lcd_itf_8080_bus8;
+#if MYNEWT_VAL_CHOICE(LCD_ITF, 8080_II_16_bit)
+static struct hal_gpio_bus lcd_itf_8080_bus16;
+#endif
+static int lcd_itf_8080_wr_port;
+static uint32_t lcd_itf_8080_wr_mask;
+
+static void
+lcd_itf_8080_strobe(void)
+{
+    hal_gpio_port_write_masked(lcd_itf_8080_wr_port, lcd_itf_8080_wr_mask, 0);
+    hal_gpio_port_write_masked(lcd_itf_8080_wr_port, lcd_itf_8080_wr_mask,
+                               lcd_itf_8080_wr_mask);
+}
+#endif
+
 #ifndef LCD_ITF_8080_WRITE_BYTE
 #define LCD_ITF_8080_WRITE_BYTE(n) lcd_itf_8080_write_byte(n)
 
 void
 lcd_itf_8080_write_byte(uint8_t b)
 {
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+    if (lcd_itf_8080_use_bus) {
+        hal_gpio_bus_write(&lcd_itf_8080_bus8, b);
+        lcd_itf_8080_strobe();
+        return;
+    }
+#endif
     hal_gpio_write(MYNEWT_VAL(LCD_D0_PIN), PIN(b, 0));
     hal_gpio_write(MYNEWT_VAL(LCD_D1_PIN), PIN(b, 1));
     hal_gpio_write(MYNEWT_VAL(LCD_D2_PIN), PIN(b, 2));
@@ -60,6 +86,13 @@ lcd_itf_8080_write_byte(uint8_t b)
 void
 lcd_itf_8080_write_word(uint16_t w)
 {
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+    if (lcd_itf_8080_use_bus) {
+        hal_gpio_bus_write(&lcd_itf_8080_bus16, w);
+        lcd_itf_8080_strobe();
+        return;
+    }
+#endif
     hal_gpio_write(MYNEWT_VAL(LCD_D0_PIN), PIN(w, 0));
     hal_gpio_write(MYNEWT_VAL(LCD_D1_PIN), PIN(w, 1));
     hal_gpio_write(MYNEWT_VAL(LCD_D2_PIN), PIN(w, 2));
@@ -121,6 +154,18 @@ lcd_ift_write_cmd(const uint8_t *cmd, int cmd_length)
     LCD_CS_PIN_INACTIVE();
 }
 
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+static const int lcd_itf_8080_data_pins[] = {
+    MYNEWT_VAL(LCD_D0_PIN), MYNEWT_VAL(LCD_D1_PIN), MYNEWT_VAL(LCD_D2_PIN),
+    MYNEWT_VAL(LCD_D3_PIN), MYNEWT_VAL(LCD_D4_PIN), MYNEWT_VAL(LCD_D5_PIN),
+    MYNEWT_VAL(LCD_D6_PIN), MYNEWT_VAL(LCD_D7_PIN),
+#if MYNEWT_VAL_CHOICE(LCD_ITF, 8080_II_16_bit)
+    MYNEWT_VAL(LCD_D8_PIN), MYNEWT_VAL(LCD_D9_PIN), MYNEWT_VAL(LCD_D10_PIN),
+    MYNEWT_VAL(LCD_D11_PIN), MYNEWT_VAL(LCD_D12_PIN), MYNEWT_VAL(LCD_D13_PIN),
+    MYNEWT_VAL(LCD_D14_PIN), MYNEWT_VAL(LCD_D15_PIN),
+#endif
+};
+#endif
 
 void
 lcd_itf_init(void)
@@ -155,4 +200,15 @@ lcd_itf_init(void)
     hal_gpio_init_out(MYNEWT_VAL(LCD_D14_PIN), 0);
     hal_gpio_init_out(MYNEWT_VAL(LCD_D15_PIN), 0);
 #endif
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+    lcd_itf_8080_use_bus =
+        hal_gpio_bus_init(&lcd_itf_8080_bus8, lcd_itf_8080_data_pins,
+                          8) == 0 &&
+#if MYNEWT_VAL_CHOICE(LCD_ITF, 8080_II_16_bit)
+        hal_gpio_bus_init(&lcd_itf_8080_bus16, lcd_itf_8080_data_pins,
+                          16) == 0 &&
+#endif
+        hal_gpio_port_pin(MYNEWT_VAL(LCD_WR_PIN), &lcd_itf_8080_wr_port,
+                          &lcd_itf_8080_wr_mask) == 0;
+#endif
 }
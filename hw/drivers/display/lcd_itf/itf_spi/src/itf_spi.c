@@ -34,16 +34,12 @@ static struct bus_spi_node_cfg lcd_spi_cfg = {
 };
 static struct os_dev *lcd_dev;
 
-void
-lcd_itf_write_color_data(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, void *pixels)
+static void
+lcd_itf_swap_color_data(uint8_t *color_data, size_t size)
 {
-    uint8_t *color_data = pixels;
     uint8_t b;
     size_t i;
-    size_t size = (x2 - x1 + 1) * (y2 - y1 + 1) * 2;
 
-    LCD_DC_PIN_DATA();
-    LCD_CS_PIN_ACTIVE();
     if (LV_COLOR_16_SWAP == 0) {
         for (i = 0; i < size; i += 2) {
             b = color_data[i];
@@ -51,10 +47,92 @@ lcd_itf_write_color_data(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, voi
             color_data[i + 1] = b;
         }
     }
+}
+
+void
+lcd_itf_write_color_data(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2, void *pixels)
+{
+    uint8_t *color_data = pixels;
+    size_t size = (x2 - x1 + 1) * (y2 - y1 + 1) * 2;
+
+    LCD_DC_PIN_DATA();
+    LCD_CS_PIN_ACTIVE();
+    lcd_itf_swap_color_data(color_data, size);
     bus_node_write(lcd_dev, color_data, size, 1000, BUS_F_NOSTOP);
     LCD_CS_PIN_INACTIVE();
 }
 
+#if MYNEWT_VAL(LCD_SPI_ASYNC)
+/* Largest piece of color data queued as single bus transaction */
+#define LCD_SPI_XFER_MAX    0xFFFE
+
+static struct {
+    struct bus_xfer xfer;
+    const uint8_t *data;
+    size_t left;
+    lcd_itf_write_done_cb cb;
+    void *arg;
+} lcd_async;
+
+static void lcd_itf_async_done(struct bus_xfer *xfer);
+
+static void
+lcd_itf_async_next(void)
+{
+    uint16_t len;
+    int rc;
+
+    len = min(lcd_async.left, LCD_SPI_XFER_MAX);
+    lcd_async.xfer = (struct bus_xfer) {
+        .type = BUS_XFER_WRITE,
+        .wbuf = lcd_async.data,
+        .wlength = len,
+        .flags = len < lcd_async.left ? BUS_F_NOSTOP : 0,
+        .timeout = 1000,
+        .cb = lcd_itf_async_done,
+    };
+    lcd_async.data += len;
+    lcd_async.left -= len;
+
+    rc = bus_node_submit(lcd_dev, &lcd_async.xfer);
+    if (rc != 0) {
+        lcd_async.xfer.rc = rc;
+        lcd_async.left = 0;
+        lcd_itf_async_done(&lcd_async.xfer);
+    }
+}
+
+static void
+lcd_itf_async_done(struct bus_xfer *xfer)
+{
+    if (xfer->rc == 0 && lcd_async.left > 0) {
+        lcd_itf_async_next();
+        return;
+    }
+
+    LCD_CS_PIN_INACTIVE();
+    lcd_async.cb(lcd_async.arg);
+}
+
+void
+lcd_itf_write_color_data_async(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2,
+                               void *pixels, lcd_itf_write_done_cb cb, void *arg)
+{
+    size_t size = (x2 - x1 + 1) * (y2 - y1 + 1) * 2;
+
+    lcd_itf_swap_color_data(pixels, size);
+
+    lcd_async.data = pixels;
+    lcd_async.left = size;
+    lcd_async.cb = cb;
+    lcd_async.arg = arg;
+
+    LCD_DC_PIN_DATA();
+    LCD_CS_PIN_ACTIVE();
+    lcd_itf_async_next();
+}
+#endif
+
 void
 lcd_ift_write_cmd(const uint8_t *cmd, int cmd_length)
 {
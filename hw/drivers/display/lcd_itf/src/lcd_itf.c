@@ -33,6 +33,14 @@ lcd_delay(uint32_t delay_us)
     }
 }
 
+void __attribute__((weak))
+lcd_itf_write_color_data_async(uint16_t x1, uint16_t x2, uint16_t y1, uint16_t y2,
+                               void *pixels, lcd_itf_write_done_cb cb, void *arg)
+{
+    lcd_itf_write_color_data(x1, x2, y1, y2, pixels);
+    cb(arg);
+}
+
 void
 lcd_command_sequence(const uint8_t *cmds)
 {
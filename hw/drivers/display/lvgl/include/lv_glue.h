@@ -33,4 +33,14 @@ void lv_touch_handler(void);
  */
 void mynewt_lv_drv_init(lv_disp_drv_t *driver);
 
+/**
+ * Completion callback for lcd_itf_write_color_data_async()
+ *
+ * Signals LVGL that the flushed buffer can be reused. Safe to call from
+ * interrupt context.
+ *
+ * @param driver - lvgl display driver (lv_disp_drv_t *)
+ */
+void mynewt_lv_flush_ready(void *driver);
+
 #endif /* LV_GLUE_H */
@@ -89,6 +89,12 @@ mynewt_lv_rounder(struct _lv_disp_drv_t *driver, lv_area_t *area)
     }
 }
 
+void
+mynewt_lv_flush_ready(void *driver)
+{
+    lv_disp_flush_ready(driver);
+}
+
 void
 mynewt_lv_init(void)
 {
@@ -236,9 +236,8 @@ gc9a01_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
     cmd[0] = GC9A01_RAMWR;
     lcd_ift_write_cmd(cmd, 1);
 
-    lcd_itf_write_color_data(act_x1, act_x2, act_y1, act_y2, color_p);
-
-    lv_disp_flush_ready(drv);
+    lcd_itf_write_color_data_async(act_x1, act_x2, act_y1, act_y2, color_p,
+                                   mynewt_lv_flush_ready, drv);
 }
 
 void
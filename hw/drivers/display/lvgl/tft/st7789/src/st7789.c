@@ -267,9 +267,8 @@ st7789_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
     cmd[0] = ST7789_RAMWR;
     lcd_ift_write_cmd(cmd, 1);
 
-    lcd_itf_write_color_data(offsetx1, offsetx2, offsety1, offsety2, color_p);
-
-    lv_disp_flush_ready(drv);
+    lcd_itf_write_color_data_async(offsetx1, offsetx2, offsety1, offsety2, color_p,
+                                   mynewt_lv_flush_ready, drv);
 }
 
 void
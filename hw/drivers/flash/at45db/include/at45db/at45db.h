@@ -22,6 +22,10 @@
 
 #include <hal/hal_flash_int.h>
 #include <hal/hal_spi.h>
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+#include <os/os_mutex.h>
+#include <os/os_callout.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +40,16 @@ struct at45db_dev {
     uint32_t baudrate;
     uint16_t page_size;             /** Page size to be used, valid: 512 and 528 */
     uint8_t disable_auto_erase;     /** Reads and writes auto-erase by default */
+    uint8_t last_buf;               /** SRAM buffer programmed last */
+    uint16_t buf_page[2];           /** Page held by each SRAM buffer */
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    struct os_mutex lock;
+    /** Asynchronous erase in progress, one page at a time */
+    struct hal_flash_req *async_req;
+    uint32_t async_addr;
+    uint32_t async_end;
+    struct os_callout async_co;
+#endif
 };
 
 struct at45db_dev * at45db_default_config(void);
@@ -65,7 +65,13 @@
 #define STATUS_BUSY                 (1 << 7)
 #define STATUS_CMP                  (1 << 6)
 
-#define MAX_PAGE_SIZE               528
+/* Page number of buffer not holding any page */
+#define BUF_PAGE_NONE               0xffff
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+static int at45db_submit(const struct hal_flash *dev,
+                         struct hal_flash_req *req);
+#endif
 
 static const struct hal_flash_funcs at45db_flash_funcs = {
     .hff_read         = at45db_read,
@@ -73,6 +79,9 @@ static const struct hal_flash_funcs at45db_flash_funcs = {
     .hff_erase_sector = at45db_erase_sector,
     .hff_sector_info  = at45db_sector_info,
     .hff_init         = at45db_init,
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    .hff_submit       = at45db_submit,
+#endif
 };
 
 static struct at45db_dev at45db_default_dev = {
@@ -105,7 +114,25 @@ static struct hal_spi_settings at45db_default_settings = {
     .word_size  = HAL_SPI_WORD_SIZE_8BIT,
 };
 
-static uint8_t g_page_buffer[MAX_PAGE_SIZE];
+/*
+ * Device is only shared with callout handler of asynchronous erase,
+ * without it callers serialize access themselves.
+ */
+static inline void
+at45db_lock(struct at45db_dev *dev)
+{
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    os_mutex_pend(&dev->lock, OS_TIMEOUT_NEVER);
+#endif
+}
+
+static inline void
+at45db_unlock(struct at45db_dev *dev)
+{
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    os_mutex_release(&dev->lock);
+#endif
+}
 
 static uint8_t
 at45db_read_status(struct at45db_dev *dev)
@@ -238,6 +265,8 @@ at45db_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *buf,
     u8buf = (uint8_t *) buf;
     index = 0;
 
+    at45db_lock(dev);
+
     while (page_count--) {
         at45db_wait_ready(dev);
 
@@ -248,9 +277,36 @@ at45db_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *buf,
         len -= amount;
     }
 
+    at45db_unlock(dev);
+
     return 0;
 }
 
+/*
+ * Send command which takes page address, e.g. buffer transfer or program.
+ */
+static void
+at45db_page_cmd(struct at45db_dev *dev, uint8_t cmd, uint16_t pa)
+{
+    hal_gpio_write(dev->ss_pin, 0);
+
+    /* FIXME: check that pa doesn't overflow capacity */
+    hal_spi_tx_val(dev->spi_num, cmd);
+    hal_spi_tx_val(dev->spi_num, (pa >> 6) & ~0x80);
+    hal_spi_tx_val(dev->spi_num, pa << 2);
+    hal_spi_tx_val(dev->spi_num, 0xff);
+
+    hal_gpio_write(dev->ss_pin, 1);
+}
+
+/**
+ * Writes go through the two SRAM buffers of the chip, which keep their
+ * contents after being programmed to main memory. Driver remembers which
+ * page each buffer holds, so successive writes to the same page only
+ * transfer the new data over SPI. If page is not in either buffer, it is
+ * loaded with internal memory to buffer transfer. Buffers are used
+ * alternately, so that one can be filled while the other is programmed.
+ */
 int
 at45db_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
         const void *buf, uint32_t len)
@@ -258,12 +314,13 @@ at45db_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
     uint16_t pa;
     uint16_t bfa;
     uint32_t n;
-    uint32_t start_addr;
     uint16_t index;
     uint16_t amount;
     int page_count;
     uint8_t *u8buf;
     uint16_t page_size;
+    uint8_t busy;
+    uint8_t b;
     struct at45db_dev *dev;
 
     dev = (struct at45db_dev *) hal_flash_dev;
@@ -273,51 +330,55 @@ at45db_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
     u8buf = (uint8_t *) buf;
     index = 0;
 
-    while (page_count--) {
-        at45db_wait_ready(dev);
+    at45db_lock(dev);
 
+    while (page_count--) {
         bfa = addr % page_size;
-        start_addr = at45db_page_start_address(dev, addr);
+        pa = addr / page_size;
+
+        if (len + bfa <= page_size) {
+            amount = len;
+        } else {
+            amount = page_size - bfa;
+        }
+
+        busy = 0;
+        if (dev->buf_page[0] == pa) {
+            b = 0;
+        } else if (dev->buf_page[1] == pa) {
+            b = 1;
+        } else {
+            /* Take the buffer which was not programmed last. */
+            b = !dev->last_buf;
+            dev->buf_page[b] = BUF_PAGE_NONE;
+
+            /**
+             * If the page is not being written as a whole, the rest
+             * of it comes from main memory.
+             */
+            if (amount < page_size) {
+                at45db_wait_ready(dev);
+                at45db_page_cmd(dev, b ? MEM_TO_BUF2_TRANSFER :
+                                         MEM_TO_BUF1_TRANSFER, pa);
+                busy = 1;
+            }
+        }
 
         /**
-         * If the page is not being written from the beginning,
-         * read first the current data to rewrite back.
-         *
-         * The whole page is read here for the case of some the
-         * real data ending before the end of the page, data must
-         * be written back again.
+         * Buffer can't be accessed while it is being programmed or
+         * loaded from memory; the other buffer can.
          */
-        if (bfa || len < page_size) {
-            at45db_read_page(dev, start_addr, page_size, g_page_buffer);
+        if (busy || b == dev->last_buf) {
             at45db_wait_ready(dev);
         }
 
         hal_gpio_write(dev->ss_pin, 0);
 
-        /* TODO: ping-pong between page 1 and 2? */
-        hal_spi_tx_val(dev->spi_num, BUF1_WRITE);
+        hal_spi_tx_val(dev->spi_num, b ? BUF2_WRITE : BUF1_WRITE);
 
         hal_spi_tx_val(dev->spi_num, 0xff);
-
-        /* Always write at offset 0 of internal buffer */
-        hal_spi_tx_val(dev->spi_num, 0);
-        hal_spi_tx_val(dev->spi_num, 0);
-
-        /**
-         * Write back extra stuff at the beginning of page.
-         */
-        if (bfa) {
-            amount = addr - start_addr;
-            for (n = 0; n < amount; n++) {
-                hal_spi_tx_val(dev->spi_num, g_page_buffer[n]);
-            }
-        }
-
-        if (len + bfa <= page_size) {
-            amount = len;
-        } else {
-            amount = page_size - bfa;
-        }
+        hal_spi_tx_val(dev->spi_num, (bfa >> 8) & 3);
+        hal_spi_tx_val(dev->spi_num, bfa);
 
         /**
          * Write the stuff we're really want to write!
@@ -326,66 +387,128 @@ at45db_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
             hal_spi_tx_val(dev->spi_num, u8buf[index++]);
         }
 
-        /**
-         * Write back extra stuff at the ending of page.
-         */
-        if (bfa + len < page_size) {
-            for (n = len + bfa; n < page_size; n++) {
-                hal_spi_tx_val(dev->spi_num, g_page_buffer[n]);
-            }
-        }
-
         hal_gpio_write(dev->ss_pin, 1);
 
         at45db_wait_ready(dev);
 
-        hal_gpio_write(dev->ss_pin, 0);
-
         if (dev->disable_auto_erase) {
-            hal_spi_tx_val(dev->spi_num, BUF1_TO_MEM_NO_ERASE);
+            at45db_page_cmd(dev, b ? BUF2_TO_MEM_NO_ERASE :
+                                     BUF1_TO_MEM_NO_ERASE, pa);
         } else {
-            hal_spi_tx_val(dev->spi_num, BUF1_TO_MEM_ERASE);
+            at45db_page_cmd(dev, b ? BUF2_TO_MEM_ERASE : BUF1_TO_MEM_ERASE,
+                            pa);
         }
-
-        /* FIXME: check that pa doesn't overflow capacity */
-        pa = addr / page_size;
-
-        hal_spi_tx_val(dev->spi_num, (pa >> 6) & ~0x80);
-        hal_spi_tx_val(dev->spi_num, pa << 2);
-        hal_spi_tx_val(dev->spi_num, 0xff);
-
-        hal_gpio_write(dev->ss_pin, 1);
+        dev->buf_page[b] = pa;
+        dev->last_buf = b;
 
         addr = at45db_page_next_addr(dev, addr);
         len -= amount;
     }
 
+    at45db_unlock(dev);
+
     return 0;
 }
 
+static void
+at45db_page_erase(struct at45db_dev *dev, uint32_t sector_address)
+{
+    uint16_t pa;
+
+    pa = sector_address / dev->page_size;
+
+    at45db_wait_ready(dev);
+
+    at45db_page_cmd(dev, PAGE_ERASE, pa);
+
+    /* Buffer copy of the page is stale now. */
+    if (dev->buf_page[0] == pa) {
+        dev->buf_page[0] = BUF_PAGE_NONE;
+    }
+    if (dev->buf_page[1] == pa) {
+        dev->buf_page[1] = BUF_PAGE_NONE;
+    }
+}
+
 int
 at45db_erase_sector(const struct hal_flash *hal_flash_dev,
         uint32_t sector_address)
 {
     struct at45db_dev *dev;
-    uint16_t pa;
 
     dev = (struct at45db_dev *) hal_flash_dev;
-    pa = sector_address / dev->page_size;
 
-    at45db_wait_ready(dev);
+    at45db_lock(dev);
+    at45db_page_erase(dev, sector_address);
+    at45db_unlock(dev);
 
-    hal_gpio_write(dev->ss_pin, 0);
+    return 0;
+}
 
-    hal_spi_tx_val(dev->spi_num, PAGE_ERASE);
-    hal_spi_tx_val(dev->spi_num, (pa >> 6) & ~0x80);
-    hal_spi_tx_val(dev->spi_num, pa << 2);
-    hal_spi_tx_val(dev->spi_num, 0xff);
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Page erase takes up to 35ms, check for ready and erase next page or
+ * complete the request.
+ */
+static void
+at45db_async_tmo_func(struct os_event *ev)
+{
+    struct at45db_dev *dev = ev->ev_arg;
+    struct hal_flash_req *req;
 
-    hal_gpio_write(dev->ss_pin, 1);
+    at45db_lock(dev);
+
+    if (!at45db_device_ready(dev)) {
+        os_callout_reset(&dev->async_co, OS_TICKS_PER_SEC / 200 + 1);
+        at45db_unlock(dev);
+        return;
+    }
+    if (dev->async_addr < dev->async_end) {
+        at45db_page_erase(dev, dev->async_addr);
+        dev->async_addr += dev->page_size;
+        os_callout_reset(&dev->async_co, OS_TICKS_PER_SEC / 100 + 1);
+        at45db_unlock(dev);
+        return;
+    }
+
+    req = dev->async_req;
+    dev->async_req = NULL;
+
+    at45db_unlock(dev);
+
+    hal_flash_req_done(req, 0);
+}
+
+static int
+at45db_submit(const struct hal_flash *hal_flash_dev, struct hal_flash_req *req)
+{
+    struct at45db_dev *dev;
+
+    dev = (struct at45db_dev *) hal_flash_dev;
+
+    if (req->hfr_op != HAL_FLASH_OP_ERASE) {
+        return SYS_ENOTSUP;
+    }
+
+    at45db_lock(dev);
+
+    /* Only one asynchronous erase at a time */
+    while (dev->async_req) {
+        at45db_unlock(dev);
+        os_time_delay(OS_TICKS_PER_SEC / 100 + 1);
+        at45db_lock(dev);
+    }
+
+    dev->async_req = req;
+    dev->async_addr = req->hfr_addr;
+    dev->async_end = req->hfr_addr + req->hfr_len;
+    os_callout_reset(&dev->async_co, 0);
+
+    at45db_unlock(dev);
 
     return 0;
 }
+#endif
 
 int
 at45db_sector_info(const struct hal_flash *hal_flash_dev, int idx,
@@ -421,6 +544,16 @@ at45db_init(const struct hal_flash *hal_flash_dev)
 
     dev = (struct at45db_dev *) hal_flash_dev;
 
+    dev->buf_page[0] = BUF_PAGE_NONE;
+    dev->buf_page[1] = BUF_PAGE_NONE;
+    dev->last_buf = 1;
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    os_mutex_init(&dev->lock);
+    os_callout_init(&dev->async_co, os_eventq_dflt_get(),
+                    at45db_async_tmo_func, dev);
+#endif
+
     /* only alloc new settings if using non-default */
     if (dev->baudrate == at45db_default_settings.baudrate) {
         dev->settings = &at45db_default_settings;
@@ -29,32 +29,29 @@
 #define EDEV_TO_CRYPTO(dev) (struct eflash_crypto_dev *)(dev)
 #define ENC_FLASH_NONCE "mynewtencfla"
 
-static void
-ef_crypto_get_block(struct eflash_crypto_dev *dev, uint32_t addr, uint8_t *blk)
-{
-    memcpy(blk, ENC_FLASH_NONCE, 12);
-    memcpy(blk + 12, &addr, sizeof(addr));
-
-    crypto_encrypt_aes_ecb(dev->ecd_crypto, dev->ecd_key, 128, blk, blk, 16);
-}
-
-
+/*
+ * Counter blocks for all the blocks are encrypted with one call, letting
+ * hardware process them in one go.
+ */
 void
-enc_flash_crypt_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
-                     const uint8_t *src, uint8_t *tgt, int off, int cnt)
+enc_flash_keystream_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
+                         uint8_t *ks, int nblks)
 {
     struct eflash_crypto_dev *dev = EDEV_TO_CRYPTO(edev);
-    uint8_t blk[ENC_FLASH_BLK];
-    uint8_t *b;
+    uint8_t *blk;
     int i;
 
     assert(dev->ecd_crypto);
 
-    ef_crypto_get_block(dev, blk_addr, blk);
-    b = &blk[off];
-    for (i = 0 ; i < cnt; i++) {
-        *tgt++ = *b++ ^ *src++;
+    blk = ks;
+    for (i = 0; i < nblks; i++) {
+        memcpy(blk, ENC_FLASH_NONCE, 12);
+        memcpy(blk + 12, &blk_addr, sizeof(blk_addr));
+        blk += ENC_FLASH_BLK;
+        blk_addr += ENC_FLASH_BLK;
     }
+    crypto_encrypt_aes_ecb(dev->ecd_crypto, dev->ecd_key, 128, ks, ks,
+                           nblks * ENC_FLASH_BLK);
 }
 
 void
@@ -33,25 +33,31 @@
 #define EDEV_TO_DA1469X(dev)   (struct eflash_da1469x_dev *)dev
 #define DA1469X_AES_KEYSIZE 256
 
+/*
+ * Keystream of a block is its AES-CTR counter block, index of the block
+ * within flash, through AES. All the counter blocks are encrypted with one
+ * ECB call, which gives the same keystream as one CTR call per block.
+ */
 void
-enc_flash_crypt_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
-                     const uint8_t *src, uint8_t *tgt, int off, int cnt)
+enc_flash_keystream_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
+                         uint8_t *ks, int nblks)
 {
     struct eflash_da1469x_dev *dev = EDEV_TO_DA1469X(edev);
     const struct hal_flash *h_dev = edev->efd_hwdev;
     uint32_t ctr[4] = {0};
-    uint8_t blk[ENC_FLASH_BLK] = {0};
     const void *key = (void *)MCU_OTPM_BASE + OTP_SEGMENT_USER_DATA_KEYS +
                       (AES_MAX_KEY_LEN * (MYNEWT_VAL(USER_AES_SLOT)));
+    int i;
 
     ctr[0] = (uint32_t) ((blk_addr - h_dev->hf_base_addr) / ENC_FLASH_BLK);
-
-    memcpy(blk + off, src, cnt);
+    for (i = 0; i < nblks; i++) {
+        memcpy(ks + i * ENC_FLASH_BLK, ctr, sizeof(ctr));
+        ctr[0]++;
+    }
     os_sem_pend(&dev->ef_sem, OS_TIMEOUT_NEVER);
-    crypto_encrypt_aes_ctr(dev->ecd_crypto, key, DA1469X_AES_KEYSIZE, ctr,
-                            blk, blk, AES_BLOCK_LEN);
+    crypto_encrypt_aes_ecb(dev->ecd_crypto, key, DA1469X_AES_KEYSIZE,
+                           ks, ks, nblks * ENC_FLASH_BLK);
     os_sem_release(&dev->ef_sem);
-    memcpy(tgt, blk + off, cnt);
 }
 
 /* Key is securely DMA transferred from OTP user data key slot */
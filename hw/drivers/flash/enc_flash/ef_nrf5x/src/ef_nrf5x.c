@@ -76,21 +76,23 @@ out:
 }
 
 void
-enc_flash_crypt_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
-                     const uint8_t *src, uint8_t *tgt, int off, int cnt)
+enc_flash_keystream_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
+                         uint8_t *ks, int nblks)
 {
     struct eflash_nrf5x_dev *dev = EDEV_TO_NRF5X(edev);
     int sr;
     uint8_t *blk;
     int i;
 
-    __HAL_DISABLE_INTERRUPTS(sr);
-    blk = nrf5x_get_block(dev, blk_addr);
-    blk += off;
-    for (i = 0 ; i < cnt; i++) {
-        *tgt++ = *blk++ ^ *src++;
+    /* ECB peripheral does one block at a time. */
+    for (i = 0; i < nblks; i++) {
+        __HAL_DISABLE_INTERRUPTS(sr);
+        blk = nrf5x_get_block(dev, blk_addr);
+        memcpy(ks, blk, ENC_FLASH_BLK);
+        __HAL_ENABLE_INTERRUPTS(sr);
+        ks += ENC_FLASH_BLK;
+        blk_addr += ENC_FLASH_BLK;
     }
-    __HAL_ENABLE_INTERRUPTS(sr);
 }
 
 void
@@ -23,6 +23,7 @@
 /*
  * Encrypting flash driver using AES from Tinycrypt
  */
+#include <tinycrypt/aes.h>
 #include <enc_flash/enc_flash.h>
 
 #ifdef __cplusplus
@@ -34,7 +35,7 @@ extern "C" {
  */
 struct eflash_tinycrypt_dev {
     struct enc_flash_dev etd_dev;
-    uint8_t etd_key[ENC_FLASH_BLK];
+    struct tc_aes_key_sched_struct etd_sched;
 };
 
 #ifdef __cplusplus
@@ -30,31 +30,19 @@
 #define EDEV_TO_TC(dev) (struct eflash_tinycrypt_dev *)(edev)
 #define ENC_FLASH_NONCE "mynewtencfla"
 
-static void
-ef_tc_get_block(struct eflash_tinycrypt_dev *dev, uint32_t addr, uint8_t *blk)
-{
-    struct tc_aes_key_sched_struct ctx;
-
-    memcpy(blk, ENC_FLASH_NONCE, 12);
-    memcpy(blk + 12, &addr, sizeof(addr));
-
-    tc_aes128_set_encrypt_key(&ctx, dev->etd_key);
-    tc_aes_encrypt(blk, blk, &ctx);
-}
-
 void
-enc_flash_crypt_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
-                     const uint8_t *src, uint8_t *tgt, int off, int cnt)
+enc_flash_keystream_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
+                         uint8_t *ks, int nblks)
 {
     struct eflash_tinycrypt_dev *dev = EDEV_TO_TC(edev);
-    uint8_t blk[ENC_FLASH_BLK];
-    uint8_t *b;
     int i;
 
-    ef_tc_get_block(dev, blk_addr, blk);
-    b = &blk[off];
-    for (i = 0 ; i < cnt; i++) {
-        *tgt++ = *b++ ^ *src++;
+    for (i = 0; i < nblks; i++) {
+        memcpy(ks, ENC_FLASH_NONCE, 12);
+        memcpy(ks + 12, &blk_addr, sizeof(blk_addr));
+        tc_aes_encrypt(ks, ks, &dev->etd_sched);
+        ks += ENC_FLASH_BLK;
+        blk_addr += ENC_FLASH_BLK;
     }
 }
 
@@ -63,7 +51,7 @@ enc_flash_setkey_arch(struct enc_flash_dev *edev, uint8_t *key)
 {
     struct eflash_tinycrypt_dev *dev = EDEV_TO_TC(edev);
 
-    memcpy(dev->etd_key, key, ENC_FLASH_BLK);
+    tc_aes128_set_encrypt_key(&dev->etd_sched, key);
 }
 
 int
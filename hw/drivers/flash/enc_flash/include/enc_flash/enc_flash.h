@@ -20,6 +20,7 @@
 #ifndef __ENC_FLASH_H__
 #define __ENC_FLASH_H__
 
+#include <syscfg/syscfg.h>
 #include <hal/hal_flash_int.h>
 
 #ifdef __cplusplus
@@ -28,9 +29,22 @@ extern "C" {
 
 #define ENC_FLASH_BLK  16 /* AES128 */
 
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+/*
+ * Keystream of recently used block.
+ */
+struct enc_flash_cache_blk {
+    uint32_t efc_addr;
+    uint8_t efc_ks[ENC_FLASH_BLK];
+};
+#endif
+
 struct enc_flash_dev {
     struct hal_flash efd_hal;
     const struct hal_flash *efd_hwdev; /* pointer to underlying hw dev */
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+    struct enc_flash_cache_blk efd_cache[MYNEWT_VAL(ENC_FLASH_CACHE_BLKS)];
+#endif
 };
 
 extern const struct hal_flash_funcs enc_flash_funcs;
@@ -30,9 +30,10 @@ int enc_flash_init_arch(struct enc_flash_dev *edev);
 void enc_flash_setkey_arch(struct enc_flash_dev *edev, uint8_t *key);
 
 /*
- * Platform specific encrypt/decrypt function.
+ * Platform specific keystream generation. Fills ks with keystream of
+ * nblks consecutive blocks, starting from block at blk_addr.
  */
-void enc_flash_crypt_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
-                          const uint8_t *src, uint8_t *tgt, int off, int cnt);
+void enc_flash_keystream_arch(struct enc_flash_dev *edev, uint32_t blk_addr,
+                              uint8_t *ks, int nblks);
 
 #endif
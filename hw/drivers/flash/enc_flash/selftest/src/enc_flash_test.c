@@ -59,6 +59,7 @@ TEST_SUITE(enc_flash_test_all)
     enc_flash_test_hal();
     enc_flash_test_flash_map();
     enc_flash_test_fcb();
+    enc_flash_test_batch();
 }
 
 int
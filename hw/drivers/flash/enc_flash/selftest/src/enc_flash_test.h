@@ -28,6 +28,7 @@
 TEST_CASE_DECL(enc_flash_test_hal)
 TEST_CASE_DECL(enc_flash_test_flash_map)
 TEST_CASE_DECL(enc_flash_test_fcb)
+TEST_CASE_DECL(enc_flash_test_batch)
 
 extern struct flash_area enc_test_flash_areas[4];
 
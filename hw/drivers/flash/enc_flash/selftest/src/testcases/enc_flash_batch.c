@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include <hal/hal_flash.h>
+#include <flash_map/flash_map.h>
+
+#include "enc_flash_test.h"
+
+/*
+ * Unaligned accesses spanning multiple keystream batches.
+ */
+TEST_CASE_SELF(enc_flash_test_batch)
+{
+    struct flash_area *fa;
+    uint8_t writedata[700];
+    uint8_t readdata[700];
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    fa = enc_test_flash_areas;
+
+    rc = hal_flash_erase(fa->fa_id, fa->fa_off, fa->fa_size);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < sizeof(writedata); i++) {
+        writedata[i] = i * 7 + 3;
+    }
+
+    /* Written in pieces, starting mid block. */
+    rc = hal_flash_write(fa->fa_id, fa->fa_off + 5, writedata, 3);
+    TEST_ASSERT(rc == 0);
+    rc = hal_flash_write(fa->fa_id, fa->fa_off + 8, writedata + 3, 400);
+    TEST_ASSERT(rc == 0);
+    rc = hal_flash_write(fa->fa_id, fa->fa_off + 408, writedata + 403,
+                         sizeof(writedata) - 403);
+    TEST_ASSERT(rc == 0);
+
+    rc = hal_flash_read(fa->fa_id, fa->fa_off + 5, readdata,
+                        sizeof(readdata));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!memcmp(writedata, readdata, sizeof(readdata)));
+
+    /* Read back at different offsets, twice to hit cached keystream. */
+    for (i = 0; i < 2; i++) {
+        for (off = 0; off < sizeof(writedata); off += 37) {
+            len = sizeof(writedata) - off;
+            if (len > 150) {
+                len = 150;
+            }
+            memset(readdata, 0, len);
+            rc = hal_flash_read(fa->fa_id, fa->fa_off + 5 + off, readdata,
+                                len);
+            TEST_ASSERT(rc == 0);
+            TEST_ASSERT(!memcmp(writedata + off, readdata, len));
+        }
+    }
+}
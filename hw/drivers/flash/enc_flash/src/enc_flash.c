@@ -48,6 +48,151 @@ const struct hal_flash_funcs enc_flash_funcs = {
     .hff_init         = enc_flash_init,
 };
 
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+/* Block addresses are aligned, so this never matches. */
+#define ENC_FLASH_CACHE_INVALID 1
+
+static void
+enc_flash_cache_invalidate(struct enc_flash_dev *dev)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(ENC_FLASH_CACHE_BLKS); i++) {
+        dev->efd_cache[i].efc_addr = ENC_FLASH_CACHE_INVALID;
+    }
+}
+
+static struct enc_flash_cache_blk *
+enc_flash_cache_blk(struct enc_flash_dev *dev, uint32_t blk_addr)
+{
+    return &dev->efd_cache[(blk_addr / ENC_FLASH_BLK) %
+                           MYNEWT_VAL(ENC_FLASH_CACHE_BLKS)];
+}
+
+static int
+enc_flash_cache_get(struct enc_flash_dev *dev, uint32_t blk_addr,
+                    uint8_t *ks)
+{
+    struct enc_flash_cache_blk *efc;
+    os_sr_t sr;
+    int hit;
+
+    efc = enc_flash_cache_blk(dev, blk_addr);
+    OS_ENTER_CRITICAL(sr);
+    hit = efc->efc_addr == blk_addr;
+    if (hit) {
+        memcpy(ks, efc->efc_ks, ENC_FLASH_BLK);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return hit;
+}
+
+static void
+enc_flash_cache_put(struct enc_flash_dev *dev, uint32_t blk_addr,
+                    const uint8_t *ks)
+{
+    struct enc_flash_cache_blk *efc;
+    os_sr_t sr;
+
+    efc = enc_flash_cache_blk(dev, blk_addr);
+    OS_ENTER_CRITICAL(sr);
+    efc->efc_addr = blk_addr;
+    memcpy(efc->efc_ks, ks, ENC_FLASH_BLK);
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+/*
+ * Get keystream for nblks blocks starting at blk_addr. Blocks missing
+ * from cache are generated with as few calls to backend as possible.
+ */
+static void
+enc_flash_keystream(struct enc_flash_dev *dev, uint32_t blk_addr,
+                    uint8_t *ks, int nblks)
+{
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+    int i;
+    int j;
+    int k;
+
+    i = 0;
+    while (i < nblks) {
+        if (enc_flash_cache_get(dev, blk_addr + i * ENC_FLASH_BLK,
+                                ks + i * ENC_FLASH_BLK)) {
+            i++;
+            continue;
+        }
+        for (j = i + 1; j < nblks; j++) {
+            if (enc_flash_cache_get(dev, blk_addr + j * ENC_FLASH_BLK,
+                                    ks + j * ENC_FLASH_BLK)) {
+                break;
+            }
+        }
+        enc_flash_keystream_arch(dev, blk_addr + i * ENC_FLASH_BLK,
+                                 ks + i * ENC_FLASH_BLK, j - i);
+        for (k = i; k < j; k++) {
+            enc_flash_cache_put(dev, blk_addr + k * ENC_FLASH_BLK,
+                                ks + k * ENC_FLASH_BLK);
+        }
+        /* Block j, if any, came from cache. */
+        i = j + 1;
+    }
+#else
+    enc_flash_keystream_arch(dev, blk_addr, ks, nblks);
+#endif
+}
+
+/*
+ * Encrypt/decrypt len bytes at flash address addr from src to tgt. Calls
+ * cb, if set, for every chunk of up to ENC_FLASH_BATCH_BLKS blocks.
+ */
+static int
+enc_flash_crypt(struct enc_flash_dev *dev, uint32_t addr, const uint8_t *src,
+                uint8_t *tgt, uint32_t len,
+                int (*cb)(struct enc_flash_dev *dev, uint32_t addr,
+                          const uint8_t *buf, uint32_t len))
+{
+    uint8_t ks[MYNEWT_VAL(ENC_FLASH_BATCH_BLKS) * ENC_FLASH_BLK];
+    uint32_t blk_addr;
+    uint32_t off;
+    uint32_t cnt;
+    uint32_t i;
+    int nblks;
+    int rc;
+
+    blk_addr = addr & ~(ENC_FLASH_BLK - 1);
+    off = addr - blk_addr;
+    while (len) {
+        nblks = (off + len + ENC_FLASH_BLK - 1) / ENC_FLASH_BLK;
+        if (nblks > MYNEWT_VAL(ENC_FLASH_BATCH_BLKS)) {
+            nblks = MYNEWT_VAL(ENC_FLASH_BATCH_BLKS);
+        }
+        enc_flash_keystream(dev, blk_addr, ks, nblks);
+
+        cnt = nblks * ENC_FLASH_BLK - off;
+        if (cnt > len) {
+            cnt = len;
+        }
+        for (i = 0; i < cnt; i++) {
+            tgt[i] = src[i] ^ ks[off + i];
+        }
+        if (cb) {
+            rc = cb(dev, blk_addr + off, tgt, cnt);
+            if (rc) {
+                return rc;
+            }
+        } else {
+            tgt += cnt;
+        }
+        src += cnt;
+        len -= cnt;
+        blk_addr += nblks * ENC_FLASH_BLK;
+        off = 0;
+    }
+    return 0;
+}
+
 /*
  * Read first all the data in to provided memory area, then apply the
  * cipher -> text conversion.
@@ -57,10 +202,7 @@ enc_flash_read(const struct hal_flash *h_dev, uint32_t addr, void *buf,
                uint32_t len)
 {
     struct enc_flash_dev *dev = HAL_TO_ENC(h_dev);
-    uint8_t *bufb = buf;
-    int i;
-    int blk_end;
-    int rc = 0;
+    int rc;
 
     h_dev = dev->efd_hwdev;
 
@@ -68,67 +210,29 @@ enc_flash_read(const struct hal_flash *h_dev, uint32_t addr, void *buf,
     if (rc) {
         return rc;
     }
-    i = addr & (ENC_FLASH_BLK - 1);
-    addr &= ~(ENC_FLASH_BLK - 1);
-    blk_end = ENC_FLASH_BLK;
-    if (blk_end > i + len) {
-        blk_end = i + len;
-    }
-    while (1) {
-        enc_flash_crypt_arch(dev, addr, bufb, bufb, i, blk_end - i);
-        len -= (blk_end - i);
-        bufb += (blk_end - i);
-        if (len == 0) {
-            break;
-        }
-        i = 0;
-        addr += ENC_FLASH_BLK;
-        blk_end = ENC_FLASH_BLK;
-        if (blk_end > len) {
-            blk_end = len;
-        }
-    }
-    return rc;
+    return enc_flash_crypt(dev, addr, buf, buf, len, NULL);
 }
 
+static int
+enc_flash_write_hw(struct enc_flash_dev *dev, uint32_t addr,
+                   const uint8_t *buf, uint32_t len)
+{
+    const struct hal_flash *h_dev = dev->efd_hwdev;
+
+    return h_dev->hf_itf->hff_write(h_dev, addr, buf, len);
+}
+
+/*
+ * Encrypt data a batch at a time, writing each batch out to flash.
+ */
 static int
 enc_flash_write(const struct hal_flash *h_dev, uint32_t addr,
                 const void *buf, uint32_t len)
 {
     struct enc_flash_dev *dev = HAL_TO_ENC(h_dev);
-    const uint8_t *bufb = buf;
-    int i;
-    int blksz;
-    int rc = 0;
-    uint8_t ctext[ENC_FLASH_BLK];
+    uint8_t ctext[MYNEWT_VAL(ENC_FLASH_BATCH_BLKS) * ENC_FLASH_BLK];
 
-    h_dev = dev->efd_hwdev;
-
-    i = addr & (ENC_FLASH_BLK - 1);
-    blksz = ENC_FLASH_BLK - i;
-    if (blksz > len) {
-        blksz = len;
-    }
-    while (1) {
-        enc_flash_crypt_arch(dev, addr & ~(ENC_FLASH_BLK - 1), bufb, ctext,
-                             i, blksz);
-        len -= blksz;
-        bufb += blksz;
-        rc = h_dev->hf_itf->hff_write(h_dev, addr, ctext, blksz);
-        if (rc) {
-            return rc;
-        }
-        if (len == 0) {
-            break;
-        }
-        i = 0;
-        addr += blksz;
-        blksz = ENC_FLASH_BLK;
-        if (blksz > len) {
-            blksz = len;
-        }
-    }
-    return rc;
+    return enc_flash_crypt(dev, addr, buf, ctext, len, enc_flash_write_hw);
 }
 
 static int
@@ -185,6 +289,9 @@ void
 enc_flash_setkey(struct hal_flash *h_dev, uint8_t *key)
 {
     enc_flash_setkey_arch(HAL_TO_ENC(h_dev), key);
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+    enc_flash_cache_invalidate(HAL_TO_ENC(h_dev));
+#endif
 }
 
 static int
@@ -200,6 +307,9 @@ enc_flash_init(const struct hal_flash *h_dev)
     dev->efd_hal.hf_align = h_dev->hf_align;
     dev->efd_hal.hf_erased_val = h_dev->hf_erased_val;
 
+#if MYNEWT_VAL(ENC_FLASH_CACHE_BLKS) > 0
+    enc_flash_cache_invalidate(dev);
+#endif
     enc_flash_init_arch(dev);
 
     return 0;
@@ -37,6 +37,13 @@
 extern "C" {
 #endif
 
+/* Erase can run asynchronously through hal_flash_submit() */
+#define SPIFLASH_ASYNC \
+    (MYNEWT_VAL(HAL_FLASH_ASYNC) && MYNEWT_VAL(OS_SCHEDULING))
+/* Driver lock is not held while waiting for erase */
+#define SPIFLASH_ERASE_UNLOCKED \
+    (MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND) || SPIFLASH_ASYNC)
+
 /*
  * Structure to hold typical and maximum time as stated in chip datasheet.
  * Values are used for timeouts and are specified in micro seconds.
@@ -74,6 +81,16 @@ STATS_SECT_END
 #define SPIFLASH_STATS_INCN(__sectvarname, __var, __n)  do {} while (0)
 #endif
 
+#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+struct spiflash_cache_line {
+    /* Flash address of first cached byte, 0xFFFFFFFF if line is empty */
+    uint32_t addr;
+    /* Value of cache_stamp when line was last used (for LRU) */
+    uint32_t used;
+    uint8_t data[MYNEWT_VAL(SPIFLASH_CACHE_SIZE)];
+};
+#endif
+
 struct spiflash_dev {
     struct hal_flash hal;
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
@@ -92,6 +109,10 @@ struct spiflash_dev {
     /* Pointer to one of the supported chips */
     const struct spiflash_chip *flash_chip;
     const struct spiflash_characteristics *characteristics;
+    /* Read command selected by spiflash_identify() */
+    uint8_t read_cmd;
+    /* Number of dummy bytes sent after address for read_cmd */
+    uint8_t read_dummy;
 #if MYNEWT_VAL(OS_SCHEDULING)
     struct os_mutex lock;
 #endif
@@ -102,9 +123,33 @@ struct spiflash_dev {
 #endif
     bool pd_active;                 /* Power down active */
 #endif
+#if SPIFLASH_ERASE_UNLOCKED
+    /* Erase/program suspend and resume commands, 0 if not supported */
+    uint8_t suspend_cmd;
+    uint8_t resume_cmd;
+    /* Erase in progress, lock is not held while waiting for it */
+    bool erase_active;
+    /* Range being erased, reads from it wait for erase to finish */
+    uint32_t erase_addr;
+    uint32_t erase_len;
+    /* Time of last suspend and resume (os_cputime ticks) */
+    uint32_t erase_suspend_time;
+    uint32_t erase_resume_time;
+    /* Total time current erase spent suspended */
+    uint32_t erase_suspended_us;
+#endif
+#if SPIFLASH_ASYNC
+    /* Asynchronous erase in progress, erased one block at a time */
+    struct hal_flash_req *async_req;
+    uint32_t async_addr;
+    uint32_t async_end;
+    uint32_t async_start_time;
+    const struct spiflash_time_spec *async_spec;
+    struct os_callout async_co;
+#endif
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-    uint32_t cached_addr;
-    uint8_t cache[MYNEWT_VAL(SPIFLASH_CACHE_SIZE)];
+    uint32_t cache_stamp;
+    struct spiflash_cache_line cache[MYNEWT_VAL(SPIFLASH_CACHE_LINES)];
 #endif
 #if MYNEWT_VAL(SPIFLASH_STAT)
     STATS_SECT_DECL(spiflash_stats_section) stats;
@@ -127,6 +172,10 @@ extern struct spiflash_dev spiflash_dev;
 #define SPIFLASH_RELEASE_POWER_DOWN         0xAB
 #define SPIFLASH_READ_MANUFACTURER_ID       0x90
 #define SPIFLASH_READ_JEDEC_ID              0x9F
+#define SPIFLASH_ERASE_SUSPEND_CMD          0x75
+#define SPIFLASH_ERASE_RESUME_CMD           0x7A
+#define SPIFLASH_ERASE_SUSPEND_CMD_MX       0xB0
+#define SPIFLASH_ERASE_RESUME_CMD_MX        0x30
 
 #define SPIFLASH_STATUS_BUSY                0x01
 #define SPIFLASH_STATUS_WRITE_ENABLE        0x02
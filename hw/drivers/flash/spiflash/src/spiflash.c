@@ -613,6 +613,10 @@ static int hal_spiflash_sector_info(const struct hal_flash *hal_flash_dev, int i
 static int hal_spiflash_init(const struct hal_flash *dev);
 static int hal_spiflash_erase(const struct hal_flash *hal_flash_dev,
         uint32_t address, uint32_t sz);
+#if SPIFLASH_ASYNC
+static int hal_spiflash_submit(const struct hal_flash *hal_flash_dev,
+        struct hal_flash_req *req);
+#endif
 
 static const struct hal_flash_funcs spiflash_flash_funcs = {
     .hff_read         = hal_spiflash_read,
@@ -621,6 +625,9 @@ static const struct hal_flash_funcs spiflash_flash_funcs = {
     .hff_sector_info  = hal_spiflash_sector_info,
     .hff_init         = hal_spiflash_init,
     .hff_erase        = hal_spiflash_erase,
+#if SPIFLASH_ASYNC
+    .hff_submit       = hal_spiflash_submit,
+#endif
 };
 
 static const struct spiflash_characteristics spiflash_characteristics = {
@@ -857,7 +864,11 @@ spiflash_apd_tmo_func(struct os_event *ev)
 
     spiflash_lock_no_apd(dev);
 
-    if (dev->apd_tmo && !dev->pd_active) {
+    if (dev->apd_tmo && !dev->pd_active
+#if SPIFLASH_ERASE_UNLOCKED
+        && !dev->erase_active
+#endif
+        ) {
         spiflash_power_down(dev);
     }
 
@@ -1015,18 +1026,259 @@ spiflash_write_enable(struct spiflash_dev *dev)
     return 0;
 }
 
+#if SPIFLASH_ERASE_UNLOCKED
+static void
+spiflash_send_cmd(struct spiflash_dev *dev, uint8_t cmd)
+{
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, &cmd, 1);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_tx_val(dev->spi_num, cmd);
+
+    spiflash_cs_deactivate(dev);
+#endif
+}
+
+/*
+ * Waits until erase started by other task is finished. Lock is released
+ * while waiting so erasing task can poll status.
+ * Caller must hold the lock.
+ */
+static void
+spiflash_erase_wait_done(struct spiflash_dev *dev)
+{
+    while (dev->erase_active) {
+        spiflash_unlock_no_apd(dev);
+        spiflash_delay_us(MYNEWT_VAL(SPIFLASH_ERASE_POLL_INTERVAL));
+        spiflash_lock_no_apd(dev);
+    }
+}
+
+/*
+ * Suspends erase in progress so data outside of erased range can be read.
+ * Returns true if suspend command was sent and spiflash_erase_resume()
+ * must be called after the read.
+ * Caller must hold the lock.
+ */
+static bool
+spiflash_erase_suspend(struct spiflash_dev *dev, uint32_t addr, uint32_t len)
+{
+    uint32_t since_resume;
+
+    if (!dev->erase_active || dev->ready) {
+        return false;
+    }
+
+    if (dev->suspend_cmd == 0 ||
+        (addr < dev->erase_addr + dev->erase_len &&
+         dev->erase_addr < addr + len)) {
+        /* Part can't suspend or data is being erased, wait for the erase */
+        spiflash_erase_wait_done(dev);
+        return false;
+    }
+
+    /* Give erase some time to progress since last resume */
+    since_resume = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                             dev->erase_resume_time);
+    if (since_resume < MYNEWT_VAL(SPIFLASH_SUSPEND_INTERVAL)) {
+        os_cputime_delay_usecs(MYNEWT_VAL(SPIFLASH_SUSPEND_INTERVAL) -
+                               since_resume);
+    }
+
+    spiflash_send_cmd(dev, dev->suspend_cmd);
+    dev->erase_suspend_time = os_cputime_get32();
+
+    return true;
+}
+
+/* Resumes erase suspended by spiflash_erase_suspend(). */
+static void
+spiflash_erase_resume(struct spiflash_dev *dev)
+{
+    uint32_t now;
+
+    /* Resume is ignored if erase finished before it was suspended */
+    spiflash_send_cmd(dev, dev->resume_cmd);
+
+    now = os_cputime_get32();
+    dev->erase_resume_time = now;
+    dev->erase_suspended_us +=
+        os_cputime_ticks_to_usecs(now - dev->erase_suspend_time);
+    /* Erase is running again, or finished, erasing task will find out */
+    dev->ready = false;
+}
+
+#endif
+
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+/*
+ * Waits for erase started by spiflash_execute_erase() without holding
+ * the lock, reads from other tasks suspend the erase in the meantime.
+ * Time erase spent suspended does not count towards the timeout.
+ * Caller must hold the lock.
+ */
+static int
+spiflash_erase_wait(struct spiflash_dev *dev,
+                    const struct spiflash_time_spec *delay_spec)
+{
+    uint32_t start_time;
+    uint32_t elapsed_us;
+    uint32_t step_us;
+    int rc = -1;
+
+    dev->erase_suspended_us = 0;
+    dev->erase_resume_time = os_cputime_get32();
+    dev->erase_active = true;
+
+    step_us = (delay_spec->maximum - delay_spec->typical) / 50;
+    if (step_us < MYNEWT_VAL(SPIFLASH_ERASE_POLL_INTERVAL)) {
+        step_us = MYNEWT_VAL(SPIFLASH_ERASE_POLL_INTERVAL);
+    }
+
+    start_time = os_cputime_get32();
+    /* Wait typical erase time before starting polling for ready */
+    spiflash_unlock_no_apd(dev);
+    spiflash_delay_us(delay_spec->typical);
+    spiflash_lock_no_apd(dev);
+
+    for (;;) {
+        if (spiflash_device_ready(dev)) {
+            rc = 0;
+            break;
+        }
+        elapsed_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                               start_time);
+        if (elapsed_us - dev->erase_suspended_us > delay_spec->maximum) {
+            break;
+        }
+        spiflash_unlock_no_apd(dev);
+        spiflash_delay_us(step_us);
+        spiflash_lock_no_apd(dev);
+    }
+
+    dev->erase_active = false;
+
+    return rc;
+}
+#endif
+
+/*
+ * Reads data from flash using command selected during identification.
+ * Caller must hold the lock and wait for the device to be ready.
+ */
+static void
+spiflash_read_data(struct spiflash_dev *dev, uint32_t addr, void *buf,
+                   uint32_t len)
+{
+    uint8_t cmd[5] = { dev->read_cmd,
+        (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr), 0xFF };
+    int cmd_len = 4 + dev->read_dummy;
+
+    if (cmd[0] == 0) {
+        /* Not identified yet */
+        cmd[0] = SPIFLASH_READ;
+        cmd_len = 4;
+    }
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write_read_transact((struct os_dev *)&dev->dev,
+        &cmd, cmd_len, buf, len);
+#else
+    spiflash_cs_activate(dev);
+
+    /* Send command + address (+ dummy byte for fast read) */
+    hal_spi_txrx(dev->spi_num, cmd, NULL, cmd_len);
+    /* For security mostly, do not output random data, fill it with FF */
+    memset(buf, 0xFF, len);
+    /* Tx buf does not matter, for simplicity pass read buffer */
+    hal_spi_txrx(dev->spi_num, buf, buf, len);
+
+    spiflash_cs_deactivate(dev);
+#endif
+    SPIFLASH_STATS_INCN(dev->stats, read_bytes, len);
+}
+
+#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+static void
+spiflash_cache_invalidate(struct spiflash_dev *dev, uint32_t addr,
+                          uint32_t len)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(SPIFLASH_CACHE_LINES); ++i) {
+        if (dev->cache[i].addr != 0xFFFFFFFF &&
+            dev->cache[i].addr < addr + len &&
+            addr < dev->cache[i].addr + MYNEWT_VAL(SPIFLASH_CACHE_SIZE)) {
+            dev->cache[i].addr = 0xFFFFFFFF;
+        }
+    }
+}
+
+static void
+spiflash_cache_invalidate_all(struct spiflash_dev *dev)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(SPIFLASH_CACHE_LINES); ++i) {
+        dev->cache[i].addr = 0xFFFFFFFF;
+    }
+}
+
+/* Returns line that contains addr or NULL */
+static struct spiflash_cache_line *
+spiflash_cache_find(struct spiflash_dev *dev, uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(SPIFLASH_CACHE_LINES); ++i) {
+        if (dev->cache[i].addr != 0xFFFFFFFF &&
+            dev->cache[i].addr <= addr &&
+            addr < dev->cache[i].addr + MYNEWT_VAL(SPIFLASH_CACHE_SIZE)) {
+            dev->cache[i].used = ++dev->cache_stamp;
+            return &dev->cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns empty or least recently used line */
+static struct spiflash_cache_line *
+spiflash_cache_victim(struct spiflash_dev *dev)
+{
+    struct spiflash_cache_line *line;
+    int i;
+
+    line = &dev->cache[0];
+    for (i = 0; i < MYNEWT_VAL(SPIFLASH_CACHE_LINES); ++i) {
+        if (dev->cache[i].addr == 0xFFFFFFFF) {
+            line = &dev->cache[i];
+            break;
+        }
+        if ((int32_t)(dev->cache[i].used - line->used) < 0) {
+            line = &dev->cache[i];
+        }
+    }
+    line->used = ++dev->cache_stamp;
+
+    return line;
+}
+#endif
+
 static int
 hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *buf,
                   uint32_t len)
 {
     int err = 0;
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+    struct spiflash_cache_line *line;
     uint32_t cached_size;
-    uint8_t *user_buf;
-    uint32_t left;
 #endif
-    uint8_t cmd[] = { SPIFLASH_READ,
-        (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr) };
+#if SPIFLASH_ERASE_UNLOCKED
+    bool suspended;
+#endif
     struct spiflash_dev *dev;
 
     dev = (struct spiflash_dev *)hal_flash_dev;
@@ -1035,74 +1287,57 @@ hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *bu
 
     SPIFLASH_STATS_INC(dev->stats, read_count);
 
+#if SPIFLASH_ERASE_UNLOCKED
+    suspended = spiflash_erase_suspend(dev, addr, len);
+#endif
+
     err = spiflash_wait_ready(dev, 100);
     if (!err) {
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-        if ((dev->cached_addr <= addr) &&
-            (addr < dev->cached_addr + MYNEWT_VAL(SPIFLASH_CACHE_SIZE))) {
-            /* Check if everything is cached */
-            if (len < MYNEWT_VAL(SPIFLASH_CACHE_SIZE) -
-                      (addr - dev->cached_addr)) {
-                /* Everything  was cached */
-                memcpy(buf, dev->cache + addr - dev->cached_addr, len);
-                len = 0;
-            } else {
-                /* Some data was cached */
-                cached_size = MYNEWT_VAL(SPIFLASH_CACHE_SIZE) -
-                    (addr - dev->cached_addr);
-                memcpy(buf, dev->cache + addr - dev->cached_addr, cached_size);
-                len -= cached_size;
-                buf = (uint8_t *)buf + cached_size;
-                addr += cached_size;
-                cmd[1] = (uint8_t)(addr >> 16);
-                cmd[2] = (uint8_t)(addr >> 8);
-                cmd[3] = (uint8_t)(addr);
+        /* Take as much as possible from cache lines */
+        while (len > 0 && (line = spiflash_cache_find(dev, addr)) != NULL) {
+            cached_size = MYNEWT_VAL(SPIFLASH_CACHE_SIZE) - (addr - line->addr);
+            if (cached_size > len) {
+                cached_size = len;
             }
+            memcpy(buf, line->data + addr - line->addr, cached_size);
+            len -= cached_size;
+            buf = (uint8_t *)buf + cached_size;
+            addr += cached_size;
         }
-        left = len;
-        user_buf = buf;
-        /*
-         * In case small amount of data was requested use cache buffer for
-         * reading, instead of caller buffer that would be to small.
-         */
         if (len > 0 && len < MYNEWT_VAL(SPIFLASH_CACHE_SIZE)) {
-            len = MYNEWT_VAL(SPIFLASH_CACHE_SIZE);
-            buf = dev->cache;
+            /*
+             * Small amount of data was requested, fill whole line starting
+             * at addr so following sequential reads hit the cache.
+             */
+            line = spiflash_cache_victim(dev);
+            line->addr = 0xFFFFFFFF;
+            spiflash_read_data(dev, addr, line->data,
+                               MYNEWT_VAL(SPIFLASH_CACHE_SIZE));
+            line->addr = addr;
+            memcpy(buf, line->data, len);
+            len = 0;
         }
 #endif
         if (len > 0) {
-#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
-            bus_node_simple_write_read_transact((struct os_dev *)&dev->dev,
-                &cmd, 4, buf, len);
-#else
-            spiflash_cs_activate(dev);
-
-            /* Send command + address */
-            hal_spi_txrx(dev->spi_num, cmd, NULL, sizeof cmd);
-            /* For security mostly, do not output random data, fill it with FF */
-            memset(buf, 0xFF, len);
-            /* Tx buf does not matter, for simplicity pass read buffer */
-            hal_spi_txrx(dev->spi_num, buf, buf, len);
-
-            spiflash_cs_deactivate(dev);
-#endif
+            spiflash_read_data(dev, addr, buf, len);
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-            /* If buffer was too small, cache was used for reading */
-            if (left < MYNEWT_VAL(SPIFLASH_CACHE_SIZE)) {
-                memcpy(user_buf, dev->cache, left);
-                dev->cached_addr = addr;
-            } else {
-                /* Read was done directly to user buffer, copy end to cache */
-                dev->cached_addr = addr + left - MYNEWT_VAL(SPIFLASH_CACHE_SIZE);
-                memcpy(dev->cache, (uint8_t *)buf + left -
-                       MYNEWT_VAL(SPIFLASH_CACHE_SIZE),
-                       MYNEWT_VAL(SPIFLASH_CACHE_SIZE));
-            }
+            /* Read was done directly to user buffer, copy end to cache */
+            line = spiflash_cache_victim(dev);
+            line->addr = addr + len - MYNEWT_VAL(SPIFLASH_CACHE_SIZE);
+            memcpy(line->data, (uint8_t *)buf + len -
+                   MYNEWT_VAL(SPIFLASH_CACHE_SIZE),
+                   MYNEWT_VAL(SPIFLASH_CACHE_SIZE));
 #endif
-            SPIFLASH_STATS_INCN(dev->stats, read_bytes, len);
         }
     }
 
+#if SPIFLASH_ERASE_UNLOCKED
+    if (suspended) {
+        spiflash_erase_resume(dev);
+    }
+#endif
+
     spiflash_unlock(dev);
 
     return 0;
@@ -1125,13 +1360,17 @@ hal_spiflash_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
 
     spiflash_lock(dev);
 
+#if SPIFLASH_ERASE_UNLOCKED
+    spiflash_erase_wait_done(dev);
+#endif
+
     if (spiflash_wait_ready(dev, 100) != 0) {
         rc = -1;
         goto err;
     }
 
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-    dev->cached_addr = 0xFFFFFFFF;
+    spiflash_cache_invalidate(dev, addr, len);
 #endif
 
     pp_time_typical = dev->characteristics->tbp1.typical;
@@ -1206,17 +1445,27 @@ hal_spiflash_erase(const struct hal_flash *hal_flash_dev,
 
 static int
 spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
-                       uint32_t size,
+                       uint32_t size, uint32_t erase_addr, uint32_t erase_len,
                        const struct spiflash_time_spec *delay_spec)
 {
     int rc = 0;
+#if !MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
     uint32_t wait_time_us;
     uint32_t start_time;
+#endif
 
     spiflash_lock(dev);
 
+#if SPIFLASH_ERASE_UNLOCKED
+    spiflash_erase_wait_done(dev);
+#endif
+#if !MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    (void)erase_addr;
+    (void)erase_len;
+#endif
+
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-    dev->cached_addr = 0xFFFFFFFF;
+    spiflash_cache_invalidate_all(dev);
 #endif
 
     if (spiflash_wait_ready(dev, 100) != 0) {
@@ -1240,6 +1489,11 @@ spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
     /* Now we know that device is not ready */
     dev->ready = false;
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    dev->erase_addr = erase_addr;
+    dev->erase_len = erase_len;
+    rc = spiflash_erase_wait(dev, delay_spec);
+#else
     start_time = os_cputime_get32();
     /* Wait typical erase time before starting polling for ready */
     spiflash_delay_us(delay_spec->typical);
@@ -1253,6 +1507,7 @@ spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
 
     /* Poll status ready for remaining time */
     rc = spiflash_wait_ready_till(dev, wait_time_us, wait_time_us / 50);
+#endif
 err:
     spiflash_unlock(dev);
 
@@ -1272,18 +1527,19 @@ hal_spiflash_sector_info(const struct hal_flash *hal_flash_dev, int idx,
 
 static int
 spiflash_erase_cmd(struct spiflash_dev *dev, uint8_t cmd, uint32_t addr,
-                   const struct spiflash_time_spec *time_spec)
+                   uint32_t len, const struct spiflash_time_spec *time_spec)
 {
     uint8_t buf[4] = { cmd, (uint8_t)(addr >> 16U), (uint8_t)(addr >> 8U),
                        (uint8_t)addr };
-    return spiflash_execute_erase(dev, buf, sizeof(buf), time_spec);
+    return spiflash_execute_erase(dev, buf, sizeof(buf), addr & ~(len - 1),
+                                  len, time_spec);
 
 }
 
 int
 spiflash_sector_erase(struct spiflash_dev *dev, uint32_t addr)
 {
-    return spiflash_erase_cmd(dev, SPIFLASH_SECTOR_ERASE, addr,
+    return spiflash_erase_cmd(dev, SPIFLASH_SECTOR_ERASE, addr, 0x1000,
                               &dev->characteristics->tse);
 }
 
@@ -1291,7 +1547,7 @@ spiflash_sector_erase(struct spiflash_dev *dev, uint32_t addr)
 int
 spiflash_block_32k_erase(struct spiflash_dev *dev, uint32_t addr)
 {
-    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_32KB, addr,
+    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_32KB, addr, 0x8000,
                               &dev->characteristics->tbe1);
 }
 #endif
@@ -1300,7 +1556,7 @@ spiflash_block_32k_erase(struct spiflash_dev *dev, uint32_t addr)
 int
 spiflash_block_64k_erase(struct spiflash_dev *dev, uint32_t addr)
 {
-    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_64KB, addr,
+    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_64KB, addr, 0x10000,
                               &dev->characteristics->tbe2);
 }
 #endif
@@ -1310,7 +1566,8 @@ spiflash_chip_erase(struct spiflash_dev *dev)
 {
     uint8_t buf[1] = { SPIFLASH_CHIP_ERASE };
 
-    return spiflash_execute_erase(dev, buf, sizeof(buf),
+    /* Whole chip is erased, reads will wait for erase to finish */
+    return spiflash_execute_erase(dev, buf, sizeof(buf), 0, 0xFFFFFFFF,
                                   &dev->characteristics->tce);
 }
 
@@ -1365,6 +1622,229 @@ err:
     return rc;
 }
 
+#if SPIFLASH_ASYNC
+/*
+ * Sends erase command for the biggest block that fits in remaining range of
+ * asynchronous erase and arms callout to check for its completion.
+ * Caller must hold the lock, device must be ready.
+ */
+static void
+spiflash_async_erase_step(struct spiflash_dev *dev)
+{
+    uint8_t buf[4];
+    uint32_t addr = dev->async_addr;
+    uint32_t size = dev->async_end - addr;
+    uint32_t len;
+    int buf_len = sizeof(buf);
+
+    SPIFLASH_STATS_INC(dev->stats, erase_count);
+
+    if (addr == 0 && size == dev->hal.hf_size) {
+        buf[0] = SPIFLASH_CHIP_ERASE;
+        buf_len = 1;
+        len = size;
+        dev->async_spec = &dev->characteristics->tce;
+#if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_64BK)
+    } else if ((addr & 0xFFFFU) == 0 && (size >= 0x10000)) {
+        buf[0] = SPIFLASH_BLOCK_ERASE_64KB;
+        len = 0x10000;
+        dev->async_spec = &dev->characteristics->tbe2;
+#endif
+#if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_32BK)
+    } else if ((addr & 0x7FFFU) == 0 && (size >= 0x8000)) {
+        buf[0] = SPIFLASH_BLOCK_ERASE_32KB;
+        len = 0x8000;
+        dev->async_spec = &dev->characteristics->tbe1;
+#endif
+    } else {
+        buf[0] = SPIFLASH_SECTOR_ERASE;
+        len = MYNEWT_VAL(SPIFLASH_SECTOR_SIZE);
+        dev->async_spec = &dev->characteristics->tse;
+    }
+    buf[1] = (uint8_t)(addr >> 16U);
+    buf[2] = (uint8_t)(addr >> 8U);
+    buf[3] = (uint8_t)addr;
+
+    spiflash_write_enable(dev);
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, buf, (uint16_t)buf_len);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_txrx(dev->spi_num, buf, NULL, buf_len);
+
+    spiflash_cs_deactivate(dev);
+#endif
+    dev->ready = false;
+
+    dev->erase_addr = addr;
+    dev->erase_len = buf_len == 1 ? 0xFFFFFFFF : len;
+    dev->erase_suspended_us = 0;
+    dev->async_start_time = os_cputime_get32();
+    dev->erase_resume_time = dev->async_start_time;
+    dev->async_addr = size > len ? addr + len : dev->async_end;
+
+    /* Check status after typical erase time */
+    os_callout_reset(&dev->async_co,
+                     os_time_ms_to_ticks32(dev->async_spec->typical / 1000) +
+                     1);
+}
+
+/*
+ * Polls status of asynchronous erase, starts next block or completes
+ * the request.
+ */
+static void
+spiflash_async_tmo_func(struct os_event *ev)
+{
+    struct spiflash_dev *dev = ev->ev_arg;
+    struct hal_flash_req *req;
+    uint32_t elapsed_us;
+    uint32_t step_us;
+    int rc = 0;
+
+    spiflash_lock_no_apd(dev);
+
+    if (!spiflash_device_ready(dev)) {
+        elapsed_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                               dev->async_start_time);
+        if (elapsed_us - dev->erase_suspended_us <=
+            dev->async_spec->maximum) {
+            step_us = (dev->async_spec->maximum -
+                       dev->async_spec->typical) / 50;
+            os_callout_reset(&dev->async_co,
+                             os_time_ms_to_ticks32(step_us / 1000) + 1);
+            spiflash_unlock_no_apd(dev);
+            return;
+        }
+        rc = -1;
+    } else if (dev->async_addr < dev->async_end) {
+        spiflash_async_erase_step(dev);
+        spiflash_unlock_no_apd(dev);
+        return;
+    }
+
+    req = dev->async_req;
+    dev->async_req = NULL;
+    dev->erase_active = false;
+
+    spiflash_unlock_no_apd(dev);
+
+    hal_flash_req_done(req, rc);
+}
+
+static int
+hal_spiflash_submit(const struct hal_flash *hal_flash_dev,
+                    struct hal_flash_req *req)
+{
+    struct spiflash_dev *dev = (struct spiflash_dev *)hal_flash_dev;
+    int rc = 0;
+
+    if (req->hfr_op != HAL_FLASH_OP_ERASE) {
+        /* SPI transfers are short, hal_flash executes them synchronously */
+        return SYS_ENOTSUP;
+    }
+
+    spiflash_lock(dev);
+
+    spiflash_erase_wait_done(dev);
+
+    if (spiflash_wait_ready(dev, 100) != 0) {
+        rc = SYS_EIO;
+        goto err;
+    }
+
+#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+    spiflash_cache_invalidate_all(dev);
+#endif
+
+    dev->async_req = req;
+    dev->async_addr = req->hfr_addr & ~0xFFFU;
+    dev->async_end = req->hfr_addr + req->hfr_len;
+    dev->erase_active = true;
+    spiflash_async_erase_step(dev);
+err:
+    spiflash_unlock(dev);
+
+    return rc;
+}
+#endif
+
+/*
+ * Selects command used for data reads. FAST_READ adds one dummy byte after
+ * address but allows clock higher than READ which is limited to 33-50MHz
+ * on most parts.
+ */
+static void
+spiflash_select_read_cmd(struct spiflash_dev *dev)
+{
+    bool fast = MYNEWT_VAL(SPIFLASH_FAST_READ) == 2;
+    uint32_t freq;
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    freq = dev->dev.freq;
+#else
+    freq = dev->spi_settings.baudrate;
+#endif
+
+    if (MYNEWT_VAL(SPIFLASH_FAST_READ) == 1 &&
+        freq > MYNEWT_VAL(SPIFLASH_READ_MAX_FREQ)) {
+        switch (dev->flash_chip->fc_jedec_id.ji_manufacturer) {
+        case JEDEC_MFC_ISSI:
+        case JEDEC_MFC_WINBOND:
+        case JEDEC_MFC_GIGADEVICE:
+        case JEDEC_MFC_MACRONIX:
+        case JEDEC_MFC_MICRON:
+        case JEDEC_MFC_MICROCHIP:
+        case JEDEC_MFC_ADESTO:
+        case JEDEC_MFC_EON:
+        case JEDEC_MFC_XTX:
+        case JEDEC_MFC_PUYA:
+            fast = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    switch (dev->flash_chip->fc_jedec_id.ji_manufacturer) {
+    case JEDEC_MFC_WINBOND:
+    case JEDEC_MFC_GIGADEVICE:
+    case JEDEC_MFC_MICRON:
+    case JEDEC_MFC_ADESTO:
+    case JEDEC_MFC_XTX:
+    case JEDEC_MFC_PUYA:
+        dev->suspend_cmd = SPIFLASH_ERASE_SUSPEND_CMD;
+        dev->resume_cmd = SPIFLASH_ERASE_RESUME_CMD;
+        break;
+    case JEDEC_MFC_MACRONIX:
+    case JEDEC_MFC_MICROCHIP:
+        dev->suspend_cmd = SPIFLASH_ERASE_SUSPEND_CMD_MX;
+        dev->resume_cmd = SPIFLASH_ERASE_RESUME_CMD_MX;
+        break;
+    default:
+        /* Unknown suspend command, reads wait for erase to finish */
+        dev->suspend_cmd = 0;
+        dev->resume_cmd = 0;
+        break;
+    }
+#elif SPIFLASH_ERASE_UNLOCKED
+    /* Reads wait for asynchronous erase to finish */
+    dev->suspend_cmd = 0;
+    dev->resume_cmd = 0;
+#endif
+
+    if (fast) {
+        dev->read_cmd = SPIFLASH_FAST_READ;
+        dev->read_dummy = 1;
+    } else {
+        dev->read_cmd = SPIFLASH_READ;
+        dev->read_dummy = 0;
+    }
+}
+
 int
 spiflash_identify(struct spiflash_dev *dev)
 {
@@ -1463,6 +1943,9 @@ spiflash_identify(struct spiflash_dev *dev)
             rc = -1;
         }
     }
+    if (dev->flash_chip) {
+        spiflash_select_read_cmd(dev);
+    }
 err:
     spiflash_unlock(dev);
 
@@ -1485,12 +1968,22 @@ hal_spiflash_init(const struct hal_flash *hal_flash_dev)
     assert(rc == 0);
 #endif
 
+#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+    spiflash_cache_invalidate_all(dev);
+#endif
+
 #if MYNEWT_VAL(SPIFLASH_AUTO_POWER_DOWN)
     os_mutex_init(&dev->lock);
+    os_mutex_stats_register(&dev->lock, "spiflash");
     os_callout_init(&dev->apd_tmo_co, os_eventq_dflt_get(),
                     spiflash_apd_tmo_func, dev);
 #endif
 
+#if SPIFLASH_ASYNC
+    os_callout_init(&dev->async_co, os_eventq_dflt_get(),
+                    spiflash_async_tmo_func, dev);
+#endif
+
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
     hal_gpio_init_out(dev->ss_pin, 1);
 
@@ -108,6 +108,7 @@ mbedtls_internal_sha256_process(mbedtls_sha256_context *ctx,
      * needed for building, shouldn't ever be called in practice.
      */
     assert(0);
+    return -1;
 }
 
 #endif /* MYNEWT_VAL(MBEDTLS_SHA256_ALT) */
@@ -21,7 +21,11 @@
 #define _HW_DRIVERS_I2S_H
 
 #include <stdint.h>
+#include <syscfg/syscfg.h>
 #include <os/os_dev.h>
+#if MYNEWT_VAL(I2S_MBUF)
+#include <os/os_mbuf.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +57,10 @@ struct i2s_sample_buffer {
      * For input i2s driver fills this value.
      */
     uint32_t sample_count;
+#if MYNEWT_VAL(I2S_MBUF)
+    /* Internal use, external storage descriptor for i2s_buffer_mbuf() */
+    struct os_mbuf_ext mbuf_ext;
+#endif
 };
 
 struct i2s_buffer_pool {
@@ -96,6 +104,19 @@ enum i2s_direction {
     I2S_OUT_IN,
 };
 
+#if MYNEWT_VAL(I2S_STATS)
+struct i2s_stats {
+    /** Buffers processed by driver */
+    uint32_t buffers;
+    /** Output stream ran out of buffers while running */
+    uint32_t underruns;
+    /** Input stream ran out of buffers while running */
+    uint32_t overruns;
+    /** Highest number of samples queued for driver */
+    uint32_t max_queued_samples;
+};
+#endif
+
 /**
  * I2S device
  */
@@ -110,6 +131,14 @@ struct i2s {
     /* Semaphore holding number of elements in user queue */
     struct os_sem user_queue_buffer_count;
 
+    /* Buffers taken out of circulation to limit buffer depth */
+    STAILQ_HEAD(, i2s_sample_buffer) spare_queue;
+    /* Samples in buffers of driver queue */
+    uint32_t queued_samples;
+#if MYNEWT_VAL(I2S_STATS)
+    struct i2s_stats stats;
+#endif
+
     struct i2s_client *client;
     /* Samples per second. */
     uint32_t sample_rate;
@@ -151,6 +180,12 @@ struct i2s_client {
     i2s_state_change_t state_changed_cb;
     /** Function called when buffer is ready and i2s_buffer_get() will succeed */
     i2s_sample_buffer_ready_t sample_buffer_ready_cb;
+    /**
+     * Number of pool buffers to use, 0 for all.  Fewer buffers in
+     * circulation reduce latency at the cost of tolerance to late
+     * processing.
+     */
+    uint16_t buffer_depth;
 };
 
 /**
@@ -277,6 +312,62 @@ i2s_get_sample_rate(struct i2s *i2s)
     return i2s->sample_rate;
 }
 
+/**
+ * Get time needed to transfer samples already queued for driver.  For output
+ * I2S this is the delay before a buffer put now starts to play, for input
+ * I2S the time before driver runs out of buffers to fill.  Buffer currently
+ * being transferred is not included.  Stereo stream is assumed.
+ *
+ * @param i2s   device to check
+ *
+ * @return latency in microseconds
+ */
+uint32_t i2s_queue_latency_us(struct i2s *i2s);
+
+#if MYNEWT_VAL(I2S_MBUF)
+/**
+ * Wrap sample buffer in a packet header mbuf without copying samples.
+ * Mbuf points at sample_count samples in sample_data; the buffer is given
+ * back with i2s_buffer_put() when last mbuf referencing it is freed (for
+ * output I2S sample_count is cleared first so it is not played).  This
+ * allows samples from microphone to be passed to network stack directly.
+ *
+ * @param i2s     device buffer was obtained from with i2s_buffer_get()
+ * @param buffer  buffer to wrap, must not be used by caller afterwards
+ * @param omp     pool to allocate mbuf from, NULL to use msys
+ *
+ * @return mbuf chain on success, NULL if no mbuf available (buffer is
+ *         still owned by caller then)
+ */
+struct os_mbuf *i2s_buffer_mbuf(struct i2s *i2s,
+                                struct i2s_sample_buffer *buffer,
+                                struct os_mbuf_pool *omp);
+
+/**
+ * Write samples from mbuf chain to output I2S device.  Blocks if sample
+ * buffers are not ready yet.  Data is copied once, directly from mbufs to
+ * sample buffers.
+ *
+ * @param i2s   device to send samples to
+ * @param om    packet header mbuf chain with samples, not freed by this
+ *              function
+ *
+ * @return number of bytes consumed, negative value on error
+ */
+int i2s_write_mbuf(struct i2s *i2s, struct os_mbuf *om);
+#endif
+
+#if MYNEWT_VAL(I2S_STATS)
+/**
+ * Get statistics of I2S device
+ */
+static inline const struct i2s_stats *
+i2s_get_stats(struct i2s *i2s)
+{
+    return &i2s->stats;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,10 +21,69 @@
 
 #include <os/os_eventq.h>
 #include <os/os_sem.h>
+#include <os/util.h>
 
 #include <i2s/i2s.h>
 #include <i2s/i2s_driver.h>
 
+static void i2s_add_to_user_queue(struct i2s *i2s,
+                                  struct i2s_sample_buffer *buffer);
+static void i2s_add_to_driver_queue(struct i2s *i2s,
+                                    struct i2s_sample_buffer *buffer);
+
+static uint32_t
+i2s_buffer_queued_samples(struct i2s *i2s, struct i2s_sample_buffer *buffer)
+{
+    return i2s->direction == I2S_IN ? buffer->capacity : buffer->sample_count;
+}
+
+/* Put buffers taken out by i2s_limit_depth() back in circulation */
+static void
+i2s_restore_depth(struct i2s *i2s)
+{
+    struct i2s_sample_buffer *buffer;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    while (NULL != (buffer = STAILQ_FIRST(&i2s->spare_queue))) {
+        STAILQ_REMOVE_HEAD(&i2s->spare_queue, next_buffer);
+        if (i2s->direction == I2S_IN) {
+            i2s_add_to_driver_queue(i2s, buffer);
+        } else {
+            i2s_add_to_user_queue(i2s, buffer);
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+/* Device must be stopped */
+static void
+i2s_limit_depth(struct i2s *i2s, uint16_t depth)
+{
+    struct i2s_sample_buffer *buffer;
+    int count;
+    int sr;
+
+    if (i2s->buffer_pool == NULL || depth == 0 ||
+        depth >= i2s->buffer_pool->buffer_count) {
+        return;
+    }
+
+    for (count = i2s->buffer_pool->buffer_count - depth; count > 0; --count) {
+        if (i2s->direction == I2S_IN) {
+            buffer = i2s_driver_buffer_get(i2s);
+        } else {
+            buffer = i2s_buffer_get(i2s, 0);
+        }
+        if (buffer == NULL) {
+            break;
+        }
+        OS_ENTER_CRITICAL(sr);
+        STAILQ_INSERT_TAIL(&i2s->spare_queue, buffer, next_buffer);
+        OS_EXIT_CRITICAL(sr);
+    }
+}
+
 /* Function called from i2s_open/os_dev_open */
 static int
 i2s_open_handler(struct os_dev *dev, uint32_t timout, void *arg)
@@ -47,6 +106,9 @@ i2s_open_handler(struct os_dev *dev, uint32_t timout, void *arg)
     if (client && client->sample_rate) {
         i2s->sample_rate = client->sample_rate;
     }
+    if (client) {
+        i2s_limit_depth(i2s, client->buffer_depth);
+    }
 
     if (i2s->direction == I2S_IN) {
         while (NULL != (buffer = i2s_buffer_get(i2s, 0))) {
@@ -75,6 +137,7 @@ i2s_close_handler(struct os_dev *dev)
     i2s = (struct i2s *)dev;
     i2s_stop(i2s);
     i2s->client = NULL;
+    i2s_restore_depth(i2s);
 
     return OS_OK;
 }
@@ -102,6 +165,12 @@ static void
 i2s_add_to_driver_queue(struct i2s *i2s, struct i2s_sample_buffer *buffer)
 {
     STAILQ_INSERT_TAIL(&i2s->driver_queue, buffer, next_buffer);
+    i2s->queued_samples += i2s_buffer_queued_samples(i2s, buffer);
+#if MYNEWT_VAL(I2S_STATS)
+    if (i2s->stats.max_queued_samples < i2s->queued_samples) {
+        i2s->stats.max_queued_samples = i2s->queued_samples;
+    }
+#endif
     if (i2s->state != I2S_STATE_STOPPED) {
         i2s_driver_buffer_queued(i2s);
     }
@@ -160,6 +229,8 @@ i2s_init(struct i2s *i2s, struct i2s_buffer_pool *pool)
 {
     STAILQ_INIT(&i2s->driver_queue);
     STAILQ_INIT(&i2s->user_queue);
+    STAILQ_INIT(&i2s->spare_queue);
+    i2s->queued_samples = 0;
 
     i2s->state = I2S_STATE_STOPPED;
 
@@ -298,6 +369,7 @@ i2s_stop(struct i2s *i2s)
             STAILQ_REMOVE_HEAD(&i2s->driver_queue, next_buffer);
             i2s_add_to_user_queue(i2s, buffer);
         }
+        i2s->queued_samples = 0;
     }
     return 0;
 }
@@ -377,6 +449,7 @@ i2s_driver_buffer_get(struct i2s *i2s)
     buffer = STAILQ_FIRST(&i2s->driver_queue);
     if (buffer) {
         STAILQ_REMOVE_HEAD(&i2s->driver_queue, next_buffer);
+        i2s->queued_samples -= i2s_buffer_queued_samples(i2s, buffer);
     }
     OS_EXIT_CRITICAL(sr);
 
@@ -389,6 +462,9 @@ i2s_driver_buffer_put(struct i2s *i2s, struct i2s_sample_buffer *buffer)
     int sr;
 
     assert(buffer != NULL && i2s != NULL);
+#if MYNEWT_VAL(I2S_STATS)
+    i2s->stats.buffers++;
+#endif
     if (i2s->client) {
         /* If callback returns 1, buffer is not added to the pool */
         if (i2s->client->sample_buffer_ready_cb(i2s, buffer) == 1) {
@@ -404,9 +480,108 @@ void
 i2s_driver_state_changed(struct i2s *i2s, enum i2s_state state)
 {
     if (i2s->state != state) {
+#if MYNEWT_VAL(I2S_STATS)
+        if (state == I2S_STATE_OUT_OF_BUFFERS &&
+            i2s->state == I2S_STATE_RUNNING) {
+            if (i2s->direction == I2S_IN) {
+                i2s->stats.overruns++;
+            } else {
+                i2s->stats.underruns++;
+            }
+        }
+#endif
         i2s->state = state;
         if (i2s->client) {
             i2s->client->state_changed_cb(i2s, state);
         }
     }
 }
+
+uint32_t
+i2s_queue_latency_us(struct i2s *i2s)
+{
+    uint32_t samples;
+    uint32_t rate;
+
+    samples = i2s->queued_samples;
+    /* Samples of all channels are counted, assume stereo like i2s_read() */
+    rate = i2s->sample_rate * 2;
+    if (rate == 0) {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)samples * 1000000) / rate);
+}
+
+#if MYNEWT_VAL(I2S_MBUF)
+static void
+i2s_buffer_mbuf_free(struct os_mbuf_ext *ext)
+{
+    struct i2s *i2s = ext->ome_arg;
+    struct i2s_sample_buffer *buffer;
+
+    buffer = CONTAINER_OF(ext, struct i2s_sample_buffer, mbuf_ext);
+    if (i2s->direction == I2S_OUT) {
+        buffer->sample_count = 0;
+    }
+    i2s_buffer_put(i2s, buffer);
+}
+
+struct os_mbuf *
+i2s_buffer_mbuf(struct i2s *i2s, struct i2s_sample_buffer *buffer,
+                struct os_mbuf_pool *omp)
+{
+    struct os_mbuf *om;
+    int rc;
+
+    if (omp) {
+        om = os_mbuf_get_pkthdr(omp, 0);
+    } else {
+        om = os_msys_get_pkthdr(0, 0);
+    }
+    if (om == NULL) {
+        return NULL;
+    }
+
+    os_mbuf_ext_init(&buffer->mbuf_ext, i2s_buffer_mbuf_free, i2s);
+    rc = os_mbuf_ext_attach(om, &buffer->mbuf_ext, buffer->sample_data,
+                            buffer->sample_count * i2s->sample_size_in_bytes);
+    if (rc) {
+        os_mbuf_free_chain(om);
+        return NULL;
+    }
+
+    return om;
+}
+
+int
+i2s_write_mbuf(struct i2s *i2s, struct os_mbuf *om)
+{
+    struct i2s_sample_buffer *buffer;
+    uint32_t sample_count;
+    uint32_t bytes;
+    int off;
+    int len;
+
+    assert(i2s->direction == I2S_OUT);
+
+    len = OS_MBUF_PKTLEN(om);
+    len -= len % i2s->sample_size_in_bytes;
+    for (off = 0; off < len; off += bytes) {
+        buffer = i2s_buffer_get(i2s, OS_WAIT_FOREVER);
+        if (buffer == NULL) {
+            break;
+        }
+        sample_count = (len - off) / i2s->sample_size_in_bytes;
+        if (sample_count > buffer->capacity) {
+            sample_count = buffer->capacity;
+        }
+        bytes = sample_count * i2s->sample_size_in_bytes;
+        os_mbuf_copydata(om, off, bytes, buffer->sample_data);
+        buffer->sample_count = sample_count;
+        i2s_buffer_put(i2s, buffer);
+    }
+
+    return off;
+}
+#endif
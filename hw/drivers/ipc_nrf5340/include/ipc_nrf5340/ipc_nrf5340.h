@@ -197,6 +197,69 @@ uint16_t ipc_nrf5340_consume(int channel, uint16_t len);
  */
 void ipc_nrf5340_set_net_core_restart_cb(void (*on_restart)(void));
 
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+/**
+ * Allocates a zero-copy slot of IPC_NRF5340_ZC_SLOT_SIZE bytes in shared
+ * memory. Data is written straight into the slot and the slot is then
+ * passed to the other core with ipc_nrf5340_zc_send(); only a 4 byte
+ * descriptor goes through the channel ring.
+ *
+ * @return            Slot buffer or NULL if all slots are in flight
+ */
+void *ipc_nrf5340_zc_alloc(void);
+
+/**
+ * Returns a slot obtained from ipc_nrf5340_zc_alloc() that was not sent.
+ *
+ * @param buf         Slot buffer
+ */
+void ipc_nrf5340_zc_free(void *buf);
+
+/**
+ * Passes a zero-copy slot to the other core. The slot belongs to the
+ * receiver until it calls ipc_nrf5340_zc_release().
+ *
+ * @param channel     IPC channel number to send on
+ * @param buf         Slot buffer from ipc_nrf5340_zc_alloc()
+ * @param len         Number of valid bytes in the slot
+ * @param last        If this is the last send, so other side can be notified;
+ *                    pass false to batch several slots behind one interrupt
+ *
+ * @return            0 on success and negative error on failure
+ */
+int ipc_nrf5340_zc_send(int channel, void *buf, uint16_t len, bool last);
+
+/**
+ * Takes the next zero-copy slot received on a channel. The channel must
+ * only carry zero-copy descriptors.
+ *
+ * @param channel     IPC channel number to read from
+ * @param buf         Set to the slot data
+ *
+ * @return            Data length, 0 if nothing was received
+ */
+uint16_t ipc_nrf5340_zc_read(int channel, void **buf);
+
+/**
+ * Gives a received slot back to the sending core.
+ *
+ * @param buf         Slot buffer from ipc_nrf5340_zc_read()
+ */
+void ipc_nrf5340_zc_release(void *buf);
+
+/**
+ * Takes the next zero-copy slot received on a channel as an msys mbuf that
+ * points at the slot (external storage). The slot is released when the
+ * mbuf is freed.
+ *
+ * @param channel     IPC channel number to read from
+ *
+ * @return            mbuf or NULL if nothing was received or no mbuf is
+ *                    available
+ */
+struct os_mbuf *ipc_nrf5340_zc_read_om(int channel);
+#endif
+
 #if MYNEWT_VAL(MCU_NET_CORE)
 /**
  * Get embedded netcore image and its size.
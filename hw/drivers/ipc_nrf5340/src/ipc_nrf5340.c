@@ -54,6 +54,10 @@ struct ipc_shared {
         APP_AND_NET_RUNNING,
         NET_RESTARTED,
     } ipc_state;
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+    /* Zero-copy slot pools: [0] app to net, [1] net to app */
+    struct ipc_zc_pool *ipc_zc_pools;
+#endif
 #if MYNEWT_PKG_apache_mynewt_nimble__nimble_transport_common_hci_ipc
     volatile struct hci_ipc_shm hci_shm;
 #endif
@@ -91,6 +95,39 @@ struct ipc_shm {
 
 static struct ipc_channel ipcs[IPC_MAX_CHANS];
 
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+#define IPC_ZC_SLOTS        MYNEWT_VAL(IPC_NRF5340_ZC_SLOTS)
+#define IPC_ZC_SLOT_SIZE    MYNEWT_VAL(IPC_NRF5340_ZC_SLOT_SIZE)
+
+/*
+ * Slot pool in shared memory.  A slot is marked busy by the sending core
+ * when allocated and marked free by the receiving core when released, so
+ * each state byte only ever has one writer per transition.
+ */
+struct ipc_zc_pool {
+    volatile uint8_t state[IPC_ZC_SLOTS];
+    uint8_t data[IPC_ZC_SLOTS][IPC_ZC_SLOT_SIZE] __attribute__((aligned(4)));
+};
+
+/* Passed through the channel ring for each zero-copy message. */
+struct ipc_zc_desc {
+    uint16_t slot;
+    uint16_t len;
+};
+
+#if MYNEWT_VAL(MCU_APP_CORE)
+#define IPC_ZC_TX_POOL      0
+#define IPC_ZC_RX_POOL      1
+static struct ipc_zc_pool zc_pools[2];
+#else
+#define IPC_ZC_TX_POOL      1
+#define IPC_ZC_RX_POOL      0
+#endif
+
+/* Receiver side external storage descriptors, one per peer slot. */
+static struct os_mbuf_ext zc_exts[IPC_ZC_SLOTS];
+#endif
+
 #define NET_CRASH_CHANNEL   15
 
 __attribute__((section(".ipc"))) static struct ipc_shared ipc_shared[1];
@@ -220,11 +257,20 @@ ipc_nrf5340_isr(void)
     }
 #endif
 
-    for (i = 0; i < IPC_MAX_CHANS; i++) {
-        if (irq_pend & (0x1UL << i)) {
-            NRF_IPC->EVENTS_RECEIVE[i] = 0;
-            ipcs[i].cb(i, ipcs[i].user_data);
+    /*
+     * Keep serving channels signalled while callbacks run, instead of
+     * taking another interrupt for each of them.
+     */
+    irq_pend &= ~(1UL << NET_CRASH_CHANNEL);
+    while (irq_pend) {
+        for (i = 0; i < IPC_MAX_CHANS; i++) {
+            if (irq_pend & (0x1UL << i)) {
+                NRF_IPC->EVENTS_RECEIVE[i] = 0;
+                ipcs[i].cb(i, ipcs[i].user_data);
+            }
         }
+        irq_pend = NRF_IPC->INTPEND & NRF_IPC->INTEN &
+                   ~(1UL << NET_CRASH_CHANNEL);
     }
 
     os_trace_isr_exit();
@@ -297,6 +343,10 @@ ipc_nrf5340_init(void)
     ipc_shared->ipc_channel_count = IPC_MAX_CHANS;
     ipc_shared->ipc_shms = shms;
     ipc_shared->ipc_state = APP_WAITS_FOR_NET;
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+    memset(zc_pools, 0, sizeof(zc_pools));
+    ipc_shared->ipc_zc_pools = zc_pools;
+#endif
 
     if (MYNEWT_VAL(MCU_APP_SECURE) && !MYNEWT_VAL(IPC_NRF5340_PRE_TRUSTZONE_NETCORE_BOOT)) {
         /*
@@ -401,6 +451,9 @@ ipc_nrf5340_reset(void)
         shms[i].buf = shms_bufs[i];
         shms[i].buf_size = IPC_BUF_SIZE;
     }
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+    memset(zc_pools, 0, sizeof(zc_pools));
+#endif
 
     /* Start Network Core */
     ipc_nrf5340_netcore_init();
@@ -536,6 +589,133 @@ ipc_nrf5340_consume(int channel, uint16_t len)
     return ipc_nrf5340_shm_read(&shms[channel], NULL, NULL, len);
 }
 
+#if MYNEWT_VAL(IPC_NRF5340_ZC)
+void *
+ipc_nrf5340_zc_alloc(void)
+{
+    struct ipc_zc_pool *pool;
+    os_sr_t sr;
+    int i;
+
+    pool = &ipc_shared->ipc_zc_pools[IPC_ZC_TX_POOL];
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < IPC_ZC_SLOTS; i++) {
+        if (pool->state[i] == 0) {
+            pool->state[i] = 1;
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return i < IPC_ZC_SLOTS ? pool->data[i] : NULL;
+}
+
+static int
+ipc_nrf5340_zc_slot(struct ipc_zc_pool *pool, const void *buf)
+{
+    uintptr_t off;
+
+    off = (uintptr_t)buf - (uintptr_t)pool->data;
+    assert(off < sizeof(pool->data) && off % IPC_ZC_SLOT_SIZE == 0);
+
+    return off / IPC_ZC_SLOT_SIZE;
+}
+
+void
+ipc_nrf5340_zc_free(void *buf)
+{
+    struct ipc_zc_pool *pool;
+
+    pool = &ipc_shared->ipc_zc_pools[IPC_ZC_TX_POOL];
+    pool->state[ipc_nrf5340_zc_slot(pool, buf)] = 0;
+}
+
+int
+ipc_nrf5340_zc_send(int channel, void *buf, uint16_t len, bool last)
+{
+    struct ipc_zc_pool *pool;
+    struct ipc_zc_desc desc;
+
+    assert(len <= IPC_ZC_SLOT_SIZE);
+
+    pool = &ipc_shared->ipc_zc_pools[IPC_ZC_TX_POOL];
+    desc.slot = ipc_nrf5340_zc_slot(pool, buf);
+    desc.len = len;
+
+    /* Slot contents must be visible before the descriptor. */
+    __DMB();
+
+    return ipc_nrf5340_write(channel, &desc, sizeof(desc), last);
+}
+
+uint16_t
+ipc_nrf5340_zc_read(int channel, void **buf)
+{
+    struct ipc_zc_pool *pool;
+    struct ipc_zc_desc desc;
+
+    if (ipc_nrf5340_data_available_get(channel) < sizeof(desc)) {
+        return 0;
+    }
+    ipc_nrf5340_read(channel, &desc, sizeof(desc));
+    assert(desc.slot < IPC_ZC_SLOTS);
+
+    pool = &ipc_shared->ipc_zc_pools[IPC_ZC_RX_POOL];
+    *buf = pool->data[desc.slot];
+
+    return desc.len;
+}
+
+void
+ipc_nrf5340_zc_release(void *buf)
+{
+    struct ipc_zc_pool *pool;
+
+    pool = &ipc_shared->ipc_zc_pools[IPC_ZC_RX_POOL];
+
+    /* Done with the data before the sender may reuse the slot. */
+    __DMB();
+    pool->state[ipc_nrf5340_zc_slot(pool, buf)] = 0;
+}
+
+static void
+ipc_nrf5340_zc_ext_free(struct os_mbuf_ext *ext)
+{
+    ipc_nrf5340_zc_release(ext->ome_arg);
+}
+
+struct os_mbuf *
+ipc_nrf5340_zc_read_om(int channel)
+{
+    struct os_mbuf *om;
+    void *buf;
+    uint16_t len;
+    int slot;
+    int rc;
+
+    if (ipc_nrf5340_data_available_get(channel) < sizeof(struct ipc_zc_desc)) {
+        return NULL;
+    }
+
+    om = os_msys_get_pkthdr(0, 0);
+    if (om == NULL) {
+        /* Leave the descriptor queued for a later attempt. */
+        return NULL;
+    }
+
+    len = ipc_nrf5340_zc_read(channel, &buf);
+    slot = ipc_nrf5340_zc_slot(&ipc_shared->ipc_zc_pools[IPC_ZC_RX_POOL],
+                               buf);
+
+    os_mbuf_ext_init(&zc_exts[slot], ipc_nrf5340_zc_ext_free, buf);
+    rc = os_mbuf_ext_attach(om, &zc_exts[slot], buf, len);
+    assert(rc == 0);
+
+    return om;
+}
+#endif
+
 #if MYNEWT_VAL(MCU_NET_CORE)
 const void *
 ipc_nrf5340_net_image_get(uint32_t *size)
@@ -228,6 +228,11 @@ struct hal_timer TxTimeoutTimer;
 struct hal_timer RxTimeoutTimer;
 struct hal_timer RxTimeoutSyncWord;
 
+/*!
+ * os_cputime at which the last RxDone interrupt was taken
+ */
+static uint32_t RxDoneTime;
+
 double
 ceil(double d)
 {
@@ -1072,6 +1077,11 @@ SX1272WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
     hal_gpio_write(RADIO_NSS, 0);
     bsp_spi_write_buf(addr | 0x80, buffer, size);
     hal_gpio_write(RADIO_NSS, 1);
+#elif MYNEWT_VAL(SX1272_SPI_BURST)
+    hal_gpio_write(RADIO_NSS, 0);
+    hal_spi_tx_val(RADIO_SPI_IDX, addr | 0x80);
+    hal_spi_txrx(RADIO_SPI_IDX, buffer, NULL, size);
+    hal_gpio_write(RADIO_NSS, 1);
 #else
     uint8_t i;
 
@@ -1091,6 +1101,12 @@ SX1272ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
     hal_gpio_write(RADIO_NSS, 0);
     bsp_spi_read_buf(addr & 0x7f, buffer, size);
     hal_gpio_write(RADIO_NSS, 1);
+#elif MYNEWT_VAL(SX1272_SPI_BURST)
+    hal_gpio_write(RADIO_NSS, 0);
+    hal_spi_tx_val(RADIO_SPI_IDX, addr & 0x7f);
+    /* The radio ignores MOSI while reading; clock out the buffer itself. */
+    hal_spi_txrx(RADIO_SPI_IDX, buffer, buffer, size);
+    hal_gpio_write(RADIO_NSS, 1);
 #else
     uint8_t i;
 
@@ -1151,6 +1167,12 @@ uint32_t SX1272GetWakeupTime( void )
     return SX1272GetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
 }
 
+uint32_t
+SX1272GetRxDoneTime(void)
+{
+    return RxDoneTime;
+}
+
 void
 SX1272OnTimeoutIrq(void *unused)
 {
@@ -1231,6 +1253,8 @@ SX1272OnDio0Irq(void *unused)
 
     switch (SX1272.Settings.State) {
         case RF_RX_RUNNING:
+            // Timestamp before any bus access delays it
+            RxDoneTime = os_cputime_get32();
             //TimerStop(&RxTimeoutTimer);
             // RxDone interrupt
             switch (SX1272.Settings.Modem) {
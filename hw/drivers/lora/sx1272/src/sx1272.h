@@ -398,6 +398,13 @@ void SX1272SetPublicNetwork(bool enable);
  */
 uint32_t SX1272GetWakeupTime(void);
 
+/*!
+ * \brief Gets the os_cputime at which the last RxDone interrupt was taken.
+ *
+ * \retval time os_cputime of the last packet reception
+ */
+uint32_t SX1272GetRxDoneTime(void);
+
 void SX1272RxDisable(void);
 
 #endif // __SX1272_H__
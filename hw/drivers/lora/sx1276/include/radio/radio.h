@@ -346,6 +346,13 @@ struct Radio_s
      *
      */
     void  ( *RxDisable )( void );
+
+    /*!
+     * \brief Gets the time at which the last packet was received.
+     *
+     * \retval time os_cputime captured when the RxDone interrupt was taken
+     */
+    uint32_t ( *RxDoneTime )( void );
 };
 
 /*!
@@ -56,7 +56,8 @@ const struct Radio_s Radio =
     .SetMaxPayloadLength = SX1276SetMaxPayloadLength,
     .SetPublicNetwork = SX1276SetPublicNetwork,
     .GetWakeupTime = SX1276GetWakeupTime,
-    .RxDisable = SX1276RxDisable
+    .RxDisable = SX1276RxDisable,
+    .RxDoneTime = SX1276GetRxDoneTime
 };
 
 void
@@ -218,6 +218,11 @@ struct hal_timer RxTimeoutSyncWord;
 
 static uint32_t rx_timeout_sync_delay = -1;
 
+/*!
+ * os_cputime at which the last RxDone interrupt was taken
+ */
+static uint32_t RxDoneTime;
+
 double
 ceil(double d)
 {
@@ -242,6 +247,20 @@ round(double d)
     return (int64_t)(d + 0.5);
 }
 
+/*
+ * Writes a big-endian 16-bit value to a pair of consecutive registers in a
+ * single SPI transaction.
+ */
+static void
+SX1276Write16(uint16_t addr, uint16_t val)
+{
+    uint8_t buf[2];
+
+    buf[0] = (uint8_t)(val >> 8);
+    buf[1] = (uint8_t)(val & 0xFF);
+    SX1276WriteBuffer(addr, buf, sizeof(buf));
+}
+
 static void
 SX1276RxDone(uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr)
 {
@@ -325,11 +344,14 @@ SX1276GetStatus(void)
 void
 SX1276SetChannel(uint32_t freq)
 {
+    uint8_t frf[3];
+
     SX1276.Settings.Channel = freq;
     freq = (uint32_t)((double)freq / (double)FREQ_STEP);
-    SX1276Write(REG_FRFMSB, (uint8_t)((freq >> 16) & 0xFF));
-    SX1276Write(REG_FRFMID, (uint8_t)((freq >> 8) & 0xFF));
-    SX1276Write(REG_FRFLSB, (uint8_t)(freq & 0xFF));
+    frf[0] = (uint8_t)((freq >> 16) & 0xFF);
+    frf[1] = (uint8_t)((freq >> 8) & 0xFF);
+    frf[2] = (uint8_t)(freq & 0xFF);
+    SX1276WriteBuffer(REG_FRFMSB, frf, sizeof(frf));
 }
 
 bool
@@ -481,14 +503,12 @@ SX1276SetRxConfig(RadioModems_t modem, uint32_t bandwidth, uint32_t datarate,
         SX1276.Settings.Fsk.PreambleLen = preambleLen;
 
         datarate = (uint16_t)((double)XTAL_FREQ / (double)datarate);
-        SX1276Write(REG_BITRATEMSB, (uint8_t)(datarate >> 8));
-        SX1276Write(REG_BITRATELSB, (uint8_t)(datarate & 0xFF));
+        SX1276Write16(REG_BITRATEMSB, datarate);
 
         SX1276Write(REG_RXBW, GetFskBandwidthRegValue(bandwidth));
         SX1276Write(REG_AFCBW, GetFskBandwidthRegValue(bandwidthAfc));
 
-        SX1276Write(REG_PREAMBLEMSB, (uint8_t)((preambleLen >> 8) & 0xFF));
-        SX1276Write(REG_PREAMBLELSB, (uint8_t)(preambleLen & 0xFF));
+        SX1276Write16(REG_PREAMBLEMSB, preambleLen);
 
         if (fixLen == 1) {
             SX1276Write(REG_PAYLOADLENGTH, payloadLen);
@@ -557,8 +577,7 @@ SX1276SetRxConfig(RadioModems_t modem, uint32_t bandwidth, uint32_t datarate,
 
         SX1276Write(REG_LR_SYMBTIMEOUTLSB, (uint8_t)(symbTimeout & 0xFF));
 
-        SX1276Write(REG_LR_PREAMBLEMSB, (uint8_t)((preambleLen >> 8) & 0xFF));
-        SX1276Write(REG_LR_PREAMBLELSB, (uint8_t)(preambleLen & 0xFF));
+        SX1276Write16(REG_LR_PREAMBLEMSB, preambleLen);
 
         if (fixLen == 1) {
             SX1276Write(REG_LR_PAYLOADLENGTH, payloadLen);
@@ -670,15 +689,12 @@ SX1276SetTxConfig(RadioModems_t modem, int8_t power, uint32_t fdev,
         SX1276.Settings.Fsk.TxTimeout = timeout;
 
         fdev = (uint16_t)((double)fdev / (double)FREQ_STEP);
-        SX1276Write(REG_FDEVMSB, (uint8_t)(fdev >> 8));
-        SX1276Write(REG_FDEVLSB, (uint8_t)(fdev & 0xFF));
+        SX1276Write16(REG_FDEVMSB, fdev);
 
         datarate = (uint16_t)((double)XTAL_FREQ / (double)datarate);
-        SX1276Write(REG_BITRATEMSB, (uint8_t)(datarate >> 8));
-        SX1276Write(REG_BITRATELSB, (uint8_t)(datarate & 0xFF));
+        SX1276Write16(REG_BITRATEMSB, datarate);
 
-        SX1276Write(REG_PREAMBLEMSB, (preambleLen >> 8) & 0x00FF);
-        SX1276Write(REG_PREAMBLELSB, preambleLen & 0xFF);
+        SX1276Write16(REG_PREAMBLEMSB, preambleLen);
 
         SX1276Write(REG_PACKETCONFIG1,
                      (SX1276Read(REG_PACKETCONFIG1) &
@@ -742,8 +758,7 @@ SX1276SetTxConfig(RadioModems_t modem, int8_t power, uint32_t fdev,
                        RFLR_MODEMCONFIG3_LOWDATARATEOPTIMIZE_MASK) |
                        (SX1276.Settings.LoRa.LowDatarateOptimize << 3));
 
-        SX1276Write(REG_LR_PREAMBLEMSB, (preambleLen >> 8) & 0x00FF);
-        SX1276Write(REG_LR_PREAMBLELSB, preambleLen & 0xFF);
+        SX1276Write16(REG_LR_PREAMBLEMSB, preambleLen);
 
         if (datarate == 6) {
             SX1276Write(REG_LR_DETECTOPTIMIZE,
@@ -1259,14 +1274,20 @@ SX1276Read(uint16_t addr)
 void
 SX1276WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 {
+#if !MYNEWT_VAL(SX1276_SPI_BURST)
     uint8_t i;
+#endif
 
     hal_gpio_write(RADIO_NSS, 0);
 
     hal_spi_tx_val(RADIO_SPI_IDX, addr | 0x80);
+#if MYNEWT_VAL(SX1276_SPI_BURST)
+    hal_spi_txrx(RADIO_SPI_IDX, buffer, NULL, size);
+#else
     for(i = 0; i < size; i++) {
         hal_spi_tx_val(RADIO_SPI_IDX, buffer[i]);
     }
+#endif
 
     hal_gpio_write(RADIO_NSS, 1);
 }
@@ -1274,14 +1295,21 @@ SX1276WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 void
 SX1276ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 {
+#if !MYNEWT_VAL(SX1276_SPI_BURST)
     uint8_t i;
+#endif
 
     hal_gpio_write(RADIO_NSS, 0);
 
     hal_spi_tx_val(RADIO_SPI_IDX, addr & 0x7f);
+#if MYNEWT_VAL(SX1276_SPI_BURST)
+    /* The radio ignores MOSI while reading; clock out the buffer itself. */
+    hal_spi_txrx(RADIO_SPI_IDX, buffer, buffer, size);
+#else
     for (i = 0; i < size; i++) {
         buffer[i] = hal_spi_tx_val(RADIO_SPI_IDX, 0);
     }
+#endif
 
     hal_gpio_write(RADIO_NSS, 1);
 }
@@ -1335,6 +1363,12 @@ SX1276GetWakeupTime(void)
     return SX1276GetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
 }
 
+uint32_t
+SX1276GetRxDoneTime(void)
+{
+    return RxDoneTime;
+}
+
 void
 SX1276OnTimeoutIrq(void *unused)
 {
@@ -1380,9 +1414,13 @@ SX1276OnDio0Irq(void *unused)
     int8_t snr;
     int16_t rssi;
     volatile uint8_t irqFlags = 0;
+    uint8_t regs[4];
+    uint8_t pkt[2];
 
     switch (SX1276.Settings.State) {
     case RF_RX_RUNNING:
+        // Timestamp before any bus access delays it
+        RxDoneTime = os_cputime_get32();
         //TimerStop(&RxTimeoutTimer);
         // RxDone interrupt
         switch (SX1276.Settings.Modem) {
@@ -1455,7 +1493,9 @@ SX1276OnDio0Irq(void *unused)
             // Clear Irq
             SX1276Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXDONE);
 
-            irqFlags = SX1276Read(REG_LR_IRQFLAGS);
+            // FIFO RX address, IRQ mask, IRQ flags and RX byte count
+            SX1276ReadBuffer(REG_LR_FIFORXCURRENTADDR, regs, 4);
+            irqFlags = regs[2];
             if ((irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK) == RFLR_IRQFLAGS_PAYLOADCRCERROR) {
                 // Clear Irq
                 SX1276Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_PAYLOADCRCERROR);
@@ -1469,8 +1509,11 @@ SX1276OnDio0Irq(void *unused)
                 break;
             }
 
+            // Packet SNR and RSSI
+            SX1276ReadBuffer(REG_LR_PKTSNRVALUE, pkt, 2);
+
             // The SNR sign bit is 1
-            SX1276.Settings.LoRaPacketHandler.SnrValue = SX1276Read(REG_LR_PKTSNRVALUE);
+            SX1276.Settings.LoRaPacketHandler.SnrValue = pkt[0];
             if (SX1276.Settings.LoRaPacketHandler.SnrValue & 0x80) {
                 // Invert and divide by 4
                 snr = ((~SX1276.Settings.LoRaPacketHandler.SnrValue + 1) & 0xFF) >> 2;
@@ -1480,7 +1523,7 @@ SX1276OnDio0Irq(void *unused)
                 snr = (SX1276.Settings.LoRaPacketHandler.SnrValue & 0xFF) >> 2;
             }
 
-            rssi = SX1276Read(REG_LR_PKTRSSIVALUE);
+            rssi = pkt[1];
             if (snr < 0) {
                 if (SX1276.Settings.Channel > RF_MID_BAND_THRESH) {
                     SX1276.Settings.LoRaPacketHandler.RssiValue =
@@ -1499,8 +1542,8 @@ SX1276OnDio0Irq(void *unused)
                 }
             }
 
-            SX1276.Settings.LoRaPacketHandler.Size = SX1276Read(REG_LR_RXNBBYTES);
-            SX1276Write(REG_LR_FIFOADDRPTR, SX1276Read(REG_LR_FIFORXCURRENTADDR));
+            SX1276.Settings.LoRaPacketHandler.Size = regs[3];
+            SX1276Write(REG_LR_FIFOADDRPTR, regs[0]);
             SX1276ReadFifo(RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size);
 
             if (SX1276.Settings.LoRa.RxContinuous == false) {
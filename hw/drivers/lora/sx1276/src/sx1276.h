@@ -394,6 +394,13 @@ void SX1276SetPublicNetwork(bool enable);
  */
 uint32_t SX1276GetWakeupTime(void);
 
+/*!
+ * \brief Gets the os_cputime at which the last RxDone interrupt was taken.
+ *
+ * \retval time os_cputime of the last packet reception
+ */
+uint32_t SX1276GetRxDoneTime(void);
+
 void SX1276RxDisable(void);
 
 #endif // __SX1276_H__
@@ -19,6 +19,7 @@
 
 #include "os/mynewt.h"
 
+#include <hal/hal_dma.h>
 #include <hal/hal_gpio.h>
 #include <hal/hal_timer.h>
 #include <mcu/cmsis_nvic.h>
@@ -59,13 +60,26 @@
 #define SMSC_8710_ISR_AUTO_DONE 0x40
 #define SMSC_8710_ISR_LINK_DOWN 0x10
 
-#define STM32_ETH_RX_DESC_SZ 3
-#define STM32_ETH_TX_DESC_SZ 4
+#define STM32_ETH_RX_DESC_SZ MYNEWT_VAL(STM32_ETH_RX_DESC_CNT)
+#define STM32_ETH_TX_DESC_SZ MYNEWT_VAL(STM32_ETH_TX_DESC_CNT)
 
+#if STM32_ETH_RX_DESC_SZ < 2 || STM32_ETH_RX_DESC_SZ > 255
+#error "STM32_ETH_RX_DESC_CNT must be between 2 and 255"
+#endif
+#if STM32_ETH_TX_DESC_SZ < 2 || STM32_ETH_TX_DESC_SZ > 255
+#error "STM32_ETH_TX_DESC_CNT must be between 2 and 255"
+#endif
+
+/*
+ * Each descriptor is on cache lines of its own, with data cache on CPU and
+ * DMA must not write different descriptors in the same line.  Every CPU
+ * write to a descriptor is followed by hal_dma_sync_for_device(), and
+ * reads of a descriptor the DMA may own by hal_dma_sync_for_cpu().
+ */
 struct stm32_eth_desc {
     volatile ETH_DMADescTypeDef desc;
     struct pbuf *p;
-};
+} __attribute__((aligned(HAL_DMA_BUF_ALIGN)));
 
 struct stm32_eth_state {
     struct netif st_nif;
@@ -77,6 +91,9 @@ struct stm32_eth_state {
     uint8_t st_tx_head;
     uint8_t st_tx_tail;
     struct hal_timer st_phy_tmr;
+#if MYNEWT_VAL(STM32_ETH_RX_POLL)
+    struct os_callout st_rx_poll;
+#endif
     const struct stm32_eth_cfg *cfg;
 };
 
@@ -86,6 +103,8 @@ struct stm32_eth_stats {
     uint32_t oerr;
     uint32_t iframe;
     uint32_t imem;
+    uint32_t ierr;
+    uint32_t ipoll;
 } stm32_eth_stats;
 
 static struct stm32_eth_state stm32_eth_state;
@@ -101,6 +120,7 @@ stm32_eth_setup_descs(struct stm32_eth_desc *descs, int cnt)
     }
     descs[cnt - 1].desc.Status = 0;
     descs[cnt - 1].desc.Buffer2NextDescAddr = (uint32_t)&descs[0].desc;
+    hal_dma_sync_for_device(descs, cnt * sizeof(*descs));
 }
 
 static void
@@ -119,11 +139,13 @@ stm32_eth_fill_rx(struct stm32_eth_state *ses)
             ++stm32_eth_stats.imem;
             break;
         }
+        hal_dma_sync_for_device(p->payload, ETH_MAX_PACKET_SIZE);
         sed->p = p;
         sed->desc.Status = 0;
         sed->desc.ControlBufferSize = ETH_DMARXDESC_RCH | ETH_MAX_PACKET_SIZE;
         sed->desc.Buffer1Addr = (uint32_t)p->payload;
         sed->desc.Status = ETH_DMARXDESC_OWN;
+        hal_dma_sync_for_device(sed, sizeof(*sed));
 
         ses->st_rx_tail++;
         if (ses->st_rx_tail >= STM32_ETH_RX_DESC_SZ) {
@@ -132,38 +154,59 @@ stm32_eth_fill_rx(struct stm32_eth_state *ses)
     }
 }
 
-static void
-stm32_eth_input(struct stm32_eth_state *ses)
+/*
+ * Whether the descriptor at the head of the RX ring holds a received frame.
+ */
+static int
+stm32_eth_rx_ready(struct stm32_eth_state *ses)
+{
+    struct stm32_eth_desc *sed;
+
+    sed = &ses->st_rx_descs[ses->st_rx_head];
+    hal_dma_sync_for_cpu(sed, sizeof(*sed));
+    return sed->p && !(sed->desc.Status & ETH_DMARXDESC_OWN);
+}
+
+/*
+ * Passes up to budget received frames to lwIP, and refills the ring.
+ *
+ * @return The number of descriptors consumed.
+ */
+static int
+stm32_eth_input(struct stm32_eth_state *ses, int budget)
 {
     struct stm32_eth_desc *sed;
     struct pbuf *p;
     struct netif *nif;
+    int cnt;
 
     nif = &ses->st_nif;
 
-    while (1) {
+    for (cnt = 0; cnt < budget && stm32_eth_rx_ready(ses); cnt++) {
         sed = &ses->st_rx_descs[ses->st_rx_head];
-        if (!sed->p) {
-            break;
-        }
-        if (sed->desc.Status & ETH_DMARXDESC_OWN) {
-            break;
-        }
         p = sed->p;
         sed->p = NULL;
-        if (!(sed->desc.Status & ETH_DMARXDESC_LS)) {
+        hal_dma_sync_for_device(sed, sizeof(*sed));
+        ses->st_rx_head++;
+        if (ses->st_rx_head >= STM32_ETH_RX_DESC_SZ) {
+            ses->st_rx_head = 0;
+        }
+        if ((sed->desc.Status & (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS)) !=
+            (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS) ||
+            sed->desc.Status & ETH_DMARXDESC_ES) {
             /*
-             * Incoming data spans multiple pbufs. XXX support later
+             * Errored, or spans multiple buffers, which cannot happen
+             * as each holds ETH_MAX_PACKET_SIZE.
              */
+            ++stm32_eth_stats.ierr;
             pbuf_free(p);
             continue;
         }
         p->len = p->tot_len = (sed->desc.Status & ETH_DMARXDESC_FL) >> 16;
+        hal_dma_sync_for_cpu(p->payload, p->len);
         ++stm32_eth_stats.iframe;
-        nif->input(p, nif);
-        ses->st_rx_head++;
-        if (ses->st_rx_head >= STM32_ETH_RX_DESC_SZ) {
-            ses->st_rx_head = 0;
+        if (nif->input(p, nif) != ERR_OK) {
+            pbuf_free(p);
         }
     }
 
@@ -176,12 +219,61 @@ stm32_eth_input(struct stm32_eth_state *ses)
         ses->st_eth.Instance->DMASR = ETH_DMASR_RBUS;
         ses->st_eth.Instance->DMARPDR = 0;
     }
+
+    return cnt;
+}
+
+#if MYNEWT_VAL(STM32_ETH_RX_POLL)
+static void
+stm32_eth_rx_poll(struct os_event *ev)
+{
+    struct stm32_eth_state *ses = ev->ev_arg;
+    os_sr_t sr;
+
+    ++stm32_eth_stats.ipoll;
+    if (stm32_eth_input(ses, MYNEWT_VAL(STM32_ETH_RX_BUDGET)) ==
+        MYNEWT_VAL(STM32_ETH_RX_BUDGET)) {
+        /*
+         * Possibly more pending; let other events run first.
+         */
+        os_eventq_put(os_eventq_dflt_get(), &ses->st_rx_poll.c_ev);
+        return;
+    }
+    if (ses->st_rx_descs[ses->st_rx_tail].p == NULL) {
+        /*
+         * Ring could not be refilled.  Nothing more can be received
+         * until it is, so retry shortly.
+         */
+        os_callout_reset(&ses->st_rx_poll, MYNEWT_VAL(STM32_ETH_RX_RETRY));
+    }
+
+    /*
+     * Unmask the interrupt.  A frame completing after the ring was
+     * checked sets RS again; one completing before it is caught below.
+     */
+    OS_ENTER_CRITICAL(sr);
+    ses->st_eth.Instance->DMASR = ETH_DMASR_RS;
+    if (stm32_eth_rx_ready(ses)) {
+        os_eventq_put(os_eventq_dflt_get(), &ses->st_rx_poll.c_ev);
+    } else {
+        ses->st_eth.Instance->DMAIER |= ETH_DMAIER_RIE;
+    }
+    OS_EXIT_CRITICAL(sr);
 }
+#endif
 
 void
 HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
 {
-    stm32_eth_input(&stm32_eth_state);
+#if MYNEWT_VAL(STM32_ETH_RX_POLL)
+    /*
+     * Mask further RX interrupts until the ring has been drained.
+     */
+    heth->Instance->DMAIER &= ~ETH_DMAIER_RIE;
+    os_eventq_put(os_eventq_dflt_get(), &stm32_eth_state.st_rx_poll.c_ev);
+#else
+    stm32_eth_input(&stm32_eth_state, STM32_ETH_RX_DESC_SZ);
+#endif
 }
 
 /*
@@ -222,6 +314,7 @@ stm32_eth_output_done(struct stm32_eth_state *ses)
 
     while (1) {
         sed = &ses->st_tx_descs[ses->st_tx_tail];
+        hal_dma_sync_for_cpu(sed, sizeof(*sed));
         if (!sed->p) {
             break;
         }
@@ -238,6 +331,7 @@ stm32_eth_output_done(struct stm32_eth_state *ses)
         }
         pbuf_free(sed->p);
         sed->p = NULL;
+        hal_dma_sync_for_device(sed, sizeof(*sed));
         ses->st_tx_tail++;
         if (ses->st_tx_tail >= STM32_ETH_TX_DESC_SZ) {
             ses->st_tx_tail = 0;
@@ -262,6 +356,7 @@ stm32_eth_output(struct netif *nif, struct pbuf *p)
         if (!q->len) {
             continue;
         }
+        hal_dma_sync_for_cpu(sed, sizeof(*sed));
         if (sed->desc.Status & ETH_DMATXDESC_OWN) {
             /*
              * Not enough space.
@@ -285,12 +380,14 @@ stm32_eth_output(struct netif *nif, struct pbuf *p)
         if (q->next == NULL) {
             reg |= ETH_DMATXDESC_LS;
         }
+        hal_dma_sync_for_device(q->payload, q->len);
         sed->desc.Status = reg;
-        sed->desc.ControlBufferSize = p->len;
-        sed->desc.Buffer1Addr = (uint32_t)p->payload;
-        sed->p = p;
-        pbuf_ref(p);
+        sed->desc.ControlBufferSize = q->len;
+        sed->desc.Buffer1Addr = (uint32_t)q->payload;
+        sed->p = q;
+        pbuf_ref(q);
         sed->desc.Status = reg | ETH_DMATXDESC_OWN;
+        hal_dma_sync_for_device(sed, sizeof(*sed));
         ses->st_tx_head++;
         if (ses->st_tx_head >= STM32_ETH_TX_DESC_SZ) {
             ses->st_tx_head = 0;
@@ -415,6 +512,10 @@ stm32_lwip_init(struct netif *nif)
     ses->st_tx_head = 0;
     ses->st_tx_tail = 0;
 
+#if MYNEWT_VAL(STM32_ETH_RX_POLL)
+    os_callout_init(&ses->st_rx_poll, os_eventq_dflt_get(), stm32_eth_rx_poll,
+                    ses);
+#endif
     stm32_eth_setup_descs(ses->st_rx_descs, STM32_ETH_RX_DESC_SZ);
     stm32_eth_setup_descs(ses->st_tx_descs, STM32_ETH_TX_DESC_SZ);
     stm32_eth_fill_rx(ses);
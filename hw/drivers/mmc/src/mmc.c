@@ -73,6 +73,9 @@ static struct mmc {
     int spi_num;
     int ss_pin;
     struct mmc_spi_cfg mmc_spi_cfg;
+#if MYNEWT_VAL(MMC_SPI_NOBLOCK)
+    struct os_sem txrx_sem;
+#endif
 } g_mmc;
 
 /* FIXME: currently limited to single MMC spi device */
@@ -153,22 +156,50 @@ mmc_spi_set_cs(struct mmc *mmc, int cs)
     hal_gpio_write(mmc->ss_pin, cs);
 }
 
+#if MYNEWT_VAL(MMC_SPI_NOBLOCK)
+static void
+mmc_spi_txrx_cb(void *arg, int len)
+{
+    struct mmc *mmc = arg;
+
+    os_sem_release(&mmc->txrx_sem);
+}
+#endif
+
+/**
+ * Transfers a buffer in one HAL call.  Long transfers use the non-blocking
+ * (DMA capable) interface when enabled; the task sleeps until done.
+ */
 static int
-mmc_spi_tx(struct mmc *mmc, const uint8_t *buf, uint16_t count)
+mmc_spi_txrx(struct mmc *mmc, uint8_t *txbuf, uint8_t *rxbuf, uint16_t count)
 {
-    for (int i = 0; i < count; i++) {
-        hal_spi_tx_val(mmc->spi_num, buf[i]);
+#if MYNEWT_VAL(MMC_SPI_NOBLOCK)
+    int rc;
+
+    if (count >= MYNEWT_VAL(MMC_SPI_NOBLOCK_MIN)) {
+        rc = hal_spi_txrx_noblock(mmc->spi_num, txbuf, rxbuf, count);
+        if (rc != 0) {
+            return rc;
+        }
+        return os_sem_pend(&mmc->txrx_sem, OS_TICKS_PER_SEC);
     }
-    return 0;
+#endif
+
+    return hal_spi_txrx(mmc->spi_num, txbuf, rxbuf, count);
+}
+
+static int
+mmc_spi_tx(struct mmc *mmc, const uint8_t *buf, uint16_t count)
+{
+    return mmc_spi_txrx(mmc, (uint8_t *)buf, NULL, count);
 }
 
 static int
 mmc_spi_rx(struct mmc *mmc, uint8_t *buf, uint16_t count)
 {
-    for (int i = 0; i < count; i++) {
-        buf[i] = hal_spi_tx_val(mmc->spi_num, 0xFF);
-    }
-    return 0;
+    /* Clock out 0xFF; received bytes overwrite the ones already sent. */
+    memset(buf, 0xFF, count);
+    return mmc_spi_txrx(mmc, buf, buf, count);
 }
 
 #endif
@@ -422,7 +453,12 @@ mmc_init(int spi_num, struct mmc_spi_cfg *spi_cfg, int ss_pin)
         return (rc);
     }
 
+#if MYNEWT_VAL(MMC_SPI_NOBLOCK)
+    os_sem_init(&mmc->txrx_sem, 0);
+    hal_spi_set_txrx_cb(mmc->spi_num, mmc_spi_txrx_cb, mmc);
+#else
     hal_spi_set_txrx_cb(mmc->spi_num, NULL, NULL);
+#endif
     rc = hal_spi_enable(mmc->spi_num);
     if (rc) {
         return (rc);
@@ -569,6 +605,19 @@ wait_busy(struct mmc *mmc)
 {
     os_time_t timeout;
     uint8_t res;
+    int spin;
+
+    /*
+     * SPI mode has no busy interrupt, so the card has to be polled.  Most
+     * block programs finish within a few hundred byte times; poll back to
+     * back for that long before falling back to sleeping between polls.
+     */
+    for (spin = MYNEWT_VAL(MMC_POLL_SPIN_BYTES); spin > 0; spin--) {
+        mmc_spi_rx(mmc, &res, 1);
+        if (res) {
+            return res;
+        }
+    }
 
     timeout = os_time_get() + OS_TICKS_PER_SEC / 2;
     do {
@@ -576,7 +625,38 @@ wait_busy(struct mmc *mmc)
         if (res) {
             break;
         }
-        os_time_delay(OS_TICKS_PER_SEC / 1000);
+        os_time_delay(max(OS_TICKS_PER_SEC / 1000, 1));
+    } while (os_time_get() < timeout);
+
+    return res;
+}
+
+/**
+ * 7.3.3 Control tokens
+ *   Wait up to 200ms for a data token, polling back to back at first as
+ *   with wait_busy().
+ */
+static uint8_t
+wait_token(struct mmc *mmc)
+{
+    os_time_t timeout;
+    uint8_t res;
+    int spin;
+
+    for (spin = MYNEWT_VAL(MMC_POLL_SPIN_BYTES); spin > 0; spin--) {
+        mmc_spi_rx(mmc, &res, 1);
+        if (res != 0xFF) {
+            return res;
+        }
+    }
+
+    timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
+    do {
+        mmc_spi_rx(mmc, &res, 1);
+        if (res != 0xFF) {
+            break;
+        }
+        os_time_delay(max(OS_TICKS_PER_SEC / 1000, 1));
     } while (os_time_get() < timeout);
 
     return res;
@@ -591,13 +671,12 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
     uint8_t cmd;
     uint8_t res;
     int rc;
-    size_t block_len;
     size_t block_count;
-    os_time_t timeout;
     uint32_t block_addr;
     size_t offset;
     size_t index;
     size_t amount;
+    uint8_t crc[2];
     struct mmc *mmc;
 
     mmc = mmc_cfg_dev(mmc_id);
@@ -607,10 +686,9 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
 
     rc = MMC_OK;
 
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
     block_addr = addr / BLOCK_LEN;
     offset = addr - (block_addr * BLOCK_LEN);
+    block_count = (offset + len + BLOCK_LEN - 1) / BLOCK_LEN;
 
     mmc_spi_set_cs(mmc, 0);
 
@@ -623,18 +701,7 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
 
     index = 0;
     while (block_count--) {
-        /**
-         * 7.3.3 Control tokens
-         *   Wait up to 200ms for control token.
-         */
-        timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-        do {
-            mmc_spi_rx(mmc, &res, 1);
-            if (res != 0xFF) {
-                break;
-            }
-            os_time_delay(OS_TICKS_PER_SEC / 20);
-        } while (os_time_get() < timeout);
+        res = wait_token(mmc);
 
         /**
          * 7.3.3.2 Start Block Tokens and Stop Tran Token
@@ -644,13 +711,18 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
             goto out;
         }
 
-        mmc_spi_rx(mmc, g_block_buf, BLOCK_LEN + 2 /* CRC */);
+        amount = MIN(BLOCK_LEN - offset, len);
 
         /* TODO: CRC-16 not used here but would be cool to have */
 
-        amount = MIN(BLOCK_LEN - offset, len);
-
-        memcpy(((uint8_t *)buf + index), &g_block_buf[offset], amount);
+        if (amount == BLOCK_LEN) {
+            /* Whole block: receive straight into the caller's buffer. */
+            mmc_spi_rx(mmc, (uint8_t *)buf + index, BLOCK_LEN);
+            mmc_spi_rx(mmc, crc, sizeof(crc));
+        } else {
+            mmc_spi_rx(mmc, g_block_buf, BLOCK_LEN + 2 /* CRC */);
+            memcpy(((uint8_t *)buf + index), &g_block_buf[offset], amount);
+        }
 
         offset = 0;
         len -= amount;
@@ -675,13 +747,12 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
 {
     uint8_t cmd;
     uint8_t res;
-    size_t block_len;
     size_t block_count;
-    os_time_t timeout;
     uint32_t block_addr;
     size_t offset;
     size_t index;
     size_t amount;
+    uint8_t crc[2];
     int rc;
     struct mmc *mmc;
 
@@ -690,10 +761,9 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
         return (MMC_DEVICE_ERROR);
     }
 
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
     block_addr = addr / BLOCK_LEN;
     offset = addr - (block_addr * BLOCK_LEN);
+    block_count = (offset + len + BLOCK_LEN - 1) / BLOCK_LEN;
 
     mmc_spi_set_cs(mmc, 0);
 
@@ -712,15 +782,7 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
             goto out;
         }
 
-        timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-        do {
-            mmc_spi_rx(mmc, &res, 1);
-            if (res != 0xff) {
-                break;
-            }
-            os_time_delay(OS_TICKS_PER_SEC / 20);
-        } while (os_time_get() < timeout);
-
+        res = wait_token(mmc);
         if (res != START_BLOCK) {
             rc = MMC_CARD_ERROR;
             goto out;
@@ -750,12 +812,19 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
         }
 
         amount = MIN(BLOCK_LEN - offset, len);
-        memcpy(&g_block_buf[offset], ((uint8_t *)buf + index), amount);
 
         /* CRC */
-        g_block_buf[BLOCK_LEN] = 0xFF;
-        g_block_buf[BLOCK_LEN + 1] = 0xFF;
-        mmc_spi_tx(mmc, g_block_buf, BLOCK_LEN + 2);
+        crc[0] = 0xFF;
+        crc[1] = 0xFF;
+
+        if (amount == BLOCK_LEN) {
+            /* Whole block: send straight from the caller's buffer. */
+            mmc_spi_tx(mmc, (const uint8_t *)buf + index, BLOCK_LEN);
+        } else {
+            memcpy(&g_block_buf[offset], ((uint8_t *)buf + index), amount);
+            mmc_spi_tx(mmc, g_block_buf, BLOCK_LEN);
+        }
+        mmc_spi_tx(mmc, crc, sizeof(crc));
 
         /**
          * 7.3.3.1 Data Response Token
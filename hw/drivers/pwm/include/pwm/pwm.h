@@ -29,6 +29,7 @@ extern "C" {
 struct pwm_dev;
 struct pwm_dev_cfg;
 struct pwm_chan_cfg;
+struct pwm_seq;
 
 /**
  * Configure a PWM device.
@@ -141,8 +142,30 @@ typedef int (*pwm_get_resolution_bits_func_t) (struct pwm_dev *);
  */
 typedef int (*pwm_disable_func_t) (struct pwm_dev *);
 
+/**
+ * Play a sequence of duty cycles from memory, see struct pwm_seq.
+ * The device plays the sequence in place of its current duty cycles
+ * until pwm_disable() is called or the sequence ends.
+ *
+ * @param dev The device to play the sequence on.
+ * @param seq The sequence; must stay valid while it plays.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*pwm_play_seq_func_t) (struct pwm_dev *, struct pwm_seq *);
+
 typedef void (*user_handler_t) (void*);
 
+/**
+ * Called from interrupt context when the device is done with a sequence
+ * buffer.
+ *
+ * @param dev The device playing the sequence.
+ * @param buf The buffer that finished playing.
+ * @param arg User data from the sequence.
+ */
+typedef void (*pwm_seq_buf_done_t) (struct pwm_dev *, uint16_t *, void *);
+
 struct pwm_driver_funcs {
     pwm_config_device_func_t pwm_configure_device;
     pwm_config_channel_func_t pwm_configure_channel;
@@ -154,6 +177,7 @@ struct pwm_driver_funcs {
     pwm_get_top_value_funct_t pwm_get_top_value;
     pwm_get_resolution_bits_func_t pwm_get_resolution_bits;
     pwm_disable_func_t pwm_disable;
+    pwm_play_seq_func_t pwm_play_seq;
 };
 
 struct pwm_dev {
@@ -202,6 +226,37 @@ struct pwm_dev_cfg {
     void* data;
 };
 
+/**
+ * PWM sequence, a waveform played by the PWM peripheral's DMA without
+ * CPU involvement, one step per PWM period.
+ *
+ * bufs - One or two buffers of duty cycle values, in the units of
+ * pwm_set_duty_cycle().  With two buffers the device alternates between
+ * them, so one can be refilled from buf_done while the other plays.
+ * len - Number of values in each buffer, a multiple of chans.
+ * chans - Number of channels set by each step, starting with channel 0;
+ * the values of one step are consecutive.  Drivers may support only some
+ * counts.
+ * loop - Play until pwm_disable(), instead of once through the buffers.
+ * buf_done - Called as each buffer finishes, NULL for no calls.  Only a
+ * second buffer can be refilled safely, a single buffer is replayed at
+ * once.
+ * arg - User data passed to buf_done.
+ *
+ * Drivers may convert the values to hardware format in place, also after
+ * buf_done returns.  The seq_end_handler of the device configuration is
+ * called when a sequence which does not loop has ended; the outputs then
+ * keep the last duty cycles until pwm_disable().
+ */
+struct pwm_seq {
+    uint16_t *bufs[2];
+    uint16_t len;
+    uint8_t chans;
+    bool loop;
+    pwm_seq_buf_done_t buf_done;
+    void *arg;
+};
+
 int pwm_configure_device(struct pwm_dev *dev, struct pwm_dev_cfg *cfg);
 int pwm_configure_channel(struct pwm_dev *dev, uint8_t cnum, struct pwm_chan_cfg *cfg);
 int pwm_set_duty_cycle(struct pwm_dev *pwm_d, uint8_t cnum, uint16_t fraction);
@@ -212,6 +267,7 @@ int pwm_get_clock_freq(struct pwm_dev *dev);
 int pwm_get_top_value(struct pwm_dev *dev);
 int pwm_get_resolution_bits(struct pwm_dev *dev);
 int pwm_disable(struct pwm_dev *dev);
+int pwm_play_seq(struct pwm_dev *dev, struct pwm_seq *seq);
 
 #ifdef __cplusplus
 }
@@ -50,6 +50,8 @@ struct nrf52_pwm_dev_global {
     user_handler_t seq_end_handler;
     void* cycle_data;
     void* seq_end_data;
+    struct pwm_dev *dev;
+    struct pwm_seq *seq;
 };
 
 static struct nrf52_pwm_dev_global instances[] =
@@ -124,18 +126,49 @@ static struct nrf52_pwm_dev_global instances[] =
 #endif
 };
 
-#if MYNEWT_VAL(PWM_0)
+/**
+ * Convert sequence values to hardware format, in place.  Bit 15 selects
+ * the polarity of the output: with it set the output is high for the
+ * compare value, which is the duty cycle of a non-inverted channel.
+ * Converting twice is harmless.
+ */
 static void
-handler_0(nrfx_pwm_evt_type_t event_type, void *unused)
+seq_convert(struct nrf52_pwm_dev_global *instance, uint16_t *buf)
 {
+    const struct pwm_seq *seq = instance->seq;
+    int i;
+
+    for (i = 0; i < seq->len; i++) {
+        if (instance->config.pin_inverted[i % seq->chans]) {
+            buf[i] &= ~0x8000;
+        } else {
+            buf[i] |= 0x8000;
+        }
+    }
+}
+
+static void
+nrf52_pwm_handler(struct nrf52_pwm_dev_global *instance,
+                  nrfx_pwm_evt_type_t event_type)
+{
+    struct pwm_seq *seq = instance->seq;
+    uint16_t *buf;
+
     switch (event_type) {
     case NRFX_PWM_EVT_END_SEQ0:
     case NRFX_PWM_EVT_END_SEQ1:
-        instances[0].cycle_handler(instances[0].cycle_data);
+        if (seq) {
+            buf = seq->bufs[1] && event_type == NRFX_PWM_EVT_END_SEQ1 ?
+                  seq->bufs[1] : seq->bufs[0];
+            seq->buf_done(instance->dev, buf, seq->arg);
+            seq_convert(instance, buf);
+        } else {
+            instance->cycle_handler(instance->cycle_data);
+        }
         break;
 
     case NRFX_PWM_EVT_FINISHED:
-        instances[0].seq_end_handler(instances[0].seq_end_data);
+        instance->seq_end_handler(instance->seq_end_data);
         break;
 
     case NRFX_PWM_EVT_STOPPED:
@@ -145,28 +178,20 @@ handler_0(nrfx_pwm_evt_type_t event_type, void *unused)
         assert(0);
     }
 }
+
+#if MYNEWT_VAL(PWM_0)
+static void
+handler_0(nrfx_pwm_evt_type_t event_type, void *unused)
+{
+    nrf52_pwm_handler(&instances[0], event_type);
+}
 #endif
 
 #if MYNEWT_VAL(PWM_1)
 static void
 handler_1(nrfx_pwm_evt_type_t event_type, void *unused)
 {
-    switch (event_type) {
-    case NRFX_PWM_EVT_END_SEQ0:
-    case NRFX_PWM_EVT_END_SEQ1:
-        instances[1].cycle_handler(instances[1].cycle_data);
-        break;
-
-    case NRFX_PWM_EVT_FINISHED:
-        instances[1].seq_end_handler(instances[1].seq_end_data);
-        break;
-
-    case NRFX_PWM_EVT_STOPPED:
-        break;
-
-    default:
-        assert(0);
-    }
+    nrf52_pwm_handler(&instances[1], event_type);
 }
 #endif
 
@@ -174,23 +199,7 @@ handler_1(nrfx_pwm_evt_type_t event_type, void *unused)
 static void
 handler_2(nrfx_pwm_evt_type_t event_type, void *unused)
 {
-    switch (event_type) {
-    case NRFX_PWM_EVT_END_SEQ0:
-    case NRFX_PWM_EVT_END_SEQ1:
-        instances[2].cycle_handler(instances[2].cycle_data);
-        break;
-
-    case NRFX_PWM_EVT_FINISHED:
-        instances[2].seq_end_handler(instances[2].seq_end_data);
-        break;
-
-    case NRFX_PWM_EVT_STOPPED:
-        break;
-
-    default:
-        assert(0);
-    }
-
+    nrf52_pwm_handler(&instances[2], event_type);
 }
 #endif
 
@@ -198,22 +207,7 @@ handler_2(nrfx_pwm_evt_type_t event_type, void *unused)
 static void
 handler_3(nrfx_pwm_evt_type_t event_type, void *unused)
 {
-    switch (event_type) {
-    case NRFX_PWM_EVT_END_SEQ0:
-    case NRFX_PWM_EVT_END_SEQ1:
-        instances[3].cycle_handler(instances[3].cycle_data);
-        break;
-
-    case NRFX_PWM_EVT_FINISHED:
-        instances[3].seq_end_handler(instances[3].seq_end_data);
-        break;
-
-    case NRFX_PWM_EVT_STOPPED:
-        break;
-
-    default:
-        assert(0);
-    }
+    nrf52_pwm_handler(&instances[3], event_type);
 }
 #endif
 
@@ -280,6 +274,7 @@ cleanup_instance(int inst_id)
     instances[inst_id].seq_end_handler = NULL;
     instances[inst_id].cycle_data = NULL;
     instances[inst_id].seq_end_data = NULL;
+    instances[inst_id].seq = NULL;
     memset((uint16_t *) &instances[inst_id].duty_cycles,
            0x00,
            4 * sizeof(uint16_t));
@@ -372,12 +367,51 @@ nrf52_pwm_close(struct os_dev *odev)
     return (0);
 }
 
+/**
+ * Play the current sequence.  A single buffer is played through both
+ * hardware sequence slots.
+ */
+static void
+play_seq_config(struct nrf52_pwm_dev_global *instance)
+{
+    struct pwm_seq *seq = instance->seq;
+    nrf_pwm_sequence_t seq0 = {
+        .values.p_raw = seq->bufs[0],
+        .length = seq->len,
+        .repeats = 0,
+        .end_delay = 0
+    };
+    nrf_pwm_sequence_t seq1 = seq0;
+    nrfx_pwm_flag_t flags;
+
+    flags = seq->loop ? NRFX_PWM_FLAG_LOOP : 0;
+    if (seq->buf_done) {
+        flags |= NRFX_PWM_FLAG_SIGNAL_END_SEQ0 | NRFX_PWM_FLAG_SIGNAL_END_SEQ1;
+    }
+    if (!instance->seq_end_handler) {
+        flags |= NRFX_PWM_FLAG_NO_EVT_FINISHED;
+    }
+
+    if (seq->bufs[1]) {
+        seq1.values.p_raw = seq->bufs[1];
+        nrfx_pwm_complex_playback(&instance->drv_instance, &seq0, &seq1, 1,
+                                  flags);
+    } else {
+        nrfx_pwm_simple_playback(&instance->drv_instance, &seq0, 1, flags);
+    }
+}
+
 /**
  * Play using current configuration.
  */
 static void
 play_current_config(struct nrf52_pwm_dev_global *instance)
 {
+    if (instance->seq) {
+        play_seq_config(instance);
+        return;
+    }
+
     nrf_pwm_sequence_t const seq =
         {
             .values.p_individual = &instance->duty_cycles,
@@ -531,6 +565,69 @@ nrf52_pwm_enable(struct pwm_dev *dev)
     int inst_id = dev->pwm_instance_id;
     struct nrf52_pwm_dev_global *instance = &instances[inst_id];
 
+    if (instance->seq) {
+        /* Switch back from a sequence to the channel duty cycles */
+        if (instance->playing) {
+            nrfx_pwm_uninit(&instance->drv_instance);
+        }
+        instance->seq = NULL;
+        instance->config.load_mode = NRF_PWM_LOAD_INDIVIDUAL;
+    }
+
+    nrfx_pwm_init(&instance->drv_instance,
+                  &instance->config,
+                  instance->internal_handler,
+                  NULL);
+    play_current_config(instance);
+    instance->playing = true;
+
+    return (0);
+}
+
+/**
+ * Play a sequence of duty cycles through EasyDMA.  One value per step
+ * sets all channels alike (common load mode), four set each channel
+ * (individual load mode).
+ *
+ * @param dev The device to play the sequence on.
+ * @param seq The sequence.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+static int
+nrf52_pwm_play_seq(struct pwm_dev *dev, struct pwm_seq *seq)
+{
+    int inst_id = dev->pwm_instance_id;
+    struct nrf52_pwm_dev_global *instance = &instances[inst_id];
+    nrfx_pwm_handler_t handler;
+
+    if (!instance->in_use) {
+        return (EINVAL);
+    }
+    if ((seq->chans != 1 && seq->chans != NRF_PWM_CHANNEL_COUNT) ||
+        seq->len > PWM_SEQ_CNT_CNT_Msk) {
+        return (EINVAL);
+    }
+
+    if (instance->playing) {
+        nrfx_pwm_uninit(&instance->drv_instance);
+        instance->playing = false;
+    }
+
+    instance->seq = seq;
+    instance->config.load_mode = seq->chans == 1 ? NRF_PWM_LOAD_COMMON :
+                                                   NRF_PWM_LOAD_INDIVIDUAL;
+    seq_convert(instance, seq->bufs[0]);
+    if (seq->bufs[1]) {
+        seq_convert(instance, seq->bufs[1]);
+    }
+
+    handler = NULL;
+    if (seq->buf_done || instance->seq_end_handler) {
+        handler = internal_handlers[inst_id];
+    }
+    instance->internal_handler = handler;
+
     nrfx_pwm_init(&instance->drv_instance,
                   &instance->config,
                   instance->internal_handler,
@@ -576,6 +673,7 @@ nrf52_pwm_disable(struct pwm_dev *dev)
 
     nrfx_pwm_uninit(&instances[inst_id].drv_instance);
     instances[inst_id].playing = false;
+    instances[inst_id].seq = NULL;
 
     return (0);
 }
@@ -834,6 +932,7 @@ nrf52_pwm_dev_init(struct os_dev *odev, void *arg)
     }
 
     dev->pwm_chan_count = NRF_PWM_CHANNEL_COUNT;
+    instances[dev->pwm_instance_id].dev = dev;
     os_mutex_init(&dev->pwm_lock);
 
     OS_DEV_SETHANDLERS(odev, nrf52_pwm_open, nrf52_pwm_close);
@@ -849,6 +948,7 @@ nrf52_pwm_dev_init(struct os_dev *odev, void *arg)
     pwm_funcs->pwm_get_top_value = nrf52_pwm_get_top_value;
     pwm_funcs->pwm_get_resolution_bits = nrf52_pwm_get_resolution_bits;
     pwm_funcs->pwm_disable = nrf52_pwm_disable;
+    pwm_funcs->pwm_play_seq = nrf52_pwm_play_seq;
 
     switch (dev->pwm_instance_id) {
 #if MYNEWT_VAL(PWM_0)
@@ -21,6 +21,7 @@
 #define __PWM_STM32_H__
 
 #include <pwm/pwm.h>
+#include <stm32_common/stm32_dma.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,6 +49,15 @@ extern "C" {
  * STM32_PWM_ERR_GPIO    ... an error occured during IO pin configuration
  * STM32_PWM_ERR_NOIRQ   ... the device was registered without IRQ support but
  *                           later cycle and/or sequence support was requested
+ * STM32_PWM_ERR_NODMA   ... a DMA sequence was requested but the device has
+ *                           no DMA stream configured, or the stream could not
+ *                           be set up
+ *
+ * DMA sequences (pwm_play_seq()) need HAL_DMA and a DMA stream serving the
+ * update request of the timer; set has_dma, dma_ch (the stream) and dma_req
+ * (DMA_CHANNEL_x of the request) in the configuration.  Each update event
+ * bursts the values of one step into CCR1 onwards through TIMx_DMAR.  Only
+ * 16 bit timers are supported.
  */
 
 #define STM32_PWM_ERR_OK       0
@@ -57,10 +67,14 @@ extern "C" {
 #define STM32_PWM_ERR_FREQ     4
 #define STM32_PWM_ERR_GPIO     5
 #define STM32_PWM_ERR_NOIRQ    6
+#define STM32_PWM_ERR_NODMA    7
 
 typedef struct stm32_pwm_conf {
     TIM_TypeDef   *tim;
     uint16_t       irq;
+    bool           has_dma;
+    stm32_dma_ch_t dma_ch;
+    uint32_t       dma_req;
 } stm32_pwm_conf_t;
 
 int stm32_pwm_dev_init(struct os_dev *dev, void *struct_stm32_pwm_conf_pointer);
@@ -20,6 +20,7 @@
 
 #include <bsp.h>
 #include <hal/hal_bsp.h>
+#include <hal/hal_dma.h>
 #include <mcu/cmsis_nvic.h>
 #include <os/os.h>
 #include <pwm/pwm.h>
@@ -49,6 +50,16 @@ typedef struct {
     uint16_t             pin[STM32_PWM_CH_MAX];
     uint16_t             irq;
     stm32_pwm_dev_cfg_t  cfg;
+#if MYNEWT_VAL(HAL_DMA)
+    struct pwm_dev      *dev;
+    struct pwm_seq      *seq;
+    struct hal_dma_desc  seq_desc;
+    int                  dma;
+    uint8_t              seq_buf;
+    bool                 has_dma;
+    stm32_dma_ch_t       dma_ch;
+    uint32_t             dma_req;
+#endif
 } stm32_pwm_dev_t;
 
 static stm32_pwm_dev_t stm32_pwm_dev[PWM_CNT];
@@ -122,6 +133,13 @@ stm32_pwm_isr(stm32_pwm_dev_t *pwm)
         pwm->cfg.cycle_handler(pwm->cfg.cycle_data);
     }
 
+#if MYNEWT_VAL(HAL_DMA)
+    /* A sequence has its own length */
+    if (pwm->seq) {
+        return;
+    }
+#endif
+
     if (pwm->cfg.n_cycles) {
         if (!pwm->cycle) {
 
@@ -159,6 +177,121 @@ stm32_pwm_isr_2(void)
     stm32_pwm_isr(&stm32_pwm_dev[2]);
 }
 
+#if MYNEWT_VAL(HAL_DMA)
+static void
+stm32_pwm_seq_stop(stm32_pwm_dev_t *pwm)
+{
+    if (pwm->seq) {
+        LL_TIM_DisableDMAReq_UPDATE(pwm->timx);
+        hal_dma_stop(pwm->dma);
+        pwm->seq = NULL;
+    }
+}
+
+static int
+stm32_pwm_seq_start_buf(stm32_pwm_dev_t *pwm)
+{
+    pwm->seq_desc.hdd_src = pwm->seq->bufs[pwm->seq_buf];
+    pwm->seq_desc.hdd_dst = (void *)&pwm->timx->DMAR;
+    pwm->seq_desc.hdd_len = pwm->seq->len * sizeof(uint16_t);
+    pwm->seq_desc.hdd_next = NULL;
+
+    return hal_dma_start(pwm->dma, &pwm->seq_desc);
+}
+
+/*
+ * The next buffer is started before buf_done is called.  An update request
+ * raised meanwhile stays pending until the stream serves it, so steps
+ * follow each other without a gap as long as this runs within one period.
+ */
+static void
+stm32_pwm_seq_dma_done(void *arg, int status)
+{
+    stm32_pwm_dev_t *pwm = arg;
+    struct pwm_seq *seq = pwm->seq;
+    uint16_t *buf;
+    bool last;
+
+    if (!seq) {
+        return;
+    }
+
+    buf = seq->bufs[pwm->seq_buf];
+    if (seq->bufs[1]) {
+        pwm->seq_buf ^= 1;
+    }
+    last = status || (!seq->loop && pwm->seq_buf == 0);
+    if (!last && stm32_pwm_seq_start_buf(pwm)) {
+        last = true;
+    }
+
+    if (seq->buf_done) {
+        seq->buf_done(pwm->dev, buf, seq->arg);
+    }
+
+    if (last) {
+        LL_TIM_DisableDMAReq_UPDATE(pwm->timx);
+        pwm->seq = NULL;
+        if (pwm->cfg.seq_end_handler) {
+            pwm->cfg.seq_end_handler(pwm->cfg.seq_end_data);
+        }
+    }
+}
+
+static int
+stm32_pwm_play_seq(struct pwm_dev *dev, struct pwm_seq *seq)
+{
+    stm32_pwm_dev_t *pwm;
+    struct hal_dma_cfg dma_cfg = {
+        .hdc_dir = HAL_DMA_MEM_TO_PERIPH,
+        .hdc_width = 2,
+        .hdc_priority = 3,
+        .hdc_done_cb = stm32_pwm_seq_dma_done,
+    };
+    int rc;
+
+    pwm = &stm32_pwm_dev[dev->pwm_instance_id];
+    if (!pwm->has_dma) {
+        return STM32_PWM_ERR_NODMA;
+    }
+#ifdef IS_TIM_32B_COUNTER_INSTANCE
+    /* Half word writes to 32 bit CCRs are replicated to both halves */
+    if (IS_TIM_32B_COUNTER_INSTANCE(pwm->timx)) {
+        return STM32_PWM_ERR_NODMA;
+    }
+#endif
+
+    stm32_pwm_seq_stop(pwm);
+    if (pwm->dma < 0) {
+        dma_cfg.hdc_request = pwm->dma_req;
+        dma_cfg.hdc_done_arg = pwm;
+        rc = hal_dma_channel_request(pwm->dma_ch, &dma_cfg);
+        if (rc < 0) {
+            return STM32_PWM_ERR_NODMA;
+        }
+        pwm->dma = rc;
+    }
+
+    LL_TIM_DisableCounter(pwm->timx);
+    LL_TIM_ConfigDMABurst(pwm->timx, LL_TIM_DMABURST_BASEADDR_CCR1,
+                          (uint32_t)(seq->chans - 1) << TIM_DCR_DBL_Pos);
+
+    pwm->seq = seq;
+    pwm->seq_buf = 0;
+    if (stm32_pwm_seq_start_buf(pwm)) {
+        pwm->seq = NULL;
+        return STM32_PWM_ERR_NODMA;
+    }
+
+    stm32_pwm_active_ch_set_mode(pwm, STM32_PWM_CH_MODE_ENA);
+    LL_TIM_SetCounter(pwm->timx, 0);
+    LL_TIM_EnableDMAReq_UPDATE(pwm->timx);
+    LL_TIM_EnableCounter(pwm->timx);
+
+    return STM32_PWM_ERR_OK;
+}
+#endif
+
 static int
 stm32_pwm_enable(struct pwm_dev *dev)
 {
@@ -166,6 +299,9 @@ stm32_pwm_enable(struct pwm_dev *dev)
 
     pwm = &stm32_pwm_dev[dev->pwm_instance_id];
     pwm->cycle = pwm->cfg.n_cycles;
+#if MYNEWT_VAL(HAL_DMA)
+    stm32_pwm_seq_stop(pwm);
+#endif
 
     stm32_pwm_active_ch_set_mode(pwm, STM32_PWM_CH_MODE_ENA);
 
@@ -184,6 +320,9 @@ stm32_pwm_disable(struct pwm_dev *dev)
 
     LL_TIM_DisableCounter(pwm->timx);
     LL_TIM_SetCounter(pwm->timx, 0);
+#if MYNEWT_VAL(HAL_DMA)
+    stm32_pwm_seq_stop(pwm);
+#endif
 
     return STM32_PWM_ERR_OK;
 }
@@ -458,6 +597,13 @@ stm32_pwm_dev_init(struct os_dev *odev, void *arg)
 
     pwm->timx = cfg->tim;
     pwm->irq  = cfg->irq;
+#if MYNEWT_VAL(HAL_DMA)
+    pwm->dev     = (struct pwm_dev *)odev;
+    pwm->dma     = -1;
+    pwm->has_dma = cfg->has_dma;
+    pwm->dma_ch  = cfg->dma_ch;
+    pwm->dma_req = cfg->dma_req;
+#endif
 
     LL_TIM_SetPrescaler(cfg->tim, 0xffff);
     LL_TIM_SetAutoReload(cfg->tim, 0);
@@ -610,6 +756,9 @@ stm32_pwm_dev_init(struct os_dev *odev, void *arg)
     dev->pwm_funcs.pwm_is_enabled = stm32_pwm_is_enabled;
     dev->pwm_funcs.pwm_set_duty_cycle = stm32_pwm_ch_set_duty_cycle;
     dev->pwm_funcs.pwm_set_frequency = stm32_pwm_set_frequency;
+#if MYNEWT_VAL(HAL_DMA)
+    dev->pwm_funcs.pwm_play_seq = stm32_pwm_play_seq;
+#endif
 
     os_mutex_init(&dev->pwm_lock);
     OS_DEV_SETHANDLERS(odev, stm32_pwm_open, stm32_pwm_close);
@@ -205,3 +205,30 @@ pwm_disable(struct pwm_dev *dev)
 
     return (dev->pwm_funcs.pwm_disable(dev));
 }
+
+/**
+ * Play a sequence of duty cycles from memory through the device's DMA.
+ * The sequence replaces the duty cycles set with pwm_set_duty_cycle()
+ * until pwm_disable() is called or the sequence ends.
+ *
+ * @param dev The device to play the sequence on.
+ * @param seq The sequence; must stay valid while it plays.
+ *
+ * @return 0 on success, ENOTSUP if the device cannot play sequences,
+ * EINVAL on bad sequence, or a driver error code.
+ */
+int
+pwm_play_seq(struct pwm_dev *dev, struct pwm_seq *seq)
+{
+    assert(dev);
+    assert(seq);
+    if (dev->pwm_funcs.pwm_play_seq == NULL) {
+        return (ENOTSUP);
+    }
+    if (!seq->bufs[0] || !seq->len || !seq->chans ||
+        seq->chans > dev->pwm_chan_count || seq->len % seq->chans) {
+        return (EINVAL);
+    }
+
+    return (dev->pwm_funcs.pwm_play_seq(dev, seq));
+}
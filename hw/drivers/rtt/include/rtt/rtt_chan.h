@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_RTT_CHAN_
+#define H_RTT_CHAN_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Binary RTT up-channel (target -> host).
+ *
+ * Each channel owns one RTT up-buffer, allocated from the pool sized by
+ * RTT_NUM_BUFFERS_UP.  Producers either write complete records with
+ * rtt_chan_write(), or write in place: rtt_chan_reserve() returns the
+ * contiguous free space at the write offset and rtt_chan_commit() publishes
+ * what was filled in.  Data that does not fit is dropped, never waited for,
+ * and counted.
+ */
+struct rtt_chan {
+    /** RTT up-buffer index; private. */
+    int rc_index;
+    /** Writes dropped because the host did not keep up. */
+    uint32_t rc_drops;
+    /** Bytes lost with those writes. */
+    uint32_t rc_dropped_bytes;
+};
+
+/**
+ * Sets up a binary channel.
+ *
+ * @param chan                  The channel to initialize.
+ * @param name                  Channel name shown by the host tools; must
+ *                                  stay valid.
+ * @param buf                   Up-buffer memory; must stay valid.
+ * @param size                  Size of buf, in bytes.
+ *
+ * @return                      0 on success; SYS_ENOMEM if no RTT up-buffer
+ *                                  is left.
+ */
+int rtt_chan_init(struct rtt_chan *chan, const char *name, void *buf,
+                  unsigned size);
+
+/**
+ * Writes a record as a whole, or drops it if it does not fit.  Safe to call
+ * from any context.
+ *
+ * @return                      0 if written; SYS_ENOMEM if dropped.
+ */
+int rtt_chan_write(struct rtt_chan *chan, const void *data, unsigned len);
+
+/**
+ * Reserves space for in-place writing.  Only one reservation per channel
+ * may be outstanding; producers sharing a channel must serialize
+ * reserve/commit themselves.
+ *
+ * @param chan                  The channel to write to.
+ * @param min_len               Least number of contiguous bytes needed.  If
+ *                                  less is free, the reservation fails and
+ *                                  min_len bytes are counted as dropped.
+ * @param len                   On success, the number of contiguous bytes
+ *                                  available at the returned address.  This
+ *                                  may be less than the total free space
+ *                                  when the buffer wraps.
+ *
+ * @return                      Where to write; NULL if not enough space.
+ */
+void *rtt_chan_reserve(struct rtt_chan *chan, unsigned min_len,
+                       unsigned *len);
+
+/**
+ * Publishes bytes written into a reservation.
+ *
+ * @param chan                  The channel written to.
+ * @param len                   Number of bytes written; at most the length
+ *                                  returned by rtt_chan_reserve().
+ */
+void rtt_chan_commit(struct rtt_chan *chan, unsigned len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
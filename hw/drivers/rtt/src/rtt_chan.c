@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "rtt/SEGGER_RTT.h"
+#include "rtt/rtt_chan.h"
+
+static volatile SEGGER_RTT_BUFFER_UP *
+rtt_chan_ring(const struct rtt_chan *chan)
+{
+    volatile SEGGER_RTT_CB *cb;
+
+    /* Uncached, so the host sees the offsets as soon as they change. */
+    cb = (volatile SEGGER_RTT_CB *)((uint8_t *)&_SEGGER_RTT +
+                                    SEGGER_RTT_UNCACHED_OFF);
+    return &cb->aUp[chan->rc_index];
+}
+
+/* Free bytes in the ring and, of those, how many are contiguous. */
+static unsigned
+rtt_chan_space(volatile SEGGER_RTT_BUFFER_UP *ring, unsigned *contig)
+{
+    unsigned rd;
+    unsigned wr;
+
+    rd = ring->RdOff;
+    wr = ring->WrOff;
+
+    if (rd > wr) {
+        *contig = rd - wr - 1;
+        return *contig;
+    }
+
+    /* One byte stays unused so a full ring is distinguishable. */
+    *contig = ring->SizeOfBuffer - wr - (rd == 0 ? 1 : 0);
+    return ring->SizeOfBuffer - 1 - wr + rd;
+}
+
+static void
+rtt_chan_drop(struct rtt_chan *chan, unsigned len)
+{
+    chan->rc_drops++;
+    chan->rc_dropped_bytes += len;
+}
+
+int
+rtt_chan_init(struct rtt_chan *chan, const char *name, void *buf,
+              unsigned size)
+{
+    int idx;
+
+    idx = SEGGER_RTT_AllocUpBuffer(name, buf, size,
+                                   SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    if (idx < 0) {
+        return SYS_ENOMEM;
+    }
+
+    chan->rc_index = idx;
+    chan->rc_drops = 0;
+    chan->rc_dropped_bytes = 0;
+
+    return 0;
+}
+
+int
+rtt_chan_write(struct rtt_chan *chan, const void *data, unsigned len)
+{
+    volatile SEGGER_RTT_BUFFER_UP *ring;
+    unsigned contig;
+    unsigned wr;
+    os_sr_t sr;
+    int rc;
+
+    ring = rtt_chan_ring(chan);
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (rtt_chan_space(ring, &contig) < len) {
+        rtt_chan_drop(chan, len);
+        rc = SYS_ENOMEM;
+    } else {
+        wr = ring->WrOff;
+        if (contig >= len) {
+            memcpy((char *)ring->pBuffer + wr, data, len);
+            wr += len;
+        } else {
+            contig = ring->SizeOfBuffer - wr;
+            memcpy((char *)ring->pBuffer + wr, data, contig);
+            memcpy((char *)ring->pBuffer, (const uint8_t *)data + contig,
+                   len - contig);
+            wr = len - contig;
+        }
+        if (wr == ring->SizeOfBuffer) {
+            wr = 0;
+        }
+        RTT__DMB();
+        ring->WrOff = wr;
+        rc = 0;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+void *
+rtt_chan_reserve(struct rtt_chan *chan, unsigned min_len, unsigned *len)
+{
+    volatile SEGGER_RTT_BUFFER_UP *ring;
+    unsigned contig;
+
+    ring = rtt_chan_ring(chan);
+
+    rtt_chan_space(ring, &contig);
+    if (contig == 0 || contig < min_len) {
+        rtt_chan_drop(chan, min_len);
+        return NULL;
+    }
+
+    *len = contig;
+    return (char *)ring->pBuffer + ring->WrOff;
+}
+
+void
+rtt_chan_commit(struct rtt_chan *chan, unsigned len)
+{
+    volatile SEGGER_RTT_BUFFER_UP *ring;
+    unsigned wr;
+
+    ring = rtt_chan_ring(chan);
+
+    wr = ring->WrOff + len;
+    if (wr == ring->SizeOfBuffer) {
+        wr = 0;
+    }
+
+    /* Data must be in memory before the host can see the new offset. */
+    RTT__DMB();
+    ring->WrOff = wr;
+}
@@ -446,6 +446,41 @@ bme280_compensate_humidity(struct sensor_itf *itf, uint32_t rawhumid,
 
 #endif
 
+/**
+ * Gets temperature, pressure and humidity with a single burst read of
+ * PRESS_MSB .. HUM_LSB, this also guarantees all three come from the same
+ * measurement.
+ *
+ * @param The sensor interface
+ * @param uncompensated raw temperature
+ * @param uncompensated raw pressure
+ * @param uncompensated raw humidity
+ *
+ * @return 0 on success, and non-zero error code on failure
+ */
+static int
+bme280_get_data(struct sensor_itf *itf, int32_t *temp, int32_t *press,
+                int32_t *humid)
+{
+    int rc;
+    uint8_t tmp[8];
+
+    rc = bme280_readlen(itf, BME280_REG_ADDR_PRESS, tmp, sizeof(tmp));
+    if (rc) {
+        return rc;
+    }
+
+    *press = (int32_t)((((uint32_t)(tmp[0])) << 12) |
+                       (((uint32_t)(tmp[1])) <<  4) |
+                        ((uint32_t)tmp[2] >> 4));
+    *temp = (int32_t)((((uint32_t)(tmp[3])) << 12) |
+                      (((uint32_t)(tmp[4])) <<  4) |
+                       ((uint32_t)tmp[5] >> 4));
+    *humid = (tmp[6] << 8 | tmp[7]);
+
+    return 0;
+}
+
 static int
 bme280_sensor_read(struct sensor *sensor, sensor_type_t type,
         sensor_data_func_t data_func, void *data_arg, uint32_t timeout)
@@ -486,29 +521,16 @@ bme280_sensor_read(struct sensor *sensor, sensor_type_t type,
 
     rawtemp = rawpress = rawhumid = 0;
 
-    /* Get a new temperature sample always */
-    rc = bme280_get_temperature(itf, &rawtemp);
+    /*
+     * Get new temperature, pressure and humidity samples in one burst,
+     * temperature is needed for compensation of the other two
+     */
+    rc = bme280_get_data(itf, &rawtemp, &rawpress, &rawhumid);
     if (rc) {
         goto err;
     }
     databuf.std.std_temp = bme280_compensate_temperature(rawtemp, &(bme280->pdd));
 
-    /* Get a new pressure sample */
-    if (type & SENSOR_TYPE_PRESSURE) {
-        rc = bme280_get_pressure(itf, &rawpress);
-        if (rc) {
-            goto err;
-        }
-    }
-
-    /* Get a new relative humidity sample */
-    if (type & SENSOR_TYPE_RELATIVE_HUMIDITY) {
-        rc = bme280_get_humidity(itf, &rawhumid);
-        if (rc) {
-            goto err;
-        }
-    }
-
     if (type & SENSOR_TYPE_AMBIENT_TEMPERATURE) {
         if (databuf.std.std_temp != NAN) {
             databuf.std.std_temp_is_valid = 1;
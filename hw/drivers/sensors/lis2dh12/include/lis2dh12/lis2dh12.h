@@ -26,6 +26,9 @@
 #include "bus/drivers/i2c_common.h"
 #include "bus/drivers/spi_common.h"
 #endif
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+#include "sensor/regmap.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -255,6 +258,9 @@ struct lis2dh12_int {
     struct sensor_int *ints;
 };
 
+/* Number of registers in CTRL_REG0 .. ACT_DUR covered by the cache */
+#define LIS2DH12_REG_CACHE_SIZE                 34
+
 /* Private per driver data */
 struct lis2dh12_pdd {
     /* Notification event context */
@@ -265,6 +271,10 @@ struct lis2dh12_pdd {
     uint8_t int_enable[2];
     /* State of pin for sleep/wake up handling */
     uint8_t int2_pin_state;
+#if MYNEWT_VAL(SENSOR_FIFO)
+    /* FIFO watermark interrupt enabled */
+    uint8_t fifo_wtm;
+#endif
 };
 
 struct lis2dh12 {
@@ -284,6 +294,22 @@ struct lis2dh12 {
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     bool node_is_spi;
 #endif
+#if MYNEWT_VAL(SENSOR_ASYNC)
+    /* Non-blocking read of STATUS_REG .. OUT_Z_H */
+    struct bus_xfer read_xfer;
+    uint8_t read_cmd;
+    uint8_t read_buf[7];
+#endif
+#if MYNEWT_VAL(SENSOR_FIXED)
+    /* Current read reports struct sensor_fixed_data */
+    bool fixed_read;
+#endif
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+    /* Cache of CTRL_REG0 (0x1E) .. ACT_DUR (0x3F) */
+    struct sensor_regmap regmap;
+    uint8_t reg_cache[LIS2DH12_REG_CACHE_SIZE];
+    uint8_t reg_valid[SENSOR_REGMAP_VALID_SIZE(LIS2DH12_REG_CACHE_SIZE)];
+#endif
 };
 
 /**
@@ -33,6 +33,9 @@
 #endif
 #include "sensor/sensor.h"
 #include "sensor/accel.h"
+#if MYNEWT_VAL(SENSOR_FIXED)
+#include "sensor/fixed.h"
+#endif
 #include "lis2dh12/lis2dh12.h"
 #include "lis2dh12_priv.h"
 #include "hal/hal_gpio.h"
@@ -211,6 +214,23 @@ static int lis2dh12_sensor_handle_interrupt(struct sensor *);
 
 static int lis2dh12_set_self_test_mode(struct sensor_itf *, uint8_t);
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+static int lis2dh12_sensor_read_fifo(struct sensor *, sensor_type_t,
+                                     sensor_batch_func_t, void *);
+static int lis2dh12_sensor_set_fifo(struct sensor *, sensor_type_t, uint16_t);
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+static int lis2dh12_sensor_read_start(struct sensor *, sensor_type_t);
+static int lis2dh12_sensor_read_finish(struct sensor *, sensor_type_t,
+                                       sensor_data_func_t, void *);
+#endif
+
+#if MYNEWT_VAL(SENSOR_FIXED)
+static int lis2dh12_sensor_read_fixed(struct sensor *, sensor_type_t,
+                                      sensor_data_func_t, void *, uint32_t);
+#endif
+
 static const struct sensor_driver g_lis2dh12_sensor_driver = {
     .sd_read = lis2dh12_sensor_read,
     .sd_set_config = lis2dh12_sensor_set_config,
@@ -221,7 +241,18 @@ static const struct sensor_driver g_lis2dh12_sensor_driver = {
     .sd_clear_high_trigger_thresh = lis2dh12_sensor_clear_high_thresh,
     .sd_set_notification   = lis2dh12_sensor_set_notification,
     .sd_unset_notification = lis2dh12_sensor_unset_notification,
-    .sd_handle_interrupt   = lis2dh12_sensor_handle_interrupt
+    .sd_handle_interrupt   = lis2dh12_sensor_handle_interrupt,
+#if MYNEWT_VAL(SENSOR_FIFO)
+    .sd_read_fifo          = lis2dh12_sensor_read_fifo,
+    .sd_set_fifo           = lis2dh12_sensor_set_fifo,
+#endif
+#if MYNEWT_VAL(SENSOR_ASYNC)
+    .sd_read_start         = lis2dh12_sensor_read_start,
+    .sd_read_finish        = lis2dh12_sensor_read_finish,
+#endif
+#if MYNEWT_VAL(SENSOR_FIXED)
+    .sd_read_fixed         = lis2dh12_sensor_read_fixed,
+#endif
 };
 
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
@@ -467,19 +498,13 @@ err:
 }
 #endif
 
-/**
- * Write multiple length data to LIS2DH12 sensor over different interfaces
- *
- * @param The sensor interface
- * @param register address
- * @param variable length payload
- * @param length of the payload to write
- *
- * @return 0 on success, non-zero on failure
+/*
+ * Write multiple length data to LIS2DH12 sensor over different interfaces,
+ * bypassing the register cache
  */
-int
-lis2dh12_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
-                  uint8_t len)
+static int
+lis2dh12_bus_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
+                      uint8_t len)
 {
     int rc;
 
@@ -526,18 +551,13 @@ lis2dh12_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
     return rc;
 }
 
-/**
- * Read multiple length data from LIS2DH12 sensor over different interfaces
- *
- * @param register address
- * @param variable length payload
- * @param length of the payload to read
- *
- * @return 0 on success, non-zero on failure
+/*
+ * Read multiple length data from LIS2DH12 sensor over different interfaces,
+ * bypassing the register cache
  */
-int
-lis2dh12_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
-                 uint8_t len)
+static int
+lis2dh12_bus_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
+                     uint8_t len)
 {
     int rc;
 
@@ -570,6 +590,86 @@ lis2dh12_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
     return rc;
 }
 
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+static int
+lis2dh12_regmap_read(void *arg, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    return lis2dh12_bus_readlen(arg, reg, buf, len);
+}
+
+static int
+lis2dh12_regmap_write(void *arg, uint8_t reg, const uint8_t *buf,
+                      uint8_t len)
+{
+    return lis2dh12_bus_writelen(arg, reg, (uint8_t *)buf, len);
+}
+
+/*
+ * Registers in CTRL_REG0 .. ACT_DUR which must always be accessed on the
+ * device: REFERENCE (reading it resets the HP filter), STATUS_REG and
+ * OUT_X_L .. OUT_Z_H, FIFO_SRC_REG, INT1_SRC, INT2_SRC and CLICK_SRC.
+ */
+static const uint8_t lis2dh12_volatile_regs[] = {
+    0x00, 0xff, 0x8a, 0x08, 0x00
+};
+
+static const struct sensor_regmap_desc lis2dh12_regmap_desc = {
+    .srd_first = LIS2DH12_REG_CTRL_REG0,
+    .srd_count = LIS2DH12_REG_CACHE_SIZE,
+    .srd_max_burst = 19,
+    .srd_volatile = lis2dh12_volatile_regs,
+    .srd_read = lis2dh12_regmap_read,
+    .srd_write = lis2dh12_regmap_write,
+};
+
+static struct sensor_regmap *
+lis2dh12_itf_regmap(struct sensor_itf *itf)
+{
+    return &CONTAINER_OF(itf, struct lis2dh12, sensor.s_itf)->regmap;
+}
+#endif
+
+/**
+ * Write multiple length data to LIS2DH12 sensor over different interfaces
+ *
+ * @param The sensor interface
+ * @param register address
+ * @param variable length payload
+ * @param length of the payload to write
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+lis2dh12_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
+                  uint8_t len)
+{
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+    return sensor_regmap_write(lis2dh12_itf_regmap(itf), addr, payload, len);
+#else
+    return lis2dh12_bus_writelen(itf, addr, payload, len);
+#endif
+}
+
+/**
+ * Read multiple length data from LIS2DH12 sensor over different interfaces
+ *
+ * @param register address
+ * @param variable length payload
+ * @param length of the payload to read
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+lis2dh12_readlen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
+                 uint8_t len)
+{
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+    return sensor_regmap_read(lis2dh12_itf_regmap(itf), addr, payload, len);
+#else
+    return lis2dh12_bus_readlen(itf, addr, payload, len);
+#endif
+}
+
 /**
  * Write byte to sensor over different interfaces
  *
@@ -625,6 +725,11 @@ lis2dh12_reset(struct sensor_itf *itf)
 
     os_time_delay((OS_TICKS_PER_SEC * 6/1000) + 1);
 
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+    /* Registers were reloaded, BOOT cleared itself */
+    sensor_regmap_invalidate(lis2dh12_itf_regmap(itf));
+#endif
+
 err:
     return rc;
 }
@@ -1059,23 +1164,16 @@ err:
     return rc;
 }
 
-int
-lis2dh12_get_fs(struct sensor_itf *itf, uint8_t *fs)
+static int
+lis2dh12_fs_to_g(uint8_t reg_fs, uint8_t *fs)
 {
-    int rc;
-
-    rc = lis2dh12_get_full_scale(itf, fs);
-    if (rc) {
-        return rc;
-    }
-
-    if (*fs == LIS2DH12_FS_2G) {
+    if (reg_fs == LIS2DH12_FS_2G) {
         *fs = 2;
-    } else if (*fs == LIS2DH12_FS_4G) {
+    } else if (reg_fs == LIS2DH12_FS_4G) {
         *fs = 4;
-    } else if (*fs == LIS2DH12_FS_8G) {
+    } else if (reg_fs == LIS2DH12_FS_8G) {
         *fs = 8;
-    } else if (*fs == LIS2DH12_FS_16G) {
+    } else if (reg_fs == LIS2DH12_FS_16G) {
         *fs = 16;
     } else {
         return SYS_EINVAL;
@@ -1084,6 +1182,20 @@ lis2dh12_get_fs(struct sensor_itf *itf, uint8_t *fs)
     return 0;
 }
 
+int
+lis2dh12_get_fs(struct sensor_itf *itf, uint8_t *fs)
+{
+    uint8_t reg_fs;
+    int rc;
+
+    rc = lis2dh12_get_full_scale(itf, &reg_fs);
+    if (rc) {
+        return rc;
+    }
+
+    return lis2dh12_fs_to_g(reg_fs, fs);
+}
+
 /**
  * Gets a new data sample from the light sensor.
  *
@@ -1099,23 +1211,18 @@ lis2dh12_get_data(struct sensor_itf *itf, uint8_t fs, int16_t *x, int16_t *y, in
 {
     int rc;
 
-    uint8_t payload[6] = {0};
-    uint8_t status;
+    /* STATUS_REG followed by OUT_X_L .. OUT_Z_H, read in one burst */
+    uint8_t payload[7] = {0};
     *x = *y = *z = 0;
 
-    rc = lis2dh12_readlen(itf, LIS2DH12_REG_STATUS_REG, &status, 1);
+    rc = lis2dh12_readlen(itf, LIS2DH12_REG_STATUS_REG, payload, 7);
     if (rc) {
         goto err;
     }
 
-    rc = lis2dh12_readlen(itf, LIS2DH12_REG_OUT_X_L, payload, 6);
-    if (rc) {
-        goto err;
-    }
-
-    *x = payload[0] | (payload[1] << 8);
-    *y = payload[2] | (payload[3] << 8);
-    *z = payload[4] | (payload[5] << 8);
+    *x = payload[1] | (payload[2] << 8);
+    *y = payload[3] | (payload[4] << 8);
+    *z = payload[5] | (payload[6] << 8);
 
     /*
      * Since full scale is +/-(fs)g,
@@ -1266,6 +1373,12 @@ lis2dh12_int_irq_handler(void *arg)
         wake_interrupt(lis2dh12->pdd.interrupt);
     }
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+    if (lis2dh12->pdd.fifo_wtm) {
+        sensor_mgr_put_fifo_evt(sensor);
+    }
+#endif
+
     sensor_mgr_put_interrupt_evt(sensor);
 }
 
@@ -1293,6 +1406,12 @@ lis2dh12_init(struct os_dev *dev, void *arg)
 
     lis2dh12->cfg.lc_s_mask = SENSOR_TYPE_ALL;
 
+#if MYNEWT_VAL(LIS2DH12_REG_CACHE)
+    sensor_regmap_init(&lis2dh12->regmap, &lis2dh12_regmap_desc,
+                       &lis2dh12->sensor.s_itf, lis2dh12->reg_cache,
+                       lis2dh12->reg_valid);
+#endif
+
     sensor = &lis2dh12->sensor;
 
     /* Initialise the stats entry */
@@ -1765,6 +1884,10 @@ lis2dh12_do_read(struct sensor *sensor, sensor_data_func_t data_func,
     int16_t x, y ,z;
     float fx, fy ,fz;
     int rc;
+#if MYNEWT_VAL(SENSOR_FIXED)
+    struct lis2dh12 *lis2dh12;
+    struct sensor_fixed_data sfd;
+#endif
 
     itf = SENSOR_GET_ITF(sensor);
 
@@ -1775,6 +1898,21 @@ lis2dh12_do_read(struct sensor *sensor, sensor_data_func_t data_func,
         goto err;
     }
 
+#if MYNEWT_VAL(SENSOR_FIXED)
+    lis2dh12 = (struct lis2dh12 *)SENSOR_GET_DEVICE(sensor);
+    if (lis2dh12->fixed_read) {
+        /* mg to m/s^2 */
+        sfd.sfd_x = SENSOR_Q16_SCALE(x, 980665, 100000000);
+        sfd.sfd_y = SENSOR_Q16_SCALE(y, 980665, 100000000);
+        sfd.sfd_z = SENSOR_Q16_SCALE(z, 980665, 100000000);
+        sfd.sfd_x_is_valid = 1;
+        sfd.sfd_y_is_valid = 1;
+        sfd.sfd_z_is_valid = 1;
+
+        return data_func(sensor, data_arg, &sfd, SENSOR_TYPE_ACCELEROMETER);
+    }
+#endif
+
     /* converting values from mg to ms^2 */
     lis2dh12_calc_acc_ms2(x, &fx);
     lis2dh12_calc_acc_ms2(y, &fy);
@@ -1799,6 +1937,330 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+/*
+ * Samples read from the FIFO in one bus transaction; the non bus driver
+ * I2C path can not read more than 20 bytes at a time.
+ */
+#define LIS2DH12_FIFO_CHUNK     3
+
+/**
+ * Get output data rate in Hz for the current configuration
+ *
+ * @param The sensor interface
+ * @param Pointer to return data rate in
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dh12_get_rate_hz(struct sensor_itf *itf, uint32_t *hz)
+{
+    static const uint16_t odr_hz[] = {
+        0, 1, 10, 25, 50, 100, 200, 400, 1620, 1344
+    };
+    uint8_t rate;
+    uint8_t reg;
+    int rc;
+
+    rc = lis2dh12_get_rate(itf, &rate);
+    if (rc) {
+        return rc;
+    }
+
+    rate >>= 4;
+    if (rate >= ARRAY_SIZE(odr_hz) || rate == 0) {
+        return SYS_EINVAL;
+    }
+
+    *hz = odr_hz[rate];
+
+    if (rate == (LIS2DH12_DATA_RATE_HN_1344HZ_L_5376HZ >> 4)) {
+        rc = lis2dh12_read8(itf, LIS2DH12_REG_CTRL_REG1, &reg);
+        if (rc) {
+            return rc;
+        }
+        if (reg & LIS2DH12_CTRL_REG1_LPEN) {
+            *hz = 5376;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Read all samples collected in the FIFO and pass them as batches
+ *
+ * @param The sensor ptr
+ * @param The sensor type
+ * @param The function pointer to invoke for each batch
+ * @param The opaque pointer that will be passed in to the function
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dh12_sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                          sensor_batch_func_t batch_func, void *arg)
+{
+    struct sensor_accel_data sad[LIS2DH12_FIFO_CHUNK];
+    uint8_t payload[LIS2DH12_FIFO_CHUNK * 6];
+    struct sensor_batch batch;
+    struct sensor_itf *itf;
+    uint32_t interval;
+    uint32_t now;
+    uint32_t hz;
+    uint8_t samples;
+    uint8_t fs;
+    int16_t v;
+    int cnt;
+    int rc;
+    int i;
+    int j;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        return SYS_EINVAL;
+    }
+
+    itf = SENSOR_GET_ITF(sensor);
+    now = os_cputime_get32();
+
+    rc = lis2dh12_get_fifo_samples(itf, &samples);
+    if (rc) {
+        return rc;
+    }
+    if (samples == 0) {
+        return 0;
+    }
+
+    rc = lis2dh12_get_fs(itf, &fs);
+    if (rc) {
+        return rc;
+    }
+
+    rc = lis2dh12_get_rate_hz(itf, &hz);
+    if (rc) {
+        return rc;
+    }
+
+    /* Newest sample was taken now, older ones one interval apart */
+    interval = os_cputime_usecs_to_ticks(1000000 / hz);
+
+    batch.sb_type = SENSOR_TYPE_ACCELEROMETER;
+    batch.sb_stride = sizeof(sad[0]);
+    batch.sb_data = sad;
+    batch.sb_interval = interval;
+    batch.sb_cputime = now - (samples - 1) * interval;
+
+    while (samples) {
+        cnt = min(samples, LIS2DH12_FIFO_CHUNK);
+
+        /* OUT_X_L .. OUT_Z_H wrap around in FIFO mode */
+        rc = lis2dh12_readlen(itf, LIS2DH12_REG_OUT_X_L, payload, cnt * 6);
+        if (rc) {
+            return rc;
+        }
+
+        for (i = 0; i < cnt; i++) {
+            float *axis[3] = { &sad[i].sad_x, &sad[i].sad_y, &sad[i].sad_z };
+
+            for (j = 0; j < 3; j++) {
+                v = payload[i * 6 + j * 2] | (payload[i * 6 + j * 2 + 1] << 8);
+                /* Same mg scaling as lis2dh12_get_data() */
+                v = (fs * 2 * 1000 * v) / UINT16_MAX;
+                lis2dh12_calc_acc_ms2(v, axis[j]);
+            }
+            sad[i].sad_x_is_valid = 1;
+            sad[i].sad_y_is_valid = 1;
+            sad[i].sad_z_is_valid = 1;
+        }
+
+        batch.sb_count = cnt;
+        rc = batch_func(sensor, arg, &batch);
+        if (rc) {
+            return rc;
+        }
+
+        batch.sb_cputime += cnt * interval;
+        samples -= cnt;
+    }
+
+    return 0;
+}
+
+/**
+ * Configure FIFO watermark, 0 returns FIFO to configured mode
+ *
+ * @param The sensor ptr
+ * @param The sensor type
+ * @param Number of samples that trigger FIFO read, 0 to disable
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dh12_sensor_set_fifo(struct sensor *sensor, sensor_type_t type,
+                         uint16_t watermark)
+{
+    struct lis2dh12 *lis2dh12;
+    struct sensor_itf *itf;
+    uint8_t reg;
+    int rc;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        return SYS_EINVAL;
+    }
+
+    lis2dh12 = (struct lis2dh12 *)SENSOR_GET_DEVICE(sensor);
+    itf = SENSOR_GET_ITF(sensor);
+
+    if (watermark == 0) {
+        if (lis2dh12->pdd.fifo_wtm) {
+            lis2dh12->pdd.fifo_wtm = 0;
+            if (itf->si_ints[0].host_pin >= 0) {
+                disable_interrupt(sensor, LIS2DH12_CTRL_REG3_I1_WTM, 0);
+            }
+        }
+        return lis2dh12_set_fifo_mode(itf, lis2dh12->cfg.fifo_mode);
+    }
+
+    rc = lis2dh12_set_fifo_mode(itf, LIS2DH12_FIFO_M_STREAM);
+    if (rc) {
+        return rc;
+    }
+
+    rc = lis2dh12_read8(itf, LIS2DH12_REG_FIFO_CTRL_REG, &reg);
+    if (rc) {
+        return rc;
+    }
+
+    /* FTH[4:0], FIFO holds 32 samples */
+    reg &= ~0x1f;
+    reg |= min(watermark, 31);
+
+    rc = lis2dh12_write8(itf, LIS2DH12_REG_FIFO_CTRL_REG, reg);
+    if (rc) {
+        return rc;
+    }
+
+    /* Without interrupt pin the FIFO is drained by polling */
+    if (itf->si_ints[0].host_pin >= 0) {
+        rc = enable_interrupt(sensor, LIS2DH12_CTRL_REG3_I1_WTM, 0);
+        if (rc) {
+            return rc;
+        }
+        lis2dh12->pdd.fifo_wtm = 1;
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+static void
+lis2dh12_read_xfer_cb(struct bus_xfer *xfer)
+{
+    struct lis2dh12 *lis2dh12 = xfer->arg;
+
+    /* May be called from interrupt, data is converted in sensor eventq */
+    sensor_mgr_put_read_done_evt(&lis2dh12->sensor, xfer->rc);
+}
+
+/**
+ * Queue read of STATUS_REG .. OUT_Z_H without waiting for the bus
+ *
+ * @param The sensor ptr
+ * @param The sensor type
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dh12_sensor_read_start(struct sensor *sensor, sensor_type_t type)
+{
+    struct lis2dh12 *lis2dh12;
+    struct bus_xfer *xfer;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        return SYS_EINVAL;
+    }
+
+    lis2dh12 = (struct lis2dh12 *)SENSOR_GET_DEVICE(sensor);
+
+    /* Stream mode waits for interrupts, keep it synchronous */
+    if (lis2dh12->cfg.read_mode.mode != LIS2DH12_READ_M_POLL) {
+        return SYS_ENOTSUP;
+    }
+
+    lis2dh12->read_cmd = LIS2DH12_REG_STATUS_REG;
+    if (lis2dh12->node_is_spi && MYNEWT_VAL(LIS2DH12_ENABLE_SPI)) {
+        lis2dh12->read_cmd |= LIS2DH12_SPI_READ_CMD_BIT;
+        lis2dh12->read_cmd |= LIS2DH12_SPI_ADDR_INC;
+    } else if (MYNEWT_VAL(LIS2DH12_ENABLE_I2C)) {
+        lis2dh12->read_cmd |= LIS2DH12_I2C_ADDR_INC;
+    }
+
+    xfer = &lis2dh12->read_xfer;
+    xfer->wbuf = &lis2dh12->read_cmd;
+    xfer->wlength = 1;
+    xfer->rbuf = lis2dh12->read_buf;
+    xfer->rlength = sizeof(lis2dh12->read_buf);
+    xfer->flags = BUS_F_NONE;
+    xfer->type = BUS_XFER_WRITE_READ;
+    xfer->timeout =
+        os_time_ms_to_ticks32(MYNEWT_VAL(BUS_DEFAULT_TRANSACTION_TIMEOUT_MS));
+    xfer->cb = lis2dh12_read_xfer_cb;
+    xfer->arg = lis2dh12;
+
+    return bus_node_submit(sensor->s_itf.si_dev, xfer);
+}
+
+/**
+ * Convert data read by lis2dh12_sensor_read_start() and report it
+ *
+ * @param The sensor ptr
+ * @param The sensor type
+ * @param The function pointer to invoke for the data
+ * @param The opaque pointer that will be passed in to the function
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dh12_sensor_read_finish(struct sensor *sensor, sensor_type_t type,
+                            sensor_data_func_t data_func, void *arg)
+{
+    struct sensor_accel_data sad;
+    struct lis2dh12 *lis2dh12;
+    float *axis[3];
+    uint8_t *buf;
+    uint8_t fs;
+    int16_t v;
+    int rc;
+    int i;
+
+    lis2dh12 = (struct lis2dh12 *)SENSOR_GET_DEVICE(sensor);
+    buf = lis2dh12->read_buf;
+
+    rc = lis2dh12_fs_to_g(lis2dh12->cfg.lc_fs, &fs);
+    if (rc) {
+        return rc;
+    }
+
+    axis[0] = &sad.sad_x;
+    axis[1] = &sad.sad_y;
+    axis[2] = &sad.sad_z;
+
+    for (i = 0; i < 3; i++) {
+        v = buf[1 + i * 2] | (buf[2 + i * 2] << 8);
+        /* Same mg scaling as lis2dh12_get_data() */
+        v = (fs * 2 * 1000 * v) / UINT16_MAX;
+        lis2dh12_calc_acc_ms2(v, axis[i]);
+    }
+
+    sad.sad_x_is_valid = 1;
+    sad.sad_y_is_valid = 1;
+    sad.sad_z_is_valid = 1;
+
+    return data_func(sensor, arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+}
+#endif
+
 /**
  * Do accelerometer polling reads
  *
@@ -2013,6 +2475,29 @@ err:
     }
 }
 
+#if MYNEWT_VAL(SENSOR_FIXED)
+/**
+ * Same as lis2dh12_sensor_read() but reports struct sensor_fixed_data,
+ * converted from register values without floating point math.
+ */
+static int
+lis2dh12_sensor_read_fixed(struct sensor *sensor, sensor_type_t type,
+                           sensor_data_func_t data_func, void *data_arg,
+                           uint32_t timeout)
+{
+    struct lis2dh12 *lis2dh12;
+    int rc;
+
+    lis2dh12 = (struct lis2dh12 *)SENSOR_GET_DEVICE(sensor);
+
+    lis2dh12->fixed_read = true;
+    rc = lis2dh12_sensor_read(sensor, type, data_func, data_arg, timeout);
+    lis2dh12->fixed_read = false;
+
+    return rc;
+}
+#endif
+
 static struct lis2dh12_notif_cfg *
 lis2dh12_find_notif_cfg_by_event(sensor_event_type_t event,
                                  struct lis2dh12_cfg *cfg)
@@ -3027,6 +3512,7 @@ lis2dh12_config(struct lis2dh12 *lis2dh12, struct lis2dh12_cfg *cfg)
     int rc;
     struct sensor_itf *itf;
     uint8_t chip_id;
+    uint8_t act[2];
     struct sensor *sensor;
 
     itf = SENSOR_GET_ITF(&(lis2dh12->sensor));
@@ -3180,12 +3666,10 @@ lis2dh12_config(struct lis2dh12 *lis2dh12, struct lis2dh12_cfg *cfg)
         goto err;
     }
 
-    rc = lis2dh12_set_activity_threshold(itf, cfg->act_ths);
-    if (rc) {
-        goto err;
-    }
-
-    rc = lis2dh12_set_activity_duration(itf, cfg->act_dur);
+    /* ACT_THS and ACT_DUR are adjacent, program both in one burst */
+    act[0] = cfg->act_ths;
+    act[1] = cfg->act_dur;
+    rc = lis2dh12_writelen(itf, LIS2DH12_REG_ACT_THS, act, 2);
     if (rc) {
         goto err;
     }
@@ -77,6 +77,10 @@ static int lps33hw_sensor_set_config(struct sensor *, void *);
 static int lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
         sensor_type_t sensor_type, struct sensor_type_traits *stt);
 static int lps33hw_sensor_handle_interrupt(struct sensor *sensor);
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+static int lps33hw_sensor_offload_thresh(struct sensor *sensor,
+        sensor_type_t sensor_type, struct sensor_type_traits *stt);
+#endif
 static int lps33hw_sensor_clear_low_thresh(struct sensor *sensor,
         sensor_type_t type);
 static int lps33hw_sensor_clear_high_thresh(struct sensor *sensor,
@@ -97,6 +101,9 @@ static const struct sensor_driver g_lps33hw_sensor_driver = {
     .sd_handle_interrupt          = lps33hw_sensor_handle_interrupt,
     .sd_clear_low_trigger_thresh  = lps33hw_sensor_clear_low_thresh,
     .sd_clear_high_trigger_thresh = lps33hw_sensor_clear_high_thresh,
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+    .sd_offload_thresh            = lps33hw_sensor_offload_thresh,
+#endif
     .sd_reset                     = lps33hw_reset
 };
 
@@ -770,6 +777,15 @@ lps33hw_threshold_interrupt_handler(void * arg)
     sensor_mgr_put_read_evt(stt);
 }
 
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+static void
+lps33hw_offload_interrupt_handler(void *arg)
+{
+    struct sensor_type_traits *stt = arg;
+    sensor_mgr_put_trigger_evt(stt);
+}
+#endif
+
 int
 lps33hw_config_interrupt(struct sensor *sensor, struct lps33hw_int_cfg cfg)
 {
@@ -850,18 +866,17 @@ lps33hw_config_interrupt(struct sensor *sensor, struct lps33hw_int_cfg cfg)
 }
 
 /**
- * Sets up trigger thresholds and enables interrupts
+ * Programs threshold registers from stt and enables the interrupt
  *
  * @param Pointer to sensor structure
- * @param type of sensor
  * @param threshold settings to configure
+ * @param interrupt handler, called with stt as argument
  *
  * @return 0 on success, non-zero on failure
  */
 static int
-lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
-                                  sensor_type_t sensor_type,
-                                  struct sensor_type_traits *stt)
+lps33hw_config_thresh(struct sensor *sensor, struct sensor_type_traits *stt,
+                      hal_gpio_irq_handler_t handler)
 {
     struct lps33hw *lps33hw;
     struct sensor_itf *itf;
@@ -872,10 +887,6 @@ lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
     float reference;
     float threshold;
 
-    if (sensor_type != SENSOR_TYPE_PRESSURE) {
-        return SYS_EINVAL;
-    }
-
     lps33hw = (struct lps33hw *)SENSOR_GET_DEVICE(sensor);
     itf = SENSOR_GET_ITF(sensor);
 
@@ -922,8 +933,7 @@ lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
         return rc;
     }
 
-    rc = lps33hw_enable_interrupt(sensor, lps33hw_threshold_interrupt_handler,
-        stt);
+    rc = lps33hw_enable_interrupt(sensor, handler, stt);
     if (rc) {
         return rc;
     }
@@ -931,6 +941,61 @@ lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
     return 0;
 }
 
+/**
+ * Sets up trigger thresholds and enables interrupts
+ *
+ * @param Pointer to sensor structure
+ * @param type of sensor
+ * @param threshold settings to configure
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lps33hw_sensor_set_trigger_thresh(struct sensor *sensor,
+                                  sensor_type_t sensor_type,
+                                  struct sensor_type_traits *stt)
+{
+    if (sensor_type != SENSOR_TYPE_PRESSURE) {
+        return SYS_EINVAL;
+    }
+
+    return lps33hw_config_thresh(sensor, stt,
+                                 lps33hw_threshold_interrupt_handler);
+}
+
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+/**
+ * Lets the device compare pressure against the thresholds. Differential
+ * interrupt fires when pressure goes below the low or above the high
+ * threshold, which is exactly the watermark algorithm.
+ *
+ * @param Pointer to sensor structure
+ * @param type of sensor
+ * @param threshold settings to configure
+ *
+ * @return 0 on success, SYS_ENOTSUP if thresholds need software compare,
+ *         other non-zero on failure
+ */
+static int
+lps33hw_sensor_offload_thresh(struct sensor *sensor,
+                              sensor_type_t sensor_type,
+                              struct sensor_type_traits *stt)
+{
+    if (sensor_type != SENSOR_TYPE_PRESSURE ||
+        stt->stt_algo != SENSOR_THRESH_ALGO_WATERMARK) {
+        return SYS_ENOTSUP;
+    }
+
+    if (!stt->stt_low_thresh.spd->spd_press_is_valid &&
+        !stt->stt_high_thresh.spd->spd_press_is_valid) {
+        return SYS_ENOTSUP;
+    }
+
+    return lps33hw_config_thresh(sensor, stt,
+                                 lps33hw_offload_interrupt_handler);
+}
+#endif
+
 int lps33hw_init(struct os_dev *dev, void *arg)
 {
     struct lps33hw *lps33hw;
@@ -66,10 +66,34 @@ typedef void (*uart_tx_done)(void *arg);
  */
 typedef int (*uart_rx_char)(void *arg, uint8_t byte);
 
+/*
+ * Function prototype for UART driver to report received data in block
+ * mode. Called from interrupt context whenever half of the RX buffer
+ * has been filled, or when the line went idle with data pending.
+ * Data must be consumed before returning.
+ *
+ * @param arg		This is uc_cb_arg passed in uart_conf in
+ *			os_dev_open().
+ * @param data		Received data
+ * @param len		Number of bytes received
+ */
+typedef void (*uart_rx_block)(void *arg, const uint8_t *data, uint16_t len);
+
+/*
+ * Function prototype for UART driver to report that the buffer passed to
+ * uart_tx_block() has been sent. Called from interrupt context.
+ *
+ * @param arg		This is uc_cb_arg passed in uart_conf in
+ *			os_dev_open().
+ */
+typedef void (*uart_tx_block_done)(void *arg);
+
 struct uart_driver_funcs {
     void (*uf_start_tx)(struct uart_dev *);
     void (*uf_start_rx)(struct uart_dev *);
     void (*uf_blocking_tx)(struct uart_dev *, uint8_t);
+    /* Optional, block mode transmit */
+    int (*uf_tx_block)(struct uart_dev *, const void *, uint16_t);
 };
 
 /*
@@ -104,6 +128,17 @@ struct uart_conf {
     uart_rx_char uc_rx_char;
     uart_tx_done uc_tx_done;
     void *uc_cb_arg;
+    /*
+     * Block mode, used instead of the character callbacks when
+     * uc_rx_block is set. Only drivers implementing uf_tx_block support
+     * it (uart_hal with HAL_UART_BLOCK enabled). The RX buffer is used in
+     * two halves and must stay valid while the device is open.
+     */
+    uart_rx_block uc_rx_block;
+    uart_tx_block_done uc_tx_block_done;
+    uint8_t *uc_rx_buf;
+    uint16_t uc_rx_buf_size;
+    uint16_t uc_idle_us;        /* report pending RX after idle time */
 };
 
 struct uart_dev {
@@ -149,6 +184,63 @@ uart_blocking_tx(struct uart_dev *dev, uint8_t byte)
     dev->ud_funcs.uf_blocking_tx(dev, byte);
 }
 
+/*
+ * Start transmitting a buffer in block mode.  Driver may take less than
+ * len bytes, rest must be passed again after uc_tx_block_done callback.
+ * Buffer must stay valid until then and should be located in RAM.
+ *
+ * @param dev		Uart device in question
+ * @param data		Data to send
+ * @param len		Number of bytes
+ *
+ * @return		Number of bytes accepted, SYS_EBUSY if previous
+ *			buffer is still being sent, SYS_ENOTSUP if driver
+ *			does not support block mode.
+ */
+static inline int
+uart_tx_block(struct uart_dev *dev, const void *data, uint16_t len)
+{
+    if (!dev->ud_funcs.uf_tx_block) {
+        return SYS_ENOTSUP;
+    }
+    return dev->ud_funcs.uf_tx_block(dev, data, len);
+}
+
+/*
+ * Transmit queue of mbuf chains for block mode.  Each mbuf is passed to
+ * uart_tx_block() directly, without copying.
+ */
+struct uart_mbuf_txq {
+    struct uart_dev *umt_dev;
+    struct os_mbuf *umt_tx;     /* mbuf being sent, followed by rest */
+    uint16_t umt_off;           /* offset of data in flight in umt_tx */
+    uint16_t umt_len;           /* number of bytes in flight */
+};
+
+/*
+ * Initialize mbuf transmit queue.
+ *
+ * @param umt		Transmit queue
+ * @param dev		Uart device opened in block mode
+ */
+void uart_mbuf_txq_init(struct uart_mbuf_txq *umt, struct uart_dev *dev);
+
+/*
+ * Queue mbuf chain for transmission, queue takes ownership of the chain
+ * and frees the mbufs once sent.
+ *
+ * @param umt		Transmit queue
+ * @param om		Mbuf chain to send
+ */
+void uart_mbuf_txq_put(struct uart_mbuf_txq *umt, struct os_mbuf *om);
+
+/*
+ * Continue transmission, must be called from uc_tx_block_done callback.
+ *
+ * @param umt		Transmit queue
+ */
+void uart_mbuf_txq_done(struct uart_mbuf_txq *umt);
+
 /**
  * Open UART device
  *
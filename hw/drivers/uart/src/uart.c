@@ -16,3 +16,71 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "uart/uart.h"
+
+/*
+ * Start sending next chunk, interrupts disabled.
+ */
+static void
+uart_mbuf_txq_start(struct uart_mbuf_txq *umt)
+{
+    struct os_mbuf *next;
+    int rc;
+
+    while (umt->umt_tx) {
+        if (umt->umt_off < umt->umt_tx->om_len) {
+            rc = uart_tx_block(umt->umt_dev,
+                               umt->umt_tx->om_data + umt->umt_off,
+                               umt->umt_tx->om_len - umt->umt_off);
+            if (rc > 0) {
+                umt->umt_len = rc;
+            }
+            return;
+        }
+        next = SLIST_NEXT(umt->umt_tx, om_next);
+        os_mbuf_free(umt->umt_tx);
+        umt->umt_tx = next;
+        umt->umt_off = 0;
+    }
+}
+
+void
+uart_mbuf_txq_init(struct uart_mbuf_txq *umt, struct uart_dev *dev)
+{
+    memset(umt, 0, sizeof(*umt));
+    umt->umt_dev = dev;
+}
+
+void
+uart_mbuf_txq_put(struct uart_mbuf_txq *umt, struct os_mbuf *om)
+{
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!umt->umt_tx) {
+        umt->umt_tx = om;
+        umt->umt_off = 0;
+    } else {
+        os_mbuf_concat(umt->umt_tx, om);
+    }
+    if (!umt->umt_len) {
+        uart_mbuf_txq_start(umt);
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+uart_mbuf_txq_done(struct uart_mbuf_txq *umt)
+{
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    umt->umt_off += umt->umt_len;
+    umt->umt_len = 0;
+    uart_mbuf_txq_start(umt);
+    OS_EXIT_CRITICAL(sr);
+}
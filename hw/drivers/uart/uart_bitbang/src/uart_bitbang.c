@@ -52,6 +52,10 @@ struct uart_bitbang {
         uint32_t start;         /* cputime when byte tx started */
         uint8_t byte;           /* byte being transmitted */
         uint8_t bits;           /* how many bits have been sent */
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+        int port;               /* TX pin port, precomputed */
+        uint32_t mask;          /* TX pin mask within port */
+#endif
     } ub_tx;
 
     uint8_t ub_open:1;
@@ -71,6 +75,17 @@ static const struct uart_bitbang_conf os_bsp_uartbb0_cfg = {
     .ubc_cputimer_freq = MYNEWT_VAL(OS_CPUTIME_FREQ),
 };
 
+static inline void
+uart_bitbang_tx_pin(struct uart_bitbang *ub, int val)
+{
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+    hal_gpio_port_write_masked(ub->ub_tx.port, ub->ub_tx.mask,
+                               val ? ub->ub_tx.mask : 0);
+#else
+    hal_gpio_write(ub->ub_tx.pin, val);
+#endif
+}
+
 /*
  * Bytes start with START bit (0) followed by 8 data bits and then the
  * STOP bit (1). STOP bit should be configurable. Data bits are sent LSB first.
@@ -98,21 +113,21 @@ uart_bitbang_tx_timer(void *arg)
         /*
          * Start bit
          */
-        hal_gpio_write(ub->ub_tx.pin, 0);
+        uart_bitbang_tx_pin(ub, 0);
         ub->ub_tx.start = os_cputime_get32();
         next = ub->ub_tx.start + ub->ub_bittime;
         ub->ub_txing = 1;
         ub->ub_tx.bits = 0;
     } else {
         if (ub->ub_tx.bits++ < 8) {
-            hal_gpio_write(ub->ub_tx.pin, ub->ub_tx.byte & 0x01);
+            uart_bitbang_tx_pin(ub, ub->ub_tx.byte & 0x01);
             ub->ub_tx.byte = ub->ub_tx.byte >> 1;
             next = ub->ub_tx.start + (ub->ub_bittime * (ub->ub_tx.bits + 1));
         } else {
             /*
              * STOP bit.
              */
-            hal_gpio_write(ub->ub_tx.pin, 1);
+            uart_bitbang_tx_pin(ub, 1);
             next = ub->ub_tx.start + (ub->ub_bittime * 10);
         }
     }
@@ -198,18 +213,18 @@ uart_bitbang_blocking_tx(struct uart_dev *dev, uint8_t data)
     if (!ub->ub_open) {
         return;
     }
-    hal_gpio_write(ub->ub_tx.pin, 0);
+    uart_bitbang_tx_pin(ub, 0);
     start = os_cputime_get32();
     next = start + ub->ub_bittime;
     while (os_cputime_get32() < next);
     for (i = 0; i < 8; i++) {
-        hal_gpio_write(ub->ub_tx.pin, data & 0x01);
+        uart_bitbang_tx_pin(ub, data & 0x01);
         data = data >> 1;
         next = start + (ub->ub_bittime * i + 1);
         while (os_cputime_get32() < next);
     }
     next = start + (ub->ub_bittime * 10);
-    hal_gpio_write(ub->ub_tx.pin, 1);
+    uart_bitbang_tx_pin(ub, 1);
     while (os_cputime_get32() < next);
 }
 
@@ -281,6 +296,11 @@ uart_bitbang_config(struct uart_bitbang *ub, int32_t baudrate, uint8_t databits,
     if (hal_gpio_init_out(ub->ub_tx.pin, 1)) {
         return -1;
     }
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+    if (hal_gpio_port_pin(ub->ub_tx.pin, &ub->ub_tx.port, &ub->ub_tx.mask)) {
+        return -1;
+    }
+#endif
 
     if (ub->ub_rx.pin >= 0) {
         if (hal_gpio_irq_init(ub->ub_rx.pin, uart_bitbang_isr, ub,
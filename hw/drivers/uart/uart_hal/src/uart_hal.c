@@ -64,6 +64,16 @@ uart_hal_blocking_tx(struct uart_dev *dev, uint8_t byte)
     hal_uart_blocking_tx(uart_hal_dev_get_id(dev), byte);
 }
 
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+static int
+uart_hal_tx_block(struct uart_dev *dev, const void *data, uint16_t len)
+{
+    assert(dev->ud_priv);
+
+    return hal_uart_tx_block(uart_hal_dev_get_id(dev), data, len);
+}
+#endif
+
 static int
 uart_hal_open(struct os_dev *odev, uint32_t wait, void *arg)
 {
@@ -89,8 +99,26 @@ uart_hal_open(struct os_dev *odev, uint32_t wait, void *arg)
     dev->ud_conf_port.uc_speed = uc->uc_speed;
     dev->ud_conf_port.uc_stopbits = uc->uc_stopbits;
 
-    rc = hal_uart_init_cbs(uart_hal_dev_get_id(dev), uc->uc_tx_char, uc->uc_tx_done,
-                           uc->uc_rx_char, uc->uc_cb_arg);
+    if (uc->uc_rx_block) {
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+        struct hal_uart_block_cfg blk = {
+            .ub_rx_buf = uc->uc_rx_buf,
+            .ub_rx_buf_size = uc->uc_rx_buf_size,
+            .ub_idle_us = uc->uc_idle_us,
+            .ub_rx_func = uc->uc_rx_block,
+            .ub_tx_done = uc->uc_tx_block_done,
+            .ub_arg = uc->uc_cb_arg,
+        };
+
+        rc = hal_uart_init_block(uart_hal_dev_get_id(dev), &blk);
+#else
+        rc = -1;
+#endif
+    } else {
+        rc = hal_uart_init_cbs(uart_hal_dev_get_id(dev), uc->uc_tx_char,
+                               uc->uc_tx_done, uc->uc_rx_char,
+                               uc->uc_cb_arg);
+    }
     if (rc) {
         return OS_EINVAL;
     }
@@ -190,6 +218,9 @@ uart_hal_init(struct os_dev *odev, void *arg)
     dev->ud_funcs.uf_start_tx = uart_hal_start_tx;
     dev->ud_funcs.uf_start_rx = uart_hal_start_rx;
     dev->ud_funcs.uf_blocking_tx = uart_hal_blocking_tx;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    dev->ud_funcs.uf_tx_block = uart_hal_tx_block;
+#endif
 
     hal_uart_init(uart_hal_dev_get_id(dev), arg);
 
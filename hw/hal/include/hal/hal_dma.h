@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @addtogroup HAL
+ * @{
+ *   @defgroup HALDma HAL DMA
+ *   @{
+ */
+
+#ifndef H_HAL_DMA_
+#define H_HAL_DMA_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+#include "os/os_mbuf.h"
+#include "os/os_mempool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Memory to memory copy, both addresses are incremented */
+#define HAL_DMA_MEM_TO_MEM      0
+/** Memory to peripheral register, destination is not incremented */
+#define HAL_DMA_MEM_TO_PERIPH   1
+/** Peripheral register to memory, source is not incremented */
+#define HAL_DMA_PERIPH_TO_MEM   2
+
+/**
+ * Function called when all descriptors passed to hal_dma_start() were
+ * processed or transfer failed. Called from interrupt context; a new
+ * transfer can be started on the channel from the callback.
+ *
+ * @param arg    hdc_done_arg from channel configuration
+ * @param status 0 on success, SYS_EIO on bus error
+ */
+typedef void (*hal_dma_done_cb)(void *arg, int status);
+
+/**
+ * Transfer descriptor. Descriptors can be linked, they are processed in
+ * order without calling hdc_done_cb in between. Descriptors must stay valid
+ * until transfer is finished.
+ */
+struct hal_dma_desc {
+    /** Source address */
+    const void *hdd_src;
+    /** Destination address */
+    void *hdd_dst;
+    /** Number of bytes, multiple of channel width */
+    uint32_t hdd_len;
+    /** Next descriptor, NULL for last one */
+    struct hal_dma_desc *hdd_next;
+};
+
+/** Channel configuration */
+struct hal_dma_cfg {
+    /** Transfer direction, HAL_DMA_MEM_TO_MEM etc. */
+    uint8_t hdc_dir;
+    /** Size of single transfer in bytes: 1, 2 or 4 */
+    uint8_t hdc_width;
+    /** Channel priority, 0 is lowest; clipped to what MCU supports */
+    uint8_t hdc_priority;
+    /**
+     * MCU specific peripheral request line, ignored for HAL_DMA_MEM_TO_MEM.
+     * STM32F4/F7: DMA_CHANNEL_x of selected stream
+     * DA1469x: MCU_DMA_PERIPH_x
+     */
+    uint32_t hdc_request;
+    hal_dma_done_cb hdc_done_cb;
+    void *hdc_done_arg;
+};
+
+/**
+ * Acquires and configures DMA channel.
+ *
+ * @param channel MCU specific channel number, -1 to use any free channel
+ *                that can handle requested transfer
+ * @param cfg     Channel configuration
+ *
+ * @return Acquired channel number on success,
+ *         SYS_EBUSY if channel is used,
+ *         SYS_ENOENT if no channel is free,
+ *         SYS_EINVAL if configuration is not supported by channel.
+ */
+int hal_dma_channel_request(int channel, const struct hal_dma_cfg *cfg);
+
+/**
+ * Stops and releases channel acquired with hal_dma_channel_request().
+ *
+ * @param channel Channel number
+ *
+ * @return 0 on success, SYS_EINVAL if channel was not acquired.
+ */
+int hal_dma_channel_release(int channel);
+
+/**
+ * Starts transfer of linked descriptors.
+ *
+ * @param channel Channel number
+ * @param desc    First descriptor
+ *
+ * @return 0 on success, SYS_EBUSY if transfer is in progress,
+ *         SYS_EINVAL on bad arguments.
+ */
+int hal_dma_start(int channel, struct hal_dma_desc *desc);
+
+/**
+ * Aborts transfer in progress, done callback is not called.
+ *
+ * @param channel Channel number
+ *
+ * @return 0 on success, SYS_EINVAL if channel was not acquired.
+ */
+int hal_dma_stop(int channel);
+
+/**
+ * Copies memory using any free DMA channel and waits for completion.
+ * Copies shorter than HAL_DMA_MEMCPY_MIN_LEN, and copies when no channel
+ * is available, are done by CPU. Must be called from task context.
+ *
+ * @param dst Destination
+ * @param src Source
+ * @param len Number of bytes
+ *
+ * @return 0 on success, SYS_EIO on bus error.
+ */
+int hal_dma_memcpy(void *dst, const void *src, size_t len);
+
+/*
+ * DMA buffers
+ *
+ * On MCUs whose DMA does not see the data cache (HAL_DMA_CACHE_MAINT),
+ * memory written by CPU must be cleaned from the cache before DMA reads
+ * it, and memory written by DMA must be invalidated before CPU reads it.
+ * Cache maintenance works on whole lines, so buffers must not share a
+ * line with anything CPU touches while the transfer is in progress.
+ * Buffers aligned to, and sized in multiples of HAL_DMA_BUF_ALIGN are
+ * safe; the helpers below allocate them.
+ */
+
+/** Alignment and size granule of DMA buffers, the data cache line size */
+#define HAL_DMA_BUF_ALIGN       MYNEWT_VAL(HAL_DMA_BUF_ALIGN)
+
+/** Size rounded up to whole cache lines */
+#define HAL_DMA_BUF_SIZE(sz) \
+    (((sz) + HAL_DMA_BUF_ALIGN - 1) & ~(HAL_DMA_BUF_ALIGN - 1))
+
+/** Defines a buffer which owns all cache lines it touches */
+#define HAL_DMA_BUF_DEFINE(name, sz) \
+    uint8_t name[HAL_DMA_BUF_SIZE(sz)] \
+    __attribute__((aligned(HAL_DMA_BUF_ALIGN)))
+
+/**
+ * Block size to pass to hal_dma_mempool_init() for blocks of at least sz
+ * bytes; the memory pool guard, if enabled, is accounted for.
+ */
+#define HAL_DMA_MEMPOOL_BLOCK_SZ(sz) \
+    (HAL_DMA_BUF_SIZE(OS_MEMPOOL_BLOCK_SZ(sz)) - OS_MEMPOOL_BLOCK_SZ(0))
+
+/** Defines memory for hal_dma_mempool_init() with n blocks of sz bytes */
+#define HAL_DMA_MEMPOOL_DEFINE(name, n, sz) \
+    HAL_DMA_BUF_DEFINE(name, (n) * HAL_DMA_BUF_SIZE(OS_MEMPOOL_BLOCK_SZ(sz)))
+
+#if MYNEWT_VAL(HAL_DMA_CACHE_MAINT)
+/**
+ * Makes CPU writes to a buffer visible to DMA.  Call before starting a
+ * transfer from or to the buffer; for transfers to memory this also makes
+ * sure no dirty line gets written back over the DMA data later.
+ *
+ * @param buf Buffer
+ * @param len Number of bytes
+ */
+void hal_dma_sync_for_device(const void *buf, size_t len);
+
+/**
+ * Makes DMA writes to a buffer visible to CPU.  Call after a transfer to
+ * memory has finished, before CPU reads the buffer.  Lines only partially
+ * covered by the buffer are written back first, so that CPU writes to the
+ * rest of them are not lost.
+ *
+ * @param buf Buffer
+ * @param len Number of bytes
+ */
+void hal_dma_sync_for_cpu(void *buf, size_t len);
+#else
+static inline void
+hal_dma_sync_for_device(const void *buf, size_t len)
+{
+    (void)buf;
+    (void)len;
+}
+
+static inline void
+hal_dma_sync_for_cpu(void *buf, size_t len)
+{
+    (void)buf;
+    (void)len;
+}
+#endif
+
+/**
+ * Initializes a memory pool whose blocks are safe to use as DMA buffers.
+ *
+ * @param mp         Memory pool
+ * @param blocks     Number of blocks
+ * @param block_size Minimum block size, rounded up to whole cache lines
+ * @param membuf     Memory from HAL_DMA_MEMPOOL_DEFINE()
+ * @param name       Name of the pool
+ *
+ * @return 0 on success, SYS_EINVAL if membuf is not aligned or on bad
+ *         arguments.
+ */
+int hal_dma_mempool_init(struct os_mempool *mp, uint16_t blocks,
+                         uint32_t block_size, void *membuf, char *name);
+
+/**
+ * Initializes a memory pool as with hal_dma_mempool_init(), and an mbuf
+ * pool using it.  Each mbuf then owns the cache lines it spans, so DMA
+ * can go to or from its data as long as the mbuf header is not modified
+ * during the transfer.
+ *
+ * @param omp        Mbuf pool
+ * @param mp         Memory pool
+ * @param blocks     Number of mbufs
+ * @param block_size Minimum mbuf size including headers
+ * @param membuf     Memory from HAL_DMA_MEMPOOL_DEFINE()
+ * @param name       Name of the pool
+ *
+ * @return 0 on success, SYS_EINVAL on bad arguments.
+ */
+int hal_dma_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
+                           uint16_t blocks, uint32_t block_size,
+                           void *membuf, char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_HAL_DMA_ */
+
+/**
+ *   @} HALDma
+ * @} HAL
+ */
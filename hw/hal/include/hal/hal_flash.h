@@ -32,6 +32,10 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+#include "os/os_eventq.h"
+#endif
 
 int hal_flash_ioctl(uint8_t flash_id, uint32_t cmd, void *args);
 
@@ -178,6 +182,71 @@ int hal_flash_init(void);
  */
 int hal_flash_write_protect(uint8_t id, uint8_t protect);
 
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+/**
+ * @brief Returns pointer for direct read access to flash.
+ *
+ * Pointer stays valid until next write or erase of the range.
+ *
+ * @param flash_id              The ID of the flash device.
+ * @param address               The address of first byte.
+ * @param num_bytes             The number of bytes to be accessed.
+ *
+ * @return                      Pointer to flash contents;
+ *                              NULL if range is not memory mapped, use
+ *                                  hal_flash_read() instead.
+ */
+const void *hal_flash_mmap(uint8_t flash_id, uint32_t address,
+  uint32_t num_bytes);
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+
+#define HAL_FLASH_OP_READ       0
+#define HAL_FLASH_OP_WRITE      1
+#define HAL_FLASH_OP_ERASE      2
+
+/**
+ * Asynchronous flash request.  Caller fills in all fields except hfr_rc,
+ * and must not touch the request until the completion event is delivered.
+ */
+struct hal_flash_req {
+    /** Completion event; caller sets ev_cb and ev_arg. */
+    struct os_event hfr_ev;
+    /**
+     * Queue the completion event is put to.  If NULL, ev_cb is called
+     * directly from the completion context, which may be an interrupt.
+     */
+    struct os_eventq *hfr_evq;
+    /** One of HAL_FLASH_OP_[...] */
+    uint8_t hfr_op;
+    uint8_t hfr_flash_id;
+    uint32_t hfr_addr;
+    /** Destination for read, source for write, unused for erase. */
+    void *hfr_buf;
+    uint32_t hfr_len;
+    /** Result, 0 on success; SYS_EIO on flash driver error. */
+    int hfr_rc;
+};
+
+/**
+ * @brief Starts asynchronous flash read, write or erase.
+ *
+ * When driver does not support asynchronous operation, it is executed
+ * synchronously and completion event is delivered before this function
+ * returns.
+ *
+ * @param req                   The request to execute.
+ *
+ * @return                      0 if request was started, completion event
+ *                                  will follow;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EACCES if flash is write protected.
+ */
+int hal_flash_submit(struct hal_flash_req *req);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,11 +25,13 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
 
 /*
  * API that flash driver has to implement.
  */
 struct hal_flash;
+struct hal_flash_req;
 
 struct hal_flash_funcs {
     int (*hff_read)(const struct hal_flash *dev, uint32_t address, void *dst,
@@ -45,6 +47,23 @@ struct hal_flash_funcs {
     int (*hff_init)(const struct hal_flash *dev);
     int (*hff_erase)(const struct hal_flash *dev, uint32_t address,
             uint32_t num_bytes);
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    /*
+     * Returns CPU address where flash range can be read from, NULL if
+     * it is not memory mapped at the moment.
+     */
+    const void *(*hff_mmap)(const struct hal_flash *dev, uint32_t address,
+            uint32_t num_bytes);
+#endif
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    /*
+     * Starts request, calls hal_flash_req_done() when finished. Returns
+     * SYS_ENOTSUP for operations that should be executed synchronously.
+     * Erase range is already aligned to sector boundaries.
+     */
+    int (*hff_submit)(const struct hal_flash *dev,
+            struct hal_flash_req *req);
+#endif
 };
 
 struct hal_flash {
@@ -63,6 +82,14 @@ uint32_t hal_flash_sector_size(const struct hal_flash *hf, int sec_idx);
 
 int hal_flash_is_erased(const struct hal_flash *, uint32_t, void *, uint32_t);
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Called by driver when request started with hff_submit is finished.
+ * Can be called from interrupt context.
+ */
+void hal_flash_req_done(struct hal_flash_req *req, int rc);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
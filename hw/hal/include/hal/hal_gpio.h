@@ -28,6 +28,9 @@
 #ifndef H_HAL_GPIO_
 #define H_HAL_GPIO_
 
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -136,6 +139,79 @@ int hal_gpio_read(int pin);
  */
 int hal_gpio_toggle(int pin);
 
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+/**
+ * Converts pin number to port index and pin mask used by port level
+ * functions. Result can be computed once and used for fast access to pin.
+ *
+ * @param pin  Pin number
+ * @param port Port index
+ * @param mask Mask of pin within port
+ *
+ * @return int  0: no error; -1 if pin does not exist.
+ */
+int hal_gpio_port_pin(int pin, int *port, uint32_t *mask);
+
+/**
+ * Writes several pins of one port at once. Pins in mask are set to
+ * corresponding bit of val, other pins are not affected. Pins must be
+ * configured as outputs.
+ *
+ * @param port Port index from hal_gpio_port_pin()
+ * @param mask Pins to write
+ * @param val  Values of pins
+ */
+void hal_gpio_port_write_masked(int port, uint32_t mask, uint32_t val);
+
+/**
+ * Reads input state of all pins of a port.
+ *
+ * @param port Port index from hal_gpio_port_pin()
+ *
+ * @return uint32_t Bit n is state of pin with mask (1 << n)
+ */
+uint32_t hal_gpio_port_read(int port);
+
+/** Maximum number of pins of a GPIO bus */
+#define HAL_GPIO_BUS_MAX_WIDTH  16
+
+/**
+ * Group of pins on one port written as a parallel bus. Bit n of value
+ * written to the bus goes to n-th pin passed to hal_gpio_bus_init().
+ */
+struct hal_gpio_bus {
+    /** Port index */
+    int hgb_port;
+    /** All pins of the bus */
+    uint32_t hgb_mask;
+    /** Shift of value when pins are consecutive, -1 otherwise */
+    int8_t hgb_shift;
+    /** Number of pins */
+    uint8_t hgb_width;
+    /** Port mask of each pin */
+    uint32_t hgb_bit[HAL_GPIO_BUS_MAX_WIDTH];
+};
+
+/**
+ * Prepares bus for pins. Pins must be on the same port.
+ *
+ * @param bus  Bus to initialize
+ * @param pins Pins, least significant bit first
+ * @param cnt  Number of pins, at most HAL_GPIO_BUS_MAX_WIDTH
+ *
+ * @return int  0: no error; -1 if pins are not on one port.
+ */
+int hal_gpio_bus_init(struct hal_gpio_bus *bus, const int *pins, int cnt);
+
+/**
+ * Writes value to all pins of the bus at once.
+ *
+ * @param bus Bus
+ * @param val Value, bit n goes to n-th pin of bus
+ */
+void hal_gpio_bus_write(const struct hal_gpio_bus *bus, uint32_t val);
+#endif
+
 /**
  * Initialize a given pin to trigger a GPIO IRQ callback.
  *
@@ -33,7 +33,7 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
-
+#include "syscfg/syscfg.h"
 
 /**
  * Function prototype for UART driver to ask for more data to send.
@@ -64,6 +64,71 @@ typedef int (*hal_uart_rx_char)(void *arg, uint8_t byte);
 int hal_uart_init_cbs(int uart, hal_uart_tx_char tx_func,
   hal_uart_tx_done tx_done, hal_uart_rx_char rx_func, void *arg);
 
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+/**
+ * Function prototype for UART driver to report received data in block mode.
+ * Called from interrupt context when half of the RX buffer has been filled
+ * or when the line has been idle for the configured time with data pending.
+ * Data must be consumed (copied) before returning; the driver keeps
+ * receiving into the other half of the buffer meanwhile.
+ */
+typedef void (*hal_uart_rx_block)(void *arg, const uint8_t *data,
+                                  uint16_t len);
+
+/**
+ * Function prototype for UART driver to report that the buffer passed to
+ * hal_uart_tx_block() has been sent. Called from interrupt context, next
+ * buffer can be started from the callback.
+ */
+typedef void (*hal_uart_tx_block_done)(void *arg);
+
+/** Block mode configuration */
+struct hal_uart_block_cfg {
+    /** RX buffer, used as two halves (double buffering) */
+    uint8_t *ub_rx_buf;
+    /** Size of RX buffer, must be even */
+    uint16_t ub_rx_buf_size;
+    /**
+     * Line idle time after which pending RX data is reported, drivers
+     * using hardware idle line detection (STM32: one character time)
+     * ignore it
+     */
+    uint16_t ub_idle_us;
+    hal_uart_rx_block ub_rx_func;
+    hal_uart_tx_block_done ub_tx_done;
+    void *ub_arg;
+};
+
+/**
+ * Switches given uart to block mode. Like hal_uart_init_cbs() this has to
+ * be called before hal_uart_config(); byte callbacks, hal_uart_start_tx()
+ * and hal_uart_start_rx() are not used in block mode.
+ * hal_uart_blocking_tx() keeps working.
+ *
+ * @param uart  UART number
+ * @param cfg   Block mode configuration, copied by the driver; RX buffer
+ *              must stay valid while uart is open
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int hal_uart_init_block(int uart, const struct hal_uart_block_cfg *cfg);
+
+/**
+ * Starts transmission of a buffer in block mode. Driver may send less than
+ * requested (e.g. DMA transfer size limit), the rest has to be queued
+ * again after the done callback. Buffer must stay valid until then and,
+ * for DMA capable drivers, must be located in RAM.
+ *
+ * @param uart  UART number
+ * @param data  Data to send
+ * @param len   Number of bytes to send
+ *
+ * @return number of bytes accepted, SYS_EBUSY if previous buffer is still
+ *         being sent, other negative error code on failure
+ */
+int hal_uart_tx_block(int uart, const void *data, uint16_t len);
+#endif
+
 enum hal_uart_parity {
     /** No Parity */
     HAL_UART_PARITY_NONE = 0,
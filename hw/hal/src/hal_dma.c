@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_dma.h"
+
+int
+hal_dma_mempool_init(struct os_mempool *mp, uint16_t blocks,
+                     uint32_t block_size, void *membuf, char *name)
+{
+    if ((uintptr_t)membuf & (HAL_DMA_BUF_ALIGN - 1)) {
+        return SYS_EINVAL;
+    }
+    if (os_mempool_init(mp, blocks, HAL_DMA_MEMPOOL_BLOCK_SZ(block_size),
+                        membuf, name)) {
+        return SYS_EINVAL;
+    }
+
+    return 0;
+}
+
+int
+hal_dma_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
+                       uint16_t blocks, uint32_t block_size, void *membuf,
+                       char *name)
+{
+    int rc;
+
+    rc = hal_dma_mempool_init(mp, blocks, block_size, membuf, name);
+    if (rc) {
+        return rc;
+    }
+    if (os_mbuf_pool_init(omp, mp, mp->mp_block_size, blocks)) {
+        return SYS_EINVAL;
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(HAL_DMA)
+
+struct hal_dma_memcpy_req {
+    struct os_sem sem;
+    int status;
+};
+
+static void
+hal_dma_memcpy_done(void *arg, int status)
+{
+    struct hal_dma_memcpy_req *req = arg;
+
+    req->status = status;
+    os_sem_release(&req->sem);
+}
+
+int
+hal_dma_memcpy(void *dst, const void *src, size_t len)
+{
+    struct hal_dma_memcpy_req req;
+    struct hal_dma_desc desc;
+    struct hal_dma_cfg cfg = {
+        .hdc_dir = HAL_DMA_MEM_TO_MEM,
+        .hdc_done_cb = hal_dma_memcpy_done,
+        .hdc_done_arg = &req,
+    };
+    int channel;
+    int rc;
+
+    if (len < MYNEWT_VAL(HAL_DMA_MEMCPY_MIN_LEN)) {
+        goto cpu_copy;
+    }
+
+    if ((((uintptr_t)dst | (uintptr_t)src | len) & 3) == 0) {
+        cfg.hdc_width = 4;
+    } else {
+        cfg.hdc_width = 1;
+    }
+
+    channel = hal_dma_channel_request(-1, &cfg);
+    if (channel < 0) {
+        goto cpu_copy;
+    }
+
+    os_sem_init(&req.sem, 0);
+    desc.hdd_src = src;
+    desc.hdd_dst = dst;
+    desc.hdd_len = len;
+    desc.hdd_next = NULL;
+
+    rc = hal_dma_start(channel, &desc);
+    if (rc == 0) {
+        os_sem_pend(&req.sem, OS_TIMEOUT_NEVER);
+        rc = req.status;
+    }
+    hal_dma_channel_release(channel);
+
+    return rc;
+
+cpu_copy:
+    memcpy(dst, src, len);
+    return 0;
+}
+
+#endif
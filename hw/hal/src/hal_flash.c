@@ -121,6 +121,25 @@ hal_flash_read(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
     return 0;
 }
 
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+const void *
+hal_flash_mmap(uint8_t id, uint32_t address, uint32_t num_bytes)
+{
+    const struct hal_flash *hf;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf || !hf->hf_itf->hff_mmap) {
+        return NULL;
+    }
+    if (hal_flash_check_addr(hf, address) ||
+      hal_flash_check_addr(hf, address + num_bytes)) {
+        return NULL;
+    }
+
+    return hf->hf_itf->hff_mmap(hf, address, num_bytes);
+}
+#endif
+
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_WRITES)
 /**
  * Verifies that the specified range of flash contains the given contents.
@@ -403,3 +422,133 @@ hal_flash_write_protect(uint8_t id, uint8_t protect)
 
     return SYS_EOK;
 }
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+void
+hal_flash_req_done(struct hal_flash_req *req, int rc)
+{
+    req->hfr_rc = rc ? SYS_EIO : 0;
+    if (req->hfr_evq) {
+        os_eventq_put(req->hfr_evq, &req->hfr_ev);
+    } else {
+        req->hfr_ev.ev_cb(&req->hfr_ev);
+    }
+}
+
+/*
+ * Extends erase range of the request to sector boundaries.
+ */
+static int
+hal_flash_req_align(const struct hal_flash *hf, struct hal_flash_req *req)
+{
+    uint32_t start;
+    uint32_t size;
+    uint32_t first;
+    uint32_t last;
+    uint32_t end;
+    int rc;
+    int i;
+
+    end = req->hfr_addr + req->hfr_len;
+    first = end;
+    last = req->hfr_addr;
+    for (i = 0; i < hf->hf_sector_cnt; i++) {
+        rc = hf->hf_itf->hff_sector_info(hf, i, &start, &size);
+        assert(rc == 0);
+        if (req->hfr_addr < start + size && end > start) {
+            if (start < first) {
+                first = start;
+            }
+            if (start + size > last) {
+                last = start + size;
+            }
+        }
+    }
+    if (first >= last) {
+        return SYS_EINVAL;
+    }
+    req->hfr_addr = first;
+    req->hfr_len = last - first;
+
+    return 0;
+}
+
+static int
+hal_flash_req_sync(struct hal_flash_req *req)
+{
+    int rc;
+
+    switch (req->hfr_op) {
+    case HAL_FLASH_OP_READ:
+        rc = hal_flash_read(req->hfr_flash_id, req->hfr_addr, req->hfr_buf,
+                            req->hfr_len);
+        break;
+    case HAL_FLASH_OP_WRITE:
+        rc = hal_flash_write(req->hfr_flash_id, req->hfr_addr, req->hfr_buf,
+                             req->hfr_len);
+        break;
+    default:
+        rc = hal_flash_erase(req->hfr_flash_id, req->hfr_addr, req->hfr_len);
+        break;
+    }
+    if (rc == SYS_EINVAL || rc == SYS_EACCES) {
+        return rc;
+    }
+    hal_flash_req_done(req, rc);
+
+    return 0;
+}
+
+int
+hal_flash_submit(struct hal_flash_req *req)
+{
+    const struct hal_flash *hf;
+    uint8_t id;
+    int rc;
+
+    id = req->hfr_flash_id;
+    hf = hal_bsp_flash_dev(id);
+    if (!hf || req->hfr_op > HAL_FLASH_OP_ERASE) {
+        return SYS_EINVAL;
+    }
+    if (hal_flash_check_addr(hf, req->hfr_addr) ||
+      hal_flash_check_addr(hf, req->hfr_addr + req->hfr_len) ||
+      req->hfr_addr + req->hfr_len < req->hfr_addr) {
+        return SYS_EINVAL;
+    }
+
+    /*
+     * Verification reads back data after operation completes, that is
+     * only done by synchronous path.
+     */
+    if (!hf->hf_itf->hff_submit ||
+        (MYNEWT_VAL(HAL_FLASH_VERIFY_WRITES) &&
+         req->hfr_op == HAL_FLASH_OP_WRITE) ||
+        (MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES) &&
+         req->hfr_op == HAL_FLASH_OP_ERASE)) {
+        return hal_flash_req_sync(req);
+    }
+
+    if (req->hfr_op != HAL_FLASH_OP_READ) {
+        if (protected_flash[id / 8] & (1 << (id & 7))) {
+            return SYS_EACCES;
+        }
+    }
+    if (req->hfr_op == HAL_FLASH_OP_ERASE) {
+        rc = hal_flash_req_align(hf, req);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = hf->hf_itf->hff_submit(hf, req);
+    if (rc == SYS_ENOTSUP) {
+        return hal_flash_req_sync(req);
+    }
+    if (rc) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+#endif
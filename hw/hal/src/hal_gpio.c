@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "hal/hal_gpio.h"
+
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+
+int
+hal_gpio_bus_init(struct hal_gpio_bus *bus, const int *pins, int cnt)
+{
+    uint32_t mask;
+    int port;
+    int i;
+
+    if (cnt <= 0 || cnt > HAL_GPIO_BUS_MAX_WIDTH) {
+        return -1;
+    }
+
+    bus->hgb_mask = 0;
+    for (i = 0; i < cnt; i++) {
+        if (hal_gpio_port_pin(pins[i], &port, &mask)) {
+            return -1;
+        }
+        if (i == 0) {
+            bus->hgb_port = port;
+        } else if (port != bus->hgb_port) {
+            return -1;
+        }
+        bus->hgb_bit[i] = mask;
+        bus->hgb_mask |= mask;
+    }
+    bus->hgb_width = cnt;
+
+    /* Consecutive pins in ascending order only need value shifted */
+    bus->hgb_shift = __builtin_ctz(bus->hgb_bit[0]);
+    for (i = 1; i < cnt; i++) {
+        if (bus->hgb_bit[i] != bus->hgb_bit[0] << i) {
+            bus->hgb_shift = -1;
+            break;
+        }
+    }
+
+    return 0;
+}
+
+void
+hal_gpio_bus_write(const struct hal_gpio_bus *bus, uint32_t val)
+{
+    uint32_t out;
+    int i;
+
+    if (bus->hgb_shift >= 0) {
+        out = val << bus->hgb_shift;
+    } else {
+        out = 0;
+        for (i = 0; i < bus->hgb_width; i++) {
+            if (val & (1 << i)) {
+                out |= bus->hgb_bit[i];
+            }
+        }
+    }
+
+    hal_gpio_port_write_masked(bus->hgb_port, bus->hgb_mask, out);
+}
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_dma.h"
+#include "mcu/da1469x_dma.h"
+
+#if MYNEWT_VAL(HAL_DMA)
+
+/* DMA_LEN_REG is 16 bits, longer descriptors are split */
+#define DA1469X_HAL_DMA_MAX_XFERS   0x10000
+
+struct da1469x_hal_dma {
+    struct da1469x_dma_regs *regs;
+    struct hal_dma_cfg cfg;
+    /* Descriptor being transferred and offset of current chunk in it */
+    struct hal_dma_desc *desc;
+    uint32_t off;
+    uint32_t chunk;
+};
+
+static struct da1469x_hal_dma da1469x_hal_dma[MCU_DMA_CHAN_MAX];
+
+static int
+da1469x_hal_dma_valid(int channel)
+{
+    return channel >= 0 && channel < MCU_DMA_CHAN_MAX &&
+           da1469x_hal_dma[channel].regs;
+}
+
+static uint32_t
+da1469x_hal_dma_mem_addr(const void *mem)
+{
+    /* DMA can only access QSPI flash through uncached alias */
+    if (MCU_MEM_QSPIF_M_RANGE_ADDRESS(mem)) {
+        return (uint32_t)mem + 0x20000000;
+    }
+
+    return (uint32_t)mem;
+}
+
+static void
+da1469x_hal_dma_chunk_start(struct da1469x_hal_dma *hd)
+{
+    struct hal_dma_desc *desc = hd->desc;
+    struct da1469x_dma_regs *regs = hd->regs;
+    uint32_t src = (uint32_t)desc->hdd_src;
+    uint32_t dst = (uint32_t)desc->hdd_dst;
+    uint32_t xfers;
+
+    if (hd->cfg.hdc_dir != HAL_DMA_PERIPH_TO_MEM) {
+        src = da1469x_hal_dma_mem_addr((const uint8_t *)desc->hdd_src +
+                                       hd->off);
+    }
+    if (hd->cfg.hdc_dir != HAL_DMA_MEM_TO_PERIPH) {
+        dst += hd->off;
+    }
+    xfers = (desc->hdd_len - hd->off) / hd->cfg.hdc_width;
+    if (xfers > DA1469X_HAL_DMA_MAX_XFERS) {
+        xfers = DA1469X_HAL_DMA_MAX_XFERS;
+    }
+    hd->chunk = xfers * hd->cfg.hdc_width;
+
+    regs->DMA_A_START_REG = src;
+    regs->DMA_B_START_REG = dst;
+    regs->DMA_INT_REG = xfers - 1;
+    regs->DMA_LEN_REG = xfers - 1;
+    regs->DMA_CTRL_REG |= DMA_DMA0_CTRL_REG_DMA_ON_Msk;
+}
+
+static int
+da1469x_hal_dma_isr(void *arg)
+{
+    struct da1469x_hal_dma *hd = arg;
+
+    if (!hd->desc) {
+        return 0;
+    }
+
+    hd->off += hd->chunk;
+    if (hd->off >= hd->desc->hdd_len) {
+        hd->desc = hd->desc->hdd_next;
+        hd->off = 0;
+    }
+    if (hd->desc) {
+        da1469x_hal_dma_chunk_start(hd);
+    } else if (hd->cfg.hdc_done_cb) {
+        hd->cfg.hdc_done_cb(hd->cfg.hdc_done_arg, 0);
+    }
+
+    return 0;
+}
+
+int
+hal_dma_channel_request(int channel, const struct hal_dma_cfg *cfg)
+{
+    struct da1469x_dma_config dma_cfg;
+    struct da1469x_dma_regs *chans[2];
+    struct da1469x_dma_regs *regs;
+    struct da1469x_hal_dma *hd;
+    int rc;
+
+    if (channel >= MCU_DMA_CHAN_MAX) {
+        return SYS_EINVAL;
+    }
+    switch (cfg->hdc_width) {
+    case 1:
+        dma_cfg.bus_width = MCU_DMA_BUS_WIDTH_1B;
+        break;
+    case 2:
+        dma_cfg.bus_width = MCU_DMA_BUS_WIDTH_2B;
+        break;
+    case 4:
+        dma_cfg.bus_width = MCU_DMA_BUS_WIDTH_4B;
+        break;
+    default:
+        return SYS_EINVAL;
+    }
+
+    if (cfg->hdc_dir == HAL_DMA_MEM_TO_MEM) {
+        regs = da1469x_dma_acquire_single(channel);
+        if (!regs) {
+            return channel < 0 ? SYS_ENOENT : SYS_EBUSY;
+        }
+    } else {
+        /*
+         * Peripheral requests use pair of channels, lower one reads from
+         * peripheral and upper one writes to it. Both stay acquired.
+         */
+        if (cfg->hdc_request >= MCU_DMA_PERIPH_NONE) {
+            return SYS_EINVAL;
+        }
+        rc = da1469x_dma_acquire_periph(channel, cfg->hdc_request, chans);
+        if (rc) {
+            return rc;
+        }
+        regs = chans[cfg->hdc_dir == HAL_DMA_MEM_TO_PERIPH ? 1 : 0];
+    }
+    channel = regs - (struct da1469x_dma_regs *)DMA;
+
+    hd = &da1469x_hal_dma[channel];
+    hd->regs = regs;
+    hd->cfg = *cfg;
+    hd->desc = NULL;
+
+    dma_cfg.src_inc = cfg->hdc_dir != HAL_DMA_PERIPH_TO_MEM;
+    dma_cfg.dst_inc = cfg->hdc_dir != HAL_DMA_MEM_TO_PERIPH;
+    dma_cfg.priority = cfg->hdc_priority > 7 ? 7 : cfg->hdc_priority;
+    dma_cfg.burst_mode = MCU_DMA_BURST_MODE_DISABLED;
+    da1469x_dma_configure(regs, &dma_cfg, da1469x_hal_dma_isr, hd);
+
+    return channel;
+}
+
+int
+hal_dma_channel_release(int channel)
+{
+    struct da1469x_hal_dma *hd;
+
+    if (!da1469x_hal_dma_valid(channel)) {
+        return SYS_EINVAL;
+    }
+    hd = &da1469x_hal_dma[channel];
+    hd->desc = NULL;
+    da1469x_dma_release_channel(hd->regs);
+    hd->regs = NULL;
+
+    return 0;
+}
+
+int
+hal_dma_start(int channel, struct hal_dma_desc *desc)
+{
+    struct da1469x_hal_dma *hd;
+    struct hal_dma_desc *d;
+    int sr;
+
+    if (!da1469x_hal_dma_valid(channel) || !desc) {
+        return SYS_EINVAL;
+    }
+    hd = &da1469x_hal_dma[channel];
+    for (d = desc; d; d = d->hdd_next) {
+        if (d->hdd_len == 0 || d->hdd_len % hd->cfg.hdc_width) {
+            return SYS_EINVAL;
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (hd->desc) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    hd->desc = desc;
+    hd->off = 0;
+    da1469x_hal_dma_chunk_start(hd);
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+int
+hal_dma_stop(int channel)
+{
+    struct da1469x_hal_dma *hd;
+    int sr;
+
+    if (!da1469x_hal_dma_valid(channel)) {
+        return SYS_EINVAL;
+    }
+    hd = &da1469x_hal_dma[channel];
+
+    OS_ENTER_CRITICAL(sr);
+    hd->desc = NULL;
+    hd->regs->DMA_CTRL_REG &= ~DMA_DMA0_CTRL_REG_DMA_ON_Msk;
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+#endif
@@ -19,11 +19,28 @@
 #ifndef __MCU_SIM_H__
 #define __MCU_SIM_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Counts of operations performed on the simulated flash.  Only calls made
+ * through the HAL flash interface are counted.  Tests may clear this
+ * between runs to measure one workload.
+ */
+struct native_flash_stats {
+    uint32_t nfs_reads;
+    uint32_t nfs_read_bytes;
+    uint32_t nfs_writes;
+    uint32_t nfs_write_bytes;
+    uint32_t nfs_erases;
+    uint32_t nfs_erase_bytes;
+};
+
 extern char *native_flash_file;
+extern struct native_flash_stats native_flash_stats;
 extern char *native_uart_log_file;
 extern const char *native_uart_dev_strs[];
 
@@ -31,6 +31,7 @@
 #include "mcu/mcu_sim.h"
 
 char *native_flash_file;
+struct native_flash_stats native_flash_stats;
 static int file = -1;
 static void *file_loc;
 
@@ -156,7 +157,6 @@ flash_native_write_internal(uint32_t address, const void *src, uint32_t length,
     uint32_t cur;
     uint32_t end;
     int chunk_sz;
-    int rc;
     int i;
 
     if (length == 0) {
@@ -177,8 +177,7 @@ flash_native_write_internal(uint32_t address, const void *src, uint32_t length,
 
         /* Ensure data is not being overwritten. */
         if (!allow_overwrite) {
-            rc = native_flash_read(NULL, cur, buf, chunk_sz);
-            assert(rc == 0);
+            memcpy(buf, (char *)file_loc + cur, chunk_sz);
             for (i = 0; i < chunk_sz; i++) {
                 assert(buf[i] == 0xff);
             }
@@ -197,6 +196,8 @@ native_flash_write(const struct hal_flash *dev, uint32_t address,
         const void *src, uint32_t length)
 {
     assert(address % native_flash_dev.hf_align == 0);
+    native_flash_stats.nfs_writes++;
+    native_flash_stats.nfs_write_bytes += length;
     return flash_native_write_internal(address, src, length, 0);
 }
 
@@ -212,6 +213,8 @@ native_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
         uint32_t length)
 {
     flash_native_ensure_file_open();
+    native_flash_stats.nfs_reads++;
+    native_flash_stats.nfs_read_bytes += length;
     memcpy(dst, (char *)file_loc + address, length);
 
     return 0;
@@ -257,6 +260,8 @@ native_flash_erase_sector(const struct hal_flash *dev, uint32_t sector_address)
         return -1;
     }
     len = flash_sector_len(area_id);
+    native_flash_stats.nfs_erases++;
+    native_flash_stats.nfs_erase_bytes += len;
     flash_native_erase(sector_address, len);
     return 0;
 }
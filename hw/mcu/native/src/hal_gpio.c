@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include "os/mynewt.h"
 #include "hal/hal_gpio.h"
 
 #include <stdio.h>
@@ -89,3 +90,44 @@ hal_gpio_toggle(int pin)
     hal_gpio_write(pin, pin_state);
     return pin_state;
 }
+
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+int
+hal_gpio_port_pin(int pin, int *port, uint32_t *mask)
+{
+    if (pin < 0 || pin >= HAL_GPIO_NUM_PINS) {
+        return -1;
+    }
+    *port = 0;
+    *mask = 1 << pin;
+
+    return 0;
+}
+
+void
+hal_gpio_port_write_masked(int port, uint32_t mask, uint32_t val)
+{
+    int pin;
+
+    for (pin = 0; pin < HAL_GPIO_NUM_PINS; pin++) {
+        if (mask & (1 << pin)) {
+            hal_gpio_write(pin, val & (1 << pin));
+        }
+    }
+}
+
+uint32_t
+hal_gpio_port_read(int port)
+{
+    uint32_t val = 0;
+    int pin;
+
+    for (pin = 0; pin < HAL_GPIO_NUM_PINS; pin++) {
+        if (hal_gpio[pin].val) {
+            val |= 1 << pin;
+        }
+    }
+
+    return val;
+}
+#endif
@@ -34,13 +34,20 @@ static int nrf52k_flash_erase_sector(const struct hal_flash *dev,
 static int nrf52k_flash_sector_info(const struct hal_flash *dev, int idx,
         uint32_t *address, uint32_t *sz);
 static int nrf52k_flash_init(const struct hal_flash *dev);
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+static const void *nrf52k_flash_mmap(const struct hal_flash *dev,
+        uint32_t address, uint32_t num_bytes);
+#endif
 
 static const struct hal_flash_funcs nrf52k_flash_funcs = {
     .hff_read = nrf52k_flash_read,
     .hff_write = nrf52k_flash_write,
     .hff_erase_sector = nrf52k_flash_erase_sector,
     .hff_sector_info = nrf52k_flash_sector_info,
-    .hff_init = nrf52k_flash_init
+    .hff_init = nrf52k_flash_init,
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    .hff_mmap = nrf52k_flash_mmap,
+#endif
 };
 
 #ifdef NRF52840_XXAA
@@ -98,6 +105,15 @@ nrf52k_flash_wait_ready(void)
     return -1;
 }
 
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+static const void *
+nrf52k_flash_mmap(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes)
+{
+    return (const void *)address;
+}
+#endif
+
 static int
 nrf52k_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
         uint32_t num_bytes)
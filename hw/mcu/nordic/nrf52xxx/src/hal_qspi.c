@@ -23,6 +23,7 @@
 #include "os/mynewt.h"
 #if MYNEWT_VAL(QSPI_ENABLE)
 #include <mcu/cmsis_nvic.h>
+#include <hal/hal_flash.h>
 #include <hal/hal_flash_int.h>
 #include "mcu/nrf52_hal.h"
 #include "nrf.h"
@@ -78,6 +79,15 @@ nrf52k_qspi_sector_info(const struct hal_flash *dev, int idx,
                         uint32_t *address, uint32_t *sz);
 static int
 nrf52k_qspi_init(const struct hal_flash *dev);
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+static int
+nrf52k_qspi_submit(const struct hal_flash *dev, struct hal_flash_req *req);
+#endif
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+static const void *
+nrf52k_qspi_mmap(const struct hal_flash *dev, uint32_t address,
+                  uint32_t num_bytes);
+#endif
 static int
 nrf52k_qspi_erase(const struct hal_flash *dev, uint32_t address,
                   uint32_t size);
@@ -88,7 +98,13 @@ static const struct hal_flash_funcs nrf52k_qspi_funcs = {
     .hff_erase_sector = nrf52k_qspi_erase_sector,
     .hff_sector_info = nrf52k_qspi_sector_info,
     .hff_init = nrf52k_qspi_init,
-    .hff_erase = nrf52k_qspi_erase
+    .hff_erase = nrf52k_qspi_erase,
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    .hff_submit = nrf52k_qspi_submit,
+#endif
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    .hff_mmap = nrf52k_qspi_mmap,
+#endif
 };
 
 const struct hal_flash nrf52k_qspi_dev = {
@@ -100,6 +116,137 @@ const struct hal_flash nrf52k_qspi_dev = {
     .hf_erased_val = 0xff,
 };
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Asynchronous erase state. Erase of next block is started from QSPI
+ * interrupt when previous one is finished.
+ */
+static struct {
+    struct hal_flash_req *volatile req;
+    uint32_t addr;
+    uint32_t end;
+} nrf52k_qspi_async;
+
+/* Synchronous operations wait for asynchronous erase to finish */
+static void
+nrf52k_qspi_wait_async(void)
+{
+    while (nrf52k_qspi_async.req) {
+        if (os_started()) {
+            os_time_delay(1);
+        }
+    }
+}
+
+static void
+nrf52k_qspi_async_erase_next(void)
+{
+    uint32_t address = nrf52k_qspi_async.addr;
+    uint32_t size = nrf52k_qspi_async.end - address;
+    nrf_qspi_erase_len_t len_type;
+    uint32_t len;
+
+    if (address == 0 && size == MYNEWT_VAL(QSPI_FLASH_SECTOR_COUNT) *
+        MYNEWT_VAL(QSPI_FLASH_SECTOR_SIZE)) {
+        len_type = NRF_QSPI_ERASE_LEN_ALL;
+        len = size;
+    } else if ((address & 0xFFFFU) == 0 && (size >= 0x10000)) {
+        len_type = NRF_QSPI_ERASE_LEN_64KB;
+        len = 0x10000;
+    } else {
+        len_type = NRF_QSPI_ERASE_LEN_4KB;
+        len = 0x1000;
+    }
+    if (len < size) {
+        nrf52k_qspi_async.addr = address + len;
+    } else {
+        nrf52k_qspi_async.addr = nrf52k_qspi_async.end;
+    }
+
+    NRF_QSPI->EVENTS_READY = 0;
+    NRF_QSPI->ERASE.PTR = address;
+    NRF_QSPI->ERASE.LEN = len_type;
+    NRF_QSPI->TASKS_ERASESTART = 1;
+}
+
+static void
+nrf52k_qspi_irq_handler(void)
+{
+    struct hal_flash_req *req;
+
+    os_trace_isr_enter();
+
+    if (NRF_QSPI->EVENTS_READY) {
+        NRF_QSPI->EVENTS_READY = 0;
+        if (nrf52k_qspi_async.addr < nrf52k_qspi_async.end) {
+            nrf52k_qspi_async_erase_next();
+        } else {
+            NRF_QSPI->INTENCLR = QSPI_INTENCLR_READY_Msk;
+            req = nrf52k_qspi_async.req;
+            nrf52k_qspi_async.req = NULL;
+            if (req) {
+                hal_flash_req_done(req, 0);
+            }
+        }
+    }
+
+    os_trace_isr_exit();
+}
+
+static int
+nrf52k_qspi_submit(const struct hal_flash *dev, struct hal_flash_req *req)
+{
+    os_sr_t sr;
+
+    if (req->hfr_op != HAL_FLASH_OP_ERASE) {
+        /* Reads and writes are short DMA transfers, done synchronously */
+        return SYS_ENOTSUP;
+    }
+
+    for (;;) {
+        OS_ENTER_CRITICAL(sr);
+        if (nrf52k_qspi_async.req == NULL) {
+            nrf52k_qspi_async.req = req;
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        OS_EXIT_CRITICAL(sr);
+        nrf52k_qspi_wait_async();
+    }
+
+    while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
+        ;
+
+    nrf52k_qspi_async.addr = req->hfr_addr & ~0xFFFU;
+    nrf52k_qspi_async.end = req->hfr_addr + req->hfr_len;
+    nrf52k_qspi_async_erase_next();
+    NRF_QSPI->INTENSET = QSPI_INTENSET_READY_Msk;
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+/*
+ * Flash is readable in XIP region while peripheral is not busy with
+ * erase or write.
+ */
+static const void *
+nrf52k_qspi_mmap(const struct hal_flash *dev, uint32_t address,
+                  uint32_t num_bytes)
+{
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    if (nrf52k_qspi_async.req) {
+        return NULL;
+    }
+#endif
+    while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
+        ;
+
+    return (const void *)(0x12000000 + address);
+}
+#endif
+
 static int
 nrf52k_qspi_read(const struct hal_flash *dev, uint32_t address,
                  void *dst, uint32_t num_bytes)
@@ -108,6 +255,9 @@ nrf52k_qspi_read(const struct hal_flash *dev, uint32_t address,
     uint8_t *ram_ptr = NULL;
     uint32_t read_bytes;
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf52k_qspi_wait_async();
+#endif
     while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
         ;
 
@@ -162,6 +312,9 @@ nrf52k_qspi_write(const struct hal_flash *dev, uint32_t address,
     const char src_not_in_ram = (((uint32_t) src) & 0xE0000000) != 0x20000000;
     uint32_t page_limit;
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf52k_qspi_wait_async();
+#endif
     while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
         ;
 
@@ -227,6 +380,9 @@ static void
 erase_block(uint32_t starting_address,
             nrf_qspi_erase_len_t block_size_type)
 {
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf52k_qspi_wait_async();
+#endif
     while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
         ;
     NRF_QSPI->EVENTS_READY = 0;
@@ -340,6 +496,13 @@ nrf52k_qspi_init(const struct hal_flash *dev)
     NRF_QSPI->PSEL.IO3 = MYNEWT_VAL(QSPI_PIN_DIO3);
 #endif
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    NVIC_SetVector(QSPI_IRQn, (uint32_t)nrf52k_qspi_irq_handler);
+    NVIC_SetPriority(QSPI_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    NVIC_ClearPendingIRQ(QSPI_IRQn);
+    NVIC_EnableIRQ(QSPI_IRQn);
+#endif
+
     return 0;
 }
 
@@ -26,6 +26,9 @@
 
 #include "nrf.h"
 #include "mcu/nrf52_hal.h"
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+#include "os/os_cputime.h"
+#endif
 
 
 #define UARTE_INT_ENDTX		UARTE_INTEN_ENDTX_Msk
@@ -48,6 +51,25 @@ struct hal_uart {
     hal_uart_tx_char u_tx_func;
     hal_uart_tx_done u_tx_done;
     void *u_func_arg;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    /*
+     * Block mode: RX runs continuously with ENDRX_STARTRX short alternating
+     * between two halves of the RX buffer. TIMER in counter mode counts
+     * RXDRDY events through PPI, which allows reporting partial half once
+     * line is idle without stopping the receiver.
+     */
+    uint8_t u_block:1;
+    uint8_t u_rx_idle:1;
+    uint8_t u_rx_half;
+    uint16_t u_rx_off;
+    uint32_t u_rx_base;
+    uint32_t u_rx_last;
+    uint8_t u_rx_ppi;
+    NRF_TIMER_Type *u_rx_cnt;
+    NRF_UARTE_Type *u_regs;
+    struct hal_uart_block_cfg u_blk;
+    struct hal_timer u_rx_tmr;
+#endif
 };
 
 #if defined(NRF52840_XXAA)
@@ -85,6 +107,9 @@ hal_uart_init_cbs(int port, hal_uart_tx_char tx_func, hal_uart_tx_done tx_done,
     u->u_tx_func = tx_func;
     u->u_tx_done = tx_done;
     u->u_func_arg = arg;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    u->u_block = 0;
+#endif
     return 0;
 }
 
@@ -230,6 +255,256 @@ hal_uart_blocking_tx(int port, uint8_t data)
     nrf_uart->TASKS_STOPTX = 1;
 }
 
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+static NRF_TIMER_Type *const hal_uart_timers[] = {
+    NRF_TIMER0,
+    NRF_TIMER1,
+    NRF_TIMER2,
+#if defined(NRF_TIMER3)
+    NRF_TIMER3,
+    NRF_TIMER4,
+#endif
+};
+
+static uint32_t
+hal_uart_rx_count(struct hal_uart *u)
+{
+    u->u_rx_cnt->TASKS_CAPTURE[0] = 1;
+    return u->u_rx_cnt->CC[0];
+}
+
+/*
+ * Report bytes of current RX half up to off, interrupts disabled.
+ */
+static void
+hal_uart_rx_report(struct hal_uart *u, uint16_t off)
+{
+    const struct hal_uart_block_cfg *blk = &u->u_blk;
+    uint16_t half = blk->ub_rx_buf_size / 2;
+
+    if (off > u->u_rx_off) {
+        blk->ub_rx_func(blk->ub_arg,
+                        blk->ub_rx_buf + u->u_rx_half * half + u->u_rx_off,
+                        off - u->u_rx_off);
+        u->u_rx_off = off;
+    }
+}
+
+/*
+ * Idle line check, runs every ub_idle_us while data is coming in.
+ */
+static void
+hal_uart_rx_idle_tmr(void *arg)
+{
+    struct hal_uart *u = arg;
+    uint16_t half;
+    uint32_t cnt;
+    int sr;
+
+    half = u->u_blk.ub_rx_buf_size / 2;
+
+    __HAL_DISABLE_INTERRUPTS(sr);
+    if (!u->u_open) {
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return;
+    }
+
+    /*
+     * Clear RXDRDY before sampling counter, so a byte received after
+     * this point triggers interrupt once RXDRDY is enabled again.
+     */
+    u->u_regs->EVENTS_RXDRDY = 0;
+    cnt = hal_uart_rx_count(u);
+    if (cnt != u->u_rx_last || cnt - u->u_rx_base > half) {
+        /* Still receiving or waiting for ENDRX */
+        u->u_rx_last = cnt;
+        os_cputime_timer_relative(&u->u_rx_tmr, u->u_blk.ub_idle_us);
+    } else {
+        hal_uart_rx_report(u, cnt - u->u_rx_base);
+        u->u_rx_idle = 1;
+        u->u_regs->INTENSET = UARTE_INTEN_RXDRDY_Msk;
+    }
+    __HAL_ENABLE_INTERRUPTS(sr);
+}
+
+static void
+hal_uart_block_rx_start(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    const struct hal_uart_block_cfg *blk = &u->u_blk;
+    NRF_TIMER_Type *tmr = u->u_rx_cnt;
+
+    tmr->TASKS_STOP = 1;
+    tmr->MODE = TIMER_MODE_MODE_Counter;
+    tmr->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    tmr->TASKS_CLEAR = 1;
+    tmr->TASKS_START = 1;
+
+    NRF_PPI->CH[u->u_rx_ppi].EEP = (uint32_t)&nrf_uart->EVENTS_RXDRDY;
+    NRF_PPI->CH[u->u_rx_ppi].TEP = (uint32_t)&tmr->TASKS_COUNT;
+    NRF_PPI->CHENSET = 1 << u->u_rx_ppi;
+
+    u->u_regs = nrf_uart;
+    u->u_rx_half = 0;
+    u->u_rx_off = 0;
+    u->u_rx_base = 0;
+    u->u_rx_last = 0;
+    u->u_rx_idle = 1;
+
+    nrf_uart->SHORTS = UARTE_SHORTS_ENDRX_STARTRX_Msk;
+    nrf_uart->RXD.PTR = (uint32_t)blk->ub_rx_buf;
+    nrf_uart->RXD.MAXCNT = blk->ub_rx_buf_size / 2;
+    nrf_uart->EVENTS_RXSTARTED = 0;
+    nrf_uart->EVENTS_RXDRDY = 0;
+    nrf_uart->INTENSET = UARTE_INTEN_ENDRX_Msk | UARTE_INTEN_RXSTARTED_Msk |
+                         UARTE_INTEN_RXDRDY_Msk;
+    nrf_uart->TASKS_STARTRX = 1;
+}
+
+static void
+hal_uart_block_rx_stop(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    os_cputime_timer_stop(&u->u_rx_tmr);
+    nrf_uart->SHORTS = 0;
+    NRF_PPI->CHENCLR = 1 << u->u_rx_ppi;
+    u->u_rx_cnt->TASKS_STOP = 1;
+}
+
+static void
+hal_uart_block_irq(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    const struct hal_uart_block_cfg *blk = &u->u_blk;
+    uint16_t half = blk->ub_rx_buf_size / 2;
+    uint16_t amount;
+
+    if (nrf_uart->EVENTS_ENDTX) {
+        nrf_uart->EVENTS_ENDTX = 0;
+        u->u_tx_started = 0;
+        if (blk->ub_tx_done) {
+            blk->ub_tx_done(blk->ub_arg);
+        }
+        if (!u->u_tx_started) {
+            nrf_uart->INTENCLR = UARTE_INT_ENDTX;
+            nrf_uart->TASKS_STOPTX = 1;
+        }
+    }
+    if (nrf_uart->EVENTS_ENDRX) {
+        nrf_uart->EVENTS_ENDRX = 0;
+        /* Receiver already continues in other half because of the short */
+        amount = nrf_uart->RXD.AMOUNT;
+        hal_uart_rx_report(u, amount);
+        u->u_rx_base += amount;
+        u->u_rx_half ^= 1;
+        u->u_rx_off = 0;
+    }
+    if (nrf_uart->EVENTS_RXSTARTED) {
+        nrf_uart->EVENTS_RXSTARTED = 0;
+        /* RXD.PTR is double buffered, set up the half to use after ENDRX */
+        nrf_uart->RXD.PTR = (uint32_t)(blk->ub_rx_buf +
+                                       (u->u_rx_half ^ 1) * half);
+    }
+    if (u->u_rx_idle && nrf_uart->EVENTS_RXDRDY) {
+        /* First byte after idle line, start checking for idle again */
+        nrf_uart->EVENTS_RXDRDY = 0;
+        nrf_uart->INTENCLR = UARTE_INTEN_RXDRDY_Msk;
+        u->u_rx_idle = 0;
+        u->u_rx_last = hal_uart_rx_count(u);
+        os_cputime_timer_relative(&u->u_rx_tmr, blk->ub_idle_us);
+    }
+}
+
+int
+hal_uart_init_block(int port, const struct hal_uart_block_cfg *cfg)
+{
+    struct hal_uart *u;
+    int timer;
+    int ppi;
+
+#if defined(NRF52840_XXAA)
+    if (port == 0) {
+        u = &uart0;
+        timer = MYNEWT_VAL(UART_0_BLOCK_TIMER);
+        ppi = MYNEWT_VAL(UART_0_BLOCK_PPI_CH);
+    } else if (port == 1) {
+        u = &uart1;
+        timer = MYNEWT_VAL(UART_1_BLOCK_TIMER);
+        ppi = MYNEWT_VAL(UART_1_BLOCK_PPI_CH);
+    } else {
+        return -1;
+    }
+#else
+    if (port != 0) {
+        return -1;
+    }
+    u = &uart0;
+    timer = MYNEWT_VAL(UART_0_BLOCK_TIMER);
+    ppi = MYNEWT_VAL(UART_0_BLOCK_PPI_CH);
+#endif
+
+    if (u->u_open || !cfg->ub_rx_func || cfg->ub_rx_buf_size < 2 ||
+        (cfg->ub_rx_buf_size & 1) ||
+        cfg->ub_rx_buf_size / 2 > UARTE_RXD_MAXCNT_MAXCNT_Msk ||
+        timer < 0 || timer >= ARRAY_SIZE(hal_uart_timers)) {
+        return -1;
+    }
+
+    u->u_blk = *cfg;
+    u->u_rx_cnt = hal_uart_timers[timer];
+    u->u_rx_ppi = ppi;
+    u->u_block = 1;
+    os_cputime_timer_init(&u->u_rx_tmr, hal_uart_rx_idle_tmr, u);
+
+    return 0;
+}
+
+int
+hal_uart_tx_block(int port, const void *data, uint16_t len)
+{
+    NRF_UARTE_Type *nrf_uart;
+    struct hal_uart *u;
+    int sr;
+
+#if defined(NRF52840_XXAA)
+    if (port == 0) {
+        nrf_uart = NRF_UARTE0;
+        u = &uart0;
+    } else if (port == 1) {
+        nrf_uart = NRF_UARTE1;
+        u = &uart1;
+    } else {
+        return SYS_EINVAL;
+    }
+#else
+    if (port != 0) {
+        return SYS_EINVAL;
+    }
+    nrf_uart = NRF_UARTE0;
+    u = &uart0;
+#endif
+
+    if (!u->u_open || !u->u_block) {
+        return SYS_EINVAL;
+    }
+    if (len > UARTE_TXD_MAXCNT_MAXCNT_Msk) {
+        len = UARTE_TXD_MAXCNT_MAXCNT_Msk;
+    }
+
+    __HAL_DISABLE_INTERRUPTS(sr);
+    if (u->u_tx_started) {
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return SYS_EBUSY;
+    }
+    u->u_tx_started = 1;
+    nrf_uart->EVENTS_ENDTX = 0;
+    nrf_uart->TXD.PTR = (uint32_t)data;
+    nrf_uart->TXD.MAXCNT = len;
+    nrf_uart->INTENSET = UARTE_INT_ENDTX;
+    nrf_uart->TASKS_STARTTX = 1;
+    __HAL_ENABLE_INTERRUPTS(sr);
+
+    return len;
+}
+#endif
+
 static void
 uart_irq_handler(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
 {
@@ -237,6 +512,14 @@ uart_irq_handler(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
 
     os_trace_isr_enter();
 
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    if (u->u_block) {
+        hal_uart_block_irq(nrf_uart, u);
+        os_trace_isr_exit();
+        return;
+    }
+#endif
+
     if (nrf_uart->EVENTS_ENDTX) {
         nrf_uart->EVENTS_ENDTX = 0;
         rc = hal_uart_tx_fill_buf(u);
@@ -443,10 +726,17 @@ hal_uart_config(int port, int32_t baudrate, uint8_t databits, uint8_t stopbits,
 
     nrf_uart->ENABLE = UARTE_ENABLE;
 
-    nrf_uart->INTENSET = UARTE_INT_ENDRX;
-    nrf_uart->RXD.PTR = (uint32_t)&u->u_rx_buf;
-    nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_buf);
-    nrf_uart->TASKS_STARTRX = 1;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    if (u->u_block) {
+        hal_uart_block_rx_start(nrf_uart, u);
+    } else
+#endif
+    {
+        nrf_uart->INTENSET = UARTE_INT_ENDRX;
+        nrf_uart->RXD.PTR = (uint32_t)&u->u_rx_buf;
+        nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_buf);
+        nrf_uart->TASKS_STARTRX = 1;
+    }
 
     u->u_rx_stall = 0;
     u->u_tx_started = 0;
@@ -483,6 +773,11 @@ hal_uart_close(int port)
     while (u->u_tx_started) {
         /* Wait here until the dma is finished */
     }
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    if (u->u_block) {
+        hal_uart_block_rx_stop(nrf_uart, (struct hal_uart *)u);
+    }
+#endif
     nrf_uart->ENABLE = 0;
     nrf_uart->INTENCLR = 0xffffffff;
     return 0;
@@ -40,6 +40,15 @@ nrf5340_flash_wait_ready(void)
     return -1;
 }
 
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+static const void *
+nrf5340_flash_mmap(const struct hal_flash *dev, uint32_t address,
+                   uint32_t num_bytes)
+{
+    return (const void *)address;
+}
+#endif
+
 static int
 nrf5340_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
                    uint32_t num_bytes)
@@ -209,6 +218,9 @@ static const struct hal_flash_funcs nrf5340_flash_funcs = {
     .hff_sector_info = nrf5340_flash_sector_info,
     .hff_init = nrf5340_flash_init,
     .hff_erase = nrf5340_flash_erase,
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    .hff_mmap = nrf5340_flash_mmap,
+#endif
 };
 
 const struct hal_flash nrf5340_flash_dev = {
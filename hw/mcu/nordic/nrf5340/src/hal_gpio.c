@@ -192,6 +192,41 @@ hal_gpio_toggle(int pin)
     return pin_state;
 }
 
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+#ifdef NRF_P1
+#define HAL_GPIO_PIN_COUNT      48
+#else
+#define HAL_GPIO_PIN_COUNT      32
+#endif
+
+int
+hal_gpio_port_pin(int pin, int *port, uint32_t *mask)
+{
+    if (pin < 0 || pin >= HAL_GPIO_PIN_COUNT) {
+        return -1;
+    }
+    *port = pin >> 5;
+    *mask = HAL_GPIO_MASK(pin);
+
+    return 0;
+}
+
+void
+hal_gpio_port_write_masked(int port, uint32_t mask, uint32_t val)
+{
+    NRF_GPIO_Type *gpio = HAL_GPIO_PORT(port << 5);
+
+    gpio->OUTSET = val & mask;
+    gpio->OUTCLR = ~val & mask;
+}
+
+uint32_t
+hal_gpio_port_read(int port)
+{
+    return HAL_GPIO_PORT(port << 5)->IN;
+}
+#endif
+
 /**
  * Handles the gpio interrupt attached to a gpio pin.
  */
@@ -22,6 +22,9 @@
 #include <stdint.h>
 #include <syscfg/syscfg.h>
 #if MYNEWT_VAL(QSPI_ENABLE)
+#include "os/mynewt.h"
+#include <mcu/cmsis_nvic.h>
+#include <hal/hal_flash.h>
 #include <hal/hal_flash_int.h>
 #include "mcu/nrf5340_hal.h"
 #include "nrf.h"
@@ -88,6 +91,15 @@ nrf5340_qspi_sector_info(const struct hal_flash *dev, int idx,
                          uint32_t *address, uint32_t *sz);
 static int
 nrf5340_qspi_init(const struct hal_flash *dev);
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+static int
+nrf5340_qspi_submit(const struct hal_flash *dev, struct hal_flash_req *req);
+#endif
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+static const void *
+nrf5340_qspi_mmap(const struct hal_flash *dev, uint32_t address,
+                   uint32_t num_bytes);
+#endif
 static int
 nrf5340_qspi_erase(const struct hal_flash *dev, uint32_t address,
                    uint32_t size);
@@ -98,7 +110,13 @@ static const struct hal_flash_funcs nrf5340_qspi_funcs = {
     .hff_erase_sector = nrf5340_qspi_erase_sector,
     .hff_sector_info = nrf5340_qspi_sector_info,
     .hff_init = nrf5340_qspi_init,
-    .hff_erase = nrf5340_qspi_erase
+    .hff_erase = nrf5340_qspi_erase,
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    .hff_submit = nrf5340_qspi_submit,
+#endif
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+    .hff_mmap = nrf5340_qspi_mmap,
+#endif
 };
 
 const struct hal_flash nrf5340_qspi_dev = {
@@ -110,6 +128,138 @@ const struct hal_flash nrf5340_qspi_dev = {
     .hf_erased_val = 0xff,
 };
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Asynchronous erase state. Erase of next block is started from QSPI
+ * interrupt when previous one is finished.
+ */
+static struct {
+    struct hal_flash_req *volatile req;
+    uint32_t addr;
+    uint32_t end;
+} nrf5340_qspi_async;
+
+/* Synchronous operations wait for asynchronous erase to finish */
+static void
+nrf5340_qspi_wait_async(void)
+{
+    while (nrf5340_qspi_async.req) {
+        if (os_started()) {
+            os_time_delay(1);
+        }
+    }
+}
+
+static void
+nrf5340_qspi_async_erase_next(void)
+{
+    uint32_t address = nrf5340_qspi_async.addr;
+    uint32_t size = nrf5340_qspi_async.end - address;
+    nrf_qspi_erase_len_t len_type;
+    uint32_t len;
+
+    if (address == MYNEWT_VAL(QSPI_XIP_OFFSET) &&
+        size == MYNEWT_VAL(QSPI_FLASH_SECTOR_COUNT) *
+                MYNEWT_VAL(QSPI_FLASH_SECTOR_SIZE)) {
+        len_type = NRF_QSPI_ERASE_LEN_ALL;
+        len = size;
+    } else if ((address & 0xFFFFU) == 0 && (size >= 0x10000)) {
+        len_type = NRF_QSPI_ERASE_LEN_64KB;
+        len = 0x10000;
+    } else {
+        len_type = NRF_QSPI_ERASE_LEN_4KB;
+        len = 0x1000;
+    }
+    if (len < size) {
+        nrf5340_qspi_async.addr = address + len;
+    } else {
+        nrf5340_qspi_async.addr = nrf5340_qspi_async.end;
+    }
+
+    NRF_QSPI->EVENTS_READY = 0;
+    NRF_QSPI->ERASE.PTR = address - MYNEWT_VAL(QSPI_XIP_OFFSET);
+    NRF_QSPI->ERASE.LEN = len_type;
+    NRF_QSPI->TASKS_ERASESTART = 1;
+}
+
+static void
+nrf5340_qspi_irq_handler(void)
+{
+    struct hal_flash_req *req;
+
+    os_trace_isr_enter();
+
+    if (NRF_QSPI->EVENTS_READY) {
+        NRF_QSPI->EVENTS_READY = 0;
+        if (nrf5340_qspi_async.addr < nrf5340_qspi_async.end) {
+            nrf5340_qspi_async_erase_next();
+        } else {
+            NRF_QSPI->INTENCLR = QSPI_INTENCLR_READY_Msk;
+            req = nrf5340_qspi_async.req;
+            nrf5340_qspi_async.req = NULL;
+            if (req) {
+                hal_flash_req_done(req, 0);
+            }
+        }
+    }
+
+    os_trace_isr_exit();
+}
+
+static int
+nrf5340_qspi_submit(const struct hal_flash *dev, struct hal_flash_req *req)
+{
+    os_sr_t sr;
+
+    if (req->hfr_op != HAL_FLASH_OP_ERASE) {
+        /* Reads and writes are short DMA transfers, done synchronously */
+        return SYS_ENOTSUP;
+    }
+
+    for (;;) {
+        OS_ENTER_CRITICAL(sr);
+        if (nrf5340_qspi_async.req == NULL) {
+            nrf5340_qspi_async.req = req;
+            OS_EXIT_CRITICAL(sr);
+            break;
+        }
+        OS_EXIT_CRITICAL(sr);
+        nrf5340_qspi_wait_async();
+    }
+
+    while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
+        ;
+
+    nrf5340_qspi_async.addr = req->hfr_addr & ~0xFFFU;
+    nrf5340_qspi_async.end = req->hfr_addr + req->hfr_len;
+    nrf5340_qspi_async_erase_next();
+    NRF_QSPI->INTENSET = QSPI_INTENSET_READY_Msk;
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+/*
+ * Flash is readable in XIP region while peripheral is not busy with
+ * erase or write.
+ */
+static const void *
+nrf5340_qspi_mmap(const struct hal_flash *dev, uint32_t address,
+                   uint32_t num_bytes)
+{
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    if (nrf5340_qspi_async.req) {
+        return NULL;
+    }
+#endif
+    while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
+        ;
+
+    return (const void *)(address);
+}
+#endif
+
 static int
 nrf5340_qspi_read(const struct hal_flash *dev, uint32_t address,
                   void *dst, uint32_t num_bytes)
@@ -122,6 +272,9 @@ nrf5340_qspi_read(const struct hal_flash *dev, uint32_t address,
     uint8_t *ram_ptr = NULL;
     uint32_t read_bytes;
     address -= dev->hf_base_addr;
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf5340_qspi_wait_async();
+#endif
 
     while (num_bytes != 0) {
         /*
@@ -181,6 +334,9 @@ nrf5340_qspi_write(const struct hal_flash *dev, uint32_t address,
 
     address -= MYNEWT_VAL(QSPI_XIP_OFFSET);
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf5340_qspi_wait_async();
+#endif
     while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
         ;
 
@@ -247,6 +403,9 @@ erase_block(uint32_t starting_address,
 {
     starting_address -= MYNEWT_VAL(QSPI_XIP_OFFSET);
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    nrf5340_qspi_wait_async();
+#endif
     while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
         ;
 
@@ -401,6 +560,13 @@ nrf5340_qspi_init(const struct hal_flash *dev)
     while (NRF_QSPI->EVENTS_READY == 0)
         ;
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+    NVIC_SetVector(QSPI_IRQn, (uint32_t)nrf5340_qspi_irq_handler);
+    NVIC_SetPriority(QSPI_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    NVIC_ClearPendingIRQ(QSPI_IRQn);
+    NVIC_EnableIRQ(QSPI_IRQn);
+#endif
+
     return 0;
 }
 
@@ -0,0 +1,411 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_dma.h"
+#include "mcu/cmsis_nvic.h"
+#include "stm32_common/stm32_hal.h"
+#include "stm32_common/stm32_dma.h"
+
+#if MYNEWT_VAL(HAL_DMA_CACHE_MAINT)
+
+#define STM32_DCACHE_LINE   32
+
+#if MYNEWT_VAL(HAL_DMA_BUF_ALIGN) % STM32_DCACHE_LINE
+#error "HAL_DMA_BUF_ALIGN must be a multiple of the 32 byte cache line"
+#endif
+
+void
+hal_dma_sync_for_device(const void *buf, size_t len)
+{
+    uintptr_t start = (uintptr_t)buf & ~(STM32_DCACHE_LINE - 1);
+    uintptr_t end = (uintptr_t)buf + len;
+
+    if (len) {
+        SCB_CleanDCache_by_Addr((uint32_t *)start, end - start);
+    }
+}
+
+void
+hal_dma_sync_for_cpu(void *buf, size_t len)
+{
+    uintptr_t end = (uintptr_t)buf + len;
+    uintptr_t head = (uintptr_t)buf & ~(STM32_DCACHE_LINE - 1);
+    uintptr_t tail = end & ~(STM32_DCACHE_LINE - 1);
+
+    if (len == 0) {
+        return;
+    }
+
+    /* Partial lines may hold CPU data next to the buffer, write it back */
+    if (head != (uintptr_t)buf) {
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)head, STM32_DCACHE_LINE);
+        head += STM32_DCACHE_LINE;
+    }
+    if (tail != end && tail >= head) {
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)tail, STM32_DCACHE_LINE);
+    }
+    if (tail > head) {
+        SCB_InvalidateDCache_by_Addr((uint32_t *)head, tail - head);
+    }
+}
+
+#endif
+
+#if MYNEWT_VAL(HAL_DMA)
+
+/*
+ * Only stream based DMA controllers (F4, F7) are supported for now, other
+ * families map channels to requests differently.
+ */
+#if MYNEWT_VAL(MCU_STM32F4) || MYNEWT_VAL(MCU_STM32F7)
+
+/* NDTR is 16 bits, longer descriptors are split */
+#define STM32_HAL_DMA_MAX_XFERS     0xFFFF
+
+struct stm32_hal_dma {
+    DMA_HandleTypeDef hdma;
+    struct hal_dma_cfg cfg;
+    /* Descriptor being transferred and offset of current chunk in it */
+    struct hal_dma_desc *desc;
+    uint32_t off;
+    uint32_t chunk;
+    uint8_t acquired;
+};
+
+static struct stm32_hal_dma stm32_hal_dma[DMA_CH_NUM];
+
+static DMA_Stream_TypeDef * const stm32_hal_dma_regs[DMA_CH_NUM] = {
+    DMA1_Stream0, DMA1_Stream1, DMA1_Stream2, DMA1_Stream3,
+    DMA1_Stream4, DMA1_Stream5, DMA1_Stream6, DMA1_Stream7,
+    DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3,
+    DMA2_Stream4, DMA2_Stream5, DMA2_Stream6, DMA2_Stream7,
+};
+
+static const IRQn_Type stm32_hal_dma_irqn[DMA_CH_NUM] = {
+    DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn,
+    DMA1_Stream3_IRQn, DMA1_Stream4_IRQn, DMA1_Stream5_IRQn,
+    DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+    DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn,
+    DMA2_Stream3_IRQn, DMA2_Stream4_IRQn, DMA2_Stream5_IRQn,
+    DMA2_Stream6_IRQn, DMA2_Stream7_IRQn,
+};
+
+static void (* const stm32_hal_dma_isr[DMA_CH_NUM])(void) = {
+    stm32_dma1_0_irq_handler, stm32_dma1_1_irq_handler,
+    stm32_dma1_2_irq_handler, stm32_dma1_3_irq_handler,
+    stm32_dma1_4_irq_handler, stm32_dma1_5_irq_handler,
+    stm32_dma1_6_irq_handler, stm32_dma1_7_irq_handler,
+    stm32_dma2_0_irq_handler, stm32_dma2_1_irq_handler,
+    stm32_dma2_2_irq_handler, stm32_dma2_3_irq_handler,
+    stm32_dma2_4_irq_handler, stm32_dma2_5_irq_handler,
+    stm32_dma2_6_irq_handler, stm32_dma2_7_irq_handler,
+};
+
+static int
+stm32_hal_dma_valid(int channel)
+{
+    return channel >= 0 && channel < DMA_CH_NUM &&
+           stm32_hal_dma[channel].acquired;
+}
+
+static void
+stm32_hal_dma_chunk_start(struct stm32_hal_dma *sd)
+{
+    struct hal_dma_desc *desc = sd->desc;
+    uint32_t src = (uint32_t)desc->hdd_src;
+    uint32_t dst = (uint32_t)desc->hdd_dst;
+    uint32_t len;
+
+    if (sd->cfg.hdc_dir != HAL_DMA_MEM_TO_PERIPH) {
+        dst += sd->off;
+    }
+    if (sd->cfg.hdc_dir != HAL_DMA_PERIPH_TO_MEM) {
+        src += sd->off;
+    }
+    len = desc->hdd_len - sd->off;
+    if (len > STM32_HAL_DMA_MAX_XFERS * sd->cfg.hdc_width) {
+        len = STM32_HAL_DMA_MAX_XFERS * sd->cfg.hdc_width;
+    }
+    sd->chunk = len;
+
+    if (sd->cfg.hdc_dir != HAL_DMA_PERIPH_TO_MEM) {
+        hal_dma_sync_for_device((void *)src, len);
+    }
+    if (sd->cfg.hdc_dir != HAL_DMA_MEM_TO_PERIPH) {
+        hal_dma_sync_for_device((void *)dst, len);
+    }
+
+    HAL_DMA_Start_IT(&sd->hdma, src, dst, len / sd->cfg.hdc_width);
+}
+
+static void
+stm32_hal_dma_xfer_cplt(DMA_HandleTypeDef *hdma)
+{
+    struct stm32_hal_dma *sd = CONTAINER_OF(hdma, struct stm32_hal_dma, hdma);
+
+    if (sd->cfg.hdc_dir != HAL_DMA_MEM_TO_PERIPH) {
+        hal_dma_sync_for_cpu((uint8_t *)sd->desc->hdd_dst + sd->off,
+                             sd->chunk);
+    }
+
+    sd->off += sd->chunk;
+    if (sd->off >= sd->desc->hdd_len) {
+        sd->desc = sd->desc->hdd_next;
+        sd->off = 0;
+    }
+    if (sd->desc) {
+        stm32_hal_dma_chunk_start(sd);
+    } else if (sd->cfg.hdc_done_cb) {
+        sd->cfg.hdc_done_cb(sd->cfg.hdc_done_arg, 0);
+    }
+}
+
+static void
+stm32_hal_dma_xfer_error(DMA_HandleTypeDef *hdma)
+{
+    struct stm32_hal_dma *sd = CONTAINER_OF(hdma, struct stm32_hal_dma, hdma);
+
+    /* FIFO errors are not fatal, transfer goes on */
+    if (hdma->ErrorCode == HAL_DMA_ERROR_FE) {
+        return;
+    }
+    sd->desc = NULL;
+    if (sd->cfg.hdc_done_cb) {
+        sd->cfg.hdc_done_cb(sd->cfg.hdc_done_arg, SYS_EIO);
+    }
+}
+
+static int
+stm32_hal_dma_init(int channel, const struct hal_dma_cfg *cfg)
+{
+    static const uint32_t priority[] = {
+        DMA_PRIORITY_LOW, DMA_PRIORITY_MEDIUM,
+        DMA_PRIORITY_HIGH, DMA_PRIORITY_VERY_HIGH,
+    };
+    struct stm32_hal_dma *sd = &stm32_hal_dma[channel];
+    DMA_InitTypeDef *init = &sd->hdma.Init;
+    IRQn_Type irqn = stm32_hal_dma_irqn[channel];
+
+    memset(&sd->hdma, 0, sizeof(sd->hdma));
+    sd->cfg = *cfg;
+    sd->desc = NULL;
+
+    sd->hdma.Instance = stm32_hal_dma_regs[channel];
+    switch (cfg->hdc_dir) {
+    case HAL_DMA_MEM_TO_MEM:
+        init->Channel = DMA_CHANNEL_0;
+        init->Direction = DMA_MEMORY_TO_MEMORY;
+        init->PeriphInc = DMA_PINC_ENABLE;
+        break;
+    case HAL_DMA_MEM_TO_PERIPH:
+        init->Channel = cfg->hdc_request;
+        init->Direction = DMA_MEMORY_TO_PERIPH;
+        init->PeriphInc = DMA_PINC_DISABLE;
+        break;
+    default:
+        init->Channel = cfg->hdc_request;
+        init->Direction = DMA_PERIPH_TO_MEMORY;
+        init->PeriphInc = DMA_PINC_DISABLE;
+        break;
+    }
+    init->MemInc = DMA_MINC_ENABLE;
+    switch (cfg->hdc_width) {
+    case 4:
+        init->PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+        init->MemDataAlignment = DMA_MDATAALIGN_WORD;
+        break;
+    case 2:
+        init->PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+        init->MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+        break;
+    default:
+        init->PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        init->MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        break;
+    }
+    init->Mode = DMA_NORMAL;
+    init->Priority = priority[cfg->hdc_priority > 3 ? 3 : cfg->hdc_priority];
+    /* Memory to memory transfers can't use direct mode */
+    if (cfg->hdc_dir == HAL_DMA_MEM_TO_MEM) {
+        init->FIFOMode = DMA_FIFOMODE_ENABLE;
+        init->FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+    } else {
+        init->FIFOMode = DMA_FIFOMODE_DISABLE;
+    }
+    init->MemBurst = DMA_MBURST_SINGLE;
+    init->PeriphBurst = DMA_PBURST_SINGLE;
+
+    if (channel < DMA2_CH0) {
+        __HAL_RCC_DMA1_CLK_ENABLE();
+    } else {
+        __HAL_RCC_DMA2_CLK_ENABLE();
+    }
+    if (HAL_DMA_Init(&sd->hdma) != HAL_OK) {
+        return SYS_EINVAL;
+    }
+    sd->hdma.XferCpltCallback = stm32_hal_dma_xfer_cplt;
+    sd->hdma.XferErrorCallback = stm32_hal_dma_xfer_error;
+
+    NVIC_DisableIRQ(irqn);
+    NVIC_SetVector(irqn, (uint32_t)stm32_hal_dma_isr[channel]);
+    NVIC_SetPriority(irqn, (1 << __NVIC_PRIO_BITS) - 1);
+    NVIC_ClearPendingIRQ(irqn);
+    NVIC_EnableIRQ(irqn);
+
+    return 0;
+}
+
+int
+hal_dma_channel_request(int channel, const struct hal_dma_cfg *cfg)
+{
+    int first;
+    int rc;
+
+    if (channel >= DMA_CH_NUM || (cfg->hdc_width != 1 &&
+        cfg->hdc_width != 2 && cfg->hdc_width != 4)) {
+        return SYS_EINVAL;
+    }
+
+    /* Only DMA2 can access memory on both ports */
+    first = cfg->hdc_dir == HAL_DMA_MEM_TO_MEM ? DMA2_CH0 : DMA1_CH0;
+    if (channel >= 0) {
+        if (channel < first) {
+            return SYS_EINVAL;
+        }
+        rc = stm32_dma_acquire_channel(channel, &stm32_hal_dma[channel].hdma);
+        if (rc) {
+            return rc;
+        }
+    } else {
+        for (channel = first; channel < DMA_CH_NUM; channel++) {
+            if (stm32_dma_acquire_channel(channel,
+                                          &stm32_hal_dma[channel].hdma) == 0) {
+                break;
+            }
+        }
+        if (channel == DMA_CH_NUM) {
+            return SYS_ENOENT;
+        }
+    }
+
+    rc = stm32_hal_dma_init(channel, cfg);
+    if (rc) {
+        stm32_dma_release_channel(channel);
+        return rc;
+    }
+    stm32_hal_dma[channel].acquired = 1;
+
+    return channel;
+}
+
+int
+hal_dma_channel_release(int channel)
+{
+    if (!stm32_hal_dma_valid(channel)) {
+        return SYS_EINVAL;
+    }
+
+    NVIC_DisableIRQ(stm32_hal_dma_irqn[channel]);
+    HAL_DMA_Abort(&stm32_hal_dma[channel].hdma);
+    HAL_DMA_DeInit(&stm32_hal_dma[channel].hdma);
+    stm32_hal_dma[channel].acquired = 0;
+
+    return stm32_dma_release_channel(channel);
+}
+
+int
+hal_dma_start(int channel, struct hal_dma_desc *desc)
+{
+    struct stm32_hal_dma *sd;
+    struct hal_dma_desc *d;
+    os_sr_t sr;
+
+    if (!stm32_hal_dma_valid(channel) || !desc) {
+        return SYS_EINVAL;
+    }
+    sd = &stm32_hal_dma[channel];
+    for (d = desc; d; d = d->hdd_next) {
+        if (d->hdd_len == 0 || d->hdd_len % sd->cfg.hdc_width) {
+            return SYS_EINVAL;
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (sd->desc) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    sd->desc = desc;
+    sd->off = 0;
+    stm32_hal_dma_chunk_start(sd);
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+int
+hal_dma_stop(int channel)
+{
+    struct stm32_hal_dma *sd;
+    os_sr_t sr;
+
+    if (!stm32_hal_dma_valid(channel)) {
+        return SYS_EINVAL;
+    }
+    sd = &stm32_hal_dma[channel];
+
+    OS_ENTER_CRITICAL(sr);
+    sd->desc = NULL;
+    HAL_DMA_Abort(&sd->hdma);
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+#else
+
+int
+hal_dma_channel_request(int channel, const struct hal_dma_cfg *cfg)
+{
+    return SYS_ENOTSUP;
+}
+
+int
+hal_dma_channel_release(int channel)
+{
+    return SYS_EINVAL;
+}
+
+int
+hal_dma_start(int channel, struct hal_dma_desc *desc)
+{
+    return SYS_EINVAL;
+}
+
+int
+hal_dma_stop(int channel)
+{
+    return SYS_EINVAL;
+}
+
+#endif
+
+#endif
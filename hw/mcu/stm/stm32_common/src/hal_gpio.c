@@ -850,6 +850,34 @@ int hal_gpio_toggle(int pin)
     return pin_state;
 }
 
+#if MYNEWT_VAL(HAL_GPIO_PORT)
+int
+hal_gpio_port_pin(int pin, int *port, uint32_t *mask)
+{
+    if (pin < 0 || MCU_GPIO_PIN_PORT(pin) >= HAL_GPIO_PORT_COUNT ||
+        !portmap[MCU_GPIO_PIN_PORT(pin)]) {
+        return -1;
+    }
+    *port = MCU_GPIO_PIN_PORT(pin);
+    *mask = GPIO_MASK(pin);
+
+    return 0;
+}
+
+void
+hal_gpio_port_write_masked(int port, uint32_t mask, uint32_t val)
+{
+    /* Upper half of BSRR resets pins, lower half sets them, in one write */
+    portmap[port]->BSRR = ((~val & mask) << 16) | (val & mask);
+}
+
+uint32_t
+hal_gpio_port_read(int port)
+{
+    return portmap[port]->IDR;
+}
+#endif
+
 /**
  * gpio irq init
  *
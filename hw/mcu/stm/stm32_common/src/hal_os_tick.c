@@ -372,7 +372,7 @@ os_tick_init(uint32_t os_ticks_per_sec, int prio)
     NVIC_EnableIRQ(RTC_IRQ);
 }
 
-#else
+#elif !MYNEWT_VAL(OS_TICKS_USE_LPTIM)
 #if MYNEWT_VAL(STM32_CLOCK_LSE) == 0 || (((32768 / OS_TICKS_PER_SEC) * OS_TICKS_PER_SEC) != 32768) || !defined(STM32F1)
 
 void
@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <os/mynewt.h>
+#include <stm32_common/mcu.h>
+#include <stm32_common/stm32_hal.h>
+#include <hal/hal_os_tick.h>
+
+/*
+ * OS tick from LPTIM1 clocked by the 32768 Hz LSE, with tickless idle.
+ *
+ * LPTIM1 free-runs over its 16-bit range and keeps counting in Stop mode.
+ * The compare register is set to the next tick boundary, or to the last
+ * tick of an idle period, so the CPU only wakes when the OS needs it to.
+ * Elapsed counts are converted to ticks with a running remainder, so
+ * tick rates which do not divide 32768 do not drift.
+ */
+
+#if MYNEWT_VAL(OS_TICKS_USE_LPTIM)
+
+#if !defined(STM32L0) && !defined(STM32L4) && !defined(STM32WB) && \
+    !defined(STM32G0) && !defined(STM32U5)
+#error OS_TICKS_USE_LPTIM is supported on STM32L0, L4, WB, G0 and U5 only.
+#endif
+
+#if OS_TICKS_PER_SEC > 32768
+#error OS_TICKS_PER_SEC cannot exceed 32768 when OS_TICKS_USE_LPTIM is enabled.
+#endif
+
+#if MYNEWT_VAL(OS_SYSVIEW)
+#undef STM32_WFI
+#define STM32_WFI() do { } while ((SCB->ICSR & (SCB_ICSR_ISRPENDING_Msk | SCB_ICSR_PENDSTSET_Msk)) == 0)
+#endif
+
+#if defined(STM32G0) && defined(DAC1)
+#define LPTIM_TICK_IRQ          TIM6_DAC_LPTIM1_IRQn
+#else
+#define LPTIM_TICK_IRQ          LPTIM1_IRQn
+#endif
+
+/* Newer LPTIM (U5) has capture/compare channels instead of CMP. */
+#if defined(LPTIM_CCR1_CCR1)
+#define LPTIM_TICK_CMP          CCR1
+#define LPTIM_TICK_IER          DIER
+#define LPTIM_TICK_IE_CMPM      LPTIM_DIER_CC1IE
+#define LPTIM_TICK_ISR_CMPM     LPTIM_ISR_CC1IF
+#define LPTIM_TICK_ICR_CMPM     LPTIM_ICR_CC1CF
+#define LPTIM_TICK_ISR_CMPOK    LPTIM_ISR_CMP1OK
+#define LPTIM_TICK_ICR_CMPOK    LPTIM_ICR_CMP1OKCF
+#else
+#define LPTIM_TICK_CMP          CMP
+#define LPTIM_TICK_IER          IER
+#define LPTIM_TICK_IE_CMPM      LPTIM_IER_CMPMIE
+#define LPTIM_TICK_ISR_CMPM     LPTIM_ISR_CMPM
+#define LPTIM_TICK_ICR_CMPM     LPTIM_ICR_CMPMCF
+#define LPTIM_TICK_ISR_CMPOK    LPTIM_ISR_CMPOK
+#define LPTIM_TICK_ICR_CMPOK    LPTIM_ICR_CMPOKCF
+#endif
+
+#define LPTIM_TICK_FREQ         32768
+#define LPTIM_TICK_FREQ_BITS    15
+/* Compare values are kept well inside the 16-bit range to detect misses. */
+#define LPTIM_TICK_MAX_COUNTS   0x8000
+/* The compare register takes a few counts to synchronize. */
+#define LPTIM_TICK_MIN_COUNTS   4
+
+struct hal_os_tick {
+    uint32_t ticks_per_sec;
+    /* Counter value when ticks were last accounted for. */
+    uint16_t last_cnt;
+    /* Counts since the last whole tick, in 1 / (32768 * ticks_per_sec) s. */
+    uint32_t rem;
+    /* A compare register write is in flight. */
+    uint8_t cmp_busy;
+};
+
+static struct hal_os_tick g_hal_os_tick;
+
+static uint16_t
+lptim_tick_cnt(void)
+{
+    uint16_t cnt;
+
+    /* The counter is asynchronous; two equal reads make a valid value. */
+    do {
+        cnt = LPTIM1->CNT;
+    } while (cnt != (uint16_t)LPTIM1->CNT);
+
+    return cnt;
+}
+
+static void
+lptim_tick_update(void)
+{
+    uint16_t cnt;
+    uint32_t ticks;
+
+    cnt = lptim_tick_cnt();
+    g_hal_os_tick.rem += (uint16_t)(cnt - g_hal_os_tick.last_cnt) *
+                         g_hal_os_tick.ticks_per_sec;
+    g_hal_os_tick.last_cnt = cnt;
+
+    ticks = g_hal_os_tick.rem >> LPTIM_TICK_FREQ_BITS;
+    g_hal_os_tick.rem &= LPTIM_TICK_FREQ - 1;
+    if (ticks) {
+        os_time_advance(ticks);
+    }
+}
+
+/*
+ * Arms the compare to fire on the boundary of the given tick, counted from
+ * the last accounted tick.  Must follow lptim_tick_update().
+ */
+static void
+lptim_tick_set_cmp(os_time_t ticks)
+{
+    uint32_t counts;
+    uint16_t cmp;
+
+    if (ticks > LPTIM_TICK_MAX_COUNTS) {
+        ticks = LPTIM_TICK_MAX_COUNTS;
+    }
+    counts = (ticks * LPTIM_TICK_FREQ - g_hal_os_tick.rem +
+              g_hal_os_tick.ticks_per_sec - 1) / g_hal_os_tick.ticks_per_sec;
+    if (counts > LPTIM_TICK_MAX_COUNTS) {
+        counts = LPTIM_TICK_MAX_COUNTS;
+    } else if (counts < LPTIM_TICK_MIN_COUNTS) {
+        counts = LPTIM_TICK_MIN_COUNTS;
+    }
+    cmp = g_hal_os_tick.last_cnt + counts;
+    if (cmp == 0xFFFF) {
+        /* CMP must stay below ARR; waking one count early is harmless. */
+        cmp--;
+    }
+
+    /* Only one compare write may be in flight. */
+    if (g_hal_os_tick.cmp_busy) {
+        while (!(LPTIM1->ISR & LPTIM_TICK_ISR_CMPOK)) {
+        }
+    }
+    LPTIM1->ICR = LPTIM_TICK_ICR_CMPOK;
+    LPTIM1->LPTIM_TICK_CMP = cmp;
+    g_hal_os_tick.cmp_busy = 1;
+
+    /* If the counter got there first, do not wait for it to wrap. */
+    if ((uint16_t)(lptim_tick_cnt() - g_hal_os_tick.last_cnt) + 1 >= counts) {
+        NVIC_SetPendingIRQ(LPTIM_TICK_IRQ);
+    }
+}
+
+void
+os_tick_idle(os_time_t ticks)
+{
+    OS_ASSERT_CRITICAL();
+
+    if (ticks > 0) {
+        lptim_tick_update();
+        lptim_tick_set_cmp(ticks);
+    }
+
+    __DSB();
+    STM32_WFI();
+
+    if (ticks > 0) {
+        lptim_tick_update();
+        lptim_tick_set_cmp(1);
+    }
+}
+
+static void
+lptim_tick_irq_handler(void)
+{
+    os_sr_t sr;
+
+    os_trace_isr_enter();
+
+    OS_ENTER_CRITICAL(sr);
+    LPTIM1->ICR = LPTIM_TICK_ICR_CMPM;
+    lptim_tick_update();
+    lptim_tick_set_cmp(1);
+    OS_EXIT_CRITICAL(sr);
+
+    os_trace_isr_exit();
+}
+
+void
+os_tick_init(uint32_t os_ticks_per_sec, int prio)
+{
+    os_sr_t sr;
+
+    RCC_PeriphCLKInitTypeDef clock_init = {
+        .PeriphClockSelection = RCC_PERIPHCLK_LPTIM1,
+        .Lptim1ClockSelection = RCC_LPTIM1CLKSOURCE_LSE,
+    };
+    HAL_RCCEx_PeriphCLKConfig(&clock_init);
+
+    __HAL_RCC_LPTIM1_CLK_ENABLE();
+#ifdef __HAL_RCC_LPTIM1_CLKAM_ENABLE
+    __HAL_RCC_LPTIM1_CLKAM_ENABLE();
+#endif
+
+    NVIC_SetPriority(LPTIM_TICK_IRQ, prio);
+    NVIC_SetVector(LPTIM_TICK_IRQ, (uint32_t)lptim_tick_irq_handler);
+
+#if MYNEWT_VAL(MCU_STM32G0)
+    __DBGMCU_CLK_ENABLE();
+    DBG->CR |= (DBG_CR_DBG_STOP | DBG_CR_DBG_STANDBY);
+#elif MYNEWT_VAL(MCU_STM32U5)
+    DBGMCU->CR |= (DBGMCU_CR_DBG_STOP | DBGMCU_CR_DBG_STANDBY);
+#else
+    DBGMCU->CR |= (DBGMCU_CR_DBG_SLEEP | DBGMCU_CR_DBG_STOP | DBGMCU_CR_DBG_STANDBY);
+#endif
+
+    OS_ENTER_CRITICAL(sr);
+
+    g_hal_os_tick.ticks_per_sec = os_ticks_per_sec;
+    g_hal_os_tick.rem = 0;
+    g_hal_os_tick.cmp_busy = 0;
+
+    /* Internal clock, no prescaler; configuration only while disabled. */
+    LPTIM1->CR = 0;
+    LPTIM1->CFGR = 0;
+    LPTIM1->LPTIM_TICK_IER = LPTIM_TICK_IE_CMPM;
+    LPTIM1->CR = LPTIM_CR_ENABLE;
+
+    LPTIM1->ARR = 0xFFFF;
+    while (!(LPTIM1->ISR & LPTIM_ISR_ARROK)) {
+    }
+    LPTIM1->ICR = LPTIM_ICR_ARROKCF;
+
+    LPTIM1->CR |= LPTIM_CR_CNTSTRT;
+    g_hal_os_tick.last_cnt = lptim_tick_cnt();
+    lptim_tick_set_cmp(1);
+
+    OS_EXIT_CRITICAL(sr);
+
+    NVIC_EnableIRQ(LPTIM_TICK_IRQ);
+}
+
+#endif
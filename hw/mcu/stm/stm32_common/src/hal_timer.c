@@ -79,7 +79,7 @@ static uint32_t hal_timer_cnt(struct stm32_hal_tmr *tmr);
 /*
  * Call expired timer callbacks, and reprogram timer with new expiry time.
  */
-static void
+OS_HOT_CODE static void
 stm32_tmr_cbs(struct stm32_hal_tmr *tmr)
 {
     uint32_t cnt;
@@ -113,7 +113,7 @@ stm32_tmr_cbs(struct stm32_hal_tmr *tmr)
  *
  * @param tmr
  */
-static void
+OS_HOT_CODE static void
 stm32_tmr_irq(struct stm32_hal_tmr *tmr)
 {
     uint32_t sr;
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include "os/mynewt.h"
 #include "hal/hal_uart.h"
 #include "hal/hal_gpio.h"
 #include "mcu/cmsis_nvic.h"
@@ -36,6 +37,20 @@ struct hal_uart {
     hal_uart_tx_done u_tx_done;
     void *u_func_arg;
     const struct stm32_uart_cfg *u_cfg;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    /*
+     * Block mode: received bytes are collected in halves of RX buffer and
+     * reported when a half fills up or on IDLE line; TX is fed from
+     * buffer directly.
+     */
+    uint8_t u_block:1;
+    uint8_t u_rx_half;
+    uint16_t u_rx_pos;
+    uint16_t u_rx_off;
+    uint16_t u_tx_len;
+    const uint8_t *u_tx_ptr;
+    struct hal_uart_block_cfg u_blk;
+#endif
 };
 static struct hal_uart uarts[UART_CNT];
 static struct hal_uart *
@@ -147,6 +162,7 @@ static struct hal_uart_irq uart_irqs[3];
 #  define TXE           USART_ISR_TXE
 #endif
 #  define TC            USART_ISR_TC
+#  define IDLE          USART_ISR_IDLE
 #  define RXDR(x)       ((x)->RDR)
 #  define TXDR(x)       ((x)->TDR)
 #if MYNEWT_VAL(MCU_STM32WB) || MYNEWT_VAL(MCU_STM32H7) || MYNEWT_VAL(MCU_STM32U5) || MYNEWT_VAL(MCU_STM32G4) || \
@@ -160,6 +176,7 @@ static struct hal_uart_irq uart_irqs[3];
 #  define RXNE          USART_SR_RXNE
 #  define TXE           USART_SR_TXE
 #  define TC            USART_SR_TC
+#  define IDLE          USART_SR_IDLE
 #  define RXDR(x)       ((x)->DR)
 #  define TXDR(x)       ((x)->DR)
 #  define BAUD(x,y)     UART_BRR_SAMPLING16((x), (y))
@@ -179,10 +196,116 @@ hal_uart_init_cbs(int port, hal_uart_tx_char tx_func, hal_uart_tx_done tx_done,
     u->u_tx_func = tx_func;
     u->u_tx_done = tx_done;
     u->u_func_arg = arg;
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    u->u_block = 0;
+#endif
+    return 0;
+}
+
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+int
+hal_uart_init_block(int port, const struct hal_uart_block_cfg *cfg)
+{
+    struct hal_uart *u;
+
+    u = uart_by_port(port);
+    if (!u || u->u_open || !cfg->ub_rx_func || cfg->ub_rx_buf_size < 2 ||
+        (cfg->ub_rx_buf_size & 1)) {
+        return -1;
+    }
+    u->u_blk = *cfg;
+    u->u_block = 1;
+
     return 0;
 }
 
+int
+hal_uart_tx_block(int port, const void *data, uint16_t len)
+{
+    struct hal_uart *u;
+    int sr;
+
+    u = uart_by_port(port);
+    if (!u || !u->u_open || !u->u_block) {
+        return SYS_EINVAL;
+    }
+
+    __HAL_DISABLE_INTERRUPTS(sr);
+    if (u->u_tx_len || u->u_tx_end) {
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return SYS_EBUSY;
+    }
+    u->u_tx_ptr = data;
+    u->u_tx_len = len;
+    u->u_regs->CR1 |= USART_CR1_TXEIE;
+    __HAL_ENABLE_INTERRUPTS(sr);
+
+    return len;
+}
+
+/*
+ * Report bytes of current RX half received so far.
+ */
 static void
+uart_block_rx_report(struct hal_uart *u)
+{
+    const struct hal_uart_block_cfg *blk = &u->u_blk;
+    uint16_t half = blk->ub_rx_buf_size / 2;
+
+    if (u->u_rx_pos > u->u_rx_off) {
+        blk->ub_rx_func(blk->ub_arg,
+                        blk->ub_rx_buf + u->u_rx_half * half + u->u_rx_off,
+                        u->u_rx_pos - u->u_rx_off);
+        u->u_rx_off = u->u_rx_pos;
+    }
+}
+
+OS_HOT_CODE static void
+uart_block_irq(struct hal_uart *u, USART_TypeDef *regs, uint32_t isr)
+{
+    const struct hal_uart_block_cfg *blk = &u->u_blk;
+    uint16_t half = blk->ub_rx_buf_size / 2;
+
+    while (isr & RXNE) {
+        blk->ub_rx_buf[u->u_rx_half * half + u->u_rx_pos++] = RXDR(regs);
+        if (u->u_rx_pos == half) {
+            uart_block_rx_report(u);
+            u->u_rx_half ^= 1;
+            u->u_rx_pos = 0;
+            u->u_rx_off = 0;
+        }
+        isr = STATUS(regs);
+    }
+    if (isr & IDLE) {
+#if !MYNEWT_VAL(STM32_HAL_UART_HAS_SR)
+        regs->ICR = USART_ICR_IDLECF;
+#else
+        /* SR read followed by DR read clears IDLE */
+        (void)RXDR(regs);
+#endif
+        uart_block_rx_report(u);
+    }
+    if ((isr & TXE) && (regs->CR1 & USART_CR1_TXEIE)) {
+        if (u->u_tx_len) {
+            TXDR(regs) = *u->u_tx_ptr++;
+            u->u_tx_len--;
+        }
+        if (u->u_tx_len == 0) {
+            regs->CR1 = (regs->CR1 & ~USART_CR1_TXEIE) | USART_CR1_TCIE;
+            u->u_tx_end = 1;
+        }
+    }
+    if (u->u_tx_end && (isr & TC) && (regs->CR1 & USART_CR1_TCIE)) {
+        regs->CR1 &= ~USART_CR1_TCIE;
+        u->u_tx_end = 0;
+        if (blk->ub_tx_done) {
+            blk->ub_tx_done(blk->ub_arg);
+        }
+    }
+}
+#endif
+
+OS_HOT_CODE static void
 uart_irq_handler(int num)
 {
     struct hal_uart_irq *ui;
@@ -199,6 +322,12 @@ uart_irq_handler(int num)
     regs = u->u_regs;
 
     isr = STATUS(regs);
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    if (u->u_block) {
+        uart_block_irq(u, regs, isr);
+        isr &= ~(RXNE | TXE | TC);
+    }
+#endif
     if (isr & RXNE) {
         data = RXDR(regs);
         rc = u->u_rx_func(u->u_func_arg, data);
@@ -577,6 +706,16 @@ hal_uart_config(int port, int32_t baudrate, uint8_t databits, uint8_t stopbits,
     (void)STATUS(u->u_regs);
     hal_uart_set_nvic(cfg->suc_irqn, u);
 
+#if MYNEWT_VAL(HAL_UART_BLOCK)
+    if (u->u_block) {
+        u->u_rx_half = 0;
+        u->u_rx_pos = 0;
+        u->u_rx_off = 0;
+        u->u_tx_len = 0;
+        u->u_tx_end = 0;
+        u->u_regs->CR1 |= USART_CR1_IDLEIE;
+    }
+#endif
     u->u_regs->CR1 |= (USART_CR1_RXNEIE | USART_CR1_UE);
     u->u_open = 1;
 
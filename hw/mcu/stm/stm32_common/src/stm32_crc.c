@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CRC32_HW)
+
+#include "mcu/stm32_hal.h"
+#include "crc/crc32.h"
+
+#if !defined(CRC_CR_REV_IN) || !defined(CRC_CR_REV_OUT)
+#error "CRC32_HW needs a CRC unit with input / output bit reversal"
+#endif
+
+/* Bytes fed per critical section, bounding the interrupt latency added. */
+#define STM32_CRC_CHUNK     256
+
+static uint8_t stm32_crc_ready;
+
+/*
+ * The unit works on the unreflected register, so the running value is bit
+ * reversed going in.  Word mode input reversal feeds the bytes of a little
+ * endian word in memory order; output reversal hands back the reflected
+ * register CRC-32 uses.
+ */
+uint32_t
+crc32_hw_calc(uint32_t val, const void *buf, size_t cnt)
+{
+    const uint8_t *b = buf;
+    os_sr_t sr;
+    uint32_t crc;
+    uint32_t w;
+    size_t chunk;
+
+    crc = ~val;
+    while (cnt > 0) {
+        chunk = min(cnt, STM32_CRC_CHUNK);
+        cnt -= chunk;
+
+        OS_ENTER_CRITICAL(sr);
+        if (!stm32_crc_ready) {
+            /* Resets to the CRC-32 polynomial, 32 bit wide. */
+            __HAL_RCC_CRC_CLK_ENABLE();
+            stm32_crc_ready = 1;
+        }
+        CRC->CR = CRC_CR_REV_IN | CRC_CR_REV_OUT;
+        CRC->INIT = __RBIT(crc);
+        CRC->CR |= CRC_CR_RESET;
+
+        for (; chunk >= 4; chunk -= 4, b += 4) {
+            memcpy(&w, b, sizeof(w));
+            CRC->DR = w;
+        }
+        for (; chunk > 0; chunk--) {
+            *(volatile uint8_t *)&CRC->DR = *b++;
+        }
+        crc = CRC->DR;
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    return ~crc;
+}
+
+#endif
@@ -17,5 +17,15 @@
  * under the License.
  */
 
+/* Fragment that goes to MEMORY section */
+#ifndef SECTIONS_REGIONS
+
     ITCM (rwx)       : ORIGIN = 0x00000000,   LENGTH = 64K
     DTCM (rw!x)      : ORIGIN = 0x20000000,   LENGTH = 128K
+
+#else
+/* Fragment that goes into SECTIONS */
+    _itcmram_start = ORIGIN(ITCM);
+    _dtcmram_start = ORIGIN(DTCM);
+
+#endif
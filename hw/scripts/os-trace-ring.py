@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Decodes a dump of g_os_trace_ring (kernel/os, OS_TRACE_RING), e.g. taken
+# with gdb:
+#
+#   (gdb) dump binary value trace.bin g_os_trace_ring
+#   $ os-trace-ring.py trace.bin
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x4252544f
+HDR = struct.Struct("<IHHIIB3x")
+REC = struct.Struct("<IHBBI")
+
+F_CONT = 0x01
+F_RET = 0x02
+
+NAMES = {
+    2: "isr_enter",
+    3: "isr_exit",
+    4: "task_start_exec",
+    5: "task_stop_exec",
+    6: "task_start_ready",
+    7: "task_stop_ready",
+    8: "task_create",
+    15: "user_start",
+    16: "user_stop",
+    17: "idle",
+    40: "eventq_put",
+    41: "eventq_get_no_wait",
+    42: "eventq_get",
+    43: "eventq_remove",
+    44: "eventq_poll_0timo",
+    45: "eventq_poll",
+    46: "eventq_get_batch",
+    50: "mutex_init",
+    51: "mutex_release",
+    52: "mutex_pend",
+    60: "sem_init",
+    61: "sem_release",
+    62: "sem_pend",
+    70: "callout_init",
+    71: "callout_stop",
+    72: "callout_reset",
+    73: "callout_tick",
+    80: "memblock_get",
+    81: "memblock_put_from_cb",
+    82: "memblock_put",
+    90: "mbuf_get",
+    91: "mbuf_get_pkthdr",
+    92: "mbuf_free",
+    93: "mbuf_free_chain",
+}
+
+
+def records(data):
+    magic, rec_size, rec_cnt, freq, head, frozen = HDR.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("bad magic 0x%08x; not a trace ring dump" % magic)
+    if rec_size != REC.size:
+        sys.exit("unsupported record size %d" % rec_size)
+
+    first = max(head - rec_cnt, 0)
+    for seq in range(first, head):
+        off = HDR.size + (seq % rec_cnt) * rec_size
+        yield freq, REC.unpack_from(data, off)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an os_trace_ring dump")
+    parser.add_argument("dump", help="binary dump of g_os_trace_ring")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    start = None
+    line = None
+    for freq, (ts, rid, flags, taskid, arg) in records(data):
+        if flags & F_CONT and line is not None:
+            line += " 0x%08x" % arg
+            continue
+        if line is not None:
+            print(line)
+
+        if start is None:
+            start = ts
+        usecs = ((ts - start) & 0xffffffff) * 1000000 // freq
+        name = NAMES.get(rid, "id%d" % rid)
+        if flags & F_RET:
+            name += " ret"
+        task = "-" if taskid == 0xff else str(taskid)
+        line = "%12d us  task %3s  %-22s 0x%08x" % (usecs, task, name, arg)
+
+    if line is not None:
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_FUSION_H__
+#define __SENSOR_FUSION_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/quat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Madgwick orientation filter state.
+ *
+ * Gyroscope rate is integrated and the result is corrected towards the
+ * gravity (and optionally magnetic field) direction with gain beta.
+ */
+struct sensor_fusion_filter {
+    /* Orientation quaternion w, x, y, z */
+    float sff_q[4];
+    /* Correction gain, rad/s */
+    float sff_beta;
+};
+
+/**
+ * Reset filter to identity orientation.
+ *
+ * @param f     Filter
+ * @param beta  Correction gain
+ */
+void sensor_fusion_filter_init(struct sensor_fusion_filter *f, float beta);
+
+/**
+ * Run one filter step.
+ *
+ * @param f     Filter
+ * @param gyro  Angular rate x, y, z in degrees per second
+ * @param accel Acceleration x, y, z in any unit, NULL if not available
+ * @param mag   Magnetic field x, y, z in any unit, NULL if not available;
+ *              used only together with accel
+ * @param dt    Time since previous step in seconds
+ */
+void sensor_fusion_filter_update(struct sensor_fusion_filter *f,
+                                 const float *gyro, const float *accel,
+                                 const float *mag, float dt);
+
+struct sensor_fusion_cfg {
+    /* Correction gain, 0 selects MYNEWT_VAL(SENSOR_FUSION_BETA) */
+    float sfc_beta;
+    /* Publish every n-th gyroscope sample, 0 and 1 publish every sample */
+    uint16_t sfc_out_div;
+};
+
+/**
+ * Virtual sensor providing SENSOR_TYPE_ROTATION_VECTOR computed from
+ * accelerometer, gyroscope and optionally magnetometer sensors.
+ */
+struct sensor_fusion {
+    struct os_dev sf_dev;
+    struct sensor sf_sensor;
+    struct sensor_fusion_cfg sf_cfg;
+    struct sensor_fusion_filter sf_filter;
+
+    /* Listeners registered on source sensors */
+    struct sensor_listener sf_accel_lsnr;
+    struct sensor_listener sf_gyro_lsnr;
+    struct sensor_listener sf_mag_lsnr;
+    struct sensor *sf_accel_src;
+    struct sensor *sf_gyro_src;
+    struct sensor *sf_mag_src;
+
+    /* Latest samples and their cputime, held until next gyro sample */
+    float sf_accel[3];
+    float sf_mag[3];
+    uint32_t sf_accel_ts;
+    uint32_t sf_mag_ts;
+    uint32_t sf_gyro_ts;
+    uint8_t sf_have_accel:1;
+    uint8_t sf_have_mag:1;
+    uint8_t sf_have_gyro:1;
+    uint16_t sf_out_cnt;
+
+    /* Last published orientation */
+    struct sensor_quat_data sf_out;
+};
+
+/**
+ * Expects to be called back through os_dev_create().
+ *
+ * @param dev  The device object of struct sensor_fusion
+ * @param arg  Optional struct sensor_fusion_cfg
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_fusion_init(struct os_dev *dev, void *arg);
+
+/**
+ * Configure fusion sensor.
+ *
+ * @param sf   Fusion sensor
+ * @param cfg  Configuration
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_fusion_config(struct sensor_fusion *sf,
+                         const struct sensor_fusion_cfg *cfg);
+
+/**
+ * Subscribe to source sensors and start fusing their data. Accelerometer
+ * and gyroscope may be the same sensor. Sources are polled as usual, e.g.
+ * with sensor_set_poll_rate_ms(); orientation is published to listeners
+ * of the fusion sensor as samples arrive.
+ *
+ * @param sf     Fusion sensor
+ * @param accel  Accelerometer sensor
+ * @param gyro   Gyroscope sensor
+ * @param mag    Magnetometer sensor, NULL for 6-axis fusion
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_fusion_attach(struct sensor_fusion *sf, struct sensor *accel,
+                         struct sensor *gyro, struct sensor *mag);
+
+/**
+ * Unsubscribe from source sensors.
+ *
+ * @param sf     Fusion sensor
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_fusion_detach(struct sensor_fusion *sf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_FUSION_H__ */
@@ -0,0 +1,35 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SENSOR_FUSION_TEST_
+#define H_SENSOR_FUSION_TEST_
+
+#include <math.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "sensor_fusion/sensor_fusion.h"
+
+#define SENSOR_FUSION_TEST_CLOSE(a, b, eps)  (fabsf((a) - (b)) < (eps))
+
+TEST_SUITE_DECL(sensor_fusion_test_suite);
+TEST_CASE_DECL(sensor_fusion_test_case_level);
+TEST_CASE_DECL(sensor_fusion_test_case_tilt);
+TEST_CASE_DECL(sensor_fusion_test_case_yaw);
+
+#endif
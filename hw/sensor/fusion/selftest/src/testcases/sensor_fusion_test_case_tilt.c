@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sensor_fusion_test.h"
+
+/* Gravity along +y converges to 90 degree roll about x */
+TEST_CASE_SELF(sensor_fusion_test_case_tilt)
+{
+    struct sensor_fusion_filter f;
+    const float gyro[3] = { 0.0f, 0.0f, 0.0f };
+    const float accel[3] = { 0.0f, 9.81f, 0.0f };
+    float roll;
+    float *q;
+    int i;
+
+    sensor_fusion_filter_init(&f, 0.5f);
+    q = f.sff_q;
+
+    for (i = 0; i < 2000; i++) {
+        sensor_fusion_filter_update(&f, gyro, accel, NULL, 0.01f);
+    }
+
+    roll = atan2f(2.0f * (q[0] * q[1] + q[2] * q[3]),
+                  1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
+
+    TEST_ASSERT(SENSOR_FUSION_TEST_CLOSE(fabsf(roll), 3.14159265f / 2,
+                                         0.02f));
+}
@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sensor_fusion_test.h"
+
+/*
+ * Rotation about z is not observable from gravity; it must come from
+ * integrating gyroscope rate. 90 deg/s for one second gives 90 degrees.
+ */
+TEST_CASE_SELF(sensor_fusion_test_case_yaw)
+{
+    struct sensor_fusion_filter f;
+    const float gyro[3] = { 0.0f, 0.0f, 90.0f };
+    const float accel[3] = { 0.0f, 0.0f, 9.81f };
+    float yaw;
+    float *q;
+    int i;
+
+    sensor_fusion_filter_init(&f, 0.1f);
+    q = f.sff_q;
+
+    for (i = 0; i < 100; i++) {
+        sensor_fusion_filter_update(&f, gyro, accel, NULL, 0.01f);
+    }
+
+    yaw = atan2f(2.0f * (q[0] * q[3] + q[1] * q[2]),
+                 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]));
+
+    TEST_ASSERT(SENSOR_FUSION_TEST_CLOSE(yaw, 3.14159265f / 2, 0.01f));
+}
@@ -0,0 +1,517 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/gyro.h"
+#include "sensor/mag.h"
+#include "sensor/quat.h"
+#include "sensor_fusion/sensor_fusion.h"
+
+#define SENSOR_FUSION_DEG_TO_RAD    (3.14159265f / 180.0f)
+
+static int sensor_fusion_sensor_read(struct sensor *, sensor_type_t,
+                                     sensor_data_func_t, void *, uint32_t);
+static int sensor_fusion_sensor_get_config(struct sensor *, sensor_type_t,
+                                           struct sensor_cfg *);
+
+static const struct sensor_driver g_sensor_fusion_driver = {
+    .sd_read = sensor_fusion_sensor_read,
+    .sd_get_config = sensor_fusion_sensor_get_config,
+};
+
+static float
+sensor_fusion_inv_norm(float a, float b, float c, float d)
+{
+    float n;
+
+    n = a * a + b * b + c * c + d * d;
+    if (n == 0.0f) {
+        return 0.0f;
+    }
+
+    return 1.0f / sqrtf(n);
+}
+
+void
+sensor_fusion_filter_init(struct sensor_fusion_filter *f, float beta)
+{
+    f->sff_q[0] = 1.0f;
+    f->sff_q[1] = 0.0f;
+    f->sff_q[2] = 0.0f;
+    f->sff_q[3] = 0.0f;
+    f->sff_beta = beta;
+}
+
+/*
+ * Gradient descent step of Madgwick filter, gravity only (6-axis).
+ * Returns corrective step in s, not normalized.
+ */
+static void
+sensor_fusion_grad_imu(const float *q, float ax, float ay, float az, float *s)
+{
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float q0q0 = q0 * q0;
+    float q1q1 = q1 * q1;
+    float q2q2 = q2 * q2;
+    float q3q3 = q3 * q3;
+
+    s[0] = 4.0f * q0 * q2q2 + 2.0f * q2 * ax +
+           4.0f * q0 * q1q1 - 2.0f * q1 * ay;
+    s[1] = 4.0f * q1 * q3q3 - 2.0f * q3 * ax + 4.0f * q0q0 * q1 -
+           2.0f * q0 * ay - 4.0f * q1 + 8.0f * q1 * q1q1 +
+           8.0f * q1 * q2q2 + 4.0f * q1 * az;
+    s[2] = 4.0f * q0q0 * q2 + 2.0f * q0 * ax + 4.0f * q2 * q3q3 -
+           2.0f * q3 * ay - 4.0f * q2 + 8.0f * q2 * q1q1 +
+           8.0f * q2 * q2q2 + 4.0f * q2 * az;
+    s[3] = 4.0f * q1q1 * q3 - 2.0f * q1 * ax +
+           4.0f * q2q2 * q3 - 2.0f * q2 * ay;
+}
+
+/*
+ * Gradient descent step of Madgwick filter, gravity and magnetic field
+ * (9-axis). Returns corrective step in s, not normalized.
+ */
+static void
+sensor_fusion_grad_marg(const float *q, float ax, float ay, float az,
+                        float mx, float my, float mz, float *s)
+{
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    float q2q2 = q2 * q2, q2q3 = q2 * q3;
+    float q3q3 = q3 * q3;
+    float hx, hy, bx2, bz2, bx4, bz4;
+    float fg1, fg2, fg3;
+    float fb1, fb2, fb3;
+
+    /* Reference direction of Earth's magnetic field */
+    hx = mx * q0q0 - 2.0f * q0 * my * q3 + 2.0f * q0 * mz * q2 +
+         mx * q1q1 + 2.0f * q1 * my * q2 + 2.0f * q1 * mz * q3 -
+         mx * q2q2 - mx * q3q3;
+    hy = 2.0f * q0 * mx * q3 + my * q0q0 - 2.0f * q0 * mz * q1 +
+         2.0f * q1 * mx * q2 - my * q1q1 + my * q2q2 +
+         2.0f * q2 * mz * q3 - my * q3q3;
+    bx2 = sqrtf(hx * hx + hy * hy);
+    bz2 = -2.0f * q0 * mx * q2 + 2.0f * q0 * my * q1 + mz * q0q0 +
+          2.0f * q1 * mx * q3 - mz * q1q1 + 2.0f * q2 * my * q3 -
+          mz * q2q2 + mz * q3q3;
+    bx4 = 2.0f * bx2;
+    bz4 = 2.0f * bz2;
+
+    /* Objective function errors */
+    fg1 = 2.0f * q1q3 - 2.0f * q0q2 - ax;
+    fg2 = 2.0f * q0q1 + 2.0f * q2q3 - ay;
+    fg3 = 1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az;
+    fb1 = bx2 * (0.5f - q2q2 - q3q3) + bz2 * (q1q3 - q0q2) - mx;
+    fb2 = bx2 * (q1q2 - q0q3) + bz2 * (q0q1 + q2q3) - my;
+    fb3 = bx2 * (q0q2 + q1q3) + bz2 * (0.5f - q1q1 - q2q2) - mz;
+
+    s[0] = -2.0f * q2 * fg1 + 2.0f * q1 * fg2 -
+           bz2 * q2 * fb1 + (-bx2 * q3 + bz2 * q1) * fb2 +
+           bx2 * q2 * fb3;
+    s[1] = 2.0f * q3 * fg1 + 2.0f * q0 * fg2 - 4.0f * q1 * fg3 +
+           bz2 * q3 * fb1 + (bx2 * q2 + bz2 * q0) * fb2 +
+           (bx2 * q3 - bz4 * q1) * fb3;
+    s[2] = -2.0f * q0 * fg1 + 2.0f * q3 * fg2 - 4.0f * q2 * fg3 +
+           (-bx4 * q2 - bz2 * q0) * fb1 + (bx2 * q1 + bz2 * q3) * fb2 +
+           (bx2 * q0 - bz4 * q2) * fb3;
+    s[3] = 2.0f * q1 * fg1 + 2.0f * q2 * fg2 +
+           (-bx4 * q3 + bz2 * q1) * fb1 + (-bx2 * q0 + bz2 * q2) * fb2 +
+           bx2 * q1 * fb3;
+}
+
+void
+sensor_fusion_filter_update(struct sensor_fusion_filter *f,
+                            const float *gyro, const float *accel,
+                            const float *mag, float dt)
+{
+    float *q = f->sff_q;
+    float gx, gy, gz;
+    float ax, ay, az;
+    float mx, my, mz;
+    float qd[4];
+    float s[4];
+    float n;
+    int i;
+
+    gx = gyro[0] * SENSOR_FUSION_DEG_TO_RAD;
+    gy = gyro[1] * SENSOR_FUSION_DEG_TO_RAD;
+    gz = gyro[2] * SENSOR_FUSION_DEG_TO_RAD;
+
+    /* Rate of change of quaternion from gyroscope */
+    qd[0] = 0.5f * (-q[1] * gx - q[2] * gy - q[3] * gz);
+    qd[1] = 0.5f * (q[0] * gx + q[2] * gz - q[3] * gy);
+    qd[2] = 0.5f * (q[0] * gy - q[1] * gz + q[3] * gx);
+    qd[3] = 0.5f * (q[0] * gz + q[1] * gy - q[2] * gx);
+
+    n = 0.0f;
+    if (accel) {
+        n = sensor_fusion_inv_norm(accel[0], accel[1], accel[2], 0.0f);
+    }
+
+    /* Correct only if accelerometer is valid (avoids NaN on free fall) */
+    if (n != 0.0f) {
+        ax = accel[0] * n;
+        ay = accel[1] * n;
+        az = accel[2] * n;
+
+        n = 0.0f;
+        if (mag) {
+            n = sensor_fusion_inv_norm(mag[0], mag[1], mag[2], 0.0f);
+        }
+
+        if (n != 0.0f) {
+            mx = mag[0] * n;
+            my = mag[1] * n;
+            mz = mag[2] * n;
+            sensor_fusion_grad_marg(q, ax, ay, az, mx, my, mz, s);
+        } else {
+            sensor_fusion_grad_imu(q, ax, ay, az, s);
+        }
+
+        n = sensor_fusion_inv_norm(s[0], s[1], s[2], s[3]);
+        for (i = 0; i < 4; i++) {
+            qd[i] -= f->sff_beta * s[i] * n;
+        }
+    }
+
+    for (i = 0; i < 4; i++) {
+        q[i] += qd[i] * dt;
+    }
+
+    n = sensor_fusion_inv_norm(q[0], q[1], q[2], q[3]);
+    for (i = 0; i < 4; i++) {
+        q[i] *= n;
+    }
+}
+
+static void
+sensor_fusion_publish(struct sensor_fusion *sf)
+{
+    struct sensor_quat_data *sqd = &sf->sf_out;
+
+    sqd->sqd_w = sf->sf_filter.sff_q[0];
+    sqd->sqd_x = sf->sf_filter.sff_q[1];
+    sqd->sqd_y = sf->sf_filter.sff_q[2];
+    sqd->sqd_z = sf->sf_filter.sff_q[3];
+    sqd->sqd_x_is_valid = 1;
+    sqd->sqd_y_is_valid = 1;
+    sqd->sqd_z_is_valid = 1;
+    sqd->sqd_w_is_valid = 1;
+}
+
+static int
+sensor_fusion_is_recent(uint32_t ts, uint32_t ref)
+{
+    int32_t d;
+
+    d = (int32_t)(ref - ts);
+    if (d < 0) {
+        d = -d;
+    }
+
+    return d <= os_cputime_usecs_to_ticks(
+            MYNEWT_VAL(SENSOR_FUSION_MAX_SKEW_MS) * 1000);
+}
+
+static int
+sensor_fusion_gyro(struct sensor_fusion *sf, uint32_t ts,
+                   const struct sensor_gyro_data *sgd)
+{
+    const float *accel;
+    const float *mag;
+    float gyro[3];
+    uint32_t usecs;
+
+    if (!sgd->sgd_x_is_valid || !sgd->sgd_y_is_valid ||
+        !sgd->sgd_z_is_valid) {
+        return 0;
+    }
+
+    if (!sf->sf_have_gyro) {
+        sf->sf_have_gyro = 1;
+        sf->sf_gyro_ts = ts;
+        return 0;
+    }
+
+    usecs = os_cputime_ticks_to_usecs(ts - sf->sf_gyro_ts);
+    sf->sf_gyro_ts = ts;
+
+    /* Samples sharing one timestamp (e.g. FIFO batch) carry no interval */
+    if (usecs == 0) {
+        return 0;
+    }
+    if (usecs > MYNEWT_VAL(SENSOR_FUSION_MAX_DT_MS) * 1000) {
+        return 0;
+    }
+
+    gyro[0] = sgd->sgd_x;
+    gyro[1] = sgd->sgd_y;
+    gyro[2] = sgd->sgd_z;
+
+    accel = NULL;
+    if (sf->sf_have_accel && sensor_fusion_is_recent(sf->sf_accel_ts, ts)) {
+        accel = sf->sf_accel;
+    }
+    mag = NULL;
+    if (sf->sf_have_mag && sensor_fusion_is_recent(sf->sf_mag_ts, ts)) {
+        mag = sf->sf_mag;
+    }
+
+    sensor_fusion_filter_update(&sf->sf_filter, gyro, accel, mag,
+                                usecs / 1000000.0f);
+
+    if (++sf->sf_out_cnt < sf->sf_cfg.sfc_out_div) {
+        return 0;
+    }
+    sf->sf_out_cnt = 0;
+
+    sensor_fusion_publish(sf);
+
+    return 1;
+}
+
+/*
+ * Listener for all source sensors. Samples are stamped with the source
+ * sensor timestamp, updated by the sensor framework right before data
+ * is reported.
+ */
+static int
+sensor_fusion_listener(struct sensor *sensor, void *arg, void *data,
+                       sensor_type_t type)
+{
+    struct sensor_fusion *sf = arg;
+    struct sensor_accel_data *sad;
+    struct sensor_mag_data *smd;
+    uint32_t ts;
+    int publish;
+
+    ts = sensor->s_sts.st_cputime;
+    publish = 0;
+
+    sensor_lock(&sf->sf_sensor);
+
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+        sad = data;
+        if (sad->sad_x_is_valid && sad->sad_y_is_valid &&
+            sad->sad_z_is_valid) {
+            sf->sf_accel[0] = sad->sad_x;
+            sf->sf_accel[1] = sad->sad_y;
+            sf->sf_accel[2] = sad->sad_z;
+            sf->sf_accel_ts = ts;
+            sf->sf_have_accel = 1;
+        }
+        break;
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        smd = data;
+        if (smd->smd_x_is_valid && smd->smd_y_is_valid &&
+            smd->smd_z_is_valid) {
+            sf->sf_mag[0] = smd->smd_x;
+            sf->sf_mag[1] = smd->smd_y;
+            sf->sf_mag[2] = smd->smd_z;
+            sf->sf_mag_ts = ts;
+            sf->sf_have_mag = 1;
+        }
+        break;
+    case SENSOR_TYPE_GYROSCOPE:
+        publish = sensor_fusion_gyro(sf, ts, data);
+        break;
+    default:
+        break;
+    }
+
+    sensor_unlock(&sf->sf_sensor);
+
+    if (publish) {
+        /* Reading the virtual sensor delivers orientation to its listeners */
+        sensor_read(&sf->sf_sensor, SENSOR_TYPE_ROTATION_VECTOR, NULL, NULL,
+                    OS_TIMEOUT_NEVER);
+    }
+
+    return 0;
+}
+
+static int
+sensor_fusion_sensor_read(struct sensor *sensor, sensor_type_t type,
+                          sensor_data_func_t data_func, void *data_arg,
+                          uint32_t timeout)
+{
+    struct sensor_fusion *sf;
+    struct sensor_quat_data sqd;
+
+    if (!(type & SENSOR_TYPE_ROTATION_VECTOR)) {
+        return SYS_EINVAL;
+    }
+
+    sf = (struct sensor_fusion *)SENSOR_GET_DEVICE(sensor);
+    sqd = sf->sf_out;
+
+    return data_func(sensor, data_arg, &sqd, SENSOR_TYPE_ROTATION_VECTOR);
+}
+
+static int
+sensor_fusion_sensor_get_config(struct sensor *sensor, sensor_type_t type,
+                                struct sensor_cfg *cfg)
+{
+    if (type != SENSOR_TYPE_ROTATION_VECTOR) {
+        return SYS_EINVAL;
+    }
+
+    cfg->sc_valtype = SENSOR_VALUE_TYPE_FLOAT_TRIPLET;
+
+    return 0;
+}
+
+int
+sensor_fusion_config(struct sensor_fusion *sf,
+                     const struct sensor_fusion_cfg *cfg)
+{
+    float beta;
+    int rc;
+
+    rc = sensor_lock(&sf->sf_sensor);
+    if (rc) {
+        return rc;
+    }
+
+    sf->sf_cfg = *cfg;
+
+    beta = cfg->sfc_beta;
+    if (beta == 0.0f) {
+        beta = MYNEWT_VAL(SENSOR_FUSION_BETA) / 1000.0f;
+    }
+    sf->sf_filter.sff_beta = beta;
+
+    sensor_unlock(&sf->sf_sensor);
+
+    return 0;
+}
+
+int
+sensor_fusion_init(struct os_dev *dev, void *arg)
+{
+    struct sensor_fusion_cfg dflt = { 0 };
+    struct sensor_fusion *sf;
+    struct sensor *sensor;
+    int rc;
+
+    sf = (struct sensor_fusion *)dev;
+    sensor = &sf->sf_sensor;
+
+    rc = sensor_init(sensor, dev);
+    if (rc) {
+        return rc;
+    }
+
+    sensor_fusion_filter_init(&sf->sf_filter, 0.0f);
+    sf->sf_out.sqd_w = 1.0f;
+
+    rc = sensor_set_driver(sensor, SENSOR_TYPE_ROTATION_VECTOR,
+                           (struct sensor_driver *)&g_sensor_fusion_driver);
+    if (rc) {
+        return rc;
+    }
+
+    rc = sensor_set_type_mask(sensor, SENSOR_TYPE_ROTATION_VECTOR);
+    if (rc) {
+        return rc;
+    }
+
+    rc = sensor_fusion_config(sf, arg ? arg : &dflt);
+    if (rc) {
+        return rc;
+    }
+
+    return sensor_mgr_register(sensor);
+}
+
+int
+sensor_fusion_attach(struct sensor_fusion *sf, struct sensor *accel,
+                     struct sensor *gyro, struct sensor *mag)
+{
+    int rc;
+
+    if (!accel || !gyro || sf->sf_gyro_src) {
+        return SYS_EINVAL;
+    }
+
+    sf->sf_have_accel = 0;
+    sf->sf_have_mag = 0;
+    sf->sf_have_gyro = 0;
+    sf->sf_out_cnt = 0;
+
+    sf->sf_accel_lsnr.sl_sensor_type = SENSOR_TYPE_ACCELEROMETER;
+    sf->sf_accel_lsnr.sl_func = sensor_fusion_listener;
+    sf->sf_accel_lsnr.sl_arg = sf;
+    rc = sensor_register_listener(accel, &sf->sf_accel_lsnr);
+    if (rc) {
+        return rc;
+    }
+    sf->sf_accel_src = accel;
+
+    sf->sf_gyro_lsnr.sl_sensor_type = SENSOR_TYPE_GYROSCOPE;
+    sf->sf_gyro_lsnr.sl_func = sensor_fusion_listener;
+    sf->sf_gyro_lsnr.sl_arg = sf;
+    rc = sensor_register_listener(gyro, &sf->sf_gyro_lsnr);
+    if (rc) {
+        goto err;
+    }
+    sf->sf_gyro_src = gyro;
+
+    if (mag) {
+        sf->sf_mag_lsnr.sl_sensor_type = SENSOR_TYPE_MAGNETIC_FIELD;
+        sf->sf_mag_lsnr.sl_func = sensor_fusion_listener;
+        sf->sf_mag_lsnr.sl_arg = sf;
+        rc = sensor_register_listener(mag, &sf->sf_mag_lsnr);
+        if (rc) {
+            goto err;
+        }
+        sf->sf_mag_src = mag;
+    }
+
+    return 0;
+err:
+    sensor_fusion_detach(sf);
+    return rc;
+}
+
+int
+sensor_fusion_detach(struct sensor_fusion *sf)
+{
+    if (sf->sf_accel_src) {
+        sensor_unregister_listener(sf->sf_accel_src, &sf->sf_accel_lsnr);
+        sf->sf_accel_src = NULL;
+    }
+    if (sf->sf_gyro_src) {
+        sensor_unregister_listener(sf->sf_gyro_src, &sf->sf_gyro_lsnr);
+        sf->sf_gyro_src = NULL;
+    }
+    if (sf->sf_mag_src) {
+        sensor_unregister_listener(sf->sf_mag_src, &sf->sf_mag_lsnr);
+        sf->sf_mag_src = NULL;
+    }
+
+    return 0;
+}
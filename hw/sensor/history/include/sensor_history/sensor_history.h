@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_HISTORY_H__
+#define __SENSOR_HISTORY_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stored value of an axis which was not valid in the sample */
+#define SENSOR_HISTORY_INVALID  INT16_MIN
+
+/* Maximum number of int16 values per stored sample */
+#define SENSOR_HISTORY_MAX_DIMS 3
+
+struct sensor_history_cfg {
+    /*
+     * Value of one LSB in units of the sensor type, 0 selects default for
+     * the type (e.g. 0.01 m/s^2 for accelerometer).
+     */
+    float shc_scale;
+    /* Value subtracted before scaling, e.g. to center pressure range */
+    float shc_offset;
+    /* Store every n-th sample, 0 and 1 store every sample */
+    uint16_t shc_decim;
+    /* Optional storage for cputime of each sample, one per sample */
+    uint32_t *shc_ts_buf;
+};
+
+/**
+ * Ring buffer of recent samples of one sensor type. Samples are stored as
+ * 1 (scalar types) or 3 (vector types) int16 values, oldest first.
+ */
+struct sensor_history {
+    struct sensor_listener sh_lsnr;
+    struct sensor *sh_sensor;
+    sensor_type_t sh_type;
+    struct sensor_history_cfg sh_cfg;
+
+    /* Caller provided storage, sh_cap * sh_dims values */
+    int16_t *sh_buf;
+    uint16_t sh_cap;
+    uint8_t sh_dims;
+
+    /* Index of next sample to write and number of stored samples */
+    uint16_t sh_head;
+    uint16_t sh_cnt;
+    uint16_t sh_decim_cnt;
+
+    /* cputime of newest stored sample */
+    uint32_t sh_last_ts;
+
+    /* Number of samples stored since init, wraps */
+    uint32_t sh_seq;
+};
+
+/**
+ * Contiguous view into history, valid until the next sample is stored.
+ * Samples are in shw_seg[0] followed by shw_seg[1], oldest first.
+ */
+struct sensor_history_window {
+    struct {
+        const int16_t *ptr;
+        uint16_t cnt;
+    } shw_seg[2];
+};
+
+/**
+ * Callback for sensor_history_walk(), called with each visited sample.
+ *
+ * @param arg    Argument passed to sensor_history_walk()
+ * @param sample sh_dims stored values
+ *
+ * @return 0 to continue, non-zero to stop walking.
+ */
+typedef int (*sensor_history_walk_func_t)(void *arg, const int16_t *sample);
+
+/**
+ * Number of int16 values needed for a history of given type and length.
+ */
+#define SENSOR_HISTORY_BUF_LEN(type, samples) \
+    ((samples) * sensor_history_dims(type))
+
+/**
+ * Get number of values stored per sample of sensor type.
+ *
+ * @param type  Sensor type
+ *
+ * @return 1 or 3 for supported types, 0 if type is not supported.
+ */
+uint8_t sensor_history_dims(sensor_type_t type);
+
+/**
+ * Initialize history.
+ *
+ * @param sh     History
+ * @param type   One sensor type to store
+ * @param buf    Storage for samples, SENSOR_HISTORY_BUF_LEN() values
+ * @param samples Number of samples buf holds
+ * @param cfg    Configuration, NULL for defaults
+ *
+ * @return 0 on success, SYS_EINVAL if type is not supported.
+ */
+int sensor_history_init(struct sensor_history *sh, sensor_type_t type,
+                        int16_t *buf, uint16_t samples,
+                        const struct sensor_history_cfg *cfg);
+
+/**
+ * Start storing samples read from sensor.
+ *
+ * @param sh     History
+ * @param sensor Sensor to listen to
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_history_attach(struct sensor_history *sh, struct sensor *sensor);
+
+/**
+ * Stop storing samples. Stored samples are kept.
+ *
+ * @param sh     History
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_history_detach(struct sensor_history *sh);
+
+/**
+ * Drop all stored samples.
+ *
+ * @param sh     History
+ */
+void sensor_history_clear(struct sensor_history *sh);
+
+/**
+ * Store one sample. Called by the listener registered with
+ * sensor_history_attach(); may also be used to feed samples directly.
+ *
+ * @param sh     History
+ * @param data   Sensor data of sh_type, e.g. struct sensor_accel_data
+ * @param ts     cputime of the sample
+ *
+ * @return 1 if sample was stored, 0 if it was dropped by decimation.
+ */
+int sensor_history_put(struct sensor_history *sh, const void *data,
+                       uint32_t ts);
+
+/**
+ * Get number of stored samples.
+ */
+static inline uint16_t
+sensor_history_count(const struct sensor_history *sh)
+{
+    return sh->sh_cnt;
+}
+
+/**
+ * Convert stored value back to units of the sensor type.
+ */
+static inline float
+sensor_history_to_float(const struct sensor_history *sh, int16_t val)
+{
+    return val * sh->sh_cfg.shc_scale + sh->sh_cfg.shc_offset;
+}
+
+/**
+ * Get one stored sample.
+ *
+ * @param sh     History
+ * @param age    0 for newest sample, 1 for the one before it, ...
+ * @param out    sh_dims values
+ *
+ * @return 0 on success, SYS_ENOENT if there is no such sample.
+ */
+int sensor_history_get(const struct sensor_history *sh, uint16_t age,
+                       int16_t *out);
+
+/**
+ * Get cputime of one stored sample.
+ *
+ * @param sh     History
+ * @param age    0 for newest sample, 1 for the one before it, ...
+ * @param ts     cputime of the sample
+ *
+ * @return 0 on success, SYS_ENOENT if there is no such sample,
+ *         SYS_ENOTSUP if history does not keep timestamps.
+ */
+int sensor_history_get_ts(const struct sensor_history *sh, uint16_t age,
+                          uint32_t *ts);
+
+/**
+ * Get zero-copy view of the newest samples.
+ *
+ * @param sh     History
+ * @param last   Number of newest samples, 0 for all
+ * @param win    Filled with up to two segments
+ *
+ * @return Number of samples in the window.
+ */
+uint16_t sensor_history_window(const struct sensor_history *sh,
+                               uint16_t last,
+                               struct sensor_history_window *win);
+
+/**
+ * Visit every step-th of the newest samples, oldest first. Newest sample
+ * is always visited, so decimated views of different length line up.
+ *
+ * @param sh     History
+ * @param last   Number of newest samples to walk over, 0 for all
+ * @param step   Decimation, 0 and 1 visit every sample
+ * @param func   Called with each visited sample
+ * @param arg    Argument for func
+ *
+ * @return Number of samples visited.
+ */
+uint16_t sensor_history_walk(const struct sensor_history *sh, uint16_t last,
+                             uint16_t step, sensor_history_walk_func_t func,
+                             void *arg);
+
+#if MYNEWT_VAL(SENSOR_HISTORY_OIC)
+struct oc_resource;
+
+/**
+ * Observable OIC resource serving samples of a history in batches.
+ *
+ * Payload is a CBOR map:
+ *  - "type":   sensor type
+ *  - "scale", "offset": convert "v" entries to sensor units
+ *  - "n":      number of samples
+ *  - "v":      n * dims stored values, oldest sample first
+ *  - "t0":     cputime of oldest sample in microseconds (with timestamps)
+ *  - "dt":     n - 1 microsecond deltas between samples (with timestamps)
+ */
+struct sensor_history_oic {
+    struct sensor_history *sho_sh;
+    struct oc_resource *sho_res;
+    struct os_callout sho_co;
+    uint32_t sho_interval_ms;
+    /* sh_seq of newest sample sent to observers */
+    uint32_t sho_sent_seq;
+    SLIST_ENTRY(sensor_history_oic) sho_next;
+};
+
+/**
+ * Create OIC resource for history. GET returns the newest stored samples;
+ * observers are notified every interval_ms with samples stored since the
+ * previous notification.
+ *
+ * @param sho         Resource state
+ * @param sh          History to serve
+ * @param uri         Resource URI, e.g. "/accel0/hist"
+ * @param interval_ms Batching interval
+ *
+ * @return 0 on success, non-zero error on failure.
+ */
+int sensor_history_oic_add(struct sensor_history_oic *sho,
+                           struct sensor_history *sh, const char *uri,
+                           uint32_t interval_ms);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_HISTORY_H__ */
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SENSOR_HISTORY_TEST_
+#define H_SENSOR_HISTORY_TEST_
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "sensor/accel.h"
+#include "sensor/pressure.h"
+#include "sensor_history/sensor_history.h"
+
+TEST_SUITE_DECL(sensor_history_test_suite);
+TEST_CASE_DECL(sensor_history_test_case_put_get);
+TEST_CASE_DECL(sensor_history_test_case_window);
+TEST_CASE_DECL(sensor_history_test_case_walk);
+
+/* Stores n pressure samples with values first, first + 1, ... */
+static inline void
+sensor_history_test_fill(struct sensor_history *sh, int first, int n)
+{
+    struct sensor_press_data spd = { .spd_press_is_valid = 1 };
+    int i;
+
+    for (i = 0; i < n; i++) {
+        spd.spd_press = first + i;
+        sensor_history_put(sh, &spd, i);
+    }
+}
+
+#endif
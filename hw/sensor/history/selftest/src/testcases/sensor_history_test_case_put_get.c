@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sensor_history_test.h"
+
+TEST_CASE_SELF(sensor_history_test_case_put_get)
+{
+    struct sensor_history sh;
+    struct sensor_history_cfg cfg = { 0 };
+    struct sensor_accel_data sad = { 0 };
+    int16_t buf[SENSOR_HISTORY_BUF_LEN(SENSOR_TYPE_ACCELEROMETER, 4)];
+    int16_t out[3];
+    uint32_t ts_buf[4];
+    uint32_t ts;
+    int rc;
+    int i;
+
+    rc = sensor_history_init(&sh, SENSOR_TYPE_ACCELEROMETER, buf, 4, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(sh.sh_dims == 3);
+    TEST_ASSERT(sensor_history_count(&sh) == 0);
+    TEST_ASSERT(sensor_history_get(&sh, 0, out) == SYS_ENOENT);
+
+    /* Overwrites oldest samples once full */
+    sad.sad_x_is_valid = 1;
+    sad.sad_y_is_valid = 1;
+    for (i = 0; i < 6; i++) {
+        sad.sad_x = i;
+        sad.sad_y = -9.81f;
+        sensor_history_put(&sh, &sad, i);
+    }
+    TEST_ASSERT(sensor_history_count(&sh) == 4);
+    TEST_ASSERT(sh.sh_last_ts == 5);
+
+    for (i = 0; i < 4; i++) {
+        rc = sensor_history_get(&sh, i, out);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(out[0] == (5 - i) * 100);
+        TEST_ASSERT(out[1] == -981);
+        TEST_ASSERT(out[2] == SENSOR_HISTORY_INVALID);
+    }
+    TEST_ASSERT(sensor_history_get(&sh, 4, out) == SYS_ENOENT);
+    TEST_ASSERT(sensor_history_to_float(&sh, out[1]) < -9.80f);
+
+    /* Out of range values saturate */
+    sad.sad_x = 1000.0f;
+    sad.sad_y = -1000.0f;
+    sensor_history_put(&sh, &sad, 6);
+    sensor_history_get(&sh, 0, out);
+    TEST_ASSERT(out[0] == INT16_MAX);
+    TEST_ASSERT(out[1] == -INT16_MAX);
+
+    /* Offset allows storing pressure with 1Pa resolution */
+    cfg.shc_scale = 1.0f;
+    cfg.shc_offset = 100000.0f;
+    rc = sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 4, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(sh.sh_dims == 1);
+    sensor_history_test_fill(&sh, 101325, 1);
+    sensor_history_get(&sh, 0, out);
+    TEST_ASSERT(out[0] == 1325);
+    TEST_ASSERT(sensor_history_to_float(&sh, out[0]) == 101325.0f);
+
+    /* Store decimation */
+    cfg.shc_decim = 3;
+    sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 4, &cfg);
+    sensor_history_test_fill(&sh, 100000, 7);
+    TEST_ASSERT(sensor_history_count(&sh) == 3);
+    sensor_history_get(&sh, 0, out);
+    TEST_ASSERT(out[0] == 6);
+    sensor_history_get(&sh, 2, out);
+    TEST_ASSERT(out[0] == 0);
+
+    sensor_history_clear(&sh);
+    TEST_ASSERT(sensor_history_count(&sh) == 0);
+
+    /* Per sample timestamps */
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.shc_ts_buf = ts_buf;
+    sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 4, &cfg);
+    TEST_ASSERT(sensor_history_get_ts(&sh, 0, &ts) == SYS_ENOENT);
+    sensor_history_test_fill(&sh, 100000, 6);
+    TEST_ASSERT(sh.sh_seq == 6);
+    rc = sensor_history_get_ts(&sh, 0, &ts);
+    TEST_ASSERT(rc == 0 && ts == 5);
+    rc = sensor_history_get_ts(&sh, 3, &ts);
+    TEST_ASSERT(rc == 0 && ts == 2);
+    sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 4, NULL);
+    sensor_history_test_fill(&sh, 100000, 1);
+    TEST_ASSERT(sensor_history_get_ts(&sh, 0, &ts) == SYS_ENOTSUP);
+
+    rc = sensor_history_init(&sh, SENSOR_TYPE_EULER, buf, 4, NULL);
+    TEST_ASSERT(rc == SYS_EINVAL);
+}
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sensor_history_test.h"
+
+struct sensor_history_test_walk {
+    int16_t vals[16];
+    int cnt;
+    int stop;
+};
+
+static int
+sensor_history_test_walk_cb(void *arg, const int16_t *sample)
+{
+    struct sensor_history_test_walk *w = arg;
+
+    w->vals[w->cnt++] = sample[0];
+
+    return w->cnt == w->stop;
+}
+
+TEST_CASE_SELF(sensor_history_test_case_walk)
+{
+    struct sensor_history sh;
+    struct sensor_history_test_walk w;
+    int16_t buf[10];
+    uint16_t n;
+    int rc;
+
+    rc = sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 10, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    sh.sh_cfg.shc_scale = 1.0f;
+    sensor_history_test_fill(&sh, 0, 15);
+
+    /* Every sample of last 4, oldest first */
+    memset(&w, 0, sizeof(w));
+    n = sensor_history_walk(&sh, 4, 1, sensor_history_test_walk_cb, &w);
+    TEST_ASSERT(n == 4);
+    TEST_ASSERT(w.vals[0] == 11 && w.vals[3] == 14);
+
+    /* Every 4th of all 10, aligned on newest */
+    memset(&w, 0, sizeof(w));
+    n = sensor_history_walk(&sh, 0, 4, sensor_history_test_walk_cb, &w);
+    TEST_ASSERT(n == 3);
+    TEST_ASSERT(w.vals[0] == 6);
+    TEST_ASSERT(w.vals[1] == 10);
+    TEST_ASSERT(w.vals[2] == 14);
+
+    /* Callback can stop the walk */
+    memset(&w, 0, sizeof(w));
+    w.stop = 2;
+    n = sensor_history_walk(&sh, 0, 0, sensor_history_test_walk_cb, &w);
+    TEST_ASSERT(n == 2);
+    TEST_ASSERT(w.vals[0] == 5 && w.vals[1] == 6);
+}
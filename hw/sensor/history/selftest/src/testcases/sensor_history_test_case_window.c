@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sensor_history_test.h"
+
+TEST_CASE_SELF(sensor_history_test_case_window)
+{
+    struct sensor_history sh;
+    struct sensor_history_window win;
+    int16_t buf[8];
+    uint16_t n;
+    int rc;
+
+    rc = sensor_history_init(&sh, SENSOR_TYPE_PRESSURE, buf, 8, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    sh.sh_cfg.shc_scale = 1.0f;
+
+    n = sensor_history_window(&sh, 0, &win);
+    TEST_ASSERT(n == 0);
+    TEST_ASSERT(win.shw_seg[0].cnt == 0 && win.shw_seg[1].cnt == 0);
+
+    /* Not wrapped: one segment */
+    sensor_history_test_fill(&sh, 0, 5);
+    n = sensor_history_window(&sh, 3, &win);
+    TEST_ASSERT(n == 3);
+    TEST_ASSERT(win.shw_seg[0].cnt == 3);
+    TEST_ASSERT(win.shw_seg[0].ptr[0] == 2);
+    TEST_ASSERT(win.shw_seg[0].ptr[2] == 4);
+    TEST_ASSERT(win.shw_seg[1].cnt == 0);
+
+    /* Wrapped: samples 3..10, 3..7 at the end and 8..10 at the start */
+    sensor_history_test_fill(&sh, 5, 6);
+    n = sensor_history_window(&sh, 0, &win);
+    TEST_ASSERT(n == 8);
+    TEST_ASSERT(win.shw_seg[0].cnt == 5);
+    TEST_ASSERT(win.shw_seg[0].ptr[0] == 3);
+    TEST_ASSERT(win.shw_seg[0].ptr[4] == 7);
+    TEST_ASSERT(win.shw_seg[1].cnt == 3);
+    TEST_ASSERT(win.shw_seg[1].ptr == buf);
+    TEST_ASSERT(win.shw_seg[1].ptr[2] == 10);
+
+    /* Short window fits after the wrap point */
+    n = sensor_history_window(&sh, 2, &win);
+    TEST_ASSERT(n == 2);
+    TEST_ASSERT(win.shw_seg[0].cnt == 2);
+    TEST_ASSERT(win.shw_seg[0].ptr[0] == 9);
+    TEST_ASSERT(win.shw_seg[1].cnt == 0);
+}
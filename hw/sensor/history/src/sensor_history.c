@@ -0,0 +1,366 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/gyro.h"
+#include "sensor/mag.h"
+#include "sensor/temperature.h"
+#include "sensor/pressure.h"
+#include "sensor/humidity.h"
+#include "sensor_history/sensor_history.h"
+
+uint8_t
+sensor_history_dims(sensor_type_t type)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+    case SENSOR_TYPE_GYROSCOPE:
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        return 3;
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+    case SENSOR_TYPE_PRESSURE:
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Default resolution per type; chosen so that int16 covers the full range
+ * of common parts (+-32g, +-3000dps, +-3000uT, 0..130kPa).
+ */
+static float
+sensor_history_dflt_scale(sensor_type_t type)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        /* m/s^2 */
+        return 0.01f;
+    case SENSOR_TYPE_GYROSCOPE:
+        /* deg/s */
+        return 0.1f;
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        /* uT */
+        return 0.1f;
+    case SENSOR_TYPE_PRESSURE:
+        /* Pa */
+        return 4.0f;
+    default:
+        /* degC, %RH */
+        return 0.01f;
+    }
+}
+
+static int16_t
+sensor_history_pack(const struct sensor_history *sh, float val, int valid)
+{
+    float v;
+
+    if (!valid) {
+        return SENSOR_HISTORY_INVALID;
+    }
+
+    v = (val - sh->sh_cfg.shc_offset) / sh->sh_cfg.shc_scale;
+    if (v >= INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v <= -INT16_MAX) {
+        return -INT16_MAX;
+    }
+
+    return (int16_t)(v < 0 ? v - 0.5f : v + 0.5f);
+}
+
+static int
+sensor_history_listener(struct sensor *sensor, void *arg, void *data,
+                        sensor_type_t type)
+{
+    struct sensor_history *sh;
+
+    sh = arg;
+    sensor_history_put(sh, data, sensor->s_sts.st_cputime);
+
+    return 0;
+}
+
+int
+sensor_history_init(struct sensor_history *sh, sensor_type_t type,
+                    int16_t *buf, uint16_t samples,
+                    const struct sensor_history_cfg *cfg)
+{
+    uint8_t dims;
+
+    dims = sensor_history_dims(type);
+    if (!dims || !buf || !samples) {
+        return SYS_EINVAL;
+    }
+
+    memset(sh, 0, sizeof(*sh));
+    sh->sh_type = type;
+    sh->sh_buf = buf;
+    sh->sh_cap = samples;
+    sh->sh_dims = dims;
+
+    if (cfg) {
+        sh->sh_cfg = *cfg;
+    }
+    if (sh->sh_cfg.shc_scale == 0) {
+        sh->sh_cfg.shc_scale = sensor_history_dflt_scale(type);
+    }
+
+    return 0;
+}
+
+int
+sensor_history_attach(struct sensor_history *sh, struct sensor *sensor)
+{
+    int rc;
+
+    if (!sensor || sh->sh_sensor) {
+        return SYS_EINVAL;
+    }
+
+    sh->sh_lsnr.sl_sensor_type = sh->sh_type;
+    sh->sh_lsnr.sl_func = sensor_history_listener;
+    sh->sh_lsnr.sl_arg = sh;
+    rc = sensor_register_listener(sensor, &sh->sh_lsnr);
+    if (rc) {
+        return rc;
+    }
+    sh->sh_sensor = sensor;
+
+    return 0;
+}
+
+int
+sensor_history_detach(struct sensor_history *sh)
+{
+    int rc;
+
+    if (!sh->sh_sensor) {
+        return SYS_EINVAL;
+    }
+
+    rc = sensor_unregister_listener(sh->sh_sensor, &sh->sh_lsnr);
+    sh->sh_sensor = NULL;
+
+    return rc;
+}
+
+void
+sensor_history_clear(struct sensor_history *sh)
+{
+    sh->sh_head = 0;
+    sh->sh_cnt = 0;
+    sh->sh_decim_cnt = 0;
+}
+
+int
+sensor_history_put(struct sensor_history *sh, const void *data, uint32_t ts)
+{
+    const struct sensor_accel_data *sad;
+    const struct sensor_gyro_data *sgd;
+    const struct sensor_mag_data *smd;
+    const struct sensor_temp_data *std;
+    const struct sensor_press_data *spd;
+    const struct sensor_humid_data *shd;
+    int16_t *out;
+
+    if (sh->sh_cfg.shc_decim > 1) {
+        if (sh->sh_decim_cnt++ != 0) {
+            if (sh->sh_decim_cnt >= sh->sh_cfg.shc_decim) {
+                sh->sh_decim_cnt = 0;
+            }
+            return 0;
+        }
+    }
+
+    out = &sh->sh_buf[sh->sh_head * sh->sh_dims];
+
+    switch (sh->sh_type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        sad = data;
+        out[0] = sensor_history_pack(sh, sad->sad_x, sad->sad_x_is_valid);
+        out[1] = sensor_history_pack(sh, sad->sad_y, sad->sad_y_is_valid);
+        out[2] = sensor_history_pack(sh, sad->sad_z, sad->sad_z_is_valid);
+        break;
+    case SENSOR_TYPE_GYROSCOPE:
+        sgd = data;
+        out[0] = sensor_history_pack(sh, sgd->sgd_x, sgd->sgd_x_is_valid);
+        out[1] = sensor_history_pack(sh, sgd->sgd_y, sgd->sgd_y_is_valid);
+        out[2] = sensor_history_pack(sh, sgd->sgd_z, sgd->sgd_z_is_valid);
+        break;
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        smd = data;
+        out[0] = sensor_history_pack(sh, smd->smd_x, smd->smd_x_is_valid);
+        out[1] = sensor_history_pack(sh, smd->smd_y, smd->smd_y_is_valid);
+        out[2] = sensor_history_pack(sh, smd->smd_z, smd->smd_z_is_valid);
+        break;
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+        std = data;
+        out[0] = sensor_history_pack(sh, std->std_temp,
+                                     std->std_temp_is_valid);
+        break;
+    case SENSOR_TYPE_PRESSURE:
+        spd = data;
+        out[0] = sensor_history_pack(sh, spd->spd_press,
+                                     spd->spd_press_is_valid);
+        break;
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        shd = data;
+        out[0] = sensor_history_pack(sh, shd->shd_humid,
+                                     shd->shd_humid_is_valid);
+        break;
+    default:
+        return 0;
+    }
+
+    if (sh->sh_cfg.shc_ts_buf) {
+        sh->sh_cfg.shc_ts_buf[sh->sh_head] = ts;
+    }
+    sh->sh_last_ts = ts;
+    sh->sh_seq++;
+    if (++sh->sh_head == sh->sh_cap) {
+        sh->sh_head = 0;
+    }
+    if (sh->sh_cnt < sh->sh_cap) {
+        sh->sh_cnt++;
+    }
+
+    return 1;
+}
+
+/* Buffer index of the sample age samples before the newest one */
+static uint16_t
+sensor_history_idx(const struct sensor_history *sh, uint16_t age)
+{
+    int idx;
+
+    idx = (int)sh->sh_head - 1 - age;
+    if (idx < 0) {
+        idx += sh->sh_cap;
+    }
+
+    return idx;
+}
+
+int
+sensor_history_get(const struct sensor_history *sh, uint16_t age,
+                   int16_t *out)
+{
+    if (age >= sh->sh_cnt) {
+        return SYS_ENOENT;
+    }
+
+    memcpy(out, &sh->sh_buf[sensor_history_idx(sh, age) * sh->sh_dims],
+           sh->sh_dims * sizeof(int16_t));
+
+    return 0;
+}
+
+int
+sensor_history_get_ts(const struct sensor_history *sh, uint16_t age,
+                      uint32_t *ts)
+{
+    if (!sh->sh_cfg.shc_ts_buf) {
+        return SYS_ENOTSUP;
+    }
+    if (age >= sh->sh_cnt) {
+        return SYS_ENOENT;
+    }
+
+    *ts = sh->sh_cfg.shc_ts_buf[sensor_history_idx(sh, age)];
+
+    return 0;
+}
+
+uint16_t
+sensor_history_window(const struct sensor_history *sh, uint16_t last,
+                      struct sensor_history_window *win)
+{
+    uint16_t first;
+    uint16_t n;
+
+    memset(win, 0, sizeof(*win));
+
+    n = sh->sh_cnt;
+    if (last && last < n) {
+        n = last;
+    }
+    if (!n) {
+        return 0;
+    }
+
+    first = sensor_history_idx(sh, n - 1);
+    win->shw_seg[0].ptr = &sh->sh_buf[first * sh->sh_dims];
+    if (first + n <= sh->sh_cap) {
+        win->shw_seg[0].cnt = n;
+    } else {
+        win->shw_seg[0].cnt = sh->sh_cap - first;
+        win->shw_seg[1].ptr = sh->sh_buf;
+        win->shw_seg[1].cnt = n - win->shw_seg[0].cnt;
+    }
+
+    return n;
+}
+
+uint16_t
+sensor_history_walk(const struct sensor_history *sh, uint16_t last,
+                    uint16_t step, sensor_history_walk_func_t func,
+                    void *arg)
+{
+    uint16_t visited;
+    uint16_t n;
+    int age;
+
+    if (step == 0) {
+        step = 1;
+    }
+
+    n = sh->sh_cnt;
+    if (last && last < n) {
+        n = last;
+    }
+    if (!n) {
+        return 0;
+    }
+
+    visited = 0;
+    for (age = ((n - 1) / step) * step; age >= 0; age -= step) {
+        visited++;
+        if (func(arg, &sh->sh_buf[sensor_history_idx(sh, age) *
+                                  sh->sh_dims])) {
+            break;
+        }
+    }
+
+    return visited;
+}
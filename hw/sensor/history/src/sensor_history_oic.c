@@ -0,0 +1,218 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_HISTORY_OIC)
+
+#include <string.h>
+#include "sensor_history/sensor_history.h"
+
+#include <oic/oc_rep.h>
+#include <oic/oc_ri.h>
+#include <oic/oc_api.h>
+#include <oic/messaging/coap/observe.h>
+
+static const char g_sho_rt[] = "x.mynewt.snsr.hist";
+
+static SLIST_HEAD(, sensor_history_oic) g_sho_list =
+    SLIST_HEAD_INITIALIZER(g_sho_list);
+
+/* Encodes the newest n samples into the root object */
+static void
+sensor_history_oic_encode(const struct sensor_history *sh, uint16_t n)
+{
+    int16_t val[SENSOR_HISTORY_MAX_DIMS];
+    uint32_t prev_ts;
+    uint32_t ts;
+    int age;
+    int i;
+
+    if (n > sensor_history_count(sh)) {
+        n = sensor_history_count(sh);
+    }
+    if (n > MYNEWT_VAL(SENSOR_HISTORY_OIC_MAX_SAMPLES)) {
+        n = MYNEWT_VAL(SENSOR_HISTORY_OIC_MAX_SAMPLES);
+    }
+
+    oc_rep_set_uint(root, type, sh->sh_type);
+    oc_rep_set_double(root, scale, sh->sh_cfg.shc_scale);
+    oc_rep_set_double(root, offset, sh->sh_cfg.shc_offset);
+    oc_rep_set_uint(root, n, n);
+
+    oc_rep_set_array(root, v);
+    for (age = n - 1; age >= 0; age--) {
+        sensor_history_get(sh, age, val);
+        for (i = 0; i < sh->sh_dims; i++) {
+            g_err |= cbor_encode_int(&v_array, val[i]);
+        }
+    }
+    oc_rep_close_array(root, v);
+
+    if (!n || sensor_history_get_ts(sh, n - 1, &prev_ts)) {
+        return;
+    }
+
+    oc_rep_set_uint(root, t0, os_cputime_ticks_to_usecs(prev_ts));
+    oc_rep_set_array(root, dt);
+    for (age = n - 2; age >= 0; age--) {
+        sensor_history_get_ts(sh, age, &ts);
+        g_err |= cbor_encode_uint(&dt_array,
+                                  os_cputime_ticks_to_usecs(ts - prev_ts));
+        prev_ts = ts;
+    }
+    oc_rep_close_array(root, dt);
+}
+
+static struct sensor_history_oic *
+sensor_history_oic_find(oc_resource_t *res)
+{
+    struct sensor_history_oic *sho;
+
+    SLIST_FOREACH(sho, &g_sho_list, sho_next) {
+        if (sho->sho_res == res) {
+            return sho;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+sensor_history_oic_get(oc_request_t *request, oc_interface_mask_t interface)
+{
+    struct sensor_history_oic *sho;
+
+    sho = sensor_history_oic_find(request->resource);
+    if (!sho) {
+        oc_send_response(request, OC_STATUS_NOT_FOUND);
+        return;
+    }
+
+    oc_rep_start_root_object();
+    switch (interface) {
+    case OC_IF_BASELINE:
+        oc_process_baseline_interface(request->resource);
+    case OC_IF_R:
+        sensor_history_oic_encode(sho->sho_sh,
+                                  sensor_history_count(sho->sho_sh));
+        break;
+    default:
+        break;
+    }
+    oc_rep_end_root_object();
+
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+sensor_history_oic_notify(struct sensor_history_oic *sho, uint16_t n)
+{
+    oc_request_t request = {};
+    oc_response_t response = {};
+    oc_response_buffer_t response_buffer;
+    struct os_mbuf *m;
+
+    m = os_msys_get_pkthdr(0, 0);
+    if (!m) {
+        return;
+    }
+
+    memset(&response_buffer, 0, sizeof(response_buffer));
+    response_buffer.buffer = m;
+    response.response_buffer = &response_buffer;
+    request.resource = sho->sho_res;
+    request.response = &response;
+
+    oc_rep_new(m);
+    oc_rep_start_root_object();
+    sensor_history_oic_encode(sho->sho_sh, n);
+    oc_rep_end_root_object();
+    oc_send_response(&request, OC_STATUS_OK);
+    coap_notify_observers(sho->sho_res, &response_buffer, NULL);
+    os_mbuf_free_chain(m);
+}
+
+static void
+sensor_history_oic_tmo(struct os_event *ev)
+{
+    struct sensor_history_oic *sho;
+    uint32_t new_cnt;
+    os_time_t ticks;
+
+    sho = ev->ev_arg;
+
+    new_cnt = sho->sho_sh->sh_seq - sho->sho_sent_seq;
+    if (new_cnt && sho->sho_res->num_observers) {
+        if (new_cnt > sensor_history_count(sho->sho_sh)) {
+            new_cnt = sensor_history_count(sho->sho_sh);
+        }
+        sensor_history_oic_notify(sho, new_cnt);
+    }
+    sho->sho_sent_seq = sho->sho_sh->sh_seq;
+
+    os_time_ms_to_ticks(sho->sho_interval_ms, &ticks);
+    os_callout_reset(&sho->sho_co, ticks);
+}
+
+int
+sensor_history_oic_add(struct sensor_history_oic *sho,
+                       struct sensor_history *sh, const char *uri,
+                       uint32_t interval_ms)
+{
+    os_time_t ticks;
+    int rc;
+
+    if (!sh || !uri || !interval_ms) {
+        return SYS_EINVAL;
+    }
+
+    rc = os_time_ms_to_ticks(interval_ms, &ticks);
+    if (rc) {
+        return SYS_EINVAL;
+    }
+
+    memset(sho, 0, sizeof(*sho));
+    sho->sho_sh = sh;
+    sho->sho_interval_ms = interval_ms;
+    sho->sho_sent_seq = sh->sh_seq;
+
+    sho->sho_res = oc_new_resource(uri, 1, 0);
+    if (!sho->sho_res) {
+        return SYS_ENOMEM;
+    }
+    oc_resource_bind_resource_type(sho->sho_res, g_sho_rt);
+    oc_resource_bind_resource_interface(sho->sho_res, OC_IF_R);
+    oc_resource_set_default_interface(sho->sho_res, OC_IF_R);
+    oc_resource_set_discoverable(sho->sho_res);
+    oc_resource_set_observable(sho->sho_res);
+    oc_resource_set_request_handler(sho->sho_res, OC_GET,
+                                    sensor_history_oic_get);
+    oc_add_resource(sho->sho_res);
+
+    SLIST_INSERT_HEAD(&g_sho_list, sho, sho_next);
+
+    os_callout_init(&sho->sho_co, sensor_mgr_evq_get(),
+                    sensor_history_oic_tmo, sho);
+    os_callout_reset(&sho->sho_co, ticks);
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_FIXED_H__
+#define __SENSOR_FIXED_H__
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Signed Q16.16 fixed point value */
+typedef int32_t sensor_q16_t;
+
+#define SENSOR_Q16_ONE              ((sensor_q16_t)1 << 16)
+#define SENSOR_Q16_FROM_INT(i)      ((sensor_q16_t)((i) * SENSOR_Q16_ONE))
+#define SENSOR_Q16_FROM_FLOAT(f)    ((sensor_q16_t)((f) * 65536.0f))
+#define SENSOR_Q16_TO_FLOAT(q)      ((float)(q) / 65536.0f)
+#define SENSOR_Q16_MUL(a, b)        \
+    ((sensor_q16_t)(((int64_t)(a) * (b)) >> 16))
+
+/**
+ * Scale raw register value to Q16.16 without floating point.
+ *
+ * @param raw   Raw sample
+ * @param num   Unit numerator of one LSB
+ * @param den   Unit denominator of one LSB
+ *
+ * E.g. raw accel sample of 1 mg/LSB part is converted to m/s^2 with
+ * SENSOR_Q16_SCALE(raw, 980665, 100000000).
+ */
+#define SENSOR_Q16_SCALE(raw, num, den) \
+    ((sensor_q16_t)(((int64_t)(raw) * (num) * SENSOR_Q16_ONE) / (den)))
+
+/**
+ * Fixed point sample, delivered to sl_fixed_func listeners. Units are the
+ * same as in the float structures; x, y, z hold the vector of accel, gyro
+ * and mag types, scalar types (temperature, pressure, humidity) use x
+ * only.
+ */
+struct sensor_fixed_data {
+    sensor_q16_t sfd_x;
+    sensor_q16_t sfd_y;
+    sensor_q16_t sfd_z;
+
+    /* Validity */
+    uint8_t sfd_x_is_valid:1;
+    uint8_t sfd_y_is_valid:1;
+    uint8_t sfd_z_is_valid:1;
+};
+
+/**
+ * Convert float sensor data to fixed point.
+ *
+ * @param type  Sensor type of data
+ * @param data  Sensor data, e.g. struct sensor_accel_data
+ * @param out   Converted sample
+ *
+ * @return 0 on success, SYS_ENOTSUP if type has no fixed point form.
+ */
+int sensor_fixed_from_data(sensor_type_t type, const void *data,
+                           struct sensor_fixed_data *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_FIXED_H__ */
@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_REGMAP_H__
+#define __SENSOR_REGMAP_H__
+
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Register access function supplied by the driver
+ *
+ * Reads or writes @p len consecutive registers starting at @p reg in a
+ * single bus transaction.  The driver is responsible for adding its
+ * auto-increment / read command bits to the register address.
+ *
+ * @param arg  Driver argument from sensor_regmap_init()
+ * @param reg  First register
+ * @param buf  Data buffer
+ * @param len  Number of registers
+ *
+ * @return 0 on success, non-zero on failure
+ */
+typedef int (*sensor_regmap_read_func_t)(void *arg, uint8_t reg,
+                                         uint8_t *buf, uint8_t len);
+typedef int (*sensor_regmap_write_func_t)(void *arg, uint8_t reg,
+                                          const uint8_t *buf, uint8_t len);
+
+/**
+ * Static description of a register map, usually const and shared by all
+ * instances of a driver.
+ */
+struct sensor_regmap_desc {
+    /* First register covered by the cache */
+    uint8_t srd_first;
+    /* Number of registers covered by the cache */
+    uint8_t srd_count;
+    /* Maximum registers per bus transaction, 0 for no limit */
+    uint8_t srd_max_burst;
+    /*
+     * Bitmap of registers in the cached range which must never be cached
+     * (status, data, self-clearing or read-to-clear registers), bit n
+     * corresponds to register srd_first + n.  NULL if all are cacheable.
+     */
+    const uint8_t *srd_volatile;
+    sensor_regmap_read_func_t srd_read;
+    sensor_regmap_write_func_t srd_write;
+};
+
+/** Size of the valid bitmap for a cache of __n registers */
+#define SENSOR_REGMAP_VALID_SIZE(__n)   (((__n) + 7) / 8)
+
+/**
+ * Register map instance
+ *
+ * Registers inside the cached range which are not volatile are cached
+ * write-through: reads are served from the cache once the register value
+ * is known and writes of the value already held by the device are skipped.
+ * Registers outside the range go straight to the bus.
+ */
+struct sensor_regmap {
+    const struct sensor_regmap_desc *sr_desc;
+    void *sr_arg;
+    /* srd_count bytes */
+    uint8_t *sr_cache;
+    /* SENSOR_REGMAP_VALID_SIZE(srd_count) bytes */
+    uint8_t *sr_valid;
+};
+
+/** Register / value pair for sensor_regmap_write_multi() */
+struct sensor_regmap_val {
+    uint8_t srv_reg;
+    uint8_t srv_val;
+};
+
+/**
+ * Initialize register map, all cache entries start out invalid.
+ *
+ * @param rm    Register map
+ * @param desc  Register map description
+ * @param arg   Argument passed to the read / write functions
+ * @param cache Cache storage, srd_count bytes
+ * @param valid Valid bitmap storage,
+ *              SENSOR_REGMAP_VALID_SIZE(srd_count) bytes
+ */
+void sensor_regmap_init(struct sensor_regmap *rm,
+                        const struct sensor_regmap_desc *desc, void *arg,
+                        uint8_t *cache, uint8_t *valid);
+
+/**
+ * Drop all cached values, e.g. after the device was reset.
+ *
+ * @param rm  Register map
+ */
+void sensor_regmap_invalidate(struct sensor_regmap *rm);
+
+/**
+ * Read contiguous registers
+ *
+ * If all requested registers are cached no bus access is made, otherwise
+ * the whole range is read in as few bursts as srd_max_burst allows and
+ * the cache is refreshed.
+ *
+ * @param rm   Register map
+ * @param reg  First register
+ * @param buf  Buffer for the register values
+ * @param len  Number of registers
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int sensor_regmap_read(struct sensor_regmap *rm, uint8_t reg, uint8_t *buf,
+                       uint8_t len);
+
+/**
+ * Write contiguous registers
+ *
+ * Leading and trailing registers which already hold the requested value
+ * are not written; if none differ the write is skipped entirely.
+ *
+ * @param rm   Register map
+ * @param reg  First register
+ * @param buf  Register values
+ * @param len  Number of registers
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int sensor_regmap_write(struct sensor_regmap *rm, uint8_t reg,
+                        const uint8_t *buf, uint8_t len);
+
+/**
+ * Read-modify-write a single register, the read is served from the cache
+ * when possible.
+ *
+ * @param rm    Register map
+ * @param reg   Register
+ * @param mask  Bits to modify
+ * @param val   New value of the bits in mask
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int sensor_regmap_update(struct sensor_regmap *rm, uint8_t reg, uint8_t mask,
+                         uint8_t val);
+
+/**
+ * Program a list of registers
+ *
+ * Entries whose register already holds the value are dropped and runs
+ * of consecutive registers are merged into a single burst write.  The
+ * list is written in order, so it should be sorted by register unless
+ * the device needs a specific programming sequence.
+ *
+ * @param rm    Register map
+ * @param vals  Register / value pairs
+ * @param cnt   Number of entries in vals
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int sensor_regmap_write_multi(struct sensor_regmap *rm,
+                              const struct sensor_regmap_val *vals, int cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_REGMAP_H__ */
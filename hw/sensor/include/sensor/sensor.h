@@ -282,6 +282,71 @@ typedef int
 typedef void
 (*sensor_error_func_t)(struct sensor *sensor, void *arg, int status);
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+/**
+ * Batch of samples of one type read from sensor FIFO at once.
+ */
+struct sensor_batch {
+    /* Type of samples */
+    sensor_type_t sb_type;
+
+    /* Number of samples in sb_data */
+    uint16_t sb_count;
+
+    /* Size of one sample in sb_data, e.g. sizeof(struct sensor_accel_data) */
+    uint16_t sb_stride;
+
+    /* Samples, oldest first */
+    void *sb_data;
+
+    /* Cputime of first sample */
+    uint32_t sb_cputime;
+
+    /* Cputime ticks between consecutive samples */
+    uint32_t sb_interval;
+};
+
+/**
+ * Get sample from batch.
+ *
+ * @param sb The batch
+ * @param idx Sample index, 0 is oldest
+ *
+ * @return Pointer to sample data
+ */
+static inline void *
+sensor_batch_sample(const struct sensor_batch *sb, int idx)
+{
+    return (uint8_t *)sb->sb_data + idx * sb->sb_stride;
+}
+
+/**
+ * Get cputime of sample from batch.
+ *
+ * @param sb The batch
+ * @param idx Sample index, 0 is oldest
+ *
+ * @return Cputime at which sample was taken
+ */
+static inline uint32_t
+sensor_batch_cputime(const struct sensor_batch *sb, int idx)
+{
+    return sb->sb_cputime + idx * sb->sb_interval;
+}
+
+/**
+ * Callback for handling batch of sensor samples.
+ *
+ * @param sensor The sensor for which data is being returned
+ * @param arg The argument provided to sensor_read_fifo() or listener
+ * @param batch Samples read from FIFO
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_batch_func_t)(struct sensor *sensor, void *arg,
+                                   const struct sensor_batch *batch);
+#endif
+
 /**
  *
  */
@@ -298,6 +363,20 @@ struct sensor_listener {
     /* Argument for the sensor listener */
     void *sl_arg;
 
+#if MYNEWT_VAL(SENSOR_FIXED)
+    /* Optional handler for fixed point data (struct sensor_fixed_data).
+     * If set, it is called instead of sl_func.
+     */
+    sensor_data_func_t sl_fixed_func;
+#endif
+
+#if MYNEWT_VAL(SENSOR_FIFO)
+    /* Optional handler for batches read from FIFO. If not set, sl_func is
+     * called for each sample of the batch.
+     */
+    sensor_batch_func_t sl_batch_func;
+#endif
+
     /* Next item in the sensor listener list.  The head of this list is
      * contained within the sensor object.
      */
@@ -341,6 +420,38 @@ struct sensor_read_ev_ctx {
 /**
  * Sensor type traits list
  */
+#if MYNEWT_VAL(SENSOR_FILTER)
+/**
+ * Sensor filter types
+ */
+#define SENSOR_FILTER_NONE      0
+#define SENSOR_FILTER_IIR       1
+#define SENSOR_FILTER_AVG       2
+#define SENSOR_FILTER_MEDIAN    3
+
+/**
+ * Filter applied to samples of one sensor type before they are passed to
+ * listeners. Vector types are filtered per axis.
+ */
+struct sensor_filter {
+    /* SENSOR_FILTER_* */
+    uint8_t sf_type;
+    /* Window of AVG and MEDIAN, up to MYNEWT_VAL(SENSOR_FILTER_MAX_N) */
+    uint8_t sf_n;
+    /* Pass every n-th filtered sample to listeners, 0 and 1 pass all */
+    uint8_t sf_decim;
+    /* IIR low-pass y += alpha * (x - y), 0 < alpha <= 1 */
+    float sf_alpha;
+
+    /* Filter state */
+    uint8_t sf_cnt;
+    uint8_t sf_pos;
+    uint8_t sf_decim_cnt;
+    float sf_win[3][MYNEWT_VAL(SENSOR_FILTER_MAX_N)];
+    float sf_y[3];
+};
+#endif
+
 struct sensor_type_traits {
     /* The type of sensor data for checking against thresholds */
     sensor_type_t stt_sensor_type;
@@ -366,6 +477,20 @@ struct sensor_type_traits {
     /* function ptr for setting comparison algo */
     sensor_trigger_cmp_func_t stt_trigger_cmp_algo;
 
+#if MYNEWT_VAL(SENSOR_FILTER)
+    /* Filter stage for this type */
+    struct sensor_filter stt_filter;
+#endif
+
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+    /* Threshold is compared by sensor hardware */
+    uint8_t stt_hw_thresh:1;
+    /* Hardware reported crossing, not yet delivered */
+    uint8_t stt_hw_pending:1;
+    /* Event posted from sensor threshold interrupt */
+    struct os_event stt_trig_evt;
+#endif
+
 #if MYNEWT_VAL(SENSOR_OIC)
     /* Sensor OIC resource */
     oc_resource_t *stt_oic_res;
@@ -503,6 +628,81 @@ typedef int (*sensor_handle_interrupt_t)(struct sensor *sensor);
  */
 typedef int (*sensor_reset_t)(struct sensor *);
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+/**
+ * Drain sensor FIFO, reporting samples in batches.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type Type(s) of samples to read
+ * @param batch_func Function to call for each batch
+ * @param arg Argument for batch_func
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_fifo_t)(struct sensor *sensor, sensor_type_t type,
+                                  sensor_batch_func_t batch_func, void *arg);
+
+/**
+ * Configure sensor FIFO and its watermark interrupt. Driver calls
+ * sensor_mgr_put_fifo_evt() when watermark is reached.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type Type(s) of samples to collect in FIFO
+ * @param watermark Number of samples triggering read, 0 disables FIFO
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_set_fifo_t)(struct sensor *sensor, sensor_type_t type,
+                                 uint16_t watermark);
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+/**
+ * Start reading sensor without blocking. Driver queues bus transaction(s)
+ * and returns; when data is available it calls
+ * sensor_mgr_put_read_done_evt(), possibly from interrupt context.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type Type(s) of data to read
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_start_t)(struct sensor *sensor, sensor_type_t type);
+
+/**
+ * Finish read started by sensor_read_start_t. Called from sensor manager
+ * eventq; converts data read by the bus transaction and reports it.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type Type(s) of data that was read
+ * @param data_func Function to call with the data
+ * @param arg Argument for data_func
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_finish_t)(struct sensor *sensor, sensor_type_t type,
+                                    sensor_data_func_t data_func, void *arg);
+#endif
+
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+/**
+ * Program sensor hardware to compare samples against thresholds in stt.
+ * Driver reports crossings by calling sensor_mgr_put_trigger_evt() from
+ * its interrupt handler.
+ *
+ * @param sensor Ptr to the sensor
+ * @param type Type of sensor
+ * @param stt Thresholds and comparison algorithm
+ *
+ * @return 0 if the hardware will compare, SYS_ENOTSUP if the thresholds
+ *         can not be expressed by the hardware, other non-zero error code
+ *         on failure.
+ */
+typedef int (*sensor_offload_thresh_t)(struct sensor *sensor,
+                                       sensor_type_t type,
+                                       struct sensor_type_traits *stt);
+#endif
+
 
 struct sensor_driver {
     sensor_read_func_t sd_read;
@@ -515,6 +715,21 @@ struct sensor_driver {
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
     sensor_reset_t sd_reset;
+#if MYNEWT_VAL(SENSOR_FIFO)
+    sensor_read_fifo_t sd_read_fifo;
+    sensor_set_fifo_t sd_set_fifo;
+#endif
+#if MYNEWT_VAL(SENSOR_ASYNC)
+    sensor_read_start_t sd_read_start;
+    sensor_read_finish_t sd_read_finish;
+#endif
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+    sensor_offload_thresh_t sd_offload_thresh;
+#endif
+#if MYNEWT_VAL(SENSOR_FIXED)
+    /* Same as sd_read, but reports struct sensor_fixed_data */
+    sensor_read_func_t sd_read_fixed;
+#endif
 };
 
 struct sensor_timestamp {
@@ -587,6 +802,40 @@ struct sensor_itf {
 #define SENSOR_DATA_CMP_LT(__d, __t, __f) (\
     ((__d->__f##_is_valid) && (__t->__f##_is_valid)) ? (__d->__f < __t->__f) : (0))
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+#define SENSOR_TIMING_LATE_BUCKETS  8
+
+/**
+ * Poll timing of a sensor, collected by sensor manager.
+ */
+struct sensor_timing {
+    /* Polls done, and poll slots skipped because a poll was late */
+    uint32_t st_polls;
+    uint32_t st_missed;
+
+    /*
+     * Poll lateness histogram, bucket n counts polls done less than 2^n ms
+     * after they were scheduled; the last one counts all later polls.
+     */
+    uint32_t st_late[SENSOR_TIMING_LATE_BUCKETS];
+    uint32_t st_late_max_ms;
+
+    /* sensor_read() calls and their duration in microseconds, without
+     * time spent in listeners and data callbacks.
+     */
+    uint32_t st_reads;
+    uint32_t st_read_us_total;
+    uint32_t st_read_us_max;
+
+    /* Time spent in listeners and data callbacks per read */
+    uint32_t st_dispatch_us_total;
+    uint32_t st_dispatch_us_max;
+
+    /* Dispatch time of the read in progress */
+    uint32_t st_dispatch_us_cur;
+};
+#endif
+
 struct sensor {
     /* The OS device this sensor inherits from, this is typically a sensor
      * specific driver.
@@ -613,6 +862,15 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    /* Position in sensor manager poll heap plus one, 0 if not scheduled */
+    uint16_t s_poll_idx;
+#endif
+
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    struct sensor_timing s_timing;
+#endif
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -627,6 +885,29 @@ struct sensor {
     /* OS event for interrupt handling */
     struct os_event s_interrupt_evt;
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+    /* OS event for FIFO watermark handling */
+    struct os_event s_fifo_evt;
+
+    /* Types collected in FIFO, 0 if FIFO mode is off */
+    sensor_type_t s_fifo_type;
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+    /* OS event for completion of non-blocking read */
+    struct os_event s_read_done_evt;
+
+    /* Data function and argument of read in progress */
+    sensor_data_func_t s_async_func;
+    void *s_async_arg;
+
+    /* Types being read, 0 if no read is in progress */
+    sensor_type_t s_async_type;
+
+    /* Result of bus transaction, reported by driver */
+    int s_async_rc;
+#endif
+
     /* A list of listeners that are registered to receive data off of this
      * sensor
      */
@@ -807,6 +1088,56 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+/**
+ * Read all samples collected in sensor FIFO. Listeners with sl_batch_func
+ * receive whole batches, other listeners are called for each sample.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read
+ * @param batch_func Optional callback for each batch
+ * @param arg The argument to pass to batch_func
+ *
+ * @return 0 on success, SYS_ENOTSUP if driver has no FIFO support,
+ *         non-zero on failure.
+ */
+int sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                     sensor_batch_func_t batch_func, void *arg);
+
+/**
+ * Enable or disable FIFO mode. In FIFO mode samples are read in batches
+ * when FIFO watermark is reached; periodic polling, if configured, drains
+ * FIFO instead of reading single sample.
+ *
+ * @param sensor The sensor
+ * @param type The type(s) of sensor data to collect
+ * @param watermark FIFO level triggering read, 0 disables FIFO mode
+ *
+ * @return 0 on success, SYS_ENOTSUP if driver has no FIFO support,
+ *         non-zero on failure.
+ */
+int sensor_set_fifo(struct sensor *sensor, sensor_type_t type,
+                    uint16_t watermark);
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+/**
+ * Start reading sensor without waiting for the bus. Data is delivered
+ * to listeners and data_func from the sensor manager eventq once the bus
+ * transaction completes.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read
+ * @param data_func Optional callback for the data
+ * @param arg The argument to pass to data_func
+ *
+ * @return 0 on success, SYS_ENOTSUP if driver can't read asynchronously,
+ *         SYS_EBUSY if read is already in progress, non-zero on failure.
+ */
+int sensor_read_async(struct sensor *sensor, sensor_type_t type,
+                      sensor_data_func_t data_func, void *arg);
+#endif
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -1092,6 +1423,21 @@ sensor_clear_low_thresh(const char *devname, sensor_type_t type);
 int
 sensor_clear_high_thresh(const char *devname, sensor_type_t type);
 
+#if MYNEWT_VAL(SENSOR_FILTER)
+/**
+ * Set filter for a sensor type. Filter configuration (sf_type, sf_n,
+ * sf_decim, sf_alpha) is taken from stt->stt_filter; if the sensor has no
+ * traits for stt->stt_sensor_type yet, stt is added to it.
+ *
+ * @param devname Name of the sensor
+ * @param stt Ptr to sensor type traits
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+sensor_set_filter(const char *devname, struct sensor_type_traits *stt);
+#endif
+
 /**
  * Puts a notification event on the sensor manager evq
  *
@@ -1118,6 +1464,54 @@ sensor_mgr_put_interrupt_evt(struct sensor *sensor);
 void
 sensor_mgr_put_read_evt(void *arg);
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+/**
+ * Puts FIFO read event on the sensor manager evq. Called by drivers from
+ * FIFO watermark interrupt; sensor manager then drains FIFO with
+ * sensor_read_fifo() and delivers batches to listeners.
+ *
+ * @param sensor Sensor Ptr
+ */
+void
+sensor_mgr_put_fifo_evt(struct sensor *sensor);
+#endif
+
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+/**
+ * Reset poll timing collected for sensor.
+ *
+ * @param sensor Sensor Ptr
+ */
+void
+sensor_timing_clear(struct sensor *sensor);
+#endif
+
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+/**
+ * Puts threshold trigger event on the sensor manager evq. Called by drivers
+ * from the interrupt of a threshold programmed by sd_offload_thresh; sensor
+ * manager reads the sensor and notifies trigger listeners without
+ * comparing in software.
+ *
+ * @param stt Sensor type traits the threshold belongs to
+ */
+void
+sensor_mgr_put_trigger_evt(struct sensor_type_traits *stt);
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+/**
+ * Puts read completion event on the sensor manager evq. Called by drivers
+ * when bus transaction started by sd_read_start is done; can be called
+ * from interrupt context.
+ *
+ * @param sensor Sensor Ptr
+ * @param status Result of bus transaction, 0 on success
+ */
+void
+sensor_mgr_put_read_done_evt(struct sensor *sensor, int status);
+#endif
+
 /**
  * Resets the sensor
  *
@@ -23,6 +23,8 @@
 TEST_SUITE(sensor_test_suite_poll)
 {
     sensor_test_case_poll_err();
+    sensor_test_case_fixed();
+    sensor_test_case_filter();
 }
 
 int
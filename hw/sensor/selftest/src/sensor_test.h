@@ -25,5 +25,7 @@
 
 TEST_SUITE_DECL(sensor_test_suite_poll);
 TEST_CASE_DECL(sensor_test_case_poll_err);
+TEST_CASE_DECL(sensor_test_case_fixed);
+TEST_CASE_DECL(sensor_test_case_filter);
 
 #endif
@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/temperature.h"
+#include "sensor_test.h"
+
+#define STCFI_MAX_OUT   16
+
+static float stcfi_in;
+static float stcfi_out[STCFI_MAX_OUT];
+static int stcfi_out_cnt;
+
+static int
+stcfi_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_temp_data std = {
+        .std_temp = stcfi_in,
+        .std_temp_is_valid = 1,
+    };
+
+    return data_func(sensor, arg, &std, SENSOR_TYPE_TEMPERATURE);
+}
+
+static int
+stcfi_listener(struct sensor *sensor, void *arg, void *data,
+               sensor_type_t type)
+{
+    TEST_ASSERT_FATAL(stcfi_out_cnt < STCFI_MAX_OUT);
+    stcfi_out[stcfi_out_cnt++] = ((struct sensor_temp_data *)data)->std_temp;
+    return 0;
+}
+
+static void
+stcfi_feed(struct sensor *sn, const float *in, int cnt)
+{
+    int rc;
+    int i;
+
+    stcfi_out_cnt = 0;
+    for (i = 0; i < cnt; i++) {
+        stcfi_in = in[i];
+        rc = sensor_read(sn, SENSOR_TYPE_TEMPERATURE, NULL, NULL,
+                         OS_TIMEOUT_NEVER);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+TEST_CASE_SELF(sensor_test_case_filter)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcfi_sensor_read,
+    };
+    static struct os_dev dev = {
+        .od_name = "stcfi",
+    };
+    static const float in[6] = { 1, 9, 2, 3, 100, 4 };
+    struct sensor_listener lsnr = {
+        .sl_sensor_type = SENSOR_TYPE_TEMPERATURE,
+        .sl_func = stcfi_listener,
+    };
+    struct sensor_type_traits stt = {
+        .stt_sensor_type = SENSOR_TYPE_TEMPERATURE,
+    };
+    struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, &dev);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_TEMPERATURE, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+    rc = sensor_mgr_register(&sn);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_listener(&sn, &lsnr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Invalid configuration is rejected. */
+    stt.stt_filter.sf_type = SENSOR_FILTER_MEDIAN;
+    stt.stt_filter.sf_n = MYNEWT_VAL(SENSOR_FILTER_MAX_N) + 1;
+    rc = sensor_set_filter("stcfi", &stt);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Median of 3 removes spikes. */
+    stt.stt_filter.sf_n = 3;
+    rc = sensor_set_filter("stcfi", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcfi_feed(&sn, in, 6);
+    TEST_ASSERT_FATAL(stcfi_out_cnt == 6);
+    TEST_ASSERT(stcfi_out[0] == 1);
+    TEST_ASSERT(stcfi_out[1] == 5);
+    TEST_ASSERT(stcfi_out[2] == 2);
+    TEST_ASSERT(stcfi_out[3] == 3);
+    TEST_ASSERT(stcfi_out[4] == 3);
+    TEST_ASSERT(stcfi_out[5] == 4);
+
+    /*** Moving average of 2, every other sample passed. */
+    stt.stt_filter.sf_type = SENSOR_FILTER_AVG;
+    stt.stt_filter.sf_n = 2;
+    stt.stt_filter.sf_decim = 2;
+    rc = sensor_set_filter("stcfi", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcfi_feed(&sn, in, 6);
+    TEST_ASSERT_FATAL(stcfi_out_cnt == 3);
+    TEST_ASSERT(stcfi_out[0] == 1);
+    TEST_ASSERT(stcfi_out[1] == 5.5f);
+    TEST_ASSERT(stcfi_out[2] == 51.5f);
+
+    /*** IIR low-pass. */
+    stt.stt_filter.sf_type = SENSOR_FILTER_IIR;
+    stt.stt_filter.sf_alpha = 0.5f;
+    stt.stt_filter.sf_decim = 0;
+    rc = sensor_set_filter("stcfi", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcfi_feed(&sn, in, 3);
+    TEST_ASSERT_FATAL(stcfi_out_cnt == 3);
+    TEST_ASSERT(stcfi_out[0] == 1);
+    TEST_ASSERT(stcfi_out[1] == 5);
+    TEST_ASSERT(stcfi_out[2] == 3.5f);
+
+    /*** No filter. */
+    stt.stt_filter.sf_type = SENSOR_FILTER_NONE;
+    rc = sensor_set_filter("stcfi", &stt);
+    TEST_ASSERT_FATAL(rc == 0);
+    stcfi_feed(&sn, in, 2);
+    TEST_ASSERT(stcfi_out_cnt == 2 && stcfi_out[1] == 9);
+
+    sensor_unregister_listener(&sn, &lsnr);
+}
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/fixed.h"
+#include "sensor_test.h"
+
+static int stcf_float_reads;
+static int stcf_fixed_reads;
+static struct sensor_fixed_data stcf_fixed;
+static struct sensor_accel_data stcf_float;
+
+static int
+stcf_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_data sad = {
+        .sad_x = 9.80665f,
+        .sad_y = -0.5f,
+        .sad_x_is_valid = 1,
+        .sad_y_is_valid = 1,
+    };
+
+    stcf_float_reads++;
+
+    return data_func(sensor, arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static int
+stcf_sensor_read_fixed(struct sensor *sensor, sensor_type_t type,
+                       sensor_data_func_t data_func, void *arg,
+                       uint32_t timeout)
+{
+    struct sensor_fixed_data sfd = {
+        /* 1000 mg */
+        .sfd_x = SENSOR_Q16_SCALE(1000, 980665, 100000000),
+        .sfd_y = -SENSOR_Q16_ONE / 2,
+        .sfd_x_is_valid = 1,
+        .sfd_y_is_valid = 1,
+    };
+
+    stcf_fixed_reads++;
+
+    return data_func(sensor, arg, &sfd, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static int
+stcf_fixed_listener(struct sensor *sensor, void *arg, void *data,
+                    sensor_type_t type)
+{
+    stcf_fixed = *(struct sensor_fixed_data *)data;
+    return 0;
+}
+
+static int
+stcf_float_listener(struct sensor *sensor, void *arg, void *data,
+                    sensor_type_t type)
+{
+    stcf_float = *(struct sensor_accel_data *)data;
+    return 0;
+}
+
+TEST_CASE_SELF(sensor_test_case_fixed)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcf_sensor_read,
+        .sd_read_fixed = stcf_sensor_read_fixed,
+    };
+    struct sensor_listener fixed_lsnr = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_fixed_func = stcf_fixed_listener,
+    };
+    struct sensor_listener float_lsnr = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcf_float_listener,
+    };
+    struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    /*** Only fixed point listeners; driver skips float. */
+    rc = sensor_register_listener(&sn, &fixed_lsnr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcf_fixed_reads == 1);
+    TEST_ASSERT(stcf_float_reads == 0);
+    TEST_ASSERT(stcf_fixed.sfd_x == 642688);
+    TEST_ASSERT(stcf_fixed.sfd_y == -32768);
+    TEST_ASSERT(stcf_fixed.sfd_x_is_valid && !stcf_fixed.sfd_z_is_valid);
+
+    /*** Float listener present; fixed listener gets converted data. */
+    memset(&stcf_fixed, 0, sizeof(stcf_fixed));
+    rc = sensor_register_listener(&sn, &float_lsnr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcf_fixed_reads == 1);
+    TEST_ASSERT(stcf_float_reads == 1);
+    TEST_ASSERT(stcf_float.sad_x == 9.80665f);
+    TEST_ASSERT(stcf_fixed.sfd_x >= 642688 && stcf_fixed.sfd_x <= 642690);
+    TEST_ASSERT(stcf_fixed.sfd_y == -32768);
+
+    sensor_unregister_listener(&sn, &float_lsnr);
+    sensor_unregister_listener(&sn, &fixed_lsnr);
+}
@@ -33,13 +33,57 @@
 #include "sensor/pressure.h"
 #include "sensor/humidity.h"
 #include "sensor/gyro.h"
+#if MYNEWT_VAL(SENSOR_FIXED)
+#include "sensor/fixed.h"
+#endif
 #include "console/console.h"
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+#include "bus/bus.h"
+#endif
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+#include "stats/stats.h"
+#endif
 
 #ifdef MYNEWT_VAL_SENSOR_MGR_EVQ
 extern struct os_eventq MYNEWT_VAL(SENSOR_MGR_EVQ);
 #endif
 
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+/* Totals over all sensors, per sensor values are in struct sensor_timing */
+STATS_SECT_START(sensor_mgr_stats)
+    STATS_SECT_ENTRY(polls)
+    STATS_SECT_ENTRY(missed_slots)
+    STATS_SECT_ENTRY(late_lt1ms)
+    STATS_SECT_ENTRY(late_lt2ms)
+    STATS_SECT_ENTRY(late_lt4ms)
+    STATS_SECT_ENTRY(late_lt8ms)
+    STATS_SECT_ENTRY(late_lt16ms)
+    STATS_SECT_ENTRY(late_lt32ms)
+    STATS_SECT_ENTRY(late_lt64ms)
+    STATS_SECT_ENTRY(late_ge64ms)
+    STATS_SECT_ENTRY(reads)
+    STATS_SECT_ENTRY(read_errors)
+STATS_SECT_END
+
+STATS_NAME_START(sensor_mgr_stats)
+    STATS_NAME(sensor_mgr_stats, polls)
+    STATS_NAME(sensor_mgr_stats, missed_slots)
+    STATS_NAME(sensor_mgr_stats, late_lt1ms)
+    STATS_NAME(sensor_mgr_stats, late_lt2ms)
+    STATS_NAME(sensor_mgr_stats, late_lt4ms)
+    STATS_NAME(sensor_mgr_stats, late_lt8ms)
+    STATS_NAME(sensor_mgr_stats, late_lt16ms)
+    STATS_NAME(sensor_mgr_stats, late_lt32ms)
+    STATS_NAME(sensor_mgr_stats, late_lt64ms)
+    STATS_NAME(sensor_mgr_stats, late_ge64ms)
+    STATS_NAME(sensor_mgr_stats, reads)
+    STATS_NAME(sensor_mgr_stats, read_errors)
+STATS_NAME_END(sensor_mgr_stats)
+
+static STATS_SECT_DECL(sensor_mgr_stats) g_sensor_mgr_stats;
+#endif
+
 #if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
 uint32_t test_log_idx;
 uint32_t smgr_wakeup_idx;
@@ -63,6 +107,12 @@ struct {
     struct os_eventq *mgr_eventq;
 
     SLIST_HEAD(, sensor) mgr_sensor_list;
+
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    /* Min-heap of polled sensors, ordered by s_next_run */
+    struct sensor *mgr_poll_heap[MYNEWT_VAL(SENSOR_MGR_POLL_MAX)];
+    uint16_t mgr_poll_cnt;
+#endif
 } sensor_mgr;
 
 struct sensor_timestamp sensor_base_ts;
@@ -71,6 +121,15 @@ struct os_callout st_up_osco;
 static void sensor_notify_ev_cb(struct os_event * ev);
 static void sensor_read_ev_cb(struct os_event *ev);
 static void sensor_interrupt_ev_cb(struct os_event *ev);
+#if MYNEWT_VAL(SENSOR_FIFO)
+static void sensor_fifo_ev_cb(struct os_event *ev);
+#endif
+#if MYNEWT_VAL(SENSOR_ASYNC)
+static void sensor_read_done_ev_cb(struct os_event *ev);
+#endif
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+static void sensor_trigger_ev_cb(struct os_event *ev);
+#endif
 
 /** OS event - for doing a sensor read */
 static struct os_event sensor_read_event = {
@@ -108,6 +167,134 @@ sensor_mgr_unlock(void)
     (void) os_mutex_release(&sensor_mgr.mgr_lock);
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+static inline int
+sensor_mgr_heap_lt(int a, int b)
+{
+    return OS_TIME_TICK_LT(sensor_mgr.mgr_poll_heap[a]->s_next_run,
+                           sensor_mgr.mgr_poll_heap[b]->s_next_run);
+}
+
+static void
+sensor_mgr_heap_swap(int a, int b)
+{
+    struct sensor **heap = sensor_mgr.mgr_poll_heap;
+    struct sensor *tmp;
+
+    tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+
+    /* s_poll_idx is 1 based, 0 means not scheduled */
+    heap[a]->s_poll_idx = a + 1;
+    heap[b]->s_poll_idx = b + 1;
+}
+
+static void
+sensor_mgr_heap_up(int i)
+{
+    int parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!sensor_mgr_heap_lt(i, parent)) {
+            break;
+        }
+        sensor_mgr_heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void
+sensor_mgr_heap_down(int i)
+{
+    int cnt = sensor_mgr.mgr_poll_cnt;
+    int min;
+    int c;
+
+    while (1) {
+        min = i;
+        c = 2 * i + 1;
+        if (c < cnt && sensor_mgr_heap_lt(c, min)) {
+            min = c;
+        }
+        if (c + 1 < cnt && sensor_mgr_heap_lt(c + 1, min)) {
+            min = c + 1;
+        }
+        if (min == i) {
+            break;
+        }
+        sensor_mgr_heap_swap(i, min);
+        i = min;
+    }
+}
+
+static void
+sensor_mgr_heap_remove(struct sensor *sensor)
+{
+    int last;
+    int i;
+
+    if (!sensor->s_poll_idx) {
+        return;
+    }
+
+    i = sensor->s_poll_idx - 1;
+    last = --sensor_mgr.mgr_poll_cnt;
+    sensor->s_poll_idx = 0;
+
+    if (i != last) {
+        sensor_mgr.mgr_poll_heap[i] = sensor_mgr.mgr_poll_heap[last];
+        sensor_mgr.mgr_poll_heap[i]->s_poll_idx = i + 1;
+        sensor_mgr_heap_down(i);
+        sensor_mgr_heap_up(i);
+    }
+}
+
+static int
+sensor_mgr_heap_insert(struct sensor *sensor)
+{
+    int i;
+
+    sensor_mgr_heap_remove(sensor);
+
+    /* Sensors that are not periodic are not scheduled at all */
+    if (!sensor->s_poll_rate) {
+        return 0;
+    }
+
+    if (sensor_mgr.mgr_poll_cnt >= MYNEWT_VAL(SENSOR_MGR_POLL_MAX)) {
+        return SYS_ENOMEM;
+    }
+
+    i = sensor_mgr.mgr_poll_cnt++;
+    sensor_mgr.mgr_poll_heap[i] = sensor;
+    sensor->s_poll_idx = i + 1;
+    sensor_mgr_heap_up(i);
+
+    return 0;
+}
+
+static void
+sensor_mgr_insert(struct sensor *sensor)
+{
+    struct sensor *cursor, *prev;
+
+    /* Poll order is kept in the heap, list is only used for lookups */
+    prev = NULL;
+    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
+        prev = cursor;
+    }
+
+    if (prev == NULL) {
+        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
+    } else {
+        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    }
+
+    sensor_mgr_heap_insert(sensor);
+}
+#else
 static void
 sensor_mgr_remove(struct sensor *sensor)
 {
@@ -147,6 +334,7 @@ insert:
         SLIST_INSERT_AFTER(prev, sensor, s_next);
     }
 }
+#endif
 
 /**
  * Remove a sensor type trait. This allows a calling application to clear
@@ -337,9 +525,17 @@ sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
 
     sensor_mgr_lock();
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    if (sensor_mgr.mgr_poll_cnt) {
+        head = sensor_mgr.mgr_poll_heap[0];
+    }
+#else
     head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
+#endif
 
-    *min_nextrun = sensor_calc_nextrun_delta(head, now);
+    if (head) {
+        *min_nextrun = sensor_calc_nextrun_delta(head, now);
+    }
 
     sensor_mgr_unlock();
 
@@ -347,15 +543,22 @@ sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
 
 }
 
-static void
+static int
 sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 {
     os_time_t sensor_ticks;
+    int rc;
 
     os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
 
     sensor_lock(sensor);
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+    sensor->s_next_run = sensor_ticks + now;
+
+    /* Moves the sensor to its new place in the heap */
+    rc = sensor_mgr_heap_insert(sensor);
+#else
     /* Remove the sensor from the sensor list for insert. */
     sensor_mgr_remove(sensor);
 
@@ -366,8 +569,12 @@ sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 
     /* Re-insert the sensor manager, with the new wakeup time. */
     sensor_mgr_insert(sensor);
+    rc = 0;
+#endif
 
     sensor_unlock(sensor);
+
+    return rc;
 }
 
 /**
@@ -400,15 +607,16 @@ sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate)
 
     sensor_update_poll_rate(sensor, poll_rate);
 
-    sensor_update_nextrun(sensor, now);
+    rc = sensor_update_nextrun(sensor, now);
 
     sensor_unlock(sensor);
 
     sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    if (sensor) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    }
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
-
-    return 0;
+    return rc;
 err:
     return rc;
 }
@@ -524,12 +732,233 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
     sensor_unlock(sensor);
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+/*
+ * Called before polling; s_next_run still holds the time the poll was
+ * scheduled for.
+ */
+static void
+sensor_timing_poll(struct sensor *sensor)
+{
+    struct sensor_timing *st;
+    os_time_t period;
+    int32_t late;
+    uint32_t late_ms;
+    uint32_t missed;
+    int b;
+
+    st = &sensor->s_timing;
+
+    late = (int32_t)(os_time_get() - sensor->s_next_run);
+    if (late < 0) {
+        /* Polled early, within coalesce window */
+        late = 0;
+    }
+    late_ms = os_time_ticks_to_ms32(late);
+
+    for (b = 0; b < SENSOR_TIMING_LATE_BUCKETS - 1; b++) {
+        if (late_ms < (1UL << b)) {
+            break;
+        }
+    }
+
+    missed = 0;
+    os_time_ms_to_ticks(sensor->s_poll_rate, &period);
+    if (period) {
+        missed = late / period;
+    }
+
+    st->st_polls++;
+    st->st_missed += missed;
+    st->st_late[b]++;
+    if (late_ms > st->st_late_max_ms) {
+        st->st_late_max_ms = late_ms;
+    }
+
+    STATS_INC(g_sensor_mgr_stats, polls);
+    STATS_INCN(g_sensor_mgr_stats, missed_slots, missed);
+    switch (b) {
+    case 0:
+        STATS_INC(g_sensor_mgr_stats, late_lt1ms);
+        break;
+    case 1:
+        STATS_INC(g_sensor_mgr_stats, late_lt2ms);
+        break;
+    case 2:
+        STATS_INC(g_sensor_mgr_stats, late_lt4ms);
+        break;
+    case 3:
+        STATS_INC(g_sensor_mgr_stats, late_lt8ms);
+        break;
+    case 4:
+        STATS_INC(g_sensor_mgr_stats, late_lt16ms);
+        break;
+    case 5:
+        STATS_INC(g_sensor_mgr_stats, late_lt32ms);
+        break;
+    case 6:
+        STATS_INC(g_sensor_mgr_stats, late_lt64ms);
+        break;
+    default:
+        STATS_INC(g_sensor_mgr_stats, late_ge64ms);
+        break;
+    }
+}
+
+/* Called when sensor_read() started at cputime start completes */
+static void
+sensor_timing_read(struct sensor *sensor, uint32_t start, int rc)
+{
+    struct sensor_timing *st;
+    uint32_t total;
+    uint32_t read;
+
+    st = &sensor->s_timing;
+
+    total = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    read = total > st->st_dispatch_us_cur ? total - st->st_dispatch_us_cur : 0;
+
+    st->st_reads++;
+    st->st_read_us_total += read;
+    if (read > st->st_read_us_max) {
+        st->st_read_us_max = read;
+    }
+    st->st_dispatch_us_total += st->st_dispatch_us_cur;
+    if (st->st_dispatch_us_cur > st->st_dispatch_us_max) {
+        st->st_dispatch_us_max = st->st_dispatch_us_cur;
+    }
+
+    STATS_INC(g_sensor_mgr_stats, reads);
+    if (rc) {
+        STATS_INC(g_sensor_mgr_stats, read_errors);
+    }
+}
+
+void
+sensor_timing_clear(struct sensor *sensor)
+{
+    sensor_lock(sensor);
+    memset(&sensor->s_timing, 0, sizeof(sensor->s_timing));
+    sensor_unlock(sensor);
+}
+#endif
+
+static void
+sensor_mgr_poll_sensor(struct sensor *sensor, os_time_t now)
+{
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    sensor_timing_poll(sensor);
+#endif
+
+#if MYNEWT_VAL(SENSOR_FIFO)
+    if (sensor->s_fifo_type) {
+        /* Drain FIFO, single sample read would steal from it */
+        sensor_read_fifo(sensor, sensor->s_fifo_type, NULL, NULL);
+        return;
+    }
+#endif
+
+#if MYNEWT_VAL(SENSOR_ASYNC)
+    /*
+     * Don't wait for the bus, data is reported to listeners when read
+     * completes. If previous read is still in progress this poll is
+     * skipped. Drivers which can't do it in current mode return
+     * SYS_ENOTSUP and sensor is read the usual way.
+     */
+    if (sensor->s_funcs->sd_read_start && sensor_type_traits_empty(sensor) &&
+        sensor_read_async(sensor, sensor->s_mask, NULL, NULL) != SYS_ENOTSUP) {
+        return;
+    }
+#endif
+
+    if (sensor_type_traits_empty(sensor)) {
+        sensor_mgr_poll_bytype(sensor, sensor->s_mask, NULL, now);
+    } else {
+        sensor_poll_per_type_trait(sensor, now, 0);
+    }
+}
+
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+/* Sensors with the same key share the bus they are read over */
+static uintptr_t
+sensor_mgr_bus_key(struct sensor *sensor)
+{
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    if (sensor->s_itf.si_dev) {
+        return (uintptr_t)bus_node_get_bus(sensor->s_itf.si_dev);
+    }
+    return 0;
+#else
+    return (sensor->s_itf.si_type << 8) | sensor->s_itf.si_num;
+#endif
+}
+#endif
+
 /**
  * Event that wakes up the sensor manager, this goes through the sensor
  * list and polls any active sensors.
  *
  * @param OS event
  */
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP)
+static void
+sensor_mgr_wakeup_event(struct os_event *ev)
+{
+    struct sensor *due[MYNEWT_VAL(SENSOR_MGR_POLL_MAX)];
+    struct sensor *cursor;
+    os_time_t next_wakeup;
+    os_time_t window;
+    os_time_t now;
+    int cnt;
+    int i;
+    int j;
+
+    now = os_time_get();
+
+#if MYNEWT_VAL(SENSOR_POLL_TEST_LOG)
+    smgr_wakeup[smgr_wakeup_idx++%500] = now;
+#endif
+
+    os_time_ms_to_ticks(MYNEWT_VAL(SENSOR_MGR_POLL_COALESCE_MS), &window);
+
+    sensor_mgr_lock();
+
+    /* Take out every sensor due now or within the coalesce window */
+    cnt = 0;
+    while (sensor_mgr.mgr_poll_cnt) {
+        cursor = sensor_mgr.mgr_poll_heap[0];
+        if ((int32_t)(cursor->s_next_run - now) > (int32_t)window) {
+            break;
+        }
+        sensor_mgr_heap_remove(cursor);
+
+        /* Keep sensors on the same interface next to each other */
+        for (j = cnt; j > 0 && sensor_mgr_bus_key(due[j - 1]) >
+                               sensor_mgr_bus_key(cursor); j--) {
+            due[j] = due[j - 1];
+        }
+        due[j] = cursor;
+        cnt++;
+    }
+
+    for (i = 0; i < cnt; i++) {
+        cursor = due[i];
+
+        sensor_lock(cursor);
+        sensor_mgr_poll_sensor(cursor, now);
+        sensor_update_nextrun(cursor, now);
+        sensor_unlock(cursor);
+    }
+
+    cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+
+    sensor_mgr_unlock();
+
+    if (cursor) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    }
+}
+#else
 static void
 sensor_mgr_wakeup_event(struct os_event *ev)
 {
@@ -567,12 +996,7 @@ sensor_mgr_wakeup_event(struct os_event *ev)
             break;
         }
 
-        if (sensor_type_traits_empty(cursor)) {
-
-            sensor_mgr_poll_bytype(cursor, cursor->s_mask, NULL, now);
-        } else {
-            sensor_poll_per_type_trait(cursor, now, next_wakeup);
-        }
+        sensor_mgr_poll_sensor(cursor, now);
 
         sensor_update_nextrun(cursor, now);
 
@@ -583,6 +1007,7 @@ sensor_mgr_wakeup_event(struct os_event *ev)
 
     os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
 }
+#endif
 
 /**
  * Event that wakes up timestamp update procedure, this updates the base
@@ -850,8 +1275,20 @@ sensor_mgr_find_next_bydevname(const char *devname, struct sensor *prev_cursor)
 void
 sensor_pkg_init(void)
 {
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    int rc;
+#endif
+
     sensor_mgr_init();
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    rc = stats_init_and_reg(
+        STATS_HDR(g_sensor_mgr_stats),
+        STATS_SIZE_INIT_PARMS(g_sensor_mgr_stats, STATS_SIZE_32),
+        STATS_NAME_INIT_PARMS(sensor_mgr_stats), "sensor_mgr");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
 #if MYNEWT_VAL(SENSOR_CLI)
     sensor_shell_register();
 #endif
@@ -1164,30 +1601,432 @@ done:
     return (rc);
 }
 
+#if MYNEWT_VAL(SENSOR_FIXED)
+int
+sensor_fixed_from_data(sensor_type_t type, const void *data,
+                       struct sensor_fixed_data *out)
+{
+    const struct sensor_accel_data *sad;
+    const struct sensor_gyro_data *sgd;
+    const struct sensor_mag_data *smd;
+    const struct sensor_temp_data *std;
+    const struct sensor_press_data *spd;
+    const struct sensor_humid_data *shd;
+
+    memset(out, 0, sizeof(*out));
+
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        sad = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(sad->sad_x);
+        out->sfd_y = SENSOR_Q16_FROM_FLOAT(sad->sad_y);
+        out->sfd_z = SENSOR_Q16_FROM_FLOAT(sad->sad_z);
+        out->sfd_x_is_valid = sad->sad_x_is_valid;
+        out->sfd_y_is_valid = sad->sad_y_is_valid;
+        out->sfd_z_is_valid = sad->sad_z_is_valid;
+        break;
+    case SENSOR_TYPE_GYROSCOPE:
+        sgd = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(sgd->sgd_x);
+        out->sfd_y = SENSOR_Q16_FROM_FLOAT(sgd->sgd_y);
+        out->sfd_z = SENSOR_Q16_FROM_FLOAT(sgd->sgd_z);
+        out->sfd_x_is_valid = sgd->sgd_x_is_valid;
+        out->sfd_y_is_valid = sgd->sgd_y_is_valid;
+        out->sfd_z_is_valid = sgd->sgd_z_is_valid;
+        break;
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        smd = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(smd->smd_x);
+        out->sfd_y = SENSOR_Q16_FROM_FLOAT(smd->smd_y);
+        out->sfd_z = SENSOR_Q16_FROM_FLOAT(smd->smd_z);
+        out->sfd_x_is_valid = smd->smd_x_is_valid;
+        out->sfd_y_is_valid = smd->smd_y_is_valid;
+        out->sfd_z_is_valid = smd->smd_z_is_valid;
+        break;
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+        std = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(std->std_temp);
+        out->sfd_x_is_valid = std->std_temp_is_valid;
+        break;
+    case SENSOR_TYPE_PRESSURE:
+        /* Pa does not fit Q16.16, report hPa */
+        spd = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(spd->spd_press / 100.0f);
+        out->sfd_x_is_valid = spd->spd_press_is_valid;
+        break;
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        shd = data;
+        out->sfd_x = SENSOR_Q16_FROM_FLOAT(shd->shd_humid);
+        out->sfd_x_is_valid = shd->shd_humid_is_valid;
+        break;
+    default:
+        return SYS_ENOTSUP;
+    }
+
+    return 0;
+}
+
+/*
+ * Driver can skip float conversion only if nobody wants float data.
+ */
+static int
+sensor_fixed_only(struct sensor *sensor, sensor_type_t type)
+{
+    struct sensor_listener *listener;
+
+    SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+        if ((listener->sl_sensor_type & type) && !listener->sl_fixed_func) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int
+sensor_read_fixed_data_func(struct sensor *sensor, void *arg, void *data,
+                            sensor_type_t type)
+{
+    struct sensor_listener *listener;
+    struct sensor_read_ctx *ctx;
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    uint32_t start;
+
+    start = os_cputime_get32();
+#endif
+
+    ctx = arg;
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) == SENSOR_IGN_LISTENER) {
+        return 0;
+    }
+
+    SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+        if (listener->sl_sensor_type & type) {
+            listener->sl_fixed_func(sensor, listener->sl_arg, data, type);
+        }
+    }
+
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    sensor->s_timing.st_dispatch_us_cur +=
+        os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+#endif
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(SENSOR_FILTER)
+union sensor_filter_data {
+    struct sensor_accel_data sad;
+    struct sensor_gyro_data sgd;
+    struct sensor_mag_data smd;
+    struct sensor_temp_data std;
+    struct sensor_press_data spd;
+    struct sensor_humid_data shd;
+};
+
+static size_t
+sensor_filter_data_len(sensor_type_t type)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        return sizeof(struct sensor_accel_data);
+    case SENSOR_TYPE_GYROSCOPE:
+        return sizeof(struct sensor_gyro_data);
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        return sizeof(struct sensor_mag_data);
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+        return sizeof(struct sensor_temp_data);
+    case SENSOR_TYPE_PRESSURE:
+        return sizeof(struct sensor_press_data);
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        return sizeof(struct sensor_humid_data);
+    default:
+        return 0;
+    }
+}
+
+/* Gets pointers to filtered values of data, returns their number */
+static int
+sensor_filter_axes(sensor_type_t type, union sensor_filter_data *fd,
+                   float **axes)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        axes[0] = &fd->sad.sad_x;
+        axes[1] = &fd->sad.sad_y;
+        axes[2] = &fd->sad.sad_z;
+        return 3;
+    case SENSOR_TYPE_GYROSCOPE:
+        axes[0] = &fd->sgd.sgd_x;
+        axes[1] = &fd->sgd.sgd_y;
+        axes[2] = &fd->sgd.sgd_z;
+        return 3;
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        axes[0] = &fd->smd.smd_x;
+        axes[1] = &fd->smd.smd_y;
+        axes[2] = &fd->smd.smd_z;
+        return 3;
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+        axes[0] = &fd->std.std_temp;
+        return 1;
+    case SENSOR_TYPE_PRESSURE:
+        axes[0] = &fd->spd.spd_press;
+        return 1;
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        axes[0] = &fd->shd.shd_humid;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static float
+sensor_filter_median(const float *win, int n)
+{
+    float sorted[MYNEWT_VAL(SENSOR_FILTER_MAX_N)];
+    float v;
+    int i;
+    int j;
+
+    for (i = 0; i < n; i++) {
+        v = win[i];
+        for (j = i; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+
+    if (n & 1) {
+        return sorted[n / 2];
+    }
+    return (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+/*
+ * Filters data in place. Returns 0 if the sample should be passed to
+ * listeners, SYS_EAGAIN if it is dropped by decimation.
+ */
+static int
+sensor_filter_run(struct sensor_filter *sf, sensor_type_t type,
+                  union sensor_filter_data *fd)
+{
+    float *axes[3];
+    float sum;
+    int naxes;
+    int n;
+    int i;
+    int j;
+
+    naxes = sensor_filter_axes(type, fd, axes);
+    n = sf->sf_n;
+
+    switch (sf->sf_type) {
+    case SENSOR_FILTER_IIR:
+        for (i = 0; i < naxes; i++) {
+            if (!sf->sf_cnt) {
+                sf->sf_y[i] = *axes[i];
+            } else {
+                sf->sf_y[i] += sf->sf_alpha * (*axes[i] - sf->sf_y[i]);
+            }
+            *axes[i] = sf->sf_y[i];
+        }
+        sf->sf_cnt = 1;
+        break;
+    case SENSOR_FILTER_AVG:
+    case SENSOR_FILTER_MEDIAN:
+        for (i = 0; i < naxes; i++) {
+            sf->sf_win[i][sf->sf_pos] = *axes[i];
+        }
+        if (sf->sf_cnt < n) {
+            sf->sf_cnt++;
+        }
+        if (++sf->sf_pos == n) {
+            sf->sf_pos = 0;
+        }
+        for (i = 0; i < naxes; i++) {
+            if (sf->sf_type == SENSOR_FILTER_MEDIAN) {
+                *axes[i] = sensor_filter_median(sf->sf_win[i], sf->sf_cnt);
+            } else {
+                sum = 0;
+                for (j = 0; j < sf->sf_cnt; j++) {
+                    sum += sf->sf_win[i][j];
+                }
+                *axes[i] = sum / sf->sf_cnt;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (sf->sf_decim > 1) {
+        if (sf->sf_decim_cnt++ != 0) {
+            if (sf->sf_decim_cnt >= sf->sf_decim) {
+                sf->sf_decim_cnt = 0;
+            }
+            return SYS_EAGAIN;
+        }
+    }
+
+    return 0;
+}
+
+static struct sensor_filter *
+sensor_filter_get(struct sensor *sensor, sensor_type_t type)
+{
+    struct sensor_type_traits *stt;
+
+    SLIST_FOREACH(stt, &sensor->s_type_traits_list, stt_next) {
+        if (stt->stt_sensor_type == type) {
+            if (sensor_filter_data_len(type) &&
+                (stt->stt_filter.sf_type != SENSOR_FILTER_NONE ||
+                 stt->stt_filter.sf_decim > 1)) {
+                return &stt->stt_filter;
+            }
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+int
+sensor_set_filter(const char *devname, struct sensor_type_traits *stt)
+{
+    struct sensor_type_traits *stt_tmp;
+    struct sensor_filter *sf;
+    struct sensor *sensor;
+    int rc;
+
+    if (!stt) {
+        return SYS_EINVAL;
+    }
+
+    sf = &stt->stt_filter;
+    if (sf->sf_type > SENSOR_FILTER_MEDIAN ||
+        ((sf->sf_type == SENSOR_FILTER_AVG ||
+          sf->sf_type == SENSOR_FILTER_MEDIAN) &&
+         (!sf->sf_n || sf->sf_n > MYNEWT_VAL(SENSOR_FILTER_MAX_N))) ||
+        (sf->sf_type == SENSOR_FILTER_IIR &&
+         !(sf->sf_alpha > 0 && sf->sf_alpha <= 1))) {
+        return SYS_EINVAL;
+    }
+
+    sensor = sensor_get_type_traits_byname(devname, &stt_tmp,
+                                           stt->stt_sensor_type);
+    if (!sensor) {
+        return SYS_EINVAL;
+    }
+
+    if (!stt_tmp) {
+        stt_tmp = stt;
+        rc = sensor_insert_type_trait(sensor, stt);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    if (stt_tmp != stt) {
+        stt_tmp->stt_filter.sf_type = sf->sf_type;
+        stt_tmp->stt_filter.sf_n = sf->sf_n;
+        stt_tmp->stt_filter.sf_decim = sf->sf_decim;
+        stt_tmp->stt_filter.sf_alpha = sf->sf_alpha;
+    }
+    stt_tmp->stt_filter.sf_cnt = 0;
+    stt_tmp->stt_filter.sf_pos = 0;
+    stt_tmp->stt_filter.sf_decim_cnt = 0;
+
+    sensor_unlock(sensor);
+
+    return 0;
+}
+#endif
+
+static int
+sensor_listener_call(struct sensor *sensor, struct sensor_listener *listener,
+                     void *data, sensor_type_t type)
+{
+#if MYNEWT_VAL(SENSOR_FIXED)
+    struct sensor_fixed_data sfd;
+
+    if (listener->sl_fixed_func) {
+        if (sensor_fixed_from_data(type, data, &sfd)) {
+            return 0;
+        }
+        return listener->sl_fixed_func(sensor, listener->sl_arg, &sfd, type);
+    }
+#endif
+
+    return listener->sl_func(sensor, listener->sl_arg, data, type);
+}
+
 static int
 sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
                       sensor_type_t type)
 {
     struct sensor_listener *listener;
     struct sensor_read_ctx *ctx;
+    int rc;
+    void *ldata;
+#if MYNEWT_VAL(SENSOR_FILTER)
+    union sensor_filter_data fd;
+    struct sensor_filter *sf;
+#endif
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    uint32_t start;
+
+    start = os_cputime_get32();
+#endif
 
     ctx = (struct sensor_read_ctx *) arg;
 
     if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        ldata = data;
+#if MYNEWT_VAL(SENSOR_FILTER)
+        /* Listeners get filtered data, user callback the sample read */
+        sf = sensor_filter_get(sensor, type);
+        if (sf) {
+            memcpy(&fd, data, sensor_filter_data_len(type));
+            ldata = sensor_filter_run(sf, type, &fd) ? NULL : &fd;
+        }
+#endif
+
         /* Notify all listeners first */
         SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
-            if (listener->sl_sensor_type & type) {
-                listener->sl_func(sensor, listener->sl_arg, data, type);
+            if (ldata && (listener->sl_sensor_type & type)) {
+                sensor_listener_call(sensor, listener, ldata, type);
             }
         }
     }
 
+    rc = 0;
+
     /* Call data function */
     if (ctx->user_func != NULL) {
-        return (ctx->user_func(sensor, ctx->user_arg, data, type));
+        rc = ctx->user_func(sensor, ctx->user_arg, data, type);
     }
 
-    return (0);
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    sensor->s_timing.st_dispatch_us_cur +=
+        os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+#endif
+
+    return (rc);
 }
 
 /**
@@ -1245,6 +2084,52 @@ sensor_mgr_put_read_evt(void *arg)
     os_eventq_put(sensor_mgr_evq_get(), &sensor_read_event);
 }
 
+#if MYNEWT_VAL(SENSOR_FIFO)
+void
+sensor_mgr_put_fifo_evt(struct sensor *sensor)
+{
+    sensor->s_fifo_evt.ev_arg = sensor;
+    sensor->s_fifo_evt.ev_cb = sensor_fifo_ev_cb;
+    os_eventq_put(sensor_mgr_evq_get(), &sensor->s_fifo_evt);
+}
+
+static void
+sensor_fifo_ev_cb(struct os_event *ev)
+{
+    struct sensor *sensor;
+
+    sensor = ev->ev_arg;
+
+    if (sensor->s_fifo_type) {
+        sensor_read_fifo(sensor, sensor->s_fifo_type, NULL, NULL);
+    }
+}
+#endif
+
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+void
+sensor_mgr_put_trigger_evt(struct sensor_type_traits *stt)
+{
+    stt->stt_trig_evt.ev_arg = stt;
+    stt->stt_trig_evt.ev_cb = sensor_trigger_ev_cb;
+    os_eventq_put(sensor_mgr_evq_get(), &stt->stt_trig_evt);
+}
+
+static void
+sensor_trigger_ev_cb(struct os_event *ev)
+{
+    struct sensor_type_traits *stt;
+
+    stt = ev->ev_arg;
+
+    /* Hardware already did the compare, let sensor_generate_trig() know */
+    stt->stt_hw_pending = 1;
+    sensor_read(stt->stt_sensor, stt->stt_sensor_type, NULL, NULL,
+                OS_TIMEOUT_NEVER);
+    stt->stt_hw_pending = 0;
+}
+#endif
+
 static void
 sensor_interrupt_ev_cb(struct os_event *ev)
 {
@@ -2007,6 +2892,24 @@ sensor_set_thresh(const char *devname, struct sensor_type_traits *stt)
         goto err;
     }
 
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+    stt_tmp->stt_hw_thresh = 0;
+    if (sensor->s_funcs->sd_offload_thresh) {
+        rc = sensor->s_funcs->sd_offload_thresh(sensor,
+                                                stt_tmp->stt_sensor_type,
+                                                stt_tmp);
+        if (rc == 0) {
+            stt_tmp->stt_hw_thresh = 1;
+            sensor_unlock(sensor);
+            return 0;
+        } else if (rc != SYS_ENOTSUP) {
+            sensor_unlock(sensor);
+            goto err;
+        }
+        /* Hardware can't do it, compare in software */
+    }
+#endif
+
     if (sensor->s_funcs->sd_set_trigger_thresh) {
         rc = sensor->s_funcs->sd_set_trigger_thresh(sensor,
                                                     stt_tmp->stt_sensor_type,
@@ -2126,6 +3029,14 @@ sensor_generate_trig(struct sensor *sensor,
 
     tx_trigger = 0;
 
+#if MYNEWT_VAL(SENSOR_THRESH_OFFLOAD)
+    if (stt->stt_hw_thresh) {
+        tx_trigger = stt->stt_hw_pending;
+        stt->stt_hw_pending = 0;
+        return tx_trigger ? notify(sensor, data, type) : 0;
+    }
+#endif
+
     memcpy(&low_thresh, &stt->stt_low_thresh, sizeof(low_thresh));
     memcpy(&high_thresh, &stt->stt_high_thresh, sizeof(high_thresh));
 
@@ -2182,6 +3093,9 @@ sensor_read(struct sensor *sensor, sensor_type_t type,
 {
     struct sensor_read_ctx src;
     int rc;
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    uint32_t start;
+#endif
 
     rc = sensor_lock(sensor);
     if (rc) {
@@ -2198,8 +3112,24 @@ sensor_read(struct sensor *sensor, sensor_type_t type,
 
     sensor_up_timestamp(sensor);
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    sensor->s_timing.st_dispatch_us_cur = 0;
+    start = os_cputime_get32();
+#endif
+
+#if MYNEWT_VAL(SENSOR_FIXED)
+    if (!data_func && sensor->s_funcs->sd_read_fixed &&
+        sensor_fixed_only(sensor, type)) {
+        rc = sensor->s_funcs->sd_read_fixed(sensor, type,
+                                            sensor_read_fixed_data_func,
+                                            &src, timeout);
+    } else
+#endif
     rc = sensor->s_funcs->sd_read(sensor, type, sensor_read_data_func, &src,
                                   timeout);
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    sensor_timing_read(sensor, start, rc);
+#endif
     if (rc) {
         if (sensor->s_err_fn != NULL) {
             sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
@@ -2212,6 +3142,195 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(SENSOR_ASYNC)
+void
+sensor_mgr_put_read_done_evt(struct sensor *sensor, int status)
+{
+    sensor->s_async_rc = status;
+    sensor->s_read_done_evt.ev_arg = sensor;
+    sensor->s_read_done_evt.ev_cb = sensor_read_done_ev_cb;
+    os_eventq_put(sensor_mgr_evq_get(), &sensor->s_read_done_evt);
+}
+
+static void
+sensor_read_done_ev_cb(struct os_event *ev)
+{
+    struct sensor_read_ctx src;
+    struct sensor *sensor;
+    sensor_type_t type;
+    int rc;
+
+    sensor = ev->ev_arg;
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return;
+    }
+
+    type = sensor->s_async_type;
+    if (!type) {
+        goto done;
+    }
+
+    src.user_func = sensor->s_async_func;
+    src.user_arg = sensor->s_async_arg;
+
+    rc = sensor->s_async_rc;
+    if (rc == 0) {
+        sensor_up_timestamp(sensor);
+        rc = sensor->s_funcs->sd_read_finish(sensor, type,
+                                             sensor_read_data_func, &src);
+    }
+
+    /* Read is complete, next one can be started from data callbacks */
+    sensor->s_async_type = 0;
+
+    if (rc && sensor->s_err_fn != NULL) {
+        sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+    }
+
+done:
+    sensor_unlock(sensor);
+}
+
+int
+sensor_read_async(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg)
+{
+    int rc;
+
+    if (!sensor->s_funcs->sd_read_start || !sensor->s_funcs->sd_read_finish) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
+        rc = SYS_ENOENT;
+        goto done;
+    }
+
+    if (sensor->s_async_type) {
+        rc = SYS_EBUSY;
+        goto done;
+    }
+
+    sensor->s_async_func = data_func;
+    sensor->s_async_arg = arg;
+    sensor->s_async_type = type;
+
+    rc = sensor->s_funcs->sd_read_start(sensor, type);
+    if (rc) {
+        sensor->s_async_type = 0;
+        if (rc != SYS_ENOTSUP && sensor->s_err_fn != NULL) {
+            sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+        }
+    }
+
+done:
+    sensor_unlock(sensor);
+    return rc;
+}
+#endif
+
+#if MYNEWT_VAL(SENSOR_FIFO)
+struct sensor_read_fifo_ctx {
+    sensor_batch_func_t user_func;
+    void *user_arg;
+};
+
+static int
+sensor_read_batch_func(struct sensor *sensor, void *arg,
+                       const struct sensor_batch *batch)
+{
+    struct sensor_read_fifo_ctx *ctx = arg;
+    struct sensor_listener *listener;
+    int i;
+
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+            if (!(listener->sl_sensor_type & batch->sb_type)) {
+                continue;
+            }
+            if (listener->sl_batch_func) {
+                listener->sl_batch_func(sensor, listener->sl_arg, batch);
+                continue;
+            }
+            /* No batch handler, deliver samples one by one */
+            for (i = 0; i < batch->sb_count; i++) {
+                sensor_listener_call(sensor, listener,
+                                     sensor_batch_sample(batch, i),
+                                     batch->sb_type);
+            }
+        }
+    }
+
+    if (ctx->user_func != NULL) {
+        return ctx->user_func(sensor, ctx->user_arg, batch);
+    }
+
+    return 0;
+}
+
+int
+sensor_read_fifo(struct sensor *sensor, sensor_type_t type,
+                 sensor_batch_func_t batch_func, void *arg)
+{
+    struct sensor_read_fifo_ctx ctx;
+    int rc;
+
+    if (!sensor->s_funcs->sd_read_fifo) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    ctx.user_func = batch_func;
+    ctx.user_arg = arg;
+
+    sensor_up_timestamp(sensor);
+
+    rc = sensor->s_funcs->sd_read_fifo(sensor, type, sensor_read_batch_func,
+                                       &ctx);
+    if (rc && sensor->s_err_fn != NULL) {
+        sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+    }
+
+    sensor_unlock(sensor);
+    return rc;
+}
+
+int
+sensor_set_fifo(struct sensor *sensor, sensor_type_t type,
+                uint16_t watermark)
+{
+    int rc;
+
+    if (!sensor->s_funcs->sd_set_fifo) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    rc = sensor->s_funcs->sd_set_fifo(sensor, type, watermark);
+    if (rc == 0) {
+        sensor->s_fifo_type = watermark ? type : 0;
+    }
+
+    sensor_unlock(sensor);
+    return rc;
+}
+#endif
+
 /**
  * Reset sensor
  *
@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <assert.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_REGMAP)
+
+#include "sensor/regmap.h"
+
+static int
+sensor_regmap_idx(const struct sensor_regmap *rm, int reg)
+{
+    const struct sensor_regmap_desc *desc = rm->sr_desc;
+    int idx;
+
+    idx = reg - desc->srd_first;
+    if (idx < 0 || idx >= desc->srd_count) {
+        return -1;
+    }
+    if (desc->srd_volatile &&
+        (desc->srd_volatile[idx / 8] & (1 << (idx % 8)))) {
+        return -1;
+    }
+
+    return idx;
+}
+
+static bool
+sensor_regmap_is_valid(const struct sensor_regmap *rm, int idx)
+{
+    return idx >= 0 && (rm->sr_valid[idx / 8] & (1 << (idx % 8)));
+}
+
+static bool
+sensor_regmap_is_same(const struct sensor_regmap *rm, int reg, uint8_t val)
+{
+    int idx;
+
+    idx = sensor_regmap_idx(rm, reg);
+
+    return sensor_regmap_is_valid(rm, idx) && rm->sr_cache[idx] == val;
+}
+
+/*
+ * Record the result of a bus access of registers reg..reg+len-1.  On
+ * failure the device state of the whole range is unknown.
+ */
+static void
+sensor_regmap_fill(struct sensor_regmap *rm, int reg, const uint8_t *buf,
+                   int len, int rc)
+{
+    int idx;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        idx = sensor_regmap_idx(rm, reg + i);
+        if (idx < 0) {
+            continue;
+        }
+        if (rc) {
+            rm->sr_valid[idx / 8] &= ~(1 << (idx % 8));
+        } else {
+            rm->sr_cache[idx] = buf[i];
+            rm->sr_valid[idx / 8] |= 1 << (idx % 8);
+        }
+    }
+}
+
+static int
+sensor_regmap_burst(const struct sensor_regmap *rm)
+{
+    int burst;
+
+    burst = rm->sr_desc->srd_max_burst;
+
+    return burst ? burst : UINT8_MAX;
+}
+
+static int
+sensor_regmap_bus_write(struct sensor_regmap *rm, int reg, const uint8_t *buf,
+                        int len)
+{
+    int burst;
+    int chunk;
+    int rc;
+
+    burst = sensor_regmap_burst(rm);
+
+    while (len) {
+        chunk = min(len, burst);
+        rc = rm->sr_desc->srd_write(rm->sr_arg, reg, buf, chunk);
+        sensor_regmap_fill(rm, reg, buf, chunk, rc);
+        if (rc) {
+            return rc;
+        }
+        reg += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+void
+sensor_regmap_init(struct sensor_regmap *rm,
+                   const struct sensor_regmap_desc *desc, void *arg,
+                   uint8_t *cache, uint8_t *valid)
+{
+    rm->sr_desc = desc;
+    rm->sr_arg = arg;
+    rm->sr_cache = cache;
+    rm->sr_valid = valid;
+
+    sensor_regmap_invalidate(rm);
+}
+
+void
+sensor_regmap_invalidate(struct sensor_regmap *rm)
+{
+    memset(rm->sr_valid, 0, SENSOR_REGMAP_VALID_SIZE(rm->sr_desc->srd_count));
+}
+
+int
+sensor_regmap_read(struct sensor_regmap *rm, uint8_t reg, uint8_t *buf,
+                   uint8_t len)
+{
+    int burst;
+    int chunk;
+    int idx;
+    int off;
+    int rc;
+
+    for (off = 0; off < len; off++) {
+        idx = sensor_regmap_idx(rm, reg + off);
+        if (!sensor_regmap_is_valid(rm, idx)) {
+            break;
+        }
+        buf[off] = rm->sr_cache[idx];
+    }
+    if (off == len) {
+        return 0;
+    }
+
+    burst = sensor_regmap_burst(rm);
+
+    for (off = 0; off < len; off += chunk) {
+        chunk = min(len - off, burst);
+        rc = rm->sr_desc->srd_read(rm->sr_arg, reg + off, buf + off, chunk);
+        if (rc) {
+            return rc;
+        }
+        sensor_regmap_fill(rm, reg + off, buf + off, chunk, 0);
+    }
+
+    return 0;
+}
+
+int
+sensor_regmap_write(struct sensor_regmap *rm, uint8_t reg,
+                    const uint8_t *buf, uint8_t len)
+{
+    int start;
+    int end;
+
+    for (start = 0; start < len; start++) {
+        if (!sensor_regmap_is_same(rm, reg + start, buf[start])) {
+            break;
+        }
+    }
+    if (start == len) {
+        return 0;
+    }
+
+    for (end = len; end > start; end--) {
+        if (!sensor_regmap_is_same(rm, reg + end - 1, buf[end - 1])) {
+            break;
+        }
+    }
+
+    return sensor_regmap_bus_write(rm, reg + start, buf + start, end - start);
+}
+
+int
+sensor_regmap_update(struct sensor_regmap *rm, uint8_t reg, uint8_t mask,
+                     uint8_t val)
+{
+    uint8_t tmp;
+    int rc;
+
+    rc = sensor_regmap_read(rm, reg, &tmp, 1);
+    if (rc) {
+        return rc;
+    }
+
+    tmp = (tmp & ~mask) | (val & mask);
+
+    return sensor_regmap_write(rm, reg, &tmp, 1);
+}
+
+int
+sensor_regmap_write_multi(struct sensor_regmap *rm,
+                          const struct sensor_regmap_val *vals, int cnt)
+{
+    uint8_t buf[MYNEWT_VAL(SENSOR_REGMAP_BURST_MAX)];
+    int burst;
+    int first;
+    int len;
+    int rc;
+    int i;
+
+    burst = min(sensor_regmap_burst(rm), (int)sizeof(buf));
+    first = 0;
+    len = 0;
+
+    for (i = 0; i < cnt; i++) {
+        if (sensor_regmap_is_same(rm, vals[i].srv_reg, vals[i].srv_val)) {
+            continue;
+        }
+        if (len && (vals[i].srv_reg != first + len || len == burst)) {
+            rc = sensor_regmap_bus_write(rm, first, buf, len);
+            if (rc) {
+                return rc;
+            }
+            len = 0;
+        }
+        if (len == 0) {
+            first = vals[i].srv_reg;
+        }
+        buf[len++] = vals[i].srv_val;
+    }
+
+    if (len) {
+        return sensor_regmap_bus_write(rm, first, buf, len);
+    }
+
+    return 0;
+}
+
+#endif
@@ -81,6 +81,10 @@ sensor_display_help(void)
     console_printf("  type <sensor_name>\n");
     console_printf("      types supported by registered sensor\n");
     console_printf("  notify <sensor_name> [on/off] <type>\n");
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    console_printf("  timing <sensor_name> [clear]\n");
+    console_printf("      poll lateness, missed polls, read and listener time\n");
+#endif
 }
 
 static void
@@ -1004,6 +1008,56 @@ done:
     return rc;
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+static int
+sensor_cmd_timing(int argc, char **argv)
+{
+    const struct sensor_timing *st;
+    struct sensor *sensor;
+    int i;
+
+    if (argc < 3) {
+        console_printf("Usage: sensor timing <sensor_name> [clear]\n");
+        return SYS_EINVAL;
+    }
+
+    sensor = sensor_mgr_find_next_bydevname(argv[2], NULL);
+    if (!sensor) {
+        console_printf("Sensor %s not found!\n", argv[2]);
+        return SYS_EINVAL;
+    }
+
+    if (argc > 3 && !strcmp(argv[3], "clear")) {
+        sensor_timing_clear(sensor);
+        return 0;
+    }
+
+    st = &sensor->s_timing;
+
+    console_printf("polls: %lu, missed: %lu, late max: %lu ms\n",
+                   (unsigned long)st->st_polls, (unsigned long)st->st_missed,
+                   (unsigned long)st->st_late_max_ms);
+    console_printf("late:");
+    for (i = 0; i < SENSOR_TIMING_LATE_BUCKETS - 1; i++) {
+        console_printf(" <%dms:%lu", 1 << i, (unsigned long)st->st_late[i]);
+    }
+    console_printf(" >=%dms:%lu\n", 1 << (SENSOR_TIMING_LATE_BUCKETS - 2),
+                   (unsigned long)st->st_late[i]);
+    console_printf("reads: %lu\n", (unsigned long)st->st_reads);
+    if (st->st_reads) {
+        console_printf("read us: avg %lu, max %lu\n",
+                       (unsigned long)(st->st_read_us_total / st->st_reads),
+                       (unsigned long)st->st_read_us_max);
+        console_printf("listener us: avg %lu, max %lu\n",
+                       (unsigned long)(st->st_dispatch_us_total /
+                                       st->st_reads),
+                       (unsigned long)st->st_dispatch_us_max);
+    }
+
+    return 0;
+}
+#endif
+
 static int
 sensor_cmd_exec(int argc, char **argv)
 {
@@ -1054,6 +1108,13 @@ sensor_cmd_exec(int argc, char **argv)
                            argc - 2);
            goto done;
         }
+#if MYNEWT_VAL(SENSOR_MGR_TIMING)
+    } else if (!strcmp(argv[1], "timing")) {
+        rc = sensor_cmd_timing(argc, argv);
+        if (rc) {
+            goto done;
+        }
+#endif
     } else if (!strcmp(argv[1], "read_stop")) {
         if (!g_spd.spd_read_in_progress) {
             console_printf("No read in progress\n");
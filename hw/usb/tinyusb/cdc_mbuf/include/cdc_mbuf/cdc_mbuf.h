@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __CDC_MBUF_H__
+#define __CDC_MBUF_H__
+
+#include <stdbool.h>
+#include <os/os.h>
+#include <cdc/cdc.h>
+
+struct cdc_mbuf;
+
+/**
+ * Called from transport event queue with data received from host.
+ * Data is not framed, one call delivers whatever was read from the
+ * endpoint FIFO.  The mbuf (packet header mbuf) is owned by the callee.
+ */
+typedef void cdc_mbuf_rx_fn(struct cdc_mbuf *cm, struct os_mbuf *om);
+
+/**
+ * CDC interface that moves data in mbufs.
+ *
+ * Outgoing packets are copied to the endpoint FIFO a whole mbuf at a time
+ * and flushed when FIFO is full or the queue is drained, so bulk
+ * transfers carry full packets.  tinyusb terminates transfers that end
+ * on packet boundary with a ZLP.  Received data is read from the FIFO
+ * directly into mbufs.
+ */
+struct cdc_mbuf {
+    /* CDC interface, keep first in struct */
+    cdc_itf_t cm_itf;
+    struct os_eventq *cm_evq;
+    cdc_mbuf_rx_fn *cm_rx_cb;
+    struct os_event cm_tx_ev;
+    struct os_event cm_rx_ev;
+    /* Retries reading when no mbuf was available */
+    struct os_callout cm_rx_retry;
+    /* Packets waiting for transmission */
+    STAILQ_HEAD(, os_mbuf_pkthdr) cm_tx_q;
+    /* Mbuf being copied to endpoint FIFO and offset in it */
+    struct os_mbuf *cm_tx_om;
+    uint16_t cm_tx_off;
+    bool cm_connected;
+};
+
+/**
+ * Register CDC interface that transfers data in mbufs.
+ *
+ * Must be called before USB stack is started, interface number is
+ * assigned in registration order like for other CDC functions.
+ *
+ * @param cm - Transport state.
+ * @param evq - Event queue where transmission and receive callback run.
+ * @param rx_cb - Function receiving data from host.
+ *
+ * @return 0 on success
+ */
+int cdc_mbuf_init(struct cdc_mbuf *cm, struct os_eventq *evq, cdc_mbuf_rx_fn *rx_cb);
+
+/**
+ * Queue packet for transmission to host.
+ *
+ * The mbuf is always consumed.  Packets are dropped when host has not
+ * opened the port (DTR not set).
+ *
+ * @param cm - Transport state.
+ * @param om - Packet header mbuf chain to send.
+ *
+ * @return 0 on success, SYS_EAGAIN when host is not connected.
+ */
+int cdc_mbuf_tx(struct cdc_mbuf *cm, struct os_mbuf *om);
+
+#endif /* __CDC_MBUF_H__ */
@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <os/mynewt.h>
+#include <defs/error.h>
+#include <class/cdc/cdc_device.h>
+#include <cdc_mbuf/cdc_mbuf.h>
+
+static const struct cdc_callbacks cdc_mbuf_callbacks;
+
+static void
+cdc_mbuf_tx_drop(struct cdc_mbuf *cm)
+{
+    struct os_mbuf_pkthdr *mp;
+    int sr;
+
+    os_mbuf_free_chain(cm->cm_tx_om);
+    cm->cm_tx_om = NULL;
+    cm->cm_tx_off = 0;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        mp = STAILQ_FIRST(&cm->cm_tx_q);
+        if (mp) {
+            STAILQ_REMOVE_HEAD(&cm->cm_tx_q, omp_next);
+        }
+        OS_EXIT_CRITICAL(sr);
+        if (mp == NULL) {
+            break;
+        }
+        os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(mp));
+    }
+}
+
+/*
+ * Copy queued mbufs to endpoint FIFO.  Each mbuf is written with one
+ * call, the FIFO is flushed when it does not accept more data and once
+ * more when queue is empty.  Transmission continues from tx complete
+ * callback.
+ */
+static void
+cdc_mbuf_tx_ev_cb(struct os_event *ev)
+{
+    struct cdc_mbuf *cm = ev->ev_arg;
+    uint8_t itf = cm->cm_itf.cdc_num;
+    struct os_mbuf_pkthdr *mp;
+    struct os_mbuf *om;
+    uint32_t written;
+    uint16_t len;
+    int sr;
+
+    if (!cm->cm_connected) {
+        cdc_mbuf_tx_drop(cm);
+        return;
+    }
+
+    while (1) {
+        if (cm->cm_tx_om == NULL) {
+            OS_ENTER_CRITICAL(sr);
+            mp = STAILQ_FIRST(&cm->cm_tx_q);
+            if (mp) {
+                STAILQ_REMOVE_HEAD(&cm->cm_tx_q, omp_next);
+            }
+            OS_EXIT_CRITICAL(sr);
+            if (mp == NULL) {
+                break;
+            }
+            cm->cm_tx_om = OS_MBUF_PKTHDR_TO_MBUF(mp);
+            cm->cm_tx_off = 0;
+        }
+
+        om = cm->cm_tx_om;
+        len = om->om_len - cm->cm_tx_off;
+        if (len) {
+            written = tud_cdc_n_write(itf, om->om_data + cm->cm_tx_off, len);
+            cm->cm_tx_off += written;
+            if (written < len) {
+                /* FIFO full, send it and wait for tx complete */
+                tud_cdc_n_write_flush(itf);
+                return;
+            }
+        }
+        cm->cm_tx_om = SLIST_NEXT(om, om_next);
+        cm->cm_tx_off = 0;
+        os_mbuf_free(om);
+    }
+
+    tud_cdc_n_write_flush(itf);
+}
+
+static void
+cdc_mbuf_rx_ev_cb(struct os_event *ev)
+{
+    struct cdc_mbuf *cm = ev->ev_arg;
+    uint8_t itf = cm->cm_itf.cdc_num;
+    struct os_mbuf *om;
+    uint32_t avail;
+    uint32_t len;
+
+    while ((avail = tud_cdc_n_available(itf)) > 0) {
+        om = os_msys_get_pkthdr(min(avail, UINT16_MAX), 0);
+        if (om == NULL) {
+            os_callout_reset(&cm->cm_rx_retry, MYNEWT_VAL(CDC_MBUF_RX_RETRY_TICKS));
+            return;
+        }
+        len = tud_cdc_n_read(itf, om->om_data, min(avail, OS_MBUF_TRAILINGSPACE(om)));
+        om->om_len = len;
+        OS_MBUF_PKTHDR(om)->omp_len = len;
+        if (cm->cm_rx_cb) {
+            cm->cm_rx_cb(cm, om);
+        } else {
+            os_mbuf_free_chain(om);
+        }
+    }
+}
+
+static void
+cdc_mbuf_rx_cb(cdc_itf_t *itf)
+{
+    struct cdc_mbuf *cm = (struct cdc_mbuf *)itf;
+
+    os_eventq_put(cm->cm_evq, &cm->cm_rx_ev);
+}
+
+static void
+cdc_mbuf_tx_complete_cb(cdc_itf_t *itf)
+{
+    struct cdc_mbuf *cm = (struct cdc_mbuf *)itf;
+
+    if (cm->cm_tx_om || !STAILQ_EMPTY(&cm->cm_tx_q)) {
+        os_eventq_put(cm->cm_evq, &cm->cm_tx_ev);
+    }
+}
+
+static void
+cdc_mbuf_line_state_cb(cdc_itf_t *itf, bool dtr, bool rts)
+{
+    struct cdc_mbuf *cm = (struct cdc_mbuf *)itf;
+
+    (void)rts;
+
+    if (dtr != cm->cm_connected) {
+        cm->cm_connected = dtr;
+        /* Sends pending data or drops it when port was closed */
+        os_eventq_put(cm->cm_evq, &cm->cm_tx_ev);
+    }
+}
+
+int
+cdc_mbuf_tx(struct cdc_mbuf *cm, struct os_mbuf *om)
+{
+    int sr;
+
+    assert(OS_MBUF_IS_PKTHDR(om));
+
+    if (!cm->cm_connected) {
+        os_mbuf_free_chain(om);
+        return SYS_EAGAIN;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&cm->cm_tx_q, OS_MBUF_PKTHDR(om), omp_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(cm->cm_evq, &cm->cm_tx_ev);
+
+    return 0;
+}
+
+int
+cdc_mbuf_init(struct cdc_mbuf *cm, struct os_eventq *evq, cdc_mbuf_rx_fn *rx_cb)
+{
+    memset(cm, 0, sizeof(*cm));
+
+    cm->cm_itf.callbacks = &cdc_mbuf_callbacks;
+    cm->cm_evq = evq;
+    cm->cm_rx_cb = rx_cb;
+    STAILQ_INIT(&cm->cm_tx_q);
+    cm->cm_tx_ev.ev_cb = cdc_mbuf_tx_ev_cb;
+    cm->cm_tx_ev.ev_arg = cm;
+    cm->cm_rx_ev.ev_cb = cdc_mbuf_rx_ev_cb;
+    cm->cm_rx_ev.ev_arg = cm;
+    os_callout_init(&cm->cm_rx_retry, evq, cdc_mbuf_rx_ev_cb, cm);
+
+    cdc_itf_add(&cm->cm_itf);
+
+    return 0;
+}
+
+static const struct cdc_callbacks cdc_mbuf_callbacks = {
+    .cdc_rx_cb = cdc_mbuf_rx_cb,
+    .cdc_line_state_cb = cdc_mbuf_line_state_cb,
+    .cdc_tx_complete_cb = cdc_mbuf_tx_complete_cb,
+};
@@ -46,6 +46,13 @@ typedef struct file_entry {
     /** Function called when host tries to read file sector */
     void (*read_sector)(const struct file_entry *entry,
                         uint32_t file_sector, uint8_t buffer[512]);
+    /**
+     * Optional function called when host reads several consecutive file
+     * sectors, lets entries backed by flash use one large read instead of
+     * calling read_sector for each sector.
+     */
+    void (*read_sectors)(const struct file_entry *entry,
+                         uint32_t file_sector, uint32_t count, uint8_t *buffer);
     /** Function called when host tries to write file sector */
     void (*write_sector)(const struct file_entry *entry,
                          uint32_t file_sector, uint8_t buffer[512]);
@@ -58,4 +58,23 @@ slot0_img_read(const struct file_entry *entry, uint32_t file_sector, uint8_t buf
     }
 }
 
-ROOT_DIR_ENTRY(slot0, "FIRMWARE.IMG", FAT_FILE_ENTRY_ATTRIBUTE_READ_ONLY, slot0_img_size, slot0_img_read, NULL, NULL, NULL);
+static void
+slot0_img_read_sectors(const struct file_entry *entry, uint32_t file_sector, uint32_t count, uint8_t *buffer)
+{
+    const struct flash_area *fa;
+    (void)entry;
+
+    if (0 == flash_area_open(FLASH_AREA_IMAGE_0, &fa)) {
+        flash_area_read(fa, file_sector * 512, buffer, count * 512);
+        flash_area_close(fa);
+    }
+}
+
+file_entry_t slot0 = {
+    .name = "FIRMWARE.IMG",
+    .attributes = FAT_FILE_ENTRY_ATTRIBUTE_READ_ONLY,
+    .size = slot0_img_size,
+    .read_sector = slot0_img_read,
+    .read_sectors = slot0_img_read_sectors,
+};
+const file_entry_t *slot0_ptr ROOT_DIR_SECTION = &slot0;
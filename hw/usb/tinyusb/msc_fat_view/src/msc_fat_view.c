@@ -377,6 +377,32 @@ cluster_count_from_bytes(uint32_t file_size)
     return 1 + (file_size - 1) / CLUSTER_SIZE;
 }
 
+/*
+ * Return first chain that does not end before cluster.
+ *
+ * fat_chains are kept sorted by first cluster and do not overlap, so
+ * binary search can be used. Returned chain may start after cluster
+ * (cluster is free), or be the limit if there is no such chain.
+ */
+static fat_chain_t *
+fat_chain_lower_bound(cluster_t cluster)
+{
+    fat_chain_t *chain = fat_chains;
+    int count = fat_chain_count;
+    int half;
+
+    while (count > 0) {
+        half = count / 2;
+        if (cluster >= chain[half].first + chain[half].count) {
+            chain += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return chain;
+}
+
 static fat_chain_t *
 fat_chain_find(cluster_t cluster)
 {
@@ -384,14 +410,9 @@ fat_chain_find(cluster_t cluster)
     fat_chain_t *chain;
 
     MSC_FAT_VIEW_LOG_DEBUG("fat_chain_find(%d)\n", cluster);
-    for (chain = fat_chains; chain < limit; ++chain) {
-        MSC_FAT_VIEW_LOG_DEBUG("chain %d %d-%d\n", chain - fat_chains, chain->first, chain->first + chain->count - 1);
-        if (cluster >= chain->first + chain->count) {
-            continue;
-        }
-        return (cluster < (chain->first + chain->count)) ? chain : NULL;
-    }
-    return NULL;
+    chain = fat_chain_lower_bound(cluster);
+
+    return (chain < limit && cluster >= chain->first) ? chain : NULL;
 }
 
 static void
@@ -468,7 +489,7 @@ fat_modify_next_cluster(cluster_t cluster, cluster_t next_cluster, fat_chain_t *
     fat_chain_t *chain = *cache;
 
     if (chain == NULL) {
-        chain = fat_chains;
+        chain = fat_chain_lower_bound(cluster);
     }
     /* Skip chains that end before */
     while (chain < limit && chain->first + chain->count <= cluster) {
@@ -651,22 +672,33 @@ msc_fat_view_find_dir_entry(const char *name)
     return NULL;
 }
 
+/*
+ * Find root entry that owns cluster.
+ *
+ * cluster_in_chain receives cluster index relative to the chain start,
+ * clusters_left (if not NULL) number of clusters from cluster to the end
+ * of the chain, or up to the next allocated chain if cluster is free.
+ */
 static dir_entry_t *
-msc_fat_view_dir_entry_from_cluster(cluster_t cluster, cluster_t *cluster_in_chain)
+msc_fat_view_dir_entry_from_cluster(cluster_t cluster, cluster_t *cluster_in_chain, cluster_t *clusters_left)
 {
     int i;
-    fat_chain_t *chain = fat_chains;
+    fat_chain_t *chain;
     fat_chain_t *limit = fat_chains + fat_chain_count;
 
-    while (chain < limit && cluster >= chain->first + chain->count) {
-        ++chain;
-    }
+    chain = fat_chain_lower_bound(cluster);
     if (chain >= limit || chain->first > cluster) {
         *cluster_in_chain = 0;
+        if (clusters_left) {
+            *clusters_left = (chain < limit) ? chain->first - cluster : CLUSTER_COUNT + 2 - cluster;
+        }
         return NULL;
     }
     /* TODO: find previous chain */
     *cluster_in_chain = cluster - chain->first;
+    if (clusters_left) {
+        *clusters_left = chain->first + chain->count - cluster;
+    }
     for (i = 0; i < root_dir_entry_count; ++i) {
         if (root_dir[i].first_cluster == chain->first) {
             return &root_dir[i];
@@ -758,10 +790,10 @@ msc_fat_view_fat_next_cluster(cluster_t cluster, fat_chain_t **cache)
 
     chain = *cache;
     if (chain == NULL) {
-        chain = fat_chains;
+        chain = fat_chain_lower_bound(cluster);
     }
     /* Skip chains that end before cluster */
-    while (cluster >= chain->first + chain->count) {
+    while (chain < limit && cluster >= chain->first + chain->count) {
         ++chain;
     }
     /*
@@ -1005,7 +1037,7 @@ msc_fat_view_read_sector(uint32_t sector, uint8_t buffer[512])
         msc_fat_view_read_root_sector(sector - FAT_SECTOR_COUNT - 1, buffer);
     } else {
         sector_to_cluster(sector, &cluster, &sector_in_cluster);
-        dir_entry = msc_fat_view_dir_entry_from_cluster(cluster, &cluster_in_chain);
+        dir_entry = msc_fat_view_dir_entry_from_cluster(cluster, &cluster_in_chain, NULL);
         if (dir_entry) {
             dir_entry->file->read_sector(dir_entry->file, sector_in_cluster + cluster_in_chain * SECTORS_PER_CLUSTER,
                                          buffer);
@@ -1015,6 +1047,48 @@ msc_fat_view_read_sector(uint32_t sector, uint8_t buffer[512])
     }
 }
 
+/*
+ * Read count consecutive sectors.
+ *
+ * Data sectors that belong to one continuous chain of a file are passed
+ * to the file in one read_sectors call if the file provides it.
+ * Returns number of sectors read.
+ */
+static uint32_t
+msc_fat_view_read_sectors(uint32_t sector, uint32_t count, uint8_t *buffer)
+{
+    cluster_t cluster;
+    cluster_t cluster_in_chain;
+    cluster_t clusters_left;
+    uint32_t sector_in_cluster;
+    uint32_t run;
+    uint32_t i;
+    dir_entry_t *dir_entry;
+
+    count = min(count, SECTOR_COUNT - sector);
+    for (i = 0; i < count; i += run) {
+        run = 1;
+        if (sector + i >= FAT_CLUSTER2_FIRST_SECTOR) {
+            sector_to_cluster(sector + i, &cluster, &sector_in_cluster);
+            dir_entry = msc_fat_view_dir_entry_from_cluster(cluster, &cluster_in_chain, &clusters_left);
+            run = min(count - i, clusters_left * SECTORS_PER_CLUSTER - sector_in_cluster);
+            if (dir_entry && dir_entry->file->read_sectors) {
+                dir_entry->file->read_sectors(dir_entry->file,
+                                              sector_in_cluster + cluster_in_chain * SECTORS_PER_CLUSTER,
+                                              run, buffer + i * SECTOR_SIZE);
+                continue;
+            } else if (dir_entry == NULL) {
+                memset(buffer + i * SECTOR_SIZE, 0, run * SECTOR_SIZE);
+                continue;
+            }
+            run = 1;
+        }
+        msc_fat_view_read_sector(sector + i, buffer + i * SECTOR_SIZE);
+    }
+
+    return count;
+}
+
 static int32_t
 msc_fat_view_write_fat_sector(uint32_t fat_sector, const uint8_t *buffer)
 {
@@ -1207,7 +1281,7 @@ msc_fat_view_write_normal_sector(uint32_t sector, uint8_t *buffer)
     int res;
 
     sector_to_cluster(sector, &cluster, &sector_in_cluster);
-    dir_entry = msc_fat_view_dir_entry_from_cluster(cluster, &cluster_in_chain);
+    dir_entry = msc_fat_view_dir_entry_from_cluster(cluster, &cluster_in_chain, NULL);
     if (dir_entry == NULL) {
         res = msc_fat_view_write_unallocated_sector(sector, buffer);
     } else {
@@ -1351,21 +1425,48 @@ tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool loa
 /*
  * Callback invoked when received READ10 command.
  * Copy disk's data to buffer (up to bufsize) and return number of copied bytes.
+ * With USBD_MSC_EP_BUFSIZE bigger than sector size, bufsize can cover
+ * several sectors.
  */
 int32_t
 tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize)
 {
+    uint32_t count;
+
     (void)lun;
-    (void)offset;
+    assert(offset == 0);
 
     last_scsi_command = SCSI_CMD_READ_10;
 
     if (medium_state < MEDIUM_RELOAD) {
         return -1;
     }
-    msc_fat_view_read_sector(lba, buffer);
+    count = bufsize / SECTOR_SIZE;
+    if (count == 0 || lba >= SECTOR_COUNT) {
+        return -1;
+    }
+    count = msc_fat_view_read_sectors(lba, count, buffer);
+
+    return count * SECTOR_SIZE;
+}
+
+static int32_t
+msc_fat_view_write_sector(uint32_t lba, uint8_t *buffer)
+{
+    int32_t res;
+
+    if (lba == 0) {
+        res = SECTOR_SIZE;
+        /* Ignore writes to boot sector */
+    } else if (lba < FAT_ROOT_DIR_FIRST_SECTOR) {
+        res = msc_fat_view_write_fat_sector(lba - FAT_FIRST_SECTOR, buffer);
+    } else if (lba < FAT_CLUSTER2_FIRST_SECTOR) {
+        res = msc_fat_view_write_root_sector(lba - FAT_ROOT_DIR_FIRST_SECTOR, buffer);
+    } else {
+        res = msc_fat_view_write_normal_sector(lba, buffer);
+    }
 
-    return bufsize;
+    return res;
 }
 
 /*
@@ -1375,9 +1476,12 @@ tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint
 int32_t
 tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize)
 {
-    int32_t res;
+    int32_t res = 0;
+    uint32_t count;
+    uint32_t i;
+
     MSC_FAT_VIEW_LOG_DEBUG("SCSI WRITE10 %d, %d, %d\n", (int)lba, (int)offset, (int)bufsize);
-    assert(bufsize == SECTOR_SIZE);
+    assert(bufsize >= SECTOR_SIZE);
     assert(offset == 0);
 
     last_scsi_command = SCSI_CMD_WRITE_10;
@@ -1388,15 +1492,12 @@ tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer,
         return -1;
     }
 
-    if (lba == 0) {
-        res = bufsize;
-        /* Ignore writes to boot sector */
-    } else if (lba < FAT_ROOT_DIR_FIRST_SECTOR) {
-        res = msc_fat_view_write_fat_sector(lba - FAT_FIRST_SECTOR, buffer);
-    } else if (lba < FAT_CLUSTER2_FIRST_SECTOR) {
-        res = msc_fat_view_write_root_sector(lba - FAT_ROOT_DIR_FIRST_SECTOR, buffer);
-    } else {
-        res = msc_fat_view_write_normal_sector(lba, buffer);
+    count = min(bufsize / SECTOR_SIZE, SECTOR_COUNT - lba);
+    for (i = 0; i < count; ++i) {
+        if (msc_fat_view_write_sector(lba + i, buffer + i * SECTOR_SIZE) < 0) {
+            return res ? res : -1;
+        }
+        res += SECTOR_SIZE;
     }
 
     return res;
@@ -63,6 +63,26 @@ struct unallocated_write {
     } write_status;
 } unallocated_write;
 
+#define WRITE_CACHE_SIZE    MYNEWT_VAL(MSC_FAT_VIEW_WRITE_CACHE_SIZE)
+
+#if WRITE_CACHE_SIZE < SECTOR_SIZE || (WRITE_CACHE_SIZE % SECTOR_SIZE) != 0
+#error MSC_FAT_VIEW_WRITE_CACHE_SIZE must be a multiple of 512
+#endif
+
+#ifdef FLASH_AREA_IMAGE
+/*
+ * Image sectors are collected here and written to flash in one go
+ * when the cache is full or the file is complete.
+ */
+static struct {
+    /* Offset in image flash area of the first cached byte */
+    uint32_t offset;
+    /* Number of cached bytes */
+    uint32_t size;
+    uint8_t buffer[WRITE_CACHE_SIZE];
+} write_cache;
+#endif
+
 static int write_status;
 static const char *write_result_text[] = {
     "File that was written was not a valid image.",
@@ -118,6 +138,28 @@ static const file_entry_t flash_result = {
     .read_sector = flash_result_read,
 };
 
+#ifdef FLASH_AREA_IMAGE
+static int
+write_cache_flush(const struct flash_area *fa)
+{
+    int rc = 0;
+
+    if (write_cache.size) {
+        if (!hal_flash_isempty_no_buf(fa->fa_device_id, fa->fa_off + write_cache.offset, write_cache.size)) {
+            flash_area_erase(fa, write_cache.offset, write_cache.size);
+        }
+        rc = flash_area_write(fa, write_cache.offset, write_cache.buffer, write_cache.size);
+        if (rc < 0) {
+            MSC_FAT_VIEW_LOG_ERROR("Flash write error, following writes will be rejected %d 0x%08x\n",
+                                   rc, fa->fa_off + write_cache.offset);
+        }
+        write_cache.size = 0;
+    }
+
+    return rc;
+}
+#endif
+
 static int
 image_write_sector(struct msc_fat_view_write_handler *handler, uint32_t sector, uint8_t *buffer)
 {
@@ -149,6 +191,7 @@ image_write_sector(struct msc_fat_view_write_handler *handler, uint32_t sector,
             MSC_FAT_VIEW_LOG_INFO("Image writing detected\n");
             unallocated_write.first_sector = sector;
             unallocated_write.last_sector = sector;
+            write_cache.size = 0;
         }
     } else if (unallocated_write.write_status == WRITE_IN_PROGRESS) {
         if (sector != unallocated_write.last_sector + 1) {
@@ -157,19 +200,23 @@ image_write_sector(struct msc_fat_view_write_handler *handler, uint32_t sector,
              * it sensible.
              */
             unallocated_write.write_status = WRITE_NOT_IN_SEQUENCE;
+            write_cache.size = 0;
             MSC_FAT_VIEW_LOG_ERROR("Not continuous writes to unallocated space rejected\n");
         }
     }
     if (unallocated_write.write_status == WRITE_IN_PROGRESS) {
         write_offset = (sector - unallocated_write.first_sector) * SECTOR_SIZE;
-        if (!hal_flash_isempty_no_buf(fa->fa_device_id, fa->fa_off + write_offset, SECTOR_SIZE)) {
-            flash_area_erase(fa, write_offset, SECTOR_SIZE);
+        if (write_cache.size == 0) {
+            write_cache.offset = write_offset;
         }
+        memcpy(write_cache.buffer + write_cache.size, buffer, SECTOR_SIZE);
+        write_cache.size += SECTOR_SIZE;
 
-        if ((rc = flash_area_write(fa, write_offset, buffer, SECTOR_SIZE)) < 0) {
-            MSC_FAT_VIEW_LOG_ERROR("Flash write error, following writes will be rejected %d 0x%08x\n",
-                                   rc, fa->fa_off + write_offset);
-            unallocated_write.write_status = WRITE_EXCEEDED_SPACE;
+        /* Image starts at offset 0, so cache flushes stay aligned to cache size */
+        if (((write_offset + SECTOR_SIZE) % WRITE_CACHE_SIZE) == 0) {
+            if ((rc = write_cache_flush(fa)) < 0) {
+                unallocated_write.write_status = WRITE_EXCEEDED_SPACE;
+            }
         }
     }
     flash_area_close(fa);
@@ -188,6 +235,18 @@ image_file_written(struct msc_fat_view_write_handler *handler, uint32_t size,
 {
     struct image_version version;
     uint32_t flags;
+#ifdef FLASH_AREA_IMAGE
+    const struct flash_area *fa;
+
+    /* Image tail may still be in cache */
+    if (unallocated_write.write_status == WRITE_IN_PROGRESS && write_cache.size) {
+        flash_area_open(FLASH_AREA_IMAGE, &fa);
+        if (write_cache_flush(fa) < 0) {
+            unallocated_write.write_status = WRITE_EXCEEDED_SPACE;
+        }
+        flash_area_close(fa);
+    }
+#endif
 
     if (unallocated_write.write_status == WRITE_IN_PROGRESS) {
         if (unallocated_write.first_sector == sector && first_sector) {
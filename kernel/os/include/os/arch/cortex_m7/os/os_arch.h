@@ -49,6 +49,17 @@ os_arch_in_isr(void)
     return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
 }
 
+#if MYNEWT_VAL(HARDFLOAT) && MYNEWT_VAL(OS_FPU_LAZY_STACKING)
+/**
+ * Drops the floating point context of the calling task, so that its
+ * context switches no longer save and restore S16-S31.  The task gets a
+ * new context the next time it executes an FP instruction.  Call it only
+ * from privileged thread mode, with no floating point values live, e.g.
+ * at the end of a task's processing loop.
+ */
+void os_arch_fpu_release(void);
+#endif
+
 /* Include common arch definitions and APIs */
 #include "os/arch/common.h"
 
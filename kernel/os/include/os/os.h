@@ -49,6 +49,21 @@ extern "C" {
 
 #define CTASSERT(x) typedef int __ctasssert ## __LINE__[(x) ? 1 : -1]
 
+/*
+ * Placement of hot code and data, see OS_HOT_SECTIONS.  The linker script
+ * puts .text_ram in TEXT_RAM, and .data.core and .bss.core in COREDATA_RAM
+ * and COREBSS_RAM, copying and zeroing them at startup.
+ */
+#if MYNEWT_VAL(OS_HOT_SECTIONS)
+#define OS_HOT_CODE     __attribute__((section(".text_ram")))
+#define OS_FAST_DATA    __attribute__((section(".data.core")))
+#define OS_FAST_BSS     __attribute__((section(".bss.core")))
+#else
+#define OS_HOT_CODE
+#define OS_FAST_DATA
+#define OS_FAST_BSS
+#endif
+
 
 /**
  * @cond INTERNAL_HIDDEN
@@ -75,6 +90,28 @@ void os_init_idle_task(void);
  */
 int os_started(void);
 
+/**
+ * Idle task statistics, filled in by os_idle_info_get().  Tick counts are
+ * in os ticks.
+ */
+struct os_idle_info {
+    /** Number of times the idle task has woken up */
+    uint32_t oii_wakeups;
+    /** Total time spent in os_tick_idle() */
+    uint64_t oii_sleep_ticks;
+    /** Wakeups per second, over the last measurement window */
+    uint32_t oii_wakeups_per_sec;
+    /** Average sleep duration, over the last measurement window */
+    uint32_t oii_avg_sleep_ticks;
+};
+
+/**
+ * Get idle task statistics.  Requires OS_IDLE_STATS.
+ *
+ * @param oii The structure to fill in
+ */
+void os_idle_info_get(struct os_idle_info *oii);
+
 /**
  * Definition used for functions that take timeouts to specify
  * waiting indefinitely.
@@ -125,9 +162,12 @@ void os_system_reset(void);
 #include "os/os_cputime.h"
 #include "os/os_dev.h"
 #include "os/os_error.h"
+#include "os/os_event_flags.h"
 #include "os/os_eventq.h"
+#include "os/os_evring.h"
 #include "os/os_fault.h"
 #include "os/os_heap.h"
+#include "os/os_hrtimer.h"
 #include "os/os_mbuf.h"
 #include "os/os_mempool.h"
 #include "os/os_mutex.h"
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSAmutex Adaptive mutexes
+ *   @{
+ */
+
+#ifndef _OS_AMUTEX_H_
+#define _OS_AMUTEX_H_
+
+#include "os/os.h"
+#include "os/os_mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Adaptive mutex.
+ *
+ * An uncontended acquire or release is a single compare-and-swap on the
+ * owner field; no critical section is entered and no trace or stats hooks
+ * run.  When a task finds the lock taken, it retries for OS_AMUTEX_SPIN
+ * iterations, then hands ownership over to the embedded os_mutex and
+ * blocks on it, with the usual priority inheritance.  The lock returns to
+ * the fast path once the last waiter is gone.
+ *
+ * Suited to short critical sections that are rarely contended.
+ */
+struct os_amutex {
+    /**
+     * Owner while the lock is taken through the fast path;
+     * OS_AMUTEX_INFLATED while am_mutex holds the ownership; NULL if free.
+     */
+    struct os_task *am_owner;
+    /** Nesting level of the current owner */
+    uint16_t am_level;
+    /** Number of tasks pending, or about to pend, on am_mutex */
+    uint16_t am_waiters;
+    /** Backing mutex used while the lock is contended */
+    struct os_mutex am_mutex;
+};
+
+/** @cond INTERNAL_HIDDEN */
+#define OS_AMUTEX_INFLATED  ((struct os_task *)1)
+/** @endcond */
+
+/**
+ * Initialize an adaptive mutex.
+ *
+ * @param am Pointer to the mutex
+ *
+ * @return os_error_t
+ *      OS_INVALID_PARM     Mutex passed in was NULL.
+ *      OS_OK               no error.
+ */
+os_error_t os_amutex_init(struct os_amutex *am);
+
+/**
+ * Pend (wait) for an adaptive mutex.
+ *
+ * @param am Pointer to the mutex
+ * @param timeout Timeout, in os ticks.
+ *                A timeout of 0 means do not wait if not available.
+ *                A timeout of OS_TIMEOUT_NEVER means wait forever.
+ *
+ * @return os_error_t
+ *      OS_NOT_STARTED      The OS has not been started.
+ *      OS_INVALID_PARM     Mutex passed in was NULL.
+ *      OS_TIMEOUT          Mutex was not acquired within the timeout.
+ *      OS_OK               no error.
+ */
+os_error_t os_amutex_pend(struct os_amutex *am, os_time_t timeout);
+
+/**
+ * Release an adaptive mutex.
+ *
+ * @param am Pointer to the mutex
+ *
+ * @return os_error_t
+ *      OS_NOT_STARTED      The OS has not been started.
+ *      OS_INVALID_PARM     Mutex passed in was NULL.
+ *      OS_BAD_MUTEX        Mutex is not owned by the current task.
+ *      OS_OK               no error.
+ */
+os_error_t os_amutex_release(struct os_amutex *am);
+
+/**
+ * Get the nesting level of an adaptive mutex; 0 if it is free.  See
+ * os_mutex_get_level() for the caveats.
+ *
+ * @param am Pointer to the mutex
+ *
+ * @return number of times the lock was taken by its owner
+ */
+static inline uint16_t
+os_amutex_get_level(struct os_amutex *am)
+{
+    if (am->am_owner == NULL ||
+        (am->am_owner == OS_AMUTEX_INFLATED && am->am_mutex.mu_level == 0)) {
+        return 0;
+    }
+    return am->am_level;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_AMUTEX_H_ */
+
+/**
+ *   @} OSAmutex
+ * @} OSKernel
+ */
@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSBudget Memory Budget
+ *   @{
+ */
+
+#ifndef _OS_BUDGET_H
+#define _OS_BUDGET_H
+
+#include <inttypes.h>
+#include "os/os_mempool.h"
+#include "os/os_task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Memory used by a task, and the stack size suggested for it.  Sizes are in
+ * bytes.
+ */
+struct os_task_budget {
+    /** Task identifier */
+    uint8_t otb_taskid;
+    /** Stack size */
+    uint32_t otb_stack_size;
+    /**
+     * Peak stack usage.  With OS_STACK_WATERMARK this comes from the
+     * incremental tracker; otherwise the stack is scanned.
+     */
+    uint32_t otb_stack_peak;
+    /**
+     * Suggested stack size: the peak plus OS_BUDGET_STACK_MARGIN percent,
+     * rounded up to OS_STACK_ALIGNMENT.  Larger than otb_stack_size when
+     * the task came close to overflowing its stack.
+     */
+    uint32_t otb_stack_suggest;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    /** os_malloc() heap bytes held */
+    uint32_t otb_heap_bytes;
+#endif
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    /** Mempool blocks held, counting tracked pools only */
+    uint16_t otb_pool_blocks;
+    /** Mempool bytes held, counting tracked pools only */
+    uint32_t otb_pool_bytes;
+#endif
+    /** Name of the task */
+    char otb_name[OS_TASK_MAX_NAME_LEN];
+};
+
+/**
+ * Usage of a memory pool since boot, and the block count suggested for it.
+ */
+struct os_mempool_budget {
+    /** Size of a block, in bytes */
+    uint32_t omb_block_size;
+    /** Number of blocks in the pool */
+    uint16_t omb_num_blocks;
+    /** Most blocks ever in use at once */
+    uint16_t omb_peak_blocks;
+    /**
+     * Suggested number of blocks: the peak plus OS_BUDGET_POOL_MARGIN
+     * percent, and at least one more than the peak.
+     */
+    uint16_t omb_suggest_blocks;
+    /** Bytes freed by shrinking the pool to the suggested size */
+    uint32_t omb_reclaim_bytes;
+    /** Name of the pool */
+    char omb_name[OS_MEMPOOL_INFO_NAME_LEN];
+};
+
+/**
+ * Iterates through tasks and fills out their memory budget.  Works like
+ * os_task_info_get_next().
+ *
+ * @param prev                  The task returned by the previous call, or
+ *                                  NULL to begin iteration.
+ * @param otb                   The budget to fill out.
+ *
+ * @return                      The task read, or NULL when all tasks have
+ *                                  been returned.
+ */
+struct os_task *os_task_budget_get_next(const struct os_task *prev,
+                                        struct os_task_budget *otb);
+
+/**
+ * Iterates through memory pools and fills out their memory budget.  Works
+ * like os_mempool_info_get_next().
+ *
+ * @param prev                  The pool returned by the previous call, or
+ *                                  NULL to begin iteration.
+ * @param omb                   The budget to fill out.
+ *
+ * @return                      The pool read, or NULL when all pools have
+ *                                  been returned.
+ */
+struct os_mempool *os_mempool_budget_get_next(struct os_mempool *prev,
+                                              struct os_mempool_budget *omb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_BUDGET_H */
+
+/**
+ *   @} OSBudget
+ * @} OSKernel
+ */
@@ -45,7 +45,10 @@ struct os_callout {
     struct os_eventq *c_evq;
     /** Number of ticks in the future to expire the callout */
     os_time_t c_ticks;
-
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    /** Number of ticks the callout may be delayed by to save a wakeup */
+    os_time_t c_slack;
+#endif
 
     TAILQ_ENTRY(os_callout) c_next;
 };
@@ -99,6 +102,32 @@ void os_callout_stop(struct os_callout *);
  */
 int os_callout_reset(struct os_callout *, os_time_t);
 
+/**
+ * Allow the callout to expire up to 'slack' ticks late.
+ *
+ * The idle task does not wake up the system for a callout with slack
+ * until the slack has run out, or something else needs to run.  Callouts
+ * which expire in the meantime are handled in the same wakeup.  The slack
+ * is kept across os_callout_reset() calls.  Without OS_CALLOUT_SLACK this
+ * does nothing.
+ *
+ * @param c The callout to set slack for
+ * @param slack Tolerated delay, in os ticks
+ */
+static inline void
+os_callout_set_slack(struct os_callout *c, os_time_t slack)
+{
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    if (slack > INT32_MAX) {
+        slack = INT32_MAX;
+    }
+    c->c_slack = slack;
+#else
+    (void)c;
+    (void)slack;
+#endif
+}
+
 /**
  * Returns the number of ticks which remains to callout.
  *
@@ -54,6 +54,10 @@ extern "C" {
 
 #define OS_CPUTIME_FREQ_1MHZ
 
+#elif MYNEWT_VAL(OS_CPUTIME_RECIP)
+
+#define OS_CPUTIME_FREQ_RECIP
+
 #elif MYNEWT_VAL(OS_CPUTIME_FREQ) == 256        ||  \
       MYNEWT_VAL(OS_CPUTIME_FREQ) == 512        ||  \
       MYNEWT_VAL(OS_CPUTIME_FREQ) == 1024       ||  \
@@ -76,7 +80,8 @@ extern "C" {
 #else
 
 #error "Invalid OS_CPUTIME_FREQ value.  Value must be one of a) a power of 2" \
-       ">= 256Hz, or b) any value >= 1MHz"
+       ">= 256Hz, or b) any value >= 1MHz, or c) any value with" \
+       "OS_CPUTIME_RECIP enabled"
 
 #endif
 
@@ -89,6 +94,30 @@ struct os_cputime_data
 extern struct os_cputime_data g_os_cputime;
 #endif
 
+#if defined(OS_CPUTIME_FREQ_RECIP)
+/*
+ * Multiplication by num / den in fixed point: whole + frac / 2^64, with
+ * frac rounded up so that truncating the product gives the exact floor.
+ */
+struct os_cputime_ratio
+{
+    uint32_t num;
+    uint32_t den;
+    uint32_t whole;
+    uint64_t frac;
+};
+
+/* CPUTIME data. */
+struct os_cputime_data
+{
+    struct os_cputime_ratio usecs_to_ticks;
+    struct os_cputime_ratio ticks_to_usecs;
+    struct os_cputime_ratio nsecs_to_ticks;
+    struct os_cputime_ratio ticks_to_nsecs;
+};
+extern struct os_cputime_data g_os_cputime;
+#endif
+
 /* Helpful macros to compare cputimes */
 /** evaluates to true if t1 is before t2 in time */
 #define CPUTIME_LT(__t1, __t2) ((int32_t)   ((__t1) - (__t2)) < 0)
@@ -140,6 +140,10 @@ struct os_dev {
     /** Device name */
     const char *od_name;
     STAILQ_ENTRY(os_dev) od_next;
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+    /** Next device in the same name index bucket */
+    struct os_dev *od_hash_next;
+#endif
 };
 
 #define OS_DEV_SETHANDLERS(__dev, __open, __close)          \
@@ -188,8 +192,9 @@ int os_dev_create(struct os_dev *dev, const char *name, uint8_t stage,
 /**
  * Lookup a device by name.
  *
- * WARNING: This should be called before any locking on the device is done, or
- * the device list itself is modified in any context.  There is no locking.
+ * Devices are never removed from the device list, and are linked in only
+ * once set up, so this may be called concurrently with os_dev_create()
+ * without locking.
  *
  * @param name The name of the device to look up.
  *
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSEventFlags Event flags
+ *   @{
+ */
+
+#ifndef _OS_EVENT_FLAGS_H_
+#define _OS_EVENT_FLAGS_H_
+
+#include <stdint.h>
+#include "os/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Wait until any of the requested flags is set (default). */
+#define OS_EVENT_FLAGS_ANY      (0x00)
+/** Wait until all of the requested flags are set. */
+#define OS_EVENT_FLAGS_ALL      (0x01)
+/** Clear the requested flags when the wait is satisfied. */
+#define OS_EVENT_FLAGS_CLEAR    (0x02)
+
+struct os_event_flags_waiter;
+
+/**
+ * A word of 32 flags which tasks can wait on, in any combination.  Flags
+ * may be set and cleared from tasks and interrupt handlers.
+ */
+struct os_event_flags {
+    /** Current flags */
+    uint32_t oef_flags;
+    /** Tasks waiting for flags, highest priority first */
+    SLIST_HEAD(, os_event_flags_waiter) oef_waiters;
+};
+
+/**
+ * Initialize an event flags object.
+ *
+ * @param ef                Pointer to the event flags
+ * @param flags             Initial value of the flags
+ *
+ * @return os_error_t
+ *      OS_INVALID_PARM     Event flags passed in was NULL.
+ *      OS_OK               no error.
+ */
+os_error_t os_event_flags_init(struct os_event_flags *ef, uint32_t flags);
+
+/**
+ * Set flags, waking up every waiter whose condition becomes true.  Waiters
+ * are served in priority order, so a waiter using OS_EVENT_FLAGS_CLEAR can
+ * consume flags before lower priority waiters see them.  May be called
+ * from an interrupt handler.
+ *
+ * @param ef                Pointer to the event flags
+ * @param flags             Flags to set
+ *
+ * @return os_error_t
+ *      OS_INVALID_PARM     Event flags passed in was NULL.
+ *      OS_OK               no error.
+ */
+os_error_t os_event_flags_set(struct os_event_flags *ef, uint32_t flags);
+
+/**
+ * Clear flags.  May be called from an interrupt handler.
+ *
+ * @param ef                Pointer to the event flags
+ * @param flags             Flags to clear
+ *
+ * @return The flags as they were before clearing.
+ */
+uint32_t os_event_flags_clear(struct os_event_flags *ef, uint32_t flags);
+
+/**
+ * Wait for flags to be set.
+ *
+ * @param ef                Pointer to the event flags
+ * @param mask              Flags to wait for
+ * @param opts              OS_EVENT_FLAGS_ANY or OS_EVENT_FLAGS_ALL,
+ *                          optionally OR'ed with OS_EVENT_FLAGS_CLEAR
+ * @param timeout           Timeout, in os ticks.
+ *                          A timeout of 0 means do not wait.
+ *                          A timeout of OS_TIMEOUT_NEVER means wait forever.
+ * @param out_flags         On success, the flags which satisfied the wait,
+ *                          before any clearing; on timeout, the current
+ *                          flags.  May be NULL.
+ *
+ * @return os_error_t
+ *      OS_INVALID_PARM     Event flags passed in was NULL, or mask was 0.
+ *      OS_NOT_STARTED      The wait would block before the OS has started.
+ *      OS_TIMEOUT          The flags were not set within the timeout.
+ *      OS_OK               no error.
+ */
+os_error_t os_event_flags_wait(struct os_event_flags *ef, uint32_t mask,
+                               uint8_t opts, os_time_t timeout,
+                               uint32_t *out_flags);
+
+/**
+ * Get the current flags.
+ *
+ * @param ef                Pointer to the event flags
+ *
+ * @return The current flags.
+ */
+static inline uint32_t
+os_event_flags_get(const struct os_event_flags *ef)
+{
+    return ef->oef_flags;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_EVENT_FLAGS_H_ */
+
+/**
+ *   @} OSEventFlags
+ * @} OSKernel
+ */
@@ -49,6 +49,16 @@ typedef void os_event_fn(struct os_event *ev);
 struct os_event {
     /** Whether this OS event is queued on an event queue. */
     uint8_t ev_queued;
+#if MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS) > 1
+    /**
+     * Priority band of this event.  Events in a higher band are pulled off
+     * an event queue before events in lower bands; within a band events are
+     * FIFO.  0, the default, is the lowest band; values beyond the last band
+     * are treated as the last band.  Must not be changed while the event is
+     * queued.
+     */
+    uint8_t ev_prio;
+#endif
     /**
      * Callback to call when the event is taken off of an event queue.
      * APIs, except for os_eventq_run(), assume this callback will be called by
@@ -60,6 +70,10 @@ struct os_event {
 
     /** Next event in the queue. */
     STAILQ_ENTRY(os_event) ev_next;
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    /** os_cputime at which a monitored queue got the event, 0 if unknown */
+    uint32_t ev_put_time;
+#endif
 };
 
 /** Return whether or not the given event is queued. */
@@ -67,17 +81,19 @@ struct os_event {
 
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
 /**
- * Structure keeping track of time spent inside event callback. This is
- * stored per eventq, and is updated inside os_eventq_run(). Tick unit
- * is os_cputime.
+ * Time spent in one event callback, and time its events waited on the queue
+ * before being dispatched.  A monitored eventq holds a hash table of these,
+ * keyed by callback and updated inside os_eventq_run().  Tick unit is
+ * os_cputime.
  */
 struct os_eventq_mon {
-    struct os_event *em_ev;     /* pointer to specific os_event */
-    void *em_cb;                /* callback function called */
+    os_event_fn *em_cb;         /* callback function; NULL if slot unused */
     uint32_t em_cnt;            /* number of calls made */
     uint32_t em_min;            /* least number ticks spent in a call */
     uint32_t em_max;            /* most number of ticks spent in a call */
     uint32_t em_cum;            /* cumulative number of ticks spent in a call */
+    uint32_t em_qmax;           /* longest put-to-dispatch delay */
+    uint32_t em_qcum;           /* cumulative put-to-dispatch delay */
 };
 #endif
 
@@ -94,6 +110,11 @@ struct os_eventq {
     /** Event queue list. */
     STAILQ_HEAD(, os_event) evq_list;
 
+#if MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS) > 1
+    /** Last queued event of every priority band, NULL if band is empty. */
+    struct os_event *evq_prio_tail[MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS)];
+#endif
+
 #if MYNEWT_VAL(OS_EVENTQ_DEBUG)
     /** Most recently processed event. */
     struct os_event *evq_prev;
@@ -101,6 +122,18 @@ struct os_eventq {
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
     struct os_eventq_mon *evq_mon;
     int evq_mon_elems;
+    /** Calls not recorded because the table was full */
+    uint32_t evq_mon_miss;
+    /** Next monitored event queue */
+    struct os_eventq *evq_mon_next;
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_BATCH_STATS)
+    /** Number of batches pulled with os_eventq_get_batch(). */
+    uint32_t evq_batch_cnt;
+    /** Total number of events pulled in batches. */
+    uint32_t evq_batch_evs;
+    /** Largest batch pulled so far. */
+    uint16_t evq_batch_max;
 #endif
 };
 
@@ -158,6 +191,37 @@ struct os_event *os_eventq_get(struct os_eventq *evq);
  */
 void os_eventq_run(struct os_eventq *evq);
 
+/**
+ * Pull up to max items from an event queue in a single critical section.
+ * This function blocks until there is at least one item on the event queue
+ * to read.
+ *
+ * The returned events are no longer queued; removing one of them from the
+ * queue (e.g., by stopping its callout) before it has been handled has no
+ * effect.
+ *
+ * @param evq                   The event queue to pull events from
+ * @param evs                   Array receiving the pulled events
+ * @param max                   Capacity of evs; must be greater than 0
+ *
+ * @return                      The number of events pulled
+ */
+int os_eventq_get_batch(struct os_eventq *evq, struct os_event **evs,
+                        int max);
+
+/**
+ * Pull up to max items off the event queue with os_eventq_get_batch() and
+ * call their event callbacks in order.  At most OS_EVENTQ_BATCH_MAX events
+ * are pulled per call.  This function blocks until there is at least one
+ * item on the event queue.
+ *
+ * @param evq                   The event queue to pull the items off
+ * @param max                   Maximum number of events to handle
+ *
+ * @return                      The number of events handled
+ */
+int os_eventq_run_n(struct os_eventq *evq, int max);
+
 
 /**
  * Poll the list of event queues specified by the evq parameter
@@ -192,20 +256,20 @@ struct os_eventq *os_eventq_dflt_get(void);
 
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
 /**
- * Instrument OS eventq to monitor time spent handling events.
+ * Instrument OS eventq to monitor time spent handling events.  Must be
+ * called after os_eventq_init().  With OS_EVENTQ_MONITOR_DFLT_SLOTS the
+ * default event queue is monitored from startup.
  *
  * @param evq The event queue to start monitoring
- * @param cnt How many elements can be used in monitoring.
+ * @param cnt How many elements can be used in monitoring; a power of two.
+ *            At most this many different callbacks are tracked.
  * @param mon Pointer to data where monitoring data is collected. Must hold
  *            cnt number of elements.
  *
+ * @return 0 on success, OS_EINVAL if cnt is not a power of two.
  */
-static inline void os_eventq_mon_start(struct os_eventq *evq, int cnt,
-                                       struct os_eventq_mon *mon)
-{
-    evq->evq_mon = mon;
-    evq->evq_mon_elems = cnt;
-}
+int os_eventq_mon_start(struct os_eventq *evq, int cnt,
+                        struct os_eventq_mon *mon);
 
 /**
  * Stop OS eventq monitoring.
@@ -213,11 +277,23 @@ static inline void os_eventq_mon_start(struct os_eventq *evq, int cnt,
  * @param evq The event queue this operation applies to
  *
  */
-static inline void os_eventq_mon_stop(struct os_eventq *evq)
-{
-    evq->evq_mon = NULL;
-    evq->evq_mon_elems = 0;
-}
+void os_eventq_mon_stop(struct os_eventq *evq);
+
+/**
+ * Clear the data collected for a monitored event queue.
+ *
+ * @param evq The event queue this operation applies to
+ */
+void os_eventq_mon_clear(struct os_eventq *evq);
+
+/**
+ * Iterate over the monitored event queues.
+ *
+ * @param prev The previous queue, or NULL to start.
+ *
+ * @return The next monitored event queue; NULL when done.
+ */
+struct os_eventq *os_eventq_mon_get_next(struct os_eventq *prev);
 #endif
 
 /**
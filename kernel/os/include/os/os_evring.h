@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSEvring ISR-to-task Event Rings
+ *   @{
+ */
+
+#ifndef _OS_EVRING_H
+#define _OS_EVRING_H
+
+#include <inttypes.h>
+#include "os/os_eventq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct os_evring;
+
+/** Callback function type for draining an event ring. */
+typedef void os_evring_fn(struct os_evring *ring);
+
+/**
+ * Single-producer, single-consumer ring of fixed-size elements, bound to an
+ * event queue.  The producer (typically an ISR) pushes elements without
+ * disabling interrupts; the ring's event is posted to the event queue only
+ * when the consumer has not yet been notified, i.e. once per burst.  The
+ * consumer task drains the ring from the callback given to
+ * os_evring_init().
+ */
+struct os_evring {
+    /** Element storage; er_count * er_elem_size bytes. */
+    uint8_t *er_buf;
+    /** Size of one element, in bytes. */
+    uint16_t er_elem_size;
+    /** Number of elements in the ring; power of two. */
+    uint16_t er_count;
+    /** Free-running write index, only modified by the producer. */
+    volatile uint32_t er_head;
+    /** Free-running read index, only modified by the consumer. */
+    volatile uint32_t er_tail;
+    /** Set by the producer once the event is posted; cleared on drain. */
+    volatile uint8_t er_pending;
+    /** Number of elements dropped because the ring was full. */
+    uint32_t er_drops;
+    /** Event queue to post drain events to. */
+    struct os_eventq *er_evq;
+    /** Event posted to er_evq when elements are pushed. */
+    struct os_event er_ev;
+    /** Called in the context of the consumer task to drain the ring. */
+    os_evring_fn *er_cb;
+    /** Argument for the drain callback. */
+    void *er_arg;
+};
+
+/**
+ * Initialize an event ring.
+ *
+ * @param ring                  The ring to initialize
+ * @param evq                   Event queue processed by the consumer task
+ * @param buf                   Storage for count elements of elem_size bytes
+ * @param elem_size             Size of one element, in bytes
+ * @param count                 Number of elements; must be a power of two
+ * @param cb                    Called from evq to drain the ring
+ * @param arg                   Argument for cb
+ *
+ * @return                      0 on success;
+ *                              OS_EINVAL on bad arguments.
+ */
+int os_evring_init(struct os_evring *ring, struct os_eventq *evq, void *buf,
+                   uint16_t elem_size, uint16_t count, os_evring_fn *cb,
+                   void *arg);
+
+/**
+ * Push an element onto the ring.  Must only be called by the single
+ * producer; safe to call with interrupts enabled and from an ISR.
+ *
+ * @param ring                  The ring to push onto
+ * @param elem                  Element to copy into the ring
+ *
+ * @return                      0 on success;
+ *                              OS_ENOMEM if the ring is full.
+ */
+int os_evring_push(struct os_evring *ring, const void *elem);
+
+/**
+ * Pop an element off the ring.  Must only be called by the single consumer,
+ * usually from the drain callback.
+ *
+ * @param ring                  The ring to pop from
+ * @param elem                  Buffer receiving the element
+ *
+ * @return                      0 on success;
+ *                              OS_ENOENT if the ring is empty.
+ */
+int os_evring_pop(struct os_evring *ring, void *elem);
+
+/**
+ * Returns the number of elements currently in the ring.
+ */
+static inline uint16_t
+os_evring_len(const struct os_evring *ring)
+{
+    return ring->er_head - ring->er_tail;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_EVRING_H */
+
+/**
+ *   @} OSEvring
+ * @} OSKernel
+ */
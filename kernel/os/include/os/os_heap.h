@@ -30,6 +30,8 @@
 #define H_OS_HEAP_
 
 #include <stddef.h>
+#include <stdint.h>
+#include "syscfg/syscfg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +72,45 @@ void os_free(void *mem);
  */
 void *os_realloc(void *ptr, size_t size);
 
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+
+/**
+ * Heap usage information, returned by os_heap_info_get().
+ */
+struct os_heap_info {
+    /** Number of bytes available for allocation in an empty heap */
+    size_t ohi_total;
+    /** Number of bytes currently free */
+    size_t ohi_free;
+    /** Lowest number of free bytes seen since boot */
+    size_t ohi_min_free;
+    /** Size of the largest free block */
+    size_t ohi_max_free_blk;
+    /** Number of free blocks */
+    uint32_t ohi_num_free_blks;
+    /** Number of allocated blocks */
+    uint32_t ohi_num_used_blks;
+    /** Number of allocations which could not be satisfied */
+    uint32_t ohi_num_fail;
+    /**
+     * Fragmentation, as the percentage of free bytes lying outside the
+     * largest free block.
+     */
+    uint8_t ohi_frag_pct;
+};
+
+/**
+ * Walks the os_malloc() heap and reports its usage.  The walk is linear in
+ * the number of heap blocks and holds the heap lock while it runs.
+ *
+ * @param ohi The structure to fill in.
+ *
+ * @return 0 on success.
+ */
+int os_heap_info_get(struct os_heap_info *ohi);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
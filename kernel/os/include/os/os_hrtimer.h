@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSHRTimer High Resolution Timer Service
+ *   @{
+ */
+
+#ifndef _OS_HRTIMER_H
+#define _OS_HRTIMER_H
+
+#include <stdint.h>
+#include "os/os_eventq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A high resolution timer.  Any number of these share the single os_cputime
+ * hal timer; pending timers are kept in a binary heap ordered by expiry, so
+ * that starting and stopping a timer take O(log n) time.
+ *
+ * Like a callout, an expiring timer either posts its event to an event
+ * queue, or, if it has no event queue, runs the event callback directly
+ * from the hal timer interrupt.
+ */
+struct os_hrtimer {
+    /** Event to post, or to run, when the timer expires */
+    struct os_event ht_ev;
+    /** Event queue to post to; NULL to run in interrupt context */
+    struct os_eventq *ht_evq;
+    /** Cputime at which the timer expires */
+    uint32_t ht_expiry;
+    /** Position in the heap plus one; 0 if not pending */
+    uint16_t ht_idx;
+};
+
+/**
+ * Initialize a high resolution timer.
+ *
+ * @param t The timer to initialize
+ * @param evq The event queue to post the timer event to when it expires.
+ *            If NULL, the event callback is called from the hal timer
+ *            interrupt instead.
+ * @param ev_cb The event callback
+ * @param ev_arg The argument to provide in the ev_arg field of the event
+ */
+void os_hrtimer_init(struct os_hrtimer *t, struct os_eventq *evq,
+                     os_event_fn *ev_cb, void *ev_arg);
+
+/**
+ * Start a timer that expires at 'cputime'.  If the timer is already
+ * pending it is rescheduled.  If 'cputime' has already passed, the timer
+ * expires immediately.
+ *
+ * @param t The timer to start
+ * @param cputime The cputime at which the timer should expire
+ *
+ * @return 0 on success; OS_ENOMEM if OS_HRTIMER_MAX timers are already
+ *         pending.
+ */
+int os_hrtimer_start(struct os_hrtimer *t, uint32_t cputime);
+
+/**
+ * Start a timer that expires 'usecs' microseconds from now.
+ *
+ * @param t The timer to start
+ * @param usecs Microseconds until the timer should expire
+ *
+ * @return 0 on success; OS_ENOMEM if OS_HRTIMER_MAX timers are already
+ *         pending.
+ */
+int os_hrtimer_relative(struct os_hrtimer *t, uint32_t usecs);
+
+/**
+ * Stop a timer.  If the timer already expired and its event is still
+ * queued, the event is removed.  Can be called on a stopped timer.
+ *
+ * @param t The timer to stop
+ */
+void os_hrtimer_stop(struct os_hrtimer *t);
+
+/**
+ * Returns whether the timer is pending or not.
+ *
+ * @param t The timer to check
+ *
+ * @return 1 if pending, 0 if not.
+ */
+static inline int
+os_hrtimer_queued(const struct os_hrtimer *t)
+{
+    return t->ht_idx != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_HRTIMER_H */
+
+/**
+ *   @} OSHRTimer
+ * @} OSKernel
+ */
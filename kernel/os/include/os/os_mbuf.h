@@ -29,8 +29,10 @@
 #ifndef _OS_MBUF_H
 #define _OS_MBUF_H
 
+#include <syscfg/syscfg.h>
 #include "os/queue.h"
 #include "os/os_eventq.h"
+#include "os/os_sem.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,6 +60,27 @@ struct os_mbuf_pool {
      * Next mbuf pool in the list
      */
     STAILQ_ENTRY(os_mbuf_pool) omp_next;
+
+    /**
+     * Number of msys allocations that preferred this pool and failed
+     */
+    uint32_t omp_num_fail;
+    /**
+     * Number of msys allocations that preferred this pool but were served
+     * by another one
+     */
+    uint32_t omp_num_fallback;
+
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    /**
+     * Number of blocks whose data is currently referenced by clones
+     */
+    uint16_t omp_num_shared;
+    /**
+     * Number of allocated clone mbufs, which carry no data of their own
+     */
+    uint16_t omp_num_clones;
+#endif
 };
 
 
@@ -101,6 +124,13 @@ struct os_mbuf {
      */
     uint16_t om_len;
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    /**
+     * Number of mbufs using this block's data: this one plus its clones
+     */
+    uint16_t om_refcnt;
+#endif
+
     /**
      * The mbuf pool this mbuf was allocated out of
      */
@@ -117,6 +147,14 @@ struct os_mbuf {
     uint8_t om_databuf[0];
 };
 
+struct os_mqueue;
+
+/**
+ * Called when a bounded mqueue which refused a put has drained to its low
+ * watermark.  Runs in the context of the consumer calling os_mqueue_get().
+ */
+typedef void os_mqueue_space_fn(struct os_mqueue *mq, void *arg);
+
 /**
  * Structure representing a queue of mbufs.
  */
@@ -125,6 +163,72 @@ struct os_mqueue {
     STAILQ_HEAD(, os_mbuf_pkthdr) mq_head;
     /** Event to post when new buffers are available on the queue. */
     struct os_event mq_ev;
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+    /** Number of packets on the queue */
+    uint16_t mq_count;
+    /** Maximum number of packets; 0 if unbounded */
+    uint16_t mq_high;
+    /** Producers are resumed once the count drops to this */
+    uint16_t mq_low;
+    /** Set when a put was refused, until the queue drains to mq_low */
+    uint8_t mq_full;
+    /** Number of producers blocked in os_mqueue_put_wait() */
+    uint8_t mq_waiters;
+    /** Wakes up blocked producers */
+    struct os_sem mq_space_sem;
+    /** Called when producers are resumed */
+    os_mqueue_space_fn *mq_space_cb;
+    void *mq_space_arg;
+#endif
+};
+
+/**
+ * Cursor over the contiguous data segments of a byte range of an mbuf chain.
+ * See os_mbuf_iter_init().
+ */
+struct os_mbuf_iter {
+    /** Mbuf holding the next segment */
+    const struct os_mbuf *omi_om;
+    /** Offset of the next segment within omi_om */
+    uint16_t omi_off;
+    /** Number of bytes of the range not yet returned */
+    uint16_t omi_rem;
+};
+
+/**
+ * A contiguous data segment of an mbuf chain, as filled in by
+ * os_mbuf_to_iovec().
+ */
+struct os_mbuf_iovec {
+    /** Start of the segment */
+    void *omv_base;
+    /** Length of the segment */
+    uint16_t omv_len;
+};
+
+struct os_mbuf_ext;
+
+/**
+ * Function called when the last mbuf referencing a piece of external storage
+ * is freed.  The storage may be reused or released once this returns.
+ *
+ * @param ext                   The external storage descriptor.
+ */
+typedef void os_mbuf_ext_free_fn(struct os_mbuf_ext *ext);
+
+/**
+ * Descriptor for caller-owned storage (e.g., a DMA receive buffer) that one
+ * or more mbufs point into instead of carrying the data in their own pool
+ * block.  Initialize with os_mbuf_ext_init(); the descriptor must remain
+ * valid until its free callback runs.
+ */
+struct os_mbuf_ext {
+    /** Called when the last referencing mbuf is freed; may be NULL. */
+    os_mbuf_ext_free_fn *ome_free_cb;
+    /** Argument for the free callback's use. */
+    void *ome_arg;
+    /** Number of mbufs referencing this storage. */
+    uint16_t ome_refcnt;
 };
 
 /**
@@ -134,6 +238,19 @@ struct os_mqueue {
  */
 #define OS_MBUF_F_MASK(__n) (1 << (__n))
 
+/** The mbuf's data lives in external storage; see os_mbuf_ext_attach(). */
+#define OS_MBUF_F_EXT       OS_MBUF_F_MASK(7)
+
+/** The mbuf's data lives in another mbuf's block; see os_mbuf_clone(). */
+#define OS_MBUF_F_CLONE     OS_MBUF_F_MASK(6)
+
+/**
+ * Checks whether a given mbuf points at external storage
+ *
+ * @param __om                  The mbuf to check
+ */
+#define OS_MBUF_IS_EXT(__om) (((__om)->om_flags & OS_MBUF_F_EXT) != 0)
+
 /**
  * Checks whether a given mbuf is a packet header mbuf
  *
@@ -183,6 +300,75 @@ struct os_mqueue {
     ((om)->om_pkthdr_len - sizeof (struct os_mbuf_pkthdr))
 
 
+/** @cond INTERNAL_HIDDEN */
+
+/*
+ * Location of the pointer to the storage an external or clone mbuf refers
+ * to.  It occupies the last pointer-aligned word of the otherwise unused
+ * data buffer, so it stays put when the packet header is moved or removed.
+ */
+static inline void **
+_os_mbuf_ref_slot(const struct os_mbuf *om)
+{
+    uint16_t off;
+
+    off = (om->om_omp->omp_databuf_len - sizeof (void *)) &
+          ~(sizeof (void *) - 1);
+
+    return (void **)(om->om_databuf + off);
+}
+
+/** @endcond */
+
+/**
+ * Gets the external storage descriptor of an external mbuf.
+ *
+ * @param __om                  The mbuf to query; must satisfy
+ *                                  OS_MBUF_IS_EXT().
+ */
+#define OS_MBUF_EXT(__om) (*(struct os_mbuf_ext **)_os_mbuf_ref_slot(__om))
+
+/**
+ * Gets the mbuf whose block holds the data of a clone mbuf.
+ *
+ * @param __om                  The mbuf to query; must have OS_MBUF_F_CLONE
+ *                                  set.
+ */
+#define OS_MBUF_CLONE_SRC(__om) (*(struct os_mbuf **)_os_mbuf_ref_slot(__om))
+
+/** @cond INTERNAL_HIDDEN */
+
+/*
+ * Whether the mbuf's data may be seen through other mbufs, in which case
+ * it must not be written in place nor grown into.
+ */
+static inline int
+_os_mbuf_is_shared(const struct os_mbuf *om)
+{
+    if (OS_MBUF_IS_EXT(om)) {
+        return OS_MBUF_EXT(om)->ome_refcnt > 1;
+    }
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    if (om->om_flags & OS_MBUF_F_CLONE) {
+        return OS_MBUF_CLONE_SRC(om)->om_refcnt > 1;
+    }
+    return om->om_refcnt > 1;
+#else
+    return 0;
+#endif
+}
+
+/** @endcond */
+
+/**
+ * Checks whether the data of a given mbuf is shared with other mbufs, e.g.,
+ * by os_mbuf_clone() or os_mbuf_dup() of external storage.
+ *
+ * @param __om                  The mbuf to check
+ */
+#define OS_MBUF_IS_SHARED(__om) _os_mbuf_is_shared(__om)
+
+
 /** @cond INTERNAL_HIDDEN */
 
 /*
@@ -194,6 +380,12 @@ _os_mbuf_leadingspace(struct os_mbuf *om)
     uint16_t startoff;
     uint16_t leadingspace;
 
+    /* External and shared data is never grown into. */
+    if (om->om_flags & (OS_MBUF_F_EXT | OS_MBUF_F_CLONE) ||
+        OS_MBUF_IS_SHARED(om)) {
+        return 0;
+    }
+
     startoff = 0;
     if (OS_MBUF_IS_PKTHDR(om)) {
         startoff = om->om_pkthdr_len;
@@ -228,6 +420,11 @@ _os_mbuf_trailingspace(struct os_mbuf *om)
 {
     struct os_mbuf_pool *omp;
 
+    if (om->om_flags & (OS_MBUF_F_EXT | OS_MBUF_F_CLONE) ||
+        OS_MBUF_IS_SHARED(om)) {
+        return 0;
+    }
+
     omp = om->om_omp;
 
     return (&om->om_databuf[0] + omp->omp_databuf_len) -
@@ -290,6 +487,43 @@ struct os_mbuf *os_mqueue_get(struct os_mqueue *mq);
 int os_mqueue_put(struct os_mqueue *mq, struct os_eventq *evq,
                   struct os_mbuf *om);
 
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+/**
+ * Bounds an mqueue.  Once it holds `high` packets, os_mqueue_put() fails with
+ * OS_EBUSY and leaves the mbuf with the caller.  When the consumer has
+ * drained the queue to `low` packets, blocked producers are woken up and
+ * `space_cb` is called.
+ *
+ * @param mq                    The mqueue to bound.
+ * @param high                  Maximum number of packets; 0 removes the
+ *                                  bound.
+ * @param low                   Packet count at which producers resume;
+ *                                  must be less than `high`.
+ * @param space_cb              Optional producer callback.
+ * @param arg                   The argument to pass to `space_cb`.
+ *
+ * @return                      0 on success; OS_EINVAL on bad limits.
+ */
+int os_mqueue_set_limits(struct os_mqueue *mq, uint16_t high, uint16_t low,
+                         os_mqueue_space_fn *space_cb, void *arg);
+
+/**
+ * Adds a packet to an mqueue like os_mqueue_put(), waiting for space if the
+ * mqueue is full.  Must be called from task context.
+ *
+ * @param mq                    The mbuf queue to append the mbuf to.
+ * @param evq                   The event queue to post an event to.
+ * @param om                    The mbuf to append to the mbuf queue.
+ * @param timeout               Maximum number of ticks to wait for space.
+ *
+ * @return                      0 on success; OS_EBUSY if the mqueue stayed
+ *                                  full; other non-zero on failure.  The
+ *                                  mbuf is not freed on failure.
+ */
+int os_mqueue_put_wait(struct os_mqueue *mq, struct os_eventq *evq,
+                       struct os_mbuf *om, os_time_t timeout);
+#endif
+
 /**
  * MSYS is a system level mbuf registry.  Allows the system to share
  * packet buffers amongst the various networking stacks that can be running
@@ -311,7 +545,9 @@ int os_msys_register(struct os_mbuf_pool *new_pool);
 
 /**
  * Allocate a mbuf from msys.  Based upon the data size requested,
- * os_msys_get() will choose the mbuf pool that has the best fit.
+ * os_msys_get() will choose the mbuf pool that has the best fit.  With
+ * MSYS_FALLBACK enabled, bigger pools are tried in turn if that pool is
+ * exhausted.
  *
  * @param dsize                 The estimated size of the data being stored in
  *                                  the mbuf
@@ -342,6 +578,33 @@ void os_msys_reset(void);
  */
 struct os_mbuf *os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len);
 
+/**
+ * Allocate a packet header chain holding len bytes from msys, spread over
+ * as many blocks as needed.  Blocks are taken from the best fitting pool
+ * first and then from any pool with free blocks, so large requests can be
+ * served while the fitting pool is exhausted.  The data is uninitialized;
+ * fill it with os_mbuf_copyinto() or through os_mbuf_to_iovec().
+ *
+ * @param len                   The number of data bytes in the chain
+ * @param user_hdr_len          The length to allocate for the packet header
+ *                                  structure
+ *
+ * @return                      A freshly allocated chain on success;
+ *                              NULL on failure.
+ */
+struct os_mbuf *os_msys_get_chain(uint16_t len, uint16_t user_hdr_len);
+
+/**
+ * Iterate over the mbuf pools registered with msys, from smallest to biggest
+ * block size.  The pools' omp_num_fail and omp_num_fallback counters and
+ * their mempools describe how well msys copes with the load.
+ *
+ * @param prev                  The previous pool, or NULL to start.
+ *
+ * @return                      The next pool; NULL when done.
+ */
+struct os_mbuf_pool *os_msys_pool_get_next(struct os_mbuf_pool *prev);
+
 /**
  * Count the number of blocks in all the mbuf pools that are allocated.
  *
@@ -356,6 +619,63 @@ int os_msys_count(void);
  */
 int os_msys_num_free(void);
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+/**
+ * Return the number of Msys blocks whose data is shared with clones
+ *
+ * @return                      Number of shared blocks in Msys
+ */
+int os_msys_num_shared(void);
+
+/**
+ * Return the number of allocated Msys clone mbufs, which carry no data of
+ * their own
+ *
+ * @return                      Number of clone mbufs in Msys
+ */
+int os_msys_num_clones(void);
+#endif
+
+#if MYNEWT_VAL(MSYS_COMPACT)
+/**
+ * Compacts the mbuf chains held by one owner, typically with
+ * os_mbuf_compact().  Called from the default event queue task, so the
+ * owner must lock its chains against its own users as needed.
+ *
+ * @param arg                   The compactor's omc_arg.
+ *
+ * @return                      The number of mbufs freed.
+ */
+typedef int os_msys_compact_fn(void *arg);
+
+/**
+ * A holder of long-lived mbuf chains (queued notifications, reassembly
+ * buffers, logs) that can repack them when msys runs low.
+ */
+struct os_msys_compactor {
+    os_msys_compact_fn *omc_fn;
+    void *omc_arg;
+    SLIST_ENTRY(os_msys_compactor) omc_next;
+};
+
+/**
+ * Registers a compactor.  Once an allocation leaves an msys pool with
+ * MSYS_COMPACT_LOW_WATER free blocks or fewer, or fails, all compactors are
+ * run from the default event queue.
+ *
+ * @param omc                   The compactor to register.
+ */
+void os_msys_compactor_register(struct os_msys_compactor *omc);
+
+/**
+ * Runs all registered compactors now.  Must be called from task context;
+ * useful before retrying a failed allocation.
+ *
+ * @return                      The total number of mbufs freed.
+ */
+int os_msys_compact(void);
+#endif
+
 /**
  * Initialize a pool of mbufs.
  *
@@ -395,8 +715,45 @@ struct os_mbuf *os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace);
 struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp,
                                    uint8_t user_pkthdr_len);
 
+/**
+ * Initializes an external storage descriptor.
+ *
+ * @param ext                   The descriptor to initialize.
+ * @param free_cb               Called when the last mbuf referencing the
+ *                                  storage is freed; may be NULL.
+ * @param arg                   Stored in ome_arg for the callback's use.
+ */
+void os_mbuf_ext_init(struct os_mbuf_ext *ext, os_mbuf_ext_free_fn *free_cb,
+                      void *arg);
+
+/**
+ * Points an empty mbuf at external storage, so that data received into a
+ * caller-owned buffer (e.g., by DMA) can be passed up the stack without
+ * being copied into the mbuf pool.  The mbuf, typically allocated with
+ * os_mbuf_get() or os_mbuf_get_pkthdr(), takes a reference on the storage
+ * which is dropped when the mbuf is freed.
+ *
+ * An external mbuf reports no leading or trailing space, so functions that
+ * grow a chain (os_mbuf_append(), os_mbuf_prepend(), ...) allocate fresh
+ * mbufs rather than writing past the attached range.  os_mbuf_dup() shares
+ * the storage instead of copying it.
+ *
+ * @param om                    The empty, unchained mbuf to attach to.
+ * @param ext                   The storage descriptor.
+ * @param data                  Start of the data within the storage.
+ * @param len                   Number of bytes of data.
+ *
+ * @return                      0 on success;
+ *                              OS_EINVAL if the mbuf is not empty, is not
+ *                                  from a pool, or its packet header leaves
+ *                                  no room for the descriptor pointer.
+ */
+int os_mbuf_ext_attach(struct os_mbuf *om, struct os_mbuf_ext *ext,
+                       void *data, uint16_t len);
+
 /**
  * Duplicate a chain of mbufs.  Return the start of the duplicated chain.
+ * External storage is shared by the duplicate rather than copied.
  *
  * @param om                    The mbuf chain to duplicate
  *
@@ -404,6 +761,25 @@ struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp,
  */
 struct os_mbuf *os_mbuf_dup(struct os_mbuf *om);
 
+/**
+ * Creates a chain that shares the data of another instead of copying it.
+ * Each mbuf in the new chain is a header-only clone referencing the block
+ * that holds the data, which is kept alive until the original and all of
+ * its clones are freed.  External storage is shared as by os_mbuf_dup().
+ *
+ * Shared data is copy-on-write: os_mbuf_copyinto() first moves the affected
+ * bytes into private mbufs, and shared mbufs report no leading or trailing
+ * space, so growing either chain allocates new mbufs.
+ *
+ * When OS_MBUF_CLONE is disabled, this is equivalent to os_mbuf_dup().
+ *
+ * @param om                    The mbuf chain to clone
+ *
+ * @return                      A pointer to the new chain of mbufs;
+ *                              NULL on allocation failure.
+ */
+struct os_mbuf *os_mbuf_clone(struct os_mbuf *om);
+
 /**
  * Locates the specified absolute offset within an mbuf chain.  The offset
  * can be one past than the total length of the chain, but no greater.
@@ -435,6 +811,54 @@ struct os_mbuf *os_mbuf_off(const struct os_mbuf *om, int off,
  */
 int os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst);
 
+/**
+ * Prepares an iterator over the data segments of a byte range of an mbuf
+ * chain.  The segments point into the mbufs themselves, so the range can be
+ * handed to DMA, crypto or bus drivers without being copied or pulled up.
+ * The chain must not be modified while the iterator is in use.
+ *
+ * @param it                    The iterator to initialize.
+ * @param om                    The mbuf chain to iterate over.
+ * @param off                   The offset of the range within the chain.
+ * @param len                   The length of the range.
+ *
+ * @return                      0 on success;
+ *                              OS_EINVAL if the range extends beyond the end
+ *                                  of the chain.
+ */
+int os_mbuf_iter_init(struct os_mbuf_iter *it, const struct os_mbuf *om,
+                      uint16_t off, uint16_t len);
+
+/**
+ * Gets the next data segment from an mbuf iterator.  Empty mbufs are
+ * skipped.
+ *
+ * @param it                    The iterator.
+ * @param data                  On success, points to the segment.
+ *
+ * @return                      The length of the segment;
+ *                              0 if the range is exhausted.
+ */
+uint16_t os_mbuf_iter_next(struct os_mbuf_iter *it, void **data);
+
+/**
+ * Describes a byte range of an mbuf chain as an array of data segments.
+ *
+ * @param om                    The mbuf chain.
+ * @param off                   The offset of the range within the chain.
+ * @param len                   The length of the range.
+ * @param iov                   The array to fill in.
+ * @param iovcnt                The number of entries in the array.
+ *
+ * @return                      The number of entries used on success;
+ *                              OS_EINVAL if the range extends beyond the end
+ *                                  of the chain;
+ *                              OS_ENOMEM if the range has more than iovcnt
+ *                                  segments.
+ */
+int os_mbuf_to_iovec(const struct os_mbuf *om, uint16_t off, uint16_t len,
+                     struct os_mbuf_iovec *iov, int iovcnt);
+
 /**
  * @brief Calculates the length of an mbuf chain.
  *
@@ -480,7 +904,9 @@ int os_mbuf_appendfrom(struct os_mbuf *dst, const struct os_mbuf *src,
                        uint16_t src_off, uint16_t len);
 
 /**
- * Release a mbuf back to the pool
+ * Release a mbuf back to the pool.  If the mbuf points at external storage,
+ * its reference is dropped, and the storage's free callback is called if it
+ * was the last one.
  *
  * @param om                    The Mbuf to release back to the pool
  *
@@ -584,7 +1010,9 @@ struct os_mbuf *os_mbuf_prepend_pullup(struct os_mbuf *om, uint16_t len);
  * Copies the contents of a flat buffer into an mbuf chain, starting at the
  * specified destination offset.  If the mbuf is too small for the source data,
  * it is extended as necessary.  If the destination mbuf contains a packet
- * header, the header length is updated.
+ * header, the header length is updated.  Shared data that would be
+ * overwritten is first copied into private mbufs, so other chains sharing it
+ * are unaffected.
  *
  * @param om                    The mbuf chain to copy into.
  * @param off                   The offset within the chain to copy to.
@@ -685,6 +1113,19 @@ int os_mbuf_widen(struct os_mbuf *om, uint16_t off, uint16_t len);
  */
 struct os_mbuf *os_mbuf_pack_chains(struct os_mbuf *m1, struct os_mbuf *m2);
 
+/**
+ * Repacks a chain in place into as few mbufs as its blocks allow: data is
+ * moved to the front of each mbuf and the following mbufs' data pulled into
+ * its trailing space.  Emptied mbufs are freed; the first mbuf is kept, so
+ * queue links through its packet header stay valid.  Shared and external
+ * buffers are never written to.  No mbufs are allocated.
+ *
+ * @param om                    The chain to compact.
+ *
+ * @return                      The number of mbufs freed.
+ */
+int os_mbuf_compact(struct os_mbuf *om);
+
 #ifdef __cplusplus
 }
 #endif
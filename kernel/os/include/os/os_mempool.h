@@ -65,6 +65,10 @@ struct os_mempool {
     uint16_t mp_min_free;
     /** Bitmap of OS_MEMPOOL_F_[...] values. */
     uint8_t mp_flags;
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    /** First allocation site table entry of this pool; 0xffff if none */
+    uint16_t mp_track_base;
+#endif
     /** Address of memory buffer used by pool */
     uintptr_t mp_membuf_addr;
     STAILQ_ENTRY(os_mempool) mp_list;
@@ -154,6 +158,60 @@ struct os_mempool *os_mempool_info_get_next(struct os_mempool *,
 struct os_mempool *os_mempool_get(const char *mempool_name,
                                   struct os_mempool_info *info);
 
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+/**
+ * Outstanding blocks of a pool allocated from the same call site.
+ */
+struct os_mempool_site {
+    /** The pool */
+    const struct os_mempool *oms_pool;
+    /** Return address of the allocating call */
+    uintptr_t oms_pc;
+    /** Number of blocks held */
+    uint16_t oms_count;
+    /** Bytes held, i.e. oms_count times the pool's block size */
+    uint32_t oms_bytes;
+    /** Age of the oldest block, in OS ticks */
+    os_time_t oms_max_age;
+};
+
+/**
+ * Aggregates the outstanding blocks of all tracked pools by pool and call
+ * site.
+ *
+ * @param sites                 Array to fill in.
+ * @param max_sites             Size of the array.  Blocks of further call
+ *                                  sites are not reported.
+ *
+ * @return                      Number of entries filled in.
+ */
+int os_mempool_sites_get(struct os_mempool_site *sites, int max_sites);
+
+/**
+ * Counts the outstanding blocks of all tracked pools that were allocated
+ * while the given task was running.
+ *
+ * @param taskid                The task's t_taskid.
+ * @param blocks                On return, the number of blocks held.
+ * @param bytes                 On return, the bytes held.
+ */
+void os_mempool_task_usage(uint8_t taskid, uint16_t *blocks,
+                           uint32_t *bytes);
+
+/**
+ * Attributes a block to another call site.  Used by allocators built on top
+ * of mempools, see OS_MEMPOOL_TRACK_CALLER().
+ */
+void os_mempool_track_set(const struct os_mempool *mp, const void *block,
+                          void *pc);
+
+/** Attributes a block to the caller of the calling function. */
+#define OS_MEMPOOL_TRACK_CALLER(mp, block) \
+    os_mempool_track_set((mp), (block), __builtin_return_address(0))
+#else
+#define OS_MEMPOOL_TRACK_CALLER(mp, block)
+#endif
+
 /*
  * To calculate size of the memory buffer needed for the pool. NOTE: This size
  * is NOT in bytes! The size is the number of os_membuf_t elements required for
@@ -286,6 +344,93 @@ os_error_t os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr);
  */
 os_error_t os_memblock_put(struct os_mempool *mp, void *block_addr);
 
+/**
+ * Gets up to n memory blocks from a memory pool, using a single critical
+ * section.
+ *
+ * @param mp                    Pointer to the memory pool
+ * @param blocks                Array receiving the blocks
+ * @param n                     Number of blocks requested
+ *
+ * @return                      The number of blocks retrieved; fewer than n
+ *                                  if the pool ran out of free blocks.
+ */
+int os_memblock_get_n(struct os_mempool *mp, void **blocks, int n);
+
+/**
+ * Puts n memory blocks back into the pool, using a single critical section.
+ * Blocks of an extended pool with a put callback are freed one at a time
+ * through the callback.
+ *
+ * @param mp                    Pointer to memory pool
+ * @param blocks                Array of blocks to free
+ * @param n                     Number of blocks in the array
+ *
+ * @return os_error_t
+ */
+os_error_t os_memblock_put_n(struct os_mempool *mp, void **blocks, int n);
+
+/**
+ * Memory pool magazine.  A small stash of blocks in front of a memory pool,
+ * which is refilled from and flushed to the pool in bulk.  A magazine is not
+ * protected against concurrent access; it is meant to be owned by a single
+ * task (or event queue), with one magazine per user of a shared pool.
+ *
+ * Blocks held by a magazine are accounted as allocated by the pool.
+ */
+struct os_mempool_mag {
+    /** Pool the magazine caches blocks of. */
+    struct os_mempool *mm_mp;
+    /** Storage for cached block pointers; mm_size entries. */
+    void **mm_slots;
+    /** Capacity of the magazine. */
+    uint8_t mm_size;
+    /** Number of blocks currently held. */
+    uint8_t mm_cnt;
+};
+
+/**
+ * Initializes an empty magazine in front of a memory pool.
+ *
+ * @param mag                   The magazine to initialize
+ * @param mp                    The memory pool to cache blocks of
+ * @param slots                 Storage for size block pointers
+ * @param size                  Capacity of the magazine; with 0, gets and
+ *                                  puts go straight to the pool
+ */
+void os_mempool_mag_init(struct os_mempool_mag *mag, struct os_mempool *mp,
+                         void **slots, uint8_t size);
+
+/**
+ * Gets a memory block through a magazine.  An empty magazine is refilled
+ * with half its capacity from the pool.
+ *
+ * @param mag                   The magazine to get a block from
+ *
+ * @return                      Pointer to block if available; NULL otherwise
+ */
+void *os_mempool_mag_get(struct os_mempool_mag *mag);
+
+/**
+ * Puts a memory block back through a magazine.  When the magazine is full,
+ * half of it is flushed back to the pool first.
+ *
+ * @param mag                   The magazine to put the block into
+ * @param block_addr            Pointer to memory block
+ *
+ * @return os_error_t
+ */
+os_error_t os_mempool_mag_put(struct os_mempool_mag *mag, void *block_addr);
+
+/**
+ * Returns all blocks held by a magazine to its pool.
+ *
+ * @param mag                   The magazine to flush
+ *
+ * @return os_error_t
+ */
+os_error_t os_mempool_mag_flush(struct os_mempool_mag *mag);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,22 @@ struct os_mutex {
     uint16_t    mu_level;
     /** Task that owns the mutex */
     struct os_task *mu_owner;
+    /** Entry in the owner's list of held mutexes */
+    SLIST_ENTRY(os_mutex) mu_held_next;
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    /** Name given at registration; NULL if not registered */
+    const char *mu_name;
+    /** Number of acquisitions which had to wait for another owner */
+    uint32_t mu_num_contended;
+    /** Total ticks spent waiting in contended acquisitions */
+    os_time_t mu_wait_total;
+    /** Longest wait, in ticks */
+    os_time_t mu_wait_max;
+    /** Task which held the mutex during the longest wait */
+    struct os_task *mu_wait_max_owner;
+    /** Entry in the list of registered mutexes */
+    STAILQ_ENTRY(os_mutex) mu_stats_next;
+#endif
 };
 
 /*
@@ -91,6 +107,11 @@ os_error_t os_mutex_release(struct os_mutex *mu);
 /**
  * Pend (wait) for a mutex.
  *
+ * While the calling task waits, the owner runs at the caller's priority if
+ * that is higher.  The boost is passed along the chain when the owner is
+ * itself waiting on another mutex, and is dropped when the owner releases a
+ * mutex and no remaining waiter on its other mutexes needs it.
+ *
  * @param mu Pointer to mutex.
  * @param timeout Timeout, in os ticks.
  *                A timeout of 0 means do not wait if not available.
@@ -104,6 +125,57 @@ os_error_t os_mutex_release(struct os_mutex *mu);
  */
 os_error_t os_mutex_pend(struct os_mutex *mu, os_time_t timeout);
 
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+
+/**
+ * Contention information about a registered mutex, returned by
+ * os_mutex_info_get_next().
+ */
+struct os_mutex_info {
+    /** Name the mutex was registered with */
+    const char *omi_name;
+    /** Current owner, or NULL if the mutex is free */
+    const char *omi_owner;
+    /** Name of the task holding the mutex during the longest wait */
+    const char *omi_wait_max_owner;
+    /** Number of contended acquisitions */
+    uint32_t omi_num_contended;
+    /** Total ticks spent waiting for the mutex */
+    uint32_t omi_wait_total;
+    /** Longest wait, in ticks */
+    uint32_t omi_wait_max;
+};
+
+/**
+ * Adds a mutex to the list reported by os_mutex_info_get_next().  The
+ * mutex must have been initialized with os_mutex_init().
+ *
+ * @param mu Pointer to mutex
+ * @param name The name to report the mutex under
+ */
+void os_mutex_stats_register(struct os_mutex *mu, const char *name);
+
+/**
+ * Iterates the registered mutexes and reports their contention counters.
+ *
+ * @param prev The mutex returned by the previous call, or NULL to start
+ *             from the first one.
+ * @param omi The structure to fill in.
+ *
+ * @return The next mutex; NULL if there are no more.
+ */
+struct os_mutex *os_mutex_info_get_next(const struct os_mutex *prev,
+                                        struct os_mutex_info *omi);
+
+#else
+
+static inline void
+os_mutex_stats_register(struct os_mutex *mu, const char *name)
+{
+}
+
+#endif
+
 /**
  * Get mutex lock count.
  *
@@ -121,9 +121,36 @@ int os_sched_wakeup(struct os_task *);
 int os_sched_remove(struct os_task *);
 void os_sched_resort(struct os_task *);
 os_time_t os_sched_wakeup_ticks(os_time_t now);
+void os_sched_run_list_init(void);
 
 /** @endcond */
 
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+/**
+ * System-wide scheduler trace counters, returned by os_sched_trace_get().
+ */
+struct os_sched_trace_info {
+    /** Number of task wakeups */
+    uint32_t osti_wakeups;
+    /** Wakeup-to-dispatch latencies below 10 microseconds */
+    uint32_t osti_lat_lt_10us;
+    /** Wakeup-to-dispatch latencies below 100 microseconds */
+    uint32_t osti_lat_lt_100us;
+    /** Wakeup-to-dispatch latencies below 1 millisecond */
+    uint32_t osti_lat_lt_1ms;
+    /** Wakeup-to-dispatch latencies of 1 millisecond or more */
+    uint32_t osti_lat_ge_1ms;
+};
+
+/**
+ * Reads the scheduler trace counters.  Per-task figures are reported
+ * through os_task_info_get_next().
+ *
+ * @param osti The structure to fill in.
+ */
+void os_sched_trace_get(struct os_sched_trace_info *osti);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,10 +39,19 @@ extern "C" {
 struct os_sem {
     /** Semaphore head */
     SLIST_HEAD(, os_task) sem_head;
-    /** Padding for alignment */
-    uint16_t    _pad;
-    /** Number of tokens */
-    uint16_t    sem_tokens;
+    union {
+        struct {
+            /**
+             * Nonzero if tasks may be waiting.  Only maintained with
+             * OS_SEM_FAST_PATH.
+             */
+            uint16_t    sem_waiting;
+            /** Number of tokens */
+            uint16_t    sem_tokens;
+        };
+        /** sem_waiting and sem_tokens, updated together by the fast path */
+        uint32_t    sem_state;
+    };
 };
 
 /*
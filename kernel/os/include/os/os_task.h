@@ -59,6 +59,32 @@ struct os_task_obj {
     SLIST_HEAD(, os_task) obj_head;     /* chain of waiting tasks */
 };
 
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+/**
+ * Scheduler trace state of a task.  Times are in os_cputime ticks.
+ */
+struct os_task_trace {
+    /** When the task was last made ready, if ott_ready is set */
+    uint32_t ott_ready_time;
+    /** When the task was last dispatched */
+    uint32_t ott_run_start;
+    /** Longest wakeup-to-dispatch latency */
+    uint32_t ott_lat_max;
+    /** Sum of all wakeup-to-dispatch latencies */
+    uint32_t ott_lat_total;
+    /** Number of latencies in ott_lat_total */
+    uint32_t ott_lat_cnt;
+    /** Longest time the task ran without being switched out */
+    uint32_t ott_burst_max;
+    /** Run time in the current load window */
+    uint32_t ott_win_run;
+    /** CPU load percentage of each of the last load windows */
+    uint8_t ott_load[MYNEWT_VAL(OS_SCHED_TRACE_WINDOWS)];
+    /** Set from wakeup until dispatch */
+    uint8_t ott_ready;
+};
+#endif
+
 /** Task states */
 typedef enum os_task_state {
     /** Task is ready to run */
@@ -104,7 +130,8 @@ struct os_task {
     /** Task flags, bitmask */
     uint8_t t_flags;
     uint8_t t_lockcnt;
-    uint8_t t_pad;
+    /** Priority assigned at init, before any mutex priority inheritance */
+    uint8_t t_base_prio;
 
     /** Task name */
     const char *t_name;
@@ -132,10 +159,30 @@ struct os_task {
      * execution.
      */
     uint32_t t_ctx_sw_cnt;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    /** Number of os_malloc() heap bytes allocated by this task */
+    uint32_t t_heap_bytes;
+#endif
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    /** Scheduler latency and load trace */
+    struct os_task_trace t_trace;
+#endif
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+    /** Lowest stack index known to have been used */
+    uint16_t t_stack_hwm;
+    /** Top of the next window probed for deeper use */
+    uint16_t t_stack_probe;
+#endif
 
     STAILQ_ENTRY(os_task) t_os_task_list;
     TAILQ_ENTRY(os_task) t_os_list;
     SLIST_ENTRY(os_task) t_obj_list;
+    /** Mutexes currently owned by this task */
+    SLIST_HEAD(, os_mutex) t_mutex_list;
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    /** Priority level this task is queued at in the run list */
+    uint8_t t_sched_prio;
+#endif
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -201,7 +248,11 @@ struct os_task_info {
     uint8_t oti_taskid;
     /** Task state, either READY or SLEEP */
     uint8_t oti_state;
-    /** Task stack usage */
+    /**
+     * Task stack usage.  With OS_STACK_WATERMARK this is the peak usage
+     * found so far by the incremental tracker, which may lag behind a full
+     * scan briefly.
+     */
     uint16_t oti_stkusage;
     /** Task stack size */
     uint16_t oti_stksize;
@@ -213,6 +264,20 @@ struct os_task_info {
     os_time_t oti_last_checkin;
     /** Next time this task is scheduled to check-in with sanity */
     os_time_t oti_next_checkin;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    /** Number of os_malloc() heap bytes allocated by this task */
+    uint32_t oti_heap_bytes;
+#endif
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    /** Longest wakeup-to-dispatch latency, in microseconds */
+    uint32_t oti_lat_max;
+    /** Average wakeup-to-dispatch latency, in microseconds */
+    uint32_t oti_lat_avg;
+    /** Longest uninterrupted run, in microseconds */
+    uint32_t oti_burst_max;
+    /** CPU load over the last OS_SCHED_TRACE_WINDOWS seconds, in percent */
+    uint8_t oti_load;
+#endif
     /** Name of this task */
     char oti_name[OS_TASK_MAX_NAME_LEN];
 };
@@ -110,6 +110,14 @@ os_time_t os_time_get(void);
  */
 void os_time_advance(int ticks);
 
+#if MYNEWT_VAL(OS_TICK_HOOK)
+/**
+ * Called by os_time_advance() from the OS tick interrupt, once the OS has
+ * started (OS_TICK_HOOK).  To be provided by the application or a package.
+ */
+void os_tick_hook(void);
+#endif
+
 /**
  * Puts the current task to sleep for the specified number of os ticks. There
  * is no delay if ticks is 0.
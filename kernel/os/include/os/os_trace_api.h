@@ -35,6 +35,9 @@
 #include "sysview/vendor/SEGGER_SYSVIEW.h"
 #endif
 #include "os/os.h"
+#if MYNEWT_VAL(OS_TRACE_RING)
+#include "os/os_trace_ring.h"
+#endif
 
 #define OS_TRACE_ID_EVENTQ_PUT                  (40)
 #define OS_TRACE_ID_EVENTQ_GET_NO_WAIT          (41)
@@ -42,6 +45,7 @@
 #define OS_TRACE_ID_EVENTQ_REMOVE               (43)
 #define OS_TRACE_ID_EVENTQ_POLL_0TIMO           (44)
 #define OS_TRACE_ID_EVENTQ_POLL                 (45)
+#define OS_TRACE_ID_EVENTQ_GET_BATCH            (46)
 #define OS_TRACE_ID_MUTEX_INIT                  (50)
 #define OS_TRACE_ID_MUTEX_RELEASE               (51)
 #define OS_TRACE_ID_MUTEX_PEND                  (52)
@@ -204,7 +208,122 @@ os_trace_api_ret_u32(unsigned id, uint32_t ret)
 
 #endif /* MYNEWT_VAL(OS_SYSVIEW) && !defined(OS_TRACE_DISABLE_FILE_API) */
 
-#if !MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_TRACE_RING)
+
+static inline void
+os_trace_isr_enter(void)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_ISR_ENTER, 0, 0);
+}
+
+static inline void
+os_trace_isr_exit(void)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_ISR_EXIT, 0, 0);
+}
+
+static inline void
+os_trace_task_info(const struct os_task *t)
+{
+    (void)t;
+}
+
+static inline void
+os_trace_task_create(const struct os_task *t)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_CREATE, 0, (uintptr_t)t);
+}
+
+static inline void
+os_trace_task_start_exec(const struct os_task *t)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_START_EXEC, 0, (uintptr_t)t);
+}
+
+static inline void
+os_trace_task_stop_exec(void)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_STOP_EXEC, 0, 0);
+}
+
+static inline void
+os_trace_task_start_ready(const struct os_task *t)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_START_READY, 0, (uintptr_t)t);
+}
+
+static inline void
+os_trace_task_stop_ready(const struct os_task *t, unsigned reason)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_STOP_READY, 0, (uintptr_t)t);
+    os_trace_ring_rec(OS_TRACE_RING_ID_TASK_STOP_READY, OS_TRACE_RING_F_CONT,
+                      reason);
+}
+
+static inline void
+os_trace_idle(void)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_IDLE, 0, 0);
+}
+
+static inline void
+os_trace_user_start(unsigned id)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_USER_START, 0, id);
+}
+
+static inline void
+os_trace_user_stop(unsigned id)
+{
+    os_trace_ring_rec(OS_TRACE_RING_ID_USER_STOP, 0, id);
+}
+
+#endif /* MYNEWT_VAL(OS_TRACE_RING) */
+
+#if MYNEWT_VAL(OS_TRACE_RING) && !defined(OS_TRACE_DISABLE_FILE_API)
+
+static inline void
+os_trace_api_void(unsigned id)
+{
+    os_trace_ring_rec(id, 0, 0);
+}
+
+static inline void
+os_trace_api_u32(unsigned id, uint32_t p0)
+{
+    os_trace_ring_rec(id, 0, p0);
+}
+
+static inline void
+os_trace_api_u32x2(unsigned id, uint32_t p0, uint32_t p1)
+{
+    os_trace_ring_rec(id, 0, p0);
+    os_trace_ring_rec(id, OS_TRACE_RING_F_CONT, p1);
+}
+
+static inline void
+os_trace_api_u32x3(unsigned id, uint32_t p0, uint32_t p1, uint32_t p2)
+{
+    os_trace_ring_rec(id, 0, p0);
+    os_trace_ring_rec(id, OS_TRACE_RING_F_CONT, p1);
+    os_trace_ring_rec(id, OS_TRACE_RING_F_CONT, p2);
+}
+
+static inline void
+os_trace_api_ret(unsigned id)
+{
+    os_trace_ring_rec(id, OS_TRACE_RING_F_RET, 0);
+}
+
+static inline void
+os_trace_api_ret_u32(unsigned id, uint32_t ret)
+{
+    os_trace_ring_rec(id, OS_TRACE_RING_F_RET, ret);
+}
+
+#endif /* MYNEWT_VAL(OS_TRACE_RING) && !defined(OS_TRACE_DISABLE_FILE_API) */
+
+#if !MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING)
 
 static inline void
 os_trace_isr_enter(void)
@@ -269,9 +388,10 @@ os_trace_user_stop(unsigned id)
     (void)id;
 }
 
-#endif /* !MYNEWT_VAL(OS_SYSVIEW) */
+#endif /* !MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING) */
 
-#if !MYNEWT_VAL(OS_SYSVIEW) || defined(OS_TRACE_DISABLE_FILE_API)
+#if (!MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING)) || \
+    defined(OS_TRACE_DISABLE_FILE_API)
 
 static inline void
 os_trace_api_void(unsigned id)
@@ -316,7 +436,7 @@ os_trace_api_ret_u32(unsigned id, uint32_t return_value)
     (void)return_value;
 }
 
-#endif /* !MYNEWT_VAL(OS_SYSVIEW) || defined(OS_TRACE_DISABLE_FILE_API) */
+#endif /* (!OS_SYSVIEW && !OS_TRACE_RING) || OS_TRACE_DISABLE_FILE_API */
 
 #endif /* __ASSEMBLER__ */
 
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSTraceRing RAM trace ring
+ *   @{
+ */
+
+#ifndef _OS_TRACE_RING_H
+#define _OS_TRACE_RING_H
+
+#include <stdint.h>
+#include "syscfg/syscfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** "OTRB", identifies the ring in a RAM or core dump */
+#define OS_TRACE_RING_MAGIC             (0x4252544fU)
+
+/*
+ * Record IDs for the events which SystemView records natively. The
+ * os_trace_api IDs (OS_TRACE_ID_*) and module IDs start at 32.
+ */
+#define OS_TRACE_RING_ID_ISR_ENTER          (2)
+#define OS_TRACE_RING_ID_ISR_EXIT           (3)
+#define OS_TRACE_RING_ID_TASK_START_EXEC    (4)
+#define OS_TRACE_RING_ID_TASK_STOP_EXEC     (5)
+#define OS_TRACE_RING_ID_TASK_START_READY   (6)
+#define OS_TRACE_RING_ID_TASK_STOP_READY    (7)
+#define OS_TRACE_RING_ID_TASK_CREATE        (8)
+#define OS_TRACE_RING_ID_USER_START         (15)
+#define OS_TRACE_RING_ID_USER_STOP          (16)
+#define OS_TRACE_RING_ID_IDLE               (17)
+
+/** Record holds a further argument of the preceding record */
+#define OS_TRACE_RING_F_CONT                (0x01)
+/** Record marks the return from an API call */
+#define OS_TRACE_RING_F_RET                 (0x02)
+
+/** Task ID recorded when no task is running yet */
+#define OS_TRACE_RING_NO_TASK               (0xff)
+
+/**
+ * A trace record.  Records are 12 bytes, in the CPU's byte order.
+ */
+struct os_trace_ring_rec {
+    /** os_cputime when the event occurred */
+    uint32_t otrr_ts;
+    /** Event ID */
+    uint16_t otrr_id;
+    /** OS_TRACE_RING_F_* flags */
+    uint8_t otrr_flags;
+    /** ID of the task running at the time */
+    uint8_t otrr_taskid;
+    /** Event argument */
+    uint32_t otrr_arg;
+};
+
+/**
+ * The trace ring.  The header describes the layout, so that the ring can be
+ * decoded from a raw RAM dump without the firmware image.
+ */
+struct os_trace_ring {
+    /** OS_TRACE_RING_MAGIC */
+    uint32_t otr_magic;
+    /** sizeof(struct os_trace_ring_rec) */
+    uint16_t otr_rec_size;
+    /** Number of records in the ring; a power of two */
+    uint16_t otr_rec_cnt;
+    /** Frequency of the timestamps, in Hz */
+    uint32_t otr_ts_freq;
+    /** Number of records ever written; the next one goes to otr_head % cnt */
+    volatile uint32_t otr_head;
+    /** Non-zero when recording is stopped */
+    volatile uint8_t otr_frozen;
+    uint8_t otr_pad[3];
+    /** The records */
+    struct os_trace_ring_rec otr_recs[MYNEWT_VAL(OS_TRACE_RING_SIZE)];
+};
+
+/** The trace ring; its symbol lets host tools find it in a core dump. */
+extern struct os_trace_ring g_os_trace_ring;
+
+/**
+ * Append a record to the trace ring.  Safe to call from any context; takes
+ * a lock-free path where the CPU has atomic instructions.  Does nothing
+ * while the ring is frozen.
+ *
+ * @param id                The event ID
+ * @param flags             OS_TRACE_RING_F_* flags
+ * @param arg               The event argument
+ */
+void os_trace_ring_rec(uint16_t id, uint8_t flags, uint32_t arg);
+
+/**
+ * Stop recording, for example so that a fault handler does not overwrite
+ * the events leading up to the fault.
+ */
+static inline void
+os_trace_ring_freeze(void)
+{
+    g_os_trace_ring.otr_frozen = 1;
+}
+
+/**
+ * Resume recording after os_trace_ring_freeze().
+ */
+static inline void
+os_trace_ring_thaw(void)
+{
+    g_os_trace_ring.otr_frozen = 0;
+}
+
+/**
+ * Copy records out of the trace ring, oldest first.
+ *
+ * @param seq               Sequence number of the first record to copy.
+ *                          Records older than the ring holds are skipped.
+ * @param recs              Buffer to copy the records to
+ * @param max               Maximum number of records to copy
+ * @param out_seq           On success, the sequence number of the first
+ *                          record copied.  May be NULL.
+ *
+ * @return The number of records copied.
+ */
+int os_trace_ring_read(uint32_t seq, struct os_trace_ring_rec *recs, int max,
+                       uint32_t *out_seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_TRACE_RING_H */
+
+/**
+ *   @} OSTraceRing
+ * @} OSKernel
+ */
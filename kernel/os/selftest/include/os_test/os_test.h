@@ -33,6 +33,11 @@ TEST_SUITE_DECL(os_time_test_suite);
 TEST_SUITE_DECL(os_mbuf_test_suite);
 TEST_SUITE_DECL(os_eventq_test_suite);
 TEST_SUITE_DECL(os_callout_test_suite);
+TEST_SUITE_DECL(os_heap_test_suite);
+TEST_SUITE_DECL(os_event_flags_test_suite);
+TEST_SUITE_DECL(os_hrtimer_test_suite);
+TEST_SUITE_DECL(os_task_test_suite);
+TEST_SUITE_DECL(os_cputime_test_suite);
 
 TEST_CASE_DECL(os_time_test_change);
 
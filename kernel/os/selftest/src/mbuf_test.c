@@ -99,6 +99,12 @@ TEST_CASE_DECL(os_mbuf_test_adj)
 TEST_CASE_DECL(os_mbuf_test_get_pkthdr)
 TEST_CASE_DECL(os_mbuf_test_widen)
 TEST_CASE_DECL(os_mbuf_test_pack_chains)
+TEST_CASE_DECL(os_mbuf_test_ext)
+TEST_CASE_DECL(os_mbuf_test_clone)
+TEST_CASE_DECL(os_mbuf_test_iovec)
+TEST_CASE_DECL(os_mbuf_test_msys)
+TEST_CASE_DECL(os_mbuf_test_compact)
+TEST_CASE_DECL(os_mbuf_test_mqueue_limits)
 
 TEST_SUITE(os_mbuf_test_suite)
 {
@@ -111,4 +117,10 @@ TEST_SUITE(os_mbuf_test_suite)
     os_mbuf_test_get_pkthdr();
     os_mbuf_test_widen();
     os_mbuf_test_pack_chains();
+    os_mbuf_test_ext();
+    os_mbuf_test_clone();
+    os_mbuf_test_iovec();
+    os_mbuf_test_msys();
+    os_mbuf_test_compact();
+    os_mbuf_test_mqueue_limits();
 }
@@ -58,6 +58,9 @@ mempool_test_get_pool_size(int num_blocks, int block_size)
 TEST_CASE_DECL(os_mempool_test_case)
 TEST_CASE_DECL(os_mempool_test_ext_basic)
 TEST_CASE_DECL(os_mempool_test_ext_nested)
+TEST_CASE_DECL(os_mempool_test_bulk)
+TEST_CASE_DECL(os_mempool_test_budget)
+TEST_CASE_DECL(os_mempool_test_track)
 
 TEST_SUITE(os_mempool_test_suite)
 {
@@ -69,6 +72,9 @@ TEST_SUITE(os_mempool_test_suite)
     os_mempool_test_case();
     os_mempool_test_ext_basic();
     os_mempool_test_ext_nested();
+    os_mempool_test_bulk();
+    os_mempool_test_budget();
+    os_mempool_test_track();
 
     free(TstMembuf);
     TstMembufSz = 0;
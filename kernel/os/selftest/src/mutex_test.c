@@ -282,10 +282,16 @@ mutex_task4_handler(void *arg)
 TEST_CASE_DECL(os_mutex_test_basic)
 TEST_CASE_DECL(os_mutex_test_case_1)
 TEST_CASE_DECL(os_mutex_test_case_2)
+TEST_CASE_DECL(os_mutex_test_inherit)
+TEST_CASE_DECL(os_mutex_test_inherit_timeout)
+TEST_CASE_DECL(os_mutex_test_amutex)
 
 TEST_SUITE(os_mutex_test_suite)
 {
     os_mutex_test_basic();
     os_mutex_test_case_1();
     os_mutex_test_case_2();
+    os_mutex_test_inherit();
+    os_mutex_test_inherit_timeout();
+    os_mutex_test_amutex();
 }
@@ -70,6 +70,11 @@ os_test_all(void)
     os_eventq_test_suite();
     os_callout_test_suite();
     os_time_test_suite();
+    os_heap_test_suite();
+    os_event_flags_test_suite();
+    os_hrtimer_test_suite();
+    os_task_test_suite();
+    os_cputime_test_suite();
 
     return tu_case_failed;
 }
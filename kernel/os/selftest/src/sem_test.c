@@ -260,6 +260,7 @@ TEST_CASE_DECL(os_sem_test_case_1)
 TEST_CASE_DECL(os_sem_test_case_2)
 TEST_CASE_DECL(os_sem_test_case_3)
 TEST_CASE_DECL(os_sem_test_case_4)
+TEST_CASE_DECL(os_sem_test_trace)
 
 TEST_SUITE(os_sem_test_suite)
 {
@@ -268,4 +269,5 @@ TEST_SUITE(os_sem_test_suite)
     os_sem_test_case_2();
     os_sem_test_case_3();
     os_sem_test_case_4();
+    os_sem_test_trace();
 }
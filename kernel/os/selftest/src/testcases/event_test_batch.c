@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+static int event_test_batch_runs;
+
+static void
+event_test_batch_cb(struct os_event *ev)
+{
+    TEST_ASSERT((intptr_t)ev->ev_arg == event_test_batch_runs);
+    event_test_batch_runs++;
+}
+
+/**
+ * Verifies that os_eventq_get_batch() and os_eventq_run_n() pull events in
+ * FIFO order and never more than requested.
+ */
+TEST_CASE_TASK(event_test_batch)
+{
+    struct os_event *evs[SIZE_MULTI_EVENT];
+    int cnt;
+    int i;
+
+    os_eventq_init(&my_eventq);
+
+    for (i = 0; i < SIZE_MULTI_EVENT; i++) {
+        memset(&m_event[i], 0, sizeof m_event[i]);
+        m_event[i].ev_cb = event_test_batch_cb;
+        m_event[i].ev_arg = (void *)(intptr_t)i;
+        os_eventq_put(&my_eventq, &m_event[i]);
+    }
+
+    cnt = os_eventq_get_batch(&my_eventq, evs, 2);
+    TEST_ASSERT_FATAL(cnt == 2);
+    TEST_ASSERT(evs[0] == &m_event[0]);
+    TEST_ASSERT(evs[1] == &m_event[1]);
+    TEST_ASSERT(!OS_EVENT_QUEUED(evs[0]));
+    TEST_ASSERT(!OS_EVENT_QUEUED(evs[1]));
+
+    cnt = os_eventq_get_batch(&my_eventq, evs, SIZE_MULTI_EVENT);
+    TEST_ASSERT_FATAL(cnt == 2);
+    TEST_ASSERT(evs[0] == &m_event[2]);
+    TEST_ASSERT(evs[1] == &m_event[3]);
+    TEST_ASSERT(os_eventq_get_no_wait(&my_eventq) == NULL);
+
+    event_test_batch_runs = 0;
+    for (i = 0; i < SIZE_MULTI_EVENT; i++) {
+        os_eventq_put(&my_eventq, &m_event[i]);
+    }
+    cnt = os_eventq_run_n(&my_eventq, SIZE_MULTI_EVENT);
+    TEST_ASSERT(cnt == SIZE_MULTI_EVENT);
+    TEST_ASSERT(event_test_batch_runs == SIZE_MULTI_EVENT);
+    TEST_ASSERT(os_eventq_get_no_wait(&my_eventq) == NULL);
+}
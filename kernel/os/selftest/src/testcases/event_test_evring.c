@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define EVENT_TEST_EVRING_CNT   (4)
+
+static struct os_evring event_test_ring;
+static uint32_t event_test_evring_buf[EVENT_TEST_EVRING_CNT];
+static int event_test_evring_drained;
+
+static void
+event_test_evring_cb(struct os_evring *ring)
+{
+    uint32_t val;
+
+    while (os_evring_pop(ring, &val) == 0) {
+        TEST_ASSERT(val == event_test_evring_drained);
+        event_test_evring_drained++;
+    }
+}
+
+/**
+ * Tests pushing to and draining an event ring.  Pushing does not block, so
+ * this runs without starting the OS.
+ */
+TEST_CASE_SELF(event_test_evring)
+{
+    struct os_event *evp;
+    uint32_t val;
+    int rc;
+
+    os_eventq_init(&my_eventq);
+    event_test_evring_drained = 0;
+
+    rc = os_evring_init(&event_test_ring, &my_eventq, event_test_evring_buf,
+                        sizeof(uint32_t), 3, event_test_evring_cb, NULL);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    rc = os_evring_init(&event_test_ring, &my_eventq, event_test_evring_buf,
+                        sizeof(uint32_t), EVENT_TEST_EVRING_CNT,
+                        event_test_evring_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Fill the ring; the drain event is posted once. */
+    for (val = 0; val < EVENT_TEST_EVRING_CNT; val++) {
+        rc = os_evring_push(&event_test_ring, &val);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = os_evring_push(&event_test_ring, &val);
+    TEST_ASSERT(rc == OS_ENOMEM);
+    TEST_ASSERT(event_test_ring.er_drops == 1);
+    TEST_ASSERT(os_evring_len(&event_test_ring) == EVENT_TEST_EVRING_CNT);
+
+    evp = os_eventq_get_no_wait(&my_eventq);
+    TEST_ASSERT_FATAL(evp == &event_test_ring.er_ev);
+    TEST_ASSERT(os_eventq_get_no_wait(&my_eventq) == NULL);
+
+    evp->ev_cb(evp);
+    TEST_ASSERT(event_test_evring_drained == EVENT_TEST_EVRING_CNT);
+    TEST_ASSERT(os_evring_len(&event_test_ring) == 0);
+
+    /* Once drained, the next push posts the event again. */
+    val = EVENT_TEST_EVRING_CNT;
+    rc = os_evring_push(&event_test_ring, &val);
+    TEST_ASSERT(rc == 0);
+    evp = os_eventq_get_no_wait(&my_eventq);
+    TEST_ASSERT_FATAL(evp == &event_test_ring.er_ev);
+    evp->ev_cb(evp);
+    TEST_ASSERT(event_test_evring_drained == EVENT_TEST_EVRING_CNT + 1);
+}
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+static int event_test_mon_a_runs;
+
+static void
+event_test_mon_a(struct os_event *ev)
+{
+    event_test_mon_a_runs++;
+}
+
+static void
+event_test_mon_b(struct os_event *ev)
+{
+}
+
+static const struct os_eventq_mon *
+event_test_mon_find(struct os_eventq *evq, os_event_fn *cb)
+{
+    int i;
+
+    for (i = 0; i < evq->evq_mon_elems; i++) {
+        if (evq->evq_mon[i].em_cb == cb) {
+            return &evq->evq_mon[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int
+event_test_mon_listed(struct os_eventq *evq)
+{
+    struct os_eventq *cur;
+
+    cur = NULL;
+    while ((cur = os_eventq_mon_get_next(cur)) != NULL) {
+        if (cur == evq) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+/**
+ * Verifies that the eventq monitor accounts events per callback, and copes
+ * with a full table.
+ */
+TEST_CASE_TASK(event_test_mon)
+{
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    struct os_eventq_mon mon[4];
+    const struct os_eventq_mon *em;
+    int rc;
+    int i;
+
+    os_eventq_init(&my_eventq);
+
+    rc = os_eventq_mon_start(&my_eventq, 3, mon);
+    TEST_ASSERT(rc == OS_EINVAL);
+    TEST_ASSERT(!event_test_mon_listed(&my_eventq));
+
+    rc = os_eventq_mon_start(&my_eventq, 4, mon);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(event_test_mon_listed(&my_eventq));
+
+    /*** Three events share a callback, the fourth has its own. */
+    event_test_mon_a_runs = 0;
+    for (i = 0; i < SIZE_MULTI_EVENT; i++) {
+        memset(&m_event[i], 0, sizeof m_event[i]);
+        m_event[i].ev_cb = i < 3 ? event_test_mon_a : event_test_mon_b;
+        os_eventq_put(&my_eventq, &m_event[i]);
+        TEST_ASSERT(m_event[i].ev_put_time != 0);
+    }
+    TEST_ASSERT(os_eventq_run_n(&my_eventq, SIZE_MULTI_EVENT) ==
+                SIZE_MULTI_EVENT);
+    TEST_ASSERT(event_test_mon_a_runs == 3);
+
+    em = event_test_mon_find(&my_eventq, event_test_mon_a);
+    TEST_ASSERT_FATAL(em != NULL);
+    TEST_ASSERT(em->em_cnt == 3);
+    TEST_ASSERT(em->em_max >= em->em_min);
+    TEST_ASSERT(em->em_cum >= em->em_max);
+    TEST_ASSERT(em->em_qcum >= em->em_qmax);
+
+    em = event_test_mon_find(&my_eventq, event_test_mon_b);
+    TEST_ASSERT_FATAL(em != NULL);
+    TEST_ASSERT(em->em_cnt == 1);
+    TEST_ASSERT(my_eventq.evq_mon_miss == 0);
+
+    /*** Clearing forgets the callbacks. */
+    os_eventq_mon_clear(&my_eventq);
+    TEST_ASSERT(event_test_mon_find(&my_eventq, event_test_mon_a) == NULL);
+
+    /*** Calls to callbacks that do not fit are counted as missed. */
+    rc = os_eventq_mon_start(&my_eventq, 1, mon);
+    TEST_ASSERT_FATAL(rc == 0);
+    os_eventq_put(&my_eventq, &m_event[0]);
+    os_eventq_put(&my_eventq, &m_event[3]);
+    TEST_ASSERT(os_eventq_run_n(&my_eventq, 2) == 2);
+    TEST_ASSERT(mon[0].em_cb == event_test_mon_a);
+    TEST_ASSERT(mon[0].em_cnt == 1);
+    TEST_ASSERT(my_eventq.evq_mon_miss == 1);
+
+    /*** Reinitializing a monitored queue takes it off the list. */
+    os_eventq_init(&my_eventq);
+    TEST_ASSERT(!event_test_mon_listed(&my_eventq));
+
+    rc = os_eventq_mon_start(&my_eventq, 4, mon);
+    TEST_ASSERT_FATAL(rc == 0);
+    os_eventq_mon_stop(&my_eventq);
+    TEST_ASSERT(!event_test_mon_listed(&my_eventq));
+    TEST_ASSERT(my_eventq.evq_mon == NULL);
+#endif
+}
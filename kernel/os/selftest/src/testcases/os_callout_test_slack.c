@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+static struct os_eventq callout_slack_evq;
+static struct os_callout callout_slack_a;
+static struct os_callout callout_slack_b;
+
+/* Test that slack postpones the idle wakeup, and coalesces callouts */
+TEST_CASE_SELF(callout_test_slack)
+{
+    struct os_idle_info oii;
+    os_time_t base;
+    os_time_t now;
+    os_time_t tm;
+    os_sr_t sr;
+
+    os_eventq_init(&callout_slack_evq);
+    os_callout_init(&callout_slack_a, &callout_slack_evq, my_callout, NULL);
+    os_callout_init(&callout_slack_b, &callout_slack_evq, my_callout, NULL);
+
+    /* Time does not advance while interrupts are disabled. */
+    OS_ENTER_CRITICAL(sr);
+    now = os_time_get();
+    base = os_callout_wakeup_ticks(now);
+
+    os_callout_set_slack(&callout_slack_a, 20);
+    os_callout_reset(&callout_slack_a, 10);
+    tm = os_callout_wakeup_ticks(now);
+    TEST_ASSERT(tm == min(base, 30));
+
+    /* A callout without slack inside a's window sets the wakeup time. */
+    os_callout_reset(&callout_slack_b, 12);
+    tm = os_callout_wakeup_ticks(now);
+    TEST_ASSERT(tm == min(base, 12));
+
+    /* Slack on b as well; a runs out of slack first. */
+    os_callout_set_slack(&callout_slack_b, 40);
+    os_callout_reset(&callout_slack_b, 12);
+    tm = os_callout_wakeup_ticks(now);
+    TEST_ASSERT(tm == min(base, 30));
+
+    os_callout_stop(&callout_slack_a);
+    tm = os_callout_wakeup_ticks(now);
+    TEST_ASSERT(tm == min(base, 52));
+
+    os_callout_stop(&callout_slack_b);
+    tm = os_callout_wakeup_ticks(now);
+    TEST_ASSERT(tm == base);
+    OS_EXIT_CRITICAL(sr);
+
+    /* Let the idle task run at least once. */
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    os_idle_info_get(&oii);
+    TEST_ASSERT(oii.oii_wakeups > 0);
+}
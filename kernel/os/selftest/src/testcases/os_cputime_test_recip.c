@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+#if defined(OS_CPUTIME_FREQ_RECIP)
+
+static const uint32_t otcr_freqs[] = {
+    32768, 32000, 3000000, 12000000, 16384000, 24576000, 26000000, 38400000,
+};
+
+static uint32_t
+otcr_gcd(uint32_t a, uint32_t b)
+{
+    uint32_t t;
+
+    while (b != 0) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+static uint32_t
+otcr_ref(uint32_t x, uint32_t num, uint32_t den, bool up)
+{
+    uint64_t prod;
+
+    prod = (uint64_t)x * num;
+
+    return (prod + (up ? den - 1 : 0)) / den;
+}
+
+/*
+ * Checks conv(x) == x * num / den, rounded down or up, for every 32-bit x.
+ *
+ * The fractional part of x * num / den only depends on x modulo
+ * den / gcd(num, den), while the error of the fixed-point ratio grows with
+ * x.  The largest x of each residue class is thus the hardest case, and
+ * the top den / gcd(num, den) inputs cover all of them.
+ */
+static void
+otcr_check(uint32_t (*conv)(uint32_t), uint32_t num, uint32_t den, bool up)
+{
+    uint32_t period;
+    uint32_t x;
+
+    period = den / otcr_gcd(num, den);
+
+    for (x = 0; x < 0x10000; x++) {
+        if (conv(x) != otcr_ref(x, num, den, up)) {
+            TEST_ASSERT_FATAL(0, "%u * %u / %u: %u != %u",
+                              (unsigned)x, (unsigned)num, (unsigned)den,
+                              (unsigned)conv(x),
+                              (unsigned)otcr_ref(x, num, den, up));
+        }
+    }
+
+    x = UINT32_MAX - period;
+    do {
+        x++;
+        if (conv(x) != otcr_ref(x, num, den, up)) {
+            TEST_ASSERT_FATAL(0, "%u * %u / %u: %u != %u",
+                              (unsigned)x, (unsigned)num, (unsigned)den,
+                              (unsigned)conv(x),
+                              (unsigned)otcr_ref(x, num, den, up));
+        }
+    } while (x != UINT32_MAX);
+}
+#endif
+
+TEST_CASE_SELF(os_cputime_test_recip)
+{
+#if defined(OS_CPUTIME_FREQ_RECIP)
+    uint32_t freq;
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(otcr_freqs) / sizeof(otcr_freqs[0]); i++) {
+        freq = otcr_freqs[i];
+        rc = os_cputime_init(freq);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        otcr_check(os_cputime_usecs_to_ticks, freq, 1000000, false);
+        otcr_check(os_cputime_ticks_to_usecs, 1000000, freq, true);
+        otcr_check(os_cputime_nsecs_to_ticks, freq, 1000000000, true);
+        otcr_check(os_cputime_ticks_to_nsecs, 1000000000, freq, true);
+    }
+
+    rc = os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+    TEST_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#define EVFL_TEST_PRIO_WAITER   (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define EVFL_TEST_PRIO_SETTER   (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 3)
+
+#define EVFL_TEST_A             (1 << 0)
+#define EVFL_TEST_B             (1 << 1)
+#define EVFL_TEST_C             (1 << 2)
+
+static struct os_event_flags evfl_test_ef;
+
+static void
+evfl_test_waiter_handler(void *arg)
+{
+    uint32_t flags;
+    os_error_t err;
+
+    /* Wait-any; flags are left in place. */
+    err = os_event_flags_wait(&evfl_test_ef, EVFL_TEST_A | EVFL_TEST_B,
+                              OS_EVENT_FLAGS_ANY, OS_TIMEOUT_NEVER, &flags);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(flags == EVFL_TEST_B);
+    TEST_ASSERT(os_event_flags_get(&evfl_test_ef) == EVFL_TEST_B);
+    g_task1_val = 1;
+
+    /* Wait-all with clear; B is already set, the setter provides A. */
+    err = os_event_flags_wait(&evfl_test_ef, EVFL_TEST_A | EVFL_TEST_B,
+                              OS_EVENT_FLAGS_ALL | OS_EVENT_FLAGS_CLEAR,
+                              OS_TIMEOUT_NEVER, &flags);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(flags == (EVFL_TEST_A | EVFL_TEST_B | EVFL_TEST_C));
+    TEST_ASSERT(os_event_flags_get(&evfl_test_ef) == EVFL_TEST_C);
+    g_task1_val = 2;
+
+    /* Nobody sets B; time out. */
+    err = os_event_flags_wait(&evfl_test_ef, EVFL_TEST_B, OS_EVENT_FLAGS_ANY,
+                              OS_TICKS_PER_SEC / 20, &flags);
+    TEST_ASSERT(err == OS_TIMEOUT);
+    TEST_ASSERT(flags == EVFL_TEST_C);
+    TEST_ASSERT(SLIST_EMPTY(&evfl_test_ef.oef_waiters));
+}
+
+static void
+evfl_test_setter_handler(void *arg)
+{
+    os_error_t err;
+
+    os_time_delay(OS_TICKS_PER_SEC / 20);
+    TEST_ASSERT(g_task1_val == 0);
+
+    /* Wakes the higher priority waiter immediately. */
+    err = os_event_flags_set(&evfl_test_ef, EVFL_TEST_B);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(g_task1_val == 1);
+
+    /* C alone does not satisfy the wait-all. */
+    os_event_flags_set(&evfl_test_ef, EVFL_TEST_C);
+    TEST_ASSERT(g_task1_val == 1);
+    TEST_ASSERT(!SLIST_EMPTY(&evfl_test_ef.oef_waiters));
+
+    os_event_flags_set(&evfl_test_ef, EVFL_TEST_A);
+    TEST_ASSERT(g_task1_val == 2);
+}
+
+TEST_CASE_TASK(os_event_flags_test_wait)
+{
+    uint32_t flags;
+    int rc;
+
+    g_task1_val = 0;
+
+    TEST_ASSERT(os_event_flags_init(NULL, 0) == OS_INVALID_PARM);
+    rc = os_event_flags_init(&evfl_test_ef, 0);
+    TEST_ASSERT(rc == 0);
+
+    TEST_ASSERT(os_event_flags_wait(&evfl_test_ef, 0, OS_EVENT_FLAGS_ANY,
+                                    0, NULL) == OS_INVALID_PARM);
+    TEST_ASSERT(os_event_flags_wait(&evfl_test_ef, EVFL_TEST_A,
+                                    OS_EVENT_FLAGS_ANY, 0,
+                                    &flags) == OS_TIMEOUT);
+    TEST_ASSERT(flags == 0);
+
+    taskpool_alloc_assert(evfl_test_waiter_handler, EVFL_TEST_PRIO_WAITER);
+    taskpool_alloc_assert(evfl_test_setter_handler, EVFL_TEST_PRIO_SETTER);
+
+    taskpool_wait_assert(200);
+}
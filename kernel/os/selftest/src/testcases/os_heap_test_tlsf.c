@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os_test_priv.h"
+
+#define HEAP_TEST_NUM_BLOCKS    (32)
+
+static void *heap_test_blocks[HEAP_TEST_NUM_BLOCKS];
+
+static size_t
+heap_test_size(int i)
+{
+    return i * 13 + 1;
+}
+
+static int
+heap_test_check(const uint8_t *p, size_t len, uint8_t val)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (p[i] != val) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+TEST_CASE_SELF(os_heap_test_tlsf)
+{
+    struct os_heap_info base;
+    struct os_heap_info ohi;
+    uint8_t *p;
+    uint8_t *q;
+    int rc;
+    int i;
+
+    rc = os_heap_info_get(&base);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(base.ohi_total >= base.ohi_free);
+    TEST_ASSERT(base.ohi_max_free_blk <= base.ohi_free);
+
+    /*** Allocate blocks of assorted sizes. */
+    for (i = 0; i < HEAP_TEST_NUM_BLOCKS; i++) {
+        heap_test_blocks[i] = os_malloc(heap_test_size(i));
+        TEST_ASSERT_FATAL(heap_test_blocks[i] != NULL);
+        TEST_ASSERT(((uintptr_t)heap_test_blocks[i] & 7) == 0);
+        memset(heap_test_blocks[i], i, heap_test_size(i));
+    }
+
+    rc = os_heap_info_get(&ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi.ohi_free < base.ohi_free);
+    TEST_ASSERT(ohi.ohi_min_free <= ohi.ohi_free);
+    TEST_ASSERT(ohi.ohi_num_used_blks ==
+                base.ohi_num_used_blks + HEAP_TEST_NUM_BLOCKS);
+
+    /*** Punch holes; the heap becomes fragmented. */
+    for (i = 0; i < HEAP_TEST_NUM_BLOCKS; i += 2) {
+        os_free(heap_test_blocks[i]);
+        heap_test_blocks[i] = NULL;
+    }
+
+    rc = os_heap_info_get(&ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi.ohi_num_free_blks > base.ohi_num_free_blks);
+    TEST_ASSERT(ohi.ohi_frag_pct > 0);
+
+    for (i = 1; i < HEAP_TEST_NUM_BLOCKS; i += 2) {
+        TEST_ASSERT(heap_test_check(heap_test_blocks[i],
+                                    heap_test_size(i), i));
+    }
+
+    /*** Free the rest; neighbours coalesce back to the original state. */
+    for (i = 1; i < HEAP_TEST_NUM_BLOCKS; i += 2) {
+        os_free(heap_test_blocks[i]);
+        heap_test_blocks[i] = NULL;
+    }
+
+    rc = os_heap_info_get(&ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi.ohi_free == base.ohi_free);
+    TEST_ASSERT(ohi.ohi_max_free_blk == base.ohi_max_free_blk);
+    TEST_ASSERT(ohi.ohi_num_free_blks == base.ohi_num_free_blks);
+    TEST_ASSERT(ohi.ohi_num_used_blks == base.ohi_num_used_blks);
+
+    /*** Oversized requests fail and are counted. */
+    TEST_ASSERT(os_malloc(base.ohi_total + 1) == NULL);
+    p = os_realloc(NULL, base.ohi_max_free_blk + 1);
+    TEST_ASSERT(p == NULL);
+    rc = os_heap_info_get(&ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi.ohi_num_fail == base.ohi_num_fail + 2);
+
+    /*** Realloc grows into the following free block and shrinks in place. */
+    p = os_malloc(64);
+    TEST_ASSERT_FATAL(p != NULL);
+    memset(p, 0xa5, 64);
+
+    q = os_realloc(p, 256);
+    TEST_ASSERT_FATAL(q != NULL);
+    TEST_ASSERT(q == p);
+    TEST_ASSERT(heap_test_check(q, 64, 0xa5));
+
+    q = os_realloc(q, 16);
+    TEST_ASSERT_FATAL(q == p);
+    TEST_ASSERT(heap_test_check(q, 16, 0xa5));
+
+    /*** Realloc moves the data when the neighbour is taken. */
+    p = os_malloc(32);
+    TEST_ASSERT_FATAL(p != NULL);
+    q = os_realloc(q, 512);
+    TEST_ASSERT_FATAL(q != NULL);
+    TEST_ASSERT(heap_test_check(q, 16, 0xa5));
+
+    os_free(p);
+    os_free(q);
+
+    rc = os_heap_info_get(&ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi.ohi_free == base.ohi_free);
+    TEST_ASSERT(ohi.ohi_num_free_blks == base.ohi_num_free_blks);
+}
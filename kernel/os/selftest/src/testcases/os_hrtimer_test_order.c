@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#define HRTIMER_TEST_PRIO       (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define HRTIMER_TEST_NUM        4
+
+static struct os_eventq hrtimer_test_evq;
+static struct os_hrtimer hrtimer_test_timers[HRTIMER_TEST_NUM];
+static struct os_hrtimer hrtimer_test_isr_timer;
+static volatile int hrtimer_test_isr_cnt;
+
+static void
+hrtimer_test_isr_cb(struct os_event *ev)
+{
+    hrtimer_test_isr_cnt++;
+}
+
+static void
+hrtimer_test_task_cb(struct os_event *ev)
+{
+}
+
+static void
+hrtimer_test_handler(void *arg)
+{
+    static const uint32_t usecs[HRTIMER_TEST_NUM] = {
+        30000, 10000, 40000, 20000
+    };
+    static const int order[] = { 1, 3, 0 };
+    struct os_event *ev;
+    uint32_t start;
+    int rc;
+    int i;
+
+    os_eventq_init(&hrtimer_test_evq);
+    for (i = 0; i < HRTIMER_TEST_NUM; i++) {
+        os_hrtimer_init(&hrtimer_test_timers[i], &hrtimer_test_evq,
+                        hrtimer_test_task_cb, &hrtimer_test_timers[i]);
+    }
+    os_hrtimer_init(&hrtimer_test_isr_timer, NULL, hrtimer_test_isr_cb,
+                    NULL);
+
+    start = os_cputime_get32();
+    for (i = 0; i < HRTIMER_TEST_NUM; i++) {
+        rc = os_hrtimer_start(&hrtimer_test_timers[i],
+                              start + os_cputime_usecs_to_ticks(usecs[i]));
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(os_hrtimer_queued(&hrtimer_test_timers[i]));
+    }
+    rc = os_hrtimer_relative(&hrtimer_test_isr_timer, 5000);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The last one to expire is stopped. */
+    os_hrtimer_stop(&hrtimer_test_timers[2]);
+    TEST_ASSERT(!os_hrtimer_queued(&hrtimer_test_timers[2]));
+
+    /* Timers expire in order of expiry, not of starting. */
+    for (i = 0; i < ARRAY_SIZE(order); i++) {
+        ev = os_eventq_get(&hrtimer_test_evq);
+        TEST_ASSERT(ev->ev_arg == &hrtimer_test_timers[order[i]]);
+        TEST_ASSERT(CPUTIME_GEQ(os_cputime_get32(),
+                                start +
+                                os_cputime_usecs_to_ticks(usecs[order[i]])));
+        TEST_ASSERT(!os_hrtimer_queued(&hrtimer_test_timers[order[i]]));
+    }
+    TEST_ASSERT(hrtimer_test_isr_cnt == 1);
+
+    os_time_delay(os_time_ms_to_ticks32(30));
+    TEST_ASSERT(os_eventq_get_no_wait(&hrtimer_test_evq) == NULL);
+}
+
+TEST_CASE_TASK(os_hrtimer_test_order)
+{
+    hrtimer_test_isr_cnt = 0;
+
+    taskpool_alloc_assert(hrtimer_test_handler, HRTIMER_TEST_PRIO);
+    taskpool_wait_assert(200);
+}
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_clone)
+{
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    struct os_mbuf *clone2;
+    struct os_mbuf *clone;
+    struct os_mbuf *om;
+    uint8_t buf[4] = { 0xde, 0xad, 0xbe, 0xef };
+    int rc;
+
+    os_mbuf_test_setup();
+
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 200);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Clone shares the data block. */
+    clone = os_mbuf_clone(om);
+    TEST_ASSERT_FATAL(clone != NULL);
+    TEST_ASSERT(clone != om);
+    TEST_ASSERT(clone->om_data == om->om_data);
+    TEST_ASSERT(OS_MBUF_PKTLEN(clone) == 200);
+    TEST_ASSERT(OS_MBUF_CLONE_SRC(clone) == om);
+    TEST_ASSERT(om->om_refcnt == 2);
+    TEST_ASSERT(OS_MBUF_IS_SHARED(om));
+    TEST_ASSERT(OS_MBUF_IS_SHARED(clone));
+    TEST_ASSERT(OS_MBUF_TRAILINGSPACE(om) == 0);
+    TEST_ASSERT(OS_MBUF_LEADINGSPACE(clone) == 0);
+    TEST_ASSERT(os_mbuf_pool.omp_num_shared == 1);
+    TEST_ASSERT(os_mbuf_pool.omp_num_clones == 1);
+
+    /*** A clone of a clone refers to the original block. */
+    clone2 = os_mbuf_clone(clone);
+    TEST_ASSERT_FATAL(clone2 != NULL);
+    TEST_ASSERT(OS_MBUF_CLONE_SRC(clone2) == om);
+    TEST_ASSERT(om->om_refcnt == 3);
+    TEST_ASSERT(os_mbuf_pool.omp_num_shared == 1);
+    TEST_ASSERT(os_mbuf_pool.omp_num_clones == 2);
+
+    /*** Writing to a clone copies its data first. */
+    rc = os_mbuf_copyinto(clone, 10, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(clone->om_data != om->om_data);
+    TEST_ASSERT(!(clone->om_flags & OS_MBUF_F_CLONE));
+    TEST_ASSERT(om->om_refcnt == 2);
+    TEST_ASSERT(os_mbuf_pool.omp_num_clones == 1);
+    TEST_ASSERT(os_mbuf_cmpf(clone, 0, os_mbuf_test_data, 10) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(clone, 10, buf, sizeof buf) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(clone, 14, os_mbuf_test_data + 14, 186) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 200) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(clone2, 0, os_mbuf_test_data, 200) == 0);
+
+    /*** Writing to the shared original moves its data to a new mbuf. */
+    rc = os_mbuf_copyinto(om, 0, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(om->om_len == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 200);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, buf, sizeof buf) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 4, os_mbuf_test_data + 4, 196) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(clone2, 0, os_mbuf_test_data, 200) == 0);
+
+    /*** Growing a shared chain allocates rather than writing in place. */
+    rc = os_mbuf_append(clone2, os_mbuf_test_data + 200, 20);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(SLIST_NEXT(clone2, om_next) != NULL);
+    TEST_ASSERT(os_mbuf_cmpf(clone2, 0, os_mbuf_test_data, 220) == 0);
+
+    /*** The shared block is released with its last user. */
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_pool.omp_num_shared == 0);
+    TEST_ASSERT(os_mbuf_cmpf(clone2, 0, os_mbuf_test_data, 220) == 0);
+
+    rc = os_mbuf_free_chain(clone);
+    TEST_ASSERT(rc == 0);
+    rc = os_mbuf_free_chain(clone2);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_pool.omp_num_clones == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+#endif
+}
@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_compact)
+{
+    struct os_mbuf *chain;
+    struct os_mbuf *om;
+    int freed;
+    int rc;
+    int i;
+
+    os_mbuf_test_setup();
+
+    /*** An empty chain is left alone. */
+    TEST_ASSERT(os_mbuf_compact(NULL) == 0);
+
+    /*** Four partially filled mbufs fit in one. */
+    chain = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(chain != NULL);
+    rc = os_mbuf_append(chain, os_mbuf_test_data, 40);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 1; i < 4; i++) {
+        om = os_mbuf_get(&os_mbuf_pool, 16 * i);
+        TEST_ASSERT_FATAL(om != NULL);
+        memcpy(om->om_data, os_mbuf_test_data + 40 * i, 40);
+        om->om_len = 40;
+        os_mbuf_concat(chain, om);
+    }
+    TEST_ASSERT(OS_MBUF_PKTLEN(chain) == 160);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT - 4);
+
+    freed = os_mbuf_compact(chain);
+    TEST_ASSERT(freed == 3);
+    TEST_ASSERT(SLIST_NEXT(chain, om_next) == NULL);
+    TEST_ASSERT(chain->om_len == 160);
+    TEST_ASSERT(OS_MBUF_PKTLEN(chain) == 160);
+    TEST_ASSERT(os_mbuf_cmpf(chain, 0, os_mbuf_test_data, 160) == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT - 1);
+
+    /*** A packed chain stays as it is. */
+    TEST_ASSERT(os_mbuf_compact(chain) == 0);
+
+    /*** Data spilling over a block boundary needs two blocks. */
+    for (i = 0; i < 3; i++) {
+        om = os_mbuf_get(&os_mbuf_pool, 0);
+        TEST_ASSERT_FATAL(om != NULL);
+        memcpy(om->om_data, os_mbuf_test_data + 160 + 100 * i, 100);
+        om->om_len = 100;
+        os_mbuf_concat(chain, om);
+    }
+    TEST_ASSERT(OS_MBUF_PKTLEN(chain) == 460);
+
+    freed = os_mbuf_compact(chain);
+    TEST_ASSERT(freed == 2);
+    TEST_ASSERT_FATAL(SLIST_NEXT(chain, om_next) != NULL);
+    TEST_ASSERT(SLIST_NEXT(SLIST_NEXT(chain, om_next), om_next) == NULL);
+    TEST_ASSERT(os_mbuf_len(chain) == 460);
+    TEST_ASSERT(os_mbuf_cmpf(chain, 0, os_mbuf_test_data, 460) == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT - 2);
+
+    os_mbuf_free_chain(chain);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+}
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+static int os_mbuf_test_ext_freed;
+
+static void
+os_mbuf_test_ext_free_cb(struct os_mbuf_ext *ext)
+{
+    TEST_ASSERT(ext->ome_arg == os_mbuf_test_data);
+    os_mbuf_test_ext_freed++;
+}
+
+TEST_CASE_SELF(os_mbuf_test_ext)
+{
+    struct os_mbuf_ext ext;
+    struct os_mbuf *om;
+    struct os_mbuf *dup;
+    uint8_t buf[150];
+    int rc;
+
+    os_mbuf_test_setup();
+    os_mbuf_test_ext_freed = 0;
+    os_mbuf_ext_init(&ext, os_mbuf_test_ext_free_cb, os_mbuf_test_data);
+
+    /*** Attach external storage to a packet header mbuf. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    rc = os_mbuf_ext_attach(om, &ext, os_mbuf_test_data, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_IS_EXT(om));
+    TEST_ASSERT(OS_MBUF_EXT(om) == &ext);
+    TEST_ASSERT(om->om_data == os_mbuf_test_data);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 100);
+    TEST_ASSERT(OS_MBUF_LEADINGSPACE(om) == 0);
+    TEST_ASSERT(OS_MBUF_TRAILINGSPACE(om) == 0);
+    TEST_ASSERT(ext.ome_refcnt == 1);
+
+    /* Attaching twice is rejected. */
+    rc = os_mbuf_ext_attach(om, &ext, os_mbuf_test_data, 100);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    /*** Appending goes into a new mbuf, not the external storage. */
+    rc = os_mbuf_append(om, os_mbuf_test_data + 100, 50);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(SLIST_NEXT(om, om_next) != NULL);
+    TEST_ASSERT(!OS_MBUF_IS_EXT(SLIST_NEXT(om, om_next)));
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 150);
+
+    rc = os_mbuf_copydata(om, 0, 150, buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data, 150) == 0);
+
+    /*** Duplicate shares the storage. */
+    dup = os_mbuf_dup(om);
+    TEST_ASSERT_FATAL(dup != NULL);
+    TEST_ASSERT(OS_MBUF_IS_EXT(dup));
+    TEST_ASSERT(dup->om_data == om->om_data);
+    TEST_ASSERT(ext.ome_refcnt == 2);
+    TEST_ASSERT(os_mbuf_cmpf(dup, 0, os_mbuf_test_data, 150) == 0);
+
+    /*** Trimming the front moves the data pointer within the storage. */
+    os_mbuf_adj(om, 10);
+    TEST_ASSERT(om->om_data == os_mbuf_test_data + 10);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 140);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data + 10, 140) == 0);
+
+    /*** Storage is released with the last reference. */
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ext.ome_refcnt == 1);
+    TEST_ASSERT(os_mbuf_test_ext_freed == 0);
+
+    rc = os_mbuf_free_chain(dup);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ext.ome_refcnt == 0);
+    TEST_ASSERT(os_mbuf_test_ext_freed == 1);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+
+    /*** Non-empty mbufs cannot be attached. */
+    om = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_ext_attach(om, &ext, os_mbuf_test_data, 100);
+    TEST_ASSERT(rc == OS_EINVAL);
+    os_mbuf_free_chain(om);
+}
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_iovec)
+{
+    struct os_mbuf_iovec iov[4];
+    struct os_mbuf_iter it;
+    struct os_mbuf *om;
+    struct os_mbuf *om2;
+    struct os_mbuf *om3;
+    uint16_t seg_len;
+    void *data;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    /* Build a chain of 100, 0 and 50 bytes. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om2 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om2 != NULL);
+    os_mbuf_concat(om, om2);
+
+    om3 = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om3 != NULL);
+    rc = os_mbuf_append(om3, os_mbuf_test_data + 100, 50);
+    TEST_ASSERT_FATAL(rc == 0);
+    os_mbuf_concat(om, om3);
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(om) == 150);
+
+    /*** Iterate over a range spanning all mbufs; empty ones are skipped. */
+    rc = os_mbuf_iter_init(&it, om, 90, 20);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    seg_len = os_mbuf_iter_next(&it, &data);
+    TEST_ASSERT(seg_len == 10);
+    TEST_ASSERT(data == om->om_data + 90);
+
+    seg_len = os_mbuf_iter_next(&it, &data);
+    TEST_ASSERT(seg_len == 10);
+    TEST_ASSERT(data == om3->om_data);
+
+    TEST_ASSERT(os_mbuf_iter_next(&it, &data) == 0);
+
+    /*** Same range as an iovec. */
+    rc = os_mbuf_to_iovec(om, 90, 20, iov, 4);
+    TEST_ASSERT_FATAL(rc == 2);
+    TEST_ASSERT(iov[0].omv_base == om->om_data + 90);
+    TEST_ASSERT(iov[0].omv_len == 10);
+    TEST_ASSERT(iov[1].omv_base == om3->om_data);
+    TEST_ASSERT(iov[1].omv_len == 10);
+
+    /*** Range within a single mbuf. */
+    rc = os_mbuf_to_iovec(om, 110, 40, iov, 4);
+    TEST_ASSERT_FATAL(rc == 1);
+    TEST_ASSERT(iov[0].omv_base == om3->om_data + 10);
+    TEST_ASSERT(iov[0].omv_len == 40);
+
+    /*** Too few entries. */
+    rc = os_mbuf_to_iovec(om, 0, 150, iov, 1);
+    TEST_ASSERT(rc == OS_ENOMEM);
+
+    /*** Range past the end of the chain. */
+    rc = os_mbuf_to_iovec(om, 100, 51, iov, 4);
+    TEST_ASSERT(rc == OS_EINVAL);
+    rc = os_mbuf_iter_init(&it, om, 151, 0);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    os_mbuf_free_chain(om);
+}
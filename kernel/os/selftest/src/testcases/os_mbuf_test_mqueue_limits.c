@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+#include "os_test_priv.h"
+
+#define MQUEUE_TEST_HIGH    (3)
+#define MQUEUE_TEST_LOW     (1)
+
+static int os_mbuf_test_mqueue_space_cnt;
+
+static void
+os_mbuf_test_mqueue_ev_cb(struct os_event *ev)
+{
+}
+
+static void
+os_mbuf_test_mqueue_space_cb(struct os_mqueue *mq, void *arg)
+{
+    os_mbuf_test_mqueue_space_cnt++;
+}
+
+TEST_CASE_SELF(os_mbuf_test_mqueue_limits)
+{
+    struct os_mqueue mq;
+    struct os_mbuf *om;
+    int rc;
+    int i;
+
+    os_mbuf_test_setup();
+    os_mbuf_test_mqueue_space_cnt = 0;
+
+    rc = os_mqueue_init(&mq, os_mbuf_test_mqueue_ev_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Low watermark must be below the high one. */
+    rc = os_mqueue_set_limits(&mq, MQUEUE_TEST_HIGH, MQUEUE_TEST_HIGH,
+                              NULL, NULL);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    rc = os_mqueue_set_limits(&mq, MQUEUE_TEST_HIGH, MQUEUE_TEST_LOW,
+                              os_mbuf_test_mqueue_space_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Puts beyond the high watermark are refused. */
+    for (i = 0; i < MQUEUE_TEST_HIGH; i++) {
+        om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+        TEST_ASSERT_FATAL(om != NULL);
+        rc = os_mqueue_put(&mq, NULL, om);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mqueue_put(&mq, NULL, om);
+    TEST_ASSERT(rc == OS_EBUSY);
+    rc = os_mqueue_put_wait(&mq, NULL, om, 0);
+    TEST_ASSERT(rc == OS_EBUSY);
+
+    /*** Producers resume only once the queue drains to the low mark. */
+    for (i = MQUEUE_TEST_HIGH; i > MQUEUE_TEST_LOW; i--) {
+        TEST_ASSERT(os_mbuf_test_mqueue_space_cnt == 0);
+        os_mbuf_free_chain(os_mqueue_get(&mq));
+    }
+    TEST_ASSERT(os_mbuf_test_mqueue_space_cnt == 1);
+
+    rc = os_mqueue_put_wait(&mq, NULL, om, 0);
+    TEST_ASSERT(rc == 0);
+
+    /*** Removing the bound accepts any number of packets. */
+    rc = os_mqueue_set_limits(&mq, 0, 0, NULL, NULL);
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < MQUEUE_TEST_HIGH; i++) {
+        om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+        TEST_ASSERT_FATAL(om != NULL);
+        rc = os_mqueue_put(&mq, NULL, om);
+        TEST_ASSERT(rc == 0);
+    }
+
+    while ((om = os_mqueue_get(&mq)) != NULL) {
+        os_mbuf_free_chain(om);
+    }
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+}
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define MBUF_TEST_SMALL_BUF_SIZE    (64)
+#define MBUF_TEST_SMALL_BUF_COUNT   (4)
+
+static os_membuf_t os_mbuf_test_small_membuf[
+    OS_MEMPOOL_SIZE(MBUF_TEST_SMALL_BUF_COUNT, MBUF_TEST_SMALL_BUF_SIZE)];
+static struct os_mempool os_mbuf_test_small_mempool;
+static struct os_mbuf_pool os_mbuf_test_small_pool;
+
+TEST_CASE_SELF(os_mbuf_test_msys)
+{
+    struct os_mbuf *small[MBUF_TEST_SMALL_BUF_COUNT];
+    struct os_mbuf *om;
+    struct os_mbuf *chain;
+    uint16_t len;
+    int rc;
+    int i;
+
+    os_mbuf_test_setup();
+
+    os_mempool_unregister(&os_mbuf_test_small_mempool);
+    rc = os_mempool_init(&os_mbuf_test_small_mempool,
+                         MBUF_TEST_SMALL_BUF_COUNT, MBUF_TEST_SMALL_BUF_SIZE,
+                         os_mbuf_test_small_membuf, "mbuf_small");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&os_mbuf_test_small_pool,
+                           &os_mbuf_test_small_mempool,
+                           MBUF_TEST_SMALL_BUF_SIZE,
+                           MBUF_TEST_SMALL_BUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_msys_reset();
+    os_msys_register(&os_mbuf_pool);
+    os_msys_register(&os_mbuf_test_small_pool);
+
+    /*** Pools are ordered by block size. */
+    TEST_ASSERT(os_msys_pool_get_next(NULL) == &os_mbuf_test_small_pool);
+    TEST_ASSERT(os_msys_pool_get_next(&os_mbuf_test_small_pool) ==
+                &os_mbuf_pool);
+    TEST_ASSERT(os_msys_pool_get_next(&os_mbuf_pool) == NULL);
+
+    /*** Small requests come from the small pool until it is exhausted. */
+    for (i = 0; i < MBUF_TEST_SMALL_BUF_COUNT; i++) {
+        small[i] = os_msys_get(10, 0);
+        TEST_ASSERT_FATAL(small[i] != NULL);
+        TEST_ASSERT(small[i]->om_omp == &os_mbuf_test_small_pool);
+    }
+
+    om = os_msys_get(10, 0);
+#if MYNEWT_VAL(MSYS_FALLBACK)
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp == &os_mbuf_pool);
+    TEST_ASSERT(os_mbuf_test_small_pool.omp_num_fallback == 1);
+    TEST_ASSERT(os_mbuf_test_small_pool.omp_num_fail == 0);
+    os_mbuf_free(om);
+#else
+    TEST_ASSERT(om == NULL);
+    TEST_ASSERT(os_mbuf_test_small_pool.omp_num_fail == 1);
+#endif
+
+    /*** A large chain spans several blocks. */
+    chain = os_msys_get_chain(600, 0);
+    TEST_ASSERT_FATAL(chain != NULL);
+    TEST_ASSERT(OS_MBUF_PKTLEN(chain) == 600);
+    TEST_ASSERT(os_mbuf_len(chain) == 600);
+    TEST_ASSERT(SLIST_NEXT(chain, om_next) != NULL);
+
+    rc = os_mbuf_copyinto(chain, 0, os_mbuf_test_data, 600);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(chain) == 600);
+    TEST_ASSERT(os_mbuf_cmpf(chain, 0, os_mbuf_test_data, 600) == 0);
+
+    /*** A chain falls back to smaller blocks when the big pool is empty. */
+    os_mbuf_free(small[0]);
+    os_mbuf_free(small[1]);
+    om = os_msys_get_chain(MBUF_TEST_POOL_BUF_SIZE *
+                           MBUF_TEST_POOL_BUF_COUNT, 0);
+    TEST_ASSERT(om == NULL);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free ==
+                MBUF_TEST_POOL_BUF_COUNT - 3);
+    TEST_ASSERT(os_mbuf_test_small_mempool.mp_num_free == 2);
+
+    /* Everything the big pool has left, plus a little. */
+    len = os_mbuf_mempool.mp_num_free * os_mbuf_pool.omp_databuf_len -
+          sizeof (struct os_mbuf_pkthdr) + 10;
+    om = os_msys_get_chain(len, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(os_mbuf_len(om) == len);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == 0);
+    TEST_ASSERT(os_mbuf_test_small_mempool.mp_num_free == 1);
+    os_mbuf_free_chain(om);
+
+    os_mbuf_free_chain(chain);
+    for (i = 2; i < MBUF_TEST_SMALL_BUF_COUNT; i++) {
+        os_mbuf_free(small[i]);
+    }
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+    TEST_ASSERT(os_mbuf_test_small_mempool.mp_num_free ==
+                MBUF_TEST_SMALL_BUF_COUNT);
+
+    os_msys_reset();
+}
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "os/os_budget.h"
+#include "os_test_priv.h"
+
+#define MEMPOOL_TEST_BUDGET_PEAK    (4)
+
+TEST_CASE_SELF(os_mempool_test_budget)
+{
+    struct os_mempool_budget omb;
+    struct os_mempool *mp;
+    uint16_t suggest;
+    int rc;
+    int i;
+
+    /* Attempt to unregister the pool in case this test has already run. */
+    os_mempool_unregister(&g_TstMempool);
+
+    rc = os_mempool_init(&g_TstMempool, NUM_MEM_BLOCKS, MEM_BLOCK_SIZE,
+                         TstMembuf, "TestMemPool");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Peak usage is remembered after the blocks are freed. */
+    for (i = 0; i < MEMPOOL_TEST_BUDGET_PEAK; i++) {
+        block_array[i] = os_memblock_get(&g_TstMempool);
+        TEST_ASSERT_FATAL(block_array[i] != NULL);
+    }
+    for (i = 0; i < MEMPOOL_TEST_BUDGET_PEAK; i++) {
+        rc = os_memblock_put(&g_TstMempool, block_array[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    mp = NULL;
+    while ((mp = os_mempool_budget_get_next(mp, &omb)) != NULL) {
+        if (mp == &g_TstMempool) {
+            break;
+        }
+    }
+    TEST_ASSERT_FATAL(mp == &g_TstMempool);
+
+    suggest = MEMPOOL_TEST_BUDGET_PEAK +
+              (MEMPOOL_TEST_BUDGET_PEAK * MYNEWT_VAL(OS_BUDGET_POOL_MARGIN) +
+               99) / 100;
+    if (suggest == MEMPOOL_TEST_BUDGET_PEAK) {
+        suggest++;
+    }
+
+    TEST_ASSERT(strcmp(omb.omb_name, "TestMemPool") == 0);
+    TEST_ASSERT(omb.omb_block_size == MEM_BLOCK_SIZE);
+    TEST_ASSERT(omb.omb_num_blocks == NUM_MEM_BLOCKS);
+    TEST_ASSERT(omb.omb_peak_blocks == MEMPOOL_TEST_BUDGET_PEAK);
+    TEST_ASSERT(omb.omb_suggest_blocks == suggest);
+    TEST_ASSERT(omb.omb_reclaim_bytes ==
+                (NUM_MEM_BLOCKS - suggest) *
+                OS_ALIGN(MEM_BLOCK_SIZE, OS_ALIGNMENT));
+
+    /*** An exhausted pool is suggested to grow. */
+    rc = os_memblock_get_n(&g_TstMempool, block_array, NUM_MEM_BLOCKS);
+    TEST_ASSERT_FATAL(rc == NUM_MEM_BLOCKS);
+    rc = os_memblock_put_n(&g_TstMempool, block_array, NUM_MEM_BLOCKS);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mp = NULL;
+    while ((mp = os_mempool_budget_get_next(mp, &omb)) != NULL) {
+        if (mp == &g_TstMempool) {
+            break;
+        }
+    }
+    TEST_ASSERT_FATAL(mp == &g_TstMempool);
+    TEST_ASSERT(omb.omb_peak_blocks == NUM_MEM_BLOCKS);
+    TEST_ASSERT(omb.omb_suggest_blocks > NUM_MEM_BLOCKS);
+    TEST_ASSERT(omb.omb_reclaim_bytes == 0);
+}
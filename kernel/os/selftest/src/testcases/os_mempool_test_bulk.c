@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+#define MEMPOOL_TEST_MAG_SIZE   (4)
+
+TEST_CASE_SELF(os_mempool_test_bulk)
+{
+    struct os_mempool_mag mag;
+    void *slots[MEMPOOL_TEST_MAG_SIZE];
+    void *block;
+    int rc;
+    int i;
+
+    /* Attempt to unregister the pool in case this test has already run. */
+    os_mempool_unregister(&g_TstMempool);
+
+    rc = os_mempool_init(&g_TstMempool, NUM_MEM_BLOCKS, MEM_BLOCK_SIZE,
+                         TstMembuf, "TestMemPool");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Bulk get; request more blocks than the pool holds. */
+    rc = os_memblock_get_n(&g_TstMempool, block_array, NUM_MEM_BLOCKS + 1);
+    TEST_ASSERT_FATAL(rc == NUM_MEM_BLOCKS);
+    TEST_ASSERT(g_TstMempool.mp_num_free == 0);
+    TEST_ASSERT(g_TstMempool.mp_min_free == 0);
+    for (i = 0; i < NUM_MEM_BLOCKS; i++) {
+        TEST_ASSERT(os_memblock_from(&g_TstMempool, block_array[i]));
+    }
+    TEST_ASSERT(os_memblock_get(&g_TstMempool) == NULL);
+
+    /*** Bulk put. */
+    rc = os_memblock_put_n(&g_TstMempool, block_array, NUM_MEM_BLOCKS);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(g_TstMempool.mp_num_free == NUM_MEM_BLOCKS);
+    TEST_ASSERT(os_mempool_is_sane(&g_TstMempool));
+
+    /*** Magazine refills half its capacity on get. */
+    os_mempool_mag_init(&mag, &g_TstMempool, slots, MEMPOOL_TEST_MAG_SIZE);
+    block = os_mempool_mag_get(&mag);
+    TEST_ASSERT_FATAL(block != NULL);
+    TEST_ASSERT(mag.mm_cnt == MEMPOOL_TEST_MAG_SIZE / 2 - 1);
+    TEST_ASSERT(g_TstMempool.mp_num_free ==
+                NUM_MEM_BLOCKS - MEMPOOL_TEST_MAG_SIZE / 2);
+
+    /*** Puts are absorbed until the magazine is full, then half flushed. */
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < MEMPOOL_TEST_MAG_SIZE / 2; i++) {
+        block_array[i] = os_memblock_get(&g_TstMempool);
+        TEST_ASSERT_FATAL(block_array[i] != NULL);
+        rc = os_mempool_mag_put(&mag, block_array[i]);
+        TEST_ASSERT(rc == 0);
+    }
+    TEST_ASSERT(mag.mm_cnt == MEMPOOL_TEST_MAG_SIZE);
+
+    block = os_memblock_get(&g_TstMempool);
+    TEST_ASSERT_FATAL(block != NULL);
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(mag.mm_cnt == MEMPOOL_TEST_MAG_SIZE / 2 + 1);
+
+    /*** Flush returns everything to the pool. */
+    rc = os_mempool_mag_flush(&mag);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(mag.mm_cnt == 0);
+    TEST_ASSERT(g_TstMempool.mp_num_free == NUM_MEM_BLOCKS);
+    TEST_ASSERT(os_mempool_is_sane(&g_TstMempool));
+
+    /*** A zero sized magazine passes blocks straight through. */
+    os_mempool_mag_init(&mag, &g_TstMempool, NULL, 0);
+    block = os_mempool_mag_get(&mag);
+    TEST_ASSERT_FATAL(block != NULL);
+    TEST_ASSERT(mag.mm_cnt == 0);
+    TEST_ASSERT(g_TstMempool.mp_num_free == NUM_MEM_BLOCKS - 1);
+
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(mag.mm_cnt == 0);
+    TEST_ASSERT(g_TstMempool.mp_num_free == NUM_MEM_BLOCKS);
+}
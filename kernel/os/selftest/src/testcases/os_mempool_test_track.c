@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+#define MEMPOOL_TEST_TRACK_MAG_SIZE (4)
+
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+/* Returns number of blocks of the test pool attributed to a call site. */
+static int
+os_mempool_test_track_held(void)
+{
+    struct os_mempool_site sites[8];
+    int held;
+    int num;
+    int i;
+
+    memset(sites, 0, sizeof(sites));
+    num = os_mempool_sites_get(sites, 8);
+
+    held = 0;
+    for (i = 0; i < num; i++) {
+        if (sites[i].oms_pool == &g_TstMempool) {
+            held += sites[i].oms_count;
+        }
+    }
+
+    return held;
+}
+#endif
+
+TEST_CASE_SELF(os_mempool_test_track)
+{
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    struct os_mempool_mag mag;
+    void *slots[MEMPOOL_TEST_TRACK_MAG_SIZE];
+    uint16_t base;
+    void *block;
+    int rc;
+    int i;
+
+    /*** Re-initializing a pool reuses its entries of the track table. */
+    os_mempool_unregister(&g_TstMempool);
+    rc = os_mempool_init(&g_TstMempool, NUM_MEM_BLOCKS, MEM_BLOCK_SIZE,
+                         TstMembuf, "TestMemPool");
+    TEST_ASSERT_FATAL(rc == 0);
+    base = g_TstMempool.mp_track_base;
+
+    for (i = 0; i <= MYNEWT_VAL(OS_MEMPOOL_TRACK_ENTRIES) / NUM_MEM_BLOCKS;
+         i++) {
+        os_mempool_unregister(&g_TstMempool);
+        rc = os_mempool_init(&g_TstMempool, NUM_MEM_BLOCKS, MEM_BLOCK_SIZE,
+                             TstMembuf, "TestMemPool");
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(g_TstMempool.mp_track_base == base);
+    }
+
+    block = os_memblock_get(&g_TstMempool);
+    TEST_ASSERT_FATAL(block != NULL);
+    TEST_ASSERT(os_mempool_test_track_held() == 1);
+    rc = os_memblock_put(&g_TstMempool, block);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mempool_test_track_held() == 0);
+
+    /*** Blocks cached by a magazine are not attributed to anyone. */
+    os_mempool_mag_init(&mag, &g_TstMempool, slots,
+                        MEMPOOL_TEST_TRACK_MAG_SIZE);
+    block = os_mempool_mag_get(&mag);
+    TEST_ASSERT_FATAL(block != NULL);
+    TEST_ASSERT(mag.mm_cnt > 0);
+    TEST_ASSERT(os_mempool_test_track_held() == 1);
+
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mempool_test_track_held() == 0);
+
+    block = os_mempool_mag_get(&mag);
+    TEST_ASSERT_FATAL(block != NULL);
+    TEST_ASSERT(os_mempool_test_track_held() == 1);
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mempool_mag_flush(&mag);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mempool_test_track_held() == 0);
+    TEST_ASSERT(g_TstMempool.mp_num_free == NUM_MEM_BLOCKS);
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "os/os_amutex.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#define AMUTEX_TEST_PRIO_HIGH   (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define AMUTEX_TEST_PRIO_LOW    (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 3)
+
+static struct os_amutex amutex_test_mu;
+
+static void
+amutex_test_high_handler(void *arg)
+{
+    os_error_t err;
+
+    /* Let the low priority task take the lock first. */
+    os_time_delay(OS_TICKS_PER_SEC / 20);
+
+    err = os_amutex_pend(&amutex_test_mu, 0);
+    TEST_ASSERT(err == OS_TIMEOUT);
+
+    err = os_amutex_pend(&amutex_test_mu, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(g_task1_val == 1);
+    TEST_ASSERT(os_amutex_get_level(&amutex_test_mu) == 1);
+
+    err = os_amutex_release(&amutex_test_mu);
+    TEST_ASSERT(err == OS_OK);
+
+    /* Uncontended again; the lock is back on the fast path. */
+    TEST_ASSERT(amutex_test_mu.am_owner == NULL);
+    TEST_ASSERT(os_amutex_get_level(&amutex_test_mu) == 0);
+
+    g_task2_val = 1;
+}
+
+static void
+amutex_test_low_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    /* Fast path, nested. */
+    err = os_amutex_pend(&amutex_test_mu, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(amutex_test_mu.am_owner == t);
+    err = os_amutex_pend(&amutex_test_mu, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(os_amutex_get_level(&amutex_test_mu) == 2);
+
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+
+    /* The high priority task blocked and moved the lock to the mutex. */
+    TEST_ASSERT(amutex_test_mu.am_owner == OS_AMUTEX_INFLATED);
+    TEST_ASSERT(amutex_test_mu.am_mutex.mu_owner == t);
+    TEST_ASSERT(t->t_prio == AMUTEX_TEST_PRIO_HIGH);
+
+    err = os_amutex_release(&amutex_test_mu);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(os_amutex_get_level(&amutex_test_mu) == 1);
+
+    g_task1_val = 1;
+    err = os_amutex_release(&amutex_test_mu);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == AMUTEX_TEST_PRIO_LOW);
+    TEST_ASSERT(g_task2_val == 1);
+
+    err = os_amutex_release(&amutex_test_mu);
+    TEST_ASSERT(err == OS_BAD_MUTEX);
+}
+
+TEST_CASE_TASK(os_mutex_test_amutex)
+{
+    int rc;
+
+    g_task1_val = 0;
+    g_task2_val = 0;
+
+    rc = os_amutex_init(&amutex_test_mu);
+    TEST_ASSERT(rc == 0);
+
+    taskpool_alloc_assert(amutex_test_high_handler, AMUTEX_TEST_PRIO_HIGH);
+    taskpool_alloc_assert(amutex_test_low_handler, AMUTEX_TEST_PRIO_LOW);
+
+    taskpool_wait_assert(200);
+}
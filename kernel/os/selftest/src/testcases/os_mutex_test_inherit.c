@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+/*
+ * Three tasks form an inheritance chain: the low priority task holds mutex
+ * 1, the middle one holds mutex 2 and waits on mutex 1, and the high
+ * priority one waits on mutex 2.  The boost must reach the low priority
+ * task and be unwound as the mutexes are released.
+ */
+#define MUTEX_INHERIT_PRIO_HIGH     (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define MUTEX_INHERIT_PRIO_MID      (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 3)
+#define MUTEX_INHERIT_PRIO_LOW      (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 4)
+
+static void
+mutex_inherit_high_handler(void *arg)
+{
+    os_error_t err;
+
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+
+    err = os_mutex_pend(&g_mutex2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(g_task2_val == 1);
+
+    err = os_mutex_release(&g_mutex2);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(os_sched_get_current_task()->t_prio ==
+                MUTEX_INHERIT_PRIO_HIGH);
+}
+
+static void
+mutex_inherit_mid_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    os_time_delay(OS_TICKS_PER_SEC / 20);
+
+    err = os_mutex_pend(&g_mutex2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    /* Blocks until the low priority task lets go of mutex 1. */
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(g_task1_val == 1);
+
+    /* The high priority task is waiting on mutex 2. */
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_PRIO_HIGH);
+
+    /* Releasing mutex 1 keeps the boost owed to mutex 2's waiter. */
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_PRIO_HIGH);
+
+    g_task2_val = 1;
+    err = os_mutex_release(&g_mutex2);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_PRIO_MID);
+}
+
+static void
+mutex_inherit_low_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    /* Let the others block on the chain. */
+    os_time_delay(OS_TICKS_PER_SEC / 5);
+
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_PRIO_HIGH);
+
+    g_task1_val = 1;
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_PRIO_LOW);
+
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    TEST_ASSERT(g_mutex1.mu_num_contended == 1);
+    TEST_ASSERT(g_mutex1.mu_wait_max > 0);
+    TEST_ASSERT(g_mutex1.mu_wait_max_owner == t);
+#endif
+}
+
+TEST_CASE_TASK(os_mutex_test_inherit)
+{
+    int rc;
+
+    g_task1_val = 0;
+    g_task2_val = 0;
+
+    rc = os_mutex_init(&g_mutex1);
+    TEST_ASSERT(rc == 0);
+    rc = os_mutex_init(&g_mutex2);
+    TEST_ASSERT(rc == 0);
+
+    taskpool_alloc_assert(mutex_inherit_high_handler,
+                          MUTEX_INHERIT_PRIO_HIGH);
+    taskpool_alloc_assert(mutex_inherit_mid_handler,
+                          MUTEX_INHERIT_PRIO_MID);
+    taskpool_alloc_assert(mutex_inherit_low_handler,
+                          MUTEX_INHERIT_PRIO_LOW);
+
+    taskpool_wait_assert(200);
+}
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+/*
+ * Same chain as os_mutex_test_inherit, but the high priority task gives up
+ * waiting on mutex 2.  Its boost must be withdrawn from the whole chain,
+ * not only from mutex 2's owner.
+ */
+#define MUTEX_INHERIT_TMO_PRIO_HIGH (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define MUTEX_INHERIT_TMO_PRIO_MID  (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 3)
+#define MUTEX_INHERIT_TMO_PRIO_LOW  (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 4)
+
+static void
+mutex_inherit_tmo_high_handler(void *arg)
+{
+    os_error_t err;
+
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+
+    err = os_mutex_pend(&g_mutex2, OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(err == OS_TIMEOUT);
+    g_task2_val = 1;
+}
+
+static void
+mutex_inherit_tmo_mid_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    os_time_delay(OS_TICKS_PER_SEC / 20);
+
+    err = os_mutex_pend(&g_mutex2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_TMO_PRIO_MID);
+
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+    err = os_mutex_release(&g_mutex2);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_TMO_PRIO_MID);
+}
+
+static void
+mutex_inherit_tmo_low_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    /* Let the others block on the chain. */
+    os_time_delay(OS_TICKS_PER_SEC / 7);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_TMO_PRIO_HIGH);
+
+    /* Wait for the high priority task to time out. */
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(g_task2_val == 1);
+
+    /* Only the middle task's boost is left. */
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_TMO_PRIO_MID);
+
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+    TEST_ASSERT(t->t_prio == MUTEX_INHERIT_TMO_PRIO_LOW);
+}
+
+TEST_CASE_TASK(os_mutex_test_inherit_timeout)
+{
+    int rc;
+
+    g_task2_val = 0;
+
+    rc = os_mutex_init(&g_mutex1);
+    TEST_ASSERT(rc == 0);
+    rc = os_mutex_init(&g_mutex2);
+    TEST_ASSERT(rc == 0);
+
+    taskpool_alloc_assert(mutex_inherit_tmo_high_handler,
+                          MUTEX_INHERIT_TMO_PRIO_HIGH);
+    taskpool_alloc_assert(mutex_inherit_tmo_mid_handler,
+                          MUTEX_INHERIT_TMO_PRIO_MID);
+    taskpool_alloc_assert(mutex_inherit_tmo_low_handler,
+                          MUTEX_INHERIT_TMO_PRIO_LOW);
+
+    taskpool_wait_assert(200);
+}
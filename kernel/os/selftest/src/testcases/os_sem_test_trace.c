@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#define SEM_TRACE_PRIO_HIGH     (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 2)
+#define SEM_TRACE_PRIO_LOW      (MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 3)
+
+static struct os_sem sem_trace_sem;
+static struct os_task *sem_trace_high_task;
+
+static void
+sem_trace_high_handler(void *arg)
+{
+    os_error_t err;
+    int i;
+
+    sem_trace_high_task = os_sched_get_current_task();
+
+    for (i = 0; i < 3; i++) {
+        err = os_sem_pend(&sem_trace_sem, OS_TIMEOUT_NEVER);
+        TEST_ASSERT(err == OS_OK);
+    }
+}
+
+static void
+sem_trace_low_handler(void *arg)
+{
+    struct os_task_info oti;
+    uint32_t start;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        /* Busy wait so that the low priority task has a measurable burst. */
+        start = os_cputime_get32();
+        while (CPUTIME_LT(os_cputime_get32(),
+                          start + os_cputime_usecs_to_ticks(1000))) {
+        }
+        os_sem_release(&sem_trace_sem);
+    }
+
+    TEST_ASSERT_FATAL(sem_trace_high_task != NULL);
+    TEST_ASSERT(sem_trace_high_task->t_trace.ott_lat_cnt >= 3);
+
+    os_task_info_get(os_sched_get_current_task(), &oti);
+    TEST_ASSERT(oti.oti_burst_max >= 1000);
+    TEST_ASSERT(oti.oti_lat_avg <= oti.oti_lat_max);
+    TEST_ASSERT(oti.oti_load <= 100);
+}
+
+/* Scheduler trace records wakeup latencies and run bursts */
+TEST_CASE_TASK(os_sem_test_trace)
+{
+    os_error_t err;
+
+    sem_trace_high_task = NULL;
+    err = os_sem_init(&sem_trace_sem, 0);
+    TEST_ASSERT(err == OS_OK);
+
+    taskpool_alloc_assert(sem_trace_high_handler, SEM_TRACE_PRIO_HIGH);
+    taskpool_alloc_assert(sem_trace_low_handler, SEM_TRACE_PRIO_LOW);
+
+    taskpool_wait_assert(200);
+}
@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#define STACK_HWM_BUF_WORDS     128
+
+static uint16_t
+stack_hwm_scan(const struct os_task *t)
+{
+    const os_stack_t *bottom;
+    const os_stack_t *top;
+
+    bottom = t->t_stackbottom;
+    top = bottom + t->t_stacksize;
+    while (bottom < top && *bottom == OS_STACK_PATTERN) {
+        ++bottom;
+    }
+
+    return top - bottom;
+}
+
+static os_stack_t __attribute__((noinline))
+stack_hwm_dirty(void)
+{
+    volatile os_stack_t buf[STACK_HWM_BUF_WORDS];
+    int i;
+
+    for (i = 0; i < STACK_HWM_BUF_WORDS; i++) {
+        buf[i] = 0;
+    }
+
+    return buf[0];
+}
+
+static void
+stack_hwm_handler(void *arg)
+{
+    struct os_task_info oti;
+    struct os_task *t;
+    int i;
+
+    t = os_sched_get_current_task();
+
+    TEST_ASSERT(stack_hwm_dirty() == 0);
+
+    /*
+     * Each switch away from this task probes one more window; a full sweep
+     * takes at most stacksize / window switches.
+     */
+    for (i = 0;
+         i <= t->t_stacksize / MYNEWT_VAL(OS_STACK_WATERMARK_WINDOW) + 1;
+         i++) {
+        os_time_delay(1);
+    }
+
+    os_task_info_get(t, &oti);
+    TEST_ASSERT(oti.oti_stkusage >= STACK_HWM_BUF_WORDS);
+    TEST_ASSERT(oti.oti_stkusage == stack_hwm_scan(t));
+}
+
+/* Incremental stack watermark converges on the full scan result */
+TEST_CASE_TASK(os_task_test_stack_hwm)
+{
+    taskpool_alloc_assert(stack_hwm_handler,
+                          MYNEWT_VAL(OS_MAIN_TASK_PRIO) + 1);
+    taskpool_wait_assert(1000);
+}
@@ -154,6 +154,12 @@ SVC_Done:
 
 /*-------------------------- PendSV_Handler ---------------------------------*/
 
+#if MYNEWT_VAL(OS_HOT_SECTIONS)
+        /* PendSV and SysTick run from TEXT_RAM, see OS_HOT_SECTIONS */
+        .section ".text_ram.os_arch","ax",%progbits
+        .align  2
+#endif
+
 #       void PendSV_Handler (void);
 
         .thumb_func
@@ -235,6 +241,11 @@ SysTick_Handler:
         .fnend
         .size   SysTick_Handler, .-SysTick_Handler
 
+#if MYNEWT_VAL(OS_HOT_SECTIONS)
+        .section ".text"
+        .align  2
+#endif
+
 /*-------------------------- Defalt IRQ --------------------------------*/
         .thumb_func
         .type   os_default_irq_asm, %function
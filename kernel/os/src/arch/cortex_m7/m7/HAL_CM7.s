@@ -138,6 +138,12 @@ SVC_Done:
 
 /*-------------------------- PendSV_Handler ---------------------------------*/
 
+#if MYNEWT_VAL(OS_HOT_SECTIONS)
+        /* PendSV and SysTick run from TEXT_RAM, see OS_HOT_SECTIONS */
+        .section ".text_ram.os_arch","ax",%progbits
+        .align  2
+#endif
+
 #       void PendSV_Handler (void);
 
         .thumb_func
@@ -160,7 +166,7 @@ PendSV_Handler:
         TST     LR,#0x10                /* is it extended frame? */
         IT      EQ
         VSTMDBEQ R12!,{S16-S31}         /* yes; push the regs */
-        STMDB   R12!,{R4-R11,LR}        /* Save Old context */
+        STMDB   R12!,{R4-R11,LR}        /* Save Old context and EXC_RETURN */
 #else
         STMDB   R12!,{R4-R11}           /* Save Old context */
 #endif
@@ -169,12 +175,15 @@ PendSV_Handler:
 
         LDR     R12,[R2,#0]             /* get stack pointer of task we will start */
 #if MYNEWT_VAL(HARDFLOAT)
-        LDMIA   R12!,{R4-R11,LR}        /* Restore New Context */
+        /*
+         * The saved EXC_RETURN already selects the basic or extended frame
+         * for the new task, so tasks which never used the FPU only pay for
+         * the skipped VLDMIA.
+         */
+        LDMIA   R12!,{R4-R11,LR}        /* Restore New Context and EXC_RETURN */
         TST     LR,#0x10                /* is it extended frame? */
-        ITTE    EQ
+        IT      EQ
         VLDMIAEQ R12!,{S16-S31}         /* yes; pull the regs */
-        MVNEQ   LR,#~0xFFFFFFED         /* BX treats it as extended */
-        MVNNE   LR,#~0xFFFFFFFD         /* BX treats is as basic frame */
 #else
         LDMIA   R12!,{R4-R11}           /* Restore New Context */
 #endif
@@ -211,6 +220,11 @@ SysTick_Handler:
         .fnend
         .size   SysTick_Handler, .-SysTick_Handler
 
+#if MYNEWT_VAL(OS_HOT_SECTIONS)
+        .section ".text"
+        .align  2
+#endif
+
 /*-------------------------- Defalt IRQ --------------------------------*/
         .thumb_func
         .type   os_default_irq_asm, %function
@@ -108,13 +108,13 @@ struct stack_frame {
 /* XXX: determine how we will deal with running un-privileged */
 uint32_t os_flags = OS_RUN_PRIV;
 
-void
+OS_HOT_CODE void
 timer_handler(void)
 {
     os_time_advance(1);
 }
 
-void
+OS_HOT_CODE void
 os_arch_ctx_sw(struct os_task *t)
 {
     os_sched_ctx_sw_hook(t);
@@ -123,7 +123,7 @@ os_arch_ctx_sw(struct os_task *t)
     SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
 }
 
-os_sr_t
+OS_HOT_CODE os_sr_t
 os_arch_save_sr(void)
 {
     uint32_t isr_ctx;
@@ -139,7 +139,7 @@ os_arch_save_sr(void)
     return isr_ctx;
 }
 
-void
+OS_HOT_CODE void
 os_arch_restore_sr(os_sr_t isr_ctx)
 {
 #if MCU_CRITICAL_BASEPRI
@@ -214,9 +214,29 @@ os_arch_init(void)
      * Trap on divide-by-zero.
      */
     SCB->CCR |= SCB_CCR_DIV_0_TRP_Msk;
+#if MYNEWT_VAL(HARDFLOAT) && MYNEWT_VAL(OS_FPU_LAZY_STACKING)
+    /*
+     * Set CONTROL.FPCA on the first FP instruction of a task, and only
+     * reserve space for S0-S15 when an exception interrupts such a task.
+     */
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+#endif
     os_init_idle_task();
 }
 
+#if MYNEWT_VAL(HARDFLOAT) && MYNEWT_VAL(OS_FPU_LAZY_STACKING)
+void
+os_arch_fpu_release(void)
+{
+    /*
+     * With FPCA clear the next exception stacks a basic frame, and
+     * PendSV skips S16-S31 until the task uses the FPU again.
+     */
+    __set_CONTROL(__get_CONTROL() & ~CONTROL_FPCA_Msk);
+    __ISB();
+}
+#endif
+
 __attribute__((always_inline))
 static inline void
 svc_os_arch_init(void)
@@ -126,6 +126,9 @@ __assert_func(const char *file, int line, const char *func, const char *e)
 
     OS_ENTER_CRITICAL(sr);
     (void)sr;
+#if MYNEWT_VAL(OS_TRACE_RING)
+    os_trace_ring_freeze();
+#endif
     console_blocking_mode();
     OS_PRINT_ASSERT(file, line, func, e);
 
@@ -148,6 +151,9 @@ os_default_irq(struct trap_frame *tf)
     uint32_t *orig_sp;
 #endif
 
+#if MYNEWT_VAL(OS_TRACE_RING)
+    os_trace_ring_freeze();
+#endif
     console_blocking_mode();
     console_printf("Unhandled interrupt (%ld), exception sp 0x%08lx\n",
       SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk, (uint32_t)tf->ef);
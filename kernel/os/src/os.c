@@ -45,6 +45,68 @@ OS_TASK_STACK_DEFINE(g_idle_task_stack, OS_IDLE_STACK_SIZE);
 
 uint32_t g_os_idle_ctr;
 
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR_DFLT_SLOTS) > 0
+static struct os_eventq_mon
+    os_eventq_main_mon[MYNEWT_VAL(OS_EVENTQ_MONITOR_DFLT_SLOTS)];
+#endif
+
+#if MYNEWT_VAL(OS_IDLE_STATS)
+static struct {
+    uint32_t wakeups;
+    uint64_t sleep_ticks;
+    /* Current measurement window */
+    os_time_t win_start;
+    uint32_t win_wakeups;
+    uint32_t win_sleep_ticks;
+    /* Results from the last complete window */
+    uint32_t wakeups_per_sec;
+    uint32_t avg_sleep_ticks;
+} os_idle_stats;
+
+/*
+ * Account for one return from os_tick_idle(). Rates are computed over
+ * windows of at least one second, so that they stay meaningful when a
+ * single sleep lasts longer than that.
+ */
+static void
+os_idle_stats_update(os_time_t start, os_time_t end)
+{
+    os_time_t slept;
+    os_time_t win;
+
+    slept = end - start;
+
+    os_idle_stats.wakeups++;
+    os_idle_stats.sleep_ticks += slept;
+    os_idle_stats.win_wakeups++;
+    os_idle_stats.win_sleep_ticks += slept;
+
+    win = end - os_idle_stats.win_start;
+    if (win >= OS_TICKS_PER_SEC) {
+        os_idle_stats.wakeups_per_sec =
+            (uint64_t)os_idle_stats.win_wakeups * OS_TICKS_PER_SEC / win;
+        os_idle_stats.avg_sleep_ticks =
+            os_idle_stats.win_sleep_ticks / os_idle_stats.win_wakeups;
+        os_idle_stats.win_start = end;
+        os_idle_stats.win_wakeups = 0;
+        os_idle_stats.win_sleep_ticks = 0;
+    }
+}
+
+void
+os_idle_info_get(struct os_idle_info *oii)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    oii->oii_wakeups = os_idle_stats.wakeups;
+    oii->oii_sleep_ticks = os_idle_stats.sleep_ticks;
+    oii->oii_wakeups_per_sec = os_idle_stats.wakeups_per_sec;
+    oii->oii_avg_sleep_ticks = os_idle_stats.avg_sleep_ticks;
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 struct os_task g_os_main_task;
 OS_TASK_STACK_DEFINE(g_os_main_stack, OS_MAIN_STACK_SIZE);
 
@@ -158,6 +220,9 @@ os_idle_task(void *arg)
 
         os_trace_idle();
         os_tick_idle(iticks);
+#if MYNEWT_VAL(OS_IDLE_STATS)
+        os_idle_stats_update(now, os_time_get());
+#endif
         OS_EXIT_CRITICAL(sr);
     }
 }
@@ -237,9 +302,18 @@ os_init(int (*main_fn)(int argc, char **arg))
     SEGGER_RTT_Init();
 #endif
 
-    TAILQ_INIT(&g_callout_list);
+    os_callout_module_init();
+#if MYNEWT_VAL(OS_HRTIMER)
+    os_hrtimer_module_init();
+#endif
     STAILQ_INIT(&g_os_task_list);
     os_eventq_init(os_eventq_dflt_get());
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR_DFLT_SLOTS) > 0
+    err = os_eventq_mon_start(os_eventq_dflt_get(),
+                              MYNEWT_VAL(OS_EVENTQ_MONITOR_DFLT_SLOTS),
+                              os_eventq_main_mon);
+    assert(err == OS_OK);
+#endif
 
     /* Initialize device list. */
     os_dev_reset();
@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "os/os_amutex.h"
+#include "os_priv.h"
+
+/*
+ * Compare-and-swap of the owner field.  Targets without a native pointer
+ * sized CAS (e.g. ARMv6-M) emulate it with a critical section.
+ */
+static inline int
+os_amutex_cas(struct os_amutex *am, struct os_task *old, struct os_task *new)
+{
+#if defined(__GCC_ATOMIC_POINTER_LOCK_FREE) && \
+    __GCC_ATOMIC_POINTER_LOCK_FREE == 2
+    return __atomic_compare_exchange_n(&am->am_owner, &old, new, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = am->am_owner == old;
+    if (rc) {
+        am->am_owner = new;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+#endif
+}
+
+/* Checks whether the specified task holds the mutex. */
+static int
+os_amutex_is_owner(const struct os_amutex *am, const struct os_task *t)
+{
+    struct os_task *owner;
+
+    owner = am->am_owner;
+    if (owner == OS_AMUTEX_INFLATED) {
+        return am->am_mutex.mu_level != 0 && am->am_mutex.mu_owner == t;
+    }
+    return owner == t;
+}
+
+os_error_t
+os_amutex_init(struct os_amutex *am)
+{
+    if (!am) {
+        return OS_INVALID_PARM;
+    }
+
+    am->am_owner = NULL;
+    am->am_level = 0;
+    am->am_waiters = 0;
+
+    return os_mutex_init(&am->am_mutex);
+}
+
+/*
+ * Blocks on the backing mutex.  If the lock is still held through the fast
+ * path, its ownership is first moved to the backing mutex on behalf of the
+ * current owner, so that the owner inherits the caller's priority.
+ */
+static os_error_t
+os_amutex_pend_slow(struct os_amutex *am, struct os_task *current,
+                    os_time_t timeout)
+{
+    struct os_task *owner;
+    os_error_t ret;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    owner = am->am_owner;
+    if (owner == NULL) {
+        /* Released in the meantime. */
+        am->am_owner = current;
+        am->am_level = 1;
+        OS_EXIT_CRITICAL(sr);
+        return OS_OK;
+    }
+
+    if (timeout == 0 && (owner != OS_AMUTEX_INFLATED ||
+                         am->am_mutex.mu_level != 0)) {
+        OS_EXIT_CRITICAL(sr);
+        return OS_TIMEOUT;
+    }
+
+    if (owner != OS_AMUTEX_INFLATED) {
+        os_mutex_assign(&am->am_mutex, owner);
+        am->am_owner = OS_AMUTEX_INFLATED;
+    }
+    am->am_waiters++;
+
+    OS_EXIT_CRITICAL(sr);
+
+    ret = os_mutex_pend(&am->am_mutex, timeout);
+
+    OS_ENTER_CRITICAL(sr);
+    am->am_waiters--;
+    if (ret == OS_OK) {
+        am->am_level = 1;
+    } else if (am->am_waiters == 0 && am->am_mutex.mu_level == 0) {
+        /* Nobody holds or wants the lock; go back to the fast path. */
+        am->am_owner = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return ret;
+}
+
+os_error_t
+os_amutex_pend(struct os_amutex *am, os_time_t timeout)
+{
+    struct os_task *current;
+    int i;
+
+    if (!g_os_started) {
+        return OS_NOT_STARTED;
+    }
+
+    if (!am) {
+        return OS_INVALID_PARM;
+    }
+
+    current = os_sched_get_current_task();
+
+    if (os_amutex_cas(am, NULL, current)) {
+        am->am_level = 1;
+        return OS_OK;
+    }
+
+    if (os_amutex_is_owner(am, current)) {
+        am->am_level++;
+        return OS_OK;
+    }
+
+    for (i = 0; i < MYNEWT_VAL(OS_AMUTEX_SPIN); i++) {
+        if (am->am_owner == OS_AMUTEX_INFLATED) {
+            break;
+        }
+        if (am->am_owner == NULL && os_amutex_cas(am, NULL, current)) {
+            am->am_level = 1;
+            return OS_OK;
+        }
+    }
+
+    return os_amutex_pend_slow(am, current, timeout);
+}
+
+os_error_t
+os_amutex_release(struct os_amutex *am)
+{
+    struct os_task *current;
+    os_error_t ret;
+    os_sr_t sr;
+
+    if (!g_os_started) {
+        return OS_NOT_STARTED;
+    }
+
+    if (!am) {
+        return OS_INVALID_PARM;
+    }
+
+    current = os_sched_get_current_task();
+    if (!os_amutex_is_owner(am, current)) {
+        return OS_BAD_MUTEX;
+    }
+
+    if (am->am_level > 1) {
+        am->am_level--;
+        return OS_OK;
+    }
+
+    if (os_amutex_cas(am, current, NULL)) {
+        return OS_OK;
+    }
+
+    /*
+     * Contended: hand the lock over through the backing mutex.  This may
+     * switch to the new owner, so it can't be done in a critical section.
+     */
+    ret = os_mutex_release(&am->am_mutex);
+    if (ret != OS_OK) {
+        return ret;
+    }
+
+    /* Leave the fast path disabled while any task holds or wants the lock. */
+    OS_ENTER_CRITICAL(sr);
+    if (am->am_owner == OS_AMUTEX_INFLATED &&
+        am->am_mutex.mu_level == 0 && am->am_waiters == 0) {
+        am->am_owner = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return ret;
+}
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "os/os_budget.h"
+
+/* Returns n plus margin percent of n, rounding the margin up. */
+static uint32_t
+os_budget_add_margin(uint32_t n, uint32_t margin)
+{
+    return n + (n * margin + 99) / 100;
+}
+
+struct os_task *
+os_task_budget_get_next(const struct os_task *prev,
+                        struct os_task_budget *otb)
+{
+    struct os_task_info oti;
+    struct os_task *t;
+    uint32_t suggest;
+
+    t = os_task_info_get_next(prev, &oti);
+    if (t == NULL) {
+        return NULL;
+    }
+
+    otb->otb_taskid = oti.oti_taskid;
+    otb->otb_stack_size = oti.oti_stksize * sizeof(os_stack_t);
+    otb->otb_stack_peak = oti.oti_stkusage * sizeof(os_stack_t);
+
+    suggest = os_budget_add_margin(otb->otb_stack_peak,
+                                   MYNEWT_VAL(OS_BUDGET_STACK_MARGIN));
+    otb->otb_stack_suggest = OS_ALIGN(suggest, OS_STACK_ALIGNMENT);
+
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    otb->otb_heap_bytes = oti.oti_heap_bytes;
+#endif
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    os_mempool_task_usage(oti.oti_taskid, &otb->otb_pool_blocks,
+                          &otb->otb_pool_bytes);
+#endif
+
+    memcpy(otb->otb_name, oti.oti_name, sizeof(otb->otb_name));
+
+    return t;
+}
+
+struct os_mempool *
+os_mempool_budget_get_next(struct os_mempool *prev,
+                           struct os_mempool_budget *omb)
+{
+    struct os_mempool_info omi;
+    struct os_mempool *mp;
+    uint32_t suggest;
+    uint16_t peak;
+
+    mp = os_mempool_info_get_next(prev, &omi);
+    if (mp == NULL) {
+        return NULL;
+    }
+
+    peak = omi.omi_num_blocks - omi.omi_min_free;
+    suggest = os_budget_add_margin(peak, MYNEWT_VAL(OS_BUDGET_POOL_MARGIN));
+    if (suggest == peak) {
+        suggest++;
+    }
+    if (suggest > UINT16_MAX) {
+        suggest = UINT16_MAX;
+    }
+
+    omb->omb_block_size = omi.omi_block_size;
+    omb->omb_num_blocks = omi.omi_num_blocks;
+    omb->omb_peak_blocks = peak;
+    omb->omb_suggest_blocks = suggest;
+    if (omb->omb_suggest_blocks < omb->omb_num_blocks) {
+        omb->omb_reclaim_bytes =
+            (omb->omb_num_blocks - omb->omb_suggest_blocks) *
+            OS_ALIGN(omb->omb_block_size, OS_ALIGNMENT);
+    } else {
+        omb->omb_reclaim_bytes = 0;
+    }
+    memcpy(omb->omb_name, omi.omi_name, sizeof(omb->omb_name));
+
+    return mp;
+}
@@ -26,8 +26,93 @@
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+
+#define OS_CALLOUT_WHEEL_SLOTS  MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS)
+#define OS_CALLOUT_WHEEL_MASK   (OS_CALLOUT_WHEEL_SLOTS - 1)
+
+#if (OS_CALLOUT_WHEEL_SLOTS & OS_CALLOUT_WHEEL_MASK) != 0
+#error "OS_CALLOUT_WHEEL_SLOTS must be a power of two"
+#endif
+
+/*
+ * Hashed timing wheel; a pending callout lives in the slot selected by the
+ * low bits of its expiry time. Slots are not sorted, so a slot may also
+ * hold callouts which expire a multiple of OS_CALLOUT_WHEEL_SLOTS ticks
+ * later.
+ */
+static struct os_callout_list os_callout_wheel[OS_CALLOUT_WHEEL_SLOTS];
+
+/* Last tick which os_callout_tick() has processed */
+static os_time_t os_callout_wheel_time;
+
+static inline struct os_callout_list *
+os_callout_slot(os_time_t ticks)
+{
+    return &os_callout_wheel[ticks & OS_CALLOUT_WHEEL_MASK];
+}
+
+static void
+os_callout_insert(struct os_callout *c)
+{
+    TAILQ_INSERT_TAIL(os_callout_slot(c->c_ticks), c, c_next);
+}
+
+static void
+os_callout_remove(struct os_callout *c)
+{
+    TAILQ_REMOVE(os_callout_slot(c->c_ticks), c, c_next);
+    c->c_next.tqe_prev = NULL;
+}
+
+void
+os_callout_module_init(void)
+{
+    int i;
+
+    for (i = 0; i < OS_CALLOUT_WHEEL_SLOTS; i++) {
+        TAILQ_INIT(&os_callout_wheel[i]);
+    }
+    os_callout_wheel_time = os_time_get();
+}
+
+#else
+
 struct os_callout_list g_callout_list;
 
+static void
+os_callout_insert(struct os_callout *c)
+{
+    struct os_callout *entry;
+
+    TAILQ_FOREACH(entry, &g_callout_list, c_next) {
+        if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
+            break;
+        }
+    }
+
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, c, c_next);
+    } else {
+        TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
+    }
+}
+
+static void
+os_callout_remove(struct os_callout *c)
+{
+    TAILQ_REMOVE(&g_callout_list, c, c_next);
+    c->c_next.tqe_prev = NULL;
+}
+
+void
+os_callout_module_init(void)
+{
+    TAILQ_INIT(&g_callout_list);
+}
+
+#endif
+
 void os_callout_init(struct os_callout *c, struct os_eventq *evq,
                      os_event_fn *ev_cb, void *ev_arg)
 {
@@ -51,8 +136,7 @@ os_callout_stop(struct os_callout *c)
     OS_ENTER_CRITICAL(sr);
 
     if (os_callout_queued(c)) {
-        TAILQ_REMOVE(&g_callout_list, c, c_next);
-        c->c_next.tqe_prev = NULL;
+        os_callout_remove(c);
     }
 
     if (c->c_evq) {
@@ -67,7 +151,6 @@ os_callout_stop(struct os_callout *c)
 int
 os_callout_reset(struct os_callout *c, os_time_t ticks)
 {
-    struct os_callout *entry;
     os_sr_t sr;
     int ret;
 
@@ -90,19 +173,7 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
     }
 
     c->c_ticks = os_time_get() + ticks;
-
-    entry = NULL;
-    TAILQ_FOREACH(entry, &g_callout_list, c_next) {
-        if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
-            break;
-        }
-    }
-
-    if (entry) {
-        TAILQ_INSERT_BEFORE(entry, c, c_next);
-    } else {
-        TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
-    }
+    os_callout_insert(c);
 
     OS_EXIT_CRITICAL(sr);
 
@@ -113,7 +184,128 @@ err:
     return ret;
 }
 
+/*
+ * Returns the number of ticks until the latest time 'c' may expire at,
+ * including its slack.
+ */
+static os_time_t
+os_callout_latest_ticks(const struct os_callout *c, os_time_t now)
+{
+    os_time_t rt;
+
+    if (!OS_TIME_TICK_GEQ(c->c_ticks, now)) {
+        return 0;       /* callout time is in the past */
+    }
+
+    rt = c->c_ticks - now;
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    rt += c->c_slack;
+#endif
+
+    return rt;
+}
+
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+/*
+ * Expires all callouts in a wheel slot which are due at 'now'. Events are
+ * posted in a single critical section; only callouts without an event queue
+ * have their callback run with interrupts enabled.
+ */
+static void
+os_callout_slot_expire(struct os_callout_list *slot, os_time_t now)
+{
+    struct os_callout *c;
+    struct os_callout *next;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    c = TAILQ_FIRST(slot);
+    while (c) {
+        next = TAILQ_NEXT(c, c_next);
+        if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
+            TAILQ_REMOVE(slot, c, c_next);
+            c->c_next.tqe_prev = NULL;
+            if (c->c_evq) {
+                os_eventq_put(c->c_evq, &c->c_ev);
+            } else {
+                OS_EXIT_CRITICAL(sr);
+                c->c_ev.ev_cb(&c->c_ev);
+                OS_ENTER_CRITICAL(sr);
+                /* The callback may have modified this slot. */
+                next = TAILQ_FIRST(slot);
+            }
+        }
+        c = next;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
 
+/**
+ * This function is called by the OS in the time tick.  It visits every wheel
+ * slot which passed since the previous call, and posts an event for each
+ * callout that's ready to run to the event queue provided to
+ * os_callout_init().
+ */
+void
+os_callout_tick(void)
+{
+    os_time_t now;
+    os_time_t delta;
+    os_time_t i;
+
+    os_trace_api_void(OS_TRACE_ID_CALLOUT_TICK);
+
+    now = os_time_get();
+
+    delta = now - os_callout_wheel_time;
+    if (delta > OS_CALLOUT_WHEEL_SLOTS) {
+        /* More than one revolution; every slot needs to be checked once. */
+        delta = OS_CALLOUT_WHEEL_SLOTS;
+    }
+    for (i = delta; i > 0; i--) {
+        os_callout_slot_expire(os_callout_slot(now - i + 1), now);
+    }
+    os_callout_wheel_time = now;
+
+    os_trace_api_ret(OS_TRACE_ID_CALLOUT_TICK);
+}
+
+/*
+ * Returns the number of ticks until the system must wake up for pending
+ * callouts; that is, until the first callout runs out of slack. If there
+ * are no pending callouts then return OS_TIMEOUT_NEVER instead.
+ *
+ * @param now The time now
+ *
+ * @return Number of ticks to first pending callout
+ */
+os_time_t
+os_callout_wakeup_ticks(os_time_t now)
+{
+    struct os_callout_list *slot;
+    struct os_callout *c;
+    os_time_t rt;
+    os_time_t i;
+
+    OS_ASSERT_CRITICAL();
+
+    rt = OS_TIMEOUT_NEVER;
+
+    /*
+     * Walk the slots starting at 'now'. A callout found in the slot 'i' ticks
+     * away expires in 'i' ticks, or in a later revolution. Stop as soon as
+     * no later slot can contain anything sooner.
+     */
+    for (i = 0; i < OS_CALLOUT_WHEEL_SLOTS && rt > i; i++) {
+        slot = os_callout_slot(now + i);
+        TAILQ_FOREACH(c, slot, c_next) {
+            rt = min(rt, os_callout_latest_ticks(c, now));
+        }
+    }
+
+    return (rt);
+}
+#else
 /**
  * This function is called by the OS in the time tick.  It searches the list
  * of callouts, and sees if any of them are ready to run.  If they are ready
@@ -136,8 +328,7 @@ os_callout_tick(void)
         c = TAILQ_FIRST(&g_callout_list);
         if (c) {
             if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
-                TAILQ_REMOVE(&g_callout_list, c, c_next);
-                c->c_next.tqe_prev = NULL;
+                os_callout_remove(c);
             } else {
                 c = NULL;
             }
@@ -159,8 +350,9 @@ os_callout_tick(void)
 }
 
 /*
- * Returns the number of ticks to the first pending callout. If there are no
- * pending callouts then return OS_TIMEOUT_NEVER instead.
+ * Returns the number of ticks until the system must wake up for pending
+ * callouts; that is, until the first callout runs out of slack. If there
+ * are no pending callouts then return OS_TIMEOUT_NEVER instead.
  *
  * @param now The time now
  *
@@ -174,20 +366,22 @@ os_callout_wakeup_ticks(os_time_t now)
 
     OS_ASSERT_CRITICAL();
 
-    c = TAILQ_FIRST(&g_callout_list);
-    if (c != NULL) {
-        if (OS_TIME_TICK_GEQ(c->c_ticks, now)) {
-            rt = c->c_ticks - now;
-        } else {
-            rt = 0;     /* callout time is in the past */
+    rt = OS_TIMEOUT_NEVER;
+
+    /*
+     * The list is sorted by expiry time; once a callout expires later than
+     * the current bound, neither it nor anything after it can lower it.
+     */
+    TAILQ_FOREACH(c, &g_callout_list, c_next) {
+        if (OS_TIME_TICK_GEQ(c->c_ticks, now) && c->c_ticks - now >= rt) {
+            break;
         }
-    } else {
-        rt = OS_TIMEOUT_NEVER;
+        rt = min(rt, os_callout_latest_ticks(c, now));
     }
 
     return (rt);
 }
-
+#endif
 
 os_time_t
 os_callout_remaining_ticks(struct os_callout *c, os_time_t now)
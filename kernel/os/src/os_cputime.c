@@ -22,10 +22,35 @@
 #include <assert.h>
 #include "os/mynewt.h"
 
-#if defined(OS_CPUTIME_FREQ_HIGH)
+#if defined(OS_CPUTIME_FREQ_HIGH) || defined(OS_CPUTIME_FREQ_RECIP)
 struct os_cputime_data g_os_cputime;
 #endif
 
+#if defined(OS_CPUTIME_FREQ_RECIP)
+static void
+os_cputime_ratio_init(struct os_cputime_ratio *r, uint32_t num, uint32_t den)
+{
+    uint64_t rem;
+    uint64_t hi;
+    uint64_t lo;
+
+    r->num = num;
+    r->den = den;
+    r->whole = num / den;
+
+    /* frac = ceil((num % den) * 2^64 / den), one 32-bit digit at a time. */
+    rem = num % den;
+    hi = (rem << 32) / den;
+    rem = (rem << 32) % den;
+    lo = (rem << 32) / den;
+    rem = (rem << 32) % den;
+    r->frac = (hi << 32) | lo;
+    if (rem != 0) {
+        r->frac++;
+    }
+}
+#endif
+
 int
 os_cputime_init(uint32_t clock_freq)
 {
@@ -34,6 +59,14 @@ os_cputime_init(uint32_t clock_freq)
     /* Set the ticks per microsecond. */
 #if defined(OS_CPUTIME_FREQ_HIGH)
     g_os_cputime.ticks_per_usec = clock_freq / 1000000U;
+#endif
+#if defined(OS_CPUTIME_FREQ_RECIP)
+    os_cputime_ratio_init(&g_os_cputime.usecs_to_ticks, clock_freq, 1000000U);
+    os_cputime_ratio_init(&g_os_cputime.ticks_to_usecs, 1000000U, clock_freq);
+    os_cputime_ratio_init(&g_os_cputime.nsecs_to_ticks, clock_freq,
+                          1000000000U);
+    os_cputime_ratio_init(&g_os_cputime.ticks_to_nsecs, 1000000000U,
+                          clock_freq);
 #endif
     rc = hal_timer_config(MYNEWT_VAL(OS_CPUTIME_TIMER_NUM), clock_freq);
     return rc;
@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+/**
+ * This module implements cputime functionality for any timer frequency
+ * using reciprocals precomputed by os_cputime_init().  Conversions round
+ * like the other implementations: usecs to ticks rounds down, everything
+ * else rounds up.
+ */
+
+#if defined(OS_CPUTIME_FREQ_RECIP)
+
+/**
+ * @addtogroup OSKernel Operating System Kernel
+ * @{
+ *   @defgroup OSCPUTime High Resolution Timers
+ *   @{
+ */
+
+/* floor(x * num / den), exact for any 32-bit x. */
+static uint64_t
+os_cputime_ratio_floor(const struct os_cputime_ratio *r, uint32_t x)
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    lo = (uint64_t)x * (uint32_t)r->frac;
+    hi = (uint64_t)x * (uint32_t)(r->frac >> 32);
+
+    return (uint64_t)x * r->whole + ((hi + (lo >> 32)) >> 32);
+}
+
+/* ceil(x * num / den), exact for any 32-bit x. */
+static uint64_t
+os_cputime_ratio_ceil(const struct os_cputime_ratio *r, uint32_t x)
+{
+    uint64_t val;
+
+    val = os_cputime_ratio_floor(r, x);
+    if (val * r->den < (uint64_t)x * r->num) {
+        val++;
+    }
+
+    return val;
+}
+
+/**
+ * os cputime usecs to ticks
+ *
+ * Converts the given number of microseconds into cputime ticks.
+ *
+ * @param usecs The number of microseconds to convert to ticks
+ *
+ * @return uint32_t The number of ticks corresponding to 'usecs'
+ */
+uint32_t
+os_cputime_usecs_to_ticks(uint32_t usecs)
+{
+    return os_cputime_ratio_floor(&g_os_cputime.usecs_to_ticks, usecs);
+}
+
+/**
+ * cputime ticks to usecs
+ *
+ * Convert the given number of ticks into microseconds.
+ *
+ * @param ticks The number of ticks to convert to microseconds.
+ *
+ * @return uint32_t The number of microseconds corresponding to 'ticks'
+ */
+uint32_t
+os_cputime_ticks_to_usecs(uint32_t ticks)
+{
+    return os_cputime_ratio_ceil(&g_os_cputime.ticks_to_usecs, ticks);
+}
+
+/**
+ * os cputime nsecs to ticks
+ *
+ * Converts the given number of nanoseconds into cputime ticks.
+ *
+ * @param nsecs The number of nanoseconds to convert to ticks
+ *
+ * @return uint32_t The number of ticks corresponding to 'nsecs'
+ */
+uint32_t
+os_cputime_nsecs_to_ticks(uint32_t nsecs)
+{
+    return os_cputime_ratio_ceil(&g_os_cputime.nsecs_to_ticks, nsecs);
+}
+
+/**
+ * os cputime ticks to nsecs
+ *
+ * Convert the given number of ticks into nanoseconds.
+ *
+ * @param ticks The number of ticks to convert to nanoseconds.
+ *
+ * @return uint32_t The number of nanoseconds corresponding to 'ticks'
+ */
+uint32_t
+os_cputime_ticks_to_nsecs(uint32_t ticks)
+{
+    return os_cputime_ratio_ceil(&g_os_cputime.ticks_to_nsecs, ticks);
+}
+
+/**
+ *   @} OSCPUTime
+ * @} OSKernel
+ */
+
+#endif
@@ -22,6 +22,25 @@
 
 static STAILQ_HEAD(, os_dev) g_os_dev_list;
 
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+static struct os_dev *g_os_dev_name_hash[MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE)];
+
+/* 32-bit FNV-1a. */
+static struct os_dev **
+os_dev_name_bucket(const char *name)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+
+    return &g_os_dev_name_hash[hash % MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE)];
+}
+#endif
+
 static uint8_t g_os_dev_init_stage;
 
 static int
@@ -53,12 +72,10 @@ os_dev_add(struct os_dev *dev)
 {
     struct os_dev *cur_dev;
     struct os_dev *prev_dev;
-
-    /* If no devices present, insert into head */
-    if (STAILQ_FIRST(&g_os_dev_list) == NULL) {
-        STAILQ_INSERT_HEAD(&g_os_dev_list, dev, od_next);
-        return (0);
-    }
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+    struct os_dev **bucket;
+#endif
+    os_sr_t sr;
 
     /* Add devices to the list, sorted first by stage, then by
      * priority.  Keep sorted in this order for initialization
@@ -77,12 +94,39 @@ os_dev_add(struct os_dev *dev)
         prev_dev = cur_dev;
     }
 
+    /* Lookups do not lock; the device must be complete before the store
+     * that makes it reachable.
+     */
+    OS_ENTER_CRITICAL(sr);
+
     if (prev_dev) {
-        STAILQ_INSERT_AFTER(&g_os_dev_list, prev_dev, dev, od_next);
+        STAILQ_NEXT(dev, od_next) = STAILQ_NEXT(prev_dev, od_next);
+        if (STAILQ_NEXT(dev, od_next) == NULL) {
+            g_os_dev_list.stqh_last = &STAILQ_NEXT(dev, od_next);
+        }
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        STAILQ_NEXT(prev_dev, od_next) = dev;
     } else {
-        STAILQ_INSERT_HEAD(&g_os_dev_list, dev, od_next);
+        STAILQ_NEXT(dev, od_next) = STAILQ_FIRST(&g_os_dev_list);
+        if (STAILQ_NEXT(dev, od_next) == NULL) {
+            g_os_dev_list.stqh_last = &STAILQ_NEXT(dev, od_next);
+        }
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        STAILQ_FIRST(&g_os_dev_list) = dev;
     }
 
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+    bucket = os_dev_name_bucket(dev->od_name);
+    while (*bucket != NULL) {
+        bucket = &(*bucket)->od_hash_next;
+    }
+    dev->od_hash_next = NULL;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    *bucket = dev;
+#endif
+
+    OS_EXIT_CRITICAL(sr);
+
     return (0);
 }
 
@@ -195,12 +239,19 @@ os_dev_lookup(const char *name)
 {
     struct os_dev *dev;
 
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+    dev = *os_dev_name_bucket(name);
+    while (dev != NULL && strcmp(dev->od_name, name)) {
+        dev = dev->od_hash_next;
+    }
+#else
     dev = NULL;
     STAILQ_FOREACH(dev, &g_os_dev_list, od_next) {
         if (!strcmp(dev->od_name, name)) {
             break;
         }
     }
+#endif
     return (dev);
 }
 
@@ -329,6 +380,9 @@ void
 os_dev_reset(void)
 {
     STAILQ_INIT(&g_os_dev_list);
+#if MYNEWT_VAL(OS_DEV_NAME_HASH_SIZE) > 0
+    memset(g_os_dev_name_hash, 0, sizeof g_os_dev_name_hash);
+#endif
 }
 
 void
@@ -0,0 +1,215 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include "os/mynewt.h"
+
+/* Describes a blocked os_event_flags_wait() call; lives on its stack. */
+struct os_event_flags_waiter {
+    struct os_task *oefw_task;
+    uint32_t oefw_mask;
+    /* Flags which satisfied the wait; valid once oefw_done is set. */
+    uint32_t oefw_flags;
+    uint8_t oefw_opts;
+    uint8_t oefw_done;
+    SLIST_ENTRY(os_event_flags_waiter) oefw_next;
+};
+
+static int
+os_event_flags_match(uint32_t flags, uint32_t mask, uint8_t opts)
+{
+    if (opts & OS_EVENT_FLAGS_ALL) {
+        return (flags & mask) == mask;
+    }
+    return (flags & mask) != 0;
+}
+
+os_error_t
+os_event_flags_init(struct os_event_flags *ef, uint32_t flags)
+{
+    if (!ef) {
+        return OS_INVALID_PARM;
+    }
+
+    ef->oef_flags = flags;
+    SLIST_INIT(&ef->oef_waiters);
+
+    return OS_OK;
+}
+
+os_error_t
+os_event_flags_set(struct os_event_flags *ef, uint32_t flags)
+{
+    struct os_event_flags_waiter *prev;
+    struct os_event_flags_waiter *next;
+    struct os_event_flags_waiter *w;
+    struct os_task *current;
+    struct os_task *rdy;
+    os_sr_t sr;
+
+    if (!ef) {
+        return OS_INVALID_PARM;
+    }
+
+    rdy = NULL;
+
+    OS_ENTER_CRITICAL(sr);
+
+    ef->oef_flags |= flags;
+
+    prev = NULL;
+    for (w = SLIST_FIRST(&ef->oef_waiters); w != NULL; w = next) {
+        next = SLIST_NEXT(w, oefw_next);
+
+        if (!os_event_flags_match(ef->oef_flags, w->oefw_mask,
+                                  w->oefw_opts)) {
+            prev = w;
+            continue;
+        }
+
+        w->oefw_flags = ef->oef_flags;
+        w->oefw_done = 1;
+        if (w->oefw_opts & OS_EVENT_FLAGS_CLEAR) {
+            ef->oef_flags &= ~w->oefw_mask;
+        }
+
+        if (prev != NULL) {
+            SLIST_NEXT(prev, oefw_next) = next;
+        } else {
+            SLIST_FIRST(&ef->oef_waiters) = next;
+        }
+
+        /* The waiter may have timed out already and just not run yet. */
+        if (w->oefw_task->t_state == OS_TASK_SLEEP) {
+            os_sched_wakeup(w->oefw_task);
+            if (rdy == NULL || w->oefw_task->t_prio < rdy->t_prio) {
+                rdy = w->oefw_task;
+            }
+        }
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    if (rdy != NULL) {
+        current = os_sched_get_current_task();
+        if (current == NULL || current->t_prio >= rdy->t_prio) {
+            os_sched(NULL);
+        }
+    }
+
+    return OS_OK;
+}
+
+uint32_t
+os_event_flags_clear(struct os_event_flags *ef, uint32_t flags)
+{
+    uint32_t prev;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    prev = ef->oef_flags;
+    ef->oef_flags &= ~flags;
+    OS_EXIT_CRITICAL(sr);
+
+    return prev;
+}
+
+os_error_t
+os_event_flags_wait(struct os_event_flags *ef, uint32_t mask, uint8_t opts,
+                    os_time_t timeout, uint32_t *out_flags)
+{
+    struct os_event_flags_waiter *entry;
+    struct os_event_flags_waiter *last;
+    struct os_event_flags_waiter w;
+    struct os_task *current;
+    os_error_t ret;
+    uint32_t seen;
+    os_sr_t sr;
+
+    if (!ef || mask == 0) {
+        return OS_INVALID_PARM;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    seen = ef->oef_flags;
+    if (os_event_flags_match(seen, mask, opts)) {
+        if (opts & OS_EVENT_FLAGS_CLEAR) {
+            ef->oef_flags &= ~mask;
+        }
+        OS_EXIT_CRITICAL(sr);
+        ret = OS_OK;
+        goto done;
+    }
+
+    if (timeout == 0) {
+        OS_EXIT_CRITICAL(sr);
+        ret = OS_TIMEOUT;
+        goto done;
+    }
+
+    if (!g_os_started) {
+        OS_EXIT_CRITICAL(sr);
+        ret = OS_NOT_STARTED;
+        goto done;
+    }
+
+    current = os_sched_get_current_task();
+
+    w.oefw_task = current;
+    w.oefw_mask = mask;
+    w.oefw_opts = opts;
+    w.oefw_done = 0;
+
+    /* Insert in priority order */
+    last = NULL;
+    SLIST_FOREACH(entry, &ef->oef_waiters, oefw_next) {
+        if (current->t_prio < entry->oefw_task->t_prio) {
+            break;
+        }
+        last = entry;
+    }
+    if (last) {
+        SLIST_INSERT_AFTER(last, &w, oefw_next);
+    } else {
+        SLIST_INSERT_HEAD(&ef->oef_waiters, &w, oefw_next);
+    }
+
+    os_sched_sleep(current, timeout);
+    OS_EXIT_CRITICAL(sr);
+
+    os_sched(NULL);
+
+    OS_ENTER_CRITICAL(sr);
+    if (w.oefw_done) {
+        seen = w.oefw_flags;
+        ret = OS_OK;
+    } else {
+        SLIST_REMOVE(&ef->oef_waiters, &w, os_event_flags_waiter, oefw_next);
+        seen = ef->oef_flags;
+        ret = OS_TIMEOUT;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+done:
+    if (out_flags != NULL) {
+        *out_flags = seen;
+    }
+    return ret;
+}
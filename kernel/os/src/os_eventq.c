@@ -27,9 +27,132 @@
 
 static struct os_eventq os_eventq_main;
 
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+static struct os_eventq *os_eventq_mon_list;
+
+/*
+ * Removes evq from the list of monitored queues, if it is there.  Only
+ * listed queues are dereferenced, so evq may be uninitialized.
+ */
+static void
+os_eventq_mon_unlink(struct os_eventq *evq)
+{
+    struct os_eventq **cur;
+
+    for (cur = &os_eventq_mon_list; *cur != NULL; cur = &(*cur)->evq_mon_next) {
+        if (*cur == evq) {
+            *cur = evq->evq_mon_next;
+            break;
+        }
+    }
+}
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS) > 1
+/*
+ * A prioritized queue is still a single list, sorted by band with the most
+ * urgent band first. The last event of every non-empty band is remembered,
+ * so that events can be inserted in constant time.
+ */
+static uint8_t
+os_eventq_band(const struct os_event *ev)
+{
+    return min(ev->ev_prio, MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS) - 1);
+}
+
+static void
+os_eventq_link(struct os_eventq *evq, struct os_event *ev)
+{
+    struct os_event *prev;
+    int band;
+    int i;
+
+    band = os_eventq_band(ev);
+
+    /* Last event of this band, or else of the closest more urgent one */
+    prev = NULL;
+    for (i = band; i < MYNEWT_VAL(OS_EVENTQ_PRIO_BANDS) && prev == NULL; i++) {
+        prev = evq->evq_prio_tail[i];
+    }
+
+    if (prev) {
+        STAILQ_INSERT_AFTER(&evq->evq_list, prev, ev, ev_next);
+    } else {
+        STAILQ_INSERT_HEAD(&evq->evq_list, ev, ev_next);
+    }
+    evq->evq_prio_tail[band] = ev;
+}
+
+static void
+os_eventq_unlink(struct os_eventq *evq, struct os_event *ev)
+{
+    struct os_event *prev;
+    int band;
+
+    band = os_eventq_band(ev);
+
+    if (STAILQ_FIRST(&evq->evq_list) == ev) {
+        prev = NULL;
+        STAILQ_REMOVE_HEAD(&evq->evq_list, ev_next);
+    } else {
+        prev = STAILQ_FIRST(&evq->evq_list);
+        while (STAILQ_NEXT(prev, ev_next) != ev) {
+            prev = STAILQ_NEXT(prev, ev_next);
+        }
+        STAILQ_REMOVE_AFTER(&evq->evq_list, prev, ev_next);
+    }
+
+    if (evq->evq_prio_tail[band] == ev) {
+        if (prev != NULL && os_eventq_band(prev) == band) {
+            evq->evq_prio_tail[band] = prev;
+        } else {
+            evq->evq_prio_tail[band] = NULL;
+        }
+    }
+}
+#else
+static void
+os_eventq_link(struct os_eventq *evq, struct os_event *ev)
+{
+    STAILQ_INSERT_TAIL(&evq->evq_list, ev, ev_next);
+}
+
+static void
+os_eventq_unlink(struct os_eventq *evq, struct os_event *ev)
+{
+    STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+}
+#endif
+
+/*
+ * Removes and returns the first event of the queue, or NULL if the queue is
+ * empty.
+ */
+static struct os_event *
+os_eventq_pull(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    ev = STAILQ_FIRST(&evq->evq_list);
+    if (ev) {
+        os_eventq_unlink(evq, ev);
+        ev->ev_queued = 0;
+    }
+
+    return ev;
+}
+
 void
 os_eventq_init(struct os_eventq *evq)
 {
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    os_eventq_mon_unlink(evq);
+    OS_EXIT_CRITICAL(sr);
+#endif
+
     memset(evq, 0, sizeof(*evq));
     STAILQ_INIT(&evq->evq_list);
 }
@@ -40,7 +163,7 @@ os_eventq_inited(const struct os_eventq *evq)
     return evq->evq_list.stqh_last != NULL;
 }
 
-void
+OS_HOT_CODE void
 os_eventq_put(struct os_eventq *evq, struct os_event *ev)
 {
     int resched;
@@ -61,7 +184,13 @@ os_eventq_put(struct os_eventq *evq, struct os_event *ev)
 
     /* Queue the event */
     ev->ev_queued = 1;
-    STAILQ_INSERT_TAIL(&evq->evq_list, ev, ev_next);
+    os_eventq_link(evq, ev);
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    if (evq->evq_mon) {
+        /* Never 0, which means the put time is unknown */
+        ev->ev_put_time = os_cputime_get32() | 1;
+    }
+#endif
 
     resched = 0;
     if (evq->evq_task) {
@@ -88,34 +217,23 @@ os_eventq_put(struct os_eventq *evq, struct os_event *ev)
     os_trace_api_ret(OS_TRACE_ID_EVENTQ_PUT);
 }
 
-struct os_event *
+OS_HOT_CODE struct os_event *
 os_eventq_get_no_wait(struct os_eventq *evq)
 {
     struct os_event *ev;
 
     os_trace_api_u32(OS_TRACE_ID_EVENTQ_GET_NO_WAIT, (uintptr_t)evq);
 
-    ev = STAILQ_FIRST(&evq->evq_list);
-    if (ev) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
-        ev->ev_queued = 0;
-    }
+    ev = os_eventq_pull(evq);
 
     os_trace_api_ret_u32(OS_TRACE_ID_EVENTQ_GET_NO_WAIT, (uintptr_t)ev);
 
     return ev;
 }
 
-struct os_event *
-os_eventq_get(struct os_eventq *evq)
+static void
+os_eventq_check_owner(struct os_eventq *evq, struct os_task *t)
 {
-    struct os_event *ev;
-    os_sr_t sr;
-    struct os_task *t;
-
-    os_trace_api_u32(OS_TRACE_ID_EVENTQ_GET, (uintptr_t)evq);
-
-    t = os_sched_get_current_task();
     if (evq->evq_owner != t) {
         if (evq->evq_owner == NULL) {
             evq->evq_owner = t;
@@ -127,12 +245,23 @@ os_eventq_get(struct os_eventq *evq)
             assert(0);
         }
     }
+}
+
+OS_HOT_CODE struct os_event *
+os_eventq_get(struct os_eventq *evq)
+{
+    struct os_event *ev;
+    os_sr_t sr;
+    struct os_task *t;
+
+    os_trace_api_u32(OS_TRACE_ID_EVENTQ_GET, (uintptr_t)evq);
+
+    t = os_sched_get_current_task();
+    os_eventq_check_owner(evq, t);
     OS_ENTER_CRITICAL(sr);
 pull_one:
-    ev = STAILQ_FIRST(&evq->evq_list);
+    ev = os_eventq_pull(evq);
     if (ev) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
-        ev->ev_queued = 0;
         t->t_flags &= ~OS_TASK_FLAG_EVQ_WAIT;
     } else {
         evq->evq_task = t;
@@ -157,64 +286,234 @@ pull_one:
     return (ev);
 }
 
+int
+os_eventq_get_batch(struct os_eventq *evq, struct os_event **evs, int max)
+{
+    struct os_event *ev;
+    struct os_task *t;
+    os_sr_t sr;
+    int cnt;
+
+    assert(max > 0);
+
+    os_trace_api_u32x2(OS_TRACE_ID_EVENTQ_GET_BATCH, (uintptr_t)evq,
+                       (uint32_t)max);
+
+    t = os_sched_get_current_task();
+    os_eventq_check_owner(evq, t);
+    OS_ENTER_CRITICAL(sr);
+    while (STAILQ_EMPTY(&evq->evq_list)) {
+        evq->evq_task = t;
+        os_sched_sleep(evq->evq_task, OS_TIMEOUT_NEVER);
+        t->t_flags |= OS_TASK_FLAG_EVQ_WAIT;
+        OS_EXIT_CRITICAL(sr);
+
+        os_sched(NULL);
+
+        OS_ENTER_CRITICAL(sr);
+        evq->evq_task = NULL;
+    }
+    t->t_flags &= ~OS_TASK_FLAG_EVQ_WAIT;
+
+    for (cnt = 0; cnt < max; cnt++) {
+        ev = os_eventq_pull(evq);
+        if (ev == NULL) {
+            break;
+        }
+        evs[cnt] = ev;
+    }
+
+#if MYNEWT_VAL(OS_EVENTQ_BATCH_STATS)
+    evq->evq_batch_cnt++;
+    evq->evq_batch_evs += cnt;
+    if (cnt > evq->evq_batch_max) {
+        evq->evq_batch_max = cnt;
+    }
+#endif
+    OS_EXIT_CRITICAL(sr);
+
+    os_trace_api_ret_u32(OS_TRACE_ID_EVENTQ_GET_BATCH, (uint32_t)cnt);
+
+#if MYNEWT_VAL(OS_EVENTQ_DEBUG)
+    evq->evq_prev = evs[cnt - 1];
+#endif
+
+    return cnt;
+}
+
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+int
+os_eventq_mon_start(struct os_eventq *evq, int cnt, struct os_eventq_mon *mon)
+{
+    os_sr_t sr;
+
+    if (cnt <= 0 || (cnt & (cnt - 1)) != 0) {
+        return OS_EINVAL;
+    }
+
+    memset(mon, 0, cnt * sizeof(*mon));
+
+    OS_ENTER_CRITICAL(sr);
+    os_eventq_mon_unlink(evq);
+    evq->evq_mon_next = os_eventq_mon_list;
+    os_eventq_mon_list = evq;
+    evq->evq_mon = mon;
+    evq->evq_mon_elems = cnt;
+    evq->evq_mon_miss = 0;
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+void
+os_eventq_mon_stop(struct os_eventq *evq)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    os_eventq_mon_unlink(evq);
+    evq->evq_mon = NULL;
+    evq->evq_mon_elems = 0;
+    evq->evq_mon_next = NULL;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_eventq_mon_clear(struct os_eventq *evq)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (evq->evq_mon) {
+        memset(evq->evq_mon, 0, evq->evq_mon_elems * sizeof(*evq->evq_mon));
+        evq->evq_mon_miss = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+struct os_eventq *
+os_eventq_mon_get_next(struct os_eventq *prev)
+{
+    if (prev == NULL) {
+        return os_eventq_mon_list;
+    }
+
+    return prev->evq_mon_next;
+}
+
+/*
+ * The table is open addressed with linear probing.  Callbacks are never
+ * removed, so the first empty slot ends a search.
+ */
 static struct os_eventq_mon *
-os_eventq_mon_find(struct os_eventq *evq, struct os_event *ev)
+os_eventq_mon_find(struct os_eventq *evq, os_event_fn *cb)
 {
+    struct os_eventq_mon *mon;
+    uint32_t mask;
+    uint32_t h;
     int i;
 
-    if (!evq->evq_mon) {
-        return NULL;
-    }
+    mask = evq->evq_mon_elems - 1;
+
+    /* Mix the pointer bits, the low ones are mostly alignment */
+    h = (uint32_t)(uintptr_t)cb;
+    h ^= h >> 16;
+    h *= 0x45d9f3bU;
+    h ^= h >> 16;
+
     for (i = 0; i < evq->evq_mon_elems; i++) {
-        if (evq->evq_mon[i].em_ev == NULL) {
-            evq->evq_mon[i].em_ev = ev;
-            evq->evq_mon[i].em_cb = ev->ev_cb;
+        mon = &evq->evq_mon[(h + i) & mask];
+        if (mon->em_cb == cb) {
+            return mon;
         }
-        if (evq->evq_mon[i].em_ev == ev) {
-            return &evq->evq_mon[i];
+        if (mon->em_cb == NULL) {
+            mon->em_cb = cb;
+            return mon;
         }
     }
+
+    evq->evq_mon_miss++;
     return NULL;
 }
 #endif
 
-void
-os_eventq_run(struct os_eventq *evq)
+static void
+os_eventq_dispatch(struct os_eventq *evq, struct os_event *ev)
 {
-    struct os_event *ev;
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
     struct os_eventq_mon *mon;
+    os_event_fn *cb;
+    uint32_t put_time;
+    uint32_t qdelay;
     uint32_t ticks;
 #endif
 
-    ev = os_eventq_get(evq);
     assert(ev->ev_cb != NULL);
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    if (evq->evq_mon == NULL) {
+        ev->ev_cb(ev);
+        return;
+    }
+
+    /* The callback may free or reuse the event, so note all first */
+    cb = ev->ev_cb;
+    put_time = ev->ev_put_time;
+    ev->ev_put_time = 0;
     ticks = os_cputime_get32();
-#endif
-    ev->ev_cb(ev);
-#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
-    mon = os_eventq_mon_find(evq, ev);
-    if (mon) {
-        /*
-         * If we're monitoring this eventq, and there was space to store
-         * this data, record the time spent on the event callback.
-         */
-        ticks = os_cputime_get32() - ticks;
+    qdelay = put_time ? ticks - put_time : 0;
+
+    cb(ev);
 
+    ticks = os_cputime_get32() - ticks;
+
+    /* Monitoring may have been stopped by the callback */
+    if (evq->evq_mon == NULL) {
+        return;
+    }
+    mon = os_eventq_mon_find(evq, cb);
+    if (mon) {
         mon->em_cnt++;
         mon->em_cum += ticks;
-        if (mon->em_min == 0) {
+        if (mon->em_cnt == 1 || ticks < mon->em_min) {
             mon->em_min = ticks;
         }
         if (ticks > mon->em_max) {
             mon->em_max = ticks;
         }
+        mon->em_qcum += qdelay;
+        if (qdelay > mon->em_qmax) {
+            mon->em_qmax = qdelay;
+        }
     }
+#else
+    ev->ev_cb(ev);
 #endif
 }
 
+OS_HOT_CODE void
+os_eventq_run(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    ev = os_eventq_get(evq);
+    os_eventq_dispatch(evq, ev);
+}
+
+int
+os_eventq_run_n(struct os_eventq *evq, int max)
+{
+    struct os_event *evs[MYNEWT_VAL(OS_EVENTQ_BATCH_MAX)];
+    int cnt;
+    int i;
+
+    cnt = os_eventq_get_batch(evq, evs, min(max, (int)ARRAY_SIZE(evs)));
+    for (i = 0; i < cnt; i++) {
+        os_eventq_dispatch(evq, evs[i]);
+    }
+
+    return cnt;
+}
+
 static struct os_event *
 os_eventq_poll_0timo(struct os_eventq **evq, int nevqs)
 {
@@ -229,10 +528,8 @@ os_eventq_poll_0timo(struct os_eventq **evq, int nevqs)
 
     OS_ENTER_CRITICAL(sr);
     for (i = 0; i < nevqs; i++) {
-        ev = STAILQ_FIRST(&evq[i]->evq_list);
+        ev = os_eventq_pull(evq[i]);
         if (ev) {
-            STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
-            ev->ev_queued = 0;
             break;
         }
     }
@@ -267,10 +564,8 @@ os_eventq_poll(struct os_eventq **evq, int nevqs, os_time_t timo)
     cur_t = os_sched_get_current_task();
 
     for (i = 0; i < nevqs; i++) {
-        ev = STAILQ_FIRST(&evq[i]->evq_list);
+        ev = os_eventq_pull(evq[i]);
         if (ev) {
-            STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
-            ev->ev_queued = 0;
             /* Reset the items that already have an evq task set. */
             for (j = 0; j < i; j++) {
                 evq[j]->evq_task = NULL;
@@ -298,11 +593,7 @@ os_eventq_poll(struct os_eventq **evq, int nevqs, os_time_t timo)
          * we haven't found one.
          */
         if (!ev) {
-            ev = STAILQ_FIRST(&evq[i]->evq_list);
-            if (ev) {
-                STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
-                ev->ev_queued = 0;
-            }
+            ev = os_eventq_pull(evq[i]);
         }
         evq[i]->evq_task = NULL;
     }
@@ -323,7 +614,7 @@ os_eventq_remove(struct os_eventq *evq, struct os_event *ev)
 
     OS_ENTER_CRITICAL(sr);
     if (OS_EVENT_QUEUED(ev)) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+        os_eventq_unlink(evq, ev);
     }
     ev->ev_queued = 0;
     OS_EXIT_CRITICAL(sr);
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+/*
+ * Orders element accesses against index updates. The producer and the
+ * consumer each own one index, so no read-modify-write atomics are needed;
+ * this works on cores without exclusive access instructions (Cortex-M0) too.
+ */
+#define OS_EVRING_BARRIER()     __sync_synchronize()
+
+static void
+os_evring_event_cb(struct os_event *ev)
+{
+    struct os_evring *ring;
+
+    ring = ev->ev_arg;
+
+    /*
+     * Clear the pending flag before draining. Anything pushed after this
+     * point either gets drained below, or posts the event again.
+     */
+    ring->er_pending = 0;
+    OS_EVRING_BARRIER();
+
+    ring->er_cb(ring);
+}
+
+int
+os_evring_init(struct os_evring *ring, struct os_eventq *evq, void *buf,
+               uint16_t elem_size, uint16_t count, os_evring_fn *cb,
+               void *arg)
+{
+    if (evq == NULL || buf == NULL || cb == NULL || elem_size == 0 ||
+        count == 0 || (count & (count - 1)) != 0) {
+        return OS_EINVAL;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->er_buf = buf;
+    ring->er_elem_size = elem_size;
+    ring->er_count = count;
+    ring->er_evq = evq;
+    ring->er_ev.ev_cb = os_evring_event_cb;
+    ring->er_ev.ev_arg = ring;
+    ring->er_cb = cb;
+    ring->er_arg = arg;
+
+    return OS_OK;
+}
+
+int
+os_evring_push(struct os_evring *ring, const void *elem)
+{
+    uint32_t head;
+
+    head = ring->er_head;
+    if (head - ring->er_tail >= ring->er_count) {
+        ring->er_drops++;
+        return OS_ENOMEM;
+    }
+
+    memcpy(ring->er_buf + (head & (ring->er_count - 1)) * ring->er_elem_size,
+           elem, ring->er_elem_size);
+    OS_EVRING_BARRIER();
+    ring->er_head = head + 1;
+    OS_EVRING_BARRIER();
+
+    if (!ring->er_pending) {
+        ring->er_pending = 1;
+        os_eventq_put(ring->er_evq, &ring->er_ev);
+    }
+
+    return OS_OK;
+}
+
+int
+os_evring_pop(struct os_evring *ring, void *elem)
+{
+    uint32_t tail;
+
+    tail = ring->er_tail;
+    if (tail == ring->er_head) {
+        return OS_ENOENT;
+    }
+    OS_EVRING_BARRIER();
+
+    memcpy(elem, ring->er_buf + (tail & (ring->er_count - 1)) *
+           ring->er_elem_size, ring->er_elem_size);
+    OS_EVRING_BARRIER();
+    ring->er_tail = tail + 1;
+
+    return OS_OK;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 
 #if MYNEWT_VAL(OS_SCHEDULING)
@@ -50,13 +51,468 @@ os_malloc_unlock(void)
 #endif
 }
 
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+
+/*
+ * Two-level segregated fit allocator.  Free blocks are kept in size
+ * segregated lists; the first level splits sizes by powers of two and the
+ * second level splits each power of two into OS_HEAP_SL_COUNT linear
+ * ranges.  A pair of bitmaps tracks which lists are non-empty, so both
+ * allocation and free run in constant time regardless of heap state.
+ */
+
+#define OS_HEAP_ALIGN_LOG2      (3)
+#define OS_HEAP_ALIGN           (1 << OS_HEAP_ALIGN_LOG2)
+#define OS_HEAP_SL_LOG2         (4)
+#define OS_HEAP_SL_COUNT        (1 << OS_HEAP_SL_LOG2)
+#define OS_HEAP_FL_SHIFT        (OS_HEAP_SL_LOG2 + OS_HEAP_ALIGN_LOG2)
+#define OS_HEAP_SMALL_SIZE      (1 << OS_HEAP_FL_SHIFT)
+
+/* Blocks are smaller than 1 << OS_HEAP_FL_MAX bytes. */
+#if MYNEWT_VAL(OS_HEAP_TLSF_SIZE) <= (1 << 14)
+#define OS_HEAP_FL_MAX          (14)
+#elif MYNEWT_VAL(OS_HEAP_TLSF_SIZE) <= (1 << 16)
+#define OS_HEAP_FL_MAX          (16)
+#elif MYNEWT_VAL(OS_HEAP_TLSF_SIZE) <= (1 << 18)
+#define OS_HEAP_FL_MAX          (18)
+#elif MYNEWT_VAL(OS_HEAP_TLSF_SIZE) <= (1 << 20)
+#define OS_HEAP_FL_MAX          (20)
+#elif MYNEWT_VAL(OS_HEAP_TLSF_SIZE) <= (1 << 24)
+#define OS_HEAP_FL_MAX          (24)
+#else
+#error "OS_HEAP_TLSF_SIZE must not exceed 16MB"
+#endif
+#define OS_HEAP_FL_COUNT        (OS_HEAP_FL_MAX - OS_HEAP_FL_SHIFT + 1)
+
+#define OS_HEAP_ALIGN_UP(n)                                             \
+    (((n) + OS_HEAP_ALIGN - 1) & ~((size_t)OS_HEAP_ALIGN - 1))
+
+/* Low bit of ohb_size; set while the block sits on a free list. */
+#define OS_HEAP_F_FREE          (0x1)
+
+struct os_heap_blk {
+    /* Physically preceding block; NULL for the first block. */
+    struct os_heap_blk *ohb_prev_phys;
+    /* Payload size in bytes, OR'ed with OS_HEAP_F_FREE. */
+    size_t ohb_size;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    /* Task charged for this block while it is allocated. */
+    struct os_task *ohb_owner;
+#endif
+};
+
+/* Free list links; stored in the payload of free blocks. */
+struct os_heap_links {
+    struct os_heap_blk *ohl_next;
+    struct os_heap_blk *ohl_prev;
+};
+
+#define OS_HEAP_HDR_SIZE        OS_HEAP_ALIGN_UP(sizeof(struct os_heap_blk))
+#define OS_HEAP_MIN_SIZE        OS_HEAP_ALIGN_UP(sizeof(struct os_heap_links))
+
+#define OS_HEAP_BLK_SIZE(b)     ((b)->ohb_size & ~(size_t)OS_HEAP_F_FREE)
+#define OS_HEAP_BLK_IS_FREE(b)  ((b)->ohb_size & OS_HEAP_F_FREE)
+#define OS_HEAP_BLK_DATA(b)     ((uint8_t *)(b) + OS_HEAP_HDR_SIZE)
+#define OS_HEAP_BLK_LINKS(b)    ((struct os_heap_links *)OS_HEAP_BLK_DATA(b))
+#define OS_HEAP_BLK_NEXT(b)                                             \
+    ((struct os_heap_blk *)(OS_HEAP_BLK_DATA(b) + OS_HEAP_BLK_SIZE(b)))
+#define OS_HEAP_BLK_FROM_PTR(p)                                         \
+    ((struct os_heap_blk *)((uint8_t *)(p) - OS_HEAP_HDR_SIZE))
+
+struct os_heap_tlsf {
+    uint32_t oht_fl_bitmap;
+    uint32_t oht_sl_bitmap[OS_HEAP_FL_COUNT];
+    struct os_heap_blk *oht_free[OS_HEAP_FL_COUNT][OS_HEAP_SL_COUNT];
+    size_t oht_total;
+    size_t oht_free_bytes;
+    size_t oht_min_free;
+    uint32_t oht_num_fail;
+    uint8_t oht_initialized;
+};
+
+static struct os_heap_tlsf os_heap_tlsf;
+static uint8_t os_heap_tlsf_mem[MYNEWT_VAL(OS_HEAP_TLSF_SIZE)]
+    __attribute__((aligned(OS_HEAP_ALIGN)));
+
+static inline int
+os_heap_fls(size_t size)
+{
+    return 31 - __builtin_clz((uint32_t)size);
+}
+
+static void
+os_heap_mapping(size_t size, int *fl, int *sl)
+{
+    int f;
+
+    if (size < OS_HEAP_SMALL_SIZE) {
+        *fl = 0;
+        *sl = size / (OS_HEAP_SMALL_SIZE / OS_HEAP_SL_COUNT);
+    } else {
+        f = os_heap_fls(size);
+        *sl = (size >> (f - OS_HEAP_SL_LOG2)) ^ OS_HEAP_SL_COUNT;
+        *fl = f - OS_HEAP_FL_SHIFT + 1;
+    }
+}
+
+static void
+os_heap_blk_insert(struct os_heap_blk *b)
+{
+    struct os_heap_blk *head;
+    int fl;
+    int sl;
+
+    os_heap_mapping(OS_HEAP_BLK_SIZE(b), &fl, &sl);
+
+    head = os_heap_tlsf.oht_free[fl][sl];
+    OS_HEAP_BLK_LINKS(b)->ohl_next = head;
+    OS_HEAP_BLK_LINKS(b)->ohl_prev = NULL;
+    if (head != NULL) {
+        OS_HEAP_BLK_LINKS(head)->ohl_prev = b;
+    }
+    os_heap_tlsf.oht_free[fl][sl] = b;
+    os_heap_tlsf.oht_fl_bitmap |= 1UL << fl;
+    os_heap_tlsf.oht_sl_bitmap[fl] |= 1UL << sl;
+
+    b->ohb_size |= OS_HEAP_F_FREE;
+    os_heap_tlsf.oht_free_bytes += OS_HEAP_BLK_SIZE(b);
+}
+
+static void
+os_heap_blk_remove(struct os_heap_blk *b)
+{
+    struct os_heap_links *links;
+    int fl;
+    int sl;
+
+    os_heap_mapping(OS_HEAP_BLK_SIZE(b), &fl, &sl);
+
+    links = OS_HEAP_BLK_LINKS(b);
+    if (links->ohl_next != NULL) {
+        OS_HEAP_BLK_LINKS(links->ohl_next)->ohl_prev = links->ohl_prev;
+    }
+    if (links->ohl_prev != NULL) {
+        OS_HEAP_BLK_LINKS(links->ohl_prev)->ohl_next = links->ohl_next;
+    } else {
+        os_heap_tlsf.oht_free[fl][sl] = links->ohl_next;
+        if (links->ohl_next == NULL) {
+            os_heap_tlsf.oht_sl_bitmap[fl] &= ~(1UL << sl);
+            if (os_heap_tlsf.oht_sl_bitmap[fl] == 0) {
+                os_heap_tlsf.oht_fl_bitmap &= ~(1UL << fl);
+            }
+        }
+    }
+
+    b->ohb_size &= ~(size_t)OS_HEAP_F_FREE;
+    os_heap_tlsf.oht_free_bytes -= OS_HEAP_BLK_SIZE(b);
+}
+
+/**
+ * Finds a free block of at least the specified size.  The size is rounded
+ * up to the start of the next list, so that any block in the selected list
+ * satisfies the request without walking it.
+ */
+static struct os_heap_blk *
+os_heap_blk_find(size_t size)
+{
+    uint32_t map;
+    int fl;
+    int sl;
+
+    if (size >= OS_HEAP_SMALL_SIZE) {
+        size += (1UL << (os_heap_fls(size) - OS_HEAP_SL_LOG2)) - 1;
+    }
+    os_heap_mapping(size, &fl, &sl);
+    if (fl >= OS_HEAP_FL_COUNT) {
+        return NULL;
+    }
+
+    map = os_heap_tlsf.oht_sl_bitmap[fl] & (~0UL << sl);
+    if (map == 0) {
+        map = os_heap_tlsf.oht_fl_bitmap & (~0UL << (fl + 1));
+        if (map == 0) {
+            return NULL;
+        }
+        fl = __builtin_ctz(map);
+        map = os_heap_tlsf.oht_sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(map);
+
+    return os_heap_tlsf.oht_free[fl][sl];
+}
+
+/* Absorbs block b into the physically preceding block a. */
+static void
+os_heap_blk_merge(struct os_heap_blk *a, struct os_heap_blk *b)
+{
+    a->ohb_size += OS_HEAP_HDR_SIZE + OS_HEAP_BLK_SIZE(b);
+    OS_HEAP_BLK_NEXT(a)->ohb_prev_phys = a;
+}
+
+/* Returns a block to the free lists, coalescing it with free neighbours. */
+static void
+os_heap_blk_release(struct os_heap_blk *b)
+{
+    struct os_heap_blk *next;
+    struct os_heap_blk *prev;
+
+    next = OS_HEAP_BLK_NEXT(b);
+    if (OS_HEAP_BLK_IS_FREE(next)) {
+        os_heap_blk_remove(next);
+        os_heap_blk_merge(b, next);
+    }
+
+    prev = b->ohb_prev_phys;
+    if (prev != NULL && OS_HEAP_BLK_IS_FREE(prev)) {
+        os_heap_blk_remove(prev);
+        os_heap_blk_merge(prev, b);
+        b = prev;
+    }
+
+    os_heap_blk_insert(b);
+}
+
+/* Trims an allocated block to size, freeing the tail if it is usable. */
+static void
+os_heap_blk_trim(struct os_heap_blk *b, size_t size)
+{
+    struct os_heap_blk *tail;
+    size_t cur;
+
+    cur = OS_HEAP_BLK_SIZE(b);
+    if (cur - size < OS_HEAP_HDR_SIZE + OS_HEAP_MIN_SIZE) {
+        return;
+    }
+
+    tail = (struct os_heap_blk *)(OS_HEAP_BLK_DATA(b) + size);
+    tail->ohb_prev_phys = b;
+    tail->ohb_size = cur - size - OS_HEAP_HDR_SIZE;
+    b->ohb_size = size;
+    OS_HEAP_BLK_NEXT(tail)->ohb_prev_phys = tail;
+
+    os_heap_blk_release(tail);
+}
+
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+static void
+os_heap_blk_charge(struct os_heap_blk *b)
+{
+    b->ohb_owner = g_os_started ? os_sched_get_current_task() : NULL;
+    if (b->ohb_owner != NULL) {
+        b->ohb_owner->t_heap_bytes += OS_HEAP_BLK_SIZE(b);
+    }
+}
+
+static void
+os_heap_blk_uncharge(struct os_heap_blk *b)
+{
+    if (b->ohb_owner != NULL) {
+        b->ohb_owner->t_heap_bytes -= OS_HEAP_BLK_SIZE(b);
+    }
+}
+#else
+#define os_heap_blk_charge(b)
+#define os_heap_blk_uncharge(b)
+#endif
+
+static void
+os_heap_tlsf_init(void)
+{
+    struct os_heap_blk *first;
+    struct os_heap_blk *last;
+    size_t len;
+
+    len = sizeof(os_heap_tlsf_mem) & ~((size_t)OS_HEAP_ALIGN - 1);
+
+    /*
+     * The heap is a single free block followed by an empty allocated
+     * sentinel, so that coalescing never has to check for the heap end.
+     */
+    first = (struct os_heap_blk *)os_heap_tlsf_mem;
+    first->ohb_prev_phys = NULL;
+    first->ohb_size = len - 2 * OS_HEAP_HDR_SIZE;
+
+    last = OS_HEAP_BLK_NEXT(first);
+    last->ohb_prev_phys = first;
+    last->ohb_size = 0;
+
+    os_heap_blk_insert(first);
+    os_heap_tlsf.oht_total = os_heap_tlsf.oht_free_bytes;
+    os_heap_tlsf.oht_min_free = os_heap_tlsf.oht_free_bytes;
+    os_heap_tlsf.oht_initialized = 1;
+}
+
+static size_t
+os_heap_tlsf_adjust(size_t size)
+{
+    if (size < OS_HEAP_MIN_SIZE) {
+        return OS_HEAP_MIN_SIZE;
+    }
+    return OS_HEAP_ALIGN_UP(size);
+}
+
+static void *
+os_heap_tlsf_malloc(size_t size)
+{
+    struct os_heap_blk *b;
+
+    if (!os_heap_tlsf.oht_initialized) {
+        os_heap_tlsf_init();
+    }
+
+    if (size == 0) {
+        return NULL;
+    }
+
+    b = NULL;
+    if (size <= os_heap_tlsf.oht_total) {
+        size = os_heap_tlsf_adjust(size);
+        b = os_heap_blk_find(size);
+    }
+    if (b == NULL) {
+        os_heap_tlsf.oht_num_fail++;
+        return NULL;
+    }
+
+    os_heap_blk_remove(b);
+    os_heap_blk_trim(b, size);
+    os_heap_blk_charge(b);
+
+    if (os_heap_tlsf.oht_free_bytes < os_heap_tlsf.oht_min_free) {
+        os_heap_tlsf.oht_min_free = os_heap_tlsf.oht_free_bytes;
+    }
+
+    return OS_HEAP_BLK_DATA(b);
+}
+
+static void
+os_heap_tlsf_free(void *ptr)
+{
+    struct os_heap_blk *b;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    b = OS_HEAP_BLK_FROM_PTR(ptr);
+    assert(!OS_HEAP_BLK_IS_FREE(b));
+
+    os_heap_blk_uncharge(b);
+    os_heap_blk_release(b);
+}
+
+static void *
+os_heap_tlsf_realloc(void *ptr, size_t size)
+{
+    struct os_heap_blk *b;
+    struct os_heap_blk *next;
+    size_t want;
+    void *new_ptr;
+
+    if (ptr == NULL) {
+        return os_heap_tlsf_malloc(size);
+    }
+    if (size == 0) {
+        os_heap_tlsf_free(ptr);
+        return NULL;
+    }
+    if (size > os_heap_tlsf.oht_total) {
+        os_heap_tlsf.oht_num_fail++;
+        return NULL;
+    }
+
+    b = OS_HEAP_BLK_FROM_PTR(ptr);
+    want = os_heap_tlsf_adjust(size);
+
+    /* Grow in place if the following block is free and large enough. */
+    if (want > OS_HEAP_BLK_SIZE(b)) {
+        next = OS_HEAP_BLK_NEXT(b);
+        if (!OS_HEAP_BLK_IS_FREE(next) ||
+            OS_HEAP_BLK_SIZE(b) + OS_HEAP_HDR_SIZE +
+            OS_HEAP_BLK_SIZE(next) < want) {
+
+            new_ptr = os_heap_tlsf_malloc(size);
+            if (new_ptr != NULL) {
+                memcpy(new_ptr, ptr, OS_HEAP_BLK_SIZE(b));
+                os_heap_tlsf_free(ptr);
+            }
+            return new_ptr;
+        }
+
+        os_heap_blk_uncharge(b);
+        os_heap_blk_remove(next);
+        os_heap_blk_merge(b, next);
+    } else {
+        os_heap_blk_uncharge(b);
+    }
+
+    os_heap_blk_trim(b, want);
+    os_heap_blk_charge(b);
+
+    if (os_heap_tlsf.oht_free_bytes < os_heap_tlsf.oht_min_free) {
+        os_heap_tlsf.oht_min_free = os_heap_tlsf.oht_free_bytes;
+    }
+
+    return ptr;
+}
+
+int
+os_heap_info_get(struct os_heap_info *ohi)
+{
+    struct os_heap_blk *b;
+    size_t sz;
+
+    memset(ohi, 0, sizeof(*ohi));
+
+    os_malloc_lock();
+
+    if (!os_heap_tlsf.oht_initialized) {
+        os_heap_tlsf_init();
+    }
+
+    for (b = (struct os_heap_blk *)os_heap_tlsf_mem;
+         OS_HEAP_BLK_SIZE(b) != 0;
+         b = OS_HEAP_BLK_NEXT(b)) {
+
+        if (OS_HEAP_BLK_IS_FREE(b)) {
+            sz = OS_HEAP_BLK_SIZE(b);
+            ohi->ohi_num_free_blks++;
+            if (sz > ohi->ohi_max_free_blk) {
+                ohi->ohi_max_free_blk = sz;
+            }
+        } else {
+            ohi->ohi_num_used_blks++;
+        }
+    }
+
+    ohi->ohi_total = os_heap_tlsf.oht_total;
+    ohi->ohi_free = os_heap_tlsf.oht_free_bytes;
+    ohi->ohi_min_free = os_heap_tlsf.oht_min_free;
+    ohi->ohi_num_fail = os_heap_tlsf.oht_num_fail;
+
+    os_malloc_unlock();
+
+    if (ohi->ohi_free != 0) {
+        ohi->ohi_frag_pct = 100 -
+                            ohi->ohi_max_free_blk * 100 / ohi->ohi_free;
+    }
+
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(OS_HEAP_TLSF) */
+
 void *
 os_malloc(size_t size)
 {
     void *ptr;
 
     os_malloc_lock();
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+    ptr = os_heap_tlsf_malloc(size);
+#else
     ptr = malloc(size);
+#endif
     os_malloc_unlock();
 
     return ptr;
@@ -66,7 +522,11 @@ void
 os_free(void *mem)
 {
     os_malloc_lock();
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+    os_heap_tlsf_free(mem);
+#else
     free(mem);
+#endif
     os_malloc_unlock();
 }
 
@@ -76,7 +536,11 @@ os_realloc(void *ptr, size_t size)
     void *new_ptr;
 
     os_malloc_lock();
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+    new_ptr = os_heap_tlsf_realloc(ptr, size);
+#else
     new_ptr = realloc(ptr, size);
+#endif
     os_malloc_unlock();
 
     return new_ptr;
@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "os_priv.h"
+
+#if MYNEWT_VAL(OS_HRTIMER)
+
+#define OS_HRTIMER_MAX      MYNEWT_VAL(OS_HRTIMER_MAX)
+
+#if OS_HRTIMER_MAX > UINT16_MAX - 1
+#error "OS_HRTIMER_MAX too large"
+#endif
+
+/*
+ * Binary min-heap of pending timers, ordered by expiry time. Each timer
+ * records its own position, so that it can be removed without a search.
+ */
+static struct os_hrtimer *os_hrtimer_heap[OS_HRTIMER_MAX];
+static uint16_t os_hrtimer_cnt;
+
+/* The hal timer, always armed for the root of the heap when non-empty */
+static struct hal_timer os_hrtimer_hal;
+static uint32_t os_hrtimer_hal_expiry;
+static uint8_t os_hrtimer_hal_armed;
+
+static inline int
+os_hrtimer_before(const struct os_hrtimer *a, const struct os_hrtimer *b)
+{
+    return CPUTIME_LT(a->ht_expiry, b->ht_expiry);
+}
+
+static inline void
+os_hrtimer_place(struct os_hrtimer *t, uint16_t idx)
+{
+    os_hrtimer_heap[idx] = t;
+    t->ht_idx = idx + 1;
+}
+
+static void
+os_hrtimer_sift_up(struct os_hrtimer *t, uint16_t idx)
+{
+    uint16_t parent;
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!os_hrtimer_before(t, os_hrtimer_heap[parent])) {
+            break;
+        }
+        os_hrtimer_place(os_hrtimer_heap[parent], idx);
+        idx = parent;
+    }
+    os_hrtimer_place(t, idx);
+}
+
+static void
+os_hrtimer_sift_down(struct os_hrtimer *t, uint16_t idx)
+{
+    uint16_t child;
+
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= os_hrtimer_cnt) {
+            break;
+        }
+        if (child + 1 < os_hrtimer_cnt &&
+            os_hrtimer_before(os_hrtimer_heap[child + 1],
+                              os_hrtimer_heap[child])) {
+            child++;
+        }
+        if (!os_hrtimer_before(os_hrtimer_heap[child], t)) {
+            break;
+        }
+        os_hrtimer_place(os_hrtimer_heap[child], idx);
+        idx = child;
+    }
+    os_hrtimer_place(t, idx);
+}
+
+static void
+os_hrtimer_remove(struct os_hrtimer *t)
+{
+    struct os_hrtimer *last;
+    uint16_t idx;
+
+    idx = t->ht_idx - 1;
+    t->ht_idx = 0;
+
+    os_hrtimer_cnt--;
+    if (idx == os_hrtimer_cnt) {
+        return;
+    }
+
+    /* Move the last timer into the hole, in whichever direction fits. */
+    last = os_hrtimer_heap[os_hrtimer_cnt];
+    if (idx > 0 && os_hrtimer_before(last, os_hrtimer_heap[(idx - 1) / 2])) {
+        os_hrtimer_sift_up(last, idx);
+    } else {
+        os_hrtimer_sift_down(last, idx);
+    }
+}
+
+/* Arms the hal timer for the first pending timer, if it changed. */
+static void
+os_hrtimer_arm(void)
+{
+    struct os_hrtimer *first;
+
+    if (os_hrtimer_cnt == 0) {
+        if (os_hrtimer_hal_armed) {
+            os_cputime_timer_stop(&os_hrtimer_hal);
+            os_hrtimer_hal_armed = 0;
+        }
+        return;
+    }
+
+    first = os_hrtimer_heap[0];
+    if (os_hrtimer_hal_armed && os_hrtimer_hal_expiry == first->ht_expiry) {
+        return;
+    }
+
+    os_cputime_timer_stop(&os_hrtimer_hal);
+    os_cputime_timer_start(&os_hrtimer_hal, first->ht_expiry);
+    os_hrtimer_hal_expiry = first->ht_expiry;
+    os_hrtimer_hal_armed = 1;
+}
+
+static void
+os_hrtimer_expire(void *arg)
+{
+    struct os_hrtimer *t;
+    uint32_t now;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    os_hrtimer_hal_armed = 0;
+
+    now = os_cputime_get32();
+    while (os_hrtimer_cnt > 0) {
+        t = os_hrtimer_heap[0];
+        if (CPUTIME_GT(t->ht_expiry, now)) {
+            break;
+        }
+
+        os_hrtimer_remove(t);
+        if (t->ht_evq) {
+            os_eventq_put(t->ht_evq, &t->ht_ev);
+        } else {
+            OS_EXIT_CRITICAL(sr);
+            t->ht_ev.ev_cb(&t->ht_ev);
+            OS_ENTER_CRITICAL(sr);
+            /* The callback may have taken a while. */
+            now = os_cputime_get32();
+        }
+    }
+
+    os_hrtimer_arm();
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_hrtimer_module_init(void)
+{
+    os_hrtimer_cnt = 0;
+    os_cputime_timer_init(&os_hrtimer_hal, os_hrtimer_expire, NULL);
+}
+
+void
+os_hrtimer_init(struct os_hrtimer *t, struct os_eventq *evq,
+                os_event_fn *ev_cb, void *ev_arg)
+{
+    assert(ev_cb != NULL);
+
+    memset(t, 0, sizeof(*t));
+    t->ht_ev.ev_cb = ev_cb;
+    t->ht_ev.ev_arg = ev_arg;
+    t->ht_evq = evq;
+}
+
+int
+os_hrtimer_start(struct os_hrtimer *t, uint32_t cputime)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (os_hrtimer_queued(t)) {
+        os_hrtimer_remove(t);
+    } else if (os_hrtimer_cnt >= OS_HRTIMER_MAX) {
+        rc = OS_ENOMEM;
+        goto done;
+    }
+
+    if (t->ht_evq) {
+        os_eventq_remove(t->ht_evq, &t->ht_ev);
+    }
+
+    t->ht_expiry = cputime;
+    os_hrtimer_cnt++;
+    os_hrtimer_sift_up(t, os_hrtimer_cnt - 1);
+    os_hrtimer_arm();
+    rc = 0;
+
+done:
+    OS_EXIT_CRITICAL(sr);
+    return rc;
+}
+
+int
+os_hrtimer_relative(struct os_hrtimer *t, uint32_t usecs)
+{
+    return os_hrtimer_start(t,
+                            os_cputime_get32() +
+                            os_cputime_usecs_to_ticks(usecs));
+}
+
+void
+os_hrtimer_stop(struct os_hrtimer *t)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (os_hrtimer_queued(t)) {
+        os_hrtimer_remove(t);
+        os_hrtimer_arm();
+    }
+
+    if (t->ht_evq) {
+        os_eventq_remove(t->ht_evq, &t->ht_ev);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+#endif
@@ -54,9 +54,76 @@ os_mqueue_init(struct os_mqueue *mq, os_event_fn *ev_cb, void *arg)
     ev->ev_cb = ev_cb;
     ev->ev_arg = arg;
 
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+    mq->mq_count = 0;
+    mq->mq_high = 0;
+    mq->mq_low = 0;
+    mq->mq_full = 0;
+    mq->mq_waiters = 0;
+    mq->mq_space_cb = NULL;
+    mq->mq_space_arg = NULL;
+    os_sem_init(&mq->mq_space_sem, 0);
+#endif
+
+    return (0);
+}
+
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+int
+os_mqueue_set_limits(struct os_mqueue *mq, uint16_t high, uint16_t low,
+                     os_mqueue_space_fn *space_cb, void *arg)
+{
+    os_sr_t sr;
+
+    if (high != 0 && low >= high) {
+        return (OS_EINVAL);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    mq->mq_high = high;
+    mq->mq_low = low;
+    mq->mq_space_cb = space_cb;
+    mq->mq_space_arg = arg;
+    OS_EXIT_CRITICAL(sr);
+
     return (0);
 }
 
+/**
+ * Called after a packet was taken off the queue.  Resumes producers if the
+ * queue was full and has drained to the low watermark.
+ */
+static void
+os_mqueue_drained(struct os_mqueue *mq)
+{
+    os_sr_t sr;
+    int waiters;
+    int resume;
+
+    OS_ENTER_CRITICAL(sr);
+    resume = mq->mq_full && mq->mq_count <= mq->mq_low;
+    if (resume) {
+        mq->mq_full = 0;
+        waiters = mq->mq_waiters;
+        mq->mq_waiters = 0;
+    } else {
+        waiters = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!resume) {
+        return;
+    }
+
+    while (waiters-- > 0) {
+        os_sem_release(&mq->mq_space_sem);
+    }
+    if (mq->mq_space_cb != NULL) {
+        mq->mq_space_cb(mq, mq->mq_space_arg);
+    }
+}
+#endif
+
 struct os_mbuf *
 os_mqueue_get(struct os_mqueue *mq)
 {
@@ -68,11 +135,17 @@ os_mqueue_get(struct os_mqueue *mq)
     mp = STAILQ_FIRST(&mq->mq_head);
     if (mp) {
         STAILQ_REMOVE_HEAD(&mq->mq_head, omp_next);
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+        mq->mq_count--;
+#endif
     }
     OS_EXIT_CRITICAL(sr);
 
     if (mp) {
         m = OS_MBUF_PKTHDR_TO_MBUF(mp);
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+        os_mqueue_drained(mq);
+#endif
     } else {
         m = NULL;
     }
@@ -96,6 +169,15 @@ os_mqueue_put(struct os_mqueue *mq, struct os_eventq *evq, struct os_mbuf *om)
     mp = OS_MBUF_PKTHDR(om);
 
     OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+    if (mq->mq_high != 0 && mq->mq_count >= mq->mq_high) {
+        mq->mq_full = 1;
+        OS_EXIT_CRITICAL(sr);
+        rc = OS_EBUSY;
+        goto err;
+    }
+    mq->mq_count++;
+#endif
     STAILQ_INSERT_TAIL(&mq->mq_head, mp, omp_next);
     OS_EXIT_CRITICAL(sr);
 
@@ -109,12 +191,65 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(OS_MQUEUE_FLOW_CONTROL)
+int
+os_mqueue_put_wait(struct os_mqueue *mq, struct os_eventq *evq,
+                   struct os_mbuf *om, os_time_t timeout)
+{
+    os_time_t start;
+    os_time_t elapsed;
+    os_sr_t sr;
+    int rc;
+
+    start = os_time_get();
+    while (1) {
+        rc = os_mqueue_put(mq, evq, om);
+        if (rc != OS_EBUSY) {
+            return (rc);
+        }
+
+        elapsed = os_time_get() - start;
+        if (elapsed >= timeout) {
+            return (OS_EBUSY);
+        }
+
+        /* Register as a waiter, unless the queue drained meanwhile. */
+        OS_ENTER_CRITICAL(sr);
+        if (!mq->mq_full) {
+            OS_EXIT_CRITICAL(sr);
+            continue;
+        }
+        mq->mq_waiters++;
+        OS_EXIT_CRITICAL(sr);
+
+        if (os_sem_pend(&mq->mq_space_sem,
+                        timeout == OS_TIMEOUT_NEVER ?
+                        OS_TIMEOUT_NEVER : timeout - elapsed) != OS_OK) {
+            /* A wakeup may still have been counted for us; the spare token
+             * only causes a retry for a later waiter.
+             */
+            OS_ENTER_CRITICAL(sr);
+            if (mq->mq_waiters > 0) {
+                mq->mq_waiters--;
+            }
+            OS_EXIT_CRITICAL(sr);
+        }
+    }
+}
+#endif
+
 int
 os_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
                   uint16_t buf_len, uint16_t nbufs)
 {
     omp->omp_databuf_len = buf_len - sizeof(struct os_mbuf);
     omp->omp_pool = mp;
+    omp->omp_num_fail = 0;
+    omp->omp_num_fallback = 0;
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    omp->omp_num_shared = 0;
+    omp->omp_num_clones = 0;
+#endif
 
     return (0);
 }
@@ -136,6 +271,7 @@ os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
     if (!om) {
         goto done;
     }
+    OS_MEMPOOL_TRACK_CALLER(omp->omp_pool, om);
 
     SLIST_NEXT(om, om_next) = NULL;
     om->om_flags = 0;
@@ -143,6 +279,9 @@ os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
     om->om_len = 0;
     om->om_data = (&om->om_databuf[0] + leadingspace);
     om->om_omp = omp;
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    om->om_refcnt = 1;
+#endif
 
 done:
     os_trace_api_ret_u32(OS_TRACE_ID_MBUF_GET, (uintptr_t)om);
@@ -168,6 +307,7 @@ os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t user_pkthdr_len)
 
     om = os_mbuf_get(omp, 0);
     if (om) {
+        OS_MEMPOOL_TRACK_CALLER(omp->omp_pool, om);
         om->om_pkthdr_len = pkthdr_len;
         om->om_data += pkthdr_len;
 
@@ -182,6 +322,119 @@ done:
     return om;
 }
 
+void
+os_mbuf_ext_init(struct os_mbuf_ext *ext, os_mbuf_ext_free_fn *free_cb,
+                 void *arg)
+{
+    ext->ome_free_cb = free_cb;
+    ext->ome_arg = arg;
+    ext->ome_refcnt = 0;
+}
+
+static void
+os_mbuf_ext_ref(struct os_mbuf_ext *ext)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(ext->ome_refcnt < UINT16_MAX);
+    ext->ome_refcnt++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+os_mbuf_ext_unref(struct os_mbuf_ext *ext)
+{
+    uint16_t refcnt;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(ext->ome_refcnt > 0);
+    refcnt = --ext->ome_refcnt;
+    OS_EXIT_CRITICAL(sr);
+
+    if (refcnt == 0 && ext->ome_free_cb != NULL) {
+        ext->ome_free_cb(ext);
+    }
+}
+
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+/* Drops a reference to a block's data; returns the number left. */
+static uint16_t
+os_mbuf_unref(struct os_mbuf *om)
+{
+    uint16_t refcnt;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(om->om_refcnt > 0);
+    refcnt = --om->om_refcnt;
+    if (refcnt == 1) {
+        om->om_omp->omp_num_shared--;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return refcnt;
+}
+#endif
+
+/*
+ * Drops the reference an external or clone mbuf holds on the storage at
+ * `ref`, leaving the mbuf as a regular one.
+ */
+static void
+os_mbuf_drop_ref(struct os_mbuf *om, void *ref)
+{
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    os_sr_t sr;
+#endif
+
+    if (OS_MBUF_IS_EXT(om)) {
+        om->om_flags &= ~OS_MBUF_F_EXT;
+        os_mbuf_ext_unref(ref);
+    }
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    else if (om->om_flags & OS_MBUF_F_CLONE) {
+        om->om_flags &= ~OS_MBUF_F_CLONE;
+
+        OS_ENTER_CRITICAL(sr);
+        om->om_omp->omp_num_clones--;
+        OS_EXIT_CRITICAL(sr);
+
+        os_mbuf_free(ref);
+    }
+#endif
+}
+
+int
+os_mbuf_ext_attach(struct os_mbuf *om, struct os_mbuf_ext *ext,
+                   void *data, uint16_t len)
+{
+    if (om->om_omp == NULL || om->om_len != 0 ||
+        om->om_flags & (OS_MBUF_F_EXT | OS_MBUF_F_CLONE) ||
+        OS_MBUF_IS_SHARED(om) || SLIST_NEXT(om, om_next) != NULL) {
+        return OS_EINVAL;
+    }
+
+    /* The descriptor pointer must not overlap the packet header. */
+    if ((uint8_t *)_os_mbuf_ref_slot(om) <
+        om->om_databuf + om->om_pkthdr_len) {
+        return OS_EINVAL;
+    }
+
+    os_mbuf_ext_ref(ext);
+    OS_MBUF_EXT(om) = ext;
+    om->om_flags |= OS_MBUF_F_EXT;
+    om->om_data = data;
+    om->om_len = len;
+
+    if (OS_MBUF_IS_PKTHDR(om)) {
+        OS_MBUF_PKTHDR(om)->omp_len += len;
+    }
+
+    return 0;
+}
+
 int
 os_mbuf_free(struct os_mbuf *om)
 {
@@ -190,6 +443,16 @@ os_mbuf_free(struct os_mbuf *om)
     os_trace_api_u32(OS_TRACE_ID_MBUF_FREE, (uintptr_t)om);
 
     if (om->om_omp != NULL) {
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+        /* The block stays allocated while clones still use its data. */
+        if (os_mbuf_unref(om) > 0) {
+            rc = 0;
+            goto done;
+        }
+#endif
+        if (om->om_flags & (OS_MBUF_F_EXT | OS_MBUF_F_CLONE)) {
+            os_mbuf_drop_ref(om, *_os_mbuf_ref_slot(om));
+        }
         rc = os_memblock_put(om->om_omp->omp_pool, om);
         if (rc != 0) {
             goto done;
@@ -397,15 +660,113 @@ os_mbuf_dup(struct os_mbuf *om)
             }
             copy = head;
         }
-        copy->om_flags = om->om_flags;
+        copy->om_flags = om->om_flags & ~OS_MBUF_F_CLONE;
         copy->om_len = om->om_len;
-        memcpy(OS_MBUF_DATA(copy, uint8_t *), OS_MBUF_DATA(om, uint8_t *),
-                om->om_len);
+        if (OS_MBUF_IS_EXT(om)) {
+            /* Share external storage rather than copying it. */
+            os_mbuf_ext_ref(OS_MBUF_EXT(om));
+            OS_MBUF_EXT(copy) = OS_MBUF_EXT(om);
+            copy->om_data = om->om_data;
+        } else {
+            memcpy(OS_MBUF_DATA(copy, uint8_t *), OS_MBUF_DATA(om, uint8_t *),
+                    om->om_len);
+        }
+    }
+
+    return (head);
+err:
+    return (NULL);
+}
+
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+/* Makes the empty mbuf `copy` refer to the data of `om`. */
+static int
+os_mbuf_share(struct os_mbuf *copy, struct os_mbuf *om)
+{
+    struct os_mbuf *src;
+    os_sr_t sr;
+
+    /* The reference must not overlap the packet header. */
+    if ((uint8_t *)_os_mbuf_ref_slot(copy) <
+        copy->om_databuf + copy->om_pkthdr_len) {
+        return OS_ENOMEM;
+    }
+
+    copy->om_flags = om->om_flags & ~(OS_MBUF_F_EXT | OS_MBUF_F_CLONE);
+    copy->om_data = om->om_data;
+    copy->om_len = om->om_len;
+
+    if (OS_MBUF_IS_EXT(om)) {
+        os_mbuf_ext_ref(OS_MBUF_EXT(om));
+        OS_MBUF_EXT(copy) = OS_MBUF_EXT(om);
+        copy->om_flags |= OS_MBUF_F_EXT;
+        return 0;
+    }
+
+    /* Always refer to the block holding the data, never to another clone. */
+    if (om->om_flags & OS_MBUF_F_CLONE) {
+        src = OS_MBUF_CLONE_SRC(om);
+    } else {
+        src = om;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    assert(src->om_refcnt < UINT16_MAX);
+    if (++src->om_refcnt == 2) {
+        src->om_omp->omp_num_shared++;
+    }
+    copy->om_omp->omp_num_clones++;
+    OS_EXIT_CRITICAL(sr);
+
+    OS_MBUF_CLONE_SRC(copy) = src;
+    copy->om_flags |= OS_MBUF_F_CLONE;
+
+    return 0;
+}
+#endif
+
+struct os_mbuf *
+os_mbuf_clone(struct os_mbuf *om)
+{
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    struct os_mbuf_pool *omp;
+    struct os_mbuf *head;
+    struct os_mbuf *copy;
+    struct os_mbuf *cur;
+
+    omp = om->om_omp;
+
+    head = NULL;
+    copy = NULL;
+
+    for (; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        cur = os_mbuf_get(omp, 0);
+        if (cur == NULL) {
+            goto err;
+        }
+
+        if (head) {
+            SLIST_NEXT(copy, om_next) = cur;
+        } else {
+            head = cur;
+            if (OS_MBUF_IS_PKTHDR(om)) {
+                _os_mbuf_copypkthdr(head, om);
+            }
+        }
+        copy = cur;
+
+        if (os_mbuf_share(copy, om) != 0) {
+            goto err;
+        }
     }
 
     return (head);
 err:
+    os_mbuf_free_chain(head);
     return (NULL);
+#else
+    return os_mbuf_dup(om);
+#endif
 }
 
 struct os_mbuf *
@@ -471,6 +832,84 @@ os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst)
     return (len > 0 ? -1 : 0);
 }
 
+int
+os_mbuf_iter_init(struct os_mbuf_iter *it, const struct os_mbuf *om,
+                  uint16_t off, uint16_t len)
+{
+    const struct os_mbuf *cur;
+    uint16_t cur_off;
+    int avail;
+
+    cur = os_mbuf_off(om, off, &cur_off);
+    if (cur == NULL) {
+        return OS_EINVAL;
+    }
+
+    avail = -cur_off;
+    for (om = cur; om != NULL && avail < len; om = SLIST_NEXT(om, om_next)) {
+        avail += om->om_len;
+    }
+    if (avail < len) {
+        return OS_EINVAL;
+    }
+
+    it->omi_om = cur;
+    it->omi_off = cur_off;
+    it->omi_rem = len;
+
+    return 0;
+}
+
+uint16_t
+os_mbuf_iter_next(struct os_mbuf_iter *it, void **data)
+{
+    uint16_t seg_len;
+
+    while (it->omi_rem > 0 && it->omi_om != NULL) {
+        seg_len = min(it->omi_om->om_len - it->omi_off, it->omi_rem);
+        if (seg_len > 0) {
+            *data = it->omi_om->om_data + it->omi_off;
+            it->omi_off += seg_len;
+            it->omi_rem -= seg_len;
+            return seg_len;
+        }
+
+        it->omi_om = SLIST_NEXT(it->omi_om, om_next);
+        it->omi_off = 0;
+    }
+
+    return 0;
+}
+
+int
+os_mbuf_to_iovec(const struct os_mbuf *om, uint16_t off, uint16_t len,
+                 struct os_mbuf_iovec *iov, int iovcnt)
+{
+    struct os_mbuf_iter it;
+    uint16_t seg_len;
+    void *data;
+    int cnt;
+    int rc;
+
+    rc = os_mbuf_iter_init(&it, om, off, len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    cnt = 0;
+    while ((seg_len = os_mbuf_iter_next(&it, &data)) != 0) {
+        if (cnt >= iovcnt) {
+            return OS_ENOMEM;
+        }
+
+        iov[cnt].omv_base = data;
+        iov[cnt].omv_len = seg_len;
+        cnt++;
+    }
+
+    return cnt;
+}
+
 void
 os_mbuf_adj(struct os_mbuf *om, int req_len)
 {
@@ -713,6 +1152,57 @@ os_mbuf_prepend_pullup(struct os_mbuf *om, uint16_t len)
     return om;
 }
 
+/*
+ * Gives `om` private data that can be written without affecting other mbufs
+ * sharing it.  An external or clone mbuf copies its data into its own data
+ * buffer if it fits and drops its reference.  Otherwise, the data is copied
+ * into fresh mbufs inserted after `om`, and `om` is left empty.
+ *
+ * Returns the mbuf now holding the start of om's data; NULL if out of mbufs.
+ */
+static struct os_mbuf *
+os_mbuf_unshare(struct os_mbuf *om)
+{
+    struct os_mbuf *newm;
+    struct os_mbuf *last;
+    uint8_t *dptr;
+    void *ref;
+
+    if (!OS_MBUF_IS_SHARED(om)) {
+        return om;
+    }
+
+    if (om->om_flags & (OS_MBUF_F_EXT | OS_MBUF_F_CLONE) &&
+        om->om_len <= om->om_omp->omp_databuf_len - om->om_pkthdr_len) {
+        /* The data may cover the reference; read it first. */
+        ref = *_os_mbuf_ref_slot(om);
+        dptr = om->om_databuf + om->om_pkthdr_len;
+        memcpy(dptr, om->om_data, om->om_len);
+        om->om_data = dptr;
+        os_mbuf_drop_ref(om, ref);
+        return om;
+    }
+
+    newm = os_mbuf_get(om->om_omp, 0);
+    if (newm == NULL) {
+        return NULL;
+    }
+    if (os_mbuf_append(newm, om->om_data, om->om_len) != 0) {
+        os_mbuf_free_chain(newm);
+        return NULL;
+    }
+
+    last = newm;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+    SLIST_NEXT(last, om_next) = SLIST_NEXT(om, om_next);
+    SLIST_NEXT(om, om_next) = newm;
+    om->om_len = 0;
+
+    return newm;
+}
+
 int
 os_mbuf_copyinto(struct os_mbuf *om, int off, const void *src, int len)
 {
@@ -733,6 +1223,15 @@ os_mbuf_copyinto(struct os_mbuf *om, int off, const void *src, int len)
     sptr = src;
     while (1) {
         copylen = min(cur->om_len - cur_off, len);
+        if (copylen > 0 && OS_MBUF_IS_SHARED(cur)) {
+            /* Copy on write; the data may now span several mbufs. */
+            cur = os_mbuf_unshare(cur);
+            if (cur == NULL) {
+                return OS_ENOMEM;
+            }
+            cur = os_mbuf_off(cur, cur_off, &cur_off);
+            copylen = min(cur->om_len - cur_off, len);
+        }
         if (copylen > 0) {
             memcpy(cur->om_data + cur_off, sptr, copylen);
             sptr += copylen;
@@ -1127,3 +1626,29 @@ os_mbuf_pack_chains(struct os_mbuf *m1, struct os_mbuf *m2)
 
     return m1;
 }
+
+int
+os_mbuf_compact(struct os_mbuf *om)
+{
+    const struct os_mbuf *cur;
+    int before;
+    int after;
+
+    if (om == NULL) {
+        return 0;
+    }
+
+    before = 0;
+    for (cur = om; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        before++;
+    }
+
+    os_mbuf_pack_chains(om, NULL);
+
+    after = 0;
+    for (cur = om; cur != NULL; cur = SLIST_NEXT(cur, om_next)) {
+        after++;
+    }
+
+    return before - after;
+}
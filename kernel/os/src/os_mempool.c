@@ -114,6 +114,254 @@ os_mempool_guard_check(const struct os_mempool *mp, void *start)
 #define os_mempool_guard_check(mp, start)
 #endif
 
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+#define OS_MEMPOOL_TRACK_NONE   0xffff
+#define OS_MEMPOOL_TRACK_NOTASK 0xff
+
+/*
+ * Allocation site of a block; ot_pc is 0 while the block is free.
+ * ot_taskid is the task running at allocation time, which for blocks
+ * allocated from an ISR is the interrupted task.
+ */
+struct os_mempool_track {
+    uintptr_t ot_pc;
+    os_time_t ot_time;
+    uint8_t ot_taskid;
+};
+
+/* Entries of the table given to a pool; kept across re-initialization. */
+struct os_mempool_track_pool {
+    const struct os_mempool *otp_mp;
+    uint16_t otp_base;
+    uint16_t otp_num;
+};
+
+static struct os_mempool_track
+    os_mempool_track_tbl[MYNEWT_VAL(OS_MEMPOOL_TRACK_ENTRIES)];
+static uint16_t os_mempool_track_used;
+static struct os_mempool_track_pool
+    os_mempool_track_pools[MYNEWT_VAL(OS_MEMPOOL_TRACK_POOLS)];
+static uint8_t os_mempool_track_num_pools;
+
+static void
+os_mempool_track_init(struct os_mempool *mp)
+{
+    struct os_mempool_track_pool *otp;
+    uint16_t base;
+    bool added;
+    os_sr_t sr;
+    int i;
+
+    mp->mp_track_base = OS_MEMPOOL_TRACK_NONE;
+    if (mp->mp_num_blocks == 0) {
+        return;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    /* A re-initialized pool replaces its own entries. */
+    otp = NULL;
+    for (i = 0; i < os_mempool_track_num_pools; i++) {
+        if (os_mempool_track_pools[i].otp_mp == mp) {
+            otp = &os_mempool_track_pools[i];
+            break;
+        }
+    }
+
+    added = false;
+    if (otp == NULL) {
+        if (os_mempool_track_num_pools >= MYNEWT_VAL(OS_MEMPOOL_TRACK_POOLS)) {
+            goto done;
+        }
+        otp = &os_mempool_track_pools[os_mempool_track_num_pools];
+        otp->otp_mp = mp;
+        otp->otp_base = os_mempool_track_used;
+        otp->otp_num = 0;
+        added = true;
+    }
+
+    if (otp->otp_num < mp->mp_num_blocks) {
+        /* Grown pools move to the end of the table, unless already there. */
+        if (otp->otp_base + otp->otp_num == os_mempool_track_used) {
+            base = otp->otp_base;
+        } else {
+            base = os_mempool_track_used;
+        }
+        if (base + mp->mp_num_blocks > MYNEWT_VAL(OS_MEMPOOL_TRACK_ENTRIES)) {
+            goto done;
+        }
+        otp->otp_base = base;
+        otp->otp_num = mp->mp_num_blocks;
+        os_mempool_track_used = base + mp->mp_num_blocks;
+    }
+
+    if (added) {
+        os_mempool_track_num_pools++;
+    }
+
+    mp->mp_track_base = otp->otp_base;
+    memset(&os_mempool_track_tbl[mp->mp_track_base], 0,
+           mp->mp_num_blocks * sizeof(struct os_mempool_track));
+
+done:
+    OS_EXIT_CRITICAL(sr);
+}
+
+static struct os_mempool_track *
+os_mempool_track_entry(const struct os_mempool *mp, const void *block)
+{
+    uintptr_t idx;
+
+    if (mp->mp_track_base == OS_MEMPOOL_TRACK_NONE) {
+        return NULL;
+    }
+
+    idx = ((uintptr_t)block - mp->mp_membuf_addr) /
+          OS_MEMPOOL_TRUE_BLOCK_SIZE(mp);
+    if (idx >= mp->mp_num_blocks) {
+        return NULL;
+    }
+
+    return &os_mempool_track_tbl[mp->mp_track_base + idx];
+}
+
+static void
+os_mempool_track_get(const struct os_mempool *mp, const void *block, void *pc)
+{
+    struct os_mempool_track *ot;
+    struct os_task *t;
+
+    ot = os_mempool_track_entry(mp, block);
+    if (ot != NULL) {
+        t = os_sched_get_current_task();
+        ot->ot_pc = (uintptr_t)pc;
+        ot->ot_time = os_time_get();
+        ot->ot_taskid = t != NULL ? t->t_taskid : OS_MEMPOOL_TRACK_NOTASK;
+    }
+}
+
+static void
+os_mempool_track_put(const struct os_mempool *mp, const void *block)
+{
+    struct os_mempool_track *ot;
+
+    ot = os_mempool_track_entry(mp, block);
+    if (ot != NULL) {
+        ot->ot_pc = 0;
+    }
+}
+
+static void
+os_mempool_track_clear(const struct os_mempool *mp)
+{
+    if (mp->mp_track_base != OS_MEMPOOL_TRACK_NONE) {
+        memset(&os_mempool_track_tbl[mp->mp_track_base], 0,
+               mp->mp_num_blocks * sizeof(struct os_mempool_track));
+    }
+}
+
+void
+os_mempool_track_set(const struct os_mempool *mp, const void *block, void *pc)
+{
+    struct os_mempool_track *ot;
+
+    ot = os_mempool_track_entry(mp, block);
+    if (ot != NULL) {
+        ot->ot_pc = (uintptr_t)pc;
+    }
+}
+
+int
+os_mempool_sites_get(struct os_mempool_site *sites, int max_sites)
+{
+    struct os_mempool_track ot;
+    struct os_mempool *mp;
+    os_time_t now;
+    os_time_t age;
+    os_sr_t sr;
+    int num;
+    int i;
+    int j;
+
+    num = 0;
+    now = os_time_get();
+
+    STAILQ_FOREACH(mp, &g_os_mempool_list, mp_list) {
+        if (mp->mp_track_base == OS_MEMPOOL_TRACK_NONE) {
+            continue;
+        }
+
+        for (i = 0; i < mp->mp_num_blocks; i++) {
+            OS_ENTER_CRITICAL(sr);
+            ot = os_mempool_track_tbl[mp->mp_track_base + i];
+            OS_EXIT_CRITICAL(sr);
+
+            if (ot.ot_pc == 0) {
+                continue;
+            }
+
+            for (j = 0; j < num; j++) {
+                if (sites[j].oms_pool == mp && sites[j].oms_pc == ot.ot_pc) {
+                    break;
+                }
+            }
+            if (j == num) {
+                if (num >= max_sites) {
+                    continue;
+                }
+                sites[num++] = (struct os_mempool_site) {
+                    .oms_pool = mp,
+                    .oms_pc = ot.ot_pc,
+                };
+            }
+
+            age = now - ot.ot_time;
+            sites[j].oms_count++;
+            sites[j].oms_bytes += mp->mp_block_size;
+            if (age > sites[j].oms_max_age) {
+                sites[j].oms_max_age = age;
+            }
+        }
+    }
+
+    return num;
+}
+
+void
+os_mempool_task_usage(uint8_t taskid, uint16_t *blocks, uint32_t *bytes)
+{
+    struct os_mempool_track ot;
+    struct os_mempool *mp;
+    os_sr_t sr;
+    int i;
+
+    *blocks = 0;
+    *bytes = 0;
+
+    STAILQ_FOREACH(mp, &g_os_mempool_list, mp_list) {
+        if (mp->mp_track_base == OS_MEMPOOL_TRACK_NONE) {
+            continue;
+        }
+
+        for (i = 0; i < mp->mp_num_blocks; i++) {
+            OS_ENTER_CRITICAL(sr);
+            ot = os_mempool_track_tbl[mp->mp_track_base + i];
+            OS_EXIT_CRITICAL(sr);
+
+            if (ot.ot_pc != 0 && ot.ot_taskid == taskid) {
+                (*blocks)++;
+                *bytes += mp->mp_block_size;
+            }
+        }
+    }
+}
+#else
+#define os_mempool_track_init(mp)
+#define os_mempool_track_get(mp, block, pc)
+#define os_mempool_track_put(mp, block)
+#define os_mempool_track_clear(mp)
+#endif
+
 static os_error_t
 os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
                          uint32_t block_size, void *membuf, char *name,
@@ -151,6 +399,7 @@ os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
     mp->mp_membuf_addr = (uintptr_t)membuf;
     mp->name = name;
     SLIST_FIRST(mp) = membuf;
+    os_mempool_track_init(mp);
 
     if (blocks > 0) {
         os_mempool_poison(mp, membuf);
@@ -257,6 +506,7 @@ os_mempool_clear(struct os_mempool *mp)
     /* cleanup the memory pool structure */
     mp->mp_num_free = mp->mp_num_blocks;
     mp->mp_min_free = mp->mp_num_blocks;
+    os_mempool_track_clear(mp);
     os_mempool_poison(mp, (void *)mp->mp_membuf_addr);
     os_mempool_guard(mp, (void *)mp->mp_membuf_addr);
     SLIST_FIRST(mp) = (void *)mp->mp_membuf_addr;
@@ -322,7 +572,7 @@ os_memblock_from(const struct os_mempool *mp, const void *block_addr)
     return 1;
 }
 
-void *
+OS_HOT_CODE void *
 os_memblock_get(struct os_mempool *mp)
 {
     os_sr_t sr;
@@ -353,6 +603,7 @@ os_memblock_get(struct os_mempool *mp)
         if (block) {
             os_mempool_poison_check(mp, block);
             os_mempool_guard_check(mp, block);
+            os_mempool_track_get(mp, block, __builtin_return_address(0));
         }
     }
 
@@ -361,7 +612,7 @@ os_memblock_get(struct os_mempool *mp)
     return (void *)block;
 }
 
-os_error_t
+OS_HOT_CODE os_error_t
 os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
 {
     os_sr_t sr;
@@ -372,6 +623,7 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
 
     os_mempool_guard_check(mp, block_addr);
     os_mempool_poison(mp, block_addr);
+    os_mempool_track_put(mp, block_addr);
 
     block = (struct os_memblock *)block_addr;
     OS_ENTER_CRITICAL(sr);
@@ -391,7 +643,7 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
     return OS_OK;
 }
 
-os_error_t
+OS_HOT_CODE os_error_t
 os_memblock_put(struct os_mempool *mp, void *block_addr)
 {
     struct os_mempool_ext *mpe;
@@ -443,6 +695,194 @@ done:
     return ret;
 }
 
+int
+os_memblock_get_n(struct os_mempool *mp, void **blocks, int n)
+{
+    struct os_memblock *block;
+    os_sr_t sr;
+    int cnt;
+    int i;
+
+    if (mp == NULL || n <= 0) {
+        return 0;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    cnt = min(n, mp->mp_num_free);
+    for (i = 0; i < cnt; i++) {
+        block = SLIST_FIRST(mp);
+        SLIST_FIRST(mp) = SLIST_NEXT(block, mb_next);
+        blocks[i] = block;
+    }
+    mp->mp_num_free -= cnt;
+    if (mp->mp_min_free > mp->mp_num_free) {
+        mp->mp_min_free = mp->mp_num_free;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    for (i = 0; i < cnt; i++) {
+        os_mempool_poison_check(mp, blocks[i]);
+        os_mempool_guard_check(mp, blocks[i]);
+        os_mempool_track_get(mp, blocks[i], __builtin_return_address(0));
+    }
+
+    return cnt;
+}
+
+os_error_t
+os_memblock_put_n(struct os_mempool *mp, void **blocks, int n)
+{
+    struct os_memblock *first;
+    struct os_memblock *last;
+#if MYNEWT_VAL(OS_MEMPOOL_CHECK)
+    struct os_memblock *block;
+#endif
+    os_error_t rc;
+    os_sr_t sr;
+    int i;
+
+    if (mp == NULL || blocks == NULL || n < 0) {
+        return OS_INVALID_PARM;
+    }
+    if (n == 0) {
+        return OS_OK;
+    }
+
+    /* Blocks of a pool with a put callback have to be freed one by one. */
+    if ((mp->mp_flags & OS_MEMPOOL_F_EXT) &&
+        ((struct os_mempool_ext *)mp)->mpe_put_cb != NULL) {
+        for (i = 0; i < n; i++) {
+            rc = os_memblock_put(mp, blocks[i]);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+        return OS_OK;
+    }
+
+    /* Link the blocks together outside of the critical section. */
+    for (i = 0; i < n; i++) {
+        if (blocks[i] == NULL) {
+            return OS_INVALID_PARM;
+        }
+#if MYNEWT_VAL(OS_MEMPOOL_CHECK)
+        assert(os_memblock_from(mp, blocks[i]));
+#endif
+        os_mempool_guard_check(mp, blocks[i]);
+        os_mempool_poison(mp, blocks[i]);
+        os_mempool_track_put(mp, blocks[i]);
+        if (i > 0) {
+            SLIST_NEXT((struct os_memblock *)blocks[i - 1], mb_next) =
+                blocks[i];
+        }
+    }
+    first = blocks[0];
+    last = blocks[n - 1];
+
+    OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(OS_MEMPOOL_CHECK)
+    /* Check for duplicate free. */
+    SLIST_FOREACH(block, mp, mb_next) {
+        for (i = 0; i < n; i++) {
+            assert(block != blocks[i]);
+        }
+    }
+#endif
+    SLIST_NEXT(last, mb_next) = SLIST_FIRST(mp);
+    SLIST_FIRST(mp) = first;
+    mp->mp_num_free += n;
+    OS_EXIT_CRITICAL(sr);
+
+    return OS_OK;
+}
+
+void
+os_mempool_mag_init(struct os_mempool_mag *mag, struct os_mempool *mp,
+                    void **slots, uint8_t size)
+{
+    mag->mm_mp = mp;
+    mag->mm_slots = slots;
+    mag->mm_size = size;
+    mag->mm_cnt = 0;
+}
+
+void *
+os_mempool_mag_get(struct os_mempool_mag *mag)
+{
+    void *block;
+    int i;
+
+    if (mag->mm_size == 0) {
+        return os_memblock_get(mag->mm_mp);
+    }
+
+    if (mag->mm_cnt == 0) {
+        /* Refill half of the magazine, so a put doesn't flush right away. */
+        mag->mm_cnt = os_memblock_get_n(mag->mm_mp, mag->mm_slots,
+                                        max(mag->mm_size / 2, 1));
+        if (mag->mm_cnt == 0) {
+            return NULL;
+        }
+        /* Blocks held by the magazine are not in use. */
+        for (i = 0; i < mag->mm_cnt; i++) {
+            os_mempool_track_put(mag->mm_mp, mag->mm_slots[i]);
+        }
+    }
+
+    mag->mm_cnt--;
+    block = mag->mm_slots[mag->mm_cnt];
+    os_mempool_track_get(mag->mm_mp, block, __builtin_return_address(0));
+
+    return block;
+}
+
+os_error_t
+os_mempool_mag_put(struct os_mempool_mag *mag, void *block_addr)
+{
+    os_error_t rc;
+    int keep;
+
+    if (block_addr == NULL) {
+        return OS_INVALID_PARM;
+    }
+
+    if (mag->mm_cnt == mag->mm_size) {
+        if (mag->mm_size == 0) {
+            return os_memblock_put(mag->mm_mp, block_addr);
+        }
+
+        /* Flush the older half of the magazine back to the pool. */
+        keep = mag->mm_size / 2;
+        rc = os_memblock_put_n(mag->mm_mp, mag->mm_slots,
+                               mag->mm_cnt - keep);
+        if (rc != 0) {
+            return rc;
+        }
+        memmove(mag->mm_slots, mag->mm_slots + mag->mm_cnt - keep,
+                keep * sizeof(mag->mm_slots[0]));
+        mag->mm_cnt = keep;
+    }
+
+    os_mempool_track_put(mag->mm_mp, block_addr);
+    mag->mm_slots[mag->mm_cnt] = block_addr;
+    mag->mm_cnt++;
+
+    return OS_OK;
+}
+
+os_error_t
+os_mempool_mag_flush(struct os_mempool_mag *mag)
+{
+    os_error_t rc;
+
+    rc = os_memblock_put_n(mag->mm_mp, mag->mm_slots, mag->mm_cnt);
+    if (rc == 0) {
+        mag->mm_cnt = 0;
+    }
+
+    return rc;
+}
+
 struct os_mempool *
 os_mempool_info_get_next(struct os_mempool *mp, struct os_mempool_info *omi)
 {
@@ -497,5 +937,9 @@ void
 os_mempool_module_init(void)
 {
     STAILQ_INIT(&g_os_mempool_list);
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    os_mempool_track_used = 0;
+    os_mempool_track_num_pools = 0;
+#endif
 }
 
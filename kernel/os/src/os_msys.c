@@ -55,6 +55,17 @@ static struct os_mempool os_msys_2_mempool;
 static struct os_sanity_check os_msys_sc;
 #endif
 
+#if MYNEWT_VAL(MSYS_COMPACT)
+static SLIST_HEAD(, os_msys_compactor) g_msys_compactors =
+    SLIST_HEAD_INITIALIZER(g_msys_compactors);
+
+static void os_msys_compact_ev_cb(struct os_event *ev);
+
+static struct os_event os_msys_compact_ev = {
+    .ev_cb = os_msys_compact_ev_cb,
+};
+#endif
+
 int
 os_msys_register(struct os_mbuf_pool *new_pool)
 {
@@ -113,11 +124,144 @@ os_msys_find_pool(uint16_t dsize)
 }
 
 
+/* Fallback policies for os_msys_alloc(). */
+#define OS_MSYS_FALLBACK_NONE       0
+#define OS_MSYS_FALLBACK_BIGGER     1
+#define OS_MSYS_FALLBACK_ANY        2
+
+/* Finds the biggest pool that has a free block. */
+static struct os_mbuf_pool *
+os_msys_find_free_pool(void)
+{
+    struct os_mbuf_pool *found;
+    struct os_mbuf_pool *pool;
+
+    found = NULL;
+    STAILQ_FOREACH(pool, &g_msys_pool_list, omp_next) {
+        if (pool->omp_pool->mp_num_free > 0) {
+            found = pool;
+        }
+    }
+
+    return found;
+}
+
+static struct os_mbuf *
+os_msys_alloc_from(struct os_mbuf_pool *pool, uint16_t leadingspace,
+                   int user_hdr_len)
+{
+    if (user_hdr_len >= 0) {
+        return os_mbuf_get_pkthdr(pool, user_hdr_len);
+    } else {
+        return os_mbuf_get(pool, leadingspace);
+    }
+}
+
+#if MYNEWT_VAL(MSYS_COMPACT)
+static void
+os_msys_compact_ev_cb(struct os_event *ev)
+{
+    os_msys_compact();
+}
+
+void
+os_msys_compactor_register(struct os_msys_compactor *omc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_INSERT_HEAD(&g_msys_compactors, omc, omc_next);
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+os_msys_compact(void)
+{
+    struct os_msys_compactor *omc;
+    int freed;
+
+    freed = 0;
+    SLIST_FOREACH(omc, &g_msys_compactors, omc_next) {
+        freed += omc->omc_fn(omc->omc_arg);
+    }
+
+    return freed;
+}
+
+/*
+ * Allocations may come from interrupts, so compaction is deferred to the
+ * default event queue.  Posting an event that is already queued is a no-op.
+ */
+static void
+os_msys_compact_check(const struct os_mbuf *m)
+{
+    if (m == NULL ||
+        m->om_omp->omp_pool->mp_num_free <=
+        MYNEWT_VAL(MSYS_COMPACT_LOW_WATER)) {
+
+        if (!SLIST_EMPTY(&g_msys_compactors)) {
+            os_eventq_put(os_eventq_dflt_get(), &os_msys_compact_ev);
+        }
+    }
+}
+#endif
+
+/*
+ * Allocates from `pref`, falling back to other pools as the policy allows:
+ * first to the bigger ones in turn, then to whichever has free blocks.  A
+ * pkthdr mbuf is allocated if user_hdr_len >= 0.
+ */
+static struct os_mbuf *
+os_msys_alloc(struct os_mbuf_pool *pref, int policy, uint16_t leadingspace,
+              int user_hdr_len)
+{
+    struct os_mbuf_pool *pool;
+    struct os_mbuf *m;
+    os_sr_t sr;
+
+    m = os_msys_alloc_from(pref, leadingspace, user_hdr_len);
+    if (m != NULL) {
+#if MYNEWT_VAL(MSYS_COMPACT)
+        os_msys_compact_check(m);
+#endif
+        return m;
+    }
+
+    if (policy != OS_MSYS_FALLBACK_NONE) {
+        pool = STAILQ_NEXT(pref, omp_next);
+        while (m == NULL && pool != NULL) {
+            m = os_msys_alloc_from(pool, leadingspace, user_hdr_len);
+            pool = STAILQ_NEXT(pool, omp_next);
+        }
+    }
+
+    if (m == NULL && policy == OS_MSYS_FALLBACK_ANY) {
+        pool = os_msys_find_free_pool();
+        if (pool != NULL) {
+            m = os_msys_alloc_from(pool, leadingspace, user_hdr_len);
+        }
+    }
+
+    /* Allocations may come from interrupts. */
+    OS_ENTER_CRITICAL(sr);
+    if (m != NULL) {
+        pref->omp_num_fallback++;
+    } else {
+        pref->omp_num_fail++;
+    }
+    OS_EXIT_CRITICAL(sr);
+#if MYNEWT_VAL(MSYS_COMPACT)
+    os_msys_compact_check(m);
+#endif
+
+    return m;
+}
+
 struct os_mbuf *
 os_msys_get(uint16_t dsize, uint16_t leadingspace)
 {
-    struct os_mbuf *m;
     struct os_mbuf_pool *pool;
+    struct os_mbuf *m;
 
     /* If dsize = 0 that means user has no idea how big block size is needed,
     * therefore lets find for him the biggest one
@@ -129,21 +273,25 @@ os_msys_get(uint16_t dsize, uint16_t leadingspace)
     }
 
     if (!pool) {
-        goto err;
+        return (NULL);
     }
 
-    m = os_mbuf_get(pool, leadingspace);
-    return (m);
-err:
-    return (NULL);
+    m = os_msys_alloc(pool, MYNEWT_VAL(MSYS_FALLBACK) ?
+                      OS_MSYS_FALLBACK_BIGGER : OS_MSYS_FALLBACK_NONE,
+                      leadingspace, -1);
+    if (m != NULL) {
+        OS_MEMPOOL_TRACK_CALLER(m->om_omp->omp_pool, m);
+    }
+
+    return m;
 }
 
 struct os_mbuf *
 os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
 {
     uint16_t total_pkthdr_len;
-    struct os_mbuf *m;
     struct os_mbuf_pool *pool;
+    struct os_mbuf *m;
 
     total_pkthdr_len =  user_hdr_len + sizeof(struct os_mbuf_pkthdr);
 
@@ -157,13 +305,80 @@ os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
     }
 
     if (!pool) {
-        goto err;
+        return (NULL);
+    }
+
+    m = os_msys_alloc(pool, MYNEWT_VAL(MSYS_FALLBACK) ?
+                      OS_MSYS_FALLBACK_BIGGER : OS_MSYS_FALLBACK_NONE,
+                      0, user_hdr_len);
+    if (m != NULL) {
+        OS_MEMPOOL_TRACK_CALLER(m->om_omp->omp_pool, m);
     }
 
-    m = os_mbuf_get_pkthdr(pool, user_hdr_len);
-    return (m);
+    return m;
+}
+
+struct os_mbuf *
+os_msys_get_chain(uint16_t len, uint16_t user_hdr_len)
+{
+    struct os_mbuf_pool *pool;
+    struct os_mbuf *head;
+    struct os_mbuf *last;
+    struct os_mbuf *m;
+    uint16_t rem;
+
+    head = NULL;
+    last = NULL;
+    rem = len;
+
+    do {
+        if (head == NULL) {
+            pool = os_msys_find_pool(rem + user_hdr_len +
+                                     sizeof(struct os_mbuf_pkthdr));
+        } else {
+            pool = os_msys_find_pool(rem);
+        }
+        if (pool == NULL) {
+            goto err;
+        }
+
+        /* Make do with smaller blocks if need be. */
+        m = os_msys_alloc(pool, OS_MSYS_FALLBACK_ANY, 0,
+                          head == NULL ? user_hdr_len : -1);
+        if (m == NULL) {
+            goto err;
+        }
+        OS_MEMPOOL_TRACK_CALLER(m->om_omp->omp_pool, m);
+
+        m->om_len = min(rem, OS_MBUF_TRAILINGSPACE(m));
+        rem -= m->om_len;
+
+        if (head == NULL) {
+            head = m;
+        } else {
+            SLIST_NEXT(last, om_next) = m;
+        }
+        last = m;
+    } while (rem > 0);
+
+    OS_MBUF_PKTHDR(head)->omp_len = len;
+    return head;
+
 err:
-    return (NULL);
+    if (head != NULL) {
+        os_mbuf_free_chain(head);
+    }
+    return NULL;
+}
+
+struct os_mbuf_pool *
+os_msys_pool_get_next(struct os_mbuf_pool *prev)
+{
+    if (prev == NULL) {
+        return STAILQ_FIRST(&g_msys_pool_list);
+    }
+
+    return STAILQ_NEXT(prev, omp_next);
 }
 
 int
@@ -194,6 +409,36 @@ os_msys_num_free(void)
     return total;
 }
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+int
+os_msys_num_shared(void)
+{
+    struct os_mbuf_pool *omp;
+    int total;
+
+    total = 0;
+    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
+        total += omp->omp_num_shared;
+    }
+
+    return total;
+}
+
+int
+os_msys_num_clones(void)
+{
+    struct os_mbuf_pool *omp;
+    int total;
+
+    total = 0;
+    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
+        total += omp->omp_num_clones;
+    }
+
+    return total;
+}
+#endif
+
 #if OS_MSYS_SANITY_ENABLED
 
 /**
@@ -18,12 +18,152 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "syscfg/syscfg.h"
 #if !MYNEWT_VAL(OS_SYSVIEW_TRACE_MUTEX)
 #define OS_TRACE_DISABLE_FILE_API
 #endif
 #include "os/mynewt.h"
 
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+static STAILQ_HEAD(, os_mutex) g_os_mutex_list =
+    STAILQ_HEAD_INITIALIZER(g_os_mutex_list);
+#endif
+
+/* Inserts a task into the wait list of a mutex, in priority order. */
+static void
+os_mutex_wait_insert(struct os_mutex *mu, struct os_task *t)
+{
+    struct os_task *entry;
+    struct os_task *last;
+
+    last = NULL;
+    SLIST_FOREACH(entry, &mu->mu_head, t_obj_list) {
+        if (t->t_prio < entry->t_prio) {
+            break;
+        }
+        last = entry;
+    }
+
+    if (last) {
+        SLIST_INSERT_AFTER(last, t, t_obj_list);
+    } else {
+        SLIST_INSERT_HEAD(&mu->mu_head, t, t_obj_list);
+    }
+}
+
+/*
+ * Changes the priority of a task, keeping the run list and, if the task is
+ * blocked on a mutex, that mutex's wait list in order.  Returns the mutex
+ * the task waits on, or NULL.
+ */
+static struct os_mutex *
+os_mutex_set_prio(struct os_task *t, uint8_t prio)
+{
+    struct os_mutex *mu;
+
+    t->t_prio = prio;
+    os_sched_resort(t);
+
+    if (!(t->t_flags & OS_TASK_FLAG_MUTEX_WAIT) || t->t_obj == NULL) {
+        return NULL;
+    }
+
+    mu = t->t_obj;
+    SLIST_REMOVE(&mu->mu_head, t, os_task, t_obj_list);
+    os_mutex_wait_insert(mu, t);
+
+    return mu;
+}
+
+/*
+ * Raises the owner of a mutex to the specified priority.  If the owner is
+ * itself waiting on a mutex, the boost is passed on to that mutex's owner,
+ * and so on down the chain.  The walk stops at the first task already
+ * running at the priority or higher, which also ends it on a deadlock
+ * cycle.  Must be called inside a critical section.
+ */
+static void
+os_mutex_boost(struct os_mutex *mu, uint8_t prio)
+{
+    struct os_task *owner;
+
+    owner = mu->mu_owner;
+    while (owner != NULL && owner->t_prio > prio) {
+        mu = os_mutex_set_prio(owner, prio);
+        if (mu == NULL) {
+            break;
+        }
+        owner = mu->mu_owner;
+    }
+}
+
+/*
+ * Returns the priority a task is entitled to: its own, or that of the
+ * highest priority task waiting on a mutex it holds.
+ */
+static uint8_t
+os_mutex_inherited_prio(const struct os_task *t)
+{
+    struct os_mutex *mu;
+    struct os_task *waiter;
+    uint8_t prio;
+
+    prio = t->t_base_prio;
+    SLIST_FOREACH(mu, &t->t_mutex_list, mu_held_next) {
+        waiter = SLIST_FIRST(&mu->mu_head);
+        if (waiter != NULL && waiter->t_prio < prio) {
+            prio = waiter->t_prio;
+        }
+    }
+
+    return prio;
+}
+
+/*
+ * Undoes boosts that are no longer needed after a task stopped waiting on
+ * a mutex.  The owner drops to the priority it is still entitled to; if it
+ * is itself waiting on a mutex, that mutex's owner is recomputed in turn,
+ * and so on down the chain.  The walk stops at the first task whose
+ * priority doesn't change.  Must be called inside a critical section.
+ */
+static void
+os_mutex_unboost(struct os_mutex *mu)
+{
+    struct os_task *owner;
+    uint8_t prio;
+
+    owner = mu->mu_owner;
+    while (owner != NULL) {
+        prio = os_mutex_inherited_prio(owner);
+        if (owner->t_prio >= prio) {
+            break;
+        }
+        mu = os_mutex_set_prio(owner, prio);
+        if (mu == NULL) {
+            break;
+        }
+        owner = mu->mu_owner;
+    }
+}
+
+/*
+ * Makes the specified task the owner of a free mutex, as if it had pended
+ * on it.  Used by os_amutex when a lock taken through its fast path becomes
+ * contended.  Must be called inside a critical section.
+ */
+void
+os_mutex_assign(struct os_mutex *mu, struct os_task *owner)
+{
+    assert(mu->mu_level == 0);
+
+    mu->mu_owner = owner;
+    mu->mu_prio = owner->t_prio;
+    mu->mu_level = 1;
+    owner->t_lockcnt++;
+    SLIST_INSERT_HEAD(&owner->t_mutex_list, mu, mu_held_next);
+}
+
 os_error_t
 os_mutex_init(struct os_mutex *mu)
 {
@@ -41,6 +181,12 @@ os_mutex_init(struct os_mutex *mu)
     mu->mu_level = 0;
     mu->mu_owner = NULL;
     SLIST_FIRST(&mu->mu_head) = NULL;
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    mu->mu_num_contended = 0;
+    mu->mu_wait_total = 0;
+    mu->mu_wait_max = 0;
+    mu->mu_wait_max_owner = NULL;
+#endif
 
     ret = OS_OK;
 
@@ -57,6 +203,7 @@ os_mutex_release(struct os_mutex *mu)
     struct os_task *current;
     struct os_task *rdy;
     os_error_t ret;
+    uint8_t prio;
 
     os_trace_api_u32(OS_TRACE_ID_MUTEX_RELEASE, (uintptr_t)mu);
 
@@ -91,10 +238,15 @@ os_mutex_release(struct os_mutex *mu)
     /* Decrement nesting level (this effectively sets nesting level to 0) */
     --mu->mu_level;
 
-    /* Restore owner task's priority; resort list if different  */
-    if (current->t_prio != mu->mu_prio) {
-        current->t_prio = mu->mu_prio;
-        os_sched_resort(current);
+    SLIST_REMOVE(&current->t_mutex_list, mu, os_mutex, mu_held_next);
+
+    /*
+     * Drop any boost this mutex brought; keep whatever is still needed by
+     * waiters on other mutexes the task holds.
+     */
+    prio = os_mutex_inherited_prio(current);
+    if (current->t_prio != prio) {
+        os_mutex_set_prio(current, prio);
     }
 
     /* Check if tasks are waiting for the mutex */
@@ -113,6 +265,7 @@ os_mutex_release(struct os_mutex *mu)
     mu->mu_owner = rdy;
     if (rdy) {
         rdy->t_lockcnt++;
+        SLIST_INSERT_HEAD(&rdy->t_mutex_list, mu, mu_held_next);
     }
     --current->t_lockcnt;
 
@@ -142,8 +295,11 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
     os_sr_t sr;
     os_error_t ret;
     struct os_task *current;
-    struct os_task *entry;
-    struct os_task *last;
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    struct os_task *owner;
+    os_time_t start;
+    os_time_t waited;
+#endif
 
     os_trace_api_u32x2(OS_TRACE_ID_MUTEX_PEND, (uintptr_t)mu, (uint32_t)timeout);
 
@@ -168,6 +324,7 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
         mu->mu_prio  = current->t_prio;
         current->t_lockcnt++;
         mu->mu_level = 1;
+        SLIST_INSERT_HEAD(&current->t_mutex_list, mu, mu_held_next);
         OS_EXIT_CRITICAL(sr);
         ret = OS_OK;
         goto done;
@@ -188,29 +345,16 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
         goto done;
     }
 
-    /* Change priority of owner if needed */
-    if (mu->mu_owner->t_prio > current->t_prio) {
-        mu->mu_owner->t_prio = current->t_prio;
-        os_sched_resort(mu->mu_owner);
-    }
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    owner = mu->mu_owner;
+    start = os_time_get();
+#endif
 
-    /* Link current task to tasks waiting for mutex */
-    last = NULL;
-    if (!SLIST_EMPTY(&mu->mu_head)) {
-        /* Insert in priority order */
-        SLIST_FOREACH(entry, &mu->mu_head, t_obj_list) {
-            if (current->t_prio < entry->t_prio) {
-                break;
-            }
-            last = entry;
-        }
-    }
+    /* Change priority of owner, and of whatever it waits on, if needed */
+    os_mutex_boost(mu, current->t_prio);
 
-    if (last) {
-        SLIST_INSERT_AFTER(last, current, t_obj_list);
-    } else {
-        SLIST_INSERT_HEAD(&mu->mu_head, current, t_obj_list);
-    }
+    /* Link current task to tasks waiting for mutex */
+    os_mutex_wait_insert(mu, current);
 
     /* Set mutex pointer in task */
     current->t_obj = mu;
@@ -222,17 +366,82 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
 
     OS_ENTER_CRITICAL(sr);
     current->t_flags &= ~OS_TASK_FLAG_MUTEX_WAIT;
-    OS_EXIT_CRITICAL(sr);
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    waited = os_time_get() - start;
+    mu->mu_num_contended++;
+    mu->mu_wait_total += waited;
+    if (waited >= mu->mu_wait_max) {
+        mu->mu_wait_max = waited;
+        mu->mu_wait_max_owner = owner;
+    }
+#endif
 
     /* If we are owner we did not time out. */
     if (mu->mu_owner == current) {
         ret = OS_OK;
     } else {
+        /* The owner chain may no longer need the priority it got from us. */
+        os_mutex_unboost(mu);
         ret = OS_TIMEOUT;
     }
+    OS_EXIT_CRITICAL(sr);
 
 done:
     os_trace_api_ret_u32(OS_TRACE_ID_MUTEX_PEND, (uint32_t)ret);
     return ret;
 }
 
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+void
+os_mutex_stats_register(struct os_mutex *mu, const char *name)
+{
+    struct os_mutex *cur;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    mu->mu_name = name;
+    STAILQ_FOREACH(cur, &g_os_mutex_list, mu_stats_next) {
+        if (cur == mu) {
+            break;
+        }
+    }
+    if (cur == NULL) {
+        STAILQ_INSERT_TAIL(&g_os_mutex_list, mu, mu_stats_next);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+struct os_mutex *
+os_mutex_info_get_next(const struct os_mutex *prev, struct os_mutex_info *omi)
+{
+    struct os_mutex *cur;
+    struct os_task *owner;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (prev == NULL) {
+        cur = STAILQ_FIRST(&g_os_mutex_list);
+    } else {
+        cur = STAILQ_NEXT(prev, mu_stats_next);
+    }
+
+    if (cur != NULL) {
+        owner = cur->mu_level != 0 ? cur->mu_owner : NULL;
+
+        omi->omi_name = cur->mu_name;
+        omi->omi_owner = owner != NULL ? owner->t_name : NULL;
+        omi->omi_wait_max_owner = cur->mu_wait_max_owner != NULL ?
+                                  cur->mu_wait_max_owner->t_name : NULL;
+        omi->omi_num_contended = cur->mu_num_contended;
+        omi->omi_wait_total = cur->mu_wait_total;
+        omi->omi_wait_max = cur->mu_wait_max;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return cur;
+}
+#endif
@@ -35,10 +35,26 @@ extern struct os_task g_idle_task;
 extern struct os_task_list g_os_run_list;
 extern struct os_task_list g_os_sleep_list;
 extern struct os_task_stailq g_os_task_list;
+#if !MYNEWT_VAL(OS_CALLOUT_WHEEL)
 extern struct os_callout_list g_callout_list;
+#endif
 
 void os_mempool_module_init(void);
+void os_callout_module_init(void);
+#if MYNEWT_VAL(OS_HRTIMER)
+void os_hrtimer_module_init(void);
+#endif
 void os_msys_init(void);
+void os_mutex_assign(struct os_mutex *mu, struct os_task *owner);
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+void os_task_stack_watermark_switch(void);
+#endif
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+void os_sched_trace_wakeup(struct os_task *t);
+void os_sched_trace_switch(struct os_task *prev, struct os_task *next);
+void os_sched_trace_info_get(const struct os_task *t,
+                             struct os_task_info *oti);
+#endif
 
 /**
  * Prints information about a crash to the console.  This functionality is
@@ -18,18 +18,168 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "os_priv.h"
 
-struct os_task_list g_os_run_list = TAILQ_HEAD_INITIALIZER(g_os_run_list);
+struct os_task_list g_os_run_list OS_FAST_DATA =
+    TAILQ_HEAD_INITIALIZER(g_os_run_list);
 struct os_task_list g_os_sleep_list = TAILQ_HEAD_INITIALIZER(g_os_sleep_list);
 
-struct os_task *g_current_task;
+struct os_task *g_current_task OS_FAST_BSS;
 
 extern os_time_t g_os_time;
 os_time_t g_os_last_ctx_sw_time;
 static uint8_t os_sched_lock_count;
 
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+/*
+ * The run list is kept as a single priority-sorted list, split into one
+ * segment per priority level. For every non-empty level we remember the last
+ * task of its segment, and a two-level bitmap records which levels are
+ * populated. This lets insert and remove locate their position in the list
+ * in constant time, without walking it.
+ */
+#define OS_SCHED_PRIO_LEVELS    (256)
+#define OS_SCHED_PRIO_WORDS     (OS_SCHED_PRIO_LEVELS / 32)
+
+/* Last task of every populated priority level in g_os_run_list */
+static struct os_task *os_sched_prio_tail[OS_SCHED_PRIO_LEVELS] OS_FAST_BSS;
+/* Bit (31 - (prio % 32)) of word (prio / 32) is set if level is populated */
+static uint32_t os_sched_prio_map[OS_SCHED_PRIO_WORDS] OS_FAST_BSS;
+/* Bit (31 - n) is set if os_sched_prio_map[n] is non-zero */
+static uint32_t os_sched_prio_summary OS_FAST_BSS;
+
+static inline void
+os_sched_prio_set(uint8_t prio)
+{
+    os_sched_prio_map[prio >> 5] |= 0x80000000UL >> (prio & 0x1f);
+    os_sched_prio_summary |= 0x80000000UL >> (prio >> 5);
+}
+
+static inline void
+os_sched_prio_clear(uint8_t prio)
+{
+    os_sched_prio_map[prio >> 5] &= ~(0x80000000UL >> (prio & 0x1f));
+    if (os_sched_prio_map[prio >> 5] == 0) {
+        os_sched_prio_summary &= ~(0x80000000UL >> (prio >> 5));
+    }
+}
+
+/*
+ * Returns the tail of the closest populated priority level which is more
+ * important (numerically lower) than prio, or NULL if there is none.
+ */
+static struct os_task *
+os_sched_prio_prev_tail(uint8_t prio)
+{
+    uint32_t word;
+    uint32_t mask;
+    int idx;
+
+    idx = prio >> 5;
+
+    /* Levels in the same word which are below prio */
+    mask = ~(0xffffffffUL >> (prio & 0x1f));
+    word = os_sched_prio_map[idx] & mask;
+    if (word == 0) {
+        /* Words containing more important levels */
+        mask = ~(0xffffffffUL >> idx);
+        word = os_sched_prio_summary & mask;
+        if (word == 0) {
+            return NULL;
+        }
+        /* Highest populated word before idx, i.e. the last set bit */
+        idx = 31 - __builtin_ctz(word);
+        word = os_sched_prio_map[idx];
+    }
+
+    /* Least important populated level in that word */
+    return os_sched_prio_tail[(idx << 5) + 31 - __builtin_ctz(word)];
+}
+
+OS_HOT_CODE static void
+os_sched_run_list_insert(struct os_task *t)
+{
+    struct os_task *prev;
+
+    t->t_sched_prio = t->t_prio;
+    prev = os_sched_prio_tail[t->t_sched_prio];
+    if (prev == NULL) {
+        prev = os_sched_prio_prev_tail(t->t_sched_prio);
+        os_sched_prio_set(t->t_sched_prio);
+    }
+    if (prev) {
+        TAILQ_INSERT_AFTER(&g_os_run_list, prev, t, t_os_list);
+    } else {
+        TAILQ_INSERT_HEAD(&g_os_run_list, t, t_os_list);
+    }
+    os_sched_prio_tail[t->t_sched_prio] = t;
+}
+
+OS_HOT_CODE static void
+os_sched_run_list_remove(struct os_task *t)
+{
+    struct os_task *prev;
+    uint8_t prio;
+
+    /*
+     * Use the level the task was queued at; t_prio may already have been
+     * changed by the caller (see os_sched_resort()).
+     */
+    prio = t->t_sched_prio;
+    if (os_sched_prio_tail[prio] == t) {
+        prev = TAILQ_PREV(t, os_task_list, t_os_list);
+        if (prev && prev->t_sched_prio == prio) {
+            os_sched_prio_tail[prio] = prev;
+        } else {
+            os_sched_prio_tail[prio] = NULL;
+            os_sched_prio_clear(prio);
+        }
+    }
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+#else
+OS_HOT_CODE static void
+os_sched_run_list_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
+    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
+        if (t->t_prio < entry->t_prio) {
+            break;
+        }
+    }
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_run_list, t, t_os_list);
+    }
+}
+
+OS_HOT_CODE static void
+os_sched_run_list_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+#endif
+
+/**
+ * os sched run list init
+ *
+ * Empties the run list. Only meant to be used when (re)initializing the OS.
+ */
+void
+os_sched_run_list_init(void)
+{
+    TAILQ_INIT(&g_os_run_list);
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    memset(os_sched_prio_tail, 0, sizeof(os_sched_prio_tail));
+    memset(os_sched_prio_map, 0, sizeof(os_sched_prio_map));
+    os_sched_prio_summary = 0;
+#endif
+}
+
 /**
  * os sched insert
  *
@@ -41,10 +191,9 @@ static uint8_t os_sched_lock_count;
  * @return int  OS_OK: task was inserted into run list
  *              OS_EINVAL: Task was not in ready state.
  */
-os_error_t
+OS_HOT_CODE os_error_t
 os_sched_insert(struct os_task *t)
 {
-    struct os_task *entry;
     os_sr_t sr;
     os_error_t rc;
 
@@ -53,18 +202,8 @@ os_sched_insert(struct os_task *t)
         goto err;
     }
 
-    entry = NULL;
     OS_ENTER_CRITICAL(sr);
-    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
-        if (t->t_prio < entry->t_prio) {
-            break;
-        }
-    }
-    if (entry) {
-        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
-    } else {
-        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
-    }
+    os_sched_run_list_insert(t);
     OS_EXIT_CRITICAL(sr);
 
     return (0);
@@ -72,7 +211,7 @@ err:
     return (rc);
 }
 
-void
+OS_HOT_CODE void
 os_sched_ctx_sw_hook(struct os_task *next_t)
 {
     uint32_t ticks;
@@ -85,8 +224,18 @@ os_sched_ctx_sw_hook(struct os_task *next_t)
     for (i = 0; i < MYNEWT_VAL(OS_CTX_SW_STACK_GUARD); i++) {
         assert(stack[i] == OS_STACK_PATTERN);
     }
+#endif
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+    os_task_stack_watermark_switch();
 #endif
     next_t->t_ctx_sw_cnt++;
+#if MYNEWT_VAL(OS_TRACE_RING)
+    /* SystemView records this from the context switch handler instead. */
+    os_trace_task_start_exec(next_t);
+#endif
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    os_sched_trace_switch(g_current_task, next_t);
+#endif
 #if MYNEWT_VAL(OS_TASK_RUN_TIME_CPUTIME)
     ticks = os_cputime_get32();
 #else
@@ -96,7 +245,7 @@ os_sched_ctx_sw_hook(struct os_task *next_t)
     g_os_last_ctx_sw_time = ticks;
 }
 
-struct os_task *
+OS_HOT_CODE struct os_task *
 os_sched_get_current_task(void)
 {
     return (g_current_task);
@@ -111,13 +260,13 @@ os_sched_get_current_task(void)
  *
  * @param t Pointer to currently running task.
  */
-void
+OS_HOT_CODE void
 os_sched_set_current_task(struct os_task *t)
 {
     g_current_task = t;
 }
 
-void
+OS_HOT_CODE void
 os_sched(struct os_task *next_t)
 {
     os_sr_t sr;
@@ -175,7 +324,7 @@ os_sched_resume(void)
  * NOTE: must be called with interrupts disabled! This function does not call
  * the scheduler
  */
-int
+OS_HOT_CODE int
 os_sched_sleep(struct os_task *t, os_time_t nticks)
 {
     struct os_task *entry;
@@ -185,7 +334,7 @@ os_sched_sleep(struct os_task *t, os_time_t nticks)
     }
     entry = NULL;
 
-    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+    os_sched_run_list_remove(t);
     t->t_state = OS_TASK_SLEEP;
     t->t_next_wakeup = os_time_get() + nticks;
     if (nticks == OS_TIMEOUT_NEVER) {
@@ -229,7 +378,7 @@ os_sched_remove(struct os_task *t)
     if (t->t_state == OS_TASK_SLEEP) {
         TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
     } else if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_list_remove(t);
     }
     t->t_next_wakeup = 0;
     t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
@@ -252,7 +401,7 @@ os_sched_remove(struct os_task *t)
  *
  * NOTE: This function must be called with interrupts disabled.
  */
-int
+OS_HOT_CODE int
 os_sched_wakeup(struct os_task *t)
 {
     struct os_task_obj *os_obj;
@@ -274,6 +423,9 @@ os_sched_wakeup(struct os_task *t)
     t->t_flags &= ~OS_TASK_FLAG_NO_TIMEOUT;
     TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
     os_sched_insert(t);
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    os_sched_trace_wakeup(t);
+#endif
 
     os_trace_task_start_ready(t);
 
@@ -326,7 +478,7 @@ os_sched_os_timer_exp(void)
  * Return the number of ticks until the first sleep timer expires.If there are
  * no such tasks then return OS_TIMEOUT_NEVER instead.
  */
-os_time_t
+OS_HOT_CODE os_time_t
 os_sched_wakeup_ticks(os_time_t now)
 {
     os_time_t rt;
@@ -356,7 +508,7 @@ os_sched_wakeup_ticks(os_time_t now)
  *
  * @return struct os_task*
  */
-struct os_task *
+OS_HOT_CODE struct os_task *
 os_sched_next_task(void)
 {
     return (TAILQ_FIRST(&g_os_run_list));
@@ -379,7 +531,7 @@ void
 os_sched_resort(struct os_task *t)
 {
     if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_list_remove(t);
         os_sched_insert(t);
     }
 }
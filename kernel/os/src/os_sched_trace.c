@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "os_priv.h"
+
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+
+#define OS_SCHED_TRACE_WINDOWS  MYNEWT_VAL(OS_SCHED_TRACE_WINDOWS)
+
+/* Counters; kernel/os can't depend on sys/stats */
+static struct os_sched_trace_info os_sched_trace_cnt;
+
+/* Start of the current load window, in cputime */
+static uint32_t os_sched_trace_win_start;
+/* Slot in ott_load[] the current window is stored to when it ends */
+static uint8_t os_sched_trace_win_idx;
+/* Number of completed windows, up to OS_SCHED_TRACE_WINDOWS */
+static uint8_t os_sched_trace_win_cnt;
+
+void
+os_sched_trace_wakeup(struct os_task *t)
+{
+    OS_ASSERT_CRITICAL();
+
+    t->t_trace.ott_ready_time = os_cputime_get32();
+    t->t_trace.ott_ready = 1;
+    os_sched_trace_cnt.osti_wakeups++;
+}
+
+/* Sorts a wakeup-to-dispatch latency into the histogram. */
+static void
+os_sched_trace_latency(uint32_t lat)
+{
+    uint32_t usecs;
+
+    usecs = os_cputime_ticks_to_usecs(lat);
+    if (usecs < 10) {
+        os_sched_trace_cnt.osti_lat_lt_10us++;
+    } else if (usecs < 100) {
+        os_sched_trace_cnt.osti_lat_lt_100us++;
+    } else if (usecs < 1000) {
+        os_sched_trace_cnt.osti_lat_lt_1ms++;
+    } else {
+        os_sched_trace_cnt.osti_lat_ge_1ms++;
+    }
+}
+
+/*
+ * Closes the current load window, storing each task's share of it, once it
+ * has lasted a second. Windows are only closed on context switches, so a
+ * window may be longer when a single task runs for a long time.
+ */
+static void
+os_sched_trace_roll(uint32_t now)
+{
+    struct os_task *t;
+    uint32_t win;
+
+    win = now - os_sched_trace_win_start;
+    if (win < os_cputime_usecs_to_ticks(1000000)) {
+        return;
+    }
+
+    STAILQ_FOREACH(t, &g_os_task_list, t_os_task_list) {
+        t->t_trace.ott_load[os_sched_trace_win_idx] =
+            min((uint64_t)t->t_trace.ott_win_run * 100 / win, 100);
+        t->t_trace.ott_win_run = 0;
+    }
+
+    os_sched_trace_win_start = now;
+    os_sched_trace_win_idx = (os_sched_trace_win_idx + 1) %
+                             OS_SCHED_TRACE_WINDOWS;
+    if (os_sched_trace_win_cnt < OS_SCHED_TRACE_WINDOWS) {
+        os_sched_trace_win_cnt++;
+    }
+}
+
+void
+os_sched_trace_switch(struct os_task *prev, struct os_task *next)
+{
+    struct os_task_trace *ott;
+    uint32_t now;
+    uint32_t run;
+    uint32_t lat;
+
+    now = os_cputime_get32();
+
+    ott = &prev->t_trace;
+    run = now - ott->ott_run_start;
+    ott->ott_win_run += run;
+    if (run > ott->ott_burst_max) {
+        ott->ott_burst_max = run;
+    }
+
+    ott = &next->t_trace;
+    if (ott->ott_ready) {
+        lat = now - ott->ott_ready_time;
+        ott->ott_ready = 0;
+        ott->ott_lat_total += lat;
+        ott->ott_lat_cnt++;
+        if (lat > ott->ott_lat_max) {
+            ott->ott_lat_max = lat;
+        }
+        os_sched_trace_latency(lat);
+    }
+    ott->ott_run_start = now;
+
+    os_sched_trace_roll(now);
+}
+
+void
+os_sched_trace_info_get(const struct os_task *t, struct os_task_info *oti)
+{
+    const struct os_task_trace *ott;
+    uint32_t load;
+    os_sr_t sr;
+    int i;
+
+    ott = &t->t_trace;
+
+    OS_ENTER_CRITICAL(sr);
+
+    oti->oti_lat_max = os_cputime_ticks_to_usecs(ott->ott_lat_max);
+    if (ott->ott_lat_cnt != 0) {
+        oti->oti_lat_avg =
+            os_cputime_ticks_to_usecs(ott->ott_lat_total / ott->ott_lat_cnt);
+    } else {
+        oti->oti_lat_avg = 0;
+    }
+    oti->oti_burst_max = os_cputime_ticks_to_usecs(ott->ott_burst_max);
+
+    load = 0;
+    for (i = 0; i < os_sched_trace_win_cnt; i++) {
+        load += ott->ott_load[i];
+    }
+    oti->oti_load = os_sched_trace_win_cnt ? load / os_sched_trace_win_cnt : 0;
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_sched_trace_get(struct os_sched_trace_info *osti)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *osti = os_sched_trace_cnt;
+    OS_EXIT_CRITICAL(sr);
+}
+
+#endif
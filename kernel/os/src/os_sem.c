@@ -24,6 +24,68 @@
 #endif
 #include "os/mynewt.h"
 
+#if MYNEWT_VAL(OS_SEM_FAST_PATH) && \
+    defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+#define OS_SEM_FAST 1
+#else
+#define OS_SEM_FAST 0
+#endif
+
+#if OS_SEM_FAST
+/*
+ * Fast path.  A token is taken or added with one compare-and-swap of
+ * sem_state.  The slow path changes sem_waiting and sem_tokens with plain
+ * stores inside a critical section; an exclusive access pending when it
+ * interrupts is cleared with the exception, so the swap fails and retries.
+ *
+ * Tasks only wait while there are no tokens, so a token can always be taken
+ * if there is one.  A token can only be added if sem_waiting is clear;
+ * otherwise the slow path hands it to the first waiter instead.
+ */
+static inline bool
+os_sem_state_cas(struct os_sem *sem, uint32_t old, uint32_t new)
+{
+    return __atomic_compare_exchange_n(&sem->sem_state, &old, new, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+static bool
+os_sem_take_fast(struct os_sem *sem)
+{
+    struct os_sem cur;
+    uint32_t old;
+
+    do {
+        cur.sem_state = __atomic_load_n(&sem->sem_state, __ATOMIC_RELAXED);
+        if (cur.sem_tokens == 0) {
+            return false;
+        }
+        old = cur.sem_state;
+        cur.sem_tokens--;
+    } while (!os_sem_state_cas(sem, old, cur.sem_state));
+
+    return true;
+}
+
+static bool
+os_sem_give_fast(struct os_sem *sem)
+{
+    struct os_sem cur;
+    uint32_t old;
+
+    do {
+        cur.sem_state = __atomic_load_n(&sem->sem_state, __ATOMIC_RELAXED);
+        if (cur.sem_waiting) {
+            return false;
+        }
+        old = cur.sem_state;
+        cur.sem_tokens++;
+    } while (!os_sem_state_cas(sem, old, cur.sem_state));
+
+    return true;
+}
+#endif
+
 /* XXX:
  * 1) Should I check to see if we are within an ISR for some of these?
  * 2) Would I do anything different for os_sem_release() if we were in an
@@ -42,6 +104,7 @@ os_sem_init(struct os_sem *sem, uint16_t tokens)
         goto done;
     }
 
+    sem->sem_waiting = 0;
     sem->sem_tokens = tokens;
     SLIST_FIRST(&sem->sem_head) = NULL;
 
@@ -75,6 +138,13 @@ os_sem_release(struct os_sem *sem)
         goto done;
     }
 
+#if OS_SEM_FAST
+    if (os_sem_give_fast(sem)) {
+        ret = OS_OK;
+        goto done;
+    }
+#endif
+
     /* Get current task */
     resched = 0;
     current = os_sched_get_current_task();
@@ -105,6 +175,11 @@ os_sem_release(struct os_sem *sem)
         sem->sem_tokens++;
     }
 
+#if OS_SEM_FAST
+    /* Waiters which timed out leave the flag set; catch up here. */
+    sem->sem_waiting = !SLIST_EMPTY(&sem->sem_head);
+#endif
+
     OS_EXIT_CRITICAL(sr);
 
     /* Re-schedule if needed */
@@ -143,6 +218,13 @@ os_sem_pend(struct os_sem *sem, os_time_t timeout)
         goto done;
     }
 
+#if OS_SEM_FAST
+    if (os_sem_take_fast(sem)) {
+        ret = OS_OK;
+        goto done;
+    }
+#endif
+
     /* Assume we dont have to put task to sleep; get current task */
     sched = 0;
     current = os_sched_get_current_task();
@@ -181,6 +263,9 @@ os_sem_pend(struct os_sem *sem, os_time_t timeout)
         } else {
             SLIST_INSERT_HEAD(&sem->sem_head, current, t_obj_list);
         }
+#if OS_SEM_FAST
+        sem->sem_waiting = 1;
+#endif
 
         /* We will put this task to sleep */
         sched = 1;
@@ -56,6 +56,49 @@ os_task_count(void)
     return (g_task_id);
 }
 
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+/* Task switched away from last, whose watermark is yet to be updated */
+static struct os_task *os_task_stack_watermark_prev;
+
+/*
+ * Updates the stack watermark of 't' a little at a time. The saved stack
+ * pointer gives a lower bound on the peak for free. Below the watermark, a
+ * window of OS_STACK_WATERMARK_WINDOW words is checked for the stack
+ * pattern on each call; successive calls sweep the window down to the
+ * bottom of the stack and then start over, so deeper use is found within
+ * stack size / window calls.
+ */
+static void
+os_task_stack_watermark_update(struct os_task *t)
+{
+    os_stack_t *bottom;
+    uint16_t sp;
+    uint16_t hi;
+    uint16_t lo;
+    uint16_t i;
+
+    bottom = t->t_stackbottom;
+
+    sp = (os_stack_t *)t->t_stackptr - bottom;
+    if (sp < t->t_stack_hwm) {
+        t->t_stack_hwm = sp;
+    }
+
+    hi = min(t->t_stack_probe, t->t_stack_hwm);
+    lo = hi > MYNEWT_VAL(OS_STACK_WATERMARK_WINDOW) ?
+         hi - MYNEWT_VAL(OS_STACK_WATERMARK_WINDOW) : 0;
+
+    for (i = lo; i < hi; i++) {
+        if (bottom[i] != OS_STACK_PATTERN) {
+            t->t_stack_hwm = i;
+            break;
+        }
+    }
+
+    t->t_stack_probe = lo > 0 ? lo : t->t_stack_hwm;
+}
+#endif
+
 int
 os_task_init(struct os_task *t, const char *name, os_task_func_t func,
         void *arg, uint8_t prio, os_time_t sanity_itvl,
@@ -72,6 +115,7 @@ os_task_init(struct os_task *t, const char *name, os_task_func_t func,
 
     t->t_taskid = os_task_next_id();
     t->t_prio = prio;
+    t->t_base_prio = prio;
 
     t->t_state = OS_TASK_READY;
     t->t_name = name;
@@ -97,6 +141,11 @@ os_task_init(struct os_task *t, const char *name, os_task_func_t func,
     t->t_stacksize = stack_size;
     t->t_stackptr = os_arch_task_stack_init(t, os_task_stacktop_get(t),
                                             t->t_stacksize);
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+    t->t_stack_hwm = stack_size;
+    t->t_stack_probe = stack_size;
+    os_task_stack_watermark_update(t);
+#endif
 
     STAILQ_FOREACH(task, &g_os_task_list, t_os_task_list) {
         assert(t->t_prio != task->t_prio);
@@ -169,11 +218,38 @@ os_task_remove(struct os_task *t)
     }
 
     OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+    if (os_task_stack_watermark_prev == t) {
+        os_task_stack_watermark_prev = NULL;
+    }
+#endif
     rc = os_sched_remove(t);
     OS_EXIT_CRITICAL(sr);
     return rc;
 }
 
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+/*
+ * Called on every context switch, before the port saves the context of the
+ * outgoing task, so its t_stackptr is stale.  The task is sampled on the
+ * following switch instead, by which time its context has been saved.  If
+ * that switch comes while the first is still pending, the task is still
+ * current and is skipped.
+ */
+void
+os_task_stack_watermark_switch(void)
+{
+    struct os_task *cur;
+
+    cur = os_sched_get_current_task();
+    if (os_task_stack_watermark_prev != NULL &&
+        os_task_stack_watermark_prev != cur) {
+        os_task_stack_watermark_update(os_task_stack_watermark_prev);
+    }
+    os_task_stack_watermark_prev = cur;
+}
+#endif
+
 void
 os_task_info_get(const struct os_task *task, struct os_task_info *oti)
 {
@@ -186,16 +262,26 @@ os_task_info_get(const struct os_task *task, struct os_task_info *oti)
 
     bottom = task->t_stackbottom;
     top = bottom + task->t_stacksize;
+#if MYNEWT_VAL(OS_STACK_WATERMARK)
+    bottom += task->t_stack_hwm;
+#else
     while (bottom < top) {
         if (*bottom != OS_STACK_PATTERN) {
             break;
         }
         ++bottom;
     }
+#endif
 
     oti->oti_stkusage = (uint16_t) (top - bottom);
     oti->oti_stksize = task->t_stacksize;
     oti->oti_cswcnt = task->t_ctx_sw_cnt;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    oti->oti_heap_bytes = task->t_heap_bytes;
+#endif
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    os_sched_trace_info_get(task, oti);
+#endif
     oti->oti_runtime = task->t_run_time;
     oti->oti_last_checkin = task->t_sanity_check.sc_checkin_last;
     oti->oti_next_checkin = task->t_sanity_check.sc_checkin_last +
@@ -24,7 +24,7 @@ CTASSERT(sizeof(os_time_t) == 4);
 
 #define OS_USEC_PER_TICK    (1000000 / OS_TICKS_PER_SEC)
 
-os_time_t g_os_time;
+os_time_t g_os_time OS_FAST_BSS;
 
 static STAILQ_HEAD(, os_time_change_listener) os_time_change_listeners =
     STAILQ_HEAD_INITIALIZER(os_time_change_listeners);
@@ -82,7 +82,7 @@ os_time_tick(int ticks)
     OS_EXIT_CRITICAL(sr);
 }
 
-void
+OS_HOT_CODE void
 os_time_advance(int ticks)
 {
     assert(ticks >= 0);
@@ -91,6 +91,9 @@ os_time_advance(int ticks)
         if (!os_started()) {
             g_os_time += ticks;
         } else {
+#if MYNEWT_VAL(OS_TICK_HOOK)
+            os_tick_hook();
+#endif
             os_time_tick(ticks);
             os_callout_tick();
             os_sched_os_timer_exp();
@@ -114,7 +117,7 @@ os_time_delay(os_time_t osticks)
 
 #else
 
-void
+OS_HOT_CODE void
 os_time_advance(int ticks)
 {
     g_os_time += ticks;
@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OS_TRACE_RING)
+
+#include "os/os_trace_ring.h"
+
+#define OS_TRACE_RING_CNT   MYNEWT_VAL(OS_TRACE_RING_SIZE)
+#define OS_TRACE_RING_MASK  (OS_TRACE_RING_CNT - 1)
+
+#if (OS_TRACE_RING_CNT & OS_TRACE_RING_MASK) != 0 || \
+    OS_TRACE_RING_CNT > UINT16_MAX
+#error "OS_TRACE_RING_SIZE must be a power of two, at most 32768"
+#endif
+
+struct os_trace_ring g_os_trace_ring = {
+    .otr_magic = OS_TRACE_RING_MAGIC,
+    .otr_rec_size = sizeof(struct os_trace_ring_rec),
+    .otr_rec_cnt = OS_TRACE_RING_CNT,
+    .otr_ts_freq = MYNEWT_VAL(OS_CPUTIME_FREQ),
+};
+
+/* Reserves the next slot in the ring, returning its sequence number. */
+static inline uint32_t
+os_trace_ring_reserve(void)
+{
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+    return __atomic_fetch_add(&g_os_trace_ring.otr_head, 1, __ATOMIC_RELAXED);
+#else
+    uint32_t seq;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    seq = g_os_trace_ring.otr_head++;
+    OS_EXIT_CRITICAL(sr);
+
+    return seq;
+#endif
+}
+
+void
+os_trace_ring_rec(uint16_t id, uint8_t flags, uint32_t arg)
+{
+    struct os_trace_ring_rec *rec;
+    struct os_task *t;
+
+    if (g_os_trace_ring.otr_frozen) {
+        return;
+    }
+
+    rec = &g_os_trace_ring.otr_recs[os_trace_ring_reserve() &
+                                    OS_TRACE_RING_MASK];
+
+    t = os_sched_get_current_task();
+
+    rec->otrr_ts = os_cputime_get32();
+    rec->otrr_id = id;
+    rec->otrr_flags = flags;
+    rec->otrr_taskid = t ? t->t_taskid : OS_TRACE_RING_NO_TASK;
+    rec->otrr_arg = arg;
+}
+
+int
+os_trace_ring_read(uint32_t seq, struct os_trace_ring_rec *recs, int max,
+                   uint32_t *out_seq)
+{
+    uint32_t head;
+    os_sr_t sr;
+    int cnt;
+
+    OS_ENTER_CRITICAL(sr);
+
+    head = g_os_trace_ring.otr_head;
+    if (head - seq > OS_TRACE_RING_CNT) {
+        /* Overwritten, or from the future; start from the oldest. */
+        seq = head > OS_TRACE_RING_CNT ? head - OS_TRACE_RING_CNT : 0;
+    }
+
+    for (cnt = 0; cnt < max && seq + cnt != head; cnt++) {
+        recs[cnt] = g_os_trace_ring.otr_recs[(seq + cnt) & OS_TRACE_RING_MASK];
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    if (out_seq != NULL) {
+        *out_seq = seq;
+    }
+    return cnt;
+}
+
+#endif
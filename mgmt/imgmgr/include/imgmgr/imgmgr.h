@@ -33,6 +33,11 @@ extern "C" {
 #define IMGMGR_NMGR_ID_CORELOAD     4
 #define IMGMGR_NMGR_ID_ERASE	    5
 #define IMGMGR_NMGR_ID_ERASE_STATE  6
+#define IMGMGR_NMGR_ID_UPLOAD_Z     7
+
+/* Encoding of an IMGMGR_NMGR_ID_UPLOAD_Z stream ("fmt"). */
+#define IMGMGR_UZ_FMT_LZ4           0x01    /* LZ4 compressed blocks */
+#define IMGMGR_UZ_FMT_DELTA         0x02    /* Patch against running image */
 
 #define IMGMGR_NMGR_MAX_NAME		64
 #define IMGMGR_NMGR_MAX_VER         25  /* 255.255.65535.4294967295\0 */
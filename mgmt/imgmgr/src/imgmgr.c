@@ -32,8 +32,8 @@
 #include "img_mgmt/img_mgmt.h"
 #include "imgmgr_priv.h"
 
-static imgr_upload_fn *imgr_upload_cb;
-static void *imgr_upload_arg;
+imgr_upload_fn *imgr_upload_cb;
+void *imgr_upload_arg;
 
 void
 imgr_set_upload_cb(imgr_upload_fn *cb, void *arg)
@@ -108,6 +108,15 @@ static const struct mgmt_handler imgr_mgmt_handlers[] = {
         .mh_read = NULL,
         .mh_write = imgr_erase_state,
     },
+    [IMGMGR_NMGR_ID_UPLOAD_Z] = {
+#if MYNEWT_VAL(IMGMGR_UPLOAD_Z)
+        .mh_read = NULL,
+        .mh_write = imgr_upload_z,
+#else
+        .mh_read = NULL,
+        .mh_write = NULL
+#endif
+    },
 };
 
 #define IMGR_HANDLER_CNT                                                \
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+
+#include "flash_map/flash_map.h"
+#include "mynewt_smp/smp.h"
+
+#include "imgmgr_priv.h"
+
+/*
+ * Background erase of the upload slot.
+ *
+ * Sectors are erased one per event on the mgmt event queue, so the erase
+ * runs between upload requests rather than inside them, and never gets more
+ * than IMGMGR_PREERASE_AHEAD bytes ahead of the write pointer.  Since
+ * everything runs on the queue that also processes the upload, erases and
+ * writes never overlap.
+ */
+
+struct imgr_preerase {
+    const struct flash_area *ip_fa;
+    uint32_t ip_end;                    /* Never erase beyond this. */
+    uint32_t ip_erased;                 /* Erased up to this offset. */
+    uint32_t ip_wr_off;                 /* Written up to this offset. */
+    int ip_sec_id;
+    uint8_t ip_active;
+};
+
+static struct imgr_preerase imgr_pe;
+
+static void imgr_preerase_ev_cb(struct os_event *ev);
+
+static struct os_event imgr_preerase_ev = {
+    .ev_cb = imgr_preerase_ev_cb,
+};
+
+static int
+imgr_preerase_sector(void)
+{
+    struct flash_area sector;
+    int rc;
+
+    do {
+        rc = flash_area_getnext_sector(imgr_pe.ip_fa->fa_id,
+                                       &imgr_pe.ip_sec_id, &sector);
+        if (rc) {
+            return rc;
+        }
+    } while (sector.fa_off + sector.fa_size <=
+             imgr_pe.ip_fa->fa_off + imgr_pe.ip_erased);
+
+    rc = flash_area_erase(imgr_pe.ip_fa,
+                          sector.fa_off - imgr_pe.ip_fa->fa_off,
+                          sector.fa_size);
+    if (rc) {
+        return rc;
+    }
+    imgr_pe.ip_erased = sector.fa_off + sector.fa_size -
+                        imgr_pe.ip_fa->fa_off;
+    return 0;
+}
+
+static uint32_t
+imgr_preerase_target(void)
+{
+    uint32_t target;
+
+    target = imgr_pe.ip_wr_off + MYNEWT_VAL(IMGMGR_PREERASE_AHEAD);
+    if (target > imgr_pe.ip_end) {
+        target = imgr_pe.ip_end;
+    }
+    return target;
+}
+
+static void
+imgr_preerase_kick(void)
+{
+    if (imgr_pe.ip_active && imgr_pe.ip_erased < imgr_preerase_target()) {
+        os_eventq_put(mgmt_evq_get(), &imgr_preerase_ev);
+    }
+}
+
+static void
+imgr_preerase_ev_cb(struct os_event *ev)
+{
+    if (!imgr_pe.ip_active || imgr_pe.ip_erased >= imgr_preerase_target()) {
+        return;
+    }
+    if (imgr_preerase_sector()) {
+        /* Leave it to imgr_preerase_wait() to report the failure. */
+        imgr_pe.ip_active = 0;
+        return;
+    }
+    /* One sector at a time; let queued requests run in between. */
+    imgr_preerase_kick();
+}
+
+void
+imgr_preerase_start(const struct flash_area *fa, uint32_t len)
+{
+    os_eventq_remove(mgmt_evq_get(), &imgr_preerase_ev);
+
+    imgr_pe.ip_fa = fa;
+    imgr_pe.ip_end = len;
+    imgr_pe.ip_erased = 0;
+    imgr_pe.ip_wr_off = 0;
+    imgr_pe.ip_sec_id = -1;
+    imgr_pe.ip_active = 1;
+    imgr_preerase_kick();
+}
+
+int
+imgr_preerase_wait(uint32_t end)
+{
+    int rc;
+
+    /* Catch up synchronously if the writer overtook the eraser. */
+    while (imgr_pe.ip_erased < end) {
+        rc = imgr_preerase_sector();
+        if (rc) {
+            return rc;
+        }
+    }
+    if (end > imgr_pe.ip_wr_off) {
+        imgr_pe.ip_wr_off = end;
+    }
+    imgr_pe.ip_active = 1;
+    imgr_preerase_kick();
+    return 0;
+}
+
+void
+imgr_preerase_stop(void)
+{
+    imgr_pe.ip_active = 0;
+    os_eventq_remove(mgmt_evq_get(), &imgr_preerase_ev);
+}
+
+#endif
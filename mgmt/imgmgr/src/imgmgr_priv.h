@@ -23,6 +23,12 @@
 #include <stdint.h>
 #include "os/mynewt.h"
 #include "mgmt/mgmt.h"
+#include "imgmgr/imgmgr.h"
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY_HW)
+#include "hash/hash.h"
+#elif MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+#include "tinycrypt/sha256.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -78,13 +84,75 @@ struct imgmgr_upload_cmd {
  *      "len":<file_size>		inspected when off = 0
  *      "data":<base64encoded binary>
  * }
+ *
+ *
+ * Request to compressed / delta image upload:
+ * {
+ *      "off":<offset>,
+ *      "len":<stream_size>		inspected when off = 0
+ *      "ilen":<img_size>		inspected when off = 0
+ *      "fmt":<IMGMGR_UZ_FMT_*>		inspected when off = 0
+ *      "sha":<sha256 of image>		inspected when off = 0
+ *      "bsha":<hash of base image>	optional, when off = 0
+ *      "data":<binary>
+ * }
+ *
+ * Response contains the offset of the stream to send next.
  */
 
 struct mgmt_cbuf;
 
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+/*
+ * Incremental check of an image against its SHA-256 TLV, fed with the
+ * image bytes in order while they are written.
+ */
+struct imgr_hash {
+    uint32_t ih_off;                    /* Image bytes seen. */
+    uint32_t ih_hash_end;               /* End of the hashed region. */
+    uint32_t ih_tlv_off;                /* Offset into the TLV area. */
+    uint32_t ih_tlv_end;                /* Size of the TLV area. */
+    uint16_t ih_tlv_val_left;
+    uint8_t ih_tlv_val_have;
+    uint8_t ih_tlv_type;
+    uint8_t ih_tlv_hdr_have;
+    uint8_t ih_have_tlv_hash;
+    uint8_t ih_tlv_hdr[4];
+    uint8_t ih_hdr[32];                 /* struct image_header */
+    uint8_t ih_tlv_hash[IMGMGR_HASH_LEN];
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY_HW)
+    struct hash_dev *ih_dev;
+    struct hash_sha256_context ih_sha;
+#else
+    struct tc_sha256_state_struct ih_sha;
+#endif
+};
+
+int imgr_hash_start(struct imgr_hash *ih);
+int imgr_hash_update(struct imgr_hash *ih, const uint8_t *data, uint32_t len);
+int imgr_hash_finish(struct imgr_hash *ih);
+#endif
+
+extern imgr_upload_fn *imgr_upload_cb;
+extern void *imgr_upload_arg;
+
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+struct flash_area;
+
+/*
+ * Starts erasing [0, len) of fa in the background, ahead of the writes.
+ * Before programming flash below offset end, imgr_preerase_wait(end) must
+ * be called; it finishes any erase still needed there.
+ */
+void imgr_preerase_start(const struct flash_area *fa, uint32_t len);
+int imgr_preerase_wait(uint32_t end);
+void imgr_preerase_stop(void);
+#endif
+
 int imgr_core_list(struct mgmt_ctxt *);
 int imgr_core_load(struct mgmt_ctxt *);
 int imgr_core_erase(struct mgmt_ctxt *);
+int imgr_upload_z(struct mgmt_ctxt *);
 int imgr_find_by_ver(struct image_version *find, uint8_t *hash);
 int imgr_find_by_hash(uint8_t *find, struct image_version *ver);
 int imgr_cli_register(void);
@@ -0,0 +1,669 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_Z)
+
+#include <limits.h>
+#include <string.h>
+
+#include "flash_map/flash_map.h"
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+#include "bootutil/image.h"
+#include "img_mgmt/img_mgmt.h"
+#include "lz4/lz4.h"
+#include "tinycrypt/sha256.h"
+
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+/*
+ * Compressed / delta image upload.
+ *
+ * The uploaded stream is decoded in up to two stages before it reaches
+ * flash.  With IMGMGR_UZ_FMT_LZ4 the stream is a sequence of blocks, each
+ * preceded by a 16 bit little-endian length.  If bit 15 of the length is
+ * set, the block is stored as-is; otherwise it is a raw LZ4 block.  A block
+ * decodes to at most IMGMGR_UPLOAD_Z_BLOCK_SIZE bytes.
+ *
+ * With IMGMGR_UZ_FMT_DELTA the (decompressed) stream is a list of patch
+ * operations against the running image, little-endian:
+ *     COPY  0x00 <u32 src_off> <u32 len>         copy len bytes of source
+ *     ADD   0x01 <u32 src_off> <u32 len> <len>   source + diff, bytewise
+ *     DATA  0x02 <u32 len> <len>                 literal bytes
+ * Otherwise the decoded stream is the image itself.
+ *
+ * The result is written to the upload slot as it is produced, and the
+ * SHA-256 of the whole image must match the one given in the first request.
+ */
+
+#define IMGR_UZ_OP_COPY         0x00
+#define IMGR_UZ_OP_ADD          0x01
+#define IMGR_UZ_OP_DATA         0x02
+#define IMGR_UZ_OP_NONE         0xff
+
+#define IMGR_UZ_BLK_RAW         0x8000
+
+#define IMGR_UZ_BLK_SZ          MYNEWT_VAL(IMGMGR_UPLOAD_Z_BLOCK_SIZE)
+#define IMGR_UZ_BLK_MAX         (IMGR_UZ_BLK_SZ + IMGR_UZ_BLK_SZ / 255 + 16)
+#define IMGR_UZ_WBUF_SZ         128
+
+struct imgr_uz_state {
+    const struct flash_area *iu_fa;     /* Destination slot. */
+    const struct flash_area *iu_src;    /* Base image for deltas. */
+    uint32_t iu_in_off;                 /* Upload stream bytes consumed. */
+    uint32_t iu_in_len;                 /* Upload stream length. */
+    uint32_t iu_out_off;                /* Image bytes produced. */
+    uint32_t iu_out_len;                /* Image length. */
+    uint32_t iu_erased;                 /* Erased up to this offset. */
+    int iu_sec_id;
+    uint8_t iu_fmt;
+    uint8_t iu_active;
+    uint8_t iu_hash[IMGMGR_HASH_LEN];
+    struct tc_sha256_state_struct iu_sha;
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+    struct imgr_hash iu_verify;         /* Image vs. its own hash TLV. */
+#endif
+
+    /* LZ4 block reassembly. */
+    uint16_t iu_blk_len;
+    uint16_t iu_blk_have;
+    uint8_t iu_blk_hdr_have;
+    uint8_t iu_blk_hdr[2];
+    uint8_t iu_blk[IMGR_UZ_BLK_MAX];
+    uint8_t iu_dec[IMGR_UZ_BLK_SZ];
+
+    /* Delta operation being decoded. */
+    uint8_t iu_op;
+    uint8_t iu_op_have;
+    uint8_t iu_op_hdr[9];
+    uint32_t iu_op_src;
+    uint32_t iu_op_left;
+
+    /* Write staging, keeps flash writes aligned. */
+    uint16_t iu_wbuf_len;
+    uint8_t iu_wbuf[IMGR_UZ_WBUF_SZ];
+};
+
+static struct imgr_uz_state imgr_uz;
+
+static uint32_t
+imgr_uz_get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Makes sure the destination is erased up to (and including) offset end.
+ */
+static int
+imgr_uz_erase_to(uint32_t end)
+{
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+    return imgr_preerase_wait(end);
+#elif MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+    struct flash_area sector;
+    int rc;
+
+    while (imgr_uz.iu_erased < end) {
+        rc = flash_area_getnext_sector(imgr_uz.iu_fa->fa_id,
+                                       &imgr_uz.iu_sec_id, &sector);
+        if (rc) {
+            return rc;
+        }
+        if (sector.fa_off + sector.fa_size <=
+          imgr_uz.iu_fa->fa_off + imgr_uz.iu_erased) {
+            continue;
+        }
+        rc = flash_area_erase(imgr_uz.iu_fa,
+                              sector.fa_off - imgr_uz.iu_fa->fa_off,
+                              sector.fa_size);
+        if (rc) {
+            return rc;
+        }
+        imgr_uz.iu_erased = sector.fa_off + sector.fa_size -
+                            imgr_uz.iu_fa->fa_off;
+    }
+#else
+    (void)end;
+#endif
+    return 0;
+}
+
+static int
+imgr_uz_flush(void)
+{
+    uint32_t off;
+    uint32_t len;
+    uint8_t align;
+    int rc;
+
+    len = imgr_uz.iu_wbuf_len;
+    if (len == 0) {
+        return 0;
+    }
+    off = imgr_uz.iu_out_off - len;
+
+    /* Only the last write of the image can be short; pad it. */
+    align = flash_area_align(imgr_uz.iu_fa);
+    if (len % align) {
+        memset(imgr_uz.iu_wbuf + len, flash_area_erased_val(imgr_uz.iu_fa),
+               align - len % align);
+        len += align - len % align;
+    }
+
+    rc = imgr_uz_erase_to(off + len);
+    if (rc) {
+        return rc;
+    }
+    rc = flash_area_write(imgr_uz.iu_fa, off, imgr_uz.iu_wbuf, len);
+    if (rc) {
+        return rc;
+    }
+    imgr_uz.iu_wbuf_len = 0;
+    return 0;
+}
+
+/*
+ * Final stage: image bytes, hashed and staged for writing.
+ */
+static int
+imgr_uz_out(const uint8_t *data, uint32_t len)
+{
+    uint32_t cnt;
+    int rc;
+
+    if (len > imgr_uz.iu_out_len - imgr_uz.iu_out_off) {
+        return MGMT_ERR_EINVAL;
+    }
+    tc_sha256_update(&imgr_uz.iu_sha, data, len);
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+    rc = imgr_hash_update(&imgr_uz.iu_verify, data, len);
+    if (rc) {
+        return rc;
+    }
+#endif
+
+    while (len) {
+        cnt = IMGR_UZ_WBUF_SZ - imgr_uz.iu_wbuf_len;
+        if (cnt > len) {
+            cnt = len;
+        }
+        memcpy(imgr_uz.iu_wbuf + imgr_uz.iu_wbuf_len, data, cnt);
+        imgr_uz.iu_wbuf_len += cnt;
+        imgr_uz.iu_out_off += cnt;
+        data += cnt;
+        len -= cnt;
+
+        if (imgr_uz.iu_wbuf_len == IMGR_UZ_WBUF_SZ) {
+            rc = imgr_uz_flush();
+            if (rc) {
+                return MGMT_ERR_EUNKNOWN;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Outputs len bytes of the base image starting at src_off.  If diff is
+ * given, it is added to the source bytes.
+ */
+static int
+imgr_uz_src(uint32_t src_off, const uint8_t *diff, uint32_t len)
+{
+    uint8_t buf[32];
+    uint32_t cnt;
+    uint32_t i;
+    int rc;
+
+    if (src_off > imgr_uz.iu_src->fa_size ||
+      len > imgr_uz.iu_src->fa_size - src_off) {
+        return MGMT_ERR_EINVAL;
+    }
+    while (len) {
+        cnt = min(len, sizeof(buf));
+        rc = flash_area_read(imgr_uz.iu_src, src_off, buf, cnt);
+        if (rc) {
+            return MGMT_ERR_EUNKNOWN;
+        }
+        if (diff) {
+            for (i = 0; i < cnt; i++) {
+                buf[i] += diff[i];
+            }
+            diff += cnt;
+        }
+        rc = imgr_uz_out(buf, cnt);
+        if (rc) {
+            return rc;
+        }
+        src_off += cnt;
+        len -= cnt;
+    }
+    return 0;
+}
+
+/*
+ * Second stage: patch operations, or the image itself if the upload is not
+ * a delta.
+ */
+static int
+imgr_uz_delta(const uint8_t *data, uint32_t len)
+{
+    uint32_t need;
+    uint32_t cnt;
+    uint8_t op;
+    int rc;
+
+    if (!(imgr_uz.iu_fmt & IMGMGR_UZ_FMT_DELTA)) {
+        return imgr_uz_out(data, len);
+    }
+
+    while (len) {
+        if (imgr_uz.iu_op == IMGR_UZ_OP_NONE) {
+            /* Collect the operation header. */
+            if (imgr_uz.iu_op_have == 0 && data[0] > IMGR_UZ_OP_DATA) {
+                return MGMT_ERR_EINVAL;
+            }
+            op = imgr_uz.iu_op_have ? imgr_uz.iu_op_hdr[0] : data[0];
+            need = (op == IMGR_UZ_OP_DATA) ? 5 : 9;
+            cnt = min(need - imgr_uz.iu_op_have, len);
+            memcpy(imgr_uz.iu_op_hdr + imgr_uz.iu_op_have, data, cnt);
+            imgr_uz.iu_op_have += cnt;
+            data += cnt;
+            len -= cnt;
+            if (imgr_uz.iu_op_have < need) {
+                break;
+            }
+
+            imgr_uz.iu_op = imgr_uz.iu_op_hdr[0];
+            imgr_uz.iu_op_have = 0;
+            if (imgr_uz.iu_op == IMGR_UZ_OP_DATA) {
+                imgr_uz.iu_op_src = 0;
+                imgr_uz.iu_op_left = imgr_uz_get32(imgr_uz.iu_op_hdr + 1);
+            } else {
+                imgr_uz.iu_op_src = imgr_uz_get32(imgr_uz.iu_op_hdr + 1);
+                imgr_uz.iu_op_left = imgr_uz_get32(imgr_uz.iu_op_hdr + 5);
+            }
+
+            if (imgr_uz.iu_op == IMGR_UZ_OP_COPY) {
+                rc = imgr_uz_src(imgr_uz.iu_op_src, NULL,
+                                 imgr_uz.iu_op_left);
+                if (rc) {
+                    return rc;
+                }
+                imgr_uz.iu_op_left = 0;
+            }
+        } else {
+            cnt = min(imgr_uz.iu_op_left, len);
+            if (imgr_uz.iu_op == IMGR_UZ_OP_ADD) {
+                rc = imgr_uz_src(imgr_uz.iu_op_src, data, cnt);
+                imgr_uz.iu_op_src += cnt;
+            } else {
+                rc = imgr_uz_out(data, cnt);
+            }
+            if (rc) {
+                return rc;
+            }
+            imgr_uz.iu_op_left -= cnt;
+            data += cnt;
+            len -= cnt;
+        }
+        if (imgr_uz.iu_op_left == 0) {
+            imgr_uz.iu_op = IMGR_UZ_OP_NONE;
+        }
+    }
+    return 0;
+}
+
+/*
+ * First stage: uploaded bytes, reassembled into LZ4 blocks if the upload is
+ * compressed.
+ */
+static int
+imgr_uz_feed(const uint8_t *data, uint32_t len)
+{
+    uint32_t cnt;
+    int blk_len;
+    int rc;
+
+    if (!(imgr_uz.iu_fmt & IMGMGR_UZ_FMT_LZ4)) {
+        return imgr_uz_delta(data, len);
+    }
+
+    while (len) {
+        if (imgr_uz.iu_blk_hdr_have < 2) {
+            imgr_uz.iu_blk_hdr[imgr_uz.iu_blk_hdr_have++] = *data++;
+            len--;
+            if (imgr_uz.iu_blk_hdr_have < 2) {
+                continue;
+            }
+            imgr_uz.iu_blk_len = imgr_uz.iu_blk_hdr[0] |
+                                 (imgr_uz.iu_blk_hdr[1] << 8);
+            imgr_uz.iu_blk_have = 0;
+            if (imgr_uz.iu_blk_len & IMGR_UZ_BLK_RAW) {
+                if ((imgr_uz.iu_blk_len & ~IMGR_UZ_BLK_RAW) > IMGR_UZ_BLK_SZ) {
+                    return MGMT_ERR_EINVAL;
+                }
+            } else if (imgr_uz.iu_blk_len > IMGR_UZ_BLK_MAX ||
+                       imgr_uz.iu_blk_len == 0) {
+                return MGMT_ERR_EINVAL;
+            }
+            continue;
+        }
+
+        cnt = (imgr_uz.iu_blk_len & ~IMGR_UZ_BLK_RAW) - imgr_uz.iu_blk_have;
+        if (cnt > len) {
+            cnt = len;
+        }
+        memcpy(imgr_uz.iu_blk + imgr_uz.iu_blk_have, data, cnt);
+        imgr_uz.iu_blk_have += cnt;
+        data += cnt;
+        len -= cnt;
+        if (imgr_uz.iu_blk_have < (imgr_uz.iu_blk_len & ~IMGR_UZ_BLK_RAW)) {
+            continue;
+        }
+
+        /* Block complete. */
+        imgr_uz.iu_blk_hdr_have = 0;
+        if (imgr_uz.iu_blk_len & IMGR_UZ_BLK_RAW) {
+            rc = imgr_uz_delta(imgr_uz.iu_blk, imgr_uz.iu_blk_have);
+        } else {
+            blk_len = lz4_decompress(imgr_uz.iu_blk, imgr_uz.iu_blk_have,
+                                     imgr_uz.iu_dec, sizeof(imgr_uz.iu_dec));
+            if (blk_len < 0) {
+                return MGMT_ERR_EINVAL;
+            }
+            rc = imgr_uz_delta(imgr_uz.iu_dec, blk_len);
+        }
+        if (rc) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+static void
+imgr_uz_abort(void)
+{
+    if (imgr_uz.iu_active) {
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+        imgr_preerase_stop();
+#endif
+        flash_area_close(imgr_uz.iu_fa);
+        if (imgr_uz.iu_src) {
+            flash_area_close(imgr_uz.iu_src);
+        }
+        imgr_uz.iu_active = 0;
+        imgmgr_dfu_stopped();
+    }
+}
+
+static int
+imgr_uz_start(uint32_t len, uint32_t ilen, uint8_t fmt,
+              const uint8_t *hash, const uint8_t *base, size_t base_len)
+{
+    uint8_t cur_hash[IMGMGR_HASH_LEN];
+    int area_id;
+    int rc;
+
+    imgr_uz_abort();
+
+    if (fmt & ~(IMGMGR_UZ_FMT_LZ4 | IMGMGR_UZ_FMT_DELTA)) {
+        return MGMT_ERR_ENOTSUP;
+    }
+
+    area_id = imgmgr_find_best_area_id();
+    if (area_id < 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+    memset(&imgr_uz, 0, sizeof(imgr_uz));
+    if (flash_area_open(area_id, &imgr_uz.iu_fa)) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+    if (ilen < sizeof(struct image_header) || ilen > imgr_uz.iu_fa->fa_size) {
+        flash_area_close(imgr_uz.iu_fa);
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (fmt & IMGMGR_UZ_FMT_DELTA) {
+        /* A delta is only usable against the image it was made for. */
+        if (base_len == IMGMGR_HASH_LEN) {
+            rc = img_mgmt_read_info(boot_current_slot, NULL, cur_hash, NULL);
+            if (rc || memcmp(cur_hash, base, IMGMGR_HASH_LEN)) {
+                flash_area_close(imgr_uz.iu_fa);
+                return MGMT_ERR_EBADSTATE;
+            }
+        }
+        rc = flash_area_open(flash_area_id_from_image_slot(boot_current_slot),
+                             &imgr_uz.iu_src);
+        if (rc || imgr_uz.iu_src == imgr_uz.iu_fa) {
+            flash_area_close(imgr_uz.iu_fa);
+            return MGMT_ERR_EUNKNOWN;
+        }
+    }
+
+#if !MYNEWT_VAL(IMGMGR_LAZY_ERASE) && !MYNEWT_VAL(IMGMGR_PREERASE)
+    rc = flash_area_erase(imgr_uz.iu_fa, 0, ilen);
+    if (rc) {
+        flash_area_close(imgr_uz.iu_fa);
+        if (imgr_uz.iu_src) {
+            flash_area_close(imgr_uz.iu_src);
+        }
+        return MGMT_ERR_EUNKNOWN;
+    }
+#endif
+
+    imgr_uz.iu_in_len = len;
+    imgr_uz.iu_out_len = ilen;
+    imgr_uz.iu_sec_id = -1;
+    imgr_uz.iu_fmt = fmt;
+    imgr_uz.iu_op = IMGR_UZ_OP_NONE;
+    memcpy(imgr_uz.iu_hash, hash, IMGMGR_HASH_LEN);
+    tc_sha256_init(&imgr_uz.iu_sha);
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+    rc = imgr_hash_start(&imgr_uz.iu_verify);
+    if (rc) {
+        flash_area_close(imgr_uz.iu_fa);
+        if (imgr_uz.iu_src) {
+            flash_area_close(imgr_uz.iu_src);
+        }
+        return rc;
+    }
+#endif
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+    imgr_preerase_start(imgr_uz.iu_fa, ilen);
+#endif
+    imgr_uz.iu_active = 1;
+
+    imgmgr_dfu_started();
+    return 0;
+}
+
+static int
+imgr_uz_finish(void)
+{
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (imgr_uz.iu_out_off != imgr_uz.iu_out_len ||
+      imgr_uz.iu_blk_hdr_have != 0 ||
+      imgr_uz.iu_op != IMGR_UZ_OP_NONE || imgr_uz.iu_op_have != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+    rc = imgr_uz_flush();
+    if (rc) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    tc_sha256_final(hash, &imgr_uz.iu_sha);
+    rc = memcmp(hash, imgr_uz.iu_hash, IMGMGR_HASH_LEN);
+#if MYNEWT_VAL(IMGMGR_STREAM_VERIFY)
+    /* The bootloader checks the same hash; catch a bad image now, without
+     * reading the slot back.
+     */
+    if (rc == 0) {
+        rc = imgr_hash_finish(&imgr_uz.iu_verify);
+    }
+#endif
+    if (rc) {
+        /* Make sure the bootloader never looks at the bad image. */
+        flash_area_erase(imgr_uz.iu_fa, 0, sizeof(struct image_header));
+        return MGMT_ERR_ECORRUPT;
+    }
+
+    imgr_uz.iu_active = 0;
+#if MYNEWT_VAL(IMGMGR_PREERASE)
+    imgr_preerase_stop();
+#endif
+    flash_area_close(imgr_uz.iu_fa);
+    if (imgr_uz.iu_src) {
+        flash_area_close(imgr_uz.iu_src);
+    }
+    imgmgr_dfu_stopped();
+    return 0;
+}
+
+int
+imgr_upload_z(struct mgmt_ctxt *ctxt)
+{
+    uint8_t data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
+    uint8_t hash[IMGMGR_HASH_LEN];
+    uint8_t base[IMGMGR_HASH_LEN];
+    unsigned long long off = UINT_MAX;
+    unsigned long long len = UINT_MAX;
+    unsigned long long ilen = UINT_MAX;
+    unsigned long long fmt = 0;
+    size_t data_len = 0;
+    size_t hash_len = 0;
+    size_t base_len = 0;
+    const struct cbor_attr_t uz_attr[8] = {
+        [0] = {
+            .attribute = "off",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &off,
+            .nodefault = true
+        },
+        [1] = {
+            .attribute = "data",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = data,
+            .addr.bytestring.len = &data_len,
+            .len = sizeof(data)
+        },
+        [2] = {
+            .attribute = "len",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &len,
+            .nodefault = true
+        },
+        [3] = {
+            .attribute = "ilen",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &ilen,
+            .nodefault = true
+        },
+        [4] = {
+            .attribute = "fmt",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &fmt,
+            .nodefault = true
+        },
+        [5] = {
+            .attribute = "sha",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = hash,
+            .addr.bytestring.len = &hash_len,
+            .len = sizeof(hash)
+        },
+        [6] = {
+            .attribute = "bsha",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.data = base,
+            .addr.bytestring.len = &base_len,
+            .len = sizeof(base)
+        },
+        [7] = { 0 },
+    };
+    CborError g_err = CborNoError;
+    int rc;
+
+    rc = cbor_read_object(&ctxt->it, uz_attr);
+    if (rc || off == UINT_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (off == 0) {
+        if (len == UINT_MAX || ilen == UINT_MAX ||
+          hash_len != IMGMGR_HASH_LEN) {
+            return MGMT_ERR_EINVAL;
+        }
+        if (imgr_upload_cb != NULL) {
+            rc = imgr_upload_cb(off, len, imgr_upload_arg);
+            if (rc) {
+                return img_mgmt_error_rsp(ctxt, rc, NULL);
+            }
+        }
+        rc = imgr_uz_start(len, ilen, fmt, hash, base, base_len);
+        if (rc) {
+            return img_mgmt_error_rsp(ctxt, rc, NULL);
+        }
+    } else if (!imgr_uz.iu_active) {
+        return img_mgmt_error_rsp(ctxt, MGMT_ERR_EBADSTATE, NULL);
+    }
+
+    if (off == imgr_uz.iu_in_off && data_len > 0) {
+        if (data_len > imgr_uz.iu_in_len - imgr_uz.iu_in_off) {
+            rc = MGMT_ERR_EINVAL;
+            goto err;
+        }
+        rc = imgr_uz_feed(data, data_len);
+        if (rc) {
+            goto err;
+        }
+        imgr_uz.iu_in_off += data_len;
+        if (imgr_uz.iu_in_off == imgr_uz.iu_in_len) {
+            rc = imgr_uz_finish();
+            if (rc) {
+                goto err;
+            }
+        }
+    }
+
+    /*
+     * An offset that does not match is answered with the one expected, so
+     * the client can resend the missing part.
+     */
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "rc");
+    g_err |= cbor_encode_int(&ctxt->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "off");
+    g_err |= cbor_encode_uint(&ctxt->encoder, imgr_uz.iu_in_off);
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+
+err:
+    imgr_uz_abort();
+    return img_mgmt_error_rsp(ctxt, rc, NULL);
+}
+
+#endif
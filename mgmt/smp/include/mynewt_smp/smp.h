@@ -60,15 +60,72 @@ struct smp_transport {
     struct os_mqueue st_imq;
     smp_transport_out_func_t st_output;
     smp_transport_get_mtu_func_t st_get_mtu;
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+    /** Requests received but not yet processed. */
+    uint8_t st_inflight;
+#endif
+};
+
+/** Largest transport user header a notification destination can hold. */
+#define SMP_NOTIFY_USRHDR_MAX   4
+
+/**
+ * Where unsolicited messages (notifications) for a client are sent: the
+ * transport and user header of one of its requests.
+ */
+struct smp_notify_dst {
+    struct smp_transport *snd_st;
+    uint8_t snd_usrhdr[SMP_NOTIFY_USRHDR_MAX];
+    uint8_t snd_usrhdr_len;
 };
 
 void smp_event_put(struct os_event *ev);
 int smp_transport_init(struct smp_transport *st,
         smp_transport_out_func_t output_func,
         smp_transport_get_mtu_func_t get_mtu_func);
+/**
+ * Queues a received request for processing on the mgmt event queue.  The
+ * request mbuf is always consumed.
+ *
+ * @return 0 on success; OS_ENOMEM if SMP_RX_WINDOW requests are already
+ *         queued on this transport; other OS error codes on failure.
+ */
 int smp_rx_req(struct smp_transport *st, struct os_mbuf *req);
 struct os_eventq *mgmt_evq_get(void);
 
+/**
+ * Processes a single request received on the given transport and sends
+ * the response.  The request mbuf is always consumed.
+ */
+int smp_process_request(struct smp_transport *st, struct os_mbuf *req);
+
+/**
+ * Fills in the notification destination of the client whose request is
+ * being processed.  Only valid from within a command handler.
+ *
+ * @return 0 on success; MGMT_ERR_EINVAL if no request is being processed.
+ */
+int smp_notify_dst_get(struct smp_notify_dst *dst);
+
+/**
+ * Allocates an empty packet for a notification to the given destination.
+ */
+struct os_mbuf *smp_notify_alloc(const struct smp_notify_dst *dst);
+
+/**
+ * Returns the largest notification that can currently be sent to the
+ * destination; 0 if the destination cannot be reached.  om must come from
+ * smp_notify_alloc().
+ */
+uint16_t smp_notify_mtu(const struct smp_notify_dst *dst,
+                        struct os_mbuf *om);
+
+/**
+ * Sends a notification, including its SMP header, in a single transport
+ * frame.  Notifications are not fragmented.  om is always consumed.
+ */
+int smp_notify_tx(const struct smp_notify_dst *dst, struct os_mbuf *om);
+
 #ifdef __cplusplus
 }
 #endif
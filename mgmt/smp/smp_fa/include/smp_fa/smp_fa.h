@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _SMP_FA_H_
+#define _SMP_FA_H_
+
+#include <inttypes.h>
+#include "os/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_area;
+
+/*
+ * Id's for flash area transfer commands
+ */
+
+/*
+ * Write: {"src": name, "off": first, "win": bytes, "credits": n} starts
+ * sending the named source to the client as notifications, beginning at
+ * byte "off" (default 0).  A transfer cut short, e.g. by a dropped link, is
+ * resumed by starting it again from the last verified window.  An empty
+ * name stops the transfer.  Returns {"off": first, "len": total}.
+ * Read: returns the source being sent, the next offset, its length, credits
+ * left and the number of chunks sent.
+ */
+#define SMP_FA_ID_XFER          0
+
+/*
+ * Write: {"credits": n} allows n more chunks to be sent.  Clients keep
+ * several chunks in flight by granting credits ahead of time.
+ */
+#define SMP_FA_ID_CREDIT        1
+
+/*
+ * Notifications carrying data use this id in a read response.  Each holds
+ * {"off": offset, "data": bytes}.  Chunks never cross a window boundary;
+ * the last chunk of each window adds {"woff": start, "crc": crc32} covering
+ * the window from "woff" up to the end of this chunk.  Windows start at the
+ * first offset of the transfer and are "win" bytes long.
+ */
+#define SMP_FA_ID_CHUNK         2
+
+/*
+ * Read: returns {"srcs": {name: {"area": id, "len": bytes}, ...}}.
+ */
+#define SMP_FA_ID_LIST          3
+
+/**
+ * Returns the number of bytes of valid data in a source's flash area.
+ *
+ * @param fa                    The open flash area.
+ * @param len                   On success, the length of the data.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+typedef int smp_fa_len_fn(const struct flash_area *fa, uint32_t *len);
+
+/**
+ * Flash area offered for download.
+ */
+struct smp_fa_src {
+    /** Name clients ask for */
+    const char *sfs_name;
+    /** Flash area holding the data */
+    uint8_t sfs_area_id;
+    /** Length of the data; NULL sends the whole area */
+    smp_fa_len_fn *sfs_len;
+
+    SLIST_ENTRY(smp_fa_src) sfs_next;
+};
+
+/**
+ * Offers a flash area for download, e.g. the area of an FCB backed log.
+ * The data is sent as is, so the client must know how to parse it.
+ *
+ * @param src                   The source; must stay valid.
+ *
+ * @return                      0 on success; SYS_EALREADY if a source with
+ *                                  the same name is registered.
+ */
+int smp_fa_src_register(struct smp_fa_src *src);
+
+void smp_fa_groups_register(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SMP_FA_H_ */
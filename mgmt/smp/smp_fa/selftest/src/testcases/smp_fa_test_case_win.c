@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "mgmt/mgmt.h"
+#include "mynewt_smp/smp.h"
+#include "flash_map/flash_map.h"
+#include "sysflash/sysflash.h"
+#include "crc/crc32.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "smp_fa/smp_fa.h"
+#include "smp_fa_test.h"
+
+#define SMP_FA_TEST_LEN     300
+#define SMP_FA_TEST_OFF     10
+#define SMP_FA_TEST_MTU     128
+
+static struct smp_transport smp_fa_test_st;
+static uint8_t smp_fa_test_data[SMP_FA_TEST_LEN];
+static uint8_t smp_fa_test_rx[SMP_FA_TEST_LEN];
+static uint32_t smp_fa_test_next;
+static int smp_fa_test_chunks;
+static int smp_fa_test_crcs;
+static uint32_t smp_fa_test_woff;
+static uint32_t smp_fa_test_crc;
+static int smp_fa_test_rsps;
+
+static int
+smp_fa_test_src_len(const struct flash_area *fa, uint32_t *len)
+{
+    *len = SMP_FA_TEST_LEN;
+    return 0;
+}
+
+static struct smp_fa_src smp_fa_test_src = {
+    .sfs_name = "test",
+    .sfs_area_id = FLASH_AREA_NFFS,
+    .sfs_len = smp_fa_test_src_len,
+};
+
+static uint16_t
+smp_fa_test_get_mtu(struct os_mbuf *om)
+{
+    return SMP_FA_TEST_MTU;
+}
+
+static void
+smp_fa_test_chunk_rx(struct os_mbuf *om)
+{
+    struct cbor_mbuf_reader reader;
+    CborParser parser;
+    CborValue map;
+    CborValue val;
+    uint64_t off;
+    uint64_t u;
+    size_t len;
+    int rc;
+
+    cbor_mbuf_reader_init(&reader, om, sizeof(struct mgmt_hdr));
+    rc = cbor_parser_init(&reader.r, 0, &parser, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = cbor_value_map_find_value(&map, "off", &val);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_unsigned_integer(&val));
+    cbor_value_get_uint64(&val, &off);
+    TEST_ASSERT_FATAL(off == smp_fa_test_next);
+
+    rc = cbor_value_map_find_value(&map, "data", &val);
+    TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_byte_string(&val));
+    len = SMP_FA_TEST_LEN - off;
+    rc = cbor_value_copy_byte_string(&val, smp_fa_test_rx + off, &len, NULL);
+    TEST_ASSERT_FATAL(rc == 0 && len > 0);
+    smp_fa_test_next += len;
+    smp_fa_test_chunks++;
+
+    rc = cbor_value_map_find_value(&map, "woff", &val);
+    if (rc == 0 && cbor_value_is_unsigned_integer(&val)) {
+        cbor_value_get_uint64(&val, &u);
+        smp_fa_test_woff = u;
+        rc = cbor_value_map_find_value(&map, "crc", &val);
+        TEST_ASSERT_FATAL(rc == 0 && cbor_value_is_unsigned_integer(&val));
+        cbor_value_get_uint64(&val, &u);
+        smp_fa_test_crc = u;
+        smp_fa_test_crcs++;
+    }
+}
+
+static int
+smp_fa_test_out(struct os_mbuf *om)
+{
+    struct mgmt_hdr hdr;
+    int rc;
+
+    rc = os_mbuf_copydata(om, 0, sizeof(hdr), &hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    if (hdr.nh_op == MGMT_OP_READ_RSP && hdr.nh_id == SMP_FA_ID_CHUNK) {
+        smp_fa_test_chunk_rx(om);
+    } else if (hdr.nh_op == MGMT_OP_WRITE_RSP) {
+        smp_fa_test_rsps++;
+    }
+
+    os_mbuf_free_chain(om);
+    return 0;
+}
+
+/* Starts transfer of the test source from off, windows of win bytes. */
+static void
+smp_fa_test_xfer_start(uint32_t off, uint32_t win)
+{
+    struct cbor_mbuf_writer writer;
+    struct mgmt_hdr hdr;
+    struct os_mbuf *om;
+    CborEncoder enc;
+    CborEncoder map;
+    CborError err = CborNoError;
+    int rc;
+
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.nh_op = MGMT_OP_WRITE;
+    hdr.nh_group = htons(MYNEWT_VAL(SMP_FA_GROUP_ID));
+    hdr.nh_id = SMP_FA_ID_XFER;
+    rc = os_mbuf_append(om, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    err |= cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    err |= cbor_encode_text_stringz(&map, "src");
+    err |= cbor_encode_text_stringz(&map, smp_fa_test_src.sfs_name);
+    err |= cbor_encode_text_stringz(&map, "off");
+    err |= cbor_encode_uint(&map, off);
+    err |= cbor_encode_text_stringz(&map, "win");
+    err |= cbor_encode_uint(&map, win);
+    err |= cbor_encode_text_stringz(&map, "credits");
+    err |= cbor_encode_uint(&map, 100);
+    err |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(err == CborNoError);
+
+    hdr.nh_len = htons(OS_MBUF_PKTLEN(om) - sizeof(hdr));
+    os_mbuf_copyinto(om, 0, &hdr, sizeof(hdr));
+
+    rc = smp_process_request(&smp_fa_test_st, om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Let the default event queue send all chunks. */
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+}
+
+TEST_CASE_TASK(smp_fa_test_case_win)
+{
+    const struct flash_area *fa;
+    uint32_t crc;
+    int rc;
+    int i;
+
+    for (i = 0; i < SMP_FA_TEST_LEN; i++) {
+        smp_fa_test_data[i] = i * 7;
+    }
+
+    rc = flash_area_open(FLASH_AREA_NFFS, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase(fa, 0, SMP_FA_TEST_LEN);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(fa, 0, smp_fa_test_data, SMP_FA_TEST_LEN);
+    TEST_ASSERT_FATAL(rc == 0);
+    flash_area_close(fa);
+
+    rc = smp_fa_src_register(&smp_fa_test_src);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = smp_transport_init(&smp_fa_test_st, smp_fa_test_out,
+                            smp_fa_test_get_mtu);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*
+     * Largest window accepted; the start offset plus the window wraps past
+     * UINT32_MAX.  The whole transfer is sent as a single window.
+     */
+    smp_fa_test_next = SMP_FA_TEST_OFF;
+    smp_fa_test_xfer_start(SMP_FA_TEST_OFF, UINT32_MAX);
+
+    TEST_ASSERT(smp_fa_test_rsps == 1);
+    TEST_ASSERT_FATAL(smp_fa_test_next == SMP_FA_TEST_LEN);
+    TEST_ASSERT(smp_fa_test_chunks > 1);
+    TEST_ASSERT(memcmp(smp_fa_test_rx + SMP_FA_TEST_OFF,
+                       smp_fa_test_data + SMP_FA_TEST_OFF,
+                       SMP_FA_TEST_LEN - SMP_FA_TEST_OFF) == 0);
+
+    crc = crc32_calc(crc32_init(), smp_fa_test_data + SMP_FA_TEST_OFF,
+                     SMP_FA_TEST_LEN - SMP_FA_TEST_OFF);
+    TEST_ASSERT(smp_fa_test_crcs == 1);
+    TEST_ASSERT(smp_fa_test_woff == SMP_FA_TEST_OFF);
+    TEST_ASSERT(smp_fa_test_crc == crc);
+
+    /* Small windows each get their own CRC. */
+    smp_fa_test_next = 0;
+    smp_fa_test_chunks = 0;
+    smp_fa_test_crcs = 0;
+    smp_fa_test_xfer_start(0, 100);
+
+    TEST_ASSERT(smp_fa_test_rsps == 2);
+    TEST_ASSERT_FATAL(smp_fa_test_next == SMP_FA_TEST_LEN);
+    TEST_ASSERT(smp_fa_test_crcs == 3);
+    TEST_ASSERT(smp_fa_test_woff == 200);
+    crc = crc32_calc(crc32_init(), smp_fa_test_data + 200, 100);
+    TEST_ASSERT(smp_fa_test_crc == crc);
+    TEST_ASSERT(memcmp(smp_fa_test_rx, smp_fa_test_data,
+                       SMP_FA_TEST_LEN) == 0);
+}
@@ -0,0 +1,595 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "mynewt_smp/smp.h"
+#include "flash_map/flash_map.h"
+#include "crc/crc32.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "cborattr/cborattr.h"
+#if MYNEWT_VAL(SMP_FA_COREDUMP)
+#include "coredump/coredump.h"
+#endif
+
+#include "smp_fa/smp_fa.h"
+
+/* Worst case encoded size of a chunk, excluding its data. */
+#define SMP_FA_CHUNK_OVERHEAD   48
+
+/* An MTU that cannot hold this much data is as good as none. */
+#define SMP_FA_CHUNK_MIN        16
+
+#define SMP_FA_NAME_MAX         32
+
+/* Delay before retrying a chunk that could not get mbufs. */
+#define SMP_FA_RETRY_TICKS      max(1, OS_TICKS_PER_SEC / 100)
+
+/*
+ * Transfer state.  There is a single transfer: the one the most recent
+ * client started.  Everything runs on the mgmt event queue.
+ */
+struct smp_fa_xfer {
+    struct smp_notify_dst sfx_dst;
+    struct smp_fa_src *sfx_src;
+    const struct flash_area *sfx_fa;
+    /* Offset of the next chunk */
+    uint32_t sfx_off;
+    /* End of the data */
+    uint32_t sfx_end;
+    /* Start of the current window, and its CRC so far */
+    uint32_t sfx_woff;
+    uint32_t sfx_crc;
+    uint32_t sfx_win;
+    /* Chunks the client is still willing to accept */
+    uint16_t sfx_credits;
+    uint32_t sfx_sent;
+    struct os_event sfx_ev;
+    /* Retries a chunk that could not get an mbuf */
+    struct os_callout sfx_retry;
+};
+
+static struct smp_fa_xfer smp_fa_xfer;
+static SLIST_HEAD(, smp_fa_src) smp_fa_srcs =
+    SLIST_HEAD_INITIALIZER(smp_fa_srcs);
+
+static int smp_fa_xfer_read(struct mgmt_ctxt *);
+static int smp_fa_xfer_write(struct mgmt_ctxt *);
+static int smp_fa_credit_write(struct mgmt_ctxt *);
+static int smp_fa_list_read(struct mgmt_ctxt *);
+
+static const struct mgmt_handler smp_fa_handlers[] = {
+    [SMP_FA_ID_XFER] = { smp_fa_xfer_read, smp_fa_xfer_write },
+    [SMP_FA_ID_CREDIT] = { NULL, smp_fa_credit_write },
+    [SMP_FA_ID_CHUNK] = { NULL, NULL },
+    [SMP_FA_ID_LIST] = { smp_fa_list_read, NULL },
+};
+
+static struct mgmt_group smp_fa_group = {
+    .mg_handlers = (struct mgmt_handler *)smp_fa_handlers,
+    .mg_handlers_count = sizeof(smp_fa_handlers) / sizeof(smp_fa_handlers[0]),
+    .mg_group_id = MYNEWT_VAL(SMP_FA_GROUP_ID),
+};
+
+#if MYNEWT_VAL(SMP_FA_COREDUMP)
+static int
+smp_fa_coredump_len(const struct flash_area *fa, uint32_t *len)
+{
+    struct coredump_header hdr;
+    int rc;
+
+    rc = flash_area_read(fa, 0, &hdr, sizeof(hdr));
+    if (rc != 0) {
+        return rc;
+    }
+
+    *len = hdr.ch_magic == COREDUMP_MAGIC ? hdr.ch_size : 0;
+    return 0;
+}
+
+static struct smp_fa_src smp_fa_coredump_src = {
+    .sfs_name = "coredump",
+    .sfs_area_id = MYNEWT_VAL(COREDUMP_FLASH_AREA),
+    .sfs_len = smp_fa_coredump_len,
+};
+#endif
+
+static struct smp_fa_src *
+smp_fa_src_find(const char *name)
+{
+    struct smp_fa_src *src;
+
+    SLIST_FOREACH(src, &smp_fa_srcs, sfs_next) {
+        if (strcmp(src->sfs_name, name) == 0) {
+            return src;
+        }
+    }
+
+    return NULL;
+}
+
+int
+smp_fa_src_register(struct smp_fa_src *src)
+{
+    if (smp_fa_src_find(src->sfs_name) != NULL) {
+        return SYS_EALREADY;
+    }
+
+    SLIST_INSERT_HEAD(&smp_fa_srcs, src, sfs_next);
+    return 0;
+}
+
+/* Returns the length of a source's data, limited to its flash area. */
+static int
+smp_fa_src_len(const struct smp_fa_src *src, const struct flash_area *fa,
+               uint32_t *len)
+{
+    int rc;
+
+    if (src->sfs_len == NULL) {
+        *len = fa->fa_size;
+        return 0;
+    }
+
+    rc = src->sfs_len(fa, len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    *len = min(*len, fa->fa_size);
+    return 0;
+}
+
+static void
+smp_fa_xfer_stop(struct smp_fa_xfer *sfx)
+{
+    if (sfx->sfx_src != NULL) {
+        flash_area_close(sfx->sfx_fa);
+        sfx->sfx_src = NULL;
+        sfx->sfx_fa = NULL;
+    }
+    sfx->sfx_credits = 0;
+    os_callout_stop(&sfx->sfx_retry);
+    os_eventq_remove(mgmt_evq_get(), &sfx->sfx_ev);
+}
+
+/*
+ * Appends len bytes of data at the transfer offset to om as a CBOR byte
+ * string.  The data is read from flash straight into the mbuf chain, a
+ * buffer at a time, and added to the running CRC in crc.
+ *
+ * @return 0 on success; SYS_ENOMEM if the mbuf chain could not be
+ *         extended; SYS_EIO if the flash could not be read.
+ */
+static int
+smp_fa_data_append(struct smp_fa_xfer *sfx, struct os_mbuf *om,
+                   uint16_t len, uint32_t *crc)
+{
+    struct os_mbuf *last;
+    uint8_t head[3];
+    uint16_t piece;
+    uint32_t off;
+    void *dst;
+    int rc;
+
+    if (len < 24) {
+        head[0] = 0x40 | len;
+        rc = os_mbuf_append(om, head, 1);
+    } else if (len <= UINT8_MAX) {
+        head[0] = 0x58;
+        head[1] = len;
+        rc = os_mbuf_append(om, head, 2);
+    } else {
+        head[0] = 0x59;
+        head[1] = len >> 8;
+        head[2] = len;
+        rc = os_mbuf_append(om, head, 3);
+    }
+    if (rc != 0) {
+        return SYS_ENOMEM;
+    }
+
+    off = sfx->sfx_off;
+    while (len > 0) {
+        last = om;
+        while (SLIST_NEXT(last, om_next) != NULL) {
+            last = SLIST_NEXT(last, om_next);
+        }
+        piece = min(len, OS_MBUF_TRAILINGSPACE(last));
+        if (piece == 0) {
+            piece = min(len, om->om_omp->omp_databuf_len);
+        }
+
+        dst = os_mbuf_extend(om, piece);
+        if (dst == NULL) {
+            return SYS_ENOMEM;
+        }
+        rc = flash_area_read(sfx->sfx_fa, off, dst, piece);
+        if (rc != 0) {
+            return SYS_EIO;
+        }
+
+        *crc = crc32_calc(*crc, dst, piece);
+        off += piece;
+        len -= piece;
+    }
+
+    return 0;
+}
+
+/*
+ * Sends one chunk, as large as the transport MTU allows.
+ *
+ * @return 1 if more data is left to send; 0 if the transfer is complete or
+ *         the chunk is to be retried later; -1 if the client is
+ *         unreachable or the data cannot be read.
+ */
+static int
+smp_fa_chunk_send(struct smp_fa_xfer *sfx)
+{
+    struct cbor_mbuf_writer writer;
+    struct mgmt_hdr hdr;
+    struct os_mbuf *om;
+    CborEncoder enc;
+    CborEncoder map;
+    CborError err = CborNoError;
+    uint32_t wend;
+    uint32_t crc;
+    uint16_t mtu;
+    uint16_t len;
+    int rc;
+
+    om = smp_notify_alloc(&sfx->sfx_dst);
+    if (om == NULL) {
+        os_callout_reset(&sfx->sfx_retry, SMP_FA_RETRY_TICKS);
+        return 0;
+    }
+
+    mtu = smp_notify_mtu(&sfx->sfx_dst, om);
+    if (mtu < sizeof(hdr) + SMP_FA_CHUNK_OVERHEAD + SMP_FA_CHUNK_MIN) {
+        os_mbuf_free_chain(om);
+        return -1;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    if (os_mbuf_append(om, &hdr, sizeof(hdr)) != 0) {
+        os_mbuf_free_chain(om);
+        os_callout_reset(&sfx->sfx_retry, SMP_FA_RETRY_TICKS);
+        return 0;
+    }
+
+    /* Chunks end at window boundaries, so each CRC covers whole chunks. */
+    wend = sfx->sfx_woff + min(sfx->sfx_win, sfx->sfx_end - sfx->sfx_woff);
+    len = min(wend - sfx->sfx_off,
+              mtu - OS_MBUF_PKTLEN(om) - SMP_FA_CHUNK_OVERHEAD);
+    crc = sfx->sfx_crc;
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+
+    err |= cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    err |= cbor_encode_text_stringz(&map, "off");
+    err |= cbor_encode_uint(&map, sfx->sfx_off);
+    err |= cbor_encode_text_stringz(&map, "data");
+    if (err == CborNoError) {
+        rc = smp_fa_data_append(sfx, om, len, &crc);
+        if (rc == SYS_EIO) {
+            os_mbuf_free_chain(om);
+            return -1;
+        }
+        if (rc != 0) {
+            err |= CborErrorOutOfMemory;
+        }
+    }
+    if (sfx->sfx_off + len == wend) {
+        err |= cbor_encode_text_stringz(&map, "woff");
+        err |= cbor_encode_uint(&map, sfx->sfx_woff);
+        err |= cbor_encode_text_stringz(&map, "crc");
+        err |= cbor_encode_uint(&map, crc);
+    }
+    err |= cbor_encoder_close_container(&enc, &map);
+
+    if (err != CborNoError) {
+        os_mbuf_free_chain(om);
+        os_callout_reset(&sfx->sfx_retry, SMP_FA_RETRY_TICKS);
+        return 0;
+    }
+
+    hdr.nh_op = MGMT_OP_READ_RSP;
+    hdr.nh_len = htons(OS_MBUF_PKTLEN(om) - sizeof(hdr));
+    hdr.nh_group = htons(MYNEWT_VAL(SMP_FA_GROUP_ID));
+    hdr.nh_id = SMP_FA_ID_CHUNK;
+    os_mbuf_copyinto(om, 0, &hdr, sizeof(hdr));
+
+    if (smp_notify_tx(&sfx->sfx_dst, om) != 0) {
+        return -1;
+    }
+    sfx->sfx_sent++;
+    sfx->sfx_credits--;
+
+    sfx->sfx_off += len;
+    if (sfx->sfx_off == wend) {
+        sfx->sfx_woff = wend;
+        sfx->sfx_crc = crc32_init();
+    } else {
+        sfx->sfx_crc = crc;
+    }
+
+    return sfx->sfx_off < sfx->sfx_end;
+}
+
+static void
+smp_fa_xfer_ev(struct os_event *ev)
+{
+    struct smp_fa_xfer *sfx = ev->ev_arg;
+    int rc;
+
+    if (sfx->sfx_src == NULL || sfx->sfx_credits == 0) {
+        return;
+    }
+
+    rc = smp_fa_chunk_send(sfx);
+    if (rc < 0 || sfx->sfx_off >= sfx->sfx_end) {
+        smp_fa_xfer_stop(sfx);
+    } else if (rc > 0 && sfx->sfx_credits > 0) {
+        /* Let other requests run between chunks. */
+        os_eventq_put(mgmt_evq_get(), &sfx->sfx_ev);
+    }
+}
+
+static int
+smp_fa_xfer_read(struct mgmt_ctxt *mc)
+{
+    struct smp_fa_xfer *sfx = &smp_fa_xfer;
+    CborError err = CborNoError;
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "src");
+    err |= cbor_encode_text_stringz(&mc->encoder,
+                                    sfx->sfx_src ? sfx->sfx_src->sfs_name : "");
+    err |= cbor_encode_text_stringz(&mc->encoder, "off");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_off);
+    err |= cbor_encode_text_stringz(&mc->encoder, "len");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_end);
+    err |= cbor_encode_text_stringz(&mc->encoder, "credits");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_credits);
+    err |= cbor_encode_text_stringz(&mc->encoder, "sent");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_sent);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+smp_fa_xfer_write(struct mgmt_ctxt *mc)
+{
+    struct smp_fa_xfer *sfx = &smp_fa_xfer;
+    const struct flash_area *fa;
+    struct smp_fa_src *src;
+    char name[SMP_FA_NAME_MAX];
+    long long int off = 0;
+    long long int win = MYNEWT_VAL(SMP_FA_WINDOW);
+    long long int credits = 1;
+    CborError err = CborNoError;
+    uint32_t len;
+    int rc;
+    const struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "src",
+            .type = CborAttrTextStringType,
+            .addr.string = name,
+            .len = sizeof(name),
+        },
+        [1] = {
+            .attribute = "off",
+            .type = CborAttrIntegerType,
+            .addr.integer = &off,
+        },
+        [2] = {
+            .attribute = "win",
+            .type = CborAttrIntegerType,
+            .addr.integer = &win,
+        },
+        [3] = {
+            .attribute = "credits",
+            .type = CborAttrIntegerType,
+            .addr.integer = &credits,
+        },
+        [4] = { 0 },
+    };
+
+    name[0] = '\0';
+    rc = cbor_read_object(&mc->it, attrs);
+    if (rc != 0 || off < 0 || off > UINT32_MAX || win <= 0 ||
+        win > UINT32_MAX || credits < 0 || credits > UINT16_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    smp_fa_xfer_stop(sfx);
+    len = 0;
+
+    if (name[0] != '\0') {
+        src = smp_fa_src_find(name);
+        if (src == NULL) {
+            return MGMT_ERR_ENOENT;
+        }
+        rc = flash_area_open(src->sfs_area_id, &fa);
+        if (rc != 0) {
+            return MGMT_ERR_ENOENT;
+        }
+        rc = smp_fa_src_len(src, fa, &len);
+        if (rc != 0) {
+            flash_area_close(fa);
+            return MGMT_ERR_EUNKNOWN;
+        }
+        if (off > len) {
+            flash_area_close(fa);
+            return MGMT_ERR_EINVAL;
+        }
+        rc = smp_notify_dst_get(&sfx->sfx_dst);
+        if (rc != 0) {
+            flash_area_close(fa);
+            return rc;
+        }
+
+        sfx->sfx_src = src;
+        sfx->sfx_fa = fa;
+        sfx->sfx_off = off;
+        sfx->sfx_end = len;
+        sfx->sfx_woff = off;
+        sfx->sfx_crc = crc32_init();
+        /* No window extends past the data, however large "win" is. */
+        sfx->sfx_win = min(win, len - off);
+        sfx->sfx_credits = credits;
+        sfx->sfx_sent = 0;
+
+        if (sfx->sfx_off == sfx->sfx_end) {
+            /* Nothing (left) to send. */
+            smp_fa_xfer_stop(sfx);
+        } else if (sfx->sfx_credits > 0) {
+            os_eventq_put(mgmt_evq_get(), &sfx->sfx_ev);
+        }
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "off");
+    err |= cbor_encode_uint(&mc->encoder, off);
+    err |= cbor_encode_text_stringz(&mc->encoder, "len");
+    err |= cbor_encode_uint(&mc->encoder, len);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+smp_fa_credit_write(struct mgmt_ctxt *mc)
+{
+    struct smp_fa_xfer *sfx = &smp_fa_xfer;
+    long long int credits = 0;
+    CborError err = CborNoError;
+    int rc;
+    const struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "credits",
+            .type = CborAttrIntegerType,
+            .addr.integer = &credits,
+            .nodefault = 1
+        },
+        [1] = { 0 },
+    };
+
+    rc = cbor_read_object(&mc->it, attrs);
+    if (rc != 0 || credits < 0) {
+        return MGMT_ERR_EINVAL;
+    }
+    if (sfx->sfx_src == NULL) {
+        return MGMT_ERR_ENOENT;
+    }
+
+    sfx->sfx_credits = min(UINT16_MAX, sfx->sfx_credits + credits);
+    if (sfx->sfx_credits > 0) {
+        os_eventq_put(mgmt_evq_get(), &sfx->sfx_ev);
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "off");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_off);
+    err |= cbor_encode_text_stringz(&mc->encoder, "credits");
+    err |= cbor_encode_uint(&mc->encoder, sfx->sfx_credits);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+smp_fa_list_read(struct mgmt_ctxt *mc)
+{
+    const struct flash_area *fa;
+    struct smp_fa_src *src;
+    CborError err = CborNoError;
+    CborEncoder srcs;
+    CborEncoder map;
+    uint32_t len;
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "srcs");
+    err |= cbor_encoder_create_map(&mc->encoder, &srcs, CborIndefiniteLength);
+
+    SLIST_FOREACH(src, &smp_fa_srcs, sfs_next) {
+        if (flash_area_open(src->sfs_area_id, &fa) != 0) {
+            continue;
+        }
+        if (smp_fa_src_len(src, fa, &len) != 0) {
+            len = 0;
+        }
+        flash_area_close(fa);
+
+        err |= cbor_encode_text_stringz(&srcs, src->sfs_name);
+        err |= cbor_encoder_create_map(&srcs, &map, CborIndefiniteLength);
+        err |= cbor_encode_text_stringz(&map, "area");
+        err |= cbor_encode_uint(&map, src->sfs_area_id);
+        err |= cbor_encode_text_stringz(&map, "len");
+        err |= cbor_encode_uint(&map, len);
+        err |= cbor_encoder_close_container(&srcs, &map);
+    }
+
+    err |= cbor_encoder_close_container(&mc->encoder, &srcs);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+void
+smp_fa_groups_register(void)
+{
+    mgmt_register_group(&smp_fa_group);
+}
+
+void
+smp_fa_pkg_init(void)
+{
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    smp_fa_xfer.sfx_ev.ev_cb = smp_fa_xfer_ev;
+    smp_fa_xfer.sfx_ev.ev_arg = &smp_fa_xfer;
+    os_callout_init(&smp_fa_xfer.sfx_retry, mgmt_evq_get(), smp_fa_xfer_ev,
+                    &smp_fa_xfer);
+
+#if MYNEWT_VAL(SMP_FA_COREDUMP)
+    smp_fa_src_register(&smp_fa_coredump_src);
+#endif
+
+    smp_fa_groups_register();
+}
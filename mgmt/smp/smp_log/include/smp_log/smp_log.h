@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _SMP_LOG_H_
+#define _SMP_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Id's for log streaming commands
+ */
+
+/*
+ * Write: {"log": name, "index": first, "credits": n} starts streaming the
+ * named log to the client, beginning with entry "index" (default: the next
+ * new entry).  An empty name stops streaming.
+ * Read: returns the log being streamed, the next index, credits left and
+ * the sent and dropped counters.
+ */
+#define SMP_LOG_ID_STREAM       0
+
+/*
+ * Write: {"credits": n} allows n more notifications to be sent.
+ */
+#define SMP_LOG_ID_CREDIT       1
+
+/*
+ * Notifications carrying entries use this id in a read response.  Each holds
+ * {"log": name, "next": index, "drops": n, "entries": [...]}, where "next"
+ * is the index following the last entry sent.
+ */
+#define SMP_LOG_ID_ENTRIES      2
+
+void smp_log_groups_register(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SMP_LOG_H_ */
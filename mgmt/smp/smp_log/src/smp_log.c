@@ -0,0 +1,447 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "mynewt_smp/smp.h"
+#include "log/log.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "cborattr/cborattr.h"
+
+#include "smp_log/smp_log.h"
+
+/* Worst case encoded size of an entry, excluding its body. */
+#define SMP_LOG_ENTRY_OVERHEAD  48
+
+/* Worst case size of the fields following the entries, closing included. */
+#define SMP_LOG_TRAILER_LEN     24
+
+#define SMP_LOG_NAME_MAX        32
+
+/*
+ * Streaming state.  There is a single subscriber: the client that most
+ * recently started a stream.  Everything except the append callback runs
+ * on the mgmt event queue.
+ */
+struct smp_log_stream {
+    struct smp_notify_dst sls_dst;
+    struct log *sls_log;
+    /* Append callback the log had before streaming started */
+    log_append_cb *sls_prev_cb;
+    /* Index of the next entry to send */
+    uint32_t sls_next;
+    /* Notifications the client is still willing to accept */
+    uint16_t sls_credits;
+    uint32_t sls_sent;
+    /* Entries overwritten before they could be sent */
+    uint32_t sls_drops;
+    struct os_event sls_ev;
+};
+
+struct smp_log_batch {
+    CborEncoder *slb_entries;
+    uint16_t slb_room;
+    uint16_t slb_cnt;
+    CborError slb_err;
+};
+
+static struct smp_log_stream smp_log_stream;
+static uint8_t smp_log_body[MYNEWT_VAL(SMP_LOG_BODY_MAX)];
+
+static int smp_log_stream_read(struct mgmt_ctxt *);
+static int smp_log_stream_write(struct mgmt_ctxt *);
+static int smp_log_credit_write(struct mgmt_ctxt *);
+
+static const struct mgmt_handler smp_log_handlers[] = {
+    [SMP_LOG_ID_STREAM] = { smp_log_stream_read, smp_log_stream_write },
+    [SMP_LOG_ID_CREDIT] = { NULL, smp_log_credit_write },
+};
+
+static struct mgmt_group smp_log_group = {
+    .mg_handlers = (struct mgmt_handler *)smp_log_handlers,
+    .mg_handlers_count = sizeof(smp_log_handlers) / sizeof(smp_log_handlers[0]),
+    .mg_group_id = MYNEWT_VAL(SMP_LOG_GROUP_ID),
+};
+
+/*
+ * Called from whichever task appended the entry; only wakes up the
+ * streamer.
+ */
+static void
+smp_log_append_cb(struct log *log, uint32_t idx)
+{
+    struct smp_log_stream *sls = &smp_log_stream;
+    log_append_cb *prev;
+
+    prev = sls->sls_prev_cb;
+    if (prev != NULL) {
+        prev(log, idx);
+    }
+
+    if (sls->sls_credits > 0) {
+        os_eventq_put(mgmt_evq_get(), &sls->sls_ev);
+    }
+}
+
+static void
+smp_log_stream_stop(struct smp_log_stream *sls)
+{
+    if (sls->sls_log != NULL) {
+        log_set_append_cb(sls->sls_log, sls->sls_prev_cb);
+        sls->sls_log = NULL;
+        sls->sls_prev_cb = NULL;
+    }
+    sls->sls_credits = 0;
+    os_eventq_remove(mgmt_evq_get(), &sls->sls_ev);
+}
+
+static int
+smp_log_batch_add(struct log *log, struct log_offset *lo,
+                  const struct log_entry_hdr *hdr, const void *dptr,
+                  uint16_t len)
+{
+    struct smp_log_stream *sls = &smp_log_stream;
+    struct smp_log_batch *slb = lo->lo_arg;
+    CborEncoder entry;
+    CborError err = CborNoError;
+    int rc;
+
+    if (len > sizeof(smp_log_body)) {
+        len = sizeof(smp_log_body);
+    }
+    if (len + SMP_LOG_ENTRY_OVERHEAD > slb->slb_room) {
+        if (slb->slb_cnt > 0 || slb->slb_room <= SMP_LOG_ENTRY_OVERHEAD) {
+            /* Batch is full; the rest goes in the next notification. */
+            return 1;
+        }
+        /* Entry is too large for any notification, send what fits. */
+        len = slb->slb_room - SMP_LOG_ENTRY_OVERHEAD;
+    }
+
+    rc = log_read_body(log, dptr, smp_log_body, 0, len);
+    if (rc < 0) {
+        return 1;
+    }
+    len = rc;
+
+#if !MYNEWT_VAL(LOG_GLOBAL_IDX)
+    /* Per-log indices have no holes; a gap means the log wrapped. */
+    if (hdr->ue_index > sls->sls_next) {
+        sls->sls_drops += hdr->ue_index - sls->sls_next;
+    }
+#endif
+
+    err |= cbor_encoder_create_map(slb->slb_entries, &entry,
+                                   CborIndefiniteLength);
+    err |= cbor_encode_text_stringz(&entry, "ts");
+    err |= cbor_encode_int(&entry, hdr->ue_ts);
+    err |= cbor_encode_text_stringz(&entry, "level");
+    err |= cbor_encode_uint(&entry, hdr->ue_level);
+    err |= cbor_encode_text_stringz(&entry, "module");
+    err |= cbor_encode_uint(&entry, hdr->ue_module);
+    err |= cbor_encode_text_stringz(&entry, "index");
+    err |= cbor_encode_uint(&entry, hdr->ue_index);
+    err |= cbor_encode_text_stringz(&entry, "type");
+    err |= cbor_encode_uint(&entry, hdr->ue_etype);
+    err |= cbor_encode_text_stringz(&entry, "msg");
+    err |= cbor_encode_byte_string(&entry, smp_log_body, len);
+    err |= cbor_encoder_close_container(slb->slb_entries, &entry);
+
+    slb->slb_err |= err;
+    slb->slb_cnt++;
+    slb->slb_room -= min(slb->slb_room, len + SMP_LOG_ENTRY_OVERHEAD);
+    sls->sls_next = hdr->ue_index + 1;
+
+    return 0;
+}
+
+/*
+ * Sends one notification holding as many new entries as fit in the
+ * transport MTU.
+ *
+ * @return 1 if the batch was full and more entries may be pending; 0 if
+ *         there was nothing more to send; -1 if the client is unreachable.
+ */
+static int
+smp_log_batch_send(struct smp_log_stream *sls)
+{
+    struct cbor_mbuf_writer writer;
+    struct smp_log_batch slb;
+    struct log_offset lo;
+    struct mgmt_hdr hdr;
+    struct os_mbuf *om;
+    CborEncoder enc;
+    CborEncoder map;
+    CborEncoder entries;
+    CborError err = CborNoError;
+    uint16_t mtu;
+    int rc;
+
+    om = smp_notify_alloc(&sls->sls_dst);
+    if (om == NULL) {
+        /* Retry when the next entry is appended. */
+        return 0;
+    }
+
+    /* An MTU that cannot hold a single short entry is as good as none. */
+    mtu = smp_notify_mtu(&sls->sls_dst, om);
+    if (mtu < sizeof(hdr) + SMP_LOG_NAME_MAX + SMP_LOG_TRAILER_LEN +
+              2 * SMP_LOG_ENTRY_OVERHEAD) {
+        os_mbuf_free_chain(om);
+        return -1;
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    if (os_mbuf_append(om, &hdr, sizeof(hdr)) != 0) {
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+
+    err |= cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    err |= cbor_encode_text_stringz(&map, "log");
+    err |= cbor_encode_text_stringz(&map, sls->sls_log->l_name);
+    err |= cbor_encode_text_stringz(&map, "entries");
+    err |= cbor_encoder_create_array(&map, &entries, CborIndefiniteLength);
+
+    /* "next" and "drops" follow the entries, which update them. */
+    slb = (struct smp_log_batch) {
+        .slb_entries = &entries,
+        .slb_room = mtu - min(mtu, OS_MBUF_PKTLEN(om) + SMP_LOG_TRAILER_LEN),
+    };
+    lo = (struct log_offset) {
+        .lo_ts = 0,
+        .lo_index = sls->sls_next,
+        .lo_arg = &slb,
+    };
+    rc = log_walk_body(sls->sls_log, smp_log_batch_add, &lo);
+
+    err |= slb.slb_err;
+    err |= cbor_encoder_close_container(&map, &entries);
+    err |= cbor_encode_text_stringz(&map, "next");
+    err |= cbor_encode_uint(&map, sls->sls_next);
+    err |= cbor_encode_text_stringz(&map, "drops");
+    err |= cbor_encode_uint(&map, sls->sls_drops);
+    err |= cbor_encoder_close_container(&enc, &map);
+
+    if (slb.slb_cnt == 0 || err != CborNoError) {
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+
+    hdr.nh_op = MGMT_OP_READ_RSP;
+    hdr.nh_len = htons(OS_MBUF_PKTLEN(om) - sizeof(hdr));
+    hdr.nh_group = htons(MYNEWT_VAL(SMP_LOG_GROUP_ID));
+    hdr.nh_id = SMP_LOG_ID_ENTRIES;
+    os_mbuf_copyinto(om, 0, &hdr, sizeof(hdr));
+
+    if (smp_notify_tx(&sls->sls_dst, om) != 0) {
+        return -1;
+    }
+    sls->sls_sent++;
+    sls->sls_credits--;
+
+    /* A walk aborted by a full batch leaves entries behind. */
+    return rc != 0;
+}
+
+static void
+smp_log_stream_ev(struct os_event *ev)
+{
+    struct smp_log_stream *sls = ev->ev_arg;
+    int rc;
+
+    if (sls->sls_log == NULL || sls->sls_credits == 0) {
+        return;
+    }
+
+    rc = smp_log_batch_send(sls);
+    if (rc < 0) {
+        smp_log_stream_stop(sls);
+    } else if (rc > 0 && sls->sls_credits > 0) {
+        /* Let other requests run between batches. */
+        os_eventq_put(mgmt_evq_get(), &sls->sls_ev);
+    }
+}
+
+static int
+smp_log_stream_read(struct mgmt_ctxt *mc)
+{
+    struct smp_log_stream *sls = &smp_log_stream;
+    CborError err = CborNoError;
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "log");
+    err |= cbor_encode_text_stringz(&mc->encoder,
+                                    sls->sls_log ? sls->sls_log->l_name : "");
+    err |= cbor_encode_text_stringz(&mc->encoder, "index");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_next);
+    err |= cbor_encode_text_stringz(&mc->encoder, "credits");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_credits);
+    err |= cbor_encode_text_stringz(&mc->encoder, "sent");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_sent);
+    err |= cbor_encode_text_stringz(&mc->encoder, "drops");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_drops);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+smp_log_stream_write(struct mgmt_ctxt *mc)
+{
+    struct smp_log_stream *sls = &smp_log_stream;
+    char name[SMP_LOG_NAME_MAX];
+    long long int index = -1;
+    long long int credits = 1;
+    CborError err = CborNoError;
+    struct log *log;
+    int rc;
+    const struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "log",
+            .type = CborAttrTextStringType,
+            .addr.string = name,
+            .len = sizeof(name),
+        },
+        [1] = {
+            .attribute = "index",
+            .type = CborAttrIntegerType,
+            .addr.integer = &index,
+        },
+        [2] = {
+            .attribute = "credits",
+            .type = CborAttrIntegerType,
+            .addr.integer = &credits,
+        },
+        [3] = { 0 },
+    };
+
+    name[0] = '\0';
+    rc = cbor_read_object(&mc->it, attrs);
+    if (rc != 0 || index > UINT32_MAX || credits < 0 ||
+        credits > UINT16_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    smp_log_stream_stop(sls);
+
+    if (name[0] != '\0') {
+        log = log_find(name);
+        if (log == NULL) {
+            return MGMT_ERR_ENOENT;
+        }
+        rc = smp_notify_dst_get(&sls->sls_dst);
+        if (rc != 0) {
+            return rc;
+        }
+
+        sls->sls_next = index >= 0 ? index : log_get_last_index(log);
+        sls->sls_credits = credits;
+        sls->sls_sent = 0;
+        sls->sls_drops = 0;
+        sls->sls_prev_cb = log->l_append_cb;
+        sls->sls_log = log;
+        log_set_append_cb(log, smp_log_append_cb);
+
+        /* Send anything already logged from the requested index on. */
+        if (sls->sls_credits > 0) {
+            os_eventq_put(mgmt_evq_get(), &sls->sls_ev);
+        }
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "index");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_next);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+smp_log_credit_write(struct mgmt_ctxt *mc)
+{
+    struct smp_log_stream *sls = &smp_log_stream;
+    long long int credits = 0;
+    CborError err = CborNoError;
+    int rc;
+    const struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "credits",
+            .type = CborAttrIntegerType,
+            .addr.integer = &credits,
+            .nodefault = 1
+        },
+        [1] = { 0 },
+    };
+
+    rc = cbor_read_object(&mc->it, attrs);
+    if (rc != 0 || credits < 0) {
+        return MGMT_ERR_EINVAL;
+    }
+    if (sls->sls_log == NULL) {
+        return MGMT_ERR_ENOENT;
+    }
+
+    sls->sls_credits = min(UINT16_MAX, sls->sls_credits + credits);
+    if (sls->sls_credits > 0) {
+        os_eventq_put(mgmt_evq_get(), &sls->sls_ev);
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    err |= cbor_encode_text_stringz(&mc->encoder, "credits");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_credits);
+    err |= cbor_encode_text_stringz(&mc->encoder, "drops");
+    err |= cbor_encode_uint(&mc->encoder, sls->sls_drops);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+void
+smp_log_groups_register(void)
+{
+    mgmt_register_group(&smp_log_group);
+}
+
+void
+smp_log_pkg_init(void)
+{
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    smp_log_stream.sls_ev.ev_cb = smp_log_stream_ev;
+    smp_log_stream.sls_ev.ev_arg = &smp_log_stream;
+
+    smp_log_groups_register();
+}
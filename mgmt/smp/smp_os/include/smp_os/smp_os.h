@@ -33,6 +33,10 @@ extern "C" {
 #define SMP_ID_MPSTATS         3
 #define SMP_ID_DATETIME_STR    4
 #define SMP_ID_RESET           5
+#define SMP_ID_SCHEDSTATS      6
+#define SMP_ID_TRACE_READ      7
+#define SMP_ID_EVQSTATS        8
+#define SMP_ID_MEMBUDGET       9
 
 void smp_os_groups_register(void);
 
@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "os/mynewt.h"
+#include "os/os_budget.h"
 
 #include <hal/hal_system.h>
 #include <hal/hal_watchdog.h>
@@ -43,6 +44,19 @@ static int smp_def_console_echo(struct mgmt_ctxt *cb);
 static int smp_def_mpstat_read(struct mgmt_ctxt *cb);
 static int smp_datetime_get(struct mgmt_ctxt *cb);
 static int smp_datetime_set(struct mgmt_ctxt *cb);
+static int smp_def_membudget_read(struct mgmt_ctxt *cb);
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+static int smp_def_schedstat_read(struct mgmt_ctxt *cb);
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+static int smp_def_evqstat_read(struct mgmt_ctxt *cb);
+#endif
+#if MYNEWT_VAL(OS_TRACE_RING)
+static int smp_def_trace_read(struct mgmt_ctxt *cb);
+
+/* Number of trace records returned per request */
+#define SMP_TRACE_READ_MAX      16
+#endif
 
 static const struct mgmt_handler smp_def_group_handlers[] = {
     [SMP_ID_CONS_ECHO_CTRL] = {
@@ -54,6 +68,24 @@ static const struct mgmt_handler smp_def_group_handlers[] = {
     [SMP_ID_DATETIME_STR] = {
         smp_datetime_get, smp_datetime_set
     },
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    [SMP_ID_SCHEDSTATS] = {
+        smp_def_schedstat_read, NULL
+    },
+#endif
+#if MYNEWT_VAL(OS_TRACE_RING)
+    [SMP_ID_TRACE_READ] = {
+        smp_def_trace_read, NULL
+    },
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    [SMP_ID_EVQSTATS] = {
+        smp_def_evqstat_read, NULL
+    },
+#endif
+    [SMP_ID_MEMBUDGET] = {
+        smp_def_membudget_read, NULL
+    },
 };
 
 #define SMP_DEF_GROUP_SZ                                               \
@@ -136,6 +168,262 @@ smp_def_mpstat_read(struct mgmt_ctxt *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+static int
+smp_def_schedstat_read(struct mgmt_ctxt *cb)
+{
+    struct os_task *prev_task;
+    struct os_task_info oti;
+    CborError g_err = CborNoError;
+    CborEncoder tasks;
+    CborEncoder task;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "tasks");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &tasks,
+                                     CborIndefiniteLength);
+
+    prev_task = NULL;
+    while (1) {
+        prev_task = os_task_info_get_next(prev_task, &oti);
+        if (prev_task == NULL) {
+            break;
+        }
+
+        g_err |= cbor_encode_text_stringz(&tasks, oti.oti_name);
+        g_err |= cbor_encoder_create_map(&tasks, &task, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&task, "prio");
+        g_err |= cbor_encode_uint(&task, oti.oti_prio);
+        g_err |= cbor_encode_text_stringz(&task, "load");
+        g_err |= cbor_encode_uint(&task, oti.oti_load);
+        g_err |= cbor_encode_text_stringz(&task, "latmax");
+        g_err |= cbor_encode_uint(&task, oti.oti_lat_max);
+        g_err |= cbor_encode_text_stringz(&task, "latavg");
+        g_err |= cbor_encode_uint(&task, oti.oti_lat_avg);
+        g_err |= cbor_encode_text_stringz(&task, "burst");
+        g_err |= cbor_encode_uint(&task, oti.oti_burst_max);
+        g_err |= cbor_encoder_close_container(&tasks, &task);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &tasks);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+/*
+ * Returns, for every monitored event queue, the run and put-to-dispatch
+ * times of each event callback in microseconds.
+ */
+static int
+smp_def_evqstat_read(struct mgmt_ctxt *cb)
+{
+    const struct os_eventq_mon *mon;
+    struct os_eventq *evq;
+    CborError g_err = CborNoError;
+    CborEncoder evqs;
+    CborEncoder cbs;
+    CborEncoder map;
+    CborEncoder ent;
+    int i;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "evqs");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &evqs,
+                                       CborIndefiniteLength);
+
+    evq = NULL;
+    while ((evq = os_eventq_mon_get_next(evq)) != NULL) {
+        g_err |= cbor_encoder_create_map(&evqs, &map, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&map, "task");
+        g_err |= cbor_encode_text_stringz(&map, evq->evq_owner ?
+                                          evq->evq_owner->t_name : "");
+        g_err |= cbor_encode_text_stringz(&map, "miss");
+        g_err |= cbor_encode_uint(&map, evq->evq_mon_miss);
+        g_err |= cbor_encode_text_stringz(&map, "cbs");
+        g_err |= cbor_encoder_create_array(&map, &cbs, CborIndefiniteLength);
+
+        for (i = 0; i < evq->evq_mon_elems; i++) {
+            mon = &evq->evq_mon[i];
+            if (mon->em_cb == NULL || mon->em_cnt == 0) {
+                continue;
+            }
+
+            g_err |= cbor_encoder_create_map(&cbs, &ent, CborIndefiniteLength);
+            g_err |= cbor_encode_text_stringz(&ent, "cb");
+            g_err |= cbor_encode_uint(&ent, (uintptr_t)mon->em_cb);
+            g_err |= cbor_encode_text_stringz(&ent, "cnt");
+            g_err |= cbor_encode_uint(&ent, mon->em_cnt);
+            g_err |= cbor_encode_text_stringz(&ent, "avg");
+            g_err |= cbor_encode_uint(&ent, os_cputime_ticks_to_usecs(
+                                          mon->em_cum / mon->em_cnt));
+            g_err |= cbor_encode_text_stringz(&ent, "max");
+            g_err |= cbor_encode_uint(&ent,
+                                      os_cputime_ticks_to_usecs(mon->em_max));
+            g_err |= cbor_encode_text_stringz(&ent, "qavg");
+            g_err |= cbor_encode_uint(&ent, os_cputime_ticks_to_usecs(
+                                          mon->em_qcum / mon->em_cnt));
+            g_err |= cbor_encode_text_stringz(&ent, "qmax");
+            g_err |= cbor_encode_uint(&ent,
+                                      os_cputime_ticks_to_usecs(mon->em_qmax));
+            g_err |= cbor_encoder_close_container(&cbs, &ent);
+        }
+
+        g_err |= cbor_encoder_close_container(&map, &cbs);
+        g_err |= cbor_encoder_close_container(&evqs, &map);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &evqs);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
+/*
+ * Returns each task's stack peak and held memory, and each pool's peak
+ * block count, with the sizes suggested for them.  Sizes are in bytes.
+ */
+static int
+smp_def_membudget_read(struct mgmt_ctxt *cb)
+{
+    struct os_mempool_budget omb;
+    struct os_task_budget otb;
+    struct os_mempool *prev_mp;
+    struct os_task *prev_task;
+    CborError g_err = CborNoError;
+    CborEncoder entries;
+    CborEncoder entry;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "tasks");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &entries,
+                                     CborIndefiniteLength);
+
+    prev_task = NULL;
+    while (1) {
+        prev_task = os_task_budget_get_next(prev_task, &otb);
+        if (prev_task == NULL) {
+            break;
+        }
+
+        g_err |= cbor_encode_text_stringz(&entries, otb.otb_name);
+        g_err |= cbor_encoder_create_map(&entries, &entry,
+                                         CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&entry, "id");
+        g_err |= cbor_encode_uint(&entry, otb.otb_taskid);
+        g_err |= cbor_encode_text_stringz(&entry, "stksz");
+        g_err |= cbor_encode_uint(&entry, otb.otb_stack_size);
+        g_err |= cbor_encode_text_stringz(&entry, "stkmax");
+        g_err |= cbor_encode_uint(&entry, otb.otb_stack_peak);
+        g_err |= cbor_encode_text_stringz(&entry, "stksug");
+        g_err |= cbor_encode_uint(&entry, otb.otb_stack_suggest);
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+        g_err |= cbor_encode_text_stringz(&entry, "heap");
+        g_err |= cbor_encode_uint(&entry, otb.otb_heap_bytes);
+#endif
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+        g_err |= cbor_encode_text_stringz(&entry, "pblks");
+        g_err |= cbor_encode_uint(&entry, otb.otb_pool_blocks);
+        g_err |= cbor_encode_text_stringz(&entry, "pbytes");
+        g_err |= cbor_encode_uint(&entry, otb.otb_pool_bytes);
+#endif
+        g_err |= cbor_encoder_close_container(&entries, &entry);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &entries);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "mpools");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &entries,
+                                     CborIndefiniteLength);
+
+    prev_mp = NULL;
+    while (1) {
+        prev_mp = os_mempool_budget_get_next(prev_mp, &omb);
+        if (prev_mp == NULL) {
+            break;
+        }
+
+        g_err |= cbor_encode_text_stringz(&entries, omb.omb_name);
+        g_err |= cbor_encoder_create_map(&entries, &entry,
+                                         CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&entry, "blksiz");
+        g_err |= cbor_encode_uint(&entry, omb.omb_block_size);
+        g_err |= cbor_encode_text_stringz(&entry, "nblks");
+        g_err |= cbor_encode_uint(&entry, omb.omb_num_blocks);
+        g_err |= cbor_encode_text_stringz(&entry, "peak");
+        g_err |= cbor_encode_uint(&entry, omb.omb_peak_blocks);
+        g_err |= cbor_encode_text_stringz(&entry, "sug");
+        g_err |= cbor_encode_uint(&entry, omb.omb_suggest_blocks);
+        g_err |= cbor_encode_text_stringz(&entry, "reclaim");
+        g_err |= cbor_encode_uint(&entry, omb.omb_reclaim_bytes);
+        g_err |= cbor_encoder_close_container(&entries, &entry);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &entries);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+
+#if MYNEWT_VAL(OS_TRACE_RING)
+/*
+ * Returns raw trace ring records, starting at sequence number "seq". The
+ * client keeps asking for seq + n until no records are returned.
+ */
+static int
+smp_def_trace_read(struct mgmt_ctxt *cb)
+{
+    struct os_trace_ring_rec recs[SMP_TRACE_READ_MAX];
+    long long unsigned int seq = 0;
+    CborError g_err = CborNoError;
+    uint32_t first;
+    int cnt;
+    int rc;
+    const struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "seq",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &seq,
+        },
+        [1] = { 0 },
+    };
+
+    rc = cbor_read_object(&cb->it, attrs);
+    if (rc) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    cnt = os_trace_ring_read(seq, recs, SMP_TRACE_READ_MAX, &first);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "seq");
+    g_err |= cbor_encode_uint(&cb->encoder, first);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "freq");
+    g_err |= cbor_encode_uint(&cb->encoder, g_os_trace_ring.otr_ts_freq);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "recs");
+    g_err |= cbor_encode_byte_string(&cb->encoder, (uint8_t *)recs,
+                                     cnt * sizeof(recs[0]));
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
 static int
 smp_datetime_get(struct mgmt_ctxt *cb)
 {
@@ -31,6 +31,16 @@
 /* Shared queue that SMP uses for work items. */
 struct os_eventq *g_smp_evq;
 
+#if MYNEWT_VAL(SMP_TASK)
+static struct os_eventq smp_evq;
+static struct os_task smp_task;
+OS_TASK_STACK_DEFINE(smp_task_stack, MYNEWT_VAL(SMP_TASK_STACK_SIZE));
+#endif
+
+/* Request being processed, for smp_notify_dst_get(). */
+static struct smp_transport *smp_cur_st;
+static struct os_mbuf *smp_cur_req;
+
 static mgmt_alloc_rsp_fn smp_alloc_rsp;
 static mgmt_trim_front_fn smp_trim_front;
 static mgmt_reset_buf_fn smp_reset_buf;
@@ -101,6 +111,14 @@ smp_reset_buf(void *m, void *arg)
      * to get rid of
      */
     os_mbuf_adj(m, -1 * OS_MBUF_PKTLEN((struct os_mbuf *)m));
+
+#if MYNEWT_VAL(SMP_ALIGNED_RSP)
+    /* Drop the now empty tail so that a rewrite starts segment alignment
+     * from scratch.
+     */
+    os_mbuf_free_chain(SLIST_NEXT((struct os_mbuf *)m, om_next));
+    SLIST_NEXT((struct os_mbuf *)m, om_next) = NULL;
+#endif
 }
 
 static int
@@ -163,12 +181,26 @@ smp_init_writer(struct cbor_encoder_writer *writer, void *m,
 		void *arg)
 {
     struct cbor_mbuf_writer *cmw;
-     
+#if MYNEWT_VAL(SMP_ALIGNED_RSP)
+    struct smp_transport *st = arg;
+    uint16_t mtu;
+#endif
+
     if (!writer) {
         return MGMT_ERR_EINVAL;
     }
 
     cmw = (struct cbor_mbuf_writer *)writer;
+#if MYNEWT_VAL(SMP_ALIGNED_RSP)
+    /* Lay the response out in MTU sized segments; smp_tx_rsp() can then
+     * send each one as it is.
+     */
+    mtu = st ? st->st_get_mtu(m) : 0;
+    if (mtu != 0) {
+        cbor_mbuf_writer_init_aligned(cmw, m, mtu);
+        return 0;
+    }
+#endif
     cbor_mbuf_writer_init(cmw, m);
 
     return 0;
@@ -198,6 +230,50 @@ smp_rsp_frag_alloc(uint16_t frag_size, void *arg)
     return frag;
 }
 
+#if MYNEWT_VAL(SMP_ALIGNED_RSP)
+/**
+ * Detaches the first fragment of a response written by an aligned writer.
+ * This only unlinks mbufs: the fragment boundary must fall on an mbuf
+ * boundary and the next segment must begin with a packet header.
+ *
+ * @return                      The fragment; NULL if the chain is not
+ *                                  aligned to max_frag_sz.
+ */
+static struct os_mbuf *
+smp_split_aligned(struct os_mbuf **om, uint16_t max_frag_sz)
+{
+    struct os_mbuf *frag;
+    struct os_mbuf *last;
+    struct os_mbuf *next;
+    int len;
+
+    frag = *om;
+    if (OS_MBUF_PKTLEN(frag) <= max_frag_sz) {
+        *om = NULL;
+        return frag;
+    }
+
+    len = 0;
+    for (last = frag; last != NULL; last = SLIST_NEXT(last, om_next)) {
+        len += last->om_len;
+        if (len >= max_frag_sz) {
+            break;
+        }
+    }
+    next = SLIST_NEXT(last, om_next);
+    if (len != max_frag_sz || next == NULL || !OS_MBUF_IS_PKTHDR(next)) {
+        return NULL;
+    }
+
+    SLIST_NEXT(last, om_next) = NULL;
+    OS_MBUF_PKTHDR(next)->omp_len = OS_MBUF_PKTLEN(frag) - max_frag_sz;
+    OS_MBUF_PKTHDR(frag)->omp_len = max_frag_sz;
+    *om = next;
+
+    return frag;
+}
+#endif
+
 int
 smp_tx_rsp(struct smp_streamer *ns, void *rsp, void *arg)
 {
@@ -217,7 +293,15 @@ smp_tx_rsp(struct smp_streamer *ns, void *rsp, void *arg)
     }
 
     while (m != NULL) {
+#if MYNEWT_VAL(SMP_ALIGNED_RSP)
+        frag = smp_split_aligned(&m, mtu);
+        if (frag == NULL) {
+            /* The MTU changed since the response was written. */
+            frag = mem_split_frag(&m, mtu, smp_rsp_frag_alloc, m);
+        }
+#else
         frag = mem_split_frag(&m, mtu, smp_rsp_frag_alloc, rsp);
+#endif
         if (frag == NULL) {
             return MGMT_ERR_ENOMEM;
         }
@@ -231,8 +315,116 @@ smp_tx_rsp(struct smp_streamer *ns, void *rsp, void *arg)
     return 0;
 }
 
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+/**
+ * Reserves a slot for a received request.  Requests beyond the window are
+ * refused so that a client pipelining requests gets backpressure from the
+ * transport instead of exhausting the msys pool.
+ */
+static int
+smp_window_get(struct smp_transport *st)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    if (st->st_inflight >= MYNEWT_VAL(SMP_RX_WINDOW)) {
+        rc = -1;
+    } else {
+        st->st_inflight++;
+        rc = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+static void
+smp_window_put(struct smp_transport *st)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(st->st_inflight > 0);
+    st->st_inflight--;
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
+int
+smp_process_request(struct smp_transport *st, struct os_mbuf *req)
+{
+    int rc;
+
+    smp_cur_st = st;
+    smp_cur_req = req;
+    rc = smp_process_request_packet(&st->st_streamer, req);
+    smp_cur_st = NULL;
+    smp_cur_req = NULL;
+
+    return rc;
+}
+
+int
+smp_notify_dst_get(struct smp_notify_dst *dst)
+{
+    uint16_t len;
+
+    if (smp_cur_st == NULL) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    len = OS_MBUF_USRHDR_LEN(smp_cur_req);
+    if (len > sizeof(dst->snd_usrhdr)) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    dst->snd_st = smp_cur_st;
+    memcpy(dst->snd_usrhdr, OS_MBUF_USRHDR(smp_cur_req), len);
+    dst->snd_usrhdr_len = len;
+
+    return 0;
+}
+
+struct os_mbuf *
+smp_notify_alloc(const struct smp_notify_dst *dst)
+{
+    struct os_mbuf *om;
+
+    om = os_msys_get_pkthdr(0, dst->snd_usrhdr_len);
+    if (om != NULL) {
+        memcpy(OS_MBUF_USRHDR(om), dst->snd_usrhdr, dst->snd_usrhdr_len);
+    }
+
+    return om;
+}
+
+uint16_t
+smp_notify_mtu(const struct smp_notify_dst *dst, struct os_mbuf *om)
+{
+    return dst->snd_st->st_get_mtu(om);
+}
+
+int
+smp_notify_tx(const struct smp_notify_dst *dst, struct os_mbuf *om)
+{
+    uint16_t mtu;
+
+    mtu = dst->snd_st->st_get_mtu(om);
+    if (mtu == 0 || OS_MBUF_PKTLEN(om) > mtu) {
+        os_mbuf_free_chain(om);
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    if (dst->snd_st->st_output(om) != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    return 0;
+}
+
 /**
- * Processes a single SMP packet and sends the corresponding response(s).
+ * Processes all queued SMP packets and sends the corresponding response(s).
  */
 static int
 smp_process_packet(struct smp_transport *st)
@@ -256,31 +448,47 @@ smp_process_packet(struct smp_transport *st)
         .tx_rsp_cb = smp_tx_rsp,
     };
 
+    /* Requests are handled, and their responses sent, in arrival order.  A
+     * failed request must not hold back the ones queued behind it.
+     */
+    rc = 0;
     while (1) {
         m = os_mqueue_get(&st->st_imq);
         if (!m) {
             break;
         }
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+        smp_window_put(st);
+#endif
 
-        rc = smp_process_request_packet(&st->st_streamer, m);
-        if (rc) {
-            return rc;
+        if (smp_process_request(st, m) != 0) {
+            rc = MGMT_ERR_EUNKNOWN;
         }
     }
-    
-    return 0;
+
+    return rc;
 }
 
 int
 smp_rx_req(struct smp_transport *st, struct os_mbuf *req)
 {
     int rc;
-    
-    rc = os_mqueue_put(&st->st_imq, os_eventq_dflt_get(), req);
+
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+    if (smp_window_get(st)) {
+        rc = OS_ENOMEM;
+        goto err;
+    }
+#endif
+
+    rc = os_mqueue_put(&st->st_imq, mgmt_evq_get(), req);
     if (rc) {
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+        smp_window_put(st);
+#endif
         goto err;
     }
-     
+
     return 0;
 err:
     os_mbuf_free_chain(req);
@@ -307,17 +515,47 @@ smp_transport_init(struct smp_transport *st,
     if (rc != 0) {
         goto err;
     }
+#if MYNEWT_VAL(SMP_RX_WINDOW) > 0
+    st->st_inflight = 0;
+#endif
 
     return 0;
 err:
     return rc;
 }
 
+#if MYNEWT_VAL(SMP_TASK)
+static void
+smp_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&smp_evq);
+    }
+}
+#endif
+
 void
 smp_pkg_init(void)
 {
+#if MYNEWT_VAL(SMP_TASK)
+    int rc;
+#endif
+
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
+#if MYNEWT_VAL(SMP_TASK)
+    /* Keep long running commands (image erase, flash writes) off the
+     * default task, and let requests queue up while one is processed.
+     */
+    os_eventq_init(&smp_evq);
+    rc = os_task_init(&smp_task, "smp", smp_task_handler, NULL,
+                      MYNEWT_VAL(SMP_TASK_PRIO), OS_WAIT_FOREVER,
+                      smp_task_stack, MYNEWT_VAL(SMP_TASK_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    mgmt_evq_set(&smp_evq);
+#else
     mgmt_evq_set(os_eventq_dflt_get());
+#endif
 }
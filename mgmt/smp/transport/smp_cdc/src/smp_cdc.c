@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <inttypes.h>
+#include <assert.h>
+
+#include "os/mynewt.h"
+
+#include <mgmt/mgmt.h>
+#include <mynewt_smp/smp.h>
+#include <cdc_mbuf/cdc_mbuf.h>
+
+/**
+ * \addtogroup SMP SMP
+ * @{
+ */
+
+/*
+ * SMP frames are sent over CDC as is, without the base64 and CRC framing
+ * used on UART; USB bulk transfers are already reliable.  Frames are
+ * delimited by the length field of the SMP header, same as on BLE.
+ */
+
+struct smp_cdc_state {
+    struct cdc_mbuf scs_cdc;
+    struct smp_transport scs_transport;
+    /* Received data that does not form a full frame yet */
+    struct os_mbuf *scs_rx_pkt;
+};
+
+static struct smp_cdc_state smp_cdc_state;
+
+static uint16_t
+smp_cdc_mtu(struct os_mbuf *m)
+{
+    return MGMT_MAX_MTU;
+}
+
+static int
+smp_cdc_out(struct os_mbuf *m)
+{
+    struct smp_cdc_state *scs = &smp_cdc_state;
+
+    return cdc_mbuf_tx(&scs->scs_cdc, m);
+}
+
+static void
+smp_cdc_rx_drop(struct smp_cdc_state *scs)
+{
+    os_mbuf_free_chain(scs->scs_rx_pkt);
+    scs->scs_rx_pkt = NULL;
+}
+
+/**
+ * Collects received data and passes complete frames to SMP.  A frame
+ * that ends in the middle of received data is cut off, the rest is
+ * copied to a new packet.
+ */
+static void
+smp_cdc_rx(struct cdc_mbuf *cm, struct os_mbuf *om)
+{
+    struct smp_cdc_state *scs = &smp_cdc_state;
+    struct mgmt_hdr hdr;
+    struct os_mbuf *rest;
+    int frame_len;
+    int pkt_len;
+
+    if (scs->scs_rx_pkt) {
+        os_mbuf_concat(scs->scs_rx_pkt, om);
+    } else {
+        scs->scs_rx_pkt = om;
+    }
+
+    while (scs->scs_rx_pkt) {
+        pkt_len = OS_MBUF_PKTLEN(scs->scs_rx_pkt);
+        if (pkt_len < sizeof(hdr)) {
+            break;
+        }
+        os_mbuf_copydata(scs->scs_rx_pkt, 0, sizeof(hdr), &hdr);
+        frame_len = sizeof(hdr) + ntohs(hdr.nh_len);
+        if (frame_len > MYNEWT_VAL(SMP_CDC_MAX_FRAME)) {
+            /* Not a header, lost sync with host */
+            smp_cdc_rx_drop(scs);
+            break;
+        }
+        if (pkt_len < frame_len) {
+            break;
+        }
+
+        rest = NULL;
+        if (pkt_len > frame_len) {
+            rest = os_msys_get_pkthdr(pkt_len - frame_len, 0);
+            if (rest == NULL ||
+                os_mbuf_appendfrom(rest, scs->scs_rx_pkt, frame_len, pkt_len - frame_len)) {
+                os_mbuf_free_chain(rest);
+                smp_cdc_rx_drop(scs);
+                break;
+            }
+            os_mbuf_adj(scs->scs_rx_pkt, frame_len - pkt_len);
+        }
+        smp_rx_req(&scs->scs_transport, scs->scs_rx_pkt);
+        scs->scs_rx_pkt = rest;
+    }
+}
+
+void
+smp_cdc_pkg_init(void)
+{
+    struct smp_cdc_state *scs = &smp_cdc_state;
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = smp_transport_init(&scs->scs_transport, smp_cdc_out, smp_cdc_mtu);
+    assert(rc == 0);
+
+    rc = cdc_mbuf_init(&scs->scs_cdc, mgmt_evq_get(), smp_cdc_rx);
+    assert(rc == 0);
+}
+
+/**
+ * @} SMP
+ */
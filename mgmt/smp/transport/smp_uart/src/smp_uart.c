@@ -43,6 +43,14 @@
 #define SHELL_NLIP_PKT          0x0609
 #define SHELL_NLIP_DATA         0x0414
 
+/* SLIP (RFC 1055) special characters. */
+#define SMP_UART_SLIP_END       0xc0
+#define SMP_UART_SLIP_ESC       0xdb
+#define SMP_UART_SLIP_ESC_END   0xdc
+#define SMP_UART_SLIP_ESC_ESC   0xdd
+
+#define SMP_UART_SLIP           MYNEWT_VAL_CHOICE(SMP_UART_FRAMING, slip)
+
 #define NUS_EV_TO_STATE(ptr)                                            \
     (struct smp_uart_state *)((uint8_t *)ptr -                         \
       (int)&(((struct smp_uart_state *)0)->sus_cb_ev))
@@ -56,6 +64,14 @@ struct smp_uart_state {
     struct os_mbuf_pkthdr *sus_rx_pkt;
     struct os_mbuf_pkthdr *sus_rx_q;
     struct os_mbuf_pkthdr *sus_rx;
+#if SMP_UART_SLIP
+    /* Last received character was SMP_UART_SLIP_ESC */
+    uint8_t sus_rx_esc;
+#endif
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+    struct uart_mbuf_txq sus_txq;
+    uint8_t sus_rx_buf[MYNEWT_VAL(SMP_UART_BLOCK_RX_BUF_SIZE)];
+#endif
 };
 
 /**
@@ -74,13 +90,122 @@ smp_uart_mtu(struct os_mbuf *m)
     return MGMT_MAX_MTU;
 }
 
+/**
+ * Computes CRC-16 of the packet and appends it to the end.
+ */
+static int
+smp_uart_crc_append(struct os_mbuf *m)
+{
+    struct os_mbuf *n;
+    uint16_t crc;
+
+    crc = CRC16_INITIAL_CRC;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        crc = crc16_ccitt(crc, n->om_data, n->om_len);
+    }
+    crc = htons(crc);
+
+    return os_mbuf_append(m, &crc, sizeof(crc));
+}
+
+/**
+ * Queues an encoded frame for transmission.
+ */
+static void
+smp_uart_tx_queue(struct smp_uart_state *sus, struct os_mbuf *n)
+{
+#if !MYNEWT_VAL(SMP_UART_BLOCK)
+    int sr;
+#endif
+
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+    uart_mbuf_txq_put(&sus->sus_txq, n);
+#else
+    OS_ENTER_CRITICAL(sr);
+    if (!sus->sus_tx) {
+        sus->sus_tx = n;
+        uart_start_tx(sus->sus_dev);
+    } else {
+        os_mbuf_concat(sus->sus_tx, n);
+    }
+    OS_EXIT_CRITICAL(sr);
+#endif
+}
+
+#if SMP_UART_SLIP
+/**
+ * Called by mgmt to queue packet out to UART.  The packet and its CRC are
+ * sent as a single SLIP frame.  A leading END flushes any line noise the
+ * peer may have received.
+ */
+static int
+smp_uart_out(struct os_mbuf *m)
+{
+    static const uint8_t esc_end[] = {
+        SMP_UART_SLIP_ESC, SMP_UART_SLIP_ESC_END
+    };
+    static const uint8_t esc_esc[] = {
+        SMP_UART_SLIP_ESC, SMP_UART_SLIP_ESC_ESC
+    };
+    static const uint8_t end = SMP_UART_SLIP_END;
+    struct os_mbuf *n;
+    struct os_mbuf *cur;
+    int start;
+    int i;
+
+    n = NULL;
+    if (smp_uart_crc_append(m)) {
+        goto err;
+    }
+
+    n = os_msys_get_pkthdr(0, 0);
+    if (!n || os_mbuf_append(n, &end, 1)) {
+        goto err;
+    }
+
+    for (cur = m; cur; cur = SLIST_NEXT(cur, om_next)) {
+        i = 0;
+        while (i < cur->om_len) {
+            /* Copy runs of ordinary bytes in one go. */
+            start = i;
+            while (i < cur->om_len && cur->om_data[i] != SMP_UART_SLIP_END &&
+                   cur->om_data[i] != SMP_UART_SLIP_ESC) {
+                i++;
+            }
+            if (i > start &&
+                os_mbuf_append(n, cur->om_data + start, i - start)) {
+                goto err;
+            }
+            if (i < cur->om_len) {
+                if (os_mbuf_append(n, cur->om_data[i] == SMP_UART_SLIP_END ?
+                                      esc_end : esc_esc, 2)) {
+                    goto err;
+                }
+                i++;
+            }
+        }
+    }
+
+    if (os_mbuf_append(n, &end, 1)) {
+        goto err;
+    }
+
+    os_mbuf_free_chain(m);
+    smp_uart_tx_queue(&smp_uart_state, n);
+
+    return 0;
+err:
+    os_mbuf_free_chain(m);
+    os_mbuf_free_chain(n);
+    return -1;
+}
+#else
 /**
  * Called by mgmt to queue packet out to UART.
  */
 static int
 smp_uart_out(struct os_mbuf *m)
 {
-    struct smp_uart_state *sus = &smp_uart_state;
     struct os_mbuf_pkthdr *mpkt;
     struct os_mbuf *n;
     uint16_t tmp_buf[6];
@@ -88,7 +213,6 @@ smp_uart_out(struct os_mbuf *m)
     int off;
     int boff;
     int slen;
-    int sr;
     int rc;
     int last;
     int tx_sz;
@@ -96,20 +220,11 @@ smp_uart_out(struct os_mbuf *m)
     assert(OS_MBUF_IS_PKTHDR(m));
     mpkt = OS_MBUF_PKTHDR(m);
 
-    /*
-     * Compute CRC-16 and append it to end.
-     */
+    n = NULL;
     off = 0;
-    tmp_buf[0] = CRC16_INITIAL_CRC;
-    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-        tmp_buf[0] = crc16_ccitt(tmp_buf[0], n->om_data, n->om_len);
-    }
-    tmp_buf[0] = htons(tmp_buf[0]);
-    dst = os_mbuf_extend(m, sizeof(uint16_t));
-    if (!dst) {
+    if (smp_uart_crc_append(m)) {
         goto err;
     }
-    memcpy(dst, tmp_buf, sizeof(uint16_t));
 
     /*
      * Create another mbuf chain with base64 encoded data.
@@ -172,14 +287,7 @@ smp_uart_out(struct os_mbuf *m)
     }
 
     os_mbuf_free_chain(m);
-    OS_ENTER_CRITICAL(sr);
-    if (!sus->sus_tx) {
-        sus->sus_tx = n;
-        uart_start_tx(sus->sus_dev);
-    } else {
-        os_mbuf_concat(sus->sus_tx, n);
-    }
-    OS_EXIT_CRITICAL(sr);
+    smp_uart_tx_queue(&smp_uart_state, n);
 
     return 0;
 err:
@@ -187,6 +295,7 @@ err:
     os_mbuf_free_chain(n);
     return -1;
 }
+#endif
 
 /**
  * Called by UART driver to send out next character.
@@ -225,6 +334,39 @@ smp_uart_tx_char(void *arg)
     return ch;
 }
 
+#if SMP_UART_SLIP
+/**
+ * Checks the CRC of a received frame and passes the packet on.  The CRC
+ * over packet and appended CRC is 0 for an intact frame.
+ */
+static void
+smp_uart_rx_pkt(struct smp_uart_state *sus, struct os_mbuf_pkthdr *rxm)
+{
+    struct os_mbuf *m;
+    struct os_mbuf *n;
+    uint16_t crc;
+
+    m = OS_MBUF_PKTHDR_TO_MBUF(rxm);
+
+    if (rxm->omp_len <= sizeof(crc)) {
+        goto err;
+    }
+
+    crc = CRC16_INITIAL_CRC;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        crc = crc16_ccitt(crc, n->om_data, n->om_len);
+    }
+    if (crc != 0) {
+        goto err;
+    }
+
+    os_mbuf_adj(m, -(int)sizeof(crc));
+    smp_rx_req(&sus->sus_transport, m);
+    return;
+err:
+    os_mbuf_free_chain(m);
+}
+#else
 /**
  * Check for full packet. If frame is not right, free the mbuf.
  */
@@ -297,6 +439,7 @@ smp_uart_rx_pkt(struct smp_uart_state *sus, struct os_mbuf_pkthdr *rxm)
 err:
     os_mbuf_free_chain(m);
 }
+#endif
 
 /**
  * Callback from mgmt task context.
@@ -317,6 +460,69 @@ smp_uart_rx_frame(struct os_event *ev)
     }
 }
 
+#if SMP_UART_SLIP
+/**
+ * Receive a character from UART.  Frames end with SMP_UART_SLIP_END and are
+ * unescaped as they arrive.
+ */
+static int
+smp_uart_rx_char(void *arg, uint8_t data)
+{
+    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
+    struct os_mbuf *m;
+
+    if (data == SMP_UART_SLIP_END) {
+        sus->sus_rx_esc = 0;
+        if (!sus->sus_rx || sus->sus_rx->omp_len == 0) {
+            /* Back-to-back ENDs delimit nothing. */
+            return 0;
+        }
+        if (sus->sus_rx_q) {
+            /* Previous frame not yet processed; drop this one. */
+            os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(sus->sus_rx));
+        } else {
+            sus->sus_rx_q = sus->sus_rx;
+            os_eventq_put(mgmt_evq_get(), &sus->sus_cb_ev);
+        }
+        sus->sus_rx = NULL;
+        return 0;
+    }
+
+    if (sus->sus_rx_esc) {
+        sus->sus_rx_esc = 0;
+        if (data == SMP_UART_SLIP_ESC_END) {
+            data = SMP_UART_SLIP_END;
+        } else if (data == SMP_UART_SLIP_ESC_ESC) {
+            data = SMP_UART_SLIP_ESC;
+        }
+        /* Anything else is kept as is; the CRC check rejects the frame. */
+    } else if (data == SMP_UART_SLIP_ESC) {
+        sus->sus_rx_esc = 1;
+        return 0;
+    }
+
+    if (!sus->sus_rx) {
+        m = os_msys_get_pkthdr(0, 0);
+        if (!m) {
+            return 0;
+        }
+        sus->sus_rx = OS_MBUF_PKTHDR(m);
+    }
+
+    m = OS_MBUF_PKTHDR_TO_MBUF(sus->sus_rx);
+    if (sus->sus_rx->omp_len < MGMT_MAX_MTU + sizeof(uint16_t) &&
+        os_mbuf_append(m, &data, 1) == 0) {
+        return 0;
+    }
+
+    /* Frame too long or out of mbufs; discard what was received. */
+    sus->sus_rx->omp_len = 0;
+    m->om_len = 0;
+    os_mbuf_free_chain(SLIST_NEXT(m, om_next));
+    SLIST_NEXT(m, om_next) = NULL;
+    return 0;
+}
+#else
 /**
  * Receive a character from UART.
  */
@@ -366,6 +572,33 @@ smp_uart_rx_char(void *arg, uint8_t data)
     SLIST_NEXT(m, om_next) = NULL;
     return 0;
 }
+#endif
+
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+/**
+ * Receive a block of data from UART, called from interrupt context.
+ */
+static void
+smp_uart_rx_block(void *arg, const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        smp_uart_rx_char(arg, data[i]);
+    }
+}
+
+/**
+ * Previous block sent out, continue with the rest of queued frames.
+ */
+static void
+smp_uart_tx_block_done(void *arg)
+{
+    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
+
+    uart_mbuf_txq_done(&sus->sus_txq);
+}
+#endif
 
 void
 smp_uart_pkg_init(void)
@@ -380,7 +613,14 @@ smp_uart_pkg_init(void)
         .uc_flow_ctl = UART_FLOW_CTL_NONE,
         .uc_tx_char = smp_uart_tx_char,
         .uc_rx_char = smp_uart_rx_char,
-        .uc_cb_arg = sus
+        .uc_cb_arg = sus,
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+        .uc_rx_block = smp_uart_rx_block,
+        .uc_tx_block_done = smp_uart_tx_block_done,
+        .uc_rx_buf = sus->sus_rx_buf,
+        .uc_rx_buf_size = sizeof(sus->sus_rx_buf),
+        .uc_idle_us = MYNEWT_VAL(SMP_UART_BLOCK_IDLE_US),
+#endif
     };
 
     /* Ensure this function only gets called by sysinit. */
@@ -392,6 +632,9 @@ smp_uart_pkg_init(void)
     sus->sus_dev =
       (struct uart_dev *)os_dev_open(MYNEWT_VAL(SMP_UART), 0, &uc);
     assert(sus->sus_dev);
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+    uart_mbuf_txq_init(&sus->sus_txq, sus->sus_dev);
+#endif
 
     sus->sus_cb_ev.ev_cb = smp_uart_rx_frame;
 }
@@ -19,11 +19,27 @@
 #ifndef __LWIP_LWIPOPTS_H__
 #define __LWIP_LWIPOPTS_H__
 
+#include "syscfg/syscfg.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define MEM_LIBC_MALLOC			1	/* use platform malloc */
+
+#if MYNEWT_VAL(LWIP_MN_MEMP_MSYS)
+#include <stddef.h>
+
+/* Pools and heap come from os_mempools; see lwip_mn/src/lwip_mem.c. */
+#define MEMP_MEM_MALLOC                 1
+#define mem_clib_malloc                 lwip_mn_mem_malloc
+#define mem_clib_calloc                 lwip_mn_mem_calloc
+#define mem_clib_free                   lwip_mn_mem_free
+
+void *lwip_mn_mem_malloc(size_t size);
+void *lwip_mn_mem_calloc(size_t cnt, size_t size);
+void lwip_mn_mem_free(void *ptr);
+#endif
 #define LWIP_NETIF_TX_SINGLE_PBUF 	1
 #define LWIP_NETIF_LOOPBACK		1	/* yes loopback interface */
 
@@ -60,6 +76,11 @@ extern "C" {
 
 #define SYS_LIGHTWEIGHT_PROT            1
 
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+/* Sockets send mbuf data through custom pbufs. */
+#define LWIP_SUPPORT_CUSTOM_PBUF        1
+#endif
+
 #define TCP_LISTEN_BACKLOG     	        (1)
 
 /* ---------- Memory options ---------- */
@@ -103,7 +124,12 @@ extern "C" {
 #endif
 
 /* PBUF_POOL_BUFSIZE: the size of each pbuf in the pbuf pool. */
+#if MYNEWT_VAL(LWIP_MN_MEMP_MSYS)
+/* Leave room for the block and pbuf headers within an msys_1 block. */
+#define PBUF_POOL_BUFSIZE               (MYNEWT_VAL(MSYS_1_BLOCK_SIZE) - 48)
+#else
 #define PBUF_POOL_BUFSIZE               1580
+#endif
 
 /*
  * Disable this; causes excessive stack use in device drivers calling
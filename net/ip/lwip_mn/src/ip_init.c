@@ -24,6 +24,11 @@
 
 int ip_init(void)
 {
+#if MYNEWT_VAL(LWIP_MN_MEMP_MSYS)
+    if (lwip_mem_init()) {
+        return -1;
+    }
+#endif
     if (lwip_socket_init()) {
         return -1;
     }
@@ -34,6 +34,8 @@ void lwip_cli_init(void);
 
 int lwip_err_to_mn_err(int rc);
 
+int lwip_mem_init(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LWIP_MN_MEMP_MSYS)
+
+#include <string.h>
+
+#include <lwip/mem.h>
+
+#include "ip_priv.h"
+
+/*
+ * lwIP heap and pool memory, carved from os_mempools.
+ *
+ * With MEMP_MEM_MALLOC lwIP allocates pool elements (PCBs, pbuf headers,
+ * PBUF_POOL buffers) through mem_malloc(), which in turn uses the
+ * mem_clib_*() hooks set up in lwipopts.h.  Small requests are served
+ * from a dedicated "lwip" mempool, everything else from the msys
+ * mempools, so lwIP and mbuf users share the same headroom and all of
+ * it shows up in the mempool statistics.
+ *
+ * Each block starts with a pointer to the mempool it came from.
+ */
+#define LWIP_MEM_HDR_SZ     LWIP_MEM_ALIGN_SIZE(sizeof(struct os_mempool *))
+
+#define LWIP_MEM_SMALL_SZ   \
+    (LWIP_MEM_HDR_SZ + MYNEWT_VAL(LWIP_MN_MEM_SMALL_SIZE))
+#define LWIP_MEM_SMALL_CNT  MYNEWT_VAL(LWIP_MN_MEM_SMALL_CNT)
+
+#if LWIP_MEM_SMALL_CNT > 0
+static os_membuf_t lwip_mem_small_data[
+    OS_MEMPOOL_SIZE(LWIP_MEM_SMALL_CNT, LWIP_MEM_SMALL_SZ)];
+static struct os_mempool lwip_mem_small;
+#endif
+
+static void *
+lwip_mem_get(struct os_mempool *mp)
+{
+    struct os_mempool **hdr;
+
+    hdr = os_memblock_get(mp);
+    if (!hdr) {
+        return NULL;
+    }
+    *hdr = mp;
+
+    return (uint8_t *)hdr + LWIP_MEM_HDR_SZ;
+}
+
+void *
+lwip_mn_mem_malloc(size_t size)
+{
+    struct os_mbuf_pool *omp;
+    void *ptr;
+
+    size += LWIP_MEM_HDR_SZ;
+
+#if LWIP_MEM_SMALL_CNT > 0
+    if (size <= lwip_mem_small.mp_block_size) {
+        ptr = lwip_mem_get(&lwip_mem_small);
+        if (ptr) {
+            return ptr;
+        }
+    }
+#endif
+
+    /* msys pools are ordered by size; use the first fit with room. */
+    omp = NULL;
+    while ((omp = os_msys_pool_get_next(omp)) != NULL) {
+        if (size > omp->omp_pool->mp_block_size) {
+            continue;
+        }
+        ptr = lwip_mem_get(omp->omp_pool);
+        if (ptr) {
+            return ptr;
+        }
+    }
+
+    return NULL;
+}
+
+void *
+lwip_mn_mem_calloc(size_t cnt, size_t size)
+{
+    void *ptr;
+
+    ptr = lwip_mn_mem_malloc(cnt * size);
+    if (ptr) {
+        memset(ptr, 0, cnt * size);
+    }
+    return ptr;
+}
+
+void
+lwip_mn_mem_free(void *ptr)
+{
+    struct os_mempool **hdr;
+    int rc;
+
+    if (!ptr) {
+        return;
+    }
+    hdr = (struct os_mempool **)((uint8_t *)ptr - LWIP_MEM_HDR_SZ);
+    rc = os_memblock_put(*hdr, hdr);
+    assert(rc == 0);
+}
+
+int
+lwip_mem_init(void)
+{
+#if LWIP_MEM_SMALL_CNT > 0
+    int rc;
+
+    rc = os_mempool_init(&lwip_mem_small, LWIP_MEM_SMALL_CNT,
+                         LWIP_MEM_SMALL_SZ, lwip_mem_small_data, "lwip");
+    if (rc) {
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(LWIP_MN_MEMP_MSYS) */
@@ -82,6 +82,24 @@ struct lwip_sock {
 
 static struct os_mempool lwip_sockets;
 
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "LWIP_MN_ZERO_COPY requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+/*
+ * pbuf lending one mbuf of an outgoing chain to lwIP.  The mbuf is freed
+ * when lwIP drops the last reference to the pbuf.
+ */
+struct lwip_mbuf_pbuf {
+    struct pbuf_custom lmp_pc;
+    struct os_mbuf *lmp_om;
+};
+
+static struct os_mempool lwip_rx_exts;
+static struct os_mempool lwip_tx_pbufs;
+#endif
+
 static int lwip_stream_tx(struct lwip_sock *s, int notify);
 
 static int
@@ -177,6 +195,99 @@ lwip_err_to_mn_err(int rc)
     }
 }
 
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+static void
+lwip_pbuf_ext_free(struct os_mbuf_ext *ext)
+{
+    pbuf_free(ext->ome_arg);
+    os_memblock_put(&lwip_rx_exts, ext);
+}
+
+/*
+ * Wraps every segment of pbuf chain in an external mbuf.  The pbuf is
+ * released when the last of these mbufs is freed.
+ */
+static struct os_mbuf *
+lwip_pbuf_wrap(struct pbuf *p, uint8_t usrhdr_len)
+{
+    struct os_mbuf_ext *ext;
+    struct os_mbuf *m;
+    struct os_mbuf *n;
+    struct pbuf *q;
+
+    ext = os_memblock_get(&lwip_rx_exts);
+    if (!ext) {
+        return NULL;
+    }
+    os_mbuf_ext_init(ext, lwip_pbuf_ext_free, p);
+
+    m = os_msys_get_pkthdr(0, usrhdr_len);
+    if (!m) {
+        os_memblock_put(&lwip_rx_exts, ext);
+        return NULL;
+    }
+    if (os_mbuf_ext_attach(m, ext, p->payload, p->len)) {
+        os_mbuf_free(m);
+        os_memblock_put(&lwip_rx_exts, ext);
+        return NULL;
+    }
+    for (q = p->next; q; q = q->next) {
+        if (q->len == 0) {
+            continue;
+        }
+        n = os_msys_get(0, 0);
+        if (!n) {
+            goto err;
+        }
+        if (os_mbuf_ext_attach(n, ext, q->payload, q->len)) {
+            os_mbuf_free(n);
+            goto err;
+        }
+        os_mbuf_concat(m, n);
+    }
+    return m;
+err:
+    /*
+     * Freeing the chain drops a reference to the pbuf, which stays with
+     * the caller.
+     */
+    pbuf_ref(p);
+    os_mbuf_free_chain(m);
+    return NULL;
+}
+#endif
+
+/*
+ * Converts received pbuf chain to an mbuf chain with a user header of
+ * usrhdr_len bytes.  On success the pbuf is consumed; on failure it is
+ * left to the caller.
+ */
+static struct os_mbuf *
+lwip_pbuf_to_mbuf(struct pbuf *p, uint8_t usrhdr_len)
+{
+    struct os_mbuf *m;
+    struct pbuf *q;
+
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+    m = lwip_pbuf_wrap(p, usrhdr_len);
+    if (m) {
+        return m;
+    }
+#endif
+    m = os_msys_get_pkthdr(p->tot_len, usrhdr_len);
+    if (!m) {
+        return NULL;
+    }
+    for (q = p; q; q = q->next) {
+        if (os_mbuf_append(m, q->payload, q->len)) {
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+    }
+    pbuf_free(p);
+    return m;
+}
+
 #if LWIP_UDP
 static void
 lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
@@ -184,21 +295,14 @@ lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
-    m = os_msys_get_pkthdr(p->tot_len, sizeof(struct mn_sockaddr_in6));
+    m = lwip_pbuf_to_mbuf(p, sizeof(struct mn_sockaddr_in6));
     if (!m) {
         pbuf_free(p);
         return;
     }
     lwip_addr_to_mn_addr((struct mn_sockaddr *)OS_MBUF_USRHDR(m),
       addr, port);
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
-    }
-    pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 }
@@ -210,8 +314,6 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
     if (!p) {
         /*
@@ -220,14 +322,13 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
         mn_socket_readable(&s->ls_sock, MN_ECONNABORTED);
         return ERR_OK;
     }
-    m = os_msys_get_pkthdr(p->tot_len, 0);
-    assert(m);
-    /* XXX fix this */
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
+    m = lwip_pbuf_to_mbuf(p, 0);
+    if (!m) {
+        /*
+         * lwIP holds on to the data and delivers it again later.
+         */
+        return ERR_MEM;
     }
-    pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 
@@ -470,7 +571,8 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
     while (s->ls_tx && rc == 0) {
         m = s->ls_tx;
         n = SLIST_NEXT(m, om_next);
-        rc = tcp_write(s->ls_pcb.tcp, m->om_data, m->om_len, 0);
+        rc = tcp_write(s->ls_pcb.tcp, m->om_data, m->om_len,
+                       TCP_WRITE_FLAG_COPY);
         if (rc == 0) {
             s->ls_tx = n;
             os_mbuf_free(m);
@@ -493,16 +595,128 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
     return rc;
 }
 
+#if LWIP_UDP
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+static void
+lwip_mbuf_pbuf_free(struct pbuf *p)
+{
+    struct lwip_mbuf_pbuf *lmp = (struct lwip_mbuf_pbuf *)p;
+
+    if (lmp->lmp_om) {
+        os_mbuf_free(lmp->lmp_om);
+    }
+    os_memblock_put(&lwip_tx_pbufs, lmp);
+}
+
+/*
+ * Builds a pbuf chain referencing the data of mbuf chain m.  The mbufs
+ * remain owned by the caller until handed over with lwip_mbuf_pbuf_give().
+ */
+static struct pbuf *
+lwip_mbuf_pbuf_chain(struct os_mbuf *m)
+{
+    struct lwip_mbuf_pbuf *lmp;
+    struct os_mbuf *n;
+    struct pbuf *p;
+    struct pbuf *q;
+
+    p = NULL;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        if (n->om_len == 0) {
+            continue;
+        }
+        lmp = os_memblock_get(&lwip_tx_pbufs);
+        if (!lmp) {
+            goto err;
+        }
+        lmp->lmp_om = NULL;
+        lmp->lmp_pc.custom_free_function = lwip_mbuf_pbuf_free;
+        q = pbuf_alloced_custom(PBUF_RAW, n->om_len, PBUF_ROM, &lmp->lmp_pc,
+                                n->om_data, n->om_len);
+        if (!q) {
+            os_memblock_put(&lwip_tx_pbufs, lmp);
+            goto err;
+        }
+        if (p) {
+            pbuf_cat(p, q);
+        } else {
+            p = q;
+        }
+    }
+    return p;
+err:
+    if (p) {
+        pbuf_free(p);
+    }
+    return NULL;
+}
+
+/*
+ * Passes ownership of mbuf chain m to the pbufs built from it, or frees
+ * it if the data was copied.
+ */
+static void
+lwip_mbuf_pbuf_give(struct pbuf *p, struct os_mbuf *m)
+{
+    struct os_mbuf *n;
+
+    if (!(p->flags & PBUF_FLAG_IS_CUSTOM)) {
+        os_mbuf_free_chain(m);
+        return;
+    }
+    while (m) {
+        n = SLIST_NEXT(m, om_next);
+        SLIST_NEXT(m, om_next) = NULL;
+        if (m->om_len == 0) {
+            os_mbuf_free(m);
+        } else {
+            ((struct lwip_mbuf_pbuf *)p)->lmp_om = m;
+            p = p->next;
+        }
+        m = n;
+    }
+}
+#endif
+
+static struct pbuf *
+lwip_mbuf_to_pbuf(struct os_mbuf *m)
+{
+    struct os_mbuf *n;
+    struct pbuf *p;
+    int off;
+
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+    p = lwip_mbuf_pbuf_chain(m);
+    if (p) {
+        return p;
+    }
+#endif
+    off = 0;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        off += n->om_len;
+    }
+    p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+    if (!p) {
+        return NULL;
+    }
+
+    off = 0;
+    for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+        pbuf_take_at(p, n->om_data, n->om_len, off);
+        off += n->om_len;
+    }
+    return p;
+}
+#endif
+
 static int
 lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
   struct mn_sockaddr *addr)
 {
     struct lwip_sock *s = (struct lwip_sock *)ms;
     struct pbuf *p;
-    struct os_mbuf *n;
     ip_addr_t ip_addr;
     uint16_t port;
-    int off;
     int rc;
 
     switch (s->ls_type) {
@@ -515,20 +729,10 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
         if (rc) {
             return rc;
         }
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            off += n->om_len;
-        }
-        p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+        p = lwip_mbuf_to_pbuf(m);
         if (!p) {
             return MN_ENOBUFS;
         }
-
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            pbuf_take_at(p, n->om_data, n->om_len, off);
-            off += n->om_len;
-        }
         LOCK_TCPIP_CORE();
         rc = udp_sendto(s->ls_pcb.udp, p, &ip_addr, port);
         UNLOCK_TCPIP_CORE();
@@ -537,7 +741,11 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
             pbuf_free(p);
             return rc;
         }
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+        lwip_mbuf_pbuf_give(p, m);
+#else
         os_mbuf_free_chain(m);
+#endif
         pbuf_free(p);
         return 0;
 #endif
@@ -743,6 +951,24 @@ lwip_socket_init(void)
     }
     os_mempool_init(&lwip_sockets, cnt, sizeof(struct lwip_sock), mem, "sock");
 
+#if MYNEWT_VAL(LWIP_MN_ZERO_COPY)
+    cnt = MYNEWT_VAL(LWIP_MN_ZERO_COPY_RX_CNT);
+    mem = os_malloc(OS_MEMPOOL_BYTES(cnt, sizeof(struct os_mbuf_ext)));
+    if (!mem) {
+        return -1;
+    }
+    os_mempool_init(&lwip_rx_exts, cnt, sizeof(struct os_mbuf_ext), mem,
+                    "sock_rx");
+
+    cnt = MYNEWT_VAL(LWIP_MN_ZERO_COPY_TX_CNT);
+    mem = os_malloc(OS_MEMPOOL_BYTES(cnt, sizeof(struct lwip_mbuf_pbuf)));
+    if (!mem) {
+        return -1;
+    }
+    os_mempool_init(&lwip_tx_pbufs, cnt, sizeof(struct lwip_mbuf_pbuf), mem,
+                    "sock_tx");
+#endif
+
     rc = mn_socket_ops_reg(&lwip_sock_ops);
     if (rc) {
         return -1;
@@ -20,6 +20,10 @@
 #define __SYS_MN_SOCKET_H_
 
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+#include "os/mynewt.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -75,12 +79,16 @@ extern "C" {
 struct mn_socket;
 struct mn_socket_ops;
 struct mn_sock_cb;
+struct mn_poll_ent;
 struct os_mbuf;
 
 struct mn_socket {
     const union mn_socket_cb *ms_cbs;          /* filled in by user */
     void *ms_cb_arg;                           /* filled in by user */
     const struct mn_socket_ops *ms_ops;        /* filled in by mn_socket */
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    struct mn_poll_ent *ms_poll;               /* filled in by mn_poll_add */
+#endif
 };
 
 /*
@@ -190,6 +198,94 @@ int mn_close(struct mn_socket *);
         (sock)->ms_cb_arg = (cb_arg);                                   \
     } while (0)
 
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+/*
+ * Readiness sets.
+ *
+ * Sockets added to a poll set report readiness to it, in addition to their
+ * own callbacks.  Reporting is edge triggered: an event is recorded when
+ * the socket provider signals it, i.e. when data arrives or send space
+ * becomes available.  Events accumulate on the socket until harvested with
+ * mn_poll_get(); the first one queues the socket on the set's ready list,
+ * and when that list becomes non-empty the set's event is posted to its
+ * event queue.  The handler then harvests the ready sockets in batches, and
+ * should drain each of them, as no further event is reported until new
+ * data arrives.
+ *
+ * Listen sockets keep using the newconn callback.  Poll set functions
+ * must be called from one task; notifications may come from any.
+ */
+#define MN_POLL_IN              0x01    /* data or close pending */
+#define MN_POLL_OUT             0x02    /* connected or send space */
+#define MN_POLL_ERR             0x04    /* error; always reported */
+
+struct mn_poll;
+
+/*
+ * Per socket registration in a poll set; memory owned by the caller.
+ */
+struct mn_poll_ent {
+    struct mn_poll *mpe_poll;
+    struct mn_socket *mpe_sock;
+    void *mpe_arg;
+    STAILQ_ENTRY(mn_poll_ent) mpe_next;
+    uint8_t mpe_events;                 /* interest mask */
+    uint8_t mpe_revents;                /* pending events */
+    uint8_t mpe_queued:1;               /* on ready list */
+    int mpe_err;                        /* error of last MN_POLL_ERR */
+};
+
+struct mn_poll {
+    struct os_eventq *mp_evq;
+    struct os_event mp_ev;
+    STAILQ_HEAD(, mn_poll_ent) mp_ready;
+};
+
+/*
+ * Result of mn_poll_get().
+ */
+struct mn_poll_ready {
+    struct mn_socket *mpr_sock;
+    void *mpr_arg;                      /* as passed to mn_poll_add() */
+    uint8_t mpr_events;
+    int mpr_err;
+};
+
+/*
+ * Initialize a poll set, which posts an event with handler fn and
+ * argument arg to evq whenever sockets become ready.
+ */
+void mn_poll_init(struct mn_poll *mp, struct os_eventq *evq,
+  os_event_fn *fn, void *arg);
+
+/*
+ * Add socket s to poll set mp with interest mask events.  A socket can
+ * be in one set at a time.  mn_close() removes the socket from its set.
+ *
+ * @return 0 on success, MN_EADDRINUSE if the socket is already in a set.
+ */
+int mn_poll_add(struct mn_poll *mp, struct mn_poll_ent *ent,
+  struct mn_socket *s, uint8_t events, void *arg);
+
+/*
+ * Change interest mask of a socket.  Already pending events are kept.
+ */
+void mn_poll_mod(struct mn_poll_ent *ent, uint8_t events);
+
+/*
+ * Remove socket from its poll set, discarding pending events.
+ */
+void mn_poll_del(struct mn_poll_ent *ent);
+
+/*
+ * Harvest up to max ready sockets into out; their pending events are
+ * cleared.  Sockets left over stay queued, and the event is posted again.
+ *
+ * @return Number of entries filled in.
+ */
+int mn_poll_get(struct mn_poll *mp, struct mn_poll_ready *out, int max);
+#endif
+
 /*
  * Address conversion
  */
@@ -20,6 +20,7 @@
 #define __SYS_MN_SOCKET_OPS_H_
 
 #include <inttypes.h>
+#include "mn_socket/mn_socket.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,9 +61,18 @@ struct mn_socket_ops {
 
 int mn_socket_ops_reg(const struct mn_socket_ops *ops);
 
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+void mn_poll_notify(struct mn_socket *s, uint8_t events, int error);
+#endif
+
 static inline void
 mn_socket_writable(struct mn_socket *s, int error)
 {
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    if (s->ms_poll) {
+        mn_poll_notify(s, MN_POLL_OUT, error);
+    }
+#endif
     if (s->ms_cbs && s->ms_cbs->socket.writable) {
         s->ms_cbs->socket.writable(s->ms_cb_arg, error);
     }
@@ -71,6 +81,11 @@ mn_socket_writable(struct mn_socket *s, int error)
 static inline void
 mn_socket_readable(struct mn_socket *s, int error)
 {
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    if (s->ms_poll) {
+        mn_poll_notify(s, MN_POLL_IN, error);
+    }
+#endif
     if (s->ms_cbs && s->ms_cbs->socket.readable) {
         s->ms_cbs->socket.readable(s->ms_cb_arg, error);
     }
@@ -79,6 +94,9 @@ mn_socket_readable(struct mn_socket *s, int error)
 static inline int
 mn_socket_newconn(struct mn_socket *s, struct mn_socket *new)
 {
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    new->ms_poll = NULL;
+#endif
     if (s->ms_cbs && s->ms_cbs->listen.newconn) {
         return s->ms_cbs->listen.newconn(s->ms_cb_arg, new);
     } else {
@@ -38,5 +38,6 @@ void sock_itf_list(void);
 void sock_udp_ll(void);
 void sock_udp_mcast_v4(void);
 void sock_udp_mcast_v6(void);
+void sock_udp_poll(void);
 
 #endif /* _MN_SOCK_TEST_H */
@@ -792,6 +792,98 @@ sock_udp_mcast_v6(void)
     mn_close(tx_sock);
 }
 
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+static void
+sup_poll_ev(struct os_event *ev)
+{
+}
+
+void
+sock_udp_poll(void)
+{
+    static const union mn_socket_cb sock_cbs;
+    struct mn_socket *rx_sock[2];
+    struct mn_socket *tx_sock;
+    struct mn_sockaddr_in msin;
+    struct os_eventq evq;
+    struct os_eventq *evqp;
+    struct os_event *ev;
+    struct mn_poll mp;
+    struct mn_poll_ent ent[2];
+    struct mn_poll_ready ready[2];
+    struct os_mbuf *m;
+    char data[] = "1234567890";
+    int seen;
+    int rc;
+    int i;
+
+    os_eventq_init(&evq);
+    evqp = &evq;
+    mn_poll_init(&mp, &evq, sup_poll_ev, NULL);
+
+    rc = mn_socket(&tx_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+    mn_socket_set_cbs(tx_sock, NULL, &sock_cbs);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    for (i = 0; i < 2; i++) {
+        rc = mn_socket(&rx_sock[i], MN_PF_INET, MN_SOCK_DGRAM, 0);
+        TEST_ASSERT(rc == 0);
+        mn_socket_set_cbs(rx_sock[i], NULL, &sock_cbs);
+        msin.msin_port = htons(12446 + i);
+        rc = mn_bind(rx_sock[i], (struct mn_sockaddr *)&msin);
+        TEST_ASSERT(rc == 0);
+        rc = mn_poll_add(&mp, &ent[i], rx_sock[i], MN_POLL_IN, &ent[i]);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = mn_poll_add(&mp, &ent[1], rx_sock[1], MN_POLL_IN, NULL);
+    TEST_ASSERT(rc == MN_EADDRINUSE);
+
+    for (i = 0; i < 2; i++) {
+        m = os_msys_get(sizeof(data), 0);
+        TEST_ASSERT_FATAL(m);
+        rc = os_mbuf_copyinto(m, 0, data, sizeof(data));
+        TEST_ASSERT(rc == 0);
+        msin.msin_port = htons(12446 + i);
+        rc = mn_sendto(tx_sock, m, (struct mn_sockaddr *)&msin);
+        TEST_ASSERT(rc == 0);
+    }
+
+    /*
+     * Both sockets are reported through the one poll set.
+     */
+    seen = 0;
+    while (seen != 3) {
+        ev = os_eventq_poll(&evqp, 1, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(ev == &mp.mp_ev);
+        rc = mn_poll_get(&mp, ready, 2);
+        for (i = 0; i < rc; i++) {
+            TEST_ASSERT(ready[i].mpr_events == MN_POLL_IN);
+            TEST_ASSERT(ready[i].mpr_arg == &ent[0] ||
+                        ready[i].mpr_arg == &ent[1]);
+            seen |= 1 << (ready[i].mpr_sock == rx_sock[1]);
+            rc = mn_recvfrom(ready[i].mpr_sock, &m, NULL);
+            TEST_ASSERT(rc == 0);
+            os_mbuf_free_chain(m);
+        }
+    }
+
+    /*
+     * Edge triggered; nothing more until new data arrives.
+     */
+    TEST_ASSERT(mn_poll_get(&mp, ready, 2) == 0);
+    ev = os_eventq_poll(&evqp, 1, OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(ev == NULL);
+
+    mn_close(rx_sock[0]);
+    mn_close(rx_sock[1]);
+    mn_close(tx_sock);
+}
+#endif
+
 void
 mn_socket_test_handler(void *arg)
 {
@@ -804,5 +896,8 @@ mn_socket_test_handler(void *arg)
     sock_udp_ll();
     sock_udp_mcast_v4();
     sock_udp_mcast_v6();
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    sock_udp_poll();
+#endif
     tu_restart();
 }
@@ -32,4 +32,7 @@ TEST_CASE_TASK(socket_tests)
     sock_udp_ll();
     sock_udp_mcast_v4();
     sock_udp_mcast_v6();
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    sock_udp_poll();
+#endif
 }
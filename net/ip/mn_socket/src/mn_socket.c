@@ -62,6 +62,9 @@ mn_socket(struct mn_socket **sp, uint8_t domain, uint8_t type, uint8_t proto)
     rc = mn_sock_tgt->mso_create(sp, domain, type, proto);
     if (*sp) {
         (*sp)->ms_ops = mn_sock_tgt;
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+        (*sp)->ms_poll = NULL;
+#endif
     }
     return rc;
 }
@@ -123,9 +126,134 @@ mn_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 int
 mn_close(struct mn_socket *s)
 {
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+    if (s->ms_poll) {
+        mn_poll_del(s->ms_poll);
+    }
+#endif
     return s->ms_ops->mso_close(s);
 }
 
+#if MYNEWT_VAL(MN_SOCKET_POLL)
+void
+mn_poll_init(struct mn_poll *mp, struct os_eventq *evq, os_event_fn *fn,
+  void *arg)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->mp_evq = evq;
+    mp->mp_ev.ev_cb = fn;
+    mp->mp_ev.ev_arg = arg;
+    STAILQ_INIT(&mp->mp_ready);
+}
+
+int
+mn_poll_add(struct mn_poll *mp, struct mn_poll_ent *ent, struct mn_socket *s,
+  uint8_t events, void *arg)
+{
+    os_sr_t sr;
+
+    if (s->ms_poll) {
+        return MN_EADDRINUSE;
+    }
+    memset(ent, 0, sizeof(*ent));
+    ent->mpe_poll = mp;
+    ent->mpe_sock = s;
+    ent->mpe_arg = arg;
+    ent->mpe_events = events;
+
+    OS_ENTER_CRITICAL(sr);
+    s->ms_poll = ent;
+    OS_EXIT_CRITICAL(sr);
+    return 0;
+}
+
+void
+mn_poll_mod(struct mn_poll_ent *ent, uint8_t events)
+{
+    ent->mpe_events = events;
+}
+
+void
+mn_poll_del(struct mn_poll_ent *ent)
+{
+    struct mn_poll *mp = ent->mpe_poll;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    ent->mpe_sock->ms_poll = NULL;
+    if (ent->mpe_queued) {
+        STAILQ_REMOVE(&mp->mp_ready, ent, mn_poll_ent, mpe_next);
+        ent->mpe_queued = 0;
+    }
+    ent->mpe_revents = 0;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+mn_poll_notify(struct mn_socket *s, uint8_t events, int error)
+{
+    struct mn_poll_ent *ent;
+    struct mn_poll *mp;
+    int post;
+    os_sr_t sr;
+
+    post = 0;
+    OS_ENTER_CRITICAL(sr);
+    ent = s->ms_poll;
+    if (!ent) {
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    mp = ent->mpe_poll;
+    if (error) {
+        events |= MN_POLL_ERR;
+        ent->mpe_err = error;
+    }
+    events &= ent->mpe_events | MN_POLL_ERR;
+    if (events) {
+        ent->mpe_revents |= events;
+        if (!ent->mpe_queued) {
+            ent->mpe_queued = 1;
+            post = STAILQ_EMPTY(&mp->mp_ready);
+            STAILQ_INSERT_TAIL(&mp->mp_ready, ent, mpe_next);
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (post) {
+        os_eventq_put(mp->mp_evq, &mp->mp_ev);
+    }
+}
+
+int
+mn_poll_get(struct mn_poll *mp, struct mn_poll_ready *out, int max)
+{
+    struct mn_poll_ent *ent;
+    int cnt;
+    os_sr_t sr;
+
+    cnt = 0;
+    OS_ENTER_CRITICAL(sr);
+    while (cnt < max && (ent = STAILQ_FIRST(&mp->mp_ready))) {
+        STAILQ_REMOVE_HEAD(&mp->mp_ready, mpe_next);
+        ent->mpe_queued = 0;
+        out[cnt].mpr_sock = ent->mpe_sock;
+        out[cnt].mpr_arg = ent->mpe_arg;
+        out[cnt].mpr_events = ent->mpe_revents;
+        out[cnt].mpr_err = ent->mpe_err;
+        ent->mpe_revents = 0;
+        ent->mpe_err = 0;
+        cnt++;
+    }
+    if (!STAILQ_EMPTY(&mp->mp_ready)) {
+        os_eventq_put(mp->mp_evq, &mp->mp_ev);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return cnt;
+}
+#endif
+
 int
 mn_itf_getnext(struct mn_itf *mi)
 {
@@ -37,12 +37,35 @@
 
 #include "native_sock_priv.h"
 
+/*
+ * Readiness backend: poll() over all sockets, or the host's event
+ * notification API, which only reports sockets that are ready.
+ */
+#if MYNEWT_VAL(NATIVE_SOCKETS_EVENTS) && defined(__linux__)
+#define NATIVE_SOCK_EPOLL       1
+#include <sys/epoll.h>
+#elif MYNEWT_VAL(NATIVE_SOCKETS_EVENTS) && \
+      (defined(__APPLE__) || defined(__FreeBSD__))
+#define NATIVE_SOCK_KQUEUE      1
+#include <sys/event.h>
+#elif MYNEWT_VAL(NATIVE_SOCKETS_EVENTS)
+#error "NATIVE_SOCKETS_EVENTS needs epoll or kqueue"
+#endif
+
+#if defined(NATIVE_SOCK_EPOLL) || defined(NATIVE_SOCK_KQUEUE)
+#define NATIVE_SOCK_EVENTS      1
+#define NATIVE_SOCK_READY_MAX   MYNEWT_VAL(NATIVE_SOCKETS_EVENT_BATCH)
+#else
+#define NATIVE_SOCK_READY_MAX   MYNEWT_VAL(NATIVE_SOCKETS_MAX)
+#endif
+
 static struct native_sock {
     struct mn_socket ns_sock;
     int ns_fd;
     unsigned int ns_connect:1;  /* Non-blocking connect in progress. */
     unsigned int ns_poll:1;
     unsigned int ns_listen:1;
+    unsigned int ns_out:1;      /* Registered for writability. */
     uint8_t ns_type;
     uint8_t ns_pf;
     struct os_sem ns_sem;
@@ -50,9 +73,20 @@ static struct native_sock {
     struct os_mbuf *ns_tx;
 } native_socks[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
 
+/* A socket reported ready, with POLLIN and/or POLLOUT in nr_events. */
+struct native_sock_ready {
+    struct native_sock *nr_ns;
+    int nr_events;
+};
+
 static struct native_sock_state {
+#if NATIVE_SOCK_EVENTS
+    int ev_fd;
+#else
     struct pollfd poll_fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
     int poll_fd_cnt;
+#endif
+    struct native_sock_ready ready[NATIVE_SOCK_READY_MAX];
     struct os_mutex mtx;
     struct os_task task;
 } native_sock_state;
@@ -89,6 +123,7 @@ native_get_sock(void)
             ns = &native_socks[i];
             ns->ns_poll = 0;
             ns->ns_listen = 0;
+            ns->ns_out = 0;
             return ns;
         }
     }
@@ -108,6 +143,156 @@ native_find_sock(int fd)
     return NULL;
 }
 
+#if NATIVE_SOCK_EVENTS
+/*
+ * Writability is only of interest while a connect or a write is pending;
+ * with edge-free reporting a connected socket would otherwise be reported
+ * on every wait.
+ */
+static int
+native_sock_wants_out(struct native_sock *ns)
+{
+    return ns->ns_connect || (ns->ns_type == SOCK_STREAM && ns->ns_tx);
+}
+
+#if NATIVE_SOCK_EPOLL
+static void
+native_sock_ev_ctl(struct native_sock_state *nss, struct native_sock *ns,
+                   int op, int out)
+{
+    struct epoll_event ev = {
+        .events = EPOLLIN | (out ? EPOLLOUT : 0),
+        .data.ptr = ns,
+    };
+    int rc;
+
+    rc = epoll_ctl(nss->ev_fd, op, ns->ns_fd, &ev);
+    assert(rc == 0);
+    ns->ns_out = out;
+}
+
+static int
+native_sock_ev_wait(struct native_sock_state *nss)
+{
+    struct epoll_event evs[NATIVE_SOCK_READY_MAX];
+    int cnt;
+    int i;
+
+    cnt = epoll_wait(nss->ev_fd, evs, NATIVE_SOCK_READY_MAX, 0);
+    for (i = 0; i < cnt; i++) {
+        nss->ready[i].nr_ns = evs[i].data.ptr;
+        nss->ready[i].nr_events = 0;
+        if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            nss->ready[i].nr_events |= POLLIN;
+        }
+        if (evs[i].events & EPOLLOUT) {
+            nss->ready[i].nr_events |= POLLOUT;
+        }
+    }
+
+    return cnt < 0 ? 0 : cnt;
+}
+#else
+static void
+native_sock_ev_ctl(struct native_sock_state *nss, struct native_sock *ns,
+                   int add, int out)
+{
+    struct kevent kevs[2];
+    int cnt;
+    int rc;
+
+    cnt = 0;
+    if (add) {
+        EV_SET(&kevs[cnt++], ns->ns_fd, EVFILT_READ, EV_ADD, 0, 0, ns);
+    }
+    if (out != ns->ns_out) {
+        EV_SET(&kevs[cnt++], ns->ns_fd, EVFILT_WRITE,
+               out ? EV_ADD : EV_DELETE, 0, 0, ns);
+    }
+    if (cnt) {
+        rc = kevent(nss->ev_fd, kevs, cnt, NULL, 0, NULL);
+        assert(rc == 0);
+    }
+    ns->ns_out = out;
+}
+
+static int
+native_sock_ev_wait(struct native_sock_state *nss)
+{
+    static const struct timespec zero;
+    struct kevent kevs[NATIVE_SOCK_READY_MAX];
+    int cnt;
+    int i;
+
+    cnt = kevent(nss->ev_fd, NULL, 0, kevs, NATIVE_SOCK_READY_MAX, &zero);
+    for (i = 0; i < cnt; i++) {
+        nss->ready[i].nr_ns = kevs[i].udata;
+        if (kevs[i].filter == EVFILT_WRITE) {
+            nss->ready[i].nr_events = POLLOUT;
+        } else {
+            nss->ready[i].nr_events = POLLIN;
+        }
+    }
+
+    return cnt < 0 ? 0 : cnt;
+}
+
+#define EPOLL_CTL_ADD   1
+#define EPOLL_CTL_MOD   0
+#endif
+
+/*
+ * Starts reporting readiness of a socket.
+ */
+static void
+native_sock_poll_set(struct native_sock_state *nss, struct native_sock *ns)
+{
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    native_sock_ev_ctl(nss, ns, ns->ns_poll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                       native_sock_wants_out(ns));
+    ns->ns_poll = 1;
+    os_mutex_release(&nss->mtx);
+}
+
+/*
+ * Stops reporting readiness of a socket.  Closing the descriptor removes
+ * it from the event set as well.
+ */
+static void
+native_sock_poll_clear(struct native_sock_state *nss, struct native_sock *ns)
+{
+#if NATIVE_SOCK_EPOLL
+    struct epoll_event ev;
+#endif
+
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    if (ns->ns_poll && ns->ns_fd >= 0) {
+#if NATIVE_SOCK_EPOLL
+        epoll_ctl(nss->ev_fd, EPOLL_CTL_DEL, ns->ns_fd, &ev);
+#else
+        struct kevent kevs[2];
+
+        EV_SET(&kevs[0], ns->ns_fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+        EV_SET(&kevs[1], ns->ns_fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+        kevent(nss->ev_fd, kevs, ns->ns_out ? 2 : 1, NULL, 0, NULL);
+#endif
+    }
+    ns->ns_poll = 0;
+    ns->ns_out = 0;
+    os_mutex_release(&nss->mtx);
+}
+
+/*
+ * Updates writability interest after a connect or write state change.
+ */
+static void
+native_sock_poll_update(struct native_sock_state *nss, struct native_sock *ns)
+{
+    if (ns->ns_poll && ns->ns_out != native_sock_wants_out(ns)) {
+        native_sock_ev_ctl(nss, ns, EPOLL_CTL_MOD, !ns->ns_out);
+    }
+}
+#else
 static void
 native_sock_poll_rebuild(struct native_sock_state *nss)
 {
@@ -133,6 +318,57 @@ native_sock_poll_rebuild(struct native_sock_state *nss)
     os_mutex_release(&nss->mtx);
 }
 
+static void
+native_sock_poll_set(struct native_sock_state *nss, struct native_sock *ns)
+{
+    ns->ns_poll = 1;
+    native_sock_poll_rebuild(nss);
+}
+
+static void
+native_sock_poll_clear(struct native_sock_state *nss, struct native_sock *ns)
+{
+    ns->ns_poll = 0;
+    native_sock_poll_rebuild(nss);
+}
+
+static void
+native_sock_poll_update(struct native_sock_state *nss, struct native_sock *ns)
+{
+    /* poll() always asks for writability. */
+}
+
+static int
+native_sock_ev_wait(struct native_sock_state *nss)
+{
+    int cnt;
+    int rc;
+    int i;
+
+    if (nss->poll_fd_cnt == 0) {
+        return 0;
+    }
+    rc = poll(nss->poll_fds, nss->poll_fd_cnt, 0);
+    if (rc <= 0) {
+        return 0;
+    }
+
+    cnt = 0;
+    for (i = 0; i < nss->poll_fd_cnt; i++) {
+        if (nss->poll_fds[i].revents == 0) {
+            continue;
+        }
+        nss->ready[cnt].nr_ns = native_find_sock(nss->poll_fds[i].fd);
+        assert(nss->ready[cnt].nr_ns);
+        nss->ready[cnt].nr_events = nss->poll_fds[i].revents;
+        nss->poll_fds[i].revents = 0;
+        cnt++;
+    }
+
+    return cnt;
+}
+#endif
+
 int
 native_sock_err_to_mn_err(int err)
 {
@@ -325,6 +561,7 @@ native_sock_close(struct mn_socket *s)
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
     close(ns->ns_fd);
     ns->ns_fd = -1;
+    ns->ns_connect = 0;
 
     /*
      * When socket is closed, we must free all mbufs which might be
@@ -335,7 +572,8 @@ native_sock_close(struct mn_socket *s)
         os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(m));
     }
     os_mbuf_free_chain(ns->ns_tx);
-    native_sock_poll_rebuild(nss);
+    ns->ns_tx = NULL;
+    native_sock_poll_clear(nss, ns);
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -368,8 +606,7 @@ native_sock_connect(struct mn_socket *s, struct mn_sockaddr *addr)
             return native_sock_err_to_mn_err(rc);
         }
     }
-    ns->ns_poll = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_set(nss, ns);
     os_mutex_release(&nss->mtx);
 
     /* Indicate writability if connection fully established. */
@@ -412,8 +649,7 @@ native_sock_bind(struct mn_socket *s, struct mn_sockaddr *addr)
         goto err;
     }
     if (ns->ns_type == SOCK_DGRAM) {
-        ns->ns_poll = 1;
-        native_sock_poll_rebuild(nss);
+        native_sock_poll_set(nss, ns);
     }
     os_mutex_release(&nss->mtx);
     return 0;
@@ -436,9 +672,8 @@ native_sock_listen(struct mn_socket *s, uint8_t qlen)
         os_mutex_release(&nss->mtx);
         return native_sock_err_to_mn_err(rc);
     }
-    ns->ns_poll = 1;
     ns->ns_listen = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_set(nss, ns);
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -491,6 +726,7 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
             break;
         }
     }
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
     if (notify) {
         mn_socket_writable(&ns->ns_sock, rc);
@@ -584,8 +820,7 @@ native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
         return native_sock_err_to_mn_err(errno);
     }
     if (ns->ns_type == SOCK_STREAM && rc == 0) {
-        ns->ns_poll = 0;
-        native_sock_poll_rebuild(&native_sock_state);
+        native_sock_poll_clear(&native_sock_state, ns);
         return MN_ECONNABORTED;
     }
 
@@ -746,6 +981,7 @@ socket_task(void *arg)
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
     int revents;
+    int cnt;
     int i;
     socklen_t slen;
     int sock_err;
@@ -756,25 +992,15 @@ socket_task(void *arg)
         os_mutex_release(&nss->mtx);
         os_time_delay(os_time_ms_to_ticks32(MYNEWT_VAL(NATIVE_SOCKETS_POLL_INTERVAL_MS)));
         os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-        if (nss->poll_fd_cnt) {
-            rc = poll(nss->poll_fds, nss->poll_fd_cnt, 0);
-        } else {
-            rc = 0;
-        }
-        if (rc == 0) {
-            continue;
-        }
-        for (i = 0; i < nss->poll_fd_cnt; i++) {
-            if (nss->poll_fds[i].revents == 0) {
+        cnt = native_sock_ev_wait(nss);
+        for (i = 0; i < cnt; i++) {
+            ns = nss->ready[i].nr_ns;
+            revents = nss->ready[i].nr_events;
+            if (ns->ns_fd < 0 || !ns->ns_poll) {
+                /* Closed by an earlier upcall in this batch. */
                 continue;
             }
 
-            revents = nss->poll_fds[i].revents;
-            nss->poll_fds[i].revents = 0;
-
-            ns = native_find_sock(nss->poll_fds[i].fd);
-            assert(ns);
-
             if (revents & POLLIN) {
                 if (ns->ns_listen) {
                     new_ns = native_get_sock();
@@ -797,8 +1023,7 @@ socket_task(void *arg)
                          */
                     }
                     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-                    new_ns->ns_poll = 1;
-                    native_sock_poll_rebuild(nss);
+                    native_sock_poll_set(nss, new_ns);
                 } else {
                     mn_socket_readable(&ns->ns_sock, 0);
                 }
@@ -811,6 +1036,7 @@ socket_task(void *arg)
                      * succeeded.
                      */
                     ns->ns_connect = 0;
+                    native_sock_poll_update(nss, ns);
 
                     slen = sizeof(sock_err);
                     rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
@@ -848,6 +1074,16 @@ native_sock_init(void)
         return -1;
     }
     os_mutex_init(&nss->mtx);
+#if NATIVE_SOCK_EPOLL
+    nss->ev_fd = epoll_create1(0);
+#elif NATIVE_SOCK_KQUEUE
+    nss->ev_fd = kqueue();
+#endif
+#if NATIVE_SOCK_EVENTS
+    if (nss->ev_fd < 0) {
+        return -1;
+    }
+#endif
     i = os_task_init(&nss->task, "socket", socket_task, &native_sock_state,
       MYNEWT_VAL(NATIVE_SOCKETS_PRIO), OS_WAIT_FOREVER, sp,
       MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
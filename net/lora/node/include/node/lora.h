@@ -57,6 +57,16 @@ STATS_SECT_START(lora_stats)
 STATS_SECT_END
 extern STATS_SECT_DECL(lora_stats) lora_stats;
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+STATS_SECT_START(lora_tx_sched_stats)
+    STATS_SECT_ENTRY(dc_holds)
+    STATS_SECT_ENTRY(aggr_frames)
+    STATS_SECT_ENTRY(aggr_msgs)
+    STATS_SECT_ENTRY(airtime_ms)
+STATS_SECT_END
+extern STATS_SECT_DECL(lora_tx_sched_stats) lora_tx_sched_stats;
+#endif
+
 /* XXX: for now. Maybe have api to set these? */
 #define LORA_EUI_LEN        (8)
 #define LORA_KEY_LEN        (16)
@@ -183,6 +193,8 @@ struct lora_pkt_info
 {
     uint8_t port;
     uint8_t pkt_type;
+    /* Set if the packet may share a frame with others on its port */
+    uint8_t aggr_ok;
     LoRaMacEventInfoStatus_t status;
 
     union {
@@ -240,6 +252,46 @@ int lora_app_port_close(uint8_t port);
  */
 int lora_app_port_cfg(uint8_t port, uint8_t retries);
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+/**
+ * Allow messages sent on a port to be aggregated. Queued messages with the
+ * same port and packet type are concatenated, in order, into one frame up
+ * to the maximum payload of the current data rate; the receiving
+ * application must be able to split them again (e.g. fixed size records).
+ * Each message still gets its own transmit done callback, all carrying the
+ * status of the shared frame.
+ *
+ * NOTE: The port must be opened or this will return an error
+ *
+ * @param port Port number
+ * @param enable Non-zero to allow aggregation, zero to disallow
+ *
+ * @return int A return code from set of lora return codes
+ */
+int lora_app_port_cfg_aggr(uint8_t port, uint8_t enable);
+
+/* Transmit queue information */
+struct lora_node_txq_info
+{
+    /* Messages and bytes waiting in the transmit queue */
+    uint16_t txq_msgs;
+    uint32_t txq_bytes;
+
+    /* Time (in msecs) until the held queue is retried; 0 if not held */
+    uint32_t hold_ms;
+
+    /* Total time on air of all uplinks (in msecs) */
+    uint32_t airtime_ms;
+};
+
+/**
+ * Report transmit queue depth and airtime used.
+ *
+ * @param info Pointer to where to store the information
+ */
+void lora_node_txq_info(struct lora_node_txq_info *info);
+#endif
+
 /**
  * Send a packet on a port.
  *
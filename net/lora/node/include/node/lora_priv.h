@@ -162,6 +162,22 @@ struct lora_mac_obj
     /* Pointer to current transmit mbuf. Can be NULL and still txing */
     struct os_mbuf *cur_tx_mbuf;
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+    /*
+     * Aggregated frame being transmitted (NULL if none) and the messages
+     * it carries, which are confirmed when the frame is.
+     */
+    struct os_mbuf *lm_aggr_om;
+    STAILQ_HEAD(, os_mbuf_pkthdr) lm_aggr_q;
+
+    /* Time at which a duty-cycle hold of the transmit queue ends */
+    os_time_t lm_hold_end;
+    uint8_t lm_held;
+
+    /* Total time on air of all uplinks (in msecs) */
+    uint32_t lm_airtime_ms;
+#endif
+
     /*!
      * Retransmission timer. This is used for confirmed frames on both class
      * A and C devices and for unconfirmed transmissions on class C devices
@@ -213,6 +229,7 @@ void lora_app_join_confirm(LoRaMacEventInfoStatus_t status, uint8_t attempts);
 void lora_app_link_chk_confirm(LoRaMacEventInfoStatus_t status, uint8_t num_gw,
                                uint8_t demod_margin);
 void lora_node_mcps_request(struct os_mbuf *om);
+void lora_node_mcps_confirm(struct os_mbuf *om);
 void lora_node_mac_mcps_indicate(void);
 int lora_node_join(uint8_t *dev_eui, uint8_t *app_eui, uint8_t *app_key,
                    uint8_t trials);
@@ -223,6 +240,7 @@ void lora_node_chk_txq(void);
 bool lora_node_txq_empty(void);
 bool lora_mac_srv_ack_requested(void);
 uint8_t lora_mac_cmd_buffer_len(void);
+uint32_t lora_mac_dc_time_off(void);
 void lora_node_qual_sample(int16_t rssi, int16_t snr);
 
 /* Lora debug log */
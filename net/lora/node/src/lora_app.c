@@ -36,7 +36,7 @@ struct lora_app_port
     uint8_t port_num;
     uint8_t opened;
     uint8_t retries;
-    uint8_t pad8;
+    uint8_t aggr;
     lora_rxd_func rxd_cb;
     lora_txd_func txd_cb;
 };
@@ -194,6 +194,7 @@ lora_app_port_open(uint8_t port, lora_txd_func txd_cb, lora_rxd_func rxd_cb)
         lora_app_ports[avail].rxd_cb = rxd_cb;
         lora_app_ports[avail].txd_cb = txd_cb;
         lora_app_ports[avail].retries = 8;
+        lora_app_ports[avail].aggr = 0;
         lora_app_ports[avail].opened = 1;
         rc = LORA_APP_STATUS_OK;
     } else {
@@ -258,6 +259,34 @@ lora_app_port_cfg(uint8_t port, uint8_t retries)
     return rc;
 }
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+/**
+ * Allow or disallow aggregation of the messages sent on a port.
+ *
+ * NOTE: The port must be opened or this will return an error
+ *
+ * @param port Port number
+ * @param enable Non-zero to allow aggregation
+ *
+ * @return int A return code from set of lora return codes
+ */
+int
+lora_app_port_cfg_aggr(uint8_t port, uint8_t enable)
+{
+    int rc;
+    struct lora_app_port *lap;
+
+    rc = LORA_APP_STATUS_NO_PORT;
+    lap = lora_app_port_find_open(port);
+    if (lap) {
+        lap->aggr = (enable != 0);
+        rc = LORA_APP_STATUS_OK;
+    }
+
+    return rc;
+}
+#endif
+
 /**
  * Send a packet on a port. If this routine returns an error the "transmitted"
  * callback will NOT be called; it is the callers responsibility to handle the
@@ -294,6 +323,7 @@ lora_app_port_send(uint8_t port, Mcps_t pkt_type, struct os_mbuf *om)
         lpkt->port = port;
         lpkt->pkt_type = pkt_type;
         lpkt->txdinfo.retries = lap->retries;
+        lpkt->aggr_ok = lap->aggr;
         lora_node_mcps_request(om);
         rc = LORA_APP_STATUS_OK;
     } else {
@@ -47,6 +47,16 @@ STATS_NAME_START(lora_mac_stats)
     STATS_NAME(lora_mac_stats, already_joined)
 STATS_NAME_END(lora_mac_stats)
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+STATS_SECT_DECL(lora_tx_sched_stats) lora_tx_sched_stats;
+STATS_NAME_START(lora_tx_sched_stats)
+    STATS_NAME(lora_tx_sched_stats, dc_holds)
+    STATS_NAME(lora_tx_sched_stats, aggr_frames)
+    STATS_NAME(lora_tx_sched_stats, aggr_msgs)
+    STATS_NAME(lora_tx_sched_stats, airtime_ms)
+STATS_NAME_END(lora_tx_sched_stats)
+#endif
+
 /* Device EUI */
 uint8_t g_lora_dev_eui[LORA_EUI_LEN];
 
@@ -138,6 +148,67 @@ lora_node_mcps_request(struct os_mbuf *om)
     assert(rc == 0);
 }
 
+/**
+ * Called by the MAC when a transmission attempt has finished. Hands the
+ * packet (or, for an aggregated frame, each message it carried) back to the
+ * application.
+ *
+ * @param om Pointer to transmitted packet
+ */
+void
+lora_node_mcps_confirm(struct os_mbuf *om)
+{
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+    struct lora_pkt_info *lpkt;
+    struct lora_pkt_info *mpkt;
+    struct os_mbuf_pkthdr *mp;
+    struct os_mbuf *m;
+
+    if (om && om == g_lora_mac_data.lm_aggr_om) {
+        lpkt = LORA_PKT_INFO_PTR(om);
+        while ((mp = STAILQ_FIRST(&g_lora_mac_data.lm_aggr_q)) != NULL) {
+            STAILQ_REMOVE_HEAD(&g_lora_mac_data.lm_aggr_q, omp_next);
+            m = OS_MBUF_PKTHDR_TO_MBUF(mp);
+            mpkt = LORA_PKT_INFO_PTR(m);
+            mpkt->status = lpkt->status;
+            mpkt->txdinfo = lpkt->txdinfo;
+            lora_app_mcps_confirm(m);
+        }
+        g_lora_mac_data.lm_aggr_om = NULL;
+        os_mbuf_free_chain(om);
+        return;
+    }
+#endif
+    lora_app_mcps_confirm(om);
+}
+
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+void
+lora_node_txq_info(struct lora_node_txq_info *info)
+{
+    struct os_mbuf_pkthdr *mp;
+    os_time_t now;
+    os_sr_t sr;
+
+    memset(info, 0, sizeof(*info));
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_FOREACH(mp, &g_lora_mac_data.lm_txq.mq_head, omp_next) {
+        info->txq_msgs++;
+        info->txq_bytes += mp->omp_len;
+    }
+    if (g_lora_mac_data.lm_held) {
+        now = os_time_get();
+        if (OS_TIME_TICK_GT(g_lora_mac_data.lm_hold_end, now)) {
+            info->hold_ms = os_time_ticks_to_ms32(
+                    g_lora_mac_data.lm_hold_end - now);
+        }
+    }
+    info->airtime_ms = g_lora_mac_data.lm_airtime_ms;
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 /**
  * What's the maximum payload which can be sent on next frame
  *
@@ -239,6 +310,129 @@ lora_node_get_batt_status(void)
 }
 
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+/**
+ * Hold the transmit queue while the duty-cycle restrictions would delay the
+ * next frame anyway, so that messages queued in the meantime can share it.
+ *
+ * @return int 1 if the queue is held (the queue timer is armed), 0 otherwise
+ */
+static int
+lora_node_tx_hold(void)
+{
+    uint32_t usecs;
+    uint32_t ticks;
+
+    g_lora_mac_data.lm_held = 0;
+    if (!LM_F_IS_JOINED()) {
+        return 0;
+    }
+
+    usecs = os_cputime_ticks_to_usecs(lora_mac_dc_time_off());
+    if (usecs == 0) {
+        return 0;
+    }
+
+    ticks = os_time_ms_to_ticks32((usecs + 999) / 1000);
+    if (ticks == 0) {
+        ticks = 1;
+    }
+    g_lora_mac_data.lm_hold_end = os_time_get() + ticks;
+    g_lora_mac_data.lm_held = 1;
+    os_callout_reset(&g_lora_mac_data.lm_txq_timer, ticks);
+    STATS_INC(lora_tx_sched_stats, dc_holds);
+    return 1;
+}
+
+/**
+ * Can the packet at the head of the transmit queue be added to a frame?
+ */
+static int
+lora_node_tx_aggr_ok(struct lora_pkt_info *lpkt, int len, int max_len)
+{
+    struct os_mbuf_pkthdr *mp;
+    struct lora_pkt_info *npkt;
+
+    mp = STAILQ_FIRST(&g_lora_mac_data.lm_txq.mq_head);
+    if (mp == NULL || len + mp->omp_len > max_len) {
+        return 0;
+    }
+    npkt = LORA_PKT_INFO_PTR(OS_MBUF_PKTHDR_TO_MBUF(mp));
+    return npkt->aggr_ok && npkt->port == lpkt->port &&
+           npkt->pkt_type == lpkt->pkt_type &&
+           (lpkt->pkt_type != MCPS_CONFIRMED ||
+            npkt->txdinfo.retries == lpkt->txdinfo.retries);
+}
+
+/**
+ * Build one frame out of the packet taken off the transmit queue and the
+ * compatible packets queued behind it. The original packets are kept, in
+ * order, on the aggregation queue until the frame is confirmed.
+ *
+ * @param om        Packet taken off the transmit queue
+ * @param max_len   Maximum payload of the next frame
+ *
+ * @return struct os_mbuf* The packet to transmit: om itself if nothing
+ *         could be aggregated.
+ */
+static struct os_mbuf *
+lora_node_tx_aggr(struct os_mbuf *om, int max_len)
+{
+    struct lora_pkt_info *lpkt;
+    struct os_mbuf *frame;
+    struct os_mbuf *m;
+    int len;
+    int cnt;
+
+    lpkt = LORA_PKT_INFO_PTR(om);
+    len = OS_MBUF_PKTLEN(om);
+    if (!lpkt->aggr_ok || !lora_node_tx_aggr_ok(lpkt, len, max_len)) {
+        return om;
+    }
+
+    frame = lora_pkt_alloc();
+    if (frame == NULL) {
+        return om;
+    }
+    if (os_mbuf_appendfrom(frame, om, 0, len)) {
+        os_mbuf_free_chain(frame);
+        return om;
+    }
+    memcpy(LORA_PKT_INFO_PTR(frame), lpkt, sizeof(struct lora_pkt_info));
+
+    STAILQ_INIT(&g_lora_mac_data.lm_aggr_q);
+    STAILQ_INSERT_TAIL(&g_lora_mac_data.lm_aggr_q, OS_MBUF_PKTHDR(om),
+                       omp_next);
+    cnt = 1;
+    while (cnt < MYNEWT_VAL(LORA_NODE_TX_AGGR_MAX) &&
+           lora_node_tx_aggr_ok(lpkt, len, max_len)) {
+        m = OS_MBUF_PKTHDR_TO_MBUF(
+                STAILQ_FIRST(&g_lora_mac_data.lm_txq.mq_head));
+        if (os_mbuf_appendfrom(frame, m, 0, OS_MBUF_PKTLEN(m))) {
+            /* Drop whatever was partially copied */
+            os_mbuf_adj(frame, len - OS_MBUF_PKTLEN(frame));
+            break;
+        }
+        m = os_mqueue_get(&g_lora_mac_data.lm_txq);
+        STAILQ_INSERT_TAIL(&g_lora_mac_data.lm_aggr_q, OS_MBUF_PKTHDR(m),
+                           omp_next);
+        len += OS_MBUF_PKTLEN(m);
+        ++cnt;
+    }
+
+    if (cnt == 1) {
+        STAILQ_INIT(&g_lora_mac_data.lm_aggr_q);
+        os_mbuf_free_chain(frame);
+        return om;
+    }
+
+    g_lora_mac_data.lm_aggr_om = frame;
+    STATS_INC(lora_tx_sched_stats, aggr_frames);
+    STATS_INCN(lora_tx_sched_stats, aggr_msgs, cnt);
+    return frame;
+}
+#endif
+
 /**
  * Process transmit enqueued event
  *
@@ -264,6 +458,12 @@ lora_mac_proc_tx_q_event(struct os_event *ev)
         return;
     }
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+    if (!lora_node_txq_empty() && lora_node_tx_hold()) {
+        return;
+    }
+#endif
+
     /*
      * Check if possible to send frame. If a MAC command length error we
      * need to send an empty, unconfirmed frame to flush mac commands.
@@ -316,6 +516,11 @@ send_empty_msg:
 send_from_txq:
             om = os_mqueue_get(&g_lora_mac_data.lm_txq);
             assert(om != NULL);
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+            if (rc == LORAMAC_STATUS_OK) {
+                om = lora_node_tx_aggr(om, txinfo.MaxPossiblePayload);
+            }
+#endif
             lpkt = LORA_PKT_INFO_PTR(om);
             g_lora_mac_data.curtx = lpkt;
             g_lora_node_last_tx_mac_cmd = 0;
@@ -382,7 +587,7 @@ send_from_txq:
          */
 proc_txq_om_done:
         lpkt->status = evstatus;
-        lora_app_mcps_confirm(om);
+        lora_node_mcps_confirm(om);
     }
 }
 
@@ -642,6 +847,15 @@ lora_node_init(void)
         STATS_NAME_INIT_PARMS(lora_mac_stats), "lora_mac");
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+    rc = stats_init_and_reg(
+        STATS_HDR(lora_tx_sched_stats),
+        STATS_SIZE_INIT_PARMS(lora_tx_sched_stats, STATS_SIZE_32),
+        STATS_NAME_INIT_PARMS(lora_tx_sched_stats), "lora_tx_sched");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+    STAILQ_INIT(&g_lora_mac_data.lm_aggr_q);
+#endif
+
 #if MYNEWT_VAL(LORA_NODE_CLI)
     lora_cli_init();
 #else
@@ -535,7 +535,7 @@ lora_mac_send_mcps_confirm(LoRaMacEventInfoStatus_t status)
         assert(g_lora_mac_data.curtx != NULL);
         g_lora_mac_data.curtx->status = status;
         if (g_lora_mac_data.cur_tx_mbuf) {
-            lora_app_mcps_confirm(g_lora_mac_data.cur_tx_mbuf);
+            lora_node_mcps_confirm(g_lora_mac_data.cur_tx_mbuf);
         }
         LM_F_IS_MCPS_REQ() = 0;
     }
@@ -2074,6 +2074,50 @@ CalculateBackOff(uint8_t channel)
     g_lora_mac_data.aggr_time_off = ((tx_ticks * g_lora_mac_data.aggr_dc) - tx_ticks);
 }
 
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+/**
+ * Returns how long a transmission at the current data rate would have to
+ * wait for the duty-cycle restrictions to allow it. The channel itself is
+ * chosen at transmit time; this only reports the earliest time at which
+ * any enabled channel becomes available.
+ *
+ * @return uint32_t Wait time in lora mac timer ticks; 0 if a channel is
+ *                  available now (or no channel could be found).
+ */
+uint32_t
+lora_mac_dc_time_off(void)
+{
+    LoRaMacStatus_t status;
+    NextChanParams_t nextChan;
+    TimerTime_t time_off;
+    TimerTime_t aggr_time_off;
+    uint8_t chan;
+
+    if (g_lora_mac_data.max_dc == 255) {
+        return 0;
+    }
+
+    /* Same computation as ScheduleTx(), without committing to a channel */
+    CalculateBackOff(g_lora_mac_data.last_tx_chan);
+
+    nextChan.AggrTimeOff = g_lora_mac_data.max_dc ?
+                           g_lora_mac_data.aggr_time_off : 0;
+    nextChan.Datarate = LoRaMacParams.ChannelsDatarate;
+    nextChan.DutyCycleEnabled = DutyCycleOn;
+    nextChan.Joined = LM_F_IS_JOINED();
+    nextChan.LastAggrTx = g_lora_mac_data.aggr_last_tx_done_time;
+
+    time_off = 0;
+    aggr_time_off = nextChan.AggrTimeOff;
+    status = RegionNextChannel(LoRaMacRegion, &nextChan, &chan, &time_off,
+                               &aggr_time_off);
+    if (status != LORAMAC_STATUS_DUTYCYCLE_RESTRICTED) {
+        return 0;
+    }
+    return time_off;
+}
+#endif
+
 /*!
  * \brief Resets MAC specific parameters to default
  */
@@ -2377,6 +2421,11 @@ SendFrameOnChannel(uint8_t channel)
     txi->txdinfo.txpower = txPower;
     txi->txdinfo.uplink_chan = channel;
     txi->txdinfo.tx_time_on_air = g_lora_mac_data.tx_time_on_air;
+#if MYNEWT_VAL(LORA_NODE_TX_SCHED)
+    g_lora_mac_data.lm_airtime_ms += g_lora_mac_data.tx_time_on_air;
+    STATS_INCN(lora_tx_sched_stats, airtime_ms,
+               g_lora_mac_data.tx_time_on_air);
+#endif
 
     // Send now
     Radio.Send(LoRaMacBuffer, LoRaMacBufferPktLen);
@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __MQTT_CLIENT_H_
+#define __MQTT_CLIENT_H_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "mn_socket/mn_socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mqtt_client;
+struct fcb;
+
+/*
+ * Error passed to mcc_disconnected when the broker refuses the connection;
+ * the low byte holds the CONNACK return code.
+ */
+#define MQTT_CLIENT_ECONNACK(code)  (0x100 | (code))
+
+/*
+ * Connection parameters.  The strings are referenced, not copied, and must
+ * remain valid while the client is in use.
+ */
+struct mqtt_client_cfg {
+    const char *mcc_client_id;
+    const char *mcc_username;           /* NULL if none */
+    const char *mcc_password;           /* NULL if none */
+    uint16_t mcc_keepalive;             /* seconds, 0 to disable */
+    uint8_t mcc_clean_session:1;
+};
+
+/*
+ * Application callbacks.  These run in the context of the client's event
+ * queue.  Any of them may be NULL.
+ */
+struct mqtt_client_cbs {
+    /* CONNACK accepted.  session_present as reported by the broker. */
+    void (*mcc_connected)(struct mqtt_client *mc, int session_present);
+
+    /*
+     * Connection closed.  err is 0 after mqtt_client_disconnect(),
+     * MQTT_CLIENT_ECONNACK() if the broker refused the connection, or an
+     * MN_E* error otherwise.
+     */
+    void (*mcc_disconnected)(struct mqtt_client *mc, int err);
+
+    /* Incoming message.  The callee owns payload and must free it. */
+    void (*mcc_message)(struct mqtt_client *mc, const char *topic,
+                        uint8_t qos, int retained, struct os_mbuf *payload);
+
+    /*
+     * An outgoing QoS 1/2 message left the in-flight window.  status is 0
+     * once it is fully acknowledged, or SYS_ENOENT if it was dropped
+     * because a clean session was started.
+     */
+    void (*mcc_published)(struct mqtt_client *mc, uint16_t pkt_id,
+                          int status);
+
+    /*
+     * SUBACK or UNSUBACK received.  For SUBACK, qos is the granted QoS or
+     * 0x80 on failure; for UNSUBACK it is 0.
+     */
+    void (*mcc_subscribed)(struct mqtt_client *mc, uint16_t pkt_id,
+                           uint8_t qos);
+};
+
+/*
+ * An outgoing QoS 1/2 message awaiting acknowledgement.
+ */
+struct mqtt_client_inflight {
+    struct os_mbuf *mci_pkt;            /* PUBLISH, kept for resending */
+    uint16_t mci_id;                    /* packet identifier, 0 if free */
+    uint8_t mci_state;
+};
+
+struct mqtt_client {
+    const struct mqtt_client_cfg *mc_cfg;
+    const struct mqtt_client_cbs *mc_cbs;
+    void *mc_arg;                       /* for the application */
+    struct os_eventq *mc_evq;
+    struct mn_socket *mc_sock;
+    uint8_t mc_state;
+    uint8_t mc_ping_out:1;
+    uint8_t mc_closing:1;
+    uint8_t mc_out_head;                /* oldest slot of mc_out */
+    uint8_t mc_out_cnt;                 /* slots in use, holes included */
+    uint16_t mc_next_id;
+    int mc_err;
+    os_time_t mc_tx_time;
+
+    STAILQ_HEAD(, os_mbuf_pkthdr) mc_txq;   /* packets not yet written */
+    struct os_mbuf *mc_rx;                  /* received, not yet parsed */
+
+    struct os_event mc_tx_ev;
+    struct os_event mc_rx_ev;
+    struct os_event mc_conn_ev;
+    struct os_event mc_err_ev;
+    struct os_callout mc_ping_timer;
+
+    /* In-flight window, a ring in publish order so resends keep it. */
+    struct mqtt_client_inflight mc_out[MYNEWT_VAL(MQTT_CLIENT_INFLIGHT)];
+    /* Identifiers of incoming QoS 2 messages awaiting PUBREL, 0 if free. */
+    uint16_t mc_in_qos2[MYNEWT_VAL(MQTT_CLIENT_QOS2_RX)];
+#if MYNEWT_VAL(MQTT_CLIENT_PERSIST)
+    struct fcb *mc_fcb;
+#endif
+};
+
+/**
+ * Initializes a client.  All client calls must then be made from the task
+ * processing evq.
+ *
+ * @param mc                    The client to initialize.
+ * @param cfg                   Connection parameters.
+ * @param cbs                   Application callbacks.
+ * @param evq                   Event queue the client runs on.
+ */
+void mqtt_client_init(struct mqtt_client *mc,
+                      const struct mqtt_client_cfg *cfg,
+                      const struct mqtt_client_cbs *cbs,
+                      struct os_eventq *evq);
+
+#if MYNEWT_VAL(MQTT_CLIENT_PERSIST)
+/**
+ * Keeps session state in fcb, and restores whatever state it already
+ * holds.  Call before the first mqtt_client_connect(), with clean_session
+ * cleared in the configuration.  The fcb must be large enough to hold a
+ * full window twice over.
+ *
+ * @return                      0 on success; non-zero if the stored state
+ *                                  could not be read completely.
+ */
+int mqtt_client_persist_init(struct mqtt_client *mc, struct fcb *fcb);
+#endif
+
+/**
+ * Opens a TCP connection to the broker and sends CONNECT.  Completion is
+ * reported through mcc_connected or mcc_disconnected.
+ *
+ * @return                      0 on success; MN_E* otherwise.
+ */
+int mqtt_client_connect(struct mqtt_client *mc, struct mn_sockaddr *addr);
+
+/**
+ * Sends DISCONNECT and closes the connection.  Unacknowledged messages stay
+ * in the window and are resent on the next connect.
+ */
+void mqtt_client_disconnect(struct mqtt_client *mc);
+
+/**
+ * Queues a PUBLISH.  Messages queued back to back are written to the
+ * socket in one go.  QoS 1/2 messages occupy a window slot until they are
+ * acknowledged; see mcc_published.
+ *
+ * @param topic                 Topic name.
+ * @param qos                   0, 1 or 2.
+ * @param retain                Set the RETAIN flag.
+ * @param payload               Message payload.  Consumed on success.
+ * @param out_id                Filled with the packet identifier for QoS
+ *                                  1/2 messages.  May be NULL.
+ *
+ * @return                      0 on success;
+ *                              SYS_EAGAIN if not connected;
+ *                              SYS_EBUSY if the window is full;
+ *                              SYS_ENOMEM on mbuf shortage;
+ *                              SYS_EINVAL on bad arguments.
+ */
+int mqtt_client_publish(struct mqtt_client *mc, const char *topic,
+                        uint8_t qos, int retain, struct os_mbuf *payload,
+                        uint16_t *out_id);
+
+/**
+ * Sends SUBSCRIBE for a single topic filter.  The outcome is reported
+ * through mcc_subscribed.
+ *
+ * @return                      0 on success; SYS_E* as for
+ *                                  mqtt_client_publish().
+ */
+int mqtt_client_subscribe(struct mqtt_client *mc, const char *filter,
+                          uint8_t qos, uint16_t *out_id);
+
+/**
+ * Sends UNSUBSCRIBE for a single topic filter.
+ */
+int mqtt_client_unsubscribe(struct mqtt_client *mc, const char *filter,
+                            uint16_t *out_id);
+
+/**
+ * Returns the number of free slots in the in-flight window.
+ */
+int mqtt_client_window_avail(const struct mqtt_client *mc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MQTT_CLIENT_H_ */
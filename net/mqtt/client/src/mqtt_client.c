@@ -0,0 +1,904 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "mn_socket/mn_socket.h"
+#include "mqtt/MQTTPacket.h"
+#include "mqtt_client/mqtt_client.h"
+#include "mqtt_client_priv.h"
+
+#define MQTT_CLIENT_WINDOW      MYNEWT_VAL(MQTT_CLIENT_INFLIGHT)
+
+static void mqtt_client_readable(void *cb_arg, int err);
+static void mqtt_client_writable(void *cb_arg, int err);
+
+static const union mn_socket_cb mqtt_client_sock_cbs = {
+    .socket.readable = mqtt_client_readable,
+    .socket.writable = mqtt_client_writable,
+};
+
+/*
+ * In-flight window.
+ */
+struct mqtt_client_inflight *
+mqtt_client_out_find(struct mqtt_client *mc, uint16_t id)
+{
+    struct mqtt_client_inflight *mci;
+    int i;
+
+    for (i = 0; i < mc->mc_out_cnt; i++) {
+        mci = &mc->mc_out[(mc->mc_out_head + i) % MQTT_CLIENT_WINDOW];
+        if (mci->mci_id == id) {
+            return mci;
+        }
+    }
+    return NULL;
+}
+
+struct mqtt_client_inflight *
+mqtt_client_out_alloc(struct mqtt_client *mc, uint16_t id)
+{
+    struct mqtt_client_inflight *mci;
+
+    if (mc->mc_out_cnt == MQTT_CLIENT_WINDOW) {
+        return NULL;
+    }
+    mci = &mc->mc_out[(mc->mc_out_head + mc->mc_out_cnt) % MQTT_CLIENT_WINDOW];
+    mc->mc_out_cnt++;
+    memset(mci, 0, sizeof(*mci));
+    mci->mci_id = id;
+    return mci;
+}
+
+/*
+ * Frees a window slot, and moves the head of the ring past any free slots.
+ */
+void
+mqtt_client_out_free(struct mqtt_client *mc, struct mqtt_client_inflight *mci)
+{
+    os_mbuf_free_chain(mci->mci_pkt);
+    mci->mci_pkt = NULL;
+    mci->mci_id = 0;
+    while (mc->mc_out_cnt && mc->mc_out[mc->mc_out_head].mci_id == 0) {
+        mc->mc_out_head = (mc->mc_out_head + 1) % MQTT_CLIENT_WINDOW;
+        mc->mc_out_cnt--;
+    }
+}
+
+static void
+mqtt_client_out_done(struct mqtt_client *mc, struct mqtt_client_inflight *mci,
+                     int status)
+{
+    uint16_t id;
+
+    id = mci->mci_id;
+    mqtt_client_out_free(mc, mci);
+    mqtt_client_persist(mc, MQTT_CLIENT_REC_DONE, id, NULL);
+    if (mc->mc_cbs->mcc_published) {
+        mc->mc_cbs->mcc_published(mc, id, status);
+    }
+}
+
+int
+mqtt_client_window_avail(const struct mqtt_client *mc)
+{
+    return MQTT_CLIENT_WINDOW - mc->mc_out_cnt;
+}
+
+int
+mqtt_client_qos2_add(struct mqtt_client *mc, uint16_t id)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_QOS2_RX); i++) {
+        if (mc->mc_in_qos2[i] == 0) {
+            mc->mc_in_qos2[i] = id;
+            return 0;
+        }
+    }
+    return SYS_ENOMEM;
+}
+
+static int
+mqtt_client_qos2_find(struct mqtt_client *mc, uint16_t id)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_QOS2_RX); i++) {
+        if (mc->mc_in_qos2[i] == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void
+mqtt_client_qos2_del(struct mqtt_client *mc, uint16_t id)
+{
+    int i;
+
+    i = mqtt_client_qos2_find(mc, id);
+    if (i >= 0) {
+        mc->mc_in_qos2[i] = 0;
+    }
+}
+
+static uint16_t
+mqtt_client_next_id(struct mqtt_client *mc)
+{
+    uint16_t id;
+
+    do {
+        id = mc->mc_next_id++;
+    } while (id == 0 || mqtt_client_out_find(mc, id));
+    return id;
+}
+
+/*
+ * Transmit.  Packets are queued on mc_txq and written out from the TX event,
+ * all of them chained into a single mn_sendto().
+ */
+static struct os_mbuf *
+mqtt_client_pkt_alloc(void)
+{
+    return os_msys_get_pkthdr(0, 0);
+}
+
+static void
+mqtt_client_pkt_set_len(struct os_mbuf *m, int len)
+{
+    m->om_len = len;
+    OS_MBUF_PKTHDR(m)->omp_len = len;
+}
+
+static void
+mqtt_client_queue(struct mqtt_client *mc, struct os_mbuf *m)
+{
+    STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next) = NULL;
+    STAILQ_INSERT_TAIL(&mc->mc_txq, OS_MBUF_PKTHDR(m), omp_next);
+    os_eventq_put(mc->mc_evq, &mc->mc_tx_ev);
+}
+
+static int
+mqtt_client_queue_ack(struct mqtt_client *mc, uint8_t type, uint16_t id)
+{
+    struct os_mbuf *m;
+    int len;
+
+    m = mqtt_client_pkt_alloc();
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    len = MQTTSerialize_ack(m->om_data, OS_MBUF_TRAILINGSPACE(m), type, 0,
+                            id);
+    assert(len > 0);
+    mqtt_client_pkt_set_len(m, len);
+    mqtt_client_queue(mc, m);
+    return 0;
+}
+
+static int
+mqtt_client_queue_short(struct mqtt_client *mc, uint8_t type)
+{
+    struct os_mbuf *m;
+    uint8_t pkt[2];
+
+    m = mqtt_client_pkt_alloc();
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    pkt[0] = type << 4;
+    pkt[1] = 0;
+    if (os_mbuf_append(m, pkt, sizeof(pkt))) {
+        os_mbuf_free_chain(m);
+        return SYS_ENOMEM;
+    }
+    mqtt_client_queue(mc, m);
+    return 0;
+}
+
+static void
+mqtt_client_flush_txq(struct mqtt_client *mc)
+{
+    struct os_mbuf_pkthdr *pkt;
+
+    while ((pkt = STAILQ_FIRST(&mc->mc_txq)) != NULL) {
+        STAILQ_REMOVE_HEAD(&mc->mc_txq, omp_next);
+        os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(pkt));
+    }
+}
+
+static void
+mqtt_client_close(struct mqtt_client *mc, int err)
+{
+    uint8_t state;
+
+    os_callout_stop(&mc->mc_ping_timer);
+    os_eventq_remove(mc->mc_evq, &mc->mc_tx_ev);
+    os_eventq_remove(mc->mc_evq, &mc->mc_rx_ev);
+    os_eventq_remove(mc->mc_evq, &mc->mc_conn_ev);
+    os_eventq_remove(mc->mc_evq, &mc->mc_err_ev);
+    if (mc->mc_sock) {
+        mn_close(mc->mc_sock);
+        mc->mc_sock = NULL;
+    }
+    mqtt_client_flush_txq(mc);
+    os_mbuf_free_chain(mc->mc_rx);
+    mc->mc_rx = NULL;
+
+    state = mc->mc_state;
+    mc->mc_state = MQTT_CLIENT_ST_IDLE;
+    mc->mc_ping_out = 0;
+    mc->mc_closing = 0;
+    if (state != MQTT_CLIENT_ST_IDLE && mc->mc_cbs->mcc_disconnected) {
+        mc->mc_cbs->mcc_disconnected(mc, err);
+    }
+}
+
+static void
+mqtt_client_tx_event(struct os_event *ev)
+{
+    struct mqtt_client *mc;
+    struct os_mbuf_pkthdr *pkt;
+    struct os_mbuf *m;
+    int rc;
+
+    mc = ev->ev_arg;
+    if (!mc->mc_sock || mc->mc_state < MQTT_CLIENT_ST_CONNECTING) {
+        return;
+    }
+    pkt = STAILQ_FIRST(&mc->mc_txq);
+    if (!pkt) {
+        return;
+    }
+    STAILQ_REMOVE_HEAD(&mc->mc_txq, omp_next);
+    m = OS_MBUF_PKTHDR_TO_MBUF(pkt);
+    while ((pkt = STAILQ_FIRST(&mc->mc_txq)) != NULL) {
+        STAILQ_REMOVE_HEAD(&mc->mc_txq, omp_next);
+        os_mbuf_concat(m, OS_MBUF_PKTHDR_TO_MBUF(pkt));
+    }
+    STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next) = NULL;
+
+    rc = mn_sendto(mc->mc_sock, m, NULL);
+    switch (rc) {
+    case 0:
+        mc->mc_tx_time = os_time_get();
+        if (mc->mc_closing) {
+            mqtt_client_close(mc, 0);
+        }
+        break;
+    case MN_EAGAIN:
+    case MN_ENOBUFS:
+        /* Keep it; the writable callback brings us back here. */
+        STAILQ_INSERT_HEAD(&mc->mc_txq, OS_MBUF_PKTHDR(m), omp_next);
+        break;
+    default:
+        os_mbuf_free_chain(m);
+        mqtt_client_close(mc, rc);
+        break;
+    }
+}
+
+/*
+ * Resends the window after a reconnect, oldest first.
+ */
+static int
+mqtt_client_resend(struct mqtt_client *mc)
+{
+    struct mqtt_client_inflight *mci;
+    struct os_mbuf *m;
+    int i;
+
+    for (i = 0; i < mc->mc_out_cnt; i++) {
+        mci = &mc->mc_out[(mc->mc_out_head + i) % MQTT_CLIENT_WINDOW];
+        if (mci->mci_id == 0) {
+            continue;
+        }
+        if (mci->mci_state == MQTT_CLIENT_OUT_PUBCOMP) {
+            if (mqtt_client_queue_ack(mc, PUBREL, mci->mci_id)) {
+                return MN_ENOBUFS;
+            }
+        } else {
+            m = os_mbuf_dup(mci->mci_pkt);
+            if (!m) {
+                return MN_ENOBUFS;
+            }
+            mqtt_client_queue(mc, m);
+        }
+    }
+    return 0;
+}
+
+static void
+mqtt_client_drop_session(struct mqtt_client *mc)
+{
+    struct mqtt_client_inflight *mci;
+
+    mqtt_client_persist(mc, MQTT_CLIENT_REC_CLEAR, 0, NULL);
+    memset(mc->mc_in_qos2, 0, sizeof(mc->mc_in_qos2));
+    while (mc->mc_out_cnt) {
+        mci = &mc->mc_out[mc->mc_out_head];
+        if (mci->mci_id) {
+            mqtt_client_out_done(mc, mci, SYS_ENOENT);
+        } else {
+            mqtt_client_out_free(mc, mci);
+        }
+    }
+}
+
+static void
+mqtt_client_ping_arm(struct mqtt_client *mc, os_time_t ticks)
+{
+    if (mc->mc_cfg->mcc_keepalive) {
+        os_callout_reset(&mc->mc_ping_timer, ticks);
+    }
+}
+
+static void
+mqtt_client_ping_event(struct os_event *ev)
+{
+    struct mqtt_client *mc;
+    os_time_t ka;
+    os_time_t idle;
+
+    mc = ev->ev_arg;
+    if (mc->mc_state != MQTT_CLIENT_ST_CONNECTED) {
+        return;
+    }
+    if (mc->mc_ping_out) {
+        mqtt_client_close(mc, MN_ETIMEDOUT);
+        return;
+    }
+    ka = mc->mc_cfg->mcc_keepalive * OS_TICKS_PER_SEC;
+    idle = os_time_get() - mc->mc_tx_time;
+    if (idle < ka) {
+        mqtt_client_ping_arm(mc, ka - idle);
+        return;
+    }
+    if (mqtt_client_queue_short(mc, PINGREQ) == 0) {
+        mc->mc_ping_out = 1;
+    }
+    mqtt_client_ping_arm(mc, ka);
+}
+
+/*
+ * Receive.
+ */
+static int
+mqtt_client_rx_connack(struct mqtt_client *mc, int off, int rem_len)
+{
+    uint8_t buf[2];
+    int rc;
+
+    if (mc->mc_state != MQTT_CLIENT_ST_CONNECTING || rem_len != 2) {
+        return MN_EINVAL;
+    }
+    os_mbuf_copydata(mc->mc_rx, off, sizeof(buf), buf);
+    if (buf[1] != 0) {
+        return MQTT_CLIENT_ECONNACK(buf[1]);
+    }
+    mc->mc_state = MQTT_CLIENT_ST_CONNECTED;
+    if (mc->mc_cfg->mcc_clean_session) {
+        mqtt_client_drop_session(mc);
+    } else {
+        rc = mqtt_client_resend(mc);
+        if (rc) {
+            return rc;
+        }
+    }
+    mqtt_client_ping_arm(mc, mc->mc_cfg->mcc_keepalive * OS_TICKS_PER_SEC);
+    if (mc->mc_cbs->mcc_connected) {
+        mc->mc_cbs->mcc_connected(mc, buf[0] & 0x01);
+    }
+    return 0;
+}
+
+static int
+mqtt_client_rx_publish(struct mqtt_client *mc)
+{
+    char topic[MYNEWT_VAL(MQTT_CLIENT_TOPIC_MAX) + 1];
+    struct os_mbuf *payload;
+    unsigned short id;
+    unsigned char dup;
+    unsigned char retained;
+    int qos;
+    int toff;
+    int tlen;
+    int poff;
+    int plen;
+    int deliver;
+
+    id = 0;
+    if (MQTTDeserialize_publish_mbuf(&dup, &qos, &retained, &id, &toff, &tlen,
+                                     &poff, &plen, mc->mc_rx, 0) != 1 ||
+        qos == 3) {
+        return MN_EINVAL;
+    }
+
+    deliver = tlen < sizeof(topic) && mc->mc_cbs->mcc_message;
+    if (qos == 2 && mqtt_client_qos2_find(mc, id) >= 0) {
+        /* Already delivered, the broker missed our PUBREC. */
+        deliver = 0;
+    }
+
+    payload = NULL;
+    if (deliver) {
+        os_mbuf_copydata(mc->mc_rx, toff, tlen, topic);
+        topic[tlen] = '\0';
+        payload = mqtt_client_pkt_alloc();
+        if (!payload ||
+            os_mbuf_appendfrom(payload, mc->mc_rx, poff, plen)) {
+            /* Leave it unacknowledged; the broker sends it again. */
+            os_mbuf_free_chain(payload);
+            return MN_ENOBUFS;
+        }
+    }
+    if (qos == 2 && deliver) {
+        if (mqtt_client_qos2_add(mc, id)) {
+            os_mbuf_free_chain(payload);
+            return MN_ENOBUFS;
+        }
+        mqtt_client_persist(mc, MQTT_CLIENT_REC_QOS2, id, NULL);
+    }
+    if (deliver) {
+        mc->mc_cbs->mcc_message(mc, topic, qos, retained, payload);
+    }
+
+    if (qos == 1) {
+        mqtt_client_queue_ack(mc, PUBACK, id);
+    } else if (qos == 2) {
+        mqtt_client_queue_ack(mc, PUBREC, id);
+    }
+    return 0;
+}
+
+static int
+mqtt_client_rx_ack(struct mqtt_client *mc, uint8_t type, int off,
+                   int rem_len)
+{
+    struct mqtt_client_inflight *mci;
+    uint8_t buf[3];
+    uint16_t id;
+
+    if ((type == SUBACK && rem_len < 3) || (type != SUBACK && rem_len < 2)) {
+        return MN_EINVAL;
+    }
+    os_mbuf_copydata(mc->mc_rx, off, type == SUBACK ? 3 : 2, buf);
+    id = (buf[0] << 8) | buf[1];
+
+    switch (type) {
+    case PUBACK:
+        mci = mqtt_client_out_find(mc, id);
+        if (mci && mci->mci_state == MQTT_CLIENT_OUT_PUBACK) {
+            mqtt_client_out_done(mc, mci, 0);
+        }
+        break;
+    case PUBREC:
+        mci = mqtt_client_out_find(mc, id);
+        if (!mci) {
+            break;
+        }
+        if (mci->mci_state == MQTT_CLIENT_OUT_PUBREC) {
+            os_mbuf_free_chain(mci->mci_pkt);
+            mci->mci_pkt = NULL;
+            mci->mci_state = MQTT_CLIENT_OUT_PUBCOMP;
+            mqtt_client_persist(mc, MQTT_CLIENT_REC_REL, id, NULL);
+        }
+        mqtt_client_queue_ack(mc, PUBREL, id);
+        break;
+    case PUBCOMP:
+        mci = mqtt_client_out_find(mc, id);
+        if (mci && mci->mci_state == MQTT_CLIENT_OUT_PUBCOMP) {
+            mqtt_client_out_done(mc, mci, 0);
+        }
+        break;
+    case PUBREL:
+        if (mqtt_client_qos2_find(mc, id) >= 0) {
+            mqtt_client_qos2_del(mc, id);
+            mqtt_client_persist(mc, MQTT_CLIENT_REC_QOS2_DONE, id, NULL);
+        }
+        mqtt_client_queue_ack(mc, PUBCOMP, id);
+        break;
+    case SUBACK:
+    case UNSUBACK:
+        if (mc->mc_cbs->mcc_subscribed) {
+            mc->mc_cbs->mcc_subscribed(mc, id, type == SUBACK ? buf[2] : 0);
+        }
+        break;
+    }
+    return 0;
+}
+
+/*
+ * Handles one complete packet at the front of mc_rx.  off is the length of
+ * its fixed header.
+ */
+static int
+mqtt_client_rx_pkt(struct mqtt_client *mc, uint8_t hdr, int off, int rem_len)
+{
+    uint8_t type;
+
+    type = hdr >> 4;
+    if (type != CONNACK && mc->mc_state != MQTT_CLIENT_ST_CONNECTED) {
+        return MN_EINVAL;
+    }
+    switch (type) {
+    case CONNACK:
+        return mqtt_client_rx_connack(mc, off, rem_len);
+    case PUBLISH:
+        return mqtt_client_rx_publish(mc);
+    case PUBACK:
+    case PUBREC:
+    case PUBREL:
+    case PUBCOMP:
+    case SUBACK:
+    case UNSUBACK:
+        return mqtt_client_rx_ack(mc, type, off, rem_len);
+    case PINGRESP:
+        mc->mc_ping_out = 0;
+        return 0;
+    default:
+        return MN_EINVAL;
+    }
+}
+
+static int
+mqtt_client_rx_parse(struct mqtt_client *mc)
+{
+    uint8_t hdr[5];
+    int rem_len;
+    int len;
+    int cnt;
+    int rc;
+    int i;
+
+    while (mc->mc_rx) {
+        len = OS_MBUF_PKTLEN(mc->mc_rx);
+        cnt = min(len, sizeof(hdr));
+        os_mbuf_copydata(mc->mc_rx, 0, cnt, hdr);
+
+        /* Remaining length, 1-4 bytes of 7 bits each. */
+        rem_len = 0;
+        for (i = 1; i < cnt; i++) {
+            rem_len |= (hdr[i] & 0x7f) << (7 * (i - 1));
+            if (!(hdr[i] & 0x80)) {
+                break;
+            }
+        }
+        if (i == cnt) {
+            return cnt == sizeof(hdr) ? MN_EINVAL : 0;
+        }
+        if (len < i + 1 + rem_len) {
+            return 0;
+        }
+
+        rc = mqtt_client_rx_pkt(mc, hdr[0], i + 1, rem_len);
+        if (rc) {
+            return rc;
+        }
+        if (len == i + 1 + rem_len) {
+            os_mbuf_free_chain(mc->mc_rx);
+            mc->mc_rx = NULL;
+        } else {
+            os_mbuf_adj(mc->mc_rx, i + 1 + rem_len);
+        }
+    }
+    return 0;
+}
+
+static void
+mqtt_client_rx_event(struct os_event *ev)
+{
+    struct mqtt_client *mc;
+    struct os_mbuf *m;
+    int err;
+    int rc;
+
+    mc = ev->ev_arg;
+    if (!mc->mc_sock) {
+        return;
+    }
+    while (1) {
+        err = mn_recvfrom(mc->mc_sock, &m, NULL);
+        if (err) {
+            break;
+        }
+        if (mc->mc_rx) {
+            os_mbuf_concat(mc->mc_rx, m);
+        } else {
+            mc->mc_rx = m;
+        }
+    }
+    rc = mqtt_client_rx_parse(mc);
+    if (rc == 0 && err != MN_EAGAIN) {
+        rc = err;
+    }
+    if (rc) {
+        mqtt_client_close(mc, rc);
+    }
+}
+
+static void
+mqtt_client_conn_event(struct os_event *ev)
+{
+    MQTTPacket_connectData cd = MQTTPacket_connectData_initializer;
+    struct mqtt_client *mc;
+    struct os_mbuf *m;
+    int len;
+
+    mc = ev->ev_arg;
+    if (mc->mc_state != MQTT_CLIENT_ST_TCP) {
+        return;
+    }
+    mc->mc_state = MQTT_CLIENT_ST_CONNECTING;
+
+    cd.clientID.cstring = (char *)mc->mc_cfg->mcc_client_id;
+    cd.keepAliveInterval = mc->mc_cfg->mcc_keepalive;
+    cd.cleansession = mc->mc_cfg->mcc_clean_session;
+    cd.username.cstring = (char *)mc->mc_cfg->mcc_username;
+    cd.password.cstring = (char *)mc->mc_cfg->mcc_password;
+
+    m = mqtt_client_pkt_alloc();
+    if (!m) {
+        mqtt_client_close(mc, MN_ENOBUFS);
+        return;
+    }
+    len = MQTTSerialize_connect(m->om_data, OS_MBUF_TRAILINGSPACE(m), &cd);
+    if (len <= 0) {
+        os_mbuf_free_chain(m);
+        mqtt_client_close(mc, MN_EINVAL);
+        return;
+    }
+    mqtt_client_pkt_set_len(m, len);
+    mqtt_client_queue(mc, m);
+}
+
+static void
+mqtt_client_err_event(struct os_event *ev)
+{
+    struct mqtt_client *mc;
+
+    mc = ev->ev_arg;
+    if (mc->mc_sock) {
+        mqtt_client_close(mc, mc->mc_err);
+    }
+}
+
+/*
+ * Socket callbacks; these run in the network stack's context, and hand
+ * everything over to the client's event queue.
+ */
+static void
+mqtt_client_sock_err(struct mqtt_client *mc, int err)
+{
+    mc->mc_err = err;
+    os_eventq_put(mc->mc_evq, &mc->mc_err_ev);
+}
+
+static void
+mqtt_client_readable(void *cb_arg, int err)
+{
+    struct mqtt_client *mc = cb_arg;
+
+    if (err) {
+        mqtt_client_sock_err(mc, err);
+    } else {
+        os_eventq_put(mc->mc_evq, &mc->mc_rx_ev);
+    }
+}
+
+static void
+mqtt_client_writable(void *cb_arg, int err)
+{
+    struct mqtt_client *mc = cb_arg;
+
+    if (err) {
+        mqtt_client_sock_err(mc, err);
+    } else if (mc->mc_state == MQTT_CLIENT_ST_TCP) {
+        os_eventq_put(mc->mc_evq, &mc->mc_conn_ev);
+    } else {
+        os_eventq_put(mc->mc_evq, &mc->mc_tx_ev);
+    }
+}
+
+/*
+ * API.
+ */
+int
+mqtt_client_publish(struct mqtt_client *mc, const char *topic, uint8_t qos,
+                    int retain, struct os_mbuf *payload, uint16_t *out_id)
+{
+    MQTTString mstr = MQTTString_initializer;
+    struct mqtt_client_inflight *mci;
+    struct os_mbuf *keep;
+    uint16_t id;
+    int empty;
+
+    if (qos > 2 || !topic) {
+        return SYS_EINVAL;
+    }
+    if (mc->mc_state != MQTT_CLIENT_ST_CONNECTED) {
+        return SYS_EAGAIN;
+    }
+    if (qos && mc->mc_out_cnt == MQTT_CLIENT_WINDOW) {
+        return SYS_EBUSY;
+    }
+    mstr.cstring = (char *)topic;
+    id = qos ? mqtt_client_next_id(mc) : 0;
+
+    if (!payload) {
+        payload = mqtt_client_pkt_alloc();
+        if (!payload) {
+            return SYS_ENOMEM;
+        }
+        empty = 1;
+    } else {
+        empty = 0;
+    }
+
+    keep = NULL;
+    if (qos) {
+        /* Copy for resending after a reconnect; any resend is a dup. */
+        keep = os_mbuf_dup(payload);
+        if (!keep ||
+            MQTTSerialize_publish_mbuf(&keep, 1, qos, retain, id, mstr) <= 0) {
+            goto err;
+        }
+    }
+    if (MQTTSerialize_publish_mbuf(&payload, 0, qos, retain, id, mstr) <= 0) {
+        goto err;
+    }
+
+    if (qos) {
+        mci = mqtt_client_out_alloc(mc, id);
+        assert(mci);
+        mci->mci_pkt = keep;
+        mci->mci_state = (qos == 1) ? MQTT_CLIENT_OUT_PUBACK :
+                                      MQTT_CLIENT_OUT_PUBREC;
+        mqtt_client_persist(mc, MQTT_CLIENT_REC_ADD, id, keep);
+    }
+    mqtt_client_queue(mc, payload);
+    if (out_id) {
+        *out_id = id;
+    }
+    return 0;
+err:
+    os_mbuf_free_chain(keep);
+    if (empty) {
+        os_mbuf_free_chain(payload);
+    }
+    return SYS_ENOMEM;
+}
+
+static int
+mqtt_client_sub_unsub(struct mqtt_client *mc, const char *filter, int qos,
+                      int subscribe, uint16_t *out_id)
+{
+    MQTTString mstr = MQTTString_initializer;
+    struct os_mbuf *m;
+    uint16_t id;
+    int len;
+
+    if (!filter || qos > 2) {
+        return SYS_EINVAL;
+    }
+    if (mc->mc_state != MQTT_CLIENT_ST_CONNECTED) {
+        return SYS_EAGAIN;
+    }
+    m = mqtt_client_pkt_alloc();
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    id = mqtt_client_next_id(mc);
+    mstr.cstring = (char *)filter;
+    if (subscribe) {
+        len = MQTTSerialize_subscribe(m->om_data, OS_MBUF_TRAILINGSPACE(m),
+                                      0, id, 1, &mstr, &qos);
+    } else {
+        len = MQTTSerialize_unsubscribe(m->om_data, OS_MBUF_TRAILINGSPACE(m),
+                                        0, id, 1, &mstr);
+    }
+    if (len <= 0) {
+        os_mbuf_free_chain(m);
+        return SYS_EINVAL;
+    }
+    mqtt_client_pkt_set_len(m, len);
+    mqtt_client_queue(mc, m);
+    if (out_id) {
+        *out_id = id;
+    }
+    return 0;
+}
+
+int
+mqtt_client_subscribe(struct mqtt_client *mc, const char *filter,
+                      uint8_t qos, uint16_t *out_id)
+{
+    return mqtt_client_sub_unsub(mc, filter, qos, 1, out_id);
+}
+
+int
+mqtt_client_unsubscribe(struct mqtt_client *mc, const char *filter,
+                        uint16_t *out_id)
+{
+    return mqtt_client_sub_unsub(mc, filter, 0, 0, out_id);
+}
+
+int
+mqtt_client_connect(struct mqtt_client *mc, struct mn_sockaddr *addr)
+{
+    int rc;
+
+    if (mc->mc_state != MQTT_CLIENT_ST_IDLE) {
+        return MN_EINVAL;
+    }
+    rc = mn_socket(&mc->mc_sock, addr->msa_family, MN_SOCK_STREAM, 0);
+    if (rc) {
+        return rc;
+    }
+    mn_socket_set_cbs(mc->mc_sock, mc, &mqtt_client_sock_cbs);
+    mc->mc_state = MQTT_CLIENT_ST_TCP;
+    rc = mn_connect(mc->mc_sock, addr);
+    if (rc) {
+        mn_close(mc->mc_sock);
+        mc->mc_sock = NULL;
+        mc->mc_state = MQTT_CLIENT_ST_IDLE;
+    }
+    return rc;
+}
+
+void
+mqtt_client_disconnect(struct mqtt_client *mc)
+{
+    if (mc->mc_state == MQTT_CLIENT_ST_IDLE || mc->mc_closing) {
+        return;
+    }
+    if (mc->mc_state != MQTT_CLIENT_ST_TCP &&
+        mqtt_client_queue_short(mc, DISCONNECT) == 0) {
+        /* Closed once DISCONNECT has been handed to the socket. */
+        mc->mc_closing = 1;
+        return;
+    }
+    mqtt_client_close(mc, 0);
+}
+
+void
+mqtt_client_init(struct mqtt_client *mc, const struct mqtt_client_cfg *cfg,
+                 const struct mqtt_client_cbs *cbs, struct os_eventq *evq)
+{
+    memset(mc, 0, sizeof(*mc));
+    mc->mc_cfg = cfg;
+    mc->mc_cbs = cbs;
+    mc->mc_evq = evq;
+    mc->mc_next_id = 1;
+    STAILQ_INIT(&mc->mc_txq);
+
+    mc->mc_tx_ev.ev_cb = mqtt_client_tx_event;
+    mc->mc_tx_ev.ev_arg = mc;
+    mc->mc_rx_ev.ev_cb = mqtt_client_rx_event;
+    mc->mc_rx_ev.ev_arg = mc;
+    mc->mc_conn_ev.ev_cb = mqtt_client_conn_event;
+    mc->mc_conn_ev.ev_arg = mc;
+    mc->mc_err_ev.ev_cb = mqtt_client_err_event;
+    mc->mc_err_ev.ev_arg = mc;
+    os_callout_init(&mc->mc_ping_timer, evq, mqtt_client_ping_event, mc);
+}
@@ -0,0 +1,280 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(MQTT_CLIENT_PERSIST)
+
+#include <string.h>
+
+#include "fcb/fcb.h"
+#include "flash_map/flash_map.h"
+#include "mqtt_client/mqtt_client.h"
+#include "mqtt_client_priv.h"
+
+/*
+ * Session state is kept as a journal of changes to the in-flight window
+ * and the QoS 2 receive state.  Each record is this header, followed by the
+ * PUBLISH packet for MQTT_CLIENT_REC_ADD.  When the fcb fills up, the live
+ * state is written out again and the oldest sector dropped, so replaying
+ * whatever is left always ends in the current state.
+ */
+struct mqtt_client_rec {
+    uint8_t mcr_type;
+    uint8_t mcr_pad;
+    uint16_t mcr_id;
+};
+
+#define MQTT_CLIENT_PERSIST_CHUNK   32
+
+static int
+mqtt_client_persist_write(struct fcb *fcb, uint8_t type, uint16_t id,
+                          struct os_mbuf *pkt)
+{
+    struct mqtt_client_rec rec;
+    struct fcb_entry loc;
+    uint8_t buf[MQTT_CLIENT_PERSIST_CHUNK];
+    int plen;
+    int off;
+    int cnt;
+    int rc;
+
+    plen = pkt ? OS_MBUF_PKTLEN(pkt) : 0;
+    rc = fcb_append(fcb, sizeof(rec) + plen, &loc);
+    if (rc) {
+        return rc;
+    }
+
+    /* Written in whole chunks, header first, to keep flash writes aligned. */
+    rec.mcr_type = type;
+    rec.mcr_pad = 0;
+    rec.mcr_id = id;
+    memcpy(buf, &rec, sizeof(rec));
+    off = sizeof(rec);
+    cnt = min(plen, sizeof(buf) - sizeof(rec));
+    if (cnt) {
+        os_mbuf_copydata(pkt, 0, cnt, buf + sizeof(rec));
+    }
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, off + cnt);
+    off = cnt;
+    while (rc == 0 && off < plen) {
+        cnt = min(plen - off, sizeof(buf));
+        os_mbuf_copydata(pkt, off, cnt, buf);
+        rc = flash_area_write(loc.fe_area,
+                              loc.fe_data_off + sizeof(rec) + off, buf, cnt);
+        off += cnt;
+    }
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+    return fcb_append_finish(fcb, &loc);
+}
+
+/*
+ * Writes out the whole live session state.
+ */
+static int
+mqtt_client_persist_snapshot(struct mqtt_client *mc)
+{
+    struct mqtt_client_inflight *mci;
+    int rc;
+    int i;
+
+    for (i = 0; i < mc->mc_out_cnt; i++) {
+        mci = &mc->mc_out[(mc->mc_out_head + i) %
+                          MYNEWT_VAL(MQTT_CLIENT_INFLIGHT)];
+        if (mci->mci_id == 0) {
+            continue;
+        }
+        if (mci->mci_pkt) {
+            rc = mqtt_client_persist_write(mc->mc_fcb, MQTT_CLIENT_REC_ADD,
+                                           mci->mci_id, mci->mci_pkt);
+        } else {
+            rc = mqtt_client_persist_write(mc->mc_fcb, MQTT_CLIENT_REC_REL,
+                                           mci->mci_id, NULL);
+        }
+        if (rc) {
+            return rc;
+        }
+    }
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_QOS2_RX); i++) {
+        if (mc->mc_in_qos2[i] == 0) {
+            continue;
+        }
+        rc = mqtt_client_persist_write(mc->mc_fcb, MQTT_CLIENT_REC_QOS2,
+                                       mc->mc_in_qos2[i], NULL);
+        if (rc) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+static int
+mqtt_client_persist_compact(struct mqtt_client *mc)
+{
+    int scratch;
+    int rc;
+
+    /*
+     * Prefer writing the snapshot to the scratch sector, so the old
+     * records survive until it is complete.
+     */
+    scratch = fcb_append_to_scratch(mc->mc_fcb) == 0;
+    if (!scratch) {
+        rc = fcb_rotate(mc->mc_fcb);
+        if (rc) {
+            return rc;
+        }
+    }
+    rc = mqtt_client_persist_snapshot(mc);
+    if (rc == 0 && scratch) {
+        rc = fcb_rotate(mc->mc_fcb);
+    }
+    return rc;
+}
+
+/*
+ * Records a change made to mc.  Called after the in-memory state has been
+ * updated, so a snapshot taken here already includes it.
+ */
+void
+mqtt_client_persist(struct mqtt_client *mc, uint8_t type, uint16_t id,
+                    struct os_mbuf *pkt)
+{
+    int rc;
+
+    if (!mc->mc_fcb) {
+        return;
+    }
+    if (type == MQTT_CLIENT_REC_CLEAR) {
+        fcb_clear(mc->mc_fcb);
+        return;
+    }
+    rc = mqtt_client_persist_write(mc->mc_fcb, type, id, pkt);
+    if (rc == FCB_ERR_NOSPACE) {
+        mqtt_client_persist_compact(mc);
+    }
+}
+
+static int
+mqtt_client_persist_read_pkt(struct fcb_entry *loc, struct os_mbuf **mp)
+{
+    uint8_t buf[MQTT_CLIENT_PERSIST_CHUNK];
+    struct os_mbuf *m;
+    int plen;
+    int off;
+    int cnt;
+
+    plen = loc->fe_data_len - sizeof(struct mqtt_client_rec);
+    m = os_msys_get_pkthdr(0, 0);
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    for (off = 0; off < plen; off += cnt) {
+        cnt = min(plen - off, sizeof(buf));
+        if (flash_area_read(loc->fe_area, loc->fe_data_off +
+                            sizeof(struct mqtt_client_rec) + off, buf, cnt) ||
+            os_mbuf_append(m, buf, cnt)) {
+            os_mbuf_free_chain(m);
+            return SYS_EIO;
+        }
+    }
+    *mp = m;
+    return 0;
+}
+
+static int
+mqtt_client_persist_load_cb(struct fcb_entry *loc, void *arg)
+{
+    struct mqtt_client *mc = arg;
+    struct mqtt_client_inflight *mci;
+    struct mqtt_client_rec rec;
+    struct os_mbuf *m;
+    int rc;
+
+    if (loc->fe_data_len < sizeof(rec) ||
+        flash_area_read(loc->fe_area, loc->fe_data_off, &rec, sizeof(rec))) {
+        return 0;
+    }
+    if (rec.mcr_id == 0) {
+        return 0;
+    }
+    mci = mqtt_client_out_find(mc, rec.mcr_id);
+
+    switch (rec.mcr_type) {
+    case MQTT_CLIENT_REC_ADD:
+        rc = mqtt_client_persist_read_pkt(loc, &m);
+        if (rc) {
+            return rc;
+        }
+        if (!mci) {
+            mci = mqtt_client_out_alloc(mc, rec.mcr_id);
+        }
+        if (!mci) {
+            os_mbuf_free_chain(m);
+            break;
+        }
+        os_mbuf_free_chain(mci->mci_pkt);
+        mci->mci_pkt = m;
+        m->om_data[0] |= MQTT_CLIENT_HDR_DUP;
+        mci->mci_state = ((m->om_data[0] >> 1) & 0x03) == 1 ?
+                         MQTT_CLIENT_OUT_PUBACK : MQTT_CLIENT_OUT_PUBREC;
+        break;
+    case MQTT_CLIENT_REC_REL:
+        if (!mci) {
+            mci = mqtt_client_out_alloc(mc, rec.mcr_id);
+        }
+        if (mci) {
+            os_mbuf_free_chain(mci->mci_pkt);
+            mci->mci_pkt = NULL;
+            mci->mci_state = MQTT_CLIENT_OUT_PUBCOMP;
+        }
+        break;
+    case MQTT_CLIENT_REC_DONE:
+        if (mci) {
+            mqtt_client_out_free(mc, mci);
+        }
+        break;
+    case MQTT_CLIENT_REC_QOS2:
+        mqtt_client_qos2_del(mc, rec.mcr_id);
+        mqtt_client_qos2_add(mc, rec.mcr_id);
+        break;
+    case MQTT_CLIENT_REC_QOS2_DONE:
+        mqtt_client_qos2_del(mc, rec.mcr_id);
+        break;
+    }
+    if (rec.mcr_id >= mc->mc_next_id) {
+        mc->mc_next_id = rec.mcr_id + 1;
+    }
+    return 0;
+}
+
+int
+mqtt_client_persist_init(struct mqtt_client *mc, struct fcb *fcb)
+{
+    int rc;
+
+    mc->mc_fcb = NULL;
+    rc = fcb_walk(fcb, NULL, mqtt_client_persist_load_cb, mc);
+    mc->mc_fcb = fcb;
+    return rc;
+}
+
+#endif
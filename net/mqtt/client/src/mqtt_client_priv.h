@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __MQTT_CLIENT_PRIV_H_
+#define __MQTT_CLIENT_PRIV_H_
+
+#include "mqtt_client/mqtt_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* mc_state */
+#define MQTT_CLIENT_ST_IDLE         0
+#define MQTT_CLIENT_ST_TCP          1   /* waiting for TCP connection */
+#define MQTT_CLIENT_ST_CONNECTING   2   /* CONNECT sent */
+#define MQTT_CLIENT_ST_CONNECTED    3
+
+/* mci_state */
+#define MQTT_CLIENT_OUT_PUBACK      1
+#define MQTT_CLIENT_OUT_PUBREC      2
+#define MQTT_CLIENT_OUT_PUBCOMP     3
+
+#define MQTT_CLIENT_HDR_DUP         0x08
+
+struct mqtt_client_inflight *mqtt_client_out_find(struct mqtt_client *mc,
+                                                  uint16_t id);
+struct mqtt_client_inflight *mqtt_client_out_alloc(struct mqtt_client *mc,
+                                                   uint16_t id);
+void mqtt_client_out_free(struct mqtt_client *mc,
+                          struct mqtt_client_inflight *mci);
+int mqtt_client_qos2_add(struct mqtt_client *mc, uint16_t id);
+void mqtt_client_qos2_del(struct mqtt_client *mc, uint16_t id);
+
+/* Session journal records. */
+#define MQTT_CLIENT_REC_ADD         1   /* PUBLISH entered the window */
+#define MQTT_CLIENT_REC_REL         2   /* PUBREC received */
+#define MQTT_CLIENT_REC_DONE        3   /* message left the window */
+#define MQTT_CLIENT_REC_QOS2        4   /* incoming QoS 2 message */
+#define MQTT_CLIENT_REC_QOS2_DONE   5   /* PUBREL received */
+#define MQTT_CLIENT_REC_CLEAR       6   /* session discarded */
+
+#if MYNEWT_VAL(MQTT_CLIENT_PERSIST)
+void mqtt_client_persist(struct mqtt_client *mc, uint8_t type, uint16_t id,
+                         struct os_mbuf *pkt);
+#else
+#define mqtt_client_persist(mc, type, id, pkt)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MQTT_CLIENT_PRIV_H_ */
@@ -31,6 +31,14 @@ DLLExport int MQTTSerialize_publish(unsigned char* buf, int buflen, unsigned cha
 DLLExport int MQTTDeserialize_publish(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid, MQTTString* topicName,
 		unsigned char** payload, int* payloadlen, unsigned char* buf, int len);
 
+struct os_mbuf;
+
+DLLExport int MQTTSerialize_publish_mbuf(struct os_mbuf** om, unsigned char dup, int qos, unsigned char retained, unsigned short packetid,
+		MQTTString topicName);
+
+DLLExport int MQTTDeserialize_publish_mbuf(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid,
+		int* topicoff, int* topiclen, int* payloadoff, int* payloadlen, const struct os_mbuf* om, int off);
+
 DLLExport int MQTTSerialize_puback(unsigned char* buf, int buflen, unsigned short packetid);
 DLLExport int MQTTSerialize_pubrel(unsigned char* buf, int buflen, unsigned char dup, unsigned short packetid);
 DLLExport int MQTTSerialize_pubcomp(unsigned char* buf, int buflen, unsigned short packetid);
@@ -0,0 +1,204 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * PUBLISH serialization on mbuf chains, so payloads never need to be
+ * flattened into one contiguous buffer.
+ */
+
+#include "os/mynewt.h"
+#include "MQTTPacket.h"
+#include "StackTrace.h"
+
+#include <string.h>
+
+int MQTTSerialize_publishLength(int qos, MQTTString topicName, int payloadlen);
+
+/**
+  * Serializes a publish in front of the payload chain; the payload itself
+  * is neither copied nor moved.  The header goes into the leading space of
+  * the first mbuf when there is room, otherwise into a new mbuf that is
+  * chained ahead of it.
+  * @param om in: the payload chain (a packet header mbuf).  out: the packet
+  * @param dup integer - the MQTT dup flag
+  * @param qos integer - the MQTT QoS value
+  * @param retained integer - the MQTT retained flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param topicName MQTTString - the MQTT topic in the publish
+  * @return the length of the serialized packet.  <= 0 indicates error, in
+  * which case the chain is left as it was
+  */
+int MQTTSerialize_publish_mbuf(struct os_mbuf** om, unsigned char dup, int qos, unsigned char retained, unsigned short packetid,
+		MQTTString topicName)
+{
+	unsigned char hdr[9];
+	unsigned char *ptr = hdr;
+	MQTTHeader header = {0};
+	struct os_mbuf *n;
+	int payloadlen = OS_MBUF_PKTLEN(*om);
+	int topiclen = MQTTstrlen(topicName);
+	int rem_len = 0;
+	int hdrlen = 0;
+	int rc = 0;
+
+	FUNC_ENTRY;
+	rem_len = MQTTSerialize_publishLength(qos, topicName, payloadlen);
+	if (topiclen > 0xffff || rem_len > 268435455)
+	{
+		rc = MQTTPACKET_BUFFER_TOO_SHORT;
+		goto exit;
+	}
+
+	header.bits.type = PUBLISH;
+	header.bits.dup = dup;
+	header.bits.qos = qos;
+	header.bits.retain = retained;
+	writeChar(&ptr, header.byte); /* write header */
+
+	ptr += MQTTPacket_encode(ptr, rem_len); /* write remaining length */;
+	writeInt(&ptr, topiclen);
+	hdrlen = (ptr - hdr) + topiclen + (qos > 0 ? 2 : 0);
+
+	if (OS_MBUF_LEADINGSPACE(*om) >= hdrlen)
+	{
+		*om = os_mbuf_prepend(*om, hdrlen);
+		n = NULL;
+	}
+	else
+	{
+		n = os_msys_get_pkthdr(hdrlen, OS_MBUF_USRHDR_LEN(*om));
+		if (n == NULL)
+		{
+			rc = MQTTPACKET_BUFFER_TOO_SHORT;
+			goto exit;
+		}
+		memcpy(OS_MBUF_USRHDR(n), OS_MBUF_USRHDR(*om), OS_MBUF_USRHDR_LEN(*om));
+	}
+
+	if (n == NULL)
+	{
+		os_mbuf_copyinto(*om, 0, hdr, ptr - hdr);
+		os_mbuf_copyinto(*om, ptr - hdr, topicName.cstring ? topicName.cstring : topicName.lenstring.data, topiclen);
+		if (qos > 0)
+		{
+			hdr[0] = packetid >> 8;
+			hdr[1] = packetid;
+			os_mbuf_copyinto(*om, hdrlen - 2, hdr, 2);
+		}
+	}
+	else
+	{
+		if (os_mbuf_append(n, hdr, ptr - hdr) ||
+			os_mbuf_append(n, topicName.cstring ? topicName.cstring : topicName.lenstring.data, topiclen))
+			goto fail;
+		if (qos > 0)
+		{
+			hdr[0] = packetid >> 8;
+			hdr[1] = packetid;
+			if (os_mbuf_append(n, hdr, 2))
+				goto fail;
+		}
+		os_mbuf_concat(n, *om);
+		*om = n;
+	}
+	rc = hdrlen + payloadlen;
+	goto exit;
+
+fail:
+	os_mbuf_free_chain(n);
+	rc = MQTTPACKET_BUFFER_TOO_SHORT;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
+
+
+/**
+  * Deserializes a publish held in an mbuf chain, without copying; the topic
+  * and payload are returned as offsets into the chain.
+  * @param dup returned integer - the MQTT dup flag
+  * @param qos returned integer - the MQTT QoS value
+  * @param retained returned integer - the MQTT retained flag
+  * @param packetid returned integer - the MQTT packet identifier
+  * @param topicoff returned integer - offset of the topic name in om
+  * @param topiclen returned integer - the length of the topic name
+  * @param payloadoff returned integer - offset of the payload in om
+  * @param payloadlen returned integer - the length of the MQTT payload
+  * @param om the chain holding the complete packet
+  * @param off offset of the packet in om
+  * @return error code.  1 is success
+  */
+int MQTTDeserialize_publish_mbuf(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid,
+		int* topicoff, int* topiclen, int* payloadoff, int* payloadlen, const struct os_mbuf* om, int off)
+{
+	MQTTHeader header = {0};
+	unsigned char buf[5];
+	int avail = OS_MBUF_PKTLEN(om) - off;
+	int cnt = 0;
+	int hdrlen = 0;
+	int mylen = 0;
+	int varlen = 0;
+	int rc = 0;
+
+	FUNC_ENTRY;
+	cnt = avail < (int)sizeof(buf) ? avail : (int)sizeof(buf);
+	if (cnt < 2 || os_mbuf_copydata(om, off, cnt, buf))
+		goto exit;
+	header.byte = buf[0];
+	if (header.bits.type != PUBLISH)
+		goto exit;
+	*dup = header.bits.dup;
+	*qos = header.bits.qos;
+	*retained = header.bits.retain;
+
+	/* read remaining length */
+	for (hdrlen = 1; hdrlen < cnt; hdrlen++)
+	{
+		mylen |= (buf[hdrlen] & 127) << (7 * (hdrlen - 1));
+		if ((buf[hdrlen] & 128) == 0)
+			break;
+	}
+	if (hdrlen == cnt)
+		goto exit;
+	hdrlen++;
+	if (avail < hdrlen + mylen || mylen < 2)
+		goto exit;
+
+	os_mbuf_copydata(om, off + hdrlen, 2, buf);
+	*topiclen = (buf[0] << 8) | buf[1];
+	*topicoff = off + hdrlen + 2;
+	varlen = 2 + *topiclen;
+	if (*qos > 0)
+	{
+		if (mylen < varlen + 2)
+			goto exit;
+		os_mbuf_copydata(om, off + hdrlen + varlen, 2, buf);
+		*packetid = (buf[0] << 8) | buf[1];
+		varlen += 2;
+	}
+	if (mylen < varlen)
+		goto exit;
+
+	*payloadoff = off + hdrlen + varlen;
+	*payloadlen = mylen - varlen;
+	rc = 1;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef COAP_BLOCK_H
+#define COAP_BLOCK_H
+
+#include "os/mynewt.h"
+
+#include "oic/messaging/coap/coap.h"
+#include "oic/port/oc_connectivity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(OC_BLOCKWISE)
+
+/*
+ * Block-wise transfers (RFC 7959) streamed from and to callbacks. Only one
+ * block is held in memory at a time, regardless of the transfer size.
+ */
+
+/**
+ * Produce data for a transfer.
+ *
+ * @param arg                   Argument given at registration.
+ * @param off                   Byte offset of the block within the body.
+ * @param m                     Mbuf to append the data to.
+ * @param len                   Block size.
+ *
+ * @return                      Number of bytes appended; less than len
+ *                                  marks the last block. Negative on error.
+ */
+typedef int (*coap_block_read_fn)(void *arg, uint32_t off, struct os_mbuf *m,
+                                  uint16_t len);
+
+/**
+ * Consume data of a transfer. Blocks can arrive out of order when
+ * transfers have more than one block in flight, and more than once when
+ * retransmitted. Client transfers signal completion through the done
+ * callback, not through more.
+ *
+ * @param arg                   Argument given at registration.
+ * @param off                   Byte offset of the block within the body.
+ * @param m                     Mbuf holding the data.
+ * @param moff                  Offset of the data within m.
+ * @param len                   Number of bytes of data.
+ * @param more                  0 if this is the last block.
+ *
+ * @return                      0 on success, non-zero to abort.
+ */
+typedef int (*coap_block_write_fn)(void *arg, uint32_t off, struct os_mbuf *m,
+                                   uint16_t moff, uint16_t len, int more);
+
+#ifdef OC_SERVER
+/*
+ * Server side resource. GET is served through cbr_read, PUT and POST are
+ * passed to cbr_write; either can be NULL. Requests are handled without
+ * per-client state, the client drives the transfer.
+ */
+struct coap_block_res {
+    SLIST_ENTRY(coap_block_res) cbr_next;
+    const char *cbr_uri;                /* without leading '/' */
+    coap_block_read_fn cbr_read;
+    coap_block_write_fn cbr_write;
+    void *cbr_arg;
+};
+
+int coap_block_res_register(struct coap_block_res *res);
+void coap_block_res_unregister(struct coap_block_res *res);
+
+int coap_block_handle_request(struct coap_packet_rx *req, coap_packet_t *rsp);
+#endif
+
+#ifdef OC_CLIENT
+/**
+ * Called once a client transfer finishes.
+ *
+ * @param arg                   Argument given when starting the transfer.
+ * @param status                0 on success, CoAP response code if the
+ *                                  server refused, -1 on timeout or local
+ *                                  failure.
+ */
+typedef void (*coap_block_done_fn)(void *arg, int status);
+
+/*
+ * Client transfer. Storage is owned by the caller and must stay valid until
+ * the done callback has been called, or the transfer is cancelled.
+ *
+ * Requests are sent as NON. The first block goes out alone to settle the
+ * block size, after that up to OC_BLOCKWISE_WINDOW blocks are kept in
+ * flight. Missing blocks are requested again after COAP_RESPONSE_TIMEOUT.
+ */
+struct coap_block_xfer {
+    SLIST_ENTRY(coap_block_xfer) cbx_next;
+    oc_endpoint_t cbx_ep;
+    const char *cbx_uri;
+    uint8_t cbx_method;
+    uint8_t cbx_retries;
+    uint8_t cbx_token[COAP_TOKEN_LEN];
+    uint16_t cbx_size;                  /* block size */
+    uint32_t cbx_base;                  /* first block not yet done */
+    uint32_t cbx_send;                  /* next block to send */
+    uint32_t cbx_last;                  /* last block, if known */
+    uint32_t cbx_done_map;              /* done blocks, from cbx_base */
+    struct os_callout cbx_timer;
+    coap_block_read_fn cbx_read;
+    coap_block_write_fn cbx_write;
+    coap_block_done_fn cbx_done;
+    void *cbx_arg;
+};
+
+int coap_block_get(struct coap_block_xfer *x, oc_endpoint_t *ep,
+                   const char *uri, coap_block_write_fn write_cb,
+                   coap_block_done_fn done_cb, void *arg);
+int coap_block_put(struct coap_block_xfer *x, oc_endpoint_t *ep,
+                   const char *uri, coap_block_read_fn read_cb,
+                   coap_block_done_fn done_cb, void *arg);
+void coap_block_cancel(struct coap_block_xfer *x);
+
+int coap_block_handle_response(struct coap_packet_rx *rsp);
+#endif
+
+#endif /* MYNEWT_VAL(OC_BLOCKWISE) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COAP_BLOCK_H */
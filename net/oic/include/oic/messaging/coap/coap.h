@@ -352,10 +352,18 @@ int coap_set_header_uri_host(coap_packet_t *, const char *host);
 
 int coap_get_header_uri_path(struct coap_packet_rx *, char *path, int maxlen);
                               /* in-place string might not be 0-terminated. */
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+/* points into the mbuf; valid as long as the packet is, not 0-terminated */
+int coap_get_header_uri_path_view(struct coap_packet_rx *, const char **path);
+#endif
 int coap_set_header_uri_path(coap_packet_t *, const char *path);
 
 int coap_get_header_uri_query(struct coap_packet_rx *, char *qry, int maxlen);
                               /* in-place string might not be 0-terminated. */
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+int coap_get_header_uri_query_view(struct coap_packet_rx *,
+                                   const char **query);
+#endif
 int coap_set_header_uri_query(coap_packet_t *, const char *query);
 
 int coap_get_header_location_path(struct coap_packet_rx *,
@@ -48,6 +48,9 @@ extern "C" {
 
 typedef struct coap_observer {
   SLIST_ENTRY(coap_observer) next;
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+  SLIST_ENTRY(coap_observer) hnext;     /* token hash bucket */
+#endif
 
   oc_resource_t *resource;
 
@@ -60,6 +63,11 @@ typedef struct coap_observer {
   int32_t obs_counter;
 
   uint8_t retrans_counter;
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+  uint8_t notified:1;           /* last_notify is valid */
+  uint8_t pending:1;            /* notification held back by rate limit */
+  os_time_t last_notify;
+#endif
 } coap_observer_t;
 
 void coap_remove_observer(coap_observer_t *o);
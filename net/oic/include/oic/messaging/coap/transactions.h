@@ -61,6 +61,10 @@ typedef struct coap_transaction {
     uint8_t retrans_counter;
     coap_message_type_t type;
     uint32_t retrans_tmo;
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+    uint8_t retrans_vbf;        /* backoff factor, in halves */
+    os_time_t start;            /* first transmission */
+#endif
     struct os_callout retrans_timer;
     struct os_mbuf *m;
 } coap_transaction_t;
@@ -72,6 +76,9 @@ coap_transaction_t *coap_new_transaction(uint16_t mid, oc_endpoint_t *);
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+void coap_transaction_rtt_sample(coap_transaction_t *t);
+#endif
 
 void coap_check_transactions(void);
 
@@ -55,6 +55,9 @@ typedef void (*oc_response_handler_t)(oc_client_response_t *);
 
 typedef struct oc_client_cb {
     SLIST_ENTRY(oc_client_cb) next;
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_ENTRY(oc_client_cb) hnext;    /* token hash bucket */
+#endif
     struct os_callout callout;
     oc_string_t uri;
     uint8_t token[COAP_TOKEN_LEN];
@@ -23,6 +23,12 @@ extern "C" {
 
 void oc_create_discovery_resource(void);
 
+/*
+ * Drops cached discovery payloads.  Called whenever the set of resources
+ * reported by /oic/res changes.
+ */
+void oc_discovery_cache_invalidate(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,6 +52,14 @@ int oc_ble_coap_gatt_srv_init(void);
 void oc_ble_coap_conn_new(uint16_t conn_handle);
 void oc_ble_coap_conn_del(uint16_t conn_handle);
 
+#if MYNEWT_VAL(OC_BLE_TX_SCHED)
+/*
+ * Returns a TX credit to a connection; call this from the GAP event
+ * handler for every BLE_GAP_EVENT_NOTIFY_TX, whatever its status.
+ */
+void oc_ble_coap_tx_done(uint16_t conn_handle);
+#endif
+
 #if (MYNEWT_VAL(OC_BLE_CENTRAL) == 1)
 void oc_ble_coap_gatt_notify_rx(uint16_t conn_handle, uint16_t att_handle,
                                 struct os_mbuf *om);
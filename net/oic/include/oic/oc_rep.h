@@ -21,6 +21,7 @@
 #include <stdint.h>
 
 #include <tinycbor/cbor.h>
+#include <tinycbor/cbor_mbuf_reader.h>
 #include "oic/oc_constants.h"
 #include "oic/oc_helpers.h"
 #include "oic/port/mynewt/config.h"
@@ -198,6 +199,58 @@ int oc_rep_finalize(void);
     g_err |= cbor_encoder_close_container(&object##_map, &key##_value_array);  \
   } while (0)
 
+/*
+ * Streaming parsing.  These walk the CBOR payload in place, straight out of
+ * the mbuf, without building an oc_rep_t tree; nothing is allocated.
+ *
+ * The reader must stay in scope, and the mbuf unmodified, for as long as any
+ * CborValue obtained through it is in use.
+ */
+struct oc_rep_reader {
+  struct cbor_mbuf_reader orr_mr;
+  CborParser orr_parser;
+};
+
+/*
+ * Starts parsing the payload at offset payload_off in m.  On success root
+ * holds the top level value (usually a map).
+ */
+CborError oc_rep_reader_init(struct oc_rep_reader *rd, struct os_mbuf *m,
+                             uint16_t payload_off, CborValue *root);
+
+/*
+ * Keys longer than this are skipped by oc_rep_map_visit().
+ */
+#define OC_REP_VISIT_KEY_MAX 32
+
+/*
+ * Called by oc_rep_map_visit() for every member of a map.  key is NUL
+ * terminated, and val is a private copy of the value iterator which the
+ * callback may consume or descend into.  Returning anything other than
+ * CborNoError ends the walk; that value is returned to the caller.
+ */
+typedef CborError (*oc_rep_visit_fn)(void *arg, const char *key,
+                                     CborValue *val);
+
+CborError oc_rep_map_visit(const CborValue *map, oc_rep_visit_fn fn,
+                           void *arg);
+
+/*
+ * Typed lookups of a single member of a map.  These return
+ * CborErrorIllegalType if the key is missing or the value has a different
+ * type.  For oc_rep_map_get_text() *len is the size of buf on entry, and the
+ * string length on return; the string is NUL terminated, and
+ * CborErrorOutOfMemory is returned if it does not fit.
+ */
+CborError oc_rep_map_get_int(const CborValue *map, const char *key,
+                             int64_t *val);
+CborError oc_rep_map_get_bool(const CborValue *map, const char *key,
+                              bool *val);
+CborError oc_rep_map_get_double(const CborValue *map, const char *key,
+                                double *val);
+CborError oc_rep_map_get_text(const CborValue *map, const char *key,
+                              char *buf, size_t *len);
+
 #ifdef OC_CLIENT
 typedef enum {
   NIL = 0,
@@ -237,6 +290,10 @@ typedef struct oc_rep_s
 uint16_t oc_parse_rep(struct os_mbuf *m, uint16_t payload_off,
                       uint16_t payload_size, oc_rep_t **out_rep);
 
+/*
+ * Frees a tree returned by oc_parse_rep().  Trees share one arena, so this
+ * also frees any tree parsed after this one; free them in reverse order.
+ */
 void oc_free_rep(oc_rep_t *rep);
 #endif
 
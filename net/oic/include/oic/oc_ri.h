@@ -49,6 +49,9 @@ typedef void (*oc_request_handler_t)(oc_request_t *, oc_interface_mask_t);
 
 typedef struct oc_resource {
   SLIST_ENTRY(oc_resource) next;
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+  SLIST_ENTRY(oc_resource) hnext;       /* URI hash bucket */
+#endif
   int device;
   oc_string_t uri;
   oc_string_array_t types;
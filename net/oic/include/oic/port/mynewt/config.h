@@ -64,6 +64,13 @@ typedef os_time_t oc_clock_time_t;
 /* Estimated number of nodes in payload tree structure */
 #define EST_NUM_REP_OBJECTS MYNEWT_VAL(OC_NUM_REP_OBJECTS)
 
+/* Size of the arena holding parsed payload trees */
+#if MYNEWT_VAL(OC_REP_ARENA_SIZE) > 0
+#define OC_REP_ARENA_SIZE   MYNEWT_VAL(OC_REP_ARENA_SIZE)
+#else
+#define OC_REP_ARENA_SIZE   (EST_NUM_REP_OBJECTS * (sizeof(oc_rep_t) + 32))
+#endif
+
 /* Maximum size of request/response PDUs */
 #define MAX_PAYLOAD_SIZE    MYNEWT_VAL(OC_MAX_PAYLOAD_SIZE)
 
@@ -86,6 +93,15 @@ typedef os_time_t oc_clock_time_t;
 /* Max inactivity timeout before tearing down DTLS connection */
 //#define DTLS_INACTIVITY_TIMEOUT (10)
 
+/* Number of idle DTLS sessions kept for reuse instead of being torn down */
+//#define DTLS_SESSION_CACHE_SIZE (1)
+
+/* Max age in seconds of an idle DTLS session in the session cache */
+//#define DTLS_SESSION_LIFETIME (600)
+
+/* Number of buckets in the DTLS peer lookup table */
+//#define DTLS_PEER_HASH_SIZE (4)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,409 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include "test_oic.h"
+
+#if MYNEWT_VAL(OC_BLOCKWISE)
+#include "oic/port/mynewt/config.h"
+#include "oic/oc_buffer.h"
+#include "oic/messaging/coap/coap.h"
+#include "oic/messaging/coap/block.h"
+
+#define TEST_BLOCK_SIZE     MYNEWT_VAL(OC_BLOCKWISE_SIZE)
+#define TEST_BLOCK_LEN      300
+
+static int test_block_state;
+static volatile int test_block_done;
+static struct oc_server_handle test_block_srv;
+static struct coap_block_xfer test_block_xfer;
+
+static uint8_t test_block_buf[TEST_BLOCK_LEN + TEST_BLOCK_SIZE];
+static uint32_t test_block_len;
+static int test_block_writes;
+static int test_block_reads;
+static int test_block_status;
+
+static void test_block_next_step(struct os_event *);
+static struct os_event test_block_next_ev = {
+    .ev_cb = test_block_next_step
+};
+
+static uint8_t
+test_block_byte(uint32_t off)
+{
+    return off * 7 + 3;
+}
+
+/*
+ * Source of test_block_byte() data, arg is the total length.
+ */
+static int
+test_block_read(void *arg, uint32_t off, struct os_mbuf *m, uint16_t len)
+{
+    uint32_t total = (uintptr_t)arg;
+    uint8_t b;
+    int i;
+
+    test_block_reads++;
+    if (off >= total) {
+        return 0;
+    }
+    len = min(len, total - off);
+    for (i = 0; i < len; i++) {
+        b = test_block_byte(off + i);
+        if (os_mbuf_append(m, &b, 1)) {
+            return -1;
+        }
+    }
+    return len;
+}
+
+static int
+test_block_write(void *arg, uint32_t off, struct os_mbuf *m, uint16_t moff,
+                 uint16_t len, int more)
+{
+    TEST_ASSERT_FATAL(off + len <= sizeof(test_block_buf));
+    TEST_ASSERT_FATAL(os_mbuf_copydata(m, moff, len,
+                                       test_block_buf + off) == 0);
+    test_block_len = max(test_block_len, off + len);
+    test_block_writes++;
+    return 0;
+}
+
+static void
+test_block_xfer_done(void *arg, int status)
+{
+    test_block_status = status;
+    if (test_block_state < 3) {
+        /* transfers through the stack move the test along */
+        os_eventq_put(os_eventq_dflt_get(), &test_block_next_ev);
+    }
+}
+
+static void
+test_block_reset(void)
+{
+    memset(test_block_buf, 0, sizeof(test_block_buf));
+    test_block_len = 0;
+    test_block_writes = 0;
+    test_block_reads = 0;
+    test_block_status = -2;
+}
+
+static void
+test_block_check(uint32_t len)
+{
+    uint32_t i;
+
+    TEST_ASSERT(test_block_len == len);
+    for (i = 0; i < len; i++) {
+        if (test_block_buf[i] != test_block_byte(i)) {
+            TEST_ASSERT(0, "mismatch at %u\n", (unsigned)i);
+            break;
+        }
+    }
+}
+
+static struct coap_block_res test_block_res = {
+    .cbr_uri = "blk",
+    .cbr_read = test_block_read,
+    .cbr_write = test_block_write,
+    .cbr_arg = (void *)TEST_BLOCK_LEN
+};
+
+/*
+ * Serializes pkt and parses it back, like it came in from the network.
+ */
+static struct os_mbuf *
+test_block_rx(coap_packet_t *pkt, struct coap_packet_rx *rx)
+{
+    struct os_mbuf *m;
+
+    m = oc_allocate_mbuf(&test_block_srv.endpoint);
+    TEST_ASSERT_FATAL(m);
+    TEST_ASSERT_FATAL(coap_serialize_message(pkt, m) == 0);
+    TEST_ASSERT_FATAL(coap_parse_message(rx, &m) == NO_ERROR);
+    return m;
+}
+
+static void
+test_block_payload(coap_packet_t *pkt, uint32_t off, uint16_t len)
+{
+    struct os_mbuf *data;
+
+    if (!len) {
+        return;
+    }
+    data = os_msys_get_pkthdr(len, 0);
+    TEST_ASSERT_FATAL(data);
+    TEST_ASSERT_FATAL(test_block_read((void *)(uintptr_t)(off + len), off,
+                                      data, len) == len);
+    pkt->payload_m = data;
+    pkt->payload_len = len;
+}
+
+/*
+ * Feeds a response to a client transfer; blk selects Block1 or Block2.
+ * Returns what coap_block_handle_response() did.
+ */
+static int
+test_block_rsp(struct coap_block_xfer *x, uint8_t code, int blk,
+               uint32_t num, uint8_t more, uint16_t size, uint16_t len)
+{
+    static coap_packet_t pkt[1];
+    struct coap_packet_rx rx;
+    struct os_mbuf *m;
+    int rc;
+
+    coap_init_message(pkt, COAP_TYPE_NON, code, coap_get_mid());
+    coap_set_token(pkt, x->cbx_token, sizeof(x->cbx_token));
+    if (blk == 1) {
+        coap_set_header_block1(pkt, num, more, size);
+    } else {
+        coap_set_header_block2(pkt, num, more, size);
+        test_block_payload(pkt, num * size, len);
+    }
+    m = test_block_rx(pkt, &rx);
+    rc = coap_block_handle_response(&rx);
+    os_mbuf_free_chain(m);
+    return rc;
+}
+
+/*
+ * Feeds a request to the server side, and returns the response in rsp.
+ */
+static void
+test_block_req(uint8_t code, int blk, uint32_t num, uint8_t more,
+               uint16_t size, uint16_t len, coap_packet_t *rsp)
+{
+    static coap_packet_t pkt[1];
+    struct coap_packet_rx rx;
+    struct os_mbuf *m;
+
+    coap_init_message(pkt, COAP_TYPE_NON, code, coap_get_mid());
+    coap_set_header_uri_path(pkt, test_block_res.cbr_uri);
+    if (blk == 1) {
+        coap_set_header_block1(pkt, num, more, size);
+        test_block_payload(pkt, num * size, len);
+    } else {
+        coap_set_header_block2(pkt, num, more, size);
+    }
+    m = test_block_rx(pkt, &rx);
+    coap_init_message(rsp, COAP_TYPE_NON, 0, rx.mid);
+    TEST_ASSERT(coap_block_handle_request(&rx, rsp) == 1);
+    os_mbuf_free_chain(m);
+}
+
+/*
+ * Client GET where the server asks for smaller blocks, and answers the
+ * rest out of order and twice.
+ */
+static void
+test_block_client_get(void)
+{
+    struct coap_block_xfer x;
+    uint16_t size = TEST_BLOCK_SIZE / 2;
+    int rc;
+
+    test_block_reset();
+    rc = coap_block_get(&x, &test_block_srv.endpoint, "/blk_none",
+                        test_block_write, test_block_xfer_done, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(x.cbx_size == TEST_BLOCK_SIZE);
+    TEST_ASSERT(x.cbx_send == 1);
+
+    /* smaller block size is adopted, window opens */
+    test_block_rsp(&x, CONTENT_2_05, 2, 0, 1, size, size);
+    TEST_ASSERT(x.cbx_size == size);
+    TEST_ASSERT(x.cbx_base == 1);
+    TEST_ASSERT(x.cbx_send == 1 + MYNEWT_VAL(OC_BLOCKWISE_WINDOW));
+
+    /* size can't change after the first block */
+    test_block_rsp(&x, CONTENT_2_05, 2, 1, 1, size / 2, size / 2);
+    TEST_ASSERT(test_block_writes == 1);
+
+    /* out of order, then duplicate */
+    test_block_rsp(&x, CONTENT_2_05, 2, 2, 1, size, size);
+    TEST_ASSERT(test_block_writes == 2);
+    TEST_ASSERT(x.cbx_base == 1);
+    test_block_rsp(&x, CONTENT_2_05, 2, 2, 1, size, size);
+    TEST_ASSERT(test_block_writes == 2);
+
+    /* gap filled, window slides past both */
+    test_block_rsp(&x, CONTENT_2_05, 2, 1, 1, size, size);
+    TEST_ASSERT(test_block_writes == 3);
+    TEST_ASSERT(x.cbx_base == 3);
+    test_block_rsp(&x, CONTENT_2_05, 2, 1, 1, size, size);
+    TEST_ASSERT(test_block_writes == 3);
+
+    test_block_rsp(&x, CONTENT_2_05, 2, 3, 0, size, 10);
+    TEST_ASSERT(test_block_status == 0);
+    TEST_ASSERT(test_block_writes == 4);
+    test_block_check(3 * size + 10);
+
+    /* finished; late blocks belong to nothing */
+    rc = test_block_rsp(&x, CONTENT_2_05, 2, 4, 0, size, 0);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(test_block_writes == 4);
+}
+
+/*
+ * Client PUT where the server refuses the first block as too large, then
+ * acknowledges the rest out of order and twice.
+ */
+static void
+test_block_client_put(void)
+{
+    struct coap_block_xfer x;
+    uint16_t size = TEST_BLOCK_SIZE / 2;
+    int rc;
+
+    test_block_reset();
+    rc = coap_block_put(&x, &test_block_srv.endpoint, "/blk_none",
+                        test_block_read, test_block_xfer_done,
+                        (void *)(uintptr_t)(3 * size + 10));
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(test_block_reads == 1);
+
+    /* restarted from block 0 with the smaller size */
+    test_block_rsp(&x, REQUEST_ENTITY_TOO_LARGE_4_13, 1, 0, 0, size, 0);
+    TEST_ASSERT(x.cbx_size == size);
+    TEST_ASSERT(x.cbx_base == 0);
+    TEST_ASSERT(x.cbx_send == 1);
+    TEST_ASSERT(test_block_reads == 2);
+
+    /* blocks 1-3 sent, 3 is short and so the last */
+    test_block_rsp(&x, CONTINUE_2_31, 1, 0, 1, size, 0);
+    TEST_ASSERT(x.cbx_base == 1);
+    TEST_ASSERT(x.cbx_send == 4);
+    TEST_ASSERT(x.cbx_last == 3);
+
+    test_block_rsp(&x, CHANGED_2_04, 1, 3, 0, size, 0);
+    test_block_rsp(&x, CONTINUE_2_31, 1, 2, 1, size, 0);
+    test_block_rsp(&x, CONTINUE_2_31, 1, 2, 1, size, 0);
+    TEST_ASSERT(x.cbx_base == 1);
+    TEST_ASSERT(test_block_status == -2);
+
+    test_block_rsp(&x, CONTINUE_2_31, 1, 1, 1, size, 0);
+    TEST_ASSERT(test_block_status == 0);
+}
+
+/*
+ * Server answers with its own block size when the client asks for more.
+ */
+static void
+test_block_server(void)
+{
+    coap_packet_t rsp;
+
+    test_block_req(COAP_GET, 2, 0, 0, 1024, 0, &rsp);
+    TEST_ASSERT(rsp.code == CONTENT_2_05);
+    TEST_ASSERT(rsp.block2_num == 0);
+    TEST_ASSERT(rsp.block2_size == TEST_BLOCK_SIZE);
+    TEST_ASSERT(rsp.block2_more == 1);
+    TEST_ASSERT(rsp.payload_len == TEST_BLOCK_SIZE);
+    os_mbuf_free_chain(rsp.payload_m);
+
+    /* same offset, expressed in the server's block size */
+    test_block_req(COAP_GET, 2, 1, 0, 1024, 0, &rsp);
+    TEST_ASSERT(rsp.block2_num == 1024 / TEST_BLOCK_SIZE);
+    TEST_ASSERT(rsp.block2_more == 0);
+    TEST_ASSERT(rsp.payload_len == 0);
+    TEST_ASSERT(rsp.payload_m == NULL);
+
+    test_block_req(COAP_GET, 2, 4, 0, 16, 0, &rsp);
+    TEST_ASSERT(rsp.block2_num == 4);
+    TEST_ASSERT(rsp.block2_size == 16);
+    TEST_ASSERT(rsp.payload_len == 16);
+    os_mbuf_free_chain(rsp.payload_m);
+
+    test_block_reset();
+    test_block_req(COAP_PUT, 1, 0, 1, 1024, 0, &rsp);
+    TEST_ASSERT(rsp.code == REQUEST_ENTITY_TOO_LARGE_4_13);
+    TEST_ASSERT(rsp.block1_size == TEST_BLOCK_SIZE);
+    TEST_ASSERT(test_block_writes == 0);
+
+    test_block_req(COAP_PUT, 1, 1, 0, 16, 8, &rsp);
+    TEST_ASSERT(rsp.code == CHANGED_2_04);
+    TEST_ASSERT(rsp.block1_num == 1);
+    TEST_ASSERT(test_block_writes == 1);
+    TEST_ASSERT(test_block_len == 16 + 8);
+}
+
+static void
+test_block_next_step(struct os_event *ev)
+{
+    int rc;
+
+    test_block_state++;
+    switch (test_block_state) {
+    case 1:
+        rc = coap_block_res_register(&test_block_res);
+        TEST_ASSERT_FATAL(rc == 0);
+        oic_test_get_endpoint(&test_block_srv);
+
+        /* Block2 reassembly through the stack */
+        test_block_reset();
+        rc = coap_block_get(&test_block_xfer, &test_block_srv.endpoint,
+                            "/blk", test_block_write, test_block_xfer_done,
+                            NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        oic_test_reset_tmo("block get");
+        break;
+    case 2:
+        TEST_ASSERT(test_block_status == 0);
+        test_block_check(TEST_BLOCK_LEN);
+
+        /* Block1 reassembly through the stack */
+        test_block_reset();
+        rc = coap_block_put(&test_block_xfer, &test_block_srv.endpoint,
+                            "/blk", test_block_read, test_block_xfer_done,
+                            (void *)TEST_BLOCK_LEN);
+        TEST_ASSERT_FATAL(rc == 0);
+        oic_test_reset_tmo("block put");
+        break;
+    case 3:
+        TEST_ASSERT(test_block_status == 0);
+        test_block_check(TEST_BLOCK_LEN);
+
+        test_block_client_get();
+        test_block_client_put();
+        test_block_server();
+
+        coap_block_res_unregister(&test_block_res);
+        test_block_done = 1;
+        break;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+}
+#endif
+
+void
+test_block(void)
+{
+#if MYNEWT_VAL(OC_BLOCKWISE)
+    os_eventq_put(os_eventq_dflt_get(), &test_block_next_ev);
+    while (!test_block_done)
+        ;
+#endif
+}
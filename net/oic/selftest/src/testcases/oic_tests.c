@@ -81,6 +81,7 @@ TEST_CASE_TASK(oic_tests)
     oc_main_init(&test_handler);
     test_discovery();
     test_getset();
+    test_block();
     test_observe();
     oc_main_shutdown();
 }
@@ -24,8 +24,106 @@
 #include "oic/messaging/coap/oc_coap.h"
 #include "oic/oc_api.h"
 #include "oic/oc_core_res.h"
+#include "oic/oc_discovery.h"
 #include "oic/port/mynewt/ip.h"
 
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE) > 0
+/* Longest "rt" query value a cached payload can be keyed on. */
+#define OC_DISCOVERY_CACHE_RT_LEN   32
+
+/*
+ * Encoded discovery payload for one interface and "rt" query.
+ */
+struct oc_discovery_cache_entry {
+    struct os_mbuf *odc_m;      /* payload; NULL if there were no matches */
+    uint32_t odc_used;          /* LRU stamp; 0 if the entry is unused */
+    oc_interface_mask_t odc_if;
+    uint8_t odc_rt_len;
+    char odc_rt[OC_DISCOVERY_CACHE_RT_LEN];
+};
+
+static struct oc_discovery_cache_entry
+    oc_discovery_cache[MYNEWT_VAL(OC_DISCOVERY_CACHE)];
+static uint32_t oc_discovery_cache_stamp;
+
+static struct oc_discovery_cache_entry *
+oc_discovery_cache_find(oc_interface_mask_t interface, const char *rt,
+                        int rt_len)
+{
+    struct oc_discovery_cache_entry *odc;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OC_DISCOVERY_CACHE); i++) {
+        odc = &oc_discovery_cache[i];
+        if (odc->odc_used && odc->odc_if == interface &&
+            odc->odc_rt_len == rt_len && !memcmp(odc->odc_rt, rt, rt_len)) {
+            odc->odc_used = ++oc_discovery_cache_stamp;
+            return odc;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Stores a copy of the payload just encoded, replacing the least recently
+ * used entry.
+ */
+static void
+oc_discovery_cache_add(oc_interface_mask_t interface, const char *rt,
+                       int rt_len, struct os_mbuf *payload)
+{
+    struct oc_discovery_cache_entry *odc;
+    struct os_mbuf *m = NULL;
+    int i;
+
+    if (rt_len > OC_DISCOVERY_CACHE_RT_LEN) {
+        return;
+    }
+    if (payload) {
+        m = os_msys_get_pkthdr(0, 0);
+        if (!m) {
+            return;
+        }
+        if (os_mbuf_appendfrom(m, payload, 0, OS_MBUF_PKTLEN(payload))) {
+            os_mbuf_free_chain(m);
+            return;
+        }
+    }
+
+    odc = &oc_discovery_cache[0];
+    for (i = 1; i < MYNEWT_VAL(OC_DISCOVERY_CACHE); i++) {
+        if (oc_discovery_cache[i].odc_used < odc->odc_used) {
+            odc = &oc_discovery_cache[i];
+        }
+    }
+    if (odc->odc_m) {
+        os_mbuf_free_chain(odc->odc_m);
+    }
+    odc->odc_m = m;
+    odc->odc_used = ++oc_discovery_cache_stamp;
+    odc->odc_if = interface;
+    odc->odc_rt_len = rt_len;
+    memcpy(odc->odc_rt, rt, rt_len);
+}
+#endif
+
+void
+oc_discovery_cache_invalidate(void)
+{
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE) > 0
+    struct oc_discovery_cache_entry *odc;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OC_DISCOVERY_CACHE); i++) {
+        odc = &oc_discovery_cache[i];
+        if (odc->odc_m) {
+            os_mbuf_free_chain(odc->odc_m);
+        }
+        memset(odc, 0, sizeof(*odc));
+    }
+#endif
+}
+
 static bool
 filter_resource(oc_resource_t *resource, const char *rt, int rt_len,
                 CborEncoder *links)
@@ -135,9 +233,29 @@ oc_core_discovery_handler(oc_request_t *req, oc_interface_mask_t interface)
 {
     char *rt = NULL;
     int rt_len = 0, matches = 0;
+    int response_length;
     char uuid[37];
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE) > 0
+    struct oc_discovery_cache_entry *odc;
+    struct os_mbuf *m = req->response->response_buffer->buffer;
+#endif
 
     rt_len = oc_ri_get_query_value(req->query, req->query_len, "rt", &rt);
+    if (rt_len < 0) {
+        rt_len = 0;
+    }
+
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE) > 0
+    odc = oc_discovery_cache_find(interface, rt, rt_len);
+    if (odc) {
+        if (odc->odc_m && !os_mbuf_appendfrom(m, odc->odc_m, 0,
+                                              OS_MBUF_PKTLEN(odc->odc_m))) {
+            matches = 1;
+        }
+        response_length = oc_rep_finalize();
+        goto done;
+    }
+#endif
 
     oc_uuid_to_str(oc_core_get_device_id(0), uuid, sizeof(uuid));
 
@@ -159,7 +277,15 @@ oc_core_discovery_handler(oc_request_t *req, oc_interface_mask_t interface)
         break;
     }
 
-    int response_length = oc_rep_finalize();
+    response_length = oc_rep_finalize();
+
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE) > 0
+    if (response_length >= 0 &&
+        (interface == OC_IF_LL || interface == OC_IF_BASELINE)) {
+        oc_discovery_cache_add(interface, rt, rt_len, matches ? m : NULL);
+    }
+done:
+#endif
 
     if (matches && response_length > 0) {
         req->response->response_buffer->response_length = response_length;
@@ -19,6 +19,43 @@
 #ifndef __OC_OC_PRIV_H__
 #define __OC_OC_PRIV_H__
 
+#include <stdint.h>
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+#if (MYNEWT_VAL(OC_HASH_BUCKETS) & (MYNEWT_VAL(OC_HASH_BUCKETS) - 1)) != 0
+#error "OC_HASH_BUCKETS must be a power of two"
+#endif
+
+#define OC_HASH_BUCKETS     MYNEWT_VAL(OC_HASH_BUCKETS)
+
+/*
+ * Bucket index for a byte string (URI path, token). FNV-1a; the keys are
+ * short, so this is cheaper than the string compares it replaces.
+ */
+static inline int
+oc_hash_buf(const void *buf, int len)
+{
+    const uint8_t *p = buf;
+    uint32_t h = 2166136261UL;
+
+    while (len-- > 0) {
+        h = (h ^ *p++) * 16777619UL;
+    }
+    return (h ^ (h >> 16)) & (OC_HASH_BUCKETS - 1);
+}
+
+/*
+ * Bucket index for a CoAP message ID. These are handed out sequentially,
+ * so the low bits spread well on their own.
+ */
+static inline int
+oc_hash_mid(uint16_t mid)
+{
+    return mid & (OC_HASH_BUCKETS - 1);
+}
+#endif
+
 void oc_rep_init(void);
 void oc_buffer_init(void);
 void oc_ri_mem_init(void);
@@ -17,6 +17,7 @@
 #include <stddef.h>
 
 #include "os/mynewt.h"
+#include "mem/mem.h"
 
 #include <tinycbor/cbor_mbuf_writer.h>
 #include <tinycbor/cbor_mbuf_reader.h>
@@ -28,9 +29,12 @@
 #include "api/oc_priv.h"
 
 #ifdef OC_CLIENT
-static struct os_mempool oc_rep_objects;
-static uint8_t oc_rep_objects_area[OS_MEMPOOL_BYTES(EST_NUM_REP_OBJECTS,
-      sizeof(oc_rep_t))];
+/*
+ * Parsed payload trees, including their strings and arrays, are carved out
+ * of this arena and released in one step by oc_free_rep().
+ */
+static struct mem_arena oc_rep_arena;
+static uint8_t oc_rep_arena_area[OC_REP_ARENA_SIZE];
 #endif
 
 static struct os_mbuf *g_outm;
@@ -64,23 +68,172 @@ oc_rep_reset(void)
     memset(&g_encoder, 0, sizeof(g_encoder));
 }
 
+CborError
+oc_rep_reader_init(struct oc_rep_reader *rd, struct os_mbuf *m,
+                   uint16_t payload_off, CborValue *root)
+{
+    cbor_mbuf_reader_init(&rd->orr_mr, m, payload_off);
+    return cbor_parser_init(&rd->orr_mr.r, 0, &rd->orr_parser, root);
+}
+
+CborError
+oc_rep_map_visit(const CborValue *map, oc_rep_visit_fn fn, void *arg)
+{
+    char key[OC_REP_VISIT_KEY_MAX + 1];
+    CborValue it;
+    CborValue val;
+    CborError err;
+    size_t len;
+
+    if (!cbor_value_is_map(map)) {
+        return CborErrorIllegalType;
+    }
+    err = cbor_value_enter_container(map, &it);
+    while (err == CborNoError && !cbor_value_at_end(&it)) {
+        if (!cbor_value_is_text_string(&it)) {
+            return CborErrorIllegalType;
+        }
+        len = sizeof(key);
+        err = cbor_value_copy_text_string(&it, key, &len, &it);
+        if (err == CborErrorOutOfMemory ||
+            (err == CborNoError && len >= sizeof(key))) {
+            /* Key does not fit; the iterator is at its value, skip that. */
+            err = cbor_value_advance(&it);
+            continue;
+        }
+        if (err != CborNoError) {
+            break;
+        }
+        val = it;
+        err = fn(arg, key, &val);
+        if (err != CborNoError) {
+            break;
+        }
+        err = cbor_value_advance(&it);
+    }
+    return err;
+}
+
+static CborError
+oc_rep_map_find(const CborValue *map, const char *key, CborValue *val)
+{
+    CborError err;
+
+    if (!cbor_value_is_map(map)) {
+        return CborErrorIllegalType;
+    }
+    err = cbor_value_map_find_value(map, key, val);
+    if (err == CborNoError && !cbor_value_is_valid(val)) {
+        err = CborErrorIllegalType;
+    }
+    return err;
+}
+
+CborError
+oc_rep_map_get_int(const CborValue *map, const char *key, int64_t *val)
+{
+    CborValue v;
+    CborError err;
+
+    err = oc_rep_map_find(map, key, &v);
+    if (err == CborNoError) {
+        if (!cbor_value_is_integer(&v)) {
+            return CborErrorIllegalType;
+        }
+        err = cbor_value_get_int64(&v, val);
+    }
+    return err;
+}
+
+CborError
+oc_rep_map_get_bool(const CborValue *map, const char *key, bool *val)
+{
+    CborValue v;
+    CborError err;
+
+    err = oc_rep_map_find(map, key, &v);
+    if (err == CborNoError) {
+        if (!cbor_value_is_boolean(&v)) {
+            return CborErrorIllegalType;
+        }
+        err = cbor_value_get_boolean(&v, val);
+    }
+    return err;
+}
+
+CborError
+oc_rep_map_get_double(const CborValue *map, const char *key, double *val)
+{
+    CborValue v;
+    CborError err;
+
+    err = oc_rep_map_find(map, key, &v);
+    if (err == CborNoError) {
+        if (!cbor_value_is_double(&v)) {
+            return CborErrorIllegalType;
+        }
+        err = cbor_value_get_double(&v, val);
+    }
+    return err;
+}
+
+CborError
+oc_rep_map_get_text(const CborValue *map, const char *key, char *buf,
+                    size_t *len)
+{
+    CborValue v;
+    CborError err;
+    size_t buf_sz;
+
+    err = oc_rep_map_find(map, key, &v);
+    if (err == CborNoError) {
+        if (!cbor_value_is_text_string(&v)) {
+            return CborErrorIllegalType;
+        }
+        buf_sz = *len;
+        err = cbor_value_copy_text_string(&v, buf, len, NULL);
+        if (err == CborNoError && *len >= buf_sz) {
+            /* No room left for the terminating NUL. */
+            err = CborErrorOutOfMemory;
+        }
+    }
+    return err;
+}
+
 #ifdef OC_CLIENT
 static oc_rep_t *
 _alloc_rep(void)
 {
-    oc_rep_t *rep = os_memblock_get(&oc_rep_objects);
+    oc_rep_t *rep = mem_arena_alloc(&oc_rep_arena, sizeof(*rep));
 
-    memset(rep, 0, sizeof(*rep));
-#ifdef DEBUG
-    oc_assert(rep != NULL);
-#endif
+    if (rep != NULL) {
+        memset(rep, 0, sizeof(*rep));
+    }
     return rep;
 }
 
-static void
-_free_rep(oc_rep_t *rep_value)
+static int
+_alloc_rep_string(oc_string_t *os, size_t len)
 {
-    os_memblock_put(&oc_rep_objects, rep_value);
+    os->os_str = mem_arena_alloc(&oc_rep_arena, len);
+    if (os->os_str == NULL) {
+        os->os_sz = 0;
+        return -1;
+    }
+    os->os_sz = len;
+    return 0;
+}
+
+static int
+_alloc_rep_array(oc_array_t *oa, size_t len, size_t elem_sz)
+{
+    oa->oa_arr.b = mem_arena_alloc(&oc_rep_arena, len * elem_sz);
+    if (oa->oa_arr.b == NULL) {
+        oa->oa_sz = 0;
+        return -1;
+    }
+    oa->oa_sz = len * elem_sz;
+    return 0;
 }
 
 void
@@ -89,36 +242,12 @@ oc_free_rep(oc_rep_t *rep)
     if (rep == NULL) {
         return;
     }
-    oc_free_rep(rep->next);
-    switch (rep->type) {
-    case BYTE_STRING_ARRAY:
-    case STRING_ARRAY:
-        oc_free_string_array(&rep->value_array);
-        break;
-    case BOOL_ARRAY:
-        oc_free_bool_array(&rep->value_array);
-        break;
-    case DOUBLE_ARRAY:
-        oc_free_double_array(&rep->value_array);
-        break;
-    case INT_ARRAY:
-        oc_free_int_array(&rep->value_array);
-        break;
-    case BYTE_STRING:
-    case STRING:
-        oc_free_string(&rep->value_string);
-        break;
-    case OBJECT:
-        oc_free_rep(rep->value_object);
-        break;
-    case OBJECT_ARRAY:
-        oc_free_rep(rep->value_object_array);
-        break;
-    default:
-        break;
-    }
-    oc_free_string(&rep->name);
-    _free_rep(rep);
+
+    /*
+     * The root of a tree is its first allocation; everything else parsed
+     * into it lies above it in the arena.
+     */
+    mem_arena_release(&oc_rep_arena, rep);
 }
 
 /*
@@ -138,16 +267,23 @@ oc_free_rep(oc_rep_t *rep)
 static void
 oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
 {
-  size_t k, len;
+  size_t i, k, len;
   CborValue map, array;
   *rep = _alloc_rep();
+  if (*rep == NULL) {
+    *err |= CborErrorOutOfMemory;
+    return;
+  }
   oc_rep_t *cur = *rep, **prev = 0;
   cur->next = 0;
   cur->value_object_array = 0;
   /* key */
   *err |= cbor_value_calculate_string_length(value, &len);
   len++;
-  oc_alloc_string(&cur->name, len);
+  if (_alloc_rep_string(&cur->name, len)) {
+    *err |= CborErrorOutOfMemory;
+    return;
+  }
   *err |= cbor_value_copy_text_string(value, oc_string(cur->name), &len, NULL);
   *err |= cbor_value_advance(value);
   /* value */
@@ -167,7 +303,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
   case CborByteStringType:
     *err |= cbor_value_calculate_string_length(value, &len);
     len++;
-    oc_alloc_string(&cur->value_string, len);
+    if (_alloc_rep_string(&cur->value_string, len)) {
+      *err |= CborErrorOutOfMemory;
+      return;
+    }
     *err |= cbor_value_copy_byte_string(value,
                                         (uint8_t *)oc_string(cur->value_string),
                                         &len, NULL);
@@ -176,7 +315,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
   case CborTextStringType:
     *err |= cbor_value_calculate_string_length(value, &len);
     len++;
-    oc_alloc_string(&cur->value_string, len);
+    if (_alloc_rep_string(&cur->value_string, len)) {
+      *err |= CborErrorOutOfMemory;
+      return;
+    }
     *err |= cbor_value_copy_text_string(value, oc_string(cur->value_string),
                                         &len, NULL);
     cur->type = STRING;
@@ -186,6 +328,9 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
     *err |= cbor_value_enter_container(value, &map);
     while (!cbor_value_at_end(&map)) {
       oc_parse_rep_value(&map, obj, err);
+      if (*obj == NULL) {
+        return;
+      }
       (*obj)->next = 0;
       obj = &(*obj)->next;
       *err |= cbor_value_advance(&map);
@@ -208,7 +353,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
       switch (array.type) {
       case CborIntegerType:
         if (k == 0) {
-          oc_new_int_array(&cur->value_array, len);
+          if (_alloc_rep_array(&cur->value_array, len, sizeof(int64_t))) {
+            *err |= CborErrorOutOfMemory;
+            return;
+          }
           cur->type = INT | ARRAY;
         }
         *err |=
@@ -216,7 +364,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
         break;
       case CborDoubleType:
         if (k == 0) {
-          oc_new_double_array(&cur->value_array, len);
+          if (_alloc_rep_array(&cur->value_array, len, sizeof(double))) {
+            *err |= CborErrorOutOfMemory;
+            return;
+          }
           cur->type = DOUBLE | ARRAY;
         }
         *err |=
@@ -224,7 +375,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
         break;
       case CborBooleanType:
         if (k == 0) {
-          oc_new_bool_array(&cur->value_array, len);
+          if (_alloc_rep_array(&cur->value_array, len, sizeof(bool))) {
+            *err |= CborErrorOutOfMemory;
+            return;
+          }
           cur->type = BOOL | ARRAY;
         }
         *err |=
@@ -232,7 +386,14 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
         break;
       case CborByteStringType:
         if (k == 0) {
-          oc_new_string_array(&cur->value_array, len);
+          if (_alloc_rep_array(&cur->value_array, len,
+                               STRING_ARRAY_ITEM_MAX_LEN)) {
+            *err |= CborErrorOutOfMemory;
+            return;
+          }
+          for (i = 0; i < len; i++) {
+            oc_string_array_get_item(cur->value_array, i)[0] = '\0';
+          }
           cur->type = BYTE_STRING | ARRAY;
         }
         *err |= cbor_value_calculate_string_length(&array, &len);
@@ -243,7 +404,14 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
         break;
       case CborTextStringType:
         if (k == 0) {
-          oc_new_string_array(&cur->value_array, len);
+          if (_alloc_rep_array(&cur->value_array, len,
+                               STRING_ARRAY_ITEM_MAX_LEN)) {
+            *err |= CborErrorOutOfMemory;
+            return;
+          }
+          for (i = 0; i < len; i++) {
+            oc_string_array_get_item(cur->value_array, i)[0] = '\0';
+          }
           cur->type = STRING | ARRAY;
         }
         *err |= cbor_value_calculate_string_length(&array, &len);
@@ -261,6 +429,10 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
           (*prev)->next = _alloc_rep();
           prev = &(*prev)->next;
         }
+        if (*prev == NULL) {
+          *err |= CborErrorOutOfMemory;
+          return;
+        }
         (*prev)->type = OBJECT;
         (*prev)->next = 0;
         oc_rep_t **obj = &(*prev)->value_object;
@@ -268,6 +440,9 @@ oc_parse_rep_value(CborValue *value, oc_rep_t **rep, CborError *err)
         *err |= cbor_value_enter_container(&array, &map);
         while (!cbor_value_at_end(&map)) {
           oc_parse_rep_value(&map, obj, err);
+          if (*obj == NULL) {
+            return;
+          }
           obj = &(*obj)->next;
           *err |= cbor_value_advance(&map);
         }
@@ -301,6 +476,9 @@ oc_parse_rep(struct os_mbuf *m, uint16_t payload_off,
     oc_rep_t **cur = out_rep;
     while (cbor_value_is_valid(&cur_value)) {
       oc_parse_rep_value(&cur_value, cur, &err);
+      if (*cur == NULL) {
+        break;
+      }
       err |= cbor_value_advance(&cur_value);
       cur = &(*cur)->next;
     }
@@ -311,6 +489,10 @@ oc_parse_rep(struct os_mbuf *m, uint16_t payload_off,
     oc_rep_t **cur = out_rep;
     while (cbor_value_is_valid(&cur_value)) {
       *cur = _alloc_rep();
+      if (*cur == NULL) {
+        err |= CborErrorOutOfMemory;
+        break;
+      }
       (*cur)->type = OBJECT;
       oc_parse_rep_value(&cur_value, &(*cur)->value_object, &err);
       err |= cbor_value_advance(&cur_value);
@@ -324,7 +506,7 @@ oc_parse_rep(struct os_mbuf *m, uint16_t payload_off,
 void
 oc_rep_init(void)
 {
-    os_mempool_init(&oc_rep_objects, EST_NUM_REP_OBJECTS,
-                    sizeof(oc_rep_t), oc_rep_objects_area, "oc_rep_o");
+    mem_arena_init(&oc_rep_arena, oc_rep_arena_area,
+                   sizeof(oc_rep_arena_area));
 }
 #endif
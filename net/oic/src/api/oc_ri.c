@@ -49,6 +49,9 @@ static SLIST_HEAD(, oc_resource) oc_app_resources =
 static struct os_mempool oc_resource_pool;
 static uint8_t oc_resource_area[OS_MEMPOOL_BYTES(MAX_APP_RESOURCES,
       sizeof(oc_resource_t))];
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+static SLIST_HEAD(, oc_resource) oc_app_resource_hash[OC_HASH_BUCKETS];
+#endif
 
 static void periodic_observe_handler(struct os_event *ev);
 #endif /* OC_SERVER */
@@ -56,6 +59,9 @@ static void periodic_observe_handler(struct os_event *ev);
 #ifdef OC_CLIENT
 #include "oc_client_state.h"
 static SLIST_HEAD(, oc_client_cb) oc_client_cbs;
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+static SLIST_HEAD(, oc_client_cb) oc_client_cb_hash[OC_HASH_BUCKETS];
+#endif
 static struct os_mempool oc_client_cb_pool;
 static uint8_t oc_client_cb_area[OS_MEMPOOL_BYTES(MAX_NUM_CONCURRENT_REQUESTS,
       sizeof(oc_client_cb_t))];
@@ -191,19 +197,65 @@ stop_processes(void)
 }
 
 #ifdef OC_SERVER
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+/*
+ * Resources are hashed on the URI without the leading '/', which is the
+ * form the path arrives in as CoAP Uri-Path.
+ */
+static int
+oc_ri_uri_hash(const char *uri, int len)
+{
+    if (len > 0 && uri[0] == '/') {
+        uri++;
+        len--;
+    }
+    return oc_hash_buf(uri, len);
+}
+#endif
+
 oc_resource_t *
 oc_ri_get_app_resource_by_uri(const char *uri)
 {
     oc_resource_t *res;
+    int len = strlen(uri);
 
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_FOREACH(res, &oc_app_resource_hash[oc_ri_uri_hash(uri, len)],
+                  hnext) {
+#else
     SLIST_FOREACH(res, &oc_app_resources, next) {
-        if (oc_string_len(res->uri) == strlen(uri) &&
-          strncmp(uri, oc_string(res->uri), strlen(uri)) == 0)
+#endif
+        if (oc_string_len(res->uri) == len &&
+          strncmp(uri, oc_string(res->uri), len) == 0)
             return res;
     }
 
     return NULL;
 }
+
+/*
+ * Find application resource by URI path as carried in a request, i.e.
+ * without the leading '/'.
+ */
+static oc_resource_t *
+oc_ri_get_app_resource_by_path(const char *path, int len)
+{
+    oc_resource_t *res;
+
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_FOREACH(res, &oc_app_resource_hash[oc_ri_uri_hash(path, len)],
+                  hnext) {
+#else
+    SLIST_FOREACH(res, &oc_app_resources, next) {
+#endif
+        if (oc_string_len(res->uri) == (len + 1) &&
+          strncmp((const char *)oc_string(res->uri) + 1, path, len) == 0) {
+            return res;
+        }
+    }
+
+    return NULL;
+}
 #endif
 
 void
@@ -224,8 +276,17 @@ oc_ri_mem_init(void)
 void
 oc_ri_init(void)
 {
+#if defined(OC_CLIENT) && MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    int i;
+#endif
+
 #ifdef OC_CLIENT
     SLIST_INIT(&oc_client_cbs);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    for (i = 0; i < OC_HASH_BUCKETS; i++) {
+        SLIST_INIT(&oc_client_cb_hash[i]);
+    }
+#endif
 #endif
 
     start_processes();
@@ -261,10 +322,16 @@ oc_ri_delete_resource(oc_resource_t *resource)
     SLIST_FOREACH(tmp, &oc_app_resources, next) {
         if (tmp == resource) {
             SLIST_REMOVE(&oc_app_resources, tmp, oc_resource, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+            SLIST_REMOVE(&oc_app_resource_hash[oc_ri_uri_hash(
+                  oc_string(resource->uri), oc_string_len(resource->uri))],
+                tmp, oc_resource, hnext);
+#endif
             break;
         }
     }
     os_memblock_put(&oc_resource_pool, resource);
+    oc_discovery_cache_invalidate();
 }
 
 bool
@@ -282,6 +349,12 @@ oc_ri_add_resource(oc_resource_t *resource)
     }
     if (valid) {
         SLIST_INSERT_HEAD(&oc_app_resources, resource, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+        SLIST_INSERT_HEAD(&oc_app_resource_hash[oc_ri_uri_hash(
+              oc_string(resource->uri), oc_string_len(resource->uri))],
+            resource, hnext);
+#endif
+        oc_discovery_cache_invalidate();
     }
 
     return valid;
@@ -431,6 +504,14 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   /* Initialize OCF interface selector. */
   oc_interface_mask_t interface = 0;
 
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+  /* Request uri and query string are read in place from the CoAP packet. */
+  const char *uri_path = NULL;
+  int uri_path_len = coap_get_header_uri_path_view(request, &uri_path);
+
+  const char *uri_query = NULL;
+  int uri_query_len = coap_get_header_uri_query_view(request, &uri_query);
+#else
   /* Obtain request uri from the CoAP packet. */
   char uri_path[COAP_MAX_URI];
   int uri_path_len = coap_get_header_uri_path(request, uri_path,
@@ -440,6 +521,7 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   char uri_query[COAP_MAX_URI_QUERY];
   int uri_query_len = coap_get_header_uri_query(request, uri_query,
                                                 sizeof(uri_query));
+#endif
 
   if (uri_query_len) {
     request_obj.query = uri_query;
@@ -477,13 +559,9 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   /* Check against list of declared application resources.
    */
   if (!cur_resource && !bad_request) {
-      SLIST_FOREACH(resource, &oc_app_resources, next) {
-          if (oc_string_len(resource->uri) == (uri_path_len + 1) &&
-            strncmp((const char *)oc_string(resource->uri) + 1, uri_path,
-              uri_path_len) == 0) {
-              request_obj.resource = cur_resource = resource;
-              break;
-          }
+      cur_resource = oc_ri_get_app_resource_by_path(uri_path, uri_path_len);
+      if (cur_resource) {
+          request_obj.resource = cur_resource;
       }
   }
 #endif
@@ -697,6 +775,10 @@ free_client_cb(oc_client_cb_t *cb)
     os_callout_stop(&cb->callout);
     oc_free_string(&cb->uri);
     SLIST_REMOVE(&oc_client_cbs, cb, oc_client_cb, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_REMOVE(&oc_client_cb_hash[oc_hash_buf(cb->token, cb->token_len)],
+                 cb, oc_client_cb, hnext);
+#endif
     os_memblock_put(&oc_client_cb_pool, cb);
 }
 
@@ -757,9 +839,18 @@ oc_ri_invoke_client_cb(struct coap_packet_rx *rsp, oc_endpoint_t *endpoint)
     */
     coap_get_header_content_format(rsp, &content_format);
 
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    cb = SLIST_FIRST(&oc_client_cb_hash[oc_hash_buf(rsp->token,
+                                                    rsp->token_len)]);
+#else
     cb = SLIST_FIRST(&oc_client_cbs);
+#endif
     while (cb != NULL) {
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+        tmp = SLIST_NEXT(cb, hnext);
+#else
         tmp = SLIST_NEXT(cb, next);
+#endif
         if (cb->token_len != rsp->token_len ||
             memcmp(cb->token, rsp->token, rsp->token_len)) {
             cb = tmp;
@@ -902,6 +993,11 @@ oc_ri_alloc_client_cb(const char *uri, oc_server_handle_t *server,
     os_callout_init(&cb->callout, oc_evq_get(), oc_ri_remove_cb, cb);
 
     SLIST_INSERT_HEAD(&oc_client_cbs, cb, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_INSERT_HEAD(&oc_client_cb_hash[oc_hash_buf(cb->token,
+                                                     cb->token_len)],
+                      cb, hnext);
+#endif
     return cb;
 }
 #endif /* OC_CLIENT */
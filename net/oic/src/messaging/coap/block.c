@@ -0,0 +1,549 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OC_BLOCKWISE)
+
+#include "oic/port/mynewt/config.h"
+#include "oic/port/oc_random.h"
+#include "oic/messaging/coap/coap.h"
+#include "oic/messaging/coap/transactions.h"
+#include "oic/messaging/coap/block.h"
+#include "oic/oc_buffer.h"
+#include "port/mynewt/adaptor.h"
+
+#if MYNEWT_VAL(OC_BLOCKWISE_WINDOW) < 1 || MYNEWT_VAL(OC_BLOCKWISE_WINDOW) > 32
+#error "OC_BLOCKWISE_WINDOW must be between 1 and 32"
+#endif
+
+#define COAP_BLOCK_SIZE     MIN(MYNEWT_VAL(OC_BLOCKWISE_SIZE), \
+                                COAP_MAX_BLOCK_SIZE)
+#define COAP_BLOCK_WINDOW   MYNEWT_VAL(OC_BLOCKWISE_WINDOW)
+
+#ifdef OC_SERVER
+static SLIST_HEAD(, coap_block_res) coap_block_resources =
+    SLIST_HEAD_INITIALIZER(&coap_block_resources);
+
+int
+coap_block_res_register(struct coap_block_res *res)
+{
+    SLIST_INSERT_HEAD(&coap_block_resources, res, cbr_next);
+    return 0;
+}
+
+void
+coap_block_res_unregister(struct coap_block_res *res)
+{
+    SLIST_REMOVE(&coap_block_resources, res, coap_block_res, cbr_next);
+}
+
+static struct coap_block_res *
+coap_block_res_find(struct coap_packet_rx *req)
+{
+    struct coap_block_res *res;
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+    const char *path = NULL;
+    int len;
+
+    len = coap_get_header_uri_path_view(req, &path);
+#else
+    char path[COAP_MAX_URI];
+    int len;
+
+    len = coap_get_header_uri_path(req, path, sizeof(path));
+#endif
+    SLIST_FOREACH(res, &coap_block_resources, cbr_next) {
+        if (strlen(res->cbr_uri) == len &&
+            memcmp(res->cbr_uri, path, len) == 0) {
+            return res;
+        }
+    }
+    return NULL;
+}
+
+static void
+coap_block_serve_get(struct coap_block_res *res, struct coap_packet_rx *req,
+                     coap_packet_t *rsp)
+{
+    struct os_mbuf *m;
+    uint32_t num = 0;
+    uint32_t off = 0;
+    uint16_t size = COAP_BLOCK_SIZE;
+    int rc;
+
+    if (coap_get_header_block2(req, &num, NULL, &size, &off)) {
+        /* answer with a smaller block at the same offset if need be */
+        size = MIN(size, COAP_BLOCK_SIZE);
+        num = off / size;
+    }
+
+    m = os_msys_get_pkthdr(size, 0);
+    if (!m) {
+        rsp->code = SERVICE_UNAVAILABLE_5_03;
+        return;
+    }
+    rc = res->cbr_read(res->cbr_arg, off, m, size);
+    if (rc < 0 || rc > size) {
+        os_mbuf_free_chain(m);
+        rsp->code = INTERNAL_SERVER_ERROR_5_00;
+        return;
+    }
+    rsp->code = CONTENT_2_05;
+    coap_set_header_content_format(rsp, APPLICATION_OCTET_STREAM);
+    coap_set_header_block2(rsp, num, rc == size, size);
+    if (rc) {
+        rsp->payload_m = m;
+        rsp->payload_len = rc;
+    } else {
+        os_mbuf_free_chain(m);
+    }
+}
+
+static void
+coap_block_serve_put(struct coap_block_res *res, struct coap_packet_rx *req,
+                     coap_packet_t *rsp)
+{
+    uint32_t num = 0;
+    uint32_t off = 0;
+    uint16_t size = 0;
+    uint8_t more = 0;
+    int blk;
+
+    blk = coap_get_header_block1(req, &num, &more, &size, &off);
+    if (blk && size > COAP_BLOCK_SIZE) {
+        /* tell the client which size to use instead */
+        rsp->code = REQUEST_ENTITY_TOO_LARGE_4_13;
+        coap_set_header_block1(rsp, 0, 0, COAP_BLOCK_SIZE);
+        return;
+    }
+    if (res->cbr_write(res->cbr_arg, off, req->m, req->payload_off,
+                       req->payload_len, more)) {
+        rsp->code = INTERNAL_SERVER_ERROR_5_00;
+        return;
+    }
+    rsp->code = more ? CONTINUE_2_31 : CHANGED_2_04;
+    if (blk) {
+        coap_set_header_block1(rsp, num, more, size);
+    }
+}
+
+/**
+ * Serve a request if it is for a registered block resource.
+ *
+ * @param req                   Incoming request.
+ * @param rsp                   Response, initialized by the caller.
+ *
+ * @return                      1 if rsp was filled in, 0 if the request is
+ *                                  for some other resource.
+ */
+int
+coap_block_handle_request(struct coap_packet_rx *req, coap_packet_t *rsp)
+{
+    struct coap_block_res *res;
+
+    if (SLIST_EMPTY(&coap_block_resources)) {
+        return 0;
+    }
+    res = coap_block_res_find(req);
+    if (!res) {
+        return 0;
+    }
+
+    switch (req->code) {
+    case COAP_GET:
+        if (res->cbr_read) {
+            coap_block_serve_get(res, req, rsp);
+            return 1;
+        }
+        break;
+    case COAP_PUT:
+    case COAP_POST:
+        if (res->cbr_write) {
+            coap_block_serve_put(res, req, rsp);
+            return 1;
+        }
+        break;
+    default:
+        break;
+    }
+    rsp->code = METHOD_NOT_ALLOWED_4_05;
+    return 1;
+}
+#endif /* OC_SERVER */
+
+#ifdef OC_CLIENT
+#define COAP_BLOCK_LAST_UNKNOWN     UINT32_MAX
+
+/* coap_block_rx_*() return values other than a block number */
+#define COAP_BLOCK_RX_IGNORE        -1  /* stale, or transfer finished */
+#define COAP_BLOCK_RX_REFILL        -2  /* block size changed, resend */
+
+static SLIST_HEAD(, coap_block_xfer) coap_block_xfers =
+    SLIST_HEAD_INITIALIZER(&coap_block_xfers);
+
+static void
+coap_block_finish(struct coap_block_xfer *x, int status)
+{
+    os_callout_stop(&x->cbx_timer);
+    SLIST_REMOVE(&coap_block_xfers, x, coap_block_xfer, cbx_next);
+    if (x->cbx_done) {
+        x->cbx_done(x->cbx_arg, status);
+    }
+}
+
+static int
+coap_block_send(struct coap_block_xfer *x, uint32_t num)
+{
+    static coap_packet_t pkt[1];
+    struct os_mbuf *m;
+    struct os_mbuf *data;
+    int rc;
+
+    m = oc_allocate_mbuf(&x->cbx_ep);
+    if (!m) {
+        return -1;
+    }
+    coap_init_message(pkt, COAP_TYPE_NON, x->cbx_method, coap_get_mid());
+    coap_set_token(pkt, x->cbx_token, sizeof(x->cbx_token));
+    coap_set_header_uri_path(pkt, x->cbx_uri);
+
+    if (x->cbx_method == COAP_GET) {
+        coap_set_header_block2(pkt, num, 0, x->cbx_size);
+    } else {
+        /* data is read again for retransmits, nothing is kept around */
+        data = os_msys_get_pkthdr(x->cbx_size, 0);
+        if (!data) {
+            goto err;
+        }
+        rc = x->cbx_read(x->cbx_arg, num * x->cbx_size, data, x->cbx_size);
+        if (rc < 0 || rc > x->cbx_size) {
+            os_mbuf_free_chain(data);
+            goto err;
+        }
+        if (rc < x->cbx_size) {
+            x->cbx_last = num;
+        }
+        coap_set_header_content_format(pkt, APPLICATION_OCTET_STREAM);
+        coap_set_header_block1(pkt, num, rc == x->cbx_size, x->cbx_size);
+        if (rc) {
+            pkt->payload_m = data;
+            pkt->payload_len = rc;
+        } else {
+            os_mbuf_free_chain(data);
+        }
+    }
+    if (coap_serialize_message(pkt, m)) {
+        goto err;
+    }
+    coap_send_message(m, 0);
+    return 0;
+err:
+    os_mbuf_free_chain(m);
+    return -1;
+}
+
+/*
+ * Send new blocks until the window is full. While the block size is not
+ * settled only block 0 is sent.
+ */
+static int
+coap_block_fill(struct coap_block_xfer *x)
+{
+    uint32_t lim;
+
+    if (x->cbx_base == 0) {
+        lim = 1;
+    } else {
+        lim = x->cbx_base + COAP_BLOCK_WINDOW;
+    }
+    while (x->cbx_send < lim && x->cbx_send <= x->cbx_last) {
+        if (coap_block_send(x, x->cbx_send)) {
+            return -1;
+        }
+        x->cbx_send++;
+    }
+    return 0;
+}
+
+static void
+coap_block_timeout(struct os_event *ev)
+{
+    struct coap_block_xfer *x = ev->ev_arg;
+    uint32_t num;
+
+    if (++x->cbx_retries > COAP_MAX_RETRANSMIT) {
+        coap_block_finish(x, -1);
+        return;
+    }
+    for (num = x->cbx_base; num < x->cbx_send && num <= x->cbx_last; num++) {
+        if (x->cbx_done_map & (1UL << (num - x->cbx_base))) {
+            continue;
+        }
+        if (coap_block_send(x, num)) {
+            break;
+        }
+    }
+    os_callout_reset(&x->cbx_timer, COAP_RESPONSE_TIMEOUT_TICKS);
+}
+
+static int
+coap_block_start(struct coap_block_xfer *x, oc_endpoint_t *ep,
+                 const char *uri, uint8_t method)
+{
+    uint16_t r;
+    int i;
+
+    memcpy(&x->cbx_ep, ep, oc_endpoint_size(ep));
+    while (uri[0] == '/') {
+        uri++;
+    }
+    x->cbx_uri = uri;
+    x->cbx_method = method;
+    x->cbx_retries = 0;
+    for (i = 0; i < sizeof(x->cbx_token); i += sizeof(r)) {
+        r = oc_random_rand();
+        memcpy(x->cbx_token + i, &r, sizeof(r));
+    }
+    x->cbx_size = COAP_BLOCK_SIZE;
+    x->cbx_base = 0;
+    x->cbx_send = 0;
+    x->cbx_last = COAP_BLOCK_LAST_UNKNOWN;
+    x->cbx_done_map = 0;
+    os_callout_init(&x->cbx_timer, oc_evq_get(), coap_block_timeout, x);
+
+    if (coap_block_fill(x)) {
+        return -1;
+    }
+    SLIST_INSERT_HEAD(&coap_block_xfers, x, cbx_next);
+    os_callout_reset(&x->cbx_timer, COAP_RESPONSE_TIMEOUT_TICKS);
+    return 0;
+}
+
+/**
+ * Start fetching uri from ep with block-wise GET.
+ *
+ * @return                      0 on success, -1 if the first request could
+ *                                  not be sent.
+ */
+int
+coap_block_get(struct coap_block_xfer *x, oc_endpoint_t *ep, const char *uri,
+               coap_block_write_fn write_cb, coap_block_done_fn done_cb,
+               void *arg)
+{
+    x->cbx_read = NULL;
+    x->cbx_write = write_cb;
+    x->cbx_done = done_cb;
+    x->cbx_arg = arg;
+    return coap_block_start(x, ep, uri, COAP_GET);
+}
+
+/**
+ * Start uploading to uri at ep with block-wise PUT.
+ *
+ * @return                      0 on success, -1 if the first request could
+ *                                  not be sent.
+ */
+int
+coap_block_put(struct coap_block_xfer *x, oc_endpoint_t *ep, const char *uri,
+               coap_block_read_fn read_cb, coap_block_done_fn done_cb,
+               void *arg)
+{
+    x->cbx_read = read_cb;
+    x->cbx_write = NULL;
+    x->cbx_done = done_cb;
+    x->cbx_arg = arg;
+    return coap_block_start(x, ep, uri, COAP_PUT);
+}
+
+/**
+ * Stop a transfer; the done callback is not called.
+ */
+void
+coap_block_cancel(struct coap_block_xfer *x)
+{
+    struct coap_block_xfer *tmp;
+
+    SLIST_FOREACH(tmp, &coap_block_xfers, cbx_next) {
+        if (tmp == x) {
+            os_callout_stop(&x->cbx_timer);
+            SLIST_REMOVE(&coap_block_xfers, x, coap_block_xfer, cbx_next);
+            break;
+        }
+    }
+}
+
+/*
+ * Returns the block number completed by rsp, or one of COAP_BLOCK_RX_*.
+ */
+static int32_t
+coap_block_rx_get(struct coap_block_xfer *x, struct coap_packet_rx *rsp)
+{
+    uint32_t num;
+    uint16_t size;
+    uint8_t more;
+
+    if (rsp->code != CONTENT_2_05) {
+        coap_block_finish(x, rsp->code);
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (!coap_get_header_block2(rsp, &num, &more, &size, NULL)) {
+        /* server is not block aware; this is the whole body */
+        if (x->cbx_base || x->cbx_write(x->cbx_arg, 0, rsp->m,
+                                        rsp->payload_off,
+                                        rsp->payload_len, 0)) {
+            coap_block_finish(x, -1);
+        } else {
+            coap_block_finish(x, 0);
+        }
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (x->cbx_base == 0 && size < x->cbx_size) {
+        /* server wants smaller blocks */
+        x->cbx_size = size;
+    } else if (size != x->cbx_size) {
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (num < x->cbx_base || num >= x->cbx_send || num > x->cbx_last ||
+        (x->cbx_done_map & (1UL << (num - x->cbx_base)))) {
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    /*
+     * Blocks past the end come back empty; they can overtake the real last
+     * block, so they are not passed on.
+     */
+    if (rsp->payload_len && x->cbx_write(x->cbx_arg, num * size, rsp->m,
+                                         rsp->payload_off, rsp->payload_len,
+                                         more)) {
+        coap_block_finish(x, -1);
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (!more) {
+        x->cbx_last = num;
+    }
+    return num;
+}
+
+static int32_t
+coap_block_rx_put(struct coap_block_xfer *x, struct coap_packet_rx *rsp)
+{
+    uint32_t num;
+    uint16_t size;
+
+    if (rsp->code != CONTINUE_2_31 && rsp->code != CHANGED_2_04 &&
+        rsp->code != CREATED_2_01) {
+        if (rsp->code == REQUEST_ENTITY_TOO_LARGE_4_13 && x->cbx_base == 0 &&
+            coap_get_header_block1(rsp, NULL, NULL, &size, NULL) &&
+            size < x->cbx_size) {
+            /* start over with the size the server asked for */
+            x->cbx_size = size;
+            x->cbx_send = 0;
+            x->cbx_last = COAP_BLOCK_LAST_UNKNOWN;
+            return COAP_BLOCK_RX_REFILL;
+        }
+        coap_block_finish(x, rsp->code);
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (!coap_get_header_block1(rsp, &num, NULL, &size, NULL)) {
+        /* not block aware; fine if everything fit in the first block */
+        coap_block_finish(x, x->cbx_last == 0 ? 0 : -1);
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    if (x->cbx_base == 0 && num == 0 && size < x->cbx_size) {
+        /*
+         * Server took the first block but wants smaller ones. Continue
+         * from the same offset with the new size.
+         */
+        x->cbx_base = x->cbx_size / size;
+        x->cbx_send = x->cbx_base;
+        x->cbx_size = size;
+        x->cbx_done_map = 0;
+        if (x->cbx_last == 0) {
+            coap_block_finish(x, 0);
+            return COAP_BLOCK_RX_IGNORE;
+        }
+        x->cbx_last = COAP_BLOCK_LAST_UNKNOWN;
+        return COAP_BLOCK_RX_REFILL;
+    }
+    if (size != x->cbx_size || num < x->cbx_base || num >= x->cbx_send ||
+        (x->cbx_done_map & (1UL << (num - x->cbx_base)))) {
+        return COAP_BLOCK_RX_IGNORE;
+    }
+    return num;
+}
+
+/**
+ * Pass a response to the matching client transfer, if any.
+ *
+ * @return                      1 if rsp belonged to a block transfer, 0
+ *                                  otherwise.
+ */
+int
+coap_block_handle_response(struct coap_packet_rx *rsp)
+{
+    struct coap_block_xfer *x;
+    int32_t num;
+
+    SLIST_FOREACH(x, &coap_block_xfers, cbx_next) {
+        if (rsp->token_len == sizeof(x->cbx_token) &&
+            !memcmp(rsp->token, x->cbx_token, sizeof(x->cbx_token))) {
+            break;
+        }
+    }
+    if (!x) {
+        return 0;
+    }
+    if (rsp->code == 0) {
+        return 1;
+    }
+
+    if (x->cbx_method == COAP_GET) {
+        num = coap_block_rx_get(x, rsp);
+    } else {
+        num = coap_block_rx_put(x, rsp);
+    }
+    if (num == COAP_BLOCK_RX_IGNORE) {
+        return 1;
+    }
+    if (num >= 0) {
+        x->cbx_done_map |= 1UL << (num - x->cbx_base);
+
+        /* slide the window over blocks done in sequence */
+        while (x->cbx_done_map & 1) {
+            x->cbx_done_map >>= 1;
+            x->cbx_base++;
+        }
+        if (x->cbx_base > x->cbx_last) {
+            coap_block_finish(x, 0);
+            return 1;
+        }
+    }
+    x->cbx_retries = 0;
+    if (coap_block_fill(x)) {
+        coap_block_finish(x, -1);
+        return 1;
+    }
+    os_callout_reset(&x->cbx_timer, COAP_RESPONSE_TIMEOUT_TICKS);
+    return 1;
+}
+#endif /* OC_CLIENT */
+
+#endif /* MYNEWT_VAL(OC_BLOCKWISE) */
@@ -247,6 +247,15 @@ coap_merge_multi_option(struct os_mbuf *m, uint16_t *off1, uint16_t *len1,
 
     /* merge multiple options */
     if (*len1 > 0) {
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+        if (off2 + len2 <= m->om_len) {
+            /* both in the contiguous area; second one is always later */
+            m->om_data[*off1 + *len1] = separator;
+            memmove(m->om_data + *off1 + *len1 + 1, m->om_data + off2, len2);
+            *len1 += 1 + len2;
+            return;
+        }
+#endif
         /* dst already contains an option: concatenate */
         os_mbuf_copyinto(m, *off1 + *len1, &separator, 1);
         *len1 += 1;
@@ -579,7 +588,13 @@ coap_parse_message(struct coap_packet_rx *pkt, struct os_mbuf **mp)
     /*
      * Make sure that the header is in contiguous area of memory.
      */
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+    /* and most likely the options, too */
+    opt_len = min(MYNEWT_VAL(OC_COAP_OPT_PULLUP),
+                  m->om_omp->omp_databuf_len - m->om_pkthdr_len);
+#else
     opt_len = sizeof(struct coap_tcp_hdr32);
+#endif
     if (opt_len > OS_MBUF_PKTLEN(m)) {
         opt_len = OS_MBUF_PKTLEN(m);
     }
@@ -885,6 +900,22 @@ err_short:
         cur_opt += opt_len;
     } /* for */
 
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+    /*
+     * Options did not fit in the initial pullup; make them contiguous now,
+     * so that coap_get_header_*_view() can hand out pointers.
+     */
+    if (m->om_len < cur_opt) {
+        m = os_mbuf_pullup(m, cur_opt);
+        *mp = m;
+        pkt->m = m;
+        if (!m) {
+            STATS_INC(coap_stats, imem);
+            return INTERNAL_SERVER_ERROR_5_00;
+        }
+    }
+#endif
+
     return NO_ERROR;
 }
 
@@ -1103,6 +1134,17 @@ coap_get_header_uri_path(struct coap_packet_rx *pkt, char *path, int maxlen)
     os_mbuf_copydata(pkt->m, pkt->uri_path_off, maxlen, path);
     return maxlen;
 }
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+int
+coap_get_header_uri_path_view(struct coap_packet_rx *pkt, const char **path)
+{
+    if (!IS_OPTION(pkt, COAP_OPTION_URI_PATH)) {
+        return 0;
+    }
+    *path = (const char *)pkt->m->om_data + pkt->uri_path_off;
+    return pkt->uri_path_len;
+}
+#endif
 #ifdef OC_CLIENT
 int
 coap_set_header_uri_path(coap_packet_t *pkt, const char *path)
@@ -1128,6 +1170,17 @@ coap_get_header_uri_query(struct coap_packet_rx *pkt, char *query, int maxlen)
     os_mbuf_copydata(pkt->m, pkt->uri_query_off, maxlen, query);
     return maxlen;
 }
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+int
+coap_get_header_uri_query_view(struct coap_packet_rx *pkt, const char **query)
+{
+    if (!IS_OPTION(pkt, COAP_OPTION_URI_QUERY)) {
+        return 0;
+    }
+    *query = (const char *)pkt->m->om_data + pkt->uri_query_off;
+    return pkt->uri_query_len;
+}
+#endif
 #ifdef OC_CLIENT
 int
 coap_set_header_uri_query(coap_packet_t *pkt, const char *query)
@@ -1372,7 +1425,8 @@ coap_get_payload(struct coap_packet_rx *pkt, struct os_mbuf **mp, uint16_t *off)
 int
 coap_set_payload(coap_packet_t *pkt, struct os_mbuf *m, size_t length)
 {
-    pkt->payload_m = os_mbuf_dup(m);
+    /* Shares the data; notifications reuse one payload for all observers */
+    pkt->payload_m = os_mbuf_clone(m);
     if (!pkt->payload_m) {
         return -1;
     }
@@ -42,6 +42,7 @@
 #include "oic/oc_buffer.h"
 #include "oic/oc_ri.h"
 #include "messaging/coap/engine.h"
+#include "oic/messaging/coap/block.h"
 
 #ifdef OC_CLIENT
 #include "oic/oc_client_state.h"
@@ -151,6 +152,11 @@ coap_receive(struct os_mbuf **mp)
             new_offset = block_offset;
         }
 
+#if MYNEWT_VAL(OC_BLOCKWISE) && defined(OC_SERVER)
+        if (coap_block_handle_request(message, response)) {
+            /* streamed resource, block options already handled */
+        } else
+#endif
         if (oc_ri_invoke_coap_entity_handler(message, response, &new_offset,
                                              OC_MBUF_ENDPOINT(m))) {
             if (erbium_status_code == NO_ERROR) {
@@ -248,6 +254,9 @@ coap_receive(struct os_mbuf **mp)
 
         /* Open transaction now cleared for ACK since mid matches */
         if ((transaction = coap_get_transaction_by_mid(message->mid))) {
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+            coap_transaction_rtt_sample(transaction);
+#endif
             coap_clear_transaction(transaction);
         }
         /* if(ACKed transaction) */
@@ -258,6 +267,9 @@ coap_receive(struct os_mbuf **mp)
          * ACKs and RSTs sent to oc_ri.. RSTs cleared, ACKs sent to
          * client.
          */
+#if MYNEWT_VAL(OC_BLOCKWISE)
+        if (!coap_block_handle_response(message))
+#endif
         oc_ri_invoke_client_cb(message, OC_MBUF_ENDPOINT(m));
 #endif
 
@@ -44,16 +44,28 @@
 #include "oic/messaging/coap/oc_coap.h"
 #include "oic/oc_rep.h"
 #include "oic/oc_ri.h"
+#include "oic/port/mynewt/adaptor.h"
+#include "api/oc_priv.h"
 
 /*-------------------*/
 uint64_t observe_counter = 3;
 /*---------------------------------------------------------------------------*/
 static SLIST_HEAD(, coap_observer) oc_observers;
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+static SLIST_HEAD(, coap_observer) oc_observer_hash[OC_HASH_BUCKETS];
+#endif
 
 static struct os_mempool coap_observer_pool;
 static uint8_t coap_observer_area[OS_MEMPOOL_BYTES(COAP_MAX_OBSERVERS,
       sizeof(coap_observer_t))];
 
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+#define COAP_OBSERVE_MIN_TICKS                                          \
+    ((MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) * OS_TICKS_PER_SEC + 999) / 1000)
+
+static struct os_callout coap_observe_rate_timer;
+#endif
+
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -80,11 +92,20 @@ add_observer(oc_resource_t *resource, oc_endpoint_t *endpoint,
         o->last_mid = 0;
         o->obs_counter = observe_counter;
         o->resource = resource;
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+        o->notified = 0;
+        o->pending = 0;
+#endif
         resource->num_observers++;
         OC_LOG_DEBUG("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
           coap_observer_pool.mp_num_blocks - coap_observer_pool.mp_num_free,
           coap_observer_pool.mp_num_blocks, o->url, o->token[0], o->token[1]);
         SLIST_INSERT_HEAD(&oc_observers, o, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+        SLIST_INSERT_HEAD(&oc_observer_hash[oc_hash_buf(o->token,
+                                                        o->token_len)],
+                          o, hnext);
+#endif
         return dup;
     }
     return -1;
@@ -98,6 +119,10 @@ coap_remove_observer(coap_observer_t *o)
     OC_LOG_DEBUG("Removing observer for /%s [0x%02X%02X]\n",
                  o->url, o->token[0], o->token[1]);
     SLIST_REMOVE(&oc_observers, o, coap_observer, next);
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    SLIST_REMOVE(&oc_observer_hash[oc_hash_buf(o->token, o->token_len)],
+                 o, coap_observer, hnext);
+#endif
     os_memblock_put(&coap_observer_pool, o);
 }
 /*---------------------------------------------------------------------------*/
@@ -127,9 +152,17 @@ coap_remove_observer_by_token(oc_endpoint_t *endpoint, uint8_t *token,
     int removed = 0;
     coap_observer_t *obs, *next;
 
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+    obs = SLIST_FIRST(&oc_observer_hash[oc_hash_buf(token, token_len)]);
+#else
     obs = SLIST_FIRST(&oc_observers);
+#endif
     while (obs) {
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+        next = SLIST_NEXT(obs, hnext);
+#else
         next = SLIST_NEXT(obs, next);
+#endif
         if (memcmp(&obs->endpoint, endpoint, oc_endpoint_size(endpoint)) == 0 &&
           obs->token_len == token_len &&
           memcmp(obs->token, token, token_len) == 0) {
@@ -202,13 +235,112 @@ coap_observer_walk(int (*walk_func)(struct coap_observer *, void *), void *arg)
     }
 }
 
+/*---------------------------------------------------------------------------*/
+/*- Rate limiting -----------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+static int coap_notify_observers_int(oc_resource_t *resource,
+                                     oc_response_buffer_t *response_buf,
+                                     oc_endpoint_t *endpoint, int pending);
+static void coap_observe_rate_cb(struct os_event *ev);
+
+/*
+ * Returns ticks until observer can be notified again, 0 if it can be now.
+ */
+static os_time_t
+coap_observer_holdoff(coap_observer_t *obs, os_time_t now)
+{
+    os_time_t elapsed;
+
+    if (!obs->notified) {
+        return 0;
+    }
+    elapsed = now - obs->last_notify;
+    if (elapsed >= COAP_OBSERVE_MIN_TICKS) {
+        return 0;
+    }
+    return COAP_OBSERVE_MIN_TICKS - elapsed;
+}
+
+/*
+ * Arms timer for the observer whose held back notification is due first.
+ */
+static void
+coap_observe_rate_arm(void)
+{
+    coap_observer_t *obs;
+    os_time_t now;
+    os_time_t ticks;
+    os_time_t min;
+    int found;
+
+    now = os_time_get();
+    found = 0;
+    min = 0;
+    SLIST_FOREACH(obs, &oc_observers, next) {
+        if (!obs->pending) {
+            continue;
+        }
+        ticks = coap_observer_holdoff(obs, now);
+        if (!found || ticks < min) {
+            min = ticks;
+            found = 1;
+        }
+    }
+    if (!found) {
+        os_callout_stop(&coap_observe_rate_timer);
+        return;
+    }
+    if (!os_callout_queued(&coap_observe_rate_timer)) {
+        os_callout_init(&coap_observe_rate_timer, oc_evq_get(),
+                        coap_observe_rate_cb, NULL);
+    }
+    os_callout_reset(&coap_observe_rate_timer, min);
+}
+
+static void
+coap_observe_rate_cb(struct os_event *ev)
+{
+    coap_observer_t *obs;
+    os_time_t now;
+
+    now = os_time_get();
+    SLIST_FOREACH(obs, &oc_observers, next) {
+        if (obs->pending && !coap_observer_holdoff(obs, now)) {
+            /* Sends to all due observers of the resource; clears pending */
+            coap_notify_observers_int(obs->resource, NULL, NULL, 1);
+        }
+    }
+    coap_observe_rate_arm();
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
 int
 coap_notify_observers(oc_resource_t *resource,
                       oc_response_buffer_t *response_buf,
                       oc_endpoint_t *endpoint)
+{
+    return coap_notify_observers_int(resource, response_buf, endpoint, 0);
+}
+
+/*
+ * With pending set, only observers with a held back notification which is
+ * now due are notified.
+ */
+static int
+coap_notify_observers_int(oc_resource_t *resource,
+                          oc_response_buffer_t *response_buf,
+                          oc_endpoint_t *endpoint, int pending)
+#else
+int
+coap_notify_observers(oc_resource_t *resource,
+                      oc_response_buffer_t *response_buf,
+                      oc_endpoint_t *endpoint)
+#endif
 {
     int num_observers = 0;
     coap_observer_t *obs = NULL;
@@ -221,6 +353,10 @@ coap_notify_observers(oc_resource_t *resource,
     coap_packet_t notification[1];
     coap_transaction_t *transaction = NULL;
     struct os_mbuf *m = NULL;
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+    os_time_t now = os_time_get();
+    int held = 0;
+#endif
 
     if (resource) {
         if (!resource->num_observers) {
@@ -242,8 +378,26 @@ coap_notify_observers(oc_resource_t *resource,
             continue;
         }
 
-        response.separate_response = 0;
         num_observers = obs->resource->num_observers;
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+        /*
+         * Bound the notification rate of each observer; a held back
+         * notification is sent with the then current state once due.
+         * Replies to a specific endpoint are not limited.
+         */
+        if (!endpoint) {
+            if (pending && !obs->pending) {
+                continue;
+            }
+            if (coap_observer_holdoff(obs, now)) {
+                obs->pending = 1;
+                held = 1;
+                continue;
+            }
+        }
+#endif
+
+        response.separate_response = 0;
         if (!response_buf && resource) {
             OC_LOG_DEBUG("coap_notify_observers: GET request to resource\n");
             /* performing GET on the resource */
@@ -288,6 +442,11 @@ coap_notify_observers(oc_resource_t *resource,
                                                     &obs->endpoint))) {
 
                 OC_LOG_DEBUG("coap_notify_observers: notifying observer\n");
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+                obs->pending = 0;
+                obs->notified = 1;
+                obs->last_notify = now;
+#endif
 
                 /* update last MID for RST matching */
                 obs->last_mid = transaction->mid;
@@ -316,20 +475,17 @@ coap_notify_observers(oc_resource_t *resource,
                 }
                 coap_set_token(notification, obs->token, obs->token_len);
 
+                /*
+                 * The representation is encoded once per round and shared
+                 * by the notifications to all observers; only the header
+                 * differs.
+                 */
                 if (!coap_serialize_message(notification, transaction->m)) {
                     transaction->type = notification->type;
                     coap_send_transaction(transaction);
                 } else {
                     coap_clear_transaction(transaction);
                 }
-                if (response_buf == &response_buffer) {
-                    /*
-                     * We allocated mbuf, and it's still valid.
-                     */
-                    os_mbuf_free_chain(m);
-                    m = NULL;
-                    response_buf = NULL;
-                }
             } else if (response_buf) {
                 /*
                  * Failed to alloc transaction.
@@ -343,6 +499,11 @@ coap_notify_observers(oc_resource_t *resource,
     if (m) {
         os_mbuf_free_chain(m);
     }
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+    if (held) {
+        coap_observe_rate_arm();
+    }
+#endif
     return num_observers;
 }
 /*---------------------------------------------------------------------------*/
@@ -356,10 +517,17 @@ coap_observe_handler(struct coap_packet_rx *coap_req, coap_packet_t *coap_res,
       coap_res->code < 128) { /* GET request and response without error code */
         if (IS_OPTION(coap_req, COAP_OPTION_OBSERVE)) {
             if (coap_req->observe == 0) {
+#if MYNEWT_VAL(OC_COAP_OPT_VIEW)
+                const char *uri = NULL;
+                int uri_len;
+
+                uri_len = coap_get_header_uri_path_view(coap_req, &uri);
+#else
                 char uri[COAP_MAX_URI];
                 int uri_len;
 
                 uri_len = coap_get_header_uri_path(coap_req, uri, sizeof(uri));
+#endif
                 dup = add_observer(resource, endpoint, coap_req->token,
                                    coap_req->token_len, uri, uri_len);
             } else if (coap_req->observe == 1) {
@@ -378,5 +546,9 @@ coap_observe_init(void)
 {
     os_mempool_init(&coap_observer_pool, COAP_MAX_OBSERVERS,
       sizeof(coap_observer_t), coap_observer_area, "coap_obs");
+#if MYNEWT_VAL(OC_OBSERVE_MIN_INTERVAL) > 0
+    os_callout_init(&coap_observe_rate_timer, oc_evq_get(),
+                    coap_observe_rate_cb, NULL);
+#endif
 }
 #endif /* OC_SERVER */
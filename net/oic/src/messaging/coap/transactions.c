@@ -50,14 +50,175 @@
 #endif
 
 #include "port/mynewt/adaptor.h"
+#include "api/oc_priv.h"
 
 static struct os_mempool oc_transaction_memb;
 static uint8_t oc_transaction_area[OS_MEMPOOL_BYTES(COAP_MAX_OPEN_TRANSACTIONS,
       sizeof(coap_transaction_t))];
+#if MYNEWT_VAL(OC_HASH_BUCKETS) > 0
+/*
+ * Transactions are only ever looked up by message ID, so the buckets
+ * replace the list rather than indexing it.
+ */
+static SLIST_HEAD(, coap_transaction) oc_transaction_list[OC_HASH_BUCKETS];
+#define COAP_TRANSACTION_LIST(mid)  (&oc_transaction_list[oc_hash_mid(mid)])
+#else
 static SLIST_HEAD(, coap_transaction) oc_transaction_list;
+#define COAP_TRANSACTION_LIST(mid)  (&oc_transaction_list)
+#endif
 
 static void coap_transaction_retrans(struct os_event *ev);
 
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+/*
+ * CoCoA retransmission timeout estimation, times in milliseconds. The
+ * strong estimator takes exchanges that needed no retransmission, the weak
+ * one those that completed after one or two retransmissions, measured from
+ * the first transmission.
+ */
+#define COAP_RTO_INIT_MS        (COAP_RESPONSE_TIMEOUT * 1000)
+#define COAP_RTO_MAX_MS         60000
+#define COAP_RTO_K_STRONG       4
+#define COAP_RTO_K_WEAK         1
+
+struct coap_rtt_est {
+    int32_t srtt;
+    int32_t rttvar;
+};
+
+struct coap_rtt_ent {
+    oc_endpoint_t ep;
+    uint8_t used:1;
+    uint8_t strong_valid:1;
+    uint8_t weak_valid:1;
+    os_time_t last;             /* last RTO update */
+    int32_t rto;
+    struct coap_rtt_est strong;
+    struct coap_rtt_est weak;
+};
+
+static struct coap_rtt_ent coap_rtt_tab[MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS)];
+
+static struct coap_rtt_ent *
+coap_rtt_find(oc_endpoint_t *ep, int create)
+{
+    struct coap_rtt_ent *ent;
+    struct coap_rtt_ent *lru = NULL;
+    os_time_t now;
+    int size;
+    int i;
+
+    size = oc_endpoint_size(ep);
+    for (i = 0; i < MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS); i++) {
+        ent = &coap_rtt_tab[i];
+        if (!ent->used) {
+            if (!lru || lru->used) {
+                lru = ent;
+            }
+            continue;
+        }
+        if (!memcmp(&ent->ep, ep, size)) {
+            return ent;
+        }
+        if (!lru || (lru->used && OS_TIME_TICK_LT(ent->last, lru->last))) {
+            lru = ent;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    now = os_time_get();
+    memset(lru, 0, sizeof(*lru));
+    memcpy(&lru->ep, ep, size);
+    lru->used = 1;
+    lru->rto = COAP_RTO_INIT_MS;
+    lru->last = now;
+    return lru;
+}
+
+static int32_t
+coap_rtt_est_update(struct coap_rtt_est *est, int valid, int32_t rtt, int k)
+{
+    int32_t diff;
+
+    if (!valid) {
+        est->srtt = rtt;
+        est->rttvar = rtt / 2;
+    } else {
+        diff = est->srtt - rtt;
+        if (diff < 0) {
+            diff = -diff;
+        }
+        est->rttvar = (3 * est->rttvar + diff) / 4;
+        est->srtt = (7 * est->srtt + rtt) / 8;
+    }
+    return est->srtt + k * est->rttvar;
+}
+
+/*
+ * RTO for ep. Estimates not refreshed for a while drift back towards the
+ * initial value.
+ */
+static int32_t
+coap_rtt_rto(oc_endpoint_t *ep)
+{
+    struct coap_rtt_ent *ent;
+    os_time_t now;
+    uint32_t idle;
+
+    ent = coap_rtt_find(ep, 0);
+    if (!ent) {
+        return COAP_RTO_INIT_MS;
+    }
+    now = os_time_get();
+    idle = os_time_ticks_to_ms32(now - ent->last);
+    if (ent->rto < 1000 && idle > 16 * ent->rto) {
+        ent->rto *= 2;
+        ent->last = now;
+    } else if (ent->rto > 3000 && idle > 4 * ent->rto) {
+        ent->rto = (2000 + ent->rto) / 2;
+        ent->last = now;
+    }
+    return ent->rto;
+}
+
+/**
+ * Feed the round trip time of an acknowledged confirmable transaction into
+ * the estimate for its endpoint.
+ */
+void
+coap_transaction_rtt_sample(coap_transaction_t *t)
+{
+    struct coap_rtt_ent *ent;
+    int32_t rtt;
+    int32_t rto;
+
+    if (t->type != COAP_TYPE_CON || !t->m || t->retrans_counter > 2) {
+        return;
+    }
+    ent = coap_rtt_find(OC_MBUF_ENDPOINT(t->m), 1);
+    rtt = os_time_ticks_to_ms32(os_time_get() - t->start);
+    if (t->retrans_counter == 0) {
+        rto = coap_rtt_est_update(&ent->strong, ent->strong_valid, rtt,
+                                  COAP_RTO_K_STRONG);
+        ent->strong_valid = 1;
+        ent->rto = (rto + ent->rto) / 2;
+    } else {
+        rto = coap_rtt_est_update(&ent->weak, ent->weak_valid, rtt,
+                                  COAP_RTO_K_WEAK);
+        ent->weak_valid = 1;
+        ent->rto = (rto + 3 * ent->rto) / 4;
+    }
+    if (ent->rto > COAP_RTO_MAX_MS) {
+        ent->rto = COAP_RTO_MAX_MS;
+    } else if (ent->rto < 1) {
+        ent->rto = 1;
+    }
+    ent->last = os_time_get();
+}
+#endif
+
 void
 coap_transaction_init(void)
 {
@@ -82,7 +243,7 @@ coap_new_transaction(uint16_t mid, oc_endpoint_t *endpoint)
             os_callout_init(&t->retrans_timer, oc_evq_get(),
               coap_transaction_retrans, t);
             /* list itself makes sure same element is not added twice */
-            SLIST_INSERT_HEAD(&oc_transaction_list, t, next);
+            SLIST_INSERT_HEAD(COAP_TRANSACTION_LIST(mid), t, next);
         } else {
             os_memblock_put(&oc_transaction_memb, t);
             t = NULL;
@@ -106,15 +267,40 @@ coap_send_transaction(coap_transaction_t *t)
         if (t->retrans_counter < COAP_MAX_RETRANSMIT) {
             /* not timed out yet */
             if (t->retrans_counter == 0) {
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+                int32_t rto;
+
+                rto = coap_rtt_rto(OC_MBUF_ENDPOINT(t->m));
+                t->retrans_tmo = os_time_ms_to_ticks32(
+                  rto + oc_random_rand() % (rto / 2 + 1));
+                if (t->retrans_tmo == 0) {
+                    t->retrans_tmo = 1;
+                }
+                /* variable backoff: short RTOs back off faster */
+                if (rto < 1000) {
+                    t->retrans_vbf = 6;
+                } else if (rto > 3000) {
+                    t->retrans_vbf = 3;
+                } else {
+                    t->retrans_vbf = 4;
+                }
+                t->start = os_time_get();
+#else
                 t->retrans_tmo =
                   COAP_RESPONSE_TIMEOUT_TICKS +
                   (oc_random_rand() %
                     (oc_clock_time_t)COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+#endif
                 OC_LOG_DEBUG("Initial interval " OC_CLK_FMT "\n",
                              t->retrans_tmo);
             } else {
+#if MYNEWT_VAL(OC_COAP_RTT_ENDPOINTS) > 0
+                t->retrans_tmo = t->retrans_tmo * t->retrans_vbf / 2;
+                OC_LOG_DEBUG("Backed off " OC_CLK_FMT "\n", t->retrans_tmo);
+#else
                 t->retrans_tmo <<= 1; /* double */
                 OC_LOG_DEBUG("Doubled " OC_CLK_FMT "\n", t->retrans_tmo);
+#endif
             }
 
             os_callout_reset(&t->retrans_timer, t->retrans_tmo);
@@ -163,9 +349,10 @@ coap_clear_transaction(coap_transaction_t *t)
         /*
          * Transaction might not be in the list yet.
          */
-        SLIST_FOREACH(tmp, &oc_transaction_list, next) {
+        SLIST_FOREACH(tmp, COAP_TRANSACTION_LIST(t->mid), next) {
             if (t == tmp) {
-                SLIST_REMOVE(&oc_transaction_list, t, coap_transaction, next);
+                SLIST_REMOVE(COAP_TRANSACTION_LIST(t->mid), t,
+                             coap_transaction, next);
                 break;
             }
         }
@@ -178,7 +365,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
     coap_transaction_t *t;
 
-    SLIST_FOREACH(t, &oc_transaction_list, next) {
+    SLIST_FOREACH(t, COAP_TRANSACTION_LIST(mid), next) {
         if (t->mid == mid) {
             return t;
         }
@@ -32,6 +32,7 @@
 #include "oic/messaging/coap/coap.h"
 #include "oic/port/oc_connectivity.h"
 #include "oic/port/mynewt/ble.h"
+#include "oic/port/mynewt/adaptor.h"
 #include "oic/port/mynewt/stream.h"
 #include "messaging/coap/observe.h"
 #include "host/ble_hs.h"
@@ -48,6 +49,10 @@ static void oc_gatt_conn_ev(struct oc_endpoint *oe, int type);
 static void oc_connectivity_shutdown_gatt(void);
 static bool oc_ble_ep_match(const void *ep, const void *ep_desc);
 static void oc_ble_ep_fill(void *ep, const void *ep_desc);
+#if (MYNEWT_VAL(OC_SERVER) == 1) && MYNEWT_VAL(OC_BLE_TX_SCHED)
+static void oc_ble_tx_init(void);
+static void oc_ble_tx_conn_free(uint16_t conn_handle);
+#endif
 
 static const struct oc_transport oc_gatt_transport = {
     .ot_flags = OC_TRANSPORT_USE_TCP,
@@ -449,11 +454,17 @@ oc_gatt_conn_ev(struct oc_endpoint *oe, int type)
      * Remove CoAP observers (if any) registered for this connection.
      */
     coap_observer_walk(oc_gatt_remove_obs, oe);
+#if (MYNEWT_VAL(OC_SERVER) == 1) && MYNEWT_VAL(OC_BLE_TX_SCHED)
+    oc_ble_tx_conn_free(((struct oc_endpoint_ble *)oe)->conn_handle);
+#endif
 }
 
 static int
 oc_connectivity_init_gatt(void)
 {
+#if (MYNEWT_VAL(OC_SERVER) == 1) && MYNEWT_VAL(OC_BLE_TX_SCHED)
+    oc_ble_tx_init();
+#endif
     if (oc_gatt_conn_cb.occ_func == NULL) {
         oc_gatt_conn_cb.occ_func = oc_gatt_conn_ev;
         oc_conn_cb_register(&oc_gatt_conn_cb);
@@ -515,18 +526,29 @@ err:
 }
 #endif
 
-void
-oc_send_buffer_gatt(struct os_mbuf *m)
-{
 #if (MYNEWT_VAL(OC_SERVER) == 1)
-    struct oc_endpoint_ble *oe_ble;
+static void
+oc_ble_free_segs(struct os_mbuf *m)
+{
     struct os_mbuf_pkthdr *pkt;
-    uint16_t mtu;
-    uint16_t conn_handle;
-    uint16_t attr_handle;
-#endif
 
-#if (MYNEWT_VAL(OC_SERVER) == 1)
+    while (m) {
+        pkt = STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next);
+        os_mbuf_free_chain(m);
+        m = pkt ? OS_MBUF_PKTHDR_TO_MBUF(pkt) : NULL;
+    }
+}
+
+/*
+ * Splits frame m into ATT PDUs for the current MTU of its connection, and
+ * returns the attribute handle to send them on.  On failure m is freed.
+ */
+static int
+oc_ble_tx_prep(struct os_mbuf *m, uint16_t *attr_handle)
+{
+    struct oc_endpoint_ble *oe_ble;
+    uint16_t conn_handle;
+    uint16_t mtu;
 
     assert(OS_MBUF_USRHDR_LEN(m) >= sizeof(struct oc_endpoint_ble));
     oe_ble = (struct oc_endpoint_ble *)OC_MBUF_ENDPOINT(m);
@@ -536,12 +558,12 @@ oc_send_buffer_gatt(struct os_mbuf *m)
     STATS_INCN(oc_ble_stats, obytes, OS_MBUF_PKTLEN(m));
 
 #if (MYNEWT_VAL(OC_BLE_CENTRAL) == 1)
-    attr_handle = oe_ble->tx_att_handle;
+    *attr_handle = oe_ble->tx_att_handle;
 #else
     if (oe_ble->srv_idx >= OC_BLE_SRV_CNT) {
         goto err;
     }
-    attr_handle = oc_ble_srv_handles[oe_ble->srv_idx].rsp;
+    *attr_handle = oc_ble_srv_handles[oe_ble->srv_idx].rsp;
 #endif
     mtu = ble_att_mtu(conn_handle);
     if (mtu < 4) {
@@ -552,27 +574,264 @@ oc_send_buffer_gatt(struct os_mbuf *m)
 
     if (oc_ble_frag(m, mtu)) {
         STATS_INC(oc_ble_stats, oerr);
-        return;
+        return -1;
     }
-    while (1) {
-        STATS_INC(oc_ble_stats, oseg);
-        pkt = STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next);
+    return 0;
+
+err:
+    os_mbuf_free_chain(m);
+    STATS_INC(oc_ble_stats, oerr);
+    return -1;
+}
+
+/*
+ * Sends one ATT PDU, and returns the next segment of the same frame.
+ */
+static struct os_mbuf *
+oc_ble_tx_seg(uint16_t conn_handle, uint16_t attr_handle, struct os_mbuf *m)
+{
+    struct os_mbuf_pkthdr *pkt;
+
+    STATS_INC(oc_ble_stats, oseg);
+    pkt = STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next);
 #if (MYNEWT_VAL(OC_BLE_CENTRAL) == 1)
-        ble_gattc_write_no_rsp(conn_handle, attr_handle, m);
+    ble_gattc_write_no_rsp(conn_handle, attr_handle, m);
 #else
-        ble_gattc_notify_custom(conn_handle, attr_handle, m);
+    ble_gattc_notify_custom(conn_handle, attr_handle, m);
+#endif
+    return pkt ? OS_MBUF_PKTHDR_TO_MBUF(pkt) : NULL;
+}
+
+#if MYNEWT_VAL(OC_BLE_TX_SCHED)
+/*
+ * Per-connection transmit state.  Whole frames wait on otc_q and are only
+ * fragmented once they reach the head, so the MTU used is the one in effect
+ * when they go out.  otc_cur holds the unsent segments of that frame.
+ */
+struct oc_ble_tx_conn {
+    STAILQ_HEAD(, os_mbuf_pkthdr) otc_q;
+    struct os_mbuf *otc_cur;
+    uint16_t otc_conn;
+    uint16_t otc_attr;
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0
+    int16_t otc_credits;
+#endif
+};
+
+static struct oc_ble_tx_conn oc_ble_tx_conns[MYNEWT_VAL(OC_BLE_TX_CONNS)];
+static uint8_t oc_ble_tx_rr;
+static void oc_ble_tx_run(struct os_event *ev);
+static struct os_event oc_ble_tx_ev = {
+    .ev_cb = oc_ble_tx_run,
+};
+
+static struct oc_ble_tx_conn *
+oc_ble_tx_conn_find(uint16_t conn_handle)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OC_BLE_TX_CONNS); i++) {
+        if (oc_ble_tx_conns[i].otc_conn == conn_handle) {
+            return &oc_ble_tx_conns[i];
+        }
+    }
+    return NULL;
+}
+
+static struct oc_ble_tx_conn *
+oc_ble_tx_conn_get(uint16_t conn_handle)
+{
+    struct oc_ble_tx_conn *otc;
+    os_sr_t sr;
+
+    otc = oc_ble_tx_conn_find(conn_handle);
+    if (otc) {
+        return otc;
+    }
+    otc = oc_ble_tx_conn_find(BLE_HS_CONN_HANDLE_NONE);
+    if (otc) {
+        STAILQ_INIT(&otc->otc_q);
+        otc->otc_cur = NULL;
+        OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0
+        otc->otc_credits = MYNEWT_VAL(OC_BLE_TX_CREDITS);
+#endif
+        otc->otc_conn = conn_handle;
+        OS_EXIT_CRITICAL(sr);
+    }
+    return otc;
+}
+
+static void
+oc_ble_tx_conn_free(uint16_t conn_handle)
+{
+    struct oc_ble_tx_conn *otc;
+    struct os_mbuf_pkthdr *pkt;
+
+    otc = oc_ble_tx_conn_find(conn_handle);
+    if (!otc) {
+        return;
+    }
+    oc_ble_free_segs(otc->otc_cur);
+    otc->otc_cur = NULL;
+    while ((pkt = STAILQ_FIRST(&otc->otc_q)) != NULL) {
+        STAILQ_REMOVE_HEAD(&otc->otc_q, omp_next);
+        os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(pkt));
+        STATS_INC(oc_ble_stats, oerr);
+    }
+    otc->otc_conn = BLE_HS_CONN_HANDLE_NONE;
+}
+
+static bool
+oc_ble_tx_can_send(struct oc_ble_tx_conn *otc)
+{
+    if (!otc->otc_cur && STAILQ_EMPTY(&otc->otc_q)) {
+        return false;
+    }
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0 && MYNEWT_VAL(OC_BLE_CENTRAL) == 0
+    if (otc->otc_credits <= 0) {
+        return false;
+    }
 #endif
-        if (pkt) {
-            m = OS_MBUF_PKTHDR_TO_MBUF(pkt);
-        } else {
+    return true;
+}
+
+/*
+ * Sends up to OC_BLE_TX_BURST PDUs on one connection.
+ */
+static void
+oc_ble_tx_conn_drain(struct oc_ble_tx_conn *otc)
+{
+    struct os_mbuf_pkthdr *pkt;
+    uint16_t conn_handle;
+    int cnt;
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0 && MYNEWT_VAL(OC_BLE_CENTRAL) == 0
+    os_sr_t sr;
+#endif
+
+    conn_handle = otc->otc_conn;
+    for (cnt = 0; cnt < MYNEWT_VAL(OC_BLE_TX_BURST); cnt++) {
+        if (!oc_ble_tx_can_send(otc)) {
             break;
         }
+        if (!otc->otc_cur) {
+            pkt = STAILQ_FIRST(&otc->otc_q);
+            STAILQ_REMOVE_HEAD(&otc->otc_q, omp_next);
+            STAILQ_NEXT(pkt, omp_next) = NULL;
+            otc->otc_cur = OS_MBUF_PKTHDR_TO_MBUF(pkt);
+            if (oc_ble_tx_prep(otc->otc_cur, &otc->otc_attr)) {
+                otc->otc_cur = NULL;
+                continue;
+            }
+        }
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0 && MYNEWT_VAL(OC_BLE_CENTRAL) == 0
+        OS_ENTER_CRITICAL(sr);
+        otc->otc_credits--;
+        OS_EXIT_CRITICAL(sr);
+#endif
+        otc->otc_cur = oc_ble_tx_seg(conn_handle, otc->otc_attr,
+                                     otc->otc_cur);
     }
-    return;
+}
 
-err:
-    os_mbuf_free_chain(m);
-    STATS_INC(oc_ble_stats, oerr);
+/*
+ * Gives every connection with data and credits one burst, starting one
+ * connection further along each round.  Reschedules itself while work is
+ * left, so other OIC events get to run in between rounds.
+ */
+static void
+oc_ble_tx_run(struct os_event *ev)
+{
+    struct oc_ble_tx_conn *otc;
+    bool more;
+    int i;
+
+    more = false;
+    for (i = 0; i < MYNEWT_VAL(OC_BLE_TX_CONNS); i++) {
+        otc = &oc_ble_tx_conns[(oc_ble_tx_rr + i) %
+                               MYNEWT_VAL(OC_BLE_TX_CONNS)];
+        if (otc->otc_conn == BLE_HS_CONN_HANDLE_NONE) {
+            continue;
+        }
+        oc_ble_tx_conn_drain(otc);
+        if (otc->otc_conn != BLE_HS_CONN_HANDLE_NONE &&
+            oc_ble_tx_can_send(otc)) {
+            more = true;
+        }
+    }
+    oc_ble_tx_rr = (oc_ble_tx_rr + 1) % MYNEWT_VAL(OC_BLE_TX_CONNS);
+    if (more) {
+        os_eventq_put(oc_evq_get(), &oc_ble_tx_ev);
+    }
+}
+
+static int
+oc_ble_tx_enqueue(struct os_mbuf *m)
+{
+    struct oc_endpoint_ble *oe_ble;
+    struct oc_ble_tx_conn *otc;
+
+    oe_ble = (struct oc_endpoint_ble *)OC_MBUF_ENDPOINT(m);
+    otc = oc_ble_tx_conn_get(oe_ble->conn_handle);
+    if (!otc) {
+        return -1;
+    }
+    STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next) = NULL;
+    STAILQ_INSERT_TAIL(&otc->otc_q, OS_MBUF_PKTHDR(m), omp_next);
+    os_eventq_put(oc_evq_get(), &oc_ble_tx_ev);
+    return 0;
+}
+
+void
+oc_ble_coap_tx_done(uint16_t conn_handle)
+{
+#if MYNEWT_VAL(OC_BLE_TX_CREDITS) > 0
+    struct oc_ble_tx_conn *otc;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    otc = oc_ble_tx_conn_find(conn_handle);
+    if (otc && otc->otc_credits < MYNEWT_VAL(OC_BLE_TX_CREDITS)) {
+        otc->otc_credits++;
+    }
+    OS_EXIT_CRITICAL(sr);
+    os_eventq_put(oc_evq_get(), &oc_ble_tx_ev);
+#endif
+}
+
+static void
+oc_ble_tx_init(void)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OC_BLE_TX_CONNS); i++) {
+        oc_ble_tx_conns[i].otc_conn = BLE_HS_CONN_HANDLE_NONE;
+    }
+}
+#endif /* OC_BLE_TX_SCHED */
+#endif /* OC_SERVER */
+
+void
+oc_send_buffer_gatt(struct os_mbuf *m)
+{
+#if (MYNEWT_VAL(OC_SERVER) == 1)
+    struct oc_endpoint_ble *oe_ble;
+    uint16_t conn_handle;
+    uint16_t attr_handle;
+
+#if MYNEWT_VAL(OC_BLE_TX_SCHED)
+    if (oc_ble_tx_enqueue(m) == 0) {
+        return;
+    }
+#endif
+    oe_ble = (struct oc_endpoint_ble *)OC_MBUF_ENDPOINT(m);
+    conn_handle = oe_ble->conn_handle;
+    if (oc_ble_tx_prep(m, &attr_handle)) {
+        return;
+    }
+    while (m) {
+        m = oc_ble_tx_seg(conn_handle, attr_handle, m);
+    }
 #endif
 }
 
@@ -26,22 +26,51 @@
 #include "oc_pstat.h"
 #include "oc_svr.h"
 
+#ifndef DTLS_SESSION_CACHE_SIZE
+#define DTLS_SESSION_CACHE_SIZE (1)
+#endif
+
+#ifndef DTLS_SESSION_LIFETIME
+#define DTLS_SESSION_LIFETIME (600)
+#endif
+
+#ifndef DTLS_PEER_HASH_SIZE
+#define DTLS_PEER_HASH_SIZE (4)
+#endif
+
 OC_PROCESS(oc_dtls_handler, "DTLS Process");
-OC_MEMB(dtls_peers_s, oc_sec_dtls_peer_t, MAX_DTLS_PEERS);
+OC_MEMB(dtls_peers_s, oc_sec_dtls_peer_t,
+        MAX_DTLS_PEERS + DTLS_SESSION_CACHE_SIZE);
 OC_LIST(dtls_peers);
 
+static oc_sec_dtls_peer_t *dtls_peer_hash[DTLS_PEER_HASH_SIZE];
+static int dtls_cached_sessions;
+
 static dtls_context_t *ocf_dtls_context;
 
+static oc_sec_dtls_peer_t **
+oc_sec_dtls_peer_bucket(oc_endpoint_t *endpoint, int len)
+{
+    const uint8_t *p = (const uint8_t *)endpoint;
+    uint32_t h = 2166136261U;
+
+    /* FNV-1a over the same bytes the lookup compares. */
+    while (len-- > 0) {
+        h = (h ^ *p++) * 16777619U;
+    }
+    return &dtls_peer_hash[h % DTLS_PEER_HASH_SIZE];
+}
+
 oc_sec_dtls_peer_t *
 oc_sec_dtls_get_peer(oc_endpoint_t *endpoint)
 {
-    oc_sec_dtls_peer_t *peer = oc_list_head(dtls_peers);
+    int len = oc_endpoint_size(endpoint);
+    oc_sec_dtls_peer_t *peer = *oc_sec_dtls_peer_bucket(endpoint, len);
 
     while (peer != NULL) {
-        if (memcmp(&peer->session.addr, endpoint,
-            oc_endpoint_size(endpoint)) == 0)
+        if (memcmp(&peer->session.addr, endpoint, len) == 0)
             break;
-        peer = oc_list_item_next(peer);
+        peer = peer->hnext;
     }
     return peer;
 }
@@ -49,15 +78,97 @@ oc_sec_dtls_get_peer(oc_endpoint_t *endpoint)
 void
 oc_sec_dtls_remove_peer(oc_endpoint_t *endpoint)
 {
-    oc_sec_dtls_peer_t *peer = oc_sec_dtls_get_peer(endpoint);
+    oc_sec_dtls_peer_t **prev;
+    oc_sec_dtls_peer_t *peer;
+
+    prev = oc_sec_dtls_peer_bucket(endpoint, oc_endpoint_size(endpoint));
+    peer = oc_sec_dtls_get_peer(endpoint);
 
     if (peer) {
         LOG("\n\noc_sec_dtls: removed peer\n\n");
+        while (*prev != peer) {
+            prev = &(*prev)->hnext;
+        }
+        *prev = peer->hnext;
+        if (peer->cached) {
+            dtls_cached_sessions--;
+        }
         oc_list_remove(dtls_peers, peer);
         oc_memb_free(&dtls_peers_s, peer);
     }
 }
 
+/*
+  Closes the least recently used session in the session cache to make
+  room for another one.
+*/
+static bool
+oc_sec_dtls_evict_session(void)
+{
+    oc_sec_dtls_peer_t *peer = oc_list_head(dtls_peers);
+    oc_sec_dtls_peer_t *oldest = NULL;
+
+    while (peer != NULL) {
+        if (peer->cached &&
+            (!oldest || (int32_t)(peer->timestamp - oldest->timestamp) < 0)) {
+            oldest = peer;
+        }
+        peer = oc_list_item_next(peer);
+    }
+    if (!oldest) {
+        return false;
+    }
+    LOG("\n\noc_sec_dtls: Evicting cached session\n\n");
+    oc_sec_dtls_close_init(&oldest->session.addr);
+    oc_sec_dtls_close_finish(&oldest->session.addr);
+    return true;
+}
+
+/*
+  Idle sessions that completed a PSK handshake are parked in the session
+  cache instead of being closed.  Their keys stay with tinydtls, so the
+  endpoint can carry on without a new handshake if it comes back before
+  DTLS_SESSION_LIFETIME runs out.  Entries are keyed by endpoint and by the
+  credential the session was set up with.
+*/
+static bool
+oc_sec_dtls_cache_session(oc_sec_dtls_peer_t *peer)
+{
+    if (DTLS_SESSION_CACHE_SIZE == 0 || !peer->connected ||
+        oc_sec_find_cred(&peer->uuid) == NULL) {
+        return false;
+    }
+    if (dtls_cached_sessions >= DTLS_SESSION_CACHE_SIZE &&
+        !oc_sec_dtls_evict_session()) {
+        return false;
+    }
+    LOG("\n\noc_sec_dtls: Caching idle session\n\n");
+    peer->cached = true;
+    dtls_cached_sessions++;
+    return true;
+}
+
+/*
+  Marks activity on a peer.  A cached session is taken back into use if
+  its credential is still valid, otherwise it is dropped.
+*/
+static oc_sec_dtls_peer_t *
+oc_sec_dtls_touch_peer(oc_sec_dtls_peer_t *peer)
+{
+    if (peer->cached) {
+        if (oc_sec_find_cred(&peer->uuid) == NULL) {
+            oc_sec_dtls_close_init(&peer->session.addr);
+            oc_sec_dtls_close_finish(&peer->session.addr);
+            return NULL;
+        }
+        LOG("\n\noc_sec_dtls: Resuming cached session\n\n");
+        peer->cached = false;
+        dtls_cached_sessions--;
+    }
+    peer->timestamp = oc_clock_time();
+    return peer;
+}
+
 oc_event_callback_retval_t
 oc_sec_dtls_inactive(void *data)
 {
@@ -69,6 +180,13 @@ oc_sec_dtls_inactive(void *data)
         if (time < DTLS_INACTIVITY_TIMEOUT * OC_CLOCK_SECOND) {
             LOG("\n\noc_sec_dtls: Resetting DTLS inactivity callback\n\n");
             return CONTINUE;
+        } else if (peer->cached || oc_sec_dtls_cache_session(peer)) {
+            if (time < DTLS_SESSION_LIFETIME * OC_CLOCK_SECOND) {
+                return CONTINUE;
+            }
+            LOG("\n\noc_sec_dtls: Cached session expired\n\n");
+            oc_sec_dtls_close_init(data);
+            oc_sec_dtls_close_finish(data);
         } else if (time < 2 * DTLS_INACTIVITY_TIMEOUT * OC_CLOCK_SECOND) {
             LOG("\n\noc_sec_dtls: Initiating connection close\n\n");
             oc_sec_dtls_close_init(data);
@@ -89,16 +207,25 @@ oc_sec_dtls_peer_t *
 oc_sec_dtls_add_peer(oc_endpoint_t *endpoint)
 {
     oc_sec_dtls_peer_t *peer = oc_sec_dtls_get_peer(endpoint);
+    oc_sec_dtls_peer_t **bucket;
 
     if (!peer) {
         peer = oc_memb_alloc(&dtls_peers_s);
+        if (!peer && oc_sec_dtls_evict_session()) {
+            peer = oc_memb_alloc(&dtls_peers_s);
+        }
         if (peer) {
             LOG("\n\noc_sec_dtls: Allocating new DTLS peer\n\n");
             memcpy(&peer->session.addr, endpoint, sizeof(oc_endpoint_t));
             peer->session.size = sizeof(oc_endpoint_t);
             OC_LIST_STRUCT_INIT(peer, send_queue);
             peer->connected = false;
+            peer->cached = false;
             oc_list_add(dtls_peers, peer);
+            bucket = oc_sec_dtls_peer_bucket(endpoint,
+                                             oc_endpoint_size(endpoint));
+            peer->hnext = *bucket;
+            *bucket = peer;
 
             oc_ri_add_timed_event_callback_seconds(&peer->session.addr,
                          oc_sec_dtls_inactive, DTLS_INACTIVITY_TIMEOUT);
@@ -155,6 +282,12 @@ oc_sec_dtls_init_connection(oc_message_t *message)
     oc_sec_dtls_peer_t *peer = oc_sec_dtls_add_peer(&message->endpoint);
 
     if (peer) {
+        peer = oc_sec_dtls_touch_peer(peer);
+    }
+    if (peer && peer->connected) {
+        /* Session resumed from the cache, no handshake needed. */
+        oc_sec_dtls_send_message(message);
+    } else if (peer) {
         LOG("\n\noc_dtls: Initializing DTLS connection\n\n");
         dtls_connect(ocf_dtls_context, &peer->session);
         oc_list_add(peer->send_queue, message);
@@ -180,6 +313,9 @@ oc_sec_dtls_send_message(oc_message_t *message)
     int ret = 0;
     oc_sec_dtls_peer_t *peer = oc_sec_dtls_get_peer(&message->endpoint);
 
+    if (peer) {
+        peer = oc_sec_dtls_touch_peer(peer);
+    }
     if (peer) {
         ret = dtls_write(ocf_dtls_context, &peer->session, message->data,
                          message->length);
@@ -301,7 +437,7 @@ oc_sec_dtls_recv_message(oc_message_t *message)
         if (ret != 0) {
             oc_sec_dtls_close_finish(&message->endpoint);
         } else {
-            peer->timestamp = oc_clock_time();
+            oc_sec_dtls_touch_peer(peer);
         }
     }
     oc_message_unref(message);
@@ -43,10 +43,14 @@ bool oc_sec_dtls_connected(oc_endpoint_t *endpoint);
 
 typedef struct oc_sec_dtls_peer {
     struct oc_sec_dtls_peer_s *next;
+    /* Next peer in the same lookup hash bucket */
+    struct oc_sec_dtls_peer *hnext;
     OC_LIST_STRUCT(send_queue);
     session_t session;
     oc_uuid_t uuid;
     bool connected;
+    /* Idle session kept in the session cache */
+    bool cached;
     oc_clock_time_t timestamp;
 } oc_sec_dtls_peer_t;
 
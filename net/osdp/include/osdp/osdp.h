@@ -613,6 +613,34 @@ void osdp_cp_teardown(osdp_t *ctx);
  */
 int osdp_cp_send_command(osdp_t *ctx, int pd, struct osdp_cmd *cmd);
 
+/**
+ * @brief Per-PD statistics kept by the CP scheduler (OSDP_CP_PIPELINE).
+ *
+ * Round-trip times run from the command being sent to its reply being
+ * processed, so they include the latency of the refresh calls.
+ */
+struct osdp_cp_pd_stats {
+    uint32_t commands;      /* commands sent */
+    uint32_t replies;       /* replies processed */
+    uint32_t timeouts;      /* commands that got no reply in time */
+    uint32_t rtt_last_us;   /* round-trip time of the last command */
+    uint32_t rtt_avg_us;    /* moving average (1/8 weight) */
+    uint32_t rtt_max_us;    /* largest round-trip time seen */
+    uint32_t poll_ms;       /* current poll interval */
+};
+
+/**
+ * @brief Get the scheduler statistics of a PD.
+ *
+ * @param ctx OSDP context
+ * @param pd PD offset number as in `pd_info_t *`.
+ * @param stats Filled with the statistics of the PD.
+ *
+ * @retval 0 on success
+ * @retval -1 on failure
+ */
+int osdp_cp_get_pd_stats(osdp_t *ctx, int pd, struct osdp_cp_pd_stats *stats);
+
 /**
  * @brief Set callback method for CP event notification. This callback is
  * invoked when the CP receives an event from the PD.
@@ -208,6 +208,7 @@ enum osdp_cp_phy_state_e {
     OSDP_CP_PHY_STATE_REPLY_WAIT,
     OSDP_CP_PHY_STATE_WAIT,
     OSDP_CP_PHY_STATE_ERR,
+    OSDP_CP_PHY_STATE_CMD_READY, /* built in rx_buf; waiting for channel */
 };
 
 enum osdp_state_e {
@@ -305,6 +306,13 @@ struct osdp_pd {
     int reply_id;
     uint8_t ephemeral_data[OSDP_EPHEMERAL_DATA_MAX_LEN];
 
+#if MYNEWT_VAL(OSDP_MODE_CP) && MYNEWT_VAL(OSDP_CP_PIPELINE)
+    int cmd_len;            /* length of the command prepared in rx_buf */
+    uint32_t poll_ms;       /* current poll interval */
+    int64_t cmd_tx_us;      /* when the last command was sent */
+    struct osdp_cp_pd_stats cp_stats;
+#endif
+
     union {
         struct osdp_queue cmd;
         struct osdp_queue event;
@@ -323,6 +331,9 @@ struct osdp_cp {
     struct osdp_pd *current_pd; /* current operational pd's pointer */
     int pd_offset;          /* current pd's offset into ctx->pd */
     int *channel_lock;
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    int rr_offset;          /* PD that gets the first turn in a refresh */
+#endif
     void *event_callback_arg;
     cp_event_callback_t event_callback;
 };
@@ -11,29 +11,42 @@
 
 #include <os/os_time.h>
 
-#include "tinycrypt/cbc_mode.h"
 #include "tinycrypt/aes.h"
 #include "tinycrypt/constants.h"
 #if MYNEWT_VAL(TRNG) && !MYNEWT_VAL(OSDP_USE_CRYPTO_HOOK)
 #include "trng/trng.h"
 #endif /* MYNEWT_VAL(TRNG) && !MYNEWT_VAL(OSDP_USE_CRYPTO_HOOK) */
+#if MYNEWT_VAL(OSDP_HW_CRYPTO)
+#include "crypto/crypto.h"
+#endif
 
 #include "osdp/osdp_common.h"
 #include "osdp/osdp_hooks.h"
 
-/*
- * Set this to size of the max UART buffer length and add block size
- * If the entire buffer were to be encrypted, account for the
- * the fact that the output buffer comes with IV appended
- */
-#define MAX_UART_BUF (max(MYNEWT_VAL(OSDP_UART_TX_BUFFER_LENGTH), \
-                          MYNEWT_VAL(OSDP_UART_RX_BUFFER_LENGTH)))
-#define MAX_SCRATCH_LEN (MAX_UART_BUF + TC_AES_BLOCK_SIZE)
-static uint8_t scratch_buf1[MAX_SCRATCH_LEN];
 #if MYNEWT_VAL(TRNG) && !MYNEWT_VAL(OSDP_USE_CRYPTO_HOOK)
 static struct trng_dev *trng = NULL;
 #endif /* MYNEWT_VAL(TRNG) && !MYNEWT_VAL(OSDP_USE_CRYPTO_HOOK) */
 
+#if MYNEWT_VAL(OSDP_HW_CRYPTO)
+/* Crypto device; NULL until opened, or if there is none */
+static struct crypto_dev *osdp_crypto;
+static bool osdp_crypto_opened;
+#endif
+
+/*
+ * Expanded keys of the most recently used AES keys. A secure channel
+ * session uses three (S-ENC, S-MAC1, S-MAC2) on every packet, and expanding
+ * a key costs more than encrypting a block. tinycrypt uses the same
+ * schedule for both directions.
+ */
+struct osdp_key_sched {
+    uint8_t key[16];
+    uint8_t valid;
+    struct tc_aes_key_sched_struct sched;
+};
+static struct osdp_key_sched osdp_key_scheds[MYNEWT_VAL(OSDP_KEY_SCHED_CACHE)];
+static int osdp_key_sched_next;
+
 #define OSDP_LOCK_TMO \
     (OS_TICKS_PER_SEC * MYNEWT_VAL(OSDP_DEVICE_LOCK_TIMEOUT_MS)/1000 + 1)
 
@@ -64,66 +77,156 @@ osdp_millis_since(int64_t last)
     return osdp_millis_now() - last;
 }
 
+static struct tc_aes_key_sched_struct *
+osdp_key_sched_get(const uint8_t *key)
+{
+    struct osdp_key_sched *ks;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OSDP_KEY_SCHED_CACHE); i++) {
+        ks = &osdp_key_scheds[i];
+        if (ks->valid && memcmp(ks->key, key, 16) == 0) {
+            return &ks->sched;
+        }
+    }
+
+    ks = &osdp_key_scheds[osdp_key_sched_next];
+    osdp_key_sched_next = (osdp_key_sched_next + 1) %
+                          MYNEWT_VAL(OSDP_KEY_SCHED_CACHE);
+    memcpy(ks->key, key, 16);
+    (void)tc_aes128_set_encrypt_key(&ks->sched, key);
+    ks->valid = 1;
+
+    return &ks->sched;
+}
+
+#if MYNEWT_VAL(OSDP_HW_CRYPTO)
+static struct crypto_dev *
+osdp_crypto_get(void)
+{
+    if (!osdp_crypto_opened) {
+        osdp_crypto_opened = true;
+        osdp_crypto = (struct crypto_dev *)os_dev_open("crypto",
+                                                       OS_TIMEOUT_NEVER, NULL);
+        if (osdp_crypto == NULL) {
+            OSDP_LOG_ERROR("osdp: sc: No crypto device; using software AES\n");
+        }
+    }
+    return osdp_crypto;
+}
+#endif
+
 void
 osdp_encrypt(uint8_t *key, uint8_t *iv, uint8_t *data, int len)
 {
-    struct tc_aes_key_sched_struct s;
-    (void)tc_aes128_set_encrypt_key(&s, key);
-
-    if (iv != NULL) {
-        /* Check if there is enough space for IV + len */
-        assert(len <= MAX_SCRATCH_LEN - TC_AES_BLOCK_SIZE);
-        if (tc_cbc_mode_encrypt(scratch_buf1, /* out: output buffer */
-            len + TC_AES_BLOCK_SIZE, /* outlen: max output size, including size of IV */
-            data, /* in: input buffer */
-            len, /* inlen: input len */
-            iv, /* iv: IV start */
-            &s) == TC_CRYPTO_FAIL) {
-            OSDP_LOG_ERROR("osdp: sc: CBC ENCRYPT - Failed");
+    struct tc_aes_key_sched_struct *s;
+    uint8_t *prev;
+    int i;
+    int j;
+
+#if MYNEWT_VAL(OSDP_HW_CRYPTO)
+    struct crypto_dev *crypto = osdp_crypto_get();
+    uint8_t chain[16];
+    uint32_t done;
+
+    if (crypto != NULL) {
+        if (iv != NULL) {
+            /* The driver updates the IV; callers do not expect that */
+            memcpy(chain, iv, 16);
+            done = crypto_encrypt_aes_cbc(crypto, key, 128, chain, data, data,
+                                          len);
+        } else {
+            len = 16;
+            done = crypto_encrypt_aes_ecb(crypto, key, 128, data, data, len);
         }
+        if (done == len) {
+            return;
+        }
+        if (done != 0) {
+            OSDP_LOG_ERROR("osdp: sc: HW ENCRYPT - Failed\n");
+            return;
+        }
+        /* Not supported by the device; do it in software */
+    }
+#endif
 
-        /* copy ciphertext from offset */
-        memcpy(data, scratch_buf1 + TC_AES_BLOCK_SIZE, len);
+    s = osdp_key_sched_get(key);
 
-    } else {
-        if (tc_aes_encrypt(data, data, &s) == TC_CRYPTO_FAIL) {
+    if (iv == NULL) {
+        if (tc_aes_encrypt(data, data, s) == TC_CRYPTO_FAIL) {
             OSDP_LOG_ERROR("osdp: sc: ECB ENCRYPT - Failed\n");
         }
+        return;
+    }
+
+    /* CBC, in place: each block is chained with the previous ciphertext */
+    prev = iv;
+    for (i = 0; i + 16 <= len; i += 16) {
+        for (j = 0; j < 16; j++) {
+            data[i + j] ^= prev[j];
+        }
+        if (tc_aes_encrypt(data + i, data + i, s) == TC_CRYPTO_FAIL) {
+            OSDP_LOG_ERROR("osdp: sc: CBC ENCRYPT - Failed");
+            return;
+        }
+        prev = data + i;
     }
 }
 
 void
 osdp_decrypt(uint8_t *key, uint8_t *iv, uint8_t *data, int len)
 {
-    struct tc_aes_key_sched_struct s;
-    (void)tc_aes128_set_decrypt_key(&s, key);
-
-    if (iv != NULL) {
-        /* Check if there is enough space for IV + len */
-        assert(len <= MAX_SCRATCH_LEN - TC_AES_BLOCK_SIZE);
-        /* Create input buffer. IV and cipher text in contiguous buffer per tinycrypt */
-        memcpy(scratch_buf1, iv, TC_AES_BLOCK_SIZE);
-        memcpy(scratch_buf1 + TC_AES_BLOCK_SIZE, data, len);
-        /*
-           note commit da923ca upstream(tinycrypt)
-           Commit message has this nugget:-
-           When decrypting with CBC mode, the in and out buffers should be the same size.
-           Even though the IV and ciphertext are contiguous, the in buffer points to the first byte of the ciphertext.
-         */
-        if (tc_cbc_mode_decrypt(scratch_buf1, /* out: output buffer */
-            len + TC_AES_BLOCK_SIZE, /* outlen: same as inlen */
-            scratch_buf1 + TC_AES_BLOCK_SIZE, /* in: offset to ciphertext in input buffer */
-            len + TC_AES_BLOCK_SIZE, /* inlen: total length of input, iv + buffer length */
-            scratch_buf1, /* iv: offset to IV in input buffer */
-            &s) == TC_CRYPTO_FAIL) {
-            OSDP_LOG_ERROR("osdp: sc: CBC DECRYPT - Failed\n");
+    struct tc_aes_key_sched_struct *s;
+    uint8_t chain[16];
+    uint8_t next[16];
+    int i;
+    int j;
+
+#if MYNEWT_VAL(OSDP_HW_CRYPTO)
+    struct crypto_dev *crypto = osdp_crypto_get();
+    uint32_t done;
+
+    if (crypto != NULL) {
+        if (iv != NULL) {
+            memcpy(chain, iv, 16);
+            done = crypto_decrypt_aes_cbc(crypto, key, 128, chain, data, data,
+                                          len);
+        } else {
+            len = 16;
+            done = crypto_decrypt_aes_ecb(crypto, key, 128, data, data, len);
         }
-        /* Copy decrypted data into output buffer */
-        memcpy(data, scratch_buf1, len);
-    } else {
-        if (tc_aes_decrypt(data, data, &s) == TC_CRYPTO_FAIL) {
+        if (done == len) {
+            return;
+        }
+        if (done != 0) {
+            OSDP_LOG_ERROR("osdp: sc: HW DECRYPT - Failed\n");
+            return;
+        }
+        /* Not supported by the device; do it in software */
+    }
+#endif
+
+    s = osdp_key_sched_get(key);
+
+    if (iv == NULL) {
+        if (tc_aes_decrypt(data, data, s) == TC_CRYPTO_FAIL) {
             OSDP_LOG_ERROR("osdp: sc: ECB DECRYPT - Failed\n");
         }
+        return;
+    }
+
+    /* CBC, in place: keep the ciphertext block for chaining the next one */
+    memcpy(chain, iv, 16);
+    for (i = 0; i + 16 <= len; i += 16) {
+        memcpy(next, data + i, 16);
+        if (tc_aes_decrypt(data + i, data + i, s) == TC_CRYPTO_FAIL) {
+            OSDP_LOG_ERROR("osdp: sc: CBC DECRYPT - Failed\n");
+            return;
+        }
+        for (j = 0; j < 16; j++) {
+            data[i + j] ^= chain[j];
+        }
+        memcpy(chain, next, 16);
     }
 }
 
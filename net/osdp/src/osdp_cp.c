@@ -19,6 +19,7 @@
 #define OSDP_CMD_RETRY_WAIT_MS         (MYNEWT_VAL(OSDP_CMD_RETRY_WAIT_SEC) * 1000)
 #define OSDP_PD_SC_RETRY_MS            (MYNEWT_VAL(OSDP_SC_RETRY_WAIT_SEC) * 1000)
 #define OSDP_ONLINE_RETRY_WAIT_MAX_MS  (MYNEWT_VAL(OSDP_ONLINE_RETRY_WAIT_MAX_SEC) * 1000)
+#define OSDP_CP_POLL_IDLE_MS           MYNEWT_VAL(OSDP_CP_POLL_IDLE_MS)
 
 #define CMD_POLL_LEN                   1
 #define CMD_LSTAT_LEN                  1
@@ -700,7 +701,7 @@ cp_decode_response(struct osdp_pd *pd, uint8_t *buf, int len)
 }
 
 static int
-cp_send_command(struct osdp_pd *pd)
+cp_build_packet(struct osdp_pd *pd)
 {
     int ret, len;
 
@@ -723,6 +724,14 @@ cp_send_command(struct osdp_pd *pd)
         return OSDP_CP_ERR_GENERIC;
     }
 
+    return len;
+}
+
+static int
+cp_send_packet(struct osdp_pd *pd, int len)
+{
+    int ret;
+
     /* flush rx to remove any invalid data. */
     if (pd->channel.flush) {
         pd->channel.flush(pd->channel.data);
@@ -741,9 +750,73 @@ cp_send_command(struct osdp_pd *pd)
         }
     }
 
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    pd->cmd_tx_us = os_get_uptime_usec();
+    pd->cp_stats.commands++;
+#endif
+
     return OSDP_CP_ERR_NONE;
 }
 
+static int
+cp_send_command(struct osdp_pd *pd)
+{
+    int len;
+
+    len = cp_build_packet(pd);
+    if (len < 0) {
+        return OSDP_CP_ERR_GENERIC;
+    }
+
+    return cp_send_packet(pd, len);
+}
+
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+static void
+cp_rtt_sample(struct osdp_pd *pd)
+{
+    struct osdp_cp_pd_stats *st = &pd->cp_stats;
+    uint32_t rtt;
+
+    rtt = (uint32_t)(os_get_uptime_usec() - pd->cmd_tx_us);
+    st->replies++;
+    st->rtt_last_us = rtt;
+    if (st->rtt_avg_us == 0) {
+        st->rtt_avg_us = rtt;
+    } else {
+        st->rtt_avg_us = st->rtt_avg_us - (st->rtt_avg_us >> 3) + (rtt >> 3);
+    }
+    if (rtt > st->rtt_max_us) {
+        st->rtt_max_us = rtt;
+    }
+}
+
+#define cp_poll_interval(pd)    ((pd)->poll_ms)
+
+/*
+ * With OSDP_CP_POLL_IDLE_MS set, PDs that have nothing to report are
+ * polled progressively less often, up to that limit; any reply other than
+ * a plain ACK snaps back to the base rate.
+ */
+static void
+cp_poll_adapt(struct osdp_pd *pd)
+{
+    if (OSDP_CP_POLL_IDLE_MS <= OSDP_PD_POLL_TIMEOUT_MS ||
+        pd->poll_ms < OSDP_PD_POLL_TIMEOUT_MS ||
+        pd->reply_id != REPLY_ACK) {
+        pd->poll_ms = OSDP_PD_POLL_TIMEOUT_MS;
+    } else {
+        pd->poll_ms += pd->poll_ms / 4;
+        if (pd->poll_ms > OSDP_CP_POLL_IDLE_MS) {
+            pd->poll_ms = OSDP_CP_POLL_IDLE_MS;
+        }
+    }
+    pd->cp_stats.poll_ms = pd->poll_ms;
+}
+#else
+#define cp_poll_interval(pd)    OSDP_PD_POLL_TIMEOUT_MS
+#endif
+
 static int
 cp_process_reply(struct osdp_pd *pd)
 {
@@ -802,6 +875,10 @@ cp_set_online(struct osdp_pd *pd)
 {
     cp_set_state(pd, OSDP_CP_STATE_ONLINE);
     pd->wait_ms = 0;
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    pd->poll_ms = OSDP_PD_POLL_TIMEOUT_MS;
+    pd->cp_stats.poll_ms = pd->poll_ms;
+#endif
 }
 
 static inline void
@@ -855,9 +932,27 @@ cp_phy_state_update(struct osdp_pd *pd)
         pd->rx_buf_len = 0; /* reset buf_len for next use */
         pd->phy_tstamp = osdp_millis_now();
         break;
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    case OSDP_CP_PHY_STATE_CMD_READY:
+        /* built by cp_prepare_command() while the bus was busy */
+        if (cp_send_packet(pd, pd->cmd_len) < 0) {
+            OSDP_LOG_ERROR("osdp: cp: Failed to send CMD(%d)\n", pd->cmd_id);
+            pd->phy_state = OSDP_CP_PHY_STATE_ERR;
+            ret = OSDP_CP_ERR_GENERIC;
+            break;
+        }
+        ret = OSDP_CP_ERR_INPROG;
+        pd->phy_state = OSDP_CP_PHY_STATE_REPLY_WAIT;
+        pd->rx_buf_len = 0;
+        pd->phy_tstamp = osdp_millis_now();
+        break;
+#endif
     case OSDP_CP_PHY_STATE_REPLY_WAIT:
         rc = cp_process_reply(pd);
         if (rc == OSDP_CP_ERR_NONE) {
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+            cp_rtt_sample(pd);
+#endif
             pd->phy_state = OSDP_CP_PHY_STATE_IDLE;
             break;
         }
@@ -872,6 +967,9 @@ cp_phy_state_update(struct osdp_pd *pd)
             if (rc != OSDP_CP_ERR_GENERIC) {
                 OSDP_LOG_ERROR("osdp: cp: Response timeout for CMD(%02x)",
               pd->cmd_id);
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+                pd->cp_stats.timeouts++;
+#endif
             }
             pd->rx_buf_len = 0;
             if (pd->channel.flush) {
@@ -961,11 +1059,14 @@ state_update(struct osdp_pd *pd)
             cp_set_state(pd, OSDP_CP_STATE_SC_INIT);
             break;
         }
-        if (osdp_millis_since(pd->tstamp) < OSDP_PD_POLL_TIMEOUT_MS) {
+        if (osdp_millis_since(pd->tstamp) < cp_poll_interval(pd)) {
             break;
         }
         if (cp_cmd_dispatcher(pd, CMD_POLL) == 0) {
             pd->tstamp = osdp_millis_now();
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+            cp_poll_adapt(pd);
+#endif
         }
         break;
     case OSDP_CP_STATE_OFFLINE:
@@ -1112,6 +1213,42 @@ state_update(struct osdp_pd *pd)
     return OSDP_CP_ERR_CAN_YIELD;
 }
 
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+/*
+ * Called for a PD that is waiting for a shared channel. Whatever it would
+ * send next (a queued command, or a POLL that fell due) is built now, so
+ * that it goes out as soon as the channel is released instead of after
+ * another full refresh.
+ */
+static void
+cp_prepare_command(struct osdp_pd *pd)
+{
+    struct osdp_cmd *cmd;
+    int ret, len;
+
+    if (pd->phy_state != OSDP_CP_PHY_STATE_IDLE) {
+        return;
+    }
+    if (pd->state == OSDP_CP_STATE_ONLINE &&
+        !ISSET_FLAG(pd, PD_FLAG_AWAIT_RESP) &&
+        osdp_millis_since(pd->tstamp) >= cp_poll_interval(pd)) {
+        cp_cmd_dispatcher(pd, CMD_POLL);
+    }
+    if (cp_cmd_get(pd, &cmd, &ret)) {
+        return;
+    }
+
+    len = cp_build_packet(pd);
+    if (len < 0) {
+        OSDP_LOG_ERROR("osdp: cp: Failed to build CMD(%d)\n", pd->cmd_id);
+        pd->phy_state = OSDP_CP_PHY_STATE_ERR;
+        return;
+    }
+    pd->cmd_len = len;
+    pd->phy_state = OSDP_CP_PHY_STATE_CMD_READY;
+}
+#endif
+
 static int
 osdp_cp_send_command_keyset(osdp_t *ctx, struct osdp_cmd_keyset *p)
 {
@@ -1218,12 +1355,21 @@ osdp_cp_teardown(osdp_t *ctx)
 void
 osdp_refresh(osdp_t *ctx)
 {
-    int i, rc;
+    int i, n, rc;
     struct osdp_pd *pd;
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    struct osdp_cp *cp = TO_CP(ctx);
+#endif
 
     assert(ctx);
 
-    for (i = 0; i < NUM_PD(ctx); i++) {
+    for (n = 0; n < NUM_PD(ctx); n++) {
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+        /* rotate the starting PD so one PD cannot hog a shared bus */
+        i = (cp->rr_offset + n) % NUM_PD(ctx);
+#else
+        i = n;
+#endif
         SET_CURRENT_PD(ctx, i);
         /*
            osdp_log_ctx_set(i);
@@ -1233,6 +1379,9 @@ osdp_refresh(osdp_t *ctx)
         if (ISSET_FLAG(pd, PD_FLAG_CHN_SHARED) &&
             cp_channel_acquire(pd, NULL)) {
             /* failed to lock shared channel */
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+            cp_prepare_command(pd);
+#endif
             continue;
         }
 
@@ -1243,6 +1392,27 @@ osdp_refresh(osdp_t *ctx)
             cp_channel_release(pd);
         }
     }
+
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+    /*
+     * Channels released above can be taken right away by a PD that has a
+     * command ready, rather than sitting idle until the next refresh.
+     */
+    for (n = 0; n < NUM_PD(ctx); n++) {
+        i = (cp->rr_offset + n) % NUM_PD(ctx);
+        pd = TO_PD(ctx, i);
+        if (pd->phy_state != OSDP_CP_PHY_STATE_CMD_READY ||
+            cp_channel_acquire(pd, NULL)) {
+            continue;
+        }
+        SET_CURRENT_PD(ctx, i);
+        rc = state_update(pd);
+        if (rc == OSDP_CP_ERR_CAN_YIELD) {
+            cp_channel_release(pd);
+        }
+    }
+    cp->rr_offset = (cp->rr_offset + 1) % NUM_PD(ctx);
+#endif
 }
 
 /* --- Exported Methods --- */
@@ -1302,4 +1472,20 @@ osdp_cp_send_command(osdp_t *ctx, int pd, struct osdp_cmd *p)
     return cp_cmd_put(TO_PD(ctx, pd), p, cmd_id);
 }
 
+#if MYNEWT_VAL(OSDP_CP_PIPELINE)
+int
+osdp_cp_get_pd_stats(osdp_t *ctx, int pd, struct osdp_cp_pd_stats *stats)
+{
+    assert(ctx);
+
+    if (pd < 0 || pd >= NUM_PD(ctx)) {
+        OSDP_LOG_ERROR("osdp: cp: Invalid PD number\n");
+        return -1;
+    }
+    *stats = TO_PD(ctx, pd)->cp_stats;
+
+    return 0;
+}
+#endif
+
 #endif /* OSDP_MODE_CP */
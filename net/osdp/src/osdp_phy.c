@@ -27,15 +27,14 @@ struct osdp_packet_header {
 uint8_t
 osdp_compute_checksum(uint8_t *msg, int length)
 {
-    uint8_t checksum = 0;
-    int i, whole_checksum;
+    uint8_t sum = 0;
+    int i;
 
-    whole_checksum = 0;
     for (i = 0; i < length; i++) {
-        whole_checksum += msg[i];
-        checksum = ~(0xff & whole_checksum) + 1;
+        sum += msg[i];
     }
-    return checksum;
+    /* two's complement of the byte sum */
+    return ~sum + 1;
 }
 
 static int
@@ -205,13 +205,15 @@ osdp_compute_mac(struct osdp_pd *pd, int is_cmd,
 {
     int pad_len;
     uint8_t buf[max(MYNEWT_VAL(OSDP_UART_TX_BUFFER_LENGTH),
-            MYNEWT_VAL(OSDP_UART_RX_BUFFER_LENGTH))] = { 0 };
+            MYNEWT_VAL(OSDP_UART_RX_BUFFER_LENGTH))];
     uint8_t iv[16];
 
     memcpy(buf, data, len);
     pad_len = (len % 16 == 0) ? len : AES_PAD_LEN(len);
     if (len % 16 != 0) {
         buf[len] = 0x80; /* end marker */
+        /* only the padding needs clearing, not the whole buffer */
+        memset(buf + len + 1, 0, pad_len - len - 1);
     }
     /**
      * MAC for data blocks B[1] .. B[N] (post padding) is computed as:
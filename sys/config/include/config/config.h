@@ -206,6 +206,19 @@ struct conf_handler {
 
     /** Custom argument that gets passed to the extended callbacks */
     void *ch_arg;
+
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    /**
+     * Whether stored values are applied on first use of the subtree
+     * instead of by conf_load().
+     * false: loaded by conf_load()
+     * true:  loaded on first access, see conf_ensure_loaded_tree()
+     */
+    bool ch_lazy;
+
+    /** Private; load state of a lazy handler. */
+    uint8_t ch_lazy_state;
+#endif
 };
 
 void conf_init(void);
@@ -246,6 +259,23 @@ int conf_load_one(char *name);
  */
 int conf_ensure_loaded(void);
 
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+/**
+ * @brief Makes sure stored values of a configuration subtree have been
+ * applied.
+ *
+ * Handlers registered with ch_lazy set are skipped by conf_load(), which
+ * only records whether storage holds values for them.  Their values are
+ * applied, and the handler's commit called, the first time the subtree is
+ * accessed through conf_get_value(), conf_set_value() or an export, or
+ * when this function is called for it.
+ *
+ * @param name of the configuration subtree.
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_ensure_loaded_tree(const char *name);
+#endif
+
 /**
  * Export configuration via user defined function.
  *
@@ -289,6 +319,36 @@ int conf_save_tree(char *name);
  */
 int conf_save_one(const char *name, char *var);
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+/**
+ * Start a batch of saves. Values saved with conf_save_one(), conf_save() or
+ * conf_save_tree() until conf_save_batch_commit() is called are only loaded
+ * back if the whole batch made it to storage. The config lock is held for
+ * the duration of the batch.
+ *
+ * @return 0 on success, OS_EBUSY if a batch is already open, OS_ENOENT if
+ *         there is no destination for saves, OS_EINVAL if it does not
+ *         support batches.
+ */
+int conf_save_batch_begin(void);
+
+/**
+ * Complete a batch of saves started with conf_save_batch_begin().
+ *
+ * @return 0 on success, non-zero if the batch could not be written; none of
+ *         its values are then used.
+ */
+int conf_save_batch_commit(void);
+
+/**
+ * Drop a batch of saves started with conf_save_batch_begin(); none of its
+ * values are used.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_save_batch_abort(void);
+#endif
+
 /**
  * Set configuration item identified by @p name to be value @p val_str.
  * This finds the configuration handler for this subtree and calls it's
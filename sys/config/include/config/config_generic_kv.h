@@ -77,6 +77,20 @@ int conf_fcb_kv_save(struct fcb *, const char *name, const char *value);
 int conf_fcb2_kv_save(struct fcb2 *, const char *name, const char *value);
 #endif
 
+/**
+ * Forget cached values of FCB key-value storage area
+ *
+ * With CONFIG_CACHE, the first load from an FCB kv store reads the whole
+ * area into the config cache, and later loads and saves go through the
+ * cache.  Call this if the area is changed other than through
+ * conf_fcb_kv_save() / conf_fcb2_kv_save(), e.g. when it is erased.
+ *
+ * @param fcb    FCB with kv store
+ */
+#if MYNEWT_VAL(CONFIG_CACHE)
+void conf_kv_cache_drop(const void *fcb);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,9 @@ struct conf_store_itf {
     int (*csi_save_start)(struct conf_store *cs);
     int (*csi_save)(struct conf_store *cs, const char *name, const char *value);
     int (*csi_save_end)(struct conf_store *cs);
+    /* Optional; values saved in between are applied all or none. */
+    int (*csi_batch_start)(struct conf_store *cs);
+    int (*csi_batch_end)(struct conf_store *cs, int commit);
 };
 
 struct conf_store {
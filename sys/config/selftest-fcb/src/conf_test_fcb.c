@@ -382,6 +382,21 @@ TEST_SUITE(config_test_c2)
 
     config_test_save_one_fcb();
     config_test_get_stored_fcb();
+#if MYNEWT_VAL(CONFIG_CACHE)
+    config_test_cache();
+#endif
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+    config_test_compact_incremental();
+#endif
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+    config_test_binary();
+#endif
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    config_test_save_batch();
+#endif
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    config_test_lazy_load();
+#endif
 }
 
 TEST_SUITE(config_test_c3)
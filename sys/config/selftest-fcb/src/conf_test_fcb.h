@@ -97,6 +97,11 @@ TEST_CASE_DECL(config_test_compress_reset)
 TEST_CASE_DECL(config_test_save_one_fcb)
 TEST_CASE_DECL(config_test_custom_compress)
 TEST_CASE_DECL(config_test_get_stored_fcb)
+TEST_CASE_DECL(config_test_cache)
+TEST_CASE_DECL(config_test_compact_incremental)
+TEST_CASE_DECL(config_test_binary)
+TEST_CASE_DECL(config_test_save_batch)
+TEST_CASE_DECL(config_test_lazy_load)
 
 #ifdef __cplusplus
 }
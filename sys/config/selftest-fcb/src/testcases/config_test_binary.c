@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+#include "config/config_generic_kv.h"
+
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+
+static const struct {
+    const char *val;        /* saved */
+    const char *loaded;     /* read back */
+    int type;
+    int len;                /* of the stored value */
+} config_test_binary_vals[] = {
+    { "0", "0", CONF_BIN_UINT, 1 },
+    { "127", "127", CONF_BIN_UINT, 1 },
+    { "128", "128", CONF_BIN_UINT, 2 },
+    { "-17", "-17", CONF_BIN_NINT, 1 },
+    { "18446744073709551615", "18446744073709551615", CONF_BIN_UINT, 10 },
+    { "-18446744073709551615", "-18446744073709551615", CONF_BIN_NINT, 10 },
+    { "18446744073709551617x", "18446744073709551617x", CONF_BIN_STR, 21 },
+    /* Too big for an integer, but happens to be valid base64. */
+    { "18446744073709551616", "18446744073709551616", CONF_BIN_BYTES, 15 },
+    { "007", "007", CONF_BIN_STR, 3 },
+    { "-0", "-0", CONF_BIN_STR, 2 },
+    { "AQIDBA==", "AQIDBA==", CONF_BIN_BYTES, 4 },
+    { "AQID", "AQID", CONF_BIN_BYTES, 3 },
+    { "AR==", "AR==", CONF_BIN_STR, 4 },
+    { "A===", "A===", CONF_BIN_STR, 4 },
+    { "hello world", "hello world", CONF_BIN_STR, 11 },
+    { "  spaced", "spaced", CONF_BIN_STR, 6 },
+    { "cut\nhere", "cut", CONF_BIN_STR, 3 },
+    { "", NULL, CONF_BIN_DEL, 0 },
+    { NULL, NULL, CONF_BIN_DEL, 0 },
+};
+
+TEST_CASE_SELF(config_test_binary)
+{
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char stored_val[CONF_MAX_VAL_LEN];
+    char *name;
+    char *val;
+    struct fcb_entry loc;
+    struct fcb kv;
+    int len;
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(config_test_binary_vals) /
+                    sizeof(config_test_binary_vals[0]); i++) {
+        len = conf_bin_make(buf, sizeof(buf), "bin/v",
+                            config_test_binary_vals[i].val);
+        TEST_ASSERT_FATAL(len > 0);
+        TEST_ASSERT(buf[0] == config_test_binary_vals[i].type);
+        TEST_ASSERT(len == 2 + 5 + config_test_binary_vals[i].len);
+
+        rc = conf_record_parse(buf, len, sizeof(buf), &name, &val);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(!strcmp(name, "bin/v"));
+        if (config_test_binary_vals[i].loaded) {
+            TEST_ASSERT_FATAL(val != NULL);
+            TEST_ASSERT(!strcmp(val, config_test_binary_vals[i].loaded));
+        } else {
+            TEST_ASSERT(val == NULL);
+        }
+    }
+
+    /* Longest value still fits when loaded. */
+    memset(stored_val, 'A', sizeof(stored_val) - 4);
+    stored_val[sizeof(stored_val) - 4] = '\0';
+    len = conf_bin_make(buf, sizeof(buf), "bin/v", stored_val);
+    TEST_ASSERT_FATAL(len > 0);
+    TEST_ASSERT(buf[0] == CONF_BIN_BYTES);
+    rc = conf_record_parse(buf, len, sizeof(buf), &name, &val);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(!strcmp(val, stored_val));
+
+    /*
+     * Saved records are binary, and "name=value" lines written before are
+     * still read.
+     */
+    config_wipe_fcb(&fcb_areas[2], 2);
+    memset(&kv, 0, sizeof(kv));
+    kv.f_magic = 0x12345678;
+    kv.f_sectors = &fcb_areas[2];
+    kv.f_sector_cnt = 2;
+    rc = fcb_init(&kv);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    len = conf_line_make(buf, sizeof(buf), "kv/old", "1234");
+    rc = fcb_append(&kv, len, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_append_finish(&kv, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = conf_fcb_kv_save(&kv, "kv/new", "-4321");
+    TEST_ASSERT(rc == 0);
+
+    loc.fe_area = NULL;
+    loc.fe_elem_off = 0;
+    rc = fcb_getnext(&kv, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_getnext(&kv, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(loc.fe_data_len == 2 + 6 + 2);
+    rc = flash_area_read(loc.fe_area, loc.fe_data_off, buf, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(buf[0] == CONF_BIN_NINT);
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_kv_cache_drop(&kv);
+#endif
+    rc = conf_fcb_kv_load(&kv, "kv/old", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "1234"));
+    rc = conf_fcb_kv_load(&kv, "kv/new", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "-4321"));
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_kv_cache_drop(&kv);
+#endif
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+#include "config/config_generic_kv.h"
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+
+TEST_CASE_SELF(config_test_cache)
+{
+    char stored_val[64];
+    char name[32];
+    char val[33];
+    struct conf_fcb cf;
+    struct fcb kv;
+    int rc;
+    int i;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    memset(&cf, 0, sizeof(cf));
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = 2;
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    /*
+     * Saved values read back the way storage returns them.
+     */
+    rc = conf_save_one("cache/a", "1");
+    TEST_ASSERT(rc == 0);
+    rc = conf_get_stored_value("cache/a", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "1"));
+
+    rc = conf_save_one("cache/a", "  22");
+    TEST_ASSERT(rc == 0);
+    rc = conf_get_stored_value("cache/a", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "22"));
+
+    rc = conf_save_one("cache/a", NULL);
+    TEST_ASSERT(rc == 0);
+    rc = conf_get_stored_value("cache/a", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stored_val[0] == '\0');
+
+    rc = conf_get_stored_value("cache/none", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == OS_ENOENT);
+
+    /*
+     * Lookups are served from RAM: wiping the flash does not affect them
+     * until the source is registered again.
+     */
+    rc = conf_save_one("cache/b", "bval");
+    TEST_ASSERT(rc == 0);
+    config_wipe_fcb(fcb_areas, 2);
+    rc = conf_get_stored_value("cache/b", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "bval"));
+
+    config_wipe_srcs();
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+    rc = conf_get_stored_value("cache/b", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == OS_ENOENT);
+
+    /*
+     * Overflowing the cache falls back to reading storage.
+     */
+    memset(val, 'v', sizeof(val) - 1);
+    val[sizeof(val) - 1] = '\0';
+    for (i = 0; i < MYNEWT_VAL(CONFIG_CACHE_SIZE) / 32; i++) {
+        snprintf(name, sizeof(name), "cache/k%d", i);
+        val[0] = 'a' + i % 26;
+        rc = conf_save_one(name, val);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    for (i = 0; i < MYNEWT_VAL(CONFIG_CACHE_SIZE) / 32; i++) {
+        snprintf(name, sizeof(name), "cache/k%d", i);
+        rc = conf_get_stored_value(name, stored_val, sizeof(stored_val));
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(stored_val[0] == 'a' + i % 26);
+        TEST_ASSERT(strlen(stored_val) == sizeof(val) - 1);
+    }
+
+    /*
+     * Generic kv loads are served from the cache once read.
+     */
+    memset(&kv, 0, sizeof(kv));
+    kv.f_magic = 0x12345678;
+    kv.f_sectors = &fcb_areas[2];
+    kv.f_sector_cnt = 2;
+    rc = fcb_init(&kv);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = conf_fcb_kv_save(&kv, "kv/x", "1");
+    TEST_ASSERT(rc == 0);
+    rc = conf_fcb_kv_load(&kv, "kv/x", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "1"));
+
+    rc = conf_fcb_kv_save(&kv, "kv/x", "23");
+    TEST_ASSERT(rc == 0);
+    rc = conf_fcb_kv_load(&kv, "kv/x", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "23"));
+
+    strcpy(stored_val, "untouched");
+    rc = conf_fcb_kv_load(&kv, "kv/y", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "untouched"));
+
+    config_wipe_fcb(&fcb_areas[2], 2);
+    rc = conf_fcb_kv_load(&kv, "kv/x", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "23"));
+
+    /* Once dropped, the wiped area is read again. */
+    conf_kv_cache_drop(&kv);
+    rc = fcb_init(&kv);
+    TEST_ASSERT_FATAL(rc == 0);
+    strcpy(stored_val, "untouched");
+    rc = conf_fcb_kv_load(&kv, "kv/x", stored_val, sizeof(stored_val));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(stored_val, "untouched"));
+
+    config_wipe_srcs();
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+TEST_CASE_SELF(config_test_compact_incremental)
+{
+    int rc;
+    int i;
+    int steps;
+    struct conf_fcb cf;
+    struct os_event *ev;
+    char test_value[CONF_TEST_FCB_VAL_STR_CNT][CONF_MAX_VAL_LEN];
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    memset(&cf, 0, sizeof(cf));
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    /* Only stored in the oldest sector; has to be copied. */
+    val8 = 33;
+    c2_var_count = 1;
+    test_export_block = 0;
+
+    /* Fill up until only the scratch sector is left. */
+    for (i = 0; fcb_free_sector_cnt(&cf.cf_fcb) > 1; i++) {
+        config_test_fill_area(test_value, i);
+        memcpy(val_string, test_value, sizeof(val_string));
+
+        rc = conf_save();
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(cf.cf_fcb.f_oldest == &fcb_areas[0]);
+
+    /* Run the cycle, saving new values in between its steps. */
+    steps = 0;
+    while ((ev = os_eventq_get_no_wait(os_eventq_dflt_get())) != NULL) {
+        ev->ev_cb(ev);
+        steps++;
+
+        config_test_fill_area(test_value, i++);
+        memcpy(val_string, test_value, sizeof(val_string));
+
+        rc = conf_save();
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(steps > 1);
+    TEST_ASSERT(cf.cf_fcb.f_oldest == &fcb_areas[1]);
+    TEST_ASSERT(cf.cf_fcb.f_active.fe_area == &fcb_areas[2]);
+    TEST_ASSERT(fcb_free_sector_cnt(&cf.cf_fcb) == 2);
+
+    test_export_block = 1;
+    val8 = 0;
+    memset(val_string, 0, sizeof(val_string));
+
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 33);
+    TEST_ASSERT(!memcmp(val_string, test_value, CONF_MAX_VAL_LEN));
+
+    c2_var_count = 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+
+static int lazy_val;
+static int lazy_set_cnt;
+static int lazy_commit_cnt;
+
+static char *
+lazy_get(int argc, char **argv, char *val, int val_len_max)
+{
+    if (argc == 1 && !strcmp(argv[0], "v")) {
+        return conf_str_from_value(CONF_INT32, &lazy_val, val, val_len_max);
+    }
+    return NULL;
+}
+
+static int
+lazy_set(int argc, char **argv, char *val)
+{
+    lazy_set_cnt++;
+    if (argc == 1 && !strcmp(argv[0], "v")) {
+        return CONF_VALUE_SET(val, CONF_INT32, lazy_val);
+    }
+    return OS_ENOENT;
+}
+
+static int
+lazy_commit(void)
+{
+    lazy_commit_cnt++;
+    return 0;
+}
+
+static struct conf_handler lazy_handler = {
+    .ch_name = "lazy",
+    .ch_get = lazy_get,
+    .ch_set = lazy_set,
+    .ch_commit = lazy_commit,
+    .ch_lazy = true,
+};
+
+TEST_CASE_SELF(config_test_lazy_load)
+{
+    char name[16];
+    char tmp[16];
+    char *str;
+    struct conf_fcb cf;
+    int set_cnt;
+    int rc;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    memset(&cf, 0, sizeof(cf));
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = 2;
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_register(&lazy_handler);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*
+     * Without stored values, the handler is committed by conf_load().
+     */
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lazy_set_cnt == 0);
+    TEST_ASSERT(lazy_commit_cnt == 1);
+
+    rc = conf_save_one("lazy/v", "7");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_one("lazy/v", "8");
+    TEST_ASSERT(rc == 0);
+
+    /*
+     * Stored values are left alone until the subtree is used.
+     */
+    lazy_set_cnt = 0;
+    lazy_commit_cnt = 0;
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lazy_set_cnt == 0);
+    TEST_ASSERT(lazy_commit_cnt == 0);
+    TEST_ASSERT(lazy_val == 0);
+
+    strcpy(name, "lazy/v");
+    str = conf_get_value(name, tmp, sizeof(tmp));
+    TEST_ASSERT(str && !strcmp(str, "8"));
+    TEST_ASSERT(lazy_set_cnt > 0);
+    TEST_ASSERT(lazy_commit_cnt == 1);
+
+    set_cnt = lazy_set_cnt;
+    strcpy(name, "lazy/v");
+    str = conf_get_value(name, tmp, sizeof(tmp));
+    TEST_ASSERT(str && !strcmp(str, "8"));
+    TEST_ASSERT(lazy_set_cnt == set_cnt);
+    TEST_ASSERT(lazy_commit_cnt == 1);
+
+    /*
+     * A value set before first use is not overwritten by the stored one.
+     */
+    lazy_val = 0;
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    strcpy(name, "lazy/v");
+    rc = conf_set_value(name, "9");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lazy_val == 9);
+    rc = conf_ensure_loaded_tree("lazy");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lazy_val == 9);
+
+    /*
+     * Without the cache, values are read back from storage.
+     */
+    lazy_val = 0;
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_lock();
+    conf_cache_drop(CONF_CACHE_STORE);
+    conf_unlock();
+#endif
+    rc = conf_ensure_loaded_tree("lazy/v");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(lazy_val == 8);
+
+    config_wipe_srcs();
+}
+
+#endif
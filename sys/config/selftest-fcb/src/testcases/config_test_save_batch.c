@@ -0,0 +1,162 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+
+static struct conf_fcb config_test_batch_cf;
+
+/* Registers the fcb again, as done at boot. */
+static void
+config_test_batch_reinit(void)
+{
+    struct conf_fcb *cf = &config_test_batch_cf;
+    int rc;
+
+    config_wipe_srcs();
+    memset(cf, 0, sizeof(*cf));
+    cf->cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf->cf_fcb.f_sectors = fcb_areas;
+    cf->cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(cf);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_fcb_dst(cf);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+config_test_batch_check(const char *name, const char *val)
+{
+    char stored_val[CONF_MAX_VAL_LEN];
+    int rc;
+
+    rc = conf_get_stored_value((char *)name, stored_val, sizeof(stored_val));
+    if (val) {
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(!strcmp(stored_val, val));
+    } else {
+        TEST_ASSERT(rc == OS_ENOENT);
+    }
+}
+
+TEST_CASE_SELF(config_test_save_batch)
+{
+    struct fcb *fcb = &config_test_batch_cf.cf_fcb;
+    struct fcb_entry loc;
+    char name[16];
+    char val[48];
+    char buf[32];
+    int len;
+    int rc;
+    int i;
+
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+    config_test_batch_reinit();
+
+    /* Committed batch. */
+    rc = conf_save_batch_begin();
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(conf_save_batch_begin() == OS_EBUSY);
+    rc = conf_save_one("batch/a", "1");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_one("batch/b", "2");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_batch_commit();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(conf_save_batch_commit() == OS_EINVAL);
+
+    config_test_batch_reinit();
+    config_test_batch_check("batch/a", "1");
+    config_test_batch_check("batch/b", "2");
+
+    /* Aborted batch. */
+    rc = conf_save_batch_begin();
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = conf_save_one("batch/a", "10");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_one("batch/c", "30");
+    TEST_ASSERT(rc == 0);
+    rc = conf_save_batch_abort();
+    TEST_ASSERT(rc == 0);
+
+    config_test_batch_reinit();
+    config_test_batch_check("batch/a", "1");
+    config_test_batch_check("batch/c", NULL);
+
+    /* Batch larger than the staging buffer. */
+    rc = conf_save_batch_begin();
+    TEST_ASSERT_FATAL(rc == 0);
+    memset(val, 'v', sizeof(val) - 1);
+    val[sizeof(val) - 1] = '\0';
+    for (i = 0; i < MYNEWT_VAL(CONFIG_SAVE_BATCH_BUF_SIZE) / 32; i++) {
+        snprintf(name, sizeof(name), "batch/k%d", i);
+        rc = conf_save_one(name, val);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = conf_save_batch_commit();
+    TEST_ASSERT(rc == 0);
+
+    config_test_batch_reinit();
+    for (i = 0; i < MYNEWT_VAL(CONFIG_SAVE_BATCH_BUF_SIZE) / 32; i++) {
+        snprintf(name, sizeof(name), "batch/k%d", i);
+        config_test_batch_check(name, val);
+    }
+
+    /*
+     * Batch cut short by a reset: it is closed when the fcb is registered
+     * again, and later saves are used as usual.
+     */
+    buf[0] = CONF_FCB_BATCH;
+    len = 1 + conf_line_make(buf + 1, sizeof(buf) - 1, "batch/a", "99");
+    rc = fcb_append(fcb, len, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, buf, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_append_finish(fcb, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    config_test_batch_reinit();
+    config_test_batch_check("batch/a", "1");
+    rc = conf_save_one("batch/d", "4");
+    TEST_ASSERT(rc == 0);
+
+    config_test_batch_reinit();
+    config_test_batch_check("batch/a", "1");
+    config_test_batch_check("batch/d", "4");
+
+    /*
+     * Compaction carries committed values over, and does not bring back
+     * dropped ones.
+     */
+    for (i = 0; i < fcb->f_sector_cnt - 1; i++) {
+        conf_fcb_compress(&config_test_batch_cf, NULL, NULL);
+    }
+
+    config_test_batch_reinit();
+    config_test_batch_check("batch/a", "1");
+    config_test_batch_check("batch/b", "2");
+    config_test_batch_check("batch/c", NULL);
+    config_test_batch_check("batch/d", "4");
+    config_test_batch_check("batch/k0", val);
+
+    config_wipe_srcs();
+}
+
+#endif
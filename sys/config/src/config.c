@@ -47,6 +47,7 @@ conf_init(void)
     int rc;
 
     os_mutex_init(&conf_mtx);
+    os_mutex_stats_register(&conf_mtx, "conf");
 
     SLIST_INIT(&conf_handlers);
     conf_store_init();
@@ -87,6 +88,15 @@ int
 conf_register(struct conf_handler *handler)
 {
     conf_lock();
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    /*
+     * Until conf_load() has recorded whether storage has values for the
+     * subtree, look for them on first use.
+     */
+    if (handler->ch_lazy) {
+        handler->ch_lazy_state = CONF_LAZY_PENDING;
+    }
+#endif
     SLIST_INSERT_HEAD(&conf_handlers, handler, ch_list);
     conf_unlock();
     return 0;
@@ -397,6 +407,10 @@ int
 conf_export_cb(struct conf_handler *ch, conf_export_func_t export_func,
                conf_export_tgt_t tgt)
 {
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    /* Don't export (and persist) defaults over stored values. */
+    conf_lazy_load(ch);
+#endif
     if (ch->ch_ext) {
         if (ch->ch_export_ext != NULL) {
             return ch->ch_export_ext(export_func, tgt, ch->ch_arg);
@@ -437,6 +451,12 @@ conf_set_value(char *name, char *val_str)
         goto out;
     }
 
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    /* Stored values must not overwrite this one later. */
+    if (!conf_set_from_storage()) {
+        conf_lazy_load(ch);
+    }
+#endif
     rc = conf_set_cb(ch, name_argc - 1, &name_argv[1], val_str);
 
 out:
@@ -464,6 +484,9 @@ conf_get_value(char *name, char *buf, int buf_len)
         goto out;
     }
 
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    conf_lazy_load(ch);
+#endif
     rval = conf_get_cb(ch, name_argc - 1, &name_argv[1], buf, buf_len);
 
 out:
@@ -492,6 +515,12 @@ conf_commit(char *name)
     } else {
         rc = 0;
         SLIST_FOREACH(ch, &conf_handlers, ch_list) {
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+            /* Committed once its values have been applied. */
+            if (ch->ch_lazy && ch->ch_lazy_state == CONF_LAZY_PENDING) {
+                continue;
+            }
+#endif
             if (ch->ch_commit) {
                 rc2 = conf_commit_cb(ch);
                 if (!rc) {
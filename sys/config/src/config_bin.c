@@ -0,0 +1,277 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+
+#include <ctype.h>
+#include <string.h>
+
+#include "base64/base64.h"
+#include "config/config.h"
+#include "config_priv.h"
+
+/*
+ * Binary config record, as stored in FCB:
+ *
+ *     [type:1][name length:1][name][value]
+ *
+ * The value runs to the end of the entry. Integers which are written out in
+ * canonical decimal form are stored as a LEB128 varint of their magnitude,
+ * and canonical base64 strings as the bytes they encode. Everything else is
+ * stored as a plain string. Records decode back to exactly the string which
+ * a "name=value" line would have given.
+ */
+
+/* Varint can hold 64 bits. */
+#define CONF_BIN_VARINT_MAX     10
+
+/* Longest decimal output of a varint value, with sign and terminator. */
+#define CONF_BIN_DEC_MAX        22
+
+/*
+ * Returns 1 if val is the canonical decimal form of an integer which fits in
+ * 64 bits of magnitude, storing the magnitude in *mag.
+ */
+static int
+conf_bin_is_int(const char *val, int vlen, int *neg, uint64_t *mag)
+{
+    uint64_t v;
+    int d;
+    int i;
+
+    i = 0;
+    *neg = 0;
+    if (vlen > 1 && val[0] == '-') {
+        *neg = 1;
+        i = 1;
+    }
+    if (i == vlen || (val[i] == '0' && (vlen - i > 1 || *neg))) {
+        return 0;
+    }
+    v = 0;
+    for (; i < vlen; i++) {
+        if (!isdigit((unsigned char)val[i])) {
+            return 0;
+        }
+        d = val[i] - '0';
+        if (v > (UINT64_MAX - d) / 10) {
+            return 0;
+        }
+        v = v * 10 + d;
+    }
+    *mag = v;
+    return 1;
+}
+
+/*
+ * Decodes a base64 string into dst. Returns the number of bytes, or -1 if
+ * encoding them again would not give back the same string.
+ */
+static int
+conf_bin_from_base64(const char *val, int vlen, uint8_t *dst, int dlen)
+{
+    struct base64_decoder dec = {
+        .src = val,
+        .dst = dst,
+        .src_len = vlen,
+        .dst_len = dlen,
+    };
+    char chk[BASE64_ENCODE_SIZE(3) + 1];
+    int off;
+    int len;
+
+    if (vlen < 4 || vlen % 4 || vlen / 4 * 3 > dlen) {
+        return -1;
+    }
+    len = base64_decoder_go(&dec);
+    if (len <= 0) {
+        return -1;
+    }
+
+    /* Stray padding or non-zero trailing bits would not survive. */
+    for (off = 0; off < len; off += 3) {
+        base64_encode(dst + off, min(3, len - off), chk, 1);
+        if (memcmp(chk, val + off / 3 * 4, 4)) {
+            return -1;
+        }
+    }
+    if (len / 3 * 4 + (len % 3 ? 4 : 0) != vlen) {
+        return -1;
+    }
+    return len;
+}
+
+int
+conf_bin_make(char *dst, int dlen, const char *name, const char *value)
+{
+    uint8_t *p;
+    uint64_t mag;
+    int nlen;
+    int vlen;
+    int neg;
+    int off;
+    int rc;
+
+    /* Same value as conf_line_parse() would find in "name=value". */
+    vlen = 0;
+    if (value) {
+        while (isspace((unsigned char)*value)) {
+            value++;
+        }
+        while (isprint((unsigned char)value[vlen])) {
+            vlen++;
+        }
+    }
+
+    nlen = strlen(name);
+    if (nlen > UINT8_MAX || nlen + vlen + 2 > dlen) {
+        return -1;
+    }
+    p = (uint8_t *)dst;
+    p[1] = nlen;
+    memcpy(p + 2, name, nlen);
+    off = nlen + 2;
+
+    if (vlen == 0) {
+        p[0] = CONF_BIN_DEL;
+        return off;
+    }
+    if (conf_bin_is_int(value, vlen, &neg, &mag)) {
+        p[0] = neg ? CONF_BIN_NINT : CONF_BIN_UINT;
+        do {
+            p[off] = mag & 0x7f;
+            mag >>= 7;
+            if (mag) {
+                p[off] |= 0x80;
+            }
+            off++;
+        } while (mag);
+        return off;
+    }
+    rc = conf_bin_from_base64(value, vlen, p + off, dlen - off);
+    if (rc > 0) {
+        p[0] = CONF_BIN_BYTES;
+        return off + rc;
+    }
+    p[0] = CONF_BIN_STR;
+    memcpy(p + off, value, vlen);
+    return off + vlen;
+}
+
+/*
+ * Formats a varint as a decimal string at dst.
+ */
+static int
+conf_bin_int_to_str(const uint8_t *src, int len, int neg, char *dst)
+{
+    char tmp[CONF_BIN_DEC_MAX];
+    uint64_t mag;
+    int shift;
+    int off;
+    int i;
+
+    mag = 0;
+    shift = 0;
+    for (i = 0; ; i++) {
+        if (i == len || i == CONF_BIN_VARINT_MAX) {
+            return -1;
+        }
+        mag |= (uint64_t)(src[i] & 0x7f) << shift;
+        shift += 7;
+        if (!(src[i] & 0x80)) {
+            break;
+        }
+    }
+
+    off = sizeof(tmp);
+    tmp[--off] = '\0';
+    do {
+        tmp[--off] = '0' + mag % 10;
+        mag /= 10;
+    } while (mag);
+    if (neg) {
+        tmp[--off] = '-';
+    }
+    memcpy(dst, tmp + off, sizeof(tmp) - off);
+    return 0;
+}
+
+int
+conf_bin_parse(char *buf, int len, int blen, char **namep, char **valp)
+{
+    uint8_t type;
+    char *val;
+    int nlen;
+    int vlen;
+    int tail;
+
+    if (len < 2) {
+        return -1;
+    }
+    type = buf[0];
+    nlen = (uint8_t)buf[1];
+    if (nlen == 0 || nlen + 2 > len) {
+        return -1;
+    }
+    vlen = len - nlen - 2;
+
+    /* Name moves to the front, value follows its terminator. */
+    memmove(buf, buf + 2, nlen);
+    buf[nlen] = '\0';
+    *namep = buf;
+    val = buf + nlen + 1;
+    *valp = val;
+
+    switch (type) {
+    case CONF_BIN_DEL:
+        *valp = NULL;
+        return 0;
+    case CONF_BIN_STR:
+        memmove(val, val + 1, vlen);
+        val[vlen] = '\0';
+        return 0;
+    case CONF_BIN_UINT:
+    case CONF_BIN_NINT:
+        if (nlen + 1 + CONF_BIN_DEC_MAX > blen) {
+            return -1;
+        }
+        return conf_bin_int_to_str((uint8_t *)val + 1, vlen,
+                                   type == CONF_BIN_NINT, val);
+    case CONF_BIN_BYTES:
+        /*
+         * Encode from the end of the buffer; base64_encode() reads each
+         * group of 3 bytes before writing its 4 characters, so the output
+         * can only catch up with the input after the input is used up.
+         */
+        if (nlen + 1 + BASE64_ENCODE_SIZE(vlen) + 1 > blen) {
+            return -1;
+        }
+        tail = blen - vlen;
+        memmove(buf + tail, val + 1, vlen);
+        base64_encode(buf + tail, vlen, val, 1);
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+#endif
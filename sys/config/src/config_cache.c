@@ -0,0 +1,411 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+
+#include "config/config.h"
+#include "config/config_generic_kv.h"
+#include "config_priv.h"
+
+/*
+ * Resident cache of stored config values.
+ *
+ * Entries are kept in a static arena, each followed by its name and value,
+ * and chained into hash buckets by name.  Entries are only ever appended;
+ * replaced ones are marked dead, and the arena is compacted when it fills.
+ *
+ * The cache holds values for a small number of "tags", each naming one
+ * collection of key/value pairs (the merged config store, or a generic kv
+ * fcb).  A tag is only used to answer lookups once it has been filled
+ * completely; if the arena overflows, the tag stops being complete and
+ * callers fall back to reading storage.
+ *
+ * All functions must be called with the config lock held.
+ */
+
+#define CONF_CACHE_SIZE         MYNEWT_VAL(CONFIG_CACHE_SIZE)
+#define CONF_CACHE_BUCKETS      MYNEWT_VAL(CONFIG_CACHE_BUCKETS)
+#define CONF_CACHE_MAX_TAGS     MYNEWT_VAL(CONFIG_CACHE_MAX_TAGS)
+
+#define CONF_CACHE_ENTRY_SIZE(name_len, val_len)                        \
+    ((sizeof(struct conf_cache_entry) + (name_len) + (val_len) + 2 + 3) & ~3)
+
+struct conf_cache_entry {
+    /** Arena offset + 1 of the next entry in the bucket; 0 ends it. */
+    uint16_t cce_next;
+    /** Size of the entry, including its strings and padding. */
+    uint16_t cce_size;
+    uint32_t cce_hash;
+    uint8_t cce_tag;
+    uint8_t cce_live;
+    /** Offset of the value within cce_data. */
+    uint16_t cce_val_off;
+    char cce_data[];
+};
+
+enum conf_cache_state {
+    CONF_CACHE_FREE = 0,
+    CONF_CACHE_FILLING,
+    CONF_CACHE_COMPLETE,
+    CONF_CACHE_INCOMPLETE,
+};
+
+struct conf_cache_tag {
+    const void *cct_tag;
+    uint8_t cct_state;
+};
+
+static uint32_t conf_cache_arena[CONF_CACHE_SIZE / 4];
+static uint16_t conf_cache_used;
+static uint16_t conf_cache_buckets[CONF_CACHE_BUCKETS];
+static struct conf_cache_tag conf_cache_tags[CONF_CACHE_MAX_TAGS];
+
+static struct conf_cache_entry *
+conf_cache_entry(uint16_t off)
+{
+    return (struct conf_cache_entry *)((uint8_t *)conf_cache_arena + off);
+}
+
+static uint32_t
+conf_cache_hash(const char *name)
+{
+    uint32_t hash;
+
+    /* FNV-1a. */
+    hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint16_t *
+conf_cache_bucket(uint32_t hash)
+{
+    return &conf_cache_buckets[hash % CONF_CACHE_BUCKETS];
+}
+
+static int
+conf_cache_tag_idx(const void *tag)
+{
+    int i;
+
+    for (i = 0; i < CONF_CACHE_MAX_TAGS; i++) {
+        if (conf_cache_tags[i].cct_state != CONF_CACHE_FREE &&
+            conf_cache_tags[i].cct_tag == tag) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static struct conf_cache_entry *
+conf_cache_lookup(int tag_idx, const char *name, uint32_t hash,
+                  uint16_t **out_link)
+{
+    struct conf_cache_entry *cce;
+    uint16_t *link;
+
+    link = conf_cache_bucket(hash);
+    while (*link != 0) {
+        cce = conf_cache_entry(*link - 1);
+        if (cce->cce_hash == hash && cce->cce_tag == tag_idx &&
+            !strcmp(cce->cce_data, name)) {
+
+            if (out_link != NULL) {
+                *out_link = link;
+            }
+            return cce;
+        }
+        link = &cce->cce_next;
+    }
+
+    return NULL;
+}
+
+static void
+conf_cache_unlink(struct conf_cache_entry *cce, uint16_t *link)
+{
+    *link = cce->cce_next;
+    cce->cce_live = 0;
+}
+
+/**
+ * Squeezes dead entries out of the arena and rebuilds the buckets.
+ */
+static void
+conf_cache_compact(void)
+{
+    struct conf_cache_entry *cce;
+    uint16_t *bucket;
+    uint16_t size;
+    uint16_t dst;
+    uint16_t off;
+
+    memset(conf_cache_buckets, 0, sizeof conf_cache_buckets);
+
+    dst = 0;
+    off = 0;
+    while (off < conf_cache_used) {
+        cce = conf_cache_entry(off);
+        size = cce->cce_size;
+
+        if (cce->cce_live) {
+            if (dst != off) {
+                memmove(conf_cache_entry(dst), cce, size);
+                cce = conf_cache_entry(dst);
+            }
+            bucket = conf_cache_bucket(cce->cce_hash);
+            cce->cce_next = *bucket;
+            *bucket = dst + 1;
+            dst += size;
+        }
+
+        off += size;
+    }
+
+    conf_cache_used = dst;
+}
+
+/**
+ * Removes all entries of the given tag.
+ */
+static void
+conf_cache_purge(int tag_idx)
+{
+    struct conf_cache_entry *cce;
+    uint16_t off;
+
+    for (off = 0; off < conf_cache_used; off += cce->cce_size) {
+        cce = conf_cache_entry(off);
+        if (cce->cce_tag == tag_idx) {
+            cce->cce_live = 0;
+        }
+    }
+    conf_cache_compact();
+}
+
+void
+conf_cache_init(void)
+{
+    memset(conf_cache_buckets, 0, sizeof conf_cache_buckets);
+    memset(conf_cache_tags, 0, sizeof conf_cache_tags);
+    conf_cache_used = 0;
+}
+
+int
+conf_cache_fill_start(const void *tag)
+{
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx < 0) {
+        for (idx = 0; idx < CONF_CACHE_MAX_TAGS; idx++) {
+            if (conf_cache_tags[idx].cct_state == CONF_CACHE_FREE) {
+                break;
+            }
+        }
+        if (idx == CONF_CACHE_MAX_TAGS) {
+            return OS_ENOMEM;
+        }
+        conf_cache_tags[idx].cct_tag = tag;
+    } else if (conf_cache_tags[idx].cct_state == CONF_CACHE_INCOMPLETE) {
+        /* Did not fit last time; stay out of the way until dropped. */
+        return OS_ENOMEM;
+    } else {
+        conf_cache_purge(idx);
+    }
+    conf_cache_tags[idx].cct_state = CONF_CACHE_FILLING;
+
+    return 0;
+}
+
+void
+conf_kv_cache_drop(const void *fcb)
+{
+    conf_lock();
+    conf_cache_drop(fcb);
+    conf_unlock();
+}
+
+void
+conf_cache_fill_done(const void *tag)
+{
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx >= 0 && conf_cache_tags[idx].cct_state == CONF_CACHE_FILLING) {
+        conf_cache_tags[idx].cct_state = CONF_CACHE_COMPLETE;
+    }
+}
+
+void
+conf_cache_drop(const void *tag)
+{
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx >= 0) {
+        conf_cache_purge(idx);
+        conf_cache_tags[idx].cct_state = CONF_CACHE_FREE;
+    }
+}
+
+bool
+conf_cache_ready(const void *tag)
+{
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    return idx >= 0 && conf_cache_tags[idx].cct_state == CONF_CACHE_COMPLETE;
+}
+
+void
+conf_cache_put(const void *tag, const char *name, const char *val)
+{
+    struct conf_cache_entry *cce;
+    uint16_t *link;
+    uint32_t hash;
+    size_t name_len;
+    size_t val_len;
+    size_t size;
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx < 0 || conf_cache_tags[idx].cct_state == CONF_CACHE_INCOMPLETE) {
+        return;
+    }
+
+    if (val == NULL) {
+        val = "";
+    }
+    name_len = strlen(name);
+    val_len = strlen(val);
+    size = CONF_CACHE_ENTRY_SIZE(name_len, val_len);
+
+    hash = conf_cache_hash(name);
+    cce = conf_cache_lookup(idx, name, hash, &link);
+    if (cce != NULL) {
+        if (!strcmp(cce->cce_data + cce->cce_val_off, val)) {
+            return;
+        }
+        if (cce->cce_size == size) {
+            /* Same footprint; overwrite the value in place. */
+            memcpy(cce->cce_data + cce->cce_val_off, val, val_len + 1);
+            return;
+        }
+        conf_cache_unlink(cce, link);
+    }
+
+    if (conf_cache_used + size > sizeof conf_cache_arena) {
+        conf_cache_compact();
+    }
+    if (conf_cache_used + size > sizeof conf_cache_arena) {
+        /* Out of room; this tag can no longer answer lookups. */
+        conf_cache_purge(idx);
+        conf_cache_tags[idx].cct_state = CONF_CACHE_INCOMPLETE;
+        return;
+    }
+
+    cce = conf_cache_entry(conf_cache_used);
+    cce->cce_size = size;
+    cce->cce_hash = hash;
+    cce->cce_tag = idx;
+    cce->cce_live = 1;
+    cce->cce_val_off = name_len + 1;
+    memcpy(cce->cce_data, name, name_len + 1);
+    memcpy(cce->cce_data + cce->cce_val_off, val, val_len + 1);
+
+    link = conf_cache_bucket(hash);
+    cce->cce_next = *link;
+    *link = conf_cache_used + 1;
+
+    conf_cache_used += size;
+}
+
+void
+conf_cache_put_line(const void *tag, const char *name, const char *val)
+{
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char *name_str;
+    char *val_str;
+    int rc;
+
+    /* Store the value as it will be read back from storage. */
+    rc = conf_line_make(buf, sizeof(buf), name, val);
+    if (rc >= 0) {
+        rc = conf_line_parse(buf, &name_str, &val_str);
+    }
+    if (rc < 0) {
+        conf_cache_drop(tag);
+        return;
+    }
+
+    conf_cache_put(tag, name_str, val_str);
+}
+
+const char *
+conf_cache_find(const void *tag, const char *name)
+{
+    struct conf_cache_entry *cce;
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx < 0) {
+        return NULL;
+    }
+
+    cce = conf_cache_lookup(idx, name, conf_cache_hash(name), NULL);
+    if (cce == NULL) {
+        return NULL;
+    }
+
+    return cce->cce_data + cce->cce_val_off;
+}
+
+int
+conf_cache_walk(const void *tag, conf_cache_walk_fn *fn, void *arg)
+{
+    struct conf_cache_entry *cce;
+    uint16_t off;
+    int idx;
+
+    idx = conf_cache_tag_idx(tag);
+    if (idx < 0 || conf_cache_tags[idx].cct_state != CONF_CACHE_COMPLETE) {
+        return OS_ENOENT;
+    }
+
+    for (off = 0; off < conf_cache_used; off += cce->cce_size) {
+        cce = conf_cache_entry(off);
+        if (cce->cce_live && cce->cce_tag == idx) {
+            fn(cce->cce_data, cce->cce_data + cce->cce_val_off, arg);
+        }
+    }
+
+    return 0;
+}
+
+#endif
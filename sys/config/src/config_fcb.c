@@ -33,27 +33,164 @@
 
 #define CONF_FCB_VERS		1
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+/* What became of the batch last seen while walking through the fcb. */
+#define CONF_FCB_RUN_UNKNOWN    0
+#define CONF_FCB_RUN_COMMITTED  1
+#define CONF_FCB_RUN_DROPPED    2
+
+struct conf_fcb_batch {
+    struct fcb *cb_fcb;         /* fcb with a batch open, NULL if none */
+    int cb_flushed;             /* entries already written to flash */
+    struct fcb_batch cb_stage;
+    uint8_t cb_buf[MYNEWT_VAL(CONFIG_SAVE_BATCH_BUF_SIZE)];
+};
+
+static struct conf_fcb_batch conf_fcb_batch;
+#endif
+
 struct conf_fcb_load_cb_arg {
     conf_store_load_cb cb;
     void *cb_arg;
+    struct fcb *fcb;
+    uint8_t run;
 };
 
 struct conf_kv_load_cb_arg {
     const char *name;
     char *value;
     size_t len;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* With no name, every value is added to the cache under this tag. */
+    const void *cache_tag;
+#endif
+};
+
+/*
+ * State of a compaction cycle: the oldest sector is walked an entry at a
+ * time, and values which have not been overwritten are copied to the end of
+ * the fcb.  Once the walk leaves the oldest sector, that sector is erased.
+ */
+struct conf_fcb_compact {
+    struct fcb *cc_fcb;         /* fcb being compacted, NULL if idle */
+    struct fcb_entry cc_loc;    /* last entry examined */
+    int (*cc_copy_or_not)(const char *name, const char *val, void *cn_arg);
+    void *cc_arg;
+    uint8_t cc_scratch;         /* copies are being written to scratch */
+    uint8_t cc_run;             /* batch state at cc_loc */
+};
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+static os_event_fn conf_fcb_compact_ev_fn;
+
+/* Compaction done in the background, a few entries per event. */
+static struct conf_fcb_compact conf_fcb_compact_bg;
+
+static struct os_event conf_fcb_compact_ev = {
+    .ev_cb = conf_fcb_compact_ev_fn,
 };
+#endif
 
 static int conf_fcb_load(struct conf_store *, conf_store_load_cb cb,
                          void *cb_arg);
 static int conf_fcb_save(struct conf_store *, const char *name,
                          const char *value);
+static int conf_fcb_append(struct fcb *fcb, char *buf, int len);
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+static int conf_fcb_batch_start(struct conf_store *);
+static int conf_fcb_batch_end(struct conf_store *, int commit);
+#endif
 
 static struct conf_store_itf conf_fcb_itf = {
     .csi_load = conf_fcb_load,
     .csi_save = conf_fcb_save,
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    .csi_batch_start = conf_fcb_batch_start,
+    .csi_batch_end = conf_fcb_batch_end,
+#endif
 };
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+/*
+ * Finds out whether the batch which the entry at loc is part of was
+ * committed, by looking for the marker which follows it.
+ */
+static int
+conf_fcb_batch_outcome(struct fcb *fcb, const struct fcb_entry *loc)
+{
+    struct fcb_entry next;
+    uint8_t type;
+
+    next = *loc;
+    while (fcb_getnext(fcb, &next) == 0) {
+        if (flash_area_read(next.fe_area, next.fe_data_off, &type, 1)) {
+            continue;
+        }
+        if (type == CONF_FCB_COMMIT) {
+            return CONF_FCB_RUN_COMMITTED;
+        }
+        if (type == CONF_FCB_ABORT) {
+            break;
+        }
+    }
+    return CONF_FCB_RUN_DROPPED;
+}
+
+/*
+ * Checks a record read from loc while walking forward through the fcb, run
+ * tracking the batch seen last. Batch tags are stripped off. Returns the new
+ * length, or -1 for markers and entries of batches which were not committed.
+ */
+static int
+conf_fcb_batch_filter(struct fcb *fcb, const struct fcb_entry *loc,
+                      uint8_t *run, char *buf, int len)
+{
+    if (len == 0) {
+        return len;
+    }
+    switch ((uint8_t)buf[0]) {
+    case CONF_FCB_COMMIT:
+    case CONF_FCB_ABORT:
+        *run = CONF_FCB_RUN_UNKNOWN;
+        return -1;
+    case CONF_FCB_BATCH:
+        if (*run == CONF_FCB_RUN_UNKNOWN) {
+            *run = conf_fcb_batch_outcome(fcb, loc);
+        }
+        if (*run != CONF_FCB_RUN_COMMITTED) {
+            return -1;
+        }
+        memmove(buf, buf + 1, len - 1);
+        return len - 1;
+    default:
+        return len;
+    }
+}
+
+/*
+ * A batch left open by a reset is closed, so that entries written from now
+ * on are not taken to be part of it.
+ */
+static void
+conf_fcb_batch_close(struct fcb *fcb)
+{
+    struct fcb_entry loc;
+    uint8_t type;
+
+    loc.fe_area = NULL;
+    if (fcb_getprev(fcb, &loc)) {
+        return;
+    }
+    if (flash_area_read(loc.fe_area, loc.fe_data_off, &type, 1)) {
+        return;
+    }
+    if (type == CONF_FCB_BATCH) {
+        type = CONF_FCB_ABORT;
+        conf_fcb_append(fcb, (char *)&type, 1);
+    }
+}
+#endif
+
 int
 conf_fcb_src(struct conf_fcb *cf)
 {
@@ -84,6 +221,20 @@ conf_fcb_src(struct conf_fcb *cf)
         }
     }
 
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+    /*
+     * Abandon any background cycle; it is started again by the next save.
+     * Entries it has copied so far are just duplicates.
+     */
+    conf_lock();
+    conf_fcb_compact_bg.cc_fcb = NULL;
+    conf_unlock();
+#endif
+
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    conf_fcb_batch_close(&cf->cf_fcb);
+#endif
+
     cf->cf_store.cs_itf = &conf_fcb_itf;
     conf_src_register(&cf->cf_store);
 
@@ -120,9 +271,13 @@ conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
     if (rc) {
         return 0;
     }
-    buf[len] = '\0';
-
-    rc = conf_line_parse(buf, &name_str, &val_str);
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    len = conf_fcb_batch_filter(argp->fcb, loc, &argp->run, buf, len);
+    if (len < 0) {
+        return 0;
+    }
+#endif
+    rc = conf_record_parse(buf, len, sizeof(buf), &name_str, &val_str);
     if (rc) {
         return 0;
     }
@@ -139,6 +294,8 @@ conf_fcb_load(struct conf_store *cs, conf_store_load_cb cb, void *cb_arg)
 
     arg.cb = cb;
     arg.cb_arg = cb_arg;
+    arg.fcb = &cf->cf_fcb;
+    arg.run = 0;
     rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_load_cb, &arg);
     if (rc) {
         return OS_EINVAL;
@@ -146,101 +303,248 @@ conf_fcb_load(struct conf_store *cs, conf_store_load_cb cb, void *cb_arg)
     return OS_OK;
 }
 
+/*
+ * Reads and parses the entry at loc; run tracks batches while walking
+ * forward, see conf_fcb_batch_filter().
+ */
 static int
-conf_fcb_var_read(struct fcb_entry *loc, char *buf, char **name, char **val)
+conf_fcb_var_read(struct fcb *fcb, struct fcb_entry *loc, uint8_t *run,
+                  char *buf, char **name, char **val)
 {
+    int len;
     int rc;
 
-    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, loc->fe_data_len);
+    len = loc->fe_data_len;
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
     if (rc) {
         return rc;
     }
-    buf[loc->fe_data_len] = '\0';
-    rc = conf_line_parse(buf, name, val);
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    len = conf_fcb_batch_filter(fcb, loc, run, buf, len);
+    if (len < 0) {
+        return -1;
+    }
+#endif
+    /* Callers' buffers are sized for the longest name and value. */
+    rc = conf_record_parse(buf, len,
+                           CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32,
+                           name, val);
     return rc;
 }
 
 static void
-conf_fcb_compress_internal(struct fcb *fcb,
-                           int (*copy_or_not)(const char *name, const char *val,
-                                              void *cn_arg),
-                           void *cn_arg)
+conf_fcb_compact_start(struct conf_fcb_compact *cc, struct fcb *fcb,
+                       int (*copy_or_not)(const char *name, const char *val,
+                                          void *cn_arg),
+                       void *cn_arg)
+{
+    memset(cc, 0, sizeof(*cc));
+    cc->cc_fcb = fcb;
+    cc->cc_copy_or_not = copy_or_not;
+    cc->cc_arg = cn_arg;
+}
+
+/*
+ * Copy the entry at cc_loc to the end of the fcb, unless there is a newer
+ * value for the same name.
+ */
+static void
+conf_fcb_compact_entry(struct conf_fcb_compact *cc)
 {
     int rc;
     char buf1[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    struct fcb_entry loc1;
+    struct fcb *fcb;
     struct fcb_entry loc2;
     char *name1, *val1;
     char *name2, *val2;
-    int copy;
+    char *data;
+    uint8_t run;
+    int len;
 
-    rc = fcb_append_to_scratch(fcb);
+    fcb = cc->cc_fcb;
+    rc = conf_fcb_var_read(fcb, &cc->cc_loc, &cc->cc_run, buf1, &name1,
+                           &val1);
     if (rc) {
-        return; /* XXX */
+        return;
     }
-
-    loc1.fe_area = NULL;
-    loc1.fe_elem_off = 0;
-    while (fcb_getnext(fcb, &loc1) == 0) {
-        if (loc1.fe_area != fcb->f_oldest) {
-            break;
-        }
+    if (!val1) {
+        return;
+    }
+    loc2 = cc->cc_loc;
+    run = cc->cc_run;
+    while (fcb_getnext(fcb, &loc2) == 0) {
         hal_watchdog_tickle();
-        rc = conf_fcb_var_read(&loc1, buf1, &name1, &val1);
+        rc = conf_fcb_var_read(fcb, &loc2, &run, buf2, &name2, &val2);
         if (rc) {
             continue;
         }
-        if (!val1) {
-            continue;
-        }
-        loc2 = loc1;
-        copy = 1;
-        while (fcb_getnext(fcb, &loc2) == 0) {
-            hal_watchdog_tickle();
-            rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
-            if (rc) {
-                continue;
-            }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
-            }
-        }
-        if (!copy) {
-            continue;
+        if (!strcmp(name1, name2)) {
+            return;
         }
+    }
 
-        if (copy_or_not) {
-            if (copy_or_not(name1, val1, cn_arg)) {
-                /* Copy rejected */
-                continue;
-            }
+    if (cc->cc_copy_or_not) {
+        if (cc->cc_copy_or_not(name1, val1, cc->cc_arg)) {
+            /* Copy rejected */
+            return;
         }
+    }
+    /*
+     * Can't find one. Must copy.
+     */
+    len = cc->cc_loc.fe_data_len;
+    rc = flash_area_read(cc->cc_loc.fe_area, cc->cc_loc.fe_data_off, buf1,
+      len);
+    if (rc) {
+        return;
+    }
+    data = buf1;
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    /* The copy stands on its own; the batch was committed. */
+    if ((uint8_t)data[0] == CONF_FCB_BATCH) {
+        data++;
+        len--;
+    }
+#endif
+    rc = fcb_append(fcb, len, &loc2);
+    if (rc == FCB_ERR_NOSPACE && !cc->cc_scratch) {
         /*
-         * Can't find one. Must copy.
+         * Ran out of room before the oldest sector was emptied; continue
+         * in the scratch sector.
          */
-        rc = flash_area_read(loc1.fe_area, loc1.fe_data_off, buf1,
-          loc1.fe_data_len);
+        rc = fcb_append_to_scratch(fcb);
         if (rc) {
-            continue;
+            return;
         }
-        rc = fcb_append(fcb, loc1.fe_data_len, &loc2);
-        if (rc) {
-            continue;
+        cc->cc_scratch = 1;
+        rc = fcb_append(fcb, len, &loc2);
+    }
+    if (rc) {
+        return;
+    }
+    rc = flash_area_write(loc2.fe_area, loc2.fe_data_off, data, len);
+    if (rc) {
+        return;
+    }
+    fcb_append_finish(fcb, &loc2);
+}
+
+/*
+ * Examine up to max entries of the oldest sector, or all of them if max is
+ * negative.  Once copies have spilled into the scratch sector, the cycle is
+ * always finished: new values must not be written there before the oldest
+ * sector is erased, or conf_fcb_src() would discard them after a reset.
+ *
+ * Returns 1 when the cycle is complete, 0 if there are entries left.
+ * Must be called with conf_lock held.
+ */
+static int
+conf_fcb_compact_step(struct conf_fcb_compact *cc, int max)
+{
+    struct fcb *fcb;
+    int rc;
+
+    fcb = cc->cc_fcb;
+    while (1) {
+        if (max == 0 && !cc->cc_scratch) {
+            return 0;
         }
-        rc = flash_area_write(loc2.fe_area, loc2.fe_data_off, buf1,
-          loc1.fe_data_len);
-        if (rc) {
-            continue;
+        if (fcb_getnext(fcb, &cc->cc_loc) ||
+            cc->cc_loc.fe_area != fcb->f_oldest) {
+            break;
+        }
+        hal_watchdog_tickle();
+        conf_fcb_compact_entry(cc);
+        if (max > 0) {
+            max--;
         }
-        fcb_append_finish(fcb, &loc2);
     }
+
     rc = fcb_rotate(fcb);
     if (rc) {
         /* XXXX */
         ;
     }
+    cc->cc_fcb = NULL;
+    return 1;
+}
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+/*
+ * Start a background cycle once only the scratch sectors are left free, so
+ * that the oldest sector has been emptied by the time the active one fills.
+ */
+static void
+conf_fcb_compact_kick(struct fcb *fcb)
+{
+    if (conf_fcb_compact_bg.cc_fcb != NULL) {
+        return;
+    }
+    if (fcb->f_scratch_cnt == 0 || fcb->f_oldest == fcb->f_active.fe_area) {
+        return;
+    }
+    if (fcb_free_sector_cnt(fcb) > fcb->f_scratch_cnt) {
+        return;
+    }
+    conf_fcb_compact_start(&conf_fcb_compact_bg, fcb, NULL, NULL);
+    os_eventq_put(os_eventq_dflt_get(), &conf_fcb_compact_ev);
+}
+
+static void
+conf_fcb_compact_ev_fn(struct os_event *ev)
+{
+    struct fcb *fcb;
+
+    conf_lock();
+    fcb = conf_fcb_compact_bg.cc_fcb;
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    /* Picked up again when the batch ends. */
+    if (fcb != NULL && conf_fcb_batch.cb_fcb == fcb) {
+        fcb = NULL;
+    }
+#endif
+    if (fcb != NULL) {
+        if (conf_fcb_compact_step(&conf_fcb_compact_bg,
+                                  MYNEWT_VAL(CONFIG_FCB_COMPACT_STEP))) {
+            conf_fcb_compact_kick(fcb);
+        } else {
+            os_eventq_put(os_eventq_dflt_get(), ev);
+        }
+    }
+    conf_unlock();
+}
+#endif
+
+/*
+ * Free up the oldest sector. Must be called with conf_lock held.
+ */
+static void
+conf_fcb_compress_internal(struct fcb *fcb,
+                           int (*copy_or_not)(const char *name, const char *val,
+                                              void *cn_arg),
+                           void *cn_arg)
+{
+    struct conf_fcb_compact cc;
+    int rc;
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+    if (conf_fcb_compact_bg.cc_fcb == fcb) {
+        /* Finish the cycle which is in progress. */
+        conf_fcb_compact_step(&conf_fcb_compact_bg, -1);
+        if (!copy_or_not) {
+            return;
+        }
+    }
+#endif
+
+    rc = fcb_append_to_scratch(fcb);
+    if (rc) {
+        return; /* XXX */
+    }
+    conf_fcb_compact_start(&cc, fcb, copy_or_not, cn_arg);
+    cc.cc_scratch = 1;
+    conf_fcb_compact_step(&cc, -1);
 }
 
 static int
@@ -268,6 +572,9 @@ conf_fcb_append(struct fcb *fcb, char *buf, int len)
         return OS_EINVAL;
     }
     fcb_append_finish(fcb, &loc);
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+    conf_fcb_compact_kick(fcb);
+#endif
     return OS_OK;
 }
 
@@ -279,13 +586,143 @@ conf_fcb_save(struct conf_store *cs, const char *name, const char *value)
     return conf_fcb_kv_save(&cf->cf_fcb, name, value);
 }
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+static int
+conf_fcb_batch_start(struct conf_store *cs)
+{
+    struct conf_fcb *cf = (struct conf_fcb *)cs;
+    struct fcb *fcb;
+
+    fcb = &cf->cf_fcb;
+    conf_fcb_batch.cb_fcb = fcb;
+    conf_fcb_batch.cb_flushed = 0;
+    fcb_batch_init(&conf_fcb_batch.cb_stage, conf_fcb_batch.cb_buf,
+                   sizeof(conf_fcb_batch.cb_buf));
+
+    /*
+     * Nothing can be compacted once part of the batch is in flash, so make
+     * room now if only the scratch sector is left.
+     */
+    if (fcb->f_scratch_cnt && fcb->f_oldest != fcb->f_active.fe_area &&
+        fcb_free_sector_cnt(fcb) <= fcb->f_scratch_cnt) {
+        conf_fcb_compress_internal(fcb, NULL, NULL);
+    }
+    return OS_OK;
+}
+
+/*
+ * Writes out the staged entries with a single flash write.
+ */
+static int
+conf_fcb_batch_flush(struct fcb *fcb)
+{
+    int cnt;
+    int rc;
+
+    cnt = conf_fcb_batch.cb_stage.fb_cnt;
+    if (cnt == 0) {
+        return OS_OK;
+    }
+    rc = fcb_batch_commit(fcb, &conf_fcb_batch.cb_stage, NULL);
+    if (rc == FCB_ERR_NOSPACE && conf_fcb_batch.cb_flushed == 0 &&
+        fcb->f_scratch_cnt) {
+        conf_fcb_compress_internal(fcb, NULL, NULL);
+        rc = fcb_batch_commit(fcb, &conf_fcb_batch.cb_stage, NULL);
+    }
+    if (rc) {
+        return rc == FCB_ERR_NOSPACE ? OS_ENOMEM : OS_EINVAL;
+    }
+    conf_fcb_batch.cb_flushed += cnt;
+    return OS_OK;
+}
+
+/*
+ * Stages a record, tagged as part of the batch.
+ */
+static int
+conf_fcb_batch_add(struct fcb *fcb, uint8_t type, const char *buf, int len)
+{
+    uint8_t *data;
+    int rc;
+
+    rc = fcb_batch_reserve(fcb, &conf_fcb_batch.cb_stage, len + 1,
+                           (void **)&data);
+    if (rc == FCB_ERR_NOMEM) {
+        rc = conf_fcb_batch_flush(fcb);
+        if (rc) {
+            return rc;
+        }
+        rc = fcb_batch_reserve(fcb, &conf_fcb_batch.cb_stage, len + 1,
+                               (void **)&data);
+    }
+    if (rc) {
+        return OS_ENOMEM;
+    }
+    data[0] = type;
+    if (len) {
+        memcpy(data + 1, buf, len);
+    }
+    return OS_OK;
+}
+
+static int
+conf_fcb_batch_end(struct conf_store *cs, int commit)
+{
+    struct conf_fcb *cf = (struct conf_fcb *)cs;
+    struct fcb *fcb;
+    uint8_t type;
+    int rc;
+
+    fcb = &cf->cf_fcb;
+    rc = OS_OK;
+    if (commit) {
+        if (conf_fcb_batch.cb_stage.fb_cnt || conf_fcb_batch.cb_flushed) {
+            rc = conf_fcb_batch_add(fcb, CONF_FCB_COMMIT, NULL, 0);
+            if (rc == 0) {
+                rc = conf_fcb_batch_flush(fcb);
+            }
+        }
+    }
+    if (!commit || rc) {
+        /* Entries which made it to flash are cancelled. */
+        if (conf_fcb_batch.cb_flushed) {
+            type = CONF_FCB_ABORT;
+            conf_fcb_append(fcb, (char *)&type, 1);
+        }
+#if MYNEWT_VAL(CONFIG_CACHE)
+        conf_cache_drop(fcb);
+#endif
+    }
+    conf_fcb_batch.cb_fcb = NULL;
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPACT_INCREMENTAL)
+    if (conf_fcb_compact_bg.cc_fcb != NULL) {
+        os_eventq_put(os_eventq_dflt_get(), &conf_fcb_compact_ev);
+    } else {
+        conf_fcb_compact_kick(fcb);
+    }
+#endif
+    return rc;
+}
+#endif
+
 void
 conf_fcb_compress(struct conf_fcb *cf,
                   int (*copy_or_not)(const char *name, const char *val,
                                      void *cn_arg),
                   void *cn_arg)
 {
+    conf_lock();
     conf_fcb_compress_internal(&cf->cf_fcb, copy_or_not, cn_arg);
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* The filter may have dropped values. */
+    if (copy_or_not != NULL) {
+        conf_cache_drop(CONF_CACHE_STORE);
+        conf_cache_drop(&cf->cf_fcb);
+    }
+#endif
+    conf_unlock();
 }
 
 static int
@@ -307,13 +744,18 @@ conf_kv_load_cb(struct fcb_entry *loc, void *arg)
     if (rc) {
         return 0;
     }
-    buf[len] = '\0';
-
-    rc = conf_line_parse(buf, &name_str, &val_str);
+    rc = conf_record_parse(buf, len, sizeof(buf), &name_str, &val_str);
     if (rc) {
         return 0;
     }
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+    if (cb_arg->name == NULL) {
+        conf_cache_put(cb_arg->cache_tag, name_str, val_str);
+        return 0;
+    }
+#endif
+
     if (strcmp(name_str, cb_arg->name)) {
         return 0;
     }
@@ -328,8 +770,36 @@ int
 conf_fcb_kv_load(struct fcb *fcb, const char *name, char *value, size_t len)
 {
     struct conf_kv_load_cb_arg arg;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    const char *val;
+#endif
     int rc;
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* Read the whole area into the cache once, then serve from there. */
+    conf_lock();
+    if (!conf_cache_ready(fcb) && conf_cache_fill_start(fcb) == 0) {
+        arg.name = NULL;
+        arg.cache_tag = fcb;
+        rc = fcb_walk(fcb, 0, conf_kv_load_cb, &arg);
+        if (rc) {
+            conf_cache_drop(fcb);
+        } else {
+            conf_cache_fill_done(fcb);
+        }
+    }
+    if (conf_cache_ready(fcb)) {
+        val = conf_cache_find(fcb, name);
+        if (val != NULL) {
+            strncpy(value, val, len);
+            value[len - 1] = '\0';
+        }
+        conf_unlock();
+        return OS_OK;
+    }
+    conf_unlock();
+#endif
+
     arg.name = name;
     arg.value = value;
     arg.len = len;
@@ -347,16 +817,43 @@ conf_fcb_kv_save(struct fcb *fcb, const char *name, const char *value)
 {
     char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     int len;
+    int rc;
 
     if (!name) {
         return OS_INVALID_PARM;
     }
 
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+    len = conf_bin_make(buf, sizeof(buf), name, value);
+#else
     len = conf_line_make(buf, sizeof(buf), name, value);
+#endif
     if (len < 0 || len + 2 > sizeof(buf)) {
         return OS_INVALID_PARM;
     }
-    return conf_fcb_append(fcb, buf, len);
+
+    /* Keeps appends and compaction cycles from interleaving. */
+    conf_lock();
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+    if (conf_fcb_batch.cb_fcb == fcb) {
+        rc = conf_fcb_batch_add(fcb, CONF_FCB_BATCH, buf, len);
+    } else {
+        rc = conf_fcb_append(fcb, buf, len);
+    }
+#else
+    rc = conf_fcb_append(fcb, buf, len);
+#endif
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    if (rc == 0) {
+        conf_cache_put_line(fcb, name, value);
+    } else {
+        conf_cache_drop(fcb);
+    }
+#endif
+    conf_unlock();
+
+    return rc;
 }
 
 #endif
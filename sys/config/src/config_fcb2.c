@@ -41,6 +41,10 @@ struct conf_kv_load_cb_arg {
     const char *name;
     char *value;
     size_t len;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* With no name, every value is added to the cache under this tag. */
+    const void *cache_tag;
+#endif
 };
 
 static int conf_fcb2_load(struct conf_store *, conf_store_load_cb cb,
@@ -118,9 +122,7 @@ conf_fcb2_load_cb(struct fcb2_entry *loc, void *arg)
     if (rc) {
         return 0;
     }
-    buf[len] = '\0';
-
-    rc = conf_line_parse(buf, &name_str, &val_str);
+    rc = conf_record_parse(buf, len, sizeof(buf), &name_str, &val_str);
     if (rc) {
         return 0;
     }
@@ -153,8 +155,10 @@ conf_fcb2_var_read(struct fcb2_entry *loc, char *buf, char **name, char **val)
     if (rc) {
         return rc;
     }
-    buf[loc->fe_data_len] = '\0';
-    rc = conf_line_parse(buf, name, val);
+    /* Callers' buffers are sized for the longest name and value. */
+    rc = conf_record_parse(buf, loc->fe_data_len,
+                           CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32,
+                           name, val);
     return rc;
 }
 
@@ -280,6 +284,16 @@ conf_fcb2_compress(struct conf_fcb2 *cf,
                    void *cn_arg)
 {
     conf_fcb2_compress_internal(&cf->cf2_fcb, copy_or_not, cn_arg);
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* The filter may have dropped values. */
+    if (copy_or_not != NULL) {
+        conf_lock();
+        conf_cache_drop(CONF_CACHE_STORE);
+        conf_cache_drop(&cf->cf2_fcb);
+        conf_unlock();
+    }
+#endif
 }
 
 static int
@@ -301,13 +315,18 @@ conf_kv_load_cb(struct fcb2_entry *loc, void *arg)
     if (rc) {
         return 0;
     }
-    buf[len] = '\0';
-
-    rc = conf_line_parse(buf, &name_str, &val_str);
+    rc = conf_record_parse(buf, len, sizeof(buf), &name_str, &val_str);
     if (rc) {
         return 0;
     }
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+    if (cb_arg->name == NULL) {
+        conf_cache_put(cb_arg->cache_tag, name_str, val_str);
+        return 0;
+    }
+#endif
+
     if (strcmp(name_str, cb_arg->name)) {
         return 0;
     }
@@ -322,8 +341,36 @@ int
 conf_fcb2_kv_load(struct fcb2 *fcb, const char *name, char *value, size_t len)
 {
     struct conf_kv_load_cb_arg arg;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    const char *val;
+#endif
     int rc;
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+    /* Read the whole area into the cache once, then serve from there. */
+    conf_lock();
+    if (!conf_cache_ready(fcb) && conf_cache_fill_start(fcb) == 0) {
+        arg.name = NULL;
+        arg.cache_tag = fcb;
+        rc = fcb2_walk(fcb, 0, conf_kv_load_cb, &arg);
+        if (rc) {
+            conf_cache_drop(fcb);
+        } else {
+            conf_cache_fill_done(fcb);
+        }
+    }
+    if (conf_cache_ready(fcb)) {
+        val = conf_cache_find(fcb, name);
+        if (val != NULL) {
+            strncpy(value, val, len);
+            value[len - 1] = '\0';
+        }
+        conf_unlock();
+        return OS_OK;
+    }
+    conf_unlock();
+#endif
+
     arg.name = name;
     arg.value = value;
     arg.len = len;
@@ -341,16 +388,33 @@ conf_fcb2_kv_save(struct fcb2 *fcb, const char *name, const char *value)
 {
     char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     int len;
+    int rc;
 
     if (!name) {
         return OS_INVALID_PARM;
     }
 
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+    len = conf_bin_make(buf, sizeof(buf), name, value);
+#else
     len = conf_line_make(buf, sizeof(buf), name, value);
+#endif
     if (len < 0 || len + 2 > sizeof(buf)) {
         return OS_INVALID_PARM;
     }
-    return conf_fcb2_append(fcb, buf, len);
+    rc = conf_fcb2_append(fcb, buf, len);
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_lock();
+    if (rc == 0) {
+        conf_cache_put_line(fcb, name, value);
+    } else {
+        conf_cache_drop(fcb);
+    }
+    conf_unlock();
+#endif
+
+    return rc;
 }
 
 #endif
@@ -97,3 +97,19 @@ conf_line_make(char *dst, int dlen, const char *name, const char *value)
 
     return off;
 }
+
+/*
+ * Parses a len byte record read from storage into a buffer of blen bytes;
+ * either a "name=value" line or, with CONFIG_FCB_BINARY, a binary record.
+ */
+int
+conf_record_parse(char *buf, int len, int blen, char **namep, char **valp)
+{
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+    if (len > 0 && buf[0] >= CONF_BIN_DEL && buf[0] <= CONF_BIN_BYTES) {
+        return conf_bin_parse(buf, len, blen, namep, valp);
+    }
+#endif
+    buf[len] = '\0';
+    return conf_line_parse(buf, namep, valp);
+}
@@ -31,6 +31,23 @@ struct mgmt_cbuf;
 int conf_line_parse(char *buf, char **namep, char **valp);
 int conf_line_make(char *dst, int dlen, const char *name, const char *val);
 int conf_line_make2(char *dst, int dlen, const char *name, const char *value);
+int conf_record_parse(char *buf, int len, int blen, char **namep,
+                      char **valp);
+
+#if MYNEWT_VAL(CONFIG_FCB_BINARY)
+/*
+ * Type of a binary config record; kept below the printable range so that
+ * records can be told apart from "name=value" lines.
+ */
+#define CONF_BIN_DEL            0x01    /* value deleted */
+#define CONF_BIN_STR            0x02    /* string */
+#define CONF_BIN_UINT           0x03    /* varint, non-negative integer */
+#define CONF_BIN_NINT           0x04    /* varint, magnitude of negative */
+#define CONF_BIN_BYTES          0x05    /* bytes, base64 when loaded */
+
+int conf_bin_make(char *dst, int dlen, const char *name, const char *value);
+int conf_bin_parse(char *buf, int len, int blen, char **namep, char **valp);
+#endif
 struct conf_handler *conf_parse_and_lookup(char *name, int *name_argc,
                                            char *name_argv[]);
 
@@ -46,6 +63,46 @@ SLIST_HEAD(conf_handler_head, conf_handler);
 extern struct conf_handler_head conf_handlers;
 extern struct conf_store *conf_save_dst;
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+/*
+ * Entries saved in a batch are tagged, and the batch is closed by a marker
+ * record. Tagged entries are only used if the next marker is a commit.
+ */
+#define CONF_FCB_BATCH          0x10    /* tag in front of a record */
+#define CONF_FCB_COMMIT         0x11
+#define CONF_FCB_ABORT          0x12
+#endif
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+/* Cache tag for the values of the registered config stores. */
+#define CONF_CACHE_STORE    ((const void *)&conf_load_srcs)
+
+void conf_cache_init(void);
+int conf_cache_fill_start(const void *tag);
+void conf_cache_fill_done(const void *tag);
+void conf_cache_drop(const void *tag);
+bool conf_cache_ready(const void *tag);
+void conf_cache_put(const void *tag, const char *name, const char *val);
+void conf_cache_put_line(const void *tag, const char *name,
+                         const char *val);
+const char *conf_cache_find(const void *tag, const char *name);
+
+/*
+ * Calls fn for every value cached for a complete tag.  fn must not modify
+ * the cache.
+ */
+typedef void conf_cache_walk_fn(const char *name, const char *val, void *arg);
+int conf_cache_walk(const void *tag, conf_cache_walk_fn *fn, void *arg);
+#endif
+
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+/* Load state of a lazy handler, see conf_handler.ch_lazy_state. */
+#define CONF_LAZY_LOADED        0   /* values applied, or none to apply */
+#define CONF_LAZY_PENDING       1   /* stored values not applied yet */
+
+int conf_lazy_load(struct conf_handler *ch);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,10 @@ struct conf_get_val_arg {
 
 struct conf_store_head conf_load_srcs;
 struct conf_store *conf_save_dst;
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+/* Destination of the batch being saved, NULL if none. */
+static struct conf_store *conf_batch_dst;
+#endif
 static bool conf_loading;
 static bool conf_loaded;
 
@@ -47,6 +51,12 @@ conf_src_register(struct conf_store *cs)
 {
     struct conf_store *prev, *cur;
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_lock();
+    conf_cache_drop(CONF_CACHE_STORE);
+    conf_unlock();
+#endif
+
     prev = NULL;
     SLIST_FOREACH(cur, &conf_load_srcs, cs_next) {
         prev = cur;
@@ -64,10 +74,50 @@ conf_dst_register(struct conf_store *cs)
     conf_save_dst = cs;
 }
 
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+/*
+ * Returns the lazy handler for the subtree the name belongs to, NULL if
+ * the name is handled by a regular handler or no handler at all.
+ */
+static struct conf_handler *
+conf_lazy_lookup(const char *name)
+{
+    struct conf_handler *ch;
+    size_t len;
+
+    len = strcspn(name, CONF_NAME_SEPARATOR);
+    SLIST_FOREACH(ch, &conf_handlers, ch_list) {
+        if (ch->ch_lazy && strlen(ch->ch_name) == len &&
+            !strncmp(ch->ch_name, name, len)) {
+            return ch;
+        }
+    }
+    return NULL;
+}
+#endif
+
 static void
 conf_load_cb(char *name, char *val, void *cb_arg)
 {
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    struct conf_handler *ch;
+#endif
+
     if (!cb_arg || !strcmp((char*)cb_arg, name)) {
+#if MYNEWT_VAL(CONFIG_CACHE)
+        /* Before conf_set_value() splits the name up. */
+        conf_cache_put(CONF_CACHE_STORE, name, val);
+#endif
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+        if (!cb_arg) {
+            /* Only note that the subtree has values to apply later. */
+            ch = conf_lazy_lookup(name);
+            if (ch) {
+                ch->ch_lazy_state = CONF_LAZY_PENDING;
+                return;
+            }
+        }
+#endif
         /* If cb_arg is set, set specific conf value
          * If cb_arg is not set, just set the value
          * anyways
@@ -101,6 +151,9 @@ int
 conf_load(void)
 {
     struct conf_store *cs;
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    struct conf_handler *ch;
+#endif
 
     /*
      * for every config store
@@ -111,12 +164,26 @@ conf_load(void)
     conf_lock();
     conf_loaded = true;
     conf_loading = true;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_cache_drop(CONF_CACHE_STORE);
+    conf_cache_fill_start(CONF_CACHE_STORE);
+#endif
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+    SLIST_FOREACH(ch, &conf_handlers, ch_list) {
+        if (ch->ch_lazy) {
+            ch->ch_lazy_state = CONF_LAZY_LOADED;
+        }
+    }
+#endif
     SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
         cs->cs_itf->csi_load(cs, conf_load_cb, NULL);
         if (SLIST_NEXT(cs, cs_next)) {
             conf_commit(NULL);
         }
     }
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_cache_fill_done(CONF_CACHE_STORE);
+#endif
     conf_loading = false;
     conf_unlock();
     return conf_commit(NULL);
@@ -132,12 +199,157 @@ conf_ensure_loaded(void)
     return conf_load();
 }
 
+#if MYNEWT_VAL(CONFIG_LAZY_LOAD)
+static void
+conf_lazy_set(const char *name, const char *val, struct conf_handler *ch)
+{
+    char buf[CONF_MAX_NAME_LEN + 1];
+    size_t len;
+
+    len = strlen(ch->ch_name);
+    if (strncmp(name, ch->ch_name, len) ||
+        (name[len] != '\0' && !strchr(CONF_NAME_SEPARATOR, name[len]))) {
+        return;
+    }
+
+    /* conf_set_value() splits the name up in place. */
+    strncpy(buf, name, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    conf_set_value(buf, (char *)val);
+}
+
+static void
+conf_lazy_load_cb(char *name, char *val, void *cb_arg)
+{
+    conf_lazy_set(name, val, cb_arg);
+}
+
+#if MYNEWT_VAL(CONFIG_CACHE)
+static void
+conf_lazy_cache_cb(const char *name, const char *val, void *arg)
+{
+    /* An empty value is read back from storage as NULL. */
+    conf_lazy_set(name, val[0] ? val : NULL, arg);
+}
+#endif
+
+int
+conf_lazy_load(struct conf_handler *ch)
+{
+    struct conf_store *cs;
+    bool was_loading;
+    int rc;
+
+    conf_lock();
+    if (ch->ch_lazy_state != CONF_LAZY_PENDING) {
+        conf_unlock();
+        return 0;
+    }
+    ch->ch_lazy_state = CONF_LAZY_LOADED;
+
+    was_loading = conf_loading;
+    conf_loading = true;
+    rc = -1;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    rc = conf_cache_walk(CONF_CACHE_STORE, conf_lazy_cache_cb, ch);
+#endif
+    if (rc != 0) {
+        SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+            cs->cs_itf->csi_load(cs, conf_lazy_load_cb, ch);
+        }
+    }
+    conf_loading = was_loading;
+
+    rc = conf_commit(ch->ch_name);
+    conf_unlock();
+
+    return rc;
+}
+
+int
+conf_ensure_loaded_tree(const char *name)
+{
+    struct conf_handler *ch;
+    int rc;
+
+    rc = conf_ensure_loaded();
+    if (rc) {
+        return rc;
+    }
+
+    conf_lock();
+    ch = conf_lazy_lookup(name);
+    if (ch) {
+        rc = conf_lazy_load(ch);
+    }
+    conf_unlock();
+
+    return rc;
+}
+#endif
+
 int
 conf_set_from_storage(void)
 {
     return conf_loading;
 }
 
+#if MYNEWT_VAL(CONFIG_CACHE)
+static void
+conf_cache_fill_cb(char *name, char *val, void *cb_arg)
+{
+    conf_cache_put(CONF_CACHE_STORE, name, val);
+}
+
+/*
+ * Makes sure the cache holds all stored values, reading them from the
+ * config stores if needed.  Returns false if the cache cannot be used.
+ */
+static bool
+conf_cache_fill(void)
+{
+    struct conf_store *cs;
+
+    if (conf_cache_ready(CONF_CACHE_STORE)) {
+        return true;
+    }
+    if (conf_cache_fill_start(CONF_CACHE_STORE) != 0) {
+        return false;
+    }
+    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+        cs->cs_itf->csi_load(cs, conf_cache_fill_cb, NULL);
+    }
+    conf_cache_fill_done(CONF_CACHE_STORE);
+
+    return conf_cache_ready(CONF_CACHE_STORE);
+}
+
+/*
+ * Records a value just written to the save destination.
+ */
+static void
+conf_cache_saved(const char *name, const char *value)
+{
+    struct conf_store *last;
+    struct conf_store *cs;
+
+    /*
+     * Values are read back from all sources in turn, the last one winning;
+     * the new value only shows through if the destination is read last.
+     */
+    last = NULL;
+    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+        last = cs;
+    }
+
+    if (last == conf_save_dst) {
+        conf_cache_put_line(CONF_CACHE_STORE, name, value);
+    } else {
+        conf_cache_drop(CONF_CACHE_STORE);
+    }
+}
+#endif
+
 static void
 conf_get_value_cb(char *name, char *val, void *cb_arg)
 {
@@ -159,6 +371,10 @@ conf_get_stored_value(char *name, char *buf, int buf_len)
 {
     struct conf_store *cs;
     struct conf_get_val_arg cgva;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    const char *val;
+#endif
+    bool cached;
     int val_len;
 
     cgva.name = name;
@@ -166,12 +382,24 @@ conf_get_stored_value(char *name, char *buf, int buf_len)
     cgva.val[sizeof(cgva.val) - 1] = '\0';
     cgva.seen = 0;
 
-    /*
-     * for every config store
-     */
     conf_lock();
-    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
-        cs->cs_itf->csi_load(cs, conf_get_value_cb, &cgva);
+    cached = false;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    cached = conf_cache_fill();
+    if (cached) {
+        val = conf_cache_find(CONF_CACHE_STORE, name);
+        if (val != NULL) {
+            conf_get_value_cb(name, (char *)val, &cgva);
+        }
+    }
+#endif
+    if (!cached) {
+        /*
+         * for every config store
+         */
+        SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+            cs->cs_itf->csi_load(cs, conf_get_value_cb, &cgva);
+        }
     }
     conf_unlock();
 
@@ -217,6 +445,10 @@ conf_save_one(const char *name, char *value)
 {
     struct conf_store *cs;
     struct conf_dup_check_arg cdca;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    const char *stored;
+#endif
+    bool cached;
     int rc;
 
     conf_lock();
@@ -231,8 +463,22 @@ conf_save_one(const char *name, char *value)
     cdca.name = name;
     cdca.val = value;
     cdca.is_dup = 0;
-    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
-        cs->cs_itf->csi_load(cs, conf_dup_check_cb, &cdca);
+    cached = false;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    cached = conf_cache_fill();
+    if (cached) {
+        /* An empty value is read back from storage as NULL. */
+        stored = conf_cache_find(CONF_CACHE_STORE, name);
+        if (stored != NULL) {
+            conf_dup_check_cb((char *)name, stored[0] ? (char *)stored : NULL,
+                              &cdca);
+        }
+    }
+#endif
+    if (!cached) {
+        SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+            cs->cs_itf->csi_load(cs, conf_dup_check_cb, &cdca);
+        }
     }
     if (cdca.is_dup == 1) {
         rc = 0;
@@ -240,6 +486,13 @@ conf_save_one(const char *name, char *value)
     }
     cs = conf_save_dst;
     rc = cs->cs_itf->csi_save(cs, name, value);
+#if MYNEWT_VAL(CONFIG_CACHE)
+    if (rc == 0) {
+        conf_cache_saved(name, value);
+    } else {
+        conf_cache_drop(CONF_CACHE_STORE);
+    }
+#endif
 out:
     conf_unlock();
     return rc;
@@ -312,9 +565,79 @@ out:
     return rc;
 }
 
+#if MYNEWT_VAL(CONFIG_SAVE_BATCH)
+int
+conf_save_batch_begin(void)
+{
+    struct conf_store *cs;
+    int rc;
+
+    conf_lock();
+    cs = conf_save_dst;
+    if (conf_batch_dst) {
+        rc = OS_EBUSY;
+    } else if (!cs) {
+        rc = OS_ENOENT;
+    } else if (!cs->cs_itf->csi_batch_start) {
+        rc = OS_EINVAL;
+    } else {
+        rc = cs->cs_itf->csi_batch_start(cs);
+    }
+    if (rc) {
+        conf_unlock();
+        return rc;
+    }
+
+    /* The lock is released when the batch ends. */
+    conf_batch_dst = cs;
+    return 0;
+}
+
+static int
+conf_save_batch_end(int commit)
+{
+    struct conf_store *cs;
+    int rc;
+
+    conf_lock();
+    cs = conf_batch_dst;
+    if (!cs) {
+        conf_unlock();
+        return OS_EINVAL;
+    }
+    rc = cs->cs_itf->csi_batch_end(cs, commit);
+    conf_batch_dst = NULL;
+#if MYNEWT_VAL(CONFIG_CACHE)
+    if (!commit || rc) {
+        conf_cache_drop(CONF_CACHE_STORE);
+    }
+#endif
+
+    /* Once for this call, once for conf_save_batch_begin(). */
+    conf_unlock();
+    conf_unlock();
+    return rc;
+}
+
+int
+conf_save_batch_commit(void)
+{
+    return conf_save_batch_end(1);
+}
+
+int
+conf_save_batch_abort(void)
+{
+    return conf_save_batch_end(0);
+}
+#endif
+
 void
 conf_store_init(void)
 {
     conf_loaded = false;
     SLIST_INIT(&conf_load_srcs);
+#if MYNEWT_VAL(CONFIG_CACHE)
+    conf_cache_init();
+#endif
 }
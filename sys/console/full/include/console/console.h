@@ -68,7 +68,27 @@ int console_vprintf(const char *fmt, va_list ap);
 int console_printf(const char *fmt, ...)
     __attribute__ ((format (printf, 1, 2)));;
 
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+struct console_async_info {
+    /* Size of the output ring, in bytes */
+    uint32_t cai_size;
+    /* Bytes currently queued */
+    uint32_t cai_used;
+    /* Highest number of bytes queued at once */
+    uint32_t cai_max_used;
+    /* Writes dropped because the ring was full */
+    uint32_t cai_drops;
+    /* Bytes lost with those writes */
+    uint32_t cai_dropped_bytes;
+};
+
+/* Reads output ring usage and drop counters (CONSOLE_ASYNC). */
+void console_async_info_get(struct console_async_info *info);
+#endif
+
 void console_set_completion_cb(completion_cb cb);
+/* Called from the console input context whenever CTRL-C is received */
+void console_set_interrupt_cb(console_rx_cb cb);
 int console_handle_char(uint8_t byte);
 
 /* Set queue to send console line events to */
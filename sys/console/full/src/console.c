@@ -99,6 +99,7 @@ static struct os_eventq avail_queue;
 static struct os_eventq *lines_queue;
 static struct os_event *current_line_ev;
 static completion_cb completion;
+static console_rx_cb interrupt_cb;
 bool g_console_silence;
 bool g_console_silence_non_nlip;
 bool g_console_ignore_non_nlip;
@@ -176,6 +177,15 @@ end:
     return rc;
 }
 
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+int
+console_lock_is_mine(void)
+{
+    return os_mutex_get_level(&console_write_lock) != 0 &&
+           console_write_lock.mu_owner == os_sched_get_current_task();
+}
+#endif
+
 int
 console_unlock(void)
 {
@@ -511,7 +521,7 @@ console_prompt_set(const char *prompt, const char *line)
 }
 
 int
-console_out(int c)
+console_out_sync(int c)
 {
     int rc;
     const os_time_t timeout =
@@ -531,7 +541,7 @@ console_out(int c)
 }
 
 void
-console_write(const char *str, int cnt)
+console_write_sync(const char *str, int cnt)
 {
     const os_time_t timeout =
             os_time_ms_to_ticks32(MYNEWT_VAL(CONSOLE_DEFAULT_LOCK_TIMEOUT));
@@ -570,6 +580,28 @@ done:
     (void)console_unlock();
 }
 
+int
+console_out(int c)
+{
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+    if (console_async_out(c) == 0) {
+        return c;
+    }
+#endif
+    return console_out_sync(c);
+}
+
+void
+console_write(const char *str, int cnt)
+{
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+    if (console_async_write(str, cnt) == 0) {
+        return;
+    }
+#endif
+    console_write_sync(str, cnt);
+}
+
 #if MYNEWT_VAL(CONSOLE_COMPAT)
 int
 console_read(char *str, int cnt, int *newline)
@@ -610,11 +642,17 @@ console_blocking_mode(void)
 #if MYNEWT_VAL(CONSOLE_UART)
     uart_console_blocking_mode();
 #endif
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+    console_async_set_bypass(true);
+#endif
 }
 
 void
 console_non_blocking_mode(void)
 {
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+    console_async_set_bypass(false);
+#endif
 #if MYNEWT_VAL(CONSOLE_UART)
     uart_console_non_blocking_mode();
 #endif
@@ -1216,6 +1254,9 @@ console_handle_char(uint8_t byte)
         /* CTRL-C */
         case ETX:
             console_clear_line();
+            if (interrupt_cb) {
+                interrupt_cb();
+            }
             break;
         /* CTRL-L */
         case VT:
@@ -1282,6 +1323,12 @@ console_set_completion_cb(completion_cb cb)
     completion = cb;
 }
 
+void
+console_set_interrupt_cb(console_rx_cb cb)
+{
+    interrupt_cb = cb;
+}
+
 void
 console_deinit(void)
 {
@@ -1335,4 +1382,8 @@ console_pkg_init(void)
     rc = rtt_console_init();
 #endif
     SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+    console_async_init();
+#endif
 }
@@ -0,0 +1,337 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+
+#include <string.h>
+
+#include "console/console.h"
+#include "console_priv.h"
+
+/*
+ * Output ring for the asynchronous console.
+ *
+ * Every console_write() or console_out() call becomes one record: a
+ * console_async_rec followed by the bytes, padded to pointer alignment.
+ * Space is reserved inside a short critical section and the bytes are then
+ * copied without holding any lock.  The console task replays ready records
+ * in order through the regular (synchronous) console path, so the backend
+ * (UART, RTT, USB CDC, ...) only ever blocks that task.  A record never
+ * wraps: if it does not fit in the space left at the end of the buffer,
+ * that space is skipped.
+ */
+
+#define CONSOLE_ASYNC_BUF_SIZE      MYNEWT_VAL(CONSOLE_ASYNC_BUF_SIZE)
+
+/* Longest single record; longer writes are split. */
+#define CONSOLE_ASYNC_MAX_REC       (CONSOLE_ASYNC_BUF_SIZE / 4)
+
+#define CONSOLE_ASYNC_F_READY       0x01
+#define CONSOLE_ASYNC_F_SKIP        0x02
+#define CONSOLE_ASYNC_F_CHAR        0x04
+
+struct console_async_rec {
+    uint16_t car_len;
+    volatile uint8_t car_flags;
+};
+
+#define CONSOLE_ASYNC_REC_SIZE(len) \
+    OS_ALIGN(sizeof(struct console_async_rec) + (len), sizeof(void *))
+
+static uint8_t console_async_buf[CONSOLE_ASYNC_BUF_SIZE]
+    __attribute__((aligned(sizeof(void *))));
+static uint32_t console_async_head;
+static uint32_t console_async_tail;
+static volatile uint32_t console_async_used;
+static uint32_t console_async_max_used;
+static uint32_t console_async_drops;
+static uint32_t console_async_dropped_bytes;
+
+/* Set while output must go out synchronously (console blocking mode). */
+static volatile uint8_t console_async_bypass;
+static uint8_t console_async_started;
+
+static struct os_mutex console_async_mtx;
+static struct os_eventq console_async_evq;
+static struct os_task console_async_task;
+OS_TASK_STACK_DEFINE(console_async_stack, MYNEWT_VAL(CONSOLE_ASYNC_STACK_SIZE));
+
+static void console_async_event_cb(struct os_event *ev);
+
+static struct os_event console_async_ev = {
+    .ev_cb = console_async_event_cb,
+};
+
+static struct console_async_rec *
+console_async_reserve(uint16_t len)
+{
+    struct console_async_rec *rec;
+    struct console_async_rec *skip;
+    uint32_t contig;
+    uint32_t pad;
+    uint32_t size;
+    os_sr_t sr;
+
+    size = CONSOLE_ASYNC_REC_SIZE(len);
+
+    OS_ENTER_CRITICAL(sr);
+
+    contig = CONSOLE_ASYNC_BUF_SIZE - console_async_head;
+    pad = contig < size ? contig : 0;
+    if (console_async_used + pad + size > CONSOLE_ASYNC_BUF_SIZE) {
+        OS_EXIT_CRITICAL(sr);
+        return NULL;
+    }
+
+    if (pad != 0) {
+        if (pad >= sizeof(*skip)) {
+            skip = (struct console_async_rec *)
+                &console_async_buf[console_async_head];
+            skip->car_flags = CONSOLE_ASYNC_F_SKIP;
+        }
+        console_async_head = 0;
+    }
+
+    rec = (struct console_async_rec *)&console_async_buf[console_async_head];
+    rec->car_len = len;
+    rec->car_flags = 0;
+
+    console_async_head += size;
+    if (console_async_head == CONSOLE_ASYNC_BUF_SIZE) {
+        console_async_head = 0;
+    }
+    console_async_used += pad + size;
+    if (console_async_used > console_async_max_used) {
+        console_async_max_used = console_async_used;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rec;
+}
+
+static void
+console_async_drop(int cnt)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    console_async_drops++;
+    console_async_dropped_bytes += cnt;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+console_async_release(uint32_t size)
+{
+    os_sr_t sr;
+
+    console_async_tail += size;
+    if (console_async_tail == CONSOLE_ASYNC_BUF_SIZE) {
+        console_async_tail = 0;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    console_async_used -= size;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+console_async_drain(void)
+{
+    struct console_async_rec *rec;
+    uint32_t contig;
+
+    while (console_async_used != 0) {
+        contig = CONSOLE_ASYNC_BUF_SIZE - console_async_tail;
+        rec = (struct console_async_rec *)
+            &console_async_buf[console_async_tail];
+        if (contig < sizeof(*rec) || rec->car_flags & CONSOLE_ASYNC_F_SKIP) {
+            console_async_release(contig);
+            continue;
+        }
+
+        if (!(rec->car_flags & CONSOLE_ASYNC_F_READY)) {
+            /* Still being copied; its commit will wake the task again. */
+            break;
+        }
+
+        if (rec->car_flags & CONSOLE_ASYNC_F_CHAR) {
+            console_out_sync(*(uint8_t *)(rec + 1));
+        } else {
+            console_write_sync((const char *)(rec + 1), rec->car_len);
+        }
+        console_async_release(CONSOLE_ASYNC_REC_SIZE(rec->car_len));
+    }
+}
+
+void
+console_async_flush(void)
+{
+    /* From a fault handler there is no one to wait for. */
+    if (os_arch_in_isr() || !os_started()) {
+        console_async_drain();
+        return;
+    }
+
+    os_mutex_pend(&console_async_mtx, OS_TIMEOUT_NEVER);
+    console_async_drain();
+    os_mutex_release(&console_async_mtx);
+}
+
+static int
+console_async_queue(const char *str, int cnt, uint8_t flags)
+{
+    struct console_async_rec *rec;
+
+    rec = console_async_reserve(cnt);
+    if (rec == NULL) {
+        if (MYNEWT_VAL(CONSOLE_ASYNC_LOSSY) || os_arch_in_isr()) {
+            console_async_drop(cnt);
+            return 0;
+        }
+
+        /* The console task may be waiting for the console lock held by
+         * this task, so only flush without it.
+         */
+        if (console_lock_is_mine()) {
+            return SYS_EBUSY;
+        }
+
+        /* Make room by writing out what is queued ahead, then retry. */
+        console_async_flush();
+        rec = console_async_reserve(cnt);
+        if (rec == NULL) {
+            return SYS_ENOMEM;
+        }
+    }
+
+    memcpy(rec + 1, str, cnt);
+
+    /* Record contents must be visible before the ready flag. */
+    __asm__ volatile ("" ::: "memory");
+    rec->car_flags = CONSOLE_ASYNC_F_READY | flags;
+
+    os_eventq_put(&console_async_evq, &console_async_ev);
+
+    return 0;
+}
+
+int
+console_async_write(const char *str, int cnt)
+{
+    int chunk;
+    int rc;
+
+    if (!console_async_started || console_async_bypass ||
+        os_sched_get_current_task() == &console_async_task) {
+        return SYS_ENOTSUP;
+    }
+
+    while (cnt > 0) {
+        chunk = min(cnt, CONSOLE_ASYNC_MAX_REC);
+        rc = console_async_queue(str, chunk, 0);
+        if (rc != 0) {
+            /* No room to be made; write directly. */
+            console_write_sync(str, cnt);
+            break;
+        }
+        str += chunk;
+        cnt -= chunk;
+    }
+
+    return 0;
+}
+
+int
+console_async_out(int c)
+{
+    uint8_t ch;
+
+    if (!console_async_started || console_async_bypass ||
+        os_sched_get_current_task() == &console_async_task) {
+        return SYS_ENOTSUP;
+    }
+
+    ch = c;
+    if (console_async_queue((const char *)&ch, 1, CONSOLE_ASYNC_F_CHAR)) {
+        console_out_sync(c);
+    }
+
+    return 0;
+}
+
+void
+console_async_set_bypass(bool bypass)
+{
+    console_async_bypass = bypass;
+    if (bypass && console_async_started) {
+        console_async_flush();
+    }
+}
+
+void
+console_async_info_get(struct console_async_info *info)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    info->cai_size = CONSOLE_ASYNC_BUF_SIZE;
+    info->cai_used = console_async_used;
+    info->cai_max_used = console_async_max_used;
+    info->cai_drops = console_async_drops;
+    info->cai_dropped_bytes = console_async_dropped_bytes;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+console_async_event_cb(struct os_event *ev)
+{
+    console_async_flush();
+}
+
+static void
+console_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&console_async_evq);
+    }
+}
+
+void
+console_async_init(void)
+{
+    int rc;
+
+    os_mutex_init(&console_async_mtx);
+    os_eventq_init(&console_async_evq);
+
+    rc = os_task_init(&console_async_task, "console",
+                      console_async_task_handler, NULL,
+                      MYNEWT_VAL(CONSOLE_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      console_async_stack,
+                      MYNEWT_VAL(CONSOLE_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    console_async_started = 1;
+}
+
+#endif
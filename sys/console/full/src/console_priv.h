@@ -36,6 +36,20 @@ int ble_monitor_console_is_init(void);
 int usb_cdc_console_is_init(void);
 int tcp_console_is_init(void);
 
+/* Write directly to the backend, bypassing the asynchronous ring. */
+int console_out_sync(int c);
+void console_write_sync(const char *str, int cnt);
+
+#if MYNEWT_VAL(CONSOLE_ASYNC)
+void console_async_init(void);
+/* Return 0 when the output was queued (or dropped). */
+int console_async_write(const char *str, int cnt);
+int console_async_out(int c);
+void console_async_set_bypass(bool bypass);
+void console_async_flush(void);
+int console_lock_is_mine(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,13 @@ static volatile bool uart_console_rx_stalled;
 struct os_event rx_ev;
 #endif
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+static uint8_t uart_console_block_rx_buf[
+    MYNEWT_VAL(CONSOLE_UART_BLOCK_RX_BUF_SIZE)];
+/* Number of bytes handed to uart_tx_block(), 0 when TX is idle */
+static uint16_t cr_tx_inflight;
+#endif
+
 static inline int
 inc_and_wrap(int i, int max)
 {
@@ -85,6 +92,55 @@ uart_console_ring_is_empty(const struct console_ring *cr)
     return cr->head == cr->tail;
 }
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+/*
+ * Hand the contiguous part of TX ring to the driver. Data stays in the ring
+ * until transmission finishes, tail is advanced in the done callback.
+ * Must be called with interrupts disabled.
+ */
+static void
+uart_console_block_tx_start(void)
+{
+    uint16_t len;
+    int rc;
+
+    if (cr_tx_inflight || uart_console_ring_is_empty(&cr_tx)) {
+        return;
+    }
+    if (cr_tx.head > cr_tx.tail) {
+        len = cr_tx.head - cr_tx.tail;
+    } else {
+        len = cr_tx.size - cr_tx.tail;
+    }
+    rc = uart_tx_block(uart_dev, &cr_tx.buf[cr_tx.tail], len);
+    if (rc > 0) {
+        cr_tx_inflight = rc;
+    }
+}
+
+static void
+uart_console_block_tx_done(void *arg)
+{
+    cr_tx.tail = (cr_tx.tail + cr_tx_inflight) & (cr_tx.size - 1);
+    cr_tx_inflight = 0;
+    uart_console_block_tx_start();
+}
+#endif
+
+static void
+uart_console_start_tx(struct uart_dev *uart_dev)
+{
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    uart_console_block_tx_start();
+    OS_EXIT_CRITICAL(sr);
+#else
+    uart_start_tx(uart_dev);
+#endif
+}
+
 static void
 uart_console_queue_char(struct uart_dev *uart_dev, uint8_t ch)
 {
@@ -98,7 +154,7 @@ uart_console_queue_char(struct uart_dev *uart_dev, uint8_t ch)
     OS_ENTER_CRITICAL(sr);
     while (uart_console_ring_is_full(&cr_tx)) {
         /* TX needs to drain */
-        uart_start_tx(uart_dev);
+        uart_console_start_tx(uart_dev);
         OS_EXIT_CRITICAL(sr);
         if (os_started()) {
             os_time_delay(1);
@@ -167,7 +223,7 @@ console_out_nolock(int c)
         write_char_cb(uart_dev, '\r');
     }
     write_char_cb(uart_dev, c);
-    uart_start_tx(uart_dev);
+    uart_console_start_tx(uart_dev);
 
     return c;
 }
@@ -177,7 +233,7 @@ console_rx_restart(void)
 {
 #if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
     os_eventq_put(os_eventq_dflt_get(), &rx_ev);
-#else
+#elif !MYNEWT_VAL(CONSOLE_UART_BLOCK)
     uart_start_rx(uart_dev);
 #endif
 }
@@ -219,6 +275,34 @@ uart_console_rx_char(void *arg, uint8_t byte)
 #endif
 }
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+/*
+ * Called from interrupt context with a chunk of received data. Receiver
+ * cannot be stalled in block mode; data that does not fit is dropped.
+ */
+static void
+uart_console_rx_block(void *arg, const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+#if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
+        if (uart_console_ring_is_full(&cr_rx)) {
+            break;
+        }
+        uart_console_ring_add_char(&cr_rx, data[i]);
+#else
+        console_handle_char(data[i]);
+#endif
+    }
+#if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
+    if (!rx_ev.ev_queued) {
+        os_eventq_put(os_eventq_dflt_get(), &rx_ev);
+    }
+#endif
+}
+#endif
+
 #if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
 static void
 uart_console_rx_char_event(struct os_event *ev)
@@ -290,6 +374,13 @@ uart_console_init(void)
         .uc_flow_ctl = MYNEWT_VAL(CONSOLE_UART_FLOW_CONTROL),
         .uc_tx_char = uart_console_tx_char,
         .uc_rx_char = uart_console_rx_char,
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+        .uc_rx_block = uart_console_rx_block,
+        .uc_tx_block_done = uart_console_block_tx_done,
+        .uc_rx_buf = uart_console_block_rx_buf,
+        .uc_rx_buf_size = sizeof(uart_console_block_rx_buf),
+        .uc_idle_us = MYNEWT_VAL(CONSOLE_UART_BLOCK_IDLE_US),
+#endif
     };
 
     cr_tx.size = MYNEWT_VAL(CONSOLE_UART_TX_BUF_SIZE);
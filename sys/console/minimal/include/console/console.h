@@ -69,6 +69,11 @@ console_set_completion_cb(uint8_t (*completion)(char *str, uint8_t len))
 {
 }
 
+static void inline
+console_set_interrupt_cb(void (*cb)(void))
+{
+}
+
 /**
  * Global indicating whether console is silent or not
  */
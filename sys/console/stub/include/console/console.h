@@ -117,6 +117,11 @@ console_set_completion_cb(void (*completion)(char *str, console_append_char_cb c
 {
 }
 
+static void inline
+console_set_interrupt_cb(void (*cb)(void))
+{
+}
+
 static int inline
 console_handle_char(uint8_t byte)
 {
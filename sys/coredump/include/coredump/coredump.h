@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include "os/mynewt.h"
 
 #define COREDUMP_MAGIC              0x690c47c3
 
@@ -34,6 +35,7 @@ extern "C" {
 #define COREDUMP_TLV_IMAGE          1   /* SHA256 of image creating this */
 #define COREDUMP_TLV_MEM            2   /* Memory dump */
 #define COREDUMP_TLV_REGS           3   /* CPU registers */
+#define COREDUMP_TLV_MEM_RLE        4   /* Memory dump, RLE compressed */
 
 struct coredump_tlv {
     uint8_t ct_type;
@@ -52,6 +54,21 @@ struct coredump_header {
 
 void coredump_dump(void *regs, int regs_sz);
 
+/*
+ * Memory region included in a minidump (COREDUMP_MINI), in addition to the
+ * task control blocks and stacks.
+ */
+struct coredump_region {
+    const void *cr_start;
+    uint32_t cr_size;
+    SLIST_ENTRY(coredump_region) cr_next;
+};
+
+/*
+ * Adds a region to minidumps.  The structure must stay valid for good.
+ */
+void coredump_region_add(struct coredump_region *cr);
+
 /*
  * Set this to non-zero to prevent coredump from taking place.
  */
@@ -29,6 +29,11 @@
 
 uint8_t coredump_disabled;
 
+#if MYNEWT_VAL(COREDUMP_MINI)
+static SLIST_HEAD(, coredump_region) coredump_regions =
+    SLIST_HEAD_INITIALIZER(coredump_regions);
+#endif
+
 static void
 dump_core_tlv(const struct flash_area *fa, uint32_t *off,
   struct coredump_tlv *tlv, void *data)
@@ -40,6 +45,217 @@ dump_core_tlv(const struct flash_area *fa, uint32_t *off,
     *off += tlv->ct_len;
 }
 
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+/*
+ * Largest chunk of memory compressed into one TLV; RLE grows incompressible
+ * data by 1/128 at most, so the result still fits in ct_len.
+ */
+#define COREDUMP_RLE_CHUNK      0xfc00
+#define COREDUMP_RLE_RUN_MIN    3
+#define COREDUMP_RLE_RUN_MAX    (0x7f + COREDUMP_RLE_RUN_MIN)
+#define COREDUMP_RLE_LIT_MAX    0x80
+
+/* Write staging; static, as this runs on whatever stack faulted. */
+static struct {
+    uint32_t off;
+    uint32_t end;
+    uint16_t len;
+    uint8_t buf[64];
+} dump_wbuf;
+
+static void
+dump_flush(const struct flash_area *fa)
+{
+    if (dump_wbuf.len) {
+        flash_area_write(fa, dump_wbuf.off, dump_wbuf.buf, dump_wbuf.len);
+        dump_wbuf.off += dump_wbuf.len;
+        dump_wbuf.len = 0;
+    }
+}
+
+/*
+ * Appends one RLE token.  Tokens are never split, so a dump cut short by
+ * the end of the flash area still decodes.
+ */
+static int
+dump_put(const struct flash_area *fa, uint8_t ctl, const uint8_t *data,
+         int len)
+{
+    if (dump_wbuf.off + dump_wbuf.len + 1 + len > dump_wbuf.end) {
+        return -1;
+    }
+    if (dump_wbuf.len + 1 + len > sizeof(dump_wbuf.buf)) {
+        dump_flush(fa);
+    }
+    dump_wbuf.buf[dump_wbuf.len++] = ctl;
+    while (len > 0) {
+        if (dump_wbuf.len == sizeof(dump_wbuf.buf)) {
+            dump_flush(fa);
+        }
+        dump_wbuf.buf[dump_wbuf.len++] = *data++;
+        len--;
+    }
+    return 0;
+}
+
+static int
+dump_run_len(const uint8_t *p, const uint8_t *end)
+{
+    const uint8_t *q;
+
+    for (q = p + 1; q < end && *q == *p; q++) {
+        if (q - p == COREDUMP_RLE_RUN_MAX - 1) {
+            return COREDUMP_RLE_RUN_MAX;
+        }
+    }
+    return q - p;
+}
+
+/*
+ * Byte oriented RLE:
+ *     0x00-0x7f  (n - 1)        followed by n literal bytes
+ *     0x80-0xff  0x80 + (n - 3) followed by one byte repeated n times
+ * Good enough for RAM, which is mostly zeroes and fill patterns.
+ */
+static int
+dump_core_rle(const struct flash_area *fa, uint32_t *off, uint32_t addr,
+  uint32_t len)
+{
+    struct coredump_tlv tlv;
+    const uint8_t *p = (const uint8_t *)addr;
+    const uint8_t *end = p + len;
+    const uint8_t *lit;
+    uint32_t start;
+    int rc = 0;
+    int n;
+
+    if (*off + sizeof(tlv) >= fa->fa_size) {
+        return -1;
+    }
+    start = *off;
+    dump_wbuf.off = start + sizeof(tlv);
+    dump_wbuf.end = fa->fa_size;
+    dump_wbuf.len = 0;
+
+    while (p < end) {
+        n = dump_run_len(p, end);
+        if (n >= COREDUMP_RLE_RUN_MIN) {
+            rc = dump_put(fa, 0x80 + n - COREDUMP_RLE_RUN_MIN, p, 1);
+            if (rc) {
+                break;
+            }
+            p += n;
+            continue;
+        }
+        lit = p;
+        while (p < end && p - lit < COREDUMP_RLE_LIT_MAX &&
+               dump_run_len(p, end) < COREDUMP_RLE_RUN_MIN) {
+            p++;
+        }
+        rc = dump_put(fa, p - lit - 1, lit, p - lit);
+        if (rc) {
+            break;
+        }
+    }
+    dump_flush(fa);
+
+    tlv.ct_type = COREDUMP_TLV_MEM_RLE;
+    tlv._pad = 0;
+    tlv.ct_len = dump_wbuf.off - (start + sizeof(tlv));
+    tlv.ct_off = addr;
+    flash_area_write(fa, start, &tlv, sizeof(tlv));
+    *off = dump_wbuf.off;
+
+    return rc;
+}
+#endif
+
+/*
+ * Dumps a memory region, split into as many TLVs as needed, and cut short
+ * if the flash area fills up.
+ */
+static void
+dump_core_mem(const struct flash_area *fa, uint32_t *off, uint32_t area_off,
+  uint32_t area_end)
+{
+    struct coredump_tlv tlv;
+
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+    uint32_t len;
+
+    while (area_off < area_end) {
+        len = area_end - area_off;
+        if (len > COREDUMP_RLE_CHUNK) {
+            len = COREDUMP_RLE_CHUNK;
+        }
+        if (dump_core_rle(fa, off, area_off, len)) {
+            break; /* out of space */
+        }
+        area_off += len;
+    }
+    (void)tlv;
+#else
+    tlv._pad = 0;
+    while (area_off < area_end) {
+        tlv.ct_type = COREDUMP_TLV_MEM;
+        if (area_end - area_off > USHRT_MAX) {
+            tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
+        } else {
+            tlv.ct_len = area_end - area_off;
+        }
+        if (*off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
+            if (*off + sizeof(tlv) >= fa->fa_size) {
+                break;
+            }
+            tlv.ct_len = fa->fa_size - (*off + sizeof(tlv));
+        }
+        tlv.ct_off = area_off;
+        dump_core_tlv(fa, off, &tlv, (void *)area_off);
+        area_off += tlv.ct_len;
+    }
+#endif
+}
+
+#if MYNEWT_VAL(COREDUMP_MINI)
+void
+coredump_region_add(struct coredump_region *cr)
+{
+    SLIST_INSERT_HEAD(&coredump_regions, cr, cr_next);
+}
+
+/*
+ * Task control blocks, the live part of each task's stack (all of it for
+ * the task that faulted, whose saved stack pointer is stale), and the
+ * registered regions.
+ */
+static void
+dump_core_mini(const struct flash_area *fa, uint32_t *off)
+{
+    struct coredump_region *cr;
+    struct os_task *cur;
+    struct os_task *t;
+    os_stack_t *top;
+    os_stack_t *sp;
+
+    cur = os_sched_get_current_task();
+    STAILQ_FOREACH(t, &g_os_task_list, t_os_task_list) {
+        dump_core_mem(fa, off, (uint32_t)t, (uint32_t)(t + 1));
+
+        top = t->t_stackbottom + t->t_stacksize;
+        sp = t->t_stackptr;
+        if (t == cur || sp < t->t_stackbottom || sp > top) {
+            sp = t->t_stackbottom;
+        }
+        dump_core_mem(fa, off, (uint32_t)sp, (uint32_t)top);
+    }
+
+    SLIST_FOREACH(cr, &coredump_regions, cr_next) {
+        dump_core_mem(fa, off, (uint32_t)cr->cr_start,
+                      (uint32_t)cr->cr_start + cr->cr_size);
+    }
+}
+#endif
+
 void
 coredump_dump(void *regs, int regs_sz)
 {
@@ -47,11 +263,12 @@ coredump_dump(void *regs, int regs_sz)
     struct coredump_tlv tlv;
     const struct flash_area *fa;
     struct image_version ver;
+#if !MYNEWT_VAL(COREDUMP_MINI)
     const struct hal_bsp_mem_dump *mem, *cur;
     int area_cnt, i;
+#endif
     uint8_t hash[IMGMGR_HASH_LEN];
     uint32_t off;
-    uint32_t area_off, area_end;
     int slot;
 
     if (coredump_disabled) {
@@ -103,29 +320,16 @@ coredump_dump(void *regs, int regs_sz)
         dump_core_tlv(fa, &off, &tlv, hash);
     }
 
+#if MYNEWT_VAL(COREDUMP_MINI)
+    dump_core_mini(fa, &off);
+#else
     mem = hal_bsp_core_dump(&area_cnt);
     for (i = 0; i < area_cnt; i++) {
         cur = &mem[i];
-        area_off = (uint32_t)cur->hbmd_start;
-        area_end = area_off + cur->hbmd_size;
-        while (area_off < area_end) {
-            tlv.ct_type = COREDUMP_TLV_MEM;
-            if (area_end - area_off > USHRT_MAX) {
-                tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
-            } else {
-                tlv.ct_len = area_end - area_off;
-            }
-            if (off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
-                if (off + sizeof(tlv) >= fa->fa_size) {
-                    break;
-                }
-                tlv.ct_len = fa->fa_size - (off + sizeof(tlv));
-            }
-            tlv.ct_off = area_off;
-            dump_core_tlv(fa, &off, &tlv, (void *)area_off);
-            area_off += tlv.ct_len;
-        }
+        dump_core_mem(fa, &off, (uint32_t)cur->hbmd_start,
+                      (uint32_t)cur->hbmd_start + cur->hbmd_size);
     }
+#endif
     hdr.ch_magic = COREDUMP_MAGIC;
     hdr.ch_size = off;
 
@@ -89,6 +89,35 @@ int flash_area_write(const struct flash_area *, uint32_t off, const void *src,
   uint32_t len);
 int flash_area_erase(const struct flash_area *, uint32_t off, uint32_t len);
 
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+/*
+ * Queue range of flash area to be erased in the background by the pre-erase
+ * task. A later flash_area_erase() of a range which has been pre-erased
+ * returns without touching the flash. Writing into the range through
+ * flash_area_write() cancels a queued pre-erase.
+ */
+int flash_area_preerase(const struct flash_area *, uint32_t off,
+  uint32_t len);
+
+/*
+ * Make sure that any pre-erase queued or in progress for the range has
+ * completed. Erases inline if the pre-erase task has not got to it yet.
+ * Ranges with no pre-erase queued are left as they are.
+ */
+int flash_area_preerase_wait(const struct flash_area *, uint32_t off,
+  uint32_t len);
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+/*
+ * Returns pointer for direct read-only access to flash area contents, or
+ * NULL if underlying flash is not memory mapped; use flash_area_read() then.
+ * Pointer is valid until area is written or erased.
+ */
+const void *flash_area_mmap(const struct flash_area *, uint32_t off,
+  uint32_t len);
+#endif
+
 /*
  * Whether the whole area is empty.
  */
@@ -103,6 +132,28 @@ int flash_area_is_empty(const struct flash_area *, bool *);
 int flash_area_read_is_empty(const struct flash_area *, uint32_t off, void *dst,
   uint32_t len);
 
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+/*
+ * Number of times the sector containing offset off within flash area
+ * has been erased.
+ */
+int flash_area_erase_count(const struct flash_area *, uint32_t off,
+  uint32_t *count);
+
+/*
+ * Erase counts of sectors within flash area, in the same order as
+ * flash_area_to_sectors() returns them. If counts is NULL, only number of
+ * sectors is returned in cnt.
+ */
+int flash_area_to_erase_counts(int id, int *cnt, uint32_t *counts);
+
+/*
+ * Store erase counters to FLASH_MAP_ERASE_STATS_AREA. This happens
+ * automatically every FLASH_MAP_ERASE_STATS_SAVE_INTERVAL erases.
+ */
+int flash_map_erase_stats_save(void);
+#endif
+
 /*
  * Alignment restriction for flash writes.
  */
@@ -139,6 +190,14 @@ int flash_area_id_to_image_slot(int area_id);
  * overlap with, the manufacturing flash map.  Only exposed to unit tests.
  */
 void flash_map_add_new_dflt_areas_extern(void);
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+/**
+ * Sets function called right before a pre-erase starts erasing flash, while
+ * its range is marked as being erased.  Only exposed to unit tests.
+ */
+void flash_map_preerase_set_erase_hook(void (*hook)(void));
+#endif
 #endif
 
 #ifdef __cplusplus
@@ -26,18 +26,44 @@
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
 #include "hal/hal_flash_int.h"
+#include "flash_map_test.h"
 
 struct flash_area *fa_sectors;
 
-/*
- * Max number sectors per area (for native BSP)
- */
-#define SELFTEST_FA_SECTOR_COUNT    64
-
 TEST_CASE_DECL(flash_map_test_case_1)
 TEST_CASE_DECL(flash_map_test_case_2)
 TEST_CASE_DECL(flash_map_test_case_3)
 TEST_CASE_DECL(flash_map_test_case_new_areas)
+TEST_CASE_DECL(flash_map_test_case_preerase_skip)
+TEST_CASE_DECL(flash_map_test_case_preerase_cancel)
+TEST_CASE_DECL(flash_map_test_case_preerase_wait)
+TEST_CASE_DECL(flash_map_test_case_preerase_fcb)
+TEST_CASE_DECL(flash_map_test_case_erase_stats)
+
+int
+flash_map_test_cmp(const struct flash_area *fa, uint32_t off, uint8_t val,
+                   uint32_t len)
+{
+    uint8_t rd[64];
+    uint32_t chunk;
+    int i;
+
+    while (len > 0) {
+        chunk = min(len, sizeof(rd));
+        if (flash_area_read(fa, off, rd, chunk)) {
+            return -1;
+        }
+        for (i = 0; i < chunk; i++) {
+            if (rd[i] != val) {
+                return -1;
+            }
+        }
+        off += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
 
 TEST_SUITE(flash_map_test_suite)
 {
@@ -45,6 +71,11 @@ TEST_SUITE(flash_map_test_suite)
     flash_map_test_case_2();
     flash_map_test_case_3();
     flash_map_test_case_new_areas();
+    flash_map_test_case_preerase_skip();
+    flash_map_test_case_preerase_cancel();
+    flash_map_test_case_preerase_wait();
+    flash_map_test_case_preerase_fcb();
+    flash_map_test_case_erase_stats();
 }
 
 int
@@ -32,7 +32,16 @@
 extern "C" {
 #endif
 
-/* This space intentionally left blank */
+/*
+ * Max number sectors per area (for native BSP)
+ */
+#define SELFTEST_FA_SECTOR_COUNT    64
+
+extern struct flash_area *fa_sectors;
+
+/* Returns 0 if len bytes of the area starting at off all read as val. */
+int flash_map_test_cmp(const struct flash_area *fa, uint32_t off,
+                       uint8_t val, uint32_t len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "flash_map_test.h"
+
+/*
+ * Erase counters follow erases of each sector; writes leave them alone.
+ */
+TEST_CASE_TASK(flash_map_test_case_erase_stats)
+{
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+    const struct flash_area *fa;
+    uint32_t before[SELFTEST_FA_SECTOR_COUNT];
+    uint32_t after[SELFTEST_FA_SECTOR_COUNT];
+    uint32_t count;
+    uint32_t off;
+    uint8_t wd[256];
+    int sec_cnt;
+    int cnt;
+    int rc;
+    int i;
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_1, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(sec_cnt > 1);
+    rc = flash_area_open(FLASH_AREA_IMAGE_1, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = flash_area_to_erase_counts(FLASH_AREA_IMAGE_1, &cnt, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(cnt == sec_cnt);
+    rc = flash_area_to_erase_counts(FLASH_AREA_IMAGE_1, &cnt, before);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Erasing one sector bumps only its counter. */
+    off = fa_sectors[1].fa_off - fa->fa_off;
+    rc = flash_area_erase(fa, off, fa_sectors[1].fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_to_erase_counts(FLASH_AREA_IMAGE_1, &cnt, after);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < sec_cnt; i++) {
+        TEST_ASSERT(after[i] == before[i] + (i == 1));
+    }
+    rc = flash_area_erase_count(fa, off + fa_sectors[1].fa_size - 1, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == before[1] + 1);
+
+    /* Writes are not erases. */
+    memset(wd, 0xa5, sizeof(wd));
+    rc = flash_area_write(fa, off, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_to_erase_counts(FLASH_AREA_IMAGE_1, &cnt, before);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(before, after, sec_cnt * sizeof(before[0])) == 0);
+
+    /* Erasing the whole area bumps every counter once. */
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_to_erase_counts(FLASH_AREA_IMAGE_1, &cnt, after);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < sec_cnt; i++) {
+        TEST_ASSERT(after[i] == before[i] + 1);
+    }
+
+    /* Erases behind flash map's back are not counted. */
+    rc = hal_flash_erase(fa->fa_device_id, fa_sectors[0].fa_off,
+                         fa_sectors[0].fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase_count(fa, 0, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == after[0]);
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    /* Background erase counts; the skipped erase which follows doesn't. */
+    rc = flash_area_write(fa, 0, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_preerase(fa, 0, fa_sectors[0].fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    rc = flash_area_erase(fa, 0, fa_sectors[0].fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase_count(fa, 0, &count);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(count == after[0] + 1);
+#endif
+
+    rc = flash_area_erase_count(fa, fa->fa_size, &count);
+    TEST_ASSERT(rc == SYS_EINVAL);
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA) < 0
+    TEST_ASSERT(flash_map_erase_stats_save() == SYS_ENOTSUP);
+#endif
+
+    flash_area_close(fa);
+#endif
+}
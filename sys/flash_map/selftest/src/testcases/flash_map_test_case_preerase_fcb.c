@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "flash_map_test.h"
+#include "fcb/fcb.h"
+#include "mcu/mcu_sim.h"
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+#define FMT_PREERASE_FCB_MAGIC  0x12345678
+
+static struct flash_area fmt_preerase_fcb_area[] = {
+    [0] = {
+        .fa_device_id = 0,
+        .fa_off = 0x8000,
+        .fa_size = 0x4000,
+    },
+    [1] = {
+        .fa_device_id = 0,
+        .fa_off = 0xc000,
+        .fa_size = 0x4000,
+    },
+};
+
+static int
+fmt_preerase_fcb_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    uint8_t data;
+    int *cnt = arg;
+    int rc;
+
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, &data, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(loc->fe_data_len == 1 && data == 0xb);
+    (*cnt)++;
+
+    return 0;
+}
+
+static void
+fmt_preerase_fcb_append(struct fcb *fcb, uint8_t data)
+{
+    struct fcb_entry loc;
+    int rc;
+
+    rc = fcb_append(fcb, 1, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, &data, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb_append_finish(fcb, &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+#endif
+
+/*
+ * FCB rotate leaves the erase of the oldest sector to the background task;
+ * taking the sector into use again completes the erase first.
+ */
+TEST_CASE_TASK(flash_map_test_case_preerase_fcb)
+{
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    struct fcb fcb;
+    uint32_t erases;
+    int cnt;
+    int rc;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        rc = flash_area_erase(&fmt_preerase_fcb_area[i], 0,
+                              fmt_preerase_fcb_area[i].fa_size);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    memset(&fcb, 0, sizeof(fcb));
+    fcb.f_magic = FMT_PREERASE_FCB_MAGIC;
+    fcb.f_sector_cnt = 2;
+    fcb.f_sectors = fmt_preerase_fcb_area;
+    rc = fcb_init(&fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    fmt_preerase_fcb_append(&fcb, 0xa);
+
+    /* Sector 0 is queued for erase, not erased inline. */
+    erases = native_flash_stats.nfs_erases;
+    rc = fcb_rotate(&fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases);
+    TEST_ASSERT(fcb.f_active.fe_area == &fmt_preerase_fcb_area[1]);
+
+    /* Reusing sector 0 completes its erase before writing the header. */
+    rc = fcb_rotate(&fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases + 1);
+    TEST_ASSERT(fcb.f_active.fe_area == &fmt_preerase_fcb_area[0]);
+
+    fmt_preerase_fcb_append(&fcb, 0xb);
+
+    cnt = 0;
+    rc = fcb_walk(&fcb, NULL, fmt_preerase_fcb_walk_cb, &cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnt == 1);
+
+    /* Sector 1 is erased in the background. */
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases + 2);
+    TEST_ASSERT(flash_map_test_cmp(&fmt_preerase_fcb_area[1], 0, 0xff,
+                                   fmt_preerase_fcb_area[1].fa_size) == 0);
+#endif
+}
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "flash_map_test.h"
+#include "mcu/mcu_sim.h"
+
+/*
+ * Erase of a range pre-erased in the background, and not written since, is
+ * skipped.
+ */
+TEST_CASE_TASK(flash_map_test_case_preerase_skip)
+{
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    const struct flash_area *sec;
+    uint32_t erases;
+    uint8_t wd[256];
+    int sec_cnt;
+    int rc;
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_1, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0);
+    sec = &fa_sectors[0];
+
+    memset(wd, 0xa5, sizeof(wd));
+    rc = flash_area_erase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(sec, 0, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Queued; background task runs once this task sleeps. */
+    erases = native_flash_stats.nfs_erases;
+    rc = flash_area_preerase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases);
+
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases + 1);
+    TEST_ASSERT(flash_map_test_cmp(sec, 0, 0xff, sizeof(wd)) == 0);
+
+    /* Erase is skipped; data written behind flash map's back survives. */
+    rc = hal_flash_write(sec->fa_device_id, sec->fa_off, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+    erases = native_flash_stats.nfs_erases;
+    rc = flash_area_erase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases);
+    TEST_ASSERT(flash_map_test_cmp(sec, 0, 0xa5, sizeof(wd)) == 0);
+
+    /* Writing through flash map makes the next erase real. */
+    rc = flash_area_write(sec, sizeof(wd), wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(native_flash_stats.nfs_erases == erases + 1);
+    TEST_ASSERT(flash_map_test_cmp(sec, 0, 0xff, 2 * sizeof(wd)) == 0);
+#endif
+}
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "flash_map_test.h"
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+#define FMT_PREERASE_WAIT_TICKS     5
+
+static int fmt_preerase_wait_entered;
+
+/* Keeps background erase in progress for a while. */
+static void
+fmt_preerase_wait_hook(void)
+{
+    fmt_preerase_wait_entered++;
+    os_time_delay(FMT_PREERASE_WAIT_TICKS);
+}
+#endif
+
+/*
+ * Write into a range which is being erased in the background waits for the
+ * erase to finish, so the erase does not wipe the data written.
+ */
+TEST_CASE_TASK(flash_map_test_case_preerase_wait)
+{
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    const struct flash_area *sec;
+    os_time_t start;
+    uint8_t wd[256];
+    int sec_cnt;
+    int rc;
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_1, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0);
+    sec = &fa_sectors[2];
+
+    memset(wd, 0x3c, sizeof(wd));
+    rc = flash_area_erase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_write(sec, 0, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    flash_map_preerase_set_erase_hook(fmt_preerase_wait_hook);
+
+    rc = flash_area_preerase(sec, 0, sec->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Let background task start the erase. */
+    os_time_delay(1);
+    TEST_ASSERT_FATAL(fmt_preerase_wait_entered == 1);
+
+    start = os_time_get();
+    rc = flash_area_write(sec, sizeof(wd), wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_time_get() - start > 0);
+
+    flash_map_preerase_set_erase_hook(NULL);
+
+    /* Erase happened before the write. */
+    TEST_ASSERT(flash_map_test_cmp(sec, 0, 0xff, sizeof(wd)) == 0);
+    TEST_ASSERT(flash_map_test_cmp(sec, sizeof(wd), 0x3c, sizeof(wd)) == 0);
+#endif
+}
@@ -29,6 +29,7 @@
 #include "mfg/mfg.h"
 #endif
 #include "flash_map/flash_map.h"
+#include "flash_map_priv.h"
 
 const struct flash_area *flash_map;
 int flash_map_entries;
@@ -255,6 +256,17 @@ flash_area_read(const struct flash_area *fa, uint32_t off, void *dst,
     return hal_flash_read(fa->fa_device_id, fa->fa_off + off, dst, len);
 }
 
+#if MYNEWT_VAL(HAL_FLASH_MMAP)
+const void *
+flash_area_mmap(const struct flash_area *fa, uint32_t off, uint32_t len)
+{
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return NULL;
+    }
+    return hal_flash_mmap(fa->fa_device_id, fa->fa_off + off, len);
+}
+#endif
+
 int
 flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
     uint32_t len)
@@ -262,6 +274,9 @@ flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
     if (off > fa->fa_size || off + len > fa->fa_size) {
         return -1;
     }
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    flash_map_preerase_written(fa->fa_device_id, fa->fa_off + off, len);
+#endif
     return hal_flash_write(fa->fa_device_id, fa->fa_off + off,
                            (void *)src, len);
 }
@@ -269,10 +284,24 @@ flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
 int
 flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
 {
+    int rc;
+
     if (off > fa->fa_size || off + len > fa->fa_size) {
         return -1;
     }
-    return hal_flash_erase(fa->fa_device_id, fa->fa_off + off, len);
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    if (flash_map_preerase_check(fa->fa_device_id, fa->fa_off + off, len)) {
+        /* Erased in the background, nothing written since. */
+        return 0;
+    }
+#endif
+    rc = hal_flash_erase(fa->fa_device_id, fa->fa_off + off, len);
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+    if (rc == 0) {
+        flash_map_erase_stats_note(fa->fa_device_id, fa->fa_off + off, len);
+    }
+#endif
+    return rc;
 }
 
 uint8_t
@@ -523,6 +552,10 @@ flash_map_init(void)
     rc = hal_flash_init();
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+    flash_map_preerase_init();
+#endif
+
     /* Use the hardcoded default flash map.  This is done for two reasons:
      * 1. A minimal flash map configuration is required to boot strap the
      *    process of reading the flash map from the manufacturing meta regions.
@@ -541,6 +574,9 @@ flash_map_init(void)
     rc = flash_map_read_mfg(sizeof mfg_areas / sizeof mfg_areas[0],
                             mfg_areas, &num_areas);
     if (rc != 0 || num_areas == 0) {
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+        flash_map_erase_stats_init();
+#endif
         return;
     }
     flash_map = mfg_areas;
@@ -552,6 +588,10 @@ flash_map_init(void)
      * any mfg areas.
      */
     flash_map_add_new_dflt_areas();
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+    flash_map_erase_stats_init();
+#endif
 }
 
 #if MYNEWT_VAL(SELFTEST)
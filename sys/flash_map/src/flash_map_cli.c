@@ -0,0 +1,136 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_CLI)
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "shell/shell.h"
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+
+static void
+flash_wear_show_area(const struct flash_area *fa, int verbose)
+{
+    struct flash_area sec;
+    uint32_t count;
+    uint32_t total;
+    uint32_t min_cnt;
+    uint32_t max_cnt;
+    uint32_t off;
+    int sec_id;
+    int cnt;
+    int rc;
+
+    total = 0;
+    min_cnt = UINT32_MAX;
+    max_cnt = 0;
+    cnt = 0;
+    sec_id = -1;
+    while (flash_area_getnext_sector(fa->fa_id, &sec_id, &sec) == 0) {
+        off = sec.fa_off - fa->fa_off;
+        rc = flash_area_erase_count(fa, off, &count);
+        if (rc) {
+            console_printf("area %d not tracked\n", fa->fa_id);
+            return;
+        }
+        if (verbose) {
+            console_printf("  0x%08" PRIx32 " %" PRIu32 "\n", off, count);
+        }
+        total += count;
+        min_cnt = min(min_cnt, count);
+        max_cnt = max(max_cnt, count);
+        cnt++;
+    }
+    if (cnt == 0) {
+        return;
+    }
+    console_printf("area %d: %d sectors, erases min %" PRIu32 " max %" PRIu32
+                   " total %" PRIu32 "\n",
+                   fa->fa_id, cnt, min_cnt, max_cnt, total);
+}
+
+static int
+flash_wear_cmd(int argc, char **argv)
+{
+    const struct flash_area *fa;
+    char *eptr;
+    long id;
+    int i;
+
+    if (argc > 1 && !strcmp(argv[1], "save")) {
+        if (flash_map_erase_stats_save()) {
+            console_printf("save failed\n");
+        }
+        return 0;
+    }
+    if (argc > 1) {
+        id = strtol(argv[1], &eptr, 0);
+        if (*eptr != '\0' || flash_area_open(id, &fa)) {
+            console_printf("usage: flash_wear [<area_id>|save]\n");
+            return 0;
+        }
+        flash_wear_show_area(fa, 1);
+        flash_area_close(fa);
+        return 0;
+    }
+    for (i = 0; i < flash_map_entries; i++) {
+        flash_wear_show_area(&flash_map[i], 0);
+    }
+    return 0;
+}
+
+#if MYNEWT_VAL(SHELL_CMD_HELP)
+static const struct shell_param flash_wear_params[] = {
+    {"<area_id>", "show erase count of each sector of area"},
+    {"save", "store erase counters to flash"},
+    {NULL, NULL}
+};
+
+static const struct shell_cmd_help flash_wear_help = {
+    .summary = "Show flash erase counts",
+    .usage = "flash_wear [<area_id>|save]",
+    .params = flash_wear_params,
+};
+#endif
+
+static const struct shell_cmd flash_wear_shell_cmd = {
+    .sc_cmd = "flash_wear",
+    .sc_cmd_func = flash_wear_cmd,
+#if MYNEWT_VAL(SHELL_CMD_HELP)
+    .help = &flash_wear_help,
+#endif
+};
+
+void
+flash_map_erase_stats_cli_init(void)
+{
+#if MYNEWT_VAL(SHELL_COMPAT)
+    int rc;
+
+    rc = shell_cmd_register(&flash_wear_shell_cmd);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+}
+
+#endif
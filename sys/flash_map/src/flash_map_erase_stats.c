@@ -0,0 +1,383 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <string.h>
+#include <assert.h>
+
+#include "hal/hal_bsp.h"
+#include "hal/hal_flash.h"
+#include "hal/hal_flash_int.h"
+#include "crc/crc16.h"
+#include "flash_map/flash_map.h"
+#include "flash_map_priv.h"
+
+/*
+ * Erase counters are kept per sector of every flash map area, in the
+ * order of the flash map. Counters are persisted as a sequence of
+ * snapshot records in FLASH_MAP_ERASE_STATS_AREA; the last valid one is
+ * loaded at startup.
+ */
+#define FLASH_MAP_ERASE_STATS_MAGIC     0xec5a7a75
+
+struct flash_map_erase_stats_area {
+    uint8_t fea_device_id;
+    uint16_t fea_base;
+    uint16_t fea_cnt;
+    uint32_t fea_off;
+    uint32_t fea_size;
+};
+
+struct flash_map_erase_stats_rec {
+    uint32_t fer_magic;
+    uint16_t fer_cnt;
+    uint16_t fer_crc;
+    uint32_t fer_counts[MYNEWT_VAL(FLASH_MAP_ERASE_STATS_MAX_SECTORS)];
+};
+
+static struct flash_map_erase_stats_area
+    flash_map_erase_stats_areas[MYNEWT_VAL(FLASH_MAP_MAX_AREAS)];
+static int flash_map_erase_stats_area_cnt;
+static struct flash_map_erase_stats_rec flash_map_erase_stats;
+static struct os_mutex flash_map_erase_stats_mtx;
+static int flash_map_erase_stats_dirty;
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA) >= 0
+static const struct flash_area *flash_map_erase_stats_fa;
+static uint32_t flash_map_erase_stats_off;
+static uint32_t flash_map_erase_stats_rec_len;
+#endif
+
+/*
+ * Counts erase of given range on device. Erased range is expected to be
+ * sector aligned; any sector overlapping it is counted.
+ */
+void
+flash_map_erase_stats_note(uint8_t id, uint32_t addr, uint32_t len)
+{
+    const struct flash_map_erase_stats_area *fea;
+    const struct hal_flash *hf;
+    uint32_t start;
+    uint32_t size;
+    int sec;
+    int i;
+    int j;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf) {
+        return;
+    }
+
+    os_mutex_pend(&flash_map_erase_stats_mtx, OS_TIMEOUT_NEVER);
+    for (i = 0; i < flash_map_erase_stats_area_cnt; i++) {
+        fea = &flash_map_erase_stats_areas[i];
+        if (fea->fea_device_id != id ||
+            addr >= fea->fea_off + fea->fea_size ||
+            fea->fea_off >= addr + len) {
+            continue;
+        }
+        sec = 0;
+        for (j = 0; j < hf->hf_sector_cnt && sec < fea->fea_cnt; j++) {
+            hf->hf_itf->hff_sector_info(hf, j, &start, &size);
+            if (start < fea->fea_off ||
+                start >= fea->fea_off + fea->fea_size) {
+                continue;
+            }
+            if (start < addr + len && addr < start + size) {
+                flash_map_erase_stats.fer_counts[fea->fea_base + sec]++;
+            }
+            sec++;
+        }
+        flash_map_erase_stats_dirty++;
+        /* A sector is counted in the first area containing it. */
+        break;
+    }
+    if (flash_map_erase_stats_dirty >=
+        MYNEWT_VAL(FLASH_MAP_ERASE_STATS_SAVE_INTERVAL)) {
+        flash_map_erase_stats_save();
+    }
+    os_mutex_release(&flash_map_erase_stats_mtx);
+}
+
+int
+flash_area_erase_count(const struct flash_area *fa, uint32_t off,
+                       uint32_t *count)
+{
+    const struct flash_map_erase_stats_area *fea;
+    const struct hal_flash *hf;
+    uint32_t addr;
+    uint32_t start;
+    uint32_t size;
+    int sec;
+    int i;
+    int j;
+
+    if (off >= fa->fa_size) {
+        return SYS_EINVAL;
+    }
+    hf = hal_bsp_flash_dev(fa->fa_device_id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    addr = fa->fa_off + off;
+
+    for (i = 0; i < flash_map_erase_stats_area_cnt; i++) {
+        fea = &flash_map_erase_stats_areas[i];
+        if (fea->fea_device_id != fa->fa_device_id ||
+            addr < fea->fea_off || addr >= fea->fea_off + fea->fea_size) {
+            continue;
+        }
+        sec = 0;
+        for (j = 0; j < hf->hf_sector_cnt && sec < fea->fea_cnt; j++) {
+            hf->hf_itf->hff_sector_info(hf, j, &start, &size);
+            if (start < fea->fea_off ||
+                start >= fea->fea_off + fea->fea_size) {
+                continue;
+            }
+            if (addr >= start && addr < start + size) {
+                *count = flash_map_erase_stats.fer_counts[fea->fea_base + sec];
+                return 0;
+            }
+            sec++;
+        }
+    }
+    return SYS_ENOENT;
+}
+
+int
+flash_area_to_erase_counts(int id, int *cnt, uint32_t *counts)
+{
+    const struct flash_map_erase_stats_area *fea;
+    int i;
+
+    for (i = 0; i < flash_map_entries; i++) {
+        if (flash_map[i].fa_id == id) {
+            break;
+        }
+    }
+    if (i == flash_map_entries || i >= flash_map_erase_stats_area_cnt) {
+        return SYS_ENOENT;
+    }
+    fea = &flash_map_erase_stats_areas[i];
+
+    *cnt = fea->fea_cnt;
+    if (counts) {
+        os_mutex_pend(&flash_map_erase_stats_mtx, OS_TIMEOUT_NEVER);
+        memcpy(counts, &flash_map_erase_stats.fer_counts[fea->fea_base],
+               fea->fea_cnt * sizeof(counts[0]));
+        os_mutex_release(&flash_map_erase_stats_mtx);
+    }
+    return 0;
+}
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA) >= 0
+static uint16_t
+flash_map_erase_stats_crc(const struct flash_map_erase_stats_rec *rec)
+{
+    return crc16_ccitt(CRC16_INITIAL_CRC, rec->fer_counts,
+                       rec->fer_cnt * sizeof(rec->fer_counts[0]));
+}
+
+static void
+flash_map_erase_stats_load(void)
+{
+    static struct flash_map_erase_stats_rec rec;
+    const struct flash_area *fa;
+    uint32_t erased;
+    uint32_t len;
+    uint32_t off;
+    int found;
+    int rc;
+
+    fa = flash_map_erase_stats_fa;
+    memset(&erased, flash_area_erased_val(fa), sizeof(erased));
+    len = min(flash_map_erase_stats_rec_len, sizeof(rec));
+
+    found = 0;
+    for (off = 0;
+         off + flash_map_erase_stats_rec_len <= fa->fa_size;
+         off += flash_map_erase_stats_rec_len) {
+        rc = flash_area_read(fa, off, &rec, len);
+        if (rc) {
+            break;
+        }
+        if (rec.fer_magic != FLASH_MAP_ERASE_STATS_MAGIC) {
+            if (rec.fer_magic != erased) {
+                /* Garbage; have the area erased on next save. */
+                off = fa->fa_size;
+            }
+            break;
+        }
+        if (rec.fer_cnt == flash_map_erase_stats.fer_cnt &&
+            flash_map_erase_stats_crc(&rec) == rec.fer_crc) {
+            memcpy(flash_map_erase_stats.fer_counts, rec.fer_counts,
+                   rec.fer_cnt * sizeof(rec.fer_counts[0]));
+            found = 1;
+        }
+    }
+    flash_map_erase_stats_off = off;
+    if (!found && off != 0) {
+        /* Nothing usable, or flash map has changed. */
+        flash_map_erase_stats_off = fa->fa_size;
+    }
+}
+#endif
+
+int
+flash_map_erase_stats_save(void)
+{
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA) >= 0
+    const struct flash_area *fa;
+    uint8_t tail[32];
+    uint32_t aligned;
+    uint32_t len;
+    int rc;
+
+    fa = flash_map_erase_stats_fa;
+    if (!fa) {
+        return SYS_ENOENT;
+    }
+
+    os_mutex_pend(&flash_map_erase_stats_mtx, OS_TIMEOUT_NEVER);
+
+    if (flash_map_erase_stats_off + flash_map_erase_stats_rec_len >
+        fa->fa_size) {
+        /*
+         * Area is full. Erase it directly through HAL, counting it here,
+         * so that flash_area_erase() doesn't recurse back into saving.
+         */
+        rc = hal_flash_erase(fa->fa_device_id, fa->fa_off, fa->fa_size);
+        if (rc) {
+            goto out;
+        }
+        flash_map_erase_stats_off = 0;
+        /* Keep note() from calling back here. */
+        flash_map_erase_stats_dirty = 0;
+        flash_map_erase_stats_note(fa->fa_device_id, fa->fa_off,
+                                   fa->fa_size);
+    }
+
+    flash_map_erase_stats.fer_magic = FLASH_MAP_ERASE_STATS_MAGIC;
+    flash_map_erase_stats.fer_crc =
+        flash_map_erase_stats_crc(&flash_map_erase_stats);
+
+    /*
+     * Record is written from the counter table itself, with part
+     * which goes past its end padded with erased value.
+     */
+    len = flash_map_erase_stats_rec_len;
+    if (len > sizeof(flash_map_erase_stats)) {
+        aligned = len - flash_area_align(fa);
+    } else {
+        aligned = len;
+    }
+    rc = flash_area_write(fa, flash_map_erase_stats_off,
+                          &flash_map_erase_stats, aligned);
+    if (!rc && aligned < len) {
+        memset(tail, flash_area_erased_val(fa), sizeof(tail));
+        memcpy(tail, (uint8_t *)&flash_map_erase_stats + aligned,
+               sizeof(flash_map_erase_stats) - aligned);
+        rc = flash_area_write(fa, flash_map_erase_stats_off + aligned,
+                              tail, len - aligned);
+    }
+    flash_map_erase_stats_off += len;
+    if (!rc) {
+        flash_map_erase_stats_dirty = 0;
+    }
+out:
+    os_mutex_release(&flash_map_erase_stats_mtx);
+    return rc;
+#else
+    flash_map_erase_stats_dirty = 0;
+    return SYS_ENOTSUP;
+#endif
+}
+
+void
+flash_map_erase_stats_init(void)
+{
+    const struct flash_area *fa;
+    const struct hal_flash *hf;
+    struct flash_map_erase_stats_area *fea;
+    uint32_t start;
+    uint32_t size;
+    uint16_t base;
+    int rc;
+    int i;
+    int j;
+
+    rc = os_mutex_init(&flash_map_erase_stats_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    base = 0;
+    flash_map_erase_stats_area_cnt = 0;
+    for (i = 0; i < flash_map_entries &&
+                i < MYNEWT_VAL(FLASH_MAP_MAX_AREAS); i++) {
+        fa = &flash_map[i];
+        fea = &flash_map_erase_stats_areas[i];
+        fea->fea_device_id = fa->fa_device_id;
+        fea->fea_off = fa->fa_off;
+        fea->fea_size = fa->fa_size;
+        fea->fea_base = base;
+        fea->fea_cnt = 0;
+
+        hf = hal_bsp_flash_dev(fa->fa_device_id);
+        for (j = 0; hf && j < hf->hf_sector_cnt; j++) {
+            hf->hf_itf->hff_sector_info(hf, j, &start, &size);
+            if (start >= fa->fa_off && start < fa->fa_off + fa->fa_size) {
+                fea->fea_cnt++;
+            }
+        }
+        if (base + fea->fea_cnt >
+            MYNEWT_VAL(FLASH_MAP_ERASE_STATS_MAX_SECTORS)) {
+            DFLT_LOG_WARN("flash erase stats: out of counters\n");
+            break;
+        }
+        base += fea->fea_cnt;
+        flash_map_erase_stats_area_cnt++;
+    }
+    flash_map_erase_stats.fer_cnt = base;
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA) >= 0
+    rc = flash_area_open(MYNEWT_VAL(FLASH_MAP_ERASE_STATS_AREA),
+                         &flash_map_erase_stats_fa);
+    if (rc) {
+        DFLT_LOG_WARN("flash erase stats: no area to store counters\n");
+        flash_map_erase_stats_fa = NULL;
+        return;
+    }
+    assert(flash_area_align(flash_map_erase_stats_fa) <= 32);
+    flash_map_erase_stats_rec_len =
+        offsetof(struct flash_map_erase_stats_rec, fer_counts) +
+        base * sizeof(flash_map_erase_stats.fer_counts[0]);
+    flash_map_erase_stats_rec_len =
+        (flash_map_erase_stats_rec_len +
+         flash_area_align(flash_map_erase_stats_fa) - 1) &
+        ~(flash_area_align(flash_map_erase_stats_fa) - 1);
+    flash_map_erase_stats_load();
+#endif
+}
+
+#endif
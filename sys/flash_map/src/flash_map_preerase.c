@@ -0,0 +1,328 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "hal/hal_flash.h"
+#include "flash_map/flash_map.h"
+#include "flash_map_priv.h"
+
+/*
+ * Background erase of flash ranges. Ranges are tracked by device address
+ * rather than by flash area, as users like FCB keep their own copies of
+ * flash_area structures describing individual sectors.
+ */
+#define FLASH_MAP_PREERASE_FREE         0
+#define FLASH_MAP_PREERASE_PENDING      1
+#define FLASH_MAP_PREERASE_ERASING      2
+#define FLASH_MAP_PREERASE_ERASED       3
+
+struct flash_map_preerase_slot {
+    uint8_t fps_state;
+    uint8_t fps_id;
+    uint32_t fps_addr;
+    uint32_t fps_len;
+};
+
+static struct flash_map_preerase_slot
+    flash_map_preerase_slots[MYNEWT_VAL(FLASH_MAP_PREERASE_SLOTS)];
+
+static struct os_mutex flash_map_preerase_mtx;
+static struct os_sem flash_map_preerase_sem;
+static struct os_task flash_map_preerase_task;
+static os_stack_t flash_map_preerase_stack[
+    OS_STACK_ALIGN(MYNEWT_VAL(FLASH_MAP_PREERASE_STACK_SIZE))];
+
+#define FLASH_MAP_PREERASE_NUM_SLOTS                                    \
+    (sizeof(flash_map_preerase_slots) / sizeof(flash_map_preerase_slots[0]))
+
+#if MYNEWT_VAL(SELFTEST)
+static void (*flash_map_preerase_erase_hook)(void);
+
+void
+flash_map_preerase_set_erase_hook(void (*hook)(void))
+{
+    flash_map_preerase_erase_hook = hook;
+}
+#endif
+
+static void
+flash_map_preerase_lock(void)
+{
+    os_mutex_pend(&flash_map_preerase_mtx, OS_TIMEOUT_NEVER);
+}
+
+static void
+flash_map_preerase_unlock(void)
+{
+    os_mutex_release(&flash_map_preerase_mtx);
+}
+
+static bool
+flash_map_preerase_overlaps(const struct flash_map_preerase_slot *slot,
+                            uint8_t id, uint32_t addr, uint32_t len)
+{
+    return slot->fps_state != FLASH_MAP_PREERASE_FREE &&
+           slot->fps_id == id &&
+           addr < slot->fps_addr + slot->fps_len &&
+           slot->fps_addr < addr + len;
+}
+
+/*
+ * Erases range of a slot which is in ERASING state. Called with lock held,
+ * releases it while erase is in progress. If range was written to in the
+ * meantime, slot has been freed and is left that way.
+ */
+static void
+flash_map_preerase_do(struct flash_map_preerase_slot *slot)
+{
+    uint8_t id;
+    uint32_t addr;
+    uint32_t len;
+    int rc;
+
+    id = slot->fps_id;
+    addr = slot->fps_addr;
+    len = slot->fps_len;
+
+    flash_map_preerase_unlock();
+#if MYNEWT_VAL(SELFTEST)
+    if (flash_map_preerase_erase_hook) {
+        flash_map_preerase_erase_hook();
+    }
+#endif
+    rc = hal_flash_erase(id, addr, len);
+    flash_map_preerase_lock();
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+    if (rc == 0) {
+        flash_map_erase_stats_note(id, addr, len);
+    }
+#endif
+    if (slot->fps_state == FLASH_MAP_PREERASE_ERASING) {
+        if (rc == 0) {
+            slot->fps_state = FLASH_MAP_PREERASE_ERASED;
+        } else {
+            slot->fps_state = FLASH_MAP_PREERASE_FREE;
+        }
+    }
+}
+
+/*
+ * Completes all pre-erases overlapping the range. Called with lock held.
+ * Returns true if the whole range is covered by one erased slot.
+ */
+static bool
+flash_map_preerase_complete(uint8_t id, uint32_t addr, uint32_t len)
+{
+    struct flash_map_preerase_slot *slot;
+    bool erased;
+    int i;
+
+restart:
+    erased = false;
+    for (i = 0; i < FLASH_MAP_PREERASE_NUM_SLOTS; i++) {
+        slot = &flash_map_preerase_slots[i];
+        if (!flash_map_preerase_overlaps(slot, id, addr, len)) {
+            continue;
+        }
+        switch (slot->fps_state) {
+        case FLASH_MAP_PREERASE_PENDING:
+            slot->fps_state = FLASH_MAP_PREERASE_ERASING;
+            flash_map_preerase_do(slot);
+            goto restart;
+        case FLASH_MAP_PREERASE_ERASING:
+            /* Background task is at it, give it time to finish. */
+            flash_map_preerase_unlock();
+            os_time_delay(1);
+            flash_map_preerase_lock();
+            goto restart;
+        default:
+            if (slot->fps_addr <= addr &&
+                addr + len <= slot->fps_addr + slot->fps_len) {
+                erased = true;
+            }
+            break;
+        }
+    }
+    return erased;
+}
+
+int
+flash_area_preerase(const struct flash_area *fa, uint32_t off, uint32_t len)
+{
+    struct flash_map_preerase_slot *slot;
+    struct flash_map_preerase_slot *free_slot;
+    struct flash_map_preerase_slot *erased_slot;
+    uint32_t addr;
+    int i;
+
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    addr = fa->fa_off + off;
+
+    flash_map_preerase_lock();
+
+    free_slot = NULL;
+    erased_slot = NULL;
+    for (i = 0; i < FLASH_MAP_PREERASE_NUM_SLOTS; i++) {
+        slot = &flash_map_preerase_slots[i];
+        if (slot->fps_state == FLASH_MAP_PREERASE_FREE) {
+            if (!free_slot) {
+                free_slot = slot;
+            }
+            continue;
+        }
+        if (slot->fps_id == fa->fa_device_id && slot->fps_addr == addr &&
+            slot->fps_len == len) {
+            /* Already queued, being erased or erased. */
+            flash_map_preerase_unlock();
+            return 0;
+        }
+        if (slot->fps_state == FLASH_MAP_PREERASE_ERASED && !erased_slot) {
+            erased_slot = slot;
+        }
+    }
+
+    /*
+     * Forgetting about range which has been erased only costs a redundant
+     * erase later, so reuse one of those if there are no free slots.
+     */
+    if (!free_slot) {
+        free_slot = erased_slot;
+    }
+    if (!free_slot) {
+        flash_map_preerase_unlock();
+        return SYS_ENOMEM;
+    }
+    free_slot->fps_id = fa->fa_device_id;
+    free_slot->fps_addr = addr;
+    free_slot->fps_len = len;
+    free_slot->fps_state = FLASH_MAP_PREERASE_PENDING;
+
+    flash_map_preerase_unlock();
+
+    os_sem_release(&flash_map_preerase_sem);
+
+    return 0;
+}
+
+int
+flash_area_preerase_wait(const struct flash_area *fa, uint32_t off,
+                         uint32_t len)
+{
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+
+    flash_map_preerase_lock();
+    flash_map_preerase_complete(fa->fa_device_id, fa->fa_off + off, len);
+    flash_map_preerase_unlock();
+
+    return 0;
+}
+
+int
+flash_map_preerase_check(uint8_t id, uint32_t addr, uint32_t len)
+{
+    bool erased;
+
+    flash_map_preerase_lock();
+    erased = flash_map_preerase_complete(id, addr, len);
+    flash_map_preerase_unlock();
+
+    return erased;
+}
+
+void
+flash_map_preerase_written(uint8_t id, uint32_t addr, uint32_t len)
+{
+    struct flash_map_preerase_slot *slot;
+    int i;
+
+    flash_map_preerase_lock();
+restart:
+    for (i = 0; i < FLASH_MAP_PREERASE_NUM_SLOTS; i++) {
+        slot = &flash_map_preerase_slots[i];
+        if (!flash_map_preerase_overlaps(slot, id, addr, len)) {
+            continue;
+        }
+        if (slot->fps_state == FLASH_MAP_PREERASE_ERASING) {
+            /* Don't let write race with the erase. */
+            flash_map_preerase_unlock();
+            os_time_delay(1);
+            flash_map_preerase_lock();
+            goto restart;
+        }
+        slot->fps_state = FLASH_MAP_PREERASE_FREE;
+    }
+    flash_map_preerase_unlock();
+}
+
+static void
+flash_map_preerase_task_handler(void *arg)
+{
+    struct flash_map_preerase_slot *slot;
+    int i;
+
+    while (1) {
+        os_sem_pend(&flash_map_preerase_sem, OS_TIMEOUT_NEVER);
+
+        flash_map_preerase_lock();
+        for (i = 0; i < FLASH_MAP_PREERASE_NUM_SLOTS; i++) {
+            slot = &flash_map_preerase_slots[i];
+            if (slot->fps_state == FLASH_MAP_PREERASE_PENDING) {
+                slot->fps_state = FLASH_MAP_PREERASE_ERASING;
+                flash_map_preerase_do(slot);
+            }
+        }
+        flash_map_preerase_unlock();
+    }
+}
+
+void
+flash_map_preerase_init(void)
+{
+    int rc;
+
+    rc = os_mutex_init(&flash_map_preerase_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    rc = os_sem_init(&flash_map_preerase_sem, 0);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    rc = os_task_init(&flash_map_preerase_task, "flash_erase",
+                      flash_map_preerase_task_handler, NULL,
+                      MYNEWT_VAL(FLASH_MAP_PREERASE_TASK_PRIO),
+                      OS_WAIT_FOREVER, flash_map_preerase_stack,
+                      MYNEWT_VAL(FLASH_MAP_PREERASE_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif
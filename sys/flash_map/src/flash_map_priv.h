@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef H_FLASH_MAP_PRIV_
+#define H_FLASH_MAP_PRIV_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(FLASH_MAP_PREERASE)
+void flash_map_preerase_init(void);
+int flash_map_preerase_check(uint8_t id, uint32_t addr, uint32_t len);
+void flash_map_preerase_written(uint8_t id, uint32_t addr, uint32_t len);
+#endif
+
+#if MYNEWT_VAL(FLASH_MAP_ERASE_STATS)
+void flash_map_erase_stats_init(void);
+void flash_map_erase_stats_note(uint8_t id, uint32_t addr, uint32_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -71,6 +71,8 @@ struct log;
 #define LOG_ETYPE_STRING         (0)
 #define LOG_ETYPE_CBOR           (1)
 #define LOG_ETYPE_BINARY         (2)
+/* Format string address and raw printf arguments; see LOG_DICT. */
+#define LOG_ETYPE_DICT           (3)
 
 /* UTC Timestamp for Jan 2016 00:00:00 */
 #define UTC01_01_2016    1451606400
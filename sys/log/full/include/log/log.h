@@ -19,6 +19,7 @@
 #ifndef __SYS_LOG_FULL_H__
 #define __SYS_LOG_FULL_H__
 
+#include <stdarg.h>
 #include "os/mynewt.h"
 #include "cbmem/cbmem.h"
 #include "log_common/log_common.h"
@@ -115,6 +116,7 @@ struct log_handler {
     lh_append_mbuf_body_func_t log_append_mbuf_body;
     lh_walk_func_t log_walk;
     lh_walk_func_t log_walk_sector;
+    lh_walk_func_t log_walk_reverse;
     lh_flush_func_t log_flush;
 #if MYNEWT_VAL(LOG_STORAGE_INFO)
     lh_storage_info_func_t log_storage_info;
@@ -131,6 +133,8 @@ struct log_handler {
 
 /* Flags used to indicate type of data in reserved payload*/
 #define LOG_FLAGS_IMG_HASH (1 << 0)
+/* Entry body is compressed; see LOG_COMPRESS */
+#define LOG_FLAGS_COMPRESSED (1 << 1)
 
 #if MYNEWT_VAL(LOG_VERSION) == 3
 struct log_entry_hdr {
@@ -192,6 +196,9 @@ STATS_SECT_START(logs)
     STATS_SECT_ENTRY(errs)
     STATS_SECT_ENTRY(lost)
     STATS_SECT_ENTRY(too_long)
+#if MYNEWT_VAL(LOG_ASYNC)
+    STATS_SECT_ENTRY(async_drops)
+#endif
 STATS_SECT_END
 
 #define LOG_STATS_INC(log, name)        STATS_INC(log->l_stats, name)
@@ -216,6 +223,13 @@ struct log {
 #if MYNEWT_VAL(LOG_STATS)
     STATS_SECT_DECL(logs) l_stats;
 #endif
+#if MYNEWT_VAL(LOG_ASYNC)
+    uint8_t l_async;
+#endif
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    /* Next log in the same name index bucket. */
+    struct log *l_hash_next;
+#endif
 };
 
 /* Log system level functions (for all logs.) */
@@ -418,6 +432,59 @@ struct log *log_console_get(void);
 void log_console_init(void);
 #endif
 
+#if MYNEWT_VAL(LOG_DICT)
+/**
+ * @brief Encodes a printf-style message as a LOG_ETYPE_DICT entry body.
+ *
+ * The body holds the address of `fmt` followed by the raw arguments; `fmt`
+ * must therefore stay valid for the lifetime of the image, i.e. be a
+ * string literal.  Arguments that do not fit in `buf` are dropped.
+ *
+ * @param buf                   The buffer to write the entry body to.
+ * @param len                   The size of `buf`.
+ * @param fmt                   The format string.
+ * @param args                  The format arguments.
+ *
+ * @return                      The length of the body on success;
+ *                                  -1 if `buf` is too small.
+ */
+int log_dict_vencode(void *buf, int len, const char *fmt, va_list args);
+
+/**
+ * @brief Formats a LOG_ETYPE_DICT entry body written by this image as text.
+ *
+ * @param body                  The entry body.
+ * @param body_len              The length of the entry body.
+ * @param buf                   The buffer to write the text to.
+ * @param len                   The size of `buf`.
+ *
+ * @return                      The length of the text, excluding the
+ *                                  terminating NUL.
+ */
+int log_dict_render(const void *body, int body_len, char *buf, int len);
+#endif
+
+#if MYNEWT_VAL(LOG_COMPRESS)
+/* Entry compression internals; see LOG_COMPRESS. */
+void log_compress_init(void);
+int log_compress_append(struct log *log, struct log_entry_hdr *hdr,
+                        const void *body, struct os_mbuf *om, uint16_t off,
+                        uint16_t len);
+int log_compress_body_len(struct log *log, const void *dptr,
+                          const struct log_entry_hdr *hdr);
+int log_compress_read_body(struct log *log, const void *dptr,
+                           const struct log_entry_hdr *hdr, void *buf,
+                           struct os_mbuf *om, uint16_t off, uint16_t len);
+#endif
+
+#if MYNEWT_VAL(LOG_ASYNC)
+/* Asynchronous log internals; see log_set_async(). */
+void log_async_init(void);
+void *log_async_reserve(struct log *log, uint16_t len);
+void log_async_commit(void *entry);
+int log_append_staged(struct log *log, void *data, uint16_t len);
+#endif
+
 /**
  * @brief Writes the raw contents of a flat buffer to the specified log.
  *
@@ -607,6 +674,42 @@ int log_flush(struct log *log);
 int log_walk_body_section(struct log *log, log_walk_body_func_t walk_body_func,
               struct log_offset *log_offset);
 
+/**
+ * @brief Applies a callback to each message in the specified log, starting
+ * from the newest entry and moving towards older ones.
+ *
+ * The walk ends at the oldest entry, or at the first entry whose index is
+ * less than `log_offset->lo_index`.  If `log_offset->lo_ts` is negative,
+ * only the newest entry is processed.
+ *
+ * @param log                   The log to iterate.
+ * @param walk_func             The function to apply to each log entry.
+ * @param log_offset            Specifies the range of entries to process.
+ *
+ * @return                      0 if the walk completed successfully;
+ *                              SYS_ENOTSUP if the log handler does not
+ *                                  support reverse walks;
+ *                              nonzero on error or if the walk was aborted.
+ */
+int log_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                     struct log_offset *log_offset);
+
+/**
+ * @brief Like `log_walk_reverse`, except it passes the message header and
+ * body separately to the callback.
+ *
+ * @param log                   The log to iterate.
+ * @param walk_body_func        The function to apply to each log entry.
+ * @param log_offset            Specifies the range of entries to process.
+ *
+ * @return                      0 if the walk completed successfully;
+ *                              SYS_ENOTSUP if the log handler does not
+ *                                  support reverse walks;
+ *                              nonzero on error or if the walk was aborted.
+ */
+int log_walk_body_reverse(struct log *log, log_walk_body_func_t walk_body_func,
+                          struct log_offset *log_offset);
+
 #if MYNEWT_VAL(LOG_MODULE_LEVELS)
 /**
  * @brief Retrieves the globally configured minimum log level for the specified
@@ -675,6 +778,51 @@ uint8_t log_get_level(const struct log *log);
  */
 void log_set_max_entry_len(struct log *log, uint16_t max_entry_len);
 
+#if MYNEWT_VAL(LOG_ASYNC)
+struct log_async_info {
+    /* Size of the staging ring, in bytes */
+    uint32_t lai_size;
+    /* Bytes currently queued */
+    uint32_t lai_used;
+    /* Most bytes ever queued at once */
+    uint32_t lai_max_used;
+    /* Entries dropped because the ring was full */
+    uint32_t lai_drops;
+};
+
+/**
+ * @brief Makes writes to the given log asynchronous.
+ *
+ * Entries appended to an asynchronous log are timestamped and copied into a
+ * shared RAM staging ring; the log task later writes them to the log
+ * handler in order.  Entry indices are assigned when the entry is written,
+ * and the append callback runs in the log task.  If the ring is full the
+ * entry is dropped and counted.  Appending never waits for the log
+ * handler, so flash writes and erases stay out of the caller's context.
+ *
+ * @param log                   The log to configure.
+ * @param async                 1 to queue writes; 0 to write synchronously.
+ */
+void log_set_async(struct log *log, int async);
+
+/**
+ * @brief Writes all queued asynchronous log entries now.
+ *
+ * Must be called from task context.  Useful before reading a log back or
+ * before a planned reset.
+ *
+ * @return                      The number of entries written.
+ */
+int log_async_flush(void);
+
+/**
+ * @brief Reads staging ring usage and drop counters.
+ *
+ * @param info                  The destination to write information to.
+ */
+void log_async_info_get(struct log_async_info *info);
+#endif
+
 /**
  * Return last entry index in log.
  *
@@ -56,6 +56,26 @@ struct log_fcb_bset {
     int lfs_next;
 };
 
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+/** The first entry of one FCB sector. */
+struct log_fcb_sidx {
+    /* Timestamp of the first entry in the sector. */
+    int64_t lfx_ts;
+    /* Index of the first entry in the sector. */
+    uint32_t lfx_index;
+    /* Whether the sector holds any entries. */
+    uint8_t lfx_valid;
+};
+
+/** Sector index of an fcb log; one element per FCB sector. */
+struct log_fcb_sidx_set {
+    struct log_fcb_sidx *lfxs_sectors;
+    int lfxs_cnt;
+    /* Whether the index reflects the contents of flash. */
+    uint8_t lfxs_built;
+};
+#endif
+
 /**
  * fcb_log is needed as the number of entries in a log
  */
@@ -72,6 +92,9 @@ struct fcb_log {
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     struct log_fcb_bset fl_bset;
 #endif
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    struct log_fcb_sidx_set fl_sidx;
+#endif
 };
 
 #elif MYNEWT_VAL(LOG_FCB2)
@@ -161,6 +184,80 @@ void log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb2_entry *entry,
 #endif
 #endif
 
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+
+struct log;
+struct log_offset;
+struct log_entry_hdr;
+
+/**
+ * The sector index is a RAM table holding the index and timestamp of the
+ * first entry in each FCB sector.  Walks with a starting index or
+ * timestamp use it to go straight to the right sector instead of reading
+ * entries from the start of the log.
+ *
+ * The table is built from flash, one header read per sector, on first use.
+ * After that it is kept current as entries are appended and sectors are
+ * rotated out, so it also survives a reboot without extra work.
+ */
+
+/**
+ * @brief Configures an fcb_log to keep a sector index in the specified
+ * buffer.
+ *
+ * @param fcb_log               The log to configure.
+ * @param buf                   The buffer to use for the index.
+ * @param sector_count          The number of elements in `buf`; must be at
+ *                                  least the number of sectors in the FCB.
+ *
+ * @return                      0 on success; SYS_EINVAL if the buffer is
+ *                                  too small.
+ */
+int log_fcb_init_sector_index(struct fcb_log *fcb_log,
+                              struct log_fcb_sidx *buf, int sector_count);
+
+/**
+ * @brief Marks the sector index of an fcb_log as needing a rebuild.
+ *
+ * @param fcb_log               The fcb_log to clear.
+ */
+void log_fcb_sidx_clear(struct fcb_log *fcb_log);
+
+/**
+ * @brief Drops the oldest FCB sector from the index.  This is meant to get
+ * called just before the sector is rotated out.
+ *
+ * @param fcb_log               The fcb_log to operate on.
+ */
+void log_fcb_sidx_rotate(struct fcb_log *fcb_log);
+
+/**
+ * @brief Records a newly appended entry in the sector index.
+ *
+ * @param fcb_log               The fcb_log the entry was appended to.
+ * @param loc                   The location of the new entry.
+ * @param hdr                   The header of the new entry.
+ */
+void log_fcb_sidx_append(struct fcb_log *fcb_log, const struct fcb_entry *loc,
+                         const struct log_entry_hdr *hdr);
+
+/**
+ * @brief Finds the first entry of the latest sector that can not contain
+ * any entries before the specified offset.
+ *
+ * @param log                   The log to search.
+ * @param log_offset            The index and timestamp to look for.
+ * @param out_entry             On success, the first entry of the sector.
+ * @param out_index             On success, the index of that entry.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOENT if no sector qualifies or the
+ *                                  index is not configured.
+ */
+int log_fcb_sidx_find(struct log *log, const struct log_offset *log_offset,
+                      struct fcb_entry *out_entry, uint32_t *out_index);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
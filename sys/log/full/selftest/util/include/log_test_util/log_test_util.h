@@ -71,6 +71,11 @@ TEST_CASE_DECL(log_test_case_fcb_append_mbuf_body);
 TEST_SUITE_DECL(log_test_suite_misc);
 TEST_CASE_DECL(log_test_case_level);
 TEST_CASE_DECL(log_test_case_append_cb);
+TEST_CASE_DECL(log_test_case_async);
+TEST_CASE_DECL(log_test_case_dict);
+TEST_CASE_DECL(log_test_case_fcb_sidx);
+TEST_CASE_DECL(log_test_case_walk_reverse);
+TEST_CASE_DECL(log_test_case_compress);
 
 TEST_CASE_DECL(log_test_case_2logs);
 
@@ -53,4 +53,19 @@ TEST_SUITE(log_test_suite_misc)
 #if MYNEWT_VAL(LOG_FCB)
     log_test_case_2logs();
 #endif
+#if MYNEWT_VAL(LOG_ASYNC)
+    log_test_case_async();
+#endif
+#if MYNEWT_VAL(LOG_DICT)
+    log_test_case_dict();
+#endif
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    log_test_case_fcb_sidx();
+#endif
+#if MYNEWT_VAL(LOG_FCB) || MYNEWT_VAL(LOG_FCB2)
+    log_test_case_walk_reverse();
+#endif
+#if MYNEWT_VAL(LOG_COMPRESS)
+    log_test_case_compress();
+#endif
 }
@@ -111,6 +111,8 @@ ltu_setup_fcb(struct fcb_log *fcb_log, struct log *log)
     int i;
 
     *fcb_log = (struct fcb_log) { 0 };
+    /* log_register() leaves the rotate callback alone. */
+    *log = (struct log) { 0 };
 
     fcb_log->fl_fcb.f_magic = 0x7EADBADF;
     fcb_log->fl_fcb.f_version = 0;
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+static int ltca_num_entries;
+
+static int
+ltca_walk_count(struct log *log, struct log_offset *log_offset,
+                const void *dptr, uint16_t len)
+{
+    ltca_num_entries++;
+    return 0;
+}
+
+static int
+ltca_count(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    ltca_num_entries = 0;
+    rc = log_walk(log, ltca_walk_count, &log_offset);
+    TEST_ASSERT(rc == 0);
+
+    return ltca_num_entries;
+}
+
+TEST_CASE_SELF(log_test_case_async)
+{
+    struct log_async_info info;
+    struct fcb_log fcb_log;
+    struct os_mbuf *om;
+    struct log log;
+    uint32_t drops;
+    char *str;
+    int num_strs;
+    int rc;
+    int i;
+
+    ltu_setup_fcb(&fcb_log, &log);
+    log_set_async(&log, 1);
+
+    num_strs = 0;
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+
+        /* Alternate between the flat and mbuf append paths. */
+        if (i % 2 == 0) {
+            rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str,
+                                 strlen(str));
+        } else {
+            om = ltu_flat_to_fragged_mbuf(str, strlen(str), 2);
+            rc = log_append_mbuf_body(&log, 0, 0, LOG_ETYPE_STRING, om);
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        num_strs++;
+    }
+
+    /*** Nothing reaches the log until the staging ring is drained. */
+    TEST_ASSERT(ltca_count(&log) == 0);
+
+    log_async_info_get(&info);
+    TEST_ASSERT(info.lai_used > 0);
+    drops = info.lai_drops;
+
+    rc = log_async_flush();
+    TEST_ASSERT(rc == num_strs);
+
+    log_async_info_get(&info);
+    TEST_ASSERT(info.lai_used == 0);
+
+    /* Entries are written in order with sequential indices. */
+    log_set_async(&log, 0);
+    ltu_verify_contents(&log);
+
+    /*** An entry larger than the ring is dropped and counted. */
+    log_set_async(&log, 1);
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    for (i = 0; i < MYNEWT_VAL(LOG_ASYNC_BUF_SIZE); i += 16) {
+        rc = os_mbuf_append(om, "0123456789abcdef", 16);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = log_append_mbuf_body(&log, 0, 0, LOG_ETYPE_BINARY, om);
+    TEST_ASSERT(rc != 0);
+
+    log_async_info_get(&info);
+    TEST_ASSERT(info.lai_drops == drops + 1);
+    TEST_ASSERT(log_async_flush() == 0);
+    TEST_ASSERT(ltca_count(&log) == 0);
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_COMPRESS)
+
+#define LTCC_NUM_ENTRIES    8
+#define LTCC_MAX_LEN        MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)
+
+static uint8_t ltcc_bodies[LTCC_NUM_ENTRIES][LTCC_MAX_LEN];
+static uint16_t ltcc_lens[LTCC_NUM_ENTRIES];
+static int ltcc_num_compressed;
+static int ltcc_num_walked;
+
+static uint16_t
+ltcc_fill(uint8_t *body, int i)
+{
+    static const char text[] = "sensor temp=21.5 ok\n";
+    uint16_t len;
+    uint16_t off;
+
+    /* Text of varying length; the last entry is too short to compress. */
+    len = LTCC_MAX_LEN - i * 29;
+    if (i == LTCC_NUM_ENTRIES - 1) {
+        len = MYNEWT_VAL(LOG_COMPRESS_MIN_LEN) - 1;
+    }
+    for (off = 0; off < len; off++) {
+        body[off] = text[(off + i) % (sizeof(text) - 1)];
+    }
+
+    return len;
+}
+
+static int
+ltcc_walk_raw(struct log *log, struct log_offset *log_offset,
+              const void *dptr, uint16_t len)
+{
+    struct log_entry_hdr hdr;
+    int rc;
+
+    rc = log_read_hdr(log, dptr, &hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+    if (hdr.ue_flags & LOG_FLAGS_COMPRESSED) {
+        ltcc_num_compressed++;
+        TEST_ASSERT(len - log_hdr_len(&hdr) < ltcc_lens[ltcc_num_walked]);
+    }
+    ltcc_num_walked++;
+
+    return 0;
+}
+
+static int
+ltcc_walk_body(struct log *log, struct log_offset *log_offset,
+               const struct log_entry_hdr *hdr, const void *dptr,
+               uint16_t len)
+{
+    uint8_t buf[LTCC_MAX_LEN];
+    struct os_mbuf *om;
+    uint16_t off;
+    int i;
+    int rc;
+
+    i = ltcc_num_walked++;
+    TEST_ASSERT_FATAL(i < LTCC_NUM_ENTRIES);
+
+    /* Body walks see the entry as it was appended. */
+    TEST_ASSERT(!(hdr->ue_flags & LOG_FLAGS_COMPRESSED));
+    TEST_ASSERT(len == ltcc_lens[i]);
+
+    /* Read piecewise, as the cbor reader does. */
+    for (off = 0; off < len; off += rc) {
+        rc = log_read_body(log, dptr, buf + off, off, 7);
+        TEST_ASSERT_FATAL(rc > 0);
+    }
+    TEST_ASSERT(memcmp(buf, ltcc_bodies[i], len) == 0);
+
+    /* Reads past the end are truncated. */
+    rc = log_read_body(log, dptr, buf, len - 3, 10);
+    TEST_ASSERT(rc == 3);
+
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = log_read_mbuf_body(log, dptr, om, 0, len);
+    TEST_ASSERT(rc == len);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, ltcc_bodies[i], len) == 0);
+    os_mbuf_free_chain(om);
+
+    return 0;
+}
+
+TEST_CASE_SELF(log_test_case_compress)
+{
+    uint8_t buf[LOG_HDR_SIZE + LTCC_MAX_LEN];
+    struct log_offset log_offset;
+    struct fcb_log fcb_log;
+    struct os_mbuf *om;
+    struct log log;
+    int rc;
+    int i;
+
+    ltu_setup_fcb(&fcb_log, &log);
+
+    /* Exercise every append path. */
+    for (i = 0; i < LTCC_NUM_ENTRIES; i++) {
+        ltcc_lens[i] = ltcc_fill(ltcc_bodies[i], i);
+
+        switch (i % 4) {
+        case 0:
+            rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING,
+                                 ltcc_bodies[i], ltcc_lens[i]);
+            break;
+        case 1:
+            memcpy(buf + LOG_HDR_SIZE, ltcc_bodies[i], ltcc_lens[i]);
+            rc = log_append_typed(&log, 0, 0, LOG_ETYPE_STRING, buf,
+                                  ltcc_lens[i]);
+            break;
+        case 2:
+            om = ltu_flat_to_fragged_mbuf(ltcc_bodies[i], ltcc_lens[i], 13);
+            rc = log_append_mbuf_body(&log, 0, 0, LOG_ETYPE_STRING, om);
+            break;
+        default:
+            om = ltu_flat_to_fragged_mbuf(ltcc_bodies[i], ltcc_lens[i], 13);
+            om = os_mbuf_prepend(om, LOG_HDR_SIZE);
+            TEST_ASSERT_FATAL(om != NULL);
+            rc = log_append_mbuf_typed(&log, 0, 0, LOG_ETYPE_STRING, om);
+            break;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* All but the short entry are stored compressed and smaller. */
+    memset(&log_offset, 0, sizeof(log_offset));
+    ltcc_num_compressed = 0;
+    ltcc_num_walked = 0;
+    rc = log_walk(&log, ltcc_walk_raw, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcc_num_walked == LTCC_NUM_ENTRIES);
+    TEST_ASSERT(ltcc_num_compressed == LTCC_NUM_ENTRIES - 1);
+
+    memset(&log_offset, 0, sizeof(log_offset));
+    ltcc_num_walked = 0;
+    rc = log_walk_body(&log, ltcc_walk_body, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcc_num_walked == LTCC_NUM_ENTRIES);
+}
+
+#endif
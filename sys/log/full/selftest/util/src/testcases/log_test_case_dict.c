@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_DICT)
+
+static struct log_entry_hdr ltcd_hdr;
+static char ltcd_text[LOG_PRINTF_MAX_ENTRY_LEN];
+static int ltcd_body_len;
+
+static int
+ltcd_walk_last(struct log *log, struct log_offset *log_offset,
+               const void *dptr, uint16_t len)
+{
+    uint8_t body[LOG_PRINTF_MAX_ENTRY_LEN];
+    int rc;
+
+    rc = log_read_hdr(log, dptr, &ltcd_hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    ltcd_body_len = len - log_hdr_len(&ltcd_hdr);
+    TEST_ASSERT_FATAL(ltcd_body_len <= sizeof body);
+
+    rc = log_read_body(log, dptr, body, 0, ltcd_body_len);
+    TEST_ASSERT_FATAL(rc == ltcd_body_len);
+
+    log_dict_render(body, ltcd_body_len, ltcd_text, sizeof ltcd_text);
+
+    return 0;
+}
+
+static void
+ltcd_read_last(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    ltcd_body_len = -1;
+    rc = log_walk(log, ltcd_walk_last, &log_offset);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ltcd_body_len >= 0);
+}
+
+TEST_CASE_SELF(log_test_case_dict)
+{
+    struct cbmem cbmem;
+    struct log log;
+    int i;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+    log_printf(&log, 0, 0, "%d %u 0x%04x %s %-3s| %lld %% %c",
+               -5, 7u, 0xab, "str", "a", 1LL << 40, 'q');
+    ltcd_read_last(&log);
+    TEST_ASSERT(ltcd_hdr.ue_etype == LOG_ETYPE_DICT);
+    TEST_ASSERT(strcmp(ltcd_text,
+                       "-5 7 0x00ab str a  | 1099511627776 % q") == 0);
+
+    /* Only the arguments are stored, not the expanded text. */
+    log_printf(&log, 0, 0, "a long format string with a small number: %d",
+               1);
+    ltcd_read_last(&log);
+    TEST_ASSERT(ltcd_body_len == sizeof(uintptr_t) + sizeof(int));
+    TEST_ASSERT(strcmp(ltcd_text,
+                       "a long format string with a small number: 1") == 0);
+
+    /* Arguments that do not fit are dropped. */
+    for (i = 0; i < sizeof ltcd_text - 1; i++) {
+        ltcd_text[i] = 'x';
+    }
+    ltcd_text[i] = '\0';
+    log_printf(&log, 0, 0, "%s %d", ltcd_text, 3);
+    ltcd_read_last(&log);
+    TEST_ASSERT(ltcd_body_len <= LOG_PRINTF_MAX_ENTRY_LEN);
+    TEST_ASSERT(strstr(ltcd_text, "<?>") != NULL);
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+
+#define LTCFS_MAX_ENTRIES   256
+#define LTCFS_BODY_LEN      200
+
+static uint32_t ltcfs_idxs[LTCFS_MAX_ENTRIES];
+static int64_t ltcfs_tss[LTCFS_MAX_ENTRIES];
+static int ltcfs_num_entries;
+
+static int
+ltcfs_walk_collect(struct log *log, struct log_offset *log_offset,
+                   const void *dptr, uint16_t len)
+{
+    struct log_entry_hdr hdr;
+    int rc;
+
+    rc = log_read_hdr(log, dptr, &hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Entries before the requested index must be skipped by the walk. */
+    TEST_ASSERT(hdr.ue_index >= log_offset->lo_index);
+
+    TEST_ASSERT_FATAL(ltcfs_num_entries < LTCFS_MAX_ENTRIES);
+    ltcfs_idxs[ltcfs_num_entries] = hdr.ue_index;
+    ltcfs_tss[ltcfs_num_entries] = hdr.ue_ts;
+    ltcfs_num_entries++;
+
+    return 0;
+}
+
+static int
+ltcfs_collect(struct log *log, uint32_t index, int64_t ts)
+{
+    struct log_offset log_offset = {
+        .lo_index = index,
+        .lo_ts = ts,
+    };
+    int rc;
+
+    ltcfs_num_entries = 0;
+    rc = log_walk(log, ltcfs_walk_collect, &log_offset);
+    TEST_ASSERT(rc == 0);
+
+    return ltcfs_num_entries;
+}
+
+TEST_CASE_SELF(log_test_case_fcb_sidx)
+{
+    struct log_fcb_sidx sidx[2];
+    uint32_t all_idxs[LTCFS_MAX_ENTRIES];
+    int64_t all_tss[LTCFS_MAX_ENTRIES];
+    uint8_t body[LTCFS_BODY_LEN];
+    struct fcb_log fcb_log;
+    struct log log;
+    int num_all;
+    int num;
+    int rc;
+    int i;
+    int j;
+
+    ltu_setup_fcb(&fcb_log, &log);
+
+    /*** The buffer must cover every sector. */
+    rc = log_fcb_init_sector_index(&fcb_log, sidx, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = log_fcb_init_sector_index(&fcb_log, sidx, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Write enough to force the oldest sector to be rotated out. */
+    memset(body, 0xa5, sizeof body);
+    for (i = 0; i < 3 * 16 * 1024 / LTCFS_BODY_LEN; i++) {
+        rc = log_append_body(&log, 0, 0, LOG_ETYPE_BINARY, body, sizeof body);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    num_all = ltcfs_collect(&log, 0, 0);
+    TEST_ASSERT_FATAL(num_all > 0);
+    TEST_ASSERT(ltcfs_idxs[0] > 0);
+    memcpy(all_idxs, ltcfs_idxs, num_all * sizeof all_idxs[0]);
+    memcpy(all_tss, ltcfs_tss, num_all * sizeof all_tss[0]);
+
+    /*** Seeking by index yields exactly the entries at or after it. */
+    for (i = 0; i < num_all; i += 7) {
+        num = ltcfs_collect(&log, all_idxs[i], 0);
+        TEST_ASSERT(num == num_all - i);
+        for (j = 0; j < num; j++) {
+            TEST_ASSERT(ltcfs_idxs[j] == all_idxs[i + j]);
+        }
+    }
+
+    /* An index older than the log yields everything. */
+    TEST_ASSERT(ltcfs_collect(&log, 1, 0) == num_all);
+
+    /* An index newer than the log yields nothing. */
+    TEST_ASSERT(ltcfs_collect(&log, all_idxs[num_all - 1] + 1, 0) == 0);
+
+    /*** Seeking by timestamp never skips a matching entry. */
+    for (i = 0; i < num_all; i += 7) {
+        for (j = 0; j < num_all; j++) {
+            if (all_tss[j] >= all_tss[i]) {
+                break;
+            }
+        }
+        num = ltcfs_collect(&log, 0, all_tss[i]);
+        TEST_ASSERT(num >= num_all - j);
+        TEST_ASSERT(ltcfs_idxs[num - 1] == all_idxs[num_all - 1]);
+    }
+
+    /*** A rebuilt index gives the same results as the incremental one. */
+    log_fcb_sidx_clear(&fcb_log);
+    for (i = 0; i < num_all; i += 5) {
+        num = ltcfs_collect(&log, all_idxs[i], 0);
+        TEST_ASSERT(num == num_all - i);
+        TEST_ASSERT(ltcfs_idxs[0] == all_idxs[i]);
+    }
+}
+
+#endif
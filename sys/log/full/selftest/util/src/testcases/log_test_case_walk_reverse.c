@@ -0,0 +1,149 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_FCB) || MYNEWT_VAL(LOG_FCB2)
+
+#define LTCWR_MAX_ENTRIES   256
+#define LTCWR_BODY_LEN      200
+
+static uint32_t ltcwr_idxs[LTCWR_MAX_ENTRIES];
+static int ltcwr_num_entries;
+
+static int
+ltcwr_walk_collect(struct log *log, struct log_offset *log_offset,
+                   const void *dptr, uint16_t len)
+{
+    struct log_entry_hdr hdr;
+    int rc;
+
+    rc = log_read_hdr(log, dptr, &hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT_FATAL(ltcwr_num_entries < LTCWR_MAX_ENTRIES);
+    ltcwr_idxs[ltcwr_num_entries++] = hdr.ue_index;
+
+    return 0;
+}
+
+static int
+ltcwr_walk_body_collect(struct log *log, struct log_offset *log_offset,
+                        const struct log_entry_hdr *hdr, const void *dptr,
+                        uint16_t len)
+{
+    TEST_ASSERT(len == LTCWR_BODY_LEN);
+
+    TEST_ASSERT_FATAL(ltcwr_num_entries < LTCWR_MAX_ENTRIES);
+    ltcwr_idxs[ltcwr_num_entries++] = hdr->ue_index;
+
+    return 0;
+}
+
+static int
+ltcwr_walk_stop(struct log *log, struct log_offset *log_offset,
+                const void *dptr, uint16_t len)
+{
+    ltcwr_num_entries++;
+    return 1;
+}
+
+static int
+ltcwr_collect(struct log *log, log_walk_func_t walk_func, bool reverse,
+              uint32_t index, int64_t ts)
+{
+    struct log_offset log_offset = {
+        .lo_index = index,
+        .lo_ts = ts,
+    };
+    int rc;
+
+    ltcwr_num_entries = 0;
+    if (reverse) {
+        rc = log_walk_reverse(log, walk_func, &log_offset);
+    } else {
+        rc = log_walk(log, walk_func, &log_offset);
+    }
+    TEST_ASSERT(rc == 0);
+
+    return ltcwr_num_entries;
+}
+
+TEST_CASE_SELF(log_test_case_walk_reverse)
+{
+    uint32_t all_idxs[LTCWR_MAX_ENTRIES];
+    uint8_t body[LTCWR_BODY_LEN];
+    struct log_offset log_offset;
+    struct fcb_log fcb_log;
+    struct log log;
+    int num_all;
+    int num;
+    int rc;
+    int i;
+
+    ltu_setup_fcb(&fcb_log, &log);
+
+    /*** An empty log yields nothing. */
+    TEST_ASSERT(ltcwr_collect(&log, ltcwr_walk_stop, true, 0, 0) == 0);
+
+    /* Write enough to force the oldest sector to be rotated out. */
+    memset(body, 0xa5, sizeof body);
+    for (i = 0; i < 3 * 16 * 1024 / LTCWR_BODY_LEN; i++) {
+        rc = log_append_body(&log, 0, 0, LOG_ETYPE_BINARY, body, sizeof body);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    num_all = ltcwr_collect(&log, ltcwr_walk_collect, false, 0, 0);
+    TEST_ASSERT_FATAL(num_all > 1);
+    memcpy(all_idxs, ltcwr_idxs, num_all * sizeof all_idxs[0]);
+
+    /*** A reverse walk visits the same entries, newest first. */
+    num = ltcwr_collect(&log, ltcwr_walk_collect, true, 0, 0);
+    TEST_ASSERT(num == num_all);
+    for (i = 0; i < num; i++) {
+        TEST_ASSERT(ltcwr_idxs[i] == all_idxs[num_all - 1 - i]);
+    }
+
+    /*** The walk stops before the first entry older than lo_index. */
+    for (i = 0; i < num_all; i += 7) {
+        num = ltcwr_collect(&log, ltcwr_walk_collect, true, all_idxs[i], 0);
+        TEST_ASSERT(num == num_all - i);
+        TEST_ASSERT(ltcwr_idxs[num - 1] == all_idxs[i]);
+    }
+
+    /*** A negative timestamp yields only the newest entry. */
+    num = ltcwr_collect(&log, ltcwr_walk_collect, true, 0, -1);
+    TEST_ASSERT(num == 1);
+    TEST_ASSERT(ltcwr_idxs[0] == all_idxs[num_all - 1]);
+
+    /*** A callback returning nonzero ends the walk. */
+    TEST_ASSERT(ltcwr_collect(&log, ltcwr_walk_stop, true, 0, 0) == 1);
+
+    /*** The body variant strips the header. */
+    log_offset = (struct log_offset) {
+        .lo_index = all_idxs[num_all - 3],
+    };
+    ltcwr_num_entries = 0;
+    rc = log_walk_body_reverse(&log, ltcwr_walk_body_collect, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcwr_num_entries == 3);
+    TEST_ASSERT(ltcwr_idxs[0] == all_idxs[num_all - 1]);
+}
+
+#endif
@@ -24,6 +24,7 @@
 
 #include "os/mynewt.h"
 #include "cbmem/cbmem.h"
+#include "rcu/rcu.h"
 #include "log/log.h"
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 #include "config/config.h"
@@ -44,7 +45,14 @@ struct log_module_entry {
 
 struct log_info g_log_info;
 
+/*
+ * Logs are never freed, so the list and the name index are read without
+ * locking.  Registration links a log in only after it is set up.
+ */
 static STAILQ_HEAD(, log) g_log_list = STAILQ_HEAD_INITIALIZER(g_log_list);
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+static struct log *g_log_name_hash[MYNEWT_VAL(LOG_NAME_HASH_SIZE)];
+#endif
 static struct log_module_entry g_log_module_list[
     MYNEWT_VAL(LOG_MAX_USER_MODULES)];
 static int g_log_module_count;
@@ -81,6 +89,9 @@ STATS_NAME_START(logs)
   STATS_NAME(logs, errs)
   STATS_NAME(logs, lost)
   STATS_NAME(logs, too_long)
+#if MYNEWT_VAL(LOG_ASYNC)
+  STATS_NAME(logs, async_drops)
+#endif
 STATS_NAME_END(logs)
 #endif
 
@@ -111,12 +122,7 @@ log_conf_set(int argc, char **argv, char *val)
     }
 
     /* Find proper log */
-    STAILQ_FOREACH(cur, &g_log_list, l_next) {
-        if (!strcmp(argv[0], cur->l_name)) {
-            break;
-        }
-    }
-
+    cur = log_find(argv[0]);
     if (!cur) {
         return -1;
     }
@@ -144,6 +150,9 @@ log_init(void)
     log_written = 0;
 
     STAILQ_INIT(&g_log_list);
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    memset(g_log_name_hash, 0, sizeof g_log_name_hash);
+#endif
     g_log_info.li_version = MYNEWT_VAL(LOG_VERSION);
 #if MYNEWT_VAL(LOG_GLOBAL_IDX)
     g_log_info.li_next_index = 0;
@@ -162,6 +171,14 @@ log_init(void)
     log_console_init();
 #endif
 
+#if MYNEWT_VAL(LOG_ASYNC)
+    log_async_init();
+#endif
+
+#if MYNEWT_VAL(LOG_COMPRESS)
+    log_compress_init();
+#endif
+
 #if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
 #if MYNEWT_VAL(LOG_PERSIST_WATERMARK)
     rc = conf_register(&log_conf);
@@ -263,17 +280,82 @@ log_registered(struct log *log)
     return 0;
 }
 
+static void
+log_list_insert(struct log *log)
+{
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    struct log **bucket;
+#endif
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    STAILQ_NEXT(log, l_next) = NULL;
+    RCU_ASSIGN_PTR(*g_log_list.stqh_last, log);
+    g_log_list.stqh_last = &STAILQ_NEXT(log, l_next);
+
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    /* Append, so that the first log registered under a name wins as it does
+     * in the list.
+     */
+    bucket = &g_log_name_hash[rcu_name_hash(log->l_name) %
+                              MYNEWT_VAL(LOG_NAME_HASH_SIZE)];
+    while (*bucket != NULL) {
+        bucket = &(*bucket)->l_hash_next;
+    }
+    log->l_hash_next = NULL;
+    RCU_ASSIGN_PTR(*bucket, log);
+#endif
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+log_list_remove(struct log *log)
+{
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    struct log **bucket;
+#endif
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    STAILQ_REMOVE(&g_log_list, log, log, l_next);
+
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    bucket = &g_log_name_hash[rcu_name_hash(log->l_name) %
+                              MYNEWT_VAL(LOG_NAME_HASH_SIZE)];
+    while (*bucket != NULL) {
+        if (*bucket == log) {
+            *bucket = log->l_hash_next;
+            break;
+        }
+        bucket = &(*bucket)->l_hash_next;
+    }
+#endif
+
+    OS_EXIT_CRITICAL(sr);
+}
+
 struct log *
 log_find(const char *name)
 {
     struct log *log;
 
+#if MYNEWT_VAL(LOG_NAME_HASH_SIZE) > 0
+    log = g_log_name_hash[rcu_name_hash(name) %
+                          MYNEWT_VAL(LOG_NAME_HASH_SIZE)];
+    while (log != NULL && strcmp(log->l_name, name) != 0) {
+        log = log->l_hash_next;
+    }
+#else
     log = NULL;
     while ((log = log_list_get_next(log)) != NULL) {
         if (strcmp(log->l_name, name) == 0) {
             break;
         }
     }
+#endif
 
     return log;
 }
@@ -365,9 +447,12 @@ log_register(const char *name, struct log *log, const struct log_handler *lh,
 #if !MYNEWT_VAL(LOG_GLOBAL_IDX)
     log->l_idx = 0;
 #endif
+#if MYNEWT_VAL(LOG_ASYNC)
+    log->l_async = 0;
+#endif
 
     if (!log_registered(log)) {
-        STAILQ_INSERT_TAIL(&g_log_list, log, l_next);
+        log_list_insert(log);
 #if MYNEWT_VAL(LOG_STATS)
         stats_init(STATS_HDR(log->l_stats),
                    STATS_SIZE_INIT_PARMS(log->l_stats, STATS_SIZE_32),
@@ -380,7 +465,7 @@ log_register(const char *name, struct log *log, const struct log_handler *lh,
     if (log->l_log->log_registered) {
         rc = log->l_log->log_registered(log);
         if (rc) {
-            STAILQ_REMOVE(&g_log_list, log, log, l_next);
+            log_list_remove(log);
             return rc;
         }
     }
@@ -442,6 +527,9 @@ log_chk_type(uint8_t etype)
         case LOG_ETYPE_STRING:
         case LOG_ETYPE_BINARY:
         case LOG_ETYPE_CBOR:
+#if MYNEWT_VAL(LOG_DICT)
+        case LOG_ETYPE_DICT:
+#endif
             break;
         default:
             rc = OS_ERROR;
@@ -467,14 +555,63 @@ log_chk_max_entry_len(struct log *log, uint16_t len)
     return rc;
 }
 
+static int
+log_is_async(const struct log *log)
+{
+#if MYNEWT_VAL(LOG_ASYNC)
+    return log->l_async;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Assigns the next entry index to the given header.
+ */
+static void
+log_assign_index(struct log *log, struct log_entry_hdr *ue)
+{
+    uint32_t idx;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(LOG_GLOBAL_IDX)
+#if MYNEWT_VAL(LOG_SEQUENTIAL_IDX)
+    /*
+     * Avoid incrementing the global index for streamed logs in
+     * order to keep it sequentially increasing for persisted logs.
+     */
+    if (log->l_log->log_type != LOG_TYPE_STREAM) {
+        g_log_info.li_next_index++;
+    }
+    idx = g_log_info.li_next_index;
+#else
+    idx = g_log_info.li_next_index++;
+#endif
+#else
+    idx = log->l_idx++;
+#endif
+    OS_EXIT_CRITICAL(sr);
+
+    ue->ue_index = idx;
+}
+
+#if !MYNEWT_VAL(LOG_COMPRESS)
+static inline int
+log_compress_append(struct log *log, struct log_entry_hdr *hdr,
+                    const void *body, struct os_mbuf *om, uint16_t off,
+                    uint16_t len)
+{
+    return SYS_ENOTSUP;
+}
+#endif
+
 static int
 log_append_prepare(struct log *log, uint8_t module, uint8_t level,
                    uint8_t etype, struct log_entry_hdr *ue)
 {
     int rc;
-    int sr;
     struct os_timeval tv;
-    uint32_t idx;
 
     rc = 0;
 
@@ -510,24 +647,13 @@ log_append_prepare(struct log *log, uint8_t module, uint8_t level,
         goto err;
     }
 
-    OS_ENTER_CRITICAL(sr);
-#if MYNEWT_VAL(LOG_GLOBAL_IDX)
-#if MYNEWT_VAL(LOG_SEQUENTIAL_IDX)
     /*
-     * Avoid incrementing the global index for streamed logs in
-     * order to keep it sequentially increasing for persisted logs.
+     * Asynchronous entries get their index when they are written, so that
+     * indices follow the order of entries in the log.
      */
-    if (log->l_log->log_type != LOG_TYPE_STREAM) {
-        g_log_info.li_next_index++;
+    if (!log_is_async(log)) {
+        log_assign_index(log, ue);
     }
-    idx = g_log_info.li_next_index;
-#else
-    idx = g_log_info.li_next_index++;
-#endif
-#else
-    idx = log->l_idx++;
-#endif
-    OS_EXIT_CRITICAL(sr);
 
     /* Try to get UTC Time */
     rc = os_gettimeofday(&tv, NULL);
@@ -539,7 +665,6 @@ log_append_prepare(struct log *log, uint8_t module, uint8_t level,
 
     ue->ue_level = level;
     ue->ue_module = module;
-    ue->ue_index = idx;
     ue->ue_etype = etype;
     /* Clear flags before assigning */
     ue->ue_flags = 0;
@@ -575,6 +700,73 @@ log_call_append_cb(struct log *log, uint32_t idx)
     }
 }
 
+#if MYNEWT_VAL(LOG_ASYNC)
+/**
+ * Copies a prepared entry into the asynchronous staging ring.  The body is
+ * taken from `body` if `om` is NULL, otherwise from `om` starting at offset
+ * `off`.
+ */
+static int
+log_append_async(struct log *log, const struct log_entry_hdr *hdr,
+                 const void *body, struct os_mbuf *om, uint16_t off,
+                 uint16_t body_len)
+{
+    uint16_t hdr_len;
+    uint8_t *entry;
+    int rc;
+
+    hdr_len = log_hdr_len(hdr);
+
+    entry = log_async_reserve(log, hdr_len + body_len);
+    if (entry == NULL) {
+        LOG_STATS_INC(log, async_drops);
+        return OS_ENOMEM;
+    }
+
+    memcpy(entry, hdr, hdr_len);
+    if (om == NULL) {
+        memcpy(entry + hdr_len, body, body_len);
+    } else {
+        rc = os_mbuf_copydata(om, off, body_len, entry + hdr_len);
+        assert(rc == 0);
+    }
+
+    log_async_commit(entry);
+
+    return 0;
+}
+
+int
+log_append_staged(struct log *log, void *data, uint16_t len)
+{
+    struct log_entry_hdr *hdr;
+    int rc;
+
+    hdr = data;
+    log_assign_index(log, hdr);
+
+    rc = log_compress_append(log, hdr, (uint8_t *)data + log_hdr_len(hdr),
+                             NULL, 0, len - log_hdr_len(hdr));
+    if (rc == SYS_ENOTSUP) {
+        rc = log->l_log->log_append(log, data, len);
+    }
+    if (rc != 0) {
+        LOG_STATS_INC(log, errs);
+        return rc;
+    }
+
+    log_call_append_cb(log, hdr->ue_index);
+
+    return 0;
+}
+
+void
+log_set_async(struct log *log, int async)
+{
+    log->l_async = async;
+}
+#endif
+
 int
 log_append_typed(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
                  void *data, uint16_t len)
@@ -596,7 +788,18 @@ log_append_typed(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         goto err;
     }
 
-    rc = log->l_log->log_append(log, data, len + log_hdr_len(hdr));
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_append_async(log, hdr, (uint8_t *)data + log_hdr_len(hdr),
+                                NULL, 0, len);
+    }
+#endif
+
+    rc = log_compress_append(log, hdr, (uint8_t *)data + log_hdr_len(hdr),
+                             NULL, 0, len);
+    if (rc == SYS_ENOTSUP) {
+        rc = log->l_log->log_append(log, data, len + log_hdr_len(hdr));
+    }
     if (rc != 0) {
         LOG_STATS_INC(log, errs);
         goto err;
@@ -629,7 +832,16 @@ log_append_body(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         return rc;
     }
 
-    rc = log->l_log->log_append_body(log, &hdr, body, body_len);
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_append_async(log, &hdr, body, NULL, 0, body_len);
+    }
+#endif
+
+    rc = log_compress_append(log, &hdr, body, NULL, 0, body_len);
+    if (rc == SYS_ENOTSUP) {
+        rc = log->l_log->log_append_body(log, &hdr, body, body_len);
+    }
     if (rc != 0) {
         LOG_STATS_INC(log, errs);
         return rc;
@@ -701,7 +913,26 @@ log_append_mbuf_typed_no_free(struct log *log, uint8_t module, uint8_t level,
         goto drop;
     }
 
-    rc = log->l_log->log_append_mbuf(log, om);
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        hdr_len = log_hdr_len(hdr);
+        rc = log_append_async(log, hdr, NULL, om, hdr_len, len - hdr_len);
+        if (rc != 0) {
+            goto drop;
+        }
+        *om_ptr = om;
+        return 0;
+    }
+#endif
+
+    hdr_len = log_hdr_len(hdr);
+    rc = SYS_ENOTSUP;
+    if (len > hdr_len) {
+        rc = log_compress_append(log, hdr, NULL, om, hdr_len, len - hdr_len);
+    }
+    if (rc == SYS_ENOTSUP) {
+        rc = log->l_log->log_append_mbuf(log, om);
+    }
     if (rc != 0) {
         goto err;
     }
@@ -764,7 +995,16 @@ log_append_mbuf_body_no_free(struct log *log, uint8_t module, uint8_t level,
         goto drop;
     }
 
-    rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
+#if MYNEWT_VAL(LOG_ASYNC)
+    if (log->l_async) {
+        return log_append_async(log, &hdr, NULL, om, 0, len);
+    }
+#endif
+
+    rc = log_compress_append(log, &hdr, NULL, om, 0, len);
+    if (rc == SYS_ENOTSUP) {
+        rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
+    }
     if (rc != 0) {
         goto err;
     }
@@ -798,6 +1038,14 @@ log_printf(struct log *log, uint8_t module, uint8_t level,
     char buf[LOG_PRINTF_MAX_ENTRY_LEN];
     int len;
 
+#if MYNEWT_VAL(LOG_DICT)
+    va_start(args, msg);
+    len = log_dict_vencode(buf, LOG_PRINTF_MAX_ENTRY_LEN, msg, args);
+    va_end(args);
+    if (len >= 0) {
+        log_append_body(log, module, level, LOG_ETYPE_DICT, buf, len);
+    }
+#else
     va_start(args, msg);
     len = vsnprintf(buf, LOG_PRINTF_MAX_ENTRY_LEN, msg, args);
     va_end(args);
@@ -806,6 +1054,7 @@ log_printf(struct log *log, uint8_t module, uint8_t level,
     }
 
     log_append_body(log, module, level, LOG_ETYPE_STRING, buf, len);
+#endif
 }
 
 int
@@ -860,6 +1109,17 @@ log_walk_body_fn(struct log *log, struct log_offset *log_offset, const void *dpt
     }
     if (log_offset->lo_index <= ueh.ue_index) {
         len -= log_hdr_len(&ueh);
+#if MYNEWT_VAL(LOG_COMPRESS)
+        /* Callbacks see the entry as it was appended. */
+        if (ueh.ue_flags & LOG_FLAGS_COMPRESSED) {
+            rc = log_compress_body_len(log, dptr, &ueh);
+            if (rc < 0) {
+                return rc;
+            }
+            len = rc;
+            ueh.ue_flags &= ~LOG_FLAGS_COMPRESSED;
+        }
+#endif
 
         /* Pass the wrapped callback argument to the body walk function. */
         log_offset->lo_arg = lwba->arg;
@@ -917,6 +1177,38 @@ err:
     return rc;
 }
 
+int
+log_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                 struct log_offset *log_offset)
+{
+    if (!log->l_log->log_walk_reverse) {
+        return SYS_ENOTSUP;
+    }
+
+    return log->l_log->log_walk_reverse(log, walk_func, log_offset);
+}
+
+int
+log_walk_body_reverse(struct log *log, log_walk_body_func_t walk_body_func,
+                      struct log_offset *log_offset)
+{
+    struct log_walk_body_arg lwba = {
+        .fn = walk_body_func,
+        .arg = log_offset->lo_arg,
+    };
+    int rc;
+
+    if (!log->l_log->log_walk_reverse) {
+        return SYS_ENOTSUP;
+    }
+
+    log_offset->lo_arg = &lwba;
+    rc = log->l_log->log_walk_reverse(log, log_walk_body_fn, log_offset);
+    log_offset->lo_arg = lwba.arg;
+
+    return rc;
+}
+
 /**
  * Reads from the specified log.
  *
@@ -966,6 +1258,12 @@ log_read_body(struct log *log, const void *dptr, void *buf, uint16_t off,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    if (hdr.ue_flags & LOG_FLAGS_COMPRESSED) {
+        return log_compress_read_body(log, dptr, &hdr, buf, NULL, off, len);
+    }
+#endif
+
     return log_read(log, dptr, buf, log_hdr_len(&hdr) + off, len);
 }
 
@@ -996,6 +1294,15 @@ log_read_mbuf_body(struct log *log, const void *dptr, struct os_mbuf *om,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    if (hdr.ue_flags & LOG_FLAGS_COMPRESSED) {
+        if (!om) {
+            return 0;
+        }
+        return log_compress_read_body(log, dptr, &hdr, NULL, om, off, len);
+    }
+#endif
+
     return log_read_mbuf(log, dptr, om, log_hdr_len(&hdr) + off, len);
 }
 
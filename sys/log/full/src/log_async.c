@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_ASYNC)
+
+#include <assert.h>
+#include <string.h>
+
+#include "log/log.h"
+
+/*
+ * Staging ring for asynchronous logs.
+ *
+ * Each queued entry is a log_async_rec followed by the entry (header and
+ * body), padded to pointer alignment. Space is reserved inside a short
+ * critical section; the entry is then copied without holding any lock and
+ * marked ready. The log task drains ready records in order and writes them
+ * to the backing handler. A record never wraps: if it does not fit in the
+ * space left at the end of the buffer, that space is skipped.
+ */
+
+#define LOG_ASYNC_BUF_SIZE      MYNEWT_VAL(LOG_ASYNC_BUF_SIZE)
+
+#define LOG_ASYNC_F_READY       0x01
+#define LOG_ASYNC_F_SKIP        0x02
+
+struct log_async_rec {
+    struct log *lar_log;
+    uint16_t lar_len;
+    volatile uint8_t lar_flags;
+};
+
+#define LOG_ASYNC_REC_SIZE(len) \
+    OS_ALIGN(sizeof(struct log_async_rec) + (len), sizeof(void *))
+
+static uint8_t log_async_buf[LOG_ASYNC_BUF_SIZE]
+    __attribute__((aligned(sizeof(void *))));
+static uint32_t log_async_head;
+static uint32_t log_async_tail;
+static volatile uint32_t log_async_used;
+static uint32_t log_async_max_used;
+static uint32_t log_async_drops;
+
+static struct os_mutex log_async_mtx;
+static struct os_eventq log_async_evq;
+static struct os_task log_async_task;
+OS_TASK_STACK_DEFINE(log_async_stack, MYNEWT_VAL(LOG_ASYNC_STACK_SIZE));
+
+static void log_async_event_cb(struct os_event *ev);
+
+static struct os_event log_async_ev = {
+    .ev_cb = log_async_event_cb,
+};
+
+void *
+log_async_reserve(struct log *log, uint16_t len)
+{
+    struct log_async_rec *rec;
+    struct log_async_rec *skip;
+    uint32_t contig;
+    uint32_t pad;
+    uint32_t size;
+    os_sr_t sr;
+
+    size = LOG_ASYNC_REC_SIZE(len);
+    if (size > LOG_ASYNC_BUF_SIZE) {
+        return NULL;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    contig = LOG_ASYNC_BUF_SIZE - log_async_head;
+    pad = contig < size ? contig : 0;
+    if (log_async_used + pad + size > LOG_ASYNC_BUF_SIZE) {
+        log_async_drops++;
+        OS_EXIT_CRITICAL(sr);
+        return NULL;
+    }
+
+    if (pad != 0) {
+        if (pad >= sizeof(*skip)) {
+            skip = (struct log_async_rec *)&log_async_buf[log_async_head];
+            skip->lar_flags = LOG_ASYNC_F_SKIP;
+        }
+        log_async_head = 0;
+    }
+
+    rec = (struct log_async_rec *)&log_async_buf[log_async_head];
+    rec->lar_log = log;
+    rec->lar_len = len;
+    rec->lar_flags = 0;
+
+    log_async_head += size;
+    if (log_async_head == LOG_ASYNC_BUF_SIZE) {
+        log_async_head = 0;
+    }
+    log_async_used += pad + size;
+    if (log_async_used > log_async_max_used) {
+        log_async_max_used = log_async_used;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rec + 1;
+}
+
+void
+log_async_commit(void *entry)
+{
+    struct log_async_rec *rec;
+
+    rec = (struct log_async_rec *)entry - 1;
+
+    /* Entry contents must be visible before the ready flag. */
+    __asm__ volatile ("" ::: "memory");
+    rec->lar_flags = LOG_ASYNC_F_READY;
+
+    os_eventq_put(&log_async_evq, &log_async_ev);
+}
+
+static void
+log_async_release(uint32_t size)
+{
+    os_sr_t sr;
+
+    log_async_tail += size;
+    if (log_async_tail == LOG_ASYNC_BUF_SIZE) {
+        log_async_tail = 0;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    log_async_used -= size;
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+log_async_flush(void)
+{
+    struct log_async_rec *rec;
+    uint32_t contig;
+    int cnt;
+
+    cnt = 0;
+
+    os_mutex_pend(&log_async_mtx, OS_TIMEOUT_NEVER);
+
+    while (log_async_used != 0) {
+        contig = LOG_ASYNC_BUF_SIZE - log_async_tail;
+        rec = (struct log_async_rec *)&log_async_buf[log_async_tail];
+        if (contig < sizeof(*rec) || rec->lar_flags & LOG_ASYNC_F_SKIP) {
+            log_async_release(contig);
+            continue;
+        }
+
+        if (!(rec->lar_flags & LOG_ASYNC_F_READY)) {
+            /* Still being copied; its commit will wake the task again. */
+            break;
+        }
+
+        log_append_staged(rec->lar_log, rec + 1, rec->lar_len);
+        log_async_release(LOG_ASYNC_REC_SIZE(rec->lar_len));
+        cnt++;
+    }
+
+    os_mutex_release(&log_async_mtx);
+
+    return cnt;
+}
+
+void
+log_async_info_get(struct log_async_info *info)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    info->lai_size = LOG_ASYNC_BUF_SIZE;
+    info->lai_used = log_async_used;
+    info->lai_max_used = log_async_max_used;
+    info->lai_drops = log_async_drops;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+log_async_event_cb(struct os_event *ev)
+{
+    log_async_flush();
+}
+
+static void
+log_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&log_async_evq);
+    }
+}
+
+void
+log_async_init(void)
+{
+    int rc;
+
+    log_async_head = 0;
+    log_async_tail = 0;
+    log_async_used = 0;
+    log_async_max_used = 0;
+    log_async_drops = 0;
+
+    os_mutex_init(&log_async_mtx);
+    os_eventq_init(&log_async_evq);
+
+    rc = os_task_init(&log_async_task, "log", log_async_task_handler, NULL,
+                      MYNEWT_VAL(LOG_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      log_async_stack, MYNEWT_VAL(LOG_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif
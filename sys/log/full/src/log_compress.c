@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_COMPRESS)
+
+#include <string.h>
+
+#include "lz4/lz4.h"
+#include "log/log.h"
+
+/*
+ * Per-entry compression of storage log bodies.
+ *
+ * A compressed body is the length of the original body, two bytes little
+ * endian, followed by an LZ4 block; the entry header has
+ * LOG_FLAGS_COMPRESSED set.  Bodies are only stored compressed when that
+ * makes them smaller.  Readers get the original body back through
+ * log_read_body() and friends; the entry decompressed last is kept, so
+ * reading a body piecewise decompresses it once.
+ */
+
+#define LOG_COMPRESS_MAX_LEN    MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)
+#define LOG_COMPRESS_PREFIX_LEN 2
+
+static uint16_t log_compress_work[LZ4_WORK_SIZE / sizeof(uint16_t)];
+
+/* Compressed body being written or read. */
+static uint8_t log_compress_buf[LOG_COMPRESS_PREFIX_LEN +
+                                LOG_COMPRESS_MAX_LEN];
+
+/* Last decompressed body; also used to flatten mbuf bodies for writing. */
+static uint8_t log_compress_cache[LOG_COMPRESS_MAX_LEN];
+static struct log *log_compress_cache_log;
+static uint32_t log_compress_cache_idx;
+static int64_t log_compress_cache_ts;
+static uint16_t log_compress_cache_len;
+
+static struct os_mutex log_compress_mtx;
+
+void
+log_compress_init(void)
+{
+    os_mutex_init(&log_compress_mtx);
+}
+
+int
+log_compress_append(struct log *log, struct log_entry_hdr *hdr,
+                    const void *body, struct os_mbuf *om, uint16_t off,
+                    uint16_t len)
+{
+    int clen;
+    int rc;
+
+    if (log->l_log->log_type != LOG_TYPE_STORAGE ||
+        !log->l_log->log_append_body ||
+        len < MYNEWT_VAL(LOG_COMPRESS_MIN_LEN) ||
+        len > LOG_COMPRESS_MAX_LEN) {
+        return SYS_ENOTSUP;
+    }
+
+    os_mutex_pend(&log_compress_mtx, OS_WAIT_FOREVER);
+
+    if (om != NULL) {
+        log_compress_cache_log = NULL;
+        rc = os_mbuf_copydata(om, off, len, log_compress_cache);
+        if (rc != 0) {
+            rc = SYS_ENOTSUP;
+            goto done;
+        }
+        body = log_compress_cache;
+    }
+
+    /* Only keep the compressed body if it is smaller. */
+    clen = lz4_compress(body, len, log_compress_buf + LOG_COMPRESS_PREFIX_LEN,
+                        len - LOG_COMPRESS_PREFIX_LEN - 1, log_compress_work);
+    if (clen < 0) {
+        rc = SYS_ENOTSUP;
+        goto done;
+    }
+    log_compress_buf[0] = len;
+    log_compress_buf[1] = len >> 8;
+
+    hdr->ue_flags |= LOG_FLAGS_COMPRESSED;
+    rc = log->l_log->log_append_body(log, hdr, log_compress_buf,
+                                     LOG_COMPRESS_PREFIX_LEN + clen);
+
+done:
+    os_mutex_release(&log_compress_mtx);
+    return rc;
+}
+
+int
+log_compress_body_len(struct log *log, const void *dptr,
+                      const struct log_entry_hdr *hdr)
+{
+    uint8_t prefix[LOG_COMPRESS_PREFIX_LEN];
+    int rc;
+
+    rc = log_read(log, dptr, prefix, log_hdr_len(hdr), sizeof(prefix));
+    if (rc != sizeof(prefix)) {
+        return SYS_EIO;
+    }
+
+    return prefix[0] | (prefix[1] << 8);
+}
+
+/*
+ * Makes log_compress_cache hold the decompressed body of the given entry.
+ */
+static int
+log_compress_load(struct log *log, const void *dptr,
+                  const struct log_entry_hdr *hdr)
+{
+    uint16_t len;
+    int clen;
+    int rc;
+
+    if (log_compress_cache_log == log &&
+        log_compress_cache_idx == hdr->ue_index &&
+        log_compress_cache_ts == hdr->ue_ts) {
+        return 0;
+    }
+    log_compress_cache_log = NULL;
+
+    clen = log_read(log, dptr, log_compress_buf, log_hdr_len(hdr),
+                    sizeof(log_compress_buf));
+    if (clen < LOG_COMPRESS_PREFIX_LEN) {
+        return SYS_EIO;
+    }
+    len = log_compress_buf[0] | (log_compress_buf[1] << 8);
+    if (len > LOG_COMPRESS_MAX_LEN) {
+        return SYS_EIO;
+    }
+
+    rc = lz4_decompress(log_compress_buf + LOG_COMPRESS_PREFIX_LEN,
+                        clen - LOG_COMPRESS_PREFIX_LEN,
+                        log_compress_cache, len);
+    if (rc != len) {
+        return SYS_EIO;
+    }
+
+    log_compress_cache_log = log;
+    log_compress_cache_idx = hdr->ue_index;
+    log_compress_cache_ts = hdr->ue_ts;
+    log_compress_cache_len = len;
+
+    return 0;
+}
+
+int
+log_compress_read_body(struct log *log, const void *dptr,
+                       const struct log_entry_hdr *hdr, void *buf,
+                       struct os_mbuf *om, uint16_t off, uint16_t len)
+{
+    int rc;
+
+    os_mutex_pend(&log_compress_mtx, OS_WAIT_FOREVER);
+
+    rc = log_compress_load(log, dptr, hdr);
+    if (rc != 0) {
+        goto done;
+    }
+
+    if (off >= log_compress_cache_len) {
+        rc = 0;
+        goto done;
+    }
+    if (len > log_compress_cache_len - off) {
+        len = log_compress_cache_len - off;
+    }
+
+    if (om != NULL) {
+        rc = os_mbuf_append(om, log_compress_cache + off, len);
+        if (rc != 0) {
+            rc = 0;
+            goto done;
+        }
+    } else {
+        memcpy(buf, log_compress_cache + off, len);
+    }
+    rc = len;
+
+done:
+    os_mutex_release(&log_compress_mtx);
+    return rc;
+}
+
+#endif
@@ -160,6 +160,17 @@ log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
         log_console_print_hdr(hdr);
     }
 
+#if MYNEWT_VAL(LOG_DICT)
+    if (hdr->ue_etype == LOG_ETYPE_DICT) {
+        char buf[LOG_PRINTF_MAX_ENTRY_LEN];
+        int len;
+
+        len = log_dict_render(body, body_len, buf, sizeof buf);
+        console_write(buf, len);
+        return (0);
+    }
+#endif
+
     if (hdr->ue_etype != LOG_ETYPE_CBOR) {
         console_write(body, body_len);
     } else {
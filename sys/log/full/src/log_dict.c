@@ -0,0 +1,445 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_DICT)
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log/log.h"
+
+/*
+ * Dictionary entry body:
+ *
+ *     [format string address (uintptr_t)] [arg] [arg] ...
+ *
+ * Arguments follow in format string order, unaligned, in the target's byte
+ * order and at their C type's size: int; long, size_t, ptrdiff_t and
+ * pointers at word size; long long and intmax_t at 8 bytes; floating point
+ * as double.  A '*' width or precision is stored as an int before its
+ * argument.  Strings are copied inline and NUL-terminated.  If the buffer
+ * fills up, the remaining arguments are omitted.
+ */
+
+enum log_dict_arg {
+    LOG_DICT_ARG_NONE,
+    LOG_DICT_ARG_INT,
+    LOG_DICT_ARG_LONG,
+    LOG_DICT_ARG_LLONG,
+    LOG_DICT_ARG_INTMAX,
+    LOG_DICT_ARG_SIZE,
+    LOG_DICT_ARG_PTRDIFF,
+    LOG_DICT_ARG_PTR,
+    LOG_DICT_ARG_DOUBLE,
+    LOG_DICT_ARG_STR,
+    /* %n; the pointer is consumed but not stored. */
+    LOG_DICT_ARG_SKIP,
+};
+
+/**
+ * Parses the conversion specification following a '%'.
+ *
+ * @param spec                  Points just past the '%'.
+ * @param out_arg               On success, the argument type.
+ * @param out_stars             On success, the number of '*' fields.
+ *
+ * @return                      Points just past the conversion character.
+ */
+static const char *
+log_dict_parse_spec(const char *spec, enum log_dict_arg *out_arg,
+                    int *out_stars)
+{
+    int longs;
+    int stars;
+    char m;
+
+    stars = 0;
+
+    /* Flags, width and precision. */
+    while (*spec != '\0' && strchr("-+ #0123456789.*", *spec) != NULL) {
+        if (*spec == '*') {
+            stars++;
+        }
+        spec++;
+    }
+
+    /* Length modifier. */
+    longs = 0;
+    m = '\0';
+    while (*spec != '\0' && strchr("hlLjzt", *spec) != NULL) {
+        if (*spec == 'l') {
+            longs++;
+        }
+        m = *spec++;
+    }
+
+    *out_stars = stars;
+
+    switch (*spec) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+        if (longs >= 2) {
+            *out_arg = LOG_DICT_ARG_LLONG;
+        } else if (longs == 1) {
+            *out_arg = LOG_DICT_ARG_LONG;
+        } else if (m == 'j') {
+            *out_arg = LOG_DICT_ARG_INTMAX;
+        } else if (m == 'z') {
+            *out_arg = LOG_DICT_ARG_SIZE;
+        } else if (m == 't') {
+            *out_arg = LOG_DICT_ARG_PTRDIFF;
+        } else {
+            *out_arg = LOG_DICT_ARG_INT;
+        }
+        break;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        *out_arg = LOG_DICT_ARG_DOUBLE;
+        break;
+
+    case 's':
+        *out_arg = LOG_DICT_ARG_STR;
+        break;
+
+    case 'p':
+        *out_arg = LOG_DICT_ARG_PTR;
+        break;
+
+    case 'n':
+        *out_arg = LOG_DICT_ARG_SKIP;
+        break;
+
+    case '\0':
+        *out_arg = LOG_DICT_ARG_NONE;
+        return spec;
+
+    default:
+        /* "%%" or unknown; no argument. */
+        *out_arg = LOG_DICT_ARG_NONE;
+        break;
+    }
+
+    return spec + 1;
+}
+
+struct log_dict_buf {
+    uint8_t *ldb_data;
+    int ldb_len;
+    int ldb_off;
+    bool ldb_full;
+};
+
+static void
+log_dict_put(struct log_dict_buf *b, const void *val, int len)
+{
+    if (b->ldb_full || b->ldb_off + len > b->ldb_len) {
+        b->ldb_full = true;
+        return;
+    }
+
+    memcpy(b->ldb_data + b->ldb_off, val, len);
+    b->ldb_off += len;
+}
+
+static void
+log_dict_put_str(struct log_dict_buf *b, const char *s)
+{
+    int len;
+
+    if (b->ldb_full) {
+        return;
+    }
+
+    if (s == NULL) {
+        s = "(null)";
+    }
+
+    /* Truncate to the space left, keeping the terminator. */
+    len = strlen(s);
+    if (len >= b->ldb_len - b->ldb_off) {
+        len = b->ldb_len - b->ldb_off - 1;
+        b->ldb_full = true;
+    }
+    if (len < 0) {
+        b->ldb_full = true;
+        return;
+    }
+
+    memcpy(b->ldb_data + b->ldb_off, s, len);
+    b->ldb_data[b->ldb_off + len] = '\0';
+    b->ldb_off += len + 1;
+}
+
+int
+log_dict_vencode(void *buf, int len, const char *fmt, va_list args)
+{
+    struct log_dict_buf b;
+    enum log_dict_arg arg;
+    uintptr_t addr;
+    int stars;
+    union {
+        int i;
+        long l;
+        long long ll;
+        intmax_t j;
+        size_t z;
+        ptrdiff_t t;
+        void *p;
+        double d;
+    } v;
+
+    b.ldb_data = buf;
+    b.ldb_len = len;
+    b.ldb_off = 0;
+    b.ldb_full = false;
+
+    addr = (uintptr_t)fmt;
+    log_dict_put(&b, &addr, sizeof addr);
+    if (b.ldb_full) {
+        return -1;
+    }
+
+    while (*fmt != '\0') {
+        if (*fmt++ != '%') {
+            continue;
+        }
+
+        fmt = log_dict_parse_spec(fmt, &arg, &stars);
+
+        while (stars-- > 0) {
+            v.i = va_arg(args, int);
+            log_dict_put(&b, &v.i, sizeof v.i);
+        }
+
+        switch (arg) {
+        case LOG_DICT_ARG_INT:
+            v.i = va_arg(args, int);
+            log_dict_put(&b, &v.i, sizeof v.i);
+            break;
+        case LOG_DICT_ARG_LONG:
+            v.l = va_arg(args, long);
+            log_dict_put(&b, &v.l, sizeof v.l);
+            break;
+        case LOG_DICT_ARG_LLONG:
+            v.ll = va_arg(args, long long);
+            log_dict_put(&b, &v.ll, sizeof v.ll);
+            break;
+        case LOG_DICT_ARG_INTMAX:
+            v.j = va_arg(args, intmax_t);
+            log_dict_put(&b, &v.j, sizeof v.j);
+            break;
+        case LOG_DICT_ARG_SIZE:
+            v.z = va_arg(args, size_t);
+            log_dict_put(&b, &v.z, sizeof v.z);
+            break;
+        case LOG_DICT_ARG_PTRDIFF:
+            v.t = va_arg(args, ptrdiff_t);
+            log_dict_put(&b, &v.t, sizeof v.t);
+            break;
+        case LOG_DICT_ARG_PTR:
+            v.p = va_arg(args, void *);
+            log_dict_put(&b, &v.p, sizeof v.p);
+            break;
+        case LOG_DICT_ARG_DOUBLE:
+            v.d = va_arg(args, double);
+            log_dict_put(&b, &v.d, sizeof v.d);
+            break;
+        case LOG_DICT_ARG_STR:
+            log_dict_put_str(&b, va_arg(args, const char *));
+            break;
+        case LOG_DICT_ARG_SKIP:
+            (void)va_arg(args, void *);
+            break;
+        default:
+            break;
+        }
+
+        if (b.ldb_full) {
+            break;
+        }
+    }
+
+    return b.ldb_off;
+}
+
+static int
+log_dict_get(const uint8_t **p, const uint8_t *end, void *val, int len)
+{
+    if (end - *p < len) {
+        return -1;
+    }
+
+    memcpy(val, *p, len);
+    *p += len;
+
+    return 0;
+}
+
+int
+log_dict_render(const void *body, int body_len, char *buf, int len)
+{
+    enum log_dict_arg arg;
+    const uint8_t *end;
+    const uint8_t *p;
+    const char *spec;
+    const char *fmt;
+    uintptr_t addr;
+    char sfmt[24];
+    int slen;
+    int stars;
+    int off;
+    int rc;
+    int i;
+    union {
+        int i;
+        long l;
+        long long ll;
+        intmax_t j;
+        size_t z;
+        ptrdiff_t t;
+        void *p;
+        double d;
+    } v;
+
+    if (len <= 0) {
+        return 0;
+    }
+
+    p = body;
+    end = p + body_len;
+    if (log_dict_get(&p, end, &addr, sizeof addr) != 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+    fmt = (const char *)addr;
+
+    off = 0;
+    while (*fmt != '\0' && off < len - 1) {
+        if (*fmt != '%') {
+            buf[off++] = *fmt++;
+            continue;
+        }
+
+        spec = fmt++;
+        fmt = log_dict_parse_spec(fmt, &arg, &stars);
+
+        /*
+         * Copy the specification for snprintf(), replacing each '*' with
+         * the stored value.
+         */
+        slen = 0;
+        for (; spec < fmt && slen < sizeof sfmt - 12; spec++) {
+            if (*spec != '*') {
+                sfmt[slen++] = *spec;
+            } else if (log_dict_get(&p, end, &v.i, sizeof v.i) == 0) {
+                slen += sprintf(&sfmt[slen], "%d", v.i);
+            }
+        }
+        sfmt[slen] = '\0';
+
+        rc = -1;
+        switch (arg) {
+        case LOG_DICT_ARG_NONE:
+            rc = snprintf(buf + off, len - off, "%s",
+                          strcmp(sfmt, "%%") == 0 ? "%" : sfmt);
+            break;
+        case LOG_DICT_ARG_INT:
+            if (log_dict_get(&p, end, &v.i, sizeof v.i) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.i);
+            }
+            break;
+        case LOG_DICT_ARG_LONG:
+            if (log_dict_get(&p, end, &v.l, sizeof v.l) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.l);
+            }
+            break;
+        case LOG_DICT_ARG_LLONG:
+            if (log_dict_get(&p, end, &v.ll, sizeof v.ll) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.ll);
+            }
+            break;
+        case LOG_DICT_ARG_INTMAX:
+            if (log_dict_get(&p, end, &v.j, sizeof v.j) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.j);
+            }
+            break;
+        case LOG_DICT_ARG_SIZE:
+            if (log_dict_get(&p, end, &v.z, sizeof v.z) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.z);
+            }
+            break;
+        case LOG_DICT_ARG_PTRDIFF:
+            if (log_dict_get(&p, end, &v.t, sizeof v.t) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.t);
+            }
+            break;
+        case LOG_DICT_ARG_PTR:
+            if (log_dict_get(&p, end, &v.p, sizeof v.p) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.p);
+            }
+            break;
+        case LOG_DICT_ARG_DOUBLE:
+            if (log_dict_get(&p, end, &v.d, sizeof v.d) == 0) {
+                rc = snprintf(buf + off, len - off, sfmt, v.d);
+            }
+            break;
+        case LOG_DICT_ARG_STR:
+            for (i = 0; p + i < end && p[i] != '\0'; i++) {
+            }
+            if (p + i < end) {
+                rc = snprintf(buf + off, len - off, sfmt, (const char *)p);
+                p += i + 1;
+            }
+            break;
+        case LOG_DICT_ARG_SKIP:
+            rc = 0;
+            break;
+        }
+
+        if (rc < 0) {
+            /* Argument missing; the entry was truncated. */
+            rc = snprintf(buf + off, len - off, "<?>");
+        }
+        off += rc;
+        if (off >= len) {
+            off = len - 1;
+        }
+    }
+
+    buf[off] = '\0';
+
+    return off;
+}
+
+#endif
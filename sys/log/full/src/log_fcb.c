@@ -123,6 +123,10 @@ log_fcb_find_gte(struct log *log, struct log_offset *log_offset,
 {
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     const struct log_fcb_bmark *bmark;
+#endif
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    struct fcb_entry sidx_entry;
+    uint32_t sidx_index;
 #endif
     struct log_entry_hdr hdr;
     struct fcb_log *fcb_log;
@@ -169,6 +173,26 @@ log_fcb_find_gte(struct log *log, struct log_offset *log_offset,
     }
 #endif
 
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    /*
+     * Start from the sector index unless a bookmark is closer.  With a
+     * timestamp the sector may lie past the bookmark even when its first
+     * index does not.
+     */
+    if ((log_offset->lo_index != 0 || log_offset->lo_ts > 0) &&
+        log_fcb_sidx_find(log, log_offset, &sidx_entry, &sidx_index) == 0) {
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+        if (!bmark_found || sidx_index > bmark->lfb_index ||
+            log_offset->lo_ts > 0) {
+            *out_entry = sidx_entry;
+        }
+#else
+        *out_entry = sidx_entry;
+#endif
+        bmark_found = true;
+    }
+#endif
+
     /**
      * For non-zero indices, we walk back from the latest fe_area,
      * compare the ue_index with lo_index for the first entry of each
@@ -243,6 +267,9 @@ log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
         /* Notify upper layer that a rotation is about to occur */
         if (log->l_rotate_notify_cb != NULL) {
             fcb_append_to_scratch(fcb);
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+            log_fcb_sidx_clear(fcb_log);
+#endif
             log->l_rotate_notify_cb(log);
         }
 
@@ -250,6 +277,9 @@ log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
         /* The FCB needs to be rotated. */
         log_fcb_rotate_bmarks(fcb_log);
 #endif
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+        log_fcb_sidx_rotate(fcb_log);
+#endif
 
         rc = fcb_rotate(fcb);
         if (rc) {
@@ -371,6 +401,10 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    log_fcb_sidx_append(fcb_log, &loc, hdr);
+#endif
+
     return 0;
 }
 
@@ -456,6 +490,10 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    log_fcb_sidx_append(fcb_log, &loc, hdr);
+#endif
+
     return 0;
 }
 
@@ -639,6 +677,52 @@ log_fcb_walk_area(struct log *log, log_walk_func_t walk_func,
     return log_fcb_walk_impl(log, walk_func, log_offset, true);
 }
 
+/**
+ * Walks entries from the newest towards the oldest one.  Stops at the first
+ * entry with an index below log_offset->lo_index.
+ */
+static int
+log_fcb_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                     struct log_offset *log_offset)
+{
+    struct log_entry_hdr hdr;
+    struct fcb_log *fcb_log;
+    struct fcb_entry loc;
+    int rc;
+
+    fcb_log = log->l_arg;
+
+    /* NULL fe_area starts at the newest entry. */
+    memset(&loc, 0, sizeof(loc));
+    while (fcb_getprev(&fcb_log->fl_fcb, &loc) == 0) {
+        if (log_offset->lo_ts >= 0) {
+            rc = log_read_hdr(log, &loc, &hdr);
+            if (rc != 0) {
+                return rc;
+            }
+            if (hdr.ue_index < log_offset->lo_index) {
+                break;
+            }
+        }
+
+        rc = walk_func(log, log_offset, &loc, loc.fe_data_len);
+        if (rc != 0) {
+            if (rc < 0) {
+                return rc;
+            } else {
+                return 0;
+            }
+        }
+
+        /* A negative timestamp requests the newest entry only. */
+        if (log_offset->lo_ts < 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
 static int
 log_fcb_flush(struct log *log)
 {
@@ -651,6 +735,9 @@ log_fcb_flush(struct log *log)
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     log_fcb_clear_bmarks(fcb_log);
 #endif
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+    log_fcb_sidx_clear(fcb_log);
+#endif
 
     return fcb_clear(fcb);
 }
@@ -981,6 +1068,7 @@ const struct log_handler log_fcb_handler = {
     .log_append_mbuf_body = log_fcb_append_mbuf_body,
     .log_walk             = log_fcb_walk,
     .log_walk_sector      = log_fcb_walk_area,
+    .log_walk_reverse     = log_fcb_walk_reverse,
     .log_flush            = log_fcb_flush,
 #if MYNEWT_VAL(LOG_STORAGE_INFO)
     .log_storage_info     = log_fcb_storage_info,
@@ -516,6 +516,52 @@ log_fcb2_walk(struct log *log, log_walk_func_t walk_func,
     return 0;
 }
 
+/**
+ * Walks entries from the newest towards the oldest one.  Stops at the first
+ * entry with an index below log_offset->lo_index.
+ */
+static int
+log_fcb2_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                      struct log_offset *log_off)
+{
+    struct log_entry_hdr hdr;
+    struct fcb_log *fcb_log;
+    struct fcb2_entry loc;
+    int rc;
+
+    fcb_log = log->l_arg;
+
+    /* NULL fe_range starts at the newest entry. */
+    memset(&loc, 0, sizeof(loc));
+    while (fcb2_getprev(&fcb_log->fl_fcb, &loc) == 0) {
+        if (log_off->lo_ts >= 0) {
+            rc = log_read_hdr(log, &loc, &hdr);
+            if (rc != 0) {
+                return rc;
+            }
+            if (hdr.ue_index < log_off->lo_index) {
+                break;
+            }
+        }
+
+        rc = walk_func(log, log_off, &loc, loc.fe_data_len);
+        if (rc != 0) {
+            if (rc < 0) {
+                return rc;
+            } else {
+                return 0;
+            }
+        }
+
+        /* A negative timestamp requests the newest entry only. */
+        if (log_off->lo_ts < 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
 static int
 log_fcb2_flush(struct log *log)
 {
@@ -894,6 +940,7 @@ const struct log_handler log_fcb_handler = {
     .log_append_mbuf = log_fcb2_append_mbuf,
     .log_append_mbuf_body = log_fcb2_append_mbuf_body,
     .log_walk = log_fcb2_walk,
+    .log_walk_reverse = log_fcb2_walk_reverse,
     .log_flush = log_fcb2_flush,
 #if MYNEWT_VAL(LOG_STORAGE_INFO)
     .log_storage_info = log_fcb2_storage_info,
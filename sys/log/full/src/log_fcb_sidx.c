@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_FCB_SECTOR_INDEX)
+
+#include "log/log.h"
+#include "log/log_fcb.h"
+
+int
+log_fcb_init_sector_index(struct fcb_log *fcb_log,
+                          struct log_fcb_sidx *buf, int sector_count)
+{
+    if (sector_count < fcb_log->fl_fcb.f_sector_cnt) {
+        return SYS_EINVAL;
+    }
+
+    fcb_log->fl_sidx = (struct log_fcb_sidx_set) {
+        .lfxs_sectors = buf,
+        .lfxs_cnt = fcb_log->fl_fcb.f_sector_cnt,
+    };
+
+    return 0;
+}
+
+void
+log_fcb_sidx_clear(struct fcb_log *fcb_log)
+{
+    fcb_log->fl_sidx.lfxs_built = 0;
+}
+
+static struct log_fcb_sidx *
+log_fcb_sidx_get(struct fcb_log *fcb_log, const struct flash_area *fap)
+{
+    return &fcb_log->fl_sidx.lfxs_sectors[fap - fcb_log->fl_fcb.f_sectors];
+}
+
+static struct flash_area *
+log_fcb_sidx_next_area(const struct fcb *fcb, struct flash_area *fap)
+{
+    if (fap == &fcb->f_sectors[fcb->f_sector_cnt - 1]) {
+        return &fcb->f_sectors[0];
+    }
+
+    return fap + 1;
+}
+
+void
+log_fcb_sidx_rotate(struct fcb_log *fcb_log)
+{
+    if (fcb_log->fl_sidx.lfxs_built) {
+        log_fcb_sidx_get(fcb_log, fcb_log->fl_fcb.f_oldest)->lfx_valid = 0;
+    }
+}
+
+void
+log_fcb_sidx_append(struct fcb_log *fcb_log, const struct fcb_entry *loc,
+                    const struct log_entry_hdr *hdr)
+{
+    struct log_fcb_sidx *sidx;
+
+    if (!fcb_log->fl_sidx.lfxs_built) {
+        return;
+    }
+
+    sidx = log_fcb_sidx_get(fcb_log, loc->fe_area);
+    if (!sidx->lfx_valid) {
+        /* First entry in this sector. */
+        sidx->lfx_index = hdr->ue_index;
+        sidx->lfx_ts = hdr->ue_ts;
+        sidx->lfx_valid = 1;
+    }
+}
+
+/**
+ * Reads the first entry of each sector in use.
+ */
+static int
+log_fcb_sidx_build(struct log *log, struct fcb_log *fcb_log)
+{
+    struct log_entry_hdr hdr;
+    struct log_fcb_sidx *sidx;
+    struct fcb_entry entry;
+    struct flash_area *fap;
+    struct fcb *fcb;
+    int rc;
+    int i;
+
+    fcb = &fcb_log->fl_fcb;
+
+    for (i = 0; i < fcb_log->fl_sidx.lfxs_cnt; i++) {
+        fcb_log->fl_sidx.lfxs_sectors[i].lfx_valid = 0;
+    }
+
+    fap = fcb->f_oldest;
+    while (1) {
+        memset(&entry, 0, sizeof entry);
+        entry.fe_area = fap;
+        rc = fcb_getnext(fcb, &entry);
+        if (rc == 0 && entry.fe_area == fap) {
+            rc = log_read_hdr(log, &entry, &hdr);
+            if (rc != 0) {
+                return rc;
+            }
+
+            sidx = log_fcb_sidx_get(fcb_log, fap);
+            sidx->lfx_index = hdr.ue_index;
+            sidx->lfx_ts = hdr.ue_ts;
+            sidx->lfx_valid = 1;
+        }
+
+        if (fap == fcb->f_active.fe_area) {
+            break;
+        }
+        fap = log_fcb_sidx_next_area(fcb, fap);
+    }
+
+    fcb_log->fl_sidx.lfxs_built = 1;
+
+    return 0;
+}
+
+int
+log_fcb_sidx_find(struct log *log, const struct log_offset *log_offset,
+                  struct fcb_entry *out_entry, uint32_t *out_index)
+{
+    const struct log_fcb_sidx *sidx;
+    struct flash_area *best;
+    struct flash_area *fap;
+    struct fcb_log *fcb_log;
+    struct fcb *fcb;
+    bool ts_usable;
+    int64_t prev_ts;
+    int rc;
+
+    fcb_log = log->l_arg;
+    fcb = &fcb_log->fl_fcb;
+
+    if (fcb_log->fl_sidx.lfxs_cnt == 0 || fcb->f_active.fe_area == NULL) {
+        return SYS_ENOENT;
+    }
+
+    if (!fcb_log->fl_sidx.lfxs_built) {
+        rc = log_fcb_sidx_build(log, fcb_log);
+        if (rc != 0) {
+            return SYS_ENOENT;
+        }
+    }
+
+    /*
+     * Sectors can only be skipped by timestamp if timestamps increase from
+     * sector to sector; a clock change makes them unusable.
+     */
+    ts_usable = log_offset->lo_ts > 0;
+    prev_ts = INT64_MIN;
+    fap = fcb->f_oldest;
+    while (ts_usable) {
+        sidx = log_fcb_sidx_get(fcb_log, fap);
+        if (sidx->lfx_valid) {
+            if (sidx->lfx_ts < prev_ts) {
+                ts_usable = false;
+            }
+            prev_ts = sidx->lfx_ts;
+        }
+
+        if (fap == fcb->f_active.fe_area) {
+            break;
+        }
+        fap = log_fcb_sidx_next_area(fcb, fap);
+    }
+
+    /*
+     * Pick the latest sector whose first entry comes at or before the
+     * requested index or strictly before the requested timestamp; no
+     * earlier sector can hold a requested entry.
+     */
+    best = NULL;
+    fap = fcb->f_oldest;
+    while (1) {
+        sidx = log_fcb_sidx_get(fcb_log, fap);
+        if (sidx->lfx_valid) {
+            if (best != NULL && sidx->lfx_index > log_offset->lo_index &&
+                (!ts_usable || sidx->lfx_ts >= log_offset->lo_ts)) {
+                break;
+            }
+            best = fap;
+        }
+
+        if (fap == fcb->f_active.fe_area) {
+            break;
+        }
+        fap = log_fcb_sidx_next_area(fcb, fap);
+    }
+
+    if (best == NULL) {
+        return SYS_ENOENT;
+    }
+
+    sidx = log_fcb_sidx_get(fcb_log, best);
+    memset(out_entry, 0, sizeof *out_entry);
+    out_entry->fe_area = best;
+    rc = fcb_getnext(fcb, out_entry);
+    if (rc != 0) {
+        return SYS_ENOENT;
+    }
+    *out_index = sidx->lfx_index;
+
+    return 0;
+}
+
+#endif
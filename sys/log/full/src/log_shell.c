@@ -101,6 +101,145 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     return 0;
 }
 
+static bool
+shell_log_selected(const struct log *log, const char *log_name,
+                   bool partial_match)
+{
+    if (log->l_log->log_type == LOG_TYPE_STREAM) {
+        return false;
+    }
+    if (log_name == NULL) {
+        return true;
+    }
+    if (partial_match) {
+        return log->l_name == strstr(log->l_name, log_name);
+    }
+    return strcmp(log->l_name, log_name) == 0;
+}
+
+static uint32_t
+shell_log_first_index(struct log *log, uint32_t log_limit)
+{
+    uint32_t log_last_index;
+
+    log_last_index = log_get_last_index(log);
+    if (log_limit == 0 || log_last_index < log_limit) {
+        return 0;
+    }
+    return log_last_index - log_limit;
+}
+
+#if MYNEWT_VAL(SHELL_STREAM)
+/* State of the dump being streamed; the command line is gone by the time
+ * the steps run, so the log name is copied.
+ */
+static struct {
+    struct log *log;
+    char name[MYNEWT_VAL(LOG_SHELL_NAME_MAX) + 1];
+    bool have_name;
+    bool partial_match;
+    uint32_t limit;
+    uint32_t next_index;
+    int left;
+} shell_log_dump;
+
+static int
+shell_log_dump_step_entry(struct log *log, struct log_offset *log_offset,
+                          const struct log_entry_hdr *ueh, const void *dptr,
+                          uint16_t len)
+{
+    int rc;
+
+    if (shell_log_dump.left == 0) {
+        return 1;
+    }
+
+    rc = shell_log_dump_entry(log, log_offset, ueh, dptr, len);
+    shell_log_dump.next_index = ueh->ue_index + 1;
+    shell_log_dump.left--;
+
+    return rc;
+}
+
+static void
+shell_log_dump_next_log(void)
+{
+    struct log *log;
+
+    log = shell_log_dump.log;
+    do {
+        log = log_list_get_next(log);
+    } while (log != NULL &&
+             !shell_log_selected(log, shell_log_dump.have_name ?
+                                      shell_log_dump.name : NULL,
+                                 shell_log_dump.partial_match));
+
+    shell_log_dump.log = log;
+    if (log != NULL) {
+        console_printf("Dumping log %s\n", log->l_name);
+        shell_log_dump.next_index =
+            shell_log_first_index(log, shell_log_dump.limit);
+    }
+}
+
+/* Dumps up to LOG_SHELL_STREAM_ENTRIES entries per step. */
+static int
+shell_log_dump_step(struct shell_stream *ss)
+{
+    struct log_offset log_offset;
+    int rc;
+
+    if (ss->ss_cursor == 0) {
+        ss->ss_cursor = 1;
+        shell_log_dump.log = NULL;
+        shell_log_dump_next_log();
+    }
+    if (shell_log_dump.log == NULL) {
+        return 0;
+    }
+
+    log_offset.lo_arg = NULL;
+    log_offset.lo_ts = 0;
+    log_offset.lo_index = shell_log_dump.next_index;
+    log_offset.lo_data_len = 0;
+    shell_log_dump.left = MYNEWT_VAL(LOG_SHELL_STREAM_ENTRIES);
+
+    rc = log_walk_body(shell_log_dump.log, shell_log_dump_step_entry,
+                       &log_offset);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (shell_log_dump.left != 0) {
+        /* Reached the end of this log. */
+        shell_log_dump_next_log();
+        if (shell_log_dump.log == NULL) {
+            return 0;
+        }
+    }
+
+    return SHELL_STREAM_MORE;
+}
+
+static int
+shell_log_dump_stream(const char *log_name, bool partial_match,
+                      uint32_t log_limit)
+{
+    shell_log_dump.have_name = log_name != NULL;
+    if (log_name != NULL) {
+        if (strlen(log_name) >= sizeof(shell_log_dump.name)) {
+            return SYS_EINVAL;
+        }
+        strcpy(shell_log_dump.name, log_name);
+    }
+    shell_log_dump.partial_match = partial_match;
+    shell_log_dump.limit = log_limit;
+
+    return shell_stream_start(shell_log_dump_step, NULL,
+                              streamer_console_get());
+}
+#endif
+
 int
 shell_log_dump_cmd(int argc, char **argv)
 {
@@ -108,7 +247,6 @@ shell_log_dump_cmd(int argc, char **argv)
     struct log_offset log_offset;
     bool list_only = false;
     char *log_name = NULL;
-    uint32_t log_last_index = 0;
     uint32_t log_limit = 0;
     bool stream;
     bool partial_match = false;
@@ -140,6 +278,12 @@ shell_log_dump_cmd(int argc, char **argv)
         }
     }
 
+#if MYNEWT_VAL(SHELL_STREAM)
+    if (!list_only && !clear_log) {
+        return shell_log_dump_stream(log_name, partial_match, log_limit);
+    }
+#endif
+
     log = NULL;
     while (1) {
         log = log_list_get_next(log);
@@ -155,9 +299,7 @@ shell_log_dump_cmd(int argc, char **argv)
             continue;
         }
 
-        if (stream ||
-            (log_name != NULL && ((partial_match && (log->l_name != strstr(log->l_name, log_name))) ||
-                                  (!partial_match && 0 != strcmp(log->l_name, log_name))))) {
+        if (!shell_log_selected(log, log_name, partial_match)) {
             continue;
         }
 
@@ -172,12 +314,7 @@ shell_log_dump_cmd(int argc, char **argv)
 
             log_offset.lo_arg = NULL;
             log_offset.lo_ts = 0;
-            log_last_index = log_get_last_index(log);
-            if (log_limit == 0 || log_last_index < log_limit) {
-                log_offset.lo_index = 0;
-            } else {
-                log_offset.lo_index = log_last_index - log_limit;
-            }
+            log_offset.lo_index = shell_log_first_index(log, log_limit);
             log_offset.lo_data_len = 0;
 
             rc = log_walk_body(log, shell_log_dump_entry, &log_offset);
@@ -37,6 +37,8 @@
  *       optional set of default logs.
  *     o Minimum log level per mapping.  Writes specifying a log level less
  *       than the module's minimum level are discarded.
+ *     o Optional per-module rate limits and sampling (MODLOG_RATE_LIMIT),
+ *       which bound the cost of a noisy module.
  *
  * Costs of using modlog rather than the bare `sys/log` facility are:
  *     o Increased RAM usage (`MODLOG_MAX_MAPPINGS` * 12).
@@ -84,6 +86,27 @@ struct modlog_desc {
  */
 typedef int modlog_foreach_fn(const struct modlog_desc *desc, void *arg);
 
+/**
+ * @brief Rate limit applied to all writes to a module.
+ *
+ * A write is suppressed if it is not 1 in `sample`, or if the module has
+ * used up its token bucket of `burst` messages refilled at `rate` messages
+ * per second.  Writes that no mapping would accept anyway because of their
+ * level do not count against the limit.
+ */
+struct modlog_rate_cfg {
+    /** Sustained messages per second; 0 for no token bucket. */
+    uint16_t rate;
+
+    /** Messages that may be written back to back; at least 1 if `rate`
+     *  is set.
+     */
+    uint16_t burst;
+
+    /** Only one in this many messages is written; 0 or 1 to write all. */
+    uint16_t sample;
+};
+
 /* Only enable modlog if logging is also enabled. */
 #if MYNEWT_VAL(LOG_FULL) || defined(__DOXYGEN__)
 
@@ -202,6 +225,58 @@ void modlog_printf(uint8_t module, uint8_t level, const char *msg, ...);
 void modlog_hexdump(uint8_t module, uint8_t level,
                     const void *data_ptr, uint16_t len, uint16_t line_break);
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT) || defined(__DOXYGEN__)
+
+/**
+ * @brief Sets or removes the rate limit of a module.
+ *
+ * Setting a limit resets the module's token bucket and sample counter; the
+ * count of suppressed messages is kept.
+ *
+ * @param module                The module to limit.
+ * @param cfg                   The limit to apply; NULL to remove the
+ *                                  module's limit.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the module or limit is
+ *                                  invalid;
+ *                              SYS_ENOMEM if MODLOG_MAX_RATE_LIMITS modules
+ *                                  already have a limit;
+ *                              SYS_ENOENT if removing a limit that is not
+ *                                  set.
+ */
+int modlog_set_rate(uint8_t module, const struct modlog_rate_cfg *cfg);
+
+/**
+ * @brief Retrieves the rate limit of a module.
+ *
+ * @param module                The module to look up.
+ * @param out_cfg               On success, the module's limit is written
+ *                                  here.  Pass NULL if you do not require
+ *                                  this information.
+ * @param out_suppressed        On success, the number of messages
+ *                                  suppressed since the last summary is
+ *                                  written here.  Pass NULL if you do not
+ *                                  require this information.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOENT if the module has no limit.
+ */
+int modlog_get_rate(uint8_t module, struct modlog_rate_cfg *out_cfg,
+                    uint32_t *out_suppressed);
+
+/**
+ * @brief Writes a summary of suppressed messages.
+ *
+ * For each rate limited module that suppressed messages since the last
+ * summary, writes a warning with the count to the module and resets the
+ * count.  The summary itself is not subject to the limit.  Called every
+ * MODLOG_RATE_SUMMARY_PERIOD_MS if that is nonzero.
+ */
+void modlog_rate_summary(void);
+
+#endif
+
 #else /* LOG_FULL */
 
 static inline int
@@ -257,6 +332,25 @@ modlog_hexdump(uint8_t module, uint8_t level,
                const void *data_ptr, uint16_t len, uint16_t line_break)
 {  }
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+static inline int
+modlog_set_rate(uint8_t module, const struct modlog_rate_cfg *cfg)
+{
+    return SYS_ENOTSUP;
+}
+
+static inline int
+modlog_get_rate(uint8_t module, struct modlog_rate_cfg *out_cfg,
+                uint32_t *out_suppressed)
+{
+    return SYS_ENOTSUP;
+}
+
+static inline void
+modlog_rate_summary(void)
+{ }
+#endif
+
 #endif
 
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG || defined __DOXYGEN__
@@ -27,6 +27,9 @@ TEST_SUITE(modlog_test_suite_all)
     modlog_test_case_printf();
     modlog_test_case_prio_flat();
     modlog_test_case_prio_mbuf();
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    modlog_test_case_rate();
+#endif
 }
 
 int
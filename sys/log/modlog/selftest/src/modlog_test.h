@@ -32,5 +32,6 @@ TEST_CASE_DECL(modlog_test_case_basic);
 TEST_CASE_DECL(modlog_test_case_printf);
 TEST_CASE_DECL(modlog_test_case_prio_flat);
 TEST_CASE_DECL(modlog_test_case_prio_mbuf);
+TEST_CASE_DECL(modlog_test_case_rate);
 
 #endif
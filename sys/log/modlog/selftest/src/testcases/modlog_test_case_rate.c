@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+
+static void
+mltcr_append_n(uint8_t level, int count, bool use_mbufs)
+{
+    uint8_t buf[1] = { 0 };
+    int i;
+
+    for (i = 0; i < count; i++) {
+        mltu_append(1, level, LOG_ETYPE_STRING, buf, 1, use_mbufs);
+    }
+}
+
+static uint32_t
+mltcr_suppressed(void)
+{
+    uint32_t suppressed;
+    int rc;
+
+    rc = modlog_get_rate(1, NULL, &suppressed);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return suppressed;
+}
+
+TEST_CASE_SELF(modlog_test_case_rate)
+{
+    struct modlog_rate_cfg cfg;
+    struct mltu_log_arg mla;
+    struct log log;
+    const char *exp;
+    int rc;
+    int i;
+
+    memset(&mla, 0, sizeof mla);
+    mltu_register_log(&log, &mla, "log", 0);
+
+    rc = modlog_register(1, &log, 1, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Invalid limits are rejected. */
+    cfg = (struct modlog_rate_cfg) { .rate = 1, .burst = 0 };
+    TEST_ASSERT(modlog_set_rate(1, &cfg) == SYS_EINVAL);
+    cfg = (struct modlog_rate_cfg) { .rate = 1, .burst = 3 };
+    TEST_ASSERT(modlog_set_rate(MODLOG_MODULE_DFLT, &cfg) == SYS_EINVAL);
+    TEST_ASSERT(modlog_set_rate(1, NULL) == SYS_ENOENT);
+    TEST_ASSERT(modlog_get_rate(1, NULL, NULL) == SYS_ENOENT);
+
+    /*** A full bucket lets a burst through, then suppresses. */
+    rc = modlog_set_rate(1, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltcr_append_n(1, 5, false);
+    mltcr_append_n(1, 5, true);
+    TEST_ASSERT(mla.num_entries == 3);
+    TEST_ASSERT(mltcr_suppressed() == 7);
+
+    /* Writes discarded by level do not use up the limit. */
+    mltcr_append_n(0, 5, false);
+    TEST_ASSERT(mla.num_entries == 3);
+    TEST_ASSERT(mltcr_suppressed() == 7);
+
+    /* The bucket refills at the configured rate. */
+    os_time_advance(2 * OS_TICKS_PER_SEC);
+    mltcr_append_n(1, 5, false);
+    TEST_ASSERT(mla.num_entries == 5);
+    TEST_ASSERT(mltcr_suppressed() == 10);
+
+    /*** The summary reports and resets the suppressed count. */
+    modlog_rate_summary();
+    TEST_ASSERT_FATAL(mla.num_entries == 6);
+    exp = "modlog: 10 messages suppressed";
+    TEST_ASSERT(mla.entries[5].hdr.ue_module == 1);
+    TEST_ASSERT(mla.entries[5].hdr.ue_level == LOG_LEVEL_WARN);
+    TEST_ASSERT(mla.entries[5].len == strlen(exp));
+    TEST_ASSERT(memcmp(mla.entries[5].body, exp, strlen(exp)) == 0);
+    TEST_ASSERT(mltcr_suppressed() == 0);
+
+    modlog_rate_summary();
+    TEST_ASSERT(mla.num_entries == 6);
+
+    /*** Sampling writes one in N. */
+    cfg = (struct modlog_rate_cfg) { .sample = 4 };
+    rc = modlog_set_rate(1, &cfg);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mltcr_append_n(1, 4, false);
+    mltcr_append_n(1, 4, true);
+    TEST_ASSERT(mla.num_entries == 8);
+    TEST_ASSERT(mltcr_suppressed() == 6);
+
+    /*** Removing the limit lets everything through. */
+    rc = modlog_set_rate(1, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(modlog_get_rate(1, NULL, NULL) == SYS_ENOENT);
+
+    mltcr_append_n(1, 3, false);
+    TEST_ASSERT(mla.num_entries == 11);
+
+    /*** The number of limited modules is bounded. */
+    for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_RATE_LIMITS); i++) {
+        rc = modlog_set_rate(10 + i, &cfg);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(modlog_set_rate(1, &cfg) == SYS_ENOMEM);
+}
+
+#endif
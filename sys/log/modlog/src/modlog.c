@@ -18,8 +18,10 @@
  */
 
 #include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 #include "os/mynewt.h"
-#include "rwlock/rwlock.h"
+#include "rcu/rcu.h"
 #include "log/log.h"
 #include "modlog/modlog.h"
 
@@ -37,7 +39,13 @@ static os_membuf_t modlog_mapping_buf[
                     sizeof (struct modlog_mapping))
 ];
 
-static struct rwlock modlog_rwl;
+/**
+ * Appends and other lookups traverse the mapping list inside an RCU read
+ * section without locking.  Changes are serialized by the mutex; removed
+ * mappings are freed only after a grace period.
+ */
+static struct os_mutex modlog_mtx;
+static struct rcu modlog_rcu;
 
 SLIST_HEAD(modlog_list, modlog_mapping);
 
@@ -51,6 +59,32 @@ static struct modlog_list modlog_mappings =
  */
 static struct modlog_mapping *modlog_first_dflt;
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+struct modlog_rate {
+    struct modlog_rate_cfg cfg;
+
+    /** Token bucket; one message costs OS_TICKS_PER_SEC. */
+    uint32_t credit;
+    os_time_t last_refill;
+
+    uint16_t sample_cnt;
+    uint32_t suppressed;
+    uint8_t module;
+    uint8_t in_use;
+};
+
+/**
+ * Rate limits.  Configuration is changed with the mutex held; the
+ * configuration, bucket state and counters are also accessed by appenders
+ * in a read section, so they are guarded by a critical section.
+ */
+static struct modlog_rate modlog_rates[MYNEWT_VAL(MODLOG_MAX_RATE_LIMITS)];
+
+#if MYNEWT_VAL(MODLOG_RATE_SUMMARY_PERIOD_MS) > 0
+static struct os_callout modlog_rate_timer;
+#endif
+#endif
+
 static struct modlog_mapping *
 modlog_alloc(void)
 {
@@ -137,35 +171,58 @@ modlog_find_by_module(uint8_t module, struct modlog_mapping **out_prev)
     return cur;
 }
 
+/**
+ * Links a mapping into the list.  The mapping is fully set up before it
+ * becomes reachable, so concurrent readers see either the old or the new
+ * list.
+ */
 static void
 modlog_insert(struct modlog_mapping *mm)
 {
     struct modlog_mapping *prev;
+    os_sr_t sr;
 
     modlog_find_by_module(mm->desc.module, &prev);
+
+    OS_ENTER_CRITICAL(sr);
+
     if (prev == NULL) {
-        SLIST_INSERT_HEAD(&modlog_mappings, mm, next);
+        SLIST_NEXT(mm, next) = SLIST_FIRST(&modlog_mappings);
+        RCU_ASSIGN_PTR(SLIST_FIRST(&modlog_mappings), mm);
     } else {
-        SLIST_INSERT_AFTER(prev, mm, next);
+        SLIST_NEXT(mm, next) = SLIST_NEXT(prev, next);
+        RCU_ASSIGN_PTR(SLIST_NEXT(prev, next), mm);
     }
 
     if (mm->desc.module == MODLOG_MODULE_DFLT) {
         modlog_first_dflt = mm;
     }
+
+    OS_EXIT_CRITICAL(sr);
 }
 
+/**
+ * Unlinks a mapping from the list.  Readers may still be looking at it; it
+ * must not be freed before rcu_synchronize() returns.
+ */
 static void
 modlog_remove(struct modlog_mapping *mm, struct modlog_mapping *prev)
 {
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
     if (mm == modlog_first_dflt) {
         modlog_first_dflt = SLIST_NEXT(mm, next);
     }
-        
+
     if (prev == NULL) {
         SLIST_REMOVE_HEAD(&modlog_mappings, next);
     } else {
         SLIST_NEXT(prev, next) = SLIST_NEXT(mm, next);
     }
+
+    OS_EXIT_CRITICAL(sr);
 }
 
 static int
@@ -211,6 +268,7 @@ modlog_delete_no_lock(uint8_t handle)
     }
 
     modlog_remove(mm, prev);
+    rcu_synchronize(&modlog_rcu);
     modlog_free(mm);
 
     return 0;
@@ -335,6 +393,203 @@ modlog_append_mbuf_no_lock(uint8_t module, uint8_t level, uint8_t etype,
     return rc;
 }
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+static struct modlog_rate *
+modlog_rate_find(uint8_t module)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_RATE_LIMITS); i++) {
+        if (modlog_rates[i].in_use && modlog_rates[i].module == module) {
+            return &modlog_rates[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Indicates whether any mapping in the run starting at `mm` would accept a
+ * write of the given level.
+ */
+static bool
+modlog_rate_level_passes(const struct modlog_mapping *mm, uint8_t level)
+{
+    uint8_t module;
+
+    module = mm->desc.module;
+    for (; mm != NULL && mm->desc.module == module;
+         mm = SLIST_NEXT(mm, next)) {
+
+        if (level >= mm->desc.min_level) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Applies the module's rate limit to a write.  Returns false if the write
+ * is to be suppressed.
+ */
+static bool
+modlog_rate_allow_no_lock(uint8_t module, uint8_t level)
+{
+    struct modlog_mapping *mm;
+    struct modlog_rate *mr;
+    os_time_t now;
+    uint32_t elapsed;
+    uint32_t cap;
+    bool allow;
+    os_sr_t sr;
+
+    mr = modlog_rate_find(module);
+    if (mr == NULL) {
+        return true;
+    }
+
+    /* Writes discarded by level anyway do not use up the limit. */
+    mm = modlog_find_by_module(module, NULL);
+    if (mm == NULL) {
+        mm = modlog_first_dflt;
+    }
+    if (mm == NULL || !modlog_rate_level_passes(mm, level)) {
+        return true;
+    }
+
+    allow = true;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (mr->cfg.sample > 1) {
+        allow = mr->sample_cnt == 0;
+        if (++mr->sample_cnt >= mr->cfg.sample) {
+            mr->sample_cnt = 0;
+        }
+    }
+
+    if (allow && mr->cfg.rate > 0) {
+        now = os_time_get();
+        elapsed = now - mr->last_refill;
+        mr->last_refill = now;
+
+        cap = (uint32_t)mr->cfg.burst * OS_TICKS_PER_SEC;
+        if (elapsed >= cap / mr->cfg.rate) {
+            mr->credit = cap;
+        } else {
+            mr->credit += elapsed * mr->cfg.rate;
+            if (mr->credit > cap) {
+                mr->credit = cap;
+            }
+        }
+
+        if (mr->credit >= OS_TICKS_PER_SEC) {
+            mr->credit -= OS_TICKS_PER_SEC;
+        } else {
+            allow = false;
+        }
+    }
+
+    if (!allow) {
+        mr->suppressed++;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return allow;
+}
+
+static int
+modlog_set_rate_no_lock(uint8_t module, const struct modlog_rate_cfg *cfg)
+{
+    struct modlog_rate *mr;
+    os_sr_t sr;
+    int i;
+
+    mr = modlog_rate_find(module);
+
+    if (cfg == NULL) {
+        if (mr == NULL) {
+            return SYS_ENOENT;
+        }
+        mr->in_use = 0;
+        return 0;
+    }
+
+    if (module == MODLOG_MODULE_DFLT || (cfg->rate > 0 && cfg->burst == 0)) {
+        return SYS_EINVAL;
+    }
+
+    if (mr == NULL) {
+        for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_RATE_LIMITS); i++) {
+            if (!modlog_rates[i].in_use) {
+                mr = &modlog_rates[i];
+                break;
+            }
+        }
+        if (mr == NULL) {
+            return SYS_ENOMEM;
+        }
+
+        mr->module = module;
+        mr->suppressed = 0;
+    }
+
+    /* Start with a full bucket. */
+    OS_ENTER_CRITICAL(sr);
+    mr->cfg = *cfg;
+    mr->credit = (uint32_t)cfg->burst * OS_TICKS_PER_SEC;
+    mr->last_refill = os_time_get();
+    mr->sample_cnt = 0;
+    mr->in_use = 1;
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+static void
+modlog_rate_summary_no_lock(void)
+{
+    char buf[48];
+    uint32_t suppressed;
+    os_sr_t sr;
+    int len;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MODLOG_MAX_RATE_LIMITS); i++) {
+        if (!modlog_rates[i].in_use) {
+            continue;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        suppressed = modlog_rates[i].suppressed;
+        modlog_rates[i].suppressed = 0;
+        OS_EXIT_CRITICAL(sr);
+
+        if (suppressed == 0) {
+            continue;
+        }
+
+        len = snprintf(buf, sizeof buf, "modlog: %lu messages suppressed",
+                       (unsigned long)suppressed);
+        modlog_append_no_lock(modlog_rates[i].module, LOG_LEVEL_WARN,
+                              LOG_ETYPE_STRING, buf, len);
+    }
+}
+
+#if MYNEWT_VAL(MODLOG_RATE_SUMMARY_PERIOD_MS) > 0
+static void
+modlog_rate_timer_exp(struct os_event *ev)
+{
+    modlog_rate_summary();
+
+    os_callout_reset(&modlog_rate_timer,
+        os_time_ms_to_ticks32(MYNEWT_VAL(MODLOG_RATE_SUMMARY_PERIOD_MS)));
+}
+#endif
+#endif
+
 static int
 modlog_foreach_no_lock(modlog_foreach_fn *fn, void *arg)
 {
@@ -361,9 +616,10 @@ int
 modlog_get(uint8_t handle, struct modlog_desc *out_desc)
 {
     struct modlog_mapping *mm;
+    int token;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    token = rcu_read_enter(&modlog_rcu);
 
     mm = modlog_find(handle, NULL);
     if (mm == NULL) {
@@ -375,7 +631,7 @@ modlog_get(uint8_t handle, struct modlog_desc *out_desc)
         rc = 0;
     }
 
-    rwlock_release_read(&modlog_rwl);
+    rcu_read_exit(&modlog_rcu, token);
 
     return rc;
 }
@@ -386,9 +642,9 @@ modlog_register(uint8_t module, struct log *log, uint8_t min_level,
 {
     int rc;
 
-    rwlock_acquire_write(&modlog_rwl);
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
     rc = modlog_register_no_lock(module, log, min_level, out_handle);
-    rwlock_release_write(&modlog_rwl);
+    os_mutex_release(&modlog_mtx);
 
     return rc;
 }
@@ -398,9 +654,9 @@ modlog_delete(uint8_t handle)
 {
     int rc;
 
-    rwlock_acquire_write(&modlog_rwl);
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
     rc = modlog_delete_no_lock(handle);
-    rwlock_release_write(&modlog_rwl);
+    os_mutex_release(&modlog_mtx);
 
     return rc;
 }
@@ -408,27 +664,50 @@ modlog_delete(uint8_t handle)
 void
 modlog_clear(void)
 {
+    struct modlog_mapping *next;
     struct modlog_mapping *mm;
+    os_sr_t sr;
 
-    rwlock_acquire_write(&modlog_rwl);
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
 
-    while ((mm = SLIST_FIRST(&modlog_mappings)) != NULL) {
-        modlog_remove(mm, NULL);
+    /* Detach the whole list; the unlinked mappings still chain together for
+     * readers which are traversing them.
+     */
+    OS_ENTER_CRITICAL(sr);
+    mm = SLIST_FIRST(&modlog_mappings);
+    SLIST_INIT(&modlog_mappings);
+    modlog_first_dflt = NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    rcu_synchronize(&modlog_rcu);
+
+    while (mm != NULL) {
+        next = SLIST_NEXT(mm, next);
         modlog_free(mm);
+        mm = next;
     }
 
-    rwlock_release_write(&modlog_rwl);
+    os_mutex_release(&modlog_mtx);
 }
 
 int
 modlog_append(uint8_t module, uint8_t level, uint8_t etype,
               void *data, uint16_t len)
 {
+    int token;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    token = rcu_read_enter(&modlog_rcu);
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    if (module != MODLOG_MODULE_DFLT &&
+        !modlog_rate_allow_no_lock(module, level)) {
+
+        rcu_read_exit(&modlog_rcu, token);
+        return 0;
+    }
+#endif
     rc = modlog_append_no_lock(module, level, etype, data, len);
-    rwlock_release_read(&modlog_rwl);
+    rcu_read_exit(&modlog_rcu, token);
 
     return rc;
 }
@@ -437,11 +716,19 @@ int
 modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
                    struct os_mbuf *om)
 {
+    int token;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    token = rcu_read_enter(&modlog_rcu);
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    if (!modlog_rate_allow_no_lock(module, level)) {
+        rcu_read_exit(&modlog_rcu, token);
+        os_mbuf_free_chain(om);
+        return 0;
+    }
+#endif
     rc = modlog_append_mbuf_no_lock(module, level, etype, om);
-    rwlock_release_read(&modlog_rwl);
+    rcu_read_exit(&modlog_rcu, token);
 
     return rc;
 }
@@ -449,15 +736,70 @@ modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
 int
 modlog_foreach(modlog_foreach_fn *fn, void *arg)
 {
+    int token;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
+    token = rcu_read_enter(&modlog_rcu);
     rc = modlog_foreach_no_lock(fn, arg);
-    rwlock_release_read(&modlog_rwl);
+    rcu_read_exit(&modlog_rcu, token);
 
     return rc;
 }
 
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+int
+modlog_set_rate(uint8_t module, const struct modlog_rate_cfg *cfg)
+{
+    int rc;
+
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
+    rc = modlog_set_rate_no_lock(module, cfg);
+    os_mutex_release(&modlog_mtx);
+
+    return rc;
+}
+
+int
+modlog_get_rate(uint8_t module, struct modlog_rate_cfg *out_cfg,
+                uint32_t *out_suppressed)
+{
+    struct modlog_rate *mr;
+    os_sr_t sr;
+    int rc;
+
+    os_mutex_pend(&modlog_mtx, OS_TIMEOUT_NEVER);
+
+    mr = modlog_rate_find(module);
+    if (mr == NULL) {
+        rc = SYS_ENOENT;
+    } else {
+        OS_ENTER_CRITICAL(sr);
+        if (out_cfg != NULL) {
+            *out_cfg = mr->cfg;
+        }
+        if (out_suppressed != NULL) {
+            *out_suppressed = mr->suppressed;
+        }
+        OS_EXIT_CRITICAL(sr);
+        rc = 0;
+    }
+
+    os_mutex_release(&modlog_mtx);
+
+    return rc;
+}
+
+void
+modlog_rate_summary(void)
+{
+    int token;
+
+    token = rcu_read_enter(&modlog_rcu);
+    modlog_rate_summary_no_lock();
+    rcu_read_exit(&modlog_rcu, token);
+}
+#endif
+
 void
 modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 {
@@ -465,6 +807,15 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     char buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
     int len;
 
+#if MYNEWT_VAL(LOG_DICT)
+    va_start(args, msg);
+    len = log_dict_vencode(buf, MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN), msg, args);
+    va_end(args);
+
+    if (len >= 0) {
+        modlog_append(module, level, LOG_ETYPE_DICT, buf, len);
+    }
+#else
     va_start(args, msg);
     len = vsnprintf(buf, MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN), msg, args);
     va_end(args);
@@ -474,6 +825,7 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
     }
 
     modlog_append(module, level, LOG_ETYPE_STRING, buf, len);
+#endif
 }
 
 void
@@ -513,9 +865,22 @@ modlog_init(void)
     SLIST_INIT(&modlog_mappings);
     modlog_first_dflt = NULL;
 
-    rc = rwlock_init(&modlog_rwl);
+    rc = os_mutex_init(&modlog_mtx);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+    rc = rcu_init(&modlog_rcu);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(MODLOG_RATE_LIMIT)
+    memset(modlog_rates, 0, sizeof modlog_rates);
+#if MYNEWT_VAL(MODLOG_RATE_SUMMARY_PERIOD_MS) > 0
+    os_callout_init(&modlog_rate_timer, os_eventq_dflt_get(),
+                    modlog_rate_timer_exp, NULL);
+    os_callout_reset(&modlog_rate_timer,
+        os_time_ms_to_ticks32(MYNEWT_VAL(MODLOG_RATE_SUMMARY_PERIOD_MS)));
+#endif
+#endif
+
     /* Register the default console mapping if configured. */
 #if MYNEWT_VAL(MODLOG_CONSOLE_DFLT)
     rc = modlog_register(MODLOG_MODULE_DFLT, log_console_get(),
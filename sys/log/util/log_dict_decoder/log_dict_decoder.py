@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+
+# Decodes LOG_ETYPE_DICT log entries (sys/log/full, LOG_DICT) back to text
+# using the ELF file of the image that wrote them.  Each input line holds
+# one entry body in hex, optionally preceded by other fields; the output of
+# the "log" shell command can be fed in directly:
+#
+#   $ log_dict_decoder.py bin/targets/app/app.elf < log.txt
+
+import argparse
+import re
+import struct
+import sys
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?"
+                  r"(hh|h|ll|l|L|j|z|t)?([diuoxXcfFeEgGaAspn%])")
+HEXTOK = re.compile(r"^(?:[0-9a-fA-F]{2})+$")
+
+
+class Elf:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s: not an ELF file" % path)
+
+        self.word = 4 if self.data[4] == 1 else 8
+        self.endian = "<" if self.data[5] == 1 else ">"
+        e = self.endian
+
+        if self.word == 4:
+            shoff, = struct.unpack_from(e + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(e + "HH", self.data, 0x2e)
+            shfmt = e + "IIIIIIIIII"
+        else:
+            shoff, = struct.unpack_from(e + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(e + "HH", self.data, 0x3a)
+            shfmt = e + "IIQQQQIIQQ"
+
+        # (addr, size, file offset) of each loaded section with contents.
+        self.sections = []
+        for i in range(shnum):
+            sh = struct.unpack_from(shfmt, self.data, shoff + i * shentsize)
+            sh_type, flags, addr, offset, size = sh[1:6]
+            if flags & SHF_ALLOC and sh_type != SHT_NOBITS and size != 0:
+                self.sections.append((addr, size, offset))
+
+    def string(self, addr):
+        for base, size, offset in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+class Reader:
+    def __init__(self, elf, body):
+        self.elf = elf
+        self.body = body
+        self.off = 0
+
+    def take(self, fmt):
+        fmt = self.elf.endian + fmt
+        size = struct.calcsize(fmt)
+        if self.off + size > len(self.body):
+            raise EOFError
+        val, = struct.unpack_from(fmt, self.body, self.off)
+        self.off += size
+        return val
+
+    def string(self):
+        end = self.body.find(b"\0", self.off)
+        if end < 0:
+            raise EOFError
+        s = self.body[self.off:end].decode("utf-8", "replace")
+        self.off = end + 1
+        return s
+
+
+def int_fmt(elf, mod, signed):
+    if mod in ("ll", "j"):
+        c = "q"
+    elif mod in ("l", "z", "t"):
+        c = "i" if elf.word == 4 else "q"
+    else:
+        c = "i"
+    return c if signed else c.upper()
+
+
+def narrow(val, mod, signed):
+    bits = {"hh": 8, "h": 16}.get(mod)
+    if bits is None:
+        return val
+    val &= (1 << bits) - 1
+    if signed and val >= 1 << (bits - 1):
+        val -= 1 << bits
+    return val
+
+
+def decode(elf, body):
+    r = Reader(elf, body)
+    addr = r.take("I" if elf.word == 4 else "Q")
+    fmt = elf.string(addr)
+    if fmt is None:
+        return "<unknown format string 0x%x>" % addr
+
+    out = []
+    pos = 0
+    try:
+        for m in SPEC.finditer(fmt):
+            out.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, prec, mod, conv = m.groups()
+            if conv == "%":
+                out.append("%")
+                continue
+            if width == "*":
+                width = str(r.take("i"))
+            if prec == "*":
+                prec = str(r.take("i"))
+            pyfmt = "%" + flags + (width or "")
+            if prec is not None:
+                pyfmt += "." + prec
+
+            if conv in "di":
+                val = narrow(r.take(int_fmt(elf, mod, True)), mod, True)
+                out.append((pyfmt + "d") % val)
+            elif conv in "uoxX":
+                c = "d" if conv == "u" else conv
+                val = narrow(r.take(int_fmt(elf, mod, False)), mod, False)
+                out.append((pyfmt + c) % val)
+            elif conv == "c":
+                out.append((pyfmt + "c") % chr(r.take("i") & 0xff))
+            elif conv in "fFeEgGaA":
+                c = "f" if conv in "aA" else conv
+                out.append((pyfmt + c) % r.take("d"))
+            elif conv == "s":
+                out.append((pyfmt + "s") % r.string())
+            elif conv == "p":
+                out.append("0x%x" % r.take("I" if elf.word == 4 else "Q"))
+    except EOFError:
+        out.append("<?>")
+        pos = len(fmt)
+    out.append(fmt[pos:])
+
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode LOG_ETYPE_DICT log entries")
+    parser.add_argument("elf", help="ELF file of the image")
+    parser.add_argument("input", nargs="?", type=argparse.FileType("r"),
+                        default=sys.stdin,
+                        help="entry bodies in hex, one per line")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    for line in args.input:
+        fields = line.split()
+        if fields and HEXTOK.match(fields[-1]):
+            prefix = line[:line.rindex(fields[-1])]
+            body = bytes.fromhex(fields[-1])
+            print(prefix + decode(elf, body))
+        else:
+            sys.stdout.write(line)
+
+
+if __name__ == "__main__":
+    main()
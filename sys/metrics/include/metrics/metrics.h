@@ -142,6 +142,11 @@ extern "C" {
  * As number of values increases in a series it may be necessary to allocate
  * more blocks for the same data series. Once event data is reset, all blocks
  * allocated for an event are freed.
+ *
+ * With METRICS_SERIES_STREAM enabled, series values are stored CBOR-encoded as
+ * they are set and moved into the event's CBOR stream as-is when the event
+ * ends, and each event holds at most METRICS_SERIES_STREAM_MAX_LEN bytes of
+ * series data; values which do not fit are dropped.
  */
 
 /* Helper to define metric type - use types defined below instead! */
@@ -160,6 +165,15 @@ extern "C" {
 #define METRICS_TYPE_SINGLE             (METRICS_TYPE_SINGLE_U)
 #define METRICS_TYPE_SERIES             (METRICS_TYPE_SERIES_U32)
 
+/*
+ * Series type modifier: with METRICS_SERIES_STREAM enabled, each value after
+ * the first is encoded as its (signed, modulo type width) difference from the
+ * previous one.  Slowly changing or monotonic series, e.g. timestamps, then
+ * take one or two bytes per value.  Ignored otherwise.
+ */
+#define METRICS_TYPE_DELTA_MASK         0x20
+#define METRICS_TYPE_DELTA(__type)      ((__type) | METRICS_TYPE_DELTA_MASK)
+
 /* Metric definition - use METRICS_SECT_* helpers to create */
 struct metrics_metric_def {
     const char *name;
@@ -176,6 +190,10 @@ struct metrics_event_hdr {
     uint32_t enabled;
     uint32_t set;
     uint8_t count;
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+    /* Bytes of encoded series data held by the event */
+    uint16_t series_len;
+#endif
     STAILQ_ENTRY(metrics_event_hdr) next;
     const struct metrics_metric_def *defs;
 };
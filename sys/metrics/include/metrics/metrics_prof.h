@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_METRICS_PROF_H__
+#define __SYS_METRICS_PROF_H__
+
+#include <stdint.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(METRICS_PROF)
+
+struct log;
+
+/*
+ * Code region profiler.
+ *
+ * Regions are identified by a number below METRICS_PROF_REGIONS.  Execution
+ * time of a region is measured by enclosing it in a pair of macros:
+ *
+ *     METRICS_REGION_BEGIN(MY_REGION);
+ *     ...
+ *     METRICS_REGION_END(MY_REGION);
+ *
+ * Both have to be used in the same scope, and the id has to be a plain
+ * identifier (e.g. an enum constant) or integer literal.  Each region
+ * accumulates the number of runs, total and maximum duration.  Durations are
+ * in CPU cycles where the DWT cycle counter is available (Cortex-M3 and up)
+ * and in os_cputime ticks elsewhere.  Regions also show up as user events in
+ * the OS trace (os_trace_user_start() / os_trace_user_stop()).
+ *
+ * With METRICS_PROF_PC enabled, the code interrupted by each OS tick is
+ * sampled into a histogram of METRICS_PROF_PC_BUCKETS address ranges of
+ * 2^METRICS_PROF_PC_SHIFT bytes starting at METRICS_PROF_PC_BASE.
+ *
+ * Results are available through the "metrics prof-dump" shell command, and
+ * as CBOR through metrics_prof_to_cbor() / metrics_prof_log(), e.g. to be
+ * read over SMP from a log.
+ */
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define METRICS_PROF_CYCCNT     1
+#else
+#define METRICS_PROF_CYCCNT     0
+#endif
+
+struct metrics_prof_region {
+    const char *name;
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+};
+
+extern struct metrics_prof_region
+    metrics_prof_regions[MYNEWT_VAL(METRICS_PROF_REGIONS)];
+
+static inline uint32_t
+metrics_prof_now(void)
+{
+#if METRICS_PROF_CYCCNT
+    return DWT->CYCCNT;
+#else
+    return os_cputime_get32();
+#endif
+}
+
+static inline uint32_t
+metrics_prof_region_begin(unsigned id)
+{
+    os_trace_user_start(id);
+    return metrics_prof_now();
+}
+
+void metrics_prof_record(unsigned id, uint32_t duration);
+
+static inline void
+metrics_prof_region_end(unsigned id, uint32_t start)
+{
+    metrics_prof_record(id, metrics_prof_now() - start);
+    os_trace_user_stop(id);
+}
+
+#define METRICS_REGION_BEGIN(_id) \
+    uint32_t metrics_region_start_ ## _id = metrics_prof_region_begin(_id)
+
+#define METRICS_REGION_END(_id) \
+    metrics_prof_region_end((_id), metrics_region_start_ ## _id)
+
+/**
+ * Set printable name of a region
+ *
+ * @param id    Region identifier
+ * @param name  Region name
+ *
+ * @return 0 on success, SYS_E[...] error otherwise
+ */
+int metrics_prof_region_name(unsigned id, const char *name);
+
+/**
+ * Clear all region accumulators and PC samples
+ */
+void metrics_prof_reset(void);
+
+/**
+ * Serialize profiler data to CBOR
+ *
+ * Only regions which ran and PC ranges which were sampled are included.
+ *
+ * @param om  Target mbuf
+ *
+ * @return 0 on success, SYS_E[...] error otherwise
+ */
+int metrics_prof_to_cbor(struct os_mbuf *om);
+
+/**
+ * Append profiler data to log as a CBOR entry
+ *
+ * @param log     Log instance
+ * @param module  Log module
+ * @param level   Log level
+ *
+ * @return 0 on success, SYS_E[...] error otherwise
+ */
+int metrics_prof_log(struct log *log, int module, int level);
+
+#else
+
+#define METRICS_REGION_BEGIN(_id)
+#define METRICS_REGION_END(_id)
+
+#endif /* MYNEWT_VAL(METRICS_PROF) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SYS_METRICS_PROF_H__ */
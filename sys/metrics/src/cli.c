@@ -27,6 +27,8 @@
 #include "shell/shell.h"
 #include "console/console.h"
 #include "metrics/metrics.h"
+#include "metrics/metrics_prof.h"
+#include "metrics_priv.h"
 #include "tinycbor/cbor.h"
 #include "tinycbor/cbor_mbuf_reader.h"
 
@@ -64,7 +66,7 @@ find_metric_by_name(struct metrics_event_hdr *hdr, const char *name)
 static const char *
 metric_type_str(uint8_t type)
 {
-    switch (type) {
+    switch (type & ~METRICS_TYPE_DELTA_MASK) {
     case METRICS_TYPE_SINGLE_U:
         return "unsigned";
     case METRICS_TYPE_SINGLE_S:
@@ -222,6 +224,54 @@ cmd_event_end(int argc, char **argv)
     return 0;
 }
 
+#if MYNEWT_VAL(METRICS_PROF)
+static int
+cmd_prof_dump(int argc, char **argv)
+{
+    struct metrics_prof_region *r;
+#if MYNEWT_VAL(METRICS_PROF_PC)
+    uint32_t addr;
+#endif
+    int i;
+
+    console_printf("unit: %s\n", METRICS_PROF_CYCCNT ? "cycle" : "cputime");
+    for (i = 0; i < MYNEWT_VAL(METRICS_PROF_REGIONS); i++) {
+        r = &metrics_prof_regions[i];
+        if (r->count == 0) {
+            continue;
+        }
+        console_printf("%d %s: count=%lu total=%llu max=%lu avg=%lu\n", i,
+                       r->name ? r->name : "", (unsigned long)r->count,
+                       (unsigned long long)r->total, (unsigned long)r->max,
+                       (unsigned long)(r->total / r->count));
+    }
+
+#if MYNEWT_VAL(METRICS_PROF_PC)
+    console_printf("pc: isr=%lu other=%lu\n",
+                   (unsigned long)metrics_prof_pc.isr,
+                   (unsigned long)metrics_prof_pc.other);
+    for (i = 0; i < MYNEWT_VAL(METRICS_PROF_PC_BUCKETS); i++) {
+        if (metrics_prof_pc.hist[i]) {
+            addr = MYNEWT_VAL(METRICS_PROF_PC_BASE) +
+                   ((uint32_t)i << MYNEWT_VAL(METRICS_PROF_PC_SHIFT));
+            console_printf("  0x%08lx: %lu\n", (unsigned long)addr,
+                           (unsigned long)metrics_prof_pc.hist[i]);
+        }
+    }
+#endif
+
+    return 0;
+}
+
+static int
+cmd_prof_reset(int argc, char **argv)
+{
+    metrics_prof_reset();
+
+    return 0;
+}
+#endif
+
 static const struct shell_cmd metrics_commands[] = {
     {
         .sc_cmd = "list-events",
@@ -243,6 +293,16 @@ static const struct shell_cmd metrics_commands[] = {
         .sc_cmd = "event-end",
         .sc_cmd_func = cmd_event_end,
     },
+#if MYNEWT_VAL(METRICS_PROF)
+    {
+        .sc_cmd = "prof-dump",
+        .sc_cmd_func = cmd_prof_dump,
+    },
+    {
+        .sc_cmd = "prof-reset",
+        .sc_cmd_func = cmd_prof_reset,
+    },
+#endif
     { },
 };
 
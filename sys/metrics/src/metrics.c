@@ -40,6 +40,13 @@
 #define METRICS_TYPE_SIGNED_MASK    0x40
 #define METRICS_TYPE_SIZE_MASK      0x0f
 
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+/* Kept in the packet header of each series chain */
+struct metrics_series_hdr {
+    uint32_t prev;
+};
+#endif
+
 union metrics_metric_val {
     uintptr_t notused;
     uint32_t val;
@@ -139,6 +146,9 @@ metrics_event_end(struct metrics_event_hdr *hdr)
     }
 
     hdr->set = 0;
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+    hdr->series_len = 0;
+#endif
 
     for (i = 0; i < hdr->count; i++) {
         def = &hdr->defs[i];
@@ -208,10 +218,84 @@ set_single_value(struct metrics_event_hdr *hdr, uint8_t metric,
     return 0;
 }
 
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+static int32_t
+sign_extend(uint32_t val, uint8_t bits)
+{
+    uint8_t shift;
+
+    shift = 32 - bits;
+    return (int32_t)(val << shift) >> shift;
+}
+
+/*
+ * Encodes a series value straight to CBOR at the end of the series chain.
+ */
+static int
+stream_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
+                    uint32_t val, uint8_t type)
+{
+    struct metrics_event *em = (struct metrics_event *)hdr;
+    union metrics_metric_val *v;
+    struct metrics_series_hdr *msh;
+    struct cbor_mbuf_writer writer;
+    struct CborEncoder encoder;
+    uint16_t old_len;
+    uint16_t len;
+    uint8_t bits;
+    int rc;
+
+    v = &em->vals[metric];
+
+    if (!v->series) {
+        v->series = os_mbuf_get_pkthdr(&event_metric_mbuf_pool,
+                                       sizeof(*msh));
+        if (!v->series) {
+            return SYS_ENOMEM;
+        }
+    }
+
+    msh = OS_MBUF_USRHDR(v->series);
+    old_len = OS_MBUF_PKTLEN(v->series);
+
+    bits = (type & METRICS_TYPE_SIZE_MASK) * 8;
+    if (bits < 32) {
+        val &= (1UL << bits) - 1;
+    }
+
+    cbor_mbuf_writer_init(&writer, v->series);
+    cbor_encoder_init(&encoder, &writer.enc, 0);
+
+    if ((type & METRICS_TYPE_DELTA_MASK) && old_len > 0) {
+        rc = cbor_encode_int(&encoder, sign_extend(val - msh->prev, bits));
+    } else if (type & METRICS_TYPE_SIGNED_MASK) {
+        rc = cbor_encode_int(&encoder, sign_extend(val, bits));
+    } else {
+        rc = cbor_encode_uint(&encoder, val);
+    }
+
+    len = OS_MBUF_PKTLEN(v->series) - old_len;
+    if (rc != 0 ||
+        hdr->series_len + len > MYNEWT_VAL(METRICS_SERIES_STREAM_MAX_LEN)) {
+        os_mbuf_adj(v->series, -(int)len);
+        return SYS_ENOMEM;
+    }
+
+    msh->prev = val;
+    hdr->series_len += len;
+    hdr->set |= (1 << metric);
+
+    return 0;
+}
+#endif
+
 static int
 set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
                  uint32_t val, uint8_t type)
 {
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+    return stream_series_value(hdr, metric, val, type);
+#else
     struct metrics_event *em = (struct metrics_event *)hdr;
     union metrics_metric_val *v;
     uint16_t type_len;
@@ -231,6 +315,7 @@ set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
     hdr->set |= (1 << metric);
 
     return 0;
+#endif
 }
 
 int
@@ -487,7 +572,24 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
             return SYS_ENOMEM;
         }
 
-        switch (def->type) {
+#if MYNEWT_VAL(METRICS_SERIES_STREAM)
+        /* Values are already encoded; move or copy them in as they are. */
+        if (!v->series) {
+            /* Moved out by an earlier call. */
+        } else if (om->om_omp == &event_metric_mbuf_pool) {
+            writer.enc.bytes_written += OS_MBUF_PKTLEN(v->series);
+            os_mbuf_concat(om, v->series);
+            v->series = NULL;
+        } else {
+            rc = os_mbuf_appendfrom(om, v->series, 0,
+                                    OS_MBUF_PKTLEN(v->series));
+            if (rc != 0) {
+                return SYS_ENOMEM;
+            }
+            writer.enc.bytes_written += OS_MBUF_PKTLEN(v->series);
+        }
+#else
+        switch (def->type & ~METRICS_TYPE_DELTA_MASK) {
         case METRICS_TYPE_SERIES_U8:
             append_series_u8_to_cbor(&arr, v->series);
             break;
@@ -509,6 +611,7 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
         default:
             assert(0);
         }
+#endif
 
         rc = cbor_encoder_close_container(&map, &arr);
         if (rc != 0) {
@@ -520,7 +623,7 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
          * event_metric pool - assume we do this at the end of event so will
          * start over anyway.
          */
-        if (om->om_omp == &event_metric_mbuf_pool) {
+        if (om->om_omp == &event_metric_mbuf_pool && v->series) {
             os_mbuf_free_chain(v->series);
             v->series = NULL;
         }
@@ -555,6 +658,10 @@ metrics_pkg_init(void)
                            MEMPOOL_SIZE, MEMPOOL_COUNT);
     assert(rc == 0);
 
+#if MYNEWT_VAL(METRICS_PROF)
+    metrics_prof_init();
+#endif
+
 #if MYNEWT_VAL(METRICS_CLI)
     metrics_cli_init();
 #endif
@@ -27,6 +27,22 @@ extern "C" {
 int metrics_cli_init(void);
 int metrics_cli_register_event(struct metrics_event_hdr *hdr);
 
+#if MYNEWT_VAL(METRICS_PROF)
+void metrics_prof_init(void);
+#endif
+
+#if MYNEWT_VAL(METRICS_PROF_PC)
+struct metrics_prof_pc {
+    /* Ticks which interrupted a handler, PC unknown */
+    uint32_t isr;
+    /* Ticks with PC outside of sampled range */
+    uint32_t other;
+    uint32_t hist[MYNEWT_VAL(METRICS_PROF_PC_BUCKETS)];
+};
+
+extern struct metrics_prof_pc metrics_prof_pc;
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,236 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(METRICS_PROF)
+
+#include <string.h>
+#include "metrics/metrics.h"
+#include "metrics/metrics_prof.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "log/log.h"
+#include "metrics_priv.h"
+
+#define PROF_REGIONS        MYNEWT_VAL(METRICS_PROF_REGIONS)
+
+struct metrics_prof_region metrics_prof_regions[PROF_REGIONS];
+
+#if MYNEWT_VAL(METRICS_PROF_PC)
+#define PROF_PC_BUCKETS     MYNEWT_VAL(METRICS_PROF_PC_BUCKETS)
+#define PROF_PC_BASE        MYNEWT_VAL(METRICS_PROF_PC_BASE)
+#define PROF_PC_SHIFT       MYNEWT_VAL(METRICS_PROF_PC_SHIFT)
+
+struct metrics_prof_pc metrics_prof_pc;
+#endif
+
+void
+metrics_prof_record(unsigned id, uint32_t duration)
+{
+    struct metrics_prof_region *r;
+    os_sr_t sr;
+
+    if (id >= PROF_REGIONS) {
+        return;
+    }
+
+    r = &metrics_prof_regions[id];
+
+    OS_ENTER_CRITICAL(sr);
+    r->count++;
+    r->total += duration;
+    if (duration > r->max) {
+        r->max = duration;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+metrics_prof_region_name(unsigned id, const char *name)
+{
+    if (id >= PROF_REGIONS) {
+        return SYS_EINVAL;
+    }
+
+    metrics_prof_regions[id].name = name;
+
+    return 0;
+}
+
+void
+metrics_prof_reset(void)
+{
+    os_sr_t sr;
+    int i;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < PROF_REGIONS; i++) {
+        metrics_prof_regions[i].count = 0;
+        metrics_prof_regions[i].max = 0;
+        metrics_prof_regions[i].total = 0;
+    }
+#if MYNEWT_VAL(METRICS_PROF_PC)
+    memset(&metrics_prof_pc, 0, sizeof(metrics_prof_pc));
+#endif
+    OS_EXIT_CRITICAL(sr);
+}
+
+#if MYNEWT_VAL(METRICS_PROF_PC)
+/*
+ * Called from the OS tick interrupt.  The PC of the interrupted code can
+ * only be found if it ran in thread mode, i.e. it was a task using the
+ * process stack; ticks which interrupted another handler are only counted.
+ */
+void
+os_tick_hook(void)
+{
+#if METRICS_PROF_CYCCNT
+    uint32_t *frame;
+    uint32_t pc;
+    uint32_t idx;
+
+    if ((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) == 0) {
+        metrics_prof_pc.isr++;
+        return;
+    }
+
+    /* Exception frame: r0-r3, r12, lr, pc, xpsr */
+    frame = (uint32_t *)__get_PSP();
+    pc = frame[6];
+
+    idx = (pc - PROF_PC_BASE) >> PROF_PC_SHIFT;
+    if (pc < PROF_PC_BASE || idx >= PROF_PC_BUCKETS) {
+        metrics_prof_pc.other++;
+    } else {
+        metrics_prof_pc.hist[idx]++;
+    }
+#else
+    metrics_prof_pc.isr++;
+#endif
+}
+#endif
+
+int
+metrics_prof_to_cbor(struct os_mbuf *om)
+{
+    struct metrics_prof_region *r;
+    struct cbor_mbuf_writer writer;
+    struct CborEncoder encoder;
+    struct CborEncoder map;
+    struct CborEncoder arr;
+    struct CborEncoder ent;
+    int rc;
+    int i;
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&encoder, &writer.enc, 0);
+
+    rc = cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength);
+
+    rc |= cbor_encode_text_stringz(&map, "unit");
+    rc |= cbor_encode_text_stringz(&map,
+                                   METRICS_PROF_CYCCNT ? "cycle" : "cputime");
+
+    rc |= cbor_encode_text_stringz(&map, "regions");
+    rc |= cbor_encoder_create_array(&map, &arr, CborIndefiniteLength);
+    for (i = 0; i < PROF_REGIONS; i++) {
+        r = &metrics_prof_regions[i];
+        if (r->count == 0) {
+            continue;
+        }
+
+        rc |= cbor_encoder_create_map(&arr, &ent, CborIndefiniteLength);
+        rc |= cbor_encode_text_stringz(&ent, "id");
+        rc |= cbor_encode_uint(&ent, i);
+        if (r->name) {
+            rc |= cbor_encode_text_stringz(&ent, "name");
+            rc |= cbor_encode_text_stringz(&ent, r->name);
+        }
+        rc |= cbor_encode_text_stringz(&ent, "count");
+        rc |= cbor_encode_uint(&ent, r->count);
+        rc |= cbor_encode_text_stringz(&ent, "total");
+        rc |= cbor_encode_uint(&ent, r->total);
+        rc |= cbor_encode_text_stringz(&ent, "max");
+        rc |= cbor_encode_uint(&ent, r->max);
+        rc |= cbor_encoder_close_container(&arr, &ent);
+    }
+    rc |= cbor_encoder_close_container(&map, &arr);
+
+#if MYNEWT_VAL(METRICS_PROF_PC)
+    rc |= cbor_encode_text_stringz(&map, "pc");
+    rc |= cbor_encoder_create_map(&map, &ent, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&ent, "base");
+    rc |= cbor_encode_uint(&ent, PROF_PC_BASE);
+    rc |= cbor_encode_text_stringz(&ent, "shift");
+    rc |= cbor_encode_uint(&ent, PROF_PC_SHIFT);
+    rc |= cbor_encode_text_stringz(&ent, "isr");
+    rc |= cbor_encode_uint(&ent, metrics_prof_pc.isr);
+    rc |= cbor_encode_text_stringz(&ent, "other");
+    rc |= cbor_encode_uint(&ent, metrics_prof_pc.other);
+    /* Sparse: bucket index followed by its count */
+    rc |= cbor_encode_text_stringz(&ent, "hist");
+    rc |= cbor_encoder_create_array(&ent, &arr, CborIndefiniteLength);
+    for (i = 0; i < PROF_PC_BUCKETS; i++) {
+        if (metrics_prof_pc.hist[i]) {
+            rc |= cbor_encode_uint(&arr, i);
+            rc |= cbor_encode_uint(&arr, metrics_prof_pc.hist[i]);
+        }
+    }
+    rc |= cbor_encoder_close_container(&ent, &arr);
+    rc |= cbor_encoder_close_container(&map, &ent);
+#endif
+
+    rc |= cbor_encoder_close_container(&encoder, &map);
+
+    return rc ? SYS_ENOMEM : 0;
+}
+
+int
+metrics_prof_log(struct log *log, int module, int level)
+{
+    struct os_mbuf *om;
+    int rc;
+
+    om = metrics_get_mbuf();
+    if (!om) {
+        return SYS_ENOMEM;
+    }
+
+    rc = metrics_prof_to_cbor(om);
+    if (rc) {
+        os_mbuf_free_chain(om);
+        return rc;
+    }
+
+    return log_append_mbuf_body(log, module, level, LOG_ETYPE_CBOR, om);
+}
+
+void
+metrics_prof_init(void)
+{
+#if METRICS_PROF_CYCCNT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SYS_RAND_
+#define H_SYS_RAND_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * System random numbers.
+ *
+ * Output comes from a CTR-DRBG (tinycrypt's ctr_prng), so requests are
+ * served at AES speed no matter how slow the TRNG is.  The TRNG only feeds
+ * a small entropy pool, which is topped up in the background from the
+ * default event queue.  The DRBG is reseeded from the pool every
+ * SYS_RAND_RESEED_BYTES of output; if the pool cannot keep up, the caller
+ * that crosses SYS_RAND_RESEED_MAX_BYTES waits for the TRNG.
+ *
+ * Not to be called from interrupt context.
+ */
+
+/**
+ * Fills a buffer with random bytes.
+ *
+ * @param buf                   The buffer to fill.
+ * @param len                   Number of bytes to write.
+ *
+ * @return                      0 on success; SYS_EUNKNOWN if the DRBG
+ *                              failed.
+ */
+int sys_rand_fill(void *buf, size_t len);
+
+/**
+ * Returns a random 32-bit value.
+ */
+uint32_t sys_rand_u32(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
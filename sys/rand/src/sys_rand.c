@@ -0,0 +1,202 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "trng/trng.h"
+#include "tinycrypt/constants.h"
+#include "tinycrypt/ctr_prng.h"
+#include "rand/sys_rand.h"
+
+#define SYS_RAND_SEED_LEN       (TC_AES_KEY_SIZE + TC_AES_BLOCK_SIZE)
+
+/* ctr_prng refuses requests of 64 KiB and more. */
+#define SYS_RAND_MAX_REQ        0x8000
+
+static TCCtrPrng_t sys_rand_drbg;
+static struct os_mutex sys_rand_mtx;
+static struct trng_dev *sys_rand_trng;
+static struct os_callout sys_rand_callout;
+
+/* Entropy for the next reseed.  Everything below is protected by
+ * sys_rand_mtx.
+ */
+static uint8_t sys_rand_pool[SYS_RAND_SEED_LEN];
+static uint8_t sys_rand_pool_len;
+
+static uint8_t sys_rand_seeded;
+static uint32_t sys_rand_since_reseed;
+
+static void
+sys_rand_pool_schedule(void)
+{
+    if (!os_callout_queued(&sys_rand_callout)) {
+        os_callout_reset(&sys_rand_callout, os_time_ms_to_ticks32(
+                             MYNEWT_VAL(SYS_RAND_FILL_INTERVAL_MS)));
+    }
+}
+
+static void
+sys_rand_pool_read(void)
+{
+    sys_rand_pool_len += trng_read(sys_rand_trng,
+                                   sys_rand_pool + sys_rand_pool_len,
+                                   sizeof(sys_rand_pool) - sys_rand_pool_len);
+}
+
+static void
+sys_rand_pool_cb(struct os_event *ev)
+{
+    int full;
+
+    /* Don't hold up the event queue behind a long sys_rand_fill(). */
+    if (os_mutex_pend(&sys_rand_mtx, 0) != OS_OK) {
+        sys_rand_pool_schedule();
+        return;
+    }
+    sys_rand_pool_read();
+    full = sys_rand_pool_len == sizeof(sys_rand_pool);
+    os_mutex_release(&sys_rand_mtx);
+
+    if (!full) {
+        sys_rand_pool_schedule();
+    }
+}
+
+/**
+ * Reseeds (or on first use, instantiates) the DRBG from the pool.  With
+ * wait set, a pool that is not full yet is completed straight from the
+ * TRNG; otherwise the reseed is put off until the pool has filled up.
+ */
+static int
+sys_rand_reseed(int wait)
+{
+    uint32_t val;
+    size_t cnt;
+    int rc;
+
+    if (sys_rand_pool_len < sizeof(sys_rand_pool)) {
+        if (!wait) {
+            return 0;
+        }
+        while (sys_rand_pool_len < sizeof(sys_rand_pool)) {
+            sys_rand_pool_read();
+            if (sys_rand_pool_len < sizeof(sys_rand_pool)) {
+                /* Blocks until the TRNG has a word ready. */
+                val = trng_get_u32(sys_rand_trng);
+                cnt = min(sizeof(val),
+                          sizeof(sys_rand_pool) - sys_rand_pool_len);
+                memcpy(sys_rand_pool + sys_rand_pool_len, &val, cnt);
+                sys_rand_pool_len += cnt;
+            }
+        }
+    }
+
+    if (sys_rand_seeded) {
+        rc = tc_ctr_prng_reseed(&sys_rand_drbg, sys_rand_pool,
+                                sizeof(sys_rand_pool), NULL, 0);
+    } else {
+        rc = tc_ctr_prng_init(&sys_rand_drbg, sys_rand_pool,
+                              sizeof(sys_rand_pool), NULL, 0);
+        sys_rand_seeded = rc == TC_CRYPTO_SUCCESS;
+    }
+
+    memset(sys_rand_pool, 0, sizeof(sys_rand_pool));
+    sys_rand_pool_len = 0;
+    sys_rand_since_reseed = 0;
+    sys_rand_pool_schedule();
+
+    return rc == TC_CRYPTO_SUCCESS ? 0 : SYS_EUNKNOWN;
+}
+
+int
+sys_rand_fill(void *buf, size_t len)
+{
+    uint8_t *dst;
+    size_t chunk;
+    int rc;
+
+    dst = buf;
+
+    os_mutex_pend(&sys_rand_mtx, OS_TIMEOUT_NEVER);
+
+    rc = 0;
+    if (!sys_rand_seeded ||
+        sys_rand_since_reseed >= MYNEWT_VAL(SYS_RAND_RESEED_MAX_BYTES)) {
+        rc = sys_rand_reseed(1);
+    } else if (sys_rand_since_reseed >= MYNEWT_VAL(SYS_RAND_RESEED_BYTES)) {
+        rc = sys_rand_reseed(0);
+    }
+
+    while (rc == 0 && len > 0) {
+        chunk = min(len, SYS_RAND_MAX_REQ);
+        switch (tc_ctr_prng_generate(&sys_rand_drbg, NULL, 0, dst, chunk)) {
+        case TC_CRYPTO_SUCCESS:
+            dst += chunk;
+            len -= chunk;
+            if (sys_rand_since_reseed < UINT32_MAX - chunk) {
+                sys_rand_since_reseed += chunk;
+            }
+            break;
+        case TC_CTR_PRNG_RESEED_REQ:
+            rc = sys_rand_reseed(1);
+            break;
+        default:
+            rc = SYS_EUNKNOWN;
+            break;
+        }
+    }
+
+    os_mutex_release(&sys_rand_mtx);
+
+    return rc;
+}
+
+uint32_t
+sys_rand_u32(void)
+{
+    uint32_t val;
+    int rc;
+
+    rc = sys_rand_fill(&val, sizeof(val));
+    assert(rc == 0);
+
+    return val;
+}
+
+void
+sys_rand_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = os_mutex_init(&sys_rand_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    sys_rand_trng = (struct trng_dev *)os_dev_open(
+        MYNEWT_VAL(SYS_RAND_TRNG_DEV_NAME), OS_WAIT_FOREVER, NULL);
+    SYSINIT_PANIC_ASSERT(sys_rand_trng != NULL);
+
+    /* Start filling the pool, so the first request finds it ready. */
+    os_callout_init(&sys_rand_callout, os_eventq_dflt_get(),
+                    sys_rand_pool_cb, NULL);
+    os_callout_reset(&sys_rand_callout, 0);
+}
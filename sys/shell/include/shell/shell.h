@@ -165,6 +165,53 @@ void shell_evq_set(struct os_eventq *evq);
  */
 int shell_exec(int argc, char **argv, struct streamer *streamer);
 
+#if MYNEWT_VAL(SHELL_STREAM)
+struct shell_stream;
+
+/**
+ * One step of a streaming command.  Should write a bounded amount of output
+ * and return.
+ *
+ * @return                      SHELL_STREAM_MORE to be called again; 0 when
+ *                              done; SYS_E[...] on failure.
+ */
+typedef int (*shell_stream_func_t)(struct shell_stream *ss);
+
+#define SHELL_STREAM_MORE       1
+
+struct shell_stream {
+    /** Where output goes. */
+    struct streamer *ss_streamer;
+    /** Passed to shell_stream_start(). */
+    void *ss_arg;
+    /** Free for the command to use; 0 on the first step. */
+    uint32_t ss_cursor;
+};
+
+/**
+ * Turns the running command into a streaming one: after the command
+ * handler returns, the shell calls fn step by step from its event queue,
+ * so console input and other events are handled in between.  CTRL-C stops
+ * the stream before the next step; fn is not told, so it should not keep
+ * resources between steps.  Other command lines are refused while a stream
+ * is running.
+ *
+ * Must be called from a command handler.  The handler's argv is not valid
+ * anymore once it returned.  When the output does not go to the console
+ * (e.g. a command run over SMP), fn runs to completion before the handler
+ * returns.
+ *
+ * @param fn                    The step function.
+ * @param arg                   Passed to fn in ss_arg.
+ * @param streamer              The streamer the command was given.
+ *
+ * @return                      0 on success; SYS_EBUSY if a stream is
+ *                              running already.  On SMP, the result of fn.
+ */
+int shell_stream_start(shell_stream_func_t fn, void *arg,
+                       struct streamer *streamer);
+#endif
+
 #if MYNEWT_VAL(SHELL_MGMT)
 struct os_mbuf;
 typedef int (*shell_nlip_input_func_t)(struct os_mbuf *, void *arg);
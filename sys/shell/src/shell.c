@@ -45,6 +45,16 @@ static struct os_eventq *shell_evq;
 static struct os_event shell_console_ev[MYNEWT_VAL(SHELL_MAX_CMD_QUEUED)];
 static struct console_input buf[MYNEWT_VAL(SHELL_MAX_CMD_QUEUED)];
 
+#if MYNEWT_VAL(SHELL_STREAM)
+static struct {
+    shell_stream_func_t fn;
+    struct shell_stream ss;
+    struct os_callout step;
+    uint8_t active;
+    volatile uint8_t cancel;
+} shell_stream_state;
+#endif
+
 void
 shell_evq_set(struct os_eventq *evq)
 {
@@ -415,6 +425,9 @@ shell_exec(int argc, char **argv, struct streamer *streamer)
     size_t argc_offset = 0;
     int rc;
     int def_module = default_module;
+#if MYNEWT_VAL(SHELL_STREAM)
+    uint8_t stream_active;
+#endif
 
     cmd = shell_find_cmd(argc, argv, streamer);
     if (!cmd) {
@@ -440,6 +453,10 @@ shell_exec(int argc, char **argv, struct streamer *streamer)
         argc_offset = 1;
     }
 
+#if MYNEWT_VAL(SHELL_STREAM)
+    stream_active = shell_stream_state.active;
+#endif
+
     /* Execute callback with arguments */
     if (!cmd->sc_ext) {
         rc = cmd->sc_cmd_func(argc - argc_offset, &argv[argc_offset]);
@@ -451,11 +468,103 @@ shell_exec(int argc, char **argv, struct streamer *streamer)
         show_cmd_help(argv, streamer);
     }
 
+#if MYNEWT_VAL(SHELL_STREAM)
+    if (!stream_active && shell_stream_state.active) {
+        if (rc >= 0) {
+            /* The prompt follows the last step. */
+            return rc;
+        }
+        shell_stream_state.active = 0;
+    }
+#endif
+
     print_prompt_if_console(streamer);
 
     return rc;
 }
 
+#if MYNEWT_VAL(SHELL_STREAM)
+static void
+shell_stream_schedule(void)
+{
+    os_callout_reset(&shell_stream_state.step,
+                     MYNEWT_VAL(SHELL_STREAM_STEP_TICKS));
+}
+
+static void
+shell_stream_step(struct os_event *ev)
+{
+    struct streamer *streamer;
+    int rc;
+
+    if (!shell_stream_state.active) {
+        return;
+    }
+
+    streamer = shell_stream_state.ss.ss_streamer;
+    if (shell_stream_state.cancel) {
+        streamer_printf(streamer, "^C\n");
+        rc = 0;
+    } else {
+        rc = shell_stream_state.fn(&shell_stream_state.ss);
+        if (rc == SHELL_STREAM_MORE) {
+            shell_stream_schedule();
+            return;
+        }
+    }
+
+    shell_stream_state.active = 0;
+    if (rc < 0) {
+        streamer_printf(streamer, "Error: %d\n", rc);
+    }
+    print_prompt_if_console(streamer);
+}
+
+static void
+shell_stream_interrupt(void)
+{
+    if (shell_stream_state.active) {
+        shell_stream_state.cancel = 1;
+    }
+}
+
+int
+shell_stream_start(shell_stream_func_t fn, void *arg,
+                   struct streamer *streamer)
+{
+    struct shell_stream ss;
+    int rc;
+
+    if (streamer != streamer_console_get()) {
+        /* Nobody to hand the output to later; do it all now. */
+        ss.ss_streamer = streamer;
+        ss.ss_arg = arg;
+        ss.ss_cursor = 0;
+        do {
+            rc = fn(&ss);
+        } while (rc == SHELL_STREAM_MORE);
+        return rc;
+    }
+
+    if (shell_stream_state.active) {
+        return SYS_EBUSY;
+    }
+
+    shell_stream_state.fn = fn;
+    shell_stream_state.ss.ss_streamer = streamer;
+    shell_stream_state.ss.ss_arg = arg;
+    shell_stream_state.ss.ss_cursor = 0;
+    shell_stream_state.cancel = 0;
+    shell_stream_state.active = 1;
+
+    os_callout_init(&shell_stream_state.step, shell_evq, shell_stream_step,
+                    NULL);
+    shell_stream_schedule();
+
+    return 0;
+}
+#endif
+
 static void
 shell_process_command(char *line, struct streamer *streamer)
 {
@@ -468,6 +577,14 @@ shell_process_command(char *line, struct streamer *streamer)
         return;
     }
 
+#if MYNEWT_VAL(SHELL_STREAM)
+    if (shell_stream_state.active && streamer == streamer_console_get()) {
+        streamer_printf(streamer,
+                        "Command in progress; CTRL-C to cancel it\n");
+        return;
+    }
+#endif
+
     shell_exec(argc, argv, streamer);
 }
 
@@ -1027,6 +1144,10 @@ shell_init(void)
     console_set_completion_cb(completion);
 #endif
 
+#if MYNEWT_VAL(SHELL_STREAM)
+    console_set_interrupt_cb(shell_stream_interrupt);
+#endif
+
 #if MYNEWT_VAL(SHELL_OS_MODULE)
     shell_os_register();
 #endif
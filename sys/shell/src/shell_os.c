@@ -21,6 +21,7 @@
 #include <string.h>
 
 #include "os/mynewt.h"
+#include "os/os_budget.h"
 #include "datetime/datetime.h"
 #include "console/console.h"
 
@@ -38,6 +39,9 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
 {
     struct os_task *prev_task;
     struct os_task_info oti;
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    struct os_sched_trace_info osti;
+#endif
     char *name;
     int found;
 
@@ -50,9 +54,14 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
 
     streamer_printf(streamer, "Tasks: \n");
     prev_task = NULL;
-    streamer_printf(streamer, "%8s %3s %3s %8s %8s %8s %8s %8s %8s %3s\n",
+    streamer_printf(streamer, "%8s %3s %3s %8s %8s %8s %8s %8s %8s %3s",
       "task", "pri", "tid", "runtime", "csw", "stksz", "stkuse",
       "lcheck", "ncheck", "flg");
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    streamer_printf(streamer, " %4s %8s %8s %8s",
+                    "load", "latmax", "latavg", "burst");
+#endif
+    streamer_printf(streamer, "\n");
     while (1) {
         prev_task = os_task_info_get_next(prev_task, &oti);
         if (prev_task == NULL) {
@@ -67,12 +76,20 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
             }
         }
 
-        streamer_printf(streamer, "%8s %3u %3u %8lu %8lu %8u %8u %8lu %8lu\n",
+        streamer_printf(streamer, "%8s %3u %3u %8lu %8lu %8u %8u %8lu %8lu",
                 oti.oti_name, oti.oti_prio, oti.oti_taskid,
                 (unsigned long)oti.oti_runtime, (unsigned long)oti.oti_cswcnt,
                 oti.oti_stksize, oti.oti_stkusage,
                 (unsigned long)oti.oti_last_checkin,
                 (unsigned long)oti.oti_next_checkin);
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+        /* Padding for the flg column */
+        streamer_printf(streamer, "     %3u%% %8lu %8lu %8lu",
+                oti.oti_load, (unsigned long)oti.oti_lat_max,
+                (unsigned long)oti.oti_lat_avg,
+                (unsigned long)oti.oti_burst_max);
+#endif
+        streamer_printf(streamer, "\n");
 
     }
 
@@ -80,6 +97,19 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
         streamer_printf(streamer, "Couldn't find task with name %s\n", name);
     }
 
+#if MYNEWT_VAL(OS_SCHED_TRACE)
+    if (!name) {
+        os_sched_trace_get(&osti);
+        streamer_printf(streamer, "wakeups %lu, latency <10us %lu, "
+                        "<100us %lu, <1ms %lu, >=1ms %lu\n",
+                        (unsigned long)osti.osti_wakeups,
+                        (unsigned long)osti.osti_lat_lt_10us,
+                        (unsigned long)osti.osti_lat_lt_100us,
+                        (unsigned long)osti.osti_lat_lt_1ms,
+                        (unsigned long)osti.osti_lat_ge_1ms);
+    }
+#endif
+
     return 0;
 }
 
@@ -87,6 +117,7 @@ int
 shell_os_mpool_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
                            struct streamer *streamer)
 {
+    struct os_mbuf_pool *omp;
     struct os_mempool *mp;
     struct os_mempool_info omi;
     char *name;
@@ -127,8 +158,286 @@ shell_os_mpool_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
                 name);
     }
 
+    if (name) {
+        return 0;
+    }
+
+    streamer_printf(streamer, "Msys pools: \n");
+    streamer_printf(streamer, "%32s %5s %5s %8s %8s\n",
+                    "name", "blksz", "hiwat", "fail", "fallback");
+    omp = NULL;
+    while (1) {
+        omp = os_msys_pool_get_next(omp);
+        if (omp == NULL) {
+            break;
+        }
+
+        mp = omp->omp_pool;
+        streamer_printf(streamer, "%32s %5d %5d %8lu %8lu\n",
+                        mp->name ? mp->name : "", (int)mp->mp_block_size,
+                        (int)(mp->mp_num_blocks - mp->mp_min_free),
+                        (unsigned long)omp->omp_num_fail,
+                        (unsigned long)omp->omp_num_fallback);
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+int
+shell_os_mutex_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                           struct streamer *streamer)
+{
+    struct os_mutex *mu;
+    struct os_mutex_info omi;
+
+    streamer_printf(streamer, "Mutexes: \n");
+    streamer_printf(streamer, "%16s %8s %8s %8s %8s %8s\n",
+                    "name", "owner", "cont", "wait", "maxwait", "maxowner");
+    mu = NULL;
+    while (1) {
+        mu = os_mutex_info_get_next(mu, &omi);
+        if (mu == NULL) {
+            break;
+        }
+
+        streamer_printf(streamer, "%16s %8s %8lu %8lu %8lu %8s\n",
+                        omi.omi_name ? omi.omi_name : "",
+                        omi.omi_owner ? omi.omi_owner : "-",
+                        (unsigned long)omi.omi_num_contended,
+                        (unsigned long)omi.omi_wait_total,
+                        (unsigned long)omi.omi_wait_max,
+                        omi.omi_wait_max_owner ? omi.omi_wait_max_owner : "-");
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(OS_IDLE_STATS)
+int
+shell_os_idle_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                          struct streamer *streamer)
+{
+    struct os_idle_info oii;
+
+    os_idle_info_get(&oii);
+
+    streamer_printf(streamer, "Idle: \n");
+    streamer_printf(streamer, "%10s %12s %8s %10s\n",
+                    "wakeups", "sleep_ticks", "wake/s", "avg_sleep");
+    streamer_printf(streamer, "%10lu %12llu %8lu %10lu\n",
+                    (unsigned long)oii.oii_wakeups,
+                    (unsigned long long)oii.oii_sleep_ticks,
+                    (unsigned long)oii.oii_wakeups_per_sec,
+                    (unsigned long)oii.oii_avg_sleep_ticks);
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+static unsigned long
+shell_os_evq_usecs(uint32_t ticks)
+{
+    return (unsigned long)os_cputime_ticks_to_usecs(ticks);
+}
+
+int
+shell_os_evq_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                         struct streamer *streamer)
+{
+    const struct os_eventq_mon *mon;
+    struct os_eventq *evq;
+    int i;
+
+    evq = NULL;
+    if (argc > 1 && !strcmp(argv[1], "clear")) {
+        while ((evq = os_eventq_mon_get_next(evq)) != NULL) {
+            os_eventq_mon_clear(evq);
+        }
+        return 0;
+    }
+
+    while ((evq = os_eventq_mon_get_next(evq)) != NULL) {
+        streamer_printf(streamer, "evq %s: %lu calls missed\n",
+                        evq->evq_owner ? evq->evq_owner->t_name : "-",
+                        (unsigned long)evq->evq_mon_miss);
+        streamer_printf(streamer, "%10s %8s %8s %8s %8s %8s\n",
+                        "cb", "cnt", "avg", "max", "qavg", "qmax");
+        for (i = 0; i < evq->evq_mon_elems; i++) {
+            mon = &evq->evq_mon[i];
+            if (mon->em_cb == NULL || mon->em_cnt == 0) {
+                continue;
+            }
+            streamer_printf(streamer, "0x%08lx %8lu %8lu %8lu %8lu %8lu\n",
+                            (unsigned long)(uintptr_t)mon->em_cb,
+                            (unsigned long)mon->em_cnt,
+                            shell_os_evq_usecs(mon->em_cum / mon->em_cnt),
+                            shell_os_evq_usecs(mon->em_max),
+                            shell_os_evq_usecs(mon->em_qcum / mon->em_cnt),
+                            shell_os_evq_usecs(mon->em_qmax));
+        }
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+#define SHELL_OS_MPSITES_MAX    16
+
+int
+shell_os_mpsites_display_cmd(const struct shell_cmd *cmd, int argc,
+                             char **argv, struct streamer *streamer)
+{
+    static struct os_mempool_site sites[SHELL_OS_MPSITES_MAX];
+    int num;
+    int i;
+
+    num = os_mempool_sites_get(sites, SHELL_OS_MPSITES_MAX);
+
+    streamer_printf(streamer, "%32s %10s %5s %8s %8s\n",
+                    "name", "pc", "cnt", "bytes", "maxage");
+    for (i = 0; i < num; i++) {
+        streamer_printf(streamer, "%32s 0x%08lx %5u %8lu %8lu\n",
+                        sites[i].oms_pool->name ? sites[i].oms_pool->name : "",
+                        (unsigned long)sites[i].oms_pc,
+                        sites[i].oms_count,
+                        (unsigned long)sites[i].oms_bytes,
+                        (unsigned long)os_time_ticks_to_ms32(
+                            sites[i].oms_max_age));
+    }
+    if (num == SHELL_OS_MPSITES_MAX) {
+        streamer_printf(streamer, "(sites beyond the first %d not shown)\n",
+                        num);
+    }
+
     return 0;
 }
+#endif
+
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+int
+shell_os_heap_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                          struct streamer *streamer)
+{
+    struct os_heap_info ohi;
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    struct os_task *prev_task;
+    struct os_task_info oti;
+#endif
+
+    os_heap_info_get(&ohi);
+
+    streamer_printf(streamer, "Heap: \n");
+    streamer_printf(streamer, "%8s %8s %8s %8s %5s %5s %5s %8s\n",
+                    "total", "free", "min", "maxblk", "nfree", "nused",
+                    "frag%", "fail");
+    streamer_printf(streamer, "%8lu %8lu %8lu %8lu %5lu %5lu %5u %8lu\n",
+                    (unsigned long)ohi.ohi_total, (unsigned long)ohi.ohi_free,
+                    (unsigned long)ohi.ohi_min_free,
+                    (unsigned long)ohi.ohi_max_free_blk,
+                    (unsigned long)ohi.ohi_num_free_blks,
+                    (unsigned long)ohi.ohi_num_used_blks,
+                    ohi.ohi_frag_pct, (unsigned long)ohi.ohi_num_fail);
+
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    streamer_printf(streamer, "%8s %8s\n", "task", "bytes");
+    prev_task = NULL;
+    while (1) {
+        prev_task = os_task_info_get_next(prev_task, &oti);
+        if (prev_task == NULL) {
+            break;
+        }
+
+        streamer_printf(streamer, "%8s %8lu\n", oti.oti_name,
+                        (unsigned long)oti.oti_heap_bytes);
+    }
+#endif
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(SHELL_OS_BUDGET_CMD)
+/*
+ * Prints each task's stack peak and held memory, and each pool's peak
+ * block count, next to the sizes suggested for them.
+ */
+int
+shell_os_budget_display_cmd(const struct shell_cmd *cmd, int argc,
+                            char **argv, struct streamer *streamer)
+{
+    struct os_mempool_budget omb;
+    struct os_task_budget otb;
+    struct os_mempool *prev_mp;
+    struct os_task *prev_task;
+    uint32_t stack_reclaim;
+    uint32_t pool_reclaim;
+
+    stack_reclaim = 0;
+    streamer_printf(streamer, "Tasks: \n");
+    streamer_printf(streamer, "%8s %3s %6s %6s %6s", "task", "id", "stksz",
+                    "stkmax", "stksug");
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+    streamer_printf(streamer, " %8s", "heap");
+#endif
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    streamer_printf(streamer, " %5s %8s", "pblks", "pbytes");
+#endif
+    streamer_printf(streamer, "\n");
+
+    prev_task = NULL;
+    while (1) {
+        prev_task = os_task_budget_get_next(prev_task, &otb);
+        if (prev_task == NULL) {
+            break;
+        }
+
+        streamer_printf(streamer, "%8s %3u %6lu %6lu %6lu", otb.otb_name,
+                        otb.otb_taskid, (unsigned long)otb.otb_stack_size,
+                        (unsigned long)otb.otb_stack_peak,
+                        (unsigned long)otb.otb_stack_suggest);
+#if MYNEWT_VAL(OS_HEAP_TLSF_TASK_STATS)
+        streamer_printf(streamer, " %8lu", (unsigned long)otb.otb_heap_bytes);
+#endif
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+        streamer_printf(streamer, " %5u %8lu", otb.otb_pool_blocks,
+                        (unsigned long)otb.otb_pool_bytes);
+#endif
+        streamer_printf(streamer, "\n");
+
+        if (otb.otb_stack_suggest < otb.otb_stack_size) {
+            stack_reclaim += otb.otb_stack_size - otb.otb_stack_suggest;
+        }
+    }
+
+    pool_reclaim = 0;
+    streamer_printf(streamer, "Mempools: \n");
+    streamer_printf(streamer, "%32s %5s %5s %5s %5s %8s\n", "name", "blksz",
+                    "cnt", "peak", "sug", "reclaim");
+    prev_mp = NULL;
+    while (1) {
+        prev_mp = os_mempool_budget_get_next(prev_mp, &omb);
+        if (prev_mp == NULL) {
+            break;
+        }
+
+        streamer_printf(streamer, "%32s %5lu %5u %5u %5u %8lu\n",
+                        omb.omb_name, (unsigned long)omb.omb_block_size,
+                        omb.omb_num_blocks, omb.omb_peak_blocks,
+                        omb.omb_suggest_blocks,
+                        (unsigned long)omb.omb_reclaim_bytes);
+        pool_reclaim += omb.omb_reclaim_bytes;
+    }
+
+    streamer_printf(streamer, "Reclaimable: stacks %lu, mempools %lu bytes\n",
+                    (unsigned long)stack_reclaim, (unsigned long)pool_reclaim);
+
+    return 0;
+}
+#endif
 
 int
 shell_os_date_cmd(const struct shell_cmd *cmd, int argc, char **argv,
@@ -236,6 +545,59 @@ static const struct shell_cmd_help mpool_help = {
     .params = mpool_params,
 };
 
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+static const struct shell_cmd_help mutex_help = {
+    .summary = "show os mutex contention",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
+#if MYNEWT_VAL(OS_IDLE_STATS)
+static const struct shell_cmd_help idle_help = {
+    .summary = "show idle wakeup statistics",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+static const struct shell_param evq_params[] = {
+    {"clear", "clear the collected data"},
+    {NULL, NULL}
+};
+
+static const struct shell_cmd_help evq_help = {
+    .summary = "show event callback run and queueing times, in usecs",
+    .usage = NULL,
+    .params = evq_params,
+};
+#endif
+
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+static const struct shell_cmd_help mpsites_help = {
+    .summary = "show mempool blocks held, by allocation site",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+static const struct shell_cmd_help heap_help = {
+    .summary = "show os_malloc heap usage",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
+#if MYNEWT_VAL(SHELL_OS_BUDGET_CMD)
+static const struct shell_cmd_help budget_help = {
+    .summary = "show task and mempool memory use with suggested sizes",
+    .usage = NULL,
+    .params = NULL,
+};
+#endif
+
 #if (MYNEWT_VAL(SHELL_OS_DATETIME_CMD) & 2) == 2
 static const struct shell_param date_params[] = {
     {"", "datetime to set"},
@@ -276,6 +638,24 @@ static const struct shell_cmd_help ls_dev_help = {
 static const struct shell_cmd os_commands[] = {
     SHELL_CMD_EXT("tasks", shell_os_tasks_display_cmd, &tasks_help),
     SHELL_CMD_EXT("mpool", shell_os_mpool_display_cmd, &mpool_help),
+#if MYNEWT_VAL(OS_MEMPOOL_TRACK)
+    SHELL_CMD_EXT("mpsites", shell_os_mpsites_display_cmd, &mpsites_help),
+#endif
+#if MYNEWT_VAL(OS_MUTEX_STATS)
+    SHELL_CMD_EXT("mutex", shell_os_mutex_display_cmd, &mutex_help),
+#endif
+#if MYNEWT_VAL(OS_IDLE_STATS)
+    SHELL_CMD_EXT("idle", shell_os_idle_display_cmd, &idle_help),
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_MONITOR)
+    SHELL_CMD_EXT("evq", shell_os_evq_display_cmd, &evq_help),
+#endif
+#if MYNEWT_VAL(OS_HEAP_TLSF)
+    SHELL_CMD_EXT("heap", shell_os_heap_display_cmd, &heap_help),
+#endif
+#if MYNEWT_VAL(SHELL_OS_BUDGET_CMD)
+    SHELL_CMD_EXT("budget", shell_os_budget_display_cmd, &budget_help),
+#endif
     SHELL_CMD_EXT("date", shell_os_date_cmd, &date_help),
     SHELL_CMD_EXT("reset", shell_os_reset_cmd, &reset_help),
     SHELL_CMD_EXT("reset_cause", shell_os_print_reset_cause, &print_reset_cause_help),
@@ -48,6 +48,10 @@ struct stats_hdr {
     int s_map_cnt;
 #endif
     STAILQ_ENTRY(stats_hdr) s_next;
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+    /* Next group in the same name index bucket. */
+    struct stats_hdr *s_hash_next;
+#endif
 };
 
 /**
@@ -84,6 +88,37 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_SECT_ENTRY32(__var) uint32_t STATS_SECT_VAR(__var);
 #define STATS_SECT_ENTRY64(__var) uint64_t STATS_SECT_VAR(__var);
 
+/** Number of buckets in a histogram stat; STATS_NAME_HIST() names 16. */
+#define STATS_HIST_BUCKETS  16
+
+/**
+ * A histogram of unsigned 32-bit samples, e.g. latencies.
+ *
+ * Bucket 0 counts samples of 0 and bucket n counts samples in
+ * [2^(n-1), 2^n - 1]; the last bucket also counts all larger samples.  The
+ * p50 and p99 fields hold the upper bound of the bucket containing that
+ * percentile, clamped to the range of recorded samples.
+ *
+ * All fields are 32-bit stats, so a histogram can only be placed in a group
+ * of 32-bit entries.  Each field is reported by stats_walk(), and thus by
+ * the shell and management interfaces, like any other entry.
+ */
+struct stats_hist {
+    uint32_t sh_cnt;
+    uint32_t sh_min;
+    uint32_t sh_max;
+    /** Sum of all samples; wraps. */
+    uint32_t sh_sum;
+    uint32_t sh_p50;
+    uint32_t sh_p99;
+    uint32_t sh_bucket[STATS_HIST_BUCKETS];
+};
+
+/**
+ * @brief Declares a histogram stat.  The group must use STATS_SIZE_32.
+ */
+#define STATS_SECT_HIST(__var) struct stats_hist STATS_SECT_VAR(__var);
+
 /**
  * @brief Resets all stats in the provided group to 0.
  *
@@ -169,6 +204,59 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_CLEAR(__sectvarname, __var)           \
     STATS_SET(__sectvarname, __var, 0)
 
+/**
+ * @brief Atomically adjusts a stat's value by the specified delta.
+ *
+ * Unlike `STATS_INCN()`, no increments are lost if the stat is modified from
+ * several tasks or interrupt handlers at once.  On cores with exclusive
+ * load/store instructions (Cortex-M3 and up) this is a lock-free update;
+ * elsewhere, and for 64-bit stats on 32-bit cores, interrupts are briefly
+ * disabled instead.
+ *
+ * If the specified stat group is persistent, this also schedules the group to
+ * be flushed to disk.
+ *
+ * @param __sectvarname         The name of the stat group containing the stat
+ *                                  to modify.
+ * @param __var                 The name of the individual stat to modify.
+ * @param __n                   The amount to add to the specified stat.
+ */
+#define STATS_INCN_ATOMIC(__sectvarname, __var, __n) do         \
+{                                                               \
+    stats_incn_atomic(&STATS_GET(__sectvarname, __var),         \
+                      sizeof(STATS_GET(__sectvarname, __var)),  \
+                      (__n));                                   \
+    STATS_PERSIST_SCHED((struct stats_hdr *)&__sectvarname);    \
+} while (0)
+
+/**
+ * @brief Atomically increments a stat's value.  See `STATS_INCN_ATOMIC()`.
+ *
+ * @param __sectvarname         The name of the stat group containing the stat
+ *                                  to modify.
+ * @param __var                 The name of the individual stat to modify.
+ */
+#define STATS_INC_ATOMIC(__sectvarname, __var)      \
+    STATS_INCN_ATOMIC(__sectvarname, __var, 1)
+
+/**
+ * @brief Adds a sample to a histogram stat.
+ *
+ * If the specified stat group is persistent, this also schedules the group to
+ * be flushed to disk.
+ *
+ * @param __sectvarname         The name of the stat group containing the
+ *                                  histogram.
+ * @param __var                 The name of the histogram, declared with
+ *                                  `STATS_SECT_HIST()`.
+ * @param __val                 The sample to record.
+ */
+#define STATS_HIST_RECORD(__sectvarname, __var, __val) do       \
+{                                                               \
+    stats_hist_record(&STATS_GET(__sectvarname, __var), (__val)); \
+    STATS_PERSIST_SCHED((struct stats_hdr *)&__sectvarname);    \
+} while (0)
+
 #if MYNEWT_VAL(STATS_NAMES)
 
 #define STATS_NAME_MAP_NAME(__sectname) g_stats_map_ ## __sectname
@@ -183,6 +271,39 @@ const struct stats_name_map STATS_NAME_MAP_NAME(__sectname)[] = {
 #define STATS_NAME_END(__sectname)                                          \
 };
 
+#define STATS_NAME_HIST_FIELD(__sectname, __entry, __field, __suffix)       \
+    { offsetof(STATS_SECT_DECL(__sectname),                                 \
+               STATS_SECT_VAR(__entry).__field),                            \
+      #__entry __suffix },
+
+/**
+ * @brief Names the fields of a histogram stat `<entry>_cnt`, `<entry>_min`,
+ * ..., `<entry>_p99`, `<entry>_b0` to `<entry>_b15`.
+ */
+#define STATS_NAME_HIST(__sectname, __entry)                                \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_cnt, "_cnt")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_min, "_min")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_max, "_max")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_sum, "_sum")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_p50, "_p50")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_p99, "_p99")              \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[0], "_b0")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[1], "_b1")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[2], "_b2")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[3], "_b3")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[4], "_b4")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[5], "_b5")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[6], "_b6")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[7], "_b7")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[8], "_b8")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[9], "_b9")         \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[10], "_b10")       \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[11], "_b11")       \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[12], "_b12")       \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[13], "_b13")       \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[14], "_b14")       \
+    STATS_NAME_HIST_FIELD(__sectname, __entry, sh_bucket[15], "_b15")
+
 #define STATS_NAME_INIT_PARMS(__name)                                       \
     &(STATS_NAME_MAP_NAME(__name)[0]),                                      \
     (sizeof(STATS_NAME_MAP_NAME(__name)) / sizeof(struct stats_name_map))
@@ -192,6 +313,7 @@ const struct stats_name_map STATS_NAME_MAP_NAME(__sectname)[] = {
 #define STATS_NAME_START(__name)
 #define STATS_NAME(__name, __entry)
 #define STATS_NAME_END(__name)
+#define STATS_NAME_HIST(__name, __entry)
 #define STATS_NAME_INIT_PARMS(__name) NULL, 0
 
 #endif /* MYNEWT_VAL(STATS_NAME) */
@@ -203,6 +325,8 @@ int stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint8_t cnt,
                        const struct stats_name_map *map, uint8_t map_cnt,
                        const char *name);
 void stats_reset(struct stats_hdr *shdr);
+void stats_hist_record(struct stats_hist *hist, uint32_t val);
+void stats_incn_atomic(void *stat, uint8_t size, uint32_t n);
 
 typedef int (*stats_walk_func_t)(struct stats_hdr *, void *, char *,
         uint16_t);
@@ -315,6 +439,78 @@ int stats_persist_init(struct stats_hdr *hdr, uint8_t size,
 
 #endif /* MYNEWT_VAL(STATS_PERSIST) */
 
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+
+struct os_mbuf;
+
+/**
+ * @brief Receives an encoded stats snapshot.
+ *
+ * @param om                    The CBOR-encoded snapshot.  The callback takes
+ *                                  ownership of the mbuf.
+ * @param arg                   The argument given to `stats_snap_init()`.
+ */
+typedef void stats_snap_fn(struct os_mbuf *om, void *arg);
+
+/**
+ * Periodic snapshot of the changes to all registered stats.  Each snapshot
+ * holds, in CBOR, the amount by which every stat changed since the previous
+ * one; stats and groups which did not change are left out.
+ */
+struct stats_snap {
+    /** Value of each stat at the previous snapshot. */
+    uint32_t *ss_prev;
+    uint16_t ss_prev_cnt;
+    /** Snapshots dropped since the last one delivered. */
+    uint16_t ss_lost;
+    uint32_t ss_seq;
+    os_time_t ss_itvl;
+    stats_snap_fn *ss_cb;
+    void *ss_arg;
+    struct os_callout ss_timer;
+};
+
+/**
+ * @brief Initializes a stats snapshot.
+ *
+ * The first snapshot reports the value of every non-zero stat.
+ *
+ * @param snap                  The snapshot to initialize.
+ * @param prev                  Storage for the previous value of each stat;
+ *                                  one element per stat in all groups.
+ *                                  Stats which do not fit are not reported.
+ * @param prev_cnt              The number of elements in `prev`.
+ * @param cb                    Called with each encoded snapshot.
+ * @param arg                   Passed to `cb`.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int stats_snap_init(struct stats_snap *snap, uint32_t *prev, uint16_t prev_cnt,
+                    stats_snap_fn *cb, void *arg);
+
+/**
+ * @brief Takes a snapshot every `itvl` ticks, from the default event queue.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int stats_snap_start(struct stats_snap *snap, os_time_t itvl);
+
+/**
+ * @brief Stops taking periodic snapshots.
+ */
+void stats_snap_stop(struct stats_snap *snap);
+
+/**
+ * @brief Takes a snapshot now and passes it to the snapshot's callback.
+ *
+ * @return                      0 on success;
+ *                              OS_ENOMEM if the snapshot could not be
+ *                                  encoded, or did not include all stats.
+ */
+int stats_snap_take(struct stats_snap *snap);
+
+#endif /* MYNEWT_VAL(STATS_SNAPSHOT) */
+
 #ifdef __cplusplus
 }
 #endif
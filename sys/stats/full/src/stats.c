@@ -22,6 +22,7 @@
 #include <stdio.h>
 
 #include "os/mynewt.h"
+#include "rcu/rcu.h"
 #include "stats/stats.h"
 #include "stats_priv.h"
 
@@ -58,6 +59,10 @@
  *
  * - STATS_SECT_ENTRY64(): 64-bits.  Useful for storing chunks of data.
  *
+ * - STATS_SECT_HIST(): a histogram of 32-bit samples (count, min, max, sum,
+ *   p50, p99 and log2 buckets), updated with STATS_HIST_RECORD().  Its
+ *   fields are 32-bit entries, so it only fits in a 32-bit structure.
+ *
  * Following the statics entry declaration is the statistic names declaration.
  * This is compiled out when STATS_NAME_ENABLE is set to 0.  This declaration
  * is const, and therefore can be located in .text, not .data.
@@ -77,8 +82,27 @@ STATS_NAME_START(stats)
     STATS_NAME(stats, num_registered)
 STATS_NAME_END(stats)
 
+/*
+ * Whether stats of the given size can be updated with lock-free atomics.  The
+ * ACLE macro has a bit set for each supported access size in bytes.
+ */
+#if defined(__ARM_FEATURE_LDREX)
+#define STATS_ATOMIC(__size)    (__ARM_FEATURE_LDREX & (__size))
+#elif defined(__arm__)
+#define STATS_ATOMIC(__size)    0
+#else
+#define STATS_ATOMIC(__size)    1
+#endif
+
+/*
+ * Groups are never unregistered, so the registry and the name index are read
+ * without locking.  Registration links a group in only after it is set up.
+ */
 struct stats_registry_list g_stats_registry =
     STAILQ_HEAD_INITIALIZER(g_stats_registry);
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+static struct stats_hdr *g_stats_name_hash[MYNEWT_VAL(STATS_NAME_HASH_SIZE)];
+#endif
 
 static size_t
 stats_offset(const struct stats_hdr *hdr)
@@ -105,6 +129,30 @@ stats_data(const struct stats_hdr *hdr)
     return (uint8_t *)hdr + offset;
 }
 
+static void
+stats_registry_insert(struct stats_hdr *shdr)
+{
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+    struct stats_hdr **bucket;
+#endif
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    STAILQ_NEXT(shdr, s_next) = NULL;
+    RCU_ASSIGN_PTR(*g_stats_registry.stqh_last, shdr);
+    g_stats_registry.stqh_last = &STAILQ_NEXT(shdr, s_next);
+
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+    bucket = &g_stats_name_hash[rcu_name_hash(shdr->s_name) %
+                                MYNEWT_VAL(STATS_NAME_HASH_SIZE)];
+    shdr->s_hash_next = *bucket;
+    RCU_ASSIGN_PTR(*bucket, shdr);
+#endif
+
+    OS_EXIT_CRITICAL(sr);
+}
+
 static int
 stats_register_internal(const char *name, struct stats_hdr *shdr)
 {
@@ -129,7 +177,7 @@ stats_register_internal(const char *name, struct stats_hdr *shdr)
     }
 #endif
 
-    STAILQ_INSERT_TAIL(&g_stats_registry, shdr, s_next);
+    stats_registry_insert(shdr);
 
     STATS_INC(g_stats_stats, num_registered);
 
@@ -144,6 +192,9 @@ stats_module_init_internal(void)
     int rc;
 
     STAILQ_INIT(&g_stats_registry);
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+    memset(g_stats_name_hash, 0, sizeof g_stats_name_hash);
+#endif
 
     rc = stats_init(STATS_HDR(g_stats_stats),
                     STATS_SIZE_INIT_PARMS(g_stats_stats, STATS_SIZE_32),
@@ -338,8 +389,8 @@ err:
 }
 
 /**
- * Find a statistics structure by name, this is not thread-safe.
- * (assumption: all statistics are registered prior ot OS start.)
+ * Find a statistics structure by name.  Safe to call concurrently with
+ * stats_register().
  *
  * @param name The statistic structure name to find
  *
@@ -350,12 +401,20 @@ stats_group_find(const char *name)
 {
     struct stats_hdr *cur;
 
+#if MYNEWT_VAL(STATS_NAME_HASH_SIZE) > 0
+    cur = g_stats_name_hash[rcu_name_hash(name) %
+                            MYNEWT_VAL(STATS_NAME_HASH_SIZE)];
+    while (cur != NULL && strcmp(cur->s_name, name)) {
+        cur = cur->s_hash_next;
+    }
+#else
     cur = NULL;
     STAILQ_FOREACH(cur, &g_stats_registry, s_next) {
         if (!strcmp(cur->s_name, name)) {
             break;
         }
     }
+#endif
 
     return (cur);
 }
@@ -459,3 +518,128 @@ stats_reset(struct stats_hdr *hdr)
     }
     return;
 }
+
+static uint32_t
+stats_hist_bound(const struct stats_hist *hist, int bucket)
+{
+    uint32_t bound;
+
+    if (bucket == STATS_HIST_BUCKETS - 1) {
+        return hist->sh_max;
+    }
+
+    bound = (1UL << bucket) - 1;
+    if (bound > hist->sh_max) {
+        bound = hist->sh_max;
+    }
+    if (bound < hist->sh_min) {
+        bound = hist->sh_min;
+    }
+    return bound;
+}
+
+/**
+ * Adds a sample to a histogram stat.  Use STATS_HIST_RECORD() rather than
+ * calling this directly.
+ *
+ * @param hist The histogram to update
+ * @param val The sample to record
+ */
+void
+stats_hist_record(struct stats_hist *hist, uint32_t val)
+{
+    uint32_t rank50;
+    uint32_t rank99;
+    uint32_t seen;
+    int bucket;
+    int i;
+
+    if (hist->sh_cnt == 0 || val < hist->sh_min) {
+        hist->sh_min = val;
+    }
+    if (val > hist->sh_max) {
+        hist->sh_max = val;
+    }
+    hist->sh_cnt++;
+    hist->sh_sum += val;
+
+    if (val == 0) {
+        bucket = 0;
+    } else {
+        bucket = 32 - __builtin_clz(val);
+        if (bucket >= STATS_HIST_BUCKETS) {
+            bucket = STATS_HIST_BUCKETS - 1;
+        }
+    }
+    hist->sh_bucket[bucket]++;
+
+    /* Ranks of the percentiles, rounded up; 1-based. */
+    rank50 = ((uint64_t)hist->sh_cnt * 50 + 99) / 100;
+    rank99 = ((uint64_t)hist->sh_cnt * 99 + 99) / 100;
+
+    seen = 0;
+    for (i = 0; i < STATS_HIST_BUCKETS; i++) {
+        if (seen < rank50 && seen + hist->sh_bucket[i] >= rank50) {
+            hist->sh_p50 = stats_hist_bound(hist, i);
+        }
+        seen += hist->sh_bucket[i];
+        if (seen >= rank99) {
+            hist->sh_p99 = stats_hist_bound(hist, i);
+            break;
+        }
+    }
+}
+
+/**
+ * Atomically adds to a stat.  Use STATS_INCN_ATOMIC() rather than calling
+ * this directly.
+ *
+ * @param stat The stat to update
+ * @param size The size of the stat, 2, 4 or 8 bytes
+ * @param n The amount to add
+ */
+void
+stats_incn_atomic(void *stat, uint8_t size, uint32_t n)
+{
+    os_sr_t sr;
+
+    switch (size) {
+    case sizeof(uint16_t):
+#if STATS_ATOMIC(2)
+        __atomic_fetch_add((uint16_t *)stat, n, __ATOMIC_RELAXED);
+        return;
+#endif
+        break;
+
+    case sizeof(uint32_t):
+#if STATS_ATOMIC(4)
+        __atomic_fetch_add((uint32_t *)stat, n, __ATOMIC_RELAXED);
+        return;
+#endif
+        break;
+
+    case sizeof(uint64_t):
+#if STATS_ATOMIC(8)
+        __atomic_fetch_add((uint64_t *)stat, n, __ATOMIC_RELAXED);
+        return;
+#endif
+        break;
+
+    default:
+        return;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    switch (size) {
+    case sizeof(uint16_t):
+        *(uint16_t *)stat += n;
+        break;
+    case sizeof(uint32_t):
+        *(uint32_t *)stat += n;
+        break;
+    case sizeof(uint64_t):
+        *(uint64_t *)stat += n;
+        break;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
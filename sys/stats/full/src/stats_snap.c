@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(STATS_SNAPSHOT)
+
+#include <string.h>
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "stats/stats.h"
+
+/*
+ * Periodic delta snapshots of all registered stats.
+ *
+ * The value of every stat reported last is kept in the caller-supplied
+ * ss_prev array, indexed by the position of the stat in a walk of all
+ * groups.  Groups are registered at the tail of the registry, so a stat
+ * keeps its position once registered.  Snapshots only contain the groups
+ * and stats which changed, encoded as:
+ *
+ *     {
+ *         "seq": <snapshot number>,
+ *         "ts": <os_time_get()>,
+ *         "lost": <snapshots which could not be encoded, if any>,
+ *         "g": {
+ *             "<group>": { "<stat>": <delta>, ... },
+ *             ...
+ *         }
+ *     }
+ */
+
+struct stats_snap_walk_arg {
+    struct stats_snap *snap;
+    CborEncoder *groups;
+    CborEncoder group;
+    bool group_open;
+    uint16_t idx;
+    int err;
+};
+
+static uint32_t
+stats_snap_read(const struct stats_hdr *hdr, uint16_t off)
+{
+    const void *val;
+
+    val = (const uint8_t *)hdr + off;
+    switch (hdr->s_size) {
+    case sizeof(uint16_t):
+        return *(const uint16_t *)val;
+    case sizeof(uint32_t):
+        return *(const uint32_t *)val;
+    case sizeof(uint64_t):
+        /* Deltas are reported modulo 2^32. */
+        return *(const uint64_t *)val;
+    default:
+        return 0;
+    }
+}
+
+static int
+stats_snap_walk_entry(struct stats_hdr *hdr, void *arg, char *name,
+                      uint16_t off)
+{
+    struct stats_snap_walk_arg *sswa;
+    struct stats_snap *snap;
+    uint32_t delta;
+    uint32_t cur;
+
+    sswa = arg;
+    snap = sswa->snap;
+
+    if (sswa->idx >= snap->ss_prev_cnt) {
+        return OS_ENOMEM;
+    }
+
+    cur = stats_snap_read(hdr, off);
+    delta = cur - snap->ss_prev[sswa->idx];
+    if (hdr->s_size == sizeof(uint16_t)) {
+        delta &= 0xffff;
+    }
+    snap->ss_prev[sswa->idx] = cur;
+    sswa->idx++;
+
+    if (delta == 0) {
+        return 0;
+    }
+
+    if (!sswa->group_open) {
+        sswa->err |= cbor_encode_text_stringz(sswa->groups, hdr->s_name);
+        sswa->err |= cbor_encoder_create_map(sswa->groups, &sswa->group,
+                                             CborIndefiniteLength);
+        sswa->group_open = true;
+    }
+    sswa->err |= cbor_encode_text_stringz(&sswa->group, name);
+    sswa->err |= cbor_encode_uint(&sswa->group, delta);
+
+    return 0;
+}
+
+static int
+stats_snap_walk_group(struct stats_hdr *hdr, void *arg)
+{
+    struct stats_snap_walk_arg *sswa;
+    int rc;
+
+    sswa = arg;
+    sswa->group_open = false;
+
+    rc = stats_walk(hdr, stats_snap_walk_entry, sswa);
+
+    if (sswa->group_open) {
+        sswa->err |= cbor_encoder_close_container(sswa->groups,
+                                                  &sswa->group);
+    }
+
+    return rc;
+}
+
+int
+stats_snap_take(struct stats_snap *snap)
+{
+    struct stats_snap_walk_arg sswa;
+    struct cbor_mbuf_writer writer;
+    struct os_mbuf *om;
+    CborEncoder encoder;
+    CborEncoder groups;
+    CborEncoder map;
+    int rc;
+
+    om = os_msys_get_pkthdr(0, 0);
+    if (om == NULL) {
+        snap->ss_lost++;
+        return OS_ENOMEM;
+    }
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&encoder, &writer.enc, 0);
+
+    memset(&sswa, 0, sizeof sswa);
+    sswa.snap = snap;
+    sswa.groups = &groups;
+
+    sswa.err |= cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength);
+    sswa.err |= cbor_encode_text_stringz(&map, "seq");
+    sswa.err |= cbor_encode_uint(&map, snap->ss_seq);
+    sswa.err |= cbor_encode_text_stringz(&map, "ts");
+    sswa.err |= cbor_encode_uint(&map, os_time_get());
+    if (snap->ss_lost != 0) {
+        sswa.err |= cbor_encode_text_stringz(&map, "lost");
+        sswa.err |= cbor_encode_uint(&map, snap->ss_lost);
+    }
+    sswa.err |= cbor_encode_text_stringz(&map, "g");
+    sswa.err |= cbor_encoder_create_map(&map, &groups, CborIndefiniteLength);
+
+    /* Stats which do not fit in ss_prev are left out. */
+    rc = stats_group_walk(stats_snap_walk_group, &sswa);
+
+    sswa.err |= cbor_encoder_close_container(&map, &groups);
+    sswa.err |= cbor_encoder_close_container(&encoder, &map);
+
+    if (sswa.err != 0) {
+        /* The deltas are gone; let the receiver know. */
+        os_mbuf_free_chain(om);
+        snap->ss_lost++;
+        return OS_ENOMEM;
+    }
+
+    snap->ss_seq++;
+    snap->ss_lost = 0;
+    snap->ss_cb(om, snap->ss_arg);
+
+    return rc;
+}
+
+static void
+stats_snap_timer_exp(struct os_event *ev)
+{
+    struct stats_snap *snap;
+
+    snap = ev->ev_arg;
+
+    stats_snap_take(snap);
+    os_callout_reset(&snap->ss_timer, snap->ss_itvl);
+}
+
+int
+stats_snap_init(struct stats_snap *snap, uint32_t *prev, uint16_t prev_cnt,
+                stats_snap_fn *cb, void *arg)
+{
+    if (prev == NULL || prev_cnt == 0 || cb == NULL) {
+        return OS_EINVAL;
+    }
+
+    memset(snap, 0, sizeof *snap);
+    memset(prev, 0, prev_cnt * sizeof *prev);
+    snap->ss_prev = prev;
+    snap->ss_prev_cnt = prev_cnt;
+    snap->ss_cb = cb;
+    snap->ss_arg = arg;
+    os_callout_init(&snap->ss_timer, os_eventq_dflt_get(),
+                    stats_snap_timer_exp, snap);
+
+    return 0;
+}
+
+int
+stats_snap_start(struct stats_snap *snap, os_time_t itvl)
+{
+    if (itvl == 0) {
+        return OS_EINVAL;
+    }
+
+    snap->ss_itvl = itvl;
+    return os_callout_reset(&snap->ss_timer, itvl);
+}
+
+void
+stats_snap_stop(struct stats_snap *snap)
+{
+    os_callout_stop(&snap->ss_timer);
+}
+
+#endif
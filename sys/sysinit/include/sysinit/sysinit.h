@@ -36,6 +36,9 @@ extern uint8_t sysinit_active;
 
 void sysinit_start(void);
 void sysinit_end(void);
+#if MYNEWT_VAL(SYSINIT_DEFER)
+void sysinit_defer_start(void);
+#endif
 
 typedef void sysinit_panic_fn(const char *file, int line, const char *func,
                               const char *expr, const char *msg);
@@ -79,10 +82,31 @@ void sysinit_panic_set(sysinit_panic_fn *panic_fn);
  * ensure packages don't get initialized a second time after system
  * initialization has completed.
  */
+#if MYNEWT_VAL(SYSINIT_TIMING)
+void sysinit_time_mark(const char *func);
+#define SYSINIT_TIME_MARK() sysinit_time_mark(__func__)
+#else
+#define SYSINIT_TIME_MARK()
+#endif
+
 #if MYNEWT_VAL(SYSINIT_CONSTRAIN_INIT)
-#define SYSINIT_ASSERT_ACTIVE() assert(sysinit_active)
+#define SYSINIT_ASSERT_ACTIVE() do                                          \
+{                                                                           \
+    SYSINIT_TIME_MARK();                                                    \
+    assert(sysinit_active);                                                 \
+} while (0)
 #else
-#define SYSINIT_ASSERT_ACTIVE()
+#define SYSINIT_ASSERT_ACTIVE() SYSINIT_TIME_MARK()
+#endif
+
+#if MYNEWT_VAL(SYSINIT_TIMING)
+/**
+ * Prints how long each package init function took.  Init functions are
+ * told apart by their SYSINIT_ASSERT_ACTIVE() call, so an entry's time runs
+ * until the next init function that makes one; functions that don't are
+ * counted towards the one before them.
+ */
+void sysinit_time_report(void);
 #endif
 
 #if MYNEWT_VAL(SPLIT_LOADER)
@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SYSINIT_DEFER_
+#define H_SYSINIT_DEFER_
+
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Deferred initialization.
+ *
+ * A package init function can hand off its slow part (mounting a file
+ * system, probing a sensor bus, loading configuration) with
+ * sysinit_defer().  Deferred functions run on the sysinit worker tasks once
+ * sysinit has finished, so the application's main task gets going sooner.
+ * With more than one worker, functions that block on I/O overlap.
+ *
+ * A deferred function starts only after all its dependencies finished.
+ * Dependency cycles are not detected; they leave the functions involved
+ * waiting forever.
+ */
+struct sysinit_deferred {
+    /** Name, for diagnostics. */
+    const char *sd_name;
+    /** The deferred work. */
+    void (*sd_fn)(void);
+    /** NULL terminated list of entries that must complete first, or NULL. */
+    struct sysinit_deferred * const *sd_deps;
+
+    /* Private. */
+    uint8_t sd_state;
+    uint8_t sd_waiters;
+    uint32_t sd_ticks;
+    struct os_sem sd_done;
+    STAILQ_ENTRY(sysinit_deferred) sd_next;
+};
+
+/**
+ * Queues a function to run after sysinit.  Must be called during sysinit,
+ * typically from a package init function.  The structure must stay valid
+ * for good.
+ */
+void sysinit_defer(struct sysinit_deferred *sd);
+
+/**
+ * Waits for a deferred function to complete.  Must not be called from a
+ * deferred function that the waited for entry (indirectly) depends on.
+ *
+ * @param sd                    The entry to wait for.
+ * @param timeout               Ticks to wait, or OS_TIMEOUT_NEVER.
+ *
+ * @return                      0 once the function has completed;
+ *                              OS_TIMEOUT if it did not complete in time.
+ */
+int sysinit_defer_wait(struct sysinit_deferred *sd, os_time_t timeout);
+
+/**
+ * Reports whether a deferred function has completed.
+ */
+int sysinit_defer_done(const struct sysinit_deferred *sd);
+
+#if MYNEWT_VAL(SYSINIT_TIMING)
+/**
+ * Prints how long each deferred function took.  Called by
+ * sysinit_time_report().
+ */
+void sysinit_defer_time_report(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
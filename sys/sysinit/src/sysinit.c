@@ -21,6 +21,9 @@
 #include <stddef.h>
 #include <limits.h>
 #include "os/mynewt.h"
+#if MYNEWT_VAL(SYSINIT_DEFER)
+#include "sysinit/sysinit_defer.h"
+#endif
 
 static void
 sysinit_dflt_panic_cb(const char *file, int line, const char *func,
@@ -39,6 +42,62 @@ sysinit_panic_fn *sysinit_panic_cb = sysinit_dflt_panic_cb;
 
 uint8_t sysinit_active;
 
+#if MYNEWT_VAL(SYSINIT_TIMING)
+struct sysinit_time_entry {
+    const char *name;
+    uint32_t start;
+};
+
+static struct sysinit_time_entry
+    sysinit_times[MYNEWT_VAL(SYSINIT_TIMING_MAX)];
+static uint16_t sysinit_time_cnt;
+static uint16_t sysinit_time_dropped;
+static uint32_t sysinit_time_start;
+static uint32_t sysinit_time_end;
+
+void
+sysinit_time_mark(const char *func)
+{
+    if (!sysinit_active) {
+        return;
+    }
+    if (sysinit_time_cnt == MYNEWT_VAL(SYSINIT_TIMING_MAX)) {
+        sysinit_time_dropped++;
+        return;
+    }
+    sysinit_times[sysinit_time_cnt].name = func;
+    sysinit_times[sysinit_time_cnt].start = os_cputime_get32();
+    sysinit_time_cnt++;
+}
+
+void
+sysinit_time_report(void)
+{
+    uint32_t end;
+    int i;
+
+    for (i = 0; i < sysinit_time_cnt; i++) {
+        if (i + 1 < sysinit_time_cnt) {
+            end = sysinit_times[i + 1].start;
+        } else {
+            end = sysinit_time_end;
+        }
+        printf("sysinit: %s %lu us\n", sysinit_times[i].name,
+               (unsigned long)os_cputime_ticks_to_usecs(
+                   end - sysinit_times[i].start));
+    }
+    if (sysinit_time_dropped) {
+        printf("sysinit: %u more not recorded\n", sysinit_time_dropped);
+    }
+    printf("sysinit: total %lu us\n",
+           (unsigned long)os_cputime_ticks_to_usecs(sysinit_time_end -
+                                                    sysinit_time_start));
+#if MYNEWT_VAL(SYSINIT_DEFER)
+    sysinit_defer_time_report();
+#endif
+}
+#endif
+
 /**
  * Sets the sysinit panic function; i.e., the function which executes when
  * initialization fails.  By default, a panic triggers a failed assertion.
@@ -53,10 +112,19 @@ void
 sysinit_start(void)
 {
     sysinit_active = 1;
+#if MYNEWT_VAL(SYSINIT_TIMING)
+    sysinit_time_start = os_cputime_get32();
+#endif
 }
 
 void
 sysinit_end(void)
 {
+#if MYNEWT_VAL(SYSINIT_TIMING)
+    sysinit_time_end = os_cputime_get32();
+#endif
     sysinit_active = 0;
+#if MYNEWT_VAL(SYSINIT_DEFER)
+    sysinit_defer_start();
+#endif
 }
@@ -0,0 +1,222 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SYSINIT_DEFER)
+
+#include "sysinit/sysinit_defer.h"
+
+#define SYSINIT_DEFER_IDLE      0
+#define SYSINIT_DEFER_QUEUED    1
+#define SYSINIT_DEFER_RUNNING   2
+#define SYSINIT_DEFER_DONE      3
+
+#define SYSINIT_DEFER_WORKERS   MYNEWT_VAL(SYSINIT_DEFER_WORKERS)
+
+static STAILQ_HEAD(, sysinit_deferred) sysinit_defer_list =
+    STAILQ_HEAD_INITIALIZER(sysinit_defer_list);
+
+static struct os_mutex sysinit_defer_mtx;
+
+/* Released whenever an entry completes, so idle workers look again. */
+static struct os_sem sysinit_defer_sem;
+
+static struct os_task sysinit_defer_tasks[SYSINIT_DEFER_WORKERS];
+static os_stack_t sysinit_defer_stacks[SYSINIT_DEFER_WORKERS]
+    [OS_STACK_ALIGN(MYNEWT_VAL(SYSINIT_DEFER_STACK_SIZE))]
+    __attribute__((aligned(OS_STACK_ALIGNMENT)));
+
+static uint8_t sysinit_defer_started;
+
+static int
+sysinit_defer_runnable(const struct sysinit_deferred *sd)
+{
+    struct sysinit_deferred * const *dep;
+
+    if (sd->sd_state != SYSINIT_DEFER_QUEUED) {
+        return 0;
+    }
+    if (sd->sd_deps == NULL) {
+        return 1;
+    }
+    for (dep = sd->sd_deps; *dep != NULL; dep++) {
+        /* An entry that was never queued has nothing left to do. */
+        if ((*dep)->sd_state != SYSINIT_DEFER_DONE &&
+            (*dep)->sd_state != SYSINIT_DEFER_IDLE) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static struct sysinit_deferred *
+sysinit_defer_next(void)
+{
+    struct sysinit_deferred *sd;
+
+    STAILQ_FOREACH(sd, &sysinit_defer_list, sd_next) {
+        if (sysinit_defer_runnable(sd)) {
+            sd->sd_state = SYSINIT_DEFER_RUNNING;
+            return sd;
+        }
+    }
+    return NULL;
+}
+
+static void
+sysinit_defer_task(void *arg)
+{
+    struct sysinit_deferred *sd;
+    uint32_t start;
+    int i;
+
+    while (1) {
+        os_mutex_pend(&sysinit_defer_mtx, OS_TIMEOUT_NEVER);
+        sd = sysinit_defer_next();
+        os_mutex_release(&sysinit_defer_mtx);
+
+        if (sd == NULL) {
+            /* Nothing runnable.  Either everything is done, and this
+             * sleeps for good, or something else is still running.
+             */
+            os_sem_pend(&sysinit_defer_sem, OS_TIMEOUT_NEVER);
+            continue;
+        }
+
+        start = os_cputime_get32();
+        sd->sd_fn();
+        sd->sd_ticks = os_cputime_get32() - start;
+
+        os_mutex_pend(&sysinit_defer_mtx, OS_TIMEOUT_NEVER);
+        sd->sd_state = SYSINIT_DEFER_DONE;
+        for (i = 0; i < sd->sd_waiters; i++) {
+            os_sem_release(&sd->sd_done);
+        }
+        sd->sd_waiters = 0;
+        os_mutex_release(&sysinit_defer_mtx);
+
+        for (i = 0; i < SYSINIT_DEFER_WORKERS - 1; i++) {
+            os_sem_release(&sysinit_defer_sem);
+        }
+    }
+}
+
+void
+sysinit_defer(struct sysinit_deferred *sd)
+{
+    assert(sysinit_active);
+    assert(!sysinit_defer_started);
+
+    if (STAILQ_EMPTY(&sysinit_defer_list)) {
+        os_mutex_init(&sysinit_defer_mtx);
+        os_sem_init(&sysinit_defer_sem, 0);
+    }
+    os_sem_init(&sd->sd_done, 0);
+    sd->sd_waiters = 0;
+    sd->sd_ticks = 0;
+    sd->sd_state = SYSINIT_DEFER_QUEUED;
+    STAILQ_INSERT_TAIL(&sysinit_defer_list, sd, sd_next);
+}
+
+int
+sysinit_defer_done(const struct sysinit_deferred *sd)
+{
+    return sd->sd_state == SYSINIT_DEFER_DONE ||
+           sd->sd_state == SYSINIT_DEFER_IDLE;
+}
+
+int
+sysinit_defer_wait(struct sysinit_deferred *sd, os_time_t timeout)
+{
+    os_error_t err;
+
+    if (sysinit_defer_done(sd)) {
+        return 0;
+    }
+
+    os_mutex_pend(&sysinit_defer_mtx, OS_TIMEOUT_NEVER);
+    if (sysinit_defer_done(sd)) {
+        os_mutex_release(&sysinit_defer_mtx);
+        return 0;
+    }
+    sd->sd_waiters++;
+    os_mutex_release(&sysinit_defer_mtx);
+
+    err = os_sem_pend(&sd->sd_done, timeout);
+    if (err == OS_OK) {
+        return 0;
+    }
+
+    os_mutex_pend(&sysinit_defer_mtx, OS_TIMEOUT_NEVER);
+    if (sysinit_defer_done(sd)) {
+        /* Completed just now; take our token back out of the semaphore. */
+        os_sem_pend(&sd->sd_done, 0);
+        err = OS_OK;
+    } else {
+        sd->sd_waiters--;
+    }
+    os_mutex_release(&sysinit_defer_mtx);
+
+    return err == OS_OK ? 0 : OS_TIMEOUT;
+}
+
+/**
+ * Starts working through the deferred functions.  Called by sysinit_end().
+ */
+void
+sysinit_defer_start(void)
+{
+    int rc;
+    int i;
+
+    if (STAILQ_EMPTY(&sysinit_defer_list) || sysinit_defer_started) {
+        return;
+    }
+    sysinit_defer_started = 1;
+
+    for (i = 0; i < SYSINIT_DEFER_WORKERS; i++) {
+        rc = os_task_init(&sysinit_defer_tasks[i], "sysinit_defer",
+                          sysinit_defer_task, NULL,
+                          MYNEWT_VAL(SYSINIT_DEFER_TASK_PRIO) + i,
+                          OS_WAIT_FOREVER, sysinit_defer_stacks[i],
+                          MYNEWT_VAL(SYSINIT_DEFER_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+}
+
+#if MYNEWT_VAL(SYSINIT_TIMING)
+void
+sysinit_defer_time_report(void)
+{
+    struct sysinit_deferred *sd;
+
+    STAILQ_FOREACH(sd, &sysinit_defer_list, sd_next) {
+        if (sd->sd_state == SYSINIT_DEFER_DONE) {
+            printf("sysinit: deferred %s %lu us\n", sd->sd_name,
+                   (unsigned long)os_cputime_ticks_to_usecs(sd->sd_ticks));
+        } else {
+            printf("sysinit: deferred %s pending\n", sd->sd_name);
+        }
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Micro-benchmark harness.
+ *
+ * A suite is a set of cases.  Each case measures one operation per call of
+ * its run function, which returns the duration measured with bench_now()
+ * around the operation only, so that preparation and cleanup of every
+ * iteration stay out of the sample.  The harness runs warmup iterations,
+ * then collects samples and reports min, median, p99, max and mean, with
+ * the cost of reading the timer itself subtracted.
+ *
+ * Durations are in CPU cycles where the DWT cycle counter is available
+ * (Cortex-M3 and up) and in os_cputime ticks elsewhere.
+ */
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define BENCH_CYCCNT    1
+#define BENCH_UNIT      "cycle"
+#else
+#define BENCH_CYCCNT    0
+#define BENCH_UNIT      "cputime"
+#endif
+
+static inline uint32_t
+bench_now(void)
+{
+#if BENCH_CYCCNT
+    return DWT->CYCCNT;
+#else
+    return os_cputime_get32();
+#endif
+}
+
+struct bench_case {
+    const char *bc_name;
+    /* Optional, called once before warmup; nonzero skips the case */
+    int (*bc_setup)(void);
+    /* Runs one iteration, returns its duration */
+    uint32_t (*bc_run)(void);
+    /* Optional, called once after last iteration */
+    void (*bc_teardown)(void);
+};
+
+struct bench_suite {
+    const char *bs_name;
+    const struct bench_case *bs_cases;
+    int bs_case_cnt;
+    SLIST_ENTRY(bench_suite) bs_next;
+};
+
+#define BENCH_SUITE(name_, cases_)                                  \
+    {                                                               \
+        .bs_name = (name_),                                         \
+        .bs_cases = (cases_),                                       \
+        .bs_case_cnt = sizeof(cases_) / sizeof((cases_)[0]),        \
+    }
+
+struct bench_result {
+    const char *br_suite;
+    const char *br_case;
+    /* Zero if the case was skipped */
+    int br_rc;
+    int br_count;
+    uint32_t br_overhead;
+    uint32_t br_min;
+    uint32_t br_p50;
+    uint32_t br_p99;
+    uint32_t br_max;
+    uint32_t br_mean;
+};
+
+typedef void bench_result_fn(const struct bench_result *res, void *arg);
+
+SLIST_HEAD(bench_suite_list, bench_suite);
+extern struct bench_suite_list g_bench_suites;
+
+/**
+ * Registers a suite, normally from sysinit of the package providing it.
+ */
+void bench_suite_register(struct bench_suite *suite);
+
+/**
+ * Runs all cases of one suite, or of every suite if name is NULL or "all".
+ *
+ * @param name - Suite name.
+ * @param iterations - Measured iterations per case, capped at
+ *                     BENCH_MAX_SAMPLES; 0 for default.
+ * @param warmup - Discarded iterations per case.
+ * @param cb - Called with result of each case.
+ * @param arg - Argument for cb.
+ *
+ * @return 0 on success, SYS_ENOENT if there is no such suite,
+ *         SYS_EBUSY if benchmark is already running.
+ */
+int bench_run(const char *name, int iterations, int warmup,
+              bench_result_fn *cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCH_H__ */
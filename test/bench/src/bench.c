@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+struct bench_suite_list g_bench_suites =
+    SLIST_HEAD_INITIALIZER(g_bench_suites);
+
+static uint32_t bench_samples[MYNEWT_VAL(BENCH_MAX_SAMPLES)];
+static bool bench_running;
+
+void
+bench_suite_register(struct bench_suite *suite)
+{
+    struct bench_suite *prev;
+    struct bench_suite *cur;
+
+    /* Keep registration order, suites are listed and run in it */
+    prev = NULL;
+    SLIST_FOREACH(cur, &g_bench_suites, bs_next) {
+        prev = cur;
+    }
+    if (prev) {
+        SLIST_INSERT_AFTER(prev, suite, bs_next);
+    } else {
+        SLIST_INSERT_HEAD(&g_bench_suites, suite, bs_next);
+    }
+}
+
+static int
+bench_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Smallest duration of two back to back timer reads, subtracted from every
+ * sample.
+ */
+static uint32_t
+bench_overhead(void)
+{
+    uint32_t best = UINT32_MAX;
+    uint32_t start;
+    uint32_t d;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        start = bench_now();
+        d = bench_now() - start;
+        if (d < best) {
+            best = d;
+        }
+    }
+
+    return best;
+}
+
+static void
+bench_run_case(const struct bench_suite *suite, const struct bench_case *bc,
+               int iterations, int warmup, uint32_t overhead,
+               bench_result_fn *cb, void *arg)
+{
+    struct bench_result res = {
+        .br_suite = suite->bs_name,
+        .br_case = bc->bc_name,
+        .br_overhead = overhead,
+    };
+    uint64_t total;
+    uint32_t d;
+    int i;
+
+    if (bc->bc_setup) {
+        res.br_rc = bc->bc_setup();
+        if (res.br_rc) {
+            cb(&res, arg);
+            return;
+        }
+    }
+
+    for (i = 0; i < warmup; i++) {
+        bc->bc_run();
+    }
+
+    total = 0;
+    for (i = 0; i < iterations; i++) {
+        d = bc->bc_run();
+        d = d > overhead ? d - overhead : 0;
+        bench_samples[i] = d;
+        total += d;
+    }
+
+    if (bc->bc_teardown) {
+        bc->bc_teardown();
+    }
+
+    qsort(bench_samples, iterations, sizeof(bench_samples[0]), bench_cmp);
+    res.br_count = iterations;
+    res.br_min = bench_samples[0];
+    res.br_p50 = bench_samples[(iterations - 1) * 50 / 100];
+    res.br_p99 = bench_samples[(iterations - 1) * 99 / 100];
+    res.br_max = bench_samples[iterations - 1];
+    res.br_mean = total / iterations;
+
+    cb(&res, arg);
+}
+
+int
+bench_run(const char *name, int iterations, int warmup,
+          bench_result_fn *cb, void *arg)
+{
+    struct bench_suite *suite;
+    uint32_t overhead;
+    bool all;
+    int found;
+    int sr;
+    int i;
+
+    OS_ENTER_CRITICAL(sr);
+    if (bench_running) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    bench_running = true;
+    OS_EXIT_CRITICAL(sr);
+
+    if (iterations <= 0) {
+        iterations = MYNEWT_VAL(BENCH_DFLT_ITERATIONS);
+    }
+    if (iterations > MYNEWT_VAL(BENCH_MAX_SAMPLES)) {
+        iterations = MYNEWT_VAL(BENCH_MAX_SAMPLES);
+    }
+    if (warmup < 0) {
+        warmup = MYNEWT_VAL(BENCH_DFLT_WARMUP);
+    }
+
+    all = name == NULL || name[0] == '\0' || strcmp(name, "all") == 0;
+    overhead = bench_overhead();
+    found = 0;
+    SLIST_FOREACH(suite, &g_bench_suites, bs_next) {
+        if (!all && strcmp(suite->bs_name, name) != 0) {
+            continue;
+        }
+        found++;
+        for (i = 0; i < suite->bs_case_cnt; i++) {
+            bench_run_case(suite, &suite->bs_cases[i], iterations, warmup,
+                           overhead, cb, arg);
+        }
+    }
+
+    bench_running = false;
+
+    return found ? 0 : SYS_ENOENT;
+}
+
+/*
+ * Initialize the package. Only called from sysinit().
+ */
+void
+bench_init(void)
+{
+#if BENCH_CYCCNT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+#if MYNEWT_VAL(BENCH_OS_SUITES)
+    bench_os_init();
+#endif
+#if MYNEWT_VAL(BENCH_MBUF_SUITES)
+    bench_mbuf_init();
+#endif
+#if MYNEWT_VAL(BENCH_CODEC_SUITES)
+    bench_codec_init();
+#endif
+#if MYNEWT_VAL(BENCH_EASING_SUITES)
+    bench_easing_init();
+#endif
+#if MYNEWT_VAL(BENCH_CLI)
+    bench_cli_init();
+#endif
+#if MYNEWT_VAL(BENCH_MGMT)
+    bench_mgmt_register_group();
+#endif
+}
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(BENCH_CLI)
+#include <stdlib.h>
+#include <string.h>
+#include <console/console.h>
+#include <shell/shell.h>
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+/*
+ * Results are printed as one JSON object per line, like the flash
+ * benchmark, to be collected and compared by host side tooling.
+ */
+static void
+bench_cli_result(const struct bench_result *res, void *arg)
+{
+    struct streamer *streamer = arg;
+
+    if (res->br_rc) {
+        streamer_printf(streamer,
+                        "{\"suite\":\"%s\",\"case\":\"%s\",\"rc\":%d}\n",
+                        res->br_suite, res->br_case, res->br_rc);
+        return;
+    }
+
+    streamer_printf(streamer,
+                    "{\"suite\":\"%s\",\"case\":\"%s\",\"unit\":\"%s\","
+                    "\"n\":%d,\"overhead\":%lu,\"min\":%lu,\"p50\":%lu,"
+                    "\"p99\":%lu,\"max\":%lu,\"mean\":%lu}\n",
+                    res->br_suite, res->br_case, BENCH_UNIT, res->br_count,
+                    (unsigned long)res->br_overhead,
+                    (unsigned long)res->br_min, (unsigned long)res->br_p50,
+                    (unsigned long)res->br_p99, (unsigned long)res->br_max,
+                    (unsigned long)res->br_mean);
+}
+
+static int
+bench_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+              struct streamer *streamer)
+{
+    struct bench_suite *suite;
+    const char *name = "all";
+    unsigned long val;
+    char *eptr;
+    int iterations = 0;
+    int warmup = -1;
+    int rc;
+    int i;
+
+    if (argc > 1 && (!strcmp(argv[1], "?") || !strcmp(argv[1], "help"))) {
+        streamer_printf(streamer,
+          "bench list | [<suite>|all] [iter=<n>] [warmup=<n>]\n");
+        return 0;
+    }
+
+    if (argc > 1 && !strcmp(argv[1], "list")) {
+        SLIST_FOREACH(suite, &g_bench_suites, bs_next) {
+            streamer_printf(streamer, "%s\n", suite->bs_name);
+        }
+        return 0;
+    }
+
+    for (i = 1; i < argc; i++) {
+        eptr = strchr(argv[i], '=');
+        if (!eptr) {
+            if (i == 1) {
+                name = argv[i];
+                continue;
+            }
+            goto bad_arg;
+        }
+        val = strtoul(eptr + 1, &eptr, 0);
+        if (*eptr != '\0') {
+            goto bad_arg;
+        }
+        if (!strncmp(argv[i], "iter=", 5) && val > 0) {
+            iterations = val;
+        } else if (!strncmp(argv[i], "warmup=", 7)) {
+            warmup = val;
+        } else {
+            goto bad_arg;
+        }
+    }
+
+    rc = bench_run(name, iterations, warmup, bench_cli_result, streamer);
+    if (rc == SYS_ENOENT) {
+        streamer_printf(streamer, "No suite %s\n", name);
+    } else if (rc) {
+        streamer_printf(streamer, "bench failed: %d\n", rc);
+    }
+    return 0;
+
+bad_arg:
+    streamer_printf(streamer, "Invalid argument %s\n", argv[i]);
+    return 0;
+}
+
+static struct shell_cmd bench_cmd_struct =
+    SHELL_CMD_EXT("bench", bench_cli_cmd, NULL);
+
+void
+bench_cli_init(void)
+{
+    shell_cmd_register(&bench_cmd_struct);
+}
+
+#endif /* MYNEWT_VAL(BENCH_CLI) */
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(BENCH_CODEC_SUITES)
+#include <string.h>
+#include "base64/base64.h"
+#include "base64/hex.h"
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+/* Roughly one NLIP frame worth of data. */
+#define BENCH_CODEC_LEN     96
+
+static uint8_t bench_codec_data[BENCH_CODEC_LEN];
+static char bench_codec_b64[BASE64_ENCODE_SIZE(BENCH_CODEC_LEN) + 1];
+static char bench_codec_hex[BENCH_CODEC_LEN * 2 + 1];
+static uint8_t bench_codec_out[BENCH_CODEC_LEN];
+
+static uint32_t
+bench_codec_b64_encode(void)
+{
+    uint32_t start;
+
+    start = bench_now();
+    base64_encode(bench_codec_data, BENCH_CODEC_LEN, bench_codec_b64, 1);
+
+    return bench_now() - start;
+}
+
+static uint32_t
+bench_codec_b64_decode(void)
+{
+    uint32_t start;
+
+    start = bench_now();
+    base64_decode(bench_codec_b64, bench_codec_out);
+
+    return bench_now() - start;
+}
+
+static uint32_t
+bench_codec_hex_format(void)
+{
+    uint32_t start;
+
+    start = bench_now();
+    hex_format(bench_codec_data, BENCH_CODEC_LEN, bench_codec_hex,
+               sizeof(bench_codec_hex));
+
+    return bench_now() - start;
+}
+
+static uint32_t
+bench_codec_hex_parse(void)
+{
+    uint32_t start;
+
+    start = bench_now();
+    hex_parse(bench_codec_hex, BENCH_CODEC_LEN * 2, bench_codec_out,
+              sizeof(bench_codec_out));
+
+    return bench_now() - start;
+}
+
+static const struct bench_case bench_codec_cases[] = {
+    { "b64_encode_96", NULL, bench_codec_b64_encode, NULL },
+    { "b64_decode_96", NULL, bench_codec_b64_decode, NULL },
+    { "hex_format_96", NULL, bench_codec_hex_format, NULL },
+    { "hex_parse_96", NULL, bench_codec_hex_parse, NULL },
+};
+
+static struct bench_suite bench_codec_suite =
+    BENCH_SUITE("codec", bench_codec_cases);
+
+void
+bench_codec_init(void)
+{
+    int i;
+
+    for (i = 0; i < BENCH_CODEC_LEN; i++) {
+        bench_codec_data[i] = i * 37;
+    }
+    base64_encode(bench_codec_data, BENCH_CODEC_LEN, bench_codec_b64, 1);
+    hex_format(bench_codec_data, BENCH_CODEC_LEN, bench_codec_hex,
+               sizeof(bench_codec_hex));
+
+    bench_suite_register(&bench_codec_suite);
+}
+
+#endif /* MYNEWT_VAL(BENCH_CODEC_SUITES) */
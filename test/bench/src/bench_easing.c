@@ -0,0 +1,114 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(BENCH_EASING_SUITES)
+#include "easing/easing.h"
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+/* One pass over a PWM fade, as apps/pwm_test does it. */
+#define BENCH_EASING_STEPS  64
+#define BENCH_EASING_MAX    10000
+
+static volatile int32_t bench_easing_sink;
+
+static uint32_t
+bench_easing_f(easing_f_func_t fn)
+{
+    uint32_t start;
+    uint32_t elapsed;
+    int32_t sum;
+    int i;
+
+    sum = 0;
+    start = bench_now();
+    for (i = 0; i <= BENCH_EASING_STEPS; i++) {
+        sum += (int32_t)fn(i, BENCH_EASING_STEPS, BENCH_EASING_MAX);
+    }
+    elapsed = bench_now() - start;
+    bench_easing_sink = sum;
+
+    return elapsed;
+}
+
+static uint32_t
+bench_easing_q15(easing_int_func_t fn)
+{
+    uint32_t start;
+    uint32_t elapsed;
+    int32_t sum;
+    int i;
+
+    sum = 0;
+    start = bench_now();
+    for (i = 0; i <= BENCH_EASING_STEPS; i++) {
+        sum += fn(i, BENCH_EASING_STEPS, BENCH_EASING_MAX);
+    }
+    elapsed = bench_now() - start;
+    bench_easing_sink = sum;
+
+    return elapsed;
+}
+
+#define BENCH_EASING_CASE(curve)                                    \
+    static uint32_t                                                 \
+    bench_easing_ ## curve ## _f(void)                              \
+    {                                                               \
+        return bench_easing_f(curve ## _f_io);                      \
+    }                                                               \
+    static uint32_t                                                 \
+    bench_easing_ ## curve ## _q15(void)                            \
+    {                                                               \
+        return bench_easing_q15(curve ## _q15_io);                  \
+    }
+
+BENCH_EASING_CASE(sine)
+BENCH_EASING_CASE(sine_custom)
+BENCH_EASING_CASE(exp_sin_custom)
+BENCH_EASING_CASE(exponential)
+BENCH_EASING_CASE(circular)
+BENCH_EASING_CASE(quintic)
+
+static const struct bench_case bench_easing_cases[] = {
+    { "sine_f", NULL, bench_easing_sine_f, NULL },
+    { "sine_q15", NULL, bench_easing_sine_q15, NULL },
+    { "sine_custom_f", NULL, bench_easing_sine_custom_f, NULL },
+    { "sine_custom_q15", NULL, bench_easing_sine_custom_q15, NULL },
+    { "exp_sin_custom_f", NULL, bench_easing_exp_sin_custom_f, NULL },
+    { "exp_sin_custom_q15", NULL, bench_easing_exp_sin_custom_q15, NULL },
+    { "exponential_f", NULL, bench_easing_exponential_f, NULL },
+    { "exponential_q15", NULL, bench_easing_exponential_q15, NULL },
+    { "circular_f", NULL, bench_easing_circular_f, NULL },
+    { "circular_q15", NULL, bench_easing_circular_q15, NULL },
+    { "quintic_f", NULL, bench_easing_quintic_f, NULL },
+    { "quintic_q15", NULL, bench_easing_quintic_q15, NULL },
+};
+
+static struct bench_suite bench_easing_suite =
+    BENCH_SUITE("easing", bench_easing_cases);
+
+void
+bench_easing_init(void)
+{
+    bench_suite_register(&bench_easing_suite);
+}
+
+#endif /* MYNEWT_VAL(BENCH_EASING_SUITES) */
@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * mbuf suite runs on a private pool so results do not depend on msys
+ * configuration; msys suite measures the system pools as configured.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+#define BENCH_MBUF_CNT          4
+#define BENCH_MBUF_BUF_SIZE     128
+#define BENCH_MBUF_MEMBLOCK_SIZE \
+    (BENCH_MBUF_BUF_SIZE + sizeof(struct os_mbuf) + sizeof(struct os_mbuf_pkthdr))
+
+static os_membuf_t bench_mbuf_mem[
+    OS_MEMPOOL_SIZE(BENCH_MBUF_CNT, BENCH_MBUF_MEMBLOCK_SIZE)];
+static struct os_mempool bench_mbuf_mempool;
+static struct os_mbuf_pool bench_mbuf_pool;
+static uint8_t bench_mbuf_data[64];
+
+static uint32_t
+bench_mbuf_get(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t d;
+
+    start = bench_now();
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    d = bench_now() - start;
+    os_mbuf_free_chain(om);
+
+    return d;
+}
+
+static uint32_t
+bench_mbuf_free(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    start = bench_now();
+    os_mbuf_free_chain(om);
+
+    return bench_now() - start;
+}
+
+static uint32_t
+bench_mbuf_append(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t d;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    start = bench_now();
+    os_mbuf_append(om, bench_mbuf_data, sizeof(bench_mbuf_data));
+    d = bench_now() - start;
+    os_mbuf_free_chain(om);
+
+    return d;
+}
+
+static uint32_t
+bench_mbuf_copydata(void)
+{
+    uint8_t buf[sizeof(bench_mbuf_data)];
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t d;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    os_mbuf_append(om, bench_mbuf_data, sizeof(bench_mbuf_data));
+    start = bench_now();
+    os_mbuf_copydata(om, 0, sizeof(buf), buf);
+    d = bench_now() - start;
+    os_mbuf_free_chain(om);
+
+    return d;
+}
+
+static uint32_t
+bench_mbuf_adj(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t d;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    os_mbuf_append(om, bench_mbuf_data, sizeof(bench_mbuf_data));
+    start = bench_now();
+    os_mbuf_adj(om, sizeof(bench_mbuf_data) / 2);
+    d = bench_now() - start;
+    os_mbuf_free_chain(om);
+
+    return d;
+}
+
+static const struct bench_case bench_mbuf_cases[] = {
+    { "get_pkthdr", NULL, bench_mbuf_get, NULL },
+    { "free_chain", NULL, bench_mbuf_free, NULL },
+    { "append_64", NULL, bench_mbuf_append, NULL },
+    { "copydata_64", NULL, bench_mbuf_copydata, NULL },
+    { "adj", NULL, bench_mbuf_adj, NULL },
+};
+
+static struct bench_suite bench_mbuf_suite =
+    BENCH_SUITE("mbuf", bench_mbuf_cases);
+
+static int
+bench_msys_setup(void)
+{
+    struct os_mbuf *om;
+
+    om = os_msys_get_pkthdr(0, 0);
+    if (om == NULL) {
+        return SYS_ENOMEM;
+    }
+    os_mbuf_free_chain(om);
+
+    return 0;
+}
+
+static uint32_t
+bench_msys_get(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+    uint32_t d;
+
+    start = bench_now();
+    om = os_msys_get_pkthdr(0, 0);
+    d = bench_now() - start;
+    os_mbuf_free_chain(om);
+
+    return d;
+}
+
+static uint32_t
+bench_msys_free(void)
+{
+    struct os_mbuf *om;
+    uint32_t start;
+
+    om = os_msys_get_pkthdr(0, 0);
+    start = bench_now();
+    os_mbuf_free_chain(om);
+
+    return bench_now() - start;
+}
+
+static const struct bench_case bench_msys_cases[] = {
+    { "get_pkthdr", bench_msys_setup, bench_msys_get, NULL },
+    { "free_chain", bench_msys_setup, bench_msys_free, NULL },
+};
+
+static struct bench_suite bench_msys_suite =
+    BENCH_SUITE("msys", bench_msys_cases);
+
+void
+bench_mbuf_init(void)
+{
+    int rc;
+
+    memset(bench_mbuf_data, 0xa5, sizeof(bench_mbuf_data));
+
+    rc = os_mempool_init(&bench_mbuf_mempool, BENCH_MBUF_CNT,
+                         BENCH_MBUF_MEMBLOCK_SIZE, bench_mbuf_mem,
+                         "bench_mbuf");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+    rc = os_mbuf_pool_init(&bench_mbuf_pool, &bench_mbuf_mempool,
+                           BENCH_MBUF_MEMBLOCK_SIZE, BENCH_MBUF_CNT);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    bench_suite_register(&bench_mbuf_suite);
+    bench_suite_register(&bench_msys_suite);
+}
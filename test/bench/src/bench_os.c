@@ -0,0 +1,372 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Kernel primitive suites: eventq, sched, sem, mempool and callout.
+ */
+#include "os/mynewt.h"
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+/* eventq */
+
+static struct os_eventq bench_evq;
+static struct os_event bench_ev;
+
+static void
+bench_ev_cb(struct os_event *ev)
+{
+}
+
+static uint32_t
+bench_eventq_put(void)
+{
+    uint32_t start;
+    uint32_t d;
+
+    start = bench_now();
+    os_eventq_put(&bench_evq, &bench_ev);
+    d = bench_now() - start;
+    os_eventq_get_no_wait(&bench_evq);
+
+    return d;
+}
+
+static uint32_t
+bench_eventq_get(void)
+{
+    uint32_t start;
+
+    os_eventq_put(&bench_evq, &bench_ev);
+    start = bench_now();
+    os_eventq_get_no_wait(&bench_evq);
+
+    return bench_now() - start;
+}
+
+static const struct bench_case bench_eventq_cases[] = {
+    { "put", NULL, bench_eventq_put, NULL },
+    { "get", NULL, bench_eventq_get, NULL },
+};
+
+static struct bench_suite bench_eventq_suite =
+    BENCH_SUITE("eventq", bench_eventq_cases);
+
+/*
+ * sched
+ *
+ * A peer task with priority higher than the running task blocks on a
+ * primitive; the runner timestamps, wakes it, and the peer timestamps as
+ * soon as it runs.  Each sample therefore includes the wakeup and one
+ * context switch.
+ */
+
+#define BENCH_PEER_SEM      0
+#define BENCH_PEER_MUTEX    1
+#define BENCH_PEER_EVQ      2
+
+static struct os_task bench_peer_task;
+OS_TASK_STACK_DEFINE(bench_peer_stack, MYNEWT_VAL(BENCH_PEER_STACK_SIZE));
+static struct os_sem bench_peer_start;
+static struct os_sem bench_peer_sem;
+static struct os_mutex bench_peer_mutex;
+static struct os_eventq bench_peer_evq;
+static struct os_event bench_peer_ev;
+static volatile uint32_t bench_peer_stamp;
+static volatile int bench_peer_done;
+static int bench_peer_mode;
+
+static void
+bench_peer_handler(void *arg)
+{
+    while (1) {
+        os_sem_pend(&bench_peer_start, OS_TIMEOUT_NEVER);
+        switch (bench_peer_mode) {
+        case BENCH_PEER_SEM:
+            os_sem_pend(&bench_peer_sem, OS_TIMEOUT_NEVER);
+            bench_peer_stamp = bench_now();
+            bench_peer_done = 1;
+            break;
+        case BENCH_PEER_MUTEX:
+            os_mutex_pend(&bench_peer_mutex, OS_TIMEOUT_NEVER);
+            bench_peer_stamp = bench_now();
+            os_mutex_release(&bench_peer_mutex);
+            break;
+        default:
+            os_eventq_get(&bench_peer_evq);
+            bench_peer_stamp = bench_now();
+            break;
+        }
+    }
+}
+
+static int
+bench_sched_setup(void)
+{
+    /* Peer has to preempt the runner as soon as it is woken up */
+    if (os_sched_get_current_task()->t_prio <= MYNEWT_VAL(BENCH_PEER_TASK_PRIO)) {
+        return SYS_EINVAL;
+    }
+
+    return 0;
+}
+
+static uint32_t
+bench_sched_sem(void)
+{
+    uint32_t start;
+
+    bench_peer_mode = BENCH_PEER_SEM;
+    /* Peer runs until it blocks on bench_peer_sem */
+    os_sem_release(&bench_peer_start);
+    start = bench_now();
+    os_sem_release(&bench_peer_sem);
+
+    return bench_peer_stamp - start;
+}
+
+static uint32_t
+bench_sched_mutex(void)
+{
+    uint32_t start;
+
+    bench_peer_mode = BENCH_PEER_MUTEX;
+    os_mutex_pend(&bench_peer_mutex, OS_TIMEOUT_NEVER);
+    /* Peer runs until it blocks on the mutex held here */
+    os_sem_release(&bench_peer_start);
+    start = bench_now();
+    os_mutex_release(&bench_peer_mutex);
+
+    return bench_peer_stamp - start;
+}
+
+static uint32_t
+bench_sched_eventq(void)
+{
+    uint32_t start;
+
+    bench_peer_mode = BENCH_PEER_EVQ;
+    os_sem_release(&bench_peer_start);
+    start = bench_now();
+    os_eventq_put(&bench_peer_evq, &bench_peer_ev);
+
+    return bench_peer_stamp - start;
+}
+
+static const struct bench_case bench_sched_cases[] = {
+    { "sem_wake", bench_sched_setup, bench_sched_sem, NULL },
+    { "mutex_handoff", bench_sched_setup, bench_sched_mutex, NULL },
+    { "eventq_wake", bench_sched_setup, bench_sched_eventq, NULL },
+};
+
+static struct bench_suite bench_sched_suite =
+    BENCH_SUITE("sched", bench_sched_cases);
+
+/*
+ * sem
+ *
+ * Uncontended pend and release, and the latency from a release in an
+ * interrupt handler (os_cputime timer) until the woken task runs.  Run with
+ * OS_SEM_FAST_PATH off and on to compare.
+ */
+
+static struct os_sem bench_sem;
+static struct hal_timer bench_isr_timer;
+static volatile uint32_t bench_isr_stamp;
+
+static uint32_t
+bench_sem_pend(void)
+{
+    uint32_t start;
+
+    os_sem_release(&bench_sem);
+    start = bench_now();
+    os_sem_pend(&bench_sem, 0);
+
+    return bench_now() - start;
+}
+
+static uint32_t
+bench_sem_release(void)
+{
+    uint32_t start;
+    uint32_t d;
+
+    start = bench_now();
+    os_sem_release(&bench_sem);
+    d = bench_now() - start;
+    os_sem_pend(&bench_sem, 0);
+
+    return d;
+}
+
+static void
+bench_isr_timer_cb(void *arg)
+{
+    bench_isr_stamp = bench_now();
+    os_sem_release(&bench_peer_sem);
+}
+
+static uint32_t
+bench_sem_isr_wake(void)
+{
+    bench_peer_mode = BENCH_PEER_SEM;
+    bench_peer_done = 0;
+    /* Peer runs until it blocks on bench_peer_sem */
+    os_sem_release(&bench_peer_start);
+
+    os_cputime_timer_relative(&bench_isr_timer, 50);
+    while (!bench_peer_done) {
+        /* Timer interrupt and peer preempt this loop. */
+    }
+
+    return bench_peer_stamp - bench_isr_stamp;
+}
+
+static const struct bench_case bench_sem_cases[] = {
+    { "pend", NULL, bench_sem_pend, NULL },
+    { "release", NULL, bench_sem_release, NULL },
+    { "isr_wake", bench_sched_setup, bench_sem_isr_wake, NULL },
+};
+
+static struct bench_suite bench_sem_suite =
+    BENCH_SUITE("sem", bench_sem_cases);
+
+/* mempool */
+
+#define BENCH_MEMPOOL_BLOCKS        4
+#define BENCH_MEMPOOL_BLOCK_SIZE    32
+
+static os_membuf_t bench_mempool_mem[
+    OS_MEMPOOL_SIZE(BENCH_MEMPOOL_BLOCKS, BENCH_MEMPOOL_BLOCK_SIZE)];
+static struct os_mempool bench_mempool;
+
+static uint32_t
+bench_mempool_get(void)
+{
+    uint32_t start;
+    uint32_t d;
+    void *block;
+
+    start = bench_now();
+    block = os_memblock_get(&bench_mempool);
+    d = bench_now() - start;
+    os_memblock_put(&bench_mempool, block);
+
+    return d;
+}
+
+static uint32_t
+bench_mempool_put(void)
+{
+    uint32_t start;
+    void *block;
+
+    block = os_memblock_get(&bench_mempool);
+    start = bench_now();
+    os_memblock_put(&bench_mempool, block);
+
+    return bench_now() - start;
+}
+
+static const struct bench_case bench_mempool_cases[] = {
+    { "get", NULL, bench_mempool_get, NULL },
+    { "put", NULL, bench_mempool_put, NULL },
+};
+
+static struct bench_suite bench_mempool_suite =
+    BENCH_SUITE("mempool", bench_mempool_cases);
+
+/* callout */
+
+static struct os_callout bench_callout;
+
+static uint32_t
+bench_callout_reset(void)
+{
+    uint32_t start;
+    uint32_t d;
+
+    /* Far enough to never expire during the run */
+    start = bench_now();
+    os_callout_reset(&bench_callout, OS_TICKS_PER_SEC * 60);
+    d = bench_now() - start;
+    os_callout_stop(&bench_callout);
+
+    return d;
+}
+
+static uint32_t
+bench_callout_rearm(void)
+{
+    uint32_t start;
+    uint32_t d;
+
+    /* Reset of a pending callout, the common timer restart case */
+    os_callout_reset(&bench_callout, OS_TICKS_PER_SEC * 60);
+    start = bench_now();
+    os_callout_reset(&bench_callout, OS_TICKS_PER_SEC * 60);
+    d = bench_now() - start;
+    os_callout_stop(&bench_callout);
+
+    return d;
+}
+
+static const struct bench_case bench_callout_cases[] = {
+    { "reset", NULL, bench_callout_reset, NULL },
+    { "rearm", NULL, bench_callout_rearm, NULL },
+};
+
+static struct bench_suite bench_callout_suite =
+    BENCH_SUITE("callout", bench_callout_cases);
+
+void
+bench_os_init(void)
+{
+    int rc;
+
+    os_eventq_init(&bench_evq);
+    bench_ev.ev_cb = bench_ev_cb;
+
+    os_sem_init(&bench_peer_start, 0);
+    os_sem_init(&bench_peer_sem, 0);
+    os_mutex_init(&bench_peer_mutex);
+    os_eventq_init(&bench_peer_evq);
+    bench_peer_ev.ev_cb = bench_ev_cb;
+    os_sem_init(&bench_sem, 0);
+    os_cputime_timer_init(&bench_isr_timer, bench_isr_timer_cb, NULL);
+    rc = os_task_init(&bench_peer_task, "bench", bench_peer_handler, NULL,
+                      MYNEWT_VAL(BENCH_PEER_TASK_PRIO), OS_WAIT_FOREVER,
+                      bench_peer_stack, MYNEWT_VAL(BENCH_PEER_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    rc = os_mempool_init(&bench_mempool, BENCH_MEMPOOL_BLOCKS,
+                         BENCH_MEMPOOL_BLOCK_SIZE, bench_mempool_mem,
+                         "bench");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    /* Never expires, callout is always stopped after reset */
+    os_callout_init(&bench_callout, &bench_evq, bench_ev_cb, NULL);
+
+    bench_suite_register(&bench_eventq_suite);
+    bench_suite_register(&bench_sched_suite);
+    bench_suite_register(&bench_sem_suite);
+    bench_suite_register(&bench_mempool_suite);
+    bench_suite_register(&bench_callout_suite);
+}
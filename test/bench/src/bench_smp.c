@@ -0,0 +1,199 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(BENCH_MGMT)
+#include <string.h>
+
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+
+#include "bench/bench.h"
+#include "bench_priv.h"
+
+#define BENCH_SMP_OP_RUN    0
+#define BENCH_SMP_OP_LIST   1
+
+static int bench_mgmt_run(struct mgmt_ctxt *);
+static int bench_mgmt_list(struct mgmt_ctxt *);
+
+static const struct mgmt_handler bench_mgmt_handlers[] = {
+    [BENCH_SMP_OP_RUN] = { NULL, bench_mgmt_run },
+    [BENCH_SMP_OP_LIST] = { bench_mgmt_list, NULL }
+};
+
+static struct mgmt_group bench_mgmt_group = {
+    .mg_handlers = (struct mgmt_handler *)bench_mgmt_handlers,
+    .mg_handlers_count = sizeof(bench_mgmt_handlers) / sizeof(bench_mgmt_handlers[0]),
+    .mg_group_id = MYNEWT_VAL(BENCH_MGMT_GROUP_ID),
+};
+
+struct bench_mgmt_arg {
+    CborEncoder *results;
+    CborError err;
+};
+
+static void
+bench_mgmt_result(const struct bench_result *res, void *arg)
+{
+    struct bench_mgmt_arg *bma = arg;
+    CborEncoder rmap;
+    CborError err = CborNoError;
+
+    err |= cbor_encoder_create_map(bma->results, &rmap, CborIndefiniteLength);
+    err |= cbor_encode_text_stringz(&rmap, "suite");
+    err |= cbor_encode_text_stringz(&rmap, res->br_suite);
+    err |= cbor_encode_text_stringz(&rmap, "case");
+    err |= cbor_encode_text_stringz(&rmap, res->br_case);
+    err |= cbor_encode_text_stringz(&rmap, "rc");
+    err |= cbor_encode_int(&rmap, res->br_rc);
+    if (res->br_rc == 0) {
+        err |= cbor_encode_text_stringz(&rmap, "n");
+        err |= cbor_encode_int(&rmap, res->br_count);
+        err |= cbor_encode_text_stringz(&rmap, "overhead");
+        err |= cbor_encode_uint(&rmap, res->br_overhead);
+        err |= cbor_encode_text_stringz(&rmap, "min");
+        err |= cbor_encode_uint(&rmap, res->br_min);
+        err |= cbor_encode_text_stringz(&rmap, "p50");
+        err |= cbor_encode_uint(&rmap, res->br_p50);
+        err |= cbor_encode_text_stringz(&rmap, "p99");
+        err |= cbor_encode_uint(&rmap, res->br_p99);
+        err |= cbor_encode_text_stringz(&rmap, "max");
+        err |= cbor_encode_uint(&rmap, res->br_max);
+        err |= cbor_encode_text_stringz(&rmap, "mean");
+        err |= cbor_encode_uint(&rmap, res->br_mean);
+    }
+    err |= cbor_encoder_close_container(bma->results, &rmap);
+
+    bma->err |= err;
+}
+
+/*
+ * Runs suite given by "suite" ("all" or missing for every suite) and
+ * returns all case results in "results" array.  Benchmarks run in the
+ * mgmt task, the response is sent when they are done.
+ */
+static int
+bench_mgmt_run(struct mgmt_ctxt *mc)
+{
+    char suite[32] = "";
+    long long iterations = 0;
+    long long warmup = -1;
+    struct bench_mgmt_arg bma;
+    CborEncoder results;
+    CborError err = CborNoError;
+    int rc;
+
+    const struct cbor_attr_t attr[] = {
+        [0] = {
+            .attribute = "suite",
+            .type = CborAttrTextStringType,
+            .addr.string = suite,
+            .len = sizeof(suite)
+        },
+        [1] = {
+            .attribute = "iter",
+            .type = CborAttrIntegerType,
+            .addr.integer = &iterations,
+            .dflt.integer = 0
+        },
+        [2] = {
+            .attribute = "warmup",
+            .type = CborAttrIntegerType,
+            .addr.integer = &warmup,
+            .dflt.integer = -1
+        },
+        [3] = {
+            .attribute = NULL
+        }
+    };
+
+    rc = cbor_read_object(&mc->it, attr);
+    if (rc != 0) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "unit");
+    err |= cbor_encode_text_stringz(&mc->encoder, BENCH_UNIT);
+    err |= cbor_encode_text_stringz(&mc->encoder, "results");
+    err |= cbor_encoder_create_array(&mc->encoder, &results,
+                                     CborIndefiniteLength);
+
+    bma.results = &results;
+    bma.err = CborNoError;
+    rc = bench_run(suite, iterations, warmup, bench_mgmt_result, &bma);
+    err |= bma.err;
+
+    err |= cbor_encoder_close_container(&mc->encoder, &results);
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    switch (rc) {
+    case 0:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+        break;
+    case SYS_ENOENT:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_ENOENT);
+        break;
+    case SYS_EBUSY:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EBADSTATE);
+        break;
+    default:
+        err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EUNKNOWN);
+        break;
+    }
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+static int
+bench_mgmt_list(struct mgmt_ctxt *mc)
+{
+    CborError err = CborNoError;
+    CborEncoder list;
+    struct bench_suite *suite;
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+
+    err |= cbor_encode_text_stringz(&mc->encoder, "suites");
+    err |= cbor_encoder_create_array(&mc->encoder, &list,
+                                     CborIndefiniteLength);
+    SLIST_FOREACH(suite, &g_bench_suites, bs_next) {
+        err |= cbor_encode_text_stringz(&list, suite->bs_name);
+    }
+    err |= cbor_encoder_close_container(&mc->encoder, &list);
+
+    if (err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+int
+bench_mgmt_register_group(void)
+{
+    mgmt_register_group(&bench_mgmt_group);
+
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(BENCH_MGMT) */
@@ -0,0 +1,412 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Flash benchmark. Measures throughput and per operation latency of
+ * reads, writes and erases on a flash area, optionally with several tasks
+ * accessing it concurrently, each within its own slice of the area.
+ * Results are printed as one JSON object per line, to be collected and
+ * compared by host side tooling.
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include <console/console.h>
+#include <flash_map/flash_map.h>
+#include <shell/shell.h>
+
+#define FLASH_BENCH_OP_READ     0
+#define FLASH_BENCH_OP_WRITE    1
+#define FLASH_BENCH_OP_ERASE    2
+
+static const char * const flash_bench_op_names[] = {
+    [FLASH_BENCH_OP_READ] = "read",
+    [FLASH_BENCH_OP_WRITE] = "write",
+    [FLASH_BENCH_OP_ERASE] = "erase",
+};
+
+struct flash_bench_cfg {
+    const struct flash_area *fa;
+    int op;
+    uint32_t size;
+    uint32_t offset;
+    int count;          /* Operations per task */
+    int tasks;
+};
+
+struct flash_bench_task {
+    struct os_task fbt_task;
+    struct os_sem fbt_start;
+    char fbt_name[sizeof "fbenchX"];
+    uint32_t fbt_off;   /* Slice of flash area used by this task */
+    uint32_t fbt_len;
+    uint32_t fbt_bytes;
+    uint32_t *fbt_samples;
+    int fbt_done;
+    int fbt_rc;
+    OS_TASK_STACK_DEFINE_NOSTATIC(fbt_stack,
+                                  MYNEWT_VAL(FLASH_BENCH_STACK_SIZE));
+};
+
+static struct flash_bench_task
+    flash_bench_tasks[MYNEWT_VAL(FLASH_BENCH_MAX_TASKS)];
+static struct flash_bench_cfg flash_bench_cfg;
+static uint32_t flash_bench_samples[MYNEWT_VAL(FLASH_BENCH_MAX_SAMPLES)];
+static struct os_sem flash_bench_done;
+
+/*
+ * Finds next sector starting within task's slice, wrapping around to the
+ * first one.
+ */
+static int
+flash_bench_next_sector(const struct flash_bench_task *fbt, int *sec_id,
+                        struct flash_area *sec)
+{
+    const struct flash_area *fa = flash_bench_cfg.fa;
+    uint32_t off;
+    int wrapped = 0;
+
+    while (1) {
+        if (flash_area_getnext_sector(fa->fa_id, sec_id, sec)) {
+            if (wrapped) {
+                return SYS_ENOENT;
+            }
+            wrapped = 1;
+            *sec_id = -1;
+            continue;
+        }
+        off = sec->fa_off - fa->fa_off;
+        if (off >= fbt->fbt_off && off < fbt->fbt_off + fbt->fbt_len) {
+            return 0;
+        }
+    }
+}
+
+static int
+flash_bench_run_task(struct flash_bench_task *fbt)
+{
+    const struct flash_bench_cfg *cfg = &flash_bench_cfg;
+    struct flash_area sec;
+    uint8_t *buf = NULL;
+    uint32_t start;
+    uint32_t off;
+    uint32_t len;
+    int sec_id;
+    int rc = 0;
+    int i;
+
+    len = cfg->size;
+    if (cfg->op != FLASH_BENCH_OP_ERASE) {
+        buf = malloc(len);
+        if (!buf) {
+            return SYS_ENOMEM;
+        }
+        for (i = 0; i < len; i++) {
+            buf[i] = i;
+        }
+    }
+
+    sec_id = -1;
+    off = fbt->fbt_off + cfg->offset;
+    for (i = 0; i < cfg->count; i++) {
+        if (cfg->op == FLASH_BENCH_OP_ERASE) {
+            rc = flash_bench_next_sector(fbt, &sec_id, &sec);
+            if (rc) {
+                break;
+            }
+            off = sec.fa_off - cfg->fa->fa_off;
+            len = sec.fa_size;
+        } else if (off + len > fbt->fbt_off + fbt->fbt_len) {
+            off = fbt->fbt_off + cfg->offset;
+        }
+
+        start = os_cputime_get32();
+        switch (cfg->op) {
+        case FLASH_BENCH_OP_READ:
+            rc = flash_area_read(cfg->fa, off, buf, len);
+            break;
+        case FLASH_BENCH_OP_WRITE:
+            rc = flash_area_write(cfg->fa, off, buf, len);
+            break;
+        default:
+            rc = flash_area_erase(cfg->fa, off, len);
+            break;
+        }
+        fbt->fbt_samples[i] =
+            os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+        if (rc) {
+            break;
+        }
+        fbt->fbt_bytes += len;
+        fbt->fbt_done++;
+        if (cfg->op != FLASH_BENCH_OP_ERASE) {
+            off += len;
+        }
+    }
+
+    free(buf);
+    return rc;
+}
+
+static void
+flash_bench_task_handler(void *arg)
+{
+    struct flash_bench_task *fbt = arg;
+
+    while (1) {
+        os_sem_pend(&fbt->fbt_start, OS_TIMEOUT_NEVER);
+        fbt->fbt_rc = flash_bench_run_task(fbt);
+        os_sem_release(&flash_bench_done);
+    }
+}
+
+static int
+flash_bench_cmp(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+static uint32_t
+flash_bench_pct(int cnt, int pct)
+{
+    return flash_bench_samples[(cnt - 1) * pct / 100];
+}
+
+static int
+flash_bench_run(struct streamer *streamer)
+{
+    struct flash_bench_cfg *cfg = &flash_bench_cfg;
+    struct flash_bench_task *fbt;
+    uint32_t slice;
+    uint32_t bytes;
+    uint32_t start;
+    uint32_t elapsed;
+    int done;
+    int rc;
+    int i;
+
+    slice = cfg->fa->fa_size / cfg->tasks;
+    slice -= slice % flash_area_align(cfg->fa);
+    if (cfg->op != FLASH_BENCH_OP_ERASE) {
+        if (cfg->offset + cfg->size > slice) {
+            streamer_printf(streamer, "size too large for area\n");
+            return SYS_EINVAL;
+        }
+        if (cfg->op == FLASH_BENCH_OP_WRITE) {
+            /* Every write goes to erased flash. */
+            if (cfg->count > (slice - cfg->offset) / cfg->size) {
+                cfg->count = (slice - cfg->offset) / cfg->size;
+            }
+            rc = flash_area_erase(cfg->fa, 0, cfg->fa->fa_size);
+            if (rc) {
+                streamer_printf(streamer, "erase failed: %d\n", rc);
+                return rc;
+            }
+        }
+    }
+
+    for (i = 0; i < cfg->tasks; i++) {
+        fbt = &flash_bench_tasks[i];
+        fbt->fbt_off = i * slice;
+        fbt->fbt_len = slice;
+        fbt->fbt_bytes = 0;
+        fbt->fbt_done = 0;
+        fbt->fbt_rc = 0;
+        fbt->fbt_samples = &flash_bench_samples[i * cfg->count];
+    }
+
+    start = os_cputime_get32();
+    for (i = 0; i < cfg->tasks; i++) {
+        os_sem_release(&flash_bench_tasks[i].fbt_start);
+    }
+    for (i = 0; i < cfg->tasks; i++) {
+        os_sem_pend(&flash_bench_done, OS_TIMEOUT_NEVER);
+    }
+    elapsed = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+    /* Gather samples of all tasks to the beginning of the array. */
+    done = 0;
+    bytes = 0;
+    rc = 0;
+    for (i = 0; i < cfg->tasks; i++) {
+        fbt = &flash_bench_tasks[i];
+        memmove(&flash_bench_samples[done], fbt->fbt_samples,
+                fbt->fbt_done * sizeof(flash_bench_samples[0]));
+        done += fbt->fbt_done;
+        bytes += fbt->fbt_bytes;
+        if (fbt->fbt_rc) {
+            rc = fbt->fbt_rc;
+        }
+    }
+    if (done == 0) {
+        streamer_printf(streamer, "{\"op\":\"%s\",\"rc\":%d}\n",
+                        flash_bench_op_names[cfg->op], rc);
+        return rc;
+    }
+    qsort(flash_bench_samples, done, sizeof(flash_bench_samples[0]),
+          flash_bench_cmp);
+
+    streamer_printf(streamer,
+                    "{\"area\":%d,\"op\":\"%s\",\"size\":%lu,"
+                    "\"offset\":%lu,\"tasks\":%d,\"ops\":%d,\"rc\":%d,"
+                    "\"bytes\":%lu,\"time_us\":%lu,\"kBps\":%lu,",
+                    cfg->fa->fa_id, flash_bench_op_names[cfg->op],
+                    (unsigned long)cfg->size, (unsigned long)cfg->offset,
+                    cfg->tasks, done, rc, (unsigned long)bytes,
+                    (unsigned long)elapsed,
+                    (unsigned long)(elapsed ?
+                                    (uint64_t)bytes * 1000 / elapsed : 0));
+    streamer_printf(streamer,
+                    "\"lat_us\":{\"min\":%lu,\"p50\":%lu,\"p90\":%lu,"
+                    "\"p99\":%lu,\"max\":%lu}}\n",
+                    (unsigned long)flash_bench_samples[0],
+                    (unsigned long)flash_bench_pct(done, 50),
+                    (unsigned long)flash_bench_pct(done, 90),
+                    (unsigned long)flash_bench_pct(done, 99),
+                    (unsigned long)flash_bench_samples[done - 1]);
+    return rc;
+}
+
+static int
+flash_bench_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                    struct streamer *streamer)
+{
+    static const uint32_t sweep_sizes[] = {
+        16, 64, 256, 1024, 4096
+    };
+    struct flash_bench_cfg *cfg = &flash_bench_cfg;
+    unsigned long val;
+    char *eptr;
+    int sweep = 0;
+    int count = 64;
+    int rc;
+    int i;
+
+    if (argc < 3 || !strcmp(argv[1], "?") || !strcmp(argv[1], "help")) {
+        streamer_printf(streamer,
+          "flash_bench <area_id> read|write|erase [size=<n>|sweep] "
+          "[count=<n>] [offset=<n>] [tasks=<n>]\n");
+        return 0;
+    }
+
+    val = strtoul(argv[1], &eptr, 0);
+    if (*eptr != '\0' || flash_area_open(val, &cfg->fa)) {
+        streamer_printf(streamer, "Invalid flash area %s\n", argv[1]);
+        return 0;
+    }
+    for (i = 0; i < ARRAY_SIZE(flash_bench_op_names); i++) {
+        if (!strcmp(argv[2], flash_bench_op_names[i])) {
+            break;
+        }
+    }
+    if (i == ARRAY_SIZE(flash_bench_op_names)) {
+        streamer_printf(streamer, "Invalid operation %s\n", argv[2]);
+        return 0;
+    }
+    cfg->op = i;
+    cfg->size = 256;
+    cfg->offset = 0;
+    cfg->tasks = 1;
+
+    for (i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "size=sweep")) {
+            sweep = 1;
+            continue;
+        }
+        eptr = strchr(argv[i], '=');
+        if (!eptr) {
+            goto bad_arg;
+        }
+        val = strtoul(eptr + 1, &eptr, 0);
+        if (*eptr != '\0') {
+            goto bad_arg;
+        }
+        if (!strncmp(argv[i], "size=", 5) && val > 0) {
+            cfg->size = val;
+        } else if (!strncmp(argv[i], "count=", 6) && val > 0) {
+            count = val;
+        } else if (!strncmp(argv[i], "offset=", 7)) {
+            cfg->offset = val;
+        } else if (!strncmp(argv[i], "tasks=", 6) && val > 0 &&
+                   val <= MYNEWT_VAL(FLASH_BENCH_MAX_TASKS)) {
+            cfg->tasks = val;
+        } else {
+            goto bad_arg;
+        }
+    }
+    if (count * cfg->tasks > MYNEWT_VAL(FLASH_BENCH_MAX_SAMPLES)) {
+        count = MYNEWT_VAL(FLASH_BENCH_MAX_SAMPLES) / cfg->tasks;
+    }
+
+    if (!sweep) {
+        cfg->count = count;
+        flash_bench_run(streamer);
+    } else {
+        for (i = 0; i < ARRAY_SIZE(sweep_sizes); i++) {
+            cfg->size = sweep_sizes[i];
+            cfg->count = count;
+            rc = flash_bench_run(streamer);
+            if (rc) {
+                break;
+            }
+        }
+    }
+    flash_area_close(cfg->fa);
+    return 0;
+
+bad_arg:
+    streamer_printf(streamer, "Invalid argument %s\n", argv[i]);
+    flash_area_close(cfg->fa);
+    return 0;
+}
+
+static struct shell_cmd flash_bench_cmd_struct =
+    SHELL_CMD_EXT("flash_bench", flash_bench_cli_cmd, NULL);
+
+/*
+ * Initialize the package. Only called from sysinit().
+ */
+void
+flash_bench_init(void)
+{
+    struct flash_bench_task *fbt;
+    int rc;
+    int i;
+
+    os_sem_init(&flash_bench_done, 0);
+    for (i = 0; i < MYNEWT_VAL(FLASH_BENCH_MAX_TASKS); i++) {
+        fbt = &flash_bench_tasks[i];
+        os_sem_init(&fbt->fbt_start, 0);
+        strcpy(fbt->fbt_name, "fbench");
+        fbt->fbt_name[6] = '0' + i;
+        fbt->fbt_name[7] = '\0';
+        rc = os_task_init(&fbt->fbt_task, fbt->fbt_name,
+                          flash_bench_task_handler, fbt,
+                          MYNEWT_VAL(FLASH_BENCH_TASK_PRIO) + i,
+                          OS_WAIT_FOREVER, fbt->fbt_stack,
+                          MYNEWT_VAL(FLASH_BENCH_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+
+    shell_cmd_register(&flash_bench_cmd_struct);
+}
@@ -20,6 +20,7 @@
 #define __UTIL_CBMEM_H__
 
 #include "os/mynewt.h"
+#include "os/os_amutex.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,14 +31,24 @@ struct cbmem_entry_hdr {
     uint16_t ceh_flags;
 } __attribute__((packed));
 
+/* Space is reserved, but the entry contents are not written yet. */
+#define CBMEM_ENTRY_F_PENDING   0x0001
+
 struct cbmem {
-    struct os_mutex c_lock;
+    struct os_amutex c_lock;
 
     struct cbmem_entry_hdr *c_entry_start;
     struct cbmem_entry_hdr *c_entry_end;
     uint8_t *c_buf;
     uint8_t *c_buf_end;
     uint8_t *c_buf_cur_end;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    /* Number of entries with CBMEM_ENTRY_F_PENDING set. */
+    uint16_t c_pending;
+    /* Nesting count of cbmem_lock_acquire(); entries are not evicted
+     * while a reader holds the lock. */
+    uint16_t c_pinned;
+#endif
 };
 
 struct cbmem_iter {
@@ -92,6 +103,32 @@ int cbmem_append_mbuf(struct cbmem *cbmem, const struct os_mbuf *om);
 int cbmem_append_scat_gath(struct cbmem *cbmem,
                            const struct cbmem_scat_gath *sg);
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+/**
+ * @brief Reserves space for an entry without taking the cbmem lock.
+ *
+ * The entry is skipped by readers until cbmem_append_commit() is called.
+ * Oldest entries are evicted to make room, but never while a reader holds
+ * the cbmem lock, and never past an entry that is still pending; the
+ * reservation fails instead.  Safe to call from interrupt context.
+ *
+ * @param cbmem                 The cbmem to write to.
+ * @param len                   The length of the entry contents.
+ *
+ * @return                      Pointer to len bytes to fill in;
+ *                              NULL if no space could be reserved.
+ */
+void *cbmem_append_reserve(struct cbmem *cbmem, uint16_t len);
+
+/**
+ * @brief Publishes an entry reserved with cbmem_append_reserve().
+ *
+ * @param cbmem                 The cbmem the entry was reserved in.
+ * @param data                  Pointer returned by cbmem_append_reserve().
+ */
+void cbmem_append_commit(struct cbmem *cbmem, void *data);
+#endif
+
 void cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter);
 struct cbmem_entry_hdr *cbmem_iter_next(struct cbmem *cbmem, 
         struct cbmem_iter *iter);
@@ -86,6 +86,9 @@ TEST_SUITE(cbmem_test_suite)
     cbmem_test_case_1();
     cbmem_test_case_2();
     cbmem_test_case_3();
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    cbmem_test_case_4();
+#endif
 }
 
 int
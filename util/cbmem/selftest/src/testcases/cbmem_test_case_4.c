@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cbmem_test/cbmem_test.h"
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+
+TEST_CASE_SELF(cbmem_test_case_4)
+{
+    struct cbmem_entry_hdr *pending;
+    struct cbmem_entry_hdr *hdr;
+    struct cbmem_iter iter;
+    uint8_t *data;
+    int rc;
+    int i;
+
+    data = cbmem_append_reserve(&cbmem1, CBMEM1_ENTRY_SIZE);
+    TEST_ASSERT_FATAL(data != NULL);
+    pending = (struct cbmem_entry_hdr *)(data - sizeof(*pending));
+
+    /* Readers skip the entry until it is committed. */
+    cbmem_iter_start(&cbmem1, &iter);
+    while ((hdr = cbmem_iter_next(&cbmem1, &iter)) != NULL) {
+        TEST_ASSERT(hdr != pending);
+    }
+
+    /* Appends wrap around until they reach the pending entry. */
+    for (i = 0; i < CBMEM1_ENTRY_COUNT; i++) {
+        cbmem1_entry[0] = i;
+        rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+        if (rc != 0) {
+            break;
+        }
+    }
+    TEST_ASSERT_FATAL(rc != 0);
+    TEST_ASSERT(i > 0);
+
+    /* Once committed, it is the oldest entry. */
+    memset(data, 0xaa, CBMEM1_ENTRY_SIZE);
+    cbmem_append_commit(&cbmem1, data);
+    cbmem_iter_start(&cbmem1, &iter);
+    hdr = cbmem_iter_next(&cbmem1, &iter);
+    TEST_ASSERT(hdr == pending);
+
+    /* Entries are not evicted while a reader holds the lock. */
+    rc = cbmem_lock_acquire(&cbmem1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+    TEST_ASSERT(rc != 0);
+    rc = cbmem_lock_release(&cbmem1);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+    TEST_ASSERT(rc == 0);
+
+    /* Flush is refused while an append is in progress. */
+    data = cbmem_append_reserve(&cbmem1, 16);
+    TEST_ASSERT_FATAL(data != NULL);
+    rc = cbmem_flush(&cbmem1);
+    TEST_ASSERT(rc == OS_EBUSY);
+    cbmem_append_commit(&cbmem1, data);
+    rc = cbmem_flush(&cbmem1);
+    TEST_ASSERT(rc == 0);
+}
+
+#endif
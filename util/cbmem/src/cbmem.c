@@ -26,7 +26,7 @@ typedef void (copy_data_func_t) (void *dst, const void *data, uint16_t len);
 int
 cbmem_init(struct cbmem *cbmem, void *buf, uint32_t buf_len)
 {
-    os_mutex_init(&cbmem->c_lock);
+    os_amutex_init(&cbmem->c_lock);
 
     memset(cbmem, 0, sizeof(*cbmem));
     cbmem->c_buf = buf;
@@ -35,19 +35,43 @@ cbmem_init(struct cbmem *cbmem, void *buf, uint32_t buf_len)
     return (0);
 }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+static void
+cbmem_pin(struct cbmem *cbmem, int delta)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    cbmem->c_pinned += delta;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static int
+cbmem_entry_pending(const void *hdr)
+{
+    return ((const struct cbmem_entry_hdr *)hdr)->ceh_flags &
+           CBMEM_ENTRY_F_PENDING;
+}
+#else
+#define cbmem_pin(cbmem, delta)
+#define cbmem_entry_pending(hdr) 0
+#endif
+
 int
 cbmem_lock_acquire(struct cbmem *cbmem)
 {
     int rc;
 
     if (!os_started()) {
+        cbmem_pin(cbmem, 1);
         return (0);
     }
 
-    rc = os_mutex_pend(&cbmem->c_lock, OS_WAIT_FOREVER);
+    rc = os_amutex_pend(&cbmem->c_lock, OS_WAIT_FOREVER);
     if (rc != 0) {
         goto err;
     }
+    cbmem_pin(cbmem, 1);
 
     return (0);
 err:
@@ -59,11 +83,13 @@ cbmem_lock_release(struct cbmem *cbmem)
 {
     int rc;
 
+    cbmem_pin(cbmem, -1);
+
     if (!os_started()) {
         return (0);
     }
 
-    rc = os_mutex_release(&cbmem->c_lock);
+    rc = os_amutex_release(&cbmem->c_lock);
     if (rc != 0) {
         goto err;
     }
@@ -74,19 +100,18 @@ err:
 }
 
 
-static int
-cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
-                      copy_data_func_t *copy_func)
+/*
+ * Finds room for an entry of len bytes, evicting the oldest entries if
+ * needed, and links it in as the newest entry.  Returns NULL if entries
+ * can not be evicted at the moment.
+ */
+static struct cbmem_entry_hdr *
+cbmem_reserve(struct cbmem *cbmem, uint16_t len)
 {
     struct cbmem_entry_hdr *dst;
+    uint8_t *cur_end;
     uint8_t *start;
     uint8_t *end;
-    int rc;
-
-    rc = cbmem_lock_acquire(cbmem);
-    if (rc != 0) {
-        goto err;
-    }
 
     if (cbmem->c_entry_end) {
         dst = CBMEM_ENTRY_NEXT(cbmem->c_entry_end);
@@ -94,16 +119,18 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
         dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
     }
     end = (uint8_t *) dst + len + sizeof(*dst);
+    cur_end = cbmem->c_buf_cur_end;
+    start = (uint8_t *) cbmem->c_entry_start;
 
     /* If this item would take us past the end of this buffer, then adjust
      * the item to the beginning of the buffer.
      */
     if (end > cbmem->c_buf_end) {
-        cbmem->c_buf_cur_end = (uint8_t *) dst;
+        cur_end = (uint8_t *) dst;
         dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
         end = (uint8_t *) dst + len + sizeof(*dst);
-        if ((uint8_t *) cbmem->c_entry_start >= cbmem->c_buf_cur_end) {
-            cbmem->c_entry_start = (struct cbmem_entry_hdr *) cbmem->c_buf;
+        if (start >= cur_end) {
+            start = cbmem->c_buf;
         }
     }
 
@@ -111,29 +138,106 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
      * start of the buffer, move start forward until you don't overwrite it
      * anymore.
      */
-    start = (uint8_t *) cbmem->c_entry_start;
     if (start && (uint8_t *) dst < start + CBMEM_ENTRY_SIZE(start) &&
             end > start) {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+        if (cbmem->c_pinned) {
+            return NULL;
+        }
+#endif
         while (start < end) {
+            if (cbmem_entry_pending(start)) {
+                return NULL;
+            }
             start = (uint8_t *) CBMEM_ENTRY_NEXT(start);
-            if (start == cbmem->c_buf_cur_end) {
+            if (start == cur_end) {
                 start = cbmem->c_buf;
                 break;
             }
         }
-        cbmem->c_entry_start = (struct cbmem_entry_hdr *) start;
     }
 
-    /* Copy the entry into the log
-     */
     dst->ceh_len = len;
-    copy_func((uint8_t *) dst + sizeof(*dst), data, len);
+    dst->ceh_flags = 0;
 
+    cbmem->c_buf_cur_end = cur_end;
+    cbmem->c_entry_start = (struct cbmem_entry_hdr *) start;
     cbmem->c_entry_end = dst;
     if (!cbmem->c_entry_start) {
         cbmem->c_entry_start = dst;
     }
 
+    return dst;
+}
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+void *
+cbmem_append_reserve(struct cbmem *cbmem, uint16_t len)
+{
+    struct cbmem_entry_hdr *dst;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    dst = cbmem_reserve(cbmem, len);
+    if (dst) {
+        dst->ceh_flags = CBMEM_ENTRY_F_PENDING;
+        cbmem->c_pending++;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!dst) {
+        return NULL;
+    }
+    return (uint8_t *) dst + sizeof(*dst);
+}
+
+void
+cbmem_append_commit(struct cbmem *cbmem, void *data)
+{
+    struct cbmem_entry_hdr *hdr;
+    os_sr_t sr;
+
+    hdr = (struct cbmem_entry_hdr *) ((uint8_t *) data - sizeof(*hdr));
+
+    OS_ENTER_CRITICAL(sr);
+    hdr->ceh_flags &= ~CBMEM_ENTRY_F_PENDING;
+    cbmem->c_pending--;
+    OS_EXIT_CRITICAL(sr);
+}
+
+static int
+cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
+                      copy_data_func_t *copy_func)
+{
+    void *dst;
+
+    dst = cbmem_append_reserve(cbmem, len);
+    if (!dst) {
+        return (-1);
+    }
+    copy_func(dst, data, len);
+    cbmem_append_commit(cbmem, dst);
+
+    return (0);
+}
+#else
+static int
+cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
+                      copy_data_func_t *copy_func)
+{
+    struct cbmem_entry_hdr *dst;
+    int rc;
+
+    rc = cbmem_lock_acquire(cbmem);
+    if (rc != 0) {
+        goto err;
+    }
+
+    /* Copy the entry into the log
+     */
+    dst = cbmem_reserve(cbmem, len);
+    copy_func((uint8_t *) dst + sizeof(*dst), data, len);
+
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
         goto err;
@@ -143,6 +247,7 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
 err:
     return (-1);
 }
+#endif
 
 static void
 copy_data_from_flat(void *dst, const void *data, uint16_t len)
@@ -226,13 +331,21 @@ cbmem_append_scat_gath(struct cbmem *cbmem, const struct cbmem_scat_gath *sg)
 void
 cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+#endif
     iter->ci_start = cbmem->c_entry_start;
     iter->ci_cur = cbmem->c_entry_start;
     iter->ci_end = cbmem->c_entry_end;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    OS_EXIT_CRITICAL(sr);
+#endif
 }
 
-struct cbmem_entry_hdr *
-cbmem_iter_next(struct cbmem *cbmem, struct cbmem_iter *iter)
+static struct cbmem_entry_hdr *
+cbmem_iter_next_any(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
     struct cbmem_entry_hdr *hdr;
 
@@ -261,9 +374,25 @@ err:
     return (hdr);
 }
 
+struct cbmem_entry_hdr *
+cbmem_iter_next(struct cbmem *cbmem, struct cbmem_iter *iter)
+{
+    struct cbmem_entry_hdr *hdr;
+
+    /* Skip over entries whose contents are still being written. */
+    do {
+        hdr = cbmem_iter_next_any(cbmem, iter);
+    } while (hdr != NULL && cbmem_entry_pending(hdr));
+
+    return (hdr);
+}
+
 int
 cbmem_flush(struct cbmem *cbmem)
 {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    os_sr_t sr;
+#endif
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -271,9 +400,21 @@ cbmem_flush(struct cbmem *cbmem)
         goto err;
     }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    OS_ENTER_CRITICAL(sr);
+    if (cbmem->c_pending) {
+        /* An append is still copying its contents into the buffer. */
+        OS_EXIT_CRITICAL(sr);
+        cbmem_lock_release(cbmem);
+        return (OS_EBUSY);
+    }
+#endif
     cbmem->c_entry_start = NULL;
     cbmem->c_entry_end = NULL;
     cbmem->c_buf_cur_end = NULL;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_APPEND)
+    OS_EXIT_CRITICAL(sr);
+#endif
 
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
@@ -31,6 +31,13 @@ extern "C" {
 uint32_t crc32_init(void);
 uint32_t crc32_calc(uint32_t val, const void *buf, size_t cnt);
 
+/**
+ * CRC-32 in hardware.  With CRC32_HW set, crc32_calc() calls this; it is
+ * provided by the MCU package (e.g. hw/mcu/stm/stm32_common) and takes and
+ * returns the same running value as crc32_calc().
+ */
+uint32_t crc32_hw_calc(uint32_t val, const void *buf, size_t cnt);
+
 #ifdef __cplusplus
 }
 #endif
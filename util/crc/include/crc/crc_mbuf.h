@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _UTIL_CRC_MBUF_H_
+#define _UTIL_CRC_MBUF_H_
+
+#include <inttypes.h>
+#include "os/os_mbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs crc32_calc() over part of an mbuf chain, one mbuf at a time, so the
+ * data doesn't need to be contiguous.
+ *
+ * @param val                   The running CRC, as for crc32_calc().
+ * @param om                    The mbuf chain.
+ * @param off                   Offset of the first byte to include.
+ * @param len                   Number of bytes to include.
+ * @param crc                   Filled with the resulting CRC.
+ *
+ * @return                      0 on success; SYS_EINVAL if the chain is
+ *                                  shorter than off + len.
+ */
+int crc32_mbuf(uint32_t val, const struct os_mbuf *om, int off, int len,
+               uint32_t *crc);
+
+/**
+ * Like crc32_mbuf(), for crc16_ccitt().
+ */
+int crc16_ccitt_mbuf(uint16_t val, const struct os_mbuf *om, int off,
+                     int len, uint16_t *crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
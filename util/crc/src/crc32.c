@@ -18,14 +18,36 @@
  */
 
 
+#include "syscfg/syscfg.h"
 #include <crc/crc32.h>
 
+#define CRC32_TABLE_SLICES  MYNEWT_VAL(CRC32_TABLE_SLICES)
+
+#if CRC32_TABLE_SLICES != 0 && CRC32_TABLE_SLICES != 1 && \
+    CRC32_TABLE_SLICES != 4 && CRC32_TABLE_SLICES != 8
+#error "CRC32_TABLE_SLICES must be 0, 1, 4 or 8"
+#endif
+
+#if CRC32_TABLE_SLICES > 0
+#include "crc32_tab.h"
+#endif
+
 uint32_t
 crc32_init(void)
 {
     return 0;
 }
 
+#if MYNEWT_VAL(CRC32_HW)
+
+uint32_t
+crc32_calc(uint32_t val, const void *buf, size_t cnt)
+{
+    return crc32_hw_calc(val, buf, cnt);
+}
+
+#elif CRC32_TABLE_SLICES == 0
+
 uint32_t
 crc32_calc(uint32_t val, const void *buf, size_t cnt)
 {
@@ -44,3 +66,58 @@ crc32_calc(uint32_t val, const void *buf, size_t cnt)
     }
     return ~crc;
 }
+
+#else
+
+/* Assembled byte by byte; buf need not be aligned. */
+static inline uint32_t
+crc32_le32(const uint8_t *b)
+{
+    return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+uint32_t
+crc32_calc(uint32_t val, const void *buf, size_t cnt)
+{
+    const uint8_t *b = (const uint8_t *)buf;
+    uint32_t crc;
+#if CRC32_TABLE_SLICES == 8
+    uint32_t hi;
+#endif
+
+    crc = ~val;
+
+#if CRC32_TABLE_SLICES == 8
+    while (cnt >= 8) {
+        crc ^= crc32_le32(b);
+        hi = crc32_le32(b + 4);
+        crc = crc32_tab[7][crc & 0xff] ^
+              crc32_tab[6][(crc >> 8) & 0xff] ^
+              crc32_tab[5][(crc >> 16) & 0xff] ^
+              crc32_tab[4][crc >> 24] ^
+              crc32_tab[3][hi & 0xff] ^
+              crc32_tab[2][(hi >> 8) & 0xff] ^
+              crc32_tab[1][(hi >> 16) & 0xff] ^
+              crc32_tab[0][hi >> 24];
+        b += 8;
+        cnt -= 8;
+    }
+#elif CRC32_TABLE_SLICES == 4
+    while (cnt >= 4) {
+        crc ^= crc32_le32(b);
+        crc = crc32_tab[3][crc & 0xff] ^
+              crc32_tab[2][(crc >> 8) & 0xff] ^
+              crc32_tab[1][(crc >> 16) & 0xff] ^
+              crc32_tab[0][crc >> 24];
+        b += 4;
+        cnt -= 4;
+    }
+#endif
+
+    while (cnt--) {
+        crc = (crc >> 8) ^ crc32_tab[0][(crc ^ *b++) & 0xff];
+    }
+    return ~crc;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc/crc_mbuf.h"
+
+/*
+ * Seeks to off and checks that len bytes follow.  Returns the mbuf holding
+ * off, with *moff set to the offset within it.
+ */
+static const struct os_mbuf *
+crc_mbuf_seek(const struct os_mbuf *om, int off, int len, uint16_t *moff)
+{
+    const struct os_mbuf *cur;
+    int avail;
+
+    if (off < 0 || len < 0) {
+        return NULL;
+    }
+    cur = os_mbuf_off(om, off, moff);
+    if (cur == NULL) {
+        return NULL;
+    }
+
+    avail = cur->om_len - *moff;
+    for (om = SLIST_NEXT(cur, om_next); om != NULL && avail < len;
+         om = SLIST_NEXT(om, om_next)) {
+        avail += om->om_len;
+    }
+    if (avail < len) {
+        return NULL;
+    }
+    return cur;
+}
+
+int
+crc32_mbuf(uint32_t val, const struct os_mbuf *om, int off, int len,
+           uint32_t *crc)
+{
+    uint16_t moff;
+    int chunk;
+
+    om = crc_mbuf_seek(om, off, len, &moff);
+    if (om == NULL) {
+        return SYS_EINVAL;
+    }
+
+    while (len > 0) {
+        chunk = min(om->om_len - moff, len);
+        val = crc32_calc(val, om->om_data + moff, chunk);
+        len -= chunk;
+        moff = 0;
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    *crc = val;
+    return 0;
+}
+
+int
+crc16_ccitt_mbuf(uint16_t val, const struct os_mbuf *om, int off, int len,
+                 uint16_t *crc)
+{
+    uint16_t moff;
+    int chunk;
+
+    om = crc_mbuf_seek(om, off, len, &moff);
+    if (om == NULL) {
+        return SYS_EINVAL;
+    }
+
+    while (len > 0) {
+        chunk = min(om->om_len - moff, len);
+        val = crc16_ccitt(val, om->om_data + moff, chunk);
+        len -= chunk;
+        moff = 0;
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    *crc = val;
+    return 0;
+}
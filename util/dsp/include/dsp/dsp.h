@@ -0,0 +1,239 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_DSP_
+#define H_DSP_
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Fixed-point sample, 1.15 format */
+typedef int16_t q15_t;
+
+/*
+ * Set when kernels use packed 16-bit instructions; otherwise the default
+ * functions are the same as their _scalar variants.
+ */
+#if MYNEWT_VAL(DSP_SIMD) && defined(__ARM_FEATURE_SIMD32) && \
+    __ARM_FEATURE_SIMD32
+#define DSP_HAS_SIMD    1
+#else
+#define DSP_HAS_SIMD    0
+#endif
+
+/**
+ * Convert float in range [-1, 1) to Q15, with saturation.
+ */
+#define DSP_Q15(f)                                                      \
+    ((q15_t)((f) >= 1.0 ? 32767 : (f) <= -1.0 ? -32768 : (f) * 32768))
+
+/**
+ * FIR filter instance.
+ */
+struct dsp_fir_q15 {
+    /* Coefficients, b[0] applies to newest sample */
+    const q15_t *df_coeffs;
+    /* History followed by current block, DSP_FIR_STATE_LEN() entries */
+    q15_t *df_state;
+    uint16_t df_num_taps;
+    uint16_t df_block_size;
+};
+
+/**
+ * Number of state entries for a filter with given number of taps,
+ * processing at most block_size samples per step.
+ */
+#define DSP_FIR_STATE_LEN(num_taps, block_size) \
+    ((num_taps) + (block_size) - 1)
+
+/**
+ * Initialize FIR filter and clear its history.
+ *
+ * @param fir           Filter to initialize
+ * @param coeffs        Filter coefficients, must stay valid
+ * @param num_taps      Number of coefficients
+ * @param state         State buffer, DSP_FIR_STATE_LEN() entries
+ * @param block_size    Number of samples filtered per step; longer
+ *                      input is processed in steps
+ *
+ * @return 0 on success, SYS_EINVAL on bad arguments
+ */
+int dsp_fir_q15_init(struct dsp_fir_q15 *fir, const q15_t *coeffs,
+                     uint16_t num_taps, q15_t *state, uint16_t block_size);
+
+/**
+ * Filter samples.  Products are accumulated in 64 bits, output is
+ * rounded down and saturated to Q15.  In-place operation (in == out) is
+ * allowed.
+ *
+ * @param fir           Filter
+ * @param in            Input samples
+ * @param out           Output samples
+ * @param len           Number of samples
+ */
+void dsp_fir_q15(struct dsp_fir_q15 *fir, const q15_t *in, q15_t *out,
+                 size_t len);
+
+/**
+ * Same as dsp_fir_q15(), never uses packed instructions.
+ */
+void dsp_fir_q15_scalar(struct dsp_fir_q15 *fir, const q15_t *in,
+                        q15_t *out, size_t len);
+
+/**
+ * FIR decimator; filters and keeps every dd_factor-th output.
+ */
+struct dsp_fir_decim_q15 {
+    struct dsp_fir_q15 dd_fir;
+    uint8_t dd_factor;
+};
+
+/**
+ * Initialize FIR decimator.
+ *
+ * @param dec           Decimator to initialize
+ * @param coeffs        Anti-aliasing filter coefficients
+ * @param num_taps      Number of coefficients
+ * @param factor        Decimation factor
+ * @param state         State buffer, DSP_FIR_STATE_LEN() entries
+ * @param block_size    Input samples per step, multiple of factor
+ *
+ * @return 0 on success, SYS_EINVAL on bad arguments
+ */
+int dsp_fir_decim_q15_init(struct dsp_fir_decim_q15 *dec,
+                           const q15_t *coeffs, uint16_t num_taps,
+                           uint8_t factor, q15_t *state,
+                           uint16_t block_size);
+
+/**
+ * Filter and decimate samples.
+ *
+ * @param dec           Decimator
+ * @param in            Input samples
+ * @param out           Output, len / factor samples
+ * @param len           Number of input samples, multiple of factor
+ *
+ * @return number of output samples
+ */
+size_t dsp_fir_decim_q15(struct dsp_fir_decim_q15 *dec, const q15_t *in,
+                         q15_t *out, size_t len);
+
+/**
+ * Sum of squares of samples, in Q30.
+ */
+int64_t dsp_power_q15(const q15_t *x, size_t len);
+int64_t dsp_power_q15_scalar(const q15_t *x, size_t len);
+
+/**
+ * Root mean square of samples.
+ */
+q15_t dsp_rms_q15(const q15_t *x, size_t len);
+q15_t dsp_rms_q15_scalar(const q15_t *x, size_t len);
+
+/**
+ * Complex FFT instance.
+ */
+struct dsp_cfft_q15 {
+    const q15_t *dc_twiddle;
+    uint16_t dc_len;
+};
+
+/**
+ * Number of twiddle table entries for FFT of given length.
+ */
+#define DSP_CFFT_TWIDDLE_LEN(len)   (len)
+
+/**
+ * Initialize complex FFT and compute its twiddle table.
+ *
+ * @param fft           FFT to initialize
+ * @param len           Number of complex points, power of 2, 4 to 4096
+ * @param twiddle       Table to fill, DSP_CFFT_TWIDDLE_LEN() entries;
+ *                      may be shared by FFTs of same length
+ *
+ * @return 0 on success, SYS_EINVAL on bad arguments
+ */
+int dsp_cfft_q15_init(struct dsp_cfft_q15 *fft, uint16_t len,
+                      q15_t *twiddle);
+
+/**
+ * In-place forward complex FFT.  Data is stored as interleaved real and
+ * imaginary parts.  Each stage scales by 1/2 to avoid overflow, so the
+ * result is DFT divided by len.
+ *
+ * @param fft           FFT instance
+ * @param data          2 * len samples
+ */
+void dsp_cfft_q15(const struct dsp_cfft_q15 *fft, q15_t *data);
+void dsp_cfft_q15_scalar(const struct dsp_cfft_q15 *fft, q15_t *data);
+
+/**
+ * Magnitude of complex values.
+ *
+ * @param data          Interleaved complex values, 2 * len samples
+ * @param mag           Output, len samples; may be same as data
+ * @param len           Number of complex values
+ */
+void dsp_cmag_q15(const q15_t *data, q15_t *mag, size_t len);
+
+#if MYNEWT_VAL(DSP_SENSOR)
+struct sensor_accel_data;
+
+/**
+ * Extract one axis of accelerometer readings as Q15.
+ *
+ * @param sad           Readings
+ * @param len           Number of readings
+ * @param axis          0 for X, 1 for Y, 2 for Z
+ * @param full_scale    Value mapped to 1.0 (e.g. 4 * STANDARD_ACCEL_GRAVITY
+ *                      for +/-4g range)
+ * @param out           Output, len samples
+ */
+void dsp_accel_to_q15(const struct sensor_accel_data *sad, size_t len,
+                      int axis, float full_scale, q15_t *out);
+#endif
+
+#if MYNEWT_VAL(DSP_I2S)
+struct i2s;
+struct i2s_sample_buffer;
+
+/**
+ * Filter 16-bit samples of I2S buffer in place.  Interleaved channels are
+ * filtered as one stream, use one filter per device and mono data.
+ *
+ * @param fir           Filter
+ * @param i2s           Device buffer belongs to
+ * @param buffer        Buffer with sample_count samples
+ *
+ * @return 0 on success, SYS_EINVAL if samples are not 16-bit
+ */
+int dsp_fir_q15_i2s(struct dsp_fir_q15 *fir, struct i2s *i2s,
+                    struct i2s_sample_buffer *buffer);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_DSP_ */
@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "dsp/dsp.h"
+#include "dsp_test.h"
+
+#define DECIM_TAPS      4
+#define DECIM_FACTOR    4
+#define DECIM_BLOCK     8
+#define DECIM_LEN       32
+
+TEST_CASE_SELF(dsp_test_case_decim)
+{
+    static const q15_t coeffs[DECIM_TAPS] = { 8192, 8192, 8192, 8192 };
+    q15_t state[DSP_FIR_STATE_LEN(DECIM_TAPS, DECIM_BLOCK)];
+    struct dsp_fir_decim_q15 dec;
+    q15_t in[DECIM_LEN];
+    q15_t out[DECIM_LEN / DECIM_FACTOR];
+    size_t cnt;
+    int rc;
+    int i;
+
+    rc = dsp_fir_decim_q15_init(&dec, coeffs, DECIM_TAPS, DECIM_FACTOR,
+                                state, 6);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = dsp_fir_decim_q15_init(&dec, coeffs, DECIM_TAPS, DECIM_FACTOR,
+                                state, DECIM_BLOCK);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Moving average of 4 over steps of 1000 every 4 samples */
+    for (i = 0; i < DECIM_LEN; i++) {
+        in[i] = (i / DECIM_FACTOR) * 1000;
+    }
+    cnt = dsp_fir_decim_q15(&dec, in, out, DECIM_LEN);
+    TEST_ASSERT_FATAL(cnt == DECIM_LEN / DECIM_FACTOR);
+    /* Outputs are taken at inputs 0, 4, 8, ... */
+    TEST_ASSERT(out[0] == 0);
+    for (i = 1; i < cnt; i++) {
+        TEST_ASSERT(out[i] == i * 1000 - 750);
+    }
+}
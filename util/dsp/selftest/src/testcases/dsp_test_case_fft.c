@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "dsp/dsp.h"
+#include "dsp_test.h"
+
+#define FFT_LEN     64
+#define FFT_BIN     5
+
+static q15_t fft_twiddle[DSP_CFFT_TWIDDLE_LEN(FFT_LEN)];
+static q15_t fft_data[2 * FFT_LEN];
+static q15_t fft_ref[2 * FFT_LEN];
+
+static int
+fft_near(int v, int expected, int tol)
+{
+    return v >= expected - tol && v <= expected + tol;
+}
+
+TEST_CASE_SELF(dsp_test_case_fft)
+{
+    struct dsp_cfft_q15 fft;
+    int idx;
+    int rc;
+    int i;
+
+    rc = dsp_cfft_q15_init(&fft, 48, fft_twiddle);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = dsp_cfft_q15_init(&fft, FFT_LEN, fft_twiddle);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(fft_twiddle[0] == 32767 && fft_twiddle[1] == 0);
+    TEST_ASSERT(fft_near(fft_twiddle[FFT_LEN / 2], 0, 1));
+    TEST_ASSERT(fft_near(fft_twiddle[FFT_LEN / 2 + 1], -32767, 1));
+
+    /* Impulse gives flat spectrum of 1 / len */
+    memset(fft_data, 0, sizeof(fft_data));
+    fft_data[0] = 32767;
+    dsp_cfft_q15(&fft, fft_data);
+    for (i = 0; i < FFT_LEN; i++) {
+        TEST_ASSERT(fft_near(fft_data[2 * i], 32767 / FFT_LEN, 2));
+        TEST_ASSERT(fft_near(fft_data[2 * i + 1], 0, 2));
+    }
+
+    /* Cosine at FFT_BIN, built from the twiddle table */
+    for (i = 0; i < FFT_LEN; i++) {
+        idx = (i * FFT_BIN) % FFT_LEN;
+        if (idx < FFT_LEN / 2) {
+            fft_data[2 * i] = fft_twiddle[2 * idx] / 2;
+        } else {
+            fft_data[2 * i] = -fft_twiddle[2 * (idx - FFT_LEN / 2)] / 2;
+        }
+        fft_data[2 * i + 1] = 0;
+    }
+    memcpy(fft_ref, fft_data, sizeof(fft_data));
+
+    dsp_cfft_q15(&fft, fft_data);
+    dsp_cfft_q15_scalar(&fft, fft_ref);
+    TEST_ASSERT(memcmp(fft_data, fft_ref, sizeof(fft_data)) == 0);
+
+    dsp_cmag_q15(fft_data, fft_data, FFT_LEN);
+    for (i = 0; i < FFT_LEN; i++) {
+        if (i == FFT_BIN || i == FFT_LEN - FFT_BIN) {
+            TEST_ASSERT(fft_near(fft_data[i], 16384 / 2, 16));
+        } else {
+            TEST_ASSERT(fft_near(fft_data[i], 0, 16));
+        }
+    }
+}
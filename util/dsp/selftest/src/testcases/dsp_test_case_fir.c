@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "dsp/dsp.h"
+#include "dsp_test.h"
+
+#define FIR_TAPS    13
+#define FIR_BLOCK   16
+#define FIR_LEN     100
+
+static q15_t fir_coeffs[FIR_TAPS];
+static q15_t fir_in[FIR_LEN];
+static q15_t fir_ref[FIR_LEN];
+static q15_t fir_out[FIR_LEN];
+static q15_t fir_state[DSP_FIR_STATE_LEN(FIR_TAPS, FIR_BLOCK)];
+
+static void
+fir_fill(void)
+{
+    uint32_t seed = 1;
+    int64_t acc;
+    int n;
+    int k;
+
+    for (k = 0; k < FIR_TAPS; k++) {
+        seed = seed * 1103515245 + 12345;
+        fir_coeffs[k] = (q15_t)(seed >> 16) / 4;
+    }
+    for (n = 0; n < FIR_LEN; n++) {
+        seed = seed * 1103515245 + 12345;
+        fir_in[n] = (q15_t)(seed >> 16);
+    }
+    /* Worst case input to exercise saturation */
+    fir_in[50] = -32768;
+
+    for (n = 0; n < FIR_LEN; n++) {
+        acc = 0;
+        for (k = 0; k < FIR_TAPS && k <= n; k++) {
+            acc += (int32_t)fir_coeffs[k] * fir_in[n - k];
+        }
+        acc >>= 15;
+        if (acc > 32767) {
+            acc = 32767;
+        } else if (acc < -32768) {
+            acc = -32768;
+        }
+        fir_ref[n] = acc;
+    }
+}
+
+TEST_CASE_SELF(dsp_test_case_fir)
+{
+    struct dsp_fir_q15 fir;
+    int rc;
+
+    fir_fill();
+
+    rc = dsp_fir_q15_init(&fir, fir_coeffs, 0, fir_state, FIR_BLOCK);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = dsp_fir_q15_init(&fir, fir_coeffs, FIR_TAPS, fir_state, FIR_BLOCK);
+    TEST_ASSERT_FATAL(rc == 0);
+    dsp_fir_q15(&fir, fir_in, fir_out, FIR_LEN);
+    TEST_ASSERT(memcmp(fir_out, fir_ref, sizeof(fir_ref)) == 0);
+
+    /* Split into calls not aligned to block size */
+    dsp_fir_q15_init(&fir, fir_coeffs, FIR_TAPS, fir_state, FIR_BLOCK);
+    dsp_fir_q15_scalar(&fir, fir_in, fir_out, 7);
+    dsp_fir_q15_scalar(&fir, fir_in + 7, fir_out + 7, FIR_LEN - 7);
+    TEST_ASSERT(memcmp(fir_out, fir_ref, sizeof(fir_ref)) == 0);
+
+    /* In place */
+    memcpy(fir_out, fir_in, sizeof(fir_in));
+    dsp_fir_q15_init(&fir, fir_coeffs, FIR_TAPS, fir_state, FIR_BLOCK);
+    dsp_fir_q15(&fir, fir_out, fir_out, FIR_LEN);
+    TEST_ASSERT(memcmp(fir_out, fir_ref, sizeof(fir_ref)) == 0);
+}
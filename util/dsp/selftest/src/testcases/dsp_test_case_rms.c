@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "dsp/dsp.h"
+#include "dsp_test.h"
+
+TEST_CASE_SELF(dsp_test_case_rms)
+{
+    q15_t x[31];
+    int i;
+
+    for (i = 0; i < 31; i++) {
+        x[i] = 1000;
+    }
+    TEST_ASSERT(dsp_power_q15(x, 31) == 31 * 1000 * 1000);
+    TEST_ASSERT(dsp_power_q15(x, 31) == dsp_power_q15_scalar(x, 31));
+    TEST_ASSERT(dsp_rms_q15(x, 31) == 1000);
+
+    /* Full scale square wave, odd length exercises the scalar tail */
+    for (i = 0; i < 31; i++) {
+        x[i] = (i & 1) ? -32768 : 32767;
+    }
+    TEST_ASSERT(dsp_rms_q15(x, 31) >= 32766);
+    TEST_ASSERT(dsp_rms_q15(x, 31) == dsp_rms_q15_scalar(x, 31));
+
+    TEST_ASSERT(dsp_rms_q15(x, 0) == 0);
+}
@@ -0,0 +1,204 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "defs/error.h"
+#include "dsp/dsp.h"
+#include "dsp_priv.h"
+
+#define DSP_Q30_ONE     ((int64_t)1 << 30)
+/* 2 * pi in Q30 */
+#define DSP_Q30_2PI     6746518852LL
+
+static int64_t
+dsp_q30_mul(int64_t a, int64_t b)
+{
+    return (a * b) >> 30;
+}
+
+/*
+ * Sine and cosine of 0 <= x <= pi / 2 in Q30 from Taylor series; error is
+ * well below Q15 resolution.
+ */
+static void
+dsp_sincos_q30(int64_t x, int64_t *s, int64_t *c)
+{
+    int64_t x2;
+    int64_t t;
+
+    x2 = dsp_q30_mul(x, x);
+
+    t = DSP_Q30_ONE - x2 / 72;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 42;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 20;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 6;
+    *s = dsp_q30_mul(x, t);
+
+    t = DSP_Q30_ONE - x2 / 90;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 56;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 30;
+    t = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 12;
+    *c = DSP_Q30_ONE - dsp_q30_mul(x2, t) / 2;
+}
+
+static q15_t
+dsp_q30_to_q15(int64_t v)
+{
+    return dsp_sat_q15((v + (1 << 14)) >> 15);
+}
+
+int
+dsp_cfft_q15_init(struct dsp_cfft_q15 *fft, uint16_t len, q15_t *twiddle)
+{
+    int64_t step_s;
+    int64_t step_c;
+    int64_t s;
+    int64_t c;
+    int64_t t;
+    int k;
+
+    if (len < 4 || len > 4096 || (len & (len - 1)) || !twiddle) {
+        return SYS_EINVAL;
+    }
+
+    /* w[k] = exp(-2 * pi * i * k / len), rotated step by step */
+    dsp_sincos_q30(DSP_Q30_2PI / len, &step_s, &step_c);
+    s = 0;
+    c = DSP_Q30_ONE;
+    for (k = 0; k < len / 2; k++) {
+        twiddle[2 * k] = dsp_q30_to_q15(c);
+        twiddle[2 * k + 1] = dsp_q30_to_q15(-s);
+        t = dsp_q30_mul(c, step_c) - dsp_q30_mul(s, step_s);
+        s = dsp_q30_mul(s, step_c) + dsp_q30_mul(c, step_s);
+        c = t;
+    }
+
+    fft->dc_twiddle = twiddle;
+    fft->dc_len = len;
+
+    return 0;
+}
+
+static void
+dsp_cfft_bitrev(q15_t *data, int len)
+{
+    q15_t tmp;
+    int i;
+    int j;
+    int m;
+
+    j = 0;
+    for (i = 0; i < len - 1; i++) {
+        if (i < j) {
+            tmp = data[2 * i];
+            data[2 * i] = data[2 * j];
+            data[2 * j] = tmp;
+            tmp = data[2 * i + 1];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j + 1] = tmp;
+        }
+        m = len >> 1;
+        while (j & m) {
+            j ^= m;
+            m >>= 1;
+        }
+        j |= m;
+    }
+}
+
+void
+dsp_cfft_q15_scalar(const struct dsp_cfft_q15 *fft, q15_t *data)
+{
+    const q15_t *tw = fft->dc_twiddle;
+    int len = fft->dc_len;
+    int32_t tr;
+    int32_t ti;
+    int32_t ar;
+    int32_t ai;
+    int32_t wr;
+    int32_t wi;
+    int half;
+    int step;
+    int m;
+    int k;
+    int i;
+    int j;
+
+    dsp_cfft_bitrev(data, len);
+
+    for (m = 2; m <= len; m <<= 1) {
+        half = m >> 1;
+        step = len / m;
+        for (k = 0; k < half; k++) {
+            wr = tw[2 * k * step];
+            wi = tw[2 * k * step + 1];
+            for (i = k; i < len; i += m) {
+                j = i + half;
+                tr = (data[2 * j] * wr - data[2 * j + 1] * wi) >> 16;
+                ti = (data[2 * j] * wi + data[2 * j + 1] * wr) >> 16;
+                ar = data[2 * i] >> 1;
+                ai = data[2 * i + 1] >> 1;
+                data[2 * i] = dsp_sat_q15(ar + tr);
+                data[2 * i + 1] = dsp_sat_q15(ai + ti);
+                data[2 * j] = dsp_sat_q15(ar - tr);
+                data[2 * j + 1] = dsp_sat_q15(ai - ti);
+            }
+        }
+    }
+}
+
+void
+dsp_cfft_q15(const struct dsp_cfft_q15 *fft, q15_t *data)
+{
+#if DSP_HAS_SIMD
+    const q15_t *tw = fft->dc_twiddle;
+    int len = fft->dc_len;
+    uint32_t a;
+    uint32_t b;
+    uint32_t w;
+    uint32_t t;
+    int half;
+    int step;
+    int m;
+    int k;
+    int i;
+    int j;
+
+    dsp_cfft_bitrev(data, len);
+
+    for (m = 2; m <= len; m <<= 1) {
+        half = m >> 1;
+        step = len / m;
+        for (k = 0; k < half; k++) {
+            w = dsp_ld_q15x2(&tw[2 * k * step]);
+            for (i = k; i < len; i += m) {
+                j = i + half;
+                b = dsp_ld_q15x2(&data[2 * j]);
+                /* t = b * w, real part in lower halfword */
+                t = ((uint32_t)(dsp_smusd(b, w) >> 16) & 0xffff) |
+                    ((uint32_t)(dsp_smuadx(b, w) >> 16) << 16);
+                a = dsp_shadd16(dsp_ld_q15x2(&data[2 * i]), 0);
+                dsp_st_q15x2(&data[2 * i], dsp_qadd16(a, t));
+                dsp_st_q15x2(&data[2 * j], dsp_qsub16(a, t));
+            }
+        }
+    }
+#else
+    dsp_cfft_q15_scalar(fft, data);
+#endif
+}
@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "defs/error.h"
+#include "dsp/dsp.h"
+#include "dsp_priv.h"
+
+typedef q15_t dsp_fir_dot_fn(const q15_t *b, const q15_t *s, int num_taps);
+
+/*
+ * Output for newest sample s[0]; s[-k] is multiplied by b[k].
+ */
+static q15_t
+dsp_fir_dot_scalar(const q15_t *b, const q15_t *s, int num_taps)
+{
+    int64_t acc = 0;
+    int k;
+
+    for (k = 0; k < num_taps; k++) {
+        acc += (int32_t)b[k] * s[-k];
+    }
+
+    return dsp_sat_q15(acc >> 15);
+}
+
+#if DSP_HAS_SIMD
+static q15_t
+dsp_fir_dot_simd(const q15_t *b, const q15_t *s, int num_taps)
+{
+    int64_t acc = 0;
+    int k;
+
+    /* b[k] * s[-k] + b[k + 1] * s[-k - 1] per instruction */
+    for (k = 0; k + 1 < num_taps; k += 2) {
+        acc = dsp_smlaldx(dsp_ld_q15x2(&b[k]), dsp_ld_q15x2(&s[-k - 1]),
+                          acc);
+    }
+    if (k < num_taps) {
+        acc += (int32_t)b[k] * s[-k];
+    }
+
+    return dsp_sat_q15(acc >> 15);
+}
+#endif
+
+/*
+ * Input is copied after history in state so the dot product always reads
+ * contiguous memory; every step-th output is produced.
+ */
+static void
+dsp_fir_run(struct dsp_fir_q15 *fir, const q15_t *in, q15_t *out,
+            size_t len, int step, dsp_fir_dot_fn *dot)
+{
+    int hist = fir->df_num_taps - 1;
+    size_t n;
+    size_t i;
+
+    while (len) {
+        n = len < fir->df_block_size ? len : fir->df_block_size;
+        memcpy(&fir->df_state[hist], in, n * sizeof(q15_t));
+        for (i = 0; i < n; i += step) {
+            *out++ = dot(fir->df_coeffs, &fir->df_state[hist + i],
+                         fir->df_num_taps);
+        }
+        memmove(fir->df_state, &fir->df_state[n], hist * sizeof(q15_t));
+        in += n;
+        len -= n;
+    }
+}
+
+int
+dsp_fir_q15_init(struct dsp_fir_q15 *fir, const q15_t *coeffs,
+                 uint16_t num_taps, q15_t *state, uint16_t block_size)
+{
+    if (!coeffs || !state || num_taps == 0 || block_size == 0) {
+        return SYS_EINVAL;
+    }
+
+    fir->df_coeffs = coeffs;
+    fir->df_state = state;
+    fir->df_num_taps = num_taps;
+    fir->df_block_size = block_size;
+    memset(state, 0,
+           DSP_FIR_STATE_LEN(num_taps, block_size) * sizeof(q15_t));
+
+    return 0;
+}
+
+void
+dsp_fir_q15_scalar(struct dsp_fir_q15 *fir, const q15_t *in, q15_t *out,
+                   size_t len)
+{
+    dsp_fir_run(fir, in, out, len, 1, dsp_fir_dot_scalar);
+}
+
+void
+dsp_fir_q15(struct dsp_fir_q15 *fir, const q15_t *in, q15_t *out,
+            size_t len)
+{
+#if DSP_HAS_SIMD
+    dsp_fir_run(fir, in, out, len, 1, dsp_fir_dot_simd);
+#else
+    dsp_fir_run(fir, in, out, len, 1, dsp_fir_dot_scalar);
+#endif
+}
+
+int
+dsp_fir_decim_q15_init(struct dsp_fir_decim_q15 *dec, const q15_t *coeffs,
+                       uint16_t num_taps, uint8_t factor, q15_t *state,
+                       uint16_t block_size)
+{
+    if (factor == 0 || block_size % factor) {
+        return SYS_EINVAL;
+    }
+    dec->dd_factor = factor;
+
+    return dsp_fir_q15_init(&dec->dd_fir, coeffs, num_taps, state,
+                            block_size);
+}
+
+size_t
+dsp_fir_decim_q15(struct dsp_fir_decim_q15 *dec, const q15_t *in,
+                  q15_t *out, size_t len)
+{
+    len -= len % dec->dd_factor;
+#if DSP_HAS_SIMD
+    dsp_fir_run(&dec->dd_fir, in, out, len, dec->dd_factor, dsp_fir_dot_simd);
+#else
+    dsp_fir_run(&dec->dd_fir, in, out, len, dec->dd_factor,
+                dsp_fir_dot_scalar);
+#endif
+
+    return len / dec->dd_factor;
+}
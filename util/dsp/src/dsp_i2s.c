@@ -0,0 +1,41 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(DSP_I2S)
+
+#include "i2s/i2s.h"
+#include "dsp/dsp.h"
+
+int
+dsp_fir_q15_i2s(struct dsp_fir_q15 *fir, struct i2s *i2s,
+                struct i2s_sample_buffer *buffer)
+{
+    if (i2s->sample_size_in_bytes != 2) {
+        return SYS_EINVAL;
+    }
+
+    dsp_fir_q15(fir, buffer->sample_data, buffer->sample_data,
+                buffer->sample_count);
+
+    return 0;
+}
+
+#endif
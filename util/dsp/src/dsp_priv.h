@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_DSP_PRIV_
+#define H_DSP_PRIV_
+
+#include <string.h>
+#include "dsp/dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline q15_t
+dsp_sat_q15(int64_t v)
+{
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return v;
+}
+
+#if DSP_HAS_SIMD
+/*
+ * Wrappers for packed 16-bit instructions, each 32-bit operand carries two
+ * Q15 values (lower halfword first in memory).
+ */
+
+/* Two samples, p does not need to be word aligned */
+static inline uint32_t
+dsp_ld_q15x2(const q15_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void
+dsp_st_q15x2(q15_t *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/* acc + a.lo * b.lo + a.hi * b.hi */
+static inline int64_t
+dsp_smlald(uint32_t a, uint32_t b, int64_t acc)
+{
+    union {
+        int64_t v;
+        uint32_t w[2];
+    } r = { .v = acc };
+
+    __asm__ ("smlald %0, %1, %2, %3"
+             : "+r" (r.w[0]), "+r" (r.w[1]) : "r" (a), "r" (b));
+    return r.v;
+}
+
+/* acc + a.lo * b.hi + a.hi * b.lo */
+static inline int64_t
+dsp_smlaldx(uint32_t a, uint32_t b, int64_t acc)
+{
+    union {
+        int64_t v;
+        uint32_t w[2];
+    } r = { .v = acc };
+
+    __asm__ ("smlaldx %0, %1, %2, %3"
+             : "+r" (r.w[0]), "+r" (r.w[1]) : "r" (a), "r" (b));
+    return r.v;
+}
+
+/* a.lo * b.lo - a.hi * b.hi */
+static inline int32_t
+dsp_smusd(uint32_t a, uint32_t b)
+{
+    int32_t r;
+
+    __asm__ ("smusd %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+/* a.lo * b.hi + a.hi * b.lo */
+static inline int32_t
+dsp_smuadx(uint32_t a, uint32_t b)
+{
+    int32_t r;
+
+    __asm__ ("smuadx %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+/* Saturating add of halfwords */
+static inline uint32_t
+dsp_qadd16(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+
+    __asm__ ("qadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+/* Saturating subtract of halfwords */
+static inline uint32_t
+dsp_qsub16(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+
+    __asm__ ("qsub16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+
+/* Halving add of halfwords */
+static inline uint32_t
+dsp_shadd16(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+
+    __asm__ ("shadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_DSP_PRIV_ */
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(DSP_SENSOR)
+
+#include "sensor/accel.h"
+#include "dsp/dsp.h"
+#include "dsp_priv.h"
+
+void
+dsp_accel_to_q15(const struct sensor_accel_data *sad, size_t len,
+                 int axis, float full_scale, q15_t *out)
+{
+    float scale;
+    float v;
+    size_t i;
+
+    scale = 32768.0f / full_scale;
+    for (i = 0; i < len; i++) {
+        switch (axis) {
+        case 0:
+            v = sad[i].sad_x;
+            break;
+        case 1:
+            v = sad[i].sad_y;
+            break;
+        default:
+            v = sad[i].sad_z;
+            break;
+        }
+        v *= scale;
+        if (v >= 32767.0f) {
+            out[i] = 32767;
+        } else if (v <= -32768.0f) {
+            out[i] = -32768;
+        } else {
+            out[i] = (q15_t)v;
+        }
+    }
+}
+
+#endif
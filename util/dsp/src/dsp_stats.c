@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dsp/dsp.h"
+#include "dsp_priv.h"
+
+/* Integer square root, rounded down */
+static uint32_t
+dsp_isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+int64_t
+dsp_power_q15_scalar(const q15_t *x, size_t len)
+{
+    int64_t acc = 0;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        acc += (int32_t)x[i] * x[i];
+    }
+
+    return acc;
+}
+
+int64_t
+dsp_power_q15(const q15_t *x, size_t len)
+{
+#if DSP_HAS_SIMD
+    int64_t acc = 0;
+    uint32_t v;
+    size_t i;
+
+    for (i = 0; i + 1 < len; i += 2) {
+        v = dsp_ld_q15x2(&x[i]);
+        acc = dsp_smlald(v, v, acc);
+    }
+    if (i < len) {
+        acc += (int32_t)x[i] * x[i];
+    }
+
+    return acc;
+#else
+    return dsp_power_q15_scalar(x, len);
+#endif
+}
+
+static q15_t
+dsp_rms_from_power(int64_t power, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+
+    return dsp_sat_q15(dsp_isqrt64((uint64_t)power / len));
+}
+
+q15_t
+dsp_rms_q15_scalar(const q15_t *x, size_t len)
+{
+    return dsp_rms_from_power(dsp_power_q15_scalar(x, len), len);
+}
+
+q15_t
+dsp_rms_q15(const q15_t *x, size_t len)
+{
+    return dsp_rms_from_power(dsp_power_q15(x, len), len);
+}
+
+void
+dsp_cmag_q15(const q15_t *data, q15_t *mag, size_t len)
+{
+    uint32_t re2;
+    uint32_t im2;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        re2 = (int32_t)data[2 * i] * data[2 * i];
+        im2 = (int32_t)data[2 * i + 1] * data[2 * i + 1];
+        mag[i] = dsp_sat_q15(dsp_isqrt64((uint64_t)re2 + im2));
+    }
+}
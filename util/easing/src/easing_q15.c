@@ -0,0 +1,669 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Fixed-point versions of the easing curves, for parts without an FPU.
+ * The position within the animation is a Q15 ratio (32768 is 1.0), the
+ * curves compute a Q15 shape from it, which is then scaled by max_val.
+ * Polynomial curves are computed exactly, sine based ones interpolate a
+ * lookup table, and the exponential ones use table driven log2 and exp2.
+ * Results are within about 0.05% of max_val of the float versions, plus
+ * rounding; the circular curves are coarser where they turn vertical.
+ */
+
+#include "easing/easing.h"
+
+#define Q15_ONE     (1 << 15)
+#define Q15_HALF    (1 << 14)
+
+/* cos(pi / 2 * x), x in [0, 1], in 64 steps */
+static const uint16_t easing_q15_cos[65] = {
+    32768, 32758, 32729, 32679, 32610, 32522, 32413, 32286,
+    32138, 31972, 31786, 31581, 31357, 31114, 30853, 30572,
+    30274, 29957, 29622, 29269, 28899, 28511, 28106, 27684,
+    27246, 26791, 26320, 25833, 25330, 24812, 24279, 23732,
+    23170, 22595, 22006, 21403, 20788, 20160, 19520, 18868,
+    18205, 17531, 16846, 16151, 15447, 14733, 14010, 13279,
+    12540, 11793, 11039, 10279,  9512,  8740,  7962,  7180,
+     6393,  5602,  4808,  4011,  3212,  2411,  1608,   804,
+        0,
+};
+
+/* (exp(-cos(pi * x)) - 1 / e) / (e - 1 / e), x in [0, 1], in 64 steps */
+static const uint16_t easing_q15_exp_sin[65] = {
+        0,     6,    25,    56,   100,   156,   226,   309,
+      406,   517,   643,   784,   941,  1115,  1307,  1517,
+     1745,  1994,  2264,  2555,  2870,  3209,  3573,  3962,
+     4380,  4825,  5300,  5805,  6342,  6910,  7511,  8145,
+     8813,  9514, 10248, 11016, 11816, 12647, 13508, 14397,
+    15312, 16250, 17209, 18183, 19170, 20165, 21163, 22159,
+    23146, 24119, 25072, 25998, 26890, 27742, 28547, 29299,
+    29990, 30616, 31171, 31649, 32047, 32360, 32586, 32722,
+    32768,
+};
+
+/* log2(1 + x), x in [0, 1], in 32 steps */
+static const uint16_t easing_q15_log2[33] = {
+        0,  1455,  2866,  4236,  5568,  6863,  8124,  9352,
+    10549, 11716, 12855, 13968, 15055, 16117, 17156, 18173,
+    19168, 20143, 21098, 22034, 22952, 23852, 24736, 25604,
+    26455, 27292, 28114, 28922, 29717, 30498, 31267, 32024,
+    32768,
+};
+
+/* 2^x - 1, x in [0, 1], in 32 steps */
+static const uint16_t easing_q15_exp2[33] = {
+        0,   718,  1451,  2200,  2966,  3748,  4548,  5365,
+     6200,  7053,  7925,  8816,  9727, 10657, 11608, 12580,
+    13573, 14588, 15625, 16684, 17767, 18874, 20005, 21160,
+    22341, 23548, 24781, 26041, 27329, 28645, 29989, 31364,
+    32768,
+};
+
+/* Interpolates a table of 2^bits + 1 entries covering x in [0, Q15_ONE]. */
+static int32_t
+easing_q15_lut(const uint16_t *lut, int bits, int32_t x)
+{
+    int32_t shift;
+    int32_t rem;
+    int32_t i;
+
+    shift = 15 - bits;
+    i = x >> shift;
+    if (i >= (1 << bits)) {
+        return lut[1 << bits];
+    }
+    rem = x & ((1 << shift) - 1);
+
+    return lut[i] + ((((int32_t)lut[i + 1] - lut[i]) * rem) >> shift);
+}
+
+static inline int32_t
+q15_mul(int32_t a, int32_t b)
+{
+    return (a * b + Q15_HALF) >> 15;
+}
+
+/* Square root of a Q30 value, as Q15. */
+static int32_t
+q15_sqrt(uint32_t x)
+{
+    uint32_t res;
+    uint32_t bit;
+
+    res = 0;
+    bit = 1UL << 30;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+/* log2(x), as Q16; x > 0 */
+static int32_t
+q16_log2(uint32_t x)
+{
+    int32_t n;
+
+    n = 31 - __builtin_clz(x);
+    /* Fraction of the normalized mantissa, as Q15 */
+    x = (x << (31 - n)) >> 16;
+
+    return (n << 16) + (easing_q15_lut(easing_q15_log2, 5,
+                                       x & (Q15_ONE - 1)) << 1);
+}
+
+/* 2^x for x as Q16, rounded to an integer. */
+static int32_t
+q16_exp2(int32_t x)
+{
+    int32_t shift;
+    uint32_t v;
+
+    /* 2^frac as Q15 */
+    v = Q15_ONE + easing_q15_lut(easing_q15_exp2, 5, (x & 0xffff) >> 1);
+
+    shift = (x >> 16) - 15;
+    if (shift >= 0) {
+        return (int32_t)((uint64_t)v << shift);
+    }
+    if (shift < -31) {
+        return 0;
+    }
+    return (v + (1UL << (-shift - 1))) >> -shift;
+}
+
+static int32_t
+easing_q15_ratio(int32_t step, int32_t max_steps)
+{
+    if (step <= 0 || max_steps <= 0) {
+        return 0;
+    }
+    if (step >= max_steps) {
+        return Q15_ONE;
+    }
+    if (step < 0x10000) {
+        return ((uint32_t)step << 15) / (uint32_t)max_steps;
+    }
+    return ((uint64_t)step << 15) / (uint32_t)max_steps;
+}
+
+static int32_t
+easing_q15_scale(int32_t shape, int32_t max_val)
+{
+    if (max_val >= -0x7fff && max_val <= 0x7fff &&
+        shape >= -0xffff && shape <= 0xffff) {
+        return (shape * max_val + Q15_HALF) >> 15;
+    }
+    return ((int64_t)shape * max_val + Q15_HALF) >> 15;
+}
+
+/* Quadratic */
+static int32_t
+quadratic_in(int32_t r)
+{
+    return q15_mul(r, r);
+}
+
+static int32_t
+quadratic_out(int32_t r)
+{
+    return q15_mul(r, 2 * Q15_ONE - r);
+}
+
+static int32_t
+quadratic_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        return q15_mul(r, r) / 2;
+    }
+
+    r -= Q15_ONE;
+    return Q15_HALF + q15_mul(r, 2 * Q15_ONE - r) / 2;
+}
+
+/* Cubic */
+static int32_t
+cubic_in(int32_t r)
+{
+    return q15_mul(q15_mul(r, r), r);
+}
+
+static int32_t
+cubic_out(int32_t r)
+{
+    r -= Q15_ONE;
+    return q15_mul(q15_mul(r, r), r) + Q15_ONE;
+}
+
+static int32_t
+cubic_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        return q15_mul(q15_mul(r, r), r) / 2;
+    }
+
+    r -= 2 * Q15_ONE;
+    return (q15_mul(q15_mul(r, r), r) + 2 * Q15_ONE) / 2;
+}
+
+/* Quartic */
+static int32_t
+quartic_in(int32_t r)
+{
+    r = q15_mul(r, r);
+    return q15_mul(r, r);
+}
+
+static int32_t
+quartic_out(int32_t r)
+{
+    r -= Q15_ONE;
+    r = q15_mul(r, r);
+    return Q15_ONE - q15_mul(r, r);
+}
+
+static int32_t
+quartic_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        r = q15_mul(r, r);
+        return q15_mul(r, r) / 2;
+    }
+
+    r -= 2 * Q15_ONE;
+    r = q15_mul(r, r);
+    return Q15_ONE - q15_mul(r, r) / 2;
+}
+
+/* Quintic */
+static int32_t
+quintic_in(int32_t r)
+{
+    return q15_mul(quartic_in(r), r);
+}
+
+static int32_t
+quintic_out(int32_t r)
+{
+    r -= Q15_ONE;
+    return Q15_ONE + q15_mul(quartic_in(r), r);
+}
+
+static int32_t
+quintic_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        return q15_mul(quartic_in(r), r) / 2;
+    }
+
+    r -= 2 * Q15_ONE;
+    return Q15_ONE + q15_mul(quartic_in(r), r) / 2;
+}
+
+/* Circular */
+static int32_t
+circular_in(int32_t r)
+{
+    return Q15_ONE - q15_sqrt((uint32_t)Q15_ONE * Q15_ONE - r * r);
+}
+
+static int32_t
+circular_out(int32_t r)
+{
+    r -= Q15_ONE;
+    return q15_sqrt((uint32_t)Q15_ONE * Q15_ONE - r * r);
+}
+
+static int32_t
+circular_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        return circular_in(r) / 2;
+    }
+
+    return (Q15_ONE + circular_out(r - Q15_ONE)) / 2;
+}
+
+/* Sine */
+static int32_t
+sine_in(int32_t r)
+{
+    return Q15_ONE - easing_q15_lut(easing_q15_cos, 6, r);
+}
+
+static int32_t
+sine_out(int32_t r)
+{
+    return easing_q15_lut(easing_q15_cos, 6, Q15_ONE - r);
+}
+
+static int32_t
+sine_io(int32_t r)
+{
+    /* (1 - cos(pi r)) / 2 */
+    if (r <= Q15_HALF) {
+        return (Q15_ONE - easing_q15_lut(easing_q15_cos, 6, 2 * r)) / 2;
+    }
+    return (Q15_ONE + easing_q15_lut(easing_q15_cos, 6,
+                                     2 * (Q15_ONE - r))) / 2;
+}
+
+/* Bounce */
+static int32_t
+bounce_out(int32_t r)
+{
+    /* 7.5625 and 1 / 2.75 as Q15, arcs centered at 1.5, 2.25, 2.625 / 2.75 */
+    if (r < 11916) {
+        return q15_mul(247808, q15_mul(r, r));
+    }
+    if (r < 23831) {
+        r -= 17873;
+        return q15_mul(247808, q15_mul(r, r)) + 24576;
+    }
+    if (r < 29789) {
+        r -= 26810;
+        return q15_mul(247808, q15_mul(r, r)) + 30720;
+    }
+
+    r -= 31279;
+    return q15_mul(247808, q15_mul(r, r)) + 32256;
+}
+
+static int32_t
+bounce_in(int32_t r)
+{
+    return Q15_ONE - bounce_out(Q15_ONE - r);
+}
+
+static int32_t
+bounce_io(int32_t r)
+{
+    if (r < Q15_HALF) {
+        return bounce_in(2 * r) / 2;
+    }
+    return bounce_out(2 * r - Q15_ONE) / 2 + Q15_HALF;
+}
+
+/* Back */
+#define BACK_S      55758   /* 1.70158 */
+#define BACK_IO_S   85030   /* 1.70158 * 1.525 */
+
+/* r^2 * ((s + 1) * r - s) */
+static int32_t
+back_curve(int32_t r, int32_t s)
+{
+    int64_t v;
+
+    v = (int64_t)(s + Q15_ONE) * r - (int64_t)s * Q15_ONE;
+    return ((int64_t)q15_mul(r, r) * (v >> 15) + Q15_HALF) >> 15;
+}
+
+static int32_t
+back_in(int32_t r)
+{
+    return back_curve(r, BACK_S);
+}
+
+static int32_t
+back_out(int32_t r)
+{
+    return Q15_ONE - back_curve(Q15_ONE - r, BACK_S);
+}
+
+static int32_t
+back_io(int32_t r)
+{
+    r *= 2;
+    if (r < Q15_ONE) {
+        return back_curve(r, BACK_IO_S) / 2;
+    }
+    return Q15_ONE - back_curve(2 * Q15_ONE - r, BACK_IO_S) / 2;
+}
+
+/* Custom, used for breathing */
+int32_t
+exponential_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t r;
+
+    if (max_val <= 0) {
+        return 0;
+    }
+    r = easing_q15_ratio(step, max_steps);
+
+    /* 2^(r * log2(max_val)) - 1 */
+    return q16_exp2(((int64_t)q16_log2(max_val) * r) >> 15) - 1;
+}
+
+int32_t
+exp_sin_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_lut(easing_q15_exp_sin, 6,
+                       easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+sine_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t r;
+
+    /* 1 - cos(2 pi r): the sine io curve there and back, at twice the size */
+    r = easing_q15_ratio(step, max_steps);
+    r = (r <= Q15_HALF) ? 2 * r : 2 * (Q15_ONE - r);
+
+    return easing_q15_scale(sine_io(r), 2 * max_val);
+}
+
+/* Linear */
+int32_t
+linear_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(easing_q15_ratio(step, max_steps), max_val);
+}
+
+/* Exponential */
+int32_t
+exponential_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t r;
+
+    r = easing_q15_ratio(step, max_steps);
+    if (r == 0 || max_val <= 0) {
+        return 0;
+    }
+
+    /* max_val^r */
+    return q16_exp2(((int64_t)q16_log2(max_val) * r) >> 15);
+}
+
+int32_t
+exponential_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t r;
+
+    r = easing_q15_ratio(step, max_steps);
+    if (r == Q15_ONE || max_val <= 0) {
+        return max_val;
+    }
+
+    /* max_val - max_val^(1 - r) */
+    return max_val - q16_exp2(((int64_t)q16_log2(max_val) *
+                               (Q15_ONE - r)) >> 15);
+}
+
+int32_t
+exponential_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t half_log2;
+    int32_t r;
+
+    r = easing_q15_ratio(step, max_steps);
+    if (r == 0 || max_val <= 0) {
+        return 0;
+    }
+    if (r == Q15_ONE) {
+        return max_val;
+    }
+
+    /* (max_val / 2)^(2r), mirrored for the second half */
+    half_log2 = q16_log2(max_val) - (1 << 16);
+    r *= 2;
+    if (r < Q15_ONE) {
+        return q16_exp2(((int64_t)half_log2 * r) >> 15);
+    }
+    return max_val - q16_exp2(((int64_t)half_log2 * (2 * Q15_ONE - r)) >> 15);
+}
+
+/* Quadratic */
+int32_t
+quadratic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quadratic_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quadratic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quadratic_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quadratic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quadratic_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Cubic */
+int32_t
+cubic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(cubic_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+cubic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(cubic_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+cubic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(cubic_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Quartic */
+int32_t
+quartic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quartic_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quartic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quartic_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quartic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quartic_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Quintic */
+int32_t
+quintic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quintic_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quintic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quintic_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+quintic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quintic_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Circular */
+int32_t
+circular_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(circular_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+circular_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(circular_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+circular_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(circular_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Sine */
+int32_t
+sine_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(sine_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+sine_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(sine_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+sine_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(sine_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Bounce */
+int32_t
+bounce_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(bounce_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+bounce_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(bounce_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+bounce_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(bounce_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+/* Back */
+int32_t
+back_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(back_in(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+back_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(back_out(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+int32_t
+back_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(back_io(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_LZ4_
+#define H_LZ4_
+
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Size of the work area lz4_compress() needs, in bytes.
+ */
+#define LZ4_WORK_SIZE   (sizeof(uint16_t) << MYNEWT_VAL(LZ4_HASH_BITS))
+
+/**
+ * Compresses a buffer into an LZ4 block.
+ *
+ * The output is a raw LZ4 block without the frame header, as produced by
+ * LZ4_compress_default() of the reference library, and can be decoded by
+ * LZ4_decompress_safe() on the host.
+ *
+ * @param src                   The data to compress.
+ * @param src_len               The length of src; at most 65535 bytes.
+ * @param dst                   Where to write the compressed block.
+ * @param dst_len               The size of dst.
+ * @param work                  LZ4_WORK_SIZE bytes of scratch memory,
+ *                                  uint16_t aligned.
+ *
+ * @return                      The length of the compressed block;
+ *                              -1 if it does not fit in dst_len bytes.
+ */
+int lz4_compress(const void *src, int src_len, void *dst, int dst_len,
+                 void *work);
+
+/**
+ * Decompresses an LZ4 block.  Malformed input is detected; it never makes
+ * the decompressor read or write out of bounds.
+ *
+ * @param src                   The compressed block.
+ * @param src_len               The length of src.
+ * @param dst                   Where to write the decompressed data.
+ * @param dst_len               The size of dst.
+ *
+ * @return                      The length of the decompressed data;
+ *                              -1 if the block is malformed or does not
+ *                                  fit in dst_len bytes.
+ */
+int lz4_decompress(const void *src, int src_len, void *dst, int dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
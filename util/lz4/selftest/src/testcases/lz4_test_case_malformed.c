@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "lz4/lz4.h"
+#include "lz4_test.h"
+
+TEST_CASE_SELF(lz4_test_case_malformed)
+{
+    /* Match offset reaching before the start of the output. */
+    static const uint8_t bad_off[] = { 0x10, 'a', 0x02, 0x00 };
+    /* Literal run longer than the input. */
+    static const uint8_t bad_lit[] = { 0x50, 'a', 'b' };
+    /* Zero match offset. */
+    static const uint8_t zero_off[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    /* Missing length extension byte. */
+    static const uint8_t bad_ext[] = { 0xf0 };
+    /* "a" followed by a 5 byte match at offset 1, then "b": "aaaaaab". */
+    static const uint8_t good[] = { 0x11, 'a', 0x01, 0x00, 0x10, 'b' };
+    uint8_t out[16];
+    int rc;
+
+    rc = lz4_decompress(bad_off, sizeof(bad_off), out, sizeof(out));
+    TEST_ASSERT(rc == -1);
+    rc = lz4_decompress(bad_lit, sizeof(bad_lit), out, sizeof(out));
+    TEST_ASSERT(rc == -1);
+    rc = lz4_decompress(zero_off, sizeof(zero_off), out, sizeof(out));
+    TEST_ASSERT(rc == -1);
+    rc = lz4_decompress(bad_ext, sizeof(bad_ext), out, sizeof(out));
+    TEST_ASSERT(rc == -1);
+
+    rc = lz4_decompress(good, sizeof(good), out, sizeof(out));
+    TEST_ASSERT(rc == 7);
+    TEST_ASSERT(memcmp(out, "aaaaaab", 7) == 0);
+}
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "lz4/lz4.h"
+#include "lz4_test.h"
+
+#define LZ4_TEST_MAX_LEN    1024
+
+static uint16_t lz4_test_work[LZ4_WORK_SIZE / sizeof(uint16_t)];
+static uint8_t lz4_test_src[LZ4_TEST_MAX_LEN];
+static uint8_t lz4_test_dst[LZ4_TEST_MAX_LEN + LZ4_TEST_MAX_LEN / 8];
+static uint8_t lz4_test_out[LZ4_TEST_MAX_LEN];
+
+static int
+lz4_test_roundtrip(int len)
+{
+    int clen;
+    int rc;
+
+    clen = lz4_compress(lz4_test_src, len, lz4_test_dst,
+                        sizeof(lz4_test_dst), lz4_test_work);
+    TEST_ASSERT_FATAL(clen > 0);
+
+    memset(lz4_test_out, 0, sizeof(lz4_test_out));
+    rc = lz4_decompress(lz4_test_dst, clen, lz4_test_out, len);
+    TEST_ASSERT(rc == len);
+    TEST_ASSERT(memcmp(lz4_test_src, lz4_test_out, len) == 0);
+
+    /* Output that doesn't fit is reported, both ways. */
+    if (len > 0) {
+        rc = lz4_decompress(lz4_test_dst, clen, lz4_test_out, len - 1);
+        TEST_ASSERT(rc == -1);
+        rc = lz4_compress(lz4_test_src, len, lz4_test_dst, clen - 1,
+                          lz4_test_work);
+        TEST_ASSERT(rc == -1);
+    }
+
+    return clen;
+}
+
+TEST_CASE_SELF(lz4_test_case_roundtrip)
+{
+    static const char *words[] = { "temp=", "21.5 ", "rssi=", "-70 ", "ok\n" };
+    uint32_t x;
+    int clen;
+    int off;
+    int len;
+    int i;
+
+    /* Short inputs are stored as literals. */
+    strcpy((char *)lz4_test_src, "hello");
+    clen = lz4_test_roundtrip(0);
+    TEST_ASSERT(clen == 1);
+    clen = lz4_test_roundtrip(5);
+    TEST_ASSERT(clen == 6);
+
+    /* Repetitive text compresses. */
+    off = 0;
+    for (i = 0; off < LZ4_TEST_MAX_LEN; i++) {
+        len = strlen(words[i % 5]);
+        if (len > LZ4_TEST_MAX_LEN - off) {
+            len = LZ4_TEST_MAX_LEN - off;
+        }
+        memcpy(lz4_test_src + off, words[i % 5], len);
+        off += len;
+    }
+    for (len = 13; len <= LZ4_TEST_MAX_LEN; len += 61) {
+        clen = lz4_test_roundtrip(len);
+    }
+    TEST_ASSERT(clen < LZ4_TEST_MAX_LEN / 4);
+
+    /* Long runs need length extension bytes. */
+    memset(lz4_test_src, 'a', LZ4_TEST_MAX_LEN);
+    clen = lz4_test_roundtrip(LZ4_TEST_MAX_LEN);
+    TEST_ASSERT(clen < 16);
+
+    /* Random data grows only slightly. */
+    x = 1;
+    for (i = 0; i < LZ4_TEST_MAX_LEN; i++) {
+        x = x * 1103515245 + 12345;
+        lz4_test_src[i] = x >> 16;
+    }
+    clen = lz4_test_roundtrip(LZ4_TEST_MAX_LEN);
+    TEST_ASSERT(clen <= LZ4_TEST_MAX_LEN + LZ4_TEST_MAX_LEN / 255 + 16);
+}
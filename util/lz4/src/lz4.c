@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "lz4/lz4.h"
+
+#define LZ4_MIN_MATCH       4
+/* The last match must start at least this many bytes before the end. */
+#define LZ4_MF_LIMIT        12
+/* The last this many bytes are always literals. */
+#define LZ4_LAST_LITERALS   5
+#define LZ4_MAX_OFFSET      65535
+#define LZ4_RUN_MASK        15
+
+static uint32_t
+lz4_read32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t
+lz4_hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - MYNEWT_VAL(LZ4_HASH_BITS));
+}
+
+/*
+ * Writes the extra bytes of a literal or match length which did not fit in
+ * the token.
+ */
+static uint8_t *
+lz4_put_len(uint8_t *op, int len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = len;
+    return op;
+}
+
+/*
+ * Writes a sequence; literals from anchor up to ip, followed by a match of
+ * mlen bytes at offset off, or no match if mlen is 0.  Returns NULL if it
+ * doesn't fit.
+ */
+static uint8_t *
+lz4_put_seq(uint8_t *op, uint8_t *oend, const uint8_t *anchor,
+            const uint8_t *ip, uint16_t off, int mlen)
+{
+    uint8_t *token;
+    int lit;
+
+    lit = ip - anchor;
+    if (oend - op < 1 + lit + lit / 255 + 1 + 2 + mlen / 255 + 1) {
+        return NULL;
+    }
+
+    token = op++;
+    if (lit >= LZ4_RUN_MASK) {
+        *token = LZ4_RUN_MASK << 4;
+        op = lz4_put_len(op, lit - LZ4_RUN_MASK);
+    } else {
+        *token = lit << 4;
+    }
+    memcpy(op, anchor, lit);
+    op += lit;
+
+    if (mlen == 0) {
+        return op;
+    }
+
+    *op++ = off;
+    *op++ = off >> 8;
+    mlen -= LZ4_MIN_MATCH;
+    if (mlen >= LZ4_RUN_MASK) {
+        *token |= LZ4_RUN_MASK;
+        op = lz4_put_len(op, mlen - LZ4_RUN_MASK);
+    } else {
+        *token |= mlen;
+    }
+    return op;
+}
+
+int
+lz4_compress(const void *src, int src_len, void *dst, int dst_len,
+             void *work)
+{
+    const uint8_t *in = src;
+    const uint8_t *iend = in + src_len;
+    const uint8_t *ip = in;
+    const uint8_t *anchor = in;
+    const uint8_t *ref;
+    uint16_t *htab = work;
+    uint8_t *op = dst;
+    uint8_t *oend = op + dst_len;
+    uint32_t seq;
+    uint32_t h;
+    int mlen;
+
+    if (src_len < 0 || src_len > LZ4_MAX_OFFSET) {
+        return -1;
+    }
+
+    if (src_len > LZ4_MF_LIMIT) {
+        memset(htab, 0, LZ4_WORK_SIZE);
+
+        while (ip < iend - LZ4_MF_LIMIT) {
+            seq = lz4_read32(ip);
+            h = lz4_hash(seq);
+            ref = in + htab[h];
+            htab[h] = ip - in;
+            if (ref >= ip || lz4_read32(ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            /* Extend the match backwards over pending literals. */
+            while (ip > anchor && ref > in && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            mlen = LZ4_MIN_MATCH;
+            while (ip + mlen < iend - LZ4_LAST_LITERALS &&
+                   ip[mlen] == ref[mlen]) {
+                mlen++;
+            }
+
+            op = lz4_put_seq(op, oend, anchor, ip, ip - ref, mlen);
+            if (op == NULL) {
+                return -1;
+            }
+            ip += mlen;
+            anchor = ip;
+        }
+    }
+
+    op = lz4_put_seq(op, oend, anchor, iend, 0, 0);
+    if (op == NULL) {
+        return -1;
+    }
+    return op - (uint8_t *)dst;
+}
+
+/*
+ * Reads the extra bytes of a literal or match length.  Returns -1 if the
+ * input ends first.
+ */
+static int
+lz4_get_len(const uint8_t **ipp, const uint8_t *iend, int len)
+{
+    const uint8_t *ip = *ipp;
+    uint8_t b;
+
+    do {
+        if (ip >= iend) {
+            return -1;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+
+    *ipp = ip;
+    return len;
+}
+
+int
+lz4_decompress(const void *src, int src_len, void *dst, int dst_len)
+{
+    const uint8_t *ip = src;
+    const uint8_t *iend = ip + src_len;
+    const uint8_t *ref;
+    uint8_t *op = dst;
+    uint8_t *oend = op + dst_len;
+    uint8_t token;
+    uint16_t off;
+    int len;
+
+    while (ip < iend) {
+        token = *ip++;
+
+        len = token >> 4;
+        if (len == LZ4_RUN_MASK) {
+            len = lz4_get_len(&ip, iend, len);
+            if (len < 0) {
+                return -1;
+            }
+        }
+        if (len > iend - ip || len > oend - op) {
+            return -1;
+        }
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+
+        if (ip == iend) {
+            /* The last sequence has no match. */
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        off = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (off == 0 || off > op - (uint8_t *)dst) {
+            return -1;
+        }
+
+        len = token & LZ4_RUN_MASK;
+        if (len == LZ4_RUN_MASK) {
+            len = lz4_get_len(&ip, iend, len);
+            if (len < 0) {
+                return -1;
+            }
+        }
+        len += LZ4_MIN_MATCH;
+        if (len > oend - op) {
+            return -1;
+        }
+
+        /* Byte by byte, the match may overlap the bytes being written. */
+        ref = op - off;
+        while (len--) {
+            *op++ = *ref++;
+        }
+    }
+
+    return op - (uint8_t *)dst;
+}
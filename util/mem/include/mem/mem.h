@@ -63,6 +63,55 @@ struct os_mbuf *mem_split_frag(struct os_mbuf **om, uint16_t max_frag_sz,
 
 void *mem_pullup_obj(struct os_mbuf **om, uint16_t len);
 
+/**
+ * A bump-pointer allocator for objects sharing one lifetime, e.g. the
+ * objects decoded from a single request.  Allocations carry no header and
+ * cannot be freed individually; instead, the arena is rewound to drop the
+ * most recent allocations, or reset to drop all of them at once.
+ */
+struct mem_arena {
+    /** Start of the backing buffer. */
+    uint8_t *ma_buf;
+    /** Size of the backing buffer, in bytes. */
+    uint32_t ma_size;
+    /** Offset of the next allocation. */
+    uint32_t ma_off;
+    /** Highest offset reached since init; useful for sizing the buffer. */
+    uint32_t ma_hiwat;
+};
+
+void mem_arena_init(struct mem_arena *ma, void *buf, uint32_t size);
+int mem_arena_init_mbuf(struct mem_arena *ma, struct os_mbuf *om);
+void *mem_arena_alloc(struct mem_arena *ma, uint32_t size);
+void mem_arena_release(struct mem_arena *ma, void *ptr);
+
+/**
+ * Returns a mark which can later be passed to mem_arena_rewind().
+ */
+static inline uint32_t
+mem_arena_mark(const struct mem_arena *ma)
+{
+    return ma->ma_off;
+}
+
+/**
+ * Frees every allocation made since the specified mark was taken.
+ */
+static inline void
+mem_arena_rewind(struct mem_arena *ma, uint32_t mark)
+{
+    ma->ma_off = mark;
+}
+
+/**
+ * Frees every allocation in the arena.
+ */
+static inline void
+mem_arena_reset(struct mem_arena *ma)
+{
+    ma->ma_off = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "mem_test.h"
+#include "mem/mem.h"
+
+#define MTAB_BUF_SIZE   (8 * OS_ALIGNMENT)
+
+static uint8_t mtab_buf[MTAB_BUF_SIZE + OS_ALIGNMENT]
+    __attribute__((aligned(OS_ALIGNMENT)));
+
+TEST_CASE_SELF(mem_test_case_arena_basic)
+{
+    struct mem_arena ma;
+    uint32_t mark;
+    uint8_t *p1;
+    uint8_t *p2;
+    uint8_t *p3;
+
+    mem_arena_init(&ma, mtab_buf, MTAB_BUF_SIZE);
+    TEST_ASSERT(ma.ma_size == MTAB_BUF_SIZE);
+    TEST_ASSERT(ma.ma_off == 0);
+    TEST_ASSERT(ma.ma_hiwat == 0);
+
+    /*** Allocations are consecutive and rounded up to OS_ALIGNMENT. */
+    p1 = mem_arena_alloc(&ma, 1);
+    TEST_ASSERT_FATAL(p1 == mtab_buf);
+    p2 = mem_arena_alloc(&ma, OS_ALIGNMENT + 1);
+    TEST_ASSERT_FATAL(p2 == p1 + OS_ALIGNMENT);
+    TEST_ASSERT(ma.ma_off == 3 * OS_ALIGNMENT);
+
+    /*** A zero sized allocation takes no space. */
+    p3 = mem_arena_alloc(&ma, 0);
+    TEST_ASSERT(p3 == p1 + 3 * OS_ALIGNMENT);
+    TEST_ASSERT(ma.ma_off == 3 * OS_ALIGNMENT);
+
+    /*** Rewinding to a mark drops the allocations made since. */
+    mark = mem_arena_mark(&ma);
+    p3 = mem_arena_alloc(&ma, 2 * OS_ALIGNMENT);
+    TEST_ASSERT_FATAL(p3 != NULL);
+    mem_arena_rewind(&ma, mark);
+    TEST_ASSERT(ma.ma_off == 3 * OS_ALIGNMENT);
+    TEST_ASSERT(ma.ma_hiwat == 5 * OS_ALIGNMENT);
+    TEST_ASSERT(mem_arena_alloc(&ma, 1) == p3);
+
+    /*** Releasing an allocation drops it and everything after it. */
+    mem_arena_release(&ma, p2);
+    TEST_ASSERT(ma.ma_off == OS_ALIGNMENT);
+    TEST_ASSERT(mem_arena_alloc(&ma, 1) == p2);
+
+    /*** Exhaustion; a failed allocation leaves the arena unchanged. */
+    p3 = mem_arena_alloc(&ma, MTAB_BUF_SIZE - 2 * OS_ALIGNMENT);
+    TEST_ASSERT_FATAL(p3 != NULL);
+    TEST_ASSERT(ma.ma_off == MTAB_BUF_SIZE);
+    TEST_ASSERT(mem_arena_alloc(&ma, 1) == NULL);
+    TEST_ASSERT(ma.ma_off == MTAB_BUF_SIZE);
+
+    /*** Sizes that overflow when rounded up are rejected. */
+    mem_arena_reset(&ma);
+    TEST_ASSERT(ma.ma_off == 0);
+    TEST_ASSERT(mem_arena_alloc(&ma, UINT32_MAX) == NULL);
+    TEST_ASSERT(mem_arena_alloc(&ma, MTAB_BUF_SIZE + 1) == NULL);
+    TEST_ASSERT(ma.ma_off == 0);
+    TEST_ASSERT(ma.ma_hiwat == MTAB_BUF_SIZE);
+
+    /*** A misaligned buffer is trimmed to the first aligned address. */
+    mem_arena_init(&ma, mtab_buf + 1, MTAB_BUF_SIZE);
+    TEST_ASSERT(ma.ma_size == MTAB_BUF_SIZE - (OS_ALIGNMENT - 1));
+    p1 = mem_arena_alloc(&ma, 1);
+    TEST_ASSERT(p1 == mtab_buf + OS_ALIGNMENT);
+
+    /*** A buffer too small to align yields an empty arena. */
+    mem_arena_init(&ma, mtab_buf + 1, OS_ALIGNMENT - 2);
+    TEST_ASSERT(ma.ma_size == 0);
+    TEST_ASSERT(mem_arena_alloc(&ma, 1) == NULL);
+}
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "mem_test.h"
+#include "mem/mem.h"
+
+#define MTAM_BUF_SIZE   (128)
+#define MTAM_BUF_COUNT  (2)
+
+static os_membuf_t mtam_membuf[OS_MEMPOOL_SIZE(MTAM_BUF_SIZE,
+                                               MTAM_BUF_COUNT)];
+static struct os_mempool mtam_mempool;
+static struct os_mbuf_pool mtam_mbuf_pool;
+
+TEST_CASE_SELF(mem_test_case_arena_mbuf)
+{
+    struct mem_arena ma;
+    struct os_mbuf *om;
+    uint16_t space;
+    uint8_t *p;
+    int rc;
+
+    rc = os_mempool_init(&mtam_mempool, MTAM_BUF_COUNT, MTAM_BUF_SIZE,
+                         mtam_membuf, "mem_arena");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&mtam_mbuf_pool, &mtam_mempool, MTAM_BUF_SIZE,
+                           MTAM_BUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = os_mbuf_get(&mtam_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    /*** The arena covers the space after the data. */
+    rc = os_mbuf_append(om, "abc", 3);
+    TEST_ASSERT_FATAL(rc == 0);
+    space = OS_MBUF_TRAILINGSPACE(om);
+
+    rc = mem_arena_init_mbuf(&ma, om);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ma.ma_buf >= om->om_data + om->om_len);
+    TEST_ASSERT(ma.ma_buf + ma.ma_size == om->om_data + om->om_len + space);
+
+    p = mem_arena_alloc(&ma, ma.ma_size);
+    TEST_ASSERT_FATAL(p != NULL);
+    memset(p, 0xff, ma.ma_size);
+    TEST_ASSERT(memcmp(om->om_data, "abc", 3) == 0);
+    TEST_ASSERT(om->om_len == 3);
+
+    /*** An mbuf without trailing space can't back an arena. */
+    rc = os_mbuf_append(om, p, space);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_TRAILINGSPACE(om) == 0);
+    rc = mem_arena_init_mbuf(&ma, om);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    os_mbuf_free_chain(om);
+}
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "mem/mem.h"
+
+/**
+ * Initializes an arena over a caller supplied buffer.
+ *
+ * @param ma                    The arena to initialize.
+ * @param buf                   The memory to allocate from.  It must stay
+ *                                  valid for as long as the arena is used.
+ * @param size                  The size of the buffer, in bytes.
+ */
+void
+mem_arena_init(struct mem_arena *ma, void *buf, uint32_t size)
+{
+    uintptr_t start;
+    uint32_t pad;
+
+    /* Align the first allocation. */
+    start = (uintptr_t)buf;
+    pad = OS_ALIGN(start, OS_ALIGNMENT) - start;
+    if (pad > size) {
+        pad = size;
+    }
+
+    ma->ma_buf = (uint8_t *)buf + pad;
+    ma->ma_size = size - pad;
+    ma->ma_off = 0;
+    ma->ma_hiwat = 0;
+}
+
+/**
+ * Initializes an arena over the unused trailing space of an mbuf.  The mbuf
+ * must not be written to or freed while the arena is in use.
+ *
+ * @param ma                    The arena to initialize.
+ * @param om                    The mbuf whose buffer to allocate from.
+ *
+ * @return                      0 on success;
+ *                              OS_EINVAL if the mbuf has no trailing space.
+ */
+int
+mem_arena_init_mbuf(struct mem_arena *ma, struct os_mbuf *om)
+{
+    uint16_t space;
+
+    space = OS_MBUF_TRAILINGSPACE(om);
+    if (space == 0) {
+        return OS_EINVAL;
+    }
+
+    mem_arena_init(ma, om->om_data + om->om_len, space);
+    return 0;
+}
+
+/**
+ * Allocates memory from an arena.  The returned memory is aligned to
+ * OS_ALIGNMENT.
+ *
+ * @param ma                    The arena to allocate from.
+ * @param size                  The number of bytes to allocate.
+ *
+ * @return                      The allocated memory on success;
+ *                              NULL if the arena is exhausted.
+ */
+void *
+mem_arena_alloc(struct mem_arena *ma, uint32_t size)
+{
+    uint32_t len;
+    void *ptr;
+
+    len = OS_ALIGN(size, OS_ALIGNMENT);
+    if (len < size || len > ma->ma_size - ma->ma_off) {
+        return NULL;
+    }
+
+    ptr = ma->ma_buf + ma->ma_off;
+    ma->ma_off += len;
+    if (ma->ma_off > ma->ma_hiwat) {
+        ma->ma_hiwat = ma->ma_off;
+    }
+
+    return ptr;
+}
+
+/**
+ * Frees the specified allocation along with every allocation made after it.
+ *
+ * @param ma                    The arena the memory was allocated from.
+ * @param ptr                   A pointer returned by mem_arena_alloc().
+ */
+void
+mem_arena_release(struct mem_arena *ma, void *ptr)
+{
+    uint8_t *p;
+
+    p = ptr;
+    assert(p >= ma->ma_buf && p <= ma->ma_buf + ma->ma_off);
+
+    ma->ma_off = p - ma->ma_buf;
+}
@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_RCU_
+#define H_RCU_
+
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Epoch-based read-copy-update ("RCU-lite").
+ *
+ * Protects linked structures which are read far more often than they are
+ * changed.  Readers traverse the structure inside a read section without
+ * taking a lock and never block.  Writers serialize among themselves (with a
+ * mutex of their own), publish changes with single pointer stores, and call
+ * rcu_synchronize() before freeing anything they unlinked.  rcu_synchronize()
+ * returns once every read section which was open when it was called has
+ * ended, so no reader can still hold a pointer to the unlinked elements.
+ *
+ * Read sections may be nested and may be entered from interrupt context.  A
+ * read section must not call rcu_synchronize() on the same domain.
+ *
+ * All struct fields should be considered private.
+ */
+struct rcu {
+    /** Open read sections, per epoch. */
+    volatile uint16_t readers[2];
+
+    /** Epoch that new read sections are counted against. */
+    uint8_t epoch;
+
+    /** Serializes rcu_synchronize() callers. */
+    struct os_mutex mtx;
+};
+
+/**
+ * Enters a read section.
+ *
+ * @param rcu                   The domain to read.
+ *
+ * @return                      A token to pass to rcu_read_exit().
+ */
+static inline int
+rcu_read_enter(struct rcu *rcu)
+{
+    os_sr_t sr;
+    int epoch;
+
+    OS_ENTER_CRITICAL(sr);
+    epoch = rcu->epoch;
+    rcu->readers[epoch]++;
+    OS_EXIT_CRITICAL(sr);
+
+    return epoch;
+}
+
+/**
+ * Leaves a read section.
+ *
+ * @param rcu                   The domain being read.
+ * @param token                 The value returned by the matching call to
+ *                                  rcu_read_enter().
+ */
+static inline void
+rcu_read_exit(struct rcu *rcu, int token)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(rcu->readers[token] > 0);
+    rcu->readers[token]--;
+    OS_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Waits until all read sections open at the time of the call have ended.
+ * Must be called from task context, outside of any read section of the same
+ * domain.
+ *
+ * @param rcu                   The domain to wait on.
+ */
+void rcu_synchronize(struct rcu *rcu);
+
+/**
+ * Publishes a pointer for readers.  All stores made before the call (i.e.,
+ * those initializing the pointed to object) are visible to a reader which
+ * sees the new pointer value.
+ */
+#define RCU_ASSIGN_PTR(p, v) do {                       \
+    __atomic_thread_fence(__ATOMIC_RELEASE);            \
+    (p) = (v);                                          \
+} while (0)
+
+/**
+ * Hashes a name for a name-indexed registry (32-bit FNV-1a).
+ *
+ * @param name                  The null-terminated name to hash.
+ *
+ * @return                      The hash value.
+ */
+static inline uint32_t
+rcu_name_hash(const char *name)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+ * Initializes an RCU domain.
+ *
+ * @param rcu                   The domain to initialize.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int rcu_init(struct rcu *rcu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
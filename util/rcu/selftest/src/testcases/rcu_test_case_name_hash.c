@@ -0,0 +1,31 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rcu/rcu.h"
+#include "rcu_test.h"
+
+TEST_CASE_SELF(rcu_test_case_name_hash)
+{
+    /* FNV-1a reference values. */
+    TEST_ASSERT(rcu_name_hash("") == 0x811c9dc5);
+    TEST_ASSERT(rcu_name_hash("a") == 0xe40c292c);
+    TEST_ASSERT(rcu_name_hash("foobar") == 0xbf9cf968);
+
+    TEST_ASSERT(rcu_name_hash("log0") != rcu_name_hash("log1"));
+}
@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rcu/rcu.h"
+#include "rcu_test.h"
+
+#define RTCS_SYNC_TASK_PRIO     10
+
+#define RTCS_STACK_SIZE         OS_STACK_ALIGN(1024)
+
+static void rtcs_evcb_sync(struct os_event *ev);
+
+static int rtcs_num_syncs;
+
+static struct os_eventq rtcs_evq_sync;
+
+static struct os_task rtcs_task_sync;
+
+static os_stack_t rtcs_stack_sync[RTCS_STACK_SIZE];
+
+static struct rcu rtcs_rcu;
+
+static struct os_event rtcs_ev_sync = {
+    .ev_cb = rtcs_evcb_sync,
+};
+
+static void
+rtcs_evcb_sync(struct os_event *ev)
+{
+    rcu_synchronize(&rtcs_rcu);
+    rtcs_num_syncs++;
+}
+
+static void
+rtcs_enqueue_sync(void)
+{
+    os_eventq_put(&rtcs_evq_sync, &rtcs_ev_sync);
+}
+
+static void
+rtcs_sync_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&rtcs_evq_sync);
+    }
+}
+
+TEST_CASE_TASK(rcu_test_case_sync)
+{
+    int tok1;
+    int tok2;
+    int tok3;
+    int rc;
+
+    os_eventq_init(&rtcs_evq_sync);
+
+    rc = os_task_init(&rtcs_task_sync, "sync", rtcs_sync_task_handler, NULL,
+                      RTCS_SYNC_TASK_PRIO, OS_WAIT_FOREVER, rtcs_stack_sync,
+                      RTCS_STACK_SIZE);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = rcu_init(&rtcs_rcu);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* No readers; ensure synchronize returns right away. */
+    rtcs_enqueue_sync();
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 1);
+
+    /* Open two nested read sections; ensure synchronize waits. */
+    tok1 = rcu_read_enter(&rtcs_rcu);
+    tok2 = rcu_read_enter(&rtcs_rcu);
+    TEST_ASSERT_FATAL(tok1 == tok2);
+    rtcs_enqueue_sync();
+    os_time_delay(2);
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 1);
+
+    /* Open a read section meanwhile; ensure it is in the new epoch. */
+    tok3 = rcu_read_enter(&rtcs_rcu);
+    TEST_ASSERT_FATAL(tok3 != tok1);
+
+    /* Close inner section; ensure synchronize still waits for outer one. */
+    rcu_read_exit(&rtcs_rcu, tok2);
+    os_time_delay(2);
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 1);
+
+    /* Close outer section; ensure synchronize returns, ignoring the late
+     * reader.
+     */
+    rcu_read_exit(&rtcs_rcu, tok1);
+    os_time_delay(2);
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 2);
+
+    /* Synchronize again; ensure it waits for the late reader. */
+    rtcs_enqueue_sync();
+    os_time_delay(2);
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 2);
+
+    rcu_read_exit(&rtcs_rcu, tok3);
+    os_time_delay(2);
+    TEST_ASSERT_FATAL(rtcs_num_syncs == 3);
+}
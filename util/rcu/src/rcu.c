@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "rcu/rcu.h"
+
+void
+rcu_synchronize(struct rcu *rcu)
+{
+    os_sr_t sr;
+    int old;
+
+    os_mutex_pend(&rcu->mtx, OS_TIMEOUT_NEVER);
+
+    /* Count new readers against the other epoch, then wait for the ones
+     * counted against the old epoch to leave.  The previous call already
+     * drained the other epoch, so every reader which entered before this
+     * call is in the old one.
+     */
+    OS_ENTER_CRITICAL(sr);
+    old = rcu->epoch;
+    rcu->epoch = old ^ 1;
+    OS_EXIT_CRITICAL(sr);
+
+    while (rcu->readers[old] != 0) {
+        os_time_delay(1);
+    }
+
+    os_mutex_release(&rcu->mtx);
+}
+
+int
+rcu_init(struct rcu *rcu)
+{
+    *rcu = (struct rcu) { 0 };
+
+    return os_mutex_init(&rcu->mtx);
+}
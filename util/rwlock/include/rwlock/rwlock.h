@@ -22,6 +22,27 @@
 
 #include "os/mynewt.h"
 
+#if MYNEWT_VAL(RWLOCK_STATS)
+/** Contention statistics of a lock; see rwlock_stats_get(). */
+struct rwlock_stats {
+    /** Read acquisitions.  Approximate with concurrent readers. */
+    uint32_t rs_reads;
+    /** Read acquisitions which had to take the mutex */
+    uint32_t rs_read_slow;
+    /** Read acquisitions which had to block */
+    uint32_t rs_read_waits;
+    /** Write acquisitions */
+    uint32_t rs_writes;
+    /** Write acquisitions which had to block */
+    uint32_t rs_write_waits;
+};
+#endif
+
+/** State word: the number of active readers, plus the flag below. */
+#define RWLOCK_STATE_READERS    0x7fffffffUL
+/** Set while readers must go through the mutex. */
+#define RWLOCK_STATE_SLOW       0x80000000UL
+
 /**
  * @brief Readers–writer lock - lock for multiple readers, single writer.
  *
@@ -34,9 +55,20 @@
  *       is acquired by a pending writer if there is one.  If there are no
  *       pending writers, the lock is acquired by all pending readers.
  *
+ * While no writer is active or pending, readers acquire and release the lock
+ * with a single atomic update of the state word, without touching the mutex.
+ * A writer sets the RWLOCK_STATE_SLOW flag in the state word, which sends
+ * readers to the mutex protected path until the lock is uncontended again.
+ *
  * All struct fields should be considered private.
  */
 struct rwlock {
+    /**
+     * The number of active readers and the RWLOCK_STATE_SLOW flag.  Updated
+     * atomically; the flag is only changed with the mutex held.
+     */
+    volatile uint32_t state;
+
     /** Protects access to rwlock's internal state. */
     struct os_mutex mtx;
 
@@ -46,9 +78,6 @@ struct rwlock {
     /** Blocks and wakes up pending writers. */
     struct os_sem wsem;
 
-    /** The number of active readers. */
-    uint8_t num_readers;
-
     /** Whether there is an active writer. */
     bool active_writer;
 
@@ -63,6 +92,10 @@ struct rwlock {
      * acquisitions are allowed until all handoffs are complete.
      */
     uint8_t handoffs;
+
+#if MYNEWT_VAL(RWLOCK_STATS)
+    struct rwlock_stats stats;
+#endif
 };
 
 /**
@@ -93,6 +126,17 @@ void rwlock_acquire_write(struct rwlock *lock);
  */
 void rwlock_release_write(struct rwlock *lock);
 
+#if MYNEWT_VAL(RWLOCK_STATS)
+/**
+ * Reads a lock's contention statistics.
+ *
+ * @param lock                  The lock to read.
+ * @param out_stats             The statistics are written here.
+ */
+void rwlock_stats_get(const struct rwlock *lock,
+                      struct rwlock_stats *out_stats);
+#endif
+
 /**
  * Initializes a readers-writer lock.
  *
@@ -26,6 +26,84 @@
 #define RWLOCK_DBG_ASSERT(expr)
 #endif
 
+#if MYNEWT_VAL(RWLOCK_STATS)
+#define RWLOCK_STATS_INC(lock, field) ((lock)->stats.field++)
+#else
+#define RWLOCK_STATS_INC(lock, field)
+#endif
+
+/**
+ * Atomically replaces the lock's state word with `new` if it still equals
+ * `old`.  Returns true on success.
+ */
+static inline bool
+rwlock_state_cas(struct rwlock *lock, uint32_t old, uint32_t new)
+{
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+    return __atomic_compare_exchange_n(&lock->state, &old, new, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+    os_sr_t sr;
+    bool rc;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = lock->state == old;
+    if (rc) {
+        lock->state = new;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+#endif
+}
+
+static inline uint32_t
+rwlock_state_read(const struct rwlock *lock)
+{
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+    return __atomic_load_n(&lock->state, __ATOMIC_ACQUIRE);
+#else
+    return lock->state;
+#endif
+}
+
+/**
+ * Atomically clears the bits in `clr` and then sets the bits in `set`, and
+ * adds `delta` to the reader count.  Returns the new state.
+ */
+static uint32_t
+rwlock_state_update(struct rwlock *lock, uint32_t clr, uint32_t set,
+                    int delta)
+{
+    uint32_t old;
+    uint32_t new;
+
+    do {
+        old = rwlock_state_read(lock);
+        new = ((old & ~clr) | set) + delta;
+    } while (!rwlock_state_cas(lock, old, new));
+
+    return new;
+}
+
+/**
+ * Lets readers bypass the mutex again if nothing stands in their way.  The
+ * caller must lock the mutex prior to calling this.
+ */
+static void
+rwlock_update_slow(struct rwlock *lock)
+{
+    RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
+
+    if (!lock->active_writer &&
+        lock->pending_writers == 0 &&
+        lock->pending_readers == 0 &&
+        lock->handoffs == 0) {
+
+        rwlock_state_update(lock, RWLOCK_STATE_SLOW, 0, 0);
+    }
+}
+
 /**
  * Unblocks the next pending user.  The caller must lock the mutex prior to
  * calling this.
@@ -88,22 +166,40 @@ rwlock_write_must_block(const struct rwlock *lock)
     RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
 
     return lock->active_writer ||
-           lock->num_readers > 0 ||
+           (rwlock_state_read(lock) & RWLOCK_STATE_READERS) > 0 ||
            lock->handoffs > 0;
 }
 
 void
 rwlock_acquire_read(struct rwlock *lock)
 {
+    uint32_t state;
     bool acquired;
 
+    /* Fast path: no writer active or pending, just count the reader. */
+    state = rwlock_state_read(lock);
+    while (!(state & RWLOCK_STATE_SLOW)) {
+        RWLOCK_DBG_ASSERT((state & RWLOCK_STATE_READERS) !=
+                          RWLOCK_STATE_READERS);
+        if (rwlock_state_cas(lock, state, state + 1)) {
+            RWLOCK_STATS_INC(lock, rs_reads);
+            return;
+        }
+        state = rwlock_state_read(lock);
+    }
+
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
+    RWLOCK_STATS_INC(lock, rs_reads);
+    RWLOCK_STATS_INC(lock, rs_read_slow);
+
     if (rwlock_read_must_block(lock)) {
+        RWLOCK_STATS_INC(lock, rs_read_waits);
         lock->pending_readers++;
         acquired = false;
     } else {
-        lock->num_readers++;
+        rwlock_state_update(lock, 0, 0, 1);
+        rwlock_update_slow(lock);
         acquired = true;
     }
 
@@ -119,25 +215,39 @@ rwlock_acquire_read(struct rwlock *lock)
 
     /* Record reader ownership. */
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
-    lock->num_readers++;
+    rwlock_state_update(lock, 0, 0, 1);
     rwlock_complete_handoff(lock);
+    rwlock_update_slow(lock);
     os_mutex_release(&lock->mtx);
 }
 
 void
 rwlock_release_read(struct rwlock *lock)
 {
+    uint32_t state;
+
+    /* Fast path: nobody is waiting, just drop the reader. */
+    state = rwlock_state_read(lock);
+    while (!(state & RWLOCK_STATE_SLOW)) {
+        RWLOCK_DBG_ASSERT((state & RWLOCK_STATE_READERS) > 0);
+        if (rwlock_state_cas(lock, state, state - 1)) {
+            return;
+        }
+        state = rwlock_state_read(lock);
+    }
+
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
-    RWLOCK_DBG_ASSERT(lock->num_readers > 0);
-    lock->num_readers--;
+    RWLOCK_DBG_ASSERT((rwlock_state_read(lock) & RWLOCK_STATE_READERS) > 0);
+    state = rwlock_state_update(lock, 0, 0, -1);
 
     /* If this is the last active reader, unblock a pending writer if there is
      * one.
      */
-    if (lock->num_readers == 0) {
+    if ((state & RWLOCK_STATE_READERS) == 0) {
         rwlock_unblock(lock);
     }
+    rwlock_update_slow(lock);
 
     os_mutex_release(&lock->mtx);
 }
@@ -149,7 +259,15 @@ rwlock_acquire_write(struct rwlock *lock)
 
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
+    RWLOCK_STATS_INC(lock, rs_writes);
+
+    /* Send new readers through the mutex before counting active ones; a
+     * reader either makes it in before this or sees the flag.
+     */
+    rwlock_state_update(lock, 0, RWLOCK_STATE_SLOW, 0);
+
     if (rwlock_write_must_block(lock)) {
+        RWLOCK_STATS_INC(lock, rs_write_waits);
         lock->pending_writers++;
         acquired = false;
     } else {
@@ -183,10 +301,23 @@ rwlock_release_write(struct rwlock *lock)
     lock->active_writer = false;
 
     rwlock_unblock(lock);
+    rwlock_update_slow(lock);
 
     os_mutex_release(&lock->mtx);
 }
 
+#if MYNEWT_VAL(RWLOCK_STATS)
+void
+rwlock_stats_get(const struct rwlock *lock, struct rwlock_stats *out_stats)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *out_stats = lock->stats;
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 int
 rwlock_init(struct rwlock *lock)
 {
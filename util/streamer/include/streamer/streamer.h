@@ -52,6 +52,39 @@ struct streamer_mbuf {
     struct os_mbuf *om;
 };
 
+/**
+ * @brief Hands a full (or final) chunk to the transport.
+ *
+ * On success the callback takes ownership of the chunk.  Returning
+ * SYS_EAGAIN means the transport cannot take it right now; the streamer
+ * keeps the chunk and retries after streamer_chunk_resume() is called.  Any
+ * other error frees the chunk and is reported to the writer.
+ *
+ * @param om                    The chunk; a packet header mbuf.
+ * @param arg                   The argument passed to streamer_chunk_new().
+ *
+ * @return                      0 on success; SYS_E[...] on failure.
+ */
+typedef int streamer_chunk_flush_fn(struct os_mbuf *om, void *arg);
+
+/**
+ * @brief Streams data into msys mbuf chains of at most one MTU each, handing
+ * every full chain to a transport callback.
+ *
+ * printf-style output is formatted straight into the free space of the
+ * last mbuf, so no intermediate buffer or extra mbuf is needed in the
+ * common case.
+ */
+struct streamer_chunk {
+    struct streamer streamer; /* Must be first member. */
+    struct os_mbuf *om;
+    streamer_chunk_flush_fn *flush_cb;
+    void *arg;
+    uint16_t mtu;
+    os_time_t timeout;
+    struct os_sem sem;
+};
+
 /**
  * @brief Writes the given flat buffer to a streamer.
  *
@@ -107,4 +140,46 @@ int streamer_mbuf_new(struct streamer_mbuf *sm, struct os_mbuf *om);
  */
 int streamer_msys_new(struct streamer_mbuf *sm);
 
+/**
+ * Constructs a chunking streamer.
+ *
+ * @param sc                    The chunk streamer object to populate.
+ * @param mtu                   Maximum number of bytes per chunk.
+ * @param timeout               How long a writer waits for the transport
+ *                                  after it refused a chunk, in ticks.
+ * @param flush_cb              Receives each chunk.
+ * @param arg                   Passed to flush_cb.
+ *
+ * @return                      0 on success; SYS_E[...] on failure.
+ */
+int streamer_chunk_new(struct streamer_chunk *sc, uint16_t mtu,
+                       os_time_t timeout, streamer_chunk_flush_fn *flush_cb,
+                       void *arg);
+
+/**
+ * Hands the partially filled chunk, if any, to the transport.  Call when
+ * the output is complete.
+ *
+ * @param sc                    The chunk streamer to flush.
+ *
+ * @return                      0 on success; SYS_E[...] on failure.
+ */
+int streamer_chunk_flush(struct streamer_chunk *sc);
+
+/**
+ * Tells a chunk streamer the transport can accept data again.  Wakes a
+ * writer waiting after the flush callback returned SYS_EAGAIN.  Can be
+ * called from interrupt context.
+ *
+ * @param sc                    The chunk streamer to resume.
+ */
+void streamer_chunk_resume(struct streamer_chunk *sc);
+
+/**
+ * Frees any data not yet handed to the transport.
+ *
+ * @param sc                    The chunk streamer to clean up.
+ */
+void streamer_chunk_free(struct streamer_chunk *sc);
+
 #endif
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "streamer/streamer.h"
+#include "streamer_priv.h"
+
+static int
+streamer_chunk_get(struct streamer_chunk *sc)
+{
+    if (sc->om == NULL) {
+        sc->om = os_msys_get_pkthdr(sc->mtu, 0);
+        if (sc->om == NULL) {
+            return SYS_ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+static int
+streamer_chunk_send(struct streamer_chunk *sc)
+{
+    int rc;
+
+    while (1) {
+        rc = sc->flush_cb(sc->om, sc->arg);
+        if (rc != SYS_EAGAIN) {
+            break;
+        }
+
+        /* Transport is backed up; wait for it to drain. */
+        if (os_sem_pend(&sc->sem, sc->timeout) != OS_OK) {
+            return SYS_ETIMEOUT;
+        }
+    }
+
+    if (rc != 0) {
+        os_mbuf_free_chain(sc->om);
+    }
+    sc->om = NULL;
+
+    return rc;
+}
+
+static int
+streamer_chunk_write(struct streamer *streamer, const void *src, size_t len)
+{
+    struct streamer_chunk *sc;
+    const uint8_t *u8p;
+    uint16_t chunk;
+    int rc;
+
+    sc = (struct streamer_chunk *)streamer;
+    u8p = src;
+
+    while (len > 0) {
+        rc = streamer_chunk_get(sc);
+        if (rc != 0) {
+            return rc;
+        }
+
+        chunk = min(len, sc->mtu - OS_MBUF_PKTLEN(sc->om));
+        rc = os_mbuf_append(sc->om, u8p, chunk);
+        if (rc != 0) {
+            return os_error_to_sys(rc);
+        }
+        u8p += chunk;
+        len -= chunk;
+
+        if (OS_MBUF_PKTLEN(sc->om) == sc->mtu) {
+            rc = streamer_chunk_send(sc);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int
+streamer_chunk_vprintf(struct streamer *streamer, const char *fmt,
+                       va_list ap)
+{
+    char buf[MYNEWT_VAL(STREAMER_MBUF_PRINTF_MAX)];
+    struct streamer_chunk *sc;
+    int num_chars;
+    int rc;
+
+    sc = (struct streamer_chunk *)streamer;
+
+    rc = streamer_chunk_get(sc);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Common case: the text fits in the current mbuf. */
+    num_chars = streamer_mbuf_vprintf_tail(sc->om,
+                                           sc->mtu - OS_MBUF_PKTLEN(sc->om),
+                                           fmt, ap);
+    if (num_chars >= 0) {
+        return num_chars;
+    }
+
+    num_chars = vsnprintf(buf, sizeof buf, fmt, ap);
+    if (num_chars > sizeof buf - 1) {
+        num_chars = sizeof buf - 1;
+    }
+
+    rc = streamer_chunk_write(streamer, buf, num_chars);
+    if (rc != 0) {
+        return rc;
+    }
+
+    return num_chars;
+}
+
+static const struct streamer_cfg streamer_cfg_chunk = {
+    .write_cb = streamer_chunk_write,
+    .vprintf_cb = streamer_chunk_vprintf,
+};
+
+int
+streamer_chunk_new(struct streamer_chunk *sc, uint16_t mtu,
+                   os_time_t timeout, streamer_chunk_flush_fn *flush_cb,
+                   void *arg)
+{
+    if (sc == NULL || mtu == 0 || flush_cb == NULL) {
+        return SYS_EINVAL;
+    }
+
+    *sc = (struct streamer_chunk) {
+        .streamer.cfg = &streamer_cfg_chunk,
+        .flush_cb = flush_cb,
+        .arg = arg,
+        .mtu = mtu,
+        .timeout = timeout,
+    };
+    os_sem_init(&sc->sem, 0);
+
+    return 0;
+}
+
+int
+streamer_chunk_flush(struct streamer_chunk *sc)
+{
+    if (sc->om == NULL || OS_MBUF_PKTLEN(sc->om) == 0) {
+        return 0;
+    }
+
+    return streamer_chunk_send(sc);
+}
+
+void
+streamer_chunk_resume(struct streamer_chunk *sc)
+{
+    if (os_sem_get_count(&sc->sem) == 0) {
+        os_sem_release(&sc->sem);
+    }
+}
+
+void
+streamer_chunk_free(struct streamer_chunk *sc)
+{
+    if (sc->om != NULL) {
+        os_mbuf_free_chain(sc->om);
+        sc->om = NULL;
+    }
+}
@@ -19,6 +19,42 @@
 
 #include "os/mynewt.h"
 #include "streamer/streamer.h"
+#include "streamer_priv.h"
+
+int
+streamer_mbuf_vprintf_tail(struct os_mbuf *om, uint16_t max,
+                           const char *fmt, va_list ap)
+{
+    struct os_mbuf *last;
+    va_list ap2;
+    int space;
+    int num_chars;
+
+    last = om;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+
+    space = min(OS_MBUF_TRAILINGSPACE(last), max);
+    if (space <= 0) {
+        return -1;
+    }
+
+    va_copy(ap2, ap);
+    num_chars = vsnprintf((char *)last->om_data + last->om_len, space,
+                          fmt, ap2);
+    va_end(ap2);
+
+    /* The null-terminator has to fit as well. */
+    if (num_chars < 0 || num_chars >= space) {
+        return -1;
+    }
+
+    last->om_len += num_chars;
+    OS_MBUF_PKTHDR(om)->omp_len += num_chars;
+
+    return num_chars;
+}
 
 static int
 streamer_mbuf_write(struct streamer *streamer, const void *src, size_t len)
@@ -43,9 +79,20 @@ static int
 streamer_mbuf_vprintf(struct streamer *streamer, const char *fmt, va_list ap)
 {
     char buf[MYNEWT_VAL(STREAMER_MBUF_PRINTF_MAX)];
+    struct streamer_mbuf *sm;
     int num_chars;
     int rc;
 
+    sm = (struct streamer_mbuf *)streamer;
+    if (OS_MBUF_IS_PKTHDR(sm->om)) {
+        num_chars = streamer_mbuf_vprintf_tail(sm->om, UINT16_MAX -
+                                               OS_MBUF_PKTLEN(sm->om),
+                                               fmt, ap);
+        if (num_chars >= 0) {
+            return num_chars;
+        }
+    }
+
     num_chars = vsnprintf(buf, sizeof buf, fmt, ap);
     if (num_chars > sizeof buf - 1) {
         num_chars = sizeof buf - 1;
@@ -0,0 +1,37 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_STREAMER_PRIV_
+#define H_STREAMER_PRIV_
+
+#include <stdarg.h>
+#include "os/mynewt.h"
+
+/**
+ * Formats text directly into the free space of the last mbuf of a packet
+ * header chain, appending at most max bytes.
+ *
+ * @return                      The number of bytes appended; -1 if the text
+ *                              did not fit, in which case the chain is
+ *                              unchanged.
+ */
+int streamer_mbuf_vprintf_tail(struct os_mbuf *om, uint16_t max,
+                               const char *fmt, va_list ap);
+
+#endif
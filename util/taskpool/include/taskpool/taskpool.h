@@ -29,6 +29,9 @@
  * This package creates a single global task pool.  Each allocated task
  * uses the same size stack.  The task count and stack size settings are
  * specified via syscfg.
+ *
+ * With TASKPOOL_WORKERS set, the package also runs a pool of worker tasks
+ * which execute short jobs; see taskpool_job_submit().
  */
 
 /**
@@ -81,4 +84,65 @@ int taskpool_wait(os_time_t max_ticks);
  */
 void taskpool_wait_assert(os_time_t max_ticks);
 
+#if MYNEWT_VAL(TASKPOOL_WORKERS) > 0
+
+/*
+ * Worker pool.
+ *
+ * TASKPOOL_WORKERS worker tasks run short jobs.  A job is an os_event; the
+ * worker calls its ev_cb with the event as argument.  Each worker has one
+ * deque of jobs per job priority.  Jobs submitted from a worker go to the
+ * bottom of that worker's own deque and are taken back LIFO; idle workers
+ * steal from the top of other workers' deques.  High priority jobs are
+ * always taken before low priority ones.
+ */
+
+/** Taken before any low priority job. */
+#define TASKPOOL_JOB_PRIO_HIGH      0
+#define TASKPOOL_JOB_PRIO_LOW       1
+
+/**
+ * @brief Queues a job for execution by the worker pool.
+ *
+ * The event must not be changed until its callback runs.  The callback may
+ * submit the same event again.
+ *
+ * @param ev                    The job to run.
+ * @param prio                  TASKPOOL_JOB_PRIO_HIGH or
+ *                                  TASKPOOL_JOB_PRIO_LOW.
+ *
+ * @return                      0 on success;
+ *                              SYS_EBUSY if the job is already queued;
+ *                              SYS_EINVAL on a bad priority;
+ *                              SYS_ENOMEM if all deques are full.
+ */
+int taskpool_job_submit(struct os_event *ev, uint8_t prio);
+
+/**
+ * @brief Function called for each index of a parallel for.
+ *
+ * @param idx                   The index to process.
+ * @param arg                   The argument given to taskpool_parallel_for().
+ */
+typedef void taskpool_for_fn(uint32_t idx, void *arg);
+
+/**
+ * @brief Runs fn for every index in [0, count) on the worker pool and waits
+ * for all of them to finish.
+ *
+ * The range is split into at most TASKPOOL_PFOR_MAX_CHUNKS contiguous
+ * chunks.  The calling task runs the first chunk itself, and other queued
+ * jobs while it waits, so this may be called from a worker.  Chunks which
+ * cannot be queued are run by the caller as well.
+ *
+ * @param count                 The number of indices.
+ * @param fn                    The function to call for each index.
+ * @param arg                   Passed to fn.
+ * @param prio                  Priority of the chunk jobs.
+ */
+void taskpool_parallel_for(uint32_t count, taskpool_for_fn *fn, void *arg,
+                           uint8_t prio);
+
+#endif
+
 #endif
@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "taskpool_test.h"
+
+bool
+taskpool_test_on_worker(void)
+{
+    return strncmp(os_sched_get_current_task()->t_name, "worker", 6) == 0;
+}
+
+TEST_SUITE(taskpool_test_suite_work)
+{
+    taskpool_test_case_steal();
+    taskpool_test_case_enomem();
+    taskpool_test_case_pfor_nested();
+}
+
+int
+main(int argc, char **argv)
+{
+    taskpool_test_suite_work();
+    return tu_any_failed;
+}
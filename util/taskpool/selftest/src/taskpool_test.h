@@ -0,0 +1,38 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_TASKPOOL_TEST_H
+#define H_TASKPOOL_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "taskpool/taskpool.h"
+
+/* Longest a test waits for the worker pool. */
+#define TASKPOOL_TEST_TMO   OS_TICKS_PER_SEC
+
+/* Returns true if the calling task is a worker. */
+bool taskpool_test_on_worker(void);
+
+TEST_SUITE_DECL(taskpool_test_suite_work);
+TEST_CASE_DECL(taskpool_test_case_steal);
+TEST_CASE_DECL(taskpool_test_case_enomem);
+TEST_CASE_DECL(taskpool_test_case_pfor_nested);
+
+#endif
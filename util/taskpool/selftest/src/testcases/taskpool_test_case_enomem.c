@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool_test.h"
+
+#define TTCE_FILL   (MYNEWT_VAL(TASKPOOL_WORKERS) * \
+                     MYNEWT_VAL(TASKPOOL_WORKER_QUEUE_LEN))
+#define TTCE_COUNT  MYNEWT_VAL(TASKPOOL_PFOR_MAX_CHUNKS)
+
+static void ttce_block_cb(struct os_event *ev);
+static void ttce_fill_cb(struct os_event *ev);
+
+static struct os_sem ttce_gate;
+static struct os_sem ttce_done;
+static int ttce_fill_runs;
+
+static struct os_event ttce_block_ev[MYNEWT_VAL(TASKPOOL_WORKERS)];
+static struct os_event ttce_fill_ev[TTCE_FILL + 1];
+
+static struct os_task *ttce_for_task[TTCE_COUNT];
+static int ttce_for_hits[TTCE_COUNT];
+
+static void
+ttce_block_cb(struct os_event *ev)
+{
+    os_sem_pend(&ttce_gate, OS_TIMEOUT_NEVER);
+    os_sem_release(&ttce_done);
+}
+
+static void
+ttce_fill_cb(struct os_event *ev)
+{
+    ttce_fill_runs++;
+    os_sem_release(&ttce_done);
+}
+
+static void
+ttce_for_fn(uint32_t idx, void *arg)
+{
+    ttce_for_task[idx] = os_sched_get_current_task();
+    ttce_for_hits[idx]++;
+}
+
+TEST_CASE_TASK(taskpool_test_case_enomem)
+{
+    int rc;
+    int i;
+
+    os_sem_init(&ttce_gate, 0);
+    os_sem_init(&ttce_done, 0);
+
+    /* Occupy every worker. */
+    for (i = 0; i < MYNEWT_VAL(TASKPOOL_WORKERS); i++) {
+        ttce_block_ev[i].ev_cb = ttce_block_cb;
+        rc = taskpool_job_submit(&ttce_block_ev[i], TASKPOOL_JOB_PRIO_LOW);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* Fill all low priority deques. */
+    for (i = 0; i <= TTCE_FILL; i++) {
+        ttce_fill_ev[i].ev_cb = ttce_fill_cb;
+    }
+    for (i = 0; i < TTCE_FILL; i++) {
+        rc = taskpool_job_submit(&ttce_fill_ev[i], TASKPOOL_JOB_PRIO_LOW);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = taskpool_job_submit(&ttce_fill_ev[TTCE_FILL], TASKPOOL_JOB_PRIO_LOW);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+    TEST_ASSERT(!ttce_fill_ev[TTCE_FILL].ev_queued);
+    rc = taskpool_job_submit(&ttce_fill_ev[0], TASKPOOL_JOB_PRIO_LOW);
+    TEST_ASSERT(rc == SYS_EBUSY);
+    rc = taskpool_job_submit(&ttce_fill_ev[TTCE_FILL],
+                             TASKPOOL_JOB_PRIO_LOW + 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /* No chunk can be queued; the caller runs them all. */
+    taskpool_parallel_for(TTCE_COUNT, ttce_for_fn, NULL,
+                          TASKPOOL_JOB_PRIO_LOW);
+    for (i = 0; i < TTCE_COUNT; i++) {
+        TEST_ASSERT(ttce_for_hits[i] == 1);
+        TEST_ASSERT(ttce_for_task[i] == os_sched_get_current_task());
+    }
+    TEST_ASSERT(ttce_fill_runs == 0);
+
+    /* Let the workers go; the queued jobs all run. */
+    for (i = 0; i < MYNEWT_VAL(TASKPOOL_WORKERS); i++) {
+        os_sem_release(&ttce_gate);
+    }
+    for (i = 0; i < MYNEWT_VAL(TASKPOOL_WORKERS) + TTCE_FILL; i++) {
+        rc = os_sem_pend(&ttce_done, TASKPOOL_TEST_TMO);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(ttce_fill_runs == TTCE_FILL);
+}
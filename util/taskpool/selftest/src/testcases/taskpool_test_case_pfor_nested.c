@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool_test.h"
+
+#define TTCP_OUTER  4
+#define TTCP_INNER  (2 * MYNEWT_VAL(TASKPOOL_PFOR_MAX_CHUNKS))
+
+static int ttcp_hits[TTCP_OUTER][TTCP_INNER];
+static bool ttcp_on_worker[TTCP_OUTER];
+
+static void
+ttcp_inner_fn(uint32_t idx, void *arg)
+{
+    int *hits = arg;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    hits[idx]++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+/* Runs on the test task for chunk 0, on workers for the others. */
+static void
+ttcp_outer_fn(uint32_t idx, void *arg)
+{
+    ttcp_on_worker[idx] = taskpool_test_on_worker();
+    taskpool_parallel_for(TTCP_INNER, ttcp_inner_fn, ttcp_hits[idx],
+                          TASKPOOL_JOB_PRIO_LOW);
+}
+
+TEST_CASE_TASK(taskpool_test_case_pfor_nested)
+{
+    int nworker;
+    int i;
+    int j;
+
+    taskpool_parallel_for(TTCP_OUTER, ttcp_outer_fn, NULL,
+                          TASKPOOL_JOB_PRIO_LOW);
+
+    nworker = 0;
+    for (i = 0; i < TTCP_OUTER; i++) {
+        for (j = 0; j < TTCP_INNER; j++) {
+            TEST_ASSERT(ttcp_hits[i][j] == 1);
+        }
+        nworker += ttcp_on_worker[i];
+    }
+    TEST_ASSERT(!ttcp_on_worker[0]);
+    TEST_ASSERT(nworker > 0);
+}
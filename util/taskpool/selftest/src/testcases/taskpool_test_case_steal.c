@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool_test.h"
+
+static void ttcs_parent_cb(struct os_event *ev);
+static void ttcs_child_cb(struct os_event *ev);
+
+static struct os_sem ttcs_gate;
+static struct os_sem ttcs_done;
+
+static struct os_task *ttcs_parent_task;
+static struct os_task *ttcs_child_task[2];
+static int ttcs_child_seq[2];
+static int ttcs_seq;
+
+static struct os_event ttcs_parent_ev = {
+    .ev_cb = ttcs_parent_cb,
+};
+
+static struct os_event ttcs_child_ev[2] = {
+    { .ev_cb = ttcs_child_cb, .ev_arg = (void *)0 },
+    { .ev_cb = ttcs_child_cb, .ev_arg = (void *)1 },
+};
+
+static void
+ttcs_child_cb(struct os_event *ev)
+{
+    int i;
+
+    i = (int)(uintptr_t)ev->ev_arg;
+    TEST_ASSERT(taskpool_test_on_worker());
+    ttcs_child_task[i] = os_sched_get_current_task();
+    ttcs_child_seq[i] = ttcs_seq++;
+    os_sem_release(&ttcs_done);
+}
+
+/*
+ * Queues two jobs on its own worker's deque, then keeps that worker busy
+ * until the test opens the gate.
+ */
+static void
+ttcs_parent_cb(struct os_event *ev)
+{
+    int rc;
+    int i;
+
+    ttcs_parent_task = os_sched_get_current_task();
+    for (i = 0; i < 2; i++) {
+        rc = taskpool_job_submit(&ttcs_child_ev[i], TASKPOOL_JOB_PRIO_LOW);
+        TEST_ASSERT(rc == 0);
+    }
+    os_sem_pend(&ttcs_gate, OS_TIMEOUT_NEVER);
+    os_sem_release(&ttcs_done);
+}
+
+TEST_CASE_TASK(taskpool_test_case_steal)
+{
+    int rc;
+    int i;
+
+    os_sem_init(&ttcs_gate, 0);
+    os_sem_init(&ttcs_done, 0);
+
+    /* Workers run above the test task; the parent starts right away. */
+    rc = taskpool_job_submit(&ttcs_parent_ev, TASKPOOL_JOB_PRIO_LOW);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The other worker steals both children, oldest first. */
+    for (i = 0; i < 2; i++) {
+        rc = os_sem_pend(&ttcs_done, TASKPOOL_TEST_TMO);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(ttcs_parent_task != NULL);
+    TEST_ASSERT(ttcs_child_task[0] != ttcs_parent_task);
+    TEST_ASSERT(ttcs_child_task[1] == ttcs_child_task[0]);
+    TEST_ASSERT(ttcs_child_seq[0] < ttcs_child_seq[1]);
+
+    os_sem_release(&ttcs_gate);
+    rc = os_sem_pend(&ttcs_done, TASKPOOL_TEST_TMO);
+    TEST_ASSERT(rc == 0);
+}
@@ -0,0 +1,370 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * Worker pool with per-worker job deques and stealing.
+ *
+ * The deques are short rings protected by critical sections, which is all
+ * that is needed on a single core.  taskpool_jobs_sem counts queued jobs:
+ * a job is pushed before the semaphore is released, and a task only takes
+ * a job after a successful pend, so a taker always finds one.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+
+#if MYNEWT_VAL(TASKPOOL_WORKERS) > 0
+
+#define TASKPOOL_NWORKERS   MYNEWT_VAL(TASKPOOL_WORKERS)
+#define TASKPOOL_QLEN       MYNEWT_VAL(TASKPOOL_WORKER_QUEUE_LEN)
+#define TASKPOOL_PRIO_CNT   (TASKPOOL_JOB_PRIO_LOW + 1)
+
+#if (TASKPOOL_QLEN & (TASKPOOL_QLEN - 1)) != 0 || TASKPOOL_QLEN > 32768
+#error "TASKPOOL_WORKER_QUEUE_LEN must be a power of two, at most 32768"
+#endif
+
+struct taskpool_deque {
+    struct os_event *td_jobs[TASKPOOL_QLEN];
+    /** Index of the oldest job; thieves take from here. */
+    uint16_t td_top;
+    /** Index one past the newest job; the owner pushes and pops here. */
+    uint16_t td_bottom;
+};
+
+struct taskpool_worker {
+    OS_TASK_STACK_DEFINE_NOSTATIC(tw_stack,
+                                  MYNEWT_VAL(TASKPOOL_WORKER_STACK_SIZE));
+    struct os_task tw_task;
+    struct taskpool_deque tw_q[TASKPOOL_PRIO_CNT];
+    char tw_name[sizeof "workerXX"];
+};
+
+struct taskpool_pfor {
+    taskpool_for_fn *tp_fn;
+    void *tp_arg;
+    uint32_t tp_remaining;
+    struct os_sem tp_done;
+};
+
+struct taskpool_chunk {
+    struct os_event tc_ev;
+    struct taskpool_pfor *tc_pfor;
+    uint32_t tc_start;
+    uint32_t tc_end;
+};
+
+static struct taskpool_worker taskpool_workers[TASKPOOL_NWORKERS];
+
+/** Number of jobs in all deques. */
+static struct os_sem taskpool_jobs_sem;
+
+/** Next worker to receive a job submitted from outside the pool. */
+static uint8_t taskpool_next_worker;
+
+static int
+taskpool_deque_push(struct taskpool_deque *td, struct os_event *ev)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    if ((uint16_t)(td->td_bottom - td->td_top) == TASKPOOL_QLEN) {
+        rc = SYS_ENOMEM;
+    } else {
+        td->td_jobs[td->td_bottom & (TASKPOOL_QLEN - 1)] = ev;
+        td->td_bottom++;
+        rc = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+static struct os_event *
+taskpool_deque_pop(struct taskpool_deque *td)
+{
+    struct os_event *ev;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (td->td_bottom == td->td_top) {
+        ev = NULL;
+    } else {
+        td->td_bottom--;
+        ev = td->td_jobs[td->td_bottom & (TASKPOOL_QLEN - 1)];
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return ev;
+}
+
+static struct os_event *
+taskpool_deque_steal(struct taskpool_deque *td)
+{
+    struct os_event *ev;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (td->td_bottom == td->td_top) {
+        ev = NULL;
+    } else {
+        ev = td->td_jobs[td->td_top & (TASKPOOL_QLEN - 1)];
+        td->td_top++;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return ev;
+}
+
+/** Returns the index of the calling worker, or -1 if not called by one. */
+static int
+taskpool_self(void)
+{
+    struct os_task *t;
+    int i;
+
+    t = os_sched_get_current_task();
+    for (i = 0; i < TASKPOOL_NWORKERS; i++) {
+        if (t == &taskpool_workers[i].tw_task) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Takes the next job: own newest job first, then the oldest job of the
+ * other workers, going through the high priority deques before the low
+ * priority ones.  Must only be called after a successful pend on
+ * taskpool_jobs_sem.
+ */
+static struct os_event *
+taskpool_take(int self)
+{
+    struct os_event *ev;
+    int prio;
+    int w;
+    int i;
+
+    for (prio = 0; prio < TASKPOOL_PRIO_CNT; prio++) {
+        if (self >= 0) {
+            ev = taskpool_deque_pop(&taskpool_workers[self].tw_q[prio]);
+            if (ev != NULL) {
+                return ev;
+            }
+        }
+        for (i = 1; i <= TASKPOOL_NWORKERS; i++) {
+            w = (self + i) % TASKPOOL_NWORKERS;
+            if (w == self) {
+                continue;
+            }
+            ev = taskpool_deque_steal(&taskpool_workers[w].tw_q[prio]);
+            if (ev != NULL) {
+                return ev;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void
+taskpool_run(struct os_event *ev)
+{
+    assert(ev != NULL);
+
+    ev->ev_queued = 0;
+    ev->ev_cb(ev);
+}
+
+static void
+taskpool_worker_handler(void *arg)
+{
+    int self;
+    int rc;
+
+    self = (struct taskpool_worker *)arg - taskpool_workers;
+    while (1) {
+        rc = os_sem_pend(&taskpool_jobs_sem, OS_TIMEOUT_NEVER);
+        assert(rc == 0);
+
+        taskpool_run(taskpool_take(self));
+    }
+}
+
+int
+taskpool_job_submit(struct os_event *ev, uint8_t prio)
+{
+    os_sr_t sr;
+    int start;
+    int w;
+    int i;
+
+    if (prio >= TASKPOOL_PRIO_CNT) {
+        return SYS_EINVAL;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (ev->ev_queued) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+    ev->ev_queued = 1;
+    start = taskpool_self();
+    if (start < 0) {
+        start = taskpool_next_worker;
+        taskpool_next_worker = (start + 1) % TASKPOOL_NWORKERS;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    /* Prefer the submitting worker's own deque, for locality. */
+    for (i = 0; i < TASKPOOL_NWORKERS; i++) {
+        w = (start + i) % TASKPOOL_NWORKERS;
+        if (taskpool_deque_push(&taskpool_workers[w].tw_q[prio], ev) == 0) {
+            os_sem_release(&taskpool_jobs_sem);
+            return 0;
+        }
+    }
+
+    ev->ev_queued = 0;
+    return SYS_ENOMEM;
+}
+
+static void
+taskpool_chunk_run(struct os_event *ev)
+{
+    struct taskpool_chunk *tc;
+    struct taskpool_pfor *tp;
+    uint32_t idx;
+    os_sr_t sr;
+    bool last;
+
+    tc = ev->ev_arg;
+    tp = tc->tc_pfor;
+    for (idx = tc->tc_start; idx < tc->tc_end; idx++) {
+        tp->tp_fn(idx, tp->tp_arg);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    last = --tp->tp_remaining == 0;
+    OS_EXIT_CRITICAL(sr);
+
+    if (last) {
+        os_sem_release(&tp->tp_done);
+    }
+}
+
+void
+taskpool_parallel_for(uint32_t count, taskpool_for_fn *fn, void *arg,
+                      uint8_t prio)
+{
+    struct taskpool_chunk chunks[MYNEWT_VAL(TASKPOOL_PFOR_MAX_CHUNKS)];
+    struct taskpool_pfor tp;
+    uint32_t nchunks;
+    uint32_t start;
+    uint32_t len;
+    uint32_t i;
+    os_sr_t sr;
+    int self;
+    int rc;
+
+    if (count == 0) {
+        return;
+    }
+
+    nchunks = min(count, MYNEWT_VAL(TASKPOOL_PFOR_MAX_CHUNKS));
+    tp.tp_fn = fn;
+    tp.tp_arg = arg;
+    tp.tp_remaining = nchunks;
+    os_sem_init(&tp.tp_done, 0);
+
+    start = 0;
+    for (i = 0; i < nchunks; i++) {
+        len = count / nchunks + (i < count % nchunks);
+        chunks[i].tc_ev.ev_queued = 0;
+        chunks[i].tc_ev.ev_cb = taskpool_chunk_run;
+        chunks[i].tc_ev.ev_arg = &chunks[i];
+        chunks[i].tc_pfor = &tp;
+        chunks[i].tc_start = start;
+        chunks[i].tc_end = start + len;
+        start += len;
+    }
+
+    /* Queue all but the first chunk, which the caller runs itself. */
+    for (i = 1; i < nchunks; i++) {
+        rc = taskpool_job_submit(&chunks[i].tc_ev, prio);
+        if (rc != 0) {
+            taskpool_chunk_run(&chunks[i].tc_ev);
+        }
+    }
+    taskpool_chunk_run(&chunks[0].tc_ev);
+
+    /*
+     * Help with queued jobs until our chunks are done.  Once no job is
+     * queued, all remaining chunks are running elsewhere; block until the
+     * last one finishes.
+     */
+    self = taskpool_self();
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        i = tp.tp_remaining;
+        OS_EXIT_CRITICAL(sr);
+        if (i == 0) {
+            break;
+        }
+
+        if (os_sem_pend(&taskpool_jobs_sem, 0) == 0) {
+            taskpool_run(taskpool_take(self));
+        } else {
+            os_sem_pend(&tp.tp_done, OS_TIMEOUT_NEVER);
+        }
+    }
+}
+
+#endif
+
+void
+taskpool_work_init(void)
+{
+#if MYNEWT_VAL(TASKPOOL_WORKERS) > 0
+    struct taskpool_worker *tw;
+    int rc;
+    int i;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    rc = os_sem_init(&taskpool_jobs_sem, 0);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    for (i = 0; i < TASKPOOL_NWORKERS; i++) {
+        tw = &taskpool_workers[i];
+        snprintf(tw->tw_name, sizeof tw->tw_name, "worker%02d", i);
+        rc = os_task_init(&tw->tw_task, tw->tw_name, taskpool_worker_handler,
+                          tw, MYNEWT_VAL(TASKPOOL_WORKER_PRIO) + i,
+                          OS_WAIT_FOREVER, tw->tw_stack,
+                          OS_STACK_ALIGN(MYNEWT_VAL(TASKPOOL_WORKER_STACK_SIZE)));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+#endif
+}